@@ -376,6 +376,105 @@ static bool add_addrspec(struct AddressList *al, const char *phrase,
   return true;
 }
 
+/**
+ * is_simple - Can this character be used in a simple email address?
+ * @param ch Character
+ *
+ * These characters don't need quoting anywhere in an address.
+ */
+#define is_simple(ch) (((unsigned char) (ch) > 0x20) && ((ch) != 0x7f) && !strchr("@,:;<>[]\\\"()", (ch)))
+
+/**
+ * parse_simple_addr - Parse a simple email address
+ * @param[in]  s  String to parse
+ * @param[out] al Add the Address to this list
+ * @retval ptr  The comma, semicolon or end of the string after the address
+ * @retval NULL The address isn't simple
+ *
+ * Most addresses look like "user@example.com", "Name <user@example.com>" or
+ * "\"Name, Quoted\" <user@example.com>".  These can be recognised in one scan.
+ *
+ * Anything else, e.g. with a comment, a route, an escaped character or extra
+ * spaces, is left to the full parser.  The full parser would give the same
+ * result for a simple address.
+ */
+static const char *parse_simple_addr(const char *s, struct AddressList *al)
+{
+  char personal[1024];
+  size_t plen = 0;
+  const char *p = s;
+
+  if (*p == '"')
+  {
+    for (p++; *p != '"'; p++)
+    {
+      if ((*p == '\0') || (*p == '\\') || (plen == (sizeof(personal) - 1)))
+        return NULL;
+      personal[plen++] = *p;
+    }
+    p = mutt_str_skip_email_wsp(p + 1);
+    if (*p != '<')
+      return NULL;
+  }
+  else
+  {
+    /* Words of a name, separated by single spaces */
+    while (is_simple(*p))
+    {
+      if (plen >= (sizeof(personal) - 2))
+        return NULL;
+      personal[plen++] = *p++;
+      if (mutt_str_is_email_wsp(*p))
+      {
+        p = mutt_str_skip_email_wsp(p);
+        if (is_simple(*p))
+          personal[plen++] = ' ';
+      }
+    }
+  }
+  personal[plen] = '\0';
+
+  /* Without a '<', the text must be the address itself */
+  const bool angle = (*p == '<');
+  const char *addr = angle ? p + 1 : s;
+
+  const char *q = addr;
+  while (is_simple(*q))
+    q++;
+  if (q == addr)
+    return NULL;
+  if (*q == '@')
+  {
+    const char *domain = ++q;
+    while (is_simple(*q))
+      q++;
+    if (q == domain)
+      return NULL;
+  }
+
+  const size_t alen = q - addr;
+  if (alen >= 1024)
+    return NULL;
+
+  if (angle)
+  {
+    if (*q != '>')
+      return NULL;
+    q++;
+  }
+
+  q = mutt_str_skip_email_wsp(q);
+  if ((*q != '\0') && (*q != ',') && (*q != ';'))
+    return NULL;
+
+  struct Address *a = mutt_addr_new();
+  if (angle)
+    a->personal = mutt_str_dup(personal);
+  a->mailbox = mutt_strn_dup(addr, alen);
+  mutt_addrlist_append(al, a);
+  return q;
+}
+
 /**
  * mutt_addr_new - Create a new Address
  * @retval ptr Newly allocated Address
@@ -384,6 +483,7 @@ static bool add_addrspec(struct AddressList *al, const char *phrase,
  */
 struct Address *mutt_addr_new(void)
 {
+  MEM_ACCOUNT(MEM_TAG_ADDRESS, sizeof(struct Address), 1);
   return mutt_mem_calloc(1, sizeof(struct Address));
 }
 
@@ -447,6 +547,7 @@ void mutt_addr_free(struct Address **ptr)
   FREE(&a->personal);
   FREE(&a->mailbox);
   FREE(ptr);
+  MEM_ACCOUNT(MEM_TAG_ADDRESS, -(long) sizeof(struct Address), -1);
 }
 
 /**
@@ -470,6 +571,19 @@ int mutt_addrlist_parse(struct AddressList *al, const char *s)
   s = mutt_str_skip_email_wsp(s);
   while (*s)
   {
+    /* Try the quick parser at the start of each address */
+    if ((phraselen == 0) && (commentlen == 0))
+    {
+      const char *end = parse_simple_addr(s, al);
+      if (end)
+      {
+        parsed++;
+        s = end;
+        if (*s == '\0')
+          break;
+      }
+    }
+
     switch (*s)
     {
       case ';':
@@ -73,8 +73,9 @@ struct Group *mutt_pattern_group(const char *pat)
     mutt_debug(LL_DEBUG2, "Creating group %s\n", pat);
     g = mutt_mem_calloc(1, sizeof(struct Group));
     g->name = mutt_str_dup(pat);
-    STAILQ_INIT(&g->rs);
+    STAILQ_INIT(&g->rs.regexes);
     TAILQ_INIT(&g->al);
+    g->addrs = mutt_hash_new(32, MUTT_HASH_STRCASECMP);
     mutt_hash_insert(Groups, g->name, g);
   }
 
@@ -90,8 +91,9 @@ static void group_remove(struct Group *g)
   if (!g)
     return;
   mutt_hash_delete(Groups, g->name, g);
+  mutt_hash_free(&g->addrs);
   mutt_addrlist_clear(&g->al);
-  mutt_regexlist_free(&g->rs);
+  mutt_regexset_free(&g->rs);
   FREE(&g->name);
   FREE(&g);
 }
@@ -126,7 +128,7 @@ static bool empty_group(struct Group *g)
 {
   if (!g)
     return true;
-  return TAILQ_EMPTY(&g->al) && STAILQ_EMPTY(&g->rs);
+  return TAILQ_EMPTY(&g->al) && mutt_regexset_is_empty(&g->rs);
 }
 
 /**
@@ -182,12 +184,19 @@ static void group_add_addrlist(struct Group *g, const struct AddressList *al)
 
   struct AddressList al_new = TAILQ_HEAD_INITIALIZER(al_new);
   mutt_addrlist_copy(&al_new, al, false);
-  mutt_addrlist_remove_xrefs(&g->al, &al_new);
   struct Address *a = NULL, *tmp = NULL;
   TAILQ_FOREACH_SAFE(a, &al_new, entries, tmp)
   {
     TAILQ_REMOVE(&al_new, a, entries);
+    /* Skip the Addresses that are already in the Group */
+    if (a->mailbox && mutt_hash_find(g->addrs, a->mailbox))
+    {
+      mutt_addr_free(&a);
+      continue;
+    }
     mutt_addrlist_append(&g->al, a);
+    if (a->mailbox)
+      mutt_hash_insert(g->addrs, a->mailbox, a);
   }
   assert(TAILQ_EMPTY(&al_new));
 }
@@ -203,7 +212,7 @@ static void group_add_addrlist(struct Group *g, const struct AddressList *al)
  */
 static int group_add_regex(struct Group *g, const char *s, uint16_t flags, struct Buffer *err)
 {
-  return mutt_regexlist_add(&g->rs, s, flags, err);
+  return mutt_regexset_add(&g->rs, s, flags, err);
 }
 
 /**
@@ -215,7 +224,7 @@ static int group_add_regex(struct Group *g, const char *s, uint16_t flags, struc
  */
 static int group_remove_regex(struct Group *g, const char *s)
 {
-  return mutt_regexlist_remove(&g->rs, s);
+  return mutt_regexset_remove(&g->rs, s);
 }
 
 /**
@@ -250,10 +259,13 @@ int mutt_grouplist_remove_addrlist(struct GroupList *gl, struct AddressList *al)
   struct GroupNode *gnp = NULL;
   STAILQ_FOREACH(gnp, gl, entries)
   {
+    struct Group *g = gnp->group;
     struct Address *a = NULL;
     TAILQ_FOREACH(a, al, entries)
     {
-      mutt_addrlist_remove(&gnp->group->al, a->mailbox);
+      if (a->mailbox)
+        mutt_hash_delete(g->addrs, a->mailbox, NULL);
+      mutt_addrlist_remove(&g->al, a->mailbox);
     }
     if (empty_group(gnp->group))
     {
@@ -327,14 +339,8 @@ bool mutt_group_match(struct Group *g, const char *s)
   if (!g || !s)
     return false;
 
-  if (mutt_regexlist_match(&g->rs, s))
+  if (mutt_hash_find(g->addrs, s))
     return true;
-  struct Address *a = NULL;
-  TAILQ_FOREACH(a, &g->al, entries)
-  {
-    if (a->mailbox && mutt_istr_equal(s, a->mailbox))
-      return true;
-  }
 
-  return false;
+  return mutt_regexset_match(&g->rs, s);
 }
@@ -38,9 +38,10 @@
  */
 struct Group
 {
-  struct AddressList al; ///< List of Addresses
-  struct RegexList rs;   ///< Group Regex patterns
-  char *name;            ///< Name of Group
+  struct AddressList al;   ///< List of Addresses
+  struct HashTable *addrs; ///< Index of the Addresses in al, by mailbox
+  struct RegexSet rs;      ///< Group Regex patterns
+  char *name;              ///< Name of Group
 };
 
 /**
@@ -55,6 +55,9 @@
 
 struct AliasList Aliases = TAILQ_HEAD_INITIALIZER(Aliases); ///< List of all the user's email aliases
 
+static struct AliasNameArray AliasNames = ARRAY_HEAD_INITIALIZER; ///< Aliases sorted by name
+static bool AliasNamesValid = false; ///< Does AliasNames match Aliases?
+
 /**
  * write_safe_address - Defang malicious email addresses
  * @param fp File to write to
@@ -270,6 +273,99 @@ static bool string_is_address(const char *str, const char *user, const char *dom
   return false;
 }
 
+/**
+ * alias_name_sort - Compare two Aliases by name - Implements ::sort_t
+ *
+ * Aliases with the same name are kept in config order.
+ */
+static int alias_name_sort(const void *a, const void *b)
+{
+  const struct AliasName *x = a;
+  const struct AliasName *y = b;
+
+  int rc = mutt_istr_cmp(x->alias->name, y->alias->name);
+  if (rc == 0)
+    rc = (x->seq > y->seq) - (x->seq < y->seq);
+  return rc;
+}
+
+/**
+ * alias_names_invalidate - Mark the index of Alias names as out of date
+ *
+ * This must be called whenever an Alias is added to, or removed from, the
+ * list of Aliases.
+ */
+void alias_names_invalidate(void)
+{
+  AliasNamesValid = false;
+}
+
+/**
+ * alias_names_get - Get the Aliases, sorted by name
+ * @retval ptr Array of Aliases, sorted case-insensitively
+ *
+ * The index is rebuilt, if the Aliases have changed.
+ */
+static struct AliasNameArray *alias_names_get(void)
+{
+  if (AliasNamesValid)
+    return &AliasNames;
+
+  ARRAY_SHRINK(&AliasNames, ARRAY_SIZE(&AliasNames));
+
+  size_t seq = 0;
+  struct Alias *a = NULL;
+  TAILQ_FOREACH(a, &Aliases, entries)
+  {
+    if (!a->name)
+      continue;
+    struct AliasName an = { a, seq++ };
+    ARRAY_ADD(&AliasNames, an);
+  }
+  ARRAY_SORT(&AliasNames, alias_name_sort);
+
+  AliasNamesValid = true;
+  return &AliasNames;
+}
+
+/**
+ * alias_names_prefix - Find the Aliases whose names start with a string
+ * @param[in]  prefix String to match
+ * @param[out] num    Number of matching Aliases
+ * @retval ptr First matching Alias
+ *
+ * The matches are consecutive entries of the sorted index.
+ *
+ * @note The match is case-insensitive
+ */
+struct AliasName *alias_names_prefix(const char *prefix, size_t *num)
+{
+  struct AliasNameArray *ana = alias_names_get();
+  const size_t len = mutt_str_len(prefix);
+
+  /* Find the first name that isn't less than the prefix */
+  size_t lo = 0;
+  size_t hi = ARRAY_SIZE(ana);
+  while (lo < hi)
+  {
+    const size_t mid = lo + ((hi - lo) / 2);
+    if (mutt_istrn_cmp(ARRAY_GET(ana, mid)->alias->name, prefix, len) < 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  size_t end = lo;
+  while ((end < ARRAY_SIZE(ana)) &&
+         (mutt_istrn_cmp(ARRAY_GET(ana, end)->alias->name, prefix, len) == 0))
+  {
+    end++;
+  }
+
+  *num = end - lo;
+  return (end > lo) ? ARRAY_GET(ana, lo) : NULL;
+}
+
 /**
  * alias_lookup - Find an Alias
  * @param name Alias name to find
@@ -280,12 +376,15 @@ static bool string_is_address(const char *str, const char *user, const char *dom
  */
 struct AddressList *alias_lookup(const char *name)
 {
-  struct Alias *a = NULL;
+  if (!name)
+    return NULL;
 
-  TAILQ_FOREACH(a, &Aliases, entries)
+  size_t num = 0;
+  struct AliasName *an = alias_names_prefix(name, &num);
+  for (size_t i = 0; i < num; i++)
   {
-    if (mutt_istr_equal(name, a->name))
-      return &a->addr;
+    if (mutt_istr_equal(name, an[i].alias->name))
+      return &an[i].alias->addr;
   }
   return NULL;
 }
@@ -492,6 +591,7 @@ retry_name:
 
   alias_reverse_add(alias);
   TAILQ_INSERT_TAIL(&Aliases, alias, entries);
+  alias_names_invalidate();
 
   const char *const alias_file = cs_subset_path(sub, "alias_file");
   mutt_str_copy(buf, NONULL(alias_file), sizeof(buf));
@@ -634,6 +734,7 @@ void alias_free(struct Alias **ptr)
 
   struct EventAlias ea = { alias };
   notify_send(NeoMutt->notify, NT_ALIAS, NT_ALIAS_DELETED, &ea);
+  alias_names_invalidate();
 
   FREE(&alias->name);
   FREE(&alias->comment);
@@ -676,4 +777,6 @@ void alias_shutdown(void)
   }
   aliaslist_free(&Aliases);
   alias_reverse_shutdown();
+  ARRAY_FREE(&AliasNames);
+  query_cache_free();
 }
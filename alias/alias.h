@@ -61,8 +61,20 @@ struct EventAlias
   struct Alias *alias;
 };
 
-void          alias_free    (struct Alias **ptr);
-void          aliaslist_free(struct AliasList *al);
-struct Alias *alias_new     (void);
+/**
+ * struct AliasName - An entry in the index of Alias names
+ */
+struct AliasName
+{
+  struct Alias *alias; ///< Alias
+  size_t seq;          ///< Position in the list of Aliases
+};
+ARRAY_HEAD(AliasNameArray, struct AliasName);
+
+void              alias_free            (struct Alias **ptr);
+void              aliaslist_free        (struct AliasList *al);
+struct Alias *    alias_new             (void);
+void              alias_names_invalidate(void);
+struct AliasName *alias_names_prefix    (const char *prefix, size_t *num);
 
 #endif /* MUTT_ALIAS_ALIAS_H */
@@ -112,6 +112,7 @@ enum CommandResult parse_alias(struct Buffer *buf, struct Buffer *s,
     tmp = alias_new();
     tmp->name = name;
     TAILQ_INSERT_TAIL(&Aliases, tmp, entries);
+    alias_names_invalidate();
     event = NT_ALIAS_NEW;
   }
   tmp->addr = al;
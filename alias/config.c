@@ -55,6 +55,9 @@ static struct ConfigDef AliasVars[] = {
   { "sort_alias", DT_SORT|DT_SORT_REVERSE, SORT_ALIAS, IP SortAliasMethods, NULL,
     "Sort method for the alias menu"
   },
+  { "query_cache_size", DT_NUMBER|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "Number of recent address queries to remember"
+  },
   { "query_command", DT_STRING|DT_COMMAND, 0, 0, NULL,
     "External command to query and external address book"
   },
@@ -385,9 +385,13 @@ int alias_complete(char *buf, size_t buflen, struct ConfigSubset *sub)
 
   if (buf[0] != '\0')
   {
-    TAILQ_FOREACH(np, &Aliases, entries)
+    /* The index ignores case, but completion doesn't */
+    size_t num = 0;
+    struct AliasName *an = alias_names_prefix(buf, &num);
+    for (size_t n = 0; n < num; n++)
     {
-      if (np->name && mutt_strn_equal(np->name, buf, strlen(buf)))
+      np = an[n].alias;
+      if (mutt_strn_equal(np->name, buf, strlen(buf)))
       {
         if (bestname[0] == '\0') /* init */
         {
@@ -70,6 +70,117 @@ static const struct Mapping QueryHelp[] = {
   // clang-format on
 };
 
+/**
+ * struct QueryCacheEntry - The results of an Address Query
+ */
+struct QueryCacheEntry
+{
+  char *cmd;                ///< Expanded query command
+  struct AliasList results; ///< Aliases that the command returned
+  TAILQ_ENTRY(QueryCacheEntry) entries; ///< Linked list, most recently used first
+};
+TAILQ_HEAD(QueryCacheList, QueryCacheEntry);
+
+/// Recent Address Queries, see $query_cache_size
+static struct QueryCacheList QueryCache = TAILQ_HEAD_INITIALIZER(QueryCache);
+static int QueryCacheCount = 0; ///< Number of entries in the QueryCache
+
+/**
+ * query_cache_entry_free - Free a cached Address Query
+ * @param qce Cache entry
+ */
+static void query_cache_entry_free(struct QueryCacheEntry *qce)
+{
+  TAILQ_REMOVE(&QueryCache, qce, entries);
+  QueryCacheCount--;
+  aliaslist_free(&qce->results);
+  FREE(&qce->cmd);
+  FREE(&qce);
+}
+
+/**
+ * query_cache_free - Forget the cached Address Queries
+ */
+void query_cache_free(void)
+{
+  struct QueryCacheEntry *qce = NULL;
+  struct QueryCacheEntry *tmp = NULL;
+  TAILQ_FOREACH_SAFE(qce, &QueryCache, entries, tmp)
+  {
+    query_cache_entry_free(qce);
+  }
+}
+
+/**
+ * aliaslist_copy - Copy a list of Aliases
+ * @param dst List to add the copies to
+ * @param src List to copy
+ */
+static void aliaslist_copy(struct AliasList *dst, const struct AliasList *src)
+{
+  const struct Alias *np = NULL;
+  TAILQ_FOREACH(np, src, entries)
+  {
+    struct Alias *copy = alias_new();
+    copy->name = mutt_str_dup(np->name);
+    copy->comment = mutt_str_dup(np->comment);
+    mutt_addrlist_copy(&copy->addr, &np->addr, false);
+    TAILQ_INSERT_TAIL(dst, copy, entries);
+  }
+}
+
+/**
+ * query_cache_fetch - Get the cached results of an Address Query
+ * @param cmd Expanded query command
+ * @param al  Alias list to fill
+ * @retval true The results were cached
+ */
+static bool query_cache_fetch(const char *cmd, struct AliasList *al)
+{
+  struct QueryCacheEntry *qce = NULL;
+  TAILQ_FOREACH(qce, &QueryCache, entries)
+  {
+    if (mutt_str_equal(qce->cmd, cmd))
+      break;
+  }
+
+  if (!qce)
+    return false;
+
+  aliaslist_copy(al, &qce->results);
+  TAILQ_REMOVE(&QueryCache, qce, entries);
+  TAILQ_INSERT_HEAD(&QueryCache, qce, entries);
+  mutt_debug(LL_DEBUG2, "using cached results of: %s\n", cmd);
+  return true;
+}
+
+/**
+ * query_cache_store - Save the results of an Address Query
+ * @param cmd Expanded query command
+ * @param al  Aliases that the command returned
+ * @param sub Config items
+ *
+ * The least recently used queries are dropped to make room.
+ */
+static void query_cache_store(const char *cmd, const struct AliasList *al,
+                              const struct ConfigSubset *sub)
+{
+  const short c_query_cache_size = cs_subset_number(sub, "query_cache_size");
+
+  while (!TAILQ_EMPTY(&QueryCache) && (QueryCacheCount >= c_query_cache_size))
+    query_cache_entry_free(TAILQ_LAST(&QueryCache, QueryCacheList));
+
+  if (c_query_cache_size <= 0)
+    return;
+
+  struct QueryCacheEntry *qce = mutt_mem_calloc(1, sizeof(*qce));
+  qce->cmd = mutt_str_dup(cmd);
+  TAILQ_INIT(&qce->results);
+  aliaslist_copy(&qce->results, al);
+  TAILQ_INSERT_HEAD(&QueryCache, qce, entries);
+  QueryCacheCount++;
+}
+
 /**
  * alias_to_addrlist - Turn an Alias into an AddressList
  * @param al    AddressList to fill (must be empty)
@@ -251,6 +362,12 @@ static int query_run(char *s, bool verbose, struct AliasList *al,
   const char *const query_command = cs_subset_string(sub, "query_command");
   mutt_buffer_file_expand_fmt_quote(cmd, query_command, s);
 
+  if (query_cache_fetch(mutt_buffer_string(cmd), al))
+  {
+    mutt_buffer_pool_release(&cmd);
+    return 0;
+  }
+
   pid_t pid = filter_create(mutt_buffer_string(cmd), NULL, &fp, NULL);
   if (pid < 0)
   {
@@ -258,7 +375,6 @@ static int query_run(char *s, bool verbose, struct AliasList *al,
     mutt_buffer_pool_release(&cmd);
     return -1;
   }
-  mutt_buffer_pool_release(&cmd);
 
   if (verbose)
     mutt_message(_("Waiting for response..."));
@@ -297,8 +413,10 @@ static int query_run(char *s, bool verbose, struct AliasList *al,
   {
     if (verbose)
       mutt_message("%s", msg);
+    query_cache_store(mutt_buffer_string(cmd), al, sub);
   }
   FREE(&msg);
+  mutt_buffer_pool_release(&cmd);
 
   return 0;
 }
@@ -47,7 +47,7 @@
 #include "mutt_globals.h"
 #include "mx.h"
 
-struct RegexList Alternates = STAILQ_HEAD_INITIALIZER(Alternates); ///< List of regexes to match the user's alternate email addresses
+struct RegexSet Alternates = { STAILQ_HEAD_INITIALIZER(Alternates.regexes), NULL }; ///< Regexes to match the user's alternate email addresses
 struct RegexList UnAlternates = STAILQ_HEAD_INITIALIZER(UnAlternates); ///< List of regexes to blacklist false matches in Alternates
 static struct Notify *AlternatesNotify = NULL;
 
@@ -58,7 +58,7 @@ void alternates_free(void)
 {
   notify_free(&AlternatesNotify);
 
-  mutt_regexlist_free(&Alternates);
+  mutt_regexset_free(&Alternates);
   mutt_regexlist_free(&UnAlternates);
 }
 
@@ -108,7 +108,7 @@ enum CommandResult parse_alternates(struct Buffer *buf, struct Buffer *s,
 
     mutt_regexlist_remove(&UnAlternates, buf->data);
 
-    if (mutt_regexlist_add(&Alternates, buf->data, REG_ICASE, err) != 0)
+    if (mutt_regexset_add(&Alternates, buf->data, REG_ICASE, err) != 0)
       goto bail;
 
     if (mutt_grouplist_add_regex(&gl, buf->data, REG_ICASE, err) != 0)
@@ -135,7 +135,7 @@ enum CommandResult parse_unalternates(struct Buffer *buf, struct Buffer *s,
   do
   {
     mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
-    mutt_regexlist_remove(&Alternates, buf->data);
+    mutt_regexset_remove(&Alternates, buf->data);
 
     if (!mutt_str_equal(buf->data, "*") &&
         (mutt_regexlist_add(&UnAlternates, buf->data, REG_ICASE, err) != 0))
@@ -158,7 +158,7 @@ bool mutt_alternates_match(const char *addr)
   if (!addr)
     return false;
 
-  if (mutt_regexlist_match(&Alternates, addr))
+  if (mutt_regexset_match(&Alternates, addr))
   {
     mutt_debug(LL_DEBUG5, "yes, %s matched by alternates\n", addr);
     if (mutt_regexlist_match(&UnAlternates, addr))
@@ -61,6 +61,7 @@ struct ListHead AttachExclude = STAILQ_HEAD_INITIALIZER(AttachExclude); ///< Lis
 struct ListHead InlineAllow = STAILQ_HEAD_INITIALIZER(InlineAllow); ///< List of inline types to counted
 struct ListHead InlineExclude = STAILQ_HEAD_INITIALIZER(InlineExclude); ///< List of inline types to ignore
 static struct Notify *AttachmentsNotify = NULL;
+static uint32_t AttachRulesId = 0; ///< Hash of the attachments rules, 0 if unknown
 
 /**
  * attachmatch_free - Free an AttachMatch - Implements ::list_free_t
@@ -115,6 +116,55 @@ void attach_init(void)
   notify_set_parent(AttachmentsNotify, NeoMutt->notify);
 }
 
+/**
+ * attach_rules_hash - Hash a list of attachments rules
+ * @param h    Hash so far
+ * @param tag  Name of the list, e.g. "+A"
+ * @param list List of AttachMatch
+ * @retval num Updated hash
+ */
+static uint32_t attach_rules_hash(uint32_t h, const char *tag, struct ListHead *list)
+{
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, list, entries)
+  {
+    const struct AttachMatch *a = (const struct AttachMatch *) np->data;
+    const char *strs[] = { tag, a->major, "/", a->minor, ";" };
+    for (size_t i = 0; i < mutt_array_size(strs); i++)
+    {
+      /* FNV-1a */
+      for (const unsigned char *s = (const unsigned char *) strs[i]; *s; s++)
+        h = (h ^ *s) * 16777619U;
+    }
+  }
+  return h;
+}
+
+/**
+ * attach_rules_id - Identify the current attachments rules
+ * @retval num Hash of the rules, never 0
+ *
+ * An attachment count saved in the header cache is only used if it was counted
+ * with the same rules and the same $count_alternatives.
+ */
+static uint32_t attach_rules_id(void)
+{
+  if (AttachRulesId == 0)
+  {
+    uint32_t h = 2166136261U;
+    h = attach_rules_hash(h, "+A", &AttachAllow);
+    h = attach_rules_hash(h, "-A", &AttachExclude);
+    h = attach_rules_hash(h, "+I", &InlineAllow);
+    h = attach_rules_hash(h, "-I", &InlineExclude);
+    AttachRulesId = (h != 0) ? h : 1;
+  }
+
+  /* $count_alternatives changes the count, too */
+  const bool c_count_alternatives = cs_subset_bool(NeoMutt->sub, "count_alternatives");
+  const uint32_t id = AttachRulesId ^ (c_count_alternatives ? 0x80000000U : 0);
+  return (id != 0) ? id : 1;
+}
+
 /**
  * count_body_parts_check - Compares mime types to the ok and except lists
  * @param checklist List of AttachMatch
@@ -259,6 +309,14 @@ int mutt_count_body_parts(struct Mailbox *m, struct Email *e)
   if (e->attach_valid)
     return e->attach_total;
 
+  /* The count may have been restored from the header cache */
+  const uint32_t rules = attach_rules_id();
+  if (e->attach_rules == rules)
+  {
+    e->attach_valid = true;
+    return e->attach_total;
+  }
+
   if (e->body->parts)
     keep_parts = true;
   else
@@ -273,18 +331,26 @@ int mutt_count_body_parts(struct Mailbox *m, struct Email *e)
     e->attach_total = 0;
 
   e->attach_valid = true;
+  e->attach_rules = rules;
 
   if (!keep_parts)
     mutt_body_free(&e->body->parts);
 
+  /* Save the count, so the message needn't be parsed next time */
+  mx_save_hcache(m, e);
+
   return e->attach_total;
 }
 
 /**
  * mutt_attachments_reset - Reset the attachment count for all Emails
+ *
+ * Call this when the attachments rules change.
  */
 void mutt_attachments_reset(struct Mailbox *m)
 {
+  AttachRulesId = 0;
+
   if (!m)
     return;
 
@@ -295,6 +361,7 @@ void mutt_attachments_reset(struct Mailbox *m)
       break;
     e->attach_valid = false;
     e->attach_total = 0;
+    e->attach_rules = 0;
   }
 }
 
@@ -369,6 +436,7 @@ static enum CommandResult parse_attach_list(struct Buffer *buf, struct Buffer *s
     mutt_list_insert_tail(head, (char *) a);
   } while (MoreArgs(s));
 
+  AttachRulesId = 0;
   notify_send(AttachmentsNotify, NT_ATTACH, NT_ATTACH_ADD, NULL);
 
   return MUTT_CMD_SUCCESS;
@@ -434,6 +502,7 @@ static enum CommandResult parse_unattach_list(struct Buffer *buf, struct Buffer
 
   FREE(&tmp);
 
+  AttachRulesId = 0;
   notify_send(AttachmentsNotify, NT_ATTACH, NT_ATTACH_DELETE, NULL);
 
   return MUTT_CMD_SUCCESS;
@@ -545,6 +614,7 @@ enum CommandResult parse_unattachments(struct Buffer *buf, struct Buffer *s,
     mutt_list_free_type(&InlineAllow, (list_free_t) attachmatch_free);
     mutt_list_free_type(&InlineExclude, (list_free_t) attachmatch_free);
 
+    AttachRulesId = 0;
     notify_send(AttachmentsNotify, NT_ATTACH, NT_ATTACH_DELETE, NULL);
     return 0;
   }
@@ -24,6 +24,11 @@
  * @page autocrypt_db Autocrypt database handling
  *
  * Autocrypt database handling
+ *
+ * The statements are prepared once, when they're first used, and kept until
+ * the database is closed.  Between mutt_autocrypt_batch_begin() and
+ * mutt_autocrypt_batch_end(), e.g. while a mailbox is being read, the peer
+ * updates are made in a single transaction.
  */
 
 #include "config.h"
@@ -51,6 +56,77 @@ static sqlite3_stmt *GossipHistoryInsertStmt;
 
 sqlite3 *AutocryptDB = NULL;
 
+static int BatchDepth = 0;     ///< Nesting of mutt_autocrypt_batch_begin()
+static bool BatchOpen = false; ///< Has the batch's transaction been started?
+
+/**
+ * autocrypt_db_tune - Set up a newly opened database connection
+ *
+ * The write-ahead log means that a write doesn't need to sync the whole
+ * database, and that other readers don't block it.
+ */
+static void autocrypt_db_tune(void)
+{
+  sqlite3_busy_timeout(AutocryptDB, 1000);
+  if (sqlite3_exec(AutocryptDB, "PRAGMA journal_mode = WAL;", NULL, NULL, NULL) != SQLITE_OK)
+    mutt_debug(LL_DEBUG1, "can't use WAL: %s\n", sqlite3_errmsg(AutocryptDB));
+  sqlite3_exec(AutocryptDB, "PRAGMA synchronous = NORMAL;", NULL, NULL, NULL);
+}
+
+/**
+ * autocrypt_db_batch_write - Prepare to write a peer update
+ *
+ * Inside a batch, the first write starts the transaction.
+ */
+static void autocrypt_db_batch_write(void)
+{
+  if ((BatchDepth == 0) || BatchOpen || !AutocryptDB)
+    return;
+
+  if (sqlite3_exec(AutocryptDB, "BEGIN;", NULL, NULL, NULL) == SQLITE_OK)
+    BatchOpen = true;
+}
+
+/**
+ * autocrypt_db_batch_commit - Commit the batch's transaction
+ */
+static void autocrypt_db_batch_commit(void)
+{
+  if (!BatchOpen)
+    return;
+
+  BatchOpen = false;
+  if (sqlite3_exec(AutocryptDB, "COMMIT;", NULL, NULL, NULL) == SQLITE_OK)
+    return;
+
+  mutt_debug(LL_DEBUG1, "commit failed: %s\n", sqlite3_errmsg(AutocryptDB));
+  sqlite3_exec(AutocryptDB, "ROLLBACK;", NULL, NULL, NULL);
+}
+
+/**
+ * mutt_autocrypt_batch_begin - Start a batch of Autocrypt database updates
+ *
+ * Batches may be nested.  The updates are committed by the outermost
+ * mutt_autocrypt_batch_end().
+ */
+void mutt_autocrypt_batch_begin(void)
+{
+  BatchDepth++;
+}
+
+/**
+ * mutt_autocrypt_batch_end - Finish a batch of Autocrypt database updates
+ */
+void mutt_autocrypt_batch_end(void)
+{
+  if (BatchDepth == 0)
+    return;
+
+  BatchDepth--;
+  if (BatchDepth == 0)
+    autocrypt_db_batch_commit();
+}
+
 /**
  * autocrypt_db_create - Create an Autocrypt SQLite database
  * @param db_path Path to database file
@@ -67,9 +143,31 @@ static int autocrypt_db_create(const char *db_path)
     mutt_error(_("Unable to open autocrypt database %s"), db_path);
     return -1;
   }
+  autocrypt_db_tune();
   return mutt_autocrypt_schema_init();
 }
 
+/**
+ * mutt_autocrypt_db_exists - Does the Autocrypt database exist?
+ * @retval true The database file exists
+ */
+bool mutt_autocrypt_db_exists(void)
+{
+  const char *const c_autocrypt_dir =
+      cs_subset_path(NeoMutt->sub, "autocrypt_dir");
+  if (!c_autocrypt_dir)
+    return false;
+
+  struct Buffer *db_path = mutt_buffer_pool_get();
+  mutt_buffer_concat_path(db_path, c_autocrypt_dir, "autocrypt.db");
+
+  struct stat sb;
+  bool rc = (stat(mutt_buffer_string(db_path), &sb) == 0);
+
+  mutt_buffer_pool_release(&db_path);
+  return rc;
+}
+
 /**
  * mutt_autocrypt_db_init - Initialise the Autocrypt SQLite database
  * @param m          Mailbox
@@ -104,6 +202,7 @@ int mutt_autocrypt_db_init(struct Mailbox *m, bool can_create)
       mutt_error(_("Unable to open autocrypt database %s"), mutt_buffer_string(db_path));
       goto cleanup;
     }
+    autocrypt_db_tune();
 
     if (mutt_autocrypt_schema_update())
       goto cleanup;
@@ -134,6 +233,8 @@ void mutt_autocrypt_db_close(void)
   if (!AutocryptDB)
     return;
 
+  autocrypt_db_batch_commit();
+
   sqlite3_finalize(AccountGetStmt);
   AccountGetStmt = NULL;
   sqlite3_finalize(AccountInsertStmt);
@@ -619,6 +720,8 @@ int mutt_autocrypt_db_peer_insert(struct Address *addr, struct AutocryptPeer *pe
   int rc = -1;
   struct Address *norm_addr = NULL;
 
+  autocrypt_db_batch_write();
+
   norm_addr = copy_normalize_addr(addr);
 
   if (!PeerInsertStmt)
@@ -681,6 +784,8 @@ int mutt_autocrypt_db_peer_update(struct AutocryptPeer *peer)
 {
   int rc = -1;
 
+  autocrypt_db_batch_write();
+
   if (!PeerUpdateStmt)
   {
     if (sqlite3_prepare_v3(AutocryptDB,
@@ -766,6 +871,8 @@ int mutt_autocrypt_db_peer_history_insert(struct Address *addr,
 {
   int rc = -1;
 
+  autocrypt_db_batch_write();
+
   struct Address *norm_addr = copy_normalize_addr(addr);
 
   if (!PeerHistoryInsertStmt)
@@ -843,6 +950,8 @@ int mutt_autocrypt_db_gossip_history_insert(struct Address *addr,
 {
   int rc = -1;
 
+  autocrypt_db_batch_write();
+
   struct Address *norm_addr = copy_normalize_addr(addr);
 
   if (!GossipHistoryInsertStmt)
@@ -70,6 +70,9 @@
  * calls are interactive, and we don't want to prompt the user while opening a
  * mailbox, for instance.
  *
+ * If the database already exists, startup doesn't open it.  That's left until
+ * Autocrypt is first used, because starting GPGME can be slow.
+ *
  * ### Database schema version
  *
  * There is a "schema" table in the database, which records database version.
@@ -164,7 +167,10 @@ extern char *AutocryptSignAs;
 extern char *AutocryptDefaultKey;
 
 void              dlg_select_autocrypt_account           (struct Mailbox *m);
+void              mutt_autocrypt_batch_begin             (void);
+void              mutt_autocrypt_batch_end               (void);
 void              mutt_autocrypt_cleanup                 (void);
+bool              mutt_autocrypt_db_exists               (void);
 int               mutt_autocrypt_generate_gossip_list    (struct Mailbox *m, struct Email *e);
 int               mutt_autocrypt_init                    (struct Mailbox *m, bool can_create);
 int               mutt_autocrypt_process_autocrypt_header(struct Mailbox *m, struct Email *e, struct Envelope *env);
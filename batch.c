@@ -0,0 +1,459 @@
+/**
+ * @file
+ * Process mailboxes from a script, without a screen
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page neo_batch Process mailboxes from a script, without a screen
+ *
+ * `neomutt -X script` runs the commands in a script, one per line, then exits.
+ * Curses is never started, so there's no redrawing or progress to slow down
+ * bulk maintenance of a mailbox.
+ *
+ * | Command              | Description
+ * | :------------------- | :---------------------------------------------------
+ * | open MAILBOX         | Close the current mailbox and open another
+ * | limit PATTERN        | Only work on the messages matching a pattern
+ * | tag PATTERN          | Tag the messages matching a pattern
+ * | untag PATTERN        | Untag the messages matching a pattern
+ * | delete PATTERN       | Delete the messages matching a pattern
+ * | undelete PATTERN     | Undelete the messages matching a pattern
+ * | copy MAILBOX         | Copy the tagged messages to a mailbox
+ * | save MAILBOX         | Move the tagged messages to a mailbox
+ * | sync                 | Write the changes to the mailbox
+ * | close                | Close the mailbox, writing the changes
+ *
+ * Any other line is a config command, e.g. `set delete=yes`.
+ *
+ * When the script ends, the mailbox is closed, as if quitting the index.
+ * If a command fails, the script stops and the mailbox is closed without
+ * writing the changes.  Questions, e.g. `$delete`, take their default answer.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "mutt.h"
+#include "batch.h"
+#include "pattern/lib.h"
+#include "commands.h"
+#include "context.h"
+#include "hook.h"
+#include "init.h"
+#include "mutt_globals.h"
+#include "muttlib.h"
+#include "mx.h"
+
+/**
+ * batch_free_hidden - Free a closed Mailbox that isn't in the config
+ * @param m Mailbox
+ *
+ * Closing a Mailbox that wasn't in the `mailboxes` list removes it from its
+ * Account, but doesn't free it.
+ */
+static void batch_free_hidden(struct Mailbox *m)
+{
+  if (m && (m->flags & MB_HIDDEN) && (m->opened == 0))
+    mailbox_free(&m);
+}
+
+/**
+ * batch_close_ctx - Close the current Mailbox
+ * @param write Write the changes first
+ * @retval true Success
+ */
+static bool batch_close_ctx(bool write)
+{
+  if (!Context)
+    return true;
+
+  struct Mailbox *m = Context->mailbox;
+  if (write)
+  {
+    if ((mx_mbox_close(&Context) != MX_STATUS_OK) || Context)
+      return false;
+  }
+  else
+  {
+    mx_fastclose_mailbox(m);
+    ctx_free(&Context);
+  }
+
+  batch_free_hidden(m);
+  return true;
+}
+
+/**
+ * batch_report - Describe the state of the current Mailbox
+ * @param name Name of the command
+ */
+static void batch_report(const char *name)
+{
+  struct Mailbox *m = Context->mailbox;
+
+  // L10N: e.g. "tag: 10 of 200 messages shown, 4 tagged, 0 deleted"
+  mutt_message(_("%s: %d of %d messages shown, %d tagged, %d deleted"), name,
+               m->vcount, m->msg_count, m->msg_tagged, m->msg_deleted);
+}
+
+/**
+ * batch_close - Close the Mailbox - Implements BatchCommand::parse()
+ */
+static enum CommandResult batch_close(struct Buffer *buf, struct Buffer *s,
+                                      intptr_t data, struct Buffer *err)
+{
+  if (MoreArgs(s))
+  {
+    mutt_buffer_printf(err, _("%s: too many arguments"), "close");
+    return MUTT_CMD_ERROR;
+  }
+
+  if (!batch_close_ctx(true))
+  {
+    mutt_buffer_strcpy(err, _("Unable to write mailbox"));
+    return MUTT_CMD_ERROR;
+  }
+
+  return MUTT_CMD_SUCCESS;
+}
+
+/**
+ * batch_open_mailbox - Close the current Mailbox and open another
+ * @param buf Path to the Mailbox, will be expanded
+ * @param err Buffer for error messages
+ * @retval #CommandResult Result, e.g. #MUTT_CMD_SUCCESS
+ */
+static enum CommandResult batch_open_mailbox(struct Buffer *buf, struct Buffer *err)
+{
+  if (!batch_close_ctx(true))
+  {
+    mutt_buffer_strcpy(err, _("Unable to write mailbox"));
+    return MUTT_CMD_ERROR;
+  }
+
+  mutt_buffer_expand_path(buf);
+  mutt_str_replace(&CurrentFolder, mutt_buffer_string(buf));
+  mutt_folder_hook(mutt_buffer_string(buf), NULL);
+
+  struct Mailbox *m = mx_path_resolve(mutt_buffer_string(buf));
+  const bool c_read_only = cs_subset_bool(NeoMutt->sub, "read_only");
+  Context = mx_mbox_open(m, c_read_only ? MUTT_READONLY : MUTT_OPEN_NO_FLAGS);
+  if (!Context)
+  {
+    if (!m->account)
+      mailbox_free(&m);
+    mutt_buffer_printf(err, _("Unable to open mailbox %s"), mutt_buffer_string(buf));
+    return MUTT_CMD_ERROR;
+  }
+
+  batch_report("open");
+  return MUTT_CMD_SUCCESS;
+}
+
+/**
+ * batch_open - Open a Mailbox - Implements BatchCommand::parse()
+ */
+static enum CommandResult batch_open(struct Buffer *buf, struct Buffer *s,
+                                     intptr_t data, struct Buffer *err)
+{
+  if (!MoreArgs(s))
+  {
+    mutt_buffer_printf(err, _("%s: too few arguments"), "open");
+    return MUTT_CMD_ERROR;
+  }
+
+  mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
+  if (MoreArgs(s))
+  {
+    mutt_buffer_printf(err, _("%s: too many arguments"), "open");
+    return MUTT_CMD_ERROR;
+  }
+
+  return batch_open_mailbox(buf, err);
+}
+
+/**
+ * batch_pattern - Apply a pattern to the Mailbox - Implements BatchCommand::parse()
+ *
+ * The rest of the line is the pattern.
+ */
+static enum CommandResult batch_pattern(struct Buffer *buf, struct Buffer *s,
+                                        intptr_t data, struct Buffer *err)
+{
+  const char *name = mutt_buffer_string(buf);
+  if (!Context)
+  {
+    mutt_buffer_printf(err, _("%s: no mailbox is open"), name);
+    return MUTT_CMD_ERROR;
+  }
+
+  SKIPWS(s->dptr);
+  if (*s->dptr == '\0')
+  {
+    mutt_buffer_printf(err, _("%s: too few arguments"), name);
+    return MUTT_CMD_ERROR;
+  }
+
+  if (mutt_pattern_apply(Context, data, s->dptr) != 0)
+  {
+    mutt_buffer_printf(err, _("%s: invalid pattern"), name);
+    return MUTT_CMD_ERROR;
+  }
+  s->dptr += mutt_str_len(s->dptr);
+
+  batch_report(name);
+  return MUTT_CMD_SUCCESS;
+}
+
+/**
+ * batch_save - Copy or move the tagged Emails - Implements BatchCommand::parse()
+ */
+static enum CommandResult batch_save(struct Buffer *buf, struct Buffer *s,
+                                     intptr_t data, struct Buffer *err)
+{
+  const enum MessageSaveOpt save_opt = data;
+  const char *name = (save_opt == SAVE_MOVE) ? "save" : "copy";
+  if (!Context)
+  {
+    mutt_buffer_printf(err, _("%s: no mailbox is open"), name);
+    return MUTT_CMD_ERROR;
+  }
+
+  if (!MoreArgs(s))
+  {
+    mutt_buffer_printf(err, _("%s: too few arguments"), name);
+    return MUTT_CMD_ERROR;
+  }
+
+  mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
+  if (MoreArgs(s))
+  {
+    mutt_buffer_printf(err, _("%s: too many arguments"), name);
+    return MUTT_CMD_ERROR;
+  }
+  mutt_buffer_expand_path(buf);
+
+  struct Mailbox *m = Context->mailbox;
+  struct EmailList el = STAILQ_HEAD_INITIALIZER(el);
+  if (el_add_tagged(&el, Context, NULL, true) < 1)
+  {
+    mutt_message(_("%s: no tagged messages"), name);
+    return MUTT_CMD_SUCCESS;
+  }
+
+  enum CommandResult rc = MUTT_CMD_SUCCESS;
+  struct Mailbox *m_save = mx_path_resolve(mutt_buffer_string(buf));
+  const bool old_append = m_save->append;
+  struct Context *ctx_save = mx_mbox_open(m_save, MUTT_NEWFOLDER | MUTT_QUIET);
+  if (!ctx_save)
+  {
+    mailbox_free(&m_save);
+    mutt_buffer_printf(err, _("Unable to open mailbox %s"), mutt_buffer_string(buf));
+    rc = MUTT_CMD_ERROR;
+    goto done;
+  }
+  m_save->append = true;
+
+  int count = 0;
+  struct EmailNode *en = NULL;
+  mx_msg_append_batch(m_save, true);
+  STAILQ_FOREACH(en, &el, entries)
+  {
+    mutt_message_hook(m, en->email, MUTT_MESSAGE_HOOK);
+    if (mutt_save_message_ctx(m, en->email, save_opt, TRANSFORM_NONE, ctx_save->mailbox) != 0)
+    {
+      mutt_buffer_printf(err, _("%s: unable to write to %s"), name, mutt_buffer_string(buf));
+      rc = MUTT_CMD_ERROR;
+      break;
+    }
+    count++;
+  }
+
+  if ((mx_msg_append_batch(m_save, false) != 0) && (rc == MUTT_CMD_SUCCESS))
+  {
+    mutt_buffer_printf(err, _("%s: unable to write to %s"), name, mutt_buffer_string(buf));
+    rc = MUTT_CMD_ERROR;
+  }
+  mx_mbox_close(&ctx_save);
+  m_save->append = old_append;
+  batch_free_hidden(m_save);
+
+  // L10N: e.g. "save: 4 messages to /home/user/archive"
+  mutt_message(_("%s: %d messages to %s"), name, count, mutt_buffer_string(buf));
+
+done:
+  emaillist_clear(&el);
+  return rc;
+}
+
+/**
+ * batch_sync - Write the changes to the Mailbox - Implements BatchCommand::parse()
+ */
+static enum CommandResult batch_sync(struct Buffer *buf, struct Buffer *s,
+                                     intptr_t data, struct Buffer *err)
+{
+  if (!Context)
+  {
+    mutt_buffer_printf(err, _("%s: no mailbox is open"), "sync");
+    return MUTT_CMD_ERROR;
+  }
+
+  if (MoreArgs(s))
+  {
+    mutt_buffer_printf(err, _("%s: too many arguments"), "sync");
+    return MUTT_CMD_ERROR;
+  }
+
+  if (mx_mbox_sync(Context->mailbox) == MX_STATUS_ERROR)
+  {
+    mutt_buffer_strcpy(err, _("Unable to write mailbox"));
+    return MUTT_CMD_ERROR;
+  }
+
+  batch_report("sync");
+  return MUTT_CMD_SUCCESS;
+}
+
+/**
+ * BatchCommands - Commands that work on the current Mailbox
+ */
+static const struct BatchCommand BatchCommands[] = {
+  // clang-format off
+  { "close",    batch_close,   0             },
+  { "copy",     batch_save,    SAVE_COPY     },
+  { "delete",   batch_pattern, MUTT_DELETE   },
+  { "limit",    batch_pattern, MUTT_LIMIT    },
+  { "open",     batch_open,    0             },
+  { "save",     batch_save,    SAVE_MOVE     },
+  { "sync",     batch_sync,    0             },
+  { "tag",      batch_pattern, MUTT_TAG      },
+  { "undelete", batch_pattern, MUTT_UNDELETE },
+  { "untag",    batch_pattern, MUTT_UNTAG    },
+  { NULL, NULL, 0 },
+  // clang-format on
+};
+
+/**
+ * batch_line - Run one line of a batch script
+ * @param line Line to run
+ * @param err  Buffer for error messages
+ * @retval #CommandResult Result, e.g. #MUTT_CMD_SUCCESS
+ */
+static enum CommandResult batch_line(const char *line, struct Buffer *err)
+{
+  SKIPWS(line);
+  if ((*line == '\0') || (*line == '#'))
+    return MUTT_CMD_SUCCESS;
+
+  enum CommandResult rc = MUTT_CMD_ERROR;
+  struct Buffer *token = mutt_buffer_pool_get();
+  struct Buffer expn = mutt_buffer_make(0);
+  mutt_buffer_addstr(&expn, line);
+  mutt_buffer_seek(&expn, 0);
+
+  mutt_extract_token(token, &expn, MUTT_TOKEN_NO_FLAGS);
+
+  const struct BatchCommand *cmd = NULL;
+  for (size_t i = 0; BatchCommands[i].name; i++)
+  {
+    if (mutt_str_equal(mutt_buffer_string(token), BatchCommands[i].name))
+    {
+      cmd = &BatchCommands[i];
+      break;
+    }
+  }
+
+  if (cmd)
+    rc = cmd->parse(token, &expn, cmd->data, err);
+  else
+    rc = mutt_parse_rc_line(line, err);
+
+  mutt_buffer_pool_release(&token);
+  mutt_buffer_dealloc(&expn);
+  return rc;
+}
+
+/**
+ * mutt_batch_run - Run a batch script
+ * @param file   Script to run, "-" for stdin
+ * @param folder Mailbox to open first, may be NULL
+ * @retval 0 Success
+ * @retval 1 Error
+ */
+int mutt_batch_run(const char *file, const char *folder)
+{
+  FILE *fp = mutt_str_equal(file, "-") ? stdin : mutt_file_fopen(file, "r");
+  if (!fp)
+  {
+    mutt_perror(file);
+    return 1;
+  }
+
+  int rc = 0;
+  struct Buffer *err = mutt_buffer_pool_get();
+
+  if (folder)
+  {
+    struct Buffer *path = mutt_buffer_pool_get();
+    mutt_buffer_strcpy(path, folder);
+    if (batch_open_mailbox(path, err) == MUTT_CMD_ERROR)
+    {
+      mutt_error("%s", mutt_buffer_string(err));
+      rc = 1;
+    }
+    mutt_buffer_pool_release(&path);
+  }
+
+  char *line = NULL;
+  size_t linelen = 0;
+  int line_num = 0;
+  while ((rc == 0) && (line = mutt_file_read_line(line, &linelen, fp, &line_num, MUTT_RL_CONT)))
+  {
+    mutt_buffer_reset(err);
+    const enum CommandResult crc = batch_line(line, err);
+    if (crc == MUTT_CMD_ERROR)
+    {
+      mutt_error("%s:%d: %s", file, line_num, mutt_buffer_string(err));
+      rc = 1;
+    }
+    else if (crc == MUTT_CMD_WARNING)
+      mutt_warning("%s:%d: %s", file, line_num, mutt_buffer_string(err));
+    else if (crc == MUTT_CMD_FINISH)
+      break;
+  }
+  FREE(&line);
+
+  if (!batch_close_ctx(rc == 0))
+  {
+    mutt_error(_("Unable to write mailbox"));
+    batch_close_ctx(false);
+    rc = 1;
+  }
+
+  mutt_buffer_pool_release(&err);
+  if (fp != stdin)
+    mutt_file_fclose(&fp);
+  return rc;
+}
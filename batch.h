@@ -0,0 +1,53 @@
+/**
+ * @file
+ * Process mailboxes from a script, without a screen
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_BATCH_H
+#define MUTT_BATCH_H
+
+#include <stdint.h>
+#include "mutt_commands.h"
+
+struct Buffer;
+
+/**
+ * struct BatchCommand - A command in a batch script
+ */
+struct BatchCommand
+{
+  const char *name; ///< Name of the command
+
+  /**
+   * parse - Function to run a batch command
+   * @param buf  Temporary Buffer
+   * @param s    Rest of the command line
+   * @param data Private data to pass to parse function
+   * @param err  Buffer for error messages
+   * @retval #CommandResult Result, e.g. #MUTT_CMD_SUCCESS
+   */
+  enum CommandResult (*parse)(struct Buffer *buf, struct Buffer *s, intptr_t data, struct Buffer *err);
+
+  intptr_t data; ///< Private data to pass to the command
+};
+
+int mutt_batch_run(const char *file, const char *folder);
+
+#endif /* MUTT_BATCH_H */
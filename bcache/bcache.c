@@ -25,15 +25,28 @@
  * @page bcache_bcache Body Caching - local copies of email bodies
  *
  * Body Caching - local copies of email bodies
+ *
+ * If `$message_cache_size` is set, each cache directory keeps an index of its
+ * messages, their sizes and when they were last used.  The index is a journal:
+ * changes are appended and it's rewritten once it's grown to twice its size.
+ * When the cache grows too big, the least recently used messages are removed
+ * from the index and their files are deleted in the background.
+ *
+ * If `$message_cache_sharded` is set, the messages are spread over 256
+ * sub-directories, chosen by a hash of their id, so that no directory gets too
+ * big.  A cache directory is converted to (or from) this layout when it's
+ * opened.
  */
 
 #include "config.h"
 #include <dirent.h>
 #include <errno.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <time.h>
 #include "mutt/lib.h"
 #include "config/lib.h"
 #include "email/lib.h"
@@ -44,14 +57,359 @@
 
 struct ConnAccount;
 
+#define BCACHE_INDEX ".index"     ///< Name of the index file in the cache directory
+#define BCACHE_SHARDED ".sharded" ///< Marks a cache directory that uses shards
+#define BCACHE_SHARDS 256         ///< Number of shard directories
+
+/**
+ * struct BcacheEntry - A message in the index of a Body Cache
+ */
+struct BcacheEntry
+{
+  off_t size;   ///< Size of the cached message
+  time_t atime; ///< When the message was last used
+};
+
 /**
  * struct BodyCache - Local cache of email bodies
  */
 struct BodyCache
 {
   char *path;
+  bool sharded;                   ///< Messages are stored in shard directories
+  struct HashTable *index;        ///< Cached messages, id -> BcacheEntry
+  off_t size;                     ///< Total size of the cached messages
+  int index_lines;                ///< Number of lines in the index file
+  struct ListHead evict;          ///< Paths being deleted in the background
+  struct WorkerFuture *evict_fut; ///< Background deletion of the paths
 };
 
+/**
+ * bcache_max_size - Get the maximum size of a Body Cache
+ * @retval num Size in bytes, 0 if unlimited
+ */
+static off_t bcache_max_size(void)
+{
+  const long c_message_cache_size = cs_subset_long(NeoMutt->sub, "message_cache_size");
+  return (off_t) c_message_cache_size * 1024;
+}
+
+/**
+ * bcache_shard - Pick the shard directory for a message
+ * @param id  Message id
+ * @param len Length of the id
+ * @retval num Shard number, 0 to #BCACHE_SHARDS - 1
+ */
+static unsigned int bcache_shard(const char *id, size_t len)
+{
+  /* FNV-1a */
+  unsigned int h = 2166136261U;
+  for (size_t i = 0; i < len; i++)
+  {
+    h ^= (unsigned char) id[i];
+    h *= 16777619U;
+  }
+  return (h ^ (h >> 16)) % BCACHE_SHARDS;
+}
+
+/**
+ * bcache_file - Get the path of a message in the Body Cache
+ * @param bcache Body Cache
+ * @param id     Message id
+ * @param suffix Suffix for the filename, e.g. ".tmp" (optional)
+ * @param buf    Buffer for the result
+ */
+static void bcache_file(struct BodyCache *bcache, const char *id,
+                        const char *suffix, struct Buffer *buf)
+{
+  if (bcache->sharded)
+  {
+    mutt_buffer_printf(buf, "%s.%02x/%s%s", bcache->path,
+                       bcache_shard(id, mutt_str_len(id)), id, NONULL(suffix));
+  }
+  else
+  {
+    mutt_buffer_printf(buf, "%s%s%s", bcache->path, id, NONULL(suffix));
+  }
+}
+
+/**
+ * bcache_evict_task - Delete evicted messages - Implements ::worker_task_t
+ */
+static void bcache_evict_task(void *item)
+{
+  struct ListHead *paths = item;
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, paths, entries)
+  {
+    unlink(np->data);
+  }
+}
+
+/**
+ * bcache_evict_wait - Wait for the evicted messages to be deleted
+ * @param bcache Body Cache
+ */
+static void bcache_evict_wait(struct BodyCache *bcache)
+{
+  if (!bcache->evict_fut)
+    return;
+
+  mutt_worker_wait(&bcache->evict_fut);
+  mutt_list_free(&bcache->evict);
+}
+
+/**
+ * bcache_index_write - Rewrite the index of a Body Cache
+ * @param bcache Body Cache
+ */
+static void bcache_index_write(struct BodyCache *bcache)
+{
+  struct Buffer *path = mutt_buffer_pool_get();
+  struct Buffer *tmp = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s%s", bcache->path, BCACHE_INDEX);
+  mutt_buffer_printf(tmp, "%s%s.tmp", bcache->path, BCACHE_INDEX);
+
+  FILE *fp = mutt_file_fopen(mutt_buffer_string(tmp), "w");
+  if (fp)
+  {
+    int lines = 0;
+    struct HashWalkState state = { 0 };
+    struct HashElem *he = NULL;
+    while ((he = mutt_hash_walk(bcache->index, &state)))
+    {
+      const struct BcacheEntry *be = he->data;
+      fprintf(fp, "+ %ld %ld %s\n", (long) be->atime, (long) be->size, he->key.strkey);
+      lines++;
+    }
+
+    if ((mutt_file_fclose(&fp) == 0) &&
+        (rename(mutt_buffer_string(tmp), mutt_buffer_string(path)) == 0))
+    {
+      bcache->index_lines = lines;
+    }
+    else
+    {
+      unlink(mutt_buffer_string(tmp));
+    }
+  }
+
+  mutt_buffer_pool_release(&path);
+  mutt_buffer_pool_release(&tmp);
+}
+
+/**
+ * bcache_index_append - Append a change to the index of a Body Cache
+ * @param bcache Body Cache
+ * @param lines  Number of lines being added
+ * @param fmt    printf-like format string for the line(s)
+ * @param ...    Arguments to be formatted
+ */
+static void bcache_index_append(struct BodyCache *bcache, int lines, const char *fmt, ...)
+{
+  struct Buffer *path = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s%s", bcache->path, BCACHE_INDEX);
+
+  FILE *fp = mutt_file_fopen(mutt_buffer_string(path), "a");
+  if (fp)
+  {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(fp, fmt, ap);
+    va_end(ap);
+    mutt_file_fclose(&fp);
+    bcache->index_lines += lines;
+  }
+  mutt_buffer_pool_release(&path);
+
+  /* compact the journal */
+  if (bcache->index_lines > (2 * bcache->index->num_keys) + 64)
+    bcache_index_write(bcache);
+}
+
+/**
+ * bcache_index_set - Add a message to the in-memory index
+ * @param bcache Body Cache
+ * @param id     Message id
+ * @param size   Size of the message
+ * @param atime  When the message was last used
+ */
+static void bcache_index_set(struct BodyCache *bcache, const char *id, off_t size, time_t atime)
+{
+  struct BcacheEntry *be = mutt_hash_find(bcache->index, id);
+  if (be)
+  {
+    bcache->size -= be->size;
+  }
+  else
+  {
+    be = mutt_mem_calloc(1, sizeof(*be));
+    mutt_hash_insert(bcache->index, id, be);
+  }
+  be->size = size;
+  be->atime = atime;
+  bcache->size += size;
+}
+
+/**
+ * bcache_index_unset - Remove a message from the in-memory index
+ * @param bcache Body Cache
+ * @param id     Message id
+ * @retval true The message was in the index
+ */
+static bool bcache_index_unset(struct BodyCache *bcache, const char *id)
+{
+  struct BcacheEntry *be = mutt_hash_find(bcache->index, id);
+  if (!be)
+    return false;
+
+  bcache->size -= be->size;
+  mutt_hash_delete(bcache->index, id, be);
+  return true;
+}
+
+/**
+ * bcache_entry_free - Free a BcacheEntry - Implements ::hash_hdata_free_t
+ */
+static void bcache_entry_free(int type, void *obj, intptr_t data)
+{
+  FREE(&obj);
+}
+
+/**
+ * bcache_scan_cb - Add a cached message to the index - Implements ::bcache_list_t
+ */
+static int bcache_scan_cb(const char *id, struct BodyCache *bcache, void *data)
+{
+  const size_t len = mutt_str_len(id);
+  if ((len > 4) && mutt_str_equal(id + len - 4, ".tmp"))
+    return 0;
+
+  struct Buffer *path = mutt_buffer_pool_get();
+  bcache_file(bcache, id, NULL, path);
+
+  struct stat st;
+  if ((stat(mutt_buffer_string(path), &st) == 0) && S_ISREG(st.st_mode))
+    bcache_index_set(bcache, id, st.st_size, MAX(st.st_atime, st.st_mtime));
+
+  mutt_buffer_pool_release(&path);
+  return 0;
+}
+
+/**
+ * bcache_index_load - Load the index of a Body Cache
+ * @param bcache Body Cache
+ * @retval true The index is available
+ *
+ * If there's no index file, the cache directory is scanned to create one.
+ */
+static bool bcache_index_load(struct BodyCache *bcache)
+{
+  if (bcache->index)
+    return true;
+
+  if (bcache_max_size() == 0)
+    return false;
+
+  bcache->index = mutt_hash_new(1024, MUTT_HASH_STRDUP_KEYS);
+  mutt_hash_set_destructor(bcache->index, bcache_entry_free, 0);
+
+  struct Buffer *path = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s%s", bcache->path, BCACHE_INDEX);
+
+  FILE *fp = mutt_file_fopen(mutt_buffer_string(path), "r");
+  if (fp)
+  {
+    char *line = NULL;
+    size_t len = 0;
+    int lnum = 0;
+    while ((line = mutt_file_read_line(line, &len, fp, &lnum, MUTT_RL_NO_FLAGS)))
+    {
+      long atime = 0, size = 0;
+      int n = 0;
+      if ((sscanf(line, "+ %ld %ld %n", &atime, &size, &n) == 2) && (n > 0))
+        bcache_index_set(bcache, line + n, size, atime);
+      else if (mutt_str_startswith(line, "- "))
+        bcache_index_unset(bcache, line + 2);
+    }
+    bcache->index_lines = lnum;
+    FREE(&line);
+    mutt_file_fclose(&fp);
+  }
+  else if (mutt_bcache_list(bcache, bcache_scan_cb, NULL) >= 0)
+  {
+    bcache_index_write(bcache);
+  }
+
+  mutt_debug(LL_DEBUG3, "bcache: index: %zu messages, %ld bytes\n",
+             bcache->index->num_keys, (long) bcache->size);
+  mutt_buffer_pool_release(&path);
+  return true;
+}
+
+/**
+ * bcache_entry_cmp - Compare two Body Cache entries by last use - Implements ::sort_t
+ */
+static int bcache_entry_cmp(const void *a, const void *b)
+{
+  const struct BcacheEntry *ba = (*(struct HashElem *const *) a)->data;
+  const struct BcacheEntry *bb = (*(struct HashElem *const *) b)->data;
+  return (ba->atime > bb->atime) - (ba->atime < bb->atime);
+}
+
+/**
+ * bcache_evict - Remove the least recently used messages from a Body Cache
+ * @param bcache Body Cache
+ * @param keep   Message id that mustn't be evicted, e.g. the one just added
+ *
+ * The cache is shrunk to 90% of `$message_cache_size`, so the eviction isn't
+ * repeated for every new message.  The files are deleted in the background.
+ */
+static void bcache_evict(struct BodyCache *bcache, const char *keep)
+{
+  const off_t max = bcache_max_size();
+  if ((max == 0) || (bcache->size <= max))
+    return;
+
+  bcache_evict_wait(bcache);
+
+  size_t num = bcache->index->num_keys;
+  struct HashElem **elems = mutt_mem_calloc(num, sizeof(struct HashElem *));
+  struct HashWalkState state = { 0 };
+  size_t n = 0;
+  struct HashElem *he = NULL;
+  while ((n < num) && (he = mutt_hash_walk(bcache->index, &state)))
+    elems[n++] = he;
+  qsort(elems, n, sizeof(struct HashElem *), bcache_entry_cmp);
+
+  const off_t target = max - (max / 10);
+  struct Buffer *lines = mutt_buffer_pool_get();
+  struct Buffer *path = mutt_buffer_pool_get();
+  off_t size = bcache->size;
+  size_t count = 0;
+  for (size_t i = 0; (i < n) && (size > target); i++)
+  {
+    if (mutt_str_equal(elems[i]->key.strkey, keep))
+      continue;
+
+    const struct BcacheEntry *be = elems[i]->data;
+    size -= be->size;
+    bcache_file(bcache, elems[i]->key.strkey, NULL, path);
+    mutt_list_insert_tail(&bcache->evict, mutt_buffer_strdup(path));
+    mutt_buffer_add_printf(lines, "- %s\n", elems[i]->key.strkey);
+    bcache_index_unset(bcache, elems[i]->key.strkey);
+    count++;
+  }
+
+  mutt_debug(LL_DEBUG1, "bcache: evicting %zu messages from %s\n", count, bcache->path);
+  bcache_index_append(bcache, count, "%s", mutt_buffer_string(lines));
+  bcache->evict_fut = mutt_worker_submit(bcache_evict_task, &bcache->evict);
+
+  mutt_buffer_pool_release(&lines);
+  mutt_buffer_pool_release(&path);
+  FREE(&elems);
+}
+
 /**
  * bcache_path - Create the cache path for a given account/mailbox
  * @param account Account info
@@ -105,31 +463,144 @@ static int bcache_path(struct ConnAccount *account, const char *mailbox, struct
 }
 
 /**
- * mutt_bcache_move - Change the id of a message in the cache
- * @param bcache Body cache
- * @param id     Per-mailbox unique identifier for the message
- * @param newid  New id for the message
+ * bcache_migrate_file - Move a message in or out of its shard directory
+ * @param bcache Body Cache
+ * @param dir    Directory containing the message
+ * @param name   Filename of the message
+ * @param shard  true to move the message into its shard
+ * @retval true Success
  */
-static int mutt_bcache_move(struct BodyCache *bcache, const char *id, const char *newid)
+static bool bcache_migrate_file(struct BodyCache *bcache, const char *dir,
+                                const char *name, bool shard)
 {
-  if (!bcache || !id || (*id == '\0') || !newid || (*newid == '\0'))
-    return -1;
+  struct Buffer *src = mutt_buffer_pool_get();
+  struct Buffer *dst = mutt_buffer_pool_get();
+  bool rc = false;
 
-  struct Buffer *path = mutt_buffer_pool_get();
-  struct Buffer *newpath = mutt_buffer_pool_get();
+  mutt_buffer_printf(src, "%s%s", dir, name);
+  struct stat st;
+  if ((lstat(mutt_buffer_string(src), &st) != 0) || !S_ISREG(st.st_mode))
+  {
+    rc = true; // e.g. the cache of a sub-mailbox
+    goto done;
+  }
 
-  mutt_buffer_printf(path, "%s%s", bcache->path, id);
-  mutt_buffer_printf(newpath, "%s%s", bcache->path, newid);
+  if (shard)
+  {
+    /* keep an unfinished download next to the message it will become */
+    size_t len = mutt_str_len(name);
+    if ((len > 4) && mutt_str_equal(name + len - 4, ".tmp"))
+      len -= 4;
+
+    mutt_buffer_printf(dst, "%s.%02x", bcache->path, bcache_shard(name, len));
+    if ((mkdir(mutt_buffer_string(dst), S_IRWXU | S_IRWXG | S_IRWXO) != 0) &&
+        (errno != EEXIST))
+    {
+      goto done;
+    }
+    mutt_buffer_add_printf(dst, "/%s", name);
+  }
+  else
+  {
+    mutt_buffer_printf(dst, "%s%s", bcache->path, name);
+  }
 
-  mutt_debug(LL_DEBUG3, "bcache: mv: '%s' '%s'\n", mutt_buffer_string(path),
-             mutt_buffer_string(newpath));
+  rc = (rename(mutt_buffer_string(src), mutt_buffer_string(dst)) == 0);
 
-  int rc = rename(mutt_buffer_string(path), mutt_buffer_string(newpath));
-  mutt_buffer_pool_release(&path);
-  mutt_buffer_pool_release(&newpath);
+done:
+  mutt_buffer_pool_release(&src);
+  mutt_buffer_pool_release(&dst);
+  return rc;
+}
+
+/**
+ * bcache_migrate_dir - Move all the messages in a directory
+ * @param bcache Body Cache
+ * @param dir    Directory containing the messages
+ * @param shard  true to move the messages into their shards
+ * @retval true Success
+ */
+static bool bcache_migrate_dir(struct BodyCache *bcache, const char *dir, bool shard)
+{
+  DIR *d = opendir(dir);
+  if (!d)
+    return (errno == ENOENT);
+
+  bool rc = true;
+  struct dirent *de = NULL;
+  while ((de = readdir(d)))
+  {
+    if (de->d_name[0] == '.')
+      continue;
+
+    if (!bcache_migrate_file(bcache, dir, de->d_name, shard))
+      rc = false;
+  }
+
+  closedir(d);
   return rc;
 }
 
+/**
+ * bcache_migrate - Convert a Body Cache to the configured layout
+ * @param bcache Body Cache
+ *
+ * Moving a message doesn't change its id, so the index stays valid.
+ * The layout only changes once every message has been moved.  If that fails,
+ * the conversion is tried again when the cache is next opened.
+ */
+static void bcache_migrate(struct BodyCache *bcache)
+{
+  const bool c_message_cache_sharded = cs_subset_bool(NeoMutt->sub, "message_cache_sharded");
+
+  struct Buffer *marker = mutt_buffer_pool_get();
+  mutt_buffer_printf(marker, "%s%s", bcache->path, BCACHE_SHARDED);
+
+  struct stat st;
+  bcache->sharded = (stat(mutt_buffer_string(marker), &st) == 0);
+  if (bcache->sharded == c_message_cache_sharded)
+    goto done;
+
+  if (stat(bcache->path, &st) != 0)
+  {
+    /* no cache yet, mutt_bcache_put() will create it */
+    bcache->sharded = c_message_cache_sharded;
+    goto done;
+  }
+
+  mutt_debug(LL_DEBUG1, "bcache: %s shards: %s\n",
+             c_message_cache_sharded ? "creating" : "removing", bcache->path);
+
+  if (c_message_cache_sharded)
+  {
+    if (bcache_migrate_dir(bcache, bcache->path, true))
+    {
+      FILE *fp = mutt_file_fopen(mutt_buffer_string(marker), "w");
+      bcache->sharded = fp && (mutt_file_fclose(&fp) == 0);
+    }
+  }
+  else
+  {
+    bool ok = true;
+    struct Buffer *dir = mutt_buffer_pool_get();
+    for (int i = 0; i < BCACHE_SHARDS; i++)
+    {
+      mutt_buffer_printf(dir, "%s.%02x/", bcache->path, i);
+      if (bcache_migrate_dir(bcache, mutt_buffer_string(dir), false))
+        rmdir(mutt_buffer_string(dir));
+      else
+        ok = false;
+    }
+    mutt_buffer_pool_release(&dir);
+
+    if (ok && (unlink(mutt_buffer_string(marker)) == 0))
+      bcache->sharded = false;
+  }
+
+done:
+  mutt_buffer_pool_release(&marker);
+}
+
 /**
  * mutt_bcache_open - Open an Email-Body Cache
  * @param account current mailbox' account (required)
@@ -146,12 +617,23 @@ struct BodyCache *mutt_bcache_open(struct ConnAccount *account, const char *mail
     return NULL;
 
   struct BodyCache *bcache = mutt_mem_calloc(1, sizeof(struct BodyCache));
+  STAILQ_INIT(&bcache->evict);
   if (bcache_path(account, mailbox, bcache) < 0)
   {
     mutt_bcache_close(&bcache);
     return NULL;
   }
 
+  /* an index that isn't kept up to date would be wrong when it's next used */
+  if (bcache_max_size() == 0)
+  {
+    struct Buffer *path = mutt_buffer_pool_get();
+    mutt_buffer_printf(path, "%s%s", bcache->path, BCACHE_INDEX);
+    unlink(mutt_buffer_string(path));
+    mutt_buffer_pool_release(&path);
+  }
+
+  bcache_migrate(bcache);
   return bcache;
 }
 
@@ -165,6 +647,8 @@ void mutt_bcache_close(struct BodyCache **bcache)
 {
   if (!bcache || !*bcache)
     return;
+  bcache_evict_wait(*bcache);
+  mutt_hash_free(&(*bcache)->index);
   FREE(&(*bcache)->path);
   FREE(bcache);
 }
@@ -182,14 +666,31 @@ FILE *mutt_bcache_get(struct BodyCache *bcache, const char *id)
     return NULL;
 
   struct Buffer *path = mutt_buffer_pool_get();
-  mutt_buffer_addstr(path, bcache->path);
-  mutt_buffer_addstr(path, id);
+  bcache_file(bcache, id, NULL, path);
 
   FILE *fp = mutt_file_fopen(mutt_buffer_string(path), "r");
 
   mutt_debug(LL_DEBUG3, "bcache: get: '%s': %s\n", mutt_buffer_string(path),
              fp ? "yes" : "no");
 
+  /* record the use, but not more than once a minute */
+  if (fp && bcache_index_load(bcache))
+  {
+    const time_t now = mutt_date_epoch();
+    struct BcacheEntry *be = mutt_hash_find(bcache->index, id);
+    struct stat st;
+    if (be && ((now - be->atime) >= 60))
+    {
+      be->atime = now;
+      bcache_index_append(bcache, 1, "+ %ld %ld %s\n", (long) now, (long) be->size, id);
+    }
+    else if (!be && (fstat(fileno(fp), &st) == 0))
+    {
+      bcache_index_set(bcache, id, st.st_size, now);
+      bcache_index_append(bcache, 1, "+ %ld %ld %s\n", (long) now, (long) st.st_size, id);
+    }
+  }
+
   mutt_buffer_pool_release(&path);
   return fp;
 }
@@ -209,8 +710,11 @@ FILE *mutt_bcache_put(struct BodyCache *bcache, const char *id)
   if (!id || (*id == '\0') || !bcache)
     return NULL;
 
+  /* the message may have just been evicted */
+  bcache_evict_wait(bcache);
+
   struct Buffer *path = mutt_buffer_pool_get();
-  mutt_buffer_printf(path, "%s%s%s", bcache->path, id, ".tmp");
+  bcache_file(bcache, id, ".tmp", path);
 
   struct stat sb;
   if (stat(bcache->path, &sb) == 0)
@@ -228,6 +732,27 @@ FILE *mutt_bcache_put(struct BodyCache *bcache, const char *id)
       mutt_error(_("Can't create %s: %s"), bcache->path, strerror(errno));
       return NULL;
     }
+
+    if (bcache->sharded)
+    {
+      struct Buffer *marker = mutt_buffer_pool_get();
+      mutt_buffer_printf(marker, "%s%s", bcache->path, BCACHE_SHARDED);
+      FILE *fp = mutt_file_fopen(mutt_buffer_string(marker), "w");
+      mutt_file_fclose(&fp);
+      mutt_buffer_pool_release(&marker);
+    }
+  }
+
+  if (bcache->sharded)
+  {
+    struct Buffer *dir = mutt_buffer_pool_get();
+    mutt_buffer_strcpy(dir, mutt_buffer_string(path));
+    char *slash = strrchr(dir->data, '/');
+    *slash = '\0';
+    const int rc = mkdir(mutt_buffer_string(dir), S_IRWXU | S_IRWXG | S_IRWXO);
+    if ((rc != 0) && (errno != EEXIST))
+      mutt_error(_("Can't create %s: %s"), mutt_buffer_string(dir), strerror(errno));
+    mutt_buffer_pool_release(&dir);
   }
 
   mutt_debug(LL_DEBUG3, "bcache: put: '%s'\n", path);
@@ -246,11 +771,35 @@ FILE *mutt_bcache_put(struct BodyCache *bcache, const char *id)
  */
 int mutt_bcache_commit(struct BodyCache *bcache, const char *id)
 {
-  struct Buffer *tmpid = mutt_buffer_pool_get();
-  mutt_buffer_printf(tmpid, "%s.tmp", id);
+  if (!bcache || !id || (*id == '\0'))
+    return -1;
+
+  struct Buffer *tmp = mutt_buffer_pool_get();
+  struct Buffer *path = mutt_buffer_pool_get();
+  bcache_file(bcache, id, ".tmp", tmp);
+  bcache_file(bcache, id, NULL, path);
+
+  mutt_debug(LL_DEBUG3, "bcache: mv: '%s' '%s'\n", mutt_buffer_string(tmp),
+             mutt_buffer_string(path));
+
+  int rc = rename(mutt_buffer_string(tmp), mutt_buffer_string(path));
+  mutt_buffer_pool_release(&tmp);
+  if ((rc != 0) || !bcache_index_load(bcache))
+  {
+    mutt_buffer_pool_release(&path);
+    return rc;
+  }
+
+  struct stat st;
+  if (stat(mutt_buffer_string(path), &st) == 0)
+  {
+    const time_t now = mutt_date_epoch();
+    bcache_index_set(bcache, id, st.st_size, now);
+    bcache_index_append(bcache, 1, "+ %ld %ld %s\n", (long) now, (long) st.st_size, id);
+    bcache_evict(bcache, id);
+  }
+  mutt_buffer_pool_release(&path);
 
-  int rc = mutt_bcache_move(bcache, mutt_buffer_string(tmpid), id);
-  mutt_buffer_pool_release(&tmpid);
   return rc;
 }
 
@@ -267,13 +816,16 @@ int mutt_bcache_del(struct BodyCache *bcache, const char *id)
     return -1;
 
   struct Buffer *path = mutt_buffer_pool_get();
-  mutt_buffer_addstr(path, bcache->path);
-  mutt_buffer_addstr(path, id);
+  bcache_file(bcache, id, NULL, path);
 
   mutt_debug(LL_DEBUG3, "bcache: del: '%s'\n", mutt_buffer_string(path));
 
   int rc = unlink(mutt_buffer_string(path));
   mutt_buffer_pool_release(&path);
+
+  if (bcache_index_load(bcache) && bcache_index_unset(bcache, id))
+    bcache_index_append(bcache, 1, "- %s\n", id);
+
   return rc;
 }
 
@@ -290,8 +842,7 @@ int mutt_bcache_exists(struct BodyCache *bcache, const char *id)
     return -1;
 
   struct Buffer *path = mutt_buffer_pool_get();
-  mutt_buffer_addstr(path, bcache->path);
-  mutt_buffer_addstr(path, id);
+  bcache_file(bcache, id, NULL, path);
 
   int rc = 0;
   struct stat st;
@@ -307,6 +858,58 @@ int mutt_bcache_exists(struct BodyCache *bcache, const char *id)
   return rc;
 }
 
+/**
+ * bcache_list_dir - Find matching entries in one directory of the Body Cache
+ * @param[in]  bcache  Body Cache
+ * @param[in]  dir     Directory to search
+ * @param[in]  want_id Callback function called for each match
+ * @param[in]  data    Data to pass to the callback function
+ * @param[out] count   Count of matching items, -1 on failure
+ * @retval true The listing should continue
+ */
+static bool bcache_list_dir(struct BodyCache *bcache, const char *dir,
+                            bcache_list_t want_id, void *data, int *count)
+{
+  DIR *d = opendir(dir);
+  if (!d)
+  {
+    /* shards are only created when they're needed */
+    if (bcache->sharded && (errno == ENOENT))
+      return true;
+    *count = -1;
+    return false;
+  }
+
+  mutt_debug(LL_DEBUG3, "bcache: list: dir: '%s'\n", dir);
+
+  bool rc = true;
+  struct dirent *de = NULL;
+  while ((de = readdir(d)))
+  {
+    if (mutt_str_startswith(de->d_name, ".") || mutt_str_startswith(de->d_name, ".."))
+    {
+      continue;
+    }
+
+    mutt_debug(LL_DEBUG3, "bcache: list: dir: '%s', id :'%s'\n", dir, de->d_name);
+
+    if (want_id && (want_id(de->d_name, bcache, data) != 0))
+    {
+      rc = false;
+      break;
+    }
+
+    (*count)++;
+  }
+
+  if (closedir(d) < 0)
+  {
+    *count = -1;
+    rc = false;
+  }
+  return rc;
+}
+
 /**
  * mutt_bcache_list - Find matching entries in the Body Cache
  * @param bcache Body Cache from mutt_bcache_open()
@@ -328,38 +931,26 @@ int mutt_bcache_exists(struct BodyCache *bcache, const char *id)
  */
 int mutt_bcache_list(struct BodyCache *bcache, bcache_list_t want_id, void *data)
 {
-  DIR *d = NULL;
-  struct dirent *de = NULL;
-  int rc = -1;
-
-  if (!bcache || !(d = opendir(bcache->path)))
-    goto out;
-
-  rc = 0;
-
-  mutt_debug(LL_DEBUG3, "bcache: list: dir: '%s'\n", bcache->path);
+  if (!bcache)
+    return -1;
 
-  while ((de = readdir(d)))
+  int rc = 0;
+  if (bcache->sharded)
   {
-    if (mutt_str_startswith(de->d_name, ".") || mutt_str_startswith(de->d_name, ".."))
+    struct Buffer *dir = mutt_buffer_pool_get();
+    for (int i = 0; (i < BCACHE_SHARDS) && (rc >= 0); i++)
     {
-      continue;
+      mutt_buffer_printf(dir, "%s.%02x/", bcache->path, i);
+      if (!bcache_list_dir(bcache, mutt_buffer_string(dir), want_id, data, &rc))
+        break;
     }
-
-    mutt_debug(LL_DEBUG3, "bcache: list: dir: '%s', id :'%s'\n", bcache->path, de->d_name);
-
-    if (want_id && (want_id(de->d_name, bcache, data) != 0))
-      goto out;
-
-    rc++;
+    mutt_buffer_pool_release(&dir);
   }
-
-out:
-  if (d)
+  else
   {
-    if (closedir(d) < 0)
-      rc = -1;
+    bcache_list_dir(bcache, bcache->path, want_id, data, &rc);
   }
+
   mutt_debug(LL_DEBUG3, "bcache: list: did %d entries\n", rc);
   return rc;
 }
@@ -664,6 +664,30 @@ static void add_folder(struct Menu *menu, struct BrowserState *state,
   ARRAY_ADD(&state->entry, ff);
 }
 
+/**
+ * struct BrowserStat - A directory entry waiting to be examined
+ */
+struct BrowserStat
+{
+  char *name;     ///< Name of the entry
+  char *path;     ///< Full path of the entry
+  struct stat st; ///< Result of lstat()
+  bool ok;        ///< Did lstat() succeed?
+};
+ARRAY_HEAD(BrowserStatArray, struct BrowserStat);
+
+/**
+ * browser_stat_run - Examine a directory entry - Implements ::worker_task_t
+ *
+ * On a network filesystem, each lstat() can take a while, so they're done in
+ * parallel.
+ */
+static void browser_stat_run(void *item)
+{
+  struct BrowserStat *bs = item;
+  bs->ok = (lstat(bs->path, &bs->st) == 0);
+}
+
 /**
  * init_state - Initialise a browser state
  * @param state BrowserState to initialise
@@ -759,8 +783,7 @@ static int examine_directory(struct Mailbox *m, struct Menu *menu,
 
     init_state(state, menu);
 
-    struct MailboxList ml = STAILQ_HEAD_INITIALIZER(ml);
-    neomutt_mailboxlist_get_all(&ml, NeoMutt, MUTT_MAILBOX_ANY);
+    struct BrowserStatArray entries = ARRAY_HEAD_INITIALIZER;
     while ((de = readdir(dp)))
     {
       if (mutt_str_equal(de->d_name, "."))
@@ -777,31 +800,58 @@ static int examine_directory(struct Mailbox *m, struct Menu *menu,
       }
 
       mutt_buffer_concat_path(buf, d, de->d_name);
-      if (lstat(mutt_buffer_string(buf), &s) == -1)
+      struct BrowserStat bs = { 0 };
+      bs.name = mutt_str_dup(de->d_name);
+      bs.path = mutt_buffer_strdup(buf);
+      ARRAY_ADD(&entries, bs);
+    }
+    closedir(dp);
+
+    if (!ARRAY_EMPTY(&entries))
+    {
+      mutt_worker_run(browser_stat_run, ARRAY_GET(&entries, 0),
+                      sizeof(struct BrowserStat), ARRAY_SIZE(&entries));
+    }
+
+    /* Look up the mailboxes by path, the first one wins */
+    struct MailboxList ml = STAILQ_HEAD_INITIALIZER(ml);
+    neomutt_mailboxlist_get_all(&ml, NeoMutt, MUTT_MAILBOX_ANY);
+    struct HashTable *mailboxes = mutt_hash_new(128, MUTT_HASH_NO_FLAGS);
+    struct MailboxNode *np = NULL;
+    STAILQ_FOREACH(np, &ml, entries)
+    {
+      mutt_hash_insert(mailboxes, mailbox_path(np->mailbox), np->mailbox);
+    }
+
+    struct BrowserStat *bs = NULL;
+    ARRAY_FOREACH(bs, &entries)
+    {
+      if (!bs->ok)
         continue;
 
       /* No size for directories or symlinks */
-      if (S_ISDIR(s.st_mode) || S_ISLNK(s.st_mode))
-        s.st_size = 0;
-      else if (!S_ISREG(s.st_mode))
+      if (S_ISDIR(bs->st.st_mode) || S_ISLNK(bs->st.st_mode))
+        bs->st.st_size = 0;
+      else if (!S_ISREG(bs->st.st_mode))
         continue;
 
-      struct MailboxNode *np = NULL;
-      STAILQ_FOREACH(np, &ml, entries)
+      struct Mailbox *m_entry = mutt_hash_find(mailboxes, bs->path);
+      if (m_entry && m && mutt_str_equal(m_entry->realpath, m->realpath))
       {
-        if (mutt_str_equal(mutt_buffer_string(buf), mailbox_path(np->mailbox)))
-          break;
+        m_entry->msg_count = m->msg_count;
+        m_entry->msg_unread = m->msg_unread;
       }
+      add_folder(menu, state, bs->name, NULL, &bs->st, m_entry, NULL);
+    }
 
-      if (np && m && mutt_str_equal(np->mailbox->realpath, m->realpath))
-      {
-        np->mailbox->msg_count = m->msg_count;
-        np->mailbox->msg_unread = m->msg_unread;
-      }
-      add_folder(menu, state, de->d_name, NULL, &s, np ? np->mailbox : NULL, NULL);
+    ARRAY_FOREACH(bs, &entries)
+    {
+      FREE(&bs->name);
+      FREE(&bs->path);
     }
+    ARRAY_FREE(&entries);
+    mutt_hash_free(&mailboxes);
     neomutt_mailboxlist_clear(&ml);
-    closedir(dp);
   }
   browser_sort(state);
   rc = 0;
@@ -46,6 +46,7 @@
 #include "imap/lib.h"
 #include "init.h"
 #include "keymap.h"
+#include "mailcap.h"
 #include "monitor.h"
 #include "mutt_commands.h"
 #include "mutt_globals.h"
@@ -53,6 +54,7 @@
 #include "mx.h"
 #include "myvar.h"
 #include "options.h"
+#include "rc_cache.h"
 #include "version.h"
 #ifdef ENABLE_NLS
 #include <libintl.h>
@@ -147,6 +149,7 @@ int source_rc(const char *rcfile_path, struct Buffer *err)
   char rcfile[PATH_MAX];
   size_t linelen = 0;
   pid_t pid;
+  char digest[33] = { 0 };
 
   mutt_str_copy(rcfile, rcfile_path, sizeof(rcfile));
 
@@ -190,9 +193,17 @@ int source_rc(const char *rcfile_path, struct Buffer *err)
     return -1;
   }
 
+  /* A file that's unchanged since it was last read cleanly can be trusted */
+  const bool trusted = OptRcTrusted;
+  OptRcTrusted = !ispipe && rc_cache_check(rcfile, digest);
+
   token = mutt_buffer_pool_get();
   linebuf = mutt_buffer_pool_get();
 
+  /* Commands like 'alternates' make the Index reset every Email, so only do
+   * that once for the whole file */
+  notify_batch_begin(NeoMutt->notify);
+
   while ((line = mutt_file_read_line(line, &linelen, fp, &lineno, MUTT_RL_CONT)) != NULL)
   {
     const char *const c_config_charset =
@@ -247,6 +258,11 @@ int source_rc(const char *rcfile_path, struct Buffer *err)
   if (pid != -1)
     filter_wait(pid);
 
+  notify_batch_end(NeoMutt->notify);
+
+  OptRcTrusted = trusted;
+  rc_cache_update(rcfile, digest, (rc == 0) && (warnings == 0));
+
   if (rc)
   {
     /* the neomuttrc source keyword */
@@ -479,12 +495,24 @@ enum CommandResult parse_ifdef(struct Buffer *buf, struct Buffer *s,
   return MUTT_CMD_SUCCESS;
 }
 
+/**
+ * parse_hdr_order - Parse the 'hdr_order' command - Implements Command::parse()
+ */
+enum CommandResult parse_hdr_order(struct Buffer *buf, struct Buffer *s,
+                                   intptr_t data, struct Buffer *err)
+{
+  mutt_prefixset_free(&HeaderOrderSet);
+  return parse_stailq(buf, s, data, err);
+}
+
 /**
  * parse_ignore - Parse the 'ignore' command - Implements Command::parse()
  */
 enum CommandResult parse_ignore(struct Buffer *buf, struct Buffer *s,
                                 intptr_t data, struct Buffer *err)
 {
+  mutt_prefixset_free(&IgnoreSet);
+  mutt_prefixset_free(&UnIgnoreSet);
   do
   {
     mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
@@ -590,6 +618,7 @@ enum CommandResult parse_mailboxes(struct Buffer *buf, struct Buffer *s,
         if (rename)
         {
           mutt_str_replace(&m_old->name, m->name);
+          account_mailbox_rehash(a);
         }
 
         mailbox_free(&m);
@@ -1100,6 +1129,9 @@ enum CommandResult parse_setenv(struct Buffer *buf, struct Buffer *s,
     return MUTT_CMD_WARNING;
   }
 
+  /* the mailcap tests may depend on the environment */
+  mailcap_cache_free();
+
   if (unset)
   {
     if (mutt_envlist_unset(buf->data))
@@ -1411,12 +1443,24 @@ enum CommandResult parse_tag_transforms(struct Buffer *buf, struct Buffer *s,
   return MUTT_CMD_SUCCESS;
 }
 
+/**
+ * parse_unhdr_order - Parse the 'unhdr_order' command - Implements Command::parse()
+ */
+enum CommandResult parse_unhdr_order(struct Buffer *buf, struct Buffer *s,
+                                     intptr_t data, struct Buffer *err)
+{
+  mutt_prefixset_free(&HeaderOrderSet);
+  return parse_unstailq(buf, s, data, err);
+}
+
 /**
  * parse_unignore - Parse the 'unignore' command - Implements Command::parse()
  */
 enum CommandResult parse_unignore(struct Buffer *buf, struct Buffer *s,
                                   intptr_t data, struct Buffer *err)
 {
+  mutt_prefixset_free(&IgnoreSet);
+  mutt_prefixset_free(&UnIgnoreSet);
   do
   {
     mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
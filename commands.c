@@ -190,6 +190,24 @@ static void process_protected_headers(struct Mailbox *m, struct Email *e)
 #endif
 }
 
+#ifdef USE_IMAP
+/**
+ * partial_email_new - Parse a message that was only partly downloaded
+ * @param fp File containing the message
+ * @retval ptr New Email, only good for display
+ */
+static struct Email *partial_email_new(FILE *fp)
+{
+  struct Email *e = email_new();
+  e->env = mutt_rfc822_read_header(fp, e, false, false);
+  fseeko(fp, 0, SEEK_END);
+  e->body->length = ftello(fp) - e->body->offset;
+  mutt_parse_part(fp, e->body);
+  rewind(fp);
+  return e;
+}
+#endif
+
 /**
  * mutt_display_message - Display a message in the pager
  * @param win_index Index Window
@@ -211,9 +229,19 @@ int mutt_display_message(struct MuttWindow *win_index, struct MuttWindow *win_ib
   CopyHeaderFlags chflags;
   pid_t filterpid = -1;
   struct Buffer *tempfile = NULL;
+  FILE *fp_partial = NULL;
+  struct Email *e_partial = NULL;
   int res;
 
-  mutt_parse_mime_message(m, e);
+#ifdef USE_IMAP
+  /* A large message might be displayable without its attachments */
+  if ((m->type == MUTT_IMAP) && !e->body->parts)
+    fp_partial = imap_msg_open_partial(m, e);
+  if (fp_partial)
+    e_partial = partial_email_new(fp_partial);
+  else
+#endif
+    mutt_parse_mime_message(m, e);
   mutt_message_hook(m, e, MUTT_MESSAGE_HOOK);
 
   char columns[16];
@@ -308,7 +336,13 @@ int mutt_display_message(struct MuttWindow *win_index, struct MuttWindow *win_ib
   if (m->type == MUTT_NOTMUCH)
     chflags |= CH_VIRTUAL;
 #endif
-  res = mutt_copy_message(fp_out, m, e, cmflags, chflags, win_index->state.cols);
+  if (e_partial)
+  {
+    res = mutt_copy_message_fp(fp_out, fp_partial, e_partial, cmflags, chflags,
+                               win_index->state.cols);
+  }
+  else
+    res = mutt_copy_message(fp_out, m, e, cmflags, chflags, win_index->state.cols);
 
   if (((mutt_file_fclose(&fp_out) != 0) && (errno != EPIPE)) || (res < 0))
   {
@@ -327,7 +361,8 @@ int mutt_display_message(struct MuttWindow *win_index, struct MuttWindow *win_ib
 
   mutt_file_fclose(&fp_filter_out); /* XXX - check result? */
 
-  if (WithCrypto)
+  /* A partly downloaded message is never signed or encrypted */
+  if (WithCrypto && !e_partial)
   {
     /* update crypto information for this message */
     e->security &= ~(SEC_GOODSIGN | SEC_BADSIGN);
@@ -407,6 +442,8 @@ int mutt_display_message(struct MuttWindow *win_index, struct MuttWindow *win_ib
 cleanup:
   mutt_envlist_unset("COLUMNS");
   mutt_buffer_pool_release(&tempfile);
+  email_free(&e_partial);
+  mutt_file_fclose(&fp_partial);
   return rc;
 }
 
@@ -1255,6 +1292,7 @@ int mutt_save_message(struct Mailbox *m, struct EmailList *el,
     if (m->type == MUTT_NOTMUCH)
       nm_db_longrun_init(m, true);
 #endif
+    mx_msg_append_batch(ctx_save->mailbox, true);
     STAILQ_FOREACH(en, el, entries)
     {
       mutt_progress_update(&progress, ++tagged_progress_count, -1);
@@ -1278,6 +1316,8 @@ int mutt_save_message(struct Mailbox *m, struct EmailList *el,
       }
 #endif
     }
+    if ((mx_msg_append_batch(ctx_save->mailbox, false) != 0) && (rc == 0))
+      rc = -1;
 #ifdef USE_NOTMUCH
     if (m->type == MUTT_NOTMUCH)
       nm_db_longrun_done(m);
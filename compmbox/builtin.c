@@ -0,0 +1,295 @@
+/**
+ * @file
+ * Built-in compression formats
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page compmbox_builtin Built-in compression formats
+ *
+ * If NeoMutt is built with zlib or Zstandard, gzip and zstd compressed
+ * mailboxes can be read and written without running any external commands.
+ * The file is recognised by its first few bytes.
+ *
+ * The data is streamed between the files, so a big mailbox is never held in
+ * memory.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "mutt/lib.h"
+#include "private.h"
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+/// Size of the buffers used to copy the data
+#define COMP_BUILTIN_BUFSIZE (64 * 1024)
+
+#ifdef USE_ZLIB
+/**
+ * gzip_decompress - Decompress a gzip file - Implements CompBuiltin::decompress()
+ */
+static bool gzip_decompress(const char *from, const char *to)
+{
+  gzFile gz = gzopen(from, "rb");
+  if (!gz)
+    return false;
+
+  FILE *fp = mutt_file_fopen(to, "w");
+  if (!fp)
+  {
+    gzclose(gz);
+    return false;
+  }
+
+  char *buf = mutt_mem_malloc(COMP_BUILTIN_BUFSIZE);
+  bool rc = true;
+  int len;
+  while ((len = gzread(gz, buf, COMP_BUILTIN_BUFSIZE)) > 0)
+  {
+    if (fwrite(buf, 1, len, fp) != (size_t) len)
+    {
+      rc = false;
+      break;
+    }
+  }
+  if (len < 0)
+    rc = false;
+
+  FREE(&buf);
+  if (gzclose(gz) != Z_OK)
+    rc = false;
+  if (mutt_file_fclose(&fp) != 0)
+    rc = false;
+  return rc;
+}
+
+/**
+ * gzip_compress - Compress a file with gzip - Implements CompBuiltin::compress()
+ */
+static bool gzip_compress(const char *from, const char *to, bool append)
+{
+  FILE *fp = mutt_file_fopen(from, "r");
+  if (!fp)
+    return false;
+
+  gzFile gz = gzopen(to, append ? "ab" : "wb");
+  if (!gz)
+  {
+    mutt_file_fclose(&fp);
+    return false;
+  }
+
+  char *buf = mutt_mem_malloc(COMP_BUILTIN_BUFSIZE);
+  bool rc = true;
+  size_t len;
+  while ((len = fread(buf, 1, COMP_BUILTIN_BUFSIZE, fp)) > 0)
+  {
+    if (gzwrite(gz, buf, len) != (int) len)
+    {
+      rc = false;
+      break;
+    }
+  }
+  if (ferror(fp))
+    rc = false;
+
+  FREE(&buf);
+  if (gzclose(gz) != Z_OK)
+    rc = false;
+  mutt_file_fclose(&fp);
+  return rc;
+}
+
+/// Start of a gzip file, RFC1952
+static const unsigned char GzipMagic[] = { 0x1f, 0x8b };
+#endif
+
+#ifdef USE_ZSTD
+/**
+ * zstd_decompress - Decompress a zstd file - Implements CompBuiltin::decompress()
+ *
+ * The file may contain several frames, e.g. after appending.
+ */
+static bool zstd_decompress(const char *from, const char *to)
+{
+  FILE *fp_in = mutt_file_fopen(from, "r");
+  if (!fp_in)
+    return false;
+
+  FILE *fp_out = mutt_file_fopen(to, "w");
+  if (!fp_out)
+  {
+    mutt_file_fclose(&fp_in);
+    return false;
+  }
+
+  ZSTD_DCtx *dctx = ZSTD_createDCtx();
+  const size_t in_size = ZSTD_DStreamInSize();
+  const size_t out_size = ZSTD_DStreamOutSize();
+  void *in_buf = mutt_mem_malloc(in_size);
+  void *out_buf = mutt_mem_malloc(out_size);
+
+  bool rc = (dctx != NULL);
+  size_t last = 0;
+  size_t len;
+  while (rc && ((len = fread(in_buf, 1, in_size, fp_in)) > 0))
+  {
+    ZSTD_inBuffer input = { in_buf, len, 0 };
+    ZSTD_outBuffer output = { out_buf, out_size, 0 };
+    do
+    {
+      output.pos = 0;
+      last = ZSTD_decompressStream(dctx, &output, &input);
+      if (ZSTD_isError(last) || (fwrite(out_buf, 1, output.pos, fp_out) != output.pos))
+      {
+        rc = false;
+        break;
+      }
+      /* a full output buffer may mean there's more to come */
+    } while ((input.pos < input.size) || (output.pos == output.size));
+  }
+
+  /* a truncated file ends in the middle of a frame */
+  if (ferror(fp_in) || (last != 0))
+    rc = false;
+
+  FREE(&in_buf);
+  FREE(&out_buf);
+  ZSTD_freeDCtx(dctx);
+  mutt_file_fclose(&fp_in);
+  if (mutt_file_fclose(&fp_out) != 0)
+    rc = false;
+  return rc;
+}
+
+/**
+ * zstd_compress - Compress a file with zstd - Implements CompBuiltin::compress()
+ */
+static bool zstd_compress(const char *from, const char *to, bool append)
+{
+  FILE *fp_in = mutt_file_fopen(from, "r");
+  if (!fp_in)
+    return false;
+
+  FILE *fp_out = mutt_file_fopen(to, append ? "a" : "w");
+  if (!fp_out)
+  {
+    mutt_file_fclose(&fp_in);
+    return false;
+  }
+
+  ZSTD_CCtx *cctx = ZSTD_createCCtx();
+  const size_t in_size = ZSTD_CStreamInSize();
+  const size_t out_size = ZSTD_CStreamOutSize();
+  void *in_buf = mutt_mem_malloc(in_size);
+  void *out_buf = mutt_mem_malloc(out_size);
+
+  bool rc = (cctx != NULL);
+  if (rc)
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+
+  bool finished = false;
+  while (rc && !finished)
+  {
+    const size_t len = fread(in_buf, 1, in_size, fp_in);
+    if (ferror(fp_in))
+    {
+      rc = false;
+      break;
+    }
+    finished = (len < in_size);
+    const ZSTD_EndDirective mode = finished ? ZSTD_e_end : ZSTD_e_continue;
+
+    ZSTD_inBuffer input = { in_buf, len, 0 };
+    size_t remaining;
+    do
+    {
+      ZSTD_outBuffer output = { out_buf, out_size, 0 };
+      remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+      if (ZSTD_isError(remaining) ||
+          (fwrite(out_buf, 1, output.pos, fp_out) != output.pos))
+      {
+        rc = false;
+        break;
+      }
+    } while (finished ? (remaining != 0) : (input.pos < input.size));
+  }
+
+  FREE(&in_buf);
+  FREE(&out_buf);
+  ZSTD_freeCCtx(cctx);
+  mutt_file_fclose(&fp_in);
+  if (mutt_file_fclose(&fp_out) != 0)
+    rc = false;
+  return rc;
+}
+
+/// Start of a zstd frame, RFC8878
+static const unsigned char ZstdMagic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+#endif
+
+/**
+ * CompBuiltins - Compression formats that NeoMutt can read itself
+ */
+static const struct CompBuiltin CompBuiltins[] = {
+  // clang-format off
+#ifdef USE_ZLIB
+  { "gzip", GzipMagic, sizeof(GzipMagic), gzip_decompress, gzip_compress },
+#endif
+#ifdef USE_ZSTD
+  { "zstd", ZstdMagic, sizeof(ZstdMagic), zstd_decompress, zstd_compress },
+#endif
+  { NULL, NULL, 0, NULL, NULL },
+  // clang-format on
+};
+
+/**
+ * comp_builtin_find - Find the built-in format of a file
+ * @param path Path of the file
+ * @retval ptr  Format of the file
+ * @retval NULL The file isn't in a built-in format, or can't be read
+ */
+const struct CompBuiltin *comp_builtin_find(const char *path)
+{
+  if (!path || !CompBuiltins[0].name)
+    return NULL;
+
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+    return NULL;
+
+  unsigned char magic[8] = { 0 };
+  const size_t len = fread(magic, 1, sizeof(magic), fp);
+  mutt_file_fclose(&fp);
+
+  for (const struct CompBuiltin *cb = CompBuiltins; cb->name; cb++)
+  {
+    if ((len >= cb->magic_len) && (memcmp(magic, cb->magic, cb->magic_len) == 0))
+      return cb;
+  }
+
+  return NULL;
+}
@@ -30,19 +30,26 @@
  * Any references to compressed files also apply to encrypted files.
  * - mailbox->path     == plaintext file
  * - mailbox->realpath == compressed file
+ *
+ * Files in a built-in format, see @ref compmbox_builtin, don't need any hooks.
+ * The hooks take precedence, if they match.
  */
 
 #include "config.h"
+#include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 #include "mutt/lib.h"
 #include "config/lib.h"
 #include "core/lib.h"
 #include "gui/lib.h"
 #include "lib.h"
+#include "private.h"
 #include "format_flags.h"
 #include "hook.h"
 #include "mutt_commands.h"
@@ -135,9 +142,163 @@ static void unlock_realpath(struct Mailbox *m)
   mutt_file_fclose(&ci->fp_lock);
 }
 
+/**
+ * cache_path - Get the path of a file in $compress_cache
+ * @param m      Mailbox
+ * @param suffix Type of file, e.g. "mbox"
+ * @param buf    Buffer for the path
+ * @retval true $compress_cache is set
+ *
+ * The files are named after a hash of the compressed file's path.
+ */
+static bool cache_path(const struct Mailbox *m, const char *suffix, struct Buffer *buf)
+{
+  const char *const c_compress_cache = cs_subset_path(NeoMutt->sub, "compress_cache");
+  if (!c_compress_cache || !m->realpath)
+    return false;
+
+  unsigned char digest[16];
+  char hash[33];
+  mutt_md5(m->realpath, digest);
+  mutt_md5_toascii(digest, hash);
+  mutt_buffer_printf(buf, "%s/%s.%s", c_compress_cache, hash, suffix);
+  return true;
+}
+
+/**
+ * cache_stamp - Identify the current state of the compressed file
+ * @param m      Mailbox
+ * @param buf    Buffer for the stamp
+ * @param buflen Length of the buffer
+ * @retval true Success
+ */
+static bool cache_stamp(const struct Mailbox *m, char *buf, size_t buflen)
+{
+  struct stat st = { 0 };
+  if (stat(m->realpath, &st) != 0)
+    return false;
+
+  struct timespec ts = { 0 };
+  mutt_file_get_stat_timespec(&ts, &st, MUTT_STAT_MTIME);
+  snprintf(buf, buflen, "%llu %lld %lld %ld\n", (unsigned long long) st.st_ino,
+           (long long) st.st_size, (long long) ts.tv_sec, ts.tv_nsec);
+  return true;
+}
+
+/**
+ * cache_forget - Mark the decompressed copy as out of date
+ * @param m Mailbox
+ */
+static void cache_forget(struct Mailbox *m)
+{
+  struct Buffer *buf = mutt_buffer_pool_get();
+  if (cache_path(m, "stamp", buf))
+    unlink(mutt_buffer_string(buf));
+  mutt_buffer_pool_release(&buf);
+}
+
+/**
+ * cache_save_stamp - Record that the decompressed copy matches the compressed file
+ * @param m Mailbox
+ */
+static void cache_save_stamp(struct Mailbox *m)
+{
+  char stamp[128];
+  struct Buffer *buf = mutt_buffer_pool_get();
+  if (cache_path(m, "stamp", buf) && cache_stamp(m, stamp, sizeof(stamp)))
+  {
+    FILE *fp = mutt_file_fopen(mutt_buffer_string(buf), "w");
+    if (fp)
+    {
+      fputs(stamp, fp);
+      if (mutt_file_fclose(&fp) != 0)
+        unlink(mutt_buffer_string(buf));
+    }
+  }
+  mutt_buffer_pool_release(&buf);
+}
+
+/**
+ * cache_open - Use the decompressed copy of an unchanged Mailbox
+ * @param m Mailbox
+ * @retval true The copy is up to date, the Mailbox doesn't need decompressing
+ *
+ * If the copy can be used, the temporary file is removed and the Mailbox's
+ * path is set to the copy.
+ */
+static bool cache_open(struct Mailbox *m)
+{
+  struct CompressInfo *ci = m->compress_info;
+  struct Buffer *path = mutt_buffer_pool_get();
+  struct Buffer *stamp_path = mutt_buffer_pool_get();
+  bool rc = false;
+
+  if (!cache_path(m, "mbox", path) || !cache_path(m, "stamp", stamp_path) ||
+      (access(mutt_buffer_string(path), F_OK) != 0))
+  {
+    goto done;
+  }
+
+  char stamp[128];
+  char saved[128] = { 0 };
+  if (!cache_stamp(m, stamp, sizeof(stamp)))
+    goto done;
+
+  FILE *fp = fopen(mutt_buffer_string(stamp_path), "r");
+  if (!fp)
+    goto done;
+  if (!fgets(saved, sizeof(saved), fp))
+    saved[0] = '\0';
+  mutt_file_fclose(&fp);
+
+  if (!mutt_str_equal(stamp, saved))
+    goto done;
+
+  mutt_debug(LL_DEBUG1, "%s hasn't changed, using %s\n", m->realpath,
+             mutt_buffer_string(path));
+  remove(mailbox_path(m));
+  mutt_buffer_copy(&m->pathbuf, path);
+  ci->cached = true;
+  rc = true;
+
+done:
+  mutt_buffer_pool_release(&path);
+  mutt_buffer_pool_release(&stamp_path);
+  return rc;
+}
+
+/**
+ * cache_save - Keep the decompressed copy of a Mailbox
+ * @param m Mailbox
+ *
+ * The freshly decompressed file replaces any old copy in $compress_cache.
+ */
+static void cache_save(struct Mailbox *m)
+{
+  struct CompressInfo *ci = m->compress_info;
+  struct Buffer *path = mutt_buffer_pool_get();
+  if (!cache_path(m, "mbox", path))
+    goto done;
+
+  cache_forget(m);
+  if (rename(mailbox_path(m), mutt_buffer_string(path)) != 0)
+  {
+    mutt_debug(LL_DEBUG1, "rename %s: %s\n", mailbox_path(m), strerror(errno));
+    goto done;
+  }
+
+  mutt_buffer_copy(&m->pathbuf, path);
+  ci->cached = true;
+  cache_save_stamp(m);
+
+done:
+  mutt_buffer_pool_release(&path);
+}
+
 /**
  * setup_paths - Set the mailbox paths
- * @param m Mailbox to modify
+ * @param m     Mailbox to modify
+ * @param cache If true, the plaintext may be kept in $compress_cache
  * @retval  0 Success
  * @retval -1 Error
  *
@@ -145,17 +306,31 @@ static void unlock_realpath(struct Mailbox *m)
  * Create a temporary filename and put its name in mailbox->path.
  * The temporary file is created to prevent symlink attacks.
  */
-static int setup_paths(struct Mailbox *m)
+static int setup_paths(struct Mailbox *m, bool cache)
 {
   if (!m)
     return -1;
 
   /* Setup the right paths */
-  mutt_str_replace(&m->realpath, mailbox_path(m));
+  if (!mutt_str_equal(m->realpath, mailbox_path(m)))
+  {
+    mutt_str_replace(&m->realpath, mailbox_path(m));
+    account_mailbox_rehash(m->account);
+  }
 
-  /* We will uncompress to TMPDIR */
+  /* We will uncompress to TMPDIR, or next to the cached copy, so that it can
+   * be renamed into place */
   struct Buffer *buf = mutt_buffer_pool_get();
-  mutt_buffer_mktemp(buf);
+  const char *const c_compress_cache = cs_subset_path(NeoMutt->sub, "compress_cache");
+  if (cache && c_compress_cache && (mutt_file_mkdir(c_compress_cache, S_IRWXU) == 0) &&
+      cache_path(m, "mbox", buf))
+  {
+    mutt_buffer_add_printf(buf, ".%d.%" PRIu64, (int) getpid(), mutt_rand64());
+  }
+  else
+  {
+    mutt_buffer_mktemp(buf);
+  }
   mutt_buffer_copy(&m->pathbuf, buf);
   mutt_buffer_pool_release(&buf);
 
@@ -199,16 +374,20 @@ static struct CompressInfo *set_compress_info(struct Mailbox *m)
   if (m->compress_info)
     return m->compress_info;
 
-  /* Open is compulsory */
+  /* Open is compulsory, unless we know the format */
   const char *o = mutt_find_hook(MUTT_OPEN_HOOK, mailbox_path(m));
-  if (!o)
+  const struct CompBuiltin *cb = o ? NULL : comp_builtin_find(mailbox_path(m));
+  if (!o && !cb)
     return NULL;
 
-  const char *c = mutt_find_hook(MUTT_CLOSE_HOOK, mailbox_path(m));
-  const char *a = mutt_find_hook(MUTT_APPEND_HOOK, mailbox_path(m));
-
   struct CompressInfo *ci = mutt_mem_calloc(1, sizeof(struct CompressInfo));
   m->compress_info = ci;
+  ci->builtin = cb;
+  if (cb)
+    return ci;
+
+  const char *c = mutt_find_hook(MUTT_CLOSE_HOOK, mailbox_path(m));
+  const char *a = mutt_find_hook(MUTT_APPEND_HOOK, mailbox_path(m));
 
   ci->cmd_open = mutt_str_dup(o);
   ci->cmd_close = mutt_str_dup(c);
@@ -343,6 +522,56 @@ static int execute_command(struct Mailbox *m, const char *command, const char *p
   return rc;
 }
 
+/**
+ * comp_decompress - Decompress the Mailbox
+ * @param m Mailbox
+ * @retval 1 Success
+ * @retval 0 Failure
+ *
+ * Use the built-in format, or run the open-hook.
+ */
+static int comp_decompress(struct Mailbox *m)
+{
+  struct CompressInfo *ci = m->compress_info;
+  if (!ci->builtin)
+    return execute_command(m, ci->cmd_open, _("Decompressing %s"));
+
+  if (m->verbose)
+    mutt_message(_("Decompressing %s"), m->realpath);
+
+  if (ci->builtin->decompress(m->realpath, mailbox_path(m)))
+    return 1;
+
+  mutt_error(_("Error decompressing %s"), m->realpath);
+  return 0;
+}
+
+/**
+ * comp_compress - Compress the Mailbox
+ * @param m      Mailbox
+ * @param append If true, add the emails to the end of the compressed file
+ * @retval 1 Success
+ * @retval 0 Failure
+ *
+ * Use the built-in format, or run the append-hook or close-hook.
+ */
+static int comp_compress(struct Mailbox *m, bool append)
+{
+  struct CompressInfo *ci = m->compress_info;
+  const char *msg = append ? _("Compressed-appending to %s...") : _("Compressing %s");
+  if (!ci->builtin)
+    return execute_command(m, append ? ci->cmd_append : ci->cmd_close, msg);
+
+  if (m->verbose)
+    mutt_message(msg, m->realpath);
+
+  if (ci->builtin->compress(mailbox_path(m), m->realpath, append))
+    return 1;
+
+  mutt_error(_("Error compressing %s"), m->realpath);
+  return 0;
+}
+
 /**
  * mutt_comp_can_append - Can we append to this path?
  * @param m Mailbox
@@ -359,14 +588,14 @@ bool mutt_comp_can_append(struct Mailbox *m)
   if (!m)
     return false;
 
-  /* If this succeeds, we know there's an open-hook */
+  /* If this succeeds, we know there's an open-hook, or a built-in format */
   struct CompressInfo *ci = set_compress_info(m);
   if (!ci)
     return false;
 
   /* We have an open-hook, so to append we need an append-hook,
    * or a close-hook. */
-  if (ci->cmd_append || ci->cmd_close)
+  if (ci->builtin || ci->cmd_append || ci->cmd_close)
     return true;
 
   mutt_error(_("Can't append without an append-hook or close-hook : %s"), mailbox_path(m));
@@ -379,7 +608,8 @@ bool mutt_comp_can_append(struct Mailbox *m)
  * @retval true  Yes, we can read the file
  * @retval false No, we can't read the file
  *
- * Search for an 'open-hook' with a regex that matches the path.
+ * Search for an 'open-hook' with a regex that matches the path, or check
+ * whether the file is in a built-in format.
  *
  * A match means it's our responsibility to open the file.
  */
@@ -391,6 +621,9 @@ bool mutt_comp_can_read(const char *path)
   if (mutt_find_hook(MUTT_OPEN_HOOK, path))
     return true;
 
+  if (comp_builtin_find(path))
+    return true;
+
   return false;
 }
 
@@ -442,10 +675,10 @@ static enum MxOpenReturns comp_mbox_open(struct Mailbox *m)
     return MX_OPEN_ERROR;
 
   /* If there's no close-hook, or the file isn't writable */
-  if (!ci->cmd_close || (access(mailbox_path(m), W_OK) != 0))
+  if ((!ci->cmd_close && !ci->builtin) || (access(mailbox_path(m), W_OK) != 0))
     m->readonly = true;
 
-  if (setup_paths(m) != 0)
+  if (setup_paths(m, true) != 0)
     goto cmo_fail;
   store_size(m);
 
@@ -455,9 +688,13 @@ static enum MxOpenReturns comp_mbox_open(struct Mailbox *m)
     goto cmo_fail;
   }
 
-  int rc = execute_command(m, ci->cmd_open, _("Decompressing %s"));
-  if (rc == 0)
-    goto cmo_fail;
+  if (!cache_open(m))
+  {
+    int rc = comp_decompress(m);
+    if (rc == 0)
+      goto cmo_fail;
+    cache_save(m);
+  }
 
   unlock_realpath(m);
 
@@ -480,6 +717,8 @@ static enum MxOpenReturns comp_mbox_open(struct Mailbox *m)
 
 cmo_fail:
   /* remove the partial uncompressed file */
+  if (ci->cached)
+    cache_forget(m);
   remove(mailbox_path(m));
   compress_info_free(m);
   return MX_OPEN_ERROR;
@@ -495,20 +734,20 @@ cmo_fail:
  */
 static bool comp_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
 {
-  /* If this succeeds, we know there's an open-hook */
+  /* If this succeeds, we know there's an open-hook, or a built-in format */
   struct CompressInfo *ci = set_compress_info(m);
   if (!ci)
     return false;
 
   /* To append we need an append-hook or a close-hook */
-  if (!ci->cmd_append && !ci->cmd_close)
+  if (!ci->builtin && !ci->cmd_append && !ci->cmd_close)
   {
     mutt_error(_("Can't append without an append-hook or close-hook : %s"),
                mailbox_path(m));
     goto cmoa_fail1;
   }
 
-  if (setup_paths(m) != 0)
+  if (setup_paths(m, false) != 0)
     goto cmoa_fail2;
 
   /* Lock the realpath for the duration of the append.
@@ -520,9 +759,9 @@ static bool comp_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
   }
 
   /* Open the existing mailbox, unless we are appending */
-  if (!ci->cmd_append && (mutt_file_get_size(m->realpath) > 0))
+  if (!ci->builtin && !ci->cmd_append && (mutt_file_get_size(m->realpath) > 0))
   {
-    int rc = execute_command(m, ci->cmd_open, _("Decompressing %s"));
+    int rc = comp_decompress(m);
     if (rc == 0)
     {
       mutt_error(_("Compress command failed: %s"), ci->cmd_open);
@@ -595,8 +834,12 @@ static enum MxStatus comp_mbox_check(struct Mailbox *m)
     return MX_STATUS_ERROR;
   }
 
-  int rc = execute_command(m, ci->cmd_open, _("Decompressing %s"));
+  if (ci->cached)
+    cache_forget(m);
+  int rc = comp_decompress(m);
   store_size(m);
+  if ((rc != 0) && ci->cached)
+    cache_save_stamp(m);
   unlock_realpath(m);
   if (rc == 0)
     return MX_STATUS_ERROR;
@@ -617,7 +860,7 @@ static enum MxStatus comp_mbox_sync(struct Mailbox *m)
 
   struct CompressInfo *ci = m->compress_info;
 
-  if (!ci->cmd_close)
+  if (!ci->cmd_close && !ci->builtin)
   {
     mutt_error(_("Can't sync a compressed file without a close-hook"));
     return MX_STATUS_ERROR;
@@ -637,17 +880,24 @@ static enum MxStatus comp_mbox_sync(struct Mailbox *m)
   if (check != MX_STATUS_OK)
     goto sync_cleanup;
 
+  /* the copy won't match until it's been compressed */
+  if (ci->cached)
+    cache_forget(m);
+
   check = ops->mbox_sync(m);
   if (check != MX_STATUS_OK)
     goto sync_cleanup;
 
-  int rc = execute_command(m, ci->cmd_close, _("Compressing %s"));
+  int rc = comp_compress(m, false);
   if (rc == 0)
   {
     check = MX_STATUS_ERROR;
     goto sync_cleanup;
   }
 
+  if (ci->cached)
+    cache_save_stamp(m);
+
   check = MX_STATUS_OK;
 
 sync_cleanup:
@@ -681,22 +931,11 @@ static enum MxStatus comp_mbox_close(struct Mailbox *m)
   /* sync has already been called, so we only need to delete some files */
   if (m->append)
   {
-    const char *append = NULL;
-    const char *msg = NULL;
-
     /* The file exists and we can append */
-    if ((access(m->realpath, F_OK) == 0) && ci->cmd_append)
-    {
-      append = ci->cmd_append;
-      msg = _("Compressed-appending to %s...");
-    }
-    else
-    {
-      append = ci->cmd_close;
-      msg = _("Compressing %s");
-    }
+    const bool append = (access(m->realpath, F_OK) == 0) &&
+                        (ci->cmd_append || ci->builtin);
 
-    int rc = execute_command(m, append, msg);
+    int rc = comp_compress(m, append);
     if (rc == 0)
     {
       mutt_any_key_to_continue(NULL);
@@ -713,9 +952,11 @@ static enum MxStatus comp_mbox_close(struct Mailbox *m)
     const bool c_save_empty = cs_subset_bool(NeoMutt->sub, "save_empty");
     if ((access(mailbox_path(m), F_OK) != 0) && !c_save_empty)
     {
+      if (ci->cached)
+        cache_forget(m);
       remove(m->realpath);
     }
-    else
+    else if (!ci->cached)
     {
       remove(mailbox_path(m));
     }
@@ -780,6 +1021,27 @@ static int comp_msg_commit(struct Mailbox *m, struct Message *msg)
   return ops->msg_commit(m, msg);
 }
 
+/**
+ * comp_msg_append_batch - Start or finish appending several messages - Implements MxOps::msg_append_batch()
+ */
+static int comp_msg_append_batch(struct Mailbox *m, bool start)
+{
+  if (!m->compress_info)
+    return -1;
+
+  struct CompressInfo *ci = m->compress_info;
+
+  const struct MxOps *ops = ci->child_ops;
+  if (!ops)
+    return -1;
+
+  if (!ops->msg_append_batch)
+    return 0;
+
+  /* Delegate */
+  return ops->msg_append_batch(m, start);
+}
+
 /**
  * comp_msg_close - Close an email - Implements MxOps::msg_close()
  */
@@ -940,9 +1202,11 @@ struct MxOps MxCompOps = {
   .mbox_sync        = comp_mbox_sync,
   .mbox_close       = comp_mbox_close,
   .msg_open         = comp_msg_open,
+  .msg_prefetch     = NULL,
   .msg_open_new     = comp_msg_open_new,
   .msg_commit       = comp_msg_commit,
   .msg_close        = comp_msg_close,
+  .msg_append_batch = comp_msg_append_batch,
   .msg_padding_size = comp_msg_padding_size,
   .msg_save_hcache  = comp_msg_save_hcache,
   .tags_edit        = comp_tags_edit,
@@ -0,0 +1,49 @@
+/**
+ * @file
+ * Config used by libcompmbox
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page compmbox_config Config used by libcompmbox
+ *
+ * Config used by libcompmbox
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <config/lib.h>
+#include <stdbool.h>
+
+static struct ConfigDef CompmboxVars[] = {
+  // clang-format off
+  { "compress_cache", DT_PATH|DT_PATH_DIR, 0, 0, NULL,
+    "Directory to keep decompressed copies of compressed mailboxes"
+  },
+  { NULL },
+  // clang-format on
+};
+
+/**
+ * config_init_compmbox - Register compmbox config variables - Implements ::module_init_config_t
+ */
+bool config_init_compmbox(struct ConfigSet *cs)
+{
+  return cs_register_variables(cs, CompmboxVars, 0);
+}
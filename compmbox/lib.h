@@ -28,7 +28,9 @@
  *
  * | File                | Description                |
  * | :------------------ | :------------------------- |
+ * | compmbox/builtin.c  | @subpage compmbox_builtin  |
  * | compress/compress.c | @subpage compmbox_compress |
+ * | compmbox/config.c   | @subpage compmbox_config   |
  */
 
 #ifndef MUTT_COMPMBOX_LIB_H
@@ -38,6 +40,8 @@
 #include <stdio.h>
 #include "core/lib.h"
 
+struct CompBuiltin;
+
 /**
  * struct CompressInfo - Private data for compress
  *
@@ -45,13 +49,15 @@
  */
 struct CompressInfo
 {
-  const char *cmd_append;        ///< append-hook command
-  const char *cmd_close;         ///< close-hook  command
-  const char *cmd_open;          ///< open-hook   command
-  long size;                     ///< size of the compressed file
-  const struct MxOps *child_ops; ///< callbacks of de-compressed file
-  bool locked;                   ///< if realpath is locked
-  FILE *fp_lock;                 ///< fp used for locking
+  const char *cmd_append;            ///< append-hook command
+  const char *cmd_close;             ///< close-hook  command
+  const char *cmd_open;              ///< open-hook   command
+  const struct CompBuiltin *builtin; ///< built-in format, if no hooks match
+  long size;                         ///< size of the compressed file
+  const struct MxOps *child_ops;     ///< callbacks of de-compressed file
+  bool locked;                       ///< if realpath is locked
+  bool cached;                       ///< if path is a copy kept in $compress_cache
+  FILE *fp_lock;                     ///< fp used for locking
 };
 
 void mutt_comp_init(void);
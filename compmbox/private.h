@@ -0,0 +1,63 @@
+/**
+ * @file
+ * Compressed mbox local mailbox type
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_COMPMBOX_PRIVATE_H
+#define MUTT_COMPMBOX_PRIVATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * struct CompBuiltin - A compression format that NeoMutt can read itself
+ *
+ * Files in these formats don't need an open-hook, close-hook or append-hook.
+ */
+struct CompBuiltin
+{
+  const char *name;           ///< Name of the format, e.g. "gzip"
+  const unsigned char *magic; ///< Bytes at the start of a compressed file
+  size_t magic_len;           ///< Length of the magic
+
+  /**
+   * decompress - Decompress a file
+   * @param from Compressed file
+   * @param to   Plaintext file to create
+   * @retval true Success
+   */
+  bool (*decompress)(const char *from, const char *to);
+
+  /**
+   * compress - Compress a file
+   * @param from   Plaintext file
+   * @param to     Compressed file
+   * @param append If true, add to the end of the compressed file
+   * @retval true Success
+   *
+   * Appending adds a new stream to the file, so the existing contents don't
+   * need to be decompressed.
+   */
+  bool (*compress)(const char *from, const char *to, bool append);
+};
+
+const struct CompBuiltin *comp_builtin_find(const char *path);
+
+#endif /* MUTT_COMPMBOX_PRIVATE_H */
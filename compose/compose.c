@@ -1343,6 +1343,8 @@ static void compose_custom_redraw(struct Menu *menu)
 
   if (menu->redraw & REDRAW_INDEX)
     menu_redraw_index(menu);
+  else if (menu->redraw & REDRAW_SCROLL)
+    menu_redraw_scroll(menu);
   else if (menu->redraw & (REDRAW_MOTION | REDRAW_MOTION_RESYNC))
     menu_redraw_motion(menu);
   else if (menu->redraw == REDRAW_CURRENT)
@@ -31,6 +31,9 @@
 #include <string.h>
 #include "mutt/lib.h"
 #include "lib.h"
+#include "private.h"
+
+#define COMPR_BUF_MIN_SIZE 4096 ///< Smallest allocation for a scratch buffer
 
 /**
  * compr_ops - Backend implementations
@@ -92,3 +95,41 @@ const struct ComprOps *compress_get_ops(const char *compr)
 
   return *ops;
 }
+
+/**
+ * compr_buf_reserve - Make sure a scratch buffer is big enough
+ * @param buf Scratch buffer
+ * @param len Number of bytes needed
+ * @retval ptr The buffer's data
+ *
+ * If the buffer has to grow, it's at least doubled in size.
+ */
+void *compr_buf_reserve(struct ComprBuf *buf, size_t len)
+{
+  if (!buf)
+    return NULL;
+
+  if (len <= buf->size)
+    return buf->data;
+
+  size_t size = MAX(buf->size * 2, COMPR_BUF_MIN_SIZE);
+  while (size < len)
+    size *= 2;
+
+  mutt_mem_realloc(&buf->data, size);
+  buf->size = size;
+  return buf->data;
+}
+
+/**
+ * compr_buf_free - Free a scratch buffer
+ * @param buf Scratch buffer
+ */
+void compr_buf_free(struct ComprBuf *buf)
+{
+  if (!buf)
+    return;
+
+  FREE(&buf->data);
+  buf->size = 0;
+}
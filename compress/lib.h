@@ -42,11 +42,16 @@
  * Usage with Compression Level set to X:
  * - open(level X) -> N times compress() -> close()
  * - open(level X) -> N times decompress() -> close()
+ *
+ * Backends may support a trained dictionary, which improves the compression of
+ * small records that share a lot of structure:
+ * - open(level X) -> dict_train() or dict_load() -> N times compress() -> close()
  */
 
 #ifndef MUTT_COMPRESS_LIB_H
 #define MUTT_COMPRESS_LIB_H
 
+#include <stdbool.h>
 #include <stdlib.h>
 
 /**
@@ -93,6 +98,38 @@ struct ComprOps
    */
   void *(*decompress)(void *cctx, const char *cbuf, size_t clen);
 
+  /**
+   * dict_train - Train a compression dictionary from sample data
+   * @param[in]  cctx    Compression context
+   * @param[in]  samples Sample records, stored back to back
+   * @param[in]  sizes   Size of each sample record
+   * @param[in]  count   Number of sample records
+   * @param[out] dlen    Length of the returned dictionary
+   * @retval ptr  Success, pointer to the dictionary
+   * @retval NULL Not supported by the backend, or training failed
+   *
+   * On success, the dictionary is also loaded into the context, as if by
+   * dict_load().
+   *
+   * @note This function returns a pointer to data, which will be freed by the
+   *       close() function.
+   */
+  void *(*dict_train)(void *cctx, const char *samples, const size_t *sizes,
+                      unsigned int count, size_t *dlen);
+
+  /**
+   * dict_load - Use a dictionary for compression and decompression
+   * @param[in] cctx Compression context
+   * @param[in] dict Dictionary, from dict_train()
+   * @param[in] dlen Length of the dictionary
+   * @retval true  Success
+   * @retval false Not supported by the backend, or invalid dictionary
+   *
+   * Once loaded, compress() uses the dictionary.  decompress() can still read
+   * data that was compressed without a dictionary.
+   */
+  bool (*dict_load)(void *cctx, const char *dict, size_t dlen);
+
   /**
    * close - Close a compression context
    * @param[out] cctx Backend-specific context retrieved via open()
@@ -28,6 +28,7 @@
  */
 
 #include "config.h"
+#include <stdbool.h>
 #include <stddef.h>
 #include <lz4.h>
 #include "private.h"
@@ -42,8 +43,8 @@
  */
 struct ComprLz4Ctx
 {
-  void *buf;   ///< Temporary buffer
-  short level; ///< Compression Level to be used
+  struct ComprBuf buf; ///< Temporary buffer
+  short level;         ///< Compression Level to be used
 };
 
 /**
@@ -51,9 +52,9 @@ struct ComprLz4Ctx
  */
 static void *compr_lz4_open(short level)
 {
-  struct ComprLz4Ctx *ctx = mutt_mem_malloc(sizeof(struct ComprLz4Ctx));
+  struct ComprLz4Ctx *ctx = mutt_mem_calloc(1, sizeof(struct ComprLz4Ctx));
 
-  ctx->buf = mutt_mem_malloc(LZ4_compressBound(1024 * 32));
+  compr_buf_reserve(&ctx->buf, LZ4_compressBound(1024 * 32));
 
   if ((level < MIN_COMP_LEVEL) || (level > MAX_COMP_LEVEL))
   {
@@ -79,8 +80,7 @@ static void *compr_lz4_compress(void *cctx, const char *data, size_t dlen, size_
 
   int datalen = dlen;
   int len = LZ4_compressBound(dlen);
-  mutt_mem_realloc(&ctx->buf, len + 4);
-  char *cbuf = ctx->buf;
+  char *cbuf = compr_buf_reserve(&ctx->buf, len + 4);
 
   len = LZ4_compress_fast(data, cbuf + 4, datalen, len, ctx->level);
   if (len == 0)
@@ -88,7 +88,7 @@ static void *compr_lz4_compress(void *cctx, const char *data, size_t dlen, size_
   *clen = len + 4;
 
   /* save ulen to first 4 bytes */
-  unsigned char *cs = ctx->buf;
+  unsigned char *cs = (unsigned char *) cbuf;
   cs[0] = dlen & 0xff;
   dlen >>= 8;
   cs[1] = dlen & 0xff;
@@ -97,7 +97,7 @@ static void *compr_lz4_compress(void *cctx, const char *data, size_t dlen, size_
   dlen >>= 8;
   cs[3] = dlen & 0xff;
 
-  return ctx->buf;
+  return cbuf;
 }
 
 /**
@@ -116,8 +116,7 @@ static void *compr_lz4_decompress(void *cctx, const char *cbuf, size_t clen)
   if (ulen == 0)
     return (void *) cbuf;
 
-  mutt_mem_realloc(&ctx->buf, ulen);
-  void *ubuf = ctx->buf;
+  void *ubuf = compr_buf_reserve(&ctx->buf, ulen);
   const char *data = cbuf;
   int ret = LZ4_decompress_safe(data + 4, ubuf, clen - 4, ulen);
   if (ret < 0)
@@ -126,6 +125,27 @@ static void *compr_lz4_decompress(void *cctx, const char *cbuf, size_t clen)
   return ubuf;
 }
 
+/**
+ * compr_lz4_dict_train - Implements ComprOps::dict_train()
+ *
+ * Dictionaries aren't supported by lz4.
+ */
+static void *compr_lz4_dict_train(void *cctx, const char *samples, const size_t *sizes,
+                                  unsigned int count, size_t *dlen)
+{
+  return NULL;
+}
+
+/**
+ * compr_lz4_dict_load - Implements ComprOps::dict_load()
+ *
+ * Dictionaries aren't supported by lz4.
+ */
+static bool compr_lz4_dict_load(void *cctx, const char *dict, size_t dlen)
+{
+  return false;
+}
+
 /**
  * compr_lz4_close - Implements ComprOps::close()
  */
@@ -136,7 +156,7 @@ static void compr_lz4_close(void **cctx)
 
   struct ComprLz4Ctx *ctx = *cctx;
 
-  FREE(&ctx->buf);
+  compr_buf_free(&ctx->buf);
   FREE(cctx);
 }
 
@@ -23,6 +23,23 @@
 #ifndef MUTT_COMPRESS_PRIVATE_H
 #define MUTT_COMPRESS_PRIVATE_H
 
+#include <stddef.h>
+
+/**
+ * struct ComprBuf - Scratch buffer for a compression context
+ *
+ * The buffer grows geometrically and never shrinks, so a context that's kept
+ * open for a whole mailbox settles on one allocation.
+ */
+struct ComprBuf
+{
+  void *data;  ///< Buffer
+  size_t size; ///< Allocated size
+};
+
+void *compr_buf_reserve(struct ComprBuf *buf, size_t len);
+void  compr_buf_free   (struct ComprBuf *buf);
+
 #define COMPRESS_OPS(_name, _min_level, _max_level) \
   const struct ComprOps compr_##_name##_ops = {     \
     .name       = #_name,                           \
@@ -31,6 +48,8 @@
     .open       = compr_##_name##_open,             \
     .compress   = compr_##_name##_compress,         \
     .decompress = compr_##_name##_decompress,       \
+    .dict_train = compr_##_name##_dict_train,       \
+    .dict_load  = compr_##_name##_dict_load,        \
     .close      = compr_##_name##_close,            \
   };
 
@@ -28,6 +28,7 @@
  */
 
 #include "config.h"
+#include <stdbool.h>
 #include <stddef.h>
 #include <zconf.h>
 #include <zlib.h>
@@ -43,8 +44,11 @@
  */
 struct ComprZlibCtx
 {
-  void *buf;   ///< Temporary buffer
-  short level; ///< Compression Level to be used
+  struct ComprBuf buf; ///< Temporary buffer
+  short level;         ///< Compression Level to be used
+
+  z_stream zc; ///< Compression stream, reset for each record
+  z_stream zd; ///< Decompression stream, reset for each record
 };
 
 /**
@@ -52,9 +56,9 @@ struct ComprZlibCtx
  */
 static void *compr_zlib_open(short level)
 {
-  struct ComprZlibCtx *ctx = mutt_mem_malloc(sizeof(struct ComprZlibCtx));
+  struct ComprZlibCtx *ctx = mutt_mem_calloc(1, sizeof(struct ComprZlibCtx));
 
-  ctx->buf = mutt_mem_malloc(compressBound(1024 * 32));
+  compr_buf_reserve(&ctx->buf, compressBound(1024 * 32));
 
   if ((level < MIN_COMP_LEVEL) || (level > MAX_COMP_LEVEL))
   {
@@ -65,6 +69,27 @@ static void *compr_zlib_open(short level)
 
   ctx->level = level;
 
+  /* Setting up a stream is expensive (deflate allocates ~256KiB of state), so
+   * the streams are created once and reset for each record */
+  if (deflateInit(&ctx->zc, ctx->level) != Z_OK)
+  {
+    // LCOV_EXCL_START
+    compr_buf_free(&ctx->buf);
+    FREE(&ctx);
+    return NULL;
+    // LCOV_EXCL_STOP
+  }
+
+  if (inflateInit(&ctx->zd) != Z_OK)
+  {
+    // LCOV_EXCL_START
+    deflateEnd(&ctx->zc);
+    compr_buf_free(&ctx->buf);
+    FREE(&ctx);
+    return NULL;
+    // LCOV_EXCL_STOP
+  }
+
   return ctx;
 }
 
@@ -78,17 +103,21 @@ static void *compr_zlib_compress(void *cctx, const char *data, size_t dlen, size
 
   struct ComprZlibCtx *ctx = cctx;
 
-  uLong len = compressBound(dlen);
-  mutt_mem_realloc(&ctx->buf, len + 4);
-  Bytef *cbuf = (unsigned char *) ctx->buf + 4;
-  const void *ubuf = data;
-  int rc = compress2(cbuf, &len, ubuf, dlen, ctx->level);
-  if (rc != Z_OK)
+  if (deflateReset(&ctx->zc) != Z_OK)
+    return NULL; // LCOV_EXCL_LINE
+
+  uLong len = deflateBound(&ctx->zc, dlen);
+  unsigned char *cs = compr_buf_reserve(&ctx->buf, len + 4);
+
+  ctx->zc.next_in = (Bytef *) data;
+  ctx->zc.avail_in = dlen;
+  ctx->zc.next_out = cs + 4;
+  ctx->zc.avail_out = len;
+  if (deflate(&ctx->zc, Z_FINISH) != Z_STREAM_END)
     return NULL; // LCOV_EXCL_LINE
-  *clen = len + 4;
+  *clen = ctx->zc.total_out + 4;
 
   /* save ulen to first 4 bytes */
-  unsigned char *cs = ctx->buf;
   cs[0] = dlen & 0xff;
   dlen >>= 8;
   cs[1] = dlen & 0xff;
@@ -97,7 +126,7 @@ static void *compr_zlib_compress(void *cctx, const char *data, size_t dlen, size
   dlen >>= 8;
   cs[3] = dlen & 0xff;
 
-  return ctx->buf;
+  return cs;
 }
 
 /**
@@ -116,16 +145,41 @@ static void *compr_zlib_decompress(void *cctx, const char *cbuf, size_t clen)
   if (ulen == 0)
     return NULL;
 
-  mutt_mem_realloc(&ctx->buf, ulen);
-  Bytef *ubuf = ctx->buf;
-  cs = (const unsigned char *) cbuf;
-  int ret = uncompress(ubuf, &ulen, cs + 4, clen - 4);
-  if (ret != Z_OK)
+  if (inflateReset(&ctx->zd) != Z_OK)
+    return NULL; // LCOV_EXCL_LINE
+
+  Bytef *ubuf = compr_buf_reserve(&ctx->buf, ulen);
+  ctx->zd.next_in = (Bytef *) cs + 4;
+  ctx->zd.avail_in = clen - 4;
+  ctx->zd.next_out = ubuf;
+  ctx->zd.avail_out = ulen;
+  if ((inflate(&ctx->zd, Z_FINISH) != Z_STREAM_END) || (ctx->zd.total_out != ulen))
     return NULL;
 
   return ubuf;
 }
 
+/**
+ * compr_zlib_dict_train - Implements ComprOps::dict_train()
+ *
+ * Dictionaries aren't supported by zlib.
+ */
+static void *compr_zlib_dict_train(void *cctx, const char *samples, const size_t *sizes,
+                                   unsigned int count, size_t *dlen)
+{
+  return NULL;
+}
+
+/**
+ * compr_zlib_dict_load - Implements ComprOps::dict_load()
+ *
+ * Dictionaries aren't supported by zlib.
+ */
+static bool compr_zlib_dict_load(void *cctx, const char *dict, size_t dlen)
+{
+  return false;
+}
+
 /**
  * compr_zlib_close - Implements ComprOps::close()
  */
@@ -136,7 +190,9 @@ static void compr_zlib_close(void **cctx)
 
   struct ComprZlibCtx *ctx = *cctx;
 
-  FREE(&ctx->buf);
+  deflateEnd(&ctx->zc);
+  inflateEnd(&ctx->zd);
+  compr_buf_free(&ctx->buf);
   FREE(cctx);
 }
 
@@ -28,7 +28,9 @@
  */
 
 #include "config.h"
+#include <stdbool.h>
 #include <stdio.h>
+#include <zdict.h>
 #include <zstd.h>
 #include "private.h"
 #include "mutt/lib.h"
@@ -36,17 +38,23 @@
 
 #define MIN_COMP_LEVEL 1  ///< Minimum compression level for zstd
 #define MAX_COMP_LEVEL 22 ///< Maximum compression level for zstd
+#define MAX_DICT_SIZE (16 * 1024) ///< Maximum size of a trained dictionary
 
 /**
  * struct ComprZstdCtx - Private Zstandard Compression Context
  */
 struct ComprZstdCtx
 {
-  void *buf;   ///< Temporary buffer
-  short level; ///< Compression Level to be used
+  struct ComprBuf buf; ///< Temporary buffer
+  short level;         ///< Compression Level to be used
 
   ZSTD_CCtx *cctx; ///< Compression context
   ZSTD_DCtx *dctx; ///< Decompression context
+
+  void *dict;           ///< Trained dictionary
+  ZSTD_CDict *cdict;    ///< Digested dictionary for compression
+  ZSTD_DDict *ddict;    ///< Digested dictionary for decompression
+  unsigned int dict_id; ///< ID of the loaded dictionary
 };
 
 /**
@@ -54,9 +62,9 @@ struct ComprZstdCtx
  */
 static void *compr_zstd_open(short level)
 {
-  struct ComprZstdCtx *ctx = mutt_mem_malloc(sizeof(struct ComprZstdCtx));
+  struct ComprZstdCtx *ctx = mutt_mem_calloc(1, sizeof(struct ComprZstdCtx));
 
-  ctx->buf = mutt_mem_malloc(ZSTD_compressBound(1024 * 128));
+  compr_buf_reserve(&ctx->buf, ZSTD_compressBound(1024 * 128));
   ctx->cctx = ZSTD_createCCtx();
   ctx->dctx = ZSTD_createDCtx();
 
@@ -65,7 +73,7 @@ static void *compr_zstd_open(short level)
     // LCOV_EXCL_START
     ZSTD_freeCCtx(ctx->cctx);
     ZSTD_freeDCtx(ctx->dctx);
-    FREE(&ctx->buf);
+    compr_buf_free(&ctx->buf);
     FREE(&ctx);
     return NULL;
     // LCOV_EXCL_STOP
@@ -94,15 +102,19 @@ static void *compr_zstd_compress(void *cctx, const char *data, size_t dlen, size
   struct ComprZstdCtx *ctx = cctx;
 
   size_t len = ZSTD_compressBound(dlen);
-  mutt_mem_realloc(&ctx->buf, len);
+  void *cbuf = compr_buf_reserve(&ctx->buf, len);
 
-  size_t ret = ZSTD_compressCCtx(ctx->cctx, ctx->buf, len, data, dlen, ctx->level);
+  size_t ret;
+  if (ctx->cdict)
+    ret = ZSTD_compress_usingCDict(ctx->cctx, cbuf, len, data, dlen, ctx->cdict);
+  else
+    ret = ZSTD_compressCCtx(ctx->cctx, cbuf, len, data, dlen, ctx->level);
   if (ZSTD_isError(ret))
     return NULL; // LCOV_EXCL_LINE
 
   *clen = ret;
 
-  return ctx->buf;
+  return cbuf;
 }
 
 /**
@@ -122,13 +134,94 @@ static void *compr_zstd_decompress(void *cctx, const char *cbuf, size_t clen)
     return NULL;
   else if (len == 0)
     return NULL; // LCOV_EXCL_LINE
-  mutt_mem_realloc(&ctx->buf, len);
+  void *ubuf = compr_buf_reserve(&ctx->buf, len);
+
+  // Frames written with a dictionary can only be read with the same one
+  size_t ret;
+  unsigned int id = ZSTD_getDictID_fromFrame(cbuf, clen);
+  if (id == 0)
+    ret = ZSTD_decompressDCtx(ctx->dctx, ubuf, len, cbuf, clen);
+  else if (ctx->ddict && (id == ctx->dict_id))
+    ret = ZSTD_decompress_usingDDict(ctx->dctx, ubuf, len, cbuf, clen, ctx->ddict);
+  else
+    return NULL;
 
-  size_t ret = ZSTD_decompressDCtx(ctx->dctx, ctx->buf, len, cbuf, clen);
   if (ZSTD_isError(ret))
     return NULL; // LCOV_EXCL_LINE
 
-  return ctx->buf;
+  return ubuf;
+}
+
+/**
+ * dict_free - Free a loaded dictionary
+ * @param ctx Zstandard Compression Context
+ */
+static void dict_free(struct ComprZstdCtx *ctx)
+{
+  ZSTD_freeCDict(ctx->cdict);
+  ZSTD_freeDDict(ctx->ddict);
+  ctx->cdict = NULL;
+  ctx->ddict = NULL;
+  ctx->dict_id = 0;
+  FREE(&ctx->dict);
+}
+
+/**
+ * compr_zstd_dict_load - Implements ComprOps::dict_load()
+ */
+static bool compr_zstd_dict_load(void *cctx, const char *dict, size_t dlen)
+{
+  if (!cctx || !dict || (dlen == 0))
+    return false;
+
+  struct ComprZstdCtx *ctx = cctx;
+
+  unsigned int id = ZDICT_getDictID(dict, dlen);
+  if (id == 0)
+    return false;
+
+  ZSTD_CDict *cdict = ZSTD_createCDict(dict, dlen, ctx->level);
+  ZSTD_DDict *ddict = ZSTD_createDDict(dict, dlen);
+  if (!cdict || !ddict)
+  {
+    // LCOV_EXCL_START
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+    return false;
+    // LCOV_EXCL_STOP
+  }
+
+  dict_free(ctx);
+  ctx->cdict = cdict;
+  ctx->ddict = ddict;
+  ctx->dict_id = id;
+  return true;
+}
+
+/**
+ * compr_zstd_dict_train - Implements ComprOps::dict_train()
+ */
+static void *compr_zstd_dict_train(void *cctx, const char *samples, const size_t *sizes,
+                                   unsigned int count, size_t *dlen)
+{
+  if (!cctx || !samples || !sizes || (count == 0) || !dlen)
+    return NULL;
+
+  struct ComprZstdCtx *ctx = cctx;
+
+  void *dict = mutt_mem_malloc(MAX_DICT_SIZE);
+  size_t len = ZDICT_trainFromBuffer(dict, MAX_DICT_SIZE, samples, sizes, count);
+  if (ZDICT_isError(len) || !compr_zstd_dict_load(ctx, dict, len))
+  {
+    mutt_debug(LL_DEBUG1, "Couldn't train a %s dictionary from %u samples\n",
+               compr_zstd_ops.name, count);
+    FREE(&dict);
+    return NULL;
+  }
+
+  ctx->dict = dict;
+  *dlen = len;
+  return dict;
 }
 
 /**
@@ -147,7 +240,8 @@ static void compr_zstd_close(void **cctx)
   if (ctx->dctx)
     ZSTD_freeDCtx(ctx->dctx);
 
-  FREE(&ctx->buf);
+  dict_free(ctx);
+  compr_buf_free(&ctx->buf);
   FREE(cctx);
 }
 
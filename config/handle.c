@@ -0,0 +1,212 @@
+/**
+ * @file
+ * Cached handles to config items
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page config_handle Cached handles to config items
+ *
+ * Reading a config item by name means building its scoped name, looking it up
+ * in the hash table and following its inheritance.  That's fine for most
+ * code, but not inside a loop over every Email.
+ *
+ * A #ConfigHandle does the lookup once and remembers the value.  Every change
+ * to any config item bumps #ConfigGeneration, which tells the handle that its
+ * value is stale.  While nothing changes, reading a handle is just a couple
+ * of comparisons.
+ */
+
+#include "config.h"
+#include <assert.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "mutt/lib.h"
+#include "handle.h"
+#include "quad.h"
+#include "set.h"
+#include "subset.h"
+#include "types.h"
+
+/**
+ * handle_get - Get the value of a config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @param type Expected type of the config item, e.g. #DT_BOOL
+ * @retval num Native value of the config item
+ */
+static intptr_t handle_get(struct ConfigHandle *ch, const struct ConfigSubset *sub, int type)
+{
+  assert(ch && ch->name && sub);
+
+  if ((ch->sub == sub) && (ch->generation == ConfigGeneration))
+    return ch->value;
+
+  struct HashElem *he = cs_subset_create_inheritance(sub, ch->name);
+  assert(he);
+
+  assert(DTYPE(cs_get_base(he)->type) == type);
+
+  intptr_t value = cs_subset_he_native_get(sub, he, NULL);
+  assert(value != INT_MIN);
+
+  ch->sub = sub;
+  ch->value = value;
+  ch->generation = ConfigGeneration;
+  return value;
+}
+
+/**
+ * cs_handle_address - Get an Address config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval ptr  Address
+ * @retval NULL Empty address
+ */
+const struct Address *cs_handle_address(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (const struct Address *) handle_get(ch, sub, DT_ADDRESS);
+}
+
+/**
+ * cs_handle_bool - Get a boolean config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval bool Boolean value
+ */
+bool cs_handle_bool(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (bool) handle_get(ch, sub, DT_BOOL);
+}
+
+/**
+ * cs_handle_enum - Get a enumeration config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval num Enumeration
+ */
+unsigned char cs_handle_enum(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (unsigned char) handle_get(ch, sub, DT_ENUM);
+}
+
+/**
+ * cs_handle_long - Get a long config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval num Long value
+ */
+long cs_handle_long(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (long) handle_get(ch, sub, DT_LONG);
+}
+
+/**
+ * cs_handle_mbtable - Get a Multibyte table config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval ptr  Multibyte table
+ * @retval NULL Empty table
+ */
+struct MbTable *cs_handle_mbtable(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (struct MbTable *) handle_get(ch, sub, DT_MBTABLE);
+}
+
+/**
+ * cs_handle_number - Get a number config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval num Number
+ */
+short cs_handle_number(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (short) handle_get(ch, sub, DT_NUMBER);
+}
+
+/**
+ * cs_handle_path - Get a path config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval ptr  Path
+ * @retval NULL Empty path
+ */
+const char *cs_handle_path(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (const char *) handle_get(ch, sub, DT_PATH);
+}
+
+/**
+ * cs_handle_quad - Get a quad-value config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval num Quad-value
+ */
+enum QuadOption cs_handle_quad(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (enum QuadOption) handle_get(ch, sub, DT_QUAD);
+}
+
+/**
+ * cs_handle_regex - Get a regex config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval ptr  Regex
+ * @retval NULL Empty regex
+ */
+const struct Regex *cs_handle_regex(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (const struct Regex *) handle_get(ch, sub, DT_REGEX);
+}
+
+/**
+ * cs_handle_slist - Get a string-list config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval ptr  String list
+ * @retval NULL Empty string list
+ */
+const struct Slist *cs_handle_slist(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (const struct Slist *) handle_get(ch, sub, DT_SLIST);
+}
+
+/**
+ * cs_handle_sort - Get a sort config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval num Sort, e.g. #SORT_DATE
+ */
+short cs_handle_sort(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (short) handle_get(ch, sub, DT_SORT);
+}
+
+/**
+ * cs_handle_string - Get a string config item through a handle
+ * @param ch   Config Handle
+ * @param sub  Config Subset
+ * @retval ptr  String
+ * @retval NULL Empty string
+ */
+const char *cs_handle_string(struct ConfigHandle *ch, const struct ConfigSubset *sub)
+{
+  return (const char *) handle_get(ch, sub, DT_STRING);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file
+ * Cached handles to config items
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_CONFIG_HANDLE_H
+#define MUTT_CONFIG_HANDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "quad.h"
+
+struct ConfigSubset;
+
+/**
+ * struct ConfigHandle - A cached reference to a config item
+ *
+ * A handle remembers the value of a config item until the config changes.
+ * They're intended to be static variables in code that reads the same config
+ * item over and over, e.g.
+ *
+ * @code
+ * static struct ConfigHandle ch_thorough_search = CONFIG_HANDLE("thorough_search");
+ * const bool c_thorough_search = cs_handle_bool(&ch_thorough_search, NeoMutt->sub);
+ * @endcode
+ *
+ * @note Handles aren't locked, so only use them on the main thread.
+ */
+struct ConfigHandle
+{
+  const char *name;               ///< Name of the config item
+  const struct ConfigSubset *sub; ///< Subset the value was read from
+  unsigned int generation;        ///< #ConfigGeneration when the value was read
+  intptr_t value;                 ///< Native value of the config item
+};
+
+/// Initialise a ConfigHandle for a config item
+#define CONFIG_HANDLE(NAME) { NAME, NULL, 0, 0 }
+
+const struct Address *cs_handle_address(struct ConfigHandle *ch, const struct ConfigSubset *sub);
+bool                  cs_handle_bool   (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+unsigned char         cs_handle_enum   (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+long                  cs_handle_long   (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+struct MbTable       *cs_handle_mbtable(struct ConfigHandle *ch, const struct ConfigSubset *sub);
+short                 cs_handle_number (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+const char *          cs_handle_path   (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+enum QuadOption       cs_handle_quad   (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+const struct Regex *  cs_handle_regex  (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+const struct Slist *  cs_handle_slist  (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+short                 cs_handle_sort   (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+const char *          cs_handle_string (struct ConfigHandle *ch, const struct ConfigSubset *sub);
+
+#endif /* MUTT_CONFIG_HANDLE_H */
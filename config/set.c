@@ -38,6 +38,9 @@ struct ConfigSetType RegisteredTypes[18] = {
   { 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL },
 };
 
+/// Incremented whenever a config item changes, see #ConfigHandle
+unsigned int ConfigGeneration = 1;
+
 /**
  * destroy - Callback function for the Hash Table - Implements ::hash_hdata_free_t
  * @param type Object type, e.g. #DT_STRING
@@ -172,6 +175,8 @@ void cs_free(struct ConfigSet **ptr)
   if (!ptr || !*ptr)
     return;
 
+  ConfigGeneration++;
+
   struct ConfigSet *cs = *ptr;
 
   mutt_hash_free(&cs->hash);
@@ -309,6 +314,8 @@ struct HashElem *cs_inherit_variable(const struct ConfigSet *cs,
   if (!cs || !parent)
     return NULL;
 
+  ConfigGeneration++;
+
   struct Inheritance *i = mutt_mem_calloc(1, sizeof(*i));
   i->parent = parent;
   i->name = mutt_str_dup(name);
@@ -333,6 +340,8 @@ void cs_uninherit_variable(const struct ConfigSet *cs, const char *name)
   if (!cs || !name)
     return;
 
+  ConfigGeneration++;
+
   mutt_hash_delete(cs->hash, name, NULL);
 }
 
@@ -348,6 +357,8 @@ int cs_he_reset(const struct ConfigSet *cs, struct HashElem *he, struct Buffer *
   if (!cs || !he)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   /* An inherited var that's already pointing to its parent.
    * Return 'success', but don't send a notification. */
   if ((he->type & DT_INHERITED) && (DTYPE(he->type) == 0))
@@ -395,6 +406,8 @@ int cs_str_reset(const struct ConfigSet *cs, const char *name, struct Buffer *er
   if (!cs || !name)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct HashElem *he = cs_get_elem(cs, name);
   if (!he)
   {
@@ -419,6 +432,8 @@ int cs_he_initial_set(const struct ConfigSet *cs, struct HashElem *he,
   if (!cs || !he)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct ConfigDef *cdef = NULL;
 
   if (he->type & DT_INHERITED)
@@ -461,6 +476,8 @@ int cs_str_initial_set(const struct ConfigSet *cs, const char *name,
   if (!cs || !name)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct HashElem *he = cs_get_elem(cs, name);
   if (!he)
   {
@@ -546,6 +563,8 @@ int cs_he_string_set(const struct ConfigSet *cs, struct HashElem *he,
   if (!cs || !he)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct ConfigDef *cdef = NULL;
   const struct ConfigSetType *cst = NULL;
   void *var = NULL;
@@ -598,6 +617,8 @@ int cs_str_string_set(const struct ConfigSet *cs, const char *name,
   if (!cs || !name)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct HashElem *he = cs_get_elem(cs, name);
   if (!he)
   {
@@ -688,6 +709,8 @@ int cs_he_native_set(const struct ConfigSet *cs, struct HashElem *he,
   if (!cs || !he)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct ConfigDef *cdef = NULL;
   const struct ConfigSetType *cst = NULL;
   void *var = NULL;
@@ -740,6 +763,8 @@ int cs_str_native_set(const struct ConfigSet *cs, const char *name,
   if (!cs || !name)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct HashElem *he = cs_get_elem(cs, name);
   if (!he)
   {
@@ -861,6 +886,8 @@ int cs_he_string_plus_equals(const struct ConfigSet *cs, struct HashElem *he,
   if (!cs || !he)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct ConfigDef *cdef = NULL;
   const struct ConfigSetType *cst = NULL;
   void *var = NULL;
@@ -920,6 +947,8 @@ int cs_str_string_plus_equals(const struct ConfigSet *cs, const char *name,
   if (!cs || !name)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct HashElem *he = cs_get_elem(cs, name);
   if (!he)
   {
@@ -944,6 +973,8 @@ int cs_he_string_minus_equals(const struct ConfigSet *cs, struct HashElem *he,
   if (!cs || !he)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct ConfigDef *cdef = NULL;
   const struct ConfigSetType *cst = NULL;
   void *var = NULL;
@@ -1003,6 +1034,8 @@ int cs_str_string_minus_equals(const struct ConfigSet *cs, const char *name,
   if (!cs || !name)
     return CSR_ERR_CODE;
 
+  ConfigGeneration++;
+
   struct HashElem *he = cs_get_elem(cs, name);
   if (!he)
   {
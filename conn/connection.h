@@ -24,10 +24,43 @@
 #ifndef MUTT_CONN_CONNECTION_H
 #define MUTT_CONN_CONNECTION_H
 
+#include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 #include "connaccount.h"
 
+/**
+ * struct ConnStats - Network statistics of an account
+ *
+ * The stats are shared by all the Connections to an account and are kept for
+ * the life of NeoMutt, so they survive reconnections.
+ * All the times are in microseconds.
+ */
+struct ConnStats
+{
+  char host[128];           ///< Server
+  char user[128];           ///< User name, may be empty
+  unsigned short port;      ///< Port
+  unsigned char type;       ///< Connection type, e.g. #MUTT_ACCT_TYPE_IMAP
+  const char *service;      ///< Name of the service, e.g. "imap"
+
+  uint64_t bytes_in;        ///< Bytes read, after decryption and decompression
+  uint64_t bytes_out;       ///< Bytes written, before compression and encryption
+  uint64_t wire_in;         ///< Bytes read from the network
+  uint64_t wire_out;        ///< Bytes written to the network
+  uint64_t reads;           ///< Number of reads
+  uint64_t writes;          ///< Number of writes
+  uint64_t read_wait;       ///< Time spent blocked reading
+  uint64_t write_wait;      ///< Time spent blocked writing
+
+  uint64_t rtt;             ///< Smoothed round trip time of a command
+  uint64_t rtt_min;         ///< Shortest round trip
+  uint64_t rtt_max;         ///< Longest round trip
+  uint64_t rtt_count;       ///< Number of round trips measured
+
+  struct ConnStats *next;   ///< Linked list
+};
+
 /**
  * struct Connection - An open network connection (socket)
  */
@@ -35,11 +68,12 @@ struct Connection
 {
   struct ConnAccount account; ///< Account details: username, password, etc
   unsigned int ssf;           ///< Security strength factor, in bits (see below)
-  char inbuf[1024];           ///< Buffer for incoming traffic
+  char inbuf[16384];          ///< Buffer for incoming traffic
   int bufpos;                 ///< Current position in the buffer
   int fd;                     ///< Socket file descriptor
   int available;              ///< Amount of data waiting to be read
   void *sockdata;             ///< Backend-specific socket data
+  struct ConnStats *stats;    ///< Network statistics, set by mutt_socket_open()
 
   /**
    * Note about ssf: in actuality, NeoMutt uses this as a boolean to determine
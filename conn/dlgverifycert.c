@@ -63,10 +63,15 @@ static const struct Mapping VerifyHelp[] = {
  * The possible retvals will depend on the parameters.
  * The options are given in the order: Reject, Once, Always, Skip.
  * The retval represents the chosen option.
+ *
+ * If there's nobody to ask, e.g. in the background, the certificate is rejected.
  */
 int dlg_verify_certificate(const char *title, struct ListHead *list,
                            bool allow_always, bool allow_skip)
 {
+  if (OptNoCurses)
+    return 1;
+
   struct Menu *menu = mutt_menu_new(MENU_GENERIC);
   struct MuttWindow *dlg = dialog_create_simple_index(menu, WT_DLG_CERTIFICATE);
   dlg->help_data = VerifyHelp;
@@ -82,6 +82,9 @@ struct TlsSockData
   gnutls_certificate_credentials_t xcred;
 };
 
+/* TLS sessions that can be resumed, keyed by "host:port" */
+static struct HashTable *TlsSessions = NULL;
+
 /**
  * tls_init - Set up Gnu TLS
  * @retval  0 Success
@@ -884,6 +887,56 @@ static int tls_set_priority(struct TlsSockData *data)
 }
 #endif
 
+/**
+ * tls_session_key - Generate the key for a Connection's TLS session
+ * @param conn   Connection to a server
+ * @param buf    Buffer for the key
+ * @param buflen Length of the buffer
+ */
+static void tls_session_key(struct Connection *conn, char *buf, size_t buflen)
+{
+  snprintf(buf, buflen, "%s:%u", conn->account.host, conn->account.port);
+}
+
+/**
+ * tls_session_free - Free a TLS session - Implements ::hash_hdata_free_t
+ */
+static void tls_session_free(int type, void *obj, intptr_t data)
+{
+  gnutls_datum_t *sess = obj;
+  gnutls_free(sess->data);
+  FREE(&sess);
+}
+
+/**
+ * tls_session_save - Save a Connection's TLS session, so it can be resumed
+ * @param conn Connection to a server
+ *
+ * For TLS 1.3, the server sends its session tickets after the handshake, so
+ * this is called again when the Connection is closed.
+ */
+static void tls_session_save(struct Connection *conn)
+{
+  struct TlsSockData *data = conn->sockdata;
+  gnutls_datum_t *sess = mutt_mem_calloc(1, sizeof(gnutls_datum_t));
+  if (gnutls_session_get_data2(data->state, sess) < 0)
+  {
+    FREE(&sess);
+    return;
+  }
+
+  if (!TlsSessions)
+  {
+    TlsSessions = mutt_hash_new(16, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(TlsSessions, tls_session_free, 0);
+  }
+
+  char key[256];
+  tls_session_key(conn, key, sizeof(key));
+  mutt_hash_delete(TlsSessions, key, NULL);
+  mutt_hash_insert(TlsSessions, key, sess);
+}
+
 /**
  * tls_negotiate - Negotiate TLS connection
  * @param conn Connection to a server
@@ -963,11 +1016,22 @@ static int tls_negotiate(struct Connection *conn)
 
   gnutls_credentials_set(data->state, GNUTLS_CRD_CERTIFICATE, data->xcred);
 
+  /* Offer the previous session, to skip most of the handshake */
+  char key[256];
+  tls_session_key(conn, key, sizeof(key));
+  gnutls_datum_t *sess = mutt_hash_find(TlsSessions, key);
+  if (sess)
+    gnutls_session_set_data(data->state, sess->data, sess->size);
+
   do
   {
     err = gnutls_handshake(data->state);
   } while ((err == GNUTLS_E_AGAIN) || (err == GNUTLS_E_INTERRUPTED));
 
+  /* Don't offer the same session again */
+  if (err < 0)
+    mutt_hash_delete(TlsSessions, key, NULL);
+
   if (err < 0)
   {
     if (err == GNUTLS_E_FATAL_ALERT_RECEIVED)
@@ -983,7 +1047,14 @@ static int tls_negotiate(struct Connection *conn)
   }
 
   if (tls_check_certificate(conn) == 0)
+  {
+    mutt_hash_delete(TlsSessions, key, NULL);
     goto fail;
+  }
+
+  if (gnutls_session_is_resumed(data->state))
+    mutt_debug(LL_DEBUG2, "Resumed TLS session with %s\n", conn->account.host);
+  tls_session_save(conn);
 
   /* set Security Strength Factor (SSF) for SASL */
   /* NB: gnutls_cipher_get_key_size() returns key length in bytes */
@@ -1042,6 +1113,8 @@ static int tls_socket_close(struct Connection *conn)
      * connection.  */
     gnutls_bye(data->state, GNUTLS_SHUT_WR);
 
+    tls_session_save(conn);
+
     gnutls_certificate_free_credentials(data->xcred);
     gnutls_deinit(data->state);
     FREE(&conn->sockdata);
@@ -1091,6 +1164,10 @@ static int tls_socket_read(struct Connection *conn, char *buf, size_t count)
     return -1;
   }
 
+  /* GnuTLS reads the socket itself, so only the payload is counted */
+  if (conn->stats)
+    conn->stats->wire_in += rc;
+
   return rc;
 }
 
@@ -1125,6 +1202,9 @@ static int tls_socket_write(struct Connection *conn, const char *buf, size_t cou
     sent += ret;
   } while (sent < count);
 
+  if (conn->stats)
+    conn->stats->wire_out += sent;
+
   return sent;
 }
 
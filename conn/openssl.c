@@ -42,6 +42,7 @@
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <strings.h>
@@ -86,6 +87,13 @@ static int SkipModeExDataIndex = -1;
  * open up another connection to the same server in this session */
 static STACK_OF(X509) *SslSessionCerts = NULL;
 
+/* Index for storing the Connection in the SSL structure, so that its TLS
+ * session can be saved for resuming */
+static int ConnExDataIndex = -1;
+
+/* TLS sessions that can be resumed, keyed by "host:port" */
+static struct HashTable *SslSessions = NULL;
+
 static int ssl_socket_close(struct Connection *conn);
 
 /**
@@ -96,6 +104,8 @@ struct SslSockData
   SSL_CTX *sctx;
   SSL *ssl;
   unsigned char isopen;
+  uint64_t wire_in;  ///< Bytes read from the socket, so far
+  uint64_t wire_out; ///< Bytes written to the socket, so far
 };
 
 /**
@@ -589,10 +599,80 @@ static int ssl_init(void)
   SSL_load_error_strings();
   SSL_library_init();
 #endif
+  ConnExDataIndex = SSL_get_ex_new_index(0, "conn", NULL, NULL, NULL);
   init_complete = true;
   return 0;
 }
 
+/**
+ * ssl_session_key - Generate the key for a Connection's TLS session
+ * @param conn   Connection to a server
+ * @param buf    Buffer for the key
+ * @param buflen Length of the buffer
+ */
+static void ssl_session_key(struct Connection *conn, char *buf, size_t buflen)
+{
+  snprintf(buf, buflen, "%s:%u", conn->account.host, conn->account.port);
+}
+
+/**
+ * ssl_session_free - Free a TLS session - Implements ::hash_hdata_free_t
+ */
+static void ssl_session_free(int type, void *obj, intptr_t data)
+{
+  SSL_SESSION_free(obj);
+}
+
+/**
+ * ssl_session_new_cb - Save a new TLS session, so it can be resumed
+ * @param ssl  SSL connection
+ * @param sess New TLS session
+ * @retval 1 The session has been kept
+ * @retval 0 The session wasn't wanted
+ *
+ * This is called after the handshake, or for TLS 1.3, whenever the server
+ * sends a new session ticket.
+ */
+static int ssl_session_new_cb(SSL *ssl, SSL_SESSION *sess)
+{
+  struct Connection *conn = SSL_get_ex_data(ssl, ConnExDataIndex);
+  if (!conn)
+    return 0;
+
+  if (!SslSessions)
+  {
+    SslSessions = mutt_hash_new(16, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(SslSessions, ssl_session_free, 0);
+  }
+
+  char key[256];
+  ssl_session_key(conn, key, sizeof(key));
+  mutt_hash_delete(SslSessions, key, NULL);
+  mutt_hash_insert(SslSessions, key, sess);
+  mutt_debug(LL_DEBUG2, "Saved TLS session for %s\n", key);
+  return 1;
+}
+
+/**
+ * ssl_session_resume - Try to resume a Connection's previous TLS session
+ * @param conn Connection to a server
+ * @param ssl  SSL connection
+ *
+ * Resuming a session skips most of the TLS handshake.  If the server doesn't
+ * accept the session, a full handshake is done, as usual.
+ */
+static void ssl_session_resume(struct Connection *conn, SSL *ssl)
+{
+  if ((ConnExDataIndex == -1) || !SSL_set_ex_data(ssl, ConnExDataIndex, conn))
+    return;
+
+  char key[256];
+  ssl_session_key(conn, key, sizeof(key));
+  SSL_SESSION *sess = mutt_hash_find(SslSessions, key);
+  if (sess && (SSL_set_session(ssl, sess) != 1))
+    mutt_hash_delete(SslSessions, key, NULL);
+}
+
 /**
  * ssl_get_client_cert - Get the client certificate for an SSL connection
  * @param ssldata SSL socket data
@@ -1284,11 +1364,26 @@ static int ssl_setup(struct Connection *conn)
     mutt_error(_("Warning: error enabling ssl_verify_partial_chains"));
   }
 
+  /* Keep the sessions ourselves, because each Connection has its own context */
+  SSL_CTX_set_session_cache_mode(sockdata(conn)->sctx,
+                                 SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+  SSL_CTX_sess_set_new_cb(sockdata(conn)->sctx, ssl_session_new_cb);
+
   sockdata(conn)->ssl = SSL_new(sockdata(conn)->sctx);
   SSL_set_fd(sockdata(conn)->ssl, conn->fd);
+  ssl_session_resume(conn, sockdata(conn)->ssl);
 
   if (ssl_negotiate(conn, sockdata(conn)))
+  {
+    /* Don't offer the same session again */
+    char key[256];
+    ssl_session_key(conn, key, sizeof(key));
+    mutt_hash_delete(SslSessions, key, NULL);
     goto free_ssl;
+  }
+
+  if (SSL_session_reused(sockdata(conn)->ssl))
+    mutt_debug(LL_DEBUG2, "Resumed TLS session with %s\n", conn->account.host);
 
   sockdata(conn)->isopen = 1;
   conn->ssf = SSL_CIPHER_get_bits(SSL_get_current_cipher(sockdata(conn)->ssl), &maxbits);
@@ -1336,6 +1431,26 @@ static int ssl_socket_open(struct Connection *conn)
   return rc;
 }
 
+/**
+ * ssl_count_wire - Count the encrypted traffic of a Connection
+ * @param conn Connection to a server
+ *
+ * OpenSSL reads and writes the socket itself, so ask it how much has been sent.
+ */
+static void ssl_count_wire(struct Connection *conn)
+{
+  struct SslSockData *data = sockdata(conn);
+  if (!conn->stats || !data || !data->ssl)
+    return;
+
+  const uint64_t wire_in = BIO_number_read(SSL_get_rbio(data->ssl));
+  const uint64_t wire_out = BIO_number_written(SSL_get_wbio(data->ssl));
+  conn->stats->wire_in += wire_in - data->wire_in;
+  conn->stats->wire_out += wire_out - data->wire_out;
+  data->wire_in = wire_in;
+  data->wire_out = wire_out;
+}
+
 /**
  * ssl_socket_read - Read data from an SSL socket - Implements Connection::read()
  */
@@ -1345,6 +1460,7 @@ static int ssl_socket_read(struct Connection *conn, char *buf, size_t count)
   int rc;
 
   rc = SSL_read(data->ssl, buf, count);
+  ssl_count_wire(conn);
   if ((rc <= 0) || (errno == EINTR))
   {
     if (errno == EINTR)
@@ -1367,6 +1483,7 @@ static int ssl_socket_write(struct Connection *conn, const char *buf, size_t cou
     return -1;
 
   int rc = SSL_write(sockdata(conn)->ssl, buf, count);
+  ssl_count_wire(conn);
   if ((rc <= 0) || (errno == EINTR))
   {
     if (errno == EINTR)
@@ -288,6 +288,9 @@ int raw_socket_read(struct Connection *conn, char *buf, size_t count)
     rc = -1;
   }
 
+  if ((rc > 0) && conn->stats)
+    conn->stats->wire_in += rc;
+
   return rc;
 }
 
@@ -318,6 +321,8 @@ int raw_socket_write(struct Connection *conn, const char *buf, size_t count)
   } while ((sent < count) && (SigInt == 0));
 
   mutt_sig_allow_interrupt(false);
+  if (conn->stats)
+    conn->stats->wire_out += sent;
   return sent;
 }
 
@@ -26,10 +26,17 @@
  * @page conn_socket Low-level socket handling
  *
  * Low-level socket handling
+ *
+ * The traffic of each account is counted in a ConnStats.  The bytes read and
+ * written here are NeoMutt's view of the data.  The backends count the bytes
+ * that cross the network, after compression and encryption.
  */
 
 #include "config.h"
 #include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include "private.h"
@@ -42,6 +49,105 @@
 #include "protos.h"
 #include "ssl.h"
 
+static struct ConnStats *StatsHead = NULL; ///< Network statistics of every account
+
+/**
+ * stats_match - Do some statistics belong to an account?
+ * @param stats Network statistics
+ * @param cac   Account to match
+ * @retval true The account matches
+ *
+ * The port and user are only compared if both are known.
+ */
+static bool stats_match(const struct ConnStats *stats, const struct ConnAccount *cac)
+{
+  if ((stats->type != cac->type) || !mutt_istr_equal(stats->host, cac->host))
+    return false;
+
+  if ((stats->port != 0) && (cac->port != 0) && (stats->port != cac->port))
+    return false;
+
+  if ((stats->user[0] != '\0') && (cac->user[0] != '\0') &&
+      !mutt_str_equal(stats->user, cac->user))
+  {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * stats_get - Get the statistics of an account, creating them if necessary
+ * @param cac Account
+ * @retval ptr Network statistics
+ */
+static struct ConnStats *stats_get(const struct ConnAccount *cac)
+{
+  struct ConnStats **tail = &StatsHead;
+  for (; *tail; tail = &(*tail)->next)
+  {
+    if (stats_match(*tail, cac))
+      return *tail;
+  }
+
+  struct ConnStats *stats = mutt_mem_calloc(1, sizeof(*stats));
+  mutt_str_copy(stats->host, cac->host, sizeof(stats->host));
+  mutt_str_copy(stats->user, cac->user, sizeof(stats->user));
+  stats->port = cac->port;
+  stats->type = cac->type;
+  stats->service = cac->service;
+  *tail = stats;
+  return stats;
+}
+
+/**
+ * socket_read - Read from a Connection, counting the traffic
+ * @param conn Connection to a server
+ * @param buf  Buffer to store read data
+ * @param len  Length of the buffer
+ * @retval >0 Success, number of bytes read
+ * @retval -1 Error, see errno
+ */
+static int socket_read(struct Connection *conn, char *buf, size_t len)
+{
+  if (!conn->stats)
+    return conn->read(conn, buf, len);
+
+  const uint64_t start = mutt_date_monotonic_us();
+  const int rc = conn->read(conn, buf, len);
+
+  conn->stats->read_wait += mutt_date_monotonic_us() - start;
+  conn->stats->reads++;
+  if (rc > 0)
+    conn->stats->bytes_in += rc;
+
+  return rc;
+}
+
+/**
+ * socket_write - Write to a Connection, counting the traffic
+ * @param conn Connection to a server
+ * @param buf  Buffer with data to write
+ * @param len  Length of data to write
+ * @retval >0 Number of bytes written
+ * @retval -1 Error
+ */
+static int socket_write(struct Connection *conn, const char *buf, size_t len)
+{
+  if (!conn->stats)
+    return conn->write(conn, buf, len);
+
+  const uint64_t start = mutt_date_monotonic_us();
+  const int rc = conn->write(conn, buf, len);
+
+  conn->stats->write_wait += mutt_date_monotonic_us() - start;
+  conn->stats->writes++;
+  if (rc > 0)
+    conn->stats->bytes_out += rc;
+
+  return rc;
+}
+
 /**
  * socket_preconnect - Execute a command before opening a socket
  * @retval 0  Success
@@ -80,6 +186,9 @@ int mutt_socket_open(struct Connection *conn)
   if (socket_preconnect())
     return -1;
 
+  if (!conn->stats)
+    conn->stats = stats_get(&conn->account);
+
   rc = conn->open(conn);
 
   mutt_debug(LL_DEBUG2, "Connected to %s:%d on fd=%d\n", conn->account.host,
@@ -124,7 +233,7 @@ int mutt_socket_close(struct Connection *conn)
  */
 int mutt_socket_read(struct Connection *conn, char *buf, size_t len)
 {
-  return conn->read(conn, buf, len);
+  return socket_read(conn, buf, len);
 }
 
 /**
@@ -137,7 +246,7 @@ int mutt_socket_read(struct Connection *conn, char *buf, size_t len)
  */
 int mutt_socket_write(struct Connection *conn, const char *buf, size_t len)
 {
-  return conn->write(conn, buf, len);
+  return socket_write(conn, buf, len);
 }
 
 /**
@@ -163,7 +272,7 @@ int mutt_socket_write_d(struct Connection *conn, const char *buf, int len, int d
 
   while (sent < len)
   {
-    const int rc = conn->write(conn, buf + sent, len - sent);
+    const int rc = socket_write(conn, buf + sent, len - sent);
     if (rc < 0)
     {
       mutt_debug(LL_DEBUG1, "error writing (%s), closing socket\n", strerror(errno));
@@ -212,7 +321,7 @@ int mutt_socket_readchar(struct Connection *conn, char *c)
   if (conn->bufpos >= conn->available)
   {
     if (conn->fd >= 0)
-      conn->available = conn->read(conn, conn->inbuf, sizeof(conn->inbuf));
+      conn->available = socket_read(conn, conn->inbuf, sizeof(conn->inbuf));
     else
     {
       mutt_debug(LL_DEBUG1, "attempt to read from closed connection\n");
@@ -246,10 +355,11 @@ int mutt_socket_readchar(struct Connection *conn, char *c)
 int mutt_socket_readln_d(char *buf, size_t buflen, struct Connection *conn, int dbg)
 {
   char ch;
-  int i;
+  size_t i = 0;
 
-  for (i = 0; i < buflen - 1; i++)
+  while (i < (buflen - 1))
   {
+    /* refill the buffer, if necessary */
     if (mutt_socket_readchar(conn, &ch) != 1)
     {
       buf[i] = '\0';
@@ -258,7 +368,24 @@ int mutt_socket_readln_d(char *buf, size_t buflen, struct Connection *conn, int
 
     if (ch == '\n')
       break;
-    buf[i] = ch;
+    buf[i++] = ch;
+
+    /* copy the rest of the line that's already been received */
+    const char *data = conn->inbuf + conn->bufpos;
+    size_t len = MIN((size_t) (conn->available - conn->bufpos), buflen - 1 - i);
+    const char *nl = memchr(data, '\n', len);
+    if (nl)
+      len = nl - data;
+
+    memcpy(buf + i, data, len);
+    i += len;
+    conn->bufpos += len;
+
+    if (nl)
+    {
+      conn->bufpos++;
+      break;
+    }
   }
 
   /* strip \r from \r\n termination */
@@ -323,3 +450,92 @@ void mutt_socket_empty(struct Connection *conn)
     mutt_socket_read(conn, buf, MIN(bytes, sizeof(buf)));
   }
 }
+
+/**
+ * mutt_socket_rtt - Record the round trip time of a command
+ * @param conn Connection to a server
+ * @param us   Time from sending the command to reading its response, in microseconds
+ */
+void mutt_socket_rtt(struct Connection *conn, uint64_t us)
+{
+  if (!conn || !conn->stats)
+    return;
+
+  struct ConnStats *stats = conn->stats;
+  if (stats->rtt_count == 0)
+  {
+    stats->rtt = us;
+    stats->rtt_min = us;
+    stats->rtt_max = us;
+  }
+  else
+  {
+    stats->rtt = ((stats->rtt * 7) + us) / 8;
+    if (us < stats->rtt_min)
+      stats->rtt_min = us;
+    if (us > stats->rtt_max)
+      stats->rtt_max = us;
+  }
+  stats->rtt_count++;
+}
+
+/**
+ * mutt_socket_stats_dump - Write a report of the network statistics
+ * @param fp File to write to
+ */
+void mutt_socket_stats_dump(FILE *fp)
+{
+  fprintf(fp, "%-40s %10s %10s %10s %10s %8s %8s %10s %10s %8s %8s %8s\n",
+          "account", "bytes in", "bytes out", "wire in", "wire out", "reads",
+          "writes", "read ms", "write ms", "rtt ms", "min ms", "max ms");
+
+  char name[300];
+  for (struct ConnStats *stats = StatsHead; stats; stats = stats->next)
+  {
+    snprintf(name, sizeof(name), "%s://%s%s%s:%hu", NONULL(stats->service),
+             stats->user, (stats->user[0] != '\0') ? "@" : "", stats->host, stats->port);
+
+    fprintf(fp, "%-40s %10llu %10llu %10llu %10llu %8llu %8llu %10.1f %10.1f %8.3f %8.3f %8.3f\n",
+            name, (unsigned long long) stats->bytes_in,
+            (unsigned long long) stats->bytes_out, (unsigned long long) stats->wire_in,
+            (unsigned long long) stats->wire_out, (unsigned long long) stats->reads,
+            (unsigned long long) stats->writes, stats->read_wait / 1e3,
+            stats->write_wait / 1e3, stats->rtt / 1e3, stats->rtt_min / 1e3,
+            stats->rtt_max / 1e3);
+  }
+}
+
+/**
+ * mutt_socket_stats_find - Find the network statistics of an account
+ * @param cac Account
+ * @retval ptr  Network statistics
+ * @retval NULL The account hasn't connected
+ */
+struct ConnStats *mutt_socket_stats_find(const struct ConnAccount *cac)
+{
+  if (!cac)
+    return NULL;
+
+  for (struct ConnStats *stats = StatsHead; stats; stats = stats->next)
+  {
+    if (stats_match(stats, cac))
+      return stats;
+  }
+
+  return NULL;
+}
+
+/**
+ * mutt_socket_stats_free - Free the network statistics
+ *
+ * @note This must only be called once all the Connections have been freed.
+ */
+void mutt_socket_stats_free(void)
+{
+  while (StatsHead)
+  {
+    struct ConnStats *next = StatsHead->next;
+    FREE(&StatsHead);
+    StatsHead = next;
+  }
+}
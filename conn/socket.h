@@ -24,8 +24,11 @@
 #ifndef MUTT_CONN_SOCKET_H
 #define MUTT_CONN_SOCKET_H
 
+#include <stdint.h>
+#include <stdio.h>
 #include <time.h>
 
+struct ConnAccount;
 struct Connection;
 
 /**
@@ -46,6 +49,10 @@ int                mutt_socket_poll    (struct Connection *conn, time_t wait_sec
 int                mutt_socket_read    (struct Connection *conn, char *buf, size_t len);
 int                mutt_socket_readchar(struct Connection *conn, char *c);
 int                mutt_socket_readln_d(char *buf, size_t buflen, struct Connection *conn, int dbg);
+void               mutt_socket_rtt     (struct Connection *conn, uint64_t us);
+void               mutt_socket_stats_dump(FILE *fp);
+struct ConnStats * mutt_socket_stats_find(const struct ConnAccount *cac);
+void               mutt_socket_stats_free(void);
 int                mutt_socket_write   (struct Connection *conn, const char *buf, size_t len);
 int                mutt_socket_write_d (struct Connection *conn, const char *buf, int len, int dbg);
 
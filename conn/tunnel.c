@@ -150,6 +150,9 @@ static int tunnel_socket_read(struct Connection *conn, char *buf, size_t count)
     return -1;
   }
 
+  if (conn->stats)
+    conn->stats->wire_in += rc;
+
   return rc;
 }
 
@@ -178,6 +181,9 @@ static int tunnel_socket_write(struct Connection *conn, const char *buf, size_t
     sent += rc;
   } while (sent < count);
 
+  if (conn->stats)
+    conn->stats->wire_out += sent;
+
   return sent;
 }
 
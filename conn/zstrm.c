@@ -23,6 +23,13 @@
  * @page conn_zstrm Zlib compression of network traffic
  *
  * Zlib compression of network traffic
+ *
+ * The data read from the server is inflated into the caller's buffer, as much
+ * of it as has already arrived.  A bulk download, e.g. of headers, is handed
+ * over in large blocks, rather than one inflate() per network packet.
+ *
+ * When the Connection is closed, the compression ratio and the CPU time spent
+ * (de-)compressing are logged.
  */
 
 #include "config.h"
@@ -35,6 +42,13 @@
 #include "zstrm.h"
 #include "lib.h"
 
+/// Size of the buffer for compressed data from the server
+#define ZSTRM_READ_SIZE 32768
+/// Size of the buffer for compressed data to the server
+#define ZSTRM_WRITE_SIZE 8192
+/// Window size (log2) for data to the server; the commands are short
+#define ZSTRM_WRITE_WINDOW 12
+
 /**
  * struct ZstrmDirection - A stream of data being (de-)compressed
  */
@@ -44,6 +58,8 @@ struct ZstrmDirection
   char *buf;           ///< Buffer for data being (de-)compressed
   unsigned int len;    ///< Length of data
   unsigned int pos;    ///< Current position
+  unsigned int calls;  ///< Number of calls to inflate() or deflate()
+  clock_t cpu;         ///< CPU time spent in inflate() or deflate()
   bool conn_eof : 1;   ///< Connection end-of-file reached
   bool stream_eof : 1; ///< Stream end-of-file reached
 };
@@ -100,11 +116,15 @@ static int zstrm_close(struct Connection *conn)
 
   int rc = zctx->next_conn.close(&zctx->next_conn);
 
-  mutt_debug(LL_DEBUG5, "read %llu->%llu (%.1fx) wrote %llu<-%llu (%.1fx)\n",
-             zctx->read.z.total_in, zctx->read.z.total_out,
-             (float) zctx->read.z.total_out / (float) zctx->read.z.total_in,
-             zctx->write.z.total_in, zctx->write.z.total_out,
-             (float) zctx->write.z.total_in / (float) zctx->write.z.total_out);
+  const struct ZstrmDirection *r = &zctx->read;
+  const struct ZstrmDirection *w = &zctx->write;
+  mutt_debug(LL_DEBUG2,
+             "read %lu->%lu (%.1fx, %u calls, %ld ms), wrote %lu<-%lu (%.1fx, %u calls, %ld ms)\n",
+             r->z.total_in, r->z.total_out,
+             r->z.total_in ? (double) r->z.total_out / r->z.total_in : 0.0,
+             r->calls, (long) (r->cpu * 1000 / CLOCKS_PER_SEC), w->z.total_out,
+             w->z.total_in, w->z.total_out ? (double) w->z.total_in / w->z.total_out : 0.0,
+             w->calls, (long) (w->cpu * 1000 / CLOCKS_PER_SEC));
 
   // Restore the Connection's original functions
   conn->sockdata = zctx->next_conn.sockdata;
@@ -125,84 +145,82 @@ static int zstrm_close(struct Connection *conn)
 
 /**
  * zstrm_read - Read compressed data from a socket - Implements Connection::read()
+ *
+ * Inflate data until the buffer is full, or until the next stream would
+ * block.  Only the first read from the next stream may block.
  */
 static int zstrm_read(struct Connection *conn, char *buf, size_t len)
 {
   struct ZstrmContext *zctx = conn->sockdata;
-  int rc = 0;
-  int zrc = 0;
+  size_t done = 0;
 
-retry:
-  if (zctx->read.stream_eof)
-    return 0;
-
-  /* when avail_out was 0 on last call, we need to call inflate again, because
-   * more data might be available using the current input, so avoid callling
-   * read on the underlying stream in that case (for it might block) */
-  if ((zctx->read.pos == 0) && !zctx->read.conn_eof)
+  while (!zctx->read.stream_eof && (done < len))
   {
-    rc = zctx->next_conn.read(&zctx->next_conn, zctx->read.buf, zctx->read.len);
-    mutt_debug(LL_DEBUG5, "consuming data from next stream: %d bytes\n", rc);
-    if (rc < 0)
-      return rc;
-    else if (rc == 0)
-      zctx->read.conn_eof = true;
-    else
-      zctx->read.pos += rc;
-  }
+    /* when avail_out was 0 on last call, we need to call inflate again, because
+     * more data might be available using the current input, so avoid callling
+     * read on the underlying stream in that case (for it might block) */
+    if ((zctx->read.pos == 0) && !zctx->read.conn_eof)
+    {
+      if ((done > 0) && (zctx->next_conn.poll(&zctx->next_conn, 0) <= 0))
+        break;
 
-  zctx->read.z.avail_in = (uInt) zctx->read.pos;
-  zctx->read.z.next_in = (Bytef *) zctx->read.buf;
-  zctx->read.z.avail_out = (uInt) len;
-  zctx->read.z.next_out = (Bytef *) buf;
+      int rc = zctx->next_conn.read(&zctx->next_conn, zctx->read.buf, zctx->read.len);
+      mutt_debug(LL_DEBUG5, "consuming data from next stream: %d bytes\n", rc);
+      if (rc < 0)
+        return (done > 0) ? (int) done : rc;
+      else if (rc == 0)
+        zctx->read.conn_eof = true;
+      else
+        zctx->read.pos += rc;
+    }
 
-  zrc = inflate(&zctx->read.z, Z_SYNC_FLUSH);
-  mutt_debug(LL_DEBUG5, "rc=%d, consumed %u/%u bytes, produced %u/%u bytes\n",
-             zrc, zctx->read.pos - zctx->read.z.avail_in, zctx->read.pos,
-             len - zctx->read.z.avail_out, len);
+    zctx->read.z.avail_in = (uInt) zctx->read.pos;
+    zctx->read.z.next_in = (Bytef *) zctx->read.buf;
+    zctx->read.z.avail_out = (uInt) (len - done);
+    zctx->read.z.next_out = (Bytef *) buf + done;
 
-  /* shift any remaining input data to the front of the buffer */
-  if ((Bytef *) zctx->read.buf != zctx->read.z.next_in)
-  {
-    memmove(zctx->read.buf, zctx->read.z.next_in, zctx->read.z.avail_in);
-    zctx->read.pos = zctx->read.z.avail_in;
-  }
+    const clock_t start = clock();
+    int zrc = inflate(&zctx->read.z, Z_SYNC_FLUSH);
+    zctx->read.cpu += clock() - start;
+    zctx->read.calls++;
 
-  switch (zrc)
-  {
-    case Z_OK:                            /* progress has been made */
-      zrc = len - zctx->read.z.avail_out; /* "returned" bytes */
-      if (zrc == 0)
-      {
-        /* there was progress, so must have been reading input */
-        mutt_debug(LL_DEBUG5, "inflate just consumed\n");
-        goto retry;
-      }
-      break;
+    const size_t produced = (len - done) - zctx->read.z.avail_out;
+    mutt_debug(LL_DEBUG5, "rc=%d, consumed %u/%u bytes, produced %zu/%zu bytes\n",
+               zrc, zctx->read.pos - zctx->read.z.avail_in, zctx->read.pos,
+               produced, len - done);
+    done += produced;
 
-    case Z_STREAM_END: /* everything flushed, nothing remaining */
-      mutt_debug(LL_DEBUG5, "inflate returned Z_STREAM_END.\n");
-      zrc = len - zctx->read.z.avail_out; /* "returned" bytes */
-      zctx->read.stream_eof = true;
-      break;
+    /* shift any remaining input data to the front of the buffer */
+    if ((Bytef *) zctx->read.buf != zctx->read.z.next_in)
+    {
+      memmove(zctx->read.buf, zctx->read.z.next_in, zctx->read.z.avail_in);
+      zctx->read.pos = zctx->read.z.avail_in;
+    }
 
-    case Z_BUF_ERROR: /* no progress was possible */
-      if (!zctx->read.conn_eof)
-      {
+    switch (zrc)
+    {
+      case Z_OK: /* progress has been made */
+        break;
+
+      case Z_STREAM_END: /* everything flushed, nothing remaining */
+        mutt_debug(LL_DEBUG5, "inflate returned Z_STREAM_END.\n");
+        zctx->read.stream_eof = true;
+        break;
+
+      case Z_BUF_ERROR: /* no progress was possible */
+        if (zctx->read.conn_eof)
+          return (int) done;
         mutt_debug(LL_DEBUG5, "inflate returned Z_BUF_ERROR. retrying.\n");
-        goto retry;
-      }
-      zrc = 0;
-      break;
-
-    default:
-      /* bail on other rcs, such as Z_DATA_ERROR, or Z_MEM_ERROR */
-      mutt_debug(LL_DEBUG5, "inflate returned %d. aborting.\n", zrc);
-      zrc = -1;
-      break;
+        break;
+
+      default:
+        /* bail on other rcs, such as Z_DATA_ERROR, or Z_MEM_ERROR */
+        mutt_debug(LL_DEBUG5, "inflate returned %d. aborting.\n", zrc);
+        return -1;
+    }
   }
 
-  return zrc;
+  return (int) done;
 }
 
 /**
@@ -237,7 +255,10 @@ static int zstrm_write(struct Connection *conn, const char *buf, size_t count)
 
   do
   {
+    const clock_t start = clock();
     int zrc = deflate(&zctx->write.z, Z_PARTIAL_FLUSH);
+    zctx->write.cpu += clock() - start;
+    zctx->write.calls++;
     if (zrc == Z_OK)
     {
       /* push out produced data to the underlying stream */
@@ -307,10 +328,10 @@ void mutt_zstrm_wrap_conn(struct Connection *conn)
   conn->poll = zstrm_poll;
 
   /* allocate/setup (de)compression buffers */
-  zctx->read.len = 8192;
+  zctx->read.len = ZSTRM_READ_SIZE;
   zctx->read.buf = mutt_mem_malloc(zctx->read.len);
   zctx->read.pos = 0;
-  zctx->write.len = 8192;
+  zctx->write.len = ZSTRM_WRITE_SIZE;
   zctx->write.buf = mutt_mem_malloc(zctx->write.len);
   zctx->write.pos = 0;
 
@@ -324,5 +345,7 @@ void mutt_zstrm_wrap_conn(struct Connection *conn)
   zctx->write.z.zfree = zstrm_free;
   zctx->write.z.opaque = NULL;
   zctx->write.z.avail_out = zctx->write.len;
-  deflateInit2(&zctx->write.z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+  /* The server inflates with the largest window, so a smaller one is fine */
+  deflateInit2(&zctx->write.z, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+               -ZSTRM_WRITE_WINDOW, 8, Z_DEFAULT_STRATEGY);
 }
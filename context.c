@@ -107,6 +107,9 @@ static void ctx_cleanup(struct Context *ctx)
  * @param ctx          Mailbox
  *
  * this routine is called to update the counts in the context structure
+ *
+ * If emails have only been appended to the Mailbox, the threads are kept and
+ * the new emails are linked into them.
  */
 void ctx_update(struct Context *ctx)
 {
@@ -115,8 +118,12 @@ void ctx_update(struct Context *ctx)
 
   struct Mailbox *m = ctx->mailbox;
 
-  mutt_hash_free(&m->subj_hash);
-  mutt_hash_free(&m->id_hash);
+  const bool appended = mutt_thread_only_appended(ctx->threads);
+  if (!appended)
+  {
+    mutt_hash_free(&m->subj_hash);
+    mutt_hash_free(&m->id_hash);
+  }
 
   /* reset counters */
   m->msg_unread = 0;
@@ -127,7 +134,8 @@ void ctx_update(struct Context *ctx)
   m->vcount = 0;
   m->changed = false;
 
-  mutt_clear_threads(ctx->threads);
+  if (!appended)
+    mutt_clear_threads(ctx->threads);
 
   struct Email *e = NULL;
   for (int msgno = 0; msgno < m->msg_count; msgno++)
@@ -136,7 +144,10 @@ void ctx_update(struct Context *ctx)
     if (!e)
       continue;
 
-    if (WithCrypto)
+    /* emails that are already threaded don't need to be checked again */
+    const bool is_new = !appended || !e->thread;
+
+    if (WithCrypto && is_new)
     {
       /* NOTE: this _must_ be done before the check for mailcap! */
       e->security = crypt_query(e->body);
@@ -144,7 +155,9 @@ void ctx_update(struct Context *ctx)
 
     if (ctx_has_limit(ctx))
     {
-      e->vnum = -1;
+      /* Emails already checked against the limit keep their place in it */
+      if (!ctx_limit_checked(ctx, e) || !e->visible)
+        e->vnum = -1;
     }
     else
     {
@@ -153,32 +166,35 @@ void ctx_update(struct Context *ctx)
     }
     e->msgno = msgno;
 
-    const bool c_score = cs_subset_bool(NeoMutt->sub, "score");
-    if (e->env->supersedes)
+    if (is_new)
     {
-      struct Email *e2 = NULL;
-
-      if (!m->id_hash)
-        m->id_hash = mutt_make_id_hash(m);
-
-      e2 = mutt_hash_find(m->id_hash, e->env->supersedes);
-      if (e2)
+      const bool c_score = cs_subset_bool(NeoMutt->sub, "score");
+      if (e->env->supersedes)
       {
-        e2->superseded = true;
-        if (c_score)
-          mutt_score_message(ctx->mailbox, e2, true);
+        struct Email *e2 = NULL;
+
+        if (!m->id_hash)
+          m->id_hash = mutt_make_id_hash(m);
+
+        e2 = mutt_hash_find(m->id_hash, e->env->supersedes);
+        if (e2)
+        {
+          e2->superseded = true;
+          if (c_score)
+            mutt_score_message(ctx->mailbox, e2, true);
+        }
       }
-    }
 
-    /* add this message to the hash tables */
-    if (m->id_hash && e->env->message_id)
-      mutt_hash_insert(m->id_hash, e->env->message_id, e);
-    if (m->subj_hash && e->env->real_subj)
-      mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
-    mutt_label_hash_add(m, e);
+      /* add this message to the hash tables */
+      if (m->id_hash && e->env->message_id)
+        mutt_hash_insert(m->id_hash, e->env->message_id, e);
+      if (m->subj_hash && e->env->real_subj)
+        mutt_hash_insert(m->subj_hash, e->env->real_subj, e);
+      mutt_label_hash_add(m, e);
 
-    if (c_score)
-      mutt_score_message(ctx->mailbox, e, false);
+      if (c_score)
+        mutt_score_message(ctx->mailbox, e, false);
+    }
 
     if (e->changed)
       m->changed = true;
@@ -196,8 +212,8 @@ void ctx_update(struct Context *ctx)
     }
   }
 
-  /* rethread from scratch */
-  mutt_sort_headers(ctx->mailbox, ctx->threads, true, &ctx->vsize);
+  /* rethread from scratch, unless the new emails can be linked in */
+  mutt_sort_headers(ctx->mailbox, ctx->threads, !appended, &ctx->vsize);
 }
 
 /**
@@ -212,6 +228,7 @@ static void update_tables(struct Context *ctx)
   struct Mailbox *m = ctx->mailbox;
 
   int i, j, padding;
+  bool rethread = false;
 
   /* update memory to reflect the new state of the mailbox */
   m->vcount = 0;
@@ -223,13 +240,13 @@ static void update_tables(struct Context *ctx)
   m->changed = false;
   m->msg_flagged = 0;
   padding = mx_msg_padding_size(m);
+  const bool c_maildir_trash = cs_subset_bool(NeoMutt->sub, "maildir_trash");
+  const bool keep_deleted = (m->type == MUTT_MAILDIR) && c_maildir_trash;
   for (i = 0, j = 0; i < m->msg_count; i++)
   {
     if (!m->emails[i])
       break;
-    const bool c_maildir_trash = cs_subset_bool(NeoMutt->sub, "maildir_trash");
-    if (!m->emails[i]->quasi_deleted &&
-        (!m->emails[i]->deleted || ((m->type == MUTT_MAILDIR) && c_maildir_trash)))
+    if (!m->emails[i]->quasi_deleted && (!m->emails[i]->deleted || keep_deleted))
     {
       if (i != j)
       {
@@ -248,11 +265,8 @@ static void update_tables(struct Context *ctx)
       m->emails[j]->changed = false;
       m->emails[j]->env->changed = false;
 
-      if ((m->type == MUTT_MAILDIR) && c_maildir_trash)
-      {
-        if (m->emails[j]->deleted)
-          m->msg_deleted++;
-      }
+      if (keep_deleted && m->emails[j]->deleted)
+        m->msg_deleted++;
 
       if (m->emails[j]->tagged)
         m->msg_tagged++;
@@ -281,6 +295,10 @@ static void update_tables(struct Context *ctx)
         mutt_hash_delete(m->id_hash, m->emails[i]->env->message_id, m->emails[i]);
       mutt_label_hash_remove(m, m->emails[i]);
 
+      /* keep the threads intact, if possible */
+      if (m->emails[i]->thread && !mutt_thread_remove_email(ctx->threads, m->emails[i]))
+        rethread = true;
+
 #ifdef USE_IMAP
       if (m->type == MUTT_IMAP)
         imap_notify_delete_email(m, m->emails[i]);
@@ -291,6 +309,9 @@ static void update_tables(struct Context *ctx)
     }
   }
   m->msg_count = j;
+
+  if (rethread)
+    mutt_clear_threads(ctx->threads);
 }
 
 /**
@@ -320,6 +341,12 @@ int ctx_mailbox_observer(struct NotifyCallback *nc)
     case NT_MAILBOX_RESORT:
       mutt_sort_headers(ctx->mailbox, ctx->threads, true, &ctx->vsize);
       break;
+    case NT_MAILBOX_EXPUNGE:
+      /* the remaining emails are still in order, so unless the threads had to
+       * be cleared, only the display needs updating */
+      update_tables(ctx);
+      mutt_sort_headers(ctx->mailbox, ctx->threads, false, &ctx->vsize);
+      break;
   }
 
   return 0;
@@ -345,6 +372,8 @@ bool message_is_tagged(struct Email *e)
  * @param use_tagged Use tagged Emails
  * @retval num Number of selected emails
  * @retval -1  Error
+ *
+ * The search stops once all of the Mailbox's tagged Emails have been seen.
  */
 int el_add_tagged(struct EmailList *el, struct Context *ctx, struct Email *e, bool use_tagged)
 {
@@ -356,14 +385,19 @@ int el_add_tagged(struct EmailList *el, struct Context *ctx, struct Email *e, bo
       return -1;
 
     struct Mailbox *m = ctx->mailbox;
-    for (size_t i = 0; i < m->msg_count; i++)
+    int seen = 0;
+    for (size_t i = 0; (i < m->msg_count) && (seen < m->msg_tagged); i++)
     {
       e = m->emails[i];
       if (!e)
         break;
-      if (!message_is_tagged(e))
+      if (!e->tagged)
+        continue;
+      seen++;
+      if (!e->visible)
         continue;
 
+      email_env_load(e);
       struct EmailNode *en = mutt_mem_calloc(1, sizeof(*en));
       en->email = e;
       STAILQ_INSERT_TAIL(el, en, entries);
@@ -375,6 +409,7 @@ int el_add_tagged(struct EmailList *el, struct Context *ctx, struct Email *e, bo
     if (!e)
       return -1;
 
+    email_env_load(e);
     struct EmailNode *en = mutt_mem_calloc(1, sizeof(*en));
     en->email = e;
     STAILQ_INSERT_TAIL(el, en, entries);
@@ -420,6 +455,19 @@ bool ctx_has_limit(const struct Context *ctx)
   return ctx && ctx->pattern;
 }
 
+/**
+ * ctx_limit_checked - Has an Email been checked against the limit?
+ * @param ctx Context
+ * @param e   Email
+ * @retval true The Email was in the Mailbox when the limit was last applied
+ *
+ * If so, Email::visible records whether it matched.
+ */
+bool ctx_limit_checked(const struct Context *ctx, const struct Email *e)
+{
+  return ctx && e && (e->sequence < ctx->limit_seq);
+}
+
 /**
  * ctx_mailbox - wrapper to get the mailbox in a Context, or NULL
  * @param ctx Context
@@ -39,6 +39,7 @@ struct Context
   off_t vsize;                       ///< Size (in bytes) of the messages shown
   char *pattern;                     ///< Limit pattern string
   struct PatternList *limit_pattern; ///< Compiled limit pattern
+  size_t limit_seq;                  ///< Emails with a lower Email::sequence have been checked against the limit
   struct ThreadsContext *threads;    ///< Threads context
   int msg_in_pager;                  ///< Message currently shown in the pager
 
@@ -74,6 +75,7 @@ int             ctx_mailbox_observer(struct NotifyCallback *nc);
 struct Context *ctx_new             (struct Mailbox *m);
 void            ctx_update          (struct Context *ctx);
 bool            ctx_has_limit       (const struct Context *ctx);
+bool            ctx_limit_checked   (const struct Context *ctx, const struct Email *e);
 struct Mailbox* ctx_mailbox         (struct Context *ctx);
 
 bool message_is_tagged(struct Email *e);
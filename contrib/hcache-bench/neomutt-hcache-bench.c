@@ -0,0 +1,754 @@
+/**
+ * @file
+ * Benchmark the header cache backends and compression methods
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page hc_bench Header cache benchmark
+ *
+ * Benchmark the header cache backends and compression methods.
+ *
+ * A synthetic corpus of Emails is generated from a seed, so runs are
+ * reproducible.  For each combination of backend, compression method and
+ * level, every Email is stored, fetched and deleted through the hcache API.
+ * The throughput, the median and 99th percentile latencies and the size of
+ * the cache on disk are reported.
+ *
+ * Run it with `make bench-hcache`, or directly; see `-h` for the options.
+ */
+
+#include "config.h"
+#include <dirent.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "compress/lib.h"
+#include "hcache/lib.h"
+#include "store/lib.h"
+
+bool config_init_hcache(struct ConfigSet *cs);
+
+#define CONFIG_INIT_TYPE(CS, NAME)                                             \
+  extern const struct ConfigSetType cst_##NAME;                                \
+  cs_register_type(CS, &cst_##NAME)
+
+/* The benchmark doesn't link the main neomutt objects */
+char *HomeDir = NULL;
+
+/**
+ * mutt_encode_path - Convert a path to 'us-ascii'
+ * @param buf Buffer for the result
+ * @param src Path to convert (OPTIONAL)
+ *
+ * The benchmark only uses its own ASCII paths, so no conversion is needed.
+ */
+void mutt_encode_path(struct Buffer *buf, const char *src)
+{
+  mutt_buffer_strcpy(buf, src);
+}
+
+/**
+ * enum BenchDist - Distribution of the synthetic corpus
+ */
+enum BenchDist
+{
+  BENCH_DIST_UNIFORM, ///< Senders and subjects are picked evenly
+  BENCH_DIST_SKEWED,  ///< A few senders and threads dominate, like a mailing list
+};
+
+/**
+ * struct BenchOptions - Command line options
+ */
+struct BenchOptions
+{
+  int count;            ///< Number of Emails in the corpus
+  int repeat;           ///< Number of times to run each combination
+  int max_refs;         ///< Maximum length of the References header
+  unsigned int seed;    ///< Seed for the corpus generator
+  enum BenchDist dist;  ///< Distribution of the corpus
+  const char *backends; ///< Backends to test, comma-separated
+  const char *methods;  ///< Compression methods to test, comma-separated
+  const char *levels;   ///< Compression levels to test, comma-separated
+  const char *tmpdir;   ///< Where to create the caches
+};
+
+/**
+ * struct BenchTimes - Latencies of one kind of operation
+ */
+struct BenchTimes
+{
+  uint64_t *ns;    ///< Latency of each operation, in nanoseconds
+  size_t count;    ///< Number of operations
+  uint64_t total;  ///< Total time, including transactions, in nanoseconds
+};
+
+/**
+ * struct BenchResult - Results for one combination of backend and compression
+ */
+struct BenchResult
+{
+  struct BenchTimes store;  ///< Storing every Email
+  struct BenchTimes fetch;  ///< Fetching every Email
+  struct BenchTimes remove; ///< Deleting every Email
+  long long disk;           ///< Size on disk, after storing everything
+  int misses;               ///< Number of failed fetches
+};
+
+static uint32_t RandState = 1; ///< State of the corpus generator
+
+static const char *Names[] = {
+  "Alice Archer", "Bob Baker",   "Carol Clark",  "Dave Dawson",
+  "Erin Evans",   "Frank Foster", "Grace Green", "Heidi Hughes",
+  "Ivan Irving",  "Judy Jones",  "Mallory Moss", "Niaj Norris",
+  "Olivia Owens", "Peggy Price", "Rupert Reed",  "Sybil Stone",
+};
+
+static const char *Words[] = {
+  "build",   "release", "patch",  "review",  "crash",   "config",
+  "header",  "cache",   "thread", "index",   "sidebar", "folder",
+  "compose", "attach",  "crypto", "charset", "pager",   "notmuch",
+  "imap",    "maildir", "speed",  "memory",  "docs",    "question",
+};
+
+/**
+ * bench_rand - Get the next pseudo-random number
+ * @retval num Random number
+ *
+ * A xorshift generator, so that the corpus only depends on the seed.
+ */
+static uint32_t bench_rand(void)
+{
+  uint32_t x = RandState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  RandState = x;
+  return x;
+}
+
+/**
+ * bench_pick - Pick a random index
+ * @param n    Number of choices
+ * @param dist Distribution to use
+ * @retval num Index, between 0 and n-1
+ */
+static size_t bench_pick(size_t n, enum BenchDist dist)
+{
+  if (dist == BENCH_DIST_SKEWED)
+  {
+    /* Squaring a uniform number favours the low indices */
+    double r = (double) bench_rand() / UINT32_MAX;
+    return (size_t) (r * r * (n - 1) + 0.5);
+  }
+
+  return bench_rand() % n;
+}
+
+/**
+ * bench_now - Get the time from a monotonic clock
+ * @retval num Time in nanoseconds
+ */
+static uint64_t bench_now(void)
+{
+  struct timespec ts = { 0 };
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/**
+ * bench_address - Generate an address
+ * @param al   AddressList to add to
+ * @param dist Distribution to use
+ */
+static void bench_address(struct AddressList *al, enum BenchDist dist)
+{
+  const char *name = Names[bench_pick(mutt_array_size(Names), dist)];
+  char mailbox[128];
+
+  snprintf(mailbox, sizeof(mailbox), "%s@example.org", name);
+  for (char *p = mailbox; *p; p++)
+  {
+    if (*p == ' ')
+      *p = '.';
+  }
+
+  mutt_addrlist_append(al, mutt_addr_create(name, mailbox));
+}
+
+/**
+ * bench_email - Generate a synthetic Email
+ * @param opts Command line options
+ * @param i    Index of the Email in the corpus
+ * @retval ptr New Email
+ */
+static struct Email *bench_email(const struct BenchOptions *opts, int i)
+{
+  struct Email *e = email_new();
+  struct Envelope *env = mutt_env_new();
+  e->env = env;
+
+  bench_address(&env->from, opts->dist);
+  for (int n = 1 + bench_rand() % 3; n > 0; n--)
+    bench_address(&env->to, opts->dist);
+  for (int n = bench_rand() % 4; n > 0; n--)
+    bench_address(&env->cc, opts->dist);
+
+  /* Replies share the subject, and references, of an earlier thread */
+  int thread = bench_pick(MAX(i, 1), opts->dist);
+  bool reply = (i > 0) && ((bench_rand() % 2) == 0);
+
+  char buf[256];
+  int len = snprintf(buf, sizeof(buf), "%s[list] thread %d:", reply ? "Re: " : "", thread);
+  uint32_t words_state = RandState;
+  RandState = thread + 1;
+  for (int n = 2 + bench_rand() % 8; n > 0; n--)
+    len += snprintf(buf + len, sizeof(buf) - len, " %s", Words[bench_rand() % mutt_array_size(Words)]);
+  RandState = words_state;
+
+  env->subject = mutt_str_dup(buf);
+  env->real_subj = env->subject + (reply ? 4 : 0);
+
+  snprintf(buf, sizeof(buf), "<%d.%u@bench.example.org>", i, opts->seed);
+  env->message_id = mutt_str_dup(buf);
+
+  if (reply)
+  {
+    int refs = 1 + bench_rand() % MAX(opts->max_refs, 1);
+    for (int n = 0; (n < refs) && (n <= thread); n++)
+    {
+      snprintf(buf, sizeof(buf), "<%d.%u@bench.example.org>", thread - n, opts->seed);
+      mutt_list_insert_tail(&env->references, mutt_str_dup(buf));
+    }
+    snprintf(buf, sizeof(buf), "<%d.%u@bench.example.org>", thread, opts->seed);
+    mutt_list_insert_tail(&env->in_reply_to, mutt_str_dup(buf));
+  }
+
+  e->body = mutt_body_new();
+  e->body->type = TYPE_TEXT;
+  e->body->subtype = mutt_str_dup("plain");
+  e->body->encoding = ENC_7BIT;
+  e->body->length = 200 + bench_rand() % 20000;
+
+  e->date_sent = 1600000000 + (i * 60);
+  e->received = e->date_sent + bench_rand() % 600;
+  e->lines = e->body->length / 60;
+  e->read = (bench_rand() % 4) != 0;
+  e->flagged = (bench_rand() % 20) == 0;
+  e->replied = (bench_rand() % 10) == 0;
+  if ((bench_rand() % 10) == 0)
+    driver_tags_add(&e->tags, mutt_str_dup("inbox"));
+
+  return e;
+}
+
+/**
+ * bench_key - Generate the hcache key of an Email
+ * @param buf Buffer for the key
+ * @param i   Index of the Email in the corpus
+ */
+static void bench_key(struct Buffer *buf, int i)
+{
+  mutt_buffer_printf(buf, "%d.M%dP%d.bench", 1600000000 + (i * 60), i * 7, i);
+}
+
+/**
+ * bench_time - Record the latency of an operation
+ * @param bt    Latencies
+ * @param start Start time, from bench_now()
+ */
+static void bench_time(struct BenchTimes *bt, uint64_t start)
+{
+  bt->ns[bt->count++] = bench_now() - start;
+}
+
+/**
+ * bench_cmp - Compare two latencies - Implements ::sort_t
+ */
+static int bench_cmp(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * bench_disk_size - Get the total size of the files in a directory
+ * @param path Directory
+ * @retval num Size in bytes
+ */
+static long long bench_disk_size(const char *path)
+{
+  DIR *dir = opendir(path);
+  if (!dir)
+    return 0;
+
+  long long size = 0;
+  struct Buffer *file = mutt_buffer_pool_get();
+  struct dirent *de = NULL;
+  while ((de = readdir(dir)))
+  {
+    if (mutt_str_equal(de->d_name, ".") || mutt_str_equal(de->d_name, ".."))
+      continue;
+
+    mutt_buffer_concat_path(file, path, de->d_name);
+    struct stat st = { 0 };
+    if (lstat(mutt_buffer_string(file), &st) != 0)
+      continue;
+
+    if (S_ISDIR(st.st_mode))
+      size += bench_disk_size(mutt_buffer_string(file));
+    else
+      size += (long long) st.st_blocks * 512;
+  }
+
+  mutt_buffer_pool_release(&file);
+  closedir(dir);
+  return size;
+}
+
+/**
+ * bench_run - Benchmark one combination of backend and compression
+ * @param opts   Command line options
+ * @param corpus Emails to store
+ * @param order  Order in which to fetch the Emails
+ * @param dir    Empty directory for the cache
+ * @param res    Results, accumulated
+ * @retval true Success
+ */
+static bool bench_run(const struct BenchOptions *opts, struct Email **corpus,
+                      const int *order, const char *dir, struct BenchResult *res)
+{
+  struct Buffer *path = mutt_buffer_pool_get();
+  struct Buffer *key = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s/", dir);
+  bool rc = false;
+
+  /* Store the corpus in one batch, like a mailbox being opened */
+  struct HeaderCache *hc = mutt_hcache_open(mutt_buffer_string(path), "bench", NULL);
+  if (!hc)
+    goto done;
+
+  uint64_t start = bench_now();
+  mutt_hcache_begin_txn(hc);
+  for (int i = 0; i < opts->count; i++)
+  {
+    bench_key(key, i);
+    uint64_t t = bench_now();
+    mutt_hcache_store(hc, mutt_buffer_string(key), mutt_buffer_len(key), corpus[i], 0);
+    bench_time(&res->store, t);
+  }
+  mutt_hcache_commit_txn(hc);
+  mutt_hcache_close(hc);
+  res->store.total += bench_now() - start;
+  res->disk += bench_disk_size(dir);
+
+  /* Reopen the cache and fetch the corpus in random order */
+  hc = mutt_hcache_open(mutt_buffer_string(path), "bench", NULL);
+  if (!hc)
+    goto done;
+
+  start = bench_now();
+  for (int i = 0; i < opts->count; i++)
+  {
+    bench_key(key, order[i]);
+    uint64_t t = bench_now();
+    struct HCacheEntry hce = mutt_hcache_fetch(hc, mutt_buffer_string(key),
+                                               mutt_buffer_len(key), 0);
+    bench_time(&res->fetch, t);
+    if (!hce.email)
+      res->misses++;
+    email_free(&hce.email);
+  }
+  res->fetch.total += bench_now() - start;
+
+  start = bench_now();
+  mutt_hcache_begin_txn(hc);
+  for (int i = 0; i < opts->count; i++)
+  {
+    bench_key(key, order[i]);
+    uint64_t t = bench_now();
+    mutt_hcache_delete_record(hc, mutt_buffer_string(key), mutt_buffer_len(key));
+    bench_time(&res->remove, t);
+  }
+  mutt_hcache_commit_txn(hc);
+  mutt_hcache_close(hc);
+  res->remove.total += bench_now() - start;
+  rc = true;
+
+done:
+  mutt_buffer_pool_release(&key);
+  mutt_buffer_pool_release(&path);
+  return rc;
+}
+
+/**
+ * bench_print_times - Print the throughput and latencies of an operation
+ * @param bt Latencies
+ */
+static void bench_print_times(struct BenchTimes *bt)
+{
+  if ((bt->count == 0) || (bt->total == 0))
+  {
+    printf(" %9s %7s %7s", "-", "-", "-");
+    return;
+  }
+
+  qsort(bt->ns, bt->count, sizeof(*bt->ns), bench_cmp);
+  double ops = (double) bt->count * 1e9 / bt->total;
+  double p50 = bt->ns[bt->count / 2] / 1e3;
+  double p99 = bt->ns[MIN(bt->count - 1, bt->count * 99 / 100)] / 1e3;
+  printf(" %9.0f %7.1f %7.1f", ops, p50, p99);
+}
+
+/**
+ * bench_combination - Benchmark, and report, one backend and compression
+ * @param opts    Command line options
+ * @param corpus  Emails to store
+ * @param order   Order in which to fetch the Emails
+ * @param backend Backend name
+ * @param method  Compression method, or NULL for none
+ * @param level   Compression level
+ */
+static void bench_combination(const struct BenchOptions *opts, struct Email **corpus,
+                              const int *order, const char *backend,
+                              const char *method, short level)
+{
+  struct ConfigSet *cs = NeoMutt->sub->cs;
+  struct Buffer *err = mutt_buffer_pool_get();
+  char dir[PATH_MAX];
+
+  cs_str_string_set(cs, "header_cache_backend", backend, err);
+  cs_str_string_set(cs, "header_cache_compress_method", method, err);
+  if (method)
+    cs_str_native_set(cs, "header_cache_compress_level", level, err);
+
+  size_t n = (size_t) opts->count * opts->repeat;
+  struct BenchResult res = { 0 };
+  res.store.ns = mutt_mem_calloc(n, sizeof(uint64_t));
+  res.fetch.ns = mutt_mem_calloc(n, sizeof(uint64_t));
+  res.remove.ns = mutt_mem_calloc(n, sizeof(uint64_t));
+
+  char lstr[16] = "-";
+  if (method)
+    snprintf(lstr, sizeof(lstr), "%d", level);
+  printf("%-14s %-5s %5s", backend, method ? method : "none", lstr);
+  fflush(stdout);
+
+  bool ok = true;
+  for (int r = 0; ok && (r < opts->repeat); r++)
+  {
+    snprintf(dir, sizeof(dir), "%s/neomutt-hcache-bench-XXXXXX", opts->tmpdir);
+    if (!mkdtemp(dir))
+    {
+      mutt_perror(dir);
+      ok = false;
+      break;
+    }
+
+    ok = bench_run(opts, corpus, order, dir, &res);
+    mutt_file_rmtree(dir);
+  }
+
+  if (ok)
+  {
+    bench_print_times(&res.store);
+    bench_print_times(&res.fetch);
+    bench_print_times(&res.remove);
+    printf(" %9lld", res.disk / opts->repeat / 1024);
+    if (res.misses != 0)
+      printf("  (%d misses)", res.misses);
+    printf("\n");
+  }
+  else
+  {
+    printf("  failed to open the cache\n");
+  }
+
+  FREE(&res.store.ns);
+  FREE(&res.fetch.ns);
+  FREE(&res.remove.ns);
+  mutt_buffer_pool_release(&err);
+}
+
+/**
+ * bench_split - Split a comma-separated list
+ * @param head List to fill
+ * @param str  String to split
+ */
+static void bench_split(struct ListHead *head, const char *str)
+{
+  mutt_list_str_split(head, str, ',');
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, head, entries)
+  {
+    mutt_str_remove_trailing_ws(np->data);
+    char *s = mutt_str_dup(mutt_str_skip_whitespace(np->data));
+    FREE(&np->data);
+    np->data = s;
+  }
+}
+
+/**
+ * bench_methods - Benchmark every compression method for a backend
+ * @param opts    Command line options
+ * @param corpus  Emails to store
+ * @param order   Order in which to fetch the Emails
+ * @param backend Backend name
+ */
+static void bench_methods(const struct BenchOptions *opts, struct Email **corpus,
+                          const int *order, const char *backend)
+{
+  char *all = NULL;
+  const char *methods = opts->methods;
+  if (!methods)
+  {
+    const char *list = compress_list();
+    mutt_str_asprintf(&all, "none%s%s", *list ? ", " : "", list);
+    FREE(&list);
+    methods = all;
+  }
+
+  struct ListHead mlist = STAILQ_HEAD_INITIALIZER(mlist);
+  bench_split(&mlist, methods);
+
+  struct ListNode *mp = NULL;
+  STAILQ_FOREACH(mp, &mlist, entries)
+  {
+    if (mutt_str_equal(mp->data, "none"))
+    {
+      bench_combination(opts, corpus, order, backend, NULL, 0);
+      continue;
+    }
+
+    const struct ComprOps *cops = compress_get_ops(mp->data);
+    if (!cops)
+    {
+      printf("%-14s %-5s  unknown compression method\n", backend, mp->data);
+      continue;
+    }
+
+    if (opts->levels)
+    {
+      struct ListHead llist = STAILQ_HEAD_INITIALIZER(llist);
+      bench_split(&llist, opts->levels);
+      struct ListNode *lp = NULL;
+      STAILQ_FOREACH(lp, &llist, entries)
+      {
+        short level = 0;
+        if ((mutt_str_atos(lp->data, &level) != 0) ||
+            (level < cops->min_level) || (level > cops->max_level))
+        {
+          continue;
+        }
+        bench_combination(opts, corpus, order, backend, cops->name, level);
+      }
+      mutt_list_free(&llist);
+    }
+    else
+    {
+      bench_combination(opts, corpus, order, backend, cops->name, cops->min_level);
+      bench_combination(opts, corpus, order, backend, cops->name, cops->max_level);
+    }
+  }
+
+  mutt_list_free(&mlist);
+  FREE(&all);
+}
+
+/**
+ * usage - Display the command line options
+ * @param prog Program name
+ */
+static void usage(const char *prog)
+{
+  printf("Usage: %s [options]\n"
+         "  -n COUNT    Number of Emails in the corpus (default: 10000)\n"
+         "  -r REPEAT   Number of runs of each combination (default: 3)\n"
+         "  -s SEED     Seed for the corpus generator (default: 1)\n"
+         "  -d DIST     Corpus distribution: uniform, skewed (default: skewed)\n"
+         "  -R REFS     Maximum length of the References header (default: 10)\n"
+         "  -b LIST     Backends to test (default: all)\n"
+         "  -c LIST     Compression methods to test, 'none' for none (default: all)\n"
+         "  -l LIST     Compression levels to test (default: each method's min and max)\n"
+         "  -t DIR      Directory for the temporary caches (default: $TMPDIR or /tmp)\n"
+         "  -h          Display this help\n",
+         prog);
+}
+
+/**
+ * main - Benchmark the header cache
+ * @param argc Number of command line arguments
+ * @param argv List of command line arguments
+ * @retval 0 Success
+ * @retval 1 Error
+ */
+int main(int argc, char *argv[])
+{
+  struct BenchOptions opts = {
+    .count = 10000, .repeat = 3, .max_refs = 10, .seed = 1, .dist = BENCH_DIST_SKEWED,
+  };
+  opts.tmpdir = mutt_str_getenv("TMPDIR");
+  if (!opts.tmpdir)
+    opts.tmpdir = "/tmp";
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:r:s:d:R:b:c:l:t:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n':
+        opts.count = atoi(optarg);
+        break;
+      case 'r':
+        opts.repeat = atoi(optarg);
+        break;
+      case 's':
+        opts.seed = strtoul(optarg, NULL, 10);
+        break;
+      case 'd':
+        if (mutt_str_equal(optarg, "uniform"))
+          opts.dist = BENCH_DIST_UNIFORM;
+        else if (mutt_str_equal(optarg, "skewed"))
+          opts.dist = BENCH_DIST_SKEWED;
+        else
+        {
+          usage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'R':
+        opts.max_refs = atoi(optarg);
+        break;
+      case 'b':
+        opts.backends = optarg;
+        break;
+      case 'c':
+        opts.methods = optarg;
+        break;
+      case 'l':
+        opts.levels = optarg;
+        break;
+      case 't':
+        opts.tmpdir = optarg;
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if ((opts.count < 1) || (opts.repeat < 1))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  struct ConfigSet *cs = cs_new(50);
+  CONFIG_INIT_TYPE(cs, bool);
+  CONFIG_INIT_TYPE(cs, number);
+  CONFIG_INIT_TYPE(cs, path);
+  CONFIG_INIT_TYPE(cs, slist);
+  CONFIG_INIT_TYPE(cs, string);
+  NeoMutt = neomutt_new(cs);
+
+  static struct ConfigDef BenchVars[] = {
+    // clang-format off
+    { "auto_subscribe", DT_BOOL,                  false,      0, NULL, NULL },
+    { "charset",        DT_STRING,                IP "utf-8", 0, NULL, NULL },
+    { "hidden_tags",    DT_SLIST|SLIST_SEP_COMMA, 0,          0, NULL, NULL },
+    { NULL },
+    // clang-format on
+  };
+  if (!cs_register_variables(cs, BenchVars, 0) || !config_init_hcache(cs))
+  {
+    fprintf(stderr, "Couldn't register the config variables\n");
+    return 1;
+  }
+  CharsetIsUtf8 = true;
+
+  /* Generate the corpus, and a random order to fetch it in */
+  RandState = opts.seed ? opts.seed : 1;
+  struct Email **corpus = mutt_mem_calloc(opts.count, sizeof(struct Email *));
+  int *order = mutt_mem_calloc(opts.count, sizeof(int));
+  for (int i = 0; i < opts.count; i++)
+  {
+    corpus[i] = bench_email(&opts, i);
+    order[i] = i;
+  }
+  for (int i = opts.count - 1; i > 0; i--)
+  {
+    int j = bench_rand() % (i + 1);
+    int tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  printf("%d Emails, %s distribution, seed %u, %d run(s) each\n", opts.count,
+         (opts.dist == BENCH_DIST_SKEWED) ? "skewed" : "uniform", opts.seed, opts.repeat);
+  printf("Throughput in ops/s, latency in microseconds, size in KiB\n\n");
+  printf("%-14s %-5s %5s %9s %7s %7s %9s %7s %7s %9s %7s %7s %9s\n", "backend",
+         "compr", "level", "store/s", "p50", "p99", "fetch/s", "p50", "p99",
+         "delete/s", "p50", "p99", "size");
+
+  char *all = NULL;
+  const char *backends = opts.backends;
+  if (!backends)
+    backends = all = (char *) store_backend_list();
+
+  struct ListHead blist = STAILQ_HEAD_INITIALIZER(blist);
+  bench_split(&blist, backends);
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &blist, entries)
+  {
+    if (!store_is_valid_backend(np->data))
+    {
+      printf("%-14s unknown backend\n", np->data);
+      continue;
+    }
+    bench_methods(&opts, corpus, order, np->data);
+  }
+
+  mutt_list_free(&blist);
+  FREE(&all);
+  for (int i = 0; i < opts.count; i++)
+    email_free(&corpus[i]);
+  FREE(&corpus);
+  FREE(&order);
+  neomutt_free(&NeoMutt);
+  cs_free(&cs);
+  mutt_buffer_pool_free();
+  return 0;
+}
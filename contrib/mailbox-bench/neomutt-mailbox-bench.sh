@@ -0,0 +1,140 @@
+#!/usr/bin/env bash
+#
+# Copyright 2026 agent <agent@local>
+#
+# This program is free software: you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, either version 2 of the License, or (at your option) any later
+# version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+usage()
+{
+    echo "Usage: $(basename "$0") -e <neomutt> -m <mailbox> [-m <mailbox>...] [options]"
+    echo ""
+    echo "   -e Path to the neomutt executable"
+    echo "   -m Mailbox to test: a path or an imap:// URL, may be repeated"
+    echo "   -t Number of times to repeat each phase (default: 3)"
+    echo "   -l Pattern for the limit phase (default: '~f alice | ~s patch')"
+    echo "   -F Extra config file, e.g. for IMAP credentials or a header cache"
+    echo ""
+}
+
+TIMES=3
+LIMIT="~f alice | ~s patch"
+MAILBOXES=""
+EXTRA_RC=""
+
+while getopts e:m:t:l:F: OPT; do
+    case "$OPT" in
+        e)
+            NEOMUTT="$OPTARG"
+            ;;
+        m)
+            MAILBOXES="$MAILBOXES $OPTARG"
+            ;;
+        t)
+            TIMES="$OPTARG"
+            ;;
+        l)
+            LIMIT="$OPTARG"
+            ;;
+        F)
+            EXTRA_RC="$OPTARG"
+            ;;
+        *)
+            usage
+            exit 1
+    esac
+done
+
+if [ -z "$NEOMUTT" ] || [ -z "$MAILBOXES" ] || [ -z "$TIMES" ]; then
+    usage
+    exit 1
+fi
+
+CWD=$(dirname "$(realpath "$0")")
+TMPDIR=$(mktemp -d)
+trap 'rm -rf "$TMPDIR"' EXIT
+
+# Each phase does a bit more than the one before:
+#   open   - read the mailbox, without sorting it
+#   sort   - also sort it by date
+#   thread - sort it into threads instead
+#   limit  - sort it by date, then limit it to a pattern
+PHASES="open sort thread limit"
+
+exe()
+{
+    export my_folder="$1"
+    case "$2" in
+        open)   my_sort=unsorted; my_push="<exit>" ;;
+        sort)   my_sort=date;     my_push="<exit>" ;;
+        thread) my_sort=threads;  my_push="<exit>" ;;
+        limit)  my_sort=date;     my_push="<limit>$LIMIT<enter><exit>" ;;
+    esac
+    export my_sort my_push
+    local rc=(-F "$CWD"/neomuttrc)
+    if [ -n "$EXTRA_RC" ]; then
+        rc+=(-F "$EXTRA_RC")
+    fi
+    # NeoMutt's screen goes to /dev/null, but it still needs a terminal
+    t=$( { time -p "$NEOMUTT" -n "${rc[@]}" > /dev/null 2>&1; } 2>&1 )
+    echo "$t" | xargs
+}
+
+# extract <mailbox> <phase> <field of the time output>
+extract()
+{
+    awk -v m="$1" -v p="$2" -v f="$3" '$1 == m && $2 == p { print $f }' "$TMPDIR/result.txt" | xargs
+}
+
+avg()
+{
+    echo "$*" | awk '{ for (i = 1; i <= NF; i++) s += $i; printf "%.3f", s / NF }'
+}
+
+width=${#TIMES}
+
+for i in $(seq "$TIMES"); do
+    for m in $MAILBOXES; do
+        for p in $PHASES; do
+            printf "%${width}d - %-6s - %s\n" "$i" "$p" "$m"
+            echo "$m $p $(exe "$m" "$p")" >> "$TMPDIR"/result.txt
+        done
+    done
+done
+
+# The cost of a phase is its time, less the time of the phase it builds on
+base()
+{
+    case "$1" in
+        sort|thread) echo open ;;
+        limit)       echo sort ;;
+    esac
+}
+
+for m in $MAILBOXES; do
+    echo ""
+    echo "*** $m"
+    for p in $PHASES; do
+        real=$(avg "$(extract "$m" "$p" 4)")
+        user=$(avg "$(extract "$m" "$p" 6)")
+        sys=$(avg "$(extract "$m" "$p" 8)")
+        printf "%-8s %8s real %8s user %8s sys" "$p" "$real" "$user" "$sys"
+        b=$(base "$p")
+        if [ -n "$b" ]; then
+            cost=$(awk -v a="$real" -v b="$(avg "$(extract "$m" "$b" 4)")" 'BEGIN { printf "%.3f", a - b }')
+            printf "   (%s more than %s)" "$cost" "$b"
+        fi
+        echo ""
+    done
+done
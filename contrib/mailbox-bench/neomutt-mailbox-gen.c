@@ -0,0 +1,769 @@
+/**
+ * @file
+ * Generate a large synthetic mailbox
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mbox_gen Mailbox generator
+ *
+ * Generate a large mailbox to test NeoMutt's performance.
+ *
+ * The messages are generated from a seed, so the same options always give the
+ * same mailbox.  They look like a busy mailing list archive: most messages
+ * are replies in threads, most belong to a list, and some have encoded
+ * headers, quoted-printable bodies or attachments.
+ *
+ * The mailbox can be written as an mbox, a maildir or an MH folder.  To test
+ * IMAP, point an IMAP server at a generated maildir.
+ */
+
+#include "config.h"
+#include <errno.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+
+/**
+ * enum GenFormat - Format of the generated mailbox
+ */
+enum GenFormat
+{
+  GEN_MBOX,    ///< A single mbox file
+  GEN_MAILDIR, ///< A maildir directory
+  GEN_MH,      ///< An MH folder
+};
+
+/**
+ * struct GenOptions - Command line options
+ */
+struct GenOptions
+{
+  int count;             ///< Number of messages
+  unsigned int seed;     ///< Seed for the generator
+  int lists;             ///< Number of mailing lists
+  int reply_pct;         ///< Percentage of messages that are replies
+  int attach_pct;        ///< Percentage of messages with an attachment
+  enum GenFormat format; ///< Format of the mailbox
+  const char *path;      ///< Where to write the mailbox
+};
+
+/**
+ * struct GenMessage - What's remembered about each message
+ *
+ * Replies need to know about their parents, to copy the subject and list and
+ * to build the References header.
+ */
+struct GenMessage
+{
+  int parent;   ///< Index of the parent message, or -1
+  int root;     ///< Index of the first message in the thread
+  int list;     ///< Mailing list, or -1
+  bool read;    ///< Message has been read
+  bool flagged; ///< Message is flagged
+  bool replied; ///< Message has been replied to
+};
+
+static uint32_t RandState = 1; ///< State of the generator
+
+/// Epoch of the first message, 2020-01-01
+#define GEN_EPOCH 1577836800
+
+static const char *Names[] = {
+  "Alice Archer", "Bob Baker",   "Carol Clark",  "Dave Dawson",
+  "Erin Evans",   "Frank Foster", "Grace Green", "Heidi Hughes",
+  "Ivan Irving",  "Judy Jones",  "Mallory Moss", "Niaj Norris",
+  "Olivia Owens", "Peggy Price", "Rupert Reed",  "Sybil Stone",
+};
+
+/// Senders whose names need encoding
+static const char *EncodedNames[] = {
+  "=?iso-8859-1?Q?J=F6rg_Fischer?=",
+  "=?utf-8?B?w4FsdmFybyBHw7NtZXo=?=",
+  "=?utf-8?Q?Zo=C3=AB_M=C3=BCller?=",
+};
+
+static const char *Words[] = {
+  "build",   "release", "patch",  "review",  "crash",   "config",
+  "header",  "cache",   "thread", "index",   "sidebar", "folder",
+  "compose", "attach",  "crypto", "charset", "pager",   "notmuch",
+  "imap",    "maildir", "speed",  "memory",  "docs",    "question",
+};
+
+/**
+ * gen_rand - Get the next pseudo-random number
+ * @retval num Random number
+ *
+ * A xorshift generator, so that the mailbox only depends on the seed.
+ */
+static uint32_t gen_rand(void)
+{
+  uint32_t x = RandState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  RandState = x;
+  return x;
+}
+
+/**
+ * gen_percent - Randomly decide something
+ * @param pct Chance, in percent
+ * @retval true It happened
+ */
+static bool gen_percent(int pct)
+{
+  return (int) (gen_rand() % 100) < pct;
+}
+
+/**
+ * gen_recent - Pick a recent message
+ * @param i Index of the current message
+ * @retval num Index of an earlier message
+ *
+ * Squaring a uniform number favours the latest messages, so that threads are
+ * mostly close together, but some are revived much later.
+ */
+static int gen_recent(int i)
+{
+  double r = (double) gen_rand() / UINT32_MAX;
+  int back = (int) (r * r * MIN(i, 5000));
+  return i - 1 - back;
+}
+
+/**
+ * gen_words - Add some random words to a Buffer
+ * @param buf Buffer for the result
+ * @param num Number of words
+ */
+static void gen_words(struct Buffer *buf, int num)
+{
+  for (int n = 0; n < num; n++)
+  {
+    if (n > 0)
+      mutt_buffer_addch(buf, ' ');
+    mutt_buffer_addstr(buf, Words[gen_rand() % mutt_array_size(Words)]);
+  }
+}
+
+/**
+ * gen_subject - Generate the subject of a thread
+ * @param buf  Buffer for the result
+ * @param root Index of the first message in the thread
+ *
+ * The subject only depends on the thread, so replies get the same subject.
+ */
+static void gen_subject(struct Buffer *buf, int root)
+{
+  uint32_t state = RandState;
+  RandState = root + 1;
+
+  struct Buffer *words = mutt_buffer_pool_get();
+  gen_words(words, 2 + (gen_rand() % 6));
+
+  if ((root % 7) == 3)
+  {
+    /* Quoted-printable encoded word */
+    mutt_buffer_addstr(buf, "=?utf-8?Q?Caf=C3=A9_");
+    for (const char *p = mutt_buffer_string(words); *p; p++)
+      mutt_buffer_addch(buf, (*p == ' ') ? '_' : *p);
+    mutt_buffer_add_printf(buf, "_%d?=", root);
+  }
+  else if ((root % 11) == 5)
+  {
+    /* Base64 encoded word */
+    char plain[256];
+    char b64[400];
+    int len = snprintf(plain, sizeof(plain), "Gr\xc3\xbc\xc3\x9f" "e %s %d",
+                       mutt_buffer_string(words), root);
+    mutt_b64_encode(plain, MIN(len, (int) sizeof(plain) - 1), b64, sizeof(b64));
+    mutt_buffer_add_printf(buf, "=?utf-8?B?%s?=", b64);
+  }
+  else
+  {
+    mutt_buffer_add_printf(buf, "%s %d", mutt_buffer_string(words), root);
+  }
+
+  mutt_buffer_pool_release(&words);
+  RandState = state;
+}
+
+/**
+ * gen_msgid - Generate the Message-ID of a message
+ * @param buf  Buffer for the result
+ * @param opts Command line options
+ * @param i    Index of the message
+ */
+static void gen_msgid(struct Buffer *buf, const struct GenOptions *opts, int i)
+{
+  mutt_buffer_add_printf(buf, "<%d.%u@gen.example.org>", i, opts->seed);
+}
+
+/**
+ * gen_date - Get the date of a message
+ * @param i Index of the message
+ * @retval num Time, in seconds since the epoch
+ *
+ * Messages are roughly a minute apart, but don't always arrive in order.
+ */
+static time_t gen_date(int i)
+{
+  return GEN_EPOCH + ((time_t) i * 60) + (gen_rand() % 3600) - 1800;
+}
+
+/**
+ * gen_sender - Pick a sender
+ * @param buf Buffer for the result
+ */
+static void gen_sender(struct Buffer *buf)
+{
+  if (gen_percent(5))
+  {
+    int n = gen_rand() % mutt_array_size(EncodedNames);
+    mutt_buffer_add_printf(buf, "%s <intl%d@example.net>", EncodedNames[n], n);
+    return;
+  }
+
+  const char *name = Names[gen_rand() % mutt_array_size(Names)];
+  mutt_buffer_add_printf(buf, "%s <", name);
+  for (const char *p = name; *p; p++)
+    mutt_buffer_addch(buf, (*p == ' ') ? '.' : *p);
+  mutt_buffer_addstr(buf, "@example.org>");
+}
+
+/**
+ * gen_text - Generate some lines of text
+ * @param buf    Buffer for the result
+ * @param quote  If true, start with some quoted lines
+ * @param qp     If true, encode the text as quoted-printable
+ */
+static void gen_text(struct Buffer *buf, bool quote, bool qp)
+{
+  if (quote)
+  {
+    mutt_buffer_addstr(buf, "Someone wrote:\n");
+    for (int n = 2 + (gen_rand() % 8); n > 0; n--)
+    {
+      mutt_buffer_addstr(buf, "> ");
+      gen_words(buf, 4 + (gen_rand() % 8));
+      mutt_buffer_addch(buf, '\n');
+    }
+    mutt_buffer_addch(buf, '\n');
+  }
+
+  for (int n = 3 + (gen_rand() % 30); n > 0; n--)
+  {
+    gen_words(buf, 4 + (gen_rand() % 8));
+    if (qp && ((n % 4) == 0))
+      mutt_buffer_addstr(buf, " na=C3=AFve caf=C3=A9 r=C3=A9sum=C3=A9 and a long line t=\nhat's been wrapped");
+    mutt_buffer_addch(buf, '\n');
+  }
+  mutt_buffer_addstr(buf, "\n-- \nSent from a benchmark\n");
+}
+
+/**
+ * gen_attachment - Generate a base64-encoded attachment
+ * @param buf Buffer for the result
+ */
+static void gen_attachment(struct Buffer *buf)
+{
+  char raw[57];
+  char b64[80];
+  for (int n = 16 + (gen_rand() % 256); n > 0; n--)
+  {
+    for (size_t j = 0; j < sizeof(raw); j++)
+      raw[j] = (char) gen_rand();
+    mutt_b64_encode(raw, sizeof(raw), b64, sizeof(b64));
+    mutt_buffer_add_printf(buf, "%s\n", b64);
+  }
+}
+
+/**
+ * gen_plan - Decide the threads and flags of all the messages
+ * @param opts Command line options
+ * @param msgs Array of messages to fill in
+ *
+ * This is done before writing anything, because a reply sets the 'replied'
+ * flag of its parent.
+ */
+static void gen_plan(const struct GenOptions *opts, struct GenMessage *msgs)
+{
+  for (int i = 0; i < opts->count; i++)
+  {
+    struct GenMessage *gm = &msgs[i];
+    gm->parent = -1;
+    gm->root = i;
+    gm->list = -1;
+
+    if ((i > 0) && gen_percent(opts->reply_pct))
+    {
+      gm->parent = gen_recent(i);
+      struct GenMessage *parent = &msgs[gm->parent];
+      gm->root = parent->root;
+      gm->list = parent->list;
+      if (gen_percent(20))
+        parent->replied = true;
+    }
+    else if ((opts->lists > 0) && gen_percent(80))
+    {
+      gm->list = gen_rand() % opts->lists;
+    }
+
+    gm->read = gen_percent(90);
+    gm->flagged = gen_percent(2);
+  }
+}
+
+/**
+ * gen_message - Generate a message
+ * @param buf  Buffer for the result
+ * @param opts Command line options
+ * @param msgs What's known about the messages
+ * @param i    Index of the message
+ * @param date Date of the message
+ */
+static void gen_message(struct Buffer *buf, const struct GenOptions *opts,
+                        const struct GenMessage *msgs, int i, time_t date)
+{
+  const struct GenMessage *gm = &msgs[i];
+
+  struct tm *tm = gmtime(&date);
+  char datestr[64];
+  strftime(datestr, sizeof(datestr), "%a, %d %b %Y %H:%M:%S +0000", tm);
+
+  mutt_buffer_addstr(buf, "From: ");
+  gen_sender(buf);
+  mutt_buffer_addch(buf, '\n');
+
+  if (gm->list >= 0)
+  {
+    mutt_buffer_add_printf(buf, "To: list%d@lists.example.org\n", gm->list);
+    if (gen_percent(30))
+    {
+      mutt_buffer_addstr(buf, "Cc: ");
+      gen_sender(buf);
+      mutt_buffer_addch(buf, '\n');
+    }
+  }
+  else
+  {
+    mutt_buffer_addstr(buf, "To: ");
+    gen_sender(buf);
+    mutt_buffer_addch(buf, '\n');
+  }
+
+  mutt_buffer_addstr(buf, "Subject: ");
+  if (gm->parent >= 0)
+    mutt_buffer_addstr(buf, "Re: ");
+  if (gm->list >= 0)
+    mutt_buffer_add_printf(buf, "[list%d] ", gm->list);
+  gen_subject(buf, gm->root);
+  mutt_buffer_addch(buf, '\n');
+
+  mutt_buffer_add_printf(buf, "Date: %s\n", datestr);
+  mutt_buffer_addstr(buf, "Message-ID: ");
+  gen_msgid(buf, opts, i);
+  mutt_buffer_addch(buf, '\n');
+
+  if (gm->parent >= 0)
+  {
+    mutt_buffer_addstr(buf, "In-Reply-To: ");
+    gen_msgid(buf, opts, gm->parent);
+    mutt_buffer_addch(buf, '\n');
+
+    /* References lists the ancestors, oldest first, but only the last few */
+    int refs[10];
+    int num = 0;
+    for (int p = gm->parent; (p >= 0) && (num < (int) mutt_array_size(refs));
+         p = msgs[p].parent)
+    {
+      refs[num++] = p;
+    }
+    mutt_buffer_addstr(buf, "References:");
+    for (int n = num - 1; n >= 0; n--)
+    {
+      mutt_buffer_addstr(buf, (n == (num - 1)) ? " " : "\n ");
+      gen_msgid(buf, opts, refs[n]);
+    }
+    mutt_buffer_addch(buf, '\n');
+  }
+
+  if (gm->list >= 0)
+  {
+    mutt_buffer_add_printf(buf,
+                           "List-Id: List number %d <list%d.lists.example.org>\n"
+                           "List-Post: <mailto:list%d@lists.example.org>\n"
+                           "List-Unsubscribe: <mailto:list%d-leave@lists.example.org>\n"
+                           "Precedence: list\n",
+                           gm->list, gm->list, gm->list, gm->list);
+  }
+
+  mutt_buffer_addstr(buf, "MIME-Version: 1.0\n");
+
+  const bool quote = (gm->parent >= 0);
+  const int kind = gen_rand() % 100;
+  if (kind < opts->attach_pct)
+  {
+    const char *boundary = "=-=-=gen-boundary=-=-=";
+    mutt_buffer_add_printf(buf, "Content-Type: multipart/mixed; boundary=\"%s\"\n\n", boundary);
+    mutt_buffer_add_printf(buf, "This is a multi-part message in MIME format.\n\n--%s\n", boundary);
+    mutt_buffer_addstr(buf, "Content-Type: text/plain; charset=us-ascii\n\n");
+    gen_text(buf, quote, false);
+    mutt_buffer_add_printf(buf, "\n--%s\n", boundary);
+    if (gen_percent(50))
+      mutt_buffer_add_printf(buf, "Content-Type: application/pdf; name=\"report-%d.pdf\"\n", i);
+    else
+      mutt_buffer_add_printf(buf, "Content-Type: image/png; name=\"screenshot-%d.png\"\n", i);
+    mutt_buffer_addstr(buf, "Content-Transfer-Encoding: base64\n"
+                            "Content-Disposition: attachment\n\n");
+    gen_attachment(buf);
+    mutt_buffer_add_printf(buf, "\n--%s--\n", boundary);
+  }
+  else if (kind < (opts->attach_pct + 5))
+  {
+    const char *boundary = "=-=-=gen-alternative=-=-=";
+    mutt_buffer_add_printf(buf, "Content-Type: multipart/alternative; boundary=\"%s\"\n\n--%s\n",
+                           boundary, boundary);
+    mutt_buffer_addstr(buf, "Content-Type: text/plain; charset=utf-8\n\n");
+    gen_text(buf, quote, false);
+    mutt_buffer_add_printf(buf, "\n--%s\n", boundary);
+    mutt_buffer_addstr(buf, "Content-Type: text/html; charset=utf-8\n\n<html><body><p>");
+    gen_words(buf, 20 + (gen_rand() % 40));
+    mutt_buffer_add_printf(buf, "</p></body></html>\n\n--%s--\n", boundary);
+  }
+  else if (kind < (opts->attach_pct + 20))
+  {
+    mutt_buffer_addstr(buf, "Content-Type: text/plain; charset=utf-8\n"
+                            "Content-Transfer-Encoding: quoted-printable\n\n");
+    gen_text(buf, quote, true);
+  }
+  else
+  {
+    mutt_buffer_add_printf(buf, "Content-Type: text/plain; charset=%s\n\n",
+                           gen_percent(50) ? "us-ascii" : "iso-8859-1");
+    gen_text(buf, quote, false);
+  }
+}
+
+/**
+ * gen_mkdir - Create a directory, if it doesn't exist
+ * @param path Path of the directory
+ * @retval true Success
+ */
+static bool gen_mkdir(const char *path)
+{
+  if ((mkdir(path, S_IRWXU) == 0) || (errno == EEXIST))
+    return true;
+
+  fprintf(stderr, "Can't create %s: %s\n", path, strerror(errno));
+  return false;
+}
+
+/**
+ * gen_write_file - Write a message to a file
+ * @param path Path of the file
+ * @param buf  Message
+ * @retval true Success
+ */
+static bool gen_write_file(const char *path, const struct Buffer *buf)
+{
+  FILE *fp = fopen(path, "w");
+  if (!fp)
+  {
+    fprintf(stderr, "Can't create %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  bool rc = (fwrite(buf->data, 1, mutt_buffer_len(buf), fp) == mutt_buffer_len(buf));
+  if (fclose(fp) != 0)
+    rc = false;
+  if (!rc)
+    fprintf(stderr, "Can't write %s: %s\n", path, strerror(errno));
+  return rc;
+}
+
+/**
+ * gen_write_mbox - Append a message to an mbox
+ * @param fp   Mbox file
+ * @param msg  Message
+ * @param gm   What's known about the message
+ * @param date Date of the message
+ * @retval true Success
+ */
+static bool gen_write_mbox(FILE *fp, const struct Buffer *msg,
+                           const struct GenMessage *gm, time_t date)
+{
+  char datestr[64];
+  strftime(datestr, sizeof(datestr), "%a %b %e %H:%M:%S %Y", gmtime(&date));
+  fprintf(fp, "From gen@example.org %s\n", datestr);
+
+  /* The flags go at the end of the header */
+  const char *body = strstr(msg->data, "\n\n");
+  size_t hdr_len = body ? (body - msg->data + 1) : mutt_buffer_len(msg);
+  fwrite(msg->data, 1, hdr_len, fp);
+  fprintf(fp, "Status: %s\n", gm->read ? "RO" : "O");
+  if (gm->flagged || gm->replied)
+    fprintf(fp, "X-Status: %s%s\n", gm->flagged ? "F" : "", gm->replied ? "A" : "");
+
+  /* Quote any body lines that look like the start of a message */
+  for (const char *line = msg->data + hdr_len; *line;)
+  {
+    const char *end = strchr(line, '\n');
+    size_t len = end ? (end - line + 1) : strlen(line);
+    if (mutt_str_startswith(line, "From "))
+      fputc('>', fp);
+    fwrite(line, 1, len, fp);
+    line += len;
+  }
+  fputc('\n', fp);
+
+  return !ferror(fp);
+}
+
+/**
+ * gen_write_sequence - Write an MH sequence
+ * @param fp    Sequences file
+ * @param name  Name of the sequence
+ * @param msgs  What's known about the messages
+ * @param count Number of messages
+ * @param field Offset of the flag in a GenMessage
+ * @param want  Value of the flag for messages in the sequence
+ */
+static void gen_write_sequence(FILE *fp, const char *name, const struct GenMessage *msgs,
+                               int count, size_t field, bool want)
+{
+  fprintf(fp, "%s:", name);
+  for (int i = 0; i < count;)
+  {
+    if (*((const bool *) ((const char *) &msgs[i] + field)) != want)
+    {
+      i++;
+      continue;
+    }
+
+    int start = i;
+    while ((i < count) && (*((const bool *) ((const char *) &msgs[i] + field)) == want))
+      i++;
+
+    /* MH messages are numbered from 1 */
+    if ((i - start) == 1)
+      fprintf(fp, " %d", start + 1);
+    else
+      fprintf(fp, " %d-%d", start + 1, i);
+  }
+  fputc('\n', fp);
+}
+
+/**
+ * gen_mailbox - Generate the mailbox
+ * @param opts Command line options
+ * @retval 0 Success
+ * @retval 1 Error
+ */
+static int gen_mailbox(const struct GenOptions *opts)
+{
+  FILE *fp_mbox = NULL;
+  struct Buffer *path = mutt_buffer_pool_get();
+  int rc = 1;
+
+  if (opts->format == GEN_MBOX)
+  {
+    fp_mbox = fopen(opts->path, "w");
+    if (!fp_mbox)
+    {
+      fprintf(stderr, "Can't create %s: %s\n", opts->path, strerror(errno));
+      goto done;
+    }
+  }
+  else
+  {
+    static const char *subdirs[] = { "cur", "new", "tmp" };
+    size_t num = (opts->format == GEN_MAILDIR) ? mutt_array_size(subdirs) : 0;
+    if (!gen_mkdir(opts->path))
+      goto done;
+    for (size_t i = 0; i < num; i++)
+    {
+      mutt_buffer_concat_path(path, opts->path, subdirs[i]);
+      if (!gen_mkdir(mutt_buffer_string(path)))
+        goto done;
+    }
+  }
+
+  struct GenMessage *msgs = mutt_mem_calloc(opts->count, sizeof(struct GenMessage));
+  struct Buffer *msg = mutt_buffer_pool_get();
+  RandState = opts->seed ? opts->seed : 1;
+  gen_plan(opts, msgs);
+
+  for (int i = 0; i < opts->count; i++)
+  {
+    mutt_buffer_reset(msg);
+    const time_t date = gen_date(i);
+    gen_message(msg, opts, msgs, i, date);
+    const struct GenMessage *gm = &msgs[i];
+
+    bool ok = true;
+    if (opts->format == GEN_MBOX)
+    {
+      ok = gen_write_mbox(fp_mbox, msg, gm, date);
+    }
+    else if (opts->format == GEN_MAILDIR)
+    {
+      /* Maildir flags must be in ASCII order */
+      mutt_buffer_printf(path, "%s/%s/%ld.M%dP%u.gen", opts->path,
+                         gm->read ? "cur" : "new", (long) date, i, opts->seed);
+      if (gm->read)
+        mutt_buffer_add_printf(path, ":2,%s%sS", gm->flagged ? "F" : "",
+                               gm->replied ? "R" : "");
+      ok = gen_write_file(mutt_buffer_string(path), msg);
+    }
+    else
+    {
+      mutt_buffer_printf(path, "%s/%d", opts->path, i + 1);
+      ok = gen_write_file(mutt_buffer_string(path), msg);
+    }
+
+    if (!ok)
+      goto free;
+  }
+
+  if (opts->format == GEN_MH)
+  {
+    mutt_buffer_concat_path(path, opts->path, ".mh_sequences");
+    FILE *fp = fopen(mutt_buffer_string(path), "w");
+    if (!fp)
+    {
+      fprintf(stderr, "Can't create %s: %s\n", mutt_buffer_string(path), strerror(errno));
+      goto free;
+    }
+    gen_write_sequence(fp, "unseen", msgs, opts->count, offsetof(struct GenMessage, read), false);
+    gen_write_sequence(fp, "flagged", msgs, opts->count,
+                       offsetof(struct GenMessage, flagged), true);
+    gen_write_sequence(fp, "replied", msgs, opts->count,
+                       offsetof(struct GenMessage, replied), true);
+    fclose(fp);
+  }
+
+  rc = 0;
+
+free:
+  mutt_buffer_pool_release(&msg);
+  FREE(&msgs);
+
+done:
+  if (fp_mbox && (fclose(fp_mbox) != 0))
+  {
+    fprintf(stderr, "Can't write %s: %s\n", opts->path, strerror(errno));
+    rc = 1;
+  }
+  mutt_buffer_pool_release(&path);
+  return rc;
+}
+
+/**
+ * usage - Display the command line options
+ * @param prog Program name
+ */
+static void usage(const char *prog)
+{
+  printf("Usage: %s [options] PATH\n"
+         "  -n COUNT    Number of messages (default: 10000)\n"
+         "  -f FORMAT   Mailbox format: mbox, maildir, mh (default: maildir)\n"
+         "  -s SEED     Seed for the generator (default: 1)\n"
+         "  -l LISTS    Number of mailing lists (default: 20)\n"
+         "  -r PERCENT  Percentage of messages that are replies (default: 70)\n"
+         "  -a PERCENT  Percentage of messages with an attachment (default: 10)\n"
+         "  -h          Display this help\n",
+         prog);
+}
+
+/**
+ * main - Generate a mailbox
+ * @param argc Number of command line arguments
+ * @param argv List of command line arguments
+ * @retval 0 Success
+ * @retval 1 Error
+ */
+int main(int argc, char *argv[])
+{
+  struct GenOptions opts = {
+    .count = 10000, .seed = 1, .lists = 20, .reply_pct = 70, .attach_pct = 10, .format = GEN_MAILDIR,
+  };
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:f:s:l:r:a:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n':
+        opts.count = atoi(optarg);
+        break;
+      case 'f':
+        if (mutt_str_equal(optarg, "mbox"))
+          opts.format = GEN_MBOX;
+        else if (mutt_str_equal(optarg, "maildir"))
+          opts.format = GEN_MAILDIR;
+        else if (mutt_str_equal(optarg, "mh"))
+          opts.format = GEN_MH;
+        else
+        {
+          usage(argv[0]);
+          return 1;
+        }
+        break;
+      case 's':
+        opts.seed = strtoul(optarg, NULL, 10);
+        break;
+      case 'l':
+        opts.lists = atoi(optarg);
+        break;
+      case 'r':
+        opts.reply_pct = atoi(optarg);
+        break;
+      case 'a':
+        opts.attach_pct = atoi(optarg);
+        break;
+      case 'h':
+        usage(argv[0]);
+        return 0;
+      default:
+        usage(argv[0]);
+        return 1;
+    }
+  }
+
+  if ((optind != (argc - 1)) || (opts.count < 1) || (opts.lists < 0) ||
+      (opts.reply_pct < 0) || (opts.reply_pct > 100) || (opts.attach_pct < 0) ||
+      (opts.attach_pct > 80))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+  opts.path = argv[optind];
+
+  int rc = gen_mailbox(&opts);
+  mutt_buffer_pool_free();
+  return rc;
+}
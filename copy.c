@@ -46,6 +46,7 @@
 #include "format_flags.h"
 #include "handler.h"
 #include "hdrline.h"
+#include "maildir/lib.h"
 #include "mutt_globals.h"
 #include "mx.h"
 #include "state.h"
@@ -307,17 +308,13 @@ int mutt_copy_hdr(FILE *fp_in, FILE *fp_out, LOFF_T off_start, LOFF_T off_end,
       /* Find x -- the array entry where this header is to be saved */
       if (chflags & CH_REORDER)
       {
-        struct ListNode *np = NULL;
-        x = 0;
-        STAILQ_FOREACH(np, &HeaderOrderList, entries)
-        {
-          ++x;
-          if (mutt_istr_startswith(buf, np->data))
-          {
-            mutt_debug(LL_DEBUG2, "Reorder: %s matches %s", np->data, buf);
-            break;
-          }
-        }
+        if (!HeaderOrderSet)
+          HeaderOrderSet = mutt_prefixset_new(&HeaderOrderList);
+
+        /* Headers that aren't in the list share the last entry */
+        x = mutt_prefixset_find(HeaderOrderSet, buf);
+        if (x == 0)
+          x = hdr_count - 1;
       }
 
       ignore = false;
@@ -502,14 +499,13 @@ int mutt_copy_header(FILE *fp_in, struct Email *e, FILE *fp_out,
     }
   }
 #endif
-  char *tags = driver_tags_get(&e->tags);
+  const char *tags = driver_tags_get(&e->tags);
   if (tags && !(c_weed && mutt_matches_ignore("tags")))
   {
     fputs("Tags: ", fp_out);
     fputs(tags, fp_out);
     fputc('\n', fp_out);
   }
-  FREE(&tags);
 
   const char *const c_send_charset =
       cs_subset_string(NeoMutt->sub, "send_charset");
@@ -861,6 +857,31 @@ int mutt_copy_message(FILE *fp_out, struct Mailbox *m, struct Email *e,
   return rc;
 }
 
+/**
+ * append_verbatim - Can a message be appended without rewriting it?
+ * @param dest    Destination Mailbox
+ * @param src     Source Mailbox
+ * @param e       Email
+ * @param cmflags Flags, see #CopyMessageFlags
+ * @param chflags Flags, see #CopyHeaderFlags
+ * @retval true The message file can be cloned, or linked
+ *
+ * Between Maildirs, the flags are in the file name, so an unmodified message
+ * can keep its contents.  The copy loses any out-of-date Content-Length,
+ * Lines or Status headers, but Maildir doesn't use them.
+ */
+static bool append_verbatim(struct Mailbox *dest, struct Mailbox *src, struct Email *e,
+                            CopyMessageFlags cmflags, CopyHeaderFlags chflags)
+{
+  if ((src->type != MUTT_MAILDIR) || (dest->type != MUTT_MAILDIR))
+    return false;
+
+  if ((cmflags != MUTT_CM_NO_FLAGS) || ((chflags & ~CH_UPDATE_LEN) != CH_NO_FLAGS))
+    return false;
+
+  return !e->attach_del && !(e->env && e->env->changed);
+}
+
 /**
  * append_message - appends a copy of the given message to a mailbox
  * @param dest    destination mailbox
@@ -889,8 +910,15 @@ static int append_message(struct Mailbox *dest, FILE *fp_in, struct Mailbox *src
     return -1;
   if ((dest->type == MUTT_MBOX) || (dest->type == MUTT_MMDF))
     chflags |= CH_FROM | CH_FORCE_FROM;
-  chflags |= ((dest->type == MUTT_MAILDIR) ? CH_NOSTATUS : CH_UPDATE);
-  rc = mutt_copy_message_fp(msg->fp, fp_in, e, cmflags, chflags, 0);
+  /* Let the kernel, or the filesystem, copy the data */
+  rc = append_verbatim(dest, src, e, cmflags, chflags) ?
+           mutt_file_clone(fileno(fp_in), fileno(msg->fp)) :
+           1;
+  if (rc == 1)
+  {
+    chflags |= ((dest->type == MUTT_MAILDIR) ? CH_NOSTATUS : CH_UPDATE);
+    rc = mutt_copy_message_fp(msg->fp, fp_in, e, cmflags, chflags, 0);
+  }
   if (mx_msg_commit(dest, msg) != 0)
     rc = -1;
 
@@ -916,6 +944,10 @@ static int append_message(struct Mailbox *dest, FILE *fp_in, struct Mailbox *src
 int mutt_append_message(struct Mailbox *m_dst, struct Mailbox *m_src, struct Email *e,
                         CopyMessageFlags cmflags, CopyHeaderFlags chflags)
 {
+  /* On the same filesystem, a copy only needs a new name */
+  if (append_verbatim(m_dst, m_src, e, cmflags, chflags) && maildir_msg_link(m_dst, m_src, e))
+    return 0;
+
   struct Message *msg = mx_msg_open(m_src, e->msgno);
   if (!msg)
     return -1;
@@ -47,6 +47,8 @@ struct Account *account_new(const char *name, struct ConfigSubset *sub)
   struct Account *a = mutt_mem_calloc(1, sizeof(struct Account));
 
   STAILQ_INIT(&a->mailboxes);
+  a->paths = mutt_hash_new(32, MUTT_HASH_STRDUP_KEYS);
+  a->names = mutt_hash_new(32, MUTT_HASH_STRDUP_KEYS);
   a->notify = notify_new();
   a->name = mutt_str_dup(name);
   a->sub = cs_subset_new(name, sub, a->notify);
@@ -56,6 +58,57 @@ struct Account *account_new(const char *name, struct ConfigSubset *sub)
   return a;
 }
 
+/**
+ * index_add - Add a Mailbox to an Account's indexes
+ * @param a Account
+ * @param m Mailbox
+ *
+ * If two Mailboxes have the same path, or name, the first one in the list is
+ * the one that's found.
+ */
+static void index_add(struct Account *a, struct Mailbox *m)
+{
+  if (m->realpath && !mutt_hash_find(a->paths, m->realpath))
+    mutt_hash_insert(a->paths, m->realpath, m);
+  if (m->name && !mutt_hash_find(a->names, m->name))
+    mutt_hash_insert(a->names, m->name, m);
+}
+
+/**
+ * index_remove - Remove a Mailbox from an Account's indexes
+ * @param a Account
+ * @param m Mailbox, already removed from the Account's list
+ *
+ * If another Mailbox has the same path, or name, it takes its place.
+ */
+static void index_remove(struct Account *a, struct Mailbox *m)
+{
+  const bool path = m->realpath && (mutt_hash_find(a->paths, m->realpath) == m);
+  const bool name = m->name && (mutt_hash_find(a->names, m->name) == m);
+
+  if (path)
+    mutt_hash_delete(a->paths, m->realpath, m);
+  if (name)
+    mutt_hash_delete(a->names, m->name, m);
+  if (!path && !name)
+    return;
+
+  struct MailboxNode *np = NULL;
+  STAILQ_FOREACH(np, &a->mailboxes, entries)
+  {
+    if (path && mutt_str_equal(np->mailbox->realpath, m->realpath) &&
+        !mutt_hash_find(a->paths, m->realpath))
+    {
+      mutt_hash_insert(a->paths, m->realpath, np->mailbox);
+    }
+    if (name && mutt_str_equal(np->mailbox->name, m->name) &&
+        !mutt_hash_find(a->names, m->name))
+    {
+      mutt_hash_insert(a->names, m->name, np->mailbox);
+    }
+  }
+}
+
 /**
  * account_mailbox_add - Add a Mailbox to an Account
  * @param a Account
@@ -74,6 +127,7 @@ bool account_mailbox_add(struct Account *a, struct Mailbox *m)
   struct MailboxNode *np = mutt_mem_calloc(1, sizeof(*np));
   np->mailbox = m;
   STAILQ_INSERT_TAIL(&a->mailboxes, np, entries);
+  index_add(a, m);
   mailbox_set_subset(m, a->sub);
   notify_set_parent(m->notify, a->notify);
 
@@ -105,6 +159,8 @@ bool account_mailbox_remove(struct Account *a, struct Mailbox *m)
       struct EventMailbox ev_m = { m };
       notify_send(a->notify, NT_MAILBOX, NT_MAILBOX_REMOVE, &ev_m);
       STAILQ_REMOVE(&a->mailboxes, np, MailboxNode, entries);
+      if (m)
+        index_remove(a, m);
       notify_set_parent(np->mailbox->notify, NULL);
       if (!m)
         mailbox_free(&np->mailbox);
@@ -115,9 +171,67 @@ bool account_mailbox_remove(struct Account *a, struct Mailbox *m)
     }
   }
 
+  if (!m)
+  {
+    account_mailbox_rehash(a);
+  }
   return result;
 }
 
+/**
+ * account_mailbox_find - Find a Mailbox in an Account, by path
+ * @param a    Account to search
+ * @param path Path to find, must match the Mailbox's realpath exactly
+ * @retval ptr  Mailbox
+ * @retval NULL No match
+ */
+struct Mailbox *account_mailbox_find(struct Account *a, const char *path)
+{
+  if (!a || !path)
+    return NULL;
+
+  return mutt_hash_find(a->paths, path);
+}
+
+/**
+ * account_mailbox_find_name - Find a Mailbox in an Account, by name
+ * @param a    Account to search
+ * @param name Name to find
+ * @retval ptr  Mailbox
+ * @retval NULL No match
+ */
+struct Mailbox *account_mailbox_find_name(struct Account *a, const char *name)
+{
+  if (!a || !name)
+    return NULL;
+
+  return mutt_hash_find(a->names, name);
+}
+
+/**
+ * account_mailbox_rehash - Rebuild an Account's indexes of its Mailboxes
+ * @param a Account
+ *
+ * This must be called if the realpath, or name, of a Mailbox in the Account
+ * changes.
+ */
+void account_mailbox_rehash(struct Account *a)
+{
+  if (!a)
+    return;
+
+  mutt_hash_free(&a->paths);
+  mutt_hash_free(&a->names);
+  a->paths = mutt_hash_new(32, MUTT_HASH_STRDUP_KEYS);
+  a->names = mutt_hash_new(32, MUTT_HASH_STRDUP_KEYS);
+
+  struct MailboxNode *np = NULL;
+  STAILQ_FOREACH(np, &a->mailboxes, entries)
+  {
+    index_add(a, np->mailbox);
+  }
+}
+
 /**
  * account_free - Free an Account
  * @param[out] ptr Account to free
@@ -133,6 +247,8 @@ void account_free(struct Account **ptr)
     a->adata_free(&a->adata);
 
   account_mailbox_remove(a, NULL);
+  mutt_hash_free(&a->paths);
+  mutt_hash_free(&a->names);
   cs_subset_free(&a->sub);
   FREE(&a->name);
   notify_free(&a->notify);
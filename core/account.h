@@ -39,6 +39,8 @@ struct Account
   char *name;                     ///< Name of Account
   struct ConfigSubset *sub;       ///< Inherited config items
   struct MailboxList mailboxes;   ///< List of Mailboxes
+  struct HashTable *paths;        ///< Index of the Mailboxes, by realpath
+  struct HashTable *names;        ///< Index of the Mailboxes, by name
   struct Notify *notify;          ///< Notifications handler
   void *adata;                    ///< Private data (for Mailbox backends)
 
@@ -74,6 +76,9 @@ struct EventAccount
 
 void            account_free          (struct Account **ptr);
 bool            account_mailbox_add   (struct Account *a, struct Mailbox *m);
+struct Mailbox *account_mailbox_find  (struct Account *a, const char *path);
+struct Mailbox *account_mailbox_find_name(struct Account *a, const char *name);
+void            account_mailbox_rehash(struct Account *a);
 bool            account_mailbox_remove(struct Account *a, struct Mailbox *m);
 struct Account *account_new           (const char *name, struct ConfigSubset *sub);
 
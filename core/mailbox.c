@@ -142,21 +142,15 @@ struct Mailbox *mailbox_find_name(const char *name)
   if (!name)
     return NULL;
 
-  struct MailboxList ml = STAILQ_HEAD_INITIALIZER(ml);
-  neomutt_mailboxlist_get_all(&ml, NeoMutt, MUTT_MAILBOX_ANY);
-  struct MailboxNode *np = NULL;
-  struct Mailbox *m = NULL;
-  STAILQ_FOREACH(np, &ml, entries)
+  struct Account *a = NULL;
+  TAILQ_FOREACH(a, &NeoMutt->accounts, entries)
   {
-    if (mutt_str_equal(np->mailbox->name, name))
-    {
-      m = np->mailbox;
-      break;
-    }
+    struct Mailbox *m = account_mailbox_find_name(a, name);
+    if (m)
+      return m;
   }
-  neomutt_mailboxlist_clear(&ml);
 
-  return m;
+  return NULL;
 }
 
 /**
@@ -107,6 +107,9 @@ struct Mailbox
   struct timespec mtime;              ///< Time Mailbox was last changed
   struct timespec last_visited;       ///< Time of last exit from this mailbox
   struct timespec stats_last_checked; ///< Mtime of mailbox the last time stats where checked.
+  time_t check_next;                  ///< Don't check the Mailbox for new mail before this time
+  short check_backoff;                ///< Checks are $mail_check times this far apart
+  unsigned int check_state;           ///< Summary of the counts found by the last check
 
   const struct MxOps *mx_ops;         ///< MXAPI callback functions
 
@@ -174,6 +177,7 @@ enum NotifyMailbox
   NT_MAILBOX_RESORT,  ///< Email list needs resorting
   NT_MAILBOX_SWITCH,  ///< Current Mailbox has changed
   NT_MAILBOX_UPDATE,  ///< Update internal tables
+  NT_MAILBOX_EXPUNGE, ///< Deleted emails were removed, the rest are in order
   NT_MAILBOX_UNTAG,   ///< Clear the 'last-tagged' pointer
 };
 
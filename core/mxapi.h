@@ -52,6 +52,11 @@ struct Message
     bool draft : 1;
   } flags;
   time_t received; ///< the time at which this message was received
+  struct
+  {
+    const char *data; ///< The file behind fp, mapped into memory
+    size_t len;       ///< Length of the map
+  } map;              ///< Set by mx_msg_map()
 };
 
 
@@ -208,6 +213,17 @@ struct MxOps
    */
   bool (*msg_open)(struct Mailbox *m, struct Message *msg, int msgno);
 
+  /**
+   * msg_prefetch - Start reading an email in the background
+   * @param m Mailbox
+   * @param e Email that will be opened soon
+   *
+   * **Contract**
+   * - @a m is not NULL
+   * - @a e is not NULL
+   */
+  void (*msg_prefetch)(struct Mailbox *m, struct Email *e);
+
   /**
    * msg_open_new - Open a new message in a Mailbox
    * @param m   Mailbox
@@ -248,6 +264,21 @@ struct MxOps
    */
   int (*msg_close)       (struct Mailbox *m, struct Message *msg);
 
+  /**
+   * msg_append_batch - Start or finish appending several messages
+   * @param m     Mailbox
+   * @param start true at the start of the batch, false at the end
+   * @retval  0 Success
+   * @retval -1 Failure
+   *
+   * During a batch, msg_commit() doesn't need to flush each message to disk.
+   * At the end of the batch, all the messages must be on disk.
+   *
+   * **Contract**
+   * - @a m is not NULL
+   */
+  int (*msg_append_batch)(struct Mailbox *m, bool start);
+
   /**
    * msg_padding_size - Bytes of padding between messages
    * @param m Mailbox
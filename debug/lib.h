@@ -33,6 +33,7 @@
  * | debug/graphviz.c    | @subpage debug_graphviz    |
  * | debug/notify.c      | @subpage debug_notify      |
  * | debug/parse_test.c  | @subpage debug_parse       |
+ * | debug/perf.c        | @subpage debug_perf        |
  * | debug/window.c      | @subpage debug_window      |
  */
 
@@ -41,6 +42,8 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include "email/lib.h"
 
 struct AddressList;
@@ -84,6 +87,58 @@ int debug_notify_observer(struct NotifyCallback *nc);
 // Parse Set
 void test_parse_set(void);
 
+// Perf
+#ifdef USE_DEBUG_PERF
+#define PERF_BUCKETS 32 ///< Number of buckets in a Probe's histogram
+
+/**
+ * struct PerfProbe - A timer or counter in the code
+ */
+struct PerfProbe
+{
+  const char *name;                 ///< Name of the Probe
+  bool timed;                       ///< Time the calls, or just count them
+  bool registered;                  ///< Has the Probe been added to the list?
+  uint64_t count;                   ///< Number of calls
+  uint64_t total;                   ///< Total duration of the calls, in nanoseconds
+  uint64_t max;                     ///< Longest call, in nanoseconds
+  uint64_t buckets[PERF_BUCKETS];   ///< Histogram of durations, see perf_timer_stop()
+  struct PerfProbe *next;           ///< Linked list
+};
+
+/**
+ * struct PerfTimer - A running Probe
+ */
+struct PerfTimer
+{
+  struct PerfProbe *probe;          ///< Probe being timed, NULL if not
+  uint64_t start;                   ///< When the timer started, in nanoseconds
+};
+
+void             perf_count      (struct PerfProbe *probe);
+void             perf_dump       (FILE *fp);
+void             perf_reset      (void);
+struct PerfTimer perf_timer_start(struct PerfProbe *probe);
+void             perf_timer_stop (struct PerfTimer *timer);
+
+/// Time the rest of the enclosing block
+#define PERF_SCOPE(NAME)                                                       \
+  static struct PerfProbe perf_probe = { .name = NAME, .timed = true };        \
+  struct PerfTimer perf_timer __attribute__((cleanup(perf_timer_stop))) =      \
+      perf_timer_start(&perf_probe)
+
+/// Count the number of times a line is reached
+#define PERF_COUNT(NAME)                                                       \
+  do                                                                           \
+  {                                                                            \
+    static struct PerfProbe perf_probe = { .name = NAME };                     \
+    perf_count(&perf_probe);                                                   \
+  } while (0)
+#else
+#define PERF_SCOPE(NAME)
+#define PERF_COUNT(NAME)
+#endif
+
 // Window
 void debug_win_dump(void);
 
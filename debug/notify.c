@@ -140,6 +140,8 @@ static const char *get_mailbox_event(int id)
       return "resort";
     case NT_MAILBOX_UPDATE:
       return "update";
+    case NT_MAILBOX_EXPUNGE:
+      return "expunge";
     case NT_MAILBOX_UNTAG:
       return "untag";
     default:
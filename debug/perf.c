@@ -0,0 +1,234 @@
+/**
+ * @file
+ * Time the hot paths
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page debug_perf Time the hot paths
+ *
+ * A few of the slowest functions are wrapped in a PERF_SCOPE() timer.  Each
+ * probe counts its calls and keeps a histogram of their durations, which the
+ * `:perf` command displays.
+ *
+ * Probes may be hit from the worker threads.  A function that calls itself is
+ * only timed once, by the outermost call.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "mutt/lib.h"
+#include "lib.h"
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
+/// Maximum depth of nested probes that are tracked
+#define PERF_MAX_DEPTH 16
+
+static struct PerfProbe *Probes = NULL; ///< Probes that have been hit, newest first
+#ifdef USE_PTHREADS
+static pthread_mutex_t PerfLock = PTHREAD_MUTEX_INITIALIZER; ///< Protects the Probes
+#endif
+
+static __thread struct PerfProbe *Active[PERF_MAX_DEPTH]; ///< Probes running on this thread
+static __thread int ActiveDepth = 0;                      ///< Number of Active probes
+
+/**
+ * perf_lock - Lock the Probes
+ */
+static void perf_lock(void)
+{
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&PerfLock);
+#endif
+}
+
+/**
+ * perf_unlock - Unlock the Probes
+ */
+static void perf_unlock(void)
+{
+#ifdef USE_PTHREADS
+  pthread_mutex_unlock(&PerfLock);
+#endif
+}
+
+/**
+ * perf_now - Get the time, for measuring intervals
+ * @retval num Nanoseconds since an arbitrary point
+ */
+static uint64_t perf_now(void)
+{
+  struct timespec ts = { 0 };
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/**
+ * perf_register - Add a Probe to the list, the first time it's hit
+ * @param probe Probe
+ *
+ * @note The caller must hold the lock
+ */
+static void perf_register(struct PerfProbe *probe)
+{
+  if (probe->registered)
+    return;
+
+  probe->next = Probes;
+  Probes = probe;
+  probe->registered = true;
+}
+
+/**
+ * perf_timer_start - Start timing a Probe
+ * @param probe Probe
+ * @retval obj Timer for perf_timer_stop()
+ */
+struct PerfTimer perf_timer_start(struct PerfProbe *probe)
+{
+  struct PerfTimer timer = { NULL, 0 };
+
+  for (int i = 0; i < ActiveDepth; i++)
+    if (Active[i] == probe)
+      return timer; // recursive call
+
+  if (ActiveDepth == PERF_MAX_DEPTH)
+    return timer;
+
+  Active[ActiveDepth++] = probe;
+  timer.probe = probe;
+  timer.start = perf_now();
+  return timer;
+}
+
+/**
+ * perf_timer_stop - Stop timing a Probe
+ * @param timer Timer from perf_timer_start()
+ *
+ * This is called automatically when a PERF_SCOPE() goes out of scope.
+ */
+void perf_timer_stop(struct PerfTimer *timer)
+{
+  struct PerfProbe *probe = timer->probe;
+  if (!probe)
+    return;
+
+  const uint64_t ns = perf_now() - timer->start;
+  ActiveDepth--;
+
+  /* Bucket n holds durations of less than 2^n microseconds */
+  int bucket = 0;
+  for (uint64_t us = ns / 1000; us && (bucket < (PERF_BUCKETS - 1)); us >>= 1)
+    bucket++;
+
+  perf_lock();
+  perf_register(probe);
+  probe->count++;
+  probe->total += ns;
+  if (ns > probe->max)
+    probe->max = ns;
+  probe->buckets[bucket]++;
+  perf_unlock();
+}
+
+/**
+ * perf_count - Increment a counter
+ * @param probe Probe
+ */
+void perf_count(struct PerfProbe *probe)
+{
+  perf_lock();
+  perf_register(probe);
+  probe->count++;
+  perf_unlock();
+}
+
+/**
+ * perf_percentile - Estimate a percentile of a Probe's durations
+ * @param probe   Probe
+ * @param percent Percentile, e.g. 90
+ * @retval num Upper bound of the duration, in microseconds
+ */
+static double perf_percentile(const struct PerfProbe *probe, int percent)
+{
+  const double max = probe->max / 1e3;
+  const uint64_t rank = ((probe->count * percent) + 99) / 100;
+  uint64_t seen = 0;
+  for (int i = 0; i < PERF_BUCKETS; i++)
+  {
+    seen += probe->buckets[i];
+    if (seen >= rank)
+      return MIN((double) ((uint64_t) 1 << i), max);
+  }
+  return max;
+}
+
+/**
+ * perf_dump - Write a report of all the Probes
+ * @param fp File to write to
+ *
+ * The percentiles are upper bounds, accurate to a power of two.
+ */
+void perf_dump(FILE *fp)
+{
+  fprintf(fp, "%-24s %10s %12s %10s %10s %10s %10s %10s\n", "probe", "count",
+          "total ms", "mean us", "p50 us", "p90 us", "p99 us", "max us");
+
+  perf_lock();
+  for (struct PerfProbe *probe = Probes; probe; probe = probe->next)
+  {
+    if (!probe->timed)
+    {
+      fprintf(fp, "%-24s %10llu\n", probe->name, (unsigned long long) probe->count);
+      continue;
+    }
+
+    if (probe->count == 0)
+      continue;
+
+    fprintf(fp, "%-24s %10llu %12.3f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+            probe->name, (unsigned long long) probe->count, probe->total / 1e6,
+            (probe->total / 1e3) / probe->count, perf_percentile(probe, 50),
+            perf_percentile(probe, 90), perf_percentile(probe, 99), probe->max / 1e3);
+  }
+  perf_unlock();
+}
+
+/**
+ * perf_reset - Zero all the Probes
+ */
+void perf_reset(void)
+{
+  perf_lock();
+  for (struct PerfProbe *probe = Probes; probe; probe = probe->next)
+  {
+    probe->count = 0;
+    probe->total = 0;
+    probe->max = 0;
+    for (int i = 0; i < PERF_BUCKETS; i++)
+      probe->buckets[i] = 0;
+  }
+  perf_unlock();
+}
@@ -392,6 +392,18 @@
 ** Also see $$fast_reply.
 */
 
+{ "autoview_cache_size", DT_LONG, 0 },
+/*
+** .pp
+** If this is set to a non-zero number of bytes, NeoMutt will keep the output
+** of the mailcap commands used by "$auto_view" in memory.  Redisplaying a
+** message, e.g. after resizing the screen or toggling the headers, then
+** doesn't need the commands to be run again.
+** .pp
+** The output is reused for the same part, command and screen width.  If
+** the cache is full, the output that was used least recently is dropped.
+*/
+
 { "beep", DT_BOOL, true },
 /*
 ** .pp
@@ -574,6 +586,41 @@
 ** or from editing with edit-headers).
 */
 
+{ "compress_cache", DT_PATH, 0 },
+/*
+** .pp
+** Set this to a directory and NeoMutt will keep the decompressed copies of
+** compressed mailboxes here.  If a compressed mailbox hasn't changed since
+** it was last opened, it won't be decompressed again.  This also lets
+** $$mbox_header_cache work for compressed mailboxes.  You are free to remove
+** entries at any time.
+** .pp
+** If unset, the copies are made in $$tmpdir and deleted when the mailbox is
+** closed.
+** .pp
+** \fBNote:\fP if your hooks decrypt the mailboxes, the plain text will
+** be kept in this directory.
+*/
+
+{ "config_cache", DT_PATH, 0 },
+/*
+** .pp
+** When set, NeoMutt remembers a digest of each config file that it reads
+** without any errors or warnings.  When an unchanged file is read again,
+** the patterns and regular expressions of its hooks aren't compiled
+** until the hooks are first used, which makes startup faster for large
+** configs.
+** .pp
+** Because the patterns are compiled later, relative dates, e.g.
+** \fC~d<1d\fP, are relative to the time that the hook is first used
+** and an invalid pattern is only reported then.  Editing a file causes it
+** to be checked in full the next time it's read.
+** .pp
+** This option must be set before the config files that should be cached
+** are read, e.g. at the top of your neomuttrc, before any "$source"
+** commands.
+*/
+
 { "config_charset", DT_STRING, 0 },
 /*
 ** .pp
@@ -689,6 +736,21 @@
 ** $$crypt_auto_sign, $$crypt_reply_sign and $$smime_is_default.
 */
 
+{ "crypt_cache_size", DT_LONG, 0 },
+/*
+** .pp
+** If this is set to a non-zero number of bytes, NeoMutt will keep the
+** decrypted and verified contents of PGP and S/MIME messages in memory, so
+** that viewing them again, or searching them with ``~b'', doesn't need
+** them to be decrypted again.  The memory is locked, so it will never be
+** written to swap.  If the memory can't be locked (see \fCulimit -l\fP),
+** messages aren't cached.
+** .pp
+** The cache is cleared whenever the config changes, and by
+** \fC<forget-passphrase>\fP.
+** (Crypto only)
+*/
+
 { "crypt_chars", DT_MBTABLE, "SPsK " },
 /*
 ** .pp
@@ -934,9 +996,47 @@
 ** .pp
 ** Warning: Logging at high levels may save private information to the file.
 ** .pp
+** If NeoMutt was configured with \fC--with-debug-max\fP, the messages above
+** that level aren't built in, so setting a higher level has no effect.
+** .pp
 ** This option can be enabled on the command line, "neomutt -d 2"
 ** .pp
-** See also: \fC$$debug_file\fP
+** See also: \fC$$debug_file\fP, \fC$$debug_subsystems\fP
+*/
+
+{ "debug_subsystems", DT_SLIST, 0 },
+/*
+** .pp
+** This variable sets the debug level of parts of NeoMutt, overriding
+** \fC$$debug_level\fP.  It's a comma-separated list of \fIsubsystem=level\fP,
+** where the subsystem is a directory of NeoMutt's source code, e.g.
+** .ts
+** set debug_level=1
+** set debug_subsystems="imap=5,conn=3"
+** .te
+** .pp
+** will log IMAP in detail, the connection code a little less and everything
+** else at level 1.  \fC$$debug_level\fP must be at least 1 for the log file to
+** be written.
+*/
+
+{ "decode_cache_size", DT_LONG, 0 },
+/*
+** .pp
+** If this is set to a non-zero number of bytes, NeoMutt will keep the
+** decoded text of the messages and attachments it displays, searches,
+** quotes or prints in memory.  Decoding includes removing the transfer
+** encoding, converting the character set and running "$auto_view" commands.
+** .pp
+** The text is reused when the same message is decoded the same way again,
+** e.g. when it's redisplayed, or when it's searched again with
+** $$thorough_search set.  The pager, searching, replying and printing each
+** decode a message differently, so they only share the text when they ask
+** for the same output.
+** .pp
+** The cache is emptied when a config variable is changed or a command is
+** run.  Encrypted and signed messages aren't cached.  If the cache is full,
+** the text that was used least recently is dropped.
 */
 
 { "default_hook", DT_STRING, "~f %s !~P | (~P ~C %s)" },
@@ -1518,6 +1618,20 @@
 */
 
 #ifdef USE_HCACHE_COMPRESSION
+{ "header_cache_compress_dictionary", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, and the header cache is compressed with zstd, NeoMutt
+** trains a compression dictionary from the first few hundred headers it
+** stores in each cache file.  The dictionary is saved in the cache and used
+** for all later headers, which makes the small header records compress much
+** better.  Headers stored with a dictionary can't be read when this option
+** is \fIunset\fP; they are simply fetched again from the mailbox.
+** .pp
+** The other compression methods don't support dictionaries and ignore this
+** option.
+*/
+
 { "header_cache_compress_level", DT_NUMBER, 1 },
 /*
 ** .pp
@@ -1533,6 +1647,35 @@
 ** This results in much smaller cache file sizes and may even improve speed.
 */
 #endif
+
+{ "header_cache_per_account", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, and $$header_cache is a directory, the header caches of
+** all the mailboxes of an account, e.g. an IMAP server, are kept in one
+** database file.  Each mailbox has its own table in that file.  Switching
+** between mailboxes then doesn't need a new database to be opened, and the
+** size of the caches is limited by one memory map, rather than one for each
+** mailbox.
+** .pp
+** Only the lmdb backend supports this.  Other backends, and local
+** mailboxes, keep one database file for each mailbox.
+*/
+
+{ "header_cache_threads", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, and $$header_cache is set, NeoMutt saves the threads of
+** local mailboxes (mbox, mmdf, maildir and MH) in the header cache.  The
+** next time the mailbox is opened, the threads are loaded, rather than
+** worked out again from the headers of every message.  Only the messages
+** that have arrived or gone since then are linked into the threads.
+** .pp
+** The saved threads are ignored when $$duplicate_threads, $$sort_re,
+** $$strict_threads or $$thread_received have changed.  Changes to other
+** options, such as $$reply_regex, or to the messages' headers, are
+** treated as new messages.
+*/
 #endif
 
 { "header_color_partial", DT_BOOL, false },
@@ -1779,6 +1922,45 @@
 ** headers.
 */
 
+{ "imap_fetch_chunk_time", DT_NUMBER, 0 },
+/*
+** .pp
+** When set to a value greater than 0, new headers will be downloaded in
+** blocks that take about this many milliseconds each.  The size of each
+** block is estimated from the download rate of the previous one.  The next
+** block is requested before the current one has finished, so the server
+** isn't left waiting.
+** .pp
+** The first block is $$imap_fetch_chunk_size headers, or 100 if that isn't
+** set.  Each block is at most twice as large as the one before.
+*/
+
+{ "imap_fetch_connections", DT_NUMBER, 1 },
+/*
+** .pp
+** When a large mailbox is opened for the first time, its headers can be
+** downloaded over this many connections to the server at once.  Each extra
+** connection examines the mailbox and downloads the headers of a separate
+** range of messages.  Extra connections are only opened if each one would
+** download at least 1000 headers.
+** .pp
+** If set to 1, or less, all the headers are downloaded over the mailbox's
+** own connection.
+*/
+
+{ "imap_fetch_partial_size", DT_LONG, 0 },
+/*
+** .pp
+** When set to a value greater than 0, a multipart message of at least this
+** many bytes is displayed without downloading it all.  Only its text parts,
+** and any attachments smaller than this, are fetched.  The pager shows the
+** size of each attachment that was left on the server.
+** .pp
+** The whole message is downloaded when it's needed, e.g. to view an
+** attachment, to save the message or to reply to it.  Signed and encrypted
+** messages are always downloaded in full.
+*/
+
 { "imap_headers", DT_STRING, 0 },
 /*
 ** .pp
@@ -1804,6 +1986,22 @@
 ** up periodically, try unsetting this.
 */
 
+{ "imap_idle_mailboxes", DT_SLIST, 0 },
+/*
+** .pp
+** This is a comma-separated list of IMAP mailboxes that NeoMutt watches
+** with the IMAP IDLE extension, when they aren't open.  Give either the
+** name of the mailbox on the server, e.g. "INBOX", or its path.
+** .pp
+** Each mailbox gets a connection of its own, which waits for the server to
+** report changes.  The mailbox is checked as soon as it changes, rather than
+** every $$mail_check seconds, and it isn't polled while it's unchanged.
+** .pp
+** If the server supports the NOTIFY extension, and $$imap_notify is set,
+** NOTIFY is used instead.  Servers limit the number of connections a user
+** may have, so only list a few mailboxes.
+*/
+
 { "imap_keepalive", DT_NUMBER, 300 },
 /*
 ** .pp
@@ -1832,6 +2030,20 @@
 ** This variable defaults to the value of $$imap_user.
 */
 
+{ "imap_notify", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, NeoMutt will use the IMAP NOTIFY extension, if the server
+** supports it, to be told about changes to the mailboxes of an account,
+** instead of polling them.  The server reports new, expunged and changed
+** messages in the current mailbox as they happen.  NeoMutt only checks
+** the other mailboxes of the account, with a STATUS command, when the
+** server reports that they have changed.
+** .pp
+** Mailboxes added after the connection was opened are polled as usual.
+** See also $$mail_check and $$imap_idle.
+*/
+
 { "imap_oauth_refresh_command", DT_COMMAND, 0 },
 /*
 ** .pp
@@ -1841,6 +2053,20 @@
 ** mechanism.  See "$oauth" for details.
 */
 
+{ "imap_open_cached", DT_BOOL, false },
+/*
+** .pp
+** When \fIset\fP, NeoMutt won't connect to an IMAP server until it's needed.
+** If a mailbox is opened from the index and its header cache was last brought
+** up to date using QRESYNC or CONDSTORE, the cached emails are shown
+** straight away, read-only.  Once they have been drawn, NeoMutt connects,
+** selects the mailbox and catches up with the changes made since.  If the
+** server can't be reached, NeoMutt tries again every $$mail_check seconds.
+** .pp
+** This only has an effect if NeoMutt was built with a header cache, see
+** $$header_cache.
+*/
+
 { "imap_pass", DT_STRING, 0 },
 /*
 ** .pp
@@ -1881,6 +2107,9 @@
 ** more responsive. But not all servers correctly handle pipelined commands,
 ** so if you have problems you might want to try setting this variable to 0.
 ** .pp
+** While the server keeps up, the pipeline may grow to four times this depth.
+** It shrinks again if the server rejects a command as bad.
+** .pp
 ** \fBNote:\fP Changes to this variable have no effect on open connections.
 */
 
@@ -1893,6 +2122,20 @@
 ** to 0 to disable timing out.
 */
 
+{ "imap_prefetch", DT_NUMBER, 0 },
+/*
+** .pp
+** When set to a value greater than 0, NeoMutt downloads the next this many
+** messages, in index order, after a message has been opened.  They're
+** fetched one at a time while NeoMutt is waiting for a key, and stored in
+** the $$message_cachedir, so moving to the next message doesn't have to wait
+** for the server.  Pressing a key stops the download after the current
+** message.
+** .pp
+** Messages that are already cached are skipped.  This has no effect unless
+** $$message_cachedir is set.
+*/
+
 { "imap_qresync", DT_BOOL, false },
 /*
 ** .pp
@@ -2132,6 +2375,14 @@
 ** a "$mbox-hook" command.
 */
 
+{ "macro_redraw", DT_BOOL, true },
+/*
+** .pp
+** When \fIunset\fP, NeoMutt doesn't draw the index between the functions of
+** a macro, or of the keys queued by "$push" and "$exec".  The index is drawn
+** once, when the macro has finished.  This makes long macros faster.
+*/
+
 { "mail_check", DT_NUMBER, 5 },
 /*
 ** .pp
@@ -2139,6 +2390,19 @@
 ** new mail. Also see the $$timeout variable.
 */
 
+{ "mail_check_backoff", DT_NUMBER, 4 },
+/*
+** .pp
+** Checking every mailbox every $$mail_check seconds wastes time on mailboxes
+** that rarely change, e.g. archives.  Each time a mailbox is checked and
+** nothing has changed, the time until its next check is doubled, up to
+** $$mail_check_backoff times $$mail_check.  As soon as it changes, or has new
+** mail, it's checked every $$mail_check seconds again.
+** .pp
+** Forced checks, e.g. \fC<check-stats>\fP, always check every mailbox.  A
+** value of 0 or 1 checks every mailbox every time.
+*/
+
 { "mail_check_recent", DT_BOOL, true },
 /*
 ** .pp
@@ -2271,6 +2535,20 @@
 ** Also see the $$move variable.
 */
 
+#ifdef USE_HCACHE
+{ "mbox_header_cache", DT_BOOL, false },
+/*
+** .pp
+** When this variable is \fIset\fP, and $$header_cache is set, NeoMutt saves the
+** parsed headers and offsets of the messages in mbox and mmdf folders.
+** Opening the folder again then reads them from the header cache rather than
+** parsing the whole file.
+** .pp
+** The saved index is only used if the folder's size, modification time and
+** first and last blocks haven't changed since it was saved.
+*/
+#endif
+
 { "mbox_type", DT_ENUM, MUTT_MBOX },
 /*
 ** .pp
@@ -2314,6 +2592,31 @@
 ** (especially for large folders).
 */
 
+{ "message_cache_size", DT_LONG, 0 },
+/*
+** .pp
+** When set to a value greater than 0, this is the maximum size, in kilobytes,
+** of the message cache of each mailbox.  When a mailbox's cache grows bigger,
+** the messages that were used least recently are removed, in the background,
+** until it's 10% smaller.
+** .pp
+** NeoMutt keeps an index of the cache in the file \fC.index\fP of each cache
+** directory, so it doesn't have to scan the directory.  Messages added to the
+** cache while this variable was 0 are found by scanning the directory again.
+*/
+
+{ "message_cache_sharded", DT_BOOL, false },
+/*
+** .pp
+** If \fIset\fP, the messages in each mailbox's cache are spread over 256
+** sub-directories, e.g. \fC.3f\fP, chosen by the message's id.  Very large
+** directories are slow on many filesystems, so set this if you cache mailboxes
+** with many thousands of messages.
+** .pp
+** When a mailbox's cache is opened, it's converted to the new layout, which
+** may take a moment for a big cache.  Unsetting the variable converts it back.
+*/
+
 { "message_cachedir", DT_PATH, 0 },
 /*
 ** .pp
@@ -2325,7 +2628,8 @@
 ** remote message only once and can perform regular expression searches
 ** as fast as for local folders.
 ** .pp
-** Also see the $$message_cache_clean variable.
+** Also see the $$message_cache_clean, $$message_cache_sharded and
+** $$message_cache_size variables.
 */
 #endif
 
@@ -2587,6 +2891,18 @@
 ** This variable specifies the timeout for database open in seconds.
 */
 
+{ "nm_query_page_size", DT_NUMBER, 0 },
+/*
+** .pp
+** This variable sets how many messages of a notmuch query are loaded at a
+** time.  When the cursor nears the top or bottom of the index, the next
+** messages are loaded.  Searching, limiting or tagging by pattern loads
+** all of them first.
+** .pp
+** It only applies to queries of the \fCmessages\fP type, without a limit.
+** A value of 0 loads all the messages when the mailbox is opened.
+*/
+
 { "nm_query_type", DT_STRING, "messages" },
 /*
 ** .pp
@@ -2680,6 +2996,18 @@
 ** articles headers will be saved in cache when you quit newsgroup.
 */
 
+#ifdef USE_ZLIB
+{ "nntp_deflate", DT_BOOL, true },
+/*
+** .pp
+** When \fIset\fP, NeoMutt will use the COMPRESS DEFLATE extension (RFC8054)
+** if advertised by the news server.
+** .pp
+** Article overviews and lists of newsgroups compress well, so this can
+** noticeably speed up opening large newsgroups.
+*/
+#endif
+
 { "nntp_listgroup", DT_BOOL, true },
 /*
 ** .pp
@@ -2701,6 +3029,18 @@
 ** Your password for NNTP account.
 */
 
+{ "nntp_pipeline_depth", DT_NUMBER, 16 },
+/*
+** .pp
+** When fetching many articles that aren't next to each other, e.g. the
+** children of an article, NeoMutt sends up to this many commands before
+** waiting for the first answer.  This saves waiting for the server for each
+** article.
+** .pp
+** Only servers which list their capabilities (RFC3977) are sent commands
+** this way.  If set to 0 or 1, each command waits for its answer.
+*/
+
 { "nntp_poll", DT_NUMBER, 60 },
 /*
 ** .pp
@@ -3531,6 +3871,16 @@
 ** index menu when the external pager exits.
 */
 
+{ "query_cache_size", DT_NUMBER, 0 },
+/*
+** .pp
+** If set to a positive number, NeoMutt will remember the results of that
+** many recent address queries (see $$query_command).  Repeating a query,
+** e.g. by pressing \fC<complete-query>\fP again, then won't run the
+** command.  The results are kept until NeoMutt exits, so changes to the
+** external address book won't be seen.  A value of 0 disables the cache.
+*/
+
 { "query_command", DT_COMMAND, 0 },
 /*
 ** .pp
@@ -3922,6 +4272,21 @@
 ** before search results. By default, search results will be top-aligned.
 */
 
+#ifdef USE_HCACHE
+{ "search_index", DT_BOOL, false },
+/*
+** .pp
+** When this variable is \fIset\fP, and $$header_cache is set, NeoMutt keeps a
+** small summary of the text of each message in local folders (mbox, mmdf,
+** maildir and MH) when it searches them with \fC~b\fP, \fC~B\fP or \fC~h\fP.
+** .pp
+** The next time the folder is searched for a string, e.g. \fC=b foo\fP or
+** \fC~b 'foo.*bar'\fP, the messages that can't contain it are skipped without
+** being read.  Regular expressions without a fixed string, e.g.
+** \fC~b 'fo?o'\fP, still read every message.
+*/
+#endif
+
 { "send_charset", DT_STRING, "us-ascii:iso-8859-1:utf-8" },
 /*
 ** .pp
@@ -3937,6 +4302,33 @@
 ** NeoMutt uses $$charset as a fallback.
 */
 
+{ "send_queue", DT_PATH, 0 },
+/*
+** .pp
+** If set, messages are sent in the background.  When a message is ready to
+** send, it is saved in this directory and NeoMutt returns to the menu
+** straight away, while another process hands it to the SMTP server or
+** $$sendmail.  Any Fcc is still written by NeoMutt.
+** .pp
+** A message stays in the directory until it has been sent, so if sending
+** fails, or NeoMutt exits first, it will be sent later.  The number of
+** waiting messages is shown by the C%qP sequence of $$status_format.
+** .pp
+** The background process can't ask any questions, so passwords must be
+** set, e.g. $$smtp_pass, and certificates must already be trusted.
+** Messages aren't queued in batch mode, or when using Mixmaster.
+** .pp
+** Also see $$send_queue_retry.
+*/
+
+{ "send_queue_retry", DT_NUMBER, 300 },
+/*
+** .pp
+** The number of seconds to wait before trying to send the messages in
+** $$send_queue again, after an error.  If it's 0, they will only be tried
+** again when NeoMutt is restarted, or another message is sent.
+*/
+
 { "sendmail", DT_COMMAND, SENDMAIL " -oem -oi" },
 /*
 ** .pp
@@ -4708,6 +5100,17 @@
 ** The "unread" value is a synonym for "new".
 */
 
+{ "sort_parallel", DT_LONG, 50000 },
+/*
+** .pp
+** When sorting a mailbox with at least this many messages in the "index"
+** menu, NeoMutt splits the work between all the CPUs of the machine.  This
+** doesn't apply when $$sort is "threads".
+** .pp
+** A value of zero disables parallel sorting.  This variable is ignored if
+** NeoMutt was built without thread support.
+*/
+
 { "sort_re", DT_BOOL, true },
 /*
 ** .pp
@@ -4925,7 +5328,7 @@
 ** .de
 */
 
-{ "status_format", DT_STRING, "-%r-NeoMutt: %D [Msgs:%?M?%M/?%m%?n? New:%n?%?o? Old:%o?%?d? Del:%d?%?F? Flag:%F?%?t? Tag:%t?%?p? Post:%p?%?b? Inc:%b?%?l? %l?]---(%s/%S)-%>-(%P)---" },
+{ "status_format", DT_STRING, "-%r-NeoMutt: %D [Msgs:%?M?%M/?%m%?n? New:%n?%?o? Old:%o?%?d? Del:%d?%?F? Flag:%F?%?t? Tag:%t?%?p? Post:%p?%?q? Queue:%q?%?b? Inc:%b?%?l? %l?]---(%s/%S)-%>-(%P)---" },
 /*
 ** .pp
 ** Controls the format of the status line displayed in the "index"
@@ -4944,9 +5347,12 @@
 ** .dt %m  .dd * .dd The number of messages in the mailbox
 ** .dt %M  .dd * .dd The number of messages shown (i.e., which match the current limit)
 ** .dt %n  .dd * .dd Number of new messages in the mailbox (unread, unseen)
+** .dt %N  .dd * .dd Bytes read/written and round trip time of the mailbox's
+**                   IMAP or POP server, e.g. "1.2M/34K 12ms"
 ** .dt %o  .dd * .dd Number of old messages in the mailbox (unread, seen)
 ** .dt %p  .dd * .dd Number of postponed messages
 ** .dt %P  .dd   .dd Percentage of the way through the index
+** .dt %q  .dd * .dd Number of messages waiting to be sent, see $$send_queue
 ** .dt %r  .dd   .dd Modified/read-only/won't-write/attach-message indicator,
 **                   According to $$status_chars
 ** .dt %R  .dd * .dd Number of read messages in the mailbox (read, seen)
@@ -5327,6 +5733,17 @@
 ** Also see $$copy_decode_weed, $$pipe_decode_weed, $$print_decode_weed.
 */
 
+{ "worker_threads", DT_NUMBER, 0 },
+/*
+** .pp
+** NeoMutt splits some big jobs, e.g. sorting or searching a large mailbox,
+** between several threads.  This variable sets how many threads are used,
+** including the main one.
+** .pp
+** When set to 0, one thread is used for each CPU, up to 16.  When set to 1,
+** everything is done in the main thread.
+*/
+
 { "wrap", DT_NUMBER, 0 },
 /*
 ** .pp
@@ -36,13 +36,17 @@
 #include "mime.h"
 #include "parameter.h"
 
+/// Storage for all the Bodies
+static struct Slab BodySlab = MUTT_SLAB_INIT(struct Body);
+
 /**
  * mutt_body_new - Create a new Body
  * @retval ptr Newly allocated Body
  */
 struct Body *mutt_body_new(void)
 {
-  struct Body *p = mutt_mem_calloc(1, sizeof(struct Body));
+  struct Body *p = mutt_slab_alloc(&BodySlab);
+  MEM_ACCOUNT(MEM_TAG_BODY, sizeof(struct Body), 1);
 
   p->disposition = DISP_ATTACH;
   p->use_disp = true;
@@ -93,7 +97,8 @@ void mutt_body_free(struct Body **ptr)
 
     mutt_env_free(&b->mime_headers);
     mutt_body_free(&b->parts);
-    FREE(&b);
+    mutt_slab_free(&BodySlab, b);
+    MEM_ACCOUNT(MEM_TAG_BODY, -(long) sizeof(struct Body), -1);
   }
 
   *ptr = NULL;
@@ -37,6 +37,9 @@
 
 void nm_edata_free(void **ptr);
 
+/// Storage for all the Emails
+static struct Slab EmailSlab = MUTT_SLAB_INIT(struct Email);
+
 /**
  * email_free - Free an Email
  * @param[out] ptr Email to free
@@ -52,9 +55,11 @@ void email_free(struct Email **ptr)
     e->edata_free(&e->edata);
 
   mutt_env_free(&e->env);
+  FREE(&e->env_rest);
   mutt_body_free(&e->body);
   FREE(&e->tree);
   FREE(&e->path);
+  FREE(&e->render);
 #ifdef MIXMASTER
   mutt_list_free(&e->chain);
 #endif
@@ -63,7 +68,9 @@ void email_free(struct Email **ptr)
 #endif
   driver_tags_free(&e->tags);
 
-  FREE(ptr);
+  mutt_slab_free(&EmailSlab, e);
+  MEM_ACCOUNT(MEM_TAG_EMAIL, -(long) sizeof(struct Email), -1);
+  *ptr = NULL;
 }
 
 /**
@@ -74,16 +81,36 @@ struct Email *email_new(void)
 {
   static size_t sequence = 0;
 
-  struct Email *e = mutt_mem_calloc(1, sizeof(struct Email));
+  struct Email *e = mutt_slab_alloc(&EmailSlab);
+  MEM_ACCOUNT(MEM_TAG_EMAIL, sizeof(struct Email), 1);
 #ifdef MIXMASTER
   STAILQ_INIT(&e->chain);
 #endif
-  STAILQ_INIT(&e->tags);
+  driver_tags_init(&e->tags);
   e->visible = true;
   e->sequence = sequence++;
   return e;
 }
 
+/**
+ * email_env_load - Make sure an Email's Envelope is complete
+ * @param e Email
+ *
+ * An Email read from the header cache may only have the Envelope fields that
+ * the index needs.  The rest are kept encoded until something asks for them.
+ *
+ * @note This must be called on the main thread
+ */
+void email_env_load(struct Email *e)
+{
+  if (!e || !e->env_rest)
+    return;
+
+  if (e->env && e->env_load)
+    e->env_load(e);
+  FREE(&e->env_rest);
+}
+
 /**
  * email_cmp_strict - Strictly compare message emails
  * @param e1 First Email
@@ -154,6 +181,7 @@ int emaillist_add_email(struct EmailList *el, struct Email *e)
   if (!el || !e)
     return -1;
 
+  email_env_load(e);
   struct EmailNode *en = mutt_mem_calloc(1, sizeof(*en));
   en->email = e;
   STAILQ_INSERT_TAIL(el, en, entries);
@@ -26,6 +26,7 @@
 #include "config.h"
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include "mutt/lib.h"
 #include "ncrypt/lib.h"
@@ -36,8 +37,8 @@
  */
 struct Email
 {
-  SecurityFlags security;      ///< bit 0-10: flags, bit 11,12: application, bit 13: traditional pgp
-                               ///< See: ncrypt/lib.h pgplib.h, smime.h
+  /* The fields used by sorting, limiting and threading come first, so that
+   * walking the index touches as few cache lines as possible. */
 
   bool mime            : 1;    ///< Has a MIME-Version header?
   bool flagged         : 1;    ///< Marked important?
@@ -72,31 +73,41 @@ struct Email
   // the following are used to support collapsing threads
   bool collapsed : 1;          ///< Is this message part of a collapsed thread?
   bool visible   : 1;          ///< Is this message part of the view?
-  size_t num_hidden;           ///< Number of hidden messages in this view
-                               ///< (only valid when collapsed is set)
 
-  short recipient;             ///< User_is_recipient()'s return value, cached
-
-  int pair;                    ///< Color-pair to use when displaying in the index
-
-  time_t date_sent;            ///< Time when the message was sent (UTC)
-  time_t received;             ///< Time when the message was placed in the mailbox
-  LOFF_T offset;               ///< Where in the stream does this message begin?
-  int lines;                   ///< How many lines in the body of this message?
   int index;                   ///< The absolute (unsorted) message number
   int msgno;                   ///< Number displayed to the user
   int vnum;                    ///< Virtual message number
   int score;                   ///< Message score
+  time_t date_sent;            ///< Time when the message was sent (UTC)
+  time_t received;             ///< Time when the message was placed in the mailbox
   struct Envelope *env;        ///< Envelope information
+  unsigned char *env_rest;     ///< Encoded Envelope fields not yet restored, see email_env_load()
+
+  /**
+   * env_load - Restore the rest of the Envelope
+   * @param e Email whose env_rest should be decoded into its env
+   */
+  void (*env_load)(struct Email *e);
+
+  struct MuttThread *thread;   ///< Thread of Emails
+  size_t num_hidden;           ///< Number of hidden messages in this view
+                               ///< (only valid when collapsed is set)
+
+  char *tree;                  ///< Character string to print thread tree
+  size_t sequence;             ///< Sequence number assigned on creation
   struct Body *body;           ///< List of MIME parts
+  LOFF_T offset;               ///< Where in the stream does this message begin?
+  int lines;                   ///< How many lines in the body of this message?
+  int pair;                    ///< Color-pair to use when displaying in the index
+  void *render;                ///< Cached line of the index, see index_make_entry()
   char *path;                  ///< Path of Email (for local Mailboxes)
 
-  char *tree;                  ///< Character string to print thread tree
-  struct MuttThread *thread;   ///< Thread of Emails
+  short recipient;             ///< User_is_recipient()'s return value, cached
+  SecurityFlags security;      ///< bit 0-10: flags, bit 11,12: application, bit 13: traditional pgp
+                               ///< See: ncrypt/lib.h pgplib.h, smime.h
 
   short attach_total;          ///< Number of qualifying attachments in message, if attach_valid
-
-  size_t sequence;             ///< Sequence number assigned on creation
+  uint32_t attach_rules;       ///< Attachment rules that attach_total was counted with
 
 #ifdef MIXMASTER
   struct ListHead chain;       ///< Mixmaster chain
@@ -170,6 +181,7 @@ struct EventHeader
 };
 
 bool          email_cmp_strict(const struct Email *e1, const struct Email *e2);
+void          email_env_load  (struct Email *e);
 void          email_free      (struct Email **ptr);
 struct Email *email_new       (void);
 size_t        email_size      (const struct Email *e);
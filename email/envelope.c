@@ -35,13 +35,17 @@
 #include "address/lib.h"
 #include "envelope.h"
 
+/// Storage for all the Envelopes
+static struct Slab EnvelopeSlab = MUTT_SLAB_INIT(struct Envelope);
+
 /**
  * mutt_env_new - Create a new Envelope
  * @retval ptr New Envelope
  */
 struct Envelope *mutt_env_new(void)
 {
-  struct Envelope *e = mutt_mem_calloc(1, sizeof(struct Envelope));
+  struct Envelope *e = mutt_slab_alloc(&EnvelopeSlab);
+  MEM_ACCOUNT(MEM_TAG_ENVELOPE, sizeof(struct Envelope), 1);
   TAILQ_INIT(&e->return_path);
   TAILQ_INIT(&e->from);
   TAILQ_INIT(&e->to);
@@ -110,7 +114,7 @@ void mutt_env_free(struct Envelope **ptr)
   mutt_addrlist_clear(&env->mail_followup_to);
   mutt_addrlist_clear(&env->x_original_to);
 
-  FREE(&env->list_post);
+  mutt_intern_release(&env->list_post);
   FREE(&env->subject);
   /* real_subj is just an offset to subject and shouldn't be freed */
   FREE(&env->disp_subj);
@@ -137,7 +141,9 @@ void mutt_env_free(struct Envelope **ptr)
   mutt_autocrypthdr_free(&env->autocrypt_gossip);
 #endif
 
-  FREE(ptr);
+  mutt_slab_free(&EnvelopeSlab, env);
+  MEM_ACCOUNT(MEM_TAG_ENVELOPE, -(long) sizeof(struct Envelope), -1);
+  *ptr = NULL;
 }
 
 /**
@@ -214,6 +220,7 @@ void mutt_env_merge(struct Envelope *base, struct Envelope **extra)
     base->subject = (*extra)->subject;
     base->real_subj = (*extra)->real_subj;
     base->disp_subj = (*extra)->disp_subj;
+    base->disp_subj_tag = (*extra)->disp_subj_tag;
     (*extra)->subject = NULL;
     (*extra)->real_subj = NULL;
     (*extra)->disp_subj = NULL;
@@ -26,6 +26,7 @@
 
 #include "config.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include "mutt/lib.h"
 #include "address/lib.h"
 
@@ -66,6 +67,7 @@ struct Envelope
   char *subject;                       ///< Email's subject
   char *real_subj;                     ///< Offset of the real subject
   char *disp_subj;                     ///< Display subject (modified copy of subject)
+  uint32_t disp_subj_tag;              ///< Subject rules that created disp_subj, see subjrx_apply_mods()
   char *message_id;                    ///< Message ID
   char *supersedes;                    ///< Supersedes header
   char *date;                          ///< Sent date
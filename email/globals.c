@@ -34,6 +34,8 @@ struct RegexList NoSpamList = STAILQ_HEAD_INITIALIZER(NoSpamList);
 struct ReplaceList SpamList = STAILQ_HEAD_INITIALIZER(SpamList);
 struct ListHead Ignore = STAILQ_HEAD_INITIALIZER(Ignore);
 struct ListHead UnIgnore = STAILQ_HEAD_INITIALIZER(UnIgnore);
+struct PrefixSet *IgnoreSet;
+struct PrefixSet *UnIgnoreSet;
 struct ListHead MailToAllow = STAILQ_HEAD_INITIALIZER(MailToAllow);
 struct HashTable *AutoSubscribeCache;
 
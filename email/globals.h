@@ -28,9 +28,11 @@
 
 /* Global variables */
 extern struct ListHead Ignore;              ///< List of header patterns to ignore
+extern struct PrefixSet *IgnoreSet;         ///< Compiled #Ignore, see mutt_matches_ignore()
 extern struct RegexList NoSpamList;         ///< List of regexes to whitelist non-spam emails
 extern struct ReplaceList SpamList;         ///< List of regexes and patterns to match spam emails
 extern struct ListHead UnIgnore;            ///< List of header patterns to unignore (see)
+extern struct PrefixSet *UnIgnoreSet;       ///< Compiled #UnIgnore, see mutt_matches_ignore()
 extern struct ListHead MailToAllow;         ///< List of permitted fields in a mailto: url
 extern struct HashTable *AutoSubscribeCache;///< Hash Table of auto-subscribed mailing lists
 extern struct RegexList UnSubscribedLists;  ///< List of regexes to blacklist false matches in SubscribedLists
@@ -49,7 +49,7 @@ void mutt_param_free_one(struct Parameter **p)
 {
   if (!p || !*p)
     return;
-  FREE(&(*p)->attribute);
+  mutt_intern_release(&(*p)->attribute);
   FREE(&(*p)->value);
   FREE(p);
 }
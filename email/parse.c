@@ -239,6 +239,14 @@ static void parse_parameters(struct ParameterList *pl, const char *s, bool allow
 bail:
 
   rfc2231_decode_parameters(pl);
+
+  /* Parameter names are repeated in nearly every email, so share them */
+  struct Parameter *np = NULL;
+  TAILQ_FOREACH(np, pl, entries)
+  {
+    mutt_intern_replace(&np->attribute);
+  }
+
   mutt_buffer_pool_release(&buf);
 }
 
@@ -313,11 +321,20 @@ static void parse_content_language(const char *s, struct Body *ct)
  * @param s String to check
  * @retval true String matches
  *
- * Checks Ignore and UnIgnore using mutt_list_match
+ * Checks Ignore and UnIgnore, like mutt_list_match().  The lists are compiled
+ * into PrefixSets when they're first needed.  Whoever changes the lists must
+ * free #IgnoreSet and #UnIgnoreSet.
  */
 bool mutt_matches_ignore(const char *s)
 {
-  return mutt_list_match(s, &Ignore) && !mutt_list_match(s, &UnIgnore);
+  if (!IgnoreSet)
+    IgnoreSet = mutt_prefixset_new(&Ignore);
+  if (mutt_prefixset_find(IgnoreSet, s) == 0)
+    return false;
+
+  if (!UnIgnoreSet)
+    UnIgnoreSet = mutt_prefixset_new(&UnIgnore);
+  return (mutt_prefixset_find(UnIgnoreSet, s) == 0);
 }
 
 /**
@@ -593,6 +610,152 @@ cleanup:
 }
 #endif
 
+/**
+ * enum HeaderId - Email headers that NeoMutt parses
+ */
+enum HeaderId
+{
+  HDR_UNKNOWN = 0,               ///< Not a header that NeoMutt parses
+  HDR_APPARENTLY_FROM,           ///< "Apparently-From:"
+  HDR_APPARENTLY_TO,             ///< "Apparently-To:"
+  HDR_AUTOCRYPT,                 ///< "Autocrypt:"
+  HDR_AUTOCRYPT_GOSSIP,          ///< "Autocrypt-Gossip:"
+  HDR_BCC,                       ///< "Bcc:"
+  HDR_CC,                        ///< "Cc:"
+  HDR_CONTENT_DESCRIPTION,       ///< "Content-Description:"
+  HDR_CONTENT_DISPOSITION,       ///< "Content-Disposition:"
+  HDR_CONTENT_LANGUAGE,          ///< "Content-Language:"
+  HDR_CONTENT_LENGTH,            ///< "Content-Length:"
+  HDR_CONTENT_TRANSFER_ENCODING, ///< "Content-Transfer-Encoding:"
+  HDR_CONTENT_TYPE,              ///< "Content-Type:"
+  HDR_DATE,                      ///< "Date:"
+  HDR_EXPIRES,                   ///< "Expires:"
+  HDR_FOLLOWUP_TO,               ///< "Followup-To:"
+  HDR_FROM,                      ///< "From:"
+  HDR_IN_REPLY_TO,               ///< "In-Reply-To:"
+  HDR_LINES,                     ///< "Lines:"
+  HDR_LIST_POST,                 ///< "List-Post:"
+  HDR_MAIL_FOLLOWUP_TO,          ///< "Mail-Followup-To:"
+  HDR_MAIL_REPLY_TO,             ///< "Mail-Reply-To:"
+  HDR_MESSAGE_ID,                ///< "Message-ID:"
+  HDR_MIME_VERSION,              ///< "MIME-Version:"
+  HDR_NEWSGROUPS,                ///< "Newsgroups:"
+  HDR_ORGANIZATION,              ///< "Organization:"
+  HDR_RECEIVED,                  ///< "Received:"
+  HDR_REFERENCES,                ///< "References:"
+  HDR_REPLY_TO,                  ///< "Reply-To:"
+  HDR_RETURN_PATH,               ///< "Return-Path:"
+  HDR_SENDER,                    ///< "Sender:"
+  HDR_STATUS,                    ///< "Status:"
+  HDR_SUBJECT,                   ///< "Subject:"
+  HDR_SUPERSEDES,                ///< "Supersedes:" or "Supercedes:"
+  HDR_TO,                        ///< "To:"
+  HDR_X_COMMENT_TO,              ///< "X-Comment-To:"
+  HDR_X_LABEL,                   ///< "X-Label:"
+  HDR_X_ORIGINAL_TO,             ///< "X-Original-To:"
+  HDR_X_STATUS,                  ///< "X-Status:"
+  HDR_XREF,                      ///< "Xref:"
+};
+
+/**
+ * struct HeaderName - The name of a header that NeoMutt parses
+ */
+struct HeaderName
+{
+  const char *name; ///< Lower-case name, e.g. "reply-to"
+  enum HeaderId id; ///< Header ID, e.g. #HDR_REPLY_TO
+};
+
+/// Size of the HeaderNames table, a power of two
+#define HEADER_HASH_SIZE 128
+
+/**
+ * HeaderNames - Headers that NeoMutt parses, indexed by header_hash()
+ *
+ * The multipliers in header_hash() were chosen by searching for the smallest
+ * values that give every name its own slot.  If a name is added, check that
+ * it doesn't collide with another, or choose new multipliers.
+ */
+static const struct HeaderName HeaderNames[HEADER_HASH_SIZE] = {
+  // clang-format off
+  [  3] = { "reply-to",                  HDR_REPLY_TO },
+  [  9] = { "from",                      HDR_FROM },
+  [ 11] = { "return-path",               HDR_RETURN_PATH },
+  [ 14] = { "mime-version",              HDR_MIME_VERSION },
+  [ 15] = { "content-transfer-encoding", HDR_CONTENT_TRANSFER_ENCODING },
+  [ 17] = { "x-status",                  HDR_X_STATUS },
+  [ 21] = { "to",                        HDR_TO },
+  [ 24] = { "bcc",                       HDR_BCC },
+  [ 29] = { "autocrypt",                 HDR_AUTOCRYPT },
+  [ 31] = { "mail-reply-to",             HDR_MAIL_REPLY_TO },
+  [ 32] = { "x-label",                   HDR_X_LABEL },
+  [ 34] = { "list-post",                 HDR_LIST_POST },
+  [ 40] = { "cc",                        HDR_CC },
+  [ 41] = { "mail-followup-to",          HDR_MAIL_FOLLOWUP_TO },
+  [ 45] = { "sender",                    HDR_SENDER },
+  [ 49] = { "references",                HDR_REFERENCES },
+  [ 56] = { "followup-to",               HDR_FOLLOWUP_TO },
+  [ 64] = { "supercedes",                HDR_SUPERSEDES },
+  [ 65] = { "xref",                      HDR_XREF },
+  [ 67] = { "received",                  HDR_RECEIVED },
+  [ 68] = { "apparently-from",           HDR_APPARENTLY_FROM },
+  [ 69] = { "organization",              HDR_ORGANIZATION },
+  [ 77] = { "status",                    HDR_STATUS },
+  [ 78] = { "content-length",            HDR_CONTENT_LENGTH },
+  [ 79] = { "lines",                     HDR_LINES },
+  [ 80] = { "supersedes",                HDR_SUPERSEDES },
+  [ 84] = { "subject",                   HDR_SUBJECT },
+  [ 85] = { "expires",                   HDR_EXPIRES },
+  [ 89] = { "x-comment-to",              HDR_X_COMMENT_TO },
+  [ 92] = { "apparently-to",             HDR_APPARENTLY_TO },
+  [ 94] = { "x-original-to",             HDR_X_ORIGINAL_TO },
+  [ 95] = { "content-language",          HDR_CONTENT_LANGUAGE },
+  [ 99] = { "content-type",              HDR_CONTENT_TYPE },
+  [100] = { "in-reply-to",               HDR_IN_REPLY_TO },
+  [107] = { "content-description",       HDR_CONTENT_DESCRIPTION },
+  [108] = { "date",                      HDR_DATE },
+  [110] = { "message-id",                HDR_MESSAGE_ID },
+  [111] = { "content-disposition",       HDR_CONTENT_DISPOSITION },
+  [117] = { "autocrypt-gossip",          HDR_AUTOCRYPT_GOSSIP },
+  [122] = { "newsgroups",                HDR_NEWSGROUPS },
+  // clang-format on
+};
+
+/**
+ * header_hash - Hash the name of a header
+ * @param name Header name, e.g. "Reply-To"
+ * @param len  Length of the name, must be at least 1
+ * @retval num Index into HeaderNames
+ *
+ * The hash ignores case and only looks at three characters of the name.
+ */
+static unsigned int header_hash(const char *name, size_t len)
+{
+  const unsigned char *s = (const unsigned char *) name;
+  return (len + (17 * tolower(s[0])) + (16 * tolower(s[len - 1])) +
+          tolower(s[len / 2])) &
+         (HEADER_HASH_SIZE - 1);
+}
+
+/**
+ * header_lookup - Find the ID of a header
+ * @param name Header name, e.g. "Reply-To"
+ * @retval enum Header ID, e.g. #HDR_REPLY_TO
+ * @retval #HDR_UNKNOWN The header isn't one that NeoMutt parses
+ */
+static enum HeaderId header_lookup(const char *name)
+{
+  const size_t len = strlen(name);
+  if (len == 0)
+    return HDR_UNKNOWN;
+
+  const struct HeaderName *hn = &HeaderNames[header_hash(name, len)];
+  if (!hn->name || !mutt_istr_equal(name, hn->name))
+    return HDR_UNKNOWN;
+
+  return hn->id;
+}
+
 /**
  * mutt_rfc822_parse_line - Parse an email header
  * @param env       Envelope of the email
@@ -616,93 +779,74 @@ int mutt_rfc822_parse_line(struct Envelope *env, struct Email *e, char *line,
 
   bool matched = false;
 
-  switch (tolower(line[0]))
+  switch (header_lookup(line))
   {
-    case 'a':
-      if (mutt_istr_equal(line + 1, "pparently-to"))
-      {
-        mutt_addrlist_parse(&env->to, p);
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "pparently-from"))
-      {
-        mutt_addrlist_parse(&env->from, p);
-        matched = true;
-      }
+    case HDR_APPARENTLY_TO:
+      mutt_addrlist_parse(&env->to, p);
+      matched = true;
       break;
 
-    case 'b':
-      if (mutt_istr_equal(line + 1, "cc"))
-      {
-        mutt_addrlist_parse(&env->bcc, p);
-        matched = true;
-      }
+    case HDR_APPARENTLY_FROM:
+      mutt_addrlist_parse(&env->from, p);
+      matched = true;
+      break;
+
+    case HDR_BCC:
+      mutt_addrlist_parse(&env->bcc, p);
+      matched = true;
+      break;
+
+    case HDR_CC:
+      mutt_addrlist_parse(&env->cc, p);
+      matched = true;
+      break;
+
+    case HDR_CONTENT_TYPE:
+      if (e)
+        mutt_parse_content_type(p, e->body);
+      matched = true;
+      break;
+
+    case HDR_CONTENT_LANGUAGE:
+      if (e)
+        parse_content_language(p, e->body);
+      matched = true;
+      break;
+
+    case HDR_CONTENT_TRANSFER_ENCODING:
+      if (e)
+        e->body->encoding = mutt_check_encoding(p);
+      matched = true;
       break;
 
-    case 'c':
-      if (mutt_istr_equal(line + 1, "c"))
+    case HDR_CONTENT_LENGTH:
+      if (e)
       {
-        mutt_addrlist_parse(&env->cc, p);
-        matched = true;
+        int rc = mutt_str_atol(p, (long *) &e->body->length);
+        if ((rc < 0) || (e->body->length < 0))
+          e->body->length = -1;
+        if (e->body->length > CONTENT_TOO_BIG)
+          e->body->length = CONTENT_TOO_BIG;
       }
-      else
+      matched = true;
+      break;
+
+    case HDR_CONTENT_DESCRIPTION:
+      if (e)
       {
-        size_t plen = mutt_istr_startswith(line + 1, "ontent-");
-        if (plen != 0)
-        {
-          if (mutt_istr_equal(line + 1 + plen, "type"))
-          {
-            if (e)
-              mutt_parse_content_type(p, e->body);
-            matched = true;
-          }
-          else if (mutt_istr_equal(line + 1 + plen, "language"))
-          {
-            if (e)
-              parse_content_language(p, e->body);
-            matched = true;
-          }
-          else if (mutt_istr_equal(line + 1 + plen, "transfer-encoding"))
-          {
-            if (e)
-              e->body->encoding = mutt_check_encoding(p);
-            matched = true;
-          }
-          else if (mutt_istr_equal(line + 1 + plen, "length"))
-          {
-            if (e)
-            {
-              int rc = mutt_str_atol(p, (long *) &e->body->length);
-              if ((rc < 0) || (e->body->length < 0))
-                e->body->length = -1;
-              if (e->body->length > CONTENT_TOO_BIG)
-                e->body->length = CONTENT_TOO_BIG;
-            }
-            matched = true;
-          }
-          else if (mutt_istr_equal(line + 1 + plen, "description"))
-          {
-            if (e)
-            {
-              mutt_str_replace(&e->body->description, p);
-              rfc2047_decode(&e->body->description);
-            }
-            matched = true;
-          }
-          else if (mutt_istr_equal(line + 1 + plen, "disposition"))
-          {
-            if (e)
-              parse_content_disposition(p, e->body);
-            matched = true;
-          }
-        }
+        mutt_str_replace(&e->body->description, p);
+        rfc2047_decode(&e->body->description);
       }
+      matched = true;
       break;
 
-    case 'd':
-      if (!mutt_istr_equal("ate", line + 1))
-        break;
+    case HDR_CONTENT_DISPOSITION:
+      if (e)
+        parse_content_disposition(p, e->body);
+      matched = true;
+      break;
 
+    case HDR_DATE:
       mutt_str_replace(&env->date, p);
       if (e)
       {
@@ -718,301 +862,269 @@ int mutt_rfc822_parse_line(struct Envelope *env, struct Email *e, char *line,
       matched = true;
       break;
 
-    case 'e':
-      if (mutt_istr_equal("xpires", line + 1) && e &&
-          (mutt_date_parse_date(p, NULL) < mutt_date_epoch()))
+    case HDR_EXPIRES:
+      if (e && (mutt_date_parse_date(p, NULL) < mutt_date_epoch()))
       {
         e->expired = true;
       }
       break;
 
-    case 'f':
-      if (mutt_istr_equal("rom", line + 1))
-      {
-        mutt_addrlist_parse(&env->from, p);
-        matched = true;
-      }
+    case HDR_FROM:
+      mutt_addrlist_parse(&env->from, p);
+      matched = true;
+      break;
+
 #ifdef USE_NNTP
-      else if (mutt_istr_equal(line + 1, "ollowup-to"))
+    case HDR_FOLLOWUP_TO:
+      if (!env->followup_to)
       {
-        if (!env->followup_to)
-        {
-          mutt_str_remove_trailing_ws(p);
-          env->followup_to = mutt_str_dup(mutt_str_skip_whitespace(p));
-        }
-        matched = true;
+        mutt_str_remove_trailing_ws(p);
+        env->followup_to = mutt_str_dup(mutt_str_skip_whitespace(p));
       }
-#endif
+      matched = true;
       break;
+#endif
 
-    case 'i':
-      if (!mutt_istr_equal(line + 1, "n-reply-to"))
-        break;
-
+    case HDR_IN_REPLY_TO:
       mutt_list_free(&env->in_reply_to);
       parse_references(&env->in_reply_to, p);
       matched = true;
       break;
 
-    case 'l':
-      if (mutt_istr_equal(line + 1, "ines"))
+    case HDR_LINES:
+      if (e)
       {
-        if (e)
-        {
-          /* HACK - neomutt has, for a very short time, produced negative
-           * Lines header values.  Ignore them.  */
-          if ((mutt_str_atoi(p, &e->lines) < 0) || (e->lines < 0))
-            e->lines = 0;
-        }
-
-        matched = true;
+        /* HACK - neomutt has, for a very short time, produced negative
+         * Lines header values.  Ignore them.  */
+        if ((mutt_str_atoi(p, &e->lines) < 0) || (e->lines < 0))
+          e->lines = 0;
       }
-      else if (mutt_istr_equal(line + 1, "ist-Post"))
-      {
-        /* RFC2369.  FIXME: We should ignore whitespace, but don't. */
-        if (!mutt_strn_equal(p, "NO", 2))
-        {
-          char *beg = NULL, *end = NULL;
-          for (beg = strchr(p, '<'); beg; beg = strchr(end, ','))
-          {
-            beg++;
-            end = strchr(beg, '>');
-            if (!end)
-              break;
 
-            char *mlist = mutt_strn_dup(beg, end - beg);
-            /* Take the first mailto URL */
-            if (url_check_scheme(mlist) == U_MAILTO)
-            {
-              FREE(&env->list_post);
-              env->list_post = mlist;
-              const bool c_auto_subscribe =
-                  cs_subset_bool(NeoMutt->sub, "auto_subscribe");
-              if (c_auto_subscribe)
-                mutt_auto_subscribe(env->list_post);
-
-              break;
-            }
-            FREE(&mlist);
-          }
-        }
-        matched = true;
-      }
+      matched = true;
       break;
 
-    case 'm':
-      if (mutt_istr_equal(line + 1, "ime-version"))
+    case HDR_LIST_POST:
+      /* RFC2369.  FIXME: We should ignore whitespace, but don't. */
+      if (!mutt_strn_equal(p, "NO", 2))
       {
-        if (e)
-          e->mime = true;
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "essage-id"))
-      {
-        /* We add a new "Message-ID:" when building a message */
-        FREE(&env->message_id);
-        env->message_id = mutt_extract_message_id(p, NULL);
-        matched = true;
-      }
-      else
-      {
-        size_t plen = mutt_istr_startswith(line + 1, "ail-");
-        if (plen != 0)
+        char *beg = NULL, *end = NULL;
+        for (beg = strchr(p, '<'); beg; beg = strchr(end, ','))
         {
-          if (mutt_istr_equal(line + 1 + plen, "reply-to"))
-          {
-            /* override the Reply-To: field */
-            mutt_addrlist_clear(&env->reply_to);
-            mutt_addrlist_parse(&env->reply_to, p);
-            matched = true;
-          }
-          else if (mutt_istr_equal(line + 1 + plen, "followup-to"))
+          beg++;
+          end = strchr(beg, '>');
+          if (!end)
+            break;
+
+          char *mlist = mutt_strn_dup(beg, end - beg);
+          /* Take the first mailto URL */
+          if (url_check_scheme(mlist) == U_MAILTO)
           {
-            mutt_addrlist_parse(&env->mail_followup_to, p);
-            matched = true;
+            mutt_intern_release(&env->list_post);
+            env->list_post = mlist;
+            mutt_intern_replace(&env->list_post);
+            const bool c_auto_subscribe =
+                cs_subset_bool(NeoMutt->sub, "auto_subscribe");
+            if (c_auto_subscribe)
+              mutt_auto_subscribe(env->list_post);
+
+            break;
           }
+          FREE(&mlist);
         }
       }
+      matched = true;
+      break;
+
+    case HDR_MIME_VERSION:
+      if (e)
+        e->mime = true;
+      matched = true;
+      break;
+
+    case HDR_MESSAGE_ID:
+      /* We add a new "Message-ID:" when building a message */
+      FREE(&env->message_id);
+      env->message_id = mutt_extract_message_id(p, NULL);
+      matched = true;
+      break;
+
+    case HDR_MAIL_REPLY_TO:
+      /* override the Reply-To: field */
+      mutt_addrlist_clear(&env->reply_to);
+      mutt_addrlist_parse(&env->reply_to, p);
+      matched = true;
+      break;
+
+    case HDR_MAIL_FOLLOWUP_TO:
+      mutt_addrlist_parse(&env->mail_followup_to, p);
+      matched = true;
       break;
 
 #ifdef USE_NNTP
-    case 'n':
-      if (mutt_istr_equal(line + 1, "ewsgroups"))
-      {
-        FREE(&env->newsgroups);
-        mutt_str_remove_trailing_ws(p);
-        env->newsgroups = mutt_str_dup(mutt_str_skip_whitespace(p));
-        matched = true;
-      }
+    case HDR_NEWSGROUPS:
+      FREE(&env->newsgroups);
+      mutt_str_remove_trailing_ws(p);
+      env->newsgroups = mutt_str_dup(mutt_str_skip_whitespace(p));
+      matched = true;
       break;
 #endif
 
-    case 'o':
+    case HDR_ORGANIZATION:
       /* field 'Organization:' saves only for pager! */
-      if (mutt_istr_equal(line + 1, "rganization"))
-      {
-        if (!env->organization && !mutt_istr_equal(p, "unknown"))
-          env->organization = mutt_str_dup(p);
-      }
+      if (!env->organization && !mutt_istr_equal(p, "unknown"))
+        env->organization = mutt_str_dup(p);
       break;
 
-    case 'r':
-      if (mutt_istr_equal(line + 1, "eferences"))
-      {
-        mutt_list_free(&env->references);
-        parse_references(&env->references, p);
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "eply-to"))
-      {
-        mutt_addrlist_parse(&env->reply_to, p);
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "eturn-path"))
-      {
-        mutt_addrlist_parse(&env->return_path, p);
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "eceived"))
+    case HDR_REFERENCES:
+      mutt_list_free(&env->references);
+      parse_references(&env->references, p);
+      matched = true;
+      break;
+
+    case HDR_REPLY_TO:
+      mutt_addrlist_parse(&env->reply_to, p);
+      matched = true;
+      break;
+
+    case HDR_RETURN_PATH:
+      mutt_addrlist_parse(&env->return_path, p);
+      matched = true;
+      break;
+
+    case HDR_RECEIVED:
+      if (e && !e->received)
       {
-        if (e && !e->received)
+        char *d = strrchr(p, ';');
+        if (d)
         {
-          char *d = strrchr(p, ';');
-          if (d)
-          {
-            d = mutt_str_skip_email_wsp(d + 1);
-            e->received = mutt_date_parse_date(d, NULL);
-          }
+          d = mutt_str_skip_email_wsp(d + 1);
+          e->received = mutt_date_parse_date(d, NULL);
         }
       }
       break;
 
-    case 's':
-      if (mutt_istr_equal(line + 1, "ubject"))
-      {
-        if (!env->subject)
-          env->subject = mutt_str_dup(p);
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "ender"))
-      {
-        mutt_addrlist_parse(&env->sender, p);
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "tatus"))
+    case HDR_SUBJECT:
+      if (!env->subject)
+        env->subject = mutt_str_dup(p);
+      matched = true;
+      break;
+
+    case HDR_SENDER:
+      mutt_addrlist_parse(&env->sender, p);
+      matched = true;
+      break;
+
+    case HDR_STATUS:
+      if (e)
       {
-        if (e)
+        while (*p)
         {
-          while (*p)
+          switch (*p)
           {
-            switch (*p)
+            case 'O':
             {
-              case 'O':
-              {
-                const bool c_mark_old =
-                    cs_subset_bool(NeoMutt->sub, "mark_old");
-                e->old = c_mark_old;
-                break;
-              }
-              case 'R':
-                e->read = true;
-                break;
-              case 'r':
-                e->replied = true;
-                break;
+              const bool c_mark_old = cs_subset_bool(NeoMutt->sub, "mark_old");
+              e->old = c_mark_old;
+              break;
             }
-            p++;
+            case 'R':
+              e->read = true;
+              break;
+            case 'r':
+              e->replied = true;
+              break;
           }
+          p++;
         }
-        matched = true;
       }
-      else if (e && (mutt_istr_equal("upersedes", line + 1) ||
-                     mutt_istr_equal("upercedes", line + 1)))
+      matched = true;
+      break;
+
+    case HDR_SUPERSEDES:
+      if (e)
       {
         FREE(&env->supersedes);
         env->supersedes = mutt_str_dup(p);
       }
       break;
 
-    case 't':
-      if (mutt_istr_equal(line + 1, "o"))
-      {
-        mutt_addrlist_parse(&env->to, p);
-        matched = true;
-      }
+    case HDR_TO:
+      mutt_addrlist_parse(&env->to, p);
+      matched = true;
+      break;
+
 #ifdef USE_AUTOCRYPT
-      else if (mutt_istr_equal(line + 1, "utocrypt"))
+    case HDR_AUTOCRYPT:
+    {
+      const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
+      if (c_autocrypt)
       {
-        const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-        if (c_autocrypt)
-        {
-          env->autocrypt = parse_autocrypt(env->autocrypt, p);
-          matched = true;
-        }
+        env->autocrypt = parse_autocrypt(env->autocrypt, p);
+        matched = true;
       }
-      else if (mutt_istr_equal(line + 1, "utocrypt-gossip"))
+      break;
+    }
+
+    case HDR_AUTOCRYPT_GOSSIP:
+    {
+      const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
+      if (c_autocrypt)
       {
-        const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-        if (c_autocrypt)
-        {
-          env->autocrypt_gossip = parse_autocrypt(env->autocrypt_gossip, p);
-          matched = true;
-        }
+        env->autocrypt_gossip = parse_autocrypt(env->autocrypt_gossip, p);
+        matched = true;
       }
-#endif
       break;
+    }
+#endif
 
-    case 'x':
-      if (mutt_istr_equal(line + 1, "-status"))
+    case HDR_X_STATUS:
+      if (e)
       {
-        if (e)
+        while (*p)
         {
-          while (*p)
+          switch (*p)
           {
-            switch (*p)
-            {
-              case 'A':
-                e->replied = true;
-                break;
-              case 'D':
-                e->deleted = true;
-                break;
-              case 'F':
-                e->flagged = true;
-                break;
-              default:
-                break;
-            }
-            p++;
+            case 'A':
+              e->replied = true;
+              break;
+            case 'D':
+              e->deleted = true;
+              break;
+            case 'F':
+              e->flagged = true;
+              break;
+            default:
+              break;
           }
+          p++;
         }
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "-label"))
-      {
-        FREE(&env->x_label);
-        env->x_label = mutt_str_dup(p);
-        matched = true;
       }
+      matched = true;
+      break;
+
+    case HDR_X_LABEL:
+      FREE(&env->x_label);
+      env->x_label = mutt_str_dup(p);
+      matched = true;
+      break;
+
 #ifdef USE_NNTP
-      else if (mutt_istr_equal(line + 1, "-comment-to"))
-      {
-        if (!env->x_comment_to)
-          env->x_comment_to = mutt_str_dup(p);
-        matched = true;
-      }
-      else if (mutt_istr_equal(line + 1, "ref"))
-      {
-        if (!env->xref)
-          env->xref = mutt_str_dup(p);
-        matched = true;
-      }
+    case HDR_X_COMMENT_TO:
+      if (!env->x_comment_to)
+        env->x_comment_to = mutt_str_dup(p);
+      matched = true;
+      break;
+
+    case HDR_XREF:
+      if (!env->xref)
+        env->xref = mutt_str_dup(p);
+      matched = true;
+      break;
 #endif
-      else if (mutt_istr_equal(line + 1, "-original-to"))
-      {
-        mutt_addrlist_parse(&env->x_original_to, p);
-        matched = true;
-      }
+
+    case HDR_X_ORIGINAL_TO:
+      mutt_addrlist_parse(&env->x_original_to, p);
+      matched = true;
       break;
 
     default:
@@ -1039,75 +1151,234 @@ int mutt_rfc822_parse_line(struct Envelope *env, struct Email *e, char *line,
 
 /**
  * mutt_rfc822_read_line - Read a header line from a file
- * @param fp      File to read from
- * @param line    Buffer to store the result
- * @param linelen Length of buffer
- * @retval ptr Line read from file
+ * @param fp  File to read from
+ * @param buf Buffer to store the result
+ * @retval num Number of bytes read from the file
+ * @retval 0   End of the header, or of the file
  *
  * Reads an arbitrarily long header field, and looks ahead for continuation
- * lines.  "line" must point to a dynamically allocated string; it is
- * increased if more space is required to fit the whole line.
+ * lines.  The lines are read straight into the Buffer and joined with a single
+ * space, so a Buffer that's reused for each field soon stops growing.
  */
-char *mutt_rfc822_read_line(FILE *fp, char *line, size_t *linelen)
+size_t mutt_rfc822_read_line(FILE *fp, struct Buffer *buf)
 {
-  if (!fp || !line || !linelen)
-    return NULL;
+  if (!fp || !buf)
+    return 0;
 
-  char *buf = line;
-  int ch;
-  size_t offset = 0;
+  size_t read = 0;
+  mutt_buffer_reset(buf);
 
   while (true)
   {
-    if (!fgets(buf, *linelen - offset, fp) || /* end of file or */
-        (IS_SPACE(*line) && !offset))         /* end of headers */
+    size_t offset = mutt_buffer_len(buf);
+    if ((buf->dsize - offset) < 256)
+      mutt_buffer_alloc(buf, MAX(buf->dsize * 2, offset + 256));
+
+    char *line = buf->data + offset;
+    if (!fgets(line, buf->dsize - offset, fp) || /* end of file or */
+        (IS_SPACE(*line) && (offset == 0)))      /* end of headers */
     {
-      *line = '\0';
-      return line;
+      mutt_buffer_reset(buf);
+      return 0;
     }
 
-    const size_t len = mutt_str_len(buf);
+    const size_t len = mutt_str_len(line);
     if (len == 0)
-      return line;
+      return read;
+
+    read += len;
+    char *end = line + len - 1;
+    buf->dptr = end + 1;
+    if (*end != '\n')
+      continue; /* the line didn't fit */
 
-    buf += len - 1;
-    if (*buf == '\n')
+    /* we did get a full line. remove trailing space */
+    while (IS_SPACE(*end))
     {
-      /* we did get a full line. remove trailing space */
-      while (IS_SPACE(*buf))
-      {
-        *buf-- = '\0'; /* we can't come beyond line's beginning because
-                        * it begins with a non-space */
-      }
+      *end-- = '\0'; /* we can't come beyond the field's beginning because
+                      * it begins with a non-space */
+    }
+    buf->dptr = end + 1;
 
-      /* check to see if the next line is a continuation line */
-      ch = fgetc(fp);
-      if ((ch != ' ') && (ch != '\t'))
-      {
-        ungetc(ch, fp);
-        return line; /* next line is a separate header field or EOH */
-      }
+    /* check to see if the next line is a continuation line */
+    int ch = fgetc(fp);
+    if ((ch != ' ') && (ch != '\t'))
+    {
+      ungetc(ch, fp);
+      return read; /* next line is a separate header field or EOH */
+    }
+    read++;
 
-      /* eat tabs and spaces from the beginning of the continuation line */
-      while (((ch = fgetc(fp)) == ' ') || (ch == '\t'))
-        ; // do nothing
+    /* eat tabs and spaces from the beginning of the continuation line */
+    while (((ch = fgetc(fp)) == ' ') || (ch == '\t'))
+      read++;
 
-      ungetc(ch, fp);
-      *++buf = ' '; /* string is still terminated because we removed
-                       at least one whitespace char above */
+    ungetc(ch, fp);
+    mutt_buffer_addch(buf, ' ');
+  }
+  /* not reached */
+}
+
+/**
+ * header_init_body - Give an Email the default Body
+ * @param e Email
+ */
+static void header_init_body(struct Email *e)
+{
+  if (!e || e->body)
+    return;
+
+  e->body = mutt_body_new();
+
+  /* set the defaults from RFC1521 */
+  e->body->type = TYPE_TEXT;
+  e->body->subtype = mutt_str_dup("plain");
+  e->body->encoding = ENC_7BIT;
+  e->body->length = -1;
+
+  /* RFC2183 says this is arbitrary */
+  e->body->disposition = DISP_INLINE;
+}
+
+/**
+ * header_parse_spam - Match a header against the spam list
+ * @param env  Envelope of the message
+ * @param line Header line
+ */
+static void header_parse_spam(struct Envelope *env, const char *line)
+{
+  char buf[1025];
+  *buf = '\0';
+
+  if (!mutt_replacelist_match(&SpamList, buf, sizeof(buf), line))
+    return;
+  if (mutt_regexlist_match(&NoSpamList, line))
+    return;
+
+  /* if spam tag already exists, figure out how to amend it */
+  if ((!mutt_buffer_is_empty(&env->spam)) && (*buf != '\0'))
+  {
+    /* If `$spam_separator` defined, append with separator */
+    const char *const c_spam_separator =
+        cs_subset_string(NeoMutt->sub, "spam_separator");
+    if (c_spam_separator)
+    {
+      mutt_buffer_addstr(&env->spam, c_spam_separator);
+      mutt_buffer_addstr(&env->spam, buf);
     }
+    else /* overwrite */
+    {
+      mutt_buffer_reset(&env->spam);
+      mutt_buffer_addstr(&env->spam, buf);
+    }
+  }
 
-    buf++;
-    offset = buf - line;
-    if (*linelen < (offset + 256))
+  /* spam tag is new, and match expr is non-empty; copy */
+  else if (mutt_buffer_is_empty(&env->spam) && (*buf != '\0'))
+  {
+    mutt_buffer_addstr(&env->spam, buf);
+  }
+
+  /* match expr is empty; plug in null string if no existing tag */
+  else if (mutt_buffer_is_empty(&env->spam))
+  {
+    mutt_buffer_addstr(&env->spam, "");
+  }
+
+  if (!mutt_buffer_is_empty(&env->spam))
+    mutt_debug(LL_DEBUG5, "spam = %s\n", env->spam.data);
+}
+
+/**
+ * mutt_rfc822_parse_header - Parse one complete header line
+ * @param env       Envelope of the message
+ * @param e         Current Email (optional)
+ * @param line      Header line, e.g. "Subject: hello", will be modified
+ * @param user_hdrs If set, store user headers
+ * @param weed      If set, honor the header weed list for user headers
+ * @retval true  The line was a header
+ * @retval false The line isn't a header
+ *
+ * This is for callers that already have the header fields, e.g. from an NNTP
+ * overview, so they don't need to write them to a file for
+ * mutt_rfc822_read_header().  The line mustn't contain any continuations.
+ * After the last header, call mutt_rfc822_finish_header().
+ */
+bool mutt_rfc822_parse_header(struct Envelope *env, struct Email *e, char *line,
+                              bool user_hdrs, bool weed)
+{
+  if (!env || !line)
+    return false;
+
+  char *p = strpbrk(line, ": \t");
+  if (!p || (*p != ':'))
+    return false;
+
+  header_init_body(e);
+  header_parse_spam(env, line);
+
+  *p = '\0';
+  p = mutt_str_skip_email_wsp(p + 1);
+  if (*p == '\0')
+    return true; /* skip empty header fields */
+
+  mutt_rfc822_parse_line(env, e, line, p, user_hdrs, weed, true);
+  return true;
+}
+
+/**
+ * mutt_rfc822_finish_header - Tidy up after parsing a header
+ * @param env Envelope of the message
+ * @param e   Current Email
+ *
+ * Decode the Envelope and fill in the fields that depend on the others, e.g.
+ * the real subject and a missing date.
+ */
+void mutt_rfc822_finish_header(struct Envelope *env, struct Email *e)
+{
+  if (!env || !e)
+    return;
+
+  header_init_body(e);
+  rfc2047_decode_envelope(env);
+
+  if (env->subject)
+  {
+    regmatch_t pmatch[1];
+
+    const struct Regex *c_reply_regex = cs_subset_regex(NeoMutt->sub, "reply_regex");
+    if (mutt_regex_capture(c_reply_regex, env->subject, 1, pmatch))
     {
-      /* grow the buffer */
-      *linelen += 256;
-      mutt_mem_realloc(&line, *linelen);
-      buf = line + offset;
+      env->real_subj = env->subject + pmatch[0].rm_eo;
     }
+    else
+      env->real_subj = env->subject;
   }
-  /* not reached */
+
+  if (e->received < 0)
+  {
+    mutt_debug(LL_DEBUG1, "resetting invalid received time to 0\n");
+    e->received = 0;
+  }
+
+  /* check for missing or invalid date */
+  if (e->date_sent <= 0)
+  {
+    mutt_debug(LL_DEBUG1,
+               "no date found, using received time from msg separator\n");
+    e->date_sent = e->received;
+  }
+
+#ifdef USE_AUTOCRYPT
+  const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
+  if (c_autocrypt)
+  {
+    struct Mailbox *m = ctx_mailbox(Context);
+    mutt_autocrypt_process_autocrypt_header(m, e, env);
+    /* No sense in taking up memory after the header is processed */
+    mutt_autocrypthdr_free(&env->autocrypt);
+  }
+#endif
 }
 
 /**
@@ -1131,32 +1402,15 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
   struct Envelope *env = mutt_env_new();
   char *p = NULL;
   LOFF_T loc;
-  size_t linelen = 1024;
-  char *line = mutt_mem_malloc(linelen);
-  char buf[linelen + 1];
-
-  if (e)
-  {
-    if (!e->body)
-    {
-      e->body = mutt_body_new();
+  struct Buffer *buf = mutt_buffer_pool_get();
 
-      /* set the defaults from RFC1521 */
-      e->body->type = TYPE_TEXT;
-      e->body->subtype = mutt_str_dup("plain");
-      e->body->encoding = ENC_7BIT;
-      e->body->length = -1;
-
-      /* RFC2183 says this is arbitrary */
-      e->body->disposition = DISP_INLINE;
-    }
-  }
+  header_init_body(e);
 
   while ((loc = ftello(fp)) != -1)
   {
-    line = mutt_rfc822_read_line(fp, line, &linelen);
-    if (*line == '\0')
+    if (mutt_rfc822_read_line(fp, buf) == 0)
       break;
+    char *line = buf->data;
     p = strpbrk(line, ": \t");
     if (!p || (*p != ':'))
     {
@@ -1178,102 +1432,17 @@ struct Envelope *mutt_rfc822_read_header(FILE *fp, struct Email *e, bool user_hd
       break; /* end of header */
     }
 
-    *buf = '\0';
-
-    if (mutt_replacelist_match(&SpamList, buf, sizeof(buf), line))
-    {
-      if (!mutt_regexlist_match(&NoSpamList, line))
-      {
-        /* if spam tag already exists, figure out how to amend it */
-        if ((!mutt_buffer_is_empty(&env->spam)) && (*buf != '\0'))
-        {
-          /* If `$spam_separator` defined, append with separator */
-          const char *const c_spam_separator =
-              cs_subset_string(NeoMutt->sub, "spam_separator");
-          if (c_spam_separator)
-          {
-            mutt_buffer_addstr(&env->spam, c_spam_separator);
-            mutt_buffer_addstr(&env->spam, buf);
-          }
-          else /* overwrite */
-          {
-            mutt_buffer_reset(&env->spam);
-            mutt_buffer_addstr(&env->spam, buf);
-          }
-        }
-
-        /* spam tag is new, and match expr is non-empty; copy */
-        else if (mutt_buffer_is_empty(&env->spam) && (*buf != '\0'))
-        {
-          mutt_buffer_addstr(&env->spam, buf);
-        }
-
-        /* match expr is empty; plug in null string if no existing tag */
-        else if (mutt_buffer_is_empty(&env->spam))
-        {
-          mutt_buffer_addstr(&env->spam, "");
-        }
-
-        if (!mutt_buffer_is_empty(&env->spam))
-          mutt_debug(LL_DEBUG5, "spam = %s\n", env->spam.data);
-      }
-    }
-
-    *p = '\0';
-    p = mutt_str_skip_email_wsp(p + 1);
-    if (*p == '\0')
-      continue; /* skip empty header fields */
-
-    mutt_rfc822_parse_line(env, e, line, p, user_hdrs, weed, true);
+    mutt_rfc822_parse_header(env, e, line, user_hdrs, weed);
   }
 
-  FREE(&line);
+  mutt_buffer_pool_release(&buf);
 
   if (e)
   {
     e->body->hdr_offset = e->offset;
     e->body->offset = ftello(fp);
 
-    rfc2047_decode_envelope(env);
-
-    if (env->subject)
-    {
-      regmatch_t pmatch[1];
-
-      const struct Regex *c_reply_regex =
-          cs_subset_regex(NeoMutt->sub, "reply_regex");
-      if (mutt_regex_capture(c_reply_regex, env->subject, 1, pmatch))
-      {
-        env->real_subj = env->subject + pmatch[0].rm_eo;
-      }
-      else
-        env->real_subj = env->subject;
-    }
-
-    if (e->received < 0)
-    {
-      mutt_debug(LL_DEBUG1, "resetting invalid received time to 0\n");
-      e->received = 0;
-    }
-
-    /* check for missing or invalid date */
-    if (e->date_sent <= 0)
-    {
-      mutt_debug(LL_DEBUG1,
-                 "no date found, using received time from msg separator\n");
-      e->date_sent = e->received;
-    }
-
-#ifdef USE_AUTOCRYPT
-    const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-    if (c_autocrypt)
-    {
-      struct Mailbox *m = ctx_mailbox(Context);
-      mutt_autocrypt_process_autocrypt_header(m, e, env);
-      /* No sense in taking up memory after the header is processed */
-      mutt_autocrypthdr_free(&env->autocrypt);
-    }
-#endif
+    mutt_rfc822_finish_header(env, e);
   }
 
   return env;
@@ -1293,8 +1462,7 @@ struct Body *mutt_read_mime_header(FILE *fp, bool digest)
   struct Body *p = mutt_body_new();
   struct Envelope *env = mutt_env_new();
   char *c = NULL;
-  size_t linelen = 1024;
-  char *line = mutt_mem_malloc(linelen);
+  struct Buffer *buf = mutt_buffer_pool_get();
 
   p->hdr_offset = ftello(fp);
 
@@ -1302,8 +1470,9 @@ struct Body *mutt_read_mime_header(FILE *fp, bool digest)
   p->type = digest ? TYPE_MESSAGE : TYPE_TEXT;
   p->disposition = DISP_INLINE;
 
-  while (*(line = mutt_rfc822_read_line(fp, line, &linelen)) != 0)
+  while (mutt_rfc822_read_line(fp, buf) != 0)
   {
+    char *line = buf->data;
     /* Find the value of the current header */
     c = strchr(line, ':');
     if (c)
@@ -1367,7 +1536,7 @@ struct Body *mutt_read_mime_header(FILE *fp, bool digest)
   else if ((p->type == TYPE_MESSAGE) && !p->subtype)
     p->subtype = mutt_str_dup("rfc822");
 
-  FREE(&line);
+  mutt_buffer_pool_release(&buf);
 
   if (p->mime_headers)
     rfc2047_decode_envelope(p->mime_headers);
@@ -1457,6 +1626,151 @@ bail:
   recurse_level--;
 }
 
+/// Size of the blocks read while looking for MIME boundaries
+#define MULTIPART_BLOCK_SIZE (64 * 1024)
+
+/**
+ * enum BoundaryType - Type of a line that starts with a MIME boundary
+ */
+enum BoundaryType
+{
+  BOUNDARY_OTHER, ///< The boundary is followed by other text
+  BOUNDARY_PART,  ///< Start of a part, e.g. "--boundary"
+  BOUNDARY_FINAL, ///< End of the multipart, e.g. "--boundary--"
+};
+
+/**
+ * struct Boundary - A MIME boundary line found in a multipart body
+ */
+struct Boundary
+{
+  LOFF_T start;           ///< File offset of the start of the line
+  LOFF_T end;             ///< File offset of the next line
+  bool crlf;              ///< Does the line end in CRLF?
+  enum BoundaryType type; ///< Type of the line
+};
+ARRAY_HEAD(BoundaryArray, struct Boundary);
+
+/**
+ * boundary_check - Check whether a line is a MIME boundary
+ * @param[in]  line     Line to check, not NUL-terminated
+ * @param[in]  len      Length of the line, including any newline
+ * @param[in]  boundary Boundary string
+ * @param[in]  blen     Length of the boundary
+ * @param[out] type     Type of the boundary line
+ * @retval true The line starts with the boundary
+ */
+static bool boundary_check(const char *line, size_t len, const char *boundary,
+                           size_t blen, enum BoundaryType *type)
+{
+  if ((len < (blen + 2)) || (line[0] != '-') || (line[1] != '-') ||
+      (memcmp(line + 2, boundary, blen) != 0))
+  {
+    return false;
+  }
+
+  /* Ignore any trailing whitespace */
+  while ((len > (blen + 2)) && IS_SPACE(line[len - 1]))
+    len--;
+
+  const size_t rest = len - (blen + 2);
+  if (rest == 0)
+    *type = BOUNDARY_PART;
+  else if ((rest == 2) && (line[blen + 2] == '-') && (line[blen + 3] == '-'))
+    *type = BOUNDARY_FINAL;
+  else
+    *type = BOUNDARY_OTHER;
+
+  return true;
+}
+
+/**
+ * boundary_scan - Find the boundary lines of a multipart body
+ * @param[in]  fp       File positioned at the start of the body
+ * @param[in]  boundary Boundary string
+ * @param[in]  end_off  Offset of the end of the body
+ * @param[out] ba       Array for the boundary lines
+ *
+ * The body is read in large blocks, and only the starts of lines are looked
+ * at, so nothing is copied.  The scan stops at the end boundary, or after
+ * #MUTT_MIME_MAX_PARTS parts.
+ */
+static void boundary_scan(FILE *fp, const char *boundary, LOFF_T end_off,
+                          struct BoundaryArray *ba)
+{
+  const size_t blen = mutt_str_len(boundary);
+  char *block = mutt_mem_malloc(MULTIPART_BLOCK_SIZE);
+  LOFF_T pos = ftello(fp); /* File offset of block[0] */
+  size_t have = 0;         /* Bytes in the block */
+  size_t start = 0;        /* Start of the current line */
+  bool skip = false;       /* Is the current line the end of a long line? */
+  bool eof = false;
+  int parts = 0;
+
+  while ((pos >= 0) && ((pos + (LOFF_T) start) < end_off))
+  {
+    char *nl = memchr(block + start, '\n', have - start);
+    if (!nl && !eof)
+    {
+      /* Keep the partial line and read some more */
+      if (start == have)
+      {
+        pos += have;
+        have = 0;
+      }
+      else if (start == 0)
+      {
+        if (have == MULTIPART_BLOCK_SIZE)
+        {
+          /* The line is too long to be a boundary, so step over it */
+          pos += have;
+          have = 0;
+          skip = true;
+        }
+      }
+      else
+      {
+        memmove(block, block + start, have - start);
+        pos += start;
+        have -= start;
+      }
+      start = 0;
+
+      const size_t num = fread(block + have, 1, MULTIPART_BLOCK_SIZE - have, fp);
+      have += num;
+      if (num == 0)
+        eof = true;
+      continue;
+    }
+
+    const size_t len = nl ? (nl - (block + start) + 1) : (have - start);
+    if (len == 0)
+      break;
+
+    enum BoundaryType type = BOUNDARY_OTHER;
+    if (!skip && boundary_check(block + start, len, boundary, blen, &type))
+    {
+      struct Boundary b = { 0 };
+      b.start = pos + start;
+      b.end = b.start + len;
+      b.crlf = (len > 1) && (block[start + len - 2] == '\r');
+      b.type = type;
+      ARRAY_ADD(ba, b);
+
+      if ((type == BOUNDARY_FINAL) ||
+          ((type == BOUNDARY_PART) && (++parts >= MUTT_MIME_MAX_PARTS)))
+      {
+        break;
+      }
+    }
+
+    skip = false;
+    start += len;
+  }
+
+  FREE(&block);
+}
+
 /**
  * parse_multipart - Parse a multipart structure
  * @param fp       Stream to read from
@@ -1479,84 +1793,81 @@ static struct Body *parse_multipart(FILE *fp, const char *boundary,
     return NULL;
   }
 
-  char buf[1024];
   struct Body *head = NULL, *last = NULL, *new_body = NULL;
   bool final = false; /* did we see the ending boundary? */
 
-  const size_t blen = mutt_str_len(boundary);
-  while ((ftello(fp) < end_off) && fgets(buf, sizeof(buf), fp))
+  /* Find all the boundaries first, then read the header of each part */
+  LOFF_T next = ftello(fp); /* boundaries before here have already been read */
+  struct BoundaryArray ba = ARRAY_HEAD_INITIALIZER;
+  boundary_scan(fp, boundary, end_off, &ba);
+
+  struct Boundary *bnd = NULL;
+  ARRAY_FOREACH(bnd, &ba)
   {
-    const size_t len = mutt_str_len(buf);
+    if (bnd->start < next)
+      continue;
 
-    const size_t crlf = ((len > 1) && (buf[len - 2] == '\r')) ? 1 : 0;
+    if (last)
+    {
+      last->length = bnd->start - last->offset - 1 - bnd->crlf;
+      if (last->parts && (last->parts->length == 0))
+        last->parts->length = bnd->start - last->parts->offset - 1 - bnd->crlf;
+      /* if the body is empty, we can end up with a -1 length */
+      if (last->length < 0)
+        last->length = 0;
+    }
 
-    if ((buf[0] == '-') && (buf[1] == '-') && mutt_str_startswith(buf + 2, boundary))
+    /* Check for the end boundary */
+    if (bnd->type == BOUNDARY_FINAL)
+    {
+      final = true;
+      break; /* done parsing */
+    }
+    else if (bnd->type == BOUNDARY_PART)
     {
-      if (last)
+      fseeko(fp, bnd->end, SEEK_SET);
+      new_body = mutt_read_mime_header(fp, digest);
+
+#ifdef SUN_ATTACHMENT
+      if (mutt_param_get(&new_body->parameter, "content-lines"))
       {
-        last->length = ftello(fp) - last->offset - len - 1 - crlf;
-        if (last->parts && (last->parts->length == 0))
-          last->parts->length = ftello(fp) - last->parts->offset - len - 1 - crlf;
-        /* if the body is empty, we can end up with a -1 length */
-        if (last->length < 0)
-          last->length = 0;
+        char buf[1024];
+        int lines = 0;
+        if (mutt_str_atoi(mutt_param_get(&new_body->parameter, "content-lines"), &lines) < 0)
+          lines = 0;
+        for (; lines > 0; lines--)
+          if ((ftello(fp) >= end_off) || !fgets(buf, sizeof(buf), fp))
+            break;
       }
+#endif
+      next = ftello(fp);
 
-      if (len > 0)
+      /* Consistency checking - catch bad attachment end boundaries */
+      if (new_body->offset > end_off)
       {
-        /* Remove any trailing whitespace, up to the length of the boundary */
-        for (size_t i = len - 1; IS_SPACE(buf[i]) && (i >= (blen + 2)); i--)
-          buf[i] = '\0';
+        mutt_body_free(&new_body);
+        break;
       }
-
-      /* Check for the end boundary */
-      if (mutt_str_equal(buf + blen + 2, "--"))
+      if (head)
       {
-        final = true;
-        break; /* done parsing */
+        last->next = new_body;
+        last = new_body;
       }
-      else if (buf[2 + blen] == '\0')
+      else
       {
-        new_body = mutt_read_mime_header(fp, digest);
-
-#ifdef SUN_ATTACHMENT
-        if (mutt_param_get(&new_body->parameter, "content-lines"))
-        {
-          int lines = 0;
-          if (mutt_str_atoi(
-                  mutt_param_get(&new_body->parameter, "content-lines"), &lines) < 0)
-            lines = 0;
-          for (; lines > 0; lines--)
-            if ((ftello(fp) >= end_off) || !fgets(buf, sizeof(buf), fp))
-              break;
-        }
-#endif
-        /* Consistency checking - catch bad attachment end boundaries */
-        if (new_body->offset > end_off)
-        {
-          mutt_body_free(&new_body);
-          break;
-        }
-        if (head)
-        {
-          last->next = new_body;
-          last = new_body;
-        }
-        else
-        {
-          last = new_body;
-          head = new_body;
-        }
-
-        /* It seems more intuitive to add the counter increment to
-         * parse_part(), but we want to stop the case where a multipart
-         * contains thousands of tiny parts before the memory and data
-         * structures are allocated.  */
-        if (++(*counter) >= MUTT_MIME_MAX_PARTS)
-          break;
+        last = new_body;
+        head = new_body;
       }
+
+      /* It seems more intuitive to add the counter increment to
+       * parse_part(), but we want to stop the case where a multipart
+       * contains thousands of tiny parts before the memory and data
+       * structures are allocated.  */
+      if (++(*counter) >= MUTT_MIME_MAX_PARTS)
+        break;
     }
   }
+  ARRAY_FREE(&ba);
 
   /* in case of missing end boundary, set the length to something reasonable */
   if (last && (last->length == 0) && !final)
@@ -201,11 +201,9 @@ static size_t try_block(const char *d, size_t dlen, const char *fromcode,
         (iconv(cd, NULL, NULL, &ob, &obl) == (size_t)(-1)))
     {
       assert(errno == E2BIG);
-      iconv_close(cd);
       assert(ib > d);
       return ((ib - d) == dlen) ? dlen : ib - d + 1;
     }
-    iconv_close(cd);
   }
   else
   {
@@ -281,7 +279,6 @@ static size_t encode_block(char *str, char *buf, size_t buflen, const char *from
   const size_t n1 = iconv(cd, (ICONV_CONST char **) &ib, &ibl, &ob, &obl);
   const size_t n2 = iconv(cd, NULL, NULL, &ob, &obl);
   assert(n1 != (size_t)(-1) && n2 != (size_t)(-1));
-  iconv_close(cd);
   return (*encoder)(str, tmp, ob - tmp, tocode);
 }
 
@@ -329,7 +326,7 @@ static size_t choose_block(char *d, size_t dlen, int col, const char *fromcode,
  * @param[in]  charset    Charset to use for the conversion
  * @param[in]  charsetlen Length of the charset parameter
  *
- * The buffer buf is reinitialized at the end of this function.
+ * The buffer buf is reset at the end of this function.
  */
 static void finalize_chunk(struct Buffer *res, struct Buffer *buf, char *charset, size_t charsetlen)
 {
@@ -338,67 +335,80 @@ static void finalize_chunk(struct Buffer *res, struct Buffer *buf, char *charset
   char end = charset[charsetlen];
   charset[charsetlen] = '\0';
   const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
-  mutt_ch_convert_string(&buf->data, charset, c_charset, MUTT_ICONV_HOOK_FROM);
+  if (mutt_ch_convert_is_noop(mutt_buffer_string(buf), charset, c_charset, MUTT_ICONV_HOOK_FROM))
+  {
+    mutt_mb_buffer_filter_unprintable(res, mutt_buffer_string(buf));
+  }
+  else
+  {
+    char *conv = mutt_buffer_strdup(buf);
+    mutt_ch_convert_string(&conv, charset, c_charset, MUTT_ICONV_HOOK_FROM);
+    mutt_mb_buffer_filter_unprintable(res, conv);
+    FREE(&conv);
+  }
   charset[charsetlen] = end;
-  mutt_mb_filter_unprintable(&buf->data);
-  mutt_buffer_addstr(res, buf->data);
-  FREE(&buf->data);
-  mutt_buffer_init(buf);
+  mutt_buffer_reset(buf);
 }
 
 /**
  * decode_word - Decode an RFC2047-encoded string
+ * @param buf Buffer for the result
  * @param s   String to decode
  * @param len Length of the string
  * @param enc Encoding type
- * @retval ptr Decoded string
+ * @retval true Success
  *
- * @note The caller must free the returned string
+ * The decoded text is added to the end of the Buffer.  It stops at the first
+ * nul byte, if any.
  */
-static char *decode_word(const char *s, size_t len, enum ContentEncoding enc)
+static bool decode_word(struct Buffer *buf, const char *s, size_t len, enum ContentEncoding enc)
 {
   const char *it = s;
   const char *end = s + len;
+  const size_t used = mutt_buffer_len(buf);
 
   if (enc == ENC_QUOTED_PRINTABLE)
   {
-    struct Buffer buf = mutt_buffer_make(0);
     for (; it < end; it++)
     {
       if (*it == '_')
       {
-        mutt_buffer_addch(&buf, ' ');
+        mutt_buffer_addch(buf, ' ');
       }
       else if ((it[0] == '=') && (!(it[1] & ~127) && (hexval(it[1]) != -1)) &&
                (!(it[2] & ~127) && (hexval(it[2]) != -1)))
       {
-        mutt_buffer_addch(&buf, (hexval(it[1]) << 4) | hexval(it[2]));
+        mutt_buffer_addch(buf, (hexval(it[1]) << 4) | hexval(it[2]));
         it += 2;
       }
       else
       {
-        mutt_buffer_addch(&buf, *it);
+        mutt_buffer_addch(buf, *it);
       }
     }
-    mutt_buffer_addch(&buf, '\0');
-    return buf.data;
   }
   else if (enc == ENC_BASE64)
   {
     const int olen = 3 * len / 4 + 1;
-    char *out = mutt_mem_malloc(olen);
-    int dlen = mutt_b64_decode(it, out, olen);
+    mutt_buffer_alloc(buf, used + olen + 1);
+    int dlen = mutt_b64_decode(it, buf->data + used, olen);
     if (dlen == -1)
     {
-      FREE(&out);
-      return NULL;
+      buf->data[used] = '\0';
+      return false;
     }
-    out[dlen] = '\0';
-    return out;
+    mutt_buffer_seek(buf, used + dlen);
+    *buf->dptr = '\0';
+  }
+  else
+  {
+    assert(0); /* The enc parameter has an invalid value */
+    return false;
   }
 
-  assert(0); /* The enc parameter has an invalid value */
-  return NULL;
+  /* Text after a nul byte can't be displayed */
+  mutt_buffer_seek(buf, used + mutt_str_len(buf->data + used));
+  return true;
 }
 
 /**
@@ -643,7 +653,12 @@ void rfc2047_decode(char **pd)
   if (!pd || !*pd)
     return;
 
-  struct Buffer buf = mutt_buffer_make(0); /* Output buffer            */
+  /* Nothing to do unless there's an encoded word, or plain text to convert */
+  const char *const c_assumed_charset = cs_subset_string(NeoMutt->sub, "assumed_charset");
+  if (!c_assumed_charset && !strstr(*pd, "=?"))
+    return;
+
+  struct Buffer *buf = mutt_buffer_pool_get(); /* Output buffer     */
   char *s = *pd;            /* Read pointer                           */
   char *beg = NULL;         /* Begin of encoded word                  */
   enum ContentEncoding enc; /* ENC_BASE64 or ENC_QUOTED_PRINTABLE     */
@@ -655,7 +670,7 @@ void rfc2047_decode(char **pd)
   /* Keep some state in case the next decoded word is using the same charset
    * and it happens to be split in the middle of a multibyte character.
    * See https://github.com/neomutt/neomutt/issues/1015 */
-  struct Buffer prev = mutt_buffer_make(0); /* Previously decoded word  */
+  struct Buffer *prev = mutt_buffer_pool_get(); /* Previously decoded words */
   char *prev_charset = NULL;  /* Previously used charset                */
   size_t prev_charsetlen = 0; /* Length of the previously used charset  */
 
@@ -675,48 +690,48 @@ void rfc2047_decode(char **pd)
       }
 
       /* If we have some previously decoded text, add it now */
-      if (!mutt_buffer_is_empty(&prev))
+      if (prev_charset)
       {
-        finalize_chunk(&buf, &prev, prev_charset, prev_charsetlen);
+        finalize_chunk(buf, prev, prev_charset, prev_charsetlen);
+        prev_charset = NULL;
       }
 
       /* Add non-encoded part */
+      if (c_assumed_charset)
+      {
+        char *conv = mutt_strn_dup(s, holelen);
+        mutt_ch_convert_nonmime_string(&conv);
+        mutt_buffer_addstr(buf, conv);
+        FREE(&conv);
+      }
+      else
       {
-        const char *const c_assumed_charset =
-            cs_subset_string(NeoMutt->sub, "assumed_charset");
-        if (c_assumed_charset)
-        {
-          char *conv = mutt_strn_dup(s, holelen);
-          mutt_ch_convert_nonmime_string(&conv);
-          mutt_buffer_addstr(&buf, conv);
-          FREE(&conv);
-        }
-        else
-        {
-          mutt_buffer_addstr_n(&buf, s, holelen);
-        }
+        mutt_buffer_addstr_n(buf, s, holelen);
       }
       s += holelen;
     }
     if (beg)
     {
       /* Some encoded text was found */
-      text[textlen] = '\0';
-      char *decoded = decode_word(text, textlen, enc);
-      if (!decoded)
-      {
-        return;
-      }
-      if (prev.data && ((prev_charsetlen != charsetlen) ||
-                        !mutt_strn_equal(prev_charset, charset, charsetlen)))
+      if (prev_charset && ((prev_charsetlen != charsetlen) ||
+                           !mutt_strn_equal(prev_charset, charset, charsetlen)))
       {
         /* Different charset, convert the previous chunk and add it to the
          * final result */
-        finalize_chunk(&buf, &prev, prev_charset, prev_charsetlen);
+        finalize_chunk(buf, prev, prev_charset, prev_charsetlen);
       }
 
-      mutt_buffer_addstr(&prev, decoded);
-      FREE(&decoded);
+      /* Words in the same charset are decoded into the same chunk */
+      const char c = text[textlen];
+      text[textlen] = '\0';
+      const bool ok = decode_word(prev, text, textlen, enc);
+      text[textlen] = c;
+      if (!ok)
+      {
+        mutt_buffer_pool_release(&prev);
+        mutt_buffer_pool_release(&buf);
+        return;
+      }
       prev_charset = charset;
       prev_charsetlen = charsetlen;
       s = text + textlen + 2; /* Skip final ?= */
@@ -724,14 +739,12 @@ void rfc2047_decode(char **pd)
   }
 
   /* Save the last chunk */
-  if (prev.data)
-  {
-    finalize_chunk(&buf, &prev, prev_charset, prev_charsetlen);
-  }
+  if (prev_charset)
+    finalize_chunk(buf, prev, prev_charset, prev_charsetlen);
 
-  mutt_buffer_addch(&buf, '\0');
-  FREE(pd);
-  *pd = buf.data;
+  mutt_str_replace(pd, mutt_buffer_string(buf));
+  mutt_buffer_pool_release(&prev);
+  mutt_buffer_pool_release(&buf);
 }
 
 /**
@@ -41,23 +41,19 @@ struct HashTable *TagTransforms; ///< Lookup table of alternative tag names
  * @param head             List of tags
  * @param show_hidden      Show hidden tags
  * @param show_transformed Show transformed tags
- * @param filter           Match tags to this string
  * @retval ptr String list of tags
  *
  * Return a new allocated string containing tags separated by space
  */
-static char *driver_tags_getter(struct TagList *head, bool show_hidden,
-                                bool show_transformed, const char *filter)
+static char *driver_tags_getter(struct TagList *head, bool show_hidden, bool show_transformed)
 {
   if (!head)
     return NULL;
 
   char *tags = NULL;
   struct Tag *np = NULL;
-  STAILQ_FOREACH(np, head, entries)
+  STAILQ_FOREACH(np, &head->head, entries)
   {
-    if (filter && !mutt_str_equal(np->name, filter))
-      continue;
     if (show_hidden || !np->hidden)
     {
       if (show_transformed && np->transformed)
@@ -70,15 +66,37 @@ static char *driver_tags_getter(struct TagList *head, bool show_hidden,
 }
 
 /**
- * driver_tags_add - Add a tag to header
+ * driver_tags_cache - Rebuild the cached tag strings
+ * @param list List of tags
+ */
+static void driver_tags_cache(struct TagList *list)
+{
+  FREE(&list->str);
+  FREE(&list->str_transformed);
+  list->str = driver_tags_getter(list, false, false);
+  list->str_transformed = driver_tags_getter(list, false, true);
+}
+
+/**
+ * driver_tags_init - Initialise a list of tags
+ * @param list List of tags
+ */
+void driver_tags_init(struct TagList *list)
+{
+  if (!list)
+    return;
+
+  STAILQ_INIT(&list->head);
+  list->str = NULL;
+  list->str_transformed = NULL;
+}
+
+/**
+ * driver_tags_add_tag - Add a tag to header, without updating the cache
  * @param[in] list    List of tags
  * @param[in] new_tag String representing the new tag
- *
- * Add a tag to the header tags
- *
- * @note The ownership of the string is passed to the TagList structure
  */
-void driver_tags_add(struct TagList *list, char *new_tag)
+static void driver_tags_add_tag(struct TagList *list, char *new_tag)
 {
   char *new_tag_transformed = mutt_hash_find(TagTransforms, new_tag);
 
@@ -95,7 +113,22 @@ void driver_tags_add(struct TagList *list, char *new_tag)
     if (mutt_list_find(&c_hidden_tags->head, new_tag))
       tn->hidden = true;
 
-  STAILQ_INSERT_TAIL(list, tn, entries);
+  STAILQ_INSERT_TAIL(&list->head, tn, entries);
+}
+
+/**
+ * driver_tags_add - Add a tag to header
+ * @param[in] list    List of tags
+ * @param[in] new_tag String representing the new tag
+ *
+ * Add a tag to the header tags
+ *
+ * @note The ownership of the string is passed to the TagList structure
+ */
+void driver_tags_add(struct TagList *list, char *new_tag)
+{
+  driver_tags_add_tag(list, new_tag);
+  driver_tags_cache(list);
 }
 
 /**
@@ -109,7 +142,7 @@ void driver_tags_free(struct TagList *list)
   if (!list)
     return;
 
-  struct Tag *np = STAILQ_FIRST(list);
+  struct Tag *np = STAILQ_FIRST(&list->head);
   struct Tag *next = NULL;
   while (np)
   {
@@ -119,7 +152,9 @@ void driver_tags_free(struct TagList *list)
     FREE(&np);
     np = next;
   }
-  STAILQ_INIT(list);
+  STAILQ_INIT(&list->head);
+  FREE(&list->str);
+  FREE(&list->str_transformed);
 }
 
 /**
@@ -127,12 +162,16 @@ void driver_tags_free(struct TagList *list)
  * @param[in] list List of tags
  * @retval ptr String list of tags
  *
- * Return a new allocated string containing all tags separated by space with
- * transformation
+ * Return a string containing all tags separated by space with transformation
+ *
+ * @note The string belongs to the TagList and is valid until the tags change
  */
-char *driver_tags_get_transformed(struct TagList *list)
+const char *driver_tags_get_transformed(struct TagList *list)
 {
-  return driver_tags_getter(list, false, true, NULL);
+  if (!list)
+    return NULL;
+
+  return list->str_transformed;
 }
 
 /**
@@ -140,11 +179,16 @@ char *driver_tags_get_transformed(struct TagList *list)
  * @param[in] list List of tags
  * @retval ptr String list of tags
  *
- * Return a new allocated string containing all tags separated by space
+ * Return a string containing all tags separated by space
+ *
+ * @note The string belongs to the TagList and is valid until the tags change
  */
-char *driver_tags_get(struct TagList *list)
+const char *driver_tags_get(struct TagList *list)
 {
-  return driver_tags_getter(list, false, false, NULL);
+  if (!list)
+    return NULL;
+
+  return list->str;
 }
 
 /**
@@ -157,7 +201,7 @@ char *driver_tags_get(struct TagList *list)
  */
 char *driver_tags_get_with_hidden(struct TagList *list)
 {
-  return driver_tags_getter(list, true, false, NULL);
+  return driver_tags_getter(list, true, false);
 }
 
 /**
@@ -166,12 +210,22 @@ char *driver_tags_get_with_hidden(struct TagList *list)
  * @param[in] name Tag to transform
  * @retval ptr String tag
  *
- * Return a new allocated string containing all tags separated by space even
- * the hiddens.
+ * Return the transformed name of a tag, even if it's hidden.
+ *
+ * @note The string belongs to the TagList and is valid until the tags change
  */
-char *driver_tags_get_transformed_for(struct TagList *head, const char *name)
+const char *driver_tags_get_transformed_for(struct TagList *head, const char *name)
 {
-  return driver_tags_getter(head, true, true, name);
+  if (!head || !name)
+    return NULL;
+
+  struct Tag *np = NULL;
+  STAILQ_FOREACH(np, &head->head, entries)
+  {
+    if (mutt_str_equal(np->name, name))
+      return np->transformed ? np->transformed : np->name;
+  }
+  return NULL;
 }
 
 /**
@@ -197,9 +251,10 @@ bool driver_tags_replace(struct TagList *head, char *tags)
     struct ListNode *np = NULL;
     STAILQ_FOREACH(np, &hsplit, entries)
     {
-      driver_tags_add(head, np->data);
+      driver_tags_add_tag(head, np->data);
     }
     mutt_list_clear(&hsplit);
+    driver_tags_cache(head);
   }
   return true;
 }
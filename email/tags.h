@@ -41,13 +41,27 @@ struct Tag
   bool hidden;               ///< Tag should be hidden
   STAILQ_ENTRY(Tag) entries; ///< Linked list
 };
-STAILQ_HEAD(TagList, Tag);
+STAILQ_HEAD(TagHead, Tag);
 
-void  driver_tags_free               (struct TagList *list);
-char *driver_tags_get                (struct TagList *list);
-char *driver_tags_get_transformed    (struct TagList *list);
-char *driver_tags_get_transformed_for(struct TagList *list, const char *name);
-char *driver_tags_get_with_hidden    (struct TagList *list);
+/**
+ * struct TagList - A list of header tags
+ *
+ * The strings used for display and matching are rebuilt whenever the tags
+ * change, so reading them is cheap and safe on any thread.
+ */
+struct TagList
+{
+  struct TagHead head;     ///< List of Tags
+  char *str;               ///< Cache of driver_tags_get()
+  char *str_transformed;   ///< Cache of driver_tags_get_transformed()
+};
+
+void        driver_tags_free               (struct TagList *list);
+const char *driver_tags_get                (struct TagList *list);
+const char *driver_tags_get_transformed    (struct TagList *list);
+const char *driver_tags_get_transformed_for(struct TagList *list, const char *name);
+char *      driver_tags_get_with_hidden    (struct TagList *list);
+void        driver_tags_init               (struct TagList *list);
 bool  driver_tags_replace            (struct TagList *list, char *tags);
 void  driver_tags_add                (struct TagList *list, char *tag);
 
@@ -76,6 +76,10 @@ void unlink_message(struct MuttThread **old, struct MuttThread *cur)
   if (cur->next)
     cur->next->prev = cur->prev;
 
+  cur->redraw = true;
+  if (cur->parent)
+    cur->parent->redraw = true;
+
   if (cur->sort_key)
   {
     for (tmp = cur->parent; tmp && (tmp->sort_key == cur->sort_key); tmp = tmp->parent)
@@ -103,6 +107,10 @@ void insert_message(struct MuttThread **add, struct MuttThread *parent, struct M
   cur->next = *add;
   cur->prev = NULL;
   *add = cur;
+
+  cur->redraw = true;
+  if (parent)
+    parent->redraw = true;
 }
 
 /**
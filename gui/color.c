@@ -222,15 +222,38 @@ static void quotes_clear(struct Colors *c)
 }
 
 /**
- * color_list_free - Free the list of curses colours
- * @param ptr Colours
+ * color_hash - Pick a Colors::user_hash bucket for a pair of colours
+ * @param fg Foreground colour ID
+ * @param bg Background colour ID
+ * @retval num Bucket
  */
-static void color_list_free(struct ColorList **ptr)
+static size_t color_hash(uint32_t fg, uint32_t bg)
 {
-  if (!ptr || !*ptr)
-    return;
+  uint32_t h = (fg * 0x9E3779B1U) ^ bg;
+  h ^= h >> 16;
+  h *= 0x85EBCA6BU;
+  h ^= h >> 13;
+  return h % COLOR_HASH_SIZE;
+}
 
-  struct ColorList *cl = *ptr;
+/**
+ * combine_hash - Pick a Colors::combine entry for a pair of colour pairs
+ * @param fg_attr Colour pair of foreground
+ * @param bg_attr Colour pair of background
+ * @retval num Entry
+ */
+static size_t combine_hash(uint32_t fg_attr, uint32_t bg_attr)
+{
+  return color_hash(fg_attr, bg_attr) % COLOR_COMBINE_SIZE;
+}
+
+/**
+ * color_list_free - Free the list of curses colours
+ * @param c Colours
+ */
+static void color_list_free(struct Colors *c)
+{
+  struct ColorList *cl = c->user_colors;
   struct ColorList *next = NULL;
 
   while (cl)
@@ -239,7 +262,12 @@ static void color_list_free(struct ColorList **ptr)
     FREE(&cl);
     cl = next;
   }
-  *ptr = NULL;
+  c->user_colors = NULL;
+
+  memset(c->user_hash, 0, sizeof(c->user_hash));
+  FREE(&c->user_pairs);
+  c->user_pairs_size = 0;
+  memset(c->combine, 0, sizeof(c->combine));
 }
 
 /**
@@ -254,9 +282,10 @@ void mutt_color_free(struct Colors *c, uint32_t fg, uint32_t bg)
 {
   struct ColorList *q = NULL;
 
-  struct ColorList *p = c->user_colors;
-  while (p)
+  struct ColorList **hp = &c->user_hash[color_hash(fg, bg)];
+  for (; *hp; hp = &(*hp)->hash_next)
   {
+    struct ColorList *p = *hp;
     if ((p->fg == fg) && (p->bg == bg))
     {
       (p->count)--;
@@ -266,6 +295,11 @@ void mutt_color_free(struct Colors *c, uint32_t fg, uint32_t bg)
       c->num_user_colors--;
       mutt_debug(LL_DEBUG1, "Color pairs used so far: %d\n", c->num_user_colors);
 
+      /* The pair number will be reused, so forget any combinations */
+      *hp = p->hash_next;
+      c->user_pairs[p->index] = NULL;
+      memset(c->combine, 0, sizeof(c->combine));
+
       if (p == c->user_colors)
       {
         c->user_colors = c->user_colors->next;
@@ -285,7 +319,6 @@ void mutt_color_free(struct Colors *c, uint32_t fg, uint32_t bg)
       }
       /* can't get here */
     }
-    p = p->next;
   }
 }
 
@@ -307,7 +340,8 @@ static void color_line_free(struct Colors *c, struct ColorLine **ptr, bool free_
     mutt_color_free(c, cl->fg, cl->bg);
 #endif
 
-  regfree(&cl->regex);
+  if (cl->regex_ready)
+    regfree(&cl->regex);
   mutt_pattern_free(&cl->color_pattern);
   FREE(&cl->pattern);
   FREE(ptr);
@@ -347,7 +381,7 @@ static void colors_clear(struct Colors *c)
   defs_clear(c);
   quotes_clear(c);
 
-  color_list_free(&c->user_colors);
+  color_list_free(c);
 }
 
 /**
@@ -412,6 +446,93 @@ static struct ColorLine *color_line_new(void)
   return cl;
 }
 
+/**
+ * mutt_color_lines_reset - Prepare a list of colours for matching a new line
+ * @param list List of colours
+ */
+void mutt_color_lines_reset(struct ColorLineList *list)
+{
+  struct ColorLine *cl = NULL;
+  STAILQ_FOREACH(cl, list, entries)
+  {
+    cl->stop_matching = false;
+    cl->next_valid = false;
+  }
+}
+
+/**
+ * mutt_color_line_compile - Compile a colour's regex on first use
+ * @param cl Colour
+ * @retval true The regex is ready to use
+ *
+ * The regex is only checked for obvious mistakes when the colour is defined.
+ * If it doesn't compile, the error is shown once and the colour never matches.
+ */
+bool mutt_color_line_compile(struct ColorLine *cl)
+{
+  if (!cl || cl->regex_failed)
+    return false;
+  if (cl->regex_ready)
+    return true;
+
+  const int rc = REG_COMP(&cl->regex, cl->pattern, cl->cflags);
+  if (rc != 0)
+  {
+    char errmsg[256];
+    regerror(rc, &cl->regex, errmsg, sizeof(errmsg));
+    mutt_error("'%s': %s", cl->pattern, errmsg);
+    cl->regex_failed = true;
+    return false;
+  }
+
+  cl->regex_ready = true;
+  return true;
+}
+
+/**
+ * mutt_color_line_match - Find the next match of a colour in a line
+ * @param[in]  cl     Colour to match
+ * @param[in]  str    Line of text
+ * @param[in]  offset Offset into the line to search from
+ * @param[out] pmatch Match, relative to the offset
+ * @retval true A match was found
+ *
+ * The line's matches must be searched for in order, having called
+ * mutt_color_lines_reset() first.  Each colour's last match is remembered, and
+ * its regex is only run again once the search has passed that match.  This
+ * way, a line is scanned about once per colour, not once per coloured chunk.
+ */
+bool mutt_color_line_match(struct ColorLine *cl, const char *str, int offset,
+                           regmatch_t *pmatch)
+{
+  if (!cl || !str || !pmatch || !mutt_color_line_compile(cl))
+    return false;
+
+  if (cl->has_context || !cl->next_valid ||
+      ((cl->next_match.rm_so >= 0) && (cl->next_match.rm_so < offset)))
+  {
+    regmatch_t m[1];
+    if (regexec(&cl->regex, str + offset, 1, m, (offset != 0) ? REG_NOTBOL : 0) == 0)
+    {
+      cl->next_match.rm_so = m[0].rm_so + offset;
+      cl->next_match.rm_eo = m[0].rm_eo + offset;
+    }
+    else
+    {
+      cl->next_match.rm_so = -1;
+      cl->next_match.rm_eo = -1;
+    }
+    cl->next_valid = true;
+  }
+
+  if (cl->next_match.rm_so < 0)
+    return false;
+
+  pmatch->rm_so = cl->next_match.rm_so - offset;
+  pmatch->rm_eo = cl->next_match.rm_eo - offset;
+  return true;
+}
+
 #ifdef HAVE_COLOR
 #ifdef USE_SLANG_CURSES
 /**
@@ -475,17 +596,17 @@ int mutt_color_alloc(struct Colors *c, uint32_t fg, uint32_t bg)
 #ifdef USE_SLANG_CURSES
   char fgc[128], bgc[128];
 #endif
-  struct ColorList *p = c->user_colors;
+  const size_t hash = color_hash(fg, bg);
+  struct ColorList *p = c->user_hash[hash];
 
   /* check to see if this color is already allocated to save space */
-  while (p)
+  for (; p; p = p->hash_next)
   {
     if ((p->fg == fg) && (p->bg == bg))
     {
       (p->count)++;
       return COLOR_PAIR(p->index);
     }
-    p = p->next;
   }
 
   /* check to see if there are colors left */
@@ -494,23 +615,24 @@ int mutt_color_alloc(struct Colors *c, uint32_t fg, uint32_t bg)
 
   /* find the smallest available index (object) */
   int i = 1;
-  while (true)
-  {
-    p = c->user_colors;
-    while (p)
-    {
-      if (p->index == i)
-        break;
-      p = p->next;
-    }
-    if (!p)
-      break;
+  while ((i < c->user_pairs_size) && c->user_pairs[i])
     i++;
+
+  if (i >= c->user_pairs_size)
+  {
+    const int size = MAX(2 * c->user_pairs_size, 64);
+    mutt_mem_realloc(&c->user_pairs, size * sizeof(struct ColorList *));
+    memset(c->user_pairs + c->user_pairs_size, 0,
+           (size - c->user_pairs_size) * sizeof(struct ColorList *));
+    c->user_pairs_size = size;
   }
 
   p = mutt_mem_malloc(sizeof(struct ColorList));
   p->next = c->user_colors;
   c->user_colors = p;
+  p->hash_next = c->user_hash[hash];
+  c->user_hash[hash] = p;
+  c->user_pairs[i] = p;
 
   p->index = i;
   p->count = 1;
@@ -577,6 +699,12 @@ static int mutt_lookup_color(struct Colors *c, short pair, uint32_t *fg, uint32_
  */
 int mutt_color_combine(struct Colors *c, uint32_t fg_attr, uint32_t bg_attr)
 {
+  /* The combined pair is never freed, so the result can be reused until a
+   * pair is freed, or the colours are reset */
+  struct ColorCombine *cc = &c->combine[combine_hash(fg_attr, bg_attr)];
+  if ((cc->pair != 0) && (cc->fg_attr == fg_attr) && (cc->bg_attr == bg_attr))
+    return cc->pair;
+
   uint32_t fg = COLOR_DEFAULT;
   uint32_t bg = COLOR_DEFAULT;
 
@@ -585,7 +713,12 @@ int mutt_color_combine(struct Colors *c, uint32_t fg_attr, uint32_t bg_attr)
 
   if ((fg == COLOR_DEFAULT) && (bg == COLOR_DEFAULT))
     return A_NORMAL;
-  return mutt_color_alloc(c, fg, bg);
+
+  const int pair = mutt_color_alloc(c, fg, bg);
+  cc->fg_attr = fg_attr;
+  cc->bg_attr = bg_attr;
+  cc->pair = pair;
+  return pair;
 }
 #endif /* HAVE_COLOR */
 
@@ -995,7 +1128,7 @@ static enum CommandResult add_pattern(struct Colors *c, struct ColorLineList *to
       const char *const c_simple_search =
           cs_subset_string(NeoMutt->sub, "simple_search");
       mutt_check_simple(buf, NONULL(c_simple_search));
-      tmp->color_pattern = mutt_pattern_comp(ctx_mailbox(Context), Context ? Context->menu : NULL, buf->data, MUTT_PC_FULL_MSG, err);
+      tmp->color_pattern = mutt_pattern_comp(ctx_mailbox(Context), Context ? Context->menu : NULL, buf->data, MUTT_PC_FULL_MSG | MUTT_PC_LAZY_REGEX, err);
       mutt_buffer_pool_release(&buf);
       if (!tmp->color_pattern)
       {
@@ -1005,19 +1138,27 @@ static enum CommandResult add_pattern(struct Colors *c, struct ColorLineList *to
     }
     else
     {
-      uint16_t flags = 0;
       if (sensitive)
-        flags = mutt_mb_is_lower(s) ? REG_ICASE : 0;
+        tmp->cflags = mutt_mb_is_lower(s) ? REG_ICASE : 0;
       else
-        flags = REG_ICASE;
+        tmp->cflags = REG_ICASE;
 
-      const int r = REG_COMP(&tmp->regex, s, flags);
-      if (r != 0)
+      /* The regex is compiled when it's first used */
+      if (!mutt_regex_check(s, NULL, err))
       {
-        regerror(r, &tmp->regex, err->data, err->dsize);
         color_line_free(c, &tmp, true);
         return MUTT_CMD_ERROR;
       }
+
+      /* Word boundaries depend on the text before the search position */
+      for (const char *p = strchr(s, '\\'); p && p[1]; p = strchr(p + 2, '\\'))
+      {
+        if (strchr("bB<>`'", p[1]))
+        {
+          tmp->has_context = true;
+          break;
+        }
+      }
     }
     tmp->pattern = mutt_str_dup(s);
     tmp->match = match;
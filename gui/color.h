@@ -34,7 +34,8 @@
  */
 struct ColorLine
 {
-  regex_t regex;                     ///< Compiled regex
+  regex_t regex;                     ///< Compiled regex, see mutt_color_line_compile()
+  int cflags;                        ///< Flags for compiling the regex, e.g. REG_ICASE
   int match;                         ///< Substring to match, 0 for old behaviour
   char *pattern;                     ///< Pattern to match
   struct PatternList *color_pattern; ///< Compiled pattern to speed up index color calculation
@@ -43,6 +44,11 @@ struct ColorLine
   int pair;                          ///< Colour pair index
 
   bool stop_matching : 1;            ///< Used by the pager for body patterns, to prevent the color from being retried once it fails
+  bool has_context   : 1;            ///< The regex looks at the text before a match, e.g. `\<`
+  bool next_valid    : 1;            ///< next_match holds the result of the last search
+  bool regex_ready   : 1;            ///< The regex has been compiled
+  bool regex_failed  : 1;            ///< The regex didn't compile
+  regmatch_t next_match;             ///< Next match in the line being coloured, see mutt_color_line_match()
 
   STAILQ_ENTRY(ColorLine) entries;   ///< Linked list
 };
@@ -124,6 +130,20 @@ struct ColorList
   short index;
   short count;
   struct ColorList *next;
+  struct ColorList *hash_next;             ///< Next ColorList in the same Colors::user_hash bucket
+};
+
+#define COLOR_HASH_SIZE    256 ///< Number of buckets in Colors::user_hash
+#define COLOR_COMBINE_SIZE 64  ///< Number of entries in Colors::combine
+
+/**
+ * struct ColorCombine - A cached result of mutt_color_combine()
+ */
+struct ColorCombine
+{
+  uint32_t fg_attr; ///< Colour pair of the foreground
+  uint32_t bg_attr; ///< Colour pair of the background
+  int pair;         ///< Combined colour pair, 0 if the entry is unused
 };
 
 /**
@@ -148,6 +168,10 @@ struct Colors
 
   struct ColorList *user_colors;
   int num_user_colors;
+  struct ColorList *user_hash[COLOR_HASH_SIZE];     ///< Index of user_colors, by (fg, bg)
+  struct ColorList **user_pairs;                    ///< Index of user_colors, by pair number
+  int user_pairs_size;                              ///< Length of the user_pairs array
+  struct ColorCombine combine[COLOR_COMBINE_SIZE];  ///< Cache of mutt_color_combine()
 
   struct Notify *notify;                   ///< Notifications system
 };
@@ -179,6 +203,10 @@ int  mutt_color_alloc  (struct Colors *c, uint32_t fg,      uint32_t bg);
 int  mutt_color_combine(struct Colors *c, uint32_t fg_attr, uint32_t bg_attr);
 void mutt_color_free   (struct Colors *c, uint32_t fg,      uint32_t bg);
 
+bool mutt_color_line_compile(struct ColorLine *cl);
+bool mutt_color_line_match (struct ColorLine *cl, const char *str, int offset, regmatch_t *pmatch);
+void mutt_color_lines_reset(struct ColorLineList *list);
+
 struct Colors *mutt_colors_new(void);
 void           mutt_colors_free(struct Colors **ptr);
 
@@ -116,6 +116,15 @@ void mutt_refresh(void)
   refresh();
 }
 
+/**
+ * mutt_macro_pending - Are there macro events waiting to be processed?
+ * @retval true There are macro events
+ */
+bool mutt_macro_pending(void)
+{
+  return (MacroBufferCount != 0) && !OptIgnoreMacroEvents;
+}
+
 /**
  * mutt_need_hard_redraw - Force a hard refresh
  *
@@ -393,6 +402,10 @@ enum QuadOption mutt_yesorno(const char *msg, enum QuadOption def)
 
   answer[1] = '\0';
 
+  /* Without a screen, there's no one to ask */
+  if (OptNoCurses)
+    return def;
+
   bool reyes_ok = (expr = nl_langinfo(YESEXPR)) && (expr[0] == '^') &&
                   (REG_COMP(&reyes, expr, REG_NOSUB) == 0);
   bool reno_ok = (expr = nl_langinfo(NOEXPR)) && (expr[0] == '^') &&
@@ -1121,6 +1134,20 @@ void mutt_simple_format(char *buf, size_t buflen, int min_width, int max_width,
       k = (k == (size_t)(-1)) ? 1 : n;
       wc = ReplacementChar;
     }
+    else if ((k == 1) && (wc >= 0x20) && (wc < 0x7f) && !escaped &&
+             mbsinit(&mbstate1) && mbsinit(&mbstate2))
+    {
+      /* Printable ASCII is copied as it is, one column per byte */
+      const size_t ascii = mutt_mb_ascii_span(s, n);
+      const size_t copy = MIN(ascii, MIN((size_t) MAX(max_width, 0), buflen));
+      memcpy(p, s, copy);
+      p += copy;
+      buflen -= copy;
+      min_width -= copy;
+      max_width -= copy;
+      k = ascii;
+      continue;
+    }
     if (escaped)
     {
       escaped = false;
@@ -1275,6 +1302,7 @@ void mutt_paddstr(int n, const char *s)
   size_t k;
   size_t len = mutt_str_len(s);
   mbstate_t mbstate;
+  const char *run = s; /* Start of the characters that haven't been written */
 
   memset(&mbstate, 0, sizeof(mbstate));
   for (; len && (k = mbrtowc(&wc, s, len, &mbstate)); s += k, len -= k)
@@ -1293,12 +1321,22 @@ void mutt_paddstr(int n, const char *s)
     {
       if (w > n)
         break;
-      mutt_window_addnstr((char *) s, k);
       n -= w;
+      continue;
     }
+
+    /* Skip the character */
+    if (s > run)
+      mutt_window_addnstr(run, s - run);
+    run = s + k;
   }
-  while (n-- > 0)
-    mutt_window_addch(' ');
+  if (s > run)
+    mutt_window_addnstr(run, s - run);
+
+  static const char spaces[] = "                                ";
+  const int num_spaces = sizeof(spaces) - 1;
+  for (; n > 0; n -= num_spaces)
+    mutt_window_addnstr(spaces, MIN(n, num_spaces));
 }
 
 /**
@@ -1388,6 +1426,18 @@ int mutt_strnwidth(const char *s, size_t n)
   memset(&mbstate, 0, sizeof(mbstate));
   for (w = 0; n && (k = mbrtowc(&wc, s, n, &mbstate)); s += k, n -= k)
   {
+    /* Printable ASCII is one column per byte */
+    if ((k == 1) && (wc >= 0x20) && (wc < 0x7f) && mbsinit(&mbstate))
+    {
+      const size_t ascii = mutt_mb_ascii_span(s, n);
+      if (ascii > 1)
+      {
+        w += ascii;
+        k = ascii;
+        continue;
+      }
+    }
+
     if (*s == MUTT_SPECIAL_INDEX)
     {
       s += 2; /* skip the index coloring sequence */
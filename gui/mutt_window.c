@@ -533,6 +533,44 @@ int mutt_window_addstr(const char *str)
 #endif
 }
 
+/**
+ * mutt_window_scroll - Scroll the contents of a Window
+ * @param win   Window to scroll
+ * @param lines Number of lines to scroll up, negative to scroll down
+ * @retval true  Success
+ * @retval false The Window can't be scrolled
+ *
+ * The lines that are scrolled into view are blank.  Only Windows that are the
+ * full width of the screen can be scrolled, because the terminal moves whole
+ * lines.
+ */
+bool mutt_window_scroll(struct MuttWindow *win, int lines)
+{
+#ifdef USE_SLANG_CURSES
+  return false;
+#else
+  if (!win || (win->state.col_offset != 0) || (win->state.cols != COLS) ||
+      (win->state.rows < 2))
+  {
+    return false;
+  }
+
+  if (lines == 0)
+    return true;
+
+  const int top = win->state.row_offset;
+  if (setscrreg(top, top + win->state.rows - 1) == ERR)
+    return false;
+
+  scrollok(stdscr, true);
+  const int rc = scrl(lines);
+  scrollok(stdscr, false);
+  setscrreg(0, LINES - 1);
+
+  return (rc != ERR);
+#endif
+}
+
 /**
  * mutt_window_move_abs - Move the cursor to an absolute screen position
  * @param col Screen column (0-based)
@@ -751,6 +789,7 @@ void window_redraw(struct MuttWindow *win, bool force)
   if (!win)
     return;
 
+  TRACE_SCOPE("ui", "window_redraw", NULL);
   window_reflow(win);
   window_notify_all(win);
 
@@ -224,6 +224,7 @@ void mutt_window_move_abs (int col, int row);
 int  mutt_window_mvaddstr (struct MuttWindow *win, int col, int row, const char *str);
 int  mutt_window_mvprintw (struct MuttWindow *win, int col, int row, const char *fmt, ...);
 int  mutt_window_printf   (const char *format, ...);
+bool mutt_window_scroll   (struct MuttWindow *win, int lines);
 bool mutt_window_is_visible(struct MuttWindow *win);
 
 void               mutt_winlist_free (struct MuttWindowList *head);
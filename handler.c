@@ -63,6 +63,7 @@
 
 #define BUFI_SIZE 1000
 #define BUFO_SIZE 2000
+#define QP_BLOCK_SIZE 8192
 
 #define TXT_HTML 1
 #define TXT_PLAIN 2
@@ -77,6 +78,42 @@
  */
 typedef int (*handler_t)(struct Body *b, struct State *s);
 
+/**
+ * struct HandlerCacheEntry - Some cached output of a handler
+ */
+struct HandlerCacheEntry
+{
+  char key[33];     ///< Digest of the part and how it's displayed
+  char *data;       ///< Output of the handler
+  size_t len;       ///< Length of the output
+  StateFlags flags; ///< State flags that the handler left set
+  TAILQ_ENTRY(HandlerCacheEntry) entries; ///< Linked list, most recently used first
+};
+TAILQ_HEAD(HandlerCacheList, HandlerCacheEntry);
+
+/**
+ * struct HandlerCache - Cached output of a handler, limited in size
+ */
+struct HandlerCache
+{
+  struct HandlerCacheList entries; ///< Cached output, most recently used first
+  struct HashTable *hash;          ///< Entries by key
+  size_t bytes;                    ///< Total size of the cached output
+  const char *size_var;            ///< Config variable that limits the size
+};
+
+/// Output of the autoview commands, see $autoview_cache_size
+static struct HandlerCache AutoviewCache = {
+  TAILQ_HEAD_INITIALIZER(AutoviewCache.entries), NULL, 0, "autoview_cache_size"
+};
+
+/// Decoded messages and attachments, see $decode_cache_size
+static struct HandlerCache DecodeCache = {
+  TAILQ_HEAD_INITIALIZER(DecodeCache.entries), NULL, 0, "decode_cache_size"
+};
+
+static FILE *DecodeCacheFile = NULL; ///< Temporary file to collect the decoded output
+
 /**
  * print_part_line - Print a separator for the Mime part
  * @param s State of text being processed
@@ -197,62 +234,57 @@ static void decode_xbit(struct State *s, long len, bool istext, iconv_t cd)
   state_reset_prefix(s);
 }
 
-/**
- * qp_decode_triple - Decode a quoted-printable triplet
- * @param s State to work with
- * @param d Decoded character
- * @retval 0 Success
- * @retval -1 Error
- */
-static int qp_decode_triple(char *s, char *d)
-{
-  /* soft line break */
-  if ((s[0] == '=') && (s[1] == '\0'))
-    return 1;
-
-  /* quoted-printable triple */
-  if ((s[0] == '=') && isxdigit((unsigned char) s[1]) && isxdigit((unsigned char) s[2]))
-  {
-    *d = (hexval(s[1]) << 4) | hexval(s[2]);
-    return 0;
-  }
-
-  /* something else */
-  return -1;
-}
-
 /**
  * qp_decode_line - Decode a line of quoted-printable text
- * @param dest Buffer for result
+ * @param dest Buffer for result, at least len + 1 bytes
  * @param src  Text to decode
- * @param l    Bytes written to buffer
+ * @param len  Length of the text
  * @param last Last character of the line
+ * @retval num Bytes written to buffer
+ *
+ * The literal text between the '=' signs is copied in one go.
  */
-static void qp_decode_line(char *dest, char *src, size_t *l, int last)
+static size_t qp_decode_line(char *dest, const char *src, size_t len, int last)
 {
-  char *d = NULL, *s = NULL;
-  char c = 0;
-
-  int kind = -1;
+  char *d = dest;
+  const char *s = src;
+  const char *end = src + len;
   bool soft = false;
+  bool cr = false;
 
-  /* decode the line */
-
-  for (d = dest, s = src; *s;)
+  while (s < end)
   {
-    switch ((kind = qp_decode_triple(s, &c)))
+    const char *eq = memchr(s, '=', end - s);
+    const size_t run = (eq ? eq : end) - s;
+    if (run > 0)
     {
-      case 0:
-        *d++ = c;
-        s += 3;
-        break; /* qp triple */
-      case -1:
-        *d++ = *s++;
-        break; /* single character */
-      case 1:
-        soft = true;
-        s++;
-        break; /* soft line break */
+      memcpy(d, s, run);
+      d += run;
+      s += run;
+      cr = false;
+    }
+    if (!eq)
+      break;
+
+    if ((end - s) == 1)
+    {
+      /* soft line break */
+      soft = true;
+      s++;
+    }
+    else if (((end - s) >= 3) && isxdigit((unsigned char) s[1]) &&
+             isxdigit((unsigned char) s[2]))
+    {
+      /* quoted-printable triple */
+      *d = (hexval(s[1]) << 4) | hexval(s[2]);
+      cr = (*d++ == '\r');
+      s += 3;
+    }
+    else
+    {
+      /* something else */
+      *d++ = *s++;
+      cr = false;
     }
   }
 
@@ -261,14 +293,13 @@ static void qp_decode_line(char *dest, char *src, size_t *l, int last)
     /* neither \r nor \n as part of line-terminating CRLF
      * may be qp-encoded, so remove \r and \n-terminate;
      * see RFC2045, sect. 6.7, (1): General 8bit representation */
-    if ((kind == 0) && (c == '\r'))
+    if (cr)
       *(d - 1) = '\n';
     else
       *d++ = '\n';
   }
 
-  *d = '\0';
-  *l = d - dest;
+  return d - dest;
 }
 
 /**
@@ -278,63 +309,93 @@ static void qp_decode_line(char *dest, char *src, size_t *l, int last)
  * @param istext Mime part is plain text
  * @param cd     Iconv conversion descriptor
  *
- * Why doesn't this overflow any buffers? First, it's guaranteed that the
- * length of a line grows when you _en_-code it to quoted-printable. That
- * means that we always can store the result in a buffer of at most the _same_
- * size.
- *
- * Now, we don't special-case if the line we read with fgets() isn't
- * terminated. We don't care about this, since 256 > 78, so corrupted input
- * will just be corrupted a bit more. That implies that 256+1 bytes are
- * always sufficient to store the result of qp_decode_line.
+ * The text is read in blocks and each complete line is decoded in place.  An
+ * incomplete line is kept until the rest of it has been read.
  *
- * Finally, at soft line breaks, some part of a multibyte character may have
- * been left over by convert_to_state(). This shouldn't be more than 6
- * characters, so 256+7 should be sufficient memory to store the decoded
- * data.
- *
- * Just to make sure that I didn't make some off-by-one error above, we just
- * use 512 for the target buffer's size.
+ * A decoded line is never longer than the encoded one, plus its newline.
+ * Before each line is decoded, the output buffer is flushed by
+ * convert_to_state() if that line might not fit.
  */
 static void decode_quoted(struct State *s, long len, bool istext, iconv_t cd)
 {
-  char line[256];
-  char decline[512];
+  char bufi[QP_BLOCK_SIZE];
+  char decline[QP_BLOCK_SIZE + 16];
+  size_t have = 0;
   size_t l = 0;
-  size_t l3;
 
   if (istext)
     state_set_prefix(s);
 
-  while (len > 0)
+  while (true)
   {
-    /* It's ok to use a fixed size buffer for input, even if the line turns
-     * out to be longer than this.  Just process the line in chunks.  This
-     * really shouldn't happen according the MIME spec, since Q-P encoded
-     * lines are at most 76 characters, but we should be liberal about what
-     * we accept.  */
-    if (!fgets(line, MIN((ssize_t) sizeof(line), len + 1), s->fp_in))
+    if ((len > 0) && (have < sizeof(bufi)))
+    {
+      const size_t n = fread(bufi + have, 1, MIN((size_t) len, sizeof(bufi) - have), s->fp_in);
+      if (n == 0)
+        len = 0;
+      len -= n;
+      have += n;
+    }
+    if (have == 0)
       break;
 
-    size_t linelen = strlen(line);
-    len -= linelen;
+    const bool more = (len > 0);
+    char *p = bufi;
+    char *const end = bufi + have;
+    while (p < end)
+    {
+      size_t linelen;
+      char *nl = memchr(p, '\n', end - p);
+      if (nl)
+      {
+        linelen = nl + 1 - p;
+      }
+      else if (more && (p != bufi))
+      {
+        /* wait for the rest of the line */
+        break;
+      }
+      else
+      {
+        /* A line longer than the buffer is processed in chunks.  This
+         * really shouldn't happen according the MIME spec, since Q-P encoded
+         * lines are at most 76 characters, but we should be liberal about
+         * what we accept.  Don't split a triple, though. */
+        linelen = end - p;
+        if (more && (linelen > 2))
+        {
+          if (p[linelen - 1] == '=')
+            linelen -= 1;
+          else if (p[linelen - 2] == '=')
+            linelen -= 2;
+        }
+      }
 
-    /* inspect the last character we read so we can tell if we got the
-     * entire line.  */
-    const int last = (linelen != 0) ? line[linelen - 1] : 0;
+      char *line = p;
+      p += linelen;
 
-    /* chop trailing whitespace if we got the full line */
-    if (last == '\n')
-    {
-      while ((linelen > 0) && IS_SPACE(line[linelen - 1]))
-        linelen--;
-      line[linelen] = '\0';
-    }
+      /* inspect the last character we read so we can tell if we got the
+       * entire line.  */
+      const int last = line[linelen - 1];
 
-    /* decode and do character set conversion */
-    qp_decode_line(decline + l, line, &l3, last);
-    l += l3;
+      /* chop trailing whitespace if we got the full line */
+      if (last == '\n')
+      {
+        while ((linelen > 0) && IS_SPACE(line[linelen - 1]))
+          linelen--;
+      }
+
+      /* decode and do character set conversion */
+      if ((l + linelen + 1) > sizeof(decline))
+        convert_to_state(cd, decline, &l, s);
+      l += qp_decode_line(decline + l, line, linelen, last);
+    }
     convert_to_state(cd, decline, &l, s);
+
+    have = end - p;
+    memmove(bufi, p, have);
+    if (!more && (have == 0))
+      break;
   }
 
   convert_to_state(cd, 0, 0, s);
@@ -516,6 +577,202 @@ static bool is_autoview(struct Body *b)
   return false;
 }
 
+/**
+ * handler_cache_entry_free - Free a handler cache entry
+ * @param hc  Cache
+ * @param hce Cache entry
+ */
+static void handler_cache_entry_free(struct HandlerCache *hc, struct HandlerCacheEntry *hce)
+{
+  TAILQ_REMOVE(&hc->entries, hce, entries);
+  mutt_hash_delete(hc->hash, hce->key, hce);
+  hc->bytes -= hce->len;
+  FREE(&hce->data);
+  FREE(&hce);
+}
+
+/**
+ * handler_cache_clear - Forget all the output in a handler cache
+ * @param hc Cache
+ */
+static void handler_cache_clear(struct HandlerCache *hc)
+{
+  struct HandlerCacheEntry *hce = NULL;
+  struct HandlerCacheEntry *tmp = NULL;
+  TAILQ_FOREACH_SAFE(hce, &hc->entries, entries, tmp)
+  {
+    handler_cache_entry_free(hc, hce);
+  }
+  mutt_hash_free(&hc->hash);
+}
+
+/**
+ * handler_cache_fetch - Write out some cached output
+ * @param hc     Cache
+ * @param key    Cache key, from handler_cache_digest()
+ * @param fp_out File to write to
+ * @retval ptr  Cache entry that was written out
+ * @retval NULL The output wasn't in the cache
+ */
+static struct HandlerCacheEntry *handler_cache_fetch(struct HandlerCache *hc,
+                                                     const char *key, FILE *fp_out)
+{
+  struct HandlerCacheEntry *hce = hc->hash ? mutt_hash_find(hc->hash, key) : NULL;
+  if (!hce || (fwrite(hce->data, 1, hce->len, fp_out) != hce->len))
+    return NULL;
+
+  TAILQ_REMOVE(&hc->entries, hce, entries);
+  TAILQ_INSERT_HEAD(&hc->entries, hce, entries);
+  mutt_debug(LL_DEBUG2, "using cached output %s\n", key);
+  return hce;
+}
+
+/**
+ * handler_cache_store - Save some output in a handler cache
+ * @param hc  Cache
+ * @param key Cache key, from handler_cache_digest()
+ * @param fp  File containing the output
+ * @param len Length of the output
+ * @retval ptr  New cache entry
+ * @retval NULL The output wasn't saved
+ *
+ * The least recently used output is dropped to make room.
+ */
+static struct HandlerCacheEntry *handler_cache_store(struct HandlerCache *hc,
+                                                     const char *key, FILE *fp, size_t len)
+{
+  const long c_cache_size = cs_subset_long(NeoMutt->sub, hc->size_var);
+  if ((len == 0) || (len > (size_t) c_cache_size))
+    return NULL;
+
+  char *data = mutt_mem_malloc(len);
+  if ((fseeko(fp, 0, SEEK_SET) != 0) || (fread(data, 1, len, fp) != len))
+  {
+    FREE(&data);
+    return NULL;
+  }
+
+  while (!TAILQ_EMPTY(&hc->entries) && ((hc->bytes + len) > (size_t) c_cache_size))
+  {
+    handler_cache_entry_free(hc, TAILQ_LAST(&hc->entries, HandlerCacheList));
+  }
+
+  struct HandlerCacheEntry *hce = mutt_mem_calloc(1, sizeof(*hce));
+  mutt_str_copy(hce->key, key, sizeof(hce->key));
+  hce->data = data;
+  hce->len = len;
+  TAILQ_INSERT_HEAD(&hc->entries, hce, entries);
+  if (!hc->hash)
+    hc->hash = mutt_hash_new(128, MUTT_HASH_NO_FLAGS);
+  mutt_hash_insert(hc->hash, hce->key, hce);
+  hc->bytes += len;
+  return hce;
+}
+
+/**
+ * handler_cache_columns - Get the width of the screen that commands will see
+ * @retval ptr  "COLUMNS=..." from the environment of the commands
+ * @retval NULL It isn't set
+ */
+static const char *handler_cache_columns(void)
+{
+  for (char **env = mutt_envlist_getlist(); env && *env; env++)
+  {
+    if (mutt_str_startswith(*env, "COLUMNS="))
+      return *env;
+  }
+
+  return NULL;
+}
+
+/**
+ * handler_cache_digest - Finish a cache key with the contents of a part
+ * @param ctx MD5 context, already fed with how the part is displayed
+ * @param fp  File, positioned at the start of the part
+ * @param len Length of the part
+ * @param key Buffer for the key
+ * @retval true  Success
+ * @retval false The part can't be read
+ *
+ * The file is left where it was.
+ */
+static bool handler_cache_digest(struct Md5Ctx *ctx, FILE *fp, LOFF_T len, struct Buffer *key)
+{
+  const LOFF_T start = ftello(fp);
+  if (start < 0)
+    return false;
+
+  char buf[1024];
+  bool rc = true;
+  LOFF_T remaining = len;
+  while (remaining > 0)
+  {
+    const size_t chunk = MIN(sizeof(buf), (size_t) remaining);
+    if (fread(buf, 1, chunk, fp) != chunk)
+    {
+      rc = false;
+      break;
+    }
+    mutt_md5_process_bytes(buf, chunk, ctx);
+    remaining -= chunk;
+  }
+
+  if (fseeko(fp, start, SEEK_SET) != 0)
+    rc = false;
+  if (!rc)
+    return false;
+
+  unsigned char digest[16];
+  mutt_md5_finish_ctx(ctx, digest);
+  mutt_buffer_alloc(key, 33);
+  mutt_md5_toascii(digest, key->data);
+  mutt_buffer_fix_dptr(key);
+  return true;
+}
+
+/**
+ * mutt_autoview_cache_free - Forget the output of the autoview commands
+ */
+void mutt_autoview_cache_free(void)
+{
+  handler_cache_clear(&AutoviewCache);
+}
+
+/**
+ * autoview_cache_key - Create the cache key for an autoview command
+ * @param a       Body of the part
+ * @param s       State of the handler, positioned at the start of the part
+ * @param command Mailcap command, before it's expanded
+ * @param key     Buffer for the key
+ * @retval true  The output can be cached
+ * @retval false The cache is disabled, or the part can't be read
+ *
+ * The key covers everything the output depends on: the contents and type of
+ * the part, the command and the width of the screen it's formatting for.
+ */
+static bool autoview_cache_key(struct Body *a, struct State *s,
+                               const char *command, struct Buffer *key)
+{
+  const long c_autoview_cache_size = cs_subset_long(NeoMutt->sub, "autoview_cache_size");
+  if (c_autoview_cache_size <= 0)
+  {
+    mutt_autoview_cache_free();
+    return false;
+  }
+
+  struct Md5Ctx ctx;
+  mutt_md5_init_ctx(&ctx);
+
+  char buf[1024];
+  snprintf(buf, sizeof(buf), "%d/%s|%s|%d|%d|%s|%s|", a->type, NONULL(a->subtype),
+           NONULL(a->filename), s->flags, s->wraplen, NONULL(s->prefix),
+           NONULL(handler_cache_columns()));
+  mutt_md5_process(buf, &ctx);
+  mutt_md5_process(command, &ctx);
+
+  return handler_cache_digest(&ctx, s->fp_in, a->length, key);
+}
+
 /**
  * autoview_handler - Handler for autoviewable attachments - Implements ::handler_t
  */
@@ -526,10 +783,13 @@ static int autoview_handler(struct Body *a, struct State *s)
   char type[256];
   struct Buffer *cmd = mutt_buffer_pool_get();
   struct Buffer *tempfile = mutt_buffer_pool_get();
+  struct Buffer *key = mutt_buffer_pool_get();
   char *fname = NULL;
   FILE *fp_in = NULL;
   FILE *fp_out = NULL;
   FILE *fp_err = NULL;
+  FILE *fp_state = s->fp_out;
+  FILE *fp_cache = NULL;
   pid_t pid;
   int rc = 0;
 
@@ -555,6 +815,18 @@ static int autoview_handler(struct Body *a, struct State *s)
       mutt_message(_("Invoking autoview command: %s"), mutt_buffer_string(cmd));
     }
 
+    /* redisplaying a message shouldn't run the command again */
+    if (autoview_cache_key(a, s, entry->command, key))
+    {
+      if (handler_cache_fetch(&AutoviewCache, mutt_buffer_string(key), s->fp_out))
+      {
+        if (s->flags & MUTT_DISPLAY)
+          mutt_clear_error();
+        goto cleanup;
+      }
+      fp_cache = mutt_file_mkstemp();
+    }
+
     fp_in = mutt_file_fopen(mutt_buffer_string(tempfile), "w+");
     if (!fp_in)
     {
@@ -592,6 +864,9 @@ static int autoview_handler(struct Body *a, struct State *s)
       goto bail;
     }
 
+    if (fp_cache)
+      s->fp_out = fp_cache;
+
     if (s->prefix)
     {
       /* Remove ansi and formatting from autoview output in replies only.  The
@@ -645,7 +920,18 @@ static int autoview_handler(struct Body *a, struct State *s)
     mutt_file_fclose(&fp_out);
     mutt_file_fclose(&fp_err);
 
-    filter_wait(pid);
+    const int status = filter_wait(pid);
+    if (fp_cache && (s->fp_out == fp_cache))
+    {
+      s->fp_out = fp_state;
+      const LOFF_T len = ftello(fp_cache);
+      if ((status == 0) && (len > 0))
+        handler_cache_store(&AutoviewCache, mutt_buffer_string(key), fp_cache, len);
+
+      fseeko(fp_cache, 0, SEEK_SET);
+      if (mutt_file_copy_stream(fp_cache, s->fp_out) < 0)
+        rc = -1;
+    }
     if (piped)
       mutt_file_fclose(&fp_in);
     else
@@ -657,9 +943,11 @@ static int autoview_handler(struct Body *a, struct State *s)
 
 cleanup:
   mailcap_entry_free(&entry);
+  mutt_file_fclose(&fp_cache);
 
   mutt_buffer_pool_release(&cmd);
   mutt_buffer_pool_release(&tempfile);
+  mutt_buffer_pool_release(&key);
 
   return rc;
 }
@@ -878,6 +1166,37 @@ static int external_body_handler(struct Body *b, struct State *s)
                     chflags, NULL, 0);
     }
   }
+  else if (mutt_istr_equal(access_type, "x-mutt-remote"))
+  {
+    if (s->flags & MUTT_DISPLAY)
+    {
+      char pretty_size[10];
+      long size = strtol(NONULL(mutt_param_get(&b->parameter, "length")), NULL, 10);
+      mutt_str_pretty_size(pretty_size, sizeof(pretty_size), size);
+
+      /* L10N: If the translation of this string is a multi line string, then
+         each line should start with "[-- " and end with " --]".
+         The "%s/%s" is a MIME type, e.g. "text/plain".  The last %s is the
+         prettified size, e.g. 2K.  The attachment will be downloaded if the
+         user views or saves it. */
+      snprintf(strbuf, sizeof(strbuf),
+               _("[-- This %s/%s attachment (size %s) hasn't been downloaded --]\n"),
+               TYPE(b->parts), b->parts->subtype, pretty_size);
+      state_attach_puts(s, strbuf);
+      if (b->parts->filename)
+      {
+        state_mark_attach(s);
+        state_printf(s, _("[-- name: %s --]\n"), b->parts->filename);
+      }
+
+      CopyHeaderFlags chflags = CH_DECODE;
+      if (c_weed)
+        chflags |= CH_WEED | CH_REORDER;
+
+      mutt_copy_hdr(s->fp_in, s->fp_out, ftello(s->fp_in), b->parts->offset,
+                    chflags, NULL, 0);
+    }
+  }
   else if (expiration && (expire < mutt_date_epoch()))
   {
     if (s->flags & MUTT_DISPLAY)
@@ -1499,94 +1818,264 @@ static int malformed_pgp_encrypted_handler(struct Body *b, struct State *s)
  */
 void mutt_decode_base64(struct State *s, size_t len, bool istext, iconv_t cd)
 {
-  char buf[5];
-  int ch, i;
+  struct B64Stream bs = { 0 };
+  char bufe[BUFI_SIZE];
+  char bufd[(BUFI_SIZE / 4 * 3) + 3];
   bool cr = false;
   char bufi[BUFI_SIZE];
   size_t l = 0;
 
-  buf[4] = '\0';
-
   if (istext)
     state_set_prefix(s);
 
-  while (len > 0)
+  while ((len > 0) && !bs.done)
   {
-    for (i = 0; (i < 4) && (len > 0); len--)
-    {
-      ch = fgetc(s->fp_in);
-      if (ch == EOF)
-        break;
-      if ((ch >= 0) && (ch < 128) && ((base64val(ch) != -1) || (ch == '=')))
-        buf[i++] = ch;
-    }
-    if (i != 4)
-    {
-      /* "i" may be zero if there is trailing whitespace, which is not an error */
-      if (i != 0)
-        mutt_debug(LL_DEBUG2, "didn't get a multiple of 4 chars\n");
+    const size_t n = fread(bufe, 1, MIN(len, sizeof(bufe)), s->fp_in);
+    if (n == 0)
       break;
+    len -= n;
+
+    const size_t nd = mutt_b64_decode_stream(&bs, bufe, n, bufd);
+    for (size_t i = 0; i < nd; i++)
+    {
+      const char ch = bufd[i];
+
+      if (cr && (ch != '\n'))
+        bufi[l++] = '\r';
+
+      cr = false;
+
+      if (istext && (ch == '\r'))
+        cr = true;
+      else
+        bufi[l++] = ch;
+
+      if ((l + 8) >= sizeof(bufi))
+        convert_to_state(cd, bufi, &l, s);
     }
+  }
 
-    const int c1 = base64val(buf[0]);
-    const int c2 = base64val(buf[1]);
+  /* "bs.num" may be non-zero if the text was truncated */
+  if (bs.num != 0)
+    mutt_debug(LL_DEBUG2, "didn't get a multiple of 4 chars\n");
 
-    /* first char */
-    ch = (c1 << 2) | (c2 >> 4);
+  if (cr)
+    bufi[l++] = '\r';
 
-    if (cr && (ch != '\n'))
-      bufi[l++] = '\r';
+  convert_to_state(cd, bufi, &l, s);
+  convert_to_state(cd, 0, 0, s);
 
-    cr = false;
+  state_reset_prefix(s);
+}
 
-    if (istext && (ch == '\r'))
-      cr = true;
-    else
-      bufi[l++] = ch;
+/**
+ * run_cached_handler - Run an encrypted handler, using the cache if possible
+ * @param b         Body of the email
+ * @param s         State to work with
+ * @param handler   Callback function to process the content - Implements ::handler_t
+ * @param plaintext Is the content in plain text
+ * @retval 0 Success
+ * @retval -1 Error
+ *
+ * See $crypt_cache_size.
+ */
+static int run_cached_handler(struct Body *b, struct State *s, handler_t handler, bool plaintext)
+{
+  struct Buffer *key = mutt_buffer_pool_get();
+  int rc = 0;
 
-    /* second char */
-    if (buf[2] == '=')
-      break;
-    const int c3 = base64val(buf[2]);
-    ch = ((c2 & 0xf) << 4) | (c3 >> 2);
+  if (!crypt_cache_key(b, s, key))
+  {
+    rc = run_decode_and_handler(b, s, handler, plaintext);
+    goto done;
+  }
 
-    if (cr && (ch != '\n'))
-      bufi[l++] = '\r';
+  if (crypt_cache_fetch(mutt_buffer_string(key), b, s))
+    goto done;
 
-    cr = false;
+  FILE *fp_out = s->fp_out;
+  FILE *fp_tmp = mutt_file_mkstemp();
+  if (!fp_tmp)
+  {
+    rc = run_decode_and_handler(b, s, handler, plaintext);
+    goto done;
+  }
 
-    if (istext && (ch == '\r'))
-      cr = true;
-    else
-      bufi[l++] = ch;
+  s->fp_out = fp_tmp;
+  rc = run_decode_and_handler(b, s, handler, plaintext);
+  s->fp_out = fp_out;
 
-    /* third char */
-    if (buf[3] == '=')
-      break;
-    const int c4 = base64val(buf[3]);
-    ch = ((c3 & 0x3) << 6) | c4;
+  const LOFF_T len = ftello(fp_tmp);
+  if ((rc == 0) && (len > 0))
+    crypt_cache_store(mutt_buffer_string(key), b, fp_tmp, len);
 
-    if (cr && (ch != '\n'))
-      bufi[l++] = '\r';
+  fseeko(fp_tmp, 0, SEEK_SET);
+  if (mutt_file_copy_stream(fp_tmp, s->fp_out) < 0)
+    rc = -1;
+  mutt_file_fclose(&fp_tmp);
 
-    cr = false;
+done:
+  mutt_buffer_pool_release(&key);
+  return rc;
+}
 
-    if (istext && (ch == '\r'))
-      cr = true;
-    else
-      bufi[l++] = ch;
+/**
+ * mutt_decode_cache_free - Forget the decoded messages and attachments
+ */
+void mutt_decode_cache_free(void)
+{
+  handler_cache_clear(&DecodeCache);
+  mutt_file_fclose(&DecodeCacheFile);
+}
 
-    if ((l + 8) >= sizeof(bufi))
-      convert_to_state(cd, bufi, &l, s);
+/**
+ * mutt_decode_cache_observer - Forget the decoded output when the config changes - Implements ::observer_t
+ *
+ * The output depends on many config variables and commands, e.g. `auto_view`.
+ * Only the ones that just change the order of the Emails are ignored.
+ */
+int mutt_decode_cache_observer(struct NotifyCallback *nc)
+{
+  if (TAILQ_EMPTY(&DecodeCache.entries))
+    return 0;
+
+  if (nc->event_type == NT_CONFIG)
+  {
+    struct EventConfig *ec = nc->event_data;
+    if (!ec || !ec->he)
+      return -1;
+
+    const struct ConfigDef *cdef = ec->he->data;
+    if (cdef->type & (R_RESORT | R_RESORT_SUB | R_RESORT_INIT))
+      return 0;
+  }
+  else if (nc->event_type != NT_COMMAND)
+  {
+    return 0;
   }
 
-  if (cr)
-    bufi[l++] = '\r';
+  handler_cache_clear(&DecodeCache);
+  return 0;
+}
 
-  convert_to_state(cd, bufi, &l, s);
-  convert_to_state(cd, 0, 0, s);
+/**
+ * decode_cache_key - Create the cache key for a decoded message or attachment
+ * @param b   Body of the part
+ * @param s   State of the handler
+ * @param key Buffer for the key
+ * @retval true  The output can be cached
+ * @retval false The cache is disabled, or the part can't be cached
+ *
+ * Encrypted and signed parts aren't cached, so that they're decrypted and
+ * verified every time.
+ */
+static bool decode_cache_key(struct Body *b, struct State *s, struct Buffer *key)
+{
+  const long c_decode_cache_size = cs_subset_long(NeoMutt->sub, "decode_cache_size");
+  if (c_decode_cache_size <= 0)
+  {
+    if (!TAILQ_EMPTY(&DecodeCache.entries) || DecodeCacheFile)
+      mutt_decode_cache_free();
+    return false;
+  }
 
-  state_reset_prefix(s);
+  if (!s->fp_in || !s->fp_out || (b->length <= 0) || (b->length > c_decode_cache_size))
+    return false;
+
+  if ((WithCrypto != 0) && (crypt_query(b) != SEC_NO_FLAGS))
+    return false;
+
+  const LOFF_T pos = ftello(s->fp_in);
+  if ((pos < 0) || (fseeko(s->fp_in, b->offset, SEEK_SET) != 0))
+    return false;
+
+  struct Md5Ctx ctx;
+  mutt_md5_init_ctx(&ctx);
+
+  char buf[1024];
+  snprintf(buf, sizeof(buf), "%d/%s|%d|%d|%s|%d|%d|%s|%d|%d|%s|", b->type,
+           NONULL(b->subtype), b->encoding, b->disposition, NONULL(b->filename),
+           s->flags, s->wraplen, NONULL(s->prefix), OptViewAttach,
+           OptDontHandlePgpKeys, NONULL(handler_cache_columns()));
+  mutt_md5_process(buf, &ctx);
+
+  struct Parameter *np = NULL;
+  TAILQ_FOREACH(np, &b->parameter, entries)
+  {
+    snprintf(buf, sizeof(buf), "%s=%s|", NONULL(np->attribute), NONULL(np->value));
+    mutt_md5_process(buf, &ctx);
+  }
+
+  const bool rc = handler_cache_digest(&ctx, s->fp_in, b->length, key);
+  if (fseeko(s->fp_in, pos, SEEK_SET) != 0)
+    return false;
+  return rc;
+}
+
+/**
+ * decode_cache_handler - Decode a message or attachment, using the cache
+ * @param[in]  b  Body of the part
+ * @param[in]  s  State of the handler
+ * @param[out] rc Result of the handler
+ * @retval true  The part was decoded
+ * @retval false The part can't be cached, it should be decoded as usual
+ *
+ * The first caller to decode a part, e.g. the pager, saves the output, so that
+ * the next one, e.g. a search, can reuse it.  They must ask for the same flags,
+ * prefix and wrapping.
+ */
+static bool decode_cache_handler(struct Body *b, struct State *s, int *rc)
+{
+  struct Buffer *key = mutt_buffer_pool_get();
+  bool handled = false;
+
+  if (!decode_cache_key(b, s, key))
+    goto done;
+
+  struct HandlerCacheEntry *hce =
+      handler_cache_fetch(&DecodeCache, mutt_buffer_string(key), s->fp_out);
+  if (hce)
+  {
+    s->flags |= hce->flags;
+    *rc = 0;
+    handled = true;
+    goto done;
+  }
+
+  if (!DecodeCacheFile)
+    DecodeCacheFile = mutt_file_mkstemp();
+  if (!DecodeCacheFile || (fseeko(DecodeCacheFile, 0, SEEK_SET) != 0) ||
+      (ftruncate(fileno(DecodeCacheFile), 0) != 0))
+  {
+    goto done;
+  }
+
+  FILE *fp_out = s->fp_out;
+  s->fp_out = DecodeCacheFile;
+  *rc = mutt_body_handler(b, s);
+  s->fp_out = fp_out;
+
+  const LOFF_T len = ftello(DecodeCacheFile);
+  hce = NULL;
+  if ((*rc == 0) && (len > 0))
+    hce = handler_cache_store(&DecodeCache, mutt_buffer_string(key), DecodeCacheFile, len);
+
+  if (hce)
+  {
+    hce->flags = s->flags & MUTT_FIRSTDONE;
+    if (fwrite(hce->data, 1, hce->len, fp_out) != hce->len)
+      *rc = -1;
+  }
+  else if ((fseeko(DecodeCacheFile, 0, SEEK_SET) != 0) ||
+           (mutt_file_copy_bytes(DecodeCacheFile, fp_out, MAX(len, 0)) < 0))
+  {
+    *rc = -1;
+  }
+  handled = true;
+
+done:
+  mutt_buffer_pool_release(&key);
+  return handled;
 }
 
 /**
@@ -1606,6 +2095,17 @@ int mutt_body_handler(struct Body *b, struct State *s)
   handler_t encrypted_handler = NULL;
   int rc = 0;
   static unsigned short recurse_level = 0;
+  static bool decoding = false;
+
+  /* A whole message or attachment may already have been decoded */
+  if ((recurse_level == 0) && !decoding)
+  {
+    decoding = true;
+    const bool cached = decode_cache_handler(b, s, &rc);
+    decoding = false;
+    if (cached)
+      return rc;
+  }
 
   int oflags = s->flags;
 
@@ -1736,7 +2236,10 @@ int mutt_body_handler(struct Body *b, struct State *s)
       goto cleanup;
     }
 
-    rc = run_decode_and_handler(b, s, handler, plaintext);
+    if (encrypted_handler)
+      rc = run_cached_handler(b, s, handler, plaintext);
+    else
+      rc = run_decode_and_handler(b, s, handler, plaintext);
   }
   /* print hint to use attachment menu for disposition == attachment
    * if we're not already being called from there */
@@ -1902,7 +2405,4 @@ void mutt_decode_attachment(struct Body *b, struct State *s)
                   cd);
       break;
   }
-
-  if (cd != (iconv_t)(-1))
-    iconv_close(cd);
 }
@@ -28,11 +28,15 @@
 #include <stdbool.h>
 
 struct Body;
+struct NotifyCallback;
 struct State;
 
+void mutt_autoview_cache_free(void);
 int  mutt_body_handler(struct Body *b, struct State *s);
 bool mutt_can_decode(struct Body *a);
 void mutt_decode_attachment(struct Body *b, struct State *s);
 void mutt_decode_base64(struct State *s, size_t len, bool istext, iconv_t cd);
+void mutt_decode_cache_free(void);
+int  mutt_decode_cache_observer(struct NotifyCallback *nc);
 
 #endif /* MUTT_HANDLER_H */
@@ -125,7 +125,16 @@ static struct ConfigDef HcacheVars[] = {
   { "header_cache_compress_level", DT_NUMBER|DT_NOT_NEGATIVE, 1, 0, compress_level_validator,
     "(hcache) Level of compression for method"
   },
+  { "header_cache_compress_dictionary", DT_BOOL, false, 0, NULL,
+    "(hcache) Train a compression dictionary for the header cache"
+  },
 #endif
+  { "header_cache_per_account", DT_BOOL, false, 0, NULL,
+    "(hcache) Keep the header caches of an account in one database"
+  },
+  { "header_cache_threads", DT_BOOL, false, 0, NULL,
+    "(hcache) Save the threads of local mailboxes in the header cache"
+  },
 #if defined(HAVE_QDBM) || defined(HAVE_TC) || defined(HAVE_KC)
   { "header_cache_compress", DT_DEPRECATED|DT_BOOL, false, 0, NULL, NULL },
 #endif
@@ -47,6 +47,7 @@
 #include "config/lib.h"
 #include "email/lib.h"
 #include "core/lib.h"
+#include "debug/lib.h"
 #include "lib.h"
 #include "compress/lib.h"
 #include "store/lib.h"
@@ -62,6 +63,31 @@
 
 static unsigned int hcachever = 0x0;
 
+/**
+ * enum HcacheRestore - How much of a cached Email to decode
+ */
+enum HcacheRestore
+{
+  HC_RESTORE_FLAGS, ///< Only the Email's flags, dates and counters
+  HC_RESTORE_INDEX, ///< The Body and the Envelope fields the index needs
+  HC_RESTORE_FULL,  ///< The whole Email
+};
+
+#ifdef USE_HCACHE_COMPRESSION
+#define HC_DICT_MIN_SAMPLES 100           ///< Fewest records worth training a dictionary from
+#define HC_DICT_MAX_SAMPLES 1000          ///< Train a dictionary after this many records
+#define HC_DICT_MAX_BYTES   (1024 * 1024) ///< Train a dictionary after this much data
+
+/**
+ * struct HcacheDictSamples - Records collected to train a compression dictionary
+ */
+struct HcacheDictSamples
+{
+  struct Buffer data;                        ///< Uncompressed records, back to back
+  ARRAY_HEAD(DictSampleSizes, size_t) sizes; ///< Length of each record
+};
+#endif
+
 /**
  * header_size - Compute the size of the header with uuid validity
  * and crc.
@@ -71,6 +97,34 @@ static size_t header_size(void)
   return sizeof(int) + sizeof(uint32_t);
 }
 
+/**
+ * enum EmailFlags - Bit positions of the Email flags in the serialised record
+ *
+ * @note Never reuse or reorder these.  If a flag is added or removed, bump
+ *       `BASEVERSION` in `hcache/hcachever.sh`.
+ */
+enum EmailFlags
+{
+  EF_MIME = 0,         ///< Email.mime
+  EF_FLAGGED,          ///< Email.flagged
+  EF_DELETED,          ///< Email.deleted
+  EF_PURGE,            ///< Email.purge
+  EF_QUASI_DELETED,    ///< Email.quasi_deleted
+  EF_ATTACH_DEL,       ///< Email.attach_del
+  EF_OLD,              ///< Email.old
+  EF_READ,             ///< Email.read
+  EF_EXPIRED,          ///< Email.expired
+  EF_SUPERSEDED,       ///< Email.superseded
+  EF_REPLIED,          ///< Email.replied
+  EF_SUBJECT_CHANGED,  ///< Email.subject_changed
+  EF_DISPLAY_SUBJECT,  ///< Email.display_subject
+  EF_ACTIVE,           ///< Email.active
+  EF_TRASH,            ///< Email.trash
+  EF_ZOCCIDENT,        ///< Email.zoccident
+};
+
+#define EF_BIT(flag) ((uint64_t) 1 << (flag))
+
 /**
  * dump - Serialise an Email object
  * @param hc          Header cache handle
@@ -81,10 +135,16 @@ static size_t header_size(void)
  *
  * This function transforms an Email into a binary string so that it can be
  * saved to a database.
+ *
+ * Only the fields that describe the message itself are stored, each one
+ * explicitly encoded.  View state, e.g. tagged, collapsed, threading and
+ * colour, and all the pointers are left out.
+ *
+ * The Envelope fields that the index doesn't need are stored last, after
+ * their length, so that restore() can keep them without decoding them.
  */
 static void *dump(struct HeaderCache *hc, const struct Email *e, int *off, uint32_t uidvalidity)
 {
-  struct Email e_dump;
   bool convert = !CharsetIsUtf8;
 
   *off = 0;
@@ -95,55 +155,82 @@ static void *dump(struct HeaderCache *hc, const struct Email *e, int *off, uint3
 
   assert((size_t) *off == header_size());
 
-  lazy_realloc(&d, *off + sizeof(struct Email));
-  memcpy(&e_dump, e, sizeof(struct Email));
-
-  /* some fields are not safe to cache */
-  e_dump.tagged = false;
-  e_dump.changed = false;
-  e_dump.threaded = false;
-  e_dump.recip_valid = false;
-  e_dump.searched = false;
-  e_dump.matched = false;
-  e_dump.collapsed = false;
-  e_dump.visible = true;
-  e_dump.num_hidden = 0;
-  e_dump.recipient = 0;
-  e_dump.pair = 0;
-  e_dump.attach_valid = false;
-  e_dump.path = NULL;
-  e_dump.tree = NULL;
-  e_dump.thread = NULL;
-  e_dump.sequence = 0;
-  STAILQ_INIT(&e_dump.tags);
-#ifdef MIXMASTER
-  STAILQ_INIT(&e_dump.chain);
-#endif
-  e_dump.edata = NULL;
-
-  memcpy(d + *off, &e_dump, sizeof(struct Email));
-  *off += sizeof(struct Email);
-
-  d = serial_dump_envelope(e_dump.env, d, off, convert);
-  d = serial_dump_body(e_dump.body, d, off, convert);
+  uint64_t flags = (e->mime ? EF_BIT(EF_MIME) : 0) |
+                   (e->flagged ? EF_BIT(EF_FLAGGED) : 0) |
+                   (e->deleted ? EF_BIT(EF_DELETED) : 0) |
+                   (e->purge ? EF_BIT(EF_PURGE) : 0) |
+                   (e->quasi_deleted ? EF_BIT(EF_QUASI_DELETED) : 0) |
+                   (e->attach_del ? EF_BIT(EF_ATTACH_DEL) : 0) |
+                   (e->old ? EF_BIT(EF_OLD) : 0) |
+                   (e->read ? EF_BIT(EF_READ) : 0) |
+                   (e->expired ? EF_BIT(EF_EXPIRED) : 0) |
+                   (e->superseded ? EF_BIT(EF_SUPERSEDED) : 0) |
+                   (e->replied ? EF_BIT(EF_REPLIED) : 0) |
+                   (e->subject_changed ? EF_BIT(EF_SUBJECT_CHANGED) : 0) |
+                   (e->display_subject ? EF_BIT(EF_DISPLAY_SUBJECT) : 0) |
+                   (e->active ? EF_BIT(EF_ACTIVE) : 0) |
+                   (e->trash ? EF_BIT(EF_TRASH) : 0) |
+                   (e->zoccident ? EF_BIT(EF_ZOCCIDENT) : 0);
+
+  d = serial_dump_varint(flags, d, off);
+  d = serial_dump_varint(e->security, d, off);
+  d = serial_dump_varint(e->zhours, d, off);
+  d = serial_dump_varint(e->zminutes, d, off);
+  d = serial_dump_svarint(e->date_sent, d, off);
+  d = serial_dump_svarint(e->received, d, off);
+  d = serial_dump_svarint(e->offset, d, off);
+  d = serial_dump_svarint(e->lines, d, off);
+  d = serial_dump_svarint(e->index, d, off);
+
+  /* An attachment count is only useful with the rules it was counted with */
+  d = serial_dump_uint32_t(e->attach_valid ? e->attach_rules : 0, d, off);
+  d = serial_dump_varint(e->attach_valid ? e->attach_total : 0, d, off);
+
+  d = serial_dump_envelope_index(e->env, d, off, convert);
+  d = serial_dump_body(e->body, d, off, convert);
   d = serial_dump_tags(&e->tags, d, off);
 
+  const int rest_off = *off;
+  d = serial_dump_uint32_t(0, d, off);
+  d = serial_dump_envelope_rest(e->env, d, off, convert);
+  const uint32_t rest_len = *off - rest_off - sizeof(uint32_t);
+  memcpy(d + rest_off, &rest_len, sizeof(uint32_t));
+
   return d;
 }
 
+/**
+ * restore_env_rest - Decode the rest of a cached Envelope - Implements Email::env_load()
+ */
+static void restore_env_rest(struct Email *e)
+{
+  int off = 0;
+  serial_restore_envelope_rest(e->env, e->env_rest, &off, !CharsetIsUtf8);
+}
+
 /**
  * restore - Restore an Email from data retrieved from the cache
- * @param d Data retrieved using mutt_hcache_dump
+ * @param d   Data retrieved using mutt_hcache_dump
+ * @param how How much of the Email to decode, e.g. #HC_RESTORE_INDEX
  * @retval ptr Success, the restored header (can't be NULL)
  *
+ * The Email's own fields are stored ahead of the Envelope and Body, so a stub
+ * (#HC_RESTORE_FLAGS) can stop decoding early.  A stub has no Envelope and no
+ * Body.
+ *
+ * With #HC_RESTORE_INDEX, the Envelope fields that the index doesn't need are
+ * copied, still encoded, into Email::env_rest.  email_env_load() decodes them.
+ *
  * @note The returned Email must be free'd by caller code with
  *       email_free()
  */
-static struct Email *restore(const unsigned char *d)
+static struct Email *restore(const unsigned char *d, enum HcacheRestore how)
 {
   int off = 0;
   struct Email *e = email_new();
   bool convert = !CharsetIsUtf8;
+  uint64_t u = 0;
+  int64_t s = 0;
 
   /* skip validate */
   off += sizeof(uint32_t);
@@ -151,23 +238,68 @@ static struct Email *restore(const unsigned char *d)
   /* skip crc */
   off += sizeof(unsigned int);
 
-  size_t sequence = e->sequence;
-  memcpy(e, d + off, sizeof(struct Email));
-  off += sizeof(struct Email);
-  e->sequence = sequence;
-
-  STAILQ_INIT(&e->tags);
-#ifdef MIXMASTER
-  STAILQ_INIT(&e->chain);
-#endif
+  serial_restore_varint(&u, d, &off);
+  e->mime = u & EF_BIT(EF_MIME);
+  e->flagged = u & EF_BIT(EF_FLAGGED);
+  e->deleted = u & EF_BIT(EF_DELETED);
+  e->purge = u & EF_BIT(EF_PURGE);
+  e->quasi_deleted = u & EF_BIT(EF_QUASI_DELETED);
+  e->attach_del = u & EF_BIT(EF_ATTACH_DEL);
+  e->old = u & EF_BIT(EF_OLD);
+  e->read = u & EF_BIT(EF_READ);
+  e->expired = u & EF_BIT(EF_EXPIRED);
+  e->superseded = u & EF_BIT(EF_SUPERSEDED);
+  e->replied = u & EF_BIT(EF_REPLIED);
+  e->subject_changed = u & EF_BIT(EF_SUBJECT_CHANGED);
+  e->display_subject = u & EF_BIT(EF_DISPLAY_SUBJECT);
+  e->active = u & EF_BIT(EF_ACTIVE);
+  e->trash = u & EF_BIT(EF_TRASH);
+  e->zoccident = u & EF_BIT(EF_ZOCCIDENT);
+
+  serial_restore_varint(&u, d, &off);
+  e->security = u;
+  serial_restore_varint(&u, d, &off);
+  e->zhours = u;
+  serial_restore_varint(&u, d, &off);
+  e->zminutes = u;
+  serial_restore_svarint(&s, d, &off);
+  e->date_sent = s;
+  serial_restore_svarint(&s, d, &off);
+  e->received = s;
+  serial_restore_svarint(&s, d, &off);
+  e->offset = s;
+  serial_restore_svarint(&s, d, &off);
+  e->lines = s;
+  serial_restore_svarint(&s, d, &off);
+  e->index = s;
+
+  serial_restore_uint32_t(&e->attach_rules, d, &off);
+  serial_restore_varint(&u, d, &off);
+  e->attach_total = u;
+
+  if (how == HC_RESTORE_FLAGS)
+    return e;
 
   e->env = mutt_env_new();
-  serial_restore_envelope(e->env, d, &off, convert);
+  serial_restore_envelope_index(e->env, d, &off, convert);
 
   e->body = mutt_body_new();
   serial_restore_body(e->body, d, &off, convert);
   serial_restore_tags(&e->tags, d, &off);
 
+  uint32_t rest_len = 0;
+  serial_restore_uint32_t(&rest_len, d, &off);
+  if (how == HC_RESTORE_INDEX)
+  {
+    e->env_rest = mutt_mem_malloc(rest_len);
+    memcpy(e->env_rest, d + off, rest_len);
+    e->env_load = restore_env_rest;
+  }
+  else
+  {
+    serial_restore_envelope_rest(e->env, d, &off, convert);
+  }
+
   return e;
 }
 
@@ -307,6 +439,69 @@ static void hcache_per_folder(struct Buffer *hcpath, const char *path,
   mutt_buffer_pool_release(&hcfile);
 }
 
+/**
+ * hcache_per_account - Generate the pathname of an account's shared hcache
+ * @param hcpath Buffer for the database filename
+ * @param dbname Buffer for the name of the folder's database within it
+ * @param path   Base directory, from $header_cache
+ * @param folder Mailbox name (including protocol)
+ * @retval true  Success
+ * @retval false @a folder isn't part of an account, or @a path isn't a directory
+ *
+ * The folders of an account, e.g. `imaps://user@example.com/INBOX`, share one
+ * database file, named after the account: BASE/MD5.  Each folder has its own
+ * database inside the file, named after the folder.
+ */
+static bool hcache_per_account(struct Buffer *hcpath, struct Buffer *dbname,
+                               const char *path, const char *folder)
+{
+  enum UrlScheme scheme = url_check_scheme(folder);
+  if ((scheme == U_UNKNOWN) || (scheme == U_FILE))
+    return false;
+
+  struct stat sb;
+  int plen = mutt_str_len(path);
+  bool slash = (path[plen - 1] == '/');
+  int rc = stat(path, &sb);
+  if (((rc == 0) && !S_ISDIR(sb.st_mode)) || ((rc == -1) && !slash))
+    return false;
+
+  /* The account is everything before the path, e.g. `imaps://user@host` */
+  const char *account = strchr(folder, ':') + 1;
+  if (mutt_str_startswith(account, "//"))
+    account += 2;
+  const char *end = strchr(account, '/');
+  int alen = end ? end - folder : mutt_str_len(folder);
+
+  const char *const c_header_cache_backend =
+      cs_subset_string(NeoMutt->sub, "header_cache_backend");
+  const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
+
+  unsigned char m[16]; /* binary md5sum */
+  struct Buffer *name = mutt_buffer_pool_get();
+  mutt_buffer_printf(name, "%s|account|%.*s", ops->name, alen, folder);
+  mutt_md5(mutt_buffer_string(name), m);
+  mutt_buffer_reset(name);
+  mutt_md5_toascii(m, name->data);
+  mutt_buffer_printf(hcpath, "%s%s%s", path, slash ? "" : "/", mutt_buffer_string(name));
+  mutt_buffer_pool_release(&name);
+
+  mutt_encode_path(hcpath, mutt_buffer_string(hcpath));
+  create_hcache_dir(mutt_buffer_string(hcpath));
+
+#ifdef USE_HCACHE_COMPRESSION
+  const char *const c_header_cache_compress_method =
+      cs_subset_string(NeoMutt->sub, "header_cache_compress_method");
+  if (c_header_cache_compress_method)
+    mutt_buffer_printf(dbname, "%s|%s", folder, c_header_cache_compress_method);
+  else
+    mutt_buffer_strcpy(dbname, folder);
+#else
+  mutt_buffer_strcpy(dbname, folder);
+#endif
+  return true;
+}
+
 /**
  * get_foldername - Where should the cache be stored?
  * @param folder Path to be canonicalised
@@ -323,11 +518,131 @@ static char *get_foldername(const char *folder)
   return p;
 }
 
+#ifdef USE_HCACHE_COMPRESSION
+/**
+ * dict_key - Get the key of the stored compression dictionary
+ * @param cops Compression backend
+ * @param buf  Buffer for the key
+ */
+static void dict_key(const struct ComprOps *cops, struct Buffer *buf)
+{
+  mutt_buffer_printf(buf, "/DICT-%s", cops->name);
+}
+
+/**
+ * dict_samples_free - Free the collected dictionary samples
+ * @param hc Header cache handle
+ */
+static void dict_samples_free(struct HeaderCache *hc)
+{
+  if (!hc->samples)
+    return;
+
+  MEM_ACCOUNT(MEM_TAG_HCACHE, -(long) hc->samples->data.dsize, 0);
+  mutt_buffer_dealloc(&hc->samples->data);
+  ARRAY_FREE(&hc->samples->sizes);
+  FREE(&hc->samples);
+}
+
+/**
+ * dict_open - Load, or start collecting samples for, a compression dictionary
+ * @param hc   Header cache handle
+ * @param cops Compression backend
+ */
+static void dict_open(struct HeaderCache *hc, const struct ComprOps *cops)
+{
+  const bool c_header_cache_compress_dictionary =
+      cs_subset_bool(NeoMutt->sub, "header_cache_compress_dictionary");
+  if (!c_header_cache_compress_dictionary || !hc->ctx)
+    return;
+
+  struct Buffer *key = mutt_buffer_pool_get();
+  dict_key(cops, key);
+
+  size_t dlen = 0;
+  void *dict = mutt_hcache_fetch_raw(hc, mutt_buffer_string(key),
+                                     mutt_buffer_len(key), &dlen);
+  if (dict && cops->dict_load(hc->cctx, dict, dlen))
+  {
+    mutt_debug(LL_DEBUG3, "Header cache loaded a %zu byte %s dictionary\n",
+               dlen, cops->name);
+  }
+  else
+  {
+    hc->samples = mutt_mem_calloc(1, sizeof(struct HcacheDictSamples));
+  }
+
+  mutt_hcache_free_raw(hc, &dict);
+  mutt_buffer_pool_release(&key);
+}
+
+/**
+ * dict_train - Train and save a compression dictionary from the samples
+ * @param hc   Header cache handle
+ * @param cops Compression backend
+ *
+ * Whether or not training works, the samples are freed, so it's only tried
+ * once per session.
+ */
+static void dict_train(struct HeaderCache *hc, const struct ComprOps *cops)
+{
+  struct HcacheDictSamples *hs = hc->samples;
+  if (!hs)
+    return;
+
+  if (ARRAY_SIZE(&hs->sizes) >= HC_DICT_MIN_SAMPLES)
+  {
+    size_t dlen = 0;
+    void *dict = cops->dict_train(hc->cctx, hs->data.data, ARRAY_GET(&hs->sizes, 0),
+                                  ARRAY_SIZE(&hs->sizes), &dlen);
+    if (dict)
+    {
+      struct Buffer *key = mutt_buffer_pool_get();
+      dict_key(cops, key);
+      mutt_hcache_store_raw(hc, mutt_buffer_string(key), mutt_buffer_len(key), dict, dlen);
+      mutt_buffer_pool_release(&key);
+      mutt_debug(LL_DEBUG3, "Header cache trained a %zu byte %s dictionary\n",
+                 dlen, cops->name);
+    }
+  }
+
+  dict_samples_free(hc);
+}
+
+/**
+ * dict_sample - Collect a record for training a compression dictionary
+ * @param hc   Header cache handle
+ * @param cops Compression backend
+ * @param data Uncompressed record
+ * @param dlen Length of the record
+ */
+static void dict_sample(struct HeaderCache *hc, const struct ComprOps *cops,
+                        const char *data, size_t dlen)
+{
+  struct HcacheDictSamples *hs = hc->samples;
+  if (!hs)
+    return;
+
+  MEM_ACCOUNT(MEM_TAG_HCACHE, -(long) hs->data.dsize, 0);
+  mutt_buffer_addstr_n(&hs->data, data, dlen);
+  MEM_ACCOUNT(MEM_TAG_HCACHE, hs->data.dsize, 0);
+  ARRAY_ADD(&hs->sizes, dlen);
+
+  if ((ARRAY_SIZE(&hs->sizes) >= HC_DICT_MAX_SAMPLES) ||
+      (mutt_buffer_len(&hs->data) >= HC_DICT_MAX_BYTES))
+  {
+    dict_train(hc, cops);
+  }
+}
+#endif
+
 /**
  * mutt_hcache_open - Multiplexor for StoreOps::open
  */
 struct HeaderCache *mutt_hcache_open(const char *path, const char *folder, hcache_namer_t namer)
 {
+  TRACE_SCOPE("hcache", "mutt_hcache_open", folder);
+
   const char *const c_header_cache_backend =
       cs_subset_string(NeoMutt->sub, "header_cache_backend");
   const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
@@ -405,24 +720,48 @@ struct HeaderCache *mutt_hcache_open(const char *path, const char *folder, hcach
   }
 
   struct Buffer *hcpath = mutt_buffer_pool_get();
-  hcache_per_folder(hcpath, path, hc->folder, namer);
 
-  hc->ctx = ops->open(mutt_buffer_string(hcpath));
+  const bool c_header_cache_per_account =
+      cs_subset_bool(NeoMutt->sub, "header_cache_per_account");
+  if (c_header_cache_per_account && ops->open_named)
+  {
+    struct Buffer *dbname = mutt_buffer_pool_get();
+    if (hcache_per_account(hcpath, dbname, path, hc->folder))
+      hc->ctx = ops->open_named(mutt_buffer_string(hcpath), mutt_buffer_string(dbname));
+    mutt_buffer_pool_release(&dbname);
+    mutt_buffer_reset(hcpath);
+  }
+
+  /* Otherwise, or if the shared database can't be used, one per folder */
   if (!hc->ctx)
   {
-    /* remove a possibly incompatible version */
-    if (unlink(mutt_buffer_string(hcpath)) == 0)
+    hcache_per_folder(hcpath, path, hc->folder, namer);
+
+    hc->ctx = ops->open(mutt_buffer_string(hcpath));
+    if (!hc->ctx)
     {
-      hc->ctx = ops->open(mutt_buffer_string(hcpath));
-      if (!hc->ctx)
+      /* remove a possibly incompatible version */
+      if (unlink(mutt_buffer_string(hcpath)) == 0)
       {
-        FREE(&hc->folder);
-        FREE(&hc);
+        hc->ctx = ops->open(mutt_buffer_string(hcpath));
+        if (!hc->ctx)
+        {
+          FREE(&hc->folder);
+          FREE(&hc);
+        }
       }
     }
   }
 
   mutt_buffer_pool_release(&hcpath);
+
+#ifdef USE_HCACHE_COMPRESSION
+  if (hc && c_header_cache_compress_method)
+    dict_open(hc, compress_get_ops(c_header_cache_compress_method));
+#endif
+
+  if (hc)
+    MEM_ACCOUNT(MEM_TAG_HCACHE, sizeof(struct HeaderCache), 1);
   return hc;
 }
 
@@ -440,44 +779,57 @@ void mutt_hcache_close(struct HeaderCache *hc)
 #ifdef USE_HCACHE_COMPRESSION
   const char *const c_header_cache_compress_method =
       cs_subset_string(NeoMutt->sub, "header_cache_compress_method");
+  const struct ComprOps *cops = NULL;
   if (c_header_cache_compress_method)
   {
-    const struct ComprOps *cops = compress_get_ops(c_header_cache_compress_method);
-    cops->close(&hc->cctx);
+    /* A small folder may not reach the training threshold */
+    cops = compress_get_ops(c_header_cache_compress_method);
+    dict_train(hc, cops);
   }
 #endif
 
+  mutt_hcache_commit_txn(hc);
+
+#ifdef USE_HCACHE_COMPRESSION
+  if (cops)
+    cops->close(&hc->cctx);
+  dict_samples_free(hc);
+#endif
+
   ops->close(&hc->ctx);
   FREE(&hc->folder);
   FREE(&hc);
+  MEM_ACCOUNT(MEM_TAG_HCACHE, -(long) sizeof(struct HeaderCache), -1);
 }
 
 /**
- * mutt_hcache_fetch - Multiplexor for StoreOps::fetch
+ * decode_entry - Validate and restore a message's header
+ * @param hc          Header cache handle
+ * @param data        Data from the backend
+ * @param dlen        Length of the data
+ * @param uidvalidity Only restore if it matches the stored uidvalidity
+ * @param how         How much of the Email to decode, e.g. #HC_RESTORE_INDEX
+ * @retval obj HCacheEntry containing an Email, empty on failure
  */
-struct HCacheEntry mutt_hcache_fetch(struct HeaderCache *hc, const char *key,
-                                     size_t keylen, uint32_t uidvalidity)
+static struct HCacheEntry decode_entry(struct HeaderCache *hc, void *data, size_t dlen,
+                                       uint32_t uidvalidity, enum HcacheRestore how)
 {
-  struct RealKey *rk = realkey(key, keylen);
   struct HCacheEntry entry = { 0 };
 
-  size_t dlen;
-  void *data = mutt_hcache_fetch_raw(hc, rk->key, rk->len, &dlen);
-  void *to_free = data;
-  if (!data)
-  {
-    goto end;
-  }
-
   /* restore uidvalidity and crc */
   size_t hlen = header_size();
+  if (dlen < hlen)
+    return entry;
+
+  /* Without compression, the Email is parsed straight out of the backend's
+   * buffer, which for LMDB is the database's memory map, without a copy */
   int off = 0;
   serial_restore_uint32_t(&entry.uidvalidity, data, &off);
   serial_restore_int(&entry.crc, data, &off);
   assert((size_t) off == hlen);
   if (entry.crc != hc->crc || ((uidvalidity != 0) && uidvalidity != entry.uidvalidity))
   {
-    goto end;
+    return entry;
   }
 
 #ifdef USE_HCACHE_COMPRESSION
@@ -490,19 +842,146 @@ struct HCacheEntry mutt_hcache_fetch(struct HeaderCache *hc, const char *key,
     void *dblob = cops->decompress(hc->cctx, (char *) data + hlen, dlen - hlen);
     if (!dblob)
     {
-      goto end;
+      return entry;
     }
     data = (char *) dblob - hlen; /* restore skips uidvalidity and crc */
   }
 #endif
 
-  entry.email = restore(data);
+  entry.email = restore(data, how);
+  return entry;
+}
 
-end:
-  mutt_hcache_free_raw(hc, &to_free);
+/**
+ * fetch_entry - Fetch and validate a message's header from the cache
+ * @param hc          Header cache handle
+ * @param key         Message identification string
+ * @param keylen      Length of the string pointed to by key
+ * @param uidvalidity Only restore if it matches the stored uidvalidity
+ * @param how         How much of the Email to decode, e.g. #HC_RESTORE_INDEX
+ * @retval obj HCacheEntry containing an Email, empty on failure
+ */
+static struct HCacheEntry fetch_entry(struct HeaderCache *hc, const char *key, size_t keylen,
+                                      uint32_t uidvalidity, enum HcacheRestore how)
+{
+  PERF_SCOPE("mutt_hcache_fetch");
+  TRACE_SCOPE("hcache", "mutt_hcache_fetch", NULL);
+
+  struct RealKey *rk = realkey(key, keylen);
+  struct HCacheEntry entry = { 0 };
+
+  size_t dlen;
+  void *data = mutt_hcache_fetch_raw(hc, rk->key, rk->len, &dlen);
+  if (!data)
+  {
+    PERF_COUNT("mutt_hcache_fetch miss");
+    return entry;
+  }
+
+  entry = decode_entry(hc, data, dlen, uidvalidity, how);
+
+  mutt_hcache_free_raw(hc, &data);
   return entry;
 }
 
+/**
+ * mutt_hcache_fetch - Multiplexor for StoreOps::fetch
+ */
+struct HCacheEntry mutt_hcache_fetch(struct HeaderCache *hc, const char *key,
+                                     size_t keylen, uint32_t uidvalidity)
+{
+  return fetch_entry(hc, key, keylen, uidvalidity, HC_RESTORE_FULL);
+}
+
+/**
+ * mutt_hcache_fetch_index - Fetch the index fields of a message from the cache
+ */
+struct HCacheEntry mutt_hcache_fetch_index(struct HeaderCache *hc, const char *key,
+                                           size_t keylen, uint32_t uidvalidity)
+{
+  return fetch_entry(hc, key, keylen, uidvalidity, HC_RESTORE_INDEX);
+}
+
+/**
+ * mutt_hcache_fetch_stub - Fetch the flags of a message from the cache
+ */
+struct HCacheEntry mutt_hcache_fetch_stub(struct HeaderCache *hc, const char *key,
+                                          size_t keylen, uint32_t uidvalidity)
+{
+  return fetch_entry(hc, key, keylen, uidvalidity, HC_RESTORE_FLAGS);
+}
+
+/**
+ * mutt_hcache_fetch_many - Multiplexor for StoreOps::fetch_many
+ */
+void mutt_hcache_fetch_many(struct HeaderCache *hc, const char **keys,
+                            const size_t *keylens, size_t num,
+                            uint32_t uidvalidity, struct HCacheEntry *entries)
+{
+  PERF_SCOPE("mutt_hcache_fetch_many");
+  TRACE_SCOPE("hcache", "mutt_hcache_fetch_many", NULL);
+
+  if (!entries)
+    return;
+  memset(entries, 0, num * sizeof(*entries));
+
+  const char *const c_header_cache_backend =
+      cs_subset_string(NeoMutt->sub, "header_cache_backend");
+  const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
+
+  if (!hc || !ops || !keys || !keylens || (num == 0))
+    return;
+
+  /* Build all the real keys in one buffer */
+  struct Buffer *buf = mutt_buffer_pool_get();
+  size_t *offsets = mutt_mem_calloc(num, sizeof(size_t));
+  size_t *rklens = mutt_mem_calloc(num, sizeof(size_t));
+  for (size_t i = 0; i < num; i++)
+  {
+    struct RealKey *rk = realkey(keys[i], keylens[i]);
+    offsets[i] = mutt_buffer_len(buf);
+    mutt_buffer_addstr(buf, hc->folder);
+    mutt_buffer_addstr_n(buf, rk->key, rk->len);
+    rklens[i] = mutt_buffer_len(buf) - offsets[i];
+    mutt_buffer_addch(buf, '\0');
+  }
+
+  const char **rkeys = mutt_mem_calloc(num, sizeof(char *));
+  for (size_t i = 0; i < num; i++)
+    rkeys[i] = buf->data + offsets[i];
+
+  void **values = mutt_mem_calloc(num, sizeof(void *));
+  size_t *vlens = mutt_mem_calloc(num, sizeof(size_t));
+  if (ops->fetch_many)
+  {
+    ops->fetch_many(hc->ctx, rkeys, rklens, num, values, vlens);
+  }
+  else
+  {
+    for (size_t i = 0; i < num; i++)
+      values[i] = ops->fetch(hc->ctx, rkeys[i], rklens[i], &vlens[i]);
+  }
+
+  for (size_t i = 0; i < num; i++)
+  {
+    if (!values[i])
+    {
+      PERF_COUNT("mutt_hcache_fetch miss");
+      continue;
+    }
+
+    entries[i] = decode_entry(hc, values[i], vlens[i], uidvalidity, HC_RESTORE_INDEX);
+    ops->free(hc->ctx, &values[i]);
+  }
+
+  FREE(&values);
+  FREE(&vlens);
+  FREE(&rkeys);
+  FREE(&rklens);
+  FREE(&offsets);
+  mutt_buffer_pool_release(&buf);
+}
+
 /**
  * mutt_hcache_fetch_raw - Fetch a message's header from the cache
  * @param[in]  hc     Pointer to the struct HeaderCache structure got by mutt_hcache_open()
@@ -514,6 +993,9 @@ end:
  *
  * @note This function does not perform any check on the validity of the data found.
  * @note The returned data must be free with mutt_hcache_free_raw().
+ * @note The data may be borrowed from the backend, e.g. LMDB returns a pointer
+ *       into its read-only memory map.  It must not be modified and is only
+ *       valid until the next write to, or close of, the cache.
  */
 void *mutt_hcache_fetch_raw(struct HeaderCache *hc, const char *key,
                             size_t keylen, size_t *dlen)
@@ -525,10 +1007,10 @@ void *mutt_hcache_fetch_raw(struct HeaderCache *hc, const char *key,
   if (!hc || !ops)
     return NULL;
 
-  struct Buffer path = mutt_buffer_make(1024);
-  keylen = mutt_buffer_printf(&path, "%s%.*s", hc->folder, (int) keylen, key);
-  void *blob = ops->fetch(hc->ctx, mutt_buffer_string(&path), keylen, dlen);
-  mutt_buffer_dealloc(&path);
+  struct Buffer *path = mutt_buffer_pool_get();
+  keylen = mutt_buffer_printf(path, "%s%.*s", hc->folder, (int) keylen, key);
+  void *blob = ops->fetch(hc->ctx, mutt_buffer_string(path), keylen, dlen);
+  mutt_buffer_pool_release(&path);
   return blob;
 }
 
@@ -553,9 +1035,15 @@ void mutt_hcache_free_raw(struct HeaderCache *hc, void **data)
 int mutt_hcache_store(struct HeaderCache *hc, const char *key, size_t keylen,
                       struct Email *e, uint32_t uidvalidity)
 {
+  PERF_SCOPE("mutt_hcache_store");
+  TRACE_SCOPE("hcache", "mutt_hcache_store", NULL);
+
   if (!hc)
     return -1;
 
+  /* The Envelope may have come from the cache without being fully decoded */
+  email_env_load(e);
+
   int dlen = 0;
   char *data = dump(hc, e, &dlen, uidvalidity);
 
@@ -570,6 +1058,8 @@ int mutt_hcache_store(struct HeaderCache *hc, const char *key, size_t keylen,
 
     const struct ComprOps *cops = compress_get_ops(c_header_cache_compress_method);
 
+    dict_sample(hc, cops, data + hlen, dlen - hlen);
+
     /* data / dlen gets ptr to compressed data here */
     size_t clen = dlen;
     void *cdata = cops->compress(hc->cctx, data + hlen, dlen - hlen, &clen);
@@ -619,11 +1109,11 @@ int mutt_hcache_store_raw(struct HeaderCache *hc, const char *key,
   if (!hc || !ops)
     return -1;
 
-  struct Buffer path = mutt_buffer_make(1024);
+  struct Buffer *path = mutt_buffer_pool_get();
 
-  keylen = mutt_buffer_printf(&path, "%s%.*s", hc->folder, (int) keylen, key);
-  int rc = ops->store(hc->ctx, mutt_buffer_string(&path), keylen, data, dlen);
-  mutt_buffer_dealloc(&path);
+  keylen = mutt_buffer_printf(path, "%s%.*s", hc->folder, (int) keylen, key);
+  int rc = ops->store(hc->ctx, mutt_buffer_string(path), keylen, data, dlen);
+  mutt_buffer_pool_release(&path);
 
   return rc;
 }
@@ -640,11 +1130,52 @@ int mutt_hcache_delete_record(struct HeaderCache *hc, const char *key, size_t ke
       cs_subset_string(NeoMutt->sub, "header_cache_backend");
   const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
 
-  struct Buffer path = mutt_buffer_make(1024);
+  struct Buffer *path = mutt_buffer_pool_get();
 
-  keylen = mutt_buffer_printf(&path, "%s%s", hc->folder, key);
+  keylen = mutt_buffer_printf(path, "%s%s", hc->folder, key);
 
-  int rc = ops->delete_record(hc->ctx, mutt_buffer_string(&path), keylen);
-  mutt_buffer_dealloc(&path);
+  int rc = ops->delete_record(hc->ctx, mutt_buffer_string(path), keylen);
+  mutt_buffer_pool_release(&path);
   return rc;
 }
+
+/**
+ * mutt_hcache_begin_txn - Multiplexor for StoreOps::begin_txn
+ */
+int mutt_hcache_begin_txn(struct HeaderCache *hc)
+{
+  if (!hc)
+    return -1;
+
+  if (hc->in_txn)
+    return 0;
+
+  const char *const c_header_cache_backend =
+      cs_subset_string(NeoMutt->sub, "header_cache_backend");
+  const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
+
+  int rc = ops->begin_txn(hc->ctx);
+  if (rc == 0)
+    hc->in_txn = true;
+
+  return rc;
+}
+
+/**
+ * mutt_hcache_commit_txn - Multiplexor for StoreOps::commit_txn
+ */
+int mutt_hcache_commit_txn(struct HeaderCache *hc)
+{
+  if (!hc)
+    return -1;
+
+  if (!hc->in_txn)
+    return 0;
+
+  const char *const c_header_cache_backend =
+      cs_subset_string(NeoMutt->sub, "header_cache_backend");
+  const struct StoreOps *ops = store_get_backend_ops(c_header_cache_backend);
+
+  hc->in_txn = false;
+  return ops->commit_txn(hc->ctx);
+}
@@ -42,14 +42,17 @@
  * @sa Address Body Buffer Email Envelope ListNode Parameter
  *
  * To save the data, the Header Cache uses a set of 'dump' functions
- * (\ref hc_serial) to 'serialise' the structures.  The cache also stores a CRC
- * checksum of the C structs that were used.  When retrieving the data, the
- * Header Cache uses a set of 'restore' functions to turn the data back into
- * structs.
+ * (\ref hc_serial) to 'serialise' the structures.  Each field is encoded
+ * explicitly: integers as varints, strings by length, flags packed into bit
+ * sets.  Fields that only describe NeoMutt's view of the email (tagged,
+ * threading, colour, etc) aren't stored.  The cache also stores a CRC
+ * checksum of the format.  When retrieving the data, the Header Cache uses a
+ * set of 'restore' functions to turn the data back into structs.
  *
  * The CRC checksum is created by `hcache/hcachever.sh` during the build
- * process.  Whenever the definition of any of the structs changes, the CRC will
- * change, invalidating any existing cached data.
+ * process.  It covers the `BASEVERSION` and the definitions of the helper
+ * structs (e.g. Address, Envelope).  Changes to `struct Email` or
+ * `struct Body` don't invalidate the cache.
  *
  * @note Adding or removing a field from the set of serialised fields will
  * **not** affect the CRC.  In this case, it is vital that you bump the
@@ -67,11 +70,13 @@
 #ifndef MUTT_HCACHE_LIB_H
 #define MUTT_HCACHE_LIB_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 struct Buffer;
 struct Email;
+struct HcacheDictSamples;
 
 /**
  * struct HeaderCache - header cache structure
@@ -87,6 +92,8 @@ struct HeaderCache
   unsigned int crc;
   void *ctx;
   void *cctx;
+  bool in_txn;
+  struct HcacheDictSamples *samples;
 };
 
 /**
@@ -149,6 +156,49 @@ int mutt_hcache_store(struct HeaderCache *hc, const char *key, size_t keylen,
  */
 struct HCacheEntry mutt_hcache_fetch(struct HeaderCache *hc, const char *key, size_t keylen, uint32_t uidvalidity);
 
+/**
+ * mutt_hcache_fetch_index - fetch the fields of a message that the index needs
+ * @param hc     Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @param key    Message identification string
+ * @param keylen Length of the string pointed to by key
+ * @param uidvalidity Only restore if it matches the stored uidvalidity
+ * @retval obj HCacheEntry containing an Email, empty on failure
+ *
+ * This is a cheaper version of mutt_hcache_fetch() for opening a Mailbox.
+ * Only the Envelope fields that the index uses are decoded.  The rest, e.g.
+ * the References, are kept encoded until email_env_load() is called.
+ */
+struct HCacheEntry mutt_hcache_fetch_index(struct HeaderCache *hc, const char *key, size_t keylen, uint32_t uidvalidity);
+
+/**
+ * mutt_hcache_fetch_stub - fetch the flags of a message from the cache
+ * @param hc     Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @param key    Message identification string
+ * @param keylen Length of the string pointed to by key
+ * @param uidvalidity Only restore if it matches the stored uidvalidity
+ * @retval obj HCacheEntry containing an Email, empty on failure
+ *
+ * This is a cheaper version of mutt_hcache_fetch() for callers that only need
+ * the flags, dates and counters of an Email.  The Envelope and Body aren't
+ * decoded, so the Email's env and body are NULL.
+ */
+struct HCacheEntry mutt_hcache_fetch_stub(struct HeaderCache *hc, const char *key, size_t keylen, uint32_t uidvalidity);
+
+/**
+ * mutt_hcache_fetch_many - fetch and validate many messages' headers from the cache
+ * @param[in]  hc          Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @param[in]  keys        Message identification strings
+ * @param[in]  keylens     Lengths of the strings pointed to by keys
+ * @param[in]  num         Number of keys
+ * @param[in]  uidvalidity Only restore if it matches the stored uidvalidity
+ * @param[out] entries     Array of num HCacheEntry, one for each key
+ *
+ * This is the same as calling mutt_hcache_fetch_index() for each key, but the
+ * keys are prepared once and the backend may look them up in a single pass.
+ */
+void mutt_hcache_fetch_many(struct HeaderCache *hc, const char **keys, const size_t *keylens,
+                            size_t num, uint32_t uidvalidity, struct HCacheEntry *entries);
+
 int mutt_hcache_store_raw(struct HeaderCache *hc, const char *key, size_t keylen,
                           void *data, size_t dlen);
 
@@ -171,4 +221,25 @@ void mutt_hcache_free_raw(struct HeaderCache *hc, void **data);
  */
 int mutt_hcache_delete_record(struct HeaderCache *hc, const char *key, size_t keylen);
 
+/**
+ * mutt_hcache_begin_txn - start a batch of writes
+ * @param hc Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ *
+ * Group the following stores and deletes into as few backend transactions as
+ * possible.  The batch ends with mutt_hcache_commit_txn(), or when the cache is
+ * closed.  Batches don't nest; starting one while another is running is a
+ * no-op.
+ */
+int mutt_hcache_begin_txn(struct HeaderCache *hc);
+
+/**
+ * mutt_hcache_commit_txn - finish a batch of writes
+ * @param hc Pointer to the struct HeaderCache structure got by mutt_hcache_open()
+ * @retval 0   Success
+ * @retval num Generic or backend-specific error code otherwise
+ */
+int mutt_hcache_commit_txn(struct HeaderCache *hc);
+
 #endif /* MUTT_HCACHE_LIB_H */
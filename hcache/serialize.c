@@ -113,14 +113,94 @@ void serial_restore_uint32_t(uint32_t *s, const unsigned char *d, int *off)
   (*off) += sizeof(uint32_t);
 }
 
+/**
+ * serial_dump_varint - Pack an unsigned integer into a binary blob
+ * @param v   Integer to save
+ * @param d   Binary blob to add to
+ * @param off Offset into the blob
+ * @retval ptr End of the newly packed binary
+ *
+ * The integer is stored as a variable-length quantity: seven bits per byte,
+ * least significant group first, with the top bit set on all but the last
+ * byte.  Small values, which are the common case, take a single byte.
+ */
+unsigned char *serial_dump_varint(uint64_t v, unsigned char *d, int *off)
+{
+  lazy_realloc(&d, *off + 10);
+
+  while (v >= 0x80)
+  {
+    d[(*off)++] = (unsigned char) (v | 0x80);
+    v >>= 7;
+  }
+  d[(*off)++] = (unsigned char) v;
+
+  return d;
+}
+
+/**
+ * serial_dump_svarint - Pack a signed integer into a binary blob
+ * @param v   Integer to save
+ * @param d   Binary blob to add to
+ * @param off Offset into the blob
+ * @retval ptr End of the newly packed binary
+ *
+ * The integer is zig-zag encoded, so that small negative numbers are also
+ * stored compactly, see serial_dump_varint().
+ */
+unsigned char *serial_dump_svarint(int64_t v, unsigned char *d, int *off)
+{
+  uint64_t zz = ((uint64_t) v << 1) ^ (uint64_t) (v >> 63);
+  return serial_dump_varint(zz, d, off);
+}
+
+/**
+ * serial_restore_varint - Unpack an unsigned integer from a binary blob
+ * @param v   Integer to write to
+ * @param d   Binary blob to read from
+ * @param off Offset into the blob
+ */
+void serial_restore_varint(uint64_t *v, const unsigned char *d, int *off)
+{
+  uint64_t result = 0;
+  int shift = 0;
+  unsigned char c;
+
+  do
+  {
+    c = d[(*off)++];
+    if (shift < 64)
+      result |= (uint64_t) (c & 0x7f) << shift;
+    shift += 7;
+  } while (c & 0x80);
+
+  *v = result;
+}
+
+/**
+ * serial_restore_svarint - Unpack a signed integer from a binary blob
+ * @param v   Integer to write to
+ * @param d   Binary blob to read from
+ * @param off Offset into the blob
+ */
+void serial_restore_svarint(int64_t *v, const unsigned char *d, int *off)
+{
+  uint64_t zz = 0;
+  serial_restore_varint(&zz, d, off);
+  *v = (int64_t) (zz >> 1) ^ -(int64_t) (zz & 1);
+}
+
 /**
  * serial_dump_char_size - Pack a fixed-length string into a binary blob
  * @param c       String to pack
  * @param d       Binary blob to add to
- * @param size    Size of the string
+ * @param size    Length of the string, excluding the NUL terminator
  * @param off     Offset into the blob
  * @param convert If true, the strings will be converted to utf-8
  * @retval ptr End of the newly packed binary
+ *
+ * The string is stored as a varint of (length + 1) followed by the bytes,
+ * without a terminator.  A NULL string is stored as a single 0 byte.
  */
 unsigned char *serial_dump_char_size(char *c, ssize_t size, unsigned char *d,
                                      int *off, bool convert)
@@ -129,8 +209,7 @@ unsigned char *serial_dump_char_size(char *c, ssize_t size, unsigned char *d,
 
   if (!c)
   {
-    size = 0;
-    d = serial_dump_int(size, d, off);
+    d = serial_dump_varint(0, d, off);
     return d;
   }
 
@@ -140,11 +219,11 @@ unsigned char *serial_dump_char_size(char *c, ssize_t size, unsigned char *d,
     const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
     if (mutt_ch_convert_string(&p, c_charset, "utf-8", MUTT_ICONV_NO_FLAGS) == 0)
     {
-      size = mutt_str_len(p) + 1;
+      size = mutt_str_len(p);
     }
   }
 
-  d = serial_dump_int(size, d, off);
+  d = serial_dump_varint(size + 1, d, off);
   lazy_realloc(&d, *off + size);
   memcpy(d + *off, p, size);
   *off += size;
@@ -165,7 +244,7 @@ unsigned char *serial_dump_char_size(char *c, ssize_t size, unsigned char *d,
  */
 unsigned char *serial_dump_char(char *c, unsigned char *d, int *off, bool convert)
 {
-  return serial_dump_char_size(c, mutt_str_len(c) + 1, d, off, convert);
+  return serial_dump_char_size(c, mutt_str_len(c), d, off, convert);
 }
 
 /**
@@ -177,8 +256,8 @@ unsigned char *serial_dump_char(char *c, unsigned char *d, int *off, bool conver
  */
 void serial_restore_char(char **c, const unsigned char *d, int *off, bool convert)
 {
-  unsigned int size;
-  serial_restore_int(&size, d, off);
+  uint64_t size = 0;
+  serial_restore_varint(&size, d, off);
 
   if (size == 0)
   {
@@ -186,8 +265,10 @@ void serial_restore_char(char **c, const unsigned char *d, int *off, bool conver
     return;
   }
 
-  *c = mutt_mem_malloc(size);
+  size--;
+  *c = mutt_mem_malloc(size + 1);
   memcpy(*c, d + *off, size);
+  (*c)[size] = '\0';
   if (convert && !mutt_str_is_ascii(*c, size))
   {
     char *tmp = mutt_str_dup(*c);
@@ -217,20 +298,21 @@ unsigned char *serial_dump_address(struct AddressList *al, unsigned char *d,
                                    int *off, bool convert)
 {
   unsigned int counter = 0;
-  unsigned int start_off = *off;
-
-  d = serial_dump_int(0xdeadbeef, d, off);
 
   struct Address *a = NULL;
   TAILQ_FOREACH(a, al, entries)
   {
-    d = serial_dump_char(a->personal, d, off, convert);
-    d = serial_dump_char(a->mailbox, d, off, false);
-    d = serial_dump_int(a->group, d, off);
     counter++;
   }
 
-  memcpy(d + start_off, &counter, sizeof(int));
+  d = serial_dump_varint(counter, d, off);
+
+  TAILQ_FOREACH(a, al, entries)
+  {
+    d = serial_dump_char(a->personal, d, off, convert);
+    d = serial_dump_char(a->mailbox, d, off, false);
+    d = serial_dump_varint(a->group, d, off);
+  }
 
   return d;
 }
@@ -245,17 +327,17 @@ unsigned char *serial_dump_address(struct AddressList *al, unsigned char *d,
 void serial_restore_address(struct AddressList *al, const unsigned char *d,
                             int *off, bool convert)
 {
-  unsigned int counter = 0;
-  unsigned int g = 0;
+  uint64_t counter = 0;
+  uint64_t g = 0;
 
-  serial_restore_int(&counter, d, off);
+  serial_restore_varint(&counter, d, off);
 
   while (counter)
   {
     struct Address *a = mutt_addr_new();
     serial_restore_char(&a->personal, d, off, convert);
     serial_restore_char(&a->mailbox, d, off, false);
-    serial_restore_int(&g, d, off);
+    serial_restore_varint(&g, d, off);
     a->group = !!g;
     mutt_addrlist_append(al, a);
     counter--;
@@ -273,18 +355,19 @@ void serial_restore_address(struct AddressList *al, const unsigned char *d,
 unsigned char *serial_dump_stailq(struct ListHead *l, unsigned char *d, int *off, bool convert)
 {
   unsigned int counter = 0;
-  unsigned int start_off = *off;
-
-  d = serial_dump_int(0xdeadbeef, d, off);
 
   struct ListNode *np = NULL;
   STAILQ_FOREACH(np, l, entries)
   {
-    d = serial_dump_char(np->data, d, off, convert);
     counter++;
   }
 
-  memcpy(d + start_off, &counter, sizeof(int));
+  d = serial_dump_varint(counter, d, off);
+
+  STAILQ_FOREACH(np, l, entries)
+  {
+    d = serial_dump_char(np->data, d, off, convert);
+  }
 
   return d;
 }
@@ -298,9 +381,9 @@ unsigned char *serial_dump_stailq(struct ListHead *l, unsigned char *d, int *off
  */
 void serial_restore_stailq(struct ListHead *l, const unsigned char *d, int *off, bool convert)
 {
-  unsigned int counter;
+  uint64_t counter = 0;
 
-  serial_restore_int(&counter, d, off);
+  serial_restore_varint(&counter, d, off);
 
   struct ListNode *np = NULL;
   while (counter)
@@ -318,22 +401,15 @@ void serial_restore_stailq(struct ListHead *l, const unsigned char *d, int *off,
  * @param off     Offset into the blob
  * @param convert If true, the strings will be converted to utf-8
  * @retval ptr End of the newly packed binary
+ *
+ * Only the string contents are stored, not the unused space of the Buffer.
  */
 unsigned char *serial_dump_buffer(struct Buffer *buf, unsigned char *d, int *off, bool convert)
 {
-  if (!buf)
-  {
-    d = serial_dump_int(0, d, off);
-    return d;
-  }
-
-  d = serial_dump_int(1, d, off);
+  if (!buf || !buf->data)
+    return serial_dump_char(NULL, d, off, convert);
 
-  d = serial_dump_char_size(buf->data, buf->dsize + 1, d, off, convert);
-  d = serial_dump_int(buf->dptr - buf->data, d, off);
-  d = serial_dump_int(buf->dsize, d, off);
-
-  return d;
+  return serial_dump_char_size(buf->data, mutt_buffer_len(buf), d, off, convert);
 }
 
 /**
@@ -345,19 +421,15 @@ unsigned char *serial_dump_buffer(struct Buffer *buf, unsigned char *d, int *off
  */
 void serial_restore_buffer(struct Buffer *buf, const unsigned char *d, int *off, bool convert)
 {
-  unsigned int used;
-  unsigned int offset;
-  serial_restore_int(&used, d, off);
-  if (!used)
-  {
+  char *str = NULL;
+  serial_restore_char(&str, d, off, convert);
+  if (!str)
     return;
-  }
 
-  serial_restore_char(&buf->data, d, off, convert);
-  serial_restore_int(&offset, d, off);
-  mutt_buffer_seek(buf, offset);
-  serial_restore_int(&used, d, off);
-  buf->dsize = used;
+  size_t len = mutt_str_len(str);
+  buf->data = str;
+  buf->dsize = len + 1;
+  buf->dptr = buf->data + len;
 }
 
 /**
@@ -372,19 +444,20 @@ unsigned char *serial_dump_parameter(struct ParameterList *pl, unsigned char *d,
                                      int *off, bool convert)
 {
   unsigned int counter = 0;
-  unsigned int start_off = *off;
-
-  d = serial_dump_int(0xdeadbeef, d, off);
 
   struct Parameter *np = NULL;
   TAILQ_FOREACH(np, pl, entries)
   {
-    d = serial_dump_char(np->attribute, d, off, false);
-    d = serial_dump_char(np->value, d, off, convert);
     counter++;
   }
 
-  memcpy(d + start_off, &counter, sizeof(int));
+  d = serial_dump_varint(counter, d, off);
+
+  TAILQ_FOREACH(np, pl, entries)
+  {
+    d = serial_dump_char(np->attribute, d, off, false);
+    d = serial_dump_char(np->value, d, off, convert);
+  }
 
   return d;
 }
@@ -399,21 +472,36 @@ unsigned char *serial_dump_parameter(struct ParameterList *pl, unsigned char *d,
 void serial_restore_parameter(struct ParameterList *pl, const unsigned char *d,
                               int *off, bool convert)
 {
-  unsigned int counter;
+  uint64_t counter = 0;
 
-  serial_restore_int(&counter, d, off);
+  serial_restore_varint(&counter, d, off);
 
   struct Parameter *np = NULL;
   while (counter)
   {
     np = mutt_param_new();
     serial_restore_char(&np->attribute, d, off, false);
+    mutt_intern_replace(&np->attribute);
     serial_restore_char(&np->value, d, off, convert);
     TAILQ_INSERT_TAIL(pl, np, entries);
     counter--;
   }
 }
 
+/**
+ * enum BodyFlags - Bit positions of the Body flags in the serialised record
+ */
+enum BodyFlags
+{
+  BF_USE_DISP = 0,  ///< Body.use_disp
+  BF_NOCONV,        ///< Body.noconv
+  BF_FORCE_CHARSET, ///< Body.force_charset
+  BF_GOODSIG,       ///< Body.goodsig
+  BF_WARNSIG,       ///< Body.warnsig
+  BF_BADSIG,        ///< Body.badsig
+  BF_AUTOCRYPT,     ///< Body.is_autocrypt
+};
+
 /**
  * serial_dump_body - Pack an Body into a binary blob
  * @param c       Body to pack
@@ -421,36 +509,39 @@ void serial_restore_parameter(struct ParameterList *pl, const unsigned char *d,
  * @param off     Offset into the blob
  * @param convert If true, the strings will be converted to utf-8
  * @retval ptr End of the newly packed binary
+ *
+ * Only the fields that describe the parsed message are stored.
+ * Pointers and state used while sending, or by the attachment menu, are not.
  */
 unsigned char *serial_dump_body(struct Body *c, unsigned char *d, int *off, bool convert)
 {
-  struct Body nb;
-
-  memcpy(&nb, c, sizeof(struct Body));
-
-  /* some fields are not safe to cache */
-  nb.content = NULL;
-  nb.charset = NULL;
-  nb.next = NULL;
-  nb.parts = NULL;
-  nb.email = NULL;
-  nb.aptr = NULL;
-  nb.mime_headers = NULL;
-  nb.language = NULL;
+  uint64_t flags = ((uint64_t) c->use_disp << BF_USE_DISP) |
+                   ((uint64_t) c->noconv << BF_NOCONV) |
+                   ((uint64_t) c->force_charset << BF_FORCE_CHARSET) |
+                   ((uint64_t) c->goodsig << BF_GOODSIG) |
+                   ((uint64_t) c->warnsig << BF_WARNSIG) |
+                   ((uint64_t) c->badsig << BF_BADSIG);
+#ifdef USE_AUTOCRYPT
+  flags |= ((uint64_t) c->is_autocrypt << BF_AUTOCRYPT);
+#endif
 
-  lazy_realloc(&d, *off + sizeof(struct Body));
-  memcpy(d + *off, &nb, sizeof(struct Body));
-  *off += sizeof(struct Body);
+  d = serial_dump_varint(c->type, d, off);
+  d = serial_dump_varint(c->encoding, d, off);
+  d = serial_dump_varint(c->disposition, d, off);
+  d = serial_dump_varint(flags, d, off);
+  d = serial_dump_svarint(c->hdr_offset, d, off);
+  d = serial_dump_svarint(c->offset, d, off);
+  d = serial_dump_svarint(c->length, d, off);
 
-  d = serial_dump_char(nb.xtype, d, off, false);
-  d = serial_dump_char(nb.subtype, d, off, false);
+  d = serial_dump_char(c->xtype, d, off, false);
+  d = serial_dump_char(c->subtype, d, off, false);
 
-  d = serial_dump_parameter(&nb.parameter, d, off, convert);
+  d = serial_dump_parameter(&c->parameter, d, off, convert);
 
-  d = serial_dump_char(nb.description, d, off, convert);
-  d = serial_dump_char(nb.form_name, d, off, convert);
-  d = serial_dump_char(nb.filename, d, off, convert);
-  d = serial_dump_char(nb.d_filename, d, off, convert);
+  d = serial_dump_char(c->description, d, off, convert);
+  d = serial_dump_char(c->form_name, d, off, convert);
+  d = serial_dump_char(c->filename, d, off, convert);
+  d = serial_dump_char(c->d_filename, d, off, convert);
 
   return d;
 }
@@ -464,14 +555,37 @@ unsigned char *serial_dump_body(struct Body *c, unsigned char *d, int *off, bool
  */
 void serial_restore_body(struct Body *c, const unsigned char *d, int *off, bool convert)
 {
-  memcpy(c, d + *off, sizeof(struct Body));
-  *off += sizeof(struct Body);
-  c->language = NULL;
+  uint64_t u = 0;
+  int64_t s = 0;
+
+  serial_restore_varint(&u, d, off);
+  c->type = u;
+  serial_restore_varint(&u, d, off);
+  c->encoding = u;
+  serial_restore_varint(&u, d, off);
+  c->disposition = u;
+
+  serial_restore_varint(&u, d, off);
+  c->use_disp = u & (1 << BF_USE_DISP);
+  c->noconv = u & (1 << BF_NOCONV);
+  c->force_charset = u & (1 << BF_FORCE_CHARSET);
+  c->goodsig = u & (1 << BF_GOODSIG);
+  c->warnsig = u & (1 << BF_WARNSIG);
+  c->badsig = u & (1 << BF_BADSIG);
+#ifdef USE_AUTOCRYPT
+  c->is_autocrypt = u & (1 << BF_AUTOCRYPT);
+#endif
+
+  serial_restore_svarint(&s, d, off);
+  c->hdr_offset = s;
+  serial_restore_svarint(&s, d, off);
+  c->offset = s;
+  serial_restore_svarint(&s, d, off);
+  c->length = s;
 
   serial_restore_char(&c->xtype, d, off, false);
   serial_restore_char(&c->subtype, d, off, false);
 
-  TAILQ_INIT(&c->parameter);
   serial_restore_parameter(&c->parameter, d, off, convert);
 
   serial_restore_char(&c->description, d, off, convert);
@@ -481,37 +595,59 @@ void serial_restore_body(struct Body *c, const unsigned char *d, int *off, bool
 }
 
 /**
- * serial_dump_envelope - Pack an Envelope into a binary blob
+ * serial_dump_envelope_index - Pack the index fields of an Envelope into a binary blob
  * @param env     Envelope to pack
  * @param d       Binary blob to add to
  * @param off     Offset into the blob
  * @param convert If true, the strings will be converted to utf-8
  * @retval ptr End of the newly packed binary
+ *
+ * These are the fields needed to open a Mailbox: display the index, sort it
+ * without threads and fill its hash tables.
  */
-unsigned char *serial_dump_envelope(struct Envelope *env, unsigned char *d,
-                                    int *off, bool convert)
+unsigned char *serial_dump_envelope_index(struct Envelope *env, unsigned char *d,
+                                          int *off, bool convert)
 {
-  d = serial_dump_address(&env->return_path, d, off, convert);
   d = serial_dump_address(&env->from, d, off, convert);
   d = serial_dump_address(&env->to, d, off, convert);
   d = serial_dump_address(&env->cc, d, off, convert);
-  d = serial_dump_address(&env->bcc, d, off, convert);
-  d = serial_dump_address(&env->sender, d, off, convert);
-  d = serial_dump_address(&env->reply_to, d, off, convert);
-  d = serial_dump_address(&env->mail_followup_to, d, off, convert);
 
   d = serial_dump_char(env->list_post, d, off, convert);
   d = serial_dump_char(env->subject, d, off, convert);
 
+  /* Offset of real_subj into subject, plus one; zero means NULL */
   if (env->real_subj)
-    d = serial_dump_int(env->real_subj - env->subject, d, off);
+    d = serial_dump_varint(env->real_subj - env->subject + 1, d, off);
   else
-    d = serial_dump_int(-1, d, off);
+    d = serial_dump_varint(0, d, off);
 
   d = serial_dump_char(env->message_id, d, off, false);
   d = serial_dump_char(env->supersedes, d, off, false);
-  d = serial_dump_char(env->date, d, off, false);
   d = serial_dump_char(env->x_label, d, off, convert);
+
+  return d;
+}
+
+/**
+ * serial_dump_envelope_rest - Pack the rest of an Envelope into a binary blob
+ * @param env     Envelope to pack
+ * @param d       Binary blob to add to
+ * @param off     Offset into the blob
+ * @param convert If true, the strings will be converted to utf-8
+ * @retval ptr End of the newly packed binary
+ *
+ * These are the fields that serial_dump_envelope_index() leaves out.
+ */
+unsigned char *serial_dump_envelope_rest(struct Envelope *env, unsigned char *d,
+                                         int *off, bool convert)
+{
+  d = serial_dump_address(&env->return_path, d, off, convert);
+  d = serial_dump_address(&env->bcc, d, off, convert);
+  d = serial_dump_address(&env->sender, d, off, convert);
+  d = serial_dump_address(&env->reply_to, d, off, convert);
+  d = serial_dump_address(&env->mail_followup_to, d, off, convert);
+
+  d = serial_dump_char(env->date, d, off, false);
   d = serial_dump_char(env->organization, d, off, convert);
 
   d = serial_dump_buffer(&env->spam, d, off, convert);
@@ -530,43 +666,63 @@ unsigned char *serial_dump_envelope(struct Envelope *env, unsigned char *d,
 }
 
 /**
- * serial_restore_envelope - Unpack an Envelope from a binary blob
+ * serial_restore_envelope_index - Unpack the index fields of an Envelope from a binary blob
  * @param env     Store the unpacked Envelope here
  * @param d       Binary blob to read from
  * @param off     Offset into the blob
  * @param convert If true, the strings will be converted from utf-8
  */
-void serial_restore_envelope(struct Envelope *env, const unsigned char *d, int *off, bool convert)
+void serial_restore_envelope_index(struct Envelope *env, const unsigned char *d,
+                                   int *off, bool convert)
 {
-  int real_subj_off;
+  uint64_t real_subj_off = 0;
 
-  serial_restore_address(&env->return_path, d, off, convert);
   serial_restore_address(&env->from, d, off, convert);
   serial_restore_address(&env->to, d, off, convert);
   serial_restore_address(&env->cc, d, off, convert);
-  serial_restore_address(&env->bcc, d, off, convert);
-  serial_restore_address(&env->sender, d, off, convert);
-  serial_restore_address(&env->reply_to, d, off, convert);
-  serial_restore_address(&env->mail_followup_to, d, off, convert);
 
   serial_restore_char(&env->list_post, d, off, convert);
+  mutt_intern_replace(&env->list_post);
 
   const bool c_auto_subscribe = cs_subset_bool(NeoMutt->sub, "auto_subscribe");
   if (c_auto_subscribe)
     mutt_auto_subscribe(env->list_post);
 
   serial_restore_char(&env->subject, d, off, convert);
-  serial_restore_int((unsigned int *) (&real_subj_off), d, off);
+  serial_restore_varint(&real_subj_off, d, off);
 
-  if (real_subj_off >= 0)
-    env->real_subj = env->subject + real_subj_off;
+  if ((real_subj_off > 0) && env->subject &&
+      (real_subj_off - 1 <= mutt_str_len(env->subject)))
+  {
+    env->real_subj = env->subject + real_subj_off - 1;
+  }
   else
+  {
     env->real_subj = NULL;
+  }
 
   serial_restore_char(&env->message_id, d, off, false);
   serial_restore_char(&env->supersedes, d, off, false);
-  serial_restore_char(&env->date, d, off, false);
   serial_restore_char(&env->x_label, d, off, convert);
+}
+
+/**
+ * serial_restore_envelope_rest - Unpack the rest of an Envelope from a binary blob
+ * @param env     Store the unpacked Envelope here
+ * @param d       Binary blob to read from
+ * @param off     Offset into the blob
+ * @param convert If true, the strings will be converted from utf-8
+ */
+void serial_restore_envelope_rest(struct Envelope *env, const unsigned char *d,
+                                  int *off, bool convert)
+{
+  serial_restore_address(&env->return_path, d, off, convert);
+  serial_restore_address(&env->bcc, d, off, convert);
+  serial_restore_address(&env->sender, d, off, convert);
+  serial_restore_address(&env->reply_to, d, off, convert);
+  serial_restore_address(&env->mail_followup_to, d, off, convert);
+
+  serial_restore_char(&env->date, d, off, false);
   serial_restore_char(&env->organization, d, off, convert);
 
   serial_restore_buffer(&env->spam, d, off, convert);
@@ -592,18 +748,19 @@ void serial_restore_envelope(struct Envelope *env, const unsigned char *d, int *
 unsigned char *serial_dump_tags(const struct TagList *tags, unsigned char *d, int *off)
 {
   unsigned int counter = 0;
-  unsigned int start_off = *off;
-
-  d = serial_dump_int(0xdeadbeef, d, off);
 
   struct Tag *t = NULL;
-  STAILQ_FOREACH(t, tags, entries)
+  STAILQ_FOREACH(t, &tags->head, entries)
   {
-    d = serial_dump_char(t->name, d, off, false);
     counter++;
   }
 
-  memcpy(d + start_off, &counter, sizeof(int));
+  d = serial_dump_varint(counter, d, off);
+
+  STAILQ_FOREACH(t, &tags->head, entries)
+  {
+    d = serial_dump_char(t->name, d, off, false);
+  }
 
   return d;
 }
@@ -616,9 +773,9 @@ unsigned char *serial_dump_tags(const struct TagList *tags, unsigned char *d, in
  */
 void serial_restore_tags(struct TagList *tags, const unsigned char *d, int *off)
 {
-  unsigned int counter = 0;
+  uint64_t counter = 0;
 
-  serial_restore_int(&counter, d, off);
+  serial_restore_varint(&counter, d, off);
 
   while (counter)
   {
@@ -45,22 +45,28 @@ unsigned char *serial_dump_tags     (const struct TagList *tags, unsigned char *
 unsigned char *serial_dump_buffer   (struct Buffer *buf,         unsigned char *d, int *off, bool convert);
 unsigned char *serial_dump_char     (char *c,                    unsigned char *d, int *off, bool convert);
 unsigned char *serial_dump_char_size(char *c, ssize_t size,      unsigned char *d, int *off, bool convert);
-unsigned char *serial_dump_envelope (struct Envelope *e,         unsigned char *d, int *off, bool convert);
+unsigned char *serial_dump_envelope_index(struct Envelope *e,     unsigned char *d, int *off, bool convert);
+unsigned char *serial_dump_envelope_rest(struct Envelope *e,      unsigned char *d, int *off, bool convert);
 unsigned char *serial_dump_int      (unsigned int i,             unsigned char *d, int *off);
 unsigned char *serial_dump_uint32_t (uint32_t s,                 unsigned char *d, int *off);
 unsigned char *serial_dump_parameter(struct ParameterList *pl,   unsigned char *d, int *off, bool convert);
 unsigned char *serial_dump_stailq   (struct ListHead *l,         unsigned char *d, int *off, bool convert);
+unsigned char *serial_dump_svarint  (int64_t v,                  unsigned char *d, int *off);
+unsigned char *serial_dump_varint   (uint64_t v,                 unsigned char *d, int *off);
 
 void serial_restore_address  (struct AddressList *al,   const unsigned char *d, int *off, bool convert);
 void serial_restore_body     (struct Body *c,           const unsigned char *d, int *off, bool convert);
 void serial_restore_tags     (struct TagList *tags,     const unsigned char *d, int *off);
 void serial_restore_buffer   (struct Buffer *buf,       const unsigned char *d, int *off, bool convert);
 void serial_restore_char     (char **c,                 const unsigned char *d, int *off, bool convert);
-void serial_restore_envelope (struct Envelope *e,       const unsigned char *d, int *off, bool convert);
+void serial_restore_envelope_index(struct Envelope *e,   const unsigned char *d, int *off, bool convert);
+void serial_restore_envelope_rest(struct Envelope *e,    const unsigned char *d, int *off, bool convert);
 void serial_restore_int      (unsigned int *i,          const unsigned char *d, int *off);
 void serial_restore_uint32_t (uint32_t *s,              const unsigned char *d, int *off);
 void serial_restore_parameter(struct ParameterList *pl, const unsigned char *d, int *off, bool convert);
 void serial_restore_stailq   (struct ListHead *l,       const unsigned char *d, int *off, bool convert);
+void serial_restore_svarint  (int64_t *v,               const unsigned char *d, int *off);
+void serial_restore_varint   (uint64_t *v,              const unsigned char *d, int *off);
 
 void lazy_realloc(void *ptr, size_t size);
 
@@ -190,8 +190,8 @@ static const char *make_from_prefix(enum FieldType disp)
     [DISP_FROM] = "",  [DISP_PLAIN] = "",
   };
 
-  const struct MbTable *c_from_chars =
-      cs_subset_mbtable(NeoMutt->sub, "from_chars");
+  static struct ConfigHandle ch_from_chars = CONFIG_HANDLE("from_chars");
+  const struct MbTable *c_from_chars = cs_handle_mbtable(&ch_from_chars, NeoMutt->sub);
 
   if (!c_from_chars || !c_from_chars->chars || (c_from_chars->len == 0))
     return long_prefixes[disp];
@@ -442,9 +442,11 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
 {
   struct HdrFormatInfo *hfi = (struct HdrFormatInfo *) data;
   char fmt[128], tmp[1024];
-  char *p = NULL, *tags = NULL;
+  char *p = NULL;
+  const char *tags = NULL;
   bool optional = (flags & MUTT_FORMAT_OPTIONAL);
-  const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
+  static struct ConfigHandle ch_sort = CONFIG_HANDLE("sort");
+  const short c_sort = cs_handle_sort(&ch_sort, NeoMutt->sub);
   int threads = ((c_sort & SORT_MASK) == SORT_THREADS);
   int is_index = (flags & MUTT_FORMAT_INDEX);
   size_t colorlen;
@@ -461,14 +463,14 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
   const struct Address *to = TAILQ_FIRST(&e->env->to);
   const struct Address *cc = TAILQ_FIRST(&e->env->cc);
 
-  const struct MbTable *c_crypt_chars =
-      cs_subset_mbtable(NeoMutt->sub, "crypt_chars");
-  const struct MbTable *c_flag_chars =
-      cs_subset_mbtable(NeoMutt->sub, "flag_chars");
-  const struct MbTable *c_to_chars =
-      cs_subset_mbtable(NeoMutt->sub, "to_chars");
-  const char *const c_date_format =
-      cs_subset_string(NeoMutt->sub, "date_format");
+  static struct ConfigHandle ch_crypt_chars = CONFIG_HANDLE("crypt_chars");
+  static struct ConfigHandle ch_flag_chars = CONFIG_HANDLE("flag_chars");
+  static struct ConfigHandle ch_to_chars = CONFIG_HANDLE("to_chars");
+  static struct ConfigHandle ch_date_format = CONFIG_HANDLE("date_format");
+  const struct MbTable *c_crypt_chars = cs_handle_mbtable(&ch_crypt_chars, NeoMutt->sub);
+  const struct MbTable *c_flag_chars = cs_handle_mbtable(&ch_flag_chars, NeoMutt->sub);
+  const struct MbTable *c_to_chars = cs_handle_mbtable(&ch_to_chars, NeoMutt->sub);
+  const char *const c_date_format = cs_handle_string(&ch_date_format, NeoMutt->sub);
 
   buf[0] = '\0';
   switch (op)
@@ -819,7 +821,6 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
       }
       else if (!tags)
         optional = false;
-      FREE(&tags);
       break;
 
     case 'G':
@@ -840,7 +841,6 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
           colorlen = add_index_color(buf, buflen, flags, MT_COLOR_INDEX_TAG);
           mutt_format_s(buf + colorlen, buflen - colorlen, prec, NONULL(tags));
           add_index_color(buf + colorlen, buflen - colorlen, flags, MT_COLOR_INDEX);
-          FREE(&tags);
         }
         src++;
       }
@@ -856,7 +856,6 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
           tags = driver_tags_get_transformed_for(&e->tags, tag);
           if (!tags)
             optional = false;
-          FREE(&tags);
         }
       }
       break;
@@ -882,7 +881,7 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
       {
         if (flags & MUTT_FORMAT_TREE)
         {
-          char *parent_tags = NULL;
+          const char *parent_tags = NULL;
           if (e->thread->prev && e->thread->prev->message)
           {
             parent_tags = driver_tags_get_transformed(&e->thread->prev->message->tags);
@@ -894,7 +893,6 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
           }
           if (parent_tags && mutt_istr_equal(tags, parent_tags))
             have_tags = false;
-          FREE(&parent_tags);
         }
       }
       else
@@ -909,7 +907,6 @@ static const char *index_format_str(char *buf, size_t buflen, size_t col, int co
       else
         mutt_format_s(buf + colorlen, buflen - colorlen, prec, "");
       add_index_color(buf + colorlen, buflen - colorlen, flags, MT_COLOR_INDEX);
-      FREE(&tags);
       break;
     }
 
@@ -1412,6 +1409,7 @@ void mutt_make_string(char *buf, size_t buflen, int cols, const char *s,
 {
   struct HdrFormatInfo hfi = { 0 };
 
+  email_env_load(e);
   hfi.email = e;
   hfi.mailbox = m;
   hfi.msg_in_pager = inpgr;
@@ -126,6 +126,11 @@ static int helpbar_recalc(struct MuttWindow *win)
 
   wdata->help_menu = win_focus->help_menu;
   wdata->help_data = win_focus->help_data;
+
+  /* Only repaint if the text has changed */
+  if (mutt_str_equal(wdata->help_str, helpstr))
+    return 0;
+
   mutt_str_replace(&wdata->help_str, helpstr);
   win->actions |= WA_REPAINT;
 
@@ -96,6 +96,8 @@ struct History
 
 static struct History Histories[HC_MAX];
 static int OldSize = 0;
+static int HistFileLines = 0;     ///< Number of lines in `$history_file`
+static int HistFileCompacted = 0; ///< Number of lines after the last shrink_histfile()
 
 /**
  * get_history - Get a particular history
@@ -227,6 +229,8 @@ static void shrink_histfile(void)
         (*(p = linebuf + strlen(linebuf) - 1) != '|') || (hclass < 0))
     {
       mutt_error(_("Bad history file format (line %d)"), line);
+      /* don't try again until the file has doubled */
+      HistFileCompacted = HistFileLines;
       goto cleanup;
     }
     /* silently ignore too high class (probably newer neomutt) */
@@ -240,6 +244,8 @@ static void shrink_histfile(void)
     }
     n[hclass]++;
   }
+  HistFileLines = line;
+  HistFileCompacted = line;
 
   if (!regen_file)
   {
@@ -263,6 +269,7 @@ static void shrink_histfile(void)
     }
     rewind(fp);
     line = 0;
+    HistFileCompacted = 0;
     while ((linebuf = mutt_file_read_line(linebuf, &buflen, fp, &line, MUTT_RL_NO_FLAGS)))
     {
       if ((sscanf(linebuf, "%d:%n", &hclass, &read) < 1) || (read == 0) ||
@@ -280,7 +287,10 @@ static void shrink_histfile(void)
       }
       *p = '|';
       if (n[hclass]-- <= c_save_history)
+      {
         fprintf(fp_tmp, "%s\n", linebuf);
+        HistFileCompacted++;
+      }
     }
   }
 
@@ -294,6 +304,7 @@ cleanup:
       rewind(fp_tmp);
       mutt_file_copy_stream(fp_tmp, fp);
       mutt_file_fclose(&fp);
+      HistFileLines = HistFileCompacted;
     }
     mutt_file_fclose(&fp_tmp);
   }
@@ -306,10 +317,13 @@ cleanup:
  * save_history - Save one history string to a file
  * @param hclass History type
  * @param str    String to save
+ *
+ * The string is appended to the file.  The file is only shrunk once it has
+ * grown to twice its size after the last shrink, so each shrink is paid for
+ * by the strings appended since.
  */
 static void save_history(enum HistoryClass hclass, const char *str)
 {
-  static int n = 0;
   char *tmp = NULL;
 
   if (!str || (*str == '\0')) /* This shouldn't happen, but it's safer. */
@@ -341,12 +355,9 @@ static void save_history(enum HistoryClass hclass, const char *str)
   mutt_file_fclose(&fp);
   FREE(&tmp);
 
-  if (--n < 0)
-  {
-    const short c_save_history = cs_subset_number(NeoMutt->sub, "save_history");
-    n = c_save_history;
+  const short c_save_history = cs_subset_number(NeoMutt->sub, "save_history");
+  if (++HistFileLines >= (2 * MAX(HistFileCompacted, c_save_history)))
     shrink_histfile();
-  }
 }
 
 /**
@@ -634,6 +645,9 @@ void mutt_hist_read_file(void)
     }
   }
 
+  HistFileLines = line;
+  HistFileCompacted = line;
+
   mutt_file_fclose(&fp);
   FREE(&linebuf);
 }
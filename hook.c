@@ -28,11 +28,14 @@
  */
 
 #include "config.h"
+#include <ctype.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <wchar.h>
 #include "mutt/lib.h"
 #include "address/lib.h"
 #include "config/lib.h"
@@ -52,6 +55,7 @@
 #include "mutt_globals.h"
 #include "muttlib.h"
 #include "mx.h"
+#include "options.h"
 #ifdef USE_COMP_MBOX
 #include "compmbox/lib.h"
 #endif
@@ -65,15 +69,250 @@ struct Hook
   struct Regex regex;          ///< Regular expression
   char *command;               ///< Filename, command or pattern to execute
   struct PatternList *pattern; ///< Used for fcc,save,send-hook
+  bool deferred;               ///< Pattern or regex will be compiled on first use
+  bool broken;                 ///< Deferred pattern or regex didn't compile
+  char *literal;               ///< String that every match of the regex contains
+  bool lit_start : 1;          ///< The literal must be at the start of the string
+  bool lit_end : 1;            ///< The literal must be at the end of the string
+  bool lit_only : 1;           ///< The regex is just the literal
   TAILQ_ENTRY(Hook) entries;   ///< Linked list
 };
 TAILQ_HEAD(HookList, Hook);
+ARRAY_HEAD(HookArray, struct Hook *);
 
 static struct HookList Hooks = TAILQ_HEAD_INITIALIZER(Hooks);
 
+/// Hooks of each type (one per bit of #HookFlags), in the order they were defined
+static struct HookArray HooksByType[20] = { 0 };
+
 static struct HashTable *IdxFmtHooks = NULL;
 static HookFlags current_hook_type = MUTT_HOOK_NO_FLAGS;
 
+/**
+ * hook_comp_flags - Get the Pattern compile flags for a type of Hook
+ * @param type Hook type, see #HookFlags
+ * @retval num Flags for mutt_pattern_comp(), see #PatternCompFlags
+ */
+static PatternCompFlags hook_comp_flags(HookFlags type)
+{
+  if (type & MUTT_IDXFMTHOOK)
+    return MUTT_PC_FULL_MSG | MUTT_PC_PATTERN_DYNAMIC;
+  if (type & MUTT_SEND2_HOOK)
+    return MUTT_PC_SEND_MODE_SEARCH;
+  if (type & (MUTT_SEND_HOOK | MUTT_FCC_HOOK))
+    return MUTT_PC_NO_FLAGS;
+  return MUTT_PC_FULL_MSG;
+}
+
+/**
+ * hook_defer - Can a Hook's pattern be compiled later?
+ * @retval true The config file is unchanged since it was last read cleanly
+ *
+ * The pattern will be compiled when the Hook is first used, exactly as it
+ * would have been now, see $config_cache.
+ */
+static bool hook_defer(void)
+{
+  return OptRcTrusted && !Context;
+}
+
+/**
+ * hook_compile - Compile a deferred Hook pattern or regex
+ * @param hook Hook
+ * @retval true  The Hook is ready to use
+ * @retval false The pattern or regex is invalid
+ */
+static bool hook_compile(struct Hook *hook)
+{
+  if (hook->broken)
+    return false;
+  if (!hook->deferred)
+    return true;
+
+  hook->deferred = false;
+  mutt_debug(LL_DEBUG2, "compiling deferred hook '%s'\n", hook->regex.pattern);
+  struct Buffer *err = mutt_buffer_pool_get();
+
+  if (hook->type & (MUTT_SEND_HOOK | MUTT_SEND2_HOOK | MUTT_SAVE_HOOK | MUTT_FCC_HOOK |
+                    MUTT_MESSAGE_HOOK | MUTT_REPLY_HOOK | MUTT_IDXFMTHOOK))
+  {
+    hook->pattern = mutt_pattern_comp(NULL, NULL, hook->regex.pattern,
+                                      hook_comp_flags(hook->type), err);
+    hook->broken = !hook->pattern;
+  }
+  else
+  {
+    regex_t *rx = mutt_mem_malloc(sizeof(regex_t));
+    int rc = REG_COMP(rx, NONULL(hook->regex.pattern),
+                      ((hook->type & MUTT_CRYPT_HOOK) ? REG_ICASE : 0));
+    if (rc == 0)
+    {
+      hook->regex.regex = rx;
+    }
+    else
+    {
+      mutt_buffer_alloc(err, 256);
+      regerror(rc, rx, err->data, err->dsize);
+      FREE(&rx);
+      hook->broken = true;
+    }
+  }
+
+  if (hook->broken)
+    mutt_error("%s: %s", NONULL(hook->regex.pattern), mutt_buffer_string(err));
+
+  mutt_buffer_pool_release(&err);
+  return !hook->broken;
+}
+
+/**
+ * hook_index - Add a Hook to the lists of its types
+ * @param hook Hook
+ */
+static void hook_index(struct Hook *hook)
+{
+  for (size_t i = 0; i < mutt_array_size(HooksByType); i++)
+  {
+    if (hook->type & (1 << i))
+      ARRAY_ADD(&HooksByType[i], hook);
+  }
+}
+
+/**
+ * hooks_reindex - Rebuild the lists of Hooks of each type
+ */
+static void hooks_reindex(void)
+{
+  for (size_t i = 0; i < mutt_array_size(HooksByType); i++)
+    ARRAY_SHRINK(&HooksByType[i], ARRAY_SIZE(&HooksByType[i]));
+
+  struct Hook *hook = NULL;
+  TAILQ_FOREACH(hook, &Hooks, entries)
+  {
+    hook_index(hook);
+  }
+}
+
+/**
+ * hooks_of_type - Get the Hooks of one type
+ * @param type Hook type, e.g. #MUTT_FOLDER_HOOK
+ * @retval ptr  Hooks, in the order they were defined
+ * @retval NULL Not a single type
+ *
+ * @note Callers iterate by index, because running a Hook may define more.
+ */
+static struct HookArray *hooks_of_type(HookFlags type)
+{
+  for (size_t i = 0; i < mutt_array_size(HooksByType); i++)
+  {
+    if (type == (1 << i))
+      return &HooksByType[i];
+  }
+  return NULL;
+}
+
+/**
+ * hook_set_literal - Find the literal text at the start of a Hook's regex
+ * @param hook Hook
+ *
+ * Folder and account hooks are often just a path or URL, e.g.
+ * `^/home/user/mail/work$`.  The literal is checked before the regex, so most
+ * Hooks that can't match don't need to run, or even compile, their regex.
+ */
+static void hook_set_literal(struct Hook *hook)
+{
+  const char *p = hook->regex.pattern;
+  if (!p || strchr(p, '|'))
+    return;
+
+  struct Buffer *run = mutt_buffer_pool_get();
+  size_t atom = 0; // Start of the last character in the run
+  mbstate_t mbstate = { 0 };
+
+  hook->lit_start = (*p == '^');
+  if (hook->lit_start)
+    p++;
+
+  while (*p)
+  {
+    if (*p == '\\')
+    {
+      /* e.g. \w, \<, \1 */
+      if ((p[1] == '\0') || isalnum((unsigned char) p[1]) || strchr("<>`'", p[1]))
+        break;
+      atom = mutt_buffer_len(run);
+      mutt_buffer_addch(run, p[1]);
+      p += 2;
+      continue;
+    }
+
+    if (strchr("^.[$()*+?{", *p))
+      break;
+
+    size_t len = mbrlen(p, MB_CUR_MAX, &mbstate);
+    if ((len == (size_t) -1) || (len == (size_t) -2) || (len == 0))
+    {
+      memset(&mbstate, 0, sizeof(mbstate));
+      len = 1;
+    }
+    atom = mutt_buffer_len(run);
+    mutt_buffer_addstr_n(run, p, len);
+    p += len;
+  }
+
+  if ((*p == '*') || (*p == '?') || (*p == '{'))
+  {
+    /* The last character is optional */
+    run->data[atom] = '\0';
+    run->dptr = run->data + atom;
+  }
+  else if ((p[0] == '$') && (p[1] == '\0'))
+  {
+    hook->lit_end = true;
+    p++;
+  }
+
+  hook->lit_only = (*p == '\0');
+  if (mutt_buffer_is_empty(run))
+    hook->lit_start = hook->lit_end = hook->lit_only = false;
+  else
+    hook->literal = mutt_buffer_strdup(run);
+
+  mutt_buffer_pool_release(&run);
+}
+
+/**
+ * hook_regex_match - Does a string match a Hook's regex?
+ * @param hook Hook
+ * @param str  String to match
+ * @retval true The string matches (taking account of the '!')
+ */
+static bool hook_regex_match(struct Hook *hook, const char *str)
+{
+  if (!str)
+    return false;
+
+  if (hook->literal)
+  {
+    const size_t llen = mutt_str_len(hook->literal);
+    const size_t slen = mutt_str_len(str);
+    bool found;
+    if (hook->lit_start && hook->lit_end)
+      found = mutt_str_equal(str, hook->literal);
+    else if (hook->lit_start)
+      found = mutt_strn_equal(str, hook->literal, llen);
+    else if (hook->lit_end)
+      found = (slen >= llen) && mutt_str_equal(str + slen - llen, hook->literal);
+    else
+      found = strstr(str, hook->literal);
+
+    if (!found || hook->lit_only)
+      return found ^ hook->regex.pat_not;
+  }
+
+  return hook_compile(hook) && mutt_regex_match(&hook->regex, str);
+}
+
 /**
  * mutt_parse_hook - Parse the 'hook' family of commands - Implements Command::parse()
  *
@@ -86,7 +325,7 @@ enum CommandResult mutt_parse_hook(struct Buffer *buf, struct Buffer *s,
   int rc = MUTT_CMD_ERROR;
   bool pat_not = false;
   bool use_regex = true;
-  regex_t *rx = NULL;
+  bool deferred = false;
   struct PatternList *pat = NULL;
   const bool folder_or_mbox = (data & (MUTT_FOLDER_HOOK | MUTT_MBOX_HOOK));
 
@@ -258,32 +497,26 @@ enum CommandResult mutt_parse_hook(struct Buffer *buf, struct Buffer *s,
   else if (data & (MUTT_SEND_HOOK | MUTT_SEND2_HOOK | MUTT_SAVE_HOOK |
                    MUTT_FCC_HOOK | MUTT_MESSAGE_HOOK | MUTT_REPLY_HOOK))
   {
-    PatternCompFlags comp_flags;
-
-    if (data & (MUTT_SEND2_HOOK))
-      comp_flags = MUTT_PC_SEND_MODE_SEARCH;
-    else if (data & (MUTT_SEND_HOOK | MUTT_FCC_HOOK))
-      comp_flags = MUTT_PC_NO_FLAGS;
+    if (hook_defer())
+    {
+      deferred = true;
+    }
     else
-      comp_flags = MUTT_PC_FULL_MSG;
-
-    pat = mutt_pattern_comp(ctx_mailbox(Context), Context ? Context->menu : NULL,
-                            mutt_buffer_string(pattern), comp_flags, err);
-    if (!pat)
-      goto cleanup;
+    {
+      pat = mutt_pattern_comp(ctx_mailbox(Context), Context ? Context->menu : NULL,
+                              mutt_buffer_string(pattern),
+                              hook_comp_flags(data) | MUTT_PC_LAZY_REGEX, err);
+      if (!pat)
+        goto cleanup;
+    }
   }
   else if (~data & MUTT_GLOBAL_HOOK) /* NOT a global hook */
   {
-    /* Hooks not allowing full patterns: Check syntax of regex */
-    rx = mutt_mem_malloc(sizeof(regex_t));
-    int rc2 = REG_COMP(rx, NONULL(mutt_buffer_string(pattern)),
-                       ((data & MUTT_CRYPT_HOOK) ? REG_ICASE : 0));
-    if (rc2 != 0)
-    {
-      regerror(rc2, rx, err->data, err->dsize);
-      FREE(&rx);
+    /* Hooks not allowing full patterns: Check syntax of regex.
+     * It's compiled when the hook is first used. */
+    if (!hook_defer() && !mutt_regex_check(mutt_buffer_string(pattern), NULL, err))
       goto cleanup;
-    }
+    deferred = true;
   }
 
   hook = mutt_mem_calloc(1, sizeof(struct Hook));
@@ -291,9 +524,13 @@ enum CommandResult mutt_parse_hook(struct Buffer *buf, struct Buffer *s,
   hook->command = mutt_buffer_strdup(cmd);
   hook->pattern = pat;
   hook->regex.pattern = mutt_buffer_strdup(pattern);
-  hook->regex.regex = rx;
+  hook->regex.regex = NULL;
   hook->regex.pat_not = pat_not;
+  hook->deferred = deferred;
+  if (data & (MUTT_FOLDER_HOOK | MUTT_ACCOUNT_HOOK))
+    hook_set_literal(hook);
   TAILQ_INSERT_TAIL(&Hooks, hook, entries);
+  hook_index(hook);
   rc = MUTT_CMD_SUCCESS;
 
 cleanup:
@@ -310,6 +547,7 @@ static void delete_hook(struct Hook *h)
 {
   FREE(&h->command);
   FREE(&h->regex.pattern);
+  FREE(&h->literal);
   if (h->regex.regex)
   {
     regfree(h->regex.regex);
@@ -338,6 +576,16 @@ void mutt_delete_hooks(HookFlags type)
       delete_hook(h);
     }
   }
+
+  if (type == MUTT_HOOK_NO_FLAGS)
+  {
+    for (size_t i = 0; i < mutt_array_size(HooksByType); i++)
+      ARRAY_FREE(&HooksByType[i]);
+  }
+  else
+  {
+    hooks_reindex();
+  }
 }
 
 /**
@@ -439,12 +687,16 @@ enum CommandResult mutt_parse_idxfmt_hook(struct Buffer *buf, struct Buffer *s,
    * matching.  This of course is slower, but index-format-hook is commonly
    * used for date ranges, and they need to be evaluated relative to "now", not
    * the hook compilation time.  */
-  struct PatternList *pat =
-      mutt_pattern_comp(ctx_mailbox(Context), Context ? Context->menu : NULL,
-                        mutt_buffer_string(pattern),
-                        MUTT_PC_FULL_MSG | MUTT_PC_PATTERN_DYNAMIC, err);
-  if (!pat)
-    goto out;
+  struct PatternList *pat = NULL;
+  const bool deferred = hook_defer();
+  if (!deferred)
+  {
+    pat = mutt_pattern_comp(ctx_mailbox(Context), Context ? Context->menu : NULL,
+                            mutt_buffer_string(pattern),
+                            hook_comp_flags(MUTT_IDXFMTHOOK) | MUTT_PC_LAZY_REGEX, err);
+    if (!pat)
+      goto out;
+  }
 
   hook = mutt_mem_calloc(1, sizeof(struct Hook));
   hook->type = MUTT_IDXFMTHOOK;
@@ -453,6 +705,7 @@ enum CommandResult mutt_parse_idxfmt_hook(struct Buffer *buf, struct Buffer *s,
   hook->regex.pattern = mutt_buffer_strdup(pattern);
   hook->regex.regex = NULL;
   hook->regex.pat_not = pat_not;
+  hook->deferred = deferred;
 
   if (!hl)
   {
@@ -531,23 +784,22 @@ void mutt_folder_hook(const char *path, const char *desc)
   if (!path && !desc)
     return;
 
-  struct Hook *hook = NULL;
+  TRACE_SCOPE("hook", "mutt_folder_hook", path ? path : desc);
+  struct HookArray *ha = hooks_of_type(MUTT_FOLDER_HOOK);
   struct Buffer *err = mutt_buffer_pool_get();
 
   current_hook_type = MUTT_FOLDER_HOOK;
 
-  TAILQ_FOREACH(hook, &Hooks, entries)
+  for (size_t i = 0; i < ARRAY_SIZE(ha); i++)
   {
+    struct Hook *hook = *ARRAY_GET(ha, i);
     if (!hook->command)
       continue;
 
-    if (!(hook->type & MUTT_FOLDER_HOOK))
-      continue;
-
     const char *match = NULL;
-    if (mutt_regex_match(&hook->regex, path))
+    if (hook_regex_match(hook, path))
       match = path;
-    else if (mutt_regex_match(&hook->regex, desc))
+    else if (hook_regex_match(hook, desc))
       match = desc;
 
     if (match)
@@ -576,15 +828,15 @@ void mutt_folder_hook(const char *path, const char *desc)
  */
 char *mutt_find_hook(HookFlags type, const char *pat)
 {
-  struct Hook *tmp = NULL;
+  struct HookArray *ha = hooks_of_type(type);
+  if (!ha)
+    return NULL;
 
-  TAILQ_FOREACH(tmp, &Hooks, entries)
+  struct Hook **hp = NULL;
+  ARRAY_FOREACH(hp, ha)
   {
-    if (tmp->type & type)
-    {
-      if (mutt_regex_match(&tmp->regex, pat))
-        return tmp->command;
-    }
+    if (hook_regex_match(*hp, pat))
+      return (*hp)->command;
   }
   return NULL;
 }
@@ -597,18 +849,23 @@ char *mutt_find_hook(HookFlags type, const char *pat)
  */
 void mutt_message_hook(struct Mailbox *m, struct Email *e, HookFlags type)
 {
-  struct Hook *hook = NULL;
+  struct HookArray *ha = hooks_of_type(type);
+  if (!ha)
+    return;
+
+  TRACE_SCOPE("hook", "mutt_message_hook", NULL);
   struct PatternCache cache = { 0 };
   struct Buffer *err = mutt_buffer_pool_get();
 
   current_hook_type = type;
 
-  TAILQ_FOREACH(hook, &Hooks, entries)
+  for (size_t i = 0; i < ARRAY_SIZE(ha); i++)
   {
+    struct Hook *hook = *ARRAY_GET(ha, i);
     if (!hook->command)
       continue;
 
-    if (hook->type & type)
+    if (hook_compile(hook))
     {
       if ((mutt_pattern_exec(SLIST_FIRST(hook->pattern), 0, m, e, &cache) > 0) ^
           hook->regex.pat_not)
@@ -645,16 +902,18 @@ void mutt_message_hook(struct Mailbox *m, struct Email *e, HookFlags type)
 static int addr_hook(char *path, size_t pathlen, HookFlags type,
                      struct Context *ctx, struct Email *e)
 {
-  struct Hook *hook = NULL;
+  struct HookArray *ha = hooks_of_type(type);
   struct PatternCache cache = { 0 };
+  struct Hook **hp = NULL;
 
   /* determine if a matching hook exists */
-  TAILQ_FOREACH(hook, &Hooks, entries)
+  ARRAY_FOREACH(hp, ha)
   {
+    struct Hook *hook = *hp;
     if (!hook->command)
       continue;
 
-    if (hook->type & type)
+    if (hook_compile(hook))
     {
       struct Mailbox *m = ctx ? ctx->mailbox : NULL;
       if ((mutt_pattern_exec(SLIST_FIRST(hook->pattern), 0, m, e, &cache) > 0) ^
@@ -754,13 +1013,14 @@ void mutt_select_fcc(struct Buffer *path, struct Email *e)
  */
 static void list_hook(struct ListHead *matches, const char *match, HookFlags hook)
 {
-  struct Hook *tmp = NULL;
+  struct HookArray *ha = hooks_of_type(hook);
+  struct Hook **hp = NULL;
 
-  TAILQ_FOREACH(tmp, &Hooks, entries)
+  ARRAY_FOREACH(hp, ha)
   {
-    if ((tmp->type & hook) && mutt_regex_match(&tmp->regex, match))
+    if (hook_regex_match(*hp, match))
     {
-      mutt_list_insert_tail(matches, mutt_str_dup(tmp->command));
+      mutt_list_insert_tail(matches, mutt_str_dup((*hp)->command));
     }
   }
 }
@@ -790,15 +1050,17 @@ void mutt_account_hook(const char *url)
   if (inhook)
     return;
 
-  struct Hook *hook = NULL;
+  TRACE_SCOPE("hook", "mutt_account_hook", url);
+  struct HookArray *ha = hooks_of_type(MUTT_ACCOUNT_HOOK);
   struct Buffer *err = mutt_buffer_pool_get();
 
-  TAILQ_FOREACH(hook, &Hooks, entries)
+  for (size_t i = 0; i < ARRAY_SIZE(ha); i++)
   {
-    if (!(hook->command && (hook->type & MUTT_ACCOUNT_HOOK)))
+    struct Hook *hook = *ARRAY_GET(ha, i);
+    if (!hook->command)
       continue;
 
-    if (mutt_regex_match(&hook->regex, url))
+    if (hook_regex_match(hook, url))
     {
       inhook = true;
       mutt_debug(LL_DEBUG1, "account-hook '%s' matches '%s'\n", hook->regex.pattern, url);
@@ -828,7 +1090,8 @@ done:
  */
 void mutt_timeout_hook(void)
 {
-  struct Hook *hook = NULL;
+  TRACE_SCOPE("hook", "mutt_timeout_hook", NULL);
+
   struct Buffer err;
   char buf[256];
 
@@ -836,9 +1099,11 @@ void mutt_timeout_hook(void)
   err.data = buf;
   err.dsize = sizeof(buf);
 
-  TAILQ_FOREACH(hook, &Hooks, entries)
+  struct HookArray *ha = hooks_of_type(MUTT_TIMEOUT_HOOK);
+  for (size_t i = 0; i < ARRAY_SIZE(ha); i++)
   {
-    if (!(hook->command && (hook->type & MUTT_TIMEOUT_HOOK)))
+    struct Hook *hook = *ARRAY_GET(ha, i);
+    if (!hook->command)
       continue;
 
     if (mutt_parse_rc_line(hook->command, &err) == MUTT_CMD_ERROR)
@@ -864,16 +1129,21 @@ void mutt_timeout_hook(void)
  */
 void mutt_startup_shutdown_hook(HookFlags type)
 {
-  struct Hook *hook = NULL;
   struct Buffer err = mutt_buffer_make(0);
   char buf[256];
 
   err.data = buf;
   err.dsize = sizeof(buf);
 
-  TAILQ_FOREACH(hook, &Hooks, entries)
+  struct HookArray *ha = hooks_of_type(type);
+  if (!ha)
+    return;
+
+  TRACE_SCOPE("hook", "mutt_startup_shutdown_hook", NULL);
+  for (size_t i = 0; i < ARRAY_SIZE(ha); i++)
   {
-    if (!(hook->command && (hook->type & type)))
+    struct Hook *hook = *ARRAY_GET(ha, i);
+    if (!hook->command)
       continue;
 
     if (mutt_parse_rc_line(hook->command, &err) == MUTT_CMD_ERROR)
@@ -909,6 +1179,9 @@ const char *mutt_idxfmt_hook(const char *name, struct Mailbox *m, struct Email *
 
   TAILQ_FOREACH(hook, hl, entries)
   {
+    if (!hook_compile(hook))
+      continue;
+
     struct Pattern *pat = SLIST_FIRST(hook->pattern);
     if ((mutt_pattern_exec(pat, 0, m, e, &cache) > 0) ^ hook->regex.pat_not)
     {
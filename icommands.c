@@ -35,10 +35,12 @@
 #include "mutt/lib.h"
 #include "config/lib.h"
 #include "core/lib.h"
+#include "conn/lib.h"
 #include "gui/lib.h"
 #include "mutt.h"
 #include "icommands.h"
 #include "pager/lib.h"
+#include "debug/lib.h"
 #include "functions.h"
 #include "init.h"
 #include "keymap.h"
@@ -48,6 +50,12 @@
 
 // clang-format off
 static enum CommandResult icmd_bind   (struct Buffer *buf, struct Buffer *s, intptr_t data, struct Buffer *err);
+#ifdef USE_DEBUG_MEMORY
+static enum CommandResult icmd_memory (struct Buffer *buf, struct Buffer *s, intptr_t data, struct Buffer *err);
+#endif
+#ifdef USE_DEBUG_PERF
+static enum CommandResult icmd_perf   (struct Buffer *buf, struct Buffer *s, intptr_t data, struct Buffer *err);
+#endif
 static enum CommandResult icmd_set    (struct Buffer *buf, struct Buffer *s, intptr_t data, struct Buffer *err);
 static enum CommandResult icmd_version(struct Buffer *buf, struct Buffer *s, intptr_t data, struct Buffer *err);
 
@@ -59,6 +67,12 @@ static enum CommandResult icmd_version(struct Buffer *buf, struct Buffer *s, int
 static const struct ICommand ICommandList[] = {
   { "bind",     icmd_bind,     0 },
   { "macro",    icmd_bind,     1 },
+#ifdef USE_DEBUG_MEMORY
+  { "memory",   icmd_memory,   0 },
+#endif
+#ifdef USE_DEBUG_PERF
+  { "perf",     icmd_perf,     0 },
+#endif
   { "set",      icmd_set,      0 },
   { "version",  icmd_version,  0 },
   { NULL,       NULL,          0 },
@@ -301,6 +315,94 @@ static enum CommandResult icmd_bind(struct Buffer *buf, struct Buffer *s,
   return MUTT_CMD_SUCCESS;
 }
 
+#ifdef USE_DEBUG_MEMORY
+/**
+ * icmd_memory - Parse 'memory' command to display the memory use - Implements ICommand::parse()
+ */
+static enum CommandResult icmd_memory(struct Buffer *buf, struct Buffer *s,
+                                      intptr_t data, struct Buffer *err)
+{
+  if (MoreArgs(s))
+  {
+    mutt_buffer_printf(err, _("%s: too many arguments"), "memory");
+    return MUTT_CMD_WARNING;
+  }
+
+  char tempfile[PATH_MAX];
+  mutt_mktemp(tempfile, sizeof(tempfile));
+
+  FILE *fp_out = mutt_file_fopen(tempfile, "w");
+  if (!fp_out)
+  {
+    // L10N: '%s' is the file name of the temporary file
+    mutt_buffer_printf(err, _("Could not create temporary file %s"), tempfile);
+    return MUTT_CMD_ERROR;
+  }
+
+  mutt_mem_dump(fp_out);
+  mutt_file_fclose(&fp_out);
+
+  if (mutt_do_pager("memory", tempfile, MUTT_PAGER_NO_FLAGS, NULL) == -1)
+  {
+    // L10N: '%s' is the file name of the temporary file
+    mutt_buffer_printf(err, _("Could not create temporary file %s"), tempfile);
+    return MUTT_CMD_ERROR;
+  }
+
+  return MUTT_CMD_SUCCESS;
+}
+#endif
+
+#ifdef USE_DEBUG_PERF
+/**
+ * icmd_perf - Parse 'perf' command to display the timings - Implements ICommand::parse()
+ *
+ * `:perf reset` zeroes the timings.
+ */
+static enum CommandResult icmd_perf(struct Buffer *buf, struct Buffer *s,
+                                    intptr_t data, struct Buffer *err)
+{
+  if (MoreArgs(s))
+  {
+    mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
+    if (!mutt_str_equal(buf->data, "reset") || MoreArgs(s))
+    {
+      mutt_buffer_printf(err, _("%s: too many arguments"), "perf");
+      return MUTT_CMD_WARNING;
+    }
+
+    perf_reset();
+    mutt_message(_("Timings reset"));
+    return MUTT_CMD_SUCCESS;
+  }
+
+  char tempfile[PATH_MAX];
+  mutt_mktemp(tempfile, sizeof(tempfile));
+
+  FILE *fp_out = mutt_file_fopen(tempfile, "w");
+  if (!fp_out)
+  {
+    // L10N: '%s' is the file name of the temporary file
+    mutt_buffer_printf(err, _("Could not create temporary file %s"), tempfile);
+    return MUTT_CMD_ERROR;
+  }
+
+  perf_dump(fp_out);
+  fputs("\n", fp_out);
+  mutt_socket_stats_dump(fp_out);
+  mutt_file_fclose(&fp_out);
+
+  if (mutt_do_pager("perf", tempfile, MUTT_PAGER_NO_FLAGS, NULL) == -1)
+  {
+    // L10N: '%s' is the file name of the temporary file
+    mutt_buffer_printf(err, _("Could not create temporary file %s"), tempfile);
+    return MUTT_CMD_ERROR;
+  }
+
+  return MUTT_CMD_SUCCESS;
+}
+#endif
+
 /**
  * icmd_set - Parse 'set' command to display config - Implements ICommand::parse()
  */
@@ -46,11 +46,13 @@ void imap_adata_free(void **ptr)
 
   FREE(&adata->capstr);
   mutt_buffer_dealloc(&adata->cmdbuf);
+  MEM_ACCOUNT(MEM_TAG_IMAP, -(long) adata->blen, 0);
   FREE(&adata->buf);
   FREE(&adata->cmds);
 
   if (adata->conn)
   {
+    imap_monitor_remove(adata);
     if (adata->conn->close)
       adata->conn->close(adata->conn);
     FREE(&adata->conn);
@@ -67,13 +69,17 @@ struct ImapAccountData *imap_adata_new(struct Account *a)
 {
   struct ImapAccountData *adata = mutt_mem_calloc(1, sizeof(struct ImapAccountData));
   adata->account = a;
+  adata->monitor_fd = -1;
 
   static unsigned char new_seqid = 'a';
 
   adata->seqid = new_seqid;
   const short c_imap_pipeline_depth =
       cs_subset_number(NeoMutt->sub, "imap_pipeline_depth");
-  adata->cmdslots = c_imap_pipeline_depth + 2;
+  /* The pipeline starts at the configured depth and may grow while the
+   * server keeps up with it, see cmd_queue() */
+  adata->cmdwindow = c_imap_pipeline_depth + 1;
+  adata->cmdslots = (c_imap_pipeline_depth * IMAP_PIPELINE_GROWTH) + 2;
   adata->cmds = mutt_mem_calloc(adata->cmdslots, sizeof(*adata->cmds));
 
   if (++new_seqid > 'z')
@@ -24,6 +24,7 @@
 #define MUTT_IMAP_ADATA_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <time.h>
 #include "private.h" // IWYU pragma: keep
 #include "mutt/lib.h"
@@ -40,6 +41,7 @@ struct ImapAccountData
 {
   struct Connection *conn;
   bool recovering;
+  bool login_deferred; ///< $imap_open_cached put off logging in
   bool closing; ///< If true, we are waiting for CLOSE completion
   unsigned char state;  ///< ImapState, e.g. #IMAP_AUTHENTICATED
   unsigned char status; ///< ImapFlags, e.g. #IMAP_FATAL
@@ -61,6 +63,8 @@ struct ImapAccountData
 
   bool unicode; ///< If true, we can send UTF-8, and the server will use UTF8 rather than mUTF7
   bool qresync; ///< true, if QRESYNC is successfully ENABLE'd
+  bool notify;  ///< true, if NOTIFY SET was accepted
+  int monitor_fd; ///< Socket watched while waiting for a key, or -1
 
   // if set, the response parser will store results for complicated commands here
   struct ImapList *cmdresult;
@@ -68,9 +72,12 @@ struct ImapAccountData
   /* command queue */
   struct ImapCommand *cmds;
   int cmdslots;
+  int cmdwindow;          ///< Number of commands that may be in progress
   int nextcmd;
   int lastcmd;
   struct Buffer cmdbuf;
+  unsigned int cmdstalls; ///< Number of times the pipeline was full
+  uint64_t cmdlatency;    ///< Smoothed time to complete a command, in milliseconds
 
   char delim;
   struct Mailbox *mailbox;      ///< Current selected mailbox
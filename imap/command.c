@@ -44,6 +44,7 @@
 #include "email/lib.h"
 #include "core/lib.h"
 #include "conn/lib.h"
+#include "debug/lib.h"
 #include "adata.h"
 #include "edata.h"
 #include "init.h"
@@ -81,9 +82,49 @@ static const char *const Capabilities[] = {
   "LIST-EXTENDED",
   "COMPRESS=DEFLATE",
   "X-GM-EXT-1",
+  "NOTIFY",
+  "LITERAL+",
+  "LITERAL-",
   NULL,
 };
 
+/**
+ * cmd_handle_fatal - When ImapAccountData is in fatal state, do what we can
+ * @param adata Imap Account data
+ */
+static void cmd_handle_fatal(struct ImapAccountData *adata)
+{
+  /* Nothing has been sent, imap_mbox_reconcile() will connect */
+  if (adata->login_deferred)
+    return;
+
+  adata->status = IMAP_FATAL;
+
+  if (!adata->mailbox)
+    return;
+
+  struct ImapMboxData *mdata = adata->mailbox->mdata;
+
+  if ((adata->state >= IMAP_SELECTED) && (mdata->reopen & IMAP_REOPEN_ALLOW))
+  {
+    mx_fastclose_mailbox(adata->mailbox);
+    imap_monitor_remove(adata);
+    mutt_socket_close(adata->conn);
+    mutt_error(_("Mailbox %s@%s closed"), adata->conn->account.user,
+               adata->conn->account.host);
+    adata->state = IMAP_DISCONNECTED;
+  }
+
+  imap_close_connection(adata);
+  if (!adata->recovering)
+  {
+    adata->recovering = true;
+    if (imap_login(adata))
+      mutt_clear_error();
+    adata->recovering = false;
+  }
+}
+
 /**
  * cmd_queue_full - Is the IMAP command queue full?
  * @param adata Imap Account data
@@ -91,7 +132,8 @@ static const char *const Capabilities[] = {
  */
 static bool cmd_queue_full(struct ImapAccountData *adata)
 {
-  if (((adata->nextcmd + 1) % adata->cmdslots) == adata->lastcmd)
+  const int used = (adata->nextcmd - adata->lastcmd + adata->cmdslots) % adata->cmdslots;
+  if ((used >= adata->cmdwindow) || (used >= (adata->cmdslots - 1)))
     return true;
 
   return false;
@@ -121,72 +163,113 @@ static struct ImapCommand *cmd_new(struct ImapAccountData *adata)
     adata->seqno = 0;
 
   cmd->state = IMAP_RES_NEW;
+  cmd->queued = mutt_date_epoch_ms();
+  cmd->sent = 0;
 
   return cmd;
 }
 
 /**
- * cmd_queue - Add a IMAP command to the queue
+ * cmd_wait_slot - Wait for a command in the pipeline to finish
  * @param adata Imap Account data
- * @param cmdstr Command string
- * @param flags  Server flags, see #ImapCmdFlags
+ * @param flags Command flags, see #ImapCmdFlags
  * @retval  0 Success
  * @retval <0 Failure, e.g. #IMAP_RES_BAD
  *
- * If the queue is full, attempts to drain it.
+ * Any queued commands are sent, then the responses are read until the oldest
+ * command has finished.  The rest of the pipeline keeps the server busy.
+ *
+ * The pipeline was too short to cover the round trip, so it's made one
+ * command longer, up to #IMAP_PIPELINE_GROWTH times `$imap_pipeline_depth`.
  */
-static int cmd_queue(struct ImapAccountData *adata, const char *cmdstr, ImapCmdFlags flags)
+static int cmd_wait_slot(struct ImapAccountData *adata, ImapCmdFlags flags)
 {
-  if (cmd_queue_full(adata))
-  {
-    mutt_debug(LL_DEBUG3, "Draining IMAP command pipeline\n");
+  int rc;
 
-    const int rc = imap_exec(adata, NULL, flags & IMAP_CMD_POLL);
+  adata->cmdstalls++;
+  mutt_debug(LL_DEBUG3, "IMAP command pipeline full, window %d\n", adata->cmdwindow);
 
-    if (rc == IMAP_EXEC_ERROR)
-      return IMAP_RES_BAD;
+  if (!mutt_buffer_is_empty(&adata->cmdbuf) && (imap_cmd_start(adata, NULL) < 0))
+  {
+    cmd_handle_fatal(adata);
+    return IMAP_RES_BAD;
   }
 
-  struct ImapCommand *cmd = cmd_new(adata);
-  if (!cmd)
+  const short c_imap_poll_timeout =
+      cs_subset_number(NeoMutt->sub, "imap_poll_timeout");
+  if ((flags & IMAP_CMD_POLL) && (c_imap_poll_timeout > 0) &&
+      ((mutt_socket_poll(adata->conn, c_imap_poll_timeout)) == 0))
+  {
+    mutt_error(_("Connection to %s timed out"), adata->conn->account.host);
+    cmd_handle_fatal(adata);
     return IMAP_RES_BAD;
+  }
 
-  if (mutt_buffer_add_printf(&adata->cmdbuf, "%s %s\r\n", cmd->seq, cmdstr) < 0)
+  mutt_sig_allow_interrupt(true);
+  do
+  {
+    rc = imap_cmd_step(adata);
+  } while ((rc == IMAP_RES_CONTINUE) && cmd_queue_full(adata));
+  mutt_sig_allow_interrupt(false);
+
+  if ((rc != IMAP_RES_CONTINUE) && (rc != IMAP_RES_OK))
     return IMAP_RES_BAD;
 
+  if (adata->cmdwindow < (adata->cmdslots - 1))
+    adata->cmdwindow++;
+
   return 0;
 }
 
 /**
- * cmd_handle_fatal - When ImapAccountData is in fatal state, do what we can
- * @param adata Imap Account data
+ * cmd_trace_name - Get the name of a command, for the trace
+ * @param cmd    Command
+ * @param cmdstr Command string, e.g. "UID FETCH 1:* (FLAGS)"
+ *
+ * Only the command's name is kept, e.g. "UID FETCH", not its arguments.
  */
-static void cmd_handle_fatal(struct ImapAccountData *adata)
+static void cmd_trace_name(struct ImapCommand *cmd, const char *cmdstr)
 {
-  adata->status = IMAP_FATAL;
+  size_t len = strcspn(cmdstr, " ");
+  if (mutt_istrn_equal(cmdstr, "UID ", 4))
+    len = 4 + strcspn(cmdstr + 4, " ");
 
-  if (!adata->mailbox)
-    return;
-
-  struct ImapMboxData *mdata = adata->mailbox->mdata;
+  mutt_strn_copy(cmd->name, cmdstr, len, sizeof(cmd->name));
+}
 
-  if ((adata->state >= IMAP_SELECTED) && (mdata->reopen & IMAP_REOPEN_ALLOW))
+/**
+ * cmd_queue - Add a IMAP command to the queue
+ * @param adata Imap Account data
+ * @param cmdstr Command string
+ * @param flags  Server flags, see #ImapCmdFlags
+ * @retval  0 Success
+ * @retval <0 Failure, e.g. #IMAP_RES_BAD
+ *
+ * If the queue is full, waits for the oldest command to finish.
+ */
+static int cmd_queue(struct ImapAccountData *adata, const char *cmdstr, ImapCmdFlags flags)
+{
+  if (cmd_queue_full(adata))
   {
-    mx_fastclose_mailbox(adata->mailbox);
-    mutt_socket_close(adata->conn);
-    mutt_error(_("Mailbox %s@%s closed"), adata->conn->account.user,
-               adata->conn->account.host);
-    adata->state = IMAP_DISCONNECTED;
+    const int rc = cmd_wait_slot(adata, flags & IMAP_CMD_POLL);
+    if (rc < 0)
+      return rc;
   }
 
-  imap_close_connection(adata);
-  if (!adata->recovering)
+  struct ImapCommand *cmd = cmd_new(adata);
+  if (!cmd)
+    return IMAP_RES_BAD;
+
+  if (mutt_buffer_add_printf(&adata->cmdbuf, "%s %s\r\n", cmd->seq, cmdstr) < 0)
+    return IMAP_RES_BAD;
+
+  if (TraceEnabled)
   {
-    adata->recovering = true;
-    if (imap_login(adata))
-      mutt_clear_error();
-    adata->recovering = false;
+    cmd_trace_name(cmd, cmdstr);
+    trace_async_begin("imap", cmd->name, cmd->seq, NULL);
   }
+
+  return 0;
 }
 
 /**
@@ -201,6 +284,9 @@ static int cmd_start(struct ImapAccountData *adata, const char *cmdstr, ImapCmdF
 {
   int rc;
 
+  if (imap_login_deferred(adata) < 0)
+    return -1;
+
   if (adata->status == IMAP_FATAL)
   {
     cmd_handle_fatal(adata);
@@ -220,6 +306,14 @@ static int cmd_start(struct ImapAccountData *adata, const char *cmdstr, ImapCmdF
                           (flags & IMAP_CMD_PASS) ? IMAP_LOG_PASS : IMAP_LOG_CMD);
   mutt_buffer_reset(&adata->cmdbuf);
 
+  /* Start the round trip clocks of the commands that have just been sent */
+  const uint64_t now = mutt_date_monotonic_us();
+  for (int c = adata->lastcmd; c != adata->nextcmd; c = (c + 1) % adata->cmdslots)
+  {
+    if ((adata->cmds[c].state == IMAP_RES_NEW) && (adata->cmds[c].sent == 0))
+      adata->cmds[c].sent = now;
+  }
+
   /* unidle when command queue is flushed */
   if (adata->state == IMAP_IDLE)
     adata->state = IMAP_SELECTED;
@@ -271,9 +365,7 @@ static void cmd_parse_expunge(struct ImapAccountData *adata, const char *s)
   e = imap_msn_get(&mdata->msn, exp_msn - 1);
   if (e)
   {
-    /* imap_expunge_mailbox() will rewrite e->index.
-     * It needs to resort using SORT_ORDER anyway, so setting to INT_MAX
-     * makes the code simpler and possibly more efficient. */
+    /* Mark the Email for imap_expunge_mailbox(), which removes it in place */
     e->index = INT_MAX;
     imap_edata_get(e)->msn = 0;
   }
@@ -342,9 +434,7 @@ static void cmd_parse_vanished(struct ImapAccountData *adata, char *s)
 
     unsigned int exp_msn = imap_edata_get(e)->msn;
 
-    /* imap_expunge_mailbox() will rewrite e->index.
-     * It needs to resort using SORT_ORDER anyway, so setting to INT_MAX
-     * makes the code simpler and possibly more efficient. */
+    /* Mark the Email for imap_expunge_mailbox(), which removes it in place */
     e->index = INT_MAX;
     imap_edata_get(e)->msn = 0;
 
@@ -848,6 +938,9 @@ static void cmd_parse_status(struct ImapAccountData *adata, char *s)
   }
   uint32_t olduv = mdata->uidvalidity;
   unsigned int oldun = mdata->uid_next;
+  unsigned int oldmessages = mdata->messages;
+  unsigned int oldrecent = mdata->recent;
+  bool have_unseen = false;
 
   if (*s++ != '(')
   {
@@ -876,12 +969,28 @@ static void cmd_parse_status(struct ImapAccountData *adata, char *s)
     else if (mutt_str_startswith(s, "UIDVALIDITY"))
       mdata->uidvalidity = count;
     else if (mutt_str_startswith(s, "UNSEEN"))
+    {
       mdata->unseen = count;
+      have_unseen = true;
+    }
 
     s = value;
     if ((s[0] != '\0') && (*s != ')'))
       s = imap_next_word(s);
   }
+  /* A NOTIFY event only says that the mailbox has changed.  Without the
+   * UNSEEN count, it can't be used to check for new mail, so ask again. */
+  if (mdata->notify && !have_unseen)
+  {
+    mutt_debug(LL_DEBUG3, "NOTIFY: %s has changed\n", mdata->name);
+    mdata->uidvalidity = olduv;
+    mdata->uid_next = oldun;
+    mdata->messages = oldmessages;
+    mdata->recent = oldrecent;
+    mdata->notify_stale = true;
+    return;
+  }
+
   mutt_debug(LL_DEBUG3, "%s (UIDVALIDITY: %u, UIDNEXT: %u) %d messages, %d recent, %d unseen\n",
              mdata->name, mdata->uidvalidity, mdata->uid_next, mdata->messages,
              mdata->recent, mdata->unseen);
@@ -989,8 +1098,6 @@ static int cmd_handle_untagged(struct ImapAccountData *adata)
   char *s = imap_next_word(adata->buf);
   char *pn = imap_next_word(s);
 
-  const bool c_imap_server_noise =
-      cs_subset_bool(NeoMutt->sub, "imap_server_noise");
   if ((adata->state >= IMAP_SELECTED) && isdigit((unsigned char) *s))
   {
     /* pn vs. s: need initial seqno */
@@ -1042,7 +1149,8 @@ static int cmd_handle_untagged(struct ImapAccountData *adata)
 
     return -1;
   }
-  else if (c_imap_server_noise && mutt_istr_startswith(s, "NO"))
+  else if (mutt_istr_startswith(s, "NO") &&
+           cs_subset_bool(NeoMutt->sub, "imap_server_noise"))
   {
     mutt_debug(LL_DEBUG2, "Handling untagged NO\n");
 
@@ -1078,9 +1186,13 @@ int imap_cmd_start(struct ImapAccountData *adata, const char *cmdstr)
  */
 int imap_cmd_step(struct ImapAccountData *adata)
 {
+  PERF_SCOPE("imap_cmd_step");
+
   if (!adata)
     return -1;
 
+  TRACE_SCOPE("imap", "imap_cmd_step", NULL);
+
   size_t len = 0;
   int c;
   int rc;
@@ -1099,8 +1211,11 @@ int imap_cmd_step(struct ImapAccountData *adata)
   {
     if (len == adata->blen)
     {
-      mutt_mem_realloc(&adata->buf, adata->blen + IMAP_CMD_BUFSIZE);
-      adata->blen = adata->blen + IMAP_CMD_BUFSIZE;
+      /* double the buffer, so a very long line is only copied a few times */
+      const size_t blen = MAX(adata->blen * 2, IMAP_CMD_BUFSIZE);
+      mutt_mem_realloc(&adata->buf, blen);
+      MEM_ACCOUNT(MEM_TAG_IMAP, blen - adata->blen, 0);
+      adata->blen = blen;
       mutt_debug(LL_DEBUG3, "grew buffer to %lu bytes\n", adata->blen);
     }
 
@@ -1122,10 +1237,12 @@ int imap_cmd_step(struct ImapAccountData *adata)
    * one character free when we've read a full line) */
   while (len == adata->blen);
 
-  /* don't let one large string make cmd->buf hog memory forever */
-  if ((adata->blen > IMAP_CMD_BUFSIZE) && (len <= IMAP_CMD_BUFSIZE))
+  /* don't let one large string make cmd->buf hog memory forever, but don't
+   * keep resizing it for lines that are only a little long */
+  if ((adata->blen > (IMAP_CMD_BUFSIZE * 8)) && (len <= IMAP_CMD_BUFSIZE))
   {
     mutt_mem_realloc(&adata->buf, IMAP_CMD_BUFSIZE);
+    MEM_ACCOUNT(MEM_TAG_IMAP, -(long) (adata->blen - IMAP_CMD_BUFSIZE), 0);
     adata->blen = IMAP_CMD_BUFSIZE;
     mutt_debug(LL_DEBUG3, "shrank buffer to %lu bytes\n", adata->blen);
   }
@@ -1174,6 +1291,25 @@ int imap_cmd_step(struct ImapAccountData *adata)
         {
           mutt_message(_("IMAP command failed: %s"), adata->buf);
         }
+        /* Some servers can't cope with a deep pipeline */
+        if ((cmd->state == IMAP_RES_BAD) && (adata->cmdwindow > 1))
+          adata->cmdwindow /= 2;
+
+        if (TraceEnabled)
+        {
+          const char *status = (cmd->state == IMAP_RES_OK) ? "OK" :
+                               (cmd->state == IMAP_RES_NO) ? "NO" : "BAD";
+          trace_async_end("imap", cmd->name, cmd->seq, status);
+        }
+
+        if (cmd->sent != 0)
+          mutt_socket_rtt(adata->conn, mutt_date_monotonic_us() - cmd->sent);
+
+        const uint64_t latency = mutt_date_epoch_ms() - cmd->queued;
+        if (adata->cmdlatency == 0)
+          adata->cmdlatency = latency;
+        else
+          adata->cmdlatency = ((adata->cmdlatency * 7) + latency) / 8;
       }
       else
         stillrunning++;
@@ -1182,6 +1318,13 @@ int imap_cmd_step(struct ImapAccountData *adata)
     c = (c + 1) % adata->cmdslots;
   } while (c != adata->nextcmd);
 
+  /* Free the slots of any commands that finished out of order */
+  while ((adata->lastcmd != adata->nextcmd) &&
+         (adata->cmds[adata->lastcmd].state != IMAP_RES_NEW))
+  {
+    adata->lastcmd = (adata->lastcmd + 1) % adata->cmdslots;
+  }
+
   if (stillrunning)
     rc = IMAP_RES_CONTINUE;
   else
@@ -1411,6 +1554,7 @@ int imap_cmd_idle(struct ImapAccountData *adata)
     adata->state = IMAP_IDLE;
     /* queue automatic exit when next command is issued */
     mutt_buffer_addstr(&adata->cmdbuf, "DONE\r\n");
+    imap_monitor_add(adata);
     rc = IMAP_RES_OK;
   }
   if (rc != IMAP_RES_OK)
@@ -84,18 +84,36 @@ static struct ConfigDef ImapVars[] = {
   { "imap_fetch_chunk_size", DT_LONG|DT_NOT_NEGATIVE, 0, 0, NULL,
     "(imap) Download headers in blocks of this size"
   },
+  { "imap_fetch_chunk_time", DT_NUMBER|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap) Size the blocks of headers to download in this many milliseconds"
+  },
+  { "imap_fetch_connections", DT_NUMBER|DT_NOT_NEGATIVE, 1, 0, NULL,
+    "(imap) Number of connections used to download headers"
+  },
+  { "imap_fetch_partial_size", DT_LONG|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap) Display large messages without downloading their attachments"
+  },
   { "imap_headers", DT_STRING|R_INDEX, 0, 0, NULL,
     "(imap) Additional email headers to download when getting index"
   },
   { "imap_idle", DT_BOOL, false, 0, NULL,
     "(imap) Use the IMAP IDLE extension to check for new mail"
   },
+  { "imap_idle_mailboxes", DT_SLIST|SLIST_SEP_COMMA, 0, 0, NULL,
+    "(imap) Watch these mailboxes with IDLE, each on its own connection"
+  },
   { "imap_login", DT_STRING|DT_SENSITIVE, 0, 0, NULL,
     "(imap) Login name for the IMAP server (defaults to `$imap_user`)"
   },
+  { "imap_notify", DT_BOOL, false, 0, NULL,
+    "(imap) Use the IMAP NOTIFY extension instead of polling for new mail"
+  },
   { "imap_oauth_refresh_command", DT_STRING|DT_COMMAND|DT_SENSITIVE, 0, 0, NULL,
     "(imap) External command to generate OAUTH refresh token"
   },
+  { "imap_open_cached", DT_BOOL, false, 0, NULL,
+    "(imap) Show a mailbox from the header cache while connecting to the server"
+  },
   { "imap_pass", DT_STRING|DT_SENSITIVE, 0, 0, NULL,
     "(imap) Password for the IMAP server"
   },
@@ -123,6 +141,9 @@ static struct ConfigDef ImapVars[] = {
   { "imap_poll_timeout", DT_NUMBER|DT_NOT_NEGATIVE, 15, 0, NULL,
     "(imap) Maximum time to wait for a server response"
   },
+  { "imap_prefetch", DT_NUMBER|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap) Download this many of the following messages while idle"
+  },
   { "imap_qresync", DT_BOOL, false, 0, NULL,
     "(imap) Enable the QRESYNC extension"
   },
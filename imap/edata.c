@@ -45,6 +45,7 @@ void imap_edata_free(void **ptr)
   FREE(&edata->flags_system);
   FREE(&edata->flags_remote);
   FREE(ptr);
+  MEM_ACCOUNT(MEM_TAG_IMAP, -(long) sizeof(struct ImapEmailData), -1);
 }
 
 /**
@@ -53,6 +54,7 @@ void imap_edata_free(void **ptr)
  */
 struct ImapEmailData *imap_edata_new(void)
 {
+  MEM_ACCOUNT(MEM_TAG_IMAP, sizeof(struct ImapEmailData), 1);
   return mutt_mem_calloc(1, sizeof(struct ImapEmailData));
 }
 
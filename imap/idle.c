@@ -0,0 +1,440 @@
+/**
+ * @file
+ * Watch IMAP Mailboxes with IDLE
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page imap_idle Watch IMAP Mailboxes with IDLE
+ *
+ * The Account's connection can only IDLE on the selected Mailbox.  Each of the
+ * Mailboxes in `$imap_idle_mailboxes` is watched by an extra connection, which
+ * examines the Mailbox, then waits in IDLE.
+ *
+ * When the server reports a change, the Mailbox is marked as stale and checked
+ * straight away.  The STATUS is still fetched by the Account's connection, so
+ * the counts are kept in one place.  Until something changes, the Mailbox
+ * isn't polled.
+ *
+ * The extra connections aren't needed if the server has accepted NOTIFY.
+ */
+
+#include "config.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include "private.h"
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "conn/lib.h"
+#include "lib.h"
+#include "adata.h"
+#include "mdata.h"
+#include "mutt_mailbox.h"
+#include "mutt_socket.h"
+#include "muttlib.h"
+#ifdef USE_INOTIFY
+#include "monitor.h"
+#endif
+
+/// Seconds to wait before trying to watch a Mailbox again
+#define IMAP_IDLE_RETRY 300
+
+/**
+ * struct ImapIdle - An extra connection, watching a Mailbox with IDLE
+ */
+struct ImapIdle
+{
+  struct ImapAccountData *adata; ///< Connection to the server
+  struct Mailbox *mailbox;       ///< Mailbox being watched
+  bool failed;                   ///< The connection has failed
+};
+
+/**
+ * idle_wanted - Should a Mailbox be watched?
+ * @param m     Mailbox
+ * @param mdata Imap Mailbox data
+ * @retval true The Mailbox is listed in `$imap_idle_mailboxes`
+ */
+static bool idle_wanted(struct Mailbox *m, struct ImapMboxData *mdata)
+{
+  const struct Slist *c_imap_idle_mailboxes =
+      cs_subset_slist(NeoMutt->sub, "imap_idle_mailboxes");
+  if (!c_imap_idle_mailboxes)
+    return false;
+
+  bool found = false;
+  struct Buffer *buf = mutt_buffer_pool_get();
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &c_imap_idle_mailboxes->head, entries)
+  {
+    if (mutt_str_equal(np->data, mdata->name))
+    {
+      found = true;
+      break;
+    }
+
+    mutt_buffer_strcpy(buf, np->data);
+    mutt_buffer_expand_path(buf);
+    mutt_buffer_alloc(buf, PATH_MAX);
+    if ((imap_path_canon(buf->data, buf->dsize) == 0) &&
+        mutt_str_equal(buf->data, mailbox_path(m)))
+    {
+      found = true;
+      break;
+    }
+  }
+  mutt_buffer_pool_release(&buf);
+  return found;
+}
+
+/**
+ * idle_changed - Does a response report a change to the Mailbox?
+ * @param s Response from the server
+ * @retval true The response is EXISTS, EXPUNGE, FETCH, etc
+ */
+static bool idle_changed(const char *s)
+{
+  if (!mutt_str_startswith(s, "* "))
+    return false;
+
+  s += 2;
+  return isdigit((unsigned char) *s) || mutt_istr_startswith(s, "VANISHED");
+}
+
+/**
+ * idle_stale - Check a Mailbox soon
+ * @param idle Extra connection
+ */
+static void idle_stale(struct ImapIdle *idle)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(idle->mailbox);
+  if (mdata)
+    mdata->notify_stale = true;
+  mutt_mailbox_check_soon(idle->mailbox);
+}
+
+/**
+ * idle_read - Read the responses that the server has sent
+ * @param idle Extra connection
+ * @retval true  Success
+ * @retval false The connection has failed
+ */
+static bool idle_read(struct ImapIdle *idle)
+{
+  if (idle->failed)
+    return false;
+
+  struct ImapAccountData *adata = idle->adata;
+  bool changed = false;
+  int rc;
+  while ((rc = mutt_socket_poll(adata->conn, 0)) > 0)
+  {
+    /* Only untagged responses are expected, the IDLE hasn't been ended */
+    if (imap_cmd_step(adata) != IMAP_RES_CONTINUE)
+    {
+      rc = -1;
+      break;
+    }
+    changed |= idle_changed(adata->buf);
+  }
+
+  if ((rc < 0) || (adata->status == IMAP_FATAL))
+  {
+    mutt_debug(LL_DEBUG1, "lost the IDLE connection for %s\n", mailbox_path(idle->mailbox));
+    idle->failed = true;
+    changed = true;
+  }
+
+  if (changed)
+    idle_stale(idle);
+
+  return !idle->failed;
+}
+
+#ifdef USE_INOTIFY
+/**
+ * idle_monitor_read - Read the server's responses while waiting for a key - Implements ::monitor_fd_t
+ */
+static bool idle_monitor_read(int fd, void *data)
+{
+  struct ImapIdle *idle = data;
+  if (!idle->adata->conn || (idle->adata->conn->fd != fd) || !idle_read(idle))
+  {
+    idle->adata->monitor_fd = -1;
+    return false;
+  }
+  return true;
+}
+#endif
+
+/**
+ * idle_enter - Ask the server to report changes to the Mailbox
+ * @param idle Extra connection
+ * @retval true Success
+ */
+static bool idle_enter(struct ImapIdle *idle)
+{
+  struct ImapAccountData *adata = idle->adata;
+  if (imap_cmd_start(adata, "IDLE") < 0)
+    return false;
+
+  const short c_imap_poll_timeout = cs_subset_number(NeoMutt->sub, "imap_poll_timeout");
+  if ((c_imap_poll_timeout > 0) && (mutt_socket_poll(adata->conn, c_imap_poll_timeout) == 0))
+    return false;
+
+  int rc;
+  do
+  {
+    rc = imap_cmd_step(adata);
+  } while (rc == IMAP_RES_CONTINUE);
+
+  if (rc != IMAP_RES_RESPOND)
+    return false;
+
+#ifdef USE_INOTIFY
+  adata->monitor_fd = adata->conn->fd;
+  mutt_monitor_fd_add(adata->monitor_fd, idle_monitor_read, idle);
+#endif
+  return true;
+}
+
+/**
+ * idle_leave - End the IDLE
+ * @param idle Extra connection
+ * @retval true Success
+ *
+ * Any changes that the server reports before it finishes are noted.
+ */
+static bool idle_leave(struct ImapIdle *idle)
+{
+  struct ImapAccountData *adata = idle->adata;
+  imap_monitor_remove(adata);
+
+  if (mutt_socket_send(adata->conn, "DONE\r\n") < 0)
+    return false;
+
+  bool changed = false;
+  int rc;
+  do
+  {
+    rc = imap_cmd_step(adata);
+    if (rc == IMAP_RES_CONTINUE)
+      changed |= idle_changed(adata->buf);
+  } while (rc == IMAP_RES_CONTINUE);
+
+  if (changed)
+    idle_stale(idle);
+
+  return (rc == IMAP_RES_OK);
+}
+
+/**
+ * idle_free - Log out and free an extra connection
+ * @param ptr Extra connection to free
+ */
+static void idle_free(struct ImapIdle **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct ImapIdle *idle = *ptr;
+  if (!idle->failed && idle_leave(idle))
+    imap_logout(idle->adata);
+
+  imap_adata_free((void **) &idle->adata);
+  FREE(ptr);
+}
+
+/**
+ * idle_start - Open an extra connection to watch a Mailbox
+ * @param adata Imap Account data
+ * @param m     Mailbox to watch
+ * @retval ptr  Connection, logged in and waiting in IDLE
+ * @retval NULL Error
+ *
+ * The connection is left in the authenticated state, so the untagged
+ * responses about the Mailbox are only read by idle_read().
+ */
+static struct ImapIdle *idle_start(struct ImapAccountData *adata, struct Mailbox *m)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  struct ImapIdle *idle = mutt_mem_calloc(1, sizeof(struct ImapIdle));
+  idle->mailbox = m;
+  idle->adata = imap_adata_new(NULL);
+  idle->adata->conn = mutt_conn_new(&adata->conn->account);
+  if (!idle->adata->conn || (imap_login(idle->adata) < 0))
+    goto fail;
+
+  if (!(idle->adata->capabilities & IMAP_CAP_IDLE))
+  {
+    imap_logout(idle->adata);
+    goto fail;
+  }
+
+  char buf[PATH_MAX];
+  snprintf(buf, sizeof(buf), "EXAMINE %s", mdata->munge_name);
+  if ((imap_exec(idle->adata, buf, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS) ||
+      !idle_enter(idle))
+  {
+    imap_logout(idle->adata);
+    goto fail;
+  }
+
+  mutt_debug(LL_DEBUG2, "watching %s with IDLE\n", mailbox_path(m));
+  return idle;
+
+fail:
+  mutt_debug(LL_DEBUG1, "can't watch %s with IDLE\n", mailbox_path(m));
+  imap_adata_free((void **) &idle->adata);
+  FREE(&idle);
+  return NULL;
+}
+
+/**
+ * idle_keepalive - Stop the server closing an idle connection
+ * @param idle Extra connection
+ *
+ * The IDLE is ended and started again, if nothing has been heard from the
+ * server for `$imap_keepalive` seconds.
+ */
+static void idle_keepalive(struct ImapIdle *idle)
+{
+  const short c_imap_keepalive = cs_subset_number(NeoMutt->sub, "imap_keepalive");
+  if (idle->failed || (mutt_date_epoch() < (idle->adata->lastread + c_imap_keepalive)))
+    return;
+
+  if (!idle_leave(idle) || !idle_enter(idle))
+  {
+    mutt_debug(LL_DEBUG1, "lost the IDLE connection for %s\n", mailbox_path(idle->mailbox));
+    idle->failed = true;
+    idle_stale(idle);
+  }
+}
+
+/**
+ * imap_idle_free - Stop watching a Mailbox
+ * @param mdata Imap Mailbox data
+ */
+void imap_idle_free(struct ImapMboxData *mdata)
+{
+  if (mdata)
+    idle_free(&mdata->idle);
+}
+
+/**
+ * imap_idle_watch - Watch a Mailbox with IDLE, if configured
+ * @param adata Imap Account data
+ * @param m     Mailbox that's just been checked
+ *
+ * An extra connection is opened for a Mailbox in `$imap_idle_mailboxes`,
+ * unless the Mailbox is selected, or the server reports changes with NOTIFY.
+ * If the connection fails, it's opened again after #IMAP_IDLE_RETRY seconds.
+ */
+void imap_idle_watch(struct ImapAccountData *adata, struct Mailbox *m)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (!adata || !adata->conn || !mdata)
+    return;
+
+  if ((adata->state < IMAP_AUTHENTICATED) || adata->notify ||
+      !(adata->capabilities & IMAP_CAP_IDLE) || (adata->mailbox == m) ||
+      !idle_wanted(m, mdata))
+  {
+    idle_free(&mdata->idle);
+    return;
+  }
+
+  const time_t now = mutt_date_epoch();
+  if (mdata->idle)
+  {
+    if (idle_read(mdata->idle))
+      idle_keepalive(mdata->idle);
+    if (!mdata->idle->failed)
+      return;
+
+    idle_free(&mdata->idle);
+    mdata->idle_retry = now + IMAP_IDLE_RETRY;
+    return;
+  }
+
+  if (now < mdata->idle_retry)
+    return;
+
+  mdata->idle = idle_start(adata, m);
+  if (!mdata->idle)
+  {
+    mdata->idle_retry = now + IMAP_IDLE_RETRY;
+    return;
+  }
+
+  /* Catch any changes made before the IDLE started */
+  mdata->notify_stale = true;
+}
+
+/**
+ * imap_idle_fresh - Are a Mailbox's counts up to date?
+ * @param mdata Imap Mailbox data
+ * @retval true An extra connection is watching the Mailbox, and it hasn't changed
+ */
+bool imap_idle_fresh(struct ImapMboxData *mdata)
+{
+  if (!mdata || !mdata->idle || !idle_read(mdata->idle))
+    return false;
+
+  return !mdata->notify_stale;
+}
+
+/**
+ * imap_idle_keepalive - Stop the server closing the extra connections
+ * @param adata Imap Account data
+ */
+void imap_idle_keepalive(struct ImapAccountData *adata)
+{
+  if (!adata || !adata->account)
+    return;
+
+  struct MailboxNode *np = NULL;
+  STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+  {
+    struct ImapMboxData *mdata = imap_mdata_get(np->mailbox);
+    if (mdata && mdata->idle && idle_read(mdata->idle))
+      idle_keepalive(mdata->idle);
+  }
+}
+
+/**
+ * imap_idle_logout - Close the extra connections of an Account
+ * @param adata Imap Account data
+ */
+void imap_idle_logout(struct ImapAccountData *adata)
+{
+  if (!adata || !adata->account)
+    return;
+
+  struct MailboxNode *np = NULL;
+  STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+  {
+    imap_idle_free(imap_mdata_get(np->mailbox));
+  }
+}
@@ -59,8 +59,12 @@
 #include "mutt_socket.h"
 #include "muttlib.h"
 #include "mx.h"
+#include "options.h"
 #include "progress.h"
 #include "sort.h"
+#ifdef USE_INOTIFY
+#include "monitor.h"
+#endif
 #ifdef ENABLE_NLS
 #include <libintl.h>
 #endif
@@ -188,7 +192,8 @@ static void set_flag(struct Mailbox *m, AclFlags aclflag, bool flag,
  * @param[out] pos     Cursor used for multiple calls to this function
  * @retval num Messages in the set
  *
- * @note Headers must be in #SORT_ORDER. See imap_exec_msgset() for args.
+ * The messages are taken in MSN order, which is also UID order, so the
+ * Mailbox doesn't need to be sorted.  See imap_exec_msgset() for args.
  * Pos is an opaque pointer a la strtok(). It should be 0 at first call.
  */
 static int make_msg_set(struct Mailbox *m, struct Buffer *buf,
@@ -196,18 +201,21 @@ static int make_msg_set(struct Mailbox *m, struct Buffer *buf,
 {
   int count = 0;             /* number of messages in message set */
   unsigned int setstart = 0; /* start of current message range */
+  unsigned int setend = 0;   /* end of current message range */
   int n;
   bool started = false;
 
   struct ImapAccountData *adata = imap_adata_get(m);
-  if (!adata || (adata->mailbox != m))
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (!adata || !mdata || (adata->mailbox != m))
     return -1;
 
-  for (n = *pos; (n < m->msg_count) && (mutt_buffer_len(buf) < IMAP_MAX_CMDLEN); n++)
+  const int max_msn = imap_msn_highest(&mdata->msn);
+  for (n = *pos; (n < max_msn) && (mutt_buffer_len(buf) < IMAP_MAX_CMDLEN); n++)
   {
-    struct Email *e = m->emails[n];
+    struct Email *e = imap_msn_get(&mdata->msn, n);
     if (!e)
-      break;
+      continue;
     bool match = false; /* whether current message matches flag condition */
     /* don't include pending expunged messages.
      *
@@ -253,33 +261,28 @@ static int make_msg_set(struct Mailbox *m, struct Buffer *buf,
     if (match && (!changed || e->changed))
     {
       count++;
+      setend = imap_edata_get(e)->uid;
       if (setstart == 0)
       {
-        setstart = imap_edata_get(e)->uid;
-        if (started)
-        {
-          mutt_buffer_add_printf(buf, ",%u", imap_edata_get(e)->uid);
-        }
-        else
-        {
-          mutt_buffer_add_printf(buf, "%u", imap_edata_get(e)->uid);
-          started = true;
-        }
+        setstart = setend;
+        mutt_buffer_add_printf(buf, started ? ",%u" : "%u", setstart);
+        started = true;
       }
-      /* tie up if the last message also matches */
-      else if (n == (m->msg_count - 1))
-        mutt_buffer_add_printf(buf, ":%u", imap_edata_get(e)->uid);
     }
-    /* End current set if message doesn't match or we've reached the end
-     * of the mailbox via inactive messages following the last match. */
-    else if (setstart && (e->active || (n == adata->mailbox->msg_count - 1)))
+    /* End current set if an active message doesn't match.
+     * Inactive messages don't break a range. */
+    else if (setstart && e->active)
     {
-      if (imap_edata_get(m->emails[n - 1])->uid > setstart)
-        mutt_buffer_add_printf(buf, ":%u", imap_edata_get(m->emails[n - 1])->uid);
+      if (setend > setstart)
+        mutt_buffer_add_printf(buf, ":%u", setend);
       setstart = 0;
     }
   }
 
+  /* tie up the last range */
+  if (setstart && (setend > setstart))
+    mutt_buffer_add_printf(buf, ":%u", setend);
+
   *pos = n;
 
   return count;
@@ -530,7 +533,7 @@ int imap_delete_mailbox(struct Mailbox *m, char *path)
  * imap_logout - Gracefully log out of server
  * @param adata Imap Account data
  */
-static void imap_logout(struct ImapAccountData *adata)
+void imap_logout(struct ImapAccountData *adata)
 {
   /* we set status here to let imap_handle_untagged know we _expect_ to
    * receive a bye response (so it doesn't freak out and close the conn) */
@@ -549,8 +552,7 @@ static void imap_logout(struct ImapAccountData *adata)
     while (imap_cmd_step(adata) == IMAP_RES_CONTINUE)
       ; // do nothing
   }
-  mutt_socket_close(adata->conn);
-  adata->state = IMAP_DISCONNECTED;
+  imap_close_connection(adata);
 }
 
 /**
@@ -570,6 +572,8 @@ void imap_logout_all(void)
     if (!adata)
       continue;
 
+    imap_idle_logout(adata);
+
     struct Connection *conn = adata->conn;
     if (!conn || (conn->fd < 0))
       continue;
@@ -645,6 +649,68 @@ int imap_read_literal(FILE *fp, struct ImapAccountData *adata,
   return 0;
 }
 
+/**
+ * imap_read_literal_buf - Read bytes bytes from server into a Buffer
+ * @param buf   Buffer for the literal, appended to
+ * @param adata Imap Account data
+ * @param bytes Number of bytes to read
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * The Buffer is grown, at most once, to fit the whole literal.  It's at least
+ * doubled in size, so a Buffer that's reused for many literals is rarely
+ * reallocated.
+ *
+ * @note Strips `\r` from `\r\n`, like imap_read_literal().
+ */
+int imap_read_literal_buf(struct Buffer *buf, struct ImapAccountData *adata,
+                          unsigned long bytes)
+{
+  char c;
+  bool r = false;
+
+  mutt_debug(LL_DEBUG2, "reading %ld bytes\n", bytes);
+
+  const size_t start = mutt_buffer_len(buf);
+  const size_t need = start + bytes + 1;
+  if (need > buf->dsize)
+    mutt_buffer_alloc(buf, MAX(need, buf->dsize * 2));
+
+  char *dptr = buf->data + start;
+  for (unsigned long pos = 0; pos < bytes; pos++)
+  {
+    if (mutt_socket_readchar(adata->conn, &c) != 1)
+    {
+      mutt_debug(LL_DEBUG1, "error during read, %ld bytes read\n", pos);
+      adata->status = IMAP_FATAL;
+      buf->dptr = dptr;
+      *dptr = '\0';
+      return -1;
+    }
+
+    if (r && (c != '\n'))
+      *dptr++ = '\r';
+
+    if (c == '\r')
+    {
+      r = true;
+      continue;
+    }
+    else
+      r = false;
+
+    *dptr++ = c;
+  }
+  buf->dptr = dptr;
+  *dptr = '\0';
+
+  const short c_debug_level = cs_subset_number(NeoMutt->sub, "debug_level");
+  if (c_debug_level >= IMAP_LOG_LTRL)
+    mutt_debug(IMAP_LOG_LTRL, "\n%s", buf->data + start);
+
+  return 0;
+}
+
 /**
  * imap_notify_delete_email - Inform IMAP that an Email has been deleted
  * @param m Mailbox
@@ -726,11 +792,14 @@ void imap_expunge_mailbox(struct Mailbox *m)
   }
 
 #ifdef USE_HCACHE
+  /* keep the cached UIDs in step with the server, for the next CONDSTORE open */
+  if (mdata->modseq)
+    imap_hcache_store_uid_seqset(mdata);
   imap_hcache_close(mdata);
 #endif
 
-  mailbox_changed(m, NT_MAILBOX_UPDATE);
-  mailbox_changed(m, NT_MAILBOX_RESORT);
+  /* The Emails are removed in place, without rethreading or resorting */
+  mailbox_changed(m, NT_MAILBOX_EXPUNGE);
 }
 
 /**
@@ -851,9 +920,14 @@ void imap_close_connection(struct ImapAccountData *adata)
 {
   if (adata->state != IMAP_DISCONNECTED)
   {
+    mutt_debug(LL_DEBUG2, "pipeline: window %d, %u stalls, latency %llu ms\n",
+               adata->cmdwindow, adata->cmdstalls,
+               (unsigned long long) adata->cmdlatency);
+    imap_monitor_remove(adata);
     mutt_socket_close(adata->conn);
     adata->state = IMAP_DISCONNECTED;
   }
+  adata->cmdstalls = 0;
   adata->seqno = 0;
   adata->nextcmd = 0;
   adata->lastcmd = 0;
@@ -895,17 +969,6 @@ bool imap_has_flag(struct ListHead *flag_list, const char *flag)
   return false;
 }
 
-/**
- * compare_uid - Compare two Emails by UID - Implements ::sort_t
- */
-static int compare_uid(const void *a, const void *b)
-{
-  const struct Email *ea = *(struct Email const *const *) a;
-  const struct Email *eb = *(struct Email const *const *) b;
-  return imap_edata_get((struct Email *) ea)->uid -
-         imap_edata_get((struct Email *) eb)->uid;
-}
-
 /**
  * imap_exec_msgset - Prepare commands for all messages matching conditions
  * @param m       Selected Imap Mailbox
@@ -928,28 +991,12 @@ int imap_exec_msgset(struct Mailbox *m, const char *pre, const char *post,
   if (!adata || (adata->mailbox != m))
     return -1;
 
-  struct Email **emails = NULL;
   int pos;
   int rc;
   int count = 0;
 
   struct Buffer cmd = mutt_buffer_make(0);
 
-  /* We make a copy of the headers just in case resorting doesn't give
-   exactly the original order (duplicate messages?), because other parts of
-   the ctx are tied to the header order. This may be overkill. */
-  const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
-  if (c_sort != SORT_ORDER)
-  {
-    emails = m->emails;
-    // We overcommit here, just in case new mail arrives whilst we're sync-ing
-    m->emails = mutt_mem_malloc(m->email_max * sizeof(struct Email *));
-    memcpy(m->emails, emails, m->email_max * sizeof(struct Email *));
-
-    cs_subset_str_native_set(NeoMutt->sub, "sort", SORT_ORDER, NULL);
-    qsort(m->emails, m->msg_count, sizeof(struct Email *), compare_uid);
-  }
-
   pos = 0;
 
   do
@@ -973,12 +1020,6 @@ int imap_exec_msgset(struct Mailbox *m, const char *pre, const char *post,
 
 out:
   mutt_buffer_dealloc(&cmd);
-  if (c_sort != SORT_ORDER)
-  {
-    cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
-    FREE(&m->emails);
-    m->emails = emails;
-  }
 
   return rc;
 }
@@ -995,6 +1036,9 @@ out:
  * Update the IMAP server to reflect the flags for a single message before
  * performing a "UID COPY".
  *
+ * The STORE is queued, so that the flags of many messages can be pipelined.
+ * It will be sent, at the latest, with the "UID COPY".
+ *
  * @note This does not sync the "deleted" flag state, because it is not
  *       desirable to propagate that flag into the copy.
  */
@@ -1073,7 +1117,7 @@ int imap_sync_message_for_copy(struct Mailbox *m, struct Email *e,
 
   /* after all this it's still possible to have no flags, if you
    * have no ACL rights */
-  if (*flags && (imap_exec(adata, cmd->data, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS) &&
+  if (*flags && (imap_exec(adata, cmd->data, IMAP_CMD_QUEUE) != IMAP_EXEC_SUCCESS) &&
       err_continue && (*err_continue != MUTT_YES))
   {
     *err_continue = imap_continue("imap_sync_message: STORE failed", adata->buf);
@@ -1091,6 +1135,170 @@ int imap_sync_message_for_copy(struct Mailbox *m, struct Email *e,
   return 0;
 }
 
+/**
+ * imap_notify_read - Read the changes that the server has sent
+ * @param adata Imap Account data
+ *
+ * With NOTIFY, the server may send untagged responses at any time.  Process
+ * any that are waiting, without sending a command.
+ */
+static void imap_notify_read(struct ImapAccountData *adata)
+{
+  if (!adata->notify || (adata->state < IMAP_AUTHENTICATED))
+    return;
+
+  /* Don't steal the responses to a command that's still running */
+  if ((adata->state != IMAP_IDLE) && (adata->lastcmd != adata->nextcmd))
+    return;
+
+  int rc;
+  while ((rc = mutt_socket_poll(adata->conn, 0)) > 0)
+  {
+    if (imap_cmd_step(adata) != IMAP_RES_CONTINUE)
+      break;
+  }
+
+  if (rc < 0)
+  {
+    mutt_debug(LL_DEBUG1, "Poll failed, disabling NOTIFY\n");
+    adata->notify = false;
+  }
+  else if (rc == 0)
+  {
+    imap_monitor_add(adata);
+  }
+}
+
+#ifdef USE_INOTIFY
+/**
+ * imap_monitor_read - Read the server's responses while waiting for a key - Implements ::monitor_fd_t
+ *
+ * Only the untagged responses of IDLE or NOTIFY are expected.
+ */
+static bool imap_monitor_read(int fd, void *data)
+{
+  struct ImapAccountData *adata = data;
+  bool read = false;
+
+  if (!adata->conn || (adata->conn->fd != fd))
+  {
+    read = false;
+  }
+  else if (adata->state == IMAP_IDLE)
+  {
+    int rc;
+    while ((rc = mutt_socket_poll(adata->conn, 0)) > 0)
+    {
+      if (imap_cmd_step(adata) != IMAP_RES_CONTINUE)
+        break;
+    }
+    read = (rc == 0);
+  }
+  else if (adata->notify && (adata->state >= IMAP_AUTHENTICATED) &&
+           (adata->lastcmd == adata->nextcmd))
+  {
+    imap_notify_read(adata);
+    read = adata->notify;
+  }
+
+  if (!read)
+    adata->monitor_fd = -1;
+  return read;
+}
+#endif
+
+/**
+ * imap_monitor_add - Read the server's responses while waiting for a key
+ * @param adata Imap Account data
+ *
+ * The socket is watched while the connection is idle, i.e. in IDLE, or with
+ * NOTIFY and no commands running, so changes are seen as soon as they arrive.
+ */
+void imap_monitor_add(struct ImapAccountData *adata)
+{
+#ifdef USE_INOTIFY
+  if (!adata || !adata->conn || (adata->conn->fd < 0))
+    return;
+
+  if ((adata->monitor_fd >= 0) && (adata->monitor_fd != adata->conn->fd))
+    mutt_monitor_fd_remove(adata->monitor_fd);
+  adata->monitor_fd = adata->conn->fd;
+  mutt_monitor_fd_add(adata->monitor_fd, imap_monitor_read, adata);
+#endif
+}
+
+/**
+ * imap_monitor_remove - Stop watching the connection
+ * @param adata Imap Account data
+ *
+ * This must be called before the socket is closed.
+ */
+void imap_monitor_remove(struct ImapAccountData *adata)
+{
+#ifdef USE_INOTIFY
+  if (!adata || (adata->monitor_fd < 0))
+    return;
+
+  mutt_monitor_fd_remove(adata->monitor_fd);
+  adata->monitor_fd = -1;
+#endif
+}
+
+/**
+ * imap_notify_set - Ask the server to report changes to the Mailboxes
+ * @param adata Imap Account data
+ *
+ * RFC5465: The server will send EXISTS, EXPUNGE and FETCH for the selected
+ * Mailbox and STATUS for the Account's other Mailboxes, as they change.
+ */
+static void imap_notify_set(struct ImapAccountData *adata)
+{
+  adata->notify = false;
+
+  const bool c_imap_notify = cs_subset_bool(NeoMutt->sub, "imap_notify");
+  if (!c_imap_notify || !(adata->capabilities & IMAP_CAP_NOTIFY) || !adata->account)
+    return;
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+  mutt_buffer_strcpy(buf, "NOTIFY SET (selected (MessageNew MessageExpunge FlagChange))");
+
+  int num = 0;
+  struct MailboxNode *np = NULL;
+  STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+  {
+    struct ImapMboxData *mdata = imap_mdata_get(np->mailbox);
+    if (!mdata)
+      continue;
+    mutt_buffer_addstr(buf, (num == 0) ? " (mailboxes (" : " ");
+    mutt_buffer_addstr(buf, mdata->munge_name);
+    num++;
+  }
+  if (num > 0)
+    mutt_buffer_addstr(buf, ") (MessageNew MessageExpunge FlagChange))");
+
+  adata->notify = (imap_exec(adata, mutt_buffer_string(buf), IMAP_CMD_NO_FLAGS) ==
+                   IMAP_EXEC_SUCCESS);
+  mutt_buffer_pool_release(&buf);
+  if (!adata->notify)
+    adata->capabilities &= ~IMAP_CAP_NOTIFY; // Don't try again
+
+  if (adata->notify)
+    imap_monitor_add(adata);
+
+  mutt_debug(LL_DEBUG2, "NOTIFY is %s for %d mailboxes\n",
+             adata->notify ? "enabled" : "disabled", num);
+
+  /* Check each Mailbox once, then wait for the server to report changes */
+  STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+  {
+    struct ImapMboxData *mdata = imap_mdata_get(np->mailbox);
+    if (!mdata)
+      continue;
+    mdata->notify = adata->notify;
+    mdata->notify_stale = true;
+  }
+}
+
 /**
  * imap_check_mailbox - use the NOOP or IDLE command to poll for new mail
  * @param m     Mailbox
@@ -1105,6 +1313,10 @@ enum MxStatus imap_check_mailbox(struct Mailbox *m, bool force)
   struct ImapAccountData *adata = imap_adata_get(m);
   struct ImapMboxData *mdata = imap_mdata_get(m);
 
+  /* imap_mbox_reconcile() will catch up with the server */
+  if (mdata->offline)
+    return MX_STATUS_OK;
+
   /* overload keyboard timeout to avoid many mailbox checks in a row.
    * Most users don't like having to wait exactly when they press a key. */
   int rc = 0;
@@ -1135,9 +1347,20 @@ enum MxStatus imap_check_mailbox(struct Mailbox *m, bool force)
       adata->capabilities &= ~IMAP_CAP_IDLE; // Clear the flag
     }
   }
+  else if (adata->notify)
+  {
+    /* The server sends the changes without being asked, but the queued
+     * commands, e.g. STATUS, still need to be sent */
+    if ((mutt_buffer_len(&adata->cmdbuf) > 0) &&
+        (imap_exec(adata, NULL, IMAP_CMD_POLL) != IMAP_EXEC_SUCCESS))
+    {
+      return MX_STATUS_ERROR;
+    }
+    imap_notify_read(adata);
+  }
 
   const short c_timeout = cs_subset_number(NeoMutt->sub, "timeout");
-  if ((force || ((adata->state != IMAP_IDLE) &&
+  if ((force || ((adata->state != IMAP_IDLE) && !adata->notify &&
                  (mutt_date_epoch() >= adata->lastread + c_timeout))) &&
       (imap_exec(adata, "NOOP", IMAP_CMD_POLL) != IMAP_EXEC_SUCCESS))
   {
@@ -1188,6 +1411,21 @@ static int imap_status(struct ImapAccountData *adata, struct ImapMboxData *mdata
     return mdata->messages;
   }
 
+  /* With NOTIFY, the server tells us when the Mailbox changes */
+  if (mdata->notify && adata->notify)
+  {
+    imap_notify_read(adata);
+    if (adata->notify && !mdata->notify_stale)
+      return mdata->messages;
+  }
+
+  /* An extra connection is watching the Mailbox with IDLE */
+  if (imap_idle_fresh(mdata))
+    return mdata->messages;
+
+  if (imap_login_deferred(adata) < 0)
+    return -1;
+
   if (adata->capabilities & IMAP_CAP_IMAP4REV1)
     uidvalidity_flag = "UIDVALIDITY";
   else if (adata->capabilities & IMAP_CAP_STATUS)
@@ -1201,21 +1439,96 @@ static int imap_status(struct ImapAccountData *adata, struct ImapMboxData *mdata
   snprintf(cmd, sizeof(cmd), "STATUS %s (UIDNEXT %s UNSEEN RECENT MESSAGES)",
            mdata->munge_name, uidvalidity_flag);
 
+  mdata->notify_stale = false;
   int rc = imap_exec(adata, cmd, queue ? IMAP_CMD_QUEUE : IMAP_CMD_NO_FLAGS | IMAP_CMD_POLL);
   if (rc < 0)
   {
     mutt_debug(LL_DEBUG1, "Error queueing command\n");
+    mdata->notify_stale = true;
     return rc;
   }
   return mdata->messages;
 }
 
+/**
+ * imap_status_batch - Refresh all the Mailboxes of an Account at once
+ * @param adata IMAP Account data
+ * @param m     Mailbox being checked
+ * @retval num Total number of messages in the Mailbox
+ * @retval -1  Error
+ *
+ * Queue a STATUS for each Mailbox of the Account, then send them together
+ * and wait for the replies.  The Account costs one round trip, rather than
+ * one per Mailbox.  The other Mailboxes use their results when they're
+ * checked.
+ */
+static int imap_status_batch(struct ImapAccountData *adata, struct Mailbox *m)
+{
+  const int nextcmd = adata->nextcmd;
+
+  int rc = imap_status(adata, imap_mdata_get(m), true);
+  if (rc < 0)
+    return rc;
+
+  struct MailboxNode *np = NULL;
+  STAILQ_FOREACH(np, &adata->account->mailboxes, entries)
+  {
+    struct Mailbox *m_other = np->mailbox;
+    struct ImapMboxData *mdata = imap_mdata_get(m_other);
+    if ((m_other == m) || (m_other == adata->mailbox) || !mdata ||
+        (m_other->flags & MB_HIDDEN))
+    {
+      continue;
+    }
+
+    if (imap_status(adata, mdata, true) < 0)
+      break;
+    mdata->status_fresh = true;
+  }
+
+  /* Nothing was queued, e.g. NOTIFY has reported no changes */
+  if (adata->nextcmd == nextcmd)
+    return rc;
+
+  if (imap_exec(adata, NULL, IMAP_CMD_POLL) == IMAP_EXEC_FATAL)
+    return -1;
+
+  return imap_mdata_get(m)->messages;
+}
+
 /**
  * imap_mbox_check_stats - Check the Mailbox statistics - Implements MxOps::mbox_check_stats()
  */
 static enum MxStatus imap_mbox_check_stats(struct Mailbox *m, uint8_t flags)
 {
-  const int new_msgs = imap_mailbox_status(m, true);
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  /* Don't connect while the index shows a Mailbox from the header cache */
+  if (adata && adata->login_deferred && adata->mailbox)
+    return MX_STATUS_OK;
+
+  /* The Mailbox was added after NOTIFY SET was sent */
+  if (adata && mdata && !mdata->notify && (adata->state >= IMAP_AUTHENTICATED) &&
+      (adata->capabilities & IMAP_CAP_NOTIFY))
+  {
+    imap_notify_set(adata);
+  }
+
+  int new_msgs;
+  if (mdata && mdata->status_fresh)
+  {
+    /* Refreshed along with another Mailbox of the Account */
+    mdata->status_fresh = false;
+    new_msgs = mdata->messages;
+  }
+  else if (adata && mdata && adata->account)
+    new_msgs = imap_status_batch(adata, m);
+  else
+    new_msgs = imap_mailbox_status(m, true);
+
+  imap_idle_watch(adata, m);
+
   if (new_msgs == -1)
     return MX_STATUS_ERROR;
   if (new_msgs == 0)
@@ -1533,7 +1846,6 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
   if (!m)
     return -1;
 
-  struct Email **emails = NULL;
   int rc;
 
   struct ImapAccountData *adata = imap_adata_get(m);
@@ -1637,18 +1949,6 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
   imap_hcache_close(mdata);
 #endif
 
-  /* presort here to avoid doing 10 resorts in imap_exec_msgset */
-  const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
-  if (c_sort != SORT_ORDER)
-  {
-    emails = m->emails;
-    m->emails = mutt_mem_malloc(m->msg_count * sizeof(struct Email *));
-    memcpy(m->emails, emails, m->msg_count * sizeof(struct Email *));
-
-    cs_subset_str_native_set(NeoMutt->sub, "sort", SORT_ORDER, NULL);
-    qsort(m->emails, m->msg_count, sizeof(struct Email *), mutt_get_sort_func(SORT_ORDER));
-  }
-
   rc = sync_helper(m, MUTT_ACL_DELETE, MUTT_DELETED, "\\Deleted");
   if (rc >= 0)
     rc |= sync_helper(m, MUTT_ACL_WRITE, MUTT_FLAG, "\\Flagged");
@@ -1659,13 +1959,6 @@ enum MxStatus imap_sync_mailbox(struct Mailbox *m, bool expunge, bool close)
   if (rc >= 0)
     rc |= sync_helper(m, MUTT_ACL_WRITE, MUTT_REPLIED, "\\Answered");
 
-  if (c_sort != SORT_ORDER)
-  {
-    cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
-    FREE(&m->emails);
-    m->emails = emails;
-  }
-
   /* Flush the queued flags if any were changed in sync_helper. */
   if (rc > 0)
     if (imap_exec(adata, NULL, IMAP_CMD_NO_FLAGS) != IMAP_EXEC_SUCCESS)
@@ -1778,7 +2071,13 @@ static bool imap_ac_add(struct Account *a, struct Mailbox *m)
 
     mutt_account_hook(m->realpath);
 
-    if (imap_login(adata) < 0)
+#ifdef USE_HCACHE
+    /* The index may show the Mailbox from the header cache, before connecting */
+    const bool c_imap_open_cached = cs_subset_bool(NeoMutt->sub, "imap_open_cached");
+    adata->login_deferred = c_imap_open_cached && !OptNoCurses;
+#endif
+
+    if (!adata->login_deferred && (imap_login(adata) < 0))
     {
       imap_adata_free((void **) &adata);
       return false;
@@ -1907,6 +2206,8 @@ int imap_login(struct ImapAccountData *adata)
     /* we may need the root delimiter before we open a mailbox */
     imap_exec(adata, NULL, IMAP_CMD_NO_FLAGS);
 
+    imap_notify_set(adata);
+
     /* select the mailbox that used to be open before disconnect */
     if (adata->mailbox)
     {
@@ -1921,13 +2222,34 @@ int imap_login(struct ImapAccountData *adata)
 }
 
 /**
- * imap_mbox_open - Open a mailbox - Implements MxOps::mbox_open()
+ * imap_login_deferred - Log in, if $imap_open_cached put it off
+ * @param adata Imap Account data
+ * @retval  0 Success, or nothing to do
+ * @retval -1 Failure
+ *
+ * While the index shows a Mailbox from the header cache, nothing else may
+ * connect.  imap_mbox_reconcile() will log in and select it.
  */
-static enum MxOpenReturns imap_mbox_open(struct Mailbox *m)
+int imap_login_deferred(struct ImapAccountData *adata)
 {
-  if (!m->account || !m->mdata)
-    return MX_OPEN_ERROR;
+  if (!adata || !adata->login_deferred)
+    return 0;
+
+  if (adata->mailbox)
+    return -1;
 
+  adata->login_deferred = false;
+  return imap_login(adata);
+}
+
+/**
+ * imap_mbox_open_select - Select a Mailbox and read its state
+ * @param m Mailbox
+ * @retval num Number of messages in the Mailbox
+ * @retval -1  Error
+ */
+static int imap_mbox_open_select(struct Mailbox *m)
+{
   char buf[PATH_MAX];
   int count = 0;
   int rc;
@@ -1935,10 +2257,8 @@ static enum MxOpenReturns imap_mbox_open(struct Mailbox *m)
   struct ImapAccountData *adata = imap_adata_get(m);
   struct ImapMboxData *mdata = imap_mdata_get(m);
 
-  mutt_debug(LL_DEBUG3, "opening %s, saving %s\n", m->pathbuf.data,
-             (adata->mailbox ? adata->mailbox->pathbuf.data : "(none)"));
-  adata->prev_mailbox = adata->mailbox;
-  adata->mailbox = m;
+  /* The Account's connection will watch the Mailbox now */
+  imap_idle_free(mdata);
 
   /* clear mailbox status */
   adata->status = 0;
@@ -2100,8 +2420,58 @@ static enum MxOpenReturns imap_mbox_open(struct Mailbox *m)
     m->readonly = true;
   }
 
-  while (m->email_max < count)
-    mx_alloc_memory(m);
+  return count;
+
+fail:
+  if (adata->state == IMAP_SELECTED)
+    adata->state = IMAP_AUTHENTICATED;
+  return -1;
+}
+
+/**
+ * imap_mbox_open - Open a mailbox - Implements MxOps::mbox_open()
+ */
+static enum MxOpenReturns imap_mbox_open(struct Mailbox *m)
+{
+  if (!m->account || !m->mdata)
+    return MX_OPEN_ERROR;
+
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  mutt_debug(LL_DEBUG3, "opening %s, saving %s\n", m->pathbuf.data,
+             (adata->mailbox ? adata->mailbox->pathbuf.data : "(none)"));
+
+#ifdef USE_HCACHE
+  /* Show the Emails from the header cache until the index has been drawn */
+  if (adata->login_deferred && !adata->mailbox && OptOpenCached)
+  {
+    adata->prev_mailbox = NULL;
+    adata->mailbox = m;
+    if (imap_read_headers_cached(m) == 0)
+    {
+      mdata->offline = true;
+      mdata->offline_wait = true;
+      mdata->offline_readonly = m->readonly;
+      mdata->offline_retry = 0;
+      m->readonly = true;
+      return MX_OPEN_OK;
+    }
+    adata->mailbox = NULL;
+  }
+#endif
+
+  if (imap_login_deferred(adata) < 0)
+    return MX_OPEN_ERROR;
+
+  adata->prev_mailbox = adata->mailbox;
+  adata->mailbox = m;
+
+  int count = imap_mbox_open_select(m);
+  if (count < 0)
+    return MX_OPEN_ERROR;
+
+  mx_alloc_memory(m, count);
 
   m->msg_count = 0;
   m->msg_unread = 0;
@@ -2117,6 +2487,9 @@ static enum MxOpenReturns imap_mbox_open(struct Mailbox *m)
     goto fail;
   }
 
+  /* The index hasn't seen the Emails, so there's no expunge to report */
+  mdata->check_status &= ~IMAP_EXPUNGE_PENDING;
+
   mutt_debug(LL_DEBUG2, "msg_count is %d\n", m->msg_count);
   return MX_OPEN_OK;
 
@@ -2157,6 +2530,121 @@ static bool imap_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
   return true;
 }
 
+#ifdef USE_HCACHE
+/**
+ * imap_mbox_reconcile - Bring a Mailbox read from the header cache up to date
+ * @param m Mailbox
+ * @retval enum #MxStatus
+ *
+ * Log in, select the Mailbox and let QRESYNC report the changes since the
+ * header cache was written.  If the server can't do that, read the Mailbox
+ * again.  If the server can't be reached, try again after `$mail_check`.
+ */
+static enum MxStatus imap_mbox_reconcile(struct Mailbox *m)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  if (mdata->offline_wait || (mutt_date_epoch() < mdata->offline_retry))
+    return MX_STATUS_OK;
+
+  /* Log in without selecting anything */
+  adata->mailbox = NULL;
+  adata->login_deferred = false;
+  int rc = imap_login(adata);
+  adata->mailbox = m;
+  if (rc < 0)
+  {
+    adata->login_deferred = true;
+    goto retry;
+  }
+
+  const uint32_t uidvalidity = mdata->uidvalidity;
+  const unsigned long long modseq = mdata->modseq;
+  const int oldcount = m->msg_count;
+
+  /* Let EXISTS count the messages, as if the Mailbox were empty */
+  struct MSN msn = mdata->msn;
+  ARRAY_INIT(&mdata->msn);
+  m->readonly = mdata->offline_readonly;
+  int count = imap_mbox_open_select(m);
+  imap_msn_free(&mdata->msn);
+  mdata->msn = msn;
+  if (count < 0)
+    goto retry;
+
+  mdata->offline = false;
+  mdata->check_status = IMAP_OPEN_NO_FLAGS;
+
+  enum MxStatus check = MX_STATUS_OK;
+  /* QRESYNC can only tell us about the Emails we've got */
+  if ((count == 0) || !adata->qresync || (mdata->uidvalidity != uidvalidity) ||
+      (mdata->modseq == 0))
+  {
+    imap_emails_free(m);
+    check = MX_STATUS_REOPENED;
+  }
+
+  mx_alloc_memory(m, count);
+  if (count && (imap_read_headers(m, 1, count, true) < 0))
+  {
+    mutt_error(_("Error opening mailbox"));
+    if (adata->state == IMAP_SELECTED)
+      adata->state = IMAP_AUTHENTICATED;
+    return MX_STATUS_ERROR;
+  }
+
+  if (mdata->check_status & IMAP_EXPUNGE_PENDING)
+    check = MX_STATUS_REOPENED;
+  else if ((check == MX_STATUS_OK) && (m->msg_count > oldcount))
+    check = MX_STATUS_NEW_MAIL;
+  else if ((check == MX_STATUS_OK) && (mdata->modseq != modseq))
+    check = MX_STATUS_FLAGS;
+  mdata->check_status = IMAP_OPEN_NO_FLAGS;
+
+  /* Fetching the flag updates resets the counts */
+  if (check == MX_STATUS_FLAGS)
+    mailbox_changed(m, NT_MAILBOX_INVALID);
+
+  mutt_debug(LL_DEBUG2, "reconciled %s, msg_count is %d\n", mdata->name, m->msg_count);
+  return check;
+
+retry:
+  m->readonly = true;
+  const short c_mail_check = cs_subset_number(NeoMutt->sub, "mail_check");
+  mdata->offline_retry = mutt_date_epoch() + MAX(c_mail_check, 1);
+  return MX_STATUS_OK;
+}
+#endif
+
+/**
+ * imap_reconcile_pending - Is a Mailbox from the header cache waiting for the server?
+ * @retval true The index should check its Mailbox now
+ *
+ * This is called when the index is waiting for a key, so the server is only
+ * contacted once the cached Emails have been drawn.
+ */
+bool imap_reconcile_pending(void)
+{
+  bool pending = false;
+  struct Account *np = NULL;
+  TAILQ_FOREACH(np, &NeoMutt->accounts, entries)
+  {
+    if (np->type != MUTT_IMAP)
+      continue;
+
+    struct ImapAccountData *adata = np->adata;
+    struct ImapMboxData *mdata = adata ? imap_mdata_get(adata->mailbox) : NULL;
+    if (mdata && mdata->offline && mdata->offline_wait)
+    {
+      mdata->offline_wait = false;
+      pending = true;
+    }
+  }
+
+  return pending;
+}
+
 /**
  * imap_mbox_check - Check for new mail - Implements MxOps::mbox_check()
  * @param m Mailbox
@@ -2165,6 +2653,12 @@ static bool imap_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
  */
 static enum MxStatus imap_mbox_check(struct Mailbox *m)
 {
+#ifdef USE_HCACHE
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (mdata && mdata->offline)
+    return imap_mbox_reconcile(m);
+#endif
+
   imap_allow_reopen(m);
   enum MxStatus rc = imap_check_mailbox(m, false);
   /* NOTE - ctx might have been changed at this point. In particular,
@@ -2194,6 +2688,7 @@ static enum MxStatus imap_mbox_close(struct Mailbox *m)
    * touch adata - it's still being used.  */
   if (m == adata->mailbox)
   {
+    mdata->offline = false;
     if ((adata->status != IMAP_FATAL) && (adata->state >= IMAP_SELECTED))
     {
       /* mx_mbox_close won't sync if there are no deleted messages
@@ -2496,9 +2991,11 @@ struct MxOps MxImapOps = {
   .mbox_sync        = NULL, /* imap syncing is handled by imap_sync_mailbox */
   .mbox_close       = imap_mbox_close,
   .msg_open         = imap_msg_open,
+  .msg_prefetch     = NULL,
   .msg_open_new     = imap_msg_open_new,
   .msg_commit       = imap_msg_commit,
   .msg_close        = imap_msg_close,
+  .msg_append_batch = NULL,
   .msg_padding_size = NULL,
   .msg_save_hcache  = imap_msg_save_hcache,
   .tags_edit        = imap_tags_edit,
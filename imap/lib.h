@@ -57,6 +57,7 @@
 #include "config.h"
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdio.h>
 #include <sys/types.h>
 #include "core/lib.h"
 #include "commands.h"
@@ -80,6 +81,7 @@ int imap_mailbox_status(struct Mailbox *m, bool queue);
 int imap_subscribe(char *path, bool subscribe);
 int imap_complete(char *buf, size_t buflen, const char *path);
 int imap_fast_trash(struct Mailbox *m, const char *dest);
+bool imap_reconcile_pending(void);
 enum MailboxType imap_path_probe(const char *path, const struct stat *st);
 int imap_path_canon(char *buf, size_t buflen);
 void imap_notify_delete_email(struct Mailbox *m, struct Email *e);
@@ -93,6 +95,9 @@ int imap_mailbox_rename(const char *path);
 
 /* message.c */
 int imap_copy_messages(struct Mailbox *m, struct EmailList *el, const char *dest, enum MessageSaveOpt save_opt);
+FILE *imap_msg_open_partial(struct Mailbox *m, struct Email *e);
+void imap_prefetch(void);
+bool imap_prefetch_pending(void);
 
 /* socket.c */
 void imap_logout_all(void);
@@ -44,6 +44,7 @@ void imap_mdata_free(void **ptr)
 
   struct ImapMboxData *mdata = *ptr;
 
+  imap_idle_free(mdata);
   imap_mdata_cache_reset(mdata);
   mutt_list_free(&mdata->flags);
   FREE(&mdata->name);
@@ -29,6 +29,8 @@
 
 struct Mailbox;
 struct ImapAccountData;
+struct ImapIdle;
+struct ImapSearchResult;
 
 /**
  * struct ImapMboxData - IMAP-specific Mailbox data - @extends Mailbox
@@ -53,11 +55,24 @@ struct ImapMboxData
   unsigned int messages;
   unsigned int recent;
   unsigned int unseen;
+  bool notify;       ///< The server reports changes with NOTIFY
+  bool notify_stale; ///< NOTIFY or IDLE has reported a change since the last STATUS
+  bool status_fresh; ///< STATUS was refreshed along with another Mailbox
+  struct ImapIdle *idle; ///< Extra connection, watching the Mailbox with IDLE
+  time_t idle_retry;     ///< Don't try to watch the Mailbox again before this time
 
   // Cached data used only when the mailbox is opened
   struct HashTable *uid_hash;
   ARRAY_HEAD(MSN, struct Email *) msn; ///< look up headers by (MSN-1)
   struct BodyCache *bcache;
+  struct HashTable *search_cache;          ///< Results of recent searches
+  struct ImapSearchResult *search_result;  ///< Search being run
+  int prefetch_msgno;                      ///< Prefetch the messages after this one
+  int prefetch_left;                       ///< Number of messages left to prefetch
+  bool offline;          ///< The Emails came from the header cache, the Mailbox isn't selected yet
+  bool offline_wait;     ///< Don't contact the server until the index has been drawn
+  bool offline_readonly; ///< Mailbox::readonly, before the Mailbox was read from the header cache
+  time_t offline_retry;  ///< Don't try to contact the server again before this time
 
   struct HeaderCache *hcache;
 };
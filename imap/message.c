@@ -69,6 +69,11 @@
 
 struct BodyCache;
 
+/// Size of the blocks of a message that are uploaded by imap_append_message()
+#define APPEND_BUF_SIZE (64 * 1024)
+/// Largest literal that LITERAL- lets us send without waiting (RFC7888)
+#define IMAP_LITERAL_MINUS_MAX 4096
+
 /**
  * msg_cache_open - Open a message cache
  * @param m     Selected Imap Mailbox
@@ -391,22 +396,21 @@ static int msg_parse_fetch(struct ImapHeader *h, char *s)
 
 /**
  * msg_fetch_header - import IMAP FETCH response into an ImapHeader
- * @param m   Mailbox
+ * @param adata Imap Account data
  * @param ih  ImapHeader
  * @param buf Server string containing FETCH response
- * @param fp  Connection to server
+ * @param hdr Buffer for the headers, may be NULL
  * @retval  0 Success
  * @retval -1 String is not a fetch response
  * @retval -2 String is a corrupt fetch response
  *
  * Expects string beginning with * n FETCH.
  */
-static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf, FILE *fp)
+static int msg_fetch_header(struct ImapAccountData *adata, struct ImapHeader *ih,
+                            char *buf, struct Buffer *hdr)
 {
   int rc = -1; /* default now is that string isn't FETCH response */
 
-  struct ImapAccountData *adata = imap_adata_get(m);
-
   if (buf[0] != '*')
     return rc;
 
@@ -431,13 +435,13 @@ static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf,
   int parse_rc = msg_parse_fetch(ih, buf);
   if (parse_rc == 0)
     return 0;
-  if ((parse_rc != -2) || !fp)
+  if ((parse_rc != -2) || !hdr)
     return rc;
 
   unsigned int bytes = 0;
   if (imap_get_literal_count(buf, &bytes) == 0)
   {
-    imap_read_literal(fp, adata, bytes, NULL);
+    imap_read_literal_buf(hdr, adata, bytes);
 
     /* we may have other fields of the FETCH _after_ the literal
      * (eg Domino puts FLAGS here). Nothing wrong with that, either.
@@ -460,16 +464,88 @@ static int msg_fetch_header(struct Mailbox *m, struct ImapHeader *ih, char *buf,
 }
 
 /**
- * flush_buffer - Write data to a connection
- * @param buf  Buffer containing data
- * @param len  Length of buffer
- * @param conn Network connection
+ * append_crlf_length - Measure a message, as it will be sent to the server
+ * @param fp File containing the message
+ * @retval num Length of the message, with CRLF line endings
+ */
+static size_t append_crlf_length(FILE *fp)
+{
+  char buf[APPEND_BUF_SIZE];
+  size_t len = 0;
+  char last = '\0';
+  size_t num;
+
+  while ((num = fread(buf, 1, sizeof(buf), fp)) > 0)
+  {
+    len += num;
+
+    /* Count the bare LFs, which will become CRLF */
+    const char *p = buf;
+    const char *end = buf + num;
+    const char *nl = NULL;
+    while ((nl = memchr(p, '\n', end - p)))
+    {
+      const char prev = (nl == buf) ? last : nl[-1];
+      if (prev != '\r')
+        len++;
+      p = nl + 1;
+    }
+    last = buf[num - 1];
+  }
+
+  return len;
+}
+
+/**
+ * append_send_crlf - Send a message to the server, with CRLF line endings
+ * @param fp       File containing the message
+ * @param conn     Network connection
+ * @param progress Progress bar, may be NULL
+ * @retval  0 Success
+ * @retval -1 Error
  */
-static int flush_buffer(char *buf, size_t *len, struct Connection *conn)
+static int append_send_crlf(FILE *fp, struct Connection *conn, struct Progress *progress)
 {
-  buf[*len] = '\0';
-  int rc = mutt_socket_write_n(conn, buf, *len);
-  *len = 0;
+  char buf[APPEND_BUF_SIZE];
+  /* Every byte could be a bare LF */
+  char *out = mutt_mem_malloc(2 * sizeof(buf));
+  char last = '\0';
+  size_t sent = 0;
+  size_t num;
+  int rc = 0;
+
+  while ((num = fread(buf, 1, sizeof(buf), fp)) > 0)
+  {
+    size_t len = 0;
+    const char *p = buf;
+    const char *end = buf + num;
+    const char *nl = NULL;
+    while ((nl = memchr(p, '\n', end - p)))
+    {
+      const char prev = (nl == buf) ? last : nl[-1];
+      memcpy(out + len, p, nl - p);
+      len += nl - p;
+      if (prev != '\r')
+        out[len++] = '\r';
+      out[len++] = '\n';
+      p = nl + 1;
+    }
+    memcpy(out + len, p, end - p);
+    len += end - p;
+    last = buf[num - 1];
+
+    if (mutt_socket_write_n(conn, out, len) < 0)
+    {
+      rc = -1;
+      break;
+    }
+
+    sent += len;
+    if (progress)
+      mutt_progress_update(progress, sent, -1);
+  }
+
+  FREE(&out);
   return rc;
 }
 
@@ -515,21 +591,23 @@ static void imap_alloc_uid_hash(struct ImapAccountData *adata, unsigned int msn_
 /**
  * imap_fetch_msn_seqset - Generate a sequence set
  * @param[in]  buf           Buffer for the result
- * @param[in]  adata         Imap Account data
+ * @param[in]  mdata         Imap Mailbox data
  * @param[in]  evalhc        If true, check the Header Cache
  * @param[in]  msn_begin     First Message Sequence Number
  * @param[in]  msn_end       Last Message Sequence Number
+ * @param[in]  max_headers_per_fetch Most headers to fetch
  * @param[out] fetch_msn_end Highest Message Sequence Number fetched
+ * @retval num Number of headers in the sequence set
  *
  * Generates a more complicated sequence set after using the header cache,
  * in case there are missing MSNs in the middle.
  */
-static unsigned int imap_fetch_msn_seqset(struct Buffer *buf, struct ImapAccountData *adata,
+static unsigned int imap_fetch_msn_seqset(struct Buffer *buf, struct ImapMboxData *mdata,
                                           bool evalhc, unsigned int msn_begin,
-                                          unsigned int msn_end, unsigned int *fetch_msn_end)
+                                          unsigned int msn_end,
+                                          unsigned int max_headers_per_fetch,
+                                          unsigned int *fetch_msn_end)
 {
-  struct ImapMboxData *mdata = adata->mailbox->mdata;
-  unsigned int max_headers_per_fetch = UINT_MAX;
   bool first_chunk = true;
   int state = 0; /* 1: single msn, 2: range of msn */
   unsigned int msn;
@@ -541,11 +619,6 @@ static unsigned int imap_fetch_msn_seqset(struct Buffer *buf, struct ImapAccount
   if (msn_end < msn_begin)
     return 0;
 
-  const long c_imap_fetch_chunk_size =
-      cs_subset_long(NeoMutt->sub, "imap_fetch_chunk_size");
-  if (c_imap_fetch_chunk_size > 0)
-    max_headers_per_fetch = c_imap_fetch_chunk_size;
-
   if (!evalhc)
   {
     if (msn_end - msn_begin + 1 <= max_headers_per_fetch)
@@ -700,7 +773,7 @@ static int read_headers_normal_eval_cache(struct ImapAccountData *adata,
       if (rc != IMAP_RES_CONTINUE)
         break;
 
-      mfhrc = msg_fetch_header(m, &h, adata->buf, NULL);
+      mfhrc = msg_fetch_header(adata, &h, adata->buf, NULL);
       if (mfhrc < 0)
         continue;
 
@@ -757,7 +830,6 @@ static int read_headers_normal_eval_cache(struct ImapAccountData *adata,
         /*  mailbox->emails[msgno]->received is restored from mutt_hcache_restore */
         e->edata = h.edata;
         e->edata_free = imap_edata_free;
-        STAILQ_INIT(&e->tags);
 
         /* We take a copy of the tags so we can split the string */
         char *tags_copy = mutt_str_dup(h.edata->flags_remote);
@@ -823,8 +895,7 @@ static int read_headers_qresync_eval_cache(struct ImapAccountData *adata, char *
     {
       imap_msn_set(&mdata->msn, msn - 1, e);
 
-      if (m->msg_count >= m->email_max)
-        mx_alloc_memory(m);
+      mx_alloc_memory(m, m->msg_count + 1);
 
       struct ImapEmailData *edata = imap_edata_new();
       e->edata = edata;
@@ -855,6 +926,101 @@ static int read_headers_qresync_eval_cache(struct ImapAccountData *adata, char *
   return rc;
 }
 
+/**
+ * read_headers_condstore_eval_cache - Retrieve data from the header cache
+ * @param adata      Imap Account data
+ * @param uid_seqset Sequence Set of UIDs
+ * @param msn_end    Last Message Sequence number
+ * @param uid_next   UID of next email, from the header cache
+ * @retval  0 Success
+ * @retval  1 The cached UIDs are out of date
+ * @retval -1 Error
+ *
+ * For CONDSTORE without QRESYNC, the server can't tell us which messages
+ * have been expunged.  Instead of fetching every UID, ask the server for the
+ * UIDs of the new messages.  UIDs only increase, so if the cached UIDs plus
+ * the new ones add up to the number of messages, no cached message has been
+ * expunged, and the MSNs can be taken from the header cache.
+ *
+ * The flag changes are fetched by read_headers_condstore_qresync_updates().
+ */
+static int read_headers_condstore_eval_cache(struct ImapAccountData *adata,
+                                             char *uid_seqset, unsigned int msn_end,
+                                             unsigned int uid_next)
+{
+  struct Mailbox *m = adata->mailbox;
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  unsigned int num_cached = 0;
+  unsigned int num_new = 0;
+  unsigned int uid = 0;
+  char buf[64];
+  int rc;
+
+  struct SeqsetIterator *iter = mutt_seqset_iterator_new(uid_seqset);
+  if (!iter)
+    return 1;
+  while ((rc = mutt_seqset_iterator_next(iter, &uid)) == 0)
+  {
+    /* an empty spot, or a new message, means the seqset can't be trusted */
+    if ((uid == 0) || (uid >= uid_next))
+      break;
+    num_cached++;
+  }
+  mutt_seqset_iterator_free(&iter);
+  if (rc != 1)
+    return 1;
+
+  snprintf(buf, sizeof(buf), "UID SEARCH UID %u:*", uid_next);
+  imap_cmd_start(adata, buf);
+  do
+  {
+    rc = imap_cmd_step(adata);
+    if (rc != IMAP_RES_CONTINUE)
+      break;
+
+    char *s = imap_next_word(adata->buf);
+    if (!mutt_istr_startswith(s, "SEARCH"))
+      continue;
+
+    /* "n:*" always matches the last message, even if its UID is below n */
+    while ((s = imap_next_word(s)) && (*s != '\0'))
+    {
+      if ((mutt_str_atoui(s, &uid) >= 0) && (uid >= uid_next))
+        num_new++;
+    }
+  } while (rc == IMAP_RES_CONTINUE);
+
+  if (rc != IMAP_RES_OK)
+    return -1;
+
+  if ((num_cached + num_new) != msn_end)
+  {
+    mutt_debug(LL_DEBUG2, "%u cached + %u new UIDs != %u messages\n",
+               num_cached, num_new, msn_end);
+    return 1;
+  }
+
+  const int oldmsgcount = m->msg_count;
+  if (read_headers_qresync_eval_cache(adata, uid_seqset) < 0)
+    return -1;
+  if ((m->msg_count - oldmsgcount) == num_cached)
+    return 0;
+
+  /* Some headers were missing from the cache, so the MSNs are wrong */
+  mutt_debug(LL_DEBUG2, "header cache is incomplete\n");
+  for (int i = oldmsgcount; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    struct ImapEmailData *edata = imap_edata_get(e);
+    imap_msn_remove(&mdata->msn, edata->msn - 1);
+    mutt_hash_int_delete(mdata->uid_hash, edata->uid, e);
+    mailbox_size_sub(m, e);
+    email_free(&m->emails[i]);
+  }
+  m->msg_count = oldmsgcount;
+  return 1;
+}
+
 /**
  * read_headers_condstore_qresync_updates - Retrieve updates from the server
  * @param adata        Imap Account data
@@ -935,6 +1101,7 @@ static int read_headers_condstore_qresync_updates(struct ImapAccountData *adata,
   /* VANISHED handling: we need to empty out the messages */
   if (mdata->reopen & IMAP_EXPUNGE_PENDING)
   {
+    mdata->check_status |= IMAP_EXPUNGE_PENDING;
     imap_hcache_close(mdata);
     imap_expunge_mailbox(m);
 
@@ -955,6 +1122,31 @@ static int read_headers_condstore_qresync_updates(struct ImapAccountData *adata,
   return 0;
 }
 
+/**
+ * imap_emails_free - Forget all the Emails of a Mailbox
+ * @param m Imap Selected Mailbox
+ *
+ * This simulates closing the Mailbox, so that it can be read again.
+ */
+void imap_emails_free(struct Mailbox *m)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  imap_msn_free(&mdata->msn);
+  mutt_hash_free(&mdata->uid_hash);
+  mutt_hash_free(&m->id_hash);
+  mutt_hash_free(&m->subj_hash);
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    if (m->emails[i] && m->emails[i]->edata)
+      imap_edata_free(&m->emails[i]->edata);
+    email_free(&m->emails[i]);
+  }
+  m->msg_count = 0;
+  m->size = 0;
+}
+
 /**
  * imap_verify_qresync - Check to see if QRESYNC got jumbled
  * @param m  Imap Selected Mailbox
@@ -998,16 +1190,8 @@ static int imap_verify_qresync(struct Mailbox *m)
   return 0;
 
 fail:
-  imap_msn_free(&mdata->msn);
-  mutt_hash_free(&mdata->uid_hash);
-
-  for (int i = 0; i < m->msg_count; i++)
-  {
-    if (m->emails[i] && m->emails[i]->edata)
-      imap_edata_free(&m->emails[i]->edata);
-    email_free(&m->emails[i]);
-  }
-  m->msg_count = 0;
+  imap_emails_free(m);
+  mdata->check_status |= IMAP_EXPUNGE_PENDING;
   mutt_hcache_delete_record(mdata->hcache, "/MODSEQ", 7);
   imap_hcache_clear_uid_seqset(mdata);
   imap_hcache_close(mdata);
@@ -1022,398 +1206,925 @@ fail:
   return -1;
 }
 
-#endif /* USE_HCACHE */
-
 /**
- * read_headers_fetch_new - Retrieve new messages from the server
- * @param[in]  m                Imap Selected Mailbox
- * @param[in]  msn_begin        First Message Sequence number
- * @param[in]  msn_end          Last Message Sequence number
- * @param[in]  evalhc           If true, check the Header Cache
- * @param[out] maxuid           Highest UID seen
- * @param[in]  initial_download true, if this is the first opening of the mailbox
+ * imap_read_headers_cached - Read the Emails from the header cache alone
+ * @param m Imap Selected Mailbox
  * @retval  0 Success
- * @retval -1 Error
+ * @retval -1 The header cache can't be used
+ *
+ * If the header cache was last brought up to date using CONDSTORE or QRESYNC,
+ * it knows the UIDs of the Mailbox in order, so the Emails can be shown before
+ * the server has been contacted.  Once it has, imap_read_headers() will use
+ * QRESYNC to catch up with the changes.
  */
-static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
-                                  unsigned int msn_end, bool evalhc,
-                                  unsigned int *maxuid, bool initial_download)
+int imap_read_headers_cached(struct Mailbox *m)
 {
-  int rc, mfhrc = 0, retval = -1;
-  unsigned int fetch_msn_end = 0;
-  struct Progress progress;
-  char *hdrreq = NULL;
-  struct Buffer *tempfile = NULL;
-  FILE *fp = NULL;
-  struct ImapHeader h;
-  struct Buffer *buf = NULL;
-  static const char *const want_headers =
-      "DATE FROM SENDER SUBJECT TO CC MESSAGE-ID REFERENCES CONTENT-TYPE "
-      "CONTENT-DESCRIPTION IN-REPLY-TO REPLY-TO LINES LIST-POST X-LABEL "
-      "X-ORIGINAL-TO";
-
   struct ImapAccountData *adata = imap_adata_get(m);
   struct ImapMboxData *mdata = imap_mdata_get(m);
-  int idx = m->msg_count;
-
-  if (!adata || (adata->mailbox != m))
+  if (!adata || !mdata || (adata->mailbox != m))
     return -1;
 
-  struct Buffer *hdr_list = mutt_buffer_pool_get();
-  mutt_buffer_strcpy(hdr_list, want_headers);
-  const char *const c_imap_headers =
-      cs_subset_string(NeoMutt->sub, "imap_headers");
-  if (c_imap_headers)
-  {
-    mutt_buffer_addch(hdr_list, ' ');
-    mutt_buffer_addstr(hdr_list, c_imap_headers);
-  }
-#ifdef USE_AUTOCRYPT
-  const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-  if (c_autocrypt)
+  /* The header cache is named after the user, who mustn't be prompted for yet */
+  struct ConnAccount *cac = &adata->conn->account;
+  if (!(cac->flags & MUTT_ACCT_USER) &&
+      (!cac->get_field || !cac->get_field(MUTT_CA_USER, cac->gf_data) ||
+       (mutt_account_getuser(cac) < 0)))
   {
-    mutt_buffer_addch(hdr_list, ' ');
-    mutt_buffer_addstr(hdr_list, "AUTOCRYPT");
+    return -1;
   }
-#endif
 
-  if (adata->capabilities & IMAP_CAP_IMAP4REV1)
-  {
-    mutt_str_asprintf(&hdrreq, "BODY.PEEK[HEADER.FIELDS (%s)]", mutt_buffer_string(hdr_list));
-  }
-  else if (adata->capabilities & IMAP_CAP_IMAP4)
-  {
-    mutt_str_asprintf(&hdrreq, "RFC822.HEADER.LINES (%s)", mutt_buffer_string(hdr_list));
-  }
-  else
-  { /* Unable to fetch headers for lower versions */
-    mutt_error(_("Unable to fetch headers from this IMAP server version"));
-    goto bail;
-  }
+  imap_hcache_open(adata, mdata);
+  if (!mdata->hcache)
+    return -1;
 
-  mutt_buffer_pool_release(&hdr_list);
+  int rc = -1;
+  size_t dlen = 0;
+  char *uid_seqset = NULL;
+  void *uidvalidity = mutt_hcache_fetch_raw(mdata->hcache, "/UIDVALIDITY", 12, &dlen);
+  void *uid_next = mutt_hcache_fetch_raw(mdata->hcache, "/UIDNEXT", 8, &dlen);
+  unsigned long long *modseq = mutt_hcache_fetch_raw(mdata->hcache, "/MODSEQ", 7, &dlen);
+  if (!uidvalidity || !uid_next || !modseq || (*modseq == 0))
+    goto done;
 
-  /* instead of downloading all headers and then parsing them, we parse them
-   * as they come in. */
-  tempfile = mutt_buffer_pool_get();
-  mutt_buffer_mktemp(tempfile);
-  fp = mutt_file_fopen(mutt_buffer_string(tempfile), "w+");
-  if (!fp)
-  {
-    mutt_error(_("Could not create temporary file %s"), mutt_buffer_string(tempfile));
-    goto bail;
-  }
-  unlink(mutt_buffer_string(tempfile));
-  mutt_buffer_pool_release(&tempfile);
+  uid_seqset = imap_hcache_get_uid_seqset(mdata);
+  if (!uid_seqset)
+    goto done;
 
-  if (m->verbose)
+  unsigned int count = 0;
+  unsigned int uid = 0;
+  struct SeqsetIterator *iter = mutt_seqset_iterator_new(uid_seqset);
+  if (!iter)
+    goto done;
+  while (mutt_seqset_iterator_next(iter, &uid) == 0)
+    count++;
+  mutt_seqset_iterator_free(&iter);
+  if (count == 0)
+    goto done;
+
+  mdata->uidvalidity = *(uint32_t *) uidvalidity;
+  mdata->uid_next = *(unsigned int *) uid_next;
+  mdata->modseq = *modseq;
+
+  mx_alloc_memory(m, count);
+  imap_msn_reserve(&mdata->msn, count);
+  imap_alloc_uid_hash(adata, count);
+
+  if ((read_headers_qresync_eval_cache(adata, uid_seqset) < 0) || (m->msg_count != count))
   {
-    mutt_progress_init(&progress, _("Fetching message headers..."),
-                       MUTT_PROGRESS_READ, msn_end);
+    /* A missing header would leave the MSNs out of step */
+    mutt_debug(LL_DEBUG2, "header cache is incomplete\n");
+    imap_emails_free(m);
+    goto done;
   }
 
-  buf = mutt_buffer_pool_get();
+  mutt_debug(LL_DEBUG2, "read %u emails from the header cache\n", count);
+  rc = 0;
 
-  /* NOTE:
-   *   The (fetch_msn_end < msn_end) used to be important to prevent
-   *   an infinite loop, in the event the server did not return all
-   *   the headers (due to a pending expunge, for example).
-   *
-   *   I believe the new chunking imap_fetch_msn_seqset()
-   *   implementation and "msn_begin = fetch_msn_end + 1" assignment
-   *   at the end of the loop makes the comparison unneeded, but to be
-   *   cautious I'm keeping it.
-   */
-  while ((fetch_msn_end < msn_end) &&
-         imap_fetch_msn_seqset(buf, adata, evalhc, msn_begin, msn_end, &fetch_msn_end))
-  {
-    char *cmd = NULL;
-    mutt_str_asprintf(&cmd, "FETCH %s (UID FLAGS INTERNALDATE RFC822.SIZE %s)",
-                      mutt_buffer_string(buf), hdrreq);
-    imap_cmd_start(adata, cmd);
-    FREE(&cmd);
+done:
+  FREE(&uid_seqset);
+  mutt_hcache_free_raw(mdata->hcache, &uidvalidity);
+  mutt_hcache_free_raw(mdata->hcache, &uid_next);
+  mutt_hcache_free_raw(mdata->hcache, (void **) &modseq);
+  imap_hcache_close(mdata);
+  return rc;
+}
 
-    rc = IMAP_RES_CONTINUE;
-    for (int msgno = msn_begin; rc == IMAP_RES_CONTINUE; msgno++)
-    {
-      if (initial_download && SigInt && query_abort_header_download(adata))
-        goto bail;
+#endif /* USE_HCACHE */
 
-      if (m->verbose)
-        mutt_progress_update(&progress, msgno, -1);
+/**
+ * msg_open_header - Get a stream to parse the headers of a message
+ * @param hdr    Headers fetched from the server
+ * @param fp_tmp Temporary file to use if memory streams aren't supported
+ * @retval ptr  Stream positioned at the start of the headers
+ * @retval NULL Error
+ *
+ * If the stream isn't fp_tmp, the caller must close it.
+ */
+static FILE *msg_open_header(struct Buffer *hdr, FILE *fp_tmp)
+{
+#ifdef HAVE_FMEMOPEN
+  return fmemopen(hdr->data, mutt_buffer_len(hdr), "r");
+#else
+  rewind(fp_tmp);
+  fwrite(mutt_buffer_string(hdr), 1, mutt_buffer_len(hdr), fp_tmp);
+  /* make sure we don't get remnants from older larger message headers */
+  fputs("\n\n", fp_tmp);
+  rewind(fp_tmp);
+  return fp_tmp;
+#endif
+}
 
-      rewind(fp);
-      memset(&h, 0, sizeof(h));
-      h.edata = imap_edata_new();
+/**
+ * read_headers_fetch_next - Read the next header of a FETCH
+ * @param[in]  m             Imap Selected Mailbox
+ * @param[in]  adata         Connection running the FETCH
+ * @param[in]  hdr           Buffer for the headers
+ * @param[in]  fp            Temporary file, if memory streams aren't supported
+ * @param[in]  fetch_msn_end Last Message Sequence number of the FETCH
+ * @param[out] maxuid        Highest UID seen
+ * @retval #IMAP_RES_CONTINUE More headers to come
+ * @retval #IMAP_RES_OK       The FETCH is complete
+ * @retval -1                 Error
+ */
+static int read_headers_fetch_next(struct Mailbox *m, struct ImapAccountData *adata,
+                                   struct Buffer *hdr, FILE *fp,
+                                   unsigned int fetch_msn_end, unsigned int *maxuid)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  struct ImapHeader h;
+  int rc, mfhrc = 0;
 
-      /* this DO loop does two things:
-       * 1. handles untagged messages, so we can try again on the same msg
-       * 2. fetches the tagged response at the end of the last message.  */
-      do
-      {
-        rc = imap_cmd_step(adata);
-        if (rc != IMAP_RES_CONTINUE)
-          break;
+  mutt_buffer_reset(hdr);
+  memset(&h, 0, sizeof(h));
+  h.edata = imap_edata_new();
 
-        mfhrc = msg_fetch_header(m, &h, adata->buf, fp);
-        if (mfhrc < 0)
-          continue;
+  /* this DO loop does two things:
+   * 1. handles untagged messages, so we can try again on the same msg
+   * 2. fetches the tagged response at the end of the last message.  */
+  do
+  {
+    rc = imap_cmd_step(adata);
+    if (rc != IMAP_RES_CONTINUE)
+      break;
 
-        if (!ftello(fp))
-        {
-          mutt_debug(LL_DEBUG2, "ignoring fetch response with no body\n");
-          continue;
-        }
+    mfhrc = msg_fetch_header(adata, &h, adata->buf, hdr);
+    if (mfhrc < 0)
+      continue;
 
-        /* make sure we don't get remnants from older larger message headers */
-        fputs("\n\n", fp);
+    if (mutt_buffer_is_empty(hdr))
+    {
+      mutt_debug(LL_DEBUG2, "ignoring fetch response with no body\n");
+      continue;
+    }
 
-        if ((h.edata->msn < 1) || (h.edata->msn > fetch_msn_end))
-        {
-          mutt_debug(LL_DEBUG1, "skipping FETCH response for unknown message number %d\n",
-                     h.edata->msn);
-          continue;
-        }
+    if ((h.edata->msn < 1) || (h.edata->msn > fetch_msn_end))
+    {
+      mutt_debug(LL_DEBUG1, "skipping FETCH response for unknown message number %d\n",
+                 h.edata->msn);
+      continue;
+    }
 
-        /* May receive FLAGS updates in a separate untagged response */
-        if (imap_msn_get(&mdata->msn, h.edata->msn - 1))
-        {
-          mutt_debug(LL_DEBUG2, "skipping FETCH response for duplicate message %d\n",
-                     h.edata->msn);
-          continue;
-        }
+    /* May receive FLAGS updates in a separate untagged response */
+    if (imap_msn_get(&mdata->msn, h.edata->msn - 1))
+    {
+      mutt_debug(LL_DEBUG2, "skipping FETCH response for duplicate message %d\n",
+                 h.edata->msn);
+      continue;
+    }
 
-        struct Email *e = email_new();
-        m->emails[idx] = e;
+    FILE *fp_hdr = msg_open_header(hdr, fp);
+    if (!fp_hdr)
+    {
+      mutt_perror(_("Error opening 'memory stream'"));
+      mfhrc = -2;
+      break;
+    }
 
-        imap_msn_set(&mdata->msn, h.edata->msn - 1, e);
-        mutt_hash_int_insert(mdata->uid_hash, h.edata->uid, e);
+    struct Email *e = email_new();
+    m->emails[m->msg_count] = e;
 
-        e->index = h.edata->uid;
-        /* messages which have not been expunged are ACTIVE (borrowed from mh
-         * folders) */
-        e->active = true;
-        e->changed = false;
-        e->read = h.edata->read;
-        e->old = h.edata->old;
-        e->deleted = h.edata->deleted;
-        e->flagged = h.edata->flagged;
-        e->replied = h.edata->replied;
-        e->received = h.received;
-        e->edata = (void *) (h.edata);
-        e->edata_free = imap_edata_free;
-        STAILQ_INIT(&e->tags);
-
-        /* We take a copy of the tags so we can split the string */
-        char *tags_copy = mutt_str_dup(h.edata->flags_remote);
-        driver_tags_replace(&e->tags, tags_copy);
-        FREE(&tags_copy);
-
-        if (*maxuid < h.edata->uid)
-          *maxuid = h.edata->uid;
+    imap_msn_set(&mdata->msn, h.edata->msn - 1, e);
+    mutt_hash_int_insert(mdata->uid_hash, h.edata->uid, e);
 
-        rewind(fp);
-        /* NOTE: if Date: header is missing, mutt_rfc822_read_header depends
-         *   on h.received being set */
-        e->env = mutt_rfc822_read_header(fp, e, false, false);
-        /* body built as a side-effect of mutt_rfc822_read_header */
-        e->body->length = h.content_length;
-        mailbox_size_add(m, e);
+    e->index = h.edata->uid;
+    /* messages which have not been expunged are ACTIVE (borrowed from mh
+     * folders) */
+    e->active = true;
+    e->changed = false;
+    e->read = h.edata->read;
+    e->old = h.edata->old;
+    e->deleted = h.edata->deleted;
+    e->flagged = h.edata->flagged;
+    e->replied = h.edata->replied;
+    e->received = h.received;
+    e->edata = (void *) (h.edata);
+    e->edata_free = imap_edata_free;
+
+    /* We take a copy of the tags so we can split the string */
+    char *tags_copy = mutt_str_dup(h.edata->flags_remote);
+    driver_tags_replace(&e->tags, tags_copy);
+    FREE(&tags_copy);
+
+    if (*maxuid < h.edata->uid)
+      *maxuid = h.edata->uid;
+
+    /* NOTE: if Date: header is missing, mutt_rfc822_read_header depends
+     *   on h.received being set */
+    e->env = mutt_rfc822_read_header(fp_hdr, e, false, false);
+    if (fp_hdr != fp)
+      mutt_file_fclose(&fp_hdr);
+    /* body built as a side-effect of mutt_rfc822_read_header */
+    e->body->length = h.content_length;
+    mailbox_size_add(m, e);
 
 #ifdef USE_HCACHE
-        imap_hcache_put(mdata, e);
+    imap_hcache_put(mdata, e);
 #endif /* USE_HCACHE */
 
-        m->msg_count++;
+    m->msg_count++;
 
-        h.edata = NULL;
-        idx++;
-      } while (mfhrc == -1);
+    h.edata = NULL;
+  } while (mfhrc == -1);
 
-      imap_edata_free((void **) &h.edata);
+  imap_edata_free((void **) &h.edata);
 
-      if ((mfhrc < -1) || ((rc != IMAP_RES_CONTINUE) && (rc != IMAP_RES_OK)))
-        goto bail;
-    }
+  if ((mfhrc < -1) || ((rc != IMAP_RES_CONTINUE) && (rc != IMAP_RES_OK)))
+    return -1;
+
+  return rc;
+}
+
+/// Fewest messages worth fetching on an extra connection
+#define IMAP_FETCH_CONNECTION_MIN 1000
+/// Fewest headers in an adaptive FETCH, see `$imap_fetch_chunk_time`
+#define IMAP_FETCH_CHUNK_MIN 100
+
+/**
+ * struct HeaderFetch - An extra connection downloading headers
+ *
+ * Each extra connection examines the Mailbox and downloads the headers of a
+ * range of messages, while the Mailbox's own connection downloads the rest.
+ */
+struct HeaderFetch
+{
+  struct ImapAccountData *adata; ///< Connection to the server
+  unsigned int msn_first;        ///< First Message Sequence number of the range
+  unsigned int msn_begin;        ///< First Message Sequence number of the next FETCH
+  unsigned int msn_end;          ///< Last Message Sequence number of the range
+  unsigned int fetch_msn_end;    ///< Last Message Sequence number of the current FETCH
+  bool running;                  ///< A FETCH is in progress
+  bool failed;                   ///< The connection failed
+};
+
+/**
+ * header_fetch_open - Open an extra connection to download headers
+ * @param m       Imap Selected Mailbox
+ * @param msn_end Last Message Sequence number that will be fetched
+ * @retval ptr  Connection, logged in and examining the Mailbox
+ * @retval NULL Error
+ *
+ * The connection is left in the authenticated state, so the untagged
+ * responses about the Mailbox are ignored; they'll also be sent to the
+ * Mailbox's own connection.
+ */
+static struct ImapAccountData *header_fetch_open(struct Mailbox *m, unsigned int msn_end)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  struct ImapAccountData *fadata = imap_adata_new(NULL);
+  fadata->conn = mutt_conn_new(&adata->conn->account);
+  if (!fadata->conn || (imap_login(fadata) < 0))
+    goto fail;
+
+  char buf[PATH_MAX];
+  snprintf(buf, sizeof(buf), "EXAMINE %s", mdata->munge_name);
+  if (imap_cmd_start(fadata, buf) < 0)
+    goto fail;
+
+  unsigned int uidvalidity = 0;
+  unsigned int count = 0;
+  int rc;
+  do
+  {
+    rc = imap_cmd_step(fadata);
+    if (rc != IMAP_RES_CONTINUE)
+      break;
 
-    /* In case we get new mail while fetching the headers. */
-    if (mdata->reopen & IMAP_NEWMAIL_PENDING)
+    char *pc = fadata->buf + 2;
+    if (mutt_istr_startswith(pc, "OK [UIDVALIDITY"))
+    {
+      if (mutt_str_atoui(imap_next_word(pc + 3), &uidvalidity) < 0)
+        uidvalidity = 0;
+    }
+    else if (isdigit((unsigned char) *pc) &&
+             mutt_istr_startswith(imap_next_word(pc), "EXISTS"))
     {
-      msn_end = mdata->new_mail_count;
-      while (msn_end > m->email_max)
-        mx_alloc_memory(m);
-      imap_msn_reserve(&mdata->msn, msn_end);
-      mdata->reopen &= ~IMAP_NEWMAIL_PENDING;
-      mdata->new_mail_count = 0;
+      if (mutt_str_atoui(pc, &count) < 0)
+        count = 0;
     }
+  } while (rc == IMAP_RES_CONTINUE);
 
-    /* Note: RFC3501 section 7.4.1 and RFC7162 section 3.2.10.2 say we
-     * must not get any EXPUNGE/VANISHED responses in the middle of a
-     * FETCH, nor when no command is in progress (e.g. between the
-     * chunked FETCH commands).  We previously tried to be robust by
-     * setting:
-     *   msn_begin = mdata->max_msn + 1;
-     * but with chunking (and the mythical header cache holes) this
-     * may not be correct.  So here we must assume the msn values have
-     * not been altered during or after the fetch.  */
-    msn_begin = fetch_msn_end + 1;
+  /* The Message Sequence numbers must mean the same on both connections */
+  if ((rc != IMAP_RES_OK) || (uidvalidity != mdata->uidvalidity) || (count < msn_end))
+  {
+    mutt_debug(LL_DEBUG1, "can't use an extra connection to fetch headers\n");
+    imap_logout(fadata);
+    goto fail;
   }
 
-  retval = 0;
+  return fadata;
 
-bail:
-  mutt_buffer_pool_release(&hdr_list);
-  mutt_buffer_pool_release(&buf);
-  mutt_buffer_pool_release(&tempfile);
-  mutt_file_fclose(&fp);
-  FREE(&hdrreq);
+fail:
+  imap_adata_free((void **) &fadata);
+  return NULL;
+}
 
-  return retval;
+/**
+ * header_fetch_send - Send the next FETCH of an extra connection
+ * @param f      Extra connection
+ * @param mdata  Imap Mailbox data
+ * @param evalhc If true, check the Header Cache
+ * @param hdrreq Headers to fetch
+ */
+static void header_fetch_send(struct HeaderFetch *f, struct ImapMboxData *mdata,
+                              bool evalhc, const char *hdrreq)
+{
+  f->running = false;
+  if (f->failed || (f->msn_begin > f->msn_end))
+    return;
+
+  const long c_imap_fetch_chunk_size =
+      cs_subset_long(NeoMutt->sub, "imap_fetch_chunk_size");
+  const unsigned int chunk = (c_imap_fetch_chunk_size > 0) ? c_imap_fetch_chunk_size : UINT_MAX;
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+  if (imap_fetch_msn_seqset(buf, mdata, evalhc, f->msn_begin, f->msn_end, chunk,
+                            &f->fetch_msn_end))
+  {
+    char *cmd = NULL;
+    mutt_str_asprintf(&cmd, "FETCH %s (UID FLAGS INTERNALDATE RFC822.SIZE %s)",
+                      mutt_buffer_string(buf), hdrreq);
+    if (imap_cmd_start(f->adata, cmd) < 0)
+      f->failed = true;
+    else
+      f->running = true;
+    FREE(&cmd);
+  }
+  mutt_buffer_pool_release(&buf);
 }
 
 /**
- * imap_read_headers - Read headers from the server
- * @param m                Imap Selected Mailbox
- * @param msn_begin        First Message Sequence Number
- * @param msn_end          Last Message Sequence Number
- * @param initial_download true, if this is the first opening of the mailbox
- * @retval num Last MSN
- * @retval -1  Failure
+ * header_fetch_start - Share the download of headers between extra connections
+ * @param[in]     m         Imap Selected Mailbox
+ * @param[in,out] msn_begin First Message Sequence number, for the Mailbox's own connection
+ * @param[in]     msn_end   Last Message Sequence number
+ * @param[in]     evalhc    If true, check the Header Cache
+ * @param[in]     hdrreq    Headers to fetch
+ * @param[out]    fetches   Extra connections
+ * @retval num Number of extra connections
  *
- * Changed to read many headers instead of just one. It will return the msn of
- * the last message read. It will return a value other than msn_end if mail
- * comes in while downloading headers (in theory).
+ * The messages are split into equal ranges.  The extra connections fetch the
+ * first ones and msn_begin is moved to the start of the last one.
  */
-int imap_read_headers(struct Mailbox *m, unsigned int msn_begin,
-                      unsigned int msn_end, bool initial_download)
+static int header_fetch_start(struct Mailbox *m, unsigned int *msn_begin,
+                              unsigned int msn_end, bool evalhc,
+                              const char *hdrreq, struct HeaderFetch **fetches)
 {
-  int oldmsgcount;
-  unsigned int maxuid = 0;
-  int retval = -1;
-  bool evalhc = false;
-
-#ifdef USE_HCACHE
-  void *uidvalidity = NULL;
-  void *puid_next = NULL;
-  unsigned int uid_next = 0;
-  bool has_condstore = false;
-  bool has_qresync = false;
-  bool eval_condstore = false;
-  bool eval_qresync = false;
-  unsigned long long *pmodseq = NULL;
-  unsigned long long hc_modseq = 0;
-  char *uid_seqset = NULL;
-#endif /* USE_HCACHE */
+  *fetches = NULL;
 
-  struct ImapAccountData *adata = imap_adata_get(m);
-  struct ImapMboxData *mdata = imap_mdata_get(m);
-  if (!adata || (adata->mailbox != m))
-    return -1;
+  const short c_imap_fetch_connections =
+      cs_subset_number(NeoMutt->sub, "imap_fetch_connections");
+  if ((c_imap_fetch_connections < 2) || (msn_end < *msn_begin))
+    return 0;
 
-#ifdef USE_HCACHE
-retry:
-#endif /* USE_HCACHE */
+  const unsigned int count = msn_end - *msn_begin + 1;
+  unsigned int want = MIN((unsigned int) c_imap_fetch_connections,
+                          count / IMAP_FETCH_CONNECTION_MIN);
+  if (want < 2)
+    return 0;
 
-  /* make sure context has room to hold the mailbox */
-  while (msn_end > m->email_max)
-    mx_alloc_memory(m);
-  imap_msn_reserve(&mdata->msn, msn_end);
-  imap_alloc_uid_hash(adata, msn_end);
+  struct HeaderFetch *f = mutt_mem_calloc(want - 1, sizeof(struct HeaderFetch));
+  int num = 0;
+  for (; num < (int) (want - 1); num++)
+  {
+    f[num].adata = header_fetch_open(m, msn_end);
+    if (!f[num].adata)
+      break;
+  }
 
-  oldmsgcount = m->msg_count;
-  mdata->reopen &= ~(IMAP_REOPEN_ALLOW | IMAP_NEWMAIL_PENDING);
-  mdata->new_mail_count = 0;
+  if (num == 0)
+  {
+    FREE(&f);
+    return 0;
+  }
 
-#ifdef USE_HCACHE
-  imap_hcache_open(adata, mdata);
+  mutt_debug(LL_DEBUG2, "fetching headers on %d extra connections\n", num);
 
-  if (mdata->hcache && initial_download)
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  const unsigned int share = count / (num + 1);
+  for (int i = 0; i < num; i++)
   {
-    size_t dlen = 0;
-    uidvalidity = mutt_hcache_fetch_raw(mdata->hcache, "/UIDVALIDITY", 12, &dlen);
-    puid_next = mutt_hcache_fetch_raw(mdata->hcache, "/UIDNEXT", 8, &dlen);
-    if (puid_next)
-    {
-      uid_next = *(unsigned int *) puid_next;
-      mutt_hcache_free_raw(mdata->hcache, &puid_next);
-    }
+    f[i].msn_first = *msn_begin + (i * share);
+    f[i].msn_begin = f[i].msn_first;
+    f[i].msn_end = f[i].msn_first + share - 1;
+    header_fetch_send(&f[i], mdata, evalhc, hdrreq);
+  }
+  *msn_begin += num * share;
 
-    if (mdata->modseq)
-    {
-      const bool c_imap_condstore =
-          cs_subset_bool(NeoMutt->sub, "imap_condstore");
-      if ((adata->capabilities & IMAP_CAP_CONDSTORE) && c_imap_condstore)
-        has_condstore = true;
+  *fetches = f;
+  return num;
+}
 
-      /* If IMAP_CAP_QRESYNC and ImapQResync then NeoMutt sends ENABLE QRESYNC.
-       * If we receive an ENABLED response back, then adata->qresync is set.  */
-      if (adata->qresync)
-        has_qresync = true;
-    }
+/**
+ * header_fetch_poll - Read the headers from the extra connections
+ * @param[in]  m       Imap Selected Mailbox
+ * @param[in]  fetches Extra connections
+ * @param[in]  num     Number of extra connections
+ * @param[in]  wait    If true, wait for one header from each connection
+ * @param[in]  evalhc  If true, check the Header Cache
+ * @param[in]  hdrreq  Headers to fetch
+ * @param[in]  hdr     Buffer for the headers
+ * @param[in]  fp      Temporary file, if memory streams aren't supported
+ * @param[out] maxuid  Highest UID seen
+ * @retval true Some connections are still fetching
+ *
+ * If wait is false, only the headers that have already arrived are read.
+ */
+static bool header_fetch_poll(struct Mailbox *m, struct HeaderFetch *fetches,
+                              int num, bool wait, bool evalhc, const char *hdrreq,
+                              struct Buffer *hdr, FILE *fp, unsigned int *maxuid)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  bool running = false;
 
-    if (uidvalidity && uid_next && (*(uint32_t *) uidvalidity == mdata->uidvalidity))
+  for (int i = 0; i < num; i++)
+  {
+    struct HeaderFetch *f = &fetches[i];
+    while (f->running && (wait || (mutt_socket_poll(f->adata->conn, 0) > 0)))
     {
-      size_t dlen2 = 0;
-      evalhc = true;
-      pmodseq = mutt_hcache_fetch_raw(mdata->hcache, "/MODSEQ", 7, &dlen2);
-      if (pmodseq)
+      int rc = read_headers_fetch_next(m, f->adata, hdr, fp, f->fetch_msn_end, maxuid);
+      if (rc == IMAP_RES_OK)
       {
-        hc_modseq = *pmodseq;
-        mutt_hcache_free_raw(mdata->hcache, (void **) &pmodseq);
+        f->msn_begin = f->fetch_msn_end + 1;
+        header_fetch_send(f, mdata, evalhc, hdrreq);
       }
-      if (hc_modseq)
+      else if (rc < 0)
       {
-        if (has_qresync)
-        {
-          uid_seqset = imap_hcache_get_uid_seqset(mdata);
-          if (uid_seqset)
-            eval_qresync = true;
-        }
-
-        if (!eval_qresync && has_condstore)
-          eval_condstore = true;
+        mutt_debug(LL_DEBUG1, "extra connection failed fetching headers %u-%u\n",
+                   f->msn_begin, f->msn_end);
+        f->running = false;
+        f->failed = true;
       }
+
+      if (wait)
+        break;
     }
-    mutt_hcache_free_raw(mdata->hcache, &uidvalidity);
+    running |= f->running;
   }
-  if (evalhc)
+
+  return running;
+}
+
+/**
+ * header_fetch_free - Close the extra connections
+ * @param fetches Extra connections
+ * @param num     Number of extra connections
+ */
+static void header_fetch_free(struct HeaderFetch **fetches, int num)
+{
+  if (!fetches || !*fetches)
+    return;
+
+  for (int i = 0; i < num; i++)
   {
-    if (eval_qresync)
-    {
-      if (read_headers_qresync_eval_cache(adata, uid_seqset) < 0)
-        goto bail;
-    }
-    else
-    {
-      if (read_headers_normal_eval_cache(adata, msn_end, uid_next, has_condstore || has_qresync,
-                                         eval_condstore) < 0)
-        goto bail;
-    }
+    struct HeaderFetch *f = &(*fetches)[i];
+    /* Don't wait for the rest of an abandoned FETCH */
+    if (!f->running && !f->failed)
+      imap_logout(f->adata);
+    imap_adata_free((void **) &f->adata);
+  }
 
-    if ((eval_condstore || eval_qresync) && (hc_modseq != mdata->modseq))
+  FREE(fetches);
+}
+
+/**
+ * read_headers_fetch_range - Retrieve a range of new messages from the server
+ * @param[in]  m                Imap Selected Mailbox
+ * @param[in]  msn_begin        First Message Sequence number
+ * @param[in]  msn_end          Last Message Sequence number
+ * @param[in]  evalhc           If true, check the Header Cache
+ * @param[out] maxuid           Highest UID seen
+ * @param[in]  initial_download true, if this is the first opening of the mailbox
+ * @param[in]  progress         Progress bar, may be NULL
+ * @param[in]  hdrreq           Headers to fetch
+ * @param[in]  hdr              Buffer for the headers
+ * @param[in]  fp               Temporary file, if memory streams aren't supported
+ * @param[in]  fetches          Extra connections to read between headers
+ * @param[in]  num_fetches      Number of extra connections
+ * @retval  0 Success
+ * @retval -1 Error
+ */
+static int read_headers_fetch_range(struct Mailbox *m, unsigned int msn_begin,
+                                    unsigned int msn_end, bool evalhc,
+                                    unsigned int *maxuid, bool initial_download,
+                                    struct Progress *progress, const char *hdrreq,
+                                    struct Buffer *hdr, FILE *fp,
+                                    struct HeaderFetch *fetches, int num_fetches)
+{
+  int rc = IMAP_RES_OK;
+  unsigned int fetch_msn_end = msn_begin - 1;
+  int msgno = msn_begin;
+
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  struct Buffer *buf = mutt_buffer_pool_get();
+
+  const long c_imap_fetch_chunk_size =
+      cs_subset_long(NeoMutt->sub, "imap_fetch_chunk_size");
+  const short c_imap_fetch_chunk_time =
+      cs_subset_number(NeoMutt->sub, "imap_fetch_chunk_time");
+  unsigned int chunk = (c_imap_fetch_chunk_size > 0) ? c_imap_fetch_chunk_size : UINT_MAX;
+  const bool adaptive = (c_imap_fetch_chunk_time > 0);
+  if (adaptive && (c_imap_fetch_chunk_size <= 0))
+    chunk = IMAP_FETCH_CHUNK_MIN;
+
+  /* When adapting, the next chunk is sent once the last one is half read */
+  bool chunk_sent = false;
+  int chunk_start = 0; // Headers read when the last chunk was sent
+  int chunk_next = 0;  // Headers to read before sending the next chunk
+  int chunk_end = 0;   // Headers to read before all the chunks are done
+  uint64_t chunk_time = 0;
+
+  /* NOTE:
+   *   The (fetch_msn_end < msn_end) used to be important to prevent
+   *   an infinite loop, in the event the server did not return all
+   *   the headers (due to a pending expunge, for example).
+   *
+   *   I believe the new chunking imap_fetch_msn_seqset()
+   *   implementation and "msn_begin = fetch_msn_end + 1" assignment
+   *   makes the comparison unneeded, but to be cautious I'm keeping it.
+   */
+  while (true)
+  {
+    if ((rc == IMAP_RES_OK) || (chunk_sent && (m->msg_count >= chunk_next)))
     {
-      if (read_headers_condstore_qresync_updates(adata, msn_end, uid_next,
-                                                 hc_modseq, eval_qresync) < 0)
+      /* In case we get new mail while fetching the headers. */
+      if (mdata->reopen & IMAP_NEWMAIL_PENDING)
       {
-        goto bail;
+        msn_end = mdata->new_mail_count;
+        mx_alloc_memory(m, msn_end);
+        imap_msn_reserve(&mdata->msn, msn_end);
+        mdata->reopen &= ~IMAP_NEWMAIL_PENDING;
+        mdata->new_mail_count = 0;
+      }
+
+      if (adaptive && chunk_sent)
+      {
+        /* Size the next chunk to take about $imap_fetch_chunk_time */
+        const uint64_t now = mutt_date_epoch_ms();
+        const uint64_t rate = (m->msg_count - chunk_start) * 1000 /
+                              MAX(now - chunk_time, 1);
+        chunk = MIN(rate * c_imap_fetch_chunk_time / 1000, (uint64_t) chunk * 2);
+        chunk = MAX(chunk, IMAP_FETCH_CHUNK_MIN);
+      }
+      chunk_sent = false;
+
+      /* Note: RFC3501 section 7.4.1 and RFC7162 section 3.2.10.2 say we
+       * must not get any EXPUNGE/VANISHED responses in the middle of a
+       * FETCH, nor when no command is in progress (e.g. between the
+       * chunked FETCH commands).  We previously tried to be robust by
+       * setting:
+       *   msn_begin = mdata->max_msn + 1;
+       * but with chunking (and the mythical header cache holes) this
+       * may not be correct.  So here we must assume the msn values have
+       * not been altered during or after the fetch.  */
+      msn_begin = fetch_msn_end + 1;
+
+      const unsigned int count =
+          (fetch_msn_end < msn_end) ?
+              imap_fetch_msn_seqset(buf, mdata, evalhc, msn_begin, msn_end,
+                                    chunk, &fetch_msn_end) :
+              0;
+      if (count != 0)
+      {
+        char *cmd = NULL;
+        mutt_str_asprintf(&cmd, "FETCH %s (UID FLAGS INTERNALDATE RFC822.SIZE %s)",
+                          mutt_buffer_string(buf), hdrreq);
+        imap_cmd_start(adata, cmd);
+        FREE(&cmd);
+
+        if (adaptive)
+        {
+          if ((rc == IMAP_RES_OK) || (chunk_end < m->msg_count))
+            chunk_end = m->msg_count;
+          chunk_sent = true;
+          chunk_start = m->msg_count;
+          chunk_next = chunk_end + (count / 2);
+          chunk_end += count;
+          chunk_time = mutt_date_epoch_ms();
+        }
+        rc = IMAP_RES_CONTINUE;
+      }
+      else if (rc == IMAP_RES_OK)
+      {
+        break;
       }
     }
 
-    /* Look for the first empty MSN and start there */
-    while (msn_begin <= msn_end)
+    if (initial_download && SigInt && query_abort_header_download(adata))
+      goto bail;
+
+    if (progress)
+      mutt_progress_update(progress, num_fetches ? m->msg_count : msgno, -1);
+    msgno++;
+
+    rc = read_headers_fetch_next(m, adata, hdr, fp, fetch_msn_end, maxuid);
+    if (rc < 0)
+      goto bail;
+
+    if (num_fetches)
     {
-      if (!imap_msn_get(&mdata->msn, msn_begin - 1))
-        break;
-      msn_begin++;
+      header_fetch_poll(m, fetches, num_fetches, false, evalhc, hdrreq, hdr, fp, maxuid);
     }
   }
-#endif /* USE_HCACHE */
 
-  if (read_headers_fetch_new(m, msn_begin, msn_end, evalhc, &maxuid, initial_download) < 0)
-    goto bail;
+  mutt_buffer_pool_release(&buf);
+  return 0;
 
-#ifdef USE_HCACHE
-  if (eval_qresync && initial_download)
+bail:
+  mutt_buffer_pool_release(&buf);
+  return -1;
+}
+
+/**
+ * read_headers_fetch_new - Retrieve new messages from the server
+ * @param[in]  m                Imap Selected Mailbox
+ * @param[in]  msn_begin        First Message Sequence number
+ * @param[in]  msn_end          Last Message Sequence number
+ * @param[in]  evalhc           If true, check the Header Cache
+ * @param[out] maxuid           Highest UID seen
+ * @param[in]  initial_download true, if this is the first opening of the mailbox
+ * @retval  0 Success
+ * @retval -1 Error
+ *
+ * On the first download, the headers may be shared between several
+ * connections, see `$imap_fetch_connections`.  If an extra connection fails,
+ * the rest of its headers are fetched by the Mailbox's own connection.
+ */
+static int read_headers_fetch_new(struct Mailbox *m, unsigned int msn_begin,
+                                  unsigned int msn_end, bool evalhc,
+                                  unsigned int *maxuid, bool initial_download)
+{
+  int retval = -1;
+  struct Progress progress;
+  char *hdrreq = NULL;
+  FILE *fp = NULL;
+  struct Buffer *hdr = NULL;
+  struct HeaderFetch *fetches = NULL;
+  int num_fetches = 0;
+  static const char *const want_headers =
+      "DATE FROM SENDER SUBJECT TO CC MESSAGE-ID REFERENCES CONTENT-TYPE "
+      "CONTENT-DESCRIPTION IN-REPLY-TO REPLY-TO LINES LIST-POST X-LABEL "
+      "X-ORIGINAL-TO";
+
+  struct ImapAccountData *adata = imap_adata_get(m);
+
+  if (!adata || (adata->mailbox != m))
+    return -1;
+
+  struct Buffer *hdr_list = mutt_buffer_pool_get();
+  mutt_buffer_strcpy(hdr_list, want_headers);
+  const char *const c_imap_headers =
+      cs_subset_string(NeoMutt->sub, "imap_headers");
+  if (c_imap_headers)
+  {
+    mutt_buffer_addch(hdr_list, ' ');
+    mutt_buffer_addstr(hdr_list, c_imap_headers);
+  }
+#ifdef USE_AUTOCRYPT
+  const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
+  if (c_autocrypt)
+  {
+    mutt_buffer_addch(hdr_list, ' ');
+    mutt_buffer_addstr(hdr_list, "AUTOCRYPT");
+  }
+#endif
+
+  if (adata->capabilities & IMAP_CAP_IMAP4REV1)
+  {
+    mutt_str_asprintf(&hdrreq, "BODY.PEEK[HEADER.FIELDS (%s)]", mutt_buffer_string(hdr_list));
+  }
+  else if (adata->capabilities & IMAP_CAP_IMAP4)
+  {
+    mutt_str_asprintf(&hdrreq, "RFC822.HEADER.LINES (%s)", mutt_buffer_string(hdr_list));
+  }
+  else
+  { /* Unable to fetch headers for lower versions */
+    mutt_error(_("Unable to fetch headers from this IMAP server version"));
+    goto bail;
+  }
+
+  mutt_buffer_pool_release(&hdr_list);
+
+  /* instead of downloading all headers and then parsing them, we parse them
+   * as they come in.  Each one is kept in memory, in a reused Buffer. */
+#ifndef HAVE_FMEMOPEN
+  fp = mutt_file_mkstemp();
+  if (!fp)
+  {
+    mutt_perror(_("Can't create temporary file"));
+    goto bail;
+  }
+#endif
+  hdr = mutt_buffer_pool_get();
+
+  if (m->verbose)
+  {
+    mutt_progress_init(&progress, _("Fetching message headers..."),
+                       MUTT_PROGRESS_READ, msn_end);
+  }
+
+  if (initial_download)
+    num_fetches = header_fetch_start(m, &msn_begin, msn_end, evalhc, hdrreq, &fetches);
+
+  struct Progress *pbar = m->verbose ? &progress : NULL;
+  if (read_headers_fetch_range(m, msn_begin, msn_end, evalhc, maxuid, initial_download,
+                               pbar, hdrreq, hdr, fp, fetches, num_fetches) < 0)
+  {
+    goto bail;
+  }
+
+  /* Read the rest of the headers from the extra connections */
+  while (header_fetch_poll(m, fetches, num_fetches, true, evalhc, hdrreq, hdr, fp, maxuid))
+  {
+    if (SigInt && query_abort_header_download(adata))
+      goto bail;
+
+    if (pbar)
+      mutt_progress_update(pbar, m->msg_count, -1);
+  }
+
+  /* Fetch anything that a failed connection missed */
+  for (int i = 0; i < num_fetches; i++)
+  {
+    if (fetches[i].failed &&
+        (read_headers_fetch_range(m, fetches[i].msn_first, fetches[i].msn_end, true,
+                                  maxuid, initial_download, pbar, hdrreq, hdr,
+                                  fp, NULL, 0) < 0))
+    {
+      goto bail;
+    }
+  }
+
+  retval = 0;
+
+bail:
+  mutt_buffer_pool_release(&hdr_list);
+  mutt_buffer_pool_release(&hdr);
+  mutt_file_fclose(&fp);
+  FREE(&hdrreq);
+  header_fetch_free(&fetches, num_fetches);
+
+  return retval;
+}
+
+/**
+ * imap_read_headers - Read headers from the server
+ * @param m                Imap Selected Mailbox
+ * @param msn_begin        First Message Sequence Number
+ * @param msn_end          Last Message Sequence Number
+ * @param initial_download true, if this is the first opening of the mailbox
+ * @retval num Last MSN
+ * @retval -1  Failure
+ *
+ * Changed to read many headers instead of just one. It will return the msn of
+ * the last message read. It will return a value other than msn_end if mail
+ * comes in while downloading headers (in theory).
+ */
+int imap_read_headers(struct Mailbox *m, unsigned int msn_begin,
+                      unsigned int msn_end, bool initial_download)
+{
+  int oldmsgcount;
+  unsigned int maxuid = 0;
+  int retval = -1;
+  bool evalhc = false;
+
+#ifdef USE_HCACHE
+  void *uidvalidity = NULL;
+  void *puid_next = NULL;
+  unsigned int uid_next = 0;
+  bool has_condstore = false;
+  bool has_qresync = false;
+  bool eval_condstore = false;
+  bool eval_qresync = false;
+  unsigned long long *pmodseq = NULL;
+  unsigned long long hc_modseq = 0;
+  char *uid_seqset = NULL;
+#endif /* USE_HCACHE */
+
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (!adata || (adata->mailbox != m))
+    return -1;
+
+#ifdef USE_HCACHE
+retry:
+#endif /* USE_HCACHE */
+
+  /* make sure context has room to hold the mailbox */
+  mx_alloc_memory(m, msn_end);
+  imap_msn_reserve(&mdata->msn, msn_end);
+  imap_alloc_uid_hash(adata, msn_end);
+
+  oldmsgcount = m->msg_count;
+  mdata->reopen &= ~(IMAP_REOPEN_ALLOW | IMAP_NEWMAIL_PENDING);
+  mdata->new_mail_count = 0;
+
+#ifdef USE_HCACHE
+  imap_hcache_open(adata, mdata);
+  mutt_hcache_begin_txn(mdata->hcache);
+
+  if (mdata->hcache && initial_download)
+  {
+    size_t dlen = 0;
+    uidvalidity = mutt_hcache_fetch_raw(mdata->hcache, "/UIDVALIDITY", 12, &dlen);
+    puid_next = mutt_hcache_fetch_raw(mdata->hcache, "/UIDNEXT", 8, &dlen);
+    if (puid_next)
+    {
+      uid_next = *(unsigned int *) puid_next;
+      mutt_hcache_free_raw(mdata->hcache, &puid_next);
+    }
+
+    if (mdata->modseq)
+    {
+      const bool c_imap_condstore =
+          cs_subset_bool(NeoMutt->sub, "imap_condstore");
+      if ((adata->capabilities & IMAP_CAP_CONDSTORE) && c_imap_condstore)
+        has_condstore = true;
+
+      /* If IMAP_CAP_QRESYNC and ImapQResync then NeoMutt sends ENABLE QRESYNC.
+       * If we receive an ENABLED response back, then adata->qresync is set.  */
+      if (adata->qresync)
+        has_qresync = true;
+    }
+
+    if (uidvalidity && uid_next && (*(uint32_t *) uidvalidity == mdata->uidvalidity))
+    {
+      size_t dlen2 = 0;
+      evalhc = true;
+      pmodseq = mutt_hcache_fetch_raw(mdata->hcache, "/MODSEQ", 7, &dlen2);
+      if (pmodseq)
+      {
+        hc_modseq = *pmodseq;
+        mutt_hcache_free_raw(mdata->hcache, (void **) &pmodseq);
+      }
+      if (hc_modseq)
+      {
+        if (has_qresync)
+        {
+          uid_seqset = imap_hcache_get_uid_seqset(mdata);
+          if (uid_seqset)
+            eval_qresync = true;
+        }
+
+        if (!eval_qresync && has_condstore)
+        {
+          eval_condstore = true;
+          uid_seqset = imap_hcache_get_uid_seqset(mdata);
+        }
+      }
+    }
+    mutt_hcache_free_raw(mdata->hcache, &uidvalidity);
+  }
+  if (evalhc)
+  {
+    int rc_cache = 1;
+    if (eval_qresync)
+    {
+      /* imap_read_headers_cached() may have read them already */
+      if ((m->msg_count == 0) && (read_headers_qresync_eval_cache(adata, uid_seqset) < 0))
+        goto bail;
+      rc_cache = 0;
+    }
+    else if (eval_condstore && uid_seqset)
+    {
+      rc_cache = read_headers_condstore_eval_cache(adata, uid_seqset, msn_end, uid_next);
+      if (rc_cache < 0)
+        goto bail;
+    }
+
+    if (rc_cache != 0)
+    {
+      if (read_headers_normal_eval_cache(adata, msn_end, uid_next, has_condstore || has_qresync,
+                                         eval_condstore) < 0)
+        goto bail;
+    }
+
+    if ((eval_condstore || eval_qresync) && (hc_modseq != mdata->modseq))
+    {
+      if (read_headers_condstore_qresync_updates(adata, msn_end, uid_next,
+                                                 hc_modseq, eval_qresync) < 0)
+      {
+        goto bail;
+      }
+    }
+
+    /* Look for the first empty MSN and start there */
+    while (msn_begin <= msn_end)
+    {
+      if (!imap_msn_get(&mdata->msn, msn_begin - 1))
+        break;
+      msn_begin++;
+    }
+  }
+#endif /* USE_HCACHE */
+
+  if (read_headers_fetch_new(m, msn_begin, msn_end, evalhc, &maxuid, initial_download) < 0)
+    goto bail;
+
+#ifdef USE_HCACHE
+  if (eval_qresync && initial_download)
   {
     if (imap_verify_qresync(m) != 0)
     {
@@ -1462,18 +2173,22 @@ retry:
     else
       mutt_hcache_delete_record(mdata->hcache, "/MODSEQ", 7);
 
-    if (has_qresync)
+    if (has_condstore || has_qresync)
       imap_hcache_store_uid_seqset(mdata);
     else
       imap_hcache_clear_uid_seqset(mdata);
   }
-#endif /* USE_HCACHE */
+  else if (mdata->modseq)
+  {
+    /* keep the cached UIDs in step with the server, for the next CONDSTORE open */
+    imap_hcache_store_uid_seqset(mdata);
+  }
+#endif /* USE_HCACHE */
 
   if (m->msg_count > oldmsgcount)
   {
-    /* TODO: it's not clear to me why we are calling mx_alloc_memory
-     *       yet again. */
-    mx_alloc_memory(m);
+    /* Keep a free slot for the next new message */
+    mx_alloc_memory(m, m->msg_count + 1);
   }
 
   mdata->reopen |= IMAP_REOPEN_ALLOW;
@@ -1507,8 +2222,6 @@ int imap_append_message(struct Mailbox *m, struct Message *msg)
   char imap_flags[128];
   size_t len;
   struct Progress progress;
-  size_t sent;
-  int c, last;
   int rc;
 
   struct ImapAccountData *adata = imap_adata_get(m);
@@ -1521,19 +2234,7 @@ int imap_append_message(struct Mailbox *m, struct Message *msg)
     goto fail;
   }
 
-  /* currently we set the \Seen flag on all messages, but probably we
-   * should scan the message Status header for flag info. Since we're
-   * already rereading the whole file for length it isn't any more
-   * expensive (it'd be nice if we had the file size passed in already
-   * by the code that writes the file, but that's a lot of changes.
-   * Ideally we'd have an Email structure with flag info here... */
-  for (last = EOF, len = 0; (c = fgetc(fp)) != EOF; last = c)
-  {
-    if ((c == '\n') && (last != '\r'))
-      len++;
-
-    len++;
-  }
+  len = append_crlf_length(fp);
   rewind(fp);
 
   if (m->verbose)
@@ -1553,39 +2254,30 @@ int imap_append_message(struct Mailbox *m, struct Message *msg)
   if (msg->flags.draft)
     mutt_str_cat(imap_flags, sizeof(imap_flags), " \\Draft");
 
-  snprintf(buf, sizeof(buf), "APPEND %s (%s) \"%s\" {%lu}", mdata->munge_name,
-           imap_flags + 1, internaldate, (unsigned long) len);
+  /* A non-synchronising literal saves waiting for the server's go-ahead */
+  const bool sync = !((adata->capabilities & IMAP_CAP_LITERAL_PLUS) ||
+                      ((adata->capabilities & IMAP_CAP_LITERAL_MINUS) &&
+                       (len <= IMAP_LITERAL_MINUS_MAX)));
 
-  imap_cmd_start(adata, buf);
+  snprintf(buf, sizeof(buf), "APPEND %s (%s) \"%s\" {%lu%s}", mdata->munge_name,
+           imap_flags + 1, internaldate, (unsigned long) len, sync ? "" : "+");
 
-  do
-  {
-    rc = imap_cmd_step(adata);
-  } while (rc == IMAP_RES_CONTINUE);
-
-  if (rc != IMAP_RES_RESPOND)
-    goto cmd_step_fail;
+  if (imap_cmd_start(adata, buf) < 0)
+    goto fail;
 
-  for (last = EOF, sent = len = 0; (c = fgetc(fp)) != EOF; last = c)
+  if (sync)
   {
-    if ((c == '\n') && (last != '\r'))
-      buf[len++] = '\r';
-
-    buf[len++] = c;
-
-    if (len > sizeof(buf) - 3)
+    do
     {
-      sent += len;
-      if (flush_buffer(buf, &len, adata->conn) < 0)
-        goto fail;
-      if (m->verbose)
-        mutt_progress_update(&progress, sent, -1);
-    }
+      rc = imap_cmd_step(adata);
+    } while (rc == IMAP_RES_CONTINUE);
+
+    if (rc != IMAP_RES_RESPOND)
+      goto cmd_step_fail;
   }
 
-  if (len)
-    if (flush_buffer(buf, &len, adata->conn) < 0)
-      goto fail;
+  if (append_send_crlf(fp, adata->conn, m->verbose ? &progress : NULL) < 0)
+    goto fail;
 
   if (mutt_socket_send(adata->conn, "\r\n") < 0)
     goto fail;
@@ -1829,148 +2521,695 @@ int imap_cache_clean(struct Mailbox *m)
   if (!adata || (adata->mailbox != m))
     return -1;
 
-  mdata->bcache = msg_cache_open(m);
-  mutt_bcache_list(mdata->bcache, msg_cache_clean_cb, mdata);
+  mdata->bcache = msg_cache_open(m);
+  mutt_bcache_list(mdata->bcache, msg_cache_clean_cb, mdata);
+
+  return 0;
+}
+
+/**
+ * imap_set_flags - fill the message header according to the server flags
+ * @param[in]  m              Imap Selected Mailbox
+ * @param[in]  e              Email
+ * @param[in]  s              Command string
+ * @param[out] server_changes Set to true if the flags have changed
+ * @retval ptr  The end of flags string
+ * @retval NULL Failure
+ *
+ * Expects a flags line of the form "FLAGS (flag flag ...)"
+ *
+ * imap_set_flags: fill out the message header according to the flags from
+ * the server. Expects a flags line of the form "FLAGS (flag flag ...)"
+ *
+ * Sets server_changes to 1 if a change to a flag is made, or in the
+ * case of e->changed, if a change to a flag _would_ have been
+ * made.
+ */
+char *imap_set_flags(struct Mailbox *m, struct Email *e, char *s, bool *server_changes)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  if (!adata || (adata->mailbox != m))
+    return NULL;
+
+  struct ImapHeader newh = { 0 };
+  struct ImapEmailData old_edata = { 0 };
+  int local_changes = e->changed;
+
+  struct ImapEmailData *edata = e->edata;
+  newh.edata = edata;
+
+  mutt_debug(LL_DEBUG2, "parsing FLAGS\n");
+  s = msg_parse_flags(&newh, s);
+  if (!s)
+    return NULL;
+
+  /* Update tags system */
+  /* We take a copy of the tags so we can split the string */
+  char *tags_copy = mutt_str_dup(edata->flags_remote);
+  driver_tags_replace(&e->tags, tags_copy);
+  FREE(&tags_copy);
+
+  /* YAUH (yet another ugly hack): temporarily set context to
+   * read-write even if it's read-only, so *server* updates of
+   * flags can be processed by mutt_set_flag. mailbox->changed must
+   * be restored afterwards */
+  bool readonly = m->readonly;
+  m->readonly = false;
+
+  /* This is redundant with the following two checks. Removing:
+   * mutt_set_flag (m, e, MUTT_NEW, !(edata->read || edata->old)); */
+  set_changed_flag(m, e, local_changes, server_changes, MUTT_OLD, old_edata.old,
+                   edata->old, e->old);
+  set_changed_flag(m, e, local_changes, server_changes, MUTT_READ,
+                   old_edata.read, edata->read, e->read);
+  set_changed_flag(m, e, local_changes, server_changes, MUTT_DELETE,
+                   old_edata.deleted, edata->deleted, e->deleted);
+  set_changed_flag(m, e, local_changes, server_changes, MUTT_FLAG,
+                   old_edata.flagged, edata->flagged, e->flagged);
+  set_changed_flag(m, e, local_changes, server_changes, MUTT_REPLIED,
+                   old_edata.replied, edata->replied, e->replied);
+
+  /* this message is now definitively *not* changed (mutt_set_flag
+   * marks things changed as a side-effect) */
+  if (local_changes == 0)
+    e->changed = false;
+  m->changed &= !readonly;
+  m->readonly = readonly;
+
+  return s;
+}
+
+/// Deepest nesting of multiparts that will be displayed from a partial fetch
+#define IMAP_PART_DEPTH_MAX 8
+
+/**
+ * struct ImapPart - One part of a message, from its BODYSTRUCTURE
+ */
+struct ImapPart
+{
+  char section[64];       ///< Section number, e.g. "2.1", or "" for the message
+  char *type;             ///< MIME type, e.g. "text"
+  char *subtype;          ///< MIME subtype, e.g. "plain"
+  char *boundary;         ///< Boundary of a multipart
+  unsigned long size;     ///< Size of the encoded body, in bytes
+  bool fetch;             ///< Should the body be downloaded?
+  struct Buffer mime;     ///< MIME headers of the part
+  struct Buffer body;     ///< Body of the part, if it was downloaded
+  struct ImapPart *parts; ///< Parts of a multipart
+  struct ImapPart *next;  ///< Next part of the parent multipart
+};
+
+/**
+ * imap_part_free - Free a tree of ImapParts
+ * @param ptr ImapPart to free
+ */
+static void imap_part_free(struct ImapPart **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct ImapPart *part = *ptr;
+  while (part)
+  {
+    struct ImapPart *next = part->next;
+    imap_part_free(&part->parts);
+    FREE(&part->type);
+    FREE(&part->subtype);
+    FREE(&part->boundary);
+    mutt_buffer_dealloc(&part->mime);
+    mutt_buffer_dealloc(&part->body);
+    FREE(&part);
+    part = next;
+  }
+
+  *ptr = NULL;
+}
+
+/**
+ * bodystruct_string - Parse a string, number or NIL from a BODYSTRUCTURE
+ * @param[in,out] s   String to parse
+ * @param[out]    buf Buffer for the string, empty for NIL
+ * @retval  0 Success
+ * @retval -1 Error, or a literal
+ */
+static int bodystruct_string(char **s, struct Buffer *buf)
+{
+  mutt_buffer_reset(buf);
+  char *p = *s;
+  SKIPWS(p);
+
+  if (*p == '"')
+  {
+    for (p++; *p && (*p != '"'); p++)
+    {
+      if ((*p == '\\') && p[1])
+        p++;
+      mutt_buffer_addch(buf, *p);
+    }
+    if (*p != '"')
+      return -1;
+    *s = p + 1;
+    return 0;
+  }
+
+  char *start = p;
+  while (*p && !IS_SPACE(*p) && (*p != '(') && (*p != ')') && (*p != '{'))
+    p++;
+  if (p == start)
+    return -1;
+
+  if (((p - start) != 3) || !mutt_istrn_equal(start, "NIL", 3))
+    mutt_buffer_addstr_n(buf, start, p - start);
+  *s = p;
+  return 0;
+}
+
+/**
+ * bodystruct_skip - Skip one item of a BODYSTRUCTURE, e.g. a string or a list
+ * @param[in,out] s String to parse
+ * @retval  0 Success
+ * @retval -1 Error, or a literal
+ */
+static int bodystruct_skip(char **s)
+{
+  char *p = *s;
+  int depth = 0;
+
+  do
+  {
+    SKIPWS(p);
+    if (*p == '(')
+    {
+      depth++;
+      p++;
+    }
+    else if (*p == ')')
+    {
+      if (depth == 0)
+        return -1;
+      depth--;
+      p++;
+    }
+    else if (*p == '"')
+    {
+      for (p++; *p && (*p != '"'); p++)
+        if ((*p == '\\') && p[1])
+          p++;
+      if (*p != '"')
+        return -1;
+      p++;
+    }
+    else if ((*p == '{') || (*p == '\0'))
+    {
+      return -1;
+    }
+    else
+    {
+      while (*p && !IS_SPACE(*p) && (*p != '(') && (*p != ')'))
+        p++;
+    }
+  } while (depth > 0);
+
+  *s = p;
+  return 0;
+}
+
+/**
+ * bodystruct_params - Parse a list of MIME parameters from a BODYSTRUCTURE
+ * @param[in,out] s    String to parse
+ * @param[in]     part Part to store the boundary in
+ * @retval  0 Success
+ * @retval -1 Error
+ */
+static int bodystruct_params(char **s, struct ImapPart *part)
+{
+  *s = mutt_str_skip_whitespace(*s);
+  if (**s != '(')
+    return bodystruct_skip(s);
+
+  int rc = -1;
+  struct Buffer *attr = mutt_buffer_pool_get();
+  struct Buffer *value = mutt_buffer_pool_get();
+
+  (*s)++;
+  while (true)
+  {
+    *s = mutt_str_skip_whitespace(*s);
+    if (**s == ')')
+      break;
+    if ((bodystruct_string(s, attr) < 0) || (bodystruct_string(s, value) < 0))
+      goto done;
+    if (mutt_istr_equal(mutt_buffer_string(attr), "boundary"))
+      mutt_str_replace(&part->boundary, mutt_buffer_string(value));
+  }
+  (*s)++;
+  rc = 0;
+
+done:
+  mutt_buffer_pool_release(&attr);
+  mutt_buffer_pool_release(&value);
+  return rc;
+}
+
+/**
+ * bodystruct_parse - Parse a BODYSTRUCTURE
+ * @param[in,out] s       String to parse
+ * @param[in]     section Section number of the part
+ * @param[in]     depth   Nesting of the part
+ * @retval ptr  Tree of parts
+ * @retval NULL Error
+ *
+ * Only the types, the sizes and the boundaries are kept.  Messages are not
+ * parsed any further.
+ */
+static struct ImapPart *bodystruct_parse(char **s, const char *section, int depth)
+{
+  *s = mutt_str_skip_whitespace(*s);
+  if ((**s != '(') || (depth > IMAP_PART_DEPTH_MAX))
+    return NULL;
+  (*s)++;
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+  struct ImapPart *part = mutt_mem_calloc(1, sizeof(struct ImapPart));
+  mutt_str_copy(part->section, section, sizeof(part->section));
+
+  *s = mutt_str_skip_whitespace(*s);
+  if (**s == '(')
+  {
+    struct ImapPart **tail = &part->parts;
+    for (int i = 1; **s == '('; i++)
+    {
+      char child[sizeof(part->section)];
+      if (*section != '\0')
+        snprintf(child, sizeof(child), "%s.%d", section, i);
+      else
+        snprintf(child, sizeof(child), "%d", i);
+
+      *tail = bodystruct_parse(s, child, depth + 1);
+      if (!*tail)
+        goto fail;
+      tail = &(*tail)->next;
+      *s = mutt_str_skip_whitespace(*s);
+    }
+
+    part->type = mutt_str_dup("multipart");
+    if (bodystruct_string(s, buf) < 0)
+      goto fail;
+    part->subtype = mutt_buffer_strdup(buf);
+    *s = mutt_str_skip_whitespace(*s);
+    if ((**s != ')') && (bodystruct_params(s, part) < 0))
+      goto fail;
+  }
+  else
+  {
+    if (bodystruct_string(s, buf) < 0)
+      goto fail;
+    part->type = mutt_buffer_strdup(buf);
+    if (bodystruct_string(s, buf) < 0)
+      goto fail;
+    part->subtype = mutt_buffer_strdup(buf);
+
+    /* parameters, id, description, encoding, size */
+    if ((bodystruct_params(s, part) < 0) || (bodystruct_skip(s) < 0) ||
+        (bodystruct_skip(s) < 0) || (bodystruct_skip(s) < 0) ||
+        (bodystruct_string(s, buf) < 0) ||
+        (mutt_str_atoul(mutt_buffer_string(buf), &part->size) < 0))
+    {
+      goto fail;
+    }
+  }
+
+  /* Skip the rest, e.g. the line count or extension data */
+  while (true)
+  {
+    *s = mutt_str_skip_whitespace(*s);
+    if (**s == ')')
+      break;
+    if (bodystruct_skip(s) < 0)
+      goto fail;
+  }
+  (*s)++;
+
+  mutt_buffer_pool_release(&buf);
+  return part;
+
+fail:
+  mutt_buffer_pool_release(&buf);
+  imap_part_free(&part);
+  return NULL;
+}
+
+/**
+ * imap_part_plan - Decide which parts of a message to download
+ * @param[in]  part    Part to check
+ * @param[in]  limit   Largest attachment to download, in bytes
+ * @param[out] partial Set to true if a part will be left on the server
+ * @retval true  The message can be displayed from its parts
+ * @retval false The whole message is needed, e.g. it's signed
+ *
+ * Text parts are always downloaded.  Other parts are only downloaded if
+ * they're smaller than the limit.
+ */
+static bool imap_part_plan(struct ImapPart *part, unsigned long limit, bool *partial)
+{
+  if (mutt_istr_equal(part->type, "multipart"))
+  {
+    if (mutt_istr_equal(part->subtype, "signed") ||
+        mutt_istr_equal(part->subtype, "encrypted") || !part->boundary)
+    {
+      return false;
+    }
+
+    for (struct ImapPart *p = part->parts; p; p = p->next)
+      if (!imap_part_plan(p, limit, partial))
+        return false;
+
+    return true;
+  }
+
+  if (mutt_istr_equal(part->type, "application") &&
+      (mutt_istr_startswith(part->subtype, "pgp") ||
+       mutt_istr_startswith(part->subtype, "pkcs7") ||
+       mutt_istr_startswith(part->subtype, "x-pkcs7")))
+  {
+    return false;
+  }
+
+  part->fetch = mutt_istr_equal(part->type, "text") || (part->size < limit);
+  if (!part->fetch)
+    *partial = true;
+
+  return true;
+}
+
+/**
+ * imap_part_request - Add the sections of a part to a FETCH command
+ * @param part Part
+ * @param buf  Buffer for the FETCH command
+ * @param peek Don't mark the message as read
+ */
+static void imap_part_request(struct ImapPart *part, struct Buffer *buf, bool peek)
+{
+  const char *body = peek ? "BODY.PEEK" : "BODY";
+
+  if (part->section[0] != '\0')
+    mutt_buffer_add_printf(buf, " %s[%s.MIME]", body, part->section);
+  if (part->fetch)
+    mutt_buffer_add_printf(buf, " %s[%s]", body, part->section);
+
+  for (struct ImapPart *p = part->parts; p; p = p->next)
+    imap_part_request(p, buf, peek);
+}
+
+/**
+ * imap_part_find - Find the Buffer for a section of a message
+ * @param part    Tree of parts
+ * @param section Section, e.g. "2.1.MIME"
+ * @retval ptr  Buffer for the section's data
+ * @retval NULL Not found
+ */
+static struct Buffer *imap_part_find(struct ImapPart *part, const char *section)
+{
+  for (; part; part = part->next)
+  {
+    const size_t len = mutt_str_len(part->section);
+    if (len != 0)
+    {
+      if (!mutt_istrn_equal(section, part->section, len))
+        continue;
+      if (section[len] == '\0')
+        return &part->body;
+      if (mutt_istr_equal(section + len, ".MIME"))
+        return &part->mime;
+      if (section[len] != '.')
+        continue;
+    }
+
+    struct Buffer *buf = imap_part_find(part->parts, section);
+    if (buf)
+      return buf;
+  }
+
+  return NULL;
+}
+
+/**
+ * imap_part_write - Write a multipart, using only the downloaded parts
+ * @param part Multipart
+ * @param fp   File to write to
+ *
+ * Each part that wasn't downloaded is replaced by a message/external-body
+ * that describes it.
+ */
+static void imap_part_write(struct ImapPart *part, FILE *fp)
+{
+  for (struct ImapPart *p = part->parts; p; p = p->next)
+  {
+    fprintf(fp, "--%s\n", part->boundary);
+    if (!p->parts && !p->fetch)
+    {
+      fprintf(fp,
+              "Content-Type: message/external-body; access-type=x-mutt-remote;\n"
+              "\tlength=%lu\n"
+              "\n",
+              p->size);
+    }
+    fputs(mutt_buffer_string(&p->mime), fp);
+    if (p->parts)
+      imap_part_write(p, fp);
+    else if (p->fetch)
+      fputs(mutt_buffer_string(&p->body), fp);
+    fputc('\n', fp);
+  }
+  fprintf(fp, "--%s--\n", part->boundary);
+}
+
+/**
+ * imap_part_fetch - Download the sections of a message
+ * @param m    Selected Imap Mailbox
+ * @param e    Email
+ * @param cmd  FETCH command
+ * @param hdr  Buffer for the message's header
+ * @param part Tree of parts, or NULL to parse the BODYSTRUCTURE
+ * @retval ptr  Tree of parts, if part was NULL
+ * @retval ptr  part, if the sections were downloaded
+ * @retval NULL Error
+ */
+static struct ImapPart *imap_part_fetch(struct Mailbox *m, struct Email *e,
+                                        const char *cmd, struct Buffer *hdr,
+                                        struct ImapPart *part)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapPart *tree = NULL;
+  bool ok = true;
+  int rc;
+
+  e->active = false;
+  imap_cmd_start(adata, cmd);
+  do
+  {
+    rc = imap_cmd_step(adata);
+    if (rc != IMAP_RES_CONTINUE)
+      break;
+
+    char *pc = adata->buf;
+    pc = imap_next_word(pc);
+    pc = imap_next_word(pc);
+    if (!mutt_istr_startswith(pc, "FETCH"))
+      continue;
+
+    while (ok && *pc)
+    {
+      pc = imap_next_word(pc);
+      if (pc[0] == '(')
+        pc++;
+
+      if (!part && mutt_istr_startswith(pc, "BODYSTRUCTURE"))
+      {
+        pc = imap_next_word(pc);
+        imap_part_free(&tree);
+        tree = bodystruct_parse(&pc, "", 0);
+        ok = (tree != NULL);
+        break;
+      }
+      else if (part && mutt_istr_startswith(pc, "BODY["))
+      {
+        char *section = pc + 5;
+        char *end = strchr(section, ']');
+        if (!end)
+        {
+          ok = false;
+          break;
+        }
+        *end = '\0';
+
+        struct Buffer *buf = NULL;
+        if (mutt_istr_equal(section, "HEADER"))
+          buf = hdr;
+        else
+          buf = imap_part_find(part, section);
+
+        pc = imap_next_word(end + 1);
+        if (mutt_istr_startswith(pc, "NIL") || mutt_str_startswith(pc, "\"\""))
+          continue;
+
+        unsigned int bytes = 0;
+        if (!buf || (imap_get_literal_count(pc, &bytes) < 0))
+        {
+          ok = false;
+          break;
+        }
+
+        mutt_buffer_reset(buf);
+        if (imap_read_literal_buf(buf, adata, bytes) < 0)
+        {
+          ok = false;
+          break;
+        }
+
+        /* pick up trailing line */
+        rc = imap_cmd_step(adata);
+        if (rc != IMAP_RES_CONTINUE)
+          break;
+        pc = adata->buf;
+      }
+      else if (!e->changed && mutt_istr_startswith(pc, "FLAGS"))
+      {
+        pc = imap_set_flags(m, e, pc, NULL);
+        if (!pc)
+          ok = false;
+      }
+    }
+  } while (rc == IMAP_RES_CONTINUE);
+  e->active = true;
 
-  return 0;
+  if (ok && (rc == IMAP_RES_OK) && imap_code(adata->buf))
+    return part ? part : tree;
+
+  imap_part_free(&tree);
+  return NULL;
 }
 
 /**
- * imap_set_flags - fill the message header according to the server flags
- * @param[in]  m              Imap Selected Mailbox
- * @param[in]  e              Email
- * @param[in]  s              Command string
- * @param[out] server_changes Set to true if the flags have changed
- * @retval ptr  The end of flags string
- * @retval NULL Failure
+ * imap_msg_open_partial - Download the parts of a message needed to display it
+ * @param m Selected Imap Mailbox
+ * @param e Email
+ * @retval ptr  File containing the message, without its large attachments
+ * @retval NULL The whole message should be opened
  *
- * Expects a flags line of the form "FLAGS (flag flag ...)"
- *
- * imap_set_flags: fill out the message header according to the flags from
- * the server. Expects a flags line of the form "FLAGS (flag flag ...)"
+ * If `$imap_fetch_partial_size` is set, a large message is displayed from its
+ * text parts and small attachments.  Each of the other parts is replaced by a
+ * message/external-body, so the pager can show what's missing.
  *
- * Sets server_changes to 1 if a change to a flag is made, or in the
- * case of e->changed, if a change to a flag _would_ have been
- * made.
+ * The file is only good for display.  It isn't cached and it doesn't change
+ * the Email, so the whole message will be downloaded when it's needed, e.g.
+ * to view an attachment, save or reply.
  */
-char *imap_set_flags(struct Mailbox *m, struct Email *e, char *s, bool *server_changes)
+FILE *imap_msg_open_partial(struct Mailbox *m, struct Email *e)
 {
   struct ImapAccountData *adata = imap_adata_get(m);
-  if (!adata || (adata->mailbox != m))
+  if (!adata || (adata->mailbox != m) || !e || !e->body)
     return NULL;
 
-  struct ImapHeader newh = { 0 };
-  struct ImapEmailData old_edata = { 0 };
-  int local_changes = e->changed;
-
-  struct ImapEmailData *edata = e->edata;
-  newh.edata = edata;
+  const long c_imap_fetch_partial_size =
+      cs_subset_long(NeoMutt->sub, "imap_fetch_partial_size");
+  if ((c_imap_fetch_partial_size <= 0) || (e->body->type != TYPE_MULTIPART) ||
+      (e->body->length < c_imap_fetch_partial_size) ||
+      !(adata->capabilities & IMAP_CAP_IMAP4REV1))
+  {
+    return NULL;
+  }
 
-  mutt_debug(LL_DEBUG2, "parsing FLAGS\n");
-  s = msg_parse_flags(&newh, s);
-  if (!s)
+  /* A cached message is quicker to open whole */
+  FILE *fp = msg_cache_get(m, e);
+  if (fp)
+  {
+    mutt_file_fclose(&fp);
     return NULL;
+  }
 
-  /* Update tags system */
-  /* We take a copy of the tags so we can split the string */
-  char *tags_copy = mutt_str_dup(edata->flags_remote);
-  driver_tags_replace(&e->tags, tags_copy);
-  FREE(&tags_copy);
+  struct Buffer *cmd = mutt_buffer_pool_get();
+  struct Buffer *hdr = mutt_buffer_pool_get();
+  struct ImapPart *tree = NULL;
+  bool partial = false;
 
-  /* YAUH (yet another ugly hack): temporarily set context to
-   * read-write even if it's read-only, so *server* updates of
-   * flags can be processed by mutt_set_flag. mailbox->changed must
-   * be restored afterwards */
-  bool readonly = m->readonly;
-  m->readonly = false;
+  mutt_buffer_printf(cmd, "UID FETCH %u (BODYSTRUCTURE)", imap_edata_get(e)->uid);
+  tree = imap_part_fetch(m, e, mutt_buffer_string(cmd), NULL, NULL);
+  if (!tree || !mutt_istr_equal(tree->type, "multipart") ||
+      !imap_part_plan(tree, c_imap_fetch_partial_size, &partial) || !partial)
+  {
+    goto done;
+  }
 
-  /* This is redundant with the following two checks. Removing:
-   * mutt_set_flag (m, e, MUTT_NEW, !(edata->read || edata->old)); */
-  set_changed_flag(m, e, local_changes, server_changes, MUTT_OLD, old_edata.old,
-                   edata->old, e->old);
-  set_changed_flag(m, e, local_changes, server_changes, MUTT_READ,
-                   old_edata.read, edata->read, e->read);
-  set_changed_flag(m, e, local_changes, server_changes, MUTT_DELETE,
-                   old_edata.deleted, edata->deleted, e->deleted);
-  set_changed_flag(m, e, local_changes, server_changes, MUTT_FLAG,
-                   old_edata.flagged, edata->flagged, e->flagged);
-  set_changed_flag(m, e, local_changes, server_changes, MUTT_REPLIED,
-                   old_edata.replied, edata->replied, e->replied);
+  if (!isendwin() && m->verbose)
+    mutt_message(_("Fetching message..."));
 
-  /* this message is now definitively *not* changed (mutt_set_flag
-   * marks things changed as a side-effect) */
-  if (local_changes == 0)
-    e->changed = false;
-  m->changed &= !readonly;
-  m->readonly = readonly;
+  const bool c_imap_peek = cs_subset_bool(NeoMutt->sub, "imap_peek");
+  mutt_buffer_printf(cmd, "UID FETCH %u (%s[HEADER]", imap_edata_get(e)->uid,
+                     c_imap_peek ? "BODY.PEEK" : "BODY");
+  imap_part_request(tree, cmd, c_imap_peek);
+  mutt_buffer_addch(cmd, ')');
+  if (!imap_part_fetch(m, e, mutt_buffer_string(cmd), hdr, tree) ||
+      (mutt_buffer_len(hdr) == 0))
+  {
+    goto done;
+  }
 
-  return s;
+  fp = mutt_file_mkstemp();
+  if (!fp)
+    goto done;
+
+  fputs(mutt_buffer_string(hdr), fp);
+  imap_part_write(tree, fp);
+  if ((fflush(fp) != 0) || ferror(fp))
+  {
+    mutt_file_fclose(&fp);
+    goto done;
+  }
+  rewind(fp);
+  mutt_clear_error();
+  mutt_debug(LL_DEBUG1, "displaying uid %u from its parts\n", imap_edata_get(e)->uid);
+
+done:
+  imap_part_free(&tree);
+  mutt_buffer_pool_release(&cmd);
+  mutt_buffer_pool_release(&hdr);
+  return fp;
 }
 
 /**
- * imap_msg_open - Open an email message in a Mailbox - Implements MxOps::msg_open()
+ * msg_fetch_body - Download a whole message
+ * @param m               Selected Imap Mailbox
+ * @param e               Email
+ * @param fp              File to write the message to
+ * @param peek            Don't mark the message as read
+ * @param output_progress Show a progress bar
+ * @retval  0 Success
+ * @retval -1 Failure
  */
-bool imap_msg_open(struct Mailbox *m, struct Message *msg, int msgno)
+static int msg_fetch_body(struct Mailbox *m, struct Email *e, FILE *fp,
+                          bool peek, bool output_progress)
 {
-  struct Envelope *newenv = NULL;
+  struct ImapAccountData *adata = imap_adata_get(m);
   char buf[1024];
   char *pc = NULL;
   unsigned int bytes;
   struct Progress progress;
   unsigned int uid;
-  bool retried = false;
-  bool read;
   int rc;
 
   /* Sam's weird courier server returns an OK response even when FETCH
    * fails. Thanks Sam. */
   bool fetched = false;
 
-  struct ImapAccountData *adata = imap_adata_get(m);
-
-  if (!adata || (adata->mailbox != m))
-    return false;
-
-  struct Email *e = m->emails[msgno];
-  if (!e)
-    return false;
-
-  msg->fp = msg_cache_get(m, e);
-  if (msg->fp)
-  {
-    if (imap_edata_get(e)->parsed)
-      return true;
-    goto parsemsg;
-  }
-
-  /* This function is called in a few places after endwin()
-   * e.g. mutt_pipe_message(). */
-  bool output_progress = !isendwin() && m->verbose;
-  if (output_progress)
-    mutt_message(_("Fetching message..."));
-
-  msg->fp = msg_cache_put(m, e);
-  if (!msg->fp)
-  {
-    struct Buffer *path = mutt_buffer_pool_get();
-    mutt_buffer_mktemp(path);
-    msg->fp = mutt_file_fopen(mutt_buffer_string(path), "w+");
-    unlink(mutt_buffer_string(path));
-    mutt_buffer_pool_release(&path);
-
-    if (!msg->fp)
-      return false;
-  }
-
   /* mark this header as currently inactive so the command handler won't
    * also try to update it. HACK until all this code can be moved into the
    * command handler */
   e->active = false;
 
-  const bool c_imap_peek = cs_subset_bool(NeoMutt->sub, "imap_peek");
   snprintf(buf, sizeof(buf), "UID FETCH %u %s", imap_edata_get(e)->uid,
            ((adata->capabilities & IMAP_CAP_IMAP4REV1) ?
-                (c_imap_peek ? "BODY.PEEK[]" : "BODY[]") :
+                (peek ? "BODY.PEEK[]" : "BODY[]") :
                 "RFC822"));
 
   imap_cmd_start(adata, buf);
@@ -2014,7 +3253,7 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, int msgno)
           {
             mutt_progress_init(&progress, _("Fetching message..."), MUTT_PROGRESS_NET, bytes);
           }
-          if (imap_read_literal(msg->fp, adata, bytes, output_progress ? &progress : NULL) < 0)
+          if (imap_read_literal(fp, adata, bytes, output_progress ? &progress : NULL) < 0)
           {
             goto bail;
           }
@@ -2043,14 +3282,195 @@ bool imap_msg_open(struct Mailbox *m, struct Message *msg, int msgno)
   /* see comment before command start. */
   e->active = true;
 
-  fflush(msg->fp);
-  if (ferror(msg->fp))
-    goto bail;
+  fflush(fp);
+  if (ferror(fp))
+    return -1;
 
   if (rc != IMAP_RES_OK)
-    goto bail;
+    return -1;
 
   if (!fetched || !imap_code(adata->buf))
+    return -1;
+
+  return 0;
+
+bail:
+  e->active = true;
+  return -1;
+}
+
+/**
+ * msg_cache_exists - Is a message in the message cache?
+ * @param m Selected Imap Mailbox
+ * @param e Email
+ * @retval true The message is cached
+ */
+static bool msg_cache_exists(struct Mailbox *m, struct Email *e)
+{
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+
+  mdata->bcache = msg_cache_open(m);
+  char id[64];
+  snprintf(id, sizeof(id), "%u-%u", mdata->uidvalidity, imap_edata_get(e)->uid);
+  return mutt_bcache_exists(mdata->bcache, id) == 0;
+}
+
+/**
+ * imap_prefetch_pending - Are there messages to prefetch?
+ * @retval true imap_prefetch() has work to do
+ */
+bool imap_prefetch_pending(void)
+{
+  struct Account *np = NULL;
+  TAILQ_FOREACH(np, &NeoMutt->accounts, entries)
+  {
+    if (np->type != MUTT_IMAP)
+      continue;
+
+    struct ImapAccountData *adata = np->adata;
+    if (!adata || !adata->mailbox || (adata->state != IMAP_SELECTED) ||
+        (adata->status == IMAP_FATAL) || (adata->lastcmd != adata->nextcmd))
+    {
+      continue;
+    }
+
+    struct ImapMboxData *mdata = imap_mdata_get(adata->mailbox);
+    if (mdata && (mdata->prefetch_left > 0))
+      return true;
+  }
+
+  return false;
+}
+
+/**
+ * imap_prefetch - Download a message that might be read next
+ *
+ * After a message has been opened, the next `$imap_prefetch` messages, in
+ * index order, are downloaded into the message cache, one per call.  This is
+ * called while waiting for a key, so the next message opens at once.
+ */
+void imap_prefetch(void)
+{
+  struct Account *np = NULL;
+  TAILQ_FOREACH(np, &NeoMutt->accounts, entries)
+  {
+    if (np->type != MUTT_IMAP)
+      continue;
+
+    struct ImapAccountData *adata = np->adata;
+    if (!adata || !adata->mailbox || (adata->state != IMAP_SELECTED) ||
+        (adata->status == IMAP_FATAL) || (adata->lastcmd != adata->nextcmd))
+    {
+      continue;
+    }
+
+    struct Mailbox *m = adata->mailbox;
+    struct ImapMboxData *mdata = imap_mdata_get(m);
+    if (!mdata || (mdata->prefetch_left <= 0))
+      continue;
+
+    struct Email *e = NULL;
+    if ((mdata->prefetch_msgno >= 0) && (mdata->prefetch_msgno < m->msg_count))
+      e = m->emails[mdata->prefetch_msgno];
+
+    /* Find the next uncached message */
+    int vnum = (e && m->v2r && (e->vnum >= 0)) ? e->vnum + 1 : m->vcount;
+    for (e = NULL; (vnum < m->vcount) && (mdata->prefetch_left > 0); vnum++)
+    {
+      const int msgno = m->v2r[vnum];
+      if ((msgno >= 0) && (msgno < m->msg_count))
+        e = m->emails[msgno];
+      mdata->prefetch_left--;
+      if (e && !msg_cache_exists(m, e))
+        break;
+      e = NULL;
+    }
+
+    if (!e)
+    {
+      mdata->prefetch_left = 0;
+      continue;
+    }
+
+    mdata->prefetch_msgno = e->msgno;
+    FILE *fp = msg_cache_put(m, e);
+    if (!fp)
+    {
+      mdata->prefetch_left = 0;
+      return;
+    }
+
+    mutt_debug(LL_DEBUG2, "prefetching uid %u\n", imap_edata_get(e)->uid);
+    if (msg_fetch_body(m, e, fp, true, false) == 0)
+    {
+      mutt_file_fclose(&fp);
+      msg_cache_commit(m, e);
+    }
+    else
+    {
+      mutt_file_fclose(&fp);
+      imap_cache_del(m, e);
+      mdata->prefetch_left = 0;
+    }
+    return;
+  }
+}
+
+/**
+ * imap_msg_open - Open an email message in a Mailbox - Implements MxOps::msg_open()
+ */
+bool imap_msg_open(struct Mailbox *m, struct Message *msg, int msgno)
+{
+  struct Envelope *newenv = NULL;
+  char buf[1024];
+  bool retried = false;
+  bool read;
+
+  struct ImapAccountData *adata = imap_adata_get(m);
+
+  if (!adata || (adata->mailbox != m))
+    return false;
+
+  struct Email *e = m->emails[msgno];
+  if (!e)
+    return false;
+
+  msg->fp = msg_cache_get(m, e);
+
+  /* Prefetching needs the message cache */
+  const short c_imap_prefetch = cs_subset_number(NeoMutt->sub, "imap_prefetch");
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  mdata->prefetch_msgno = msgno;
+  mdata->prefetch_left = mdata->bcache ? c_imap_prefetch : 0;
+
+  if (msg->fp)
+  {
+    if (imap_edata_get(e)->parsed)
+      return true;
+    goto parsemsg;
+  }
+
+  /* This function is called in a few places after endwin()
+   * e.g. mutt_pipe_message(). */
+  bool output_progress = !isendwin() && m->verbose;
+  if (output_progress)
+    mutt_message(_("Fetching message..."));
+
+  msg->fp = msg_cache_put(m, e);
+  if (!msg->fp)
+  {
+    struct Buffer *path = mutt_buffer_pool_get();
+    mutt_buffer_mktemp(path);
+    msg->fp = mutt_file_fopen(mutt_buffer_string(path), "w+");
+    unlink(mutt_buffer_string(path));
+    mutt_buffer_pool_release(&path);
+
+    if (!msg->fp)
+      return false;
+  }
+
+  const bool c_imap_peek = cs_subset_bool(NeoMutt->sub, "imap_peek");
+  if (msg_fetch_body(m, e, msg->fp, c_imap_peek, output_progress) < 0)
     goto bail;
 
   msg_cache_commit(m, e);
@@ -2101,7 +3521,6 @@ parsemsg:
   return true;
 
 bail:
-  e->active = true;
   mutt_file_fclose(&msg->fp);
   imap_cache_del(m, e);
   return false;
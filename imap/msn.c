@@ -26,6 +26,7 @@
  * IMAP MSN helper functions
  */
 
+#include "config.h"
 #include <limits.h>
 #include <stdlib.h>
 #include "mutt/lib.h"
@@ -48,7 +49,9 @@ void imap_msn_reserve(struct MSN *msn, size_t num)
     mutt_exit(1);
   }
 
+  MEM_ACCOUNT(MEM_TAG_IMAP, -(long) (ARRAY_CAPACITY(msn) * sizeof(struct Email *)), 0);
   ARRAY_RESERVE(msn, num);
+  MEM_ACCOUNT(MEM_TAG_IMAP, ARRAY_CAPACITY(msn) * sizeof(struct Email *), 0);
 }
 
 /**
@@ -57,6 +60,7 @@ void imap_msn_reserve(struct MSN *msn, size_t num)
  */
 void imap_msn_free(struct MSN *msn)
 {
+  MEM_ACCOUNT(MEM_TAG_IMAP, -(long) (ARRAY_CAPACITY(msn) * sizeof(struct Email *)), 0);
   ARRAY_FREE(msn);
 }
 
@@ -90,7 +94,9 @@ struct Email *imap_msn_get(const struct MSN *msn, size_t idx)
  */
 void imap_msn_set(struct MSN *msn, size_t idx, struct Email *e)
 {
+  MEM_ACCOUNT(MEM_TAG_IMAP, -(long) (ARRAY_CAPACITY(msn) * sizeof(struct Email *)), 0);
   ARRAY_SET(msn, idx, e);
+  MEM_ACCOUNT(MEM_TAG_IMAP, ARRAY_CAPACITY(msn) * sizeof(struct Email *), 0);
 }
 
 /**
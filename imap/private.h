@@ -59,6 +59,8 @@ struct Progress;
 #define IMAP_RES_NEW       3  ///< ImapCommand.state additions
 
 #define SEQ_LEN 16
+/// The pipeline may grow to this many times `$imap_pipeline_depth`
+#define IMAP_PIPELINE_GROWTH 4
 #define IMAP_MAX_CMDLEN 1024 ///< Maximum length of command lines before they must be split (for lazy servers)
 
 typedef uint8_t ImapOpenFlags;         ///< Flags, e.g. #MUTT_THREAD_COLLAPSE
@@ -139,8 +141,11 @@ typedef uint32_t ImapCapFlags;              ///< Flags, e.g. #IMAP_CAP_IMAP4
 #define IMAP_CAP_LIST_EXTENDED    (1 << 16) ///< RFC5258: IMAP4 LIST Command Extensions
 #define IMAP_CAP_COMPRESS         (1 << 17) ///< RFC4978: COMPRESS=DEFLATE
 #define IMAP_CAP_X_GM_EXT_1       (1 << 18) ///< https://developers.google.com/gmail/imap/imap-extensions
+#define IMAP_CAP_NOTIFY           (1 << 19) ///< RFC5465: IMAP NOTIFY Extension
+#define IMAP_CAP_LITERAL_PLUS     (1 << 20) ///< RFC7888: LITERAL+, non-synchronising literals
+#define IMAP_CAP_LITERAL_MINUS    (1 << 21) ///< RFC7888: LITERAL-, small non-synchronising literals
 
-#define IMAP_CAP_ALL             ((1 << 19) - 1)
+#define IMAP_CAP_ALL             ((1 << 22) - 1)
 
 /**
  * struct ImapList - Items in an IMAP browser
@@ -160,6 +165,9 @@ struct ImapCommand
 {
   char seq[SEQ_LEN + 1]; ///< Command tag, e.g. 'a0001'
   int state;            ///< Command state, e.g. #IMAP_RES_NEW
+  uint64_t queued;      ///< Time the command was queued, in milliseconds
+  uint64_t sent;        ///< Time the command was sent, in microseconds, 0 if it's still queued
+  char name[16];        ///< Command name, for the trace, e.g. "UID FETCH"
 };
 
 /**
@@ -185,9 +193,14 @@ int imap_exec_msgset(struct Mailbox *m, const char *pre, const char *post,
                      enum MessageType flag, bool changed, bool invert);
 int imap_open_connection(struct ImapAccountData *adata);
 void imap_close_connection(struct ImapAccountData *adata);
+void imap_monitor_add(struct ImapAccountData *adata);
+void imap_monitor_remove(struct ImapAccountData *adata);
 int imap_read_literal(FILE *fp, struct ImapAccountData *adata, unsigned long bytes, struct Progress *pbar);
+int imap_read_literal_buf(struct Buffer *buf, struct ImapAccountData *adata, unsigned long bytes);
 void imap_expunge_mailbox(struct Mailbox *m);
 int imap_login(struct ImapAccountData *adata);
+int imap_login_deferred(struct ImapAccountData *adata);
+void imap_logout(struct ImapAccountData *adata);
 int imap_sync_message_for_copy(struct Mailbox *m, struct Email *e, struct Buffer *cmd, enum QuadOption *err_continue);
 bool imap_has_flag(struct ListHead *flag_list, const char *flag);
 int imap_adata_find(const char *path, struct ImapAccountData **adata, struct ImapMboxData **mdata);
@@ -204,8 +217,19 @@ const char *imap_cmd_trailer(struct ImapAccountData *adata);
 int imap_exec(struct ImapAccountData *adata, const char *cmdstr, ImapCmdFlags flags);
 int imap_cmd_idle(struct ImapAccountData *adata);
 
+/* idle.c */
+bool imap_idle_fresh(struct ImapMboxData *mdata);
+void imap_idle_free(struct ImapMboxData *mdata);
+void imap_idle_keepalive(struct ImapAccountData *adata);
+void imap_idle_logout(struct ImapAccountData *adata);
+void imap_idle_watch(struct ImapAccountData *adata, struct Mailbox *m);
+
 /* message.c */
 int imap_read_headers(struct Mailbox *m, unsigned int msn_begin, unsigned int msn_end, bool initial_download);
+#ifdef USE_HCACHE
+void imap_emails_free(struct Mailbox *m);
+int imap_read_headers_cached(struct Mailbox *m);
+#endif
 char *imap_set_flags(struct Mailbox *m, struct Email *e, char *s, bool *server_changes);
 int imap_cache_del(struct Mailbox *m, struct Email *e);
 int imap_cache_clean(struct Mailbox *m);
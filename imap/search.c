@@ -34,6 +34,7 @@
 #include <string.h>
 #include "private.h"
 #include "mutt/lib.h"
+#include "config/lib.h"
 #include "email/lib.h"
 #include "core/lib.h"
 #include "lib.h"
@@ -41,6 +42,21 @@
 #include "adata.h"
 #include "mdata.h"
 
+/// Maximum number of searches to remember for each Mailbox
+#define IMAP_SEARCH_CACHE_MAX 32
+/// Shortest literal worth asking the server about
+#define IMAP_SEARCH_LITERAL_MIN 3
+
+/**
+ * struct ImapSearchResult - The messages found by an IMAP SEARCH
+ */
+struct ImapSearchResult
+{
+  ARRAY_HEAD(, unsigned int) uids; ///< UIDs of the matching messages
+  unsigned int uid_next;           ///< Mailbox's UIDNEXT when it was searched
+  int msg_count;                   ///< Number of Emails when it was searched
+};
+
 // fwd decl, mutually recursive: check_pattern_list, check_pattern
 static int check_pattern_list(const struct PatternList *patterns);
 
@@ -219,12 +235,163 @@ static bool compile_search(const struct ImapAccountData *adata,
                       compile_search_self(adata, pat, buf);
 }
 
+/**
+ * search_result_free - Free an ImapSearchResult - Implements ::hash_hdata_free_t
+ */
+static void search_result_free(int type, void *obj, intptr_t data)
+{
+  struct ImapSearchResult *res = obj;
+  ARRAY_FREE(&res->uids);
+  FREE(&res);
+}
+
+/**
+ * search_run - Run an IMAP SEARCH, or remember its results
+ * @param m   Mailbox
+ * @param cmd Search command, e.g. "UID SEARCH BODY foo"
+ * @retval ptr  Results of the search, owned by the Mailbox's cache
+ * @retval NULL Failure
+ *
+ * The messages of an IMAP Mailbox never change, so the results of a search
+ * can be reused until there's new mail, or some mail is expunged.
+ * X-GM-RAW searches are always sent, because they can match the labels.
+ */
+static struct ImapSearchResult *search_run(struct Mailbox *m, const char *cmd)
+{
+  struct ImapAccountData *adata = imap_adata_get(m);
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  if (!adata || !mdata)
+    return NULL;
+
+  /* A false match, e.g. BODY "X-GM-RAW", just means the search is run again */
+  const bool reuse = !strstr(cmd, "X-GM-RAW");
+
+  struct ImapSearchResult *res = mutt_hash_find(mdata->search_cache, cmd);
+  if (reuse && res && (res->uid_next == mdata->uid_next) && (res->msg_count == m->msg_count))
+  {
+    mutt_debug(LL_DEBUG2, "Reusing results of: %s\n", cmd);
+    return res;
+  }
+
+  res = mutt_mem_calloc(1, sizeof(struct ImapSearchResult));
+  ARRAY_INIT(&res->uids);
+  res->uid_next = mdata->uid_next;
+  res->msg_count = m->msg_count;
+
+  mdata->search_result = res;
+  const bool ok = (imap_exec(adata, cmd, IMAP_CMD_NO_FLAGS) == IMAP_EXEC_SUCCESS);
+  mdata->search_result = NULL;
+
+  if (!ok)
+  {
+    search_result_free(0, res, 0);
+    return NULL;
+  }
+
+  if (!mdata->search_cache || (mdata->search_cache->num_keys >= IMAP_SEARCH_CACHE_MAX))
+  {
+    mutt_hash_free(&mdata->search_cache);
+    mdata->search_cache = mutt_hash_new(IMAP_SEARCH_CACHE_MAX, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(mdata->search_cache, search_result_free, 0);
+  }
+  mutt_hash_delete(mdata->search_cache, cmd, NULL);
+  mutt_hash_insert(mdata->search_cache, cmd, res);
+  return res;
+}
+
+/**
+ * search_literal_ok - Can a regex's literal be searched for on the server?
+ * @param pat Pattern to check
+ * @retval true The server can find the messages containing the literal
+ *
+ * The server searches the decoded text of a message, ignoring case, so its
+ * results are only a superset of the matches if $thorough_search is set.
+ * The literal must be plain ASCII to be sent without a charset.
+ */
+static bool search_literal_ok(const struct Pattern *pat)
+{
+  if (((pat->op != MUTT_PAT_BODY) && (pat->op != MUTT_PAT_WHOLE_MSG)) ||
+      pat->string_match || pat->is_multi || !pat->literal ||
+      (mutt_str_len(pat->literal) < IMAP_SEARCH_LITERAL_MIN))
+  {
+    return false;
+  }
+
+  for (const unsigned char *s = (const unsigned char *) pat->literal; *s; s++)
+  {
+    if ((*s < ' ') || (*s > '~'))
+      return false;
+  }
+
+  return cs_subset_bool(NeoMutt->sub, "thorough_search");
+}
+
+/**
+ * search_literals - Ask the server which messages contain each regex's literal
+ * @param m        Mailbox
+ * @param patterns Patterns to search for
+ * @retval true  Success
+ * @retval false Failure
+ *
+ * Messages that don't contain the literal of a regex, e.g. `~b 'foo.*bar'`,
+ * can't match it, so they won't be downloaded.  The others are matched
+ * against the regex as usual.
+ */
+static bool search_literals(struct Mailbox *m, const struct PatternList *patterns)
+{
+  struct Pattern *pat = NULL;
+  SLIST_FOREACH(pat, patterns, entries)
+  {
+    FREE(&pat->server_match);
+    pat->num_server_match = 0;
+
+    if (pat->child)
+    {
+      if (!search_literals(m, pat->child))
+        return false;
+      continue;
+    }
+
+    if (!search_literal_ok(pat))
+      continue;
+
+    char term[256];
+    struct Buffer *cmd = mutt_buffer_pool_get();
+    imap_quote_string(term, sizeof(term), pat->literal, false);
+    mutt_buffer_printf(cmd, "UID SEARCH %s %s",
+                       (pat->op == MUTT_PAT_BODY) ? "BODY" : "TEXT", term);
+    struct ImapSearchResult *res = search_run(m, mutt_buffer_string(cmd));
+    mutt_buffer_pool_release(&cmd);
+    if (!res)
+      return false;
+
+    struct ImapMboxData *mdata = imap_mdata_get(m);
+    pat->server_match = mutt_mem_calloc(MAX(m->msg_count, 1), sizeof(bool));
+    pat->num_server_match = m->msg_count;
+
+    unsigned int *uid = NULL;
+    ARRAY_FOREACH(uid, &res->uids)
+    {
+      struct Email *e = mutt_hash_int_find(mdata->uid_hash, *uid);
+      if (e && (e->index >= 0) && (e->index < m->msg_count))
+        pat->server_match[e->index] = true;
+    }
+  }
+
+  return true;
+}
+
 /**
  * imap_search - Find messages in mailbox matching a pattern
  * @param m   Mailbox
  * @param pat Pattern to match
  * @retval true  Success
  * @retval false Failure
+ *
+ * The parts of the pattern that need the text of the messages, e.g. `=b foo`,
+ * are sent to the server as one search.  The rest of the pattern is matched
+ * locally.  Regexes can't be searched for on the server, but a string that
+ * every match contains can be used to skip most of the messages.
  */
 bool imap_search(struct Mailbox *m, const struct PatternList *pat)
 {
@@ -236,6 +403,9 @@ bool imap_search(struct Mailbox *m, const struct PatternList *pat)
     e->matched = false;
   }
 
+  if (!search_literals(m, pat))
+    return false;
+
   if (check_pattern_list(pat) == 0)
     return true;
 
@@ -244,11 +414,23 @@ bool imap_search(struct Mailbox *m, const struct PatternList *pat)
   mutt_buffer_addstr(&buf, "UID SEARCH ");
 
   struct ImapAccountData *adata = imap_adata_get(m);
-  const bool ok = compile_search(adata, SLIST_FIRST(pat), &buf) &&
-                  (imap_exec(adata, buf.data, IMAP_CMD_NO_FLAGS) == IMAP_EXEC_SUCCESS);
-
+  struct ImapSearchResult *res = NULL;
+  if (compile_search(adata, SLIST_FIRST(pat), &buf))
+    res = search_run(m, buf.data);
   FREE(&buf.data);
-  return ok;
+  if (!res)
+    return false;
+
+  struct ImapMboxData *mdata = imap_mdata_get(m);
+  unsigned int *uid = NULL;
+  ARRAY_FOREACH(uid, &res->uids)
+  {
+    struct Email *e = mutt_hash_int_find(mdata->uid_hash, *uid);
+    if (e)
+      e->matched = true;
+  }
+
+  return true;
 }
 
 /**
@@ -268,6 +450,11 @@ void cmd_parse_search(struct ImapAccountData *adata, const char *s)
   {
     if (mutt_str_atoui(s, &uid) < 0)
       continue;
+    if (mdata->search_result)
+    {
+      ARRAY_ADD(&mdata->search_result->uids, uid);
+      continue;
+    }
     e = mutt_hash_int_find(mdata->uid_hash, uid);
     if (e)
       e->matched = true;
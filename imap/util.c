@@ -90,6 +90,7 @@ int imap_adata_find(const char *path, struct ImapAccountData **adata,
       continue;
     if (imap_account_match(&tmp_adata->conn->account, &cac))
     {
+      imap_login_deferred(tmp_adata);
       *mdata = imap_mdata_new(tmp_adata, tmp);
       *adata = tmp_adata;
       return 0;
@@ -108,6 +109,7 @@ void imap_mdata_cache_reset(struct ImapMboxData *mdata)
   mutt_hash_free(&mdata->uid_hash);
   imap_msn_free(&mdata->msn);
   mutt_bcache_close(&mdata->bcache);
+  mutt_hash_free(&mdata->search_cache);
 }
 
 /**
@@ -362,7 +364,7 @@ struct Email *imap_hcache_get(struct ImapMboxData *mdata, unsigned int uid)
 
   sprintf(key, "/%u", uid);
   struct HCacheEntry hce =
-      mutt_hcache_fetch(mdata->hcache, key, mutt_str_len(key), mdata->uidvalidity);
+      mutt_hcache_fetch_index(mdata->hcache, key, mutt_str_len(key), mdata->uidvalidity);
   if (!hce.email && hce.uidvalidity)
   {
     mutt_debug(LL_DEBUG3, "hcache uidvalidity mismatch: %u\n", hce.uidvalidity);
@@ -955,6 +957,7 @@ void imap_keepalive(void)
       continue;
 
     struct ImapAccountData *adata = np->adata;
+    imap_idle_keepalive(adata);
     if (!adata || !adata->mailbox)
       continue;
 
@@ -132,6 +132,25 @@ static const struct Mapping IndexNewsHelp[] = {
 };
 #endif
 
+/**
+ * struct IndexLine - A formatted line of the index, cached in Email::render
+ */
+struct IndexLine
+{
+  size_t gen;            ///< Generation of the index, see index_render_invalidate()
+  const char *format;    ///< $index_format that was used
+  MuttFormatFlags flags; ///< Flags that were used, e.g. #MUTT_FORMAT_FORCESUBJ
+  int cols;              ///< Width of the line
+  size_t buflen;         ///< Size of the buffer
+  int msg_in_pager;      ///< Email being shown in the pager
+  time_t now;            ///< Time the line was formatted, if it depends on it
+  int colors[3];         ///< Colours of the author, flags and subject, -1 if unknown
+  char line[];           ///< Formatted line
+};
+
+/// Generation of the index lines, see index_render_invalidate()
+static size_t IndexRenderGen = 1;
+
 // clang-format off
 /**
  * typedef CheckFlags - Checks to perform before running a function
@@ -262,17 +281,8 @@ static void collapse_all(struct Context *ctx, struct Menu *menu, int toggle)
 
   /* Restore the cursor */
   mutt_set_vnum(ctx->mailbox);
-  for (int i = 0; i < ctx->mailbox->vcount; i++)
-  {
-    struct Email *e = mutt_get_virt_email(ctx->mailbox, i);
-    if (!e)
-      break;
-    if (e->index == base->index)
-    {
-      menu->current = i;
-      break;
-    }
-  }
+  if (base->vnum >= 0)
+    menu->current = base->vnum;
 
   menu->redraw = REDRAW_INDEX | REDRAW_STATUS;
 }
@@ -418,6 +428,7 @@ static void resort_index(struct Context *ctx, struct Menu *menu)
 
   menu->current = -1;
   mutt_sort_headers(ctx->mailbox, ctx->threads, false, &ctx->vsize);
+  index_render_invalidate();
   /* Restore the current message */
 
   for (int i = 0; i < ctx->mailbox->vcount; i++)
@@ -468,20 +479,22 @@ static void update_index_threaded(struct Context *ctx, enum MxStatus check, int
   /* Sort first to thread the new messages, because some patterns
    * require the threading information.
    *
-   * If the mailbox was reopened, need to rethread from scratch. */
-  mutt_sort_headers(ctx->mailbox, ctx->threads, (check == MX_STATUS_REOPENED), &ctx->vsize);
+   * If the mailbox was reopened, need to rethread from scratch, unless only
+   * emails have been expunged and the threads are still intact. */
+  const bool init = (check == MX_STATUS_REOPENED) && !mutt_thread_only_appended(ctx->threads);
+  mutt_sort_headers(ctx->mailbox, ctx->threads, init, &ctx->vsize);
 
   if (lmt)
   {
-    /* Because threading changes the order in ctx->mailbox->emails, we don't
-     * know which emails are new. Hence, we need to re-apply the limit to the
-     * whole set.
-     */
+    /* Only the Emails added since the limit was applied need to be checked.
+     * The others keep their place in the limit, even in collapsed threads. */
     for (int i = 0; i < ctx->mailbox->msg_count; i++)
     {
       struct Email *e = ctx->mailbox->emails[i];
-      if ((e->vnum != -1) || mutt_pattern_exec(SLIST_FIRST(ctx->limit_pattern), MUTT_MATCH_FULL_ADDRESS,
-                                               ctx->mailbox, e, NULL))
+      if (ctx_limit_checked(ctx, e) ?
+              e->visible :
+              mutt_pattern_exec(SLIST_FIRST(ctx->limit_pattern),
+                                MUTT_MATCH_FULL_ADDRESS, ctx->mailbox, e, NULL))
       {
         /* vnum will get properly set by mutt_set_vnum(), which
          * is called by mutt_sort_headers() just below. */
@@ -493,6 +506,7 @@ static void update_index_threaded(struct Context *ctx, enum MxStatus check, int
         e->vnum = -1;
         e->visible = false;
       }
+      ctx->limit_seq = MAX(ctx->limit_seq, e->sequence + 1);
     }
     /* Need a second sort to set virtual numbers and redraw the tree */
     mutt_sort_headers(ctx->mailbox, ctx->threads, false, &ctx->vsize);
@@ -532,7 +546,8 @@ static void update_index_unthreaded(struct Context *ctx, enum MxStatus check)
 {
   /* We are in a limited view. Check if the new message(s) satisfy
    * the limit criteria. If they do, set their virtual msgno so that
-   * they will be visible in the limited view */
+   * they will be visible in the limited view.  The messages that were
+   * already checked keep their place. */
   if (ctx_has_limit(ctx))
   {
     int padding = mx_msg_padding_size(ctx->mailbox);
@@ -542,8 +557,10 @@ static void update_index_unthreaded(struct Context *ctx, enum MxStatus check)
       struct Email *e = ctx->mailbox->emails[i];
       if (!e)
         break;
-      if (mutt_pattern_exec(SLIST_FIRST(ctx->limit_pattern),
-                            MUTT_MATCH_FULL_ADDRESS, ctx->mailbox, e, NULL))
+      if (ctx_limit_checked(ctx, e) ?
+              e->visible :
+              mutt_pattern_exec(SLIST_FIRST(ctx->limit_pattern),
+                                MUTT_MATCH_FULL_ADDRESS, ctx->mailbox, e, NULL))
       {
         assert(ctx->mailbox->vcount < ctx->mailbox->msg_count);
         e->vnum = ctx->mailbox->vcount;
@@ -555,8 +572,10 @@ static void update_index_unthreaded(struct Context *ctx, enum MxStatus check)
       }
       else
       {
+        e->vnum = -1;
         e->visible = false;
       }
+      ctx->limit_seq = MAX(ctx->limit_seq, e->sequence + 1);
     }
   }
 
@@ -592,6 +611,7 @@ static bool is_current_email(const struct CurrentEmail *cur, const struct Email
  */
 static void set_current_email(struct CurrentEmail *cur, struct Email *e)
 {
+  email_env_load(e);
   cur->e = e;
   cur->sequence = e ? e->sequence : 0;
 }
@@ -610,6 +630,8 @@ static void update_index(struct Menu *menu, struct Context *ctx, enum MxStatus c
   if (!menu || !ctx)
     return;
 
+  index_render_invalidate();
+
   const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
   if ((c_sort & SORT_MASK) == SORT_THREADS)
     update_index_threaded(ctx, check, oldcount);
@@ -640,6 +662,35 @@ static void update_index(struct Menu *menu, struct Context *ctx, enum MxStatus c
                         ci_first_message(ctx->mailbox);
 }
 
+#ifdef USE_NOTMUCH
+/**
+ * index_load_more - Load more of a paged notmuch query
+ * @param menu Current Menu
+ * @param ctx  Mailbox
+ * @param all  Load all of the remaining messages
+ * @param cur  Remember our place in the index
+ * @retval true More messages were loaded
+ *
+ * See `$nm_query_page_size`.
+ */
+static bool index_load_more(struct Menu *menu, struct Context *ctx, bool all,
+                            const struct CurrentEmail *cur)
+{
+  if (!ctx || !ctx->mailbox || (ctx->mailbox->type != MUTT_NOTMUCH))
+    return false;
+
+  const int oldcount = ctx->mailbox->msg_count;
+  if (nm_mbox_load_more(ctx->mailbox, all) <= 0)
+    return false;
+
+  update_index(menu, ctx, MX_STATUS_NEW_MAIL, oldcount, cur);
+  menu->max = ctx->mailbox->vcount;
+  menu->redraw = REDRAW_FULL;
+  OptSearchInvalid = true;
+  return true;
+}
+#endif
+
 /**
  * mutt_update_index - Update the index
  * @param menu      Current Menu
@@ -755,7 +806,9 @@ static void change_folder_mailbox(struct Menu *menu, struct Mailbox *m, int *old
     return;
 
   const OpenMailboxFlags flags = read_only ? MUTT_READONLY : MUTT_OPEN_NO_FLAGS;
+  OptOpenCached = true;
   Context = mx_mbox_open(m, flags);
+  OptOpenCached = false;
   if (Context)
   {
     menu->current = ci_first_message(Context->mailbox);
@@ -935,8 +988,81 @@ void index_make_entry(struct Menu *menu, char *buf, size_t buflen, int line)
 
   const char *const c_index_format =
       cs_subset_string(NeoMutt->sub, "index_format");
-  mutt_make_string(buf, buflen, menu->win_index->state.cols, NONULL(c_index_format),
-                   m, Context->msg_in_pager, e, flags, NULL);
+  const char *fmt = NONULL(c_index_format);
+  const int cols = menu->win_index->state.cols;
+
+  /* Relative date conditionals, e.g. %<[1d?...>, depend on the current time */
+  time_t now = 0;
+  if (strstr(fmt, "?[") || strstr(fmt, "?(") || strstr(fmt, "<[") || strstr(fmt, "<("))
+    now = mutt_date_epoch();
+
+  struct IndexLine *il = e->render;
+  if (il && (il->gen == IndexRenderGen) && (il->format == fmt) &&
+      (il->flags == flags) && (il->cols == cols) && (il->buflen == buflen) &&
+      (il->msg_in_pager == Context->msg_in_pager) && (il->now == now))
+  {
+    mutt_str_copy(buf, il->line, buflen);
+    return;
+  }
+
+  mutt_make_string(buf, buflen, cols, fmt, m, Context->msg_in_pager, e, flags, NULL);
+
+  const size_t len = mutt_str_len(buf);
+  il = mutt_mem_malloc(sizeof(struct IndexLine) + len + 1);
+  il->gen = IndexRenderGen;
+  il->format = fmt;
+  il->flags = flags;
+  il->cols = cols;
+  il->buflen = buflen;
+  il->msg_in_pager = Context->msg_in_pager;
+  il->now = now;
+  for (size_t i = 0; i < mutt_array_size(il->colors); i++)
+    il->colors[i] = -1;
+  memcpy(il->line, buf, len + 1);
+  FREE(&e->render);
+  e->render = il;
+}
+
+/**
+ * index_render_invalidate - Forget the formatted index lines
+ *
+ * The lines are cached so that scrolling doesn't format them again.  Anything
+ * that might change them, e.g. a function that changes an Email's flags, a
+ * new config value or new mail, must call this.
+ */
+void index_render_invalidate(void)
+{
+  IndexRenderGen++;
+}
+
+/**
+ * index_field_color - Get the cached colour of a field of an index line
+ * @param e    Email
+ * @param type Colour, e.g. #MT_COLOR_INDEX_AUTHOR
+ * @retval ptr  Cached colour, -1 if it's not known yet
+ * @retval NULL The colour can't be cached
+ *
+ * The colour patterns are matched once for each version of the line, rather
+ * than every time it's drawn.  The cache is forgotten whenever the line is,
+ * see index_render_invalidate().
+ */
+int *index_field_color(struct Email *e, int type)
+{
+  struct IndexLine *il = e ? e->render : NULL;
+  if (!il || (il->gen != IndexRenderGen))
+    return NULL;
+
+  switch (type)
+  {
+    case MT_COLOR_INDEX_AUTHOR:
+      return &il->colors[0];
+    case MT_COLOR_INDEX_FLAGS:
+      return &il->colors[1];
+    case MT_COLOR_INDEX_SUBJECT:
+      return &il->colors[2];
+    default:
+      return NULL;
+  }
 }
 
 /**
@@ -1002,8 +1128,11 @@ void mutt_draw_statusline(int cols, const char *buf, size_t buflen)
     {
       regmatch_t pmatch[cl->match + 1];
 
-      if (regexec(&cl->regex, buf + offset, cl->match + 1, pmatch, 0) != 0)
+      if (!mutt_color_line_compile(cl) ||
+          (regexec(&cl->regex, buf + offset, cl->match + 1, pmatch, 0) != 0))
+      {
         continue; /* regex doesn't match the status bar */
+      }
 
       int first = pmatch[cl->match].rm_so + offset;
       int last = pmatch[cl->match].rm_eo + offset;
@@ -1115,6 +1244,11 @@ static void index_custom_redraw(struct Menu *menu)
       menu_redraw_index(menu);
       menu->redraw |= REDRAW_STATUS;
     }
+    else if (menu->redraw & REDRAW_SCROLL)
+    {
+      menu_redraw_scroll(menu);
+      menu->redraw |= REDRAW_STATUS;
+    }
     else if (menu->redraw & (REDRAW_MOTION_RESYNC | REDRAW_MOTION))
       menu_redraw_motion(menu);
     else if (menu->redraw & REDRAW_CURRENT)
@@ -1149,6 +1283,39 @@ static void index_custom_redraw(struct Menu *menu)
   menu->redraw = REDRAW_NO_FLAGS;
 }
 
+/**
+ * index_op_is_motion - Does a function only move around the index?
+ * @param op Operation, e.g. OP_NEXT_PAGE
+ * @retval true The function doesn't change any Emails
+ */
+static bool index_op_is_motion(int op)
+{
+  switch (op)
+  {
+    case OP_BOTTOM_PAGE:
+    case OP_CURRENT_BOTTOM:
+    case OP_CURRENT_MIDDLE:
+    case OP_CURRENT_TOP:
+    case OP_FIRST_ENTRY:
+    case OP_HALF_DOWN:
+    case OP_HALF_UP:
+    case OP_LAST_ENTRY:
+    case OP_MAIN_NEXT_UNDELETED:
+    case OP_MAIN_PREV_UNDELETED:
+    case OP_MIDDLE_PAGE:
+    case OP_NEXT_ENTRY:
+    case OP_NEXT_LINE:
+    case OP_NEXT_PAGE:
+    case OP_PREV_ENTRY:
+    case OP_PREV_LINE:
+    case OP_PREV_PAGE:
+    case OP_TOP_PAGE:
+      return true;
+    default:
+      return false;
+  }
+}
+
 /**
  * mutt_index_menu - Display a list of emails
  * @param dlg Dialog containing Windows to draw on
@@ -1239,6 +1406,7 @@ int mutt_index_menu(struct MuttWindow *dlg)
           (Context->mailbox->msg_count != 0) && ((c_sort & SORT_MASK) == SORT_THREADS))
       {
         mutt_draw_tree(Context->threads);
+        index_render_invalidate();
         menu->redraw |= REDRAW_STATUS;
         OptRedrawTree = false;
       }
@@ -1315,6 +1483,15 @@ int mutt_index_menu(struct MuttWindow *dlg)
         menu->redraw = REDRAW_FULL;
         OptSearchInvalid = true;
       }
+#ifdef USE_NOTMUCH
+      /* Load the next page of messages when the cursor nears either end */
+      else if ((check == MX_STATUS_OK) && (menu->max > 0) &&
+               ((menu->current < menu->pagelen) ||
+                (menu->current >= (menu->max - menu->pagelen))))
+      {
+        index_load_more(menu, Context, false, &cur);
+      }
+#endif
 
       if (Context)
       {
@@ -1330,6 +1507,12 @@ int mutt_index_menu(struct MuttWindow *dlg)
       newcount = mutt_mailbox_check(m, 0);
       if (newcount != oldcount)
         menu->redraw |= REDRAW_STATUS;
+      if (mutt_send_queue_check())
+        menu->redraw |= REDRAW_STATUS;
+#ifdef USE_IMAP
+      if (mutt_postponed_check_stats(false))
+        menu->redraw |= REDRAW_STATUS;
+#endif
       if (do_mailbox_notify)
       {
         if (mutt_mailbox_notify(m))
@@ -1367,8 +1550,19 @@ int mutt_index_menu(struct MuttWindow *dlg)
     }
     else
     {
-      index_custom_redraw(menu);
-      window_redraw(RootWindow, false);
+      /* in the middle of a macro, just keep the cursor in view */
+      const bool c_macro_redraw = cs_subset_bool(NeoMutt->sub, "macro_redraw");
+      if (!c_macro_redraw && mutt_macro_pending() && !SigWinch)
+      {
+        struct Mailbox *m = ctx_mailbox(Context);
+        if (m && m->emails && (menu->current < m->vcount))
+          menu_check_recenter(menu);
+      }
+      else
+      {
+        index_custom_redraw(menu);
+        window_redraw(RootWindow, false);
+      }
 
       /* give visual indication that the next command is a tag- command */
       if (tag)
@@ -1474,6 +1668,29 @@ int mutt_index_menu(struct MuttWindow *dlg)
       nm_db_debug_check(Context->mailbox);
 #endif
 
+#ifdef USE_NOTMUCH
+    /* Searching needs all the messages of a paged query */
+    switch (op)
+    {
+      case OP_LIMIT_CURRENT_THREAD:
+      case OP_MAIN_DELETE_PATTERN:
+      case OP_MAIN_LIMIT:
+      case OP_MAIN_TAG_PATTERN:
+      case OP_MAIN_UNDELETE_PATTERN:
+      case OP_MAIN_UNTAG_PATTERN:
+      case OP_SEARCH:
+      case OP_SEARCH_NEXT:
+      case OP_SEARCH_OPPOSITE:
+      case OP_SEARCH_REVERSE:
+        if (index_load_more(menu, Context, true, &cur))
+          set_current_email(&cur, mutt_get_virt_email(Context->mailbox, menu->current));
+        break;
+    }
+#endif
+
+    if (!index_op_is_motion(op))
+      index_render_invalidate();
+
     switch (op)
     {
         /* ----------------------------------------------------------------------
@@ -4097,7 +4314,8 @@ int mutt_index_menu(struct MuttWindow *dlg)
  */
 void mutt_set_header_color(struct Mailbox *m, struct Email *e)
 {
-  if (!e)
+  /* Without curses, e.g. `neomutt -X`, there are no colours */
+  if (!e || !Colors)
     return;
 
   struct ColorLine *color = NULL;
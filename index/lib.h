@@ -45,7 +45,9 @@ struct Menu;
 struct MuttWindow;
 
 int  index_color(struct Menu *menu, int line);
+int *index_field_color(struct Email *e, int type);
 void index_make_entry(struct Menu *menu, char *buf, size_t buflen, int line);
+void index_render_invalidate(void);
 void mutt_draw_statusline(int cols, const char *buf, size_t buflen);
 int  mutt_index_menu(struct MuttWindow *dlg);
 void mutt_set_header_color(struct Mailbox *m, struct Email *e);
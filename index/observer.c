@@ -33,6 +33,7 @@
 #include "email/lib.h"
 #include "core/lib.h"
 #include "gui/lib.h"
+#include "lib.h"
 #include "alternates.h"
 #include "attachments.h"
 #include "context.h"
@@ -195,7 +196,8 @@ static int index_subjrx_observer(struct NotifyCallback *nc)
 
   // struct MuttWindow *dlg = nc->global_data;
 
-  subjrx_clear_mods(ctx_mailbox(Context));
+  /* Nothing to free: subjrx_apply_mods() notices that the rules have changed
+   * and recreates each display subject as it's drawn */
   return 0;
 }
 
@@ -231,6 +233,21 @@ static int index_altern_observer(struct NotifyCallback *nc)
   return 0;
 }
 
+/**
+ * index_render_observer - Listen for changes affecting the index lines - Implements ::observer_t
+ *
+ * Almost any change, e.g. to the config, the colours or a Mailbox, can change
+ * the way the index looks.
+ */
+static int index_render_observer(struct NotifyCallback *nc)
+{
+  if (nc->event_type == NT_WINDOW)
+    return 0;
+
+  index_render_invalidate();
+  return 0;
+}
+
 /**
  * index_add_observers - Add Observers to the Index Dialog
  * @param dlg Index Dialog
@@ -244,6 +261,7 @@ void index_add_observers(struct MuttWindow *dlg)
   notify_observer_add(NeoMutt->notify, NT_SUBJRX, index_subjrx_observer, dlg);
   notify_observer_add(NeoMutt->notify, NT_ATTACH, index_attach_observer, dlg);
   notify_observer_add(NeoMutt->notify, NT_ALTERN, index_altern_observer, dlg);
+  notify_observer_add(NeoMutt->notify, NT_ALL, index_render_observer, dlg);
 }
 
 /**
@@ -259,4 +277,5 @@ void index_remove_observers(struct MuttWindow *dlg)
   notify_observer_remove(NeoMutt->notify, index_subjrx_observer, dlg);
   notify_observer_remove(NeoMutt->notify, index_attach_observer, dlg);
   notify_observer_remove(NeoMutt->notify, index_altern_observer, dlg);
+  notify_observer_remove(NeoMutt->notify, index_render_observer, dlg);
 }
@@ -65,6 +65,7 @@
 #include "myvar.h"
 #include "options.h"
 #include "protos.h"
+#include "rc_cache.h"
 #include "sort.h"
 #ifdef USE_SIDEBAR
 #include "sidebar/lib.h"
@@ -640,6 +641,7 @@ int mutt_extract_token(struct Buffer *dest, struct Buffer *tok, TokenFlags flags
 void mutt_opts_free(void)
 {
   clear_source_stack();
+  rc_cache_free();
 
   alias_shutdown();
 #ifdef USE_SIDEBAR
@@ -660,11 +662,14 @@ void mutt_opts_free(void)
   mutt_list_free(&AlternativeOrderList);
   mutt_list_free(&AutoViewList);
   mutt_list_free(&HeaderOrderList);
+  mutt_prefixset_free(&HeaderOrderSet);
   mutt_list_free(&Ignore);
+  mutt_prefixset_free(&IgnoreSet);
   mutt_list_free(&MailToAllow);
   mutt_list_free(&MimeLookupList);
   mutt_list_free(&Muttrc);
   mutt_list_free(&UnIgnore);
+  mutt_prefixset_free(&UnIgnoreSet);
   mutt_list_free(&UserHeader);
 
   mutt_colors_free(&Colors);
@@ -925,6 +930,8 @@ int mutt_init(struct ConfigSet *cs, bool skip_sys_rc, struct ListHead *commands)
   if (execute_commands(commands) != 0)
     need_pause = 1; // TEST13: neomutt -e broken
 
+  rc_cache_save();
+
   if (!get_hostname(cs))
     goto done;
 
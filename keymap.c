@@ -150,6 +150,22 @@ keycode_t AbortKey; ///< code of key to abort prompts, normally Ctrl-G
 
 struct KeymapList Keymaps[MENU_MAX];
 
+/**
+ * struct KeymapNode - A node in the trie of a Menu's key bindings
+ *
+ * The trie is built from the Menu's sorted KeymapList, when it's first needed.
+ */
+struct KeymapNode
+{
+  keycode_t key;                ///< Key that leads to this node
+  short num_children;           ///< Number of children
+  struct Keymap *map;           ///< Binding of the keys leading here, or NULL
+  struct KeymapNode *children;  ///< Keys that can follow, sorted by key
+};
+
+/// Tries of key bindings, built by km_get_trie()
+static struct KeymapNode *KeymapTries[MENU_MAX];
+
 #ifdef NCURSES_VERSION
 /**
  * struct Extkey - Map key names from NeoMutt's style to Curses style
@@ -212,6 +228,101 @@ static void mutt_keymap_free(struct Keymap **km)
   FREE(km);
 }
 
+/**
+ * keymap_node_free - Free the children of a trie node
+ * @param node Node of the trie
+ */
+static void keymap_node_free(struct KeymapNode *node)
+{
+  for (int i = 0; i < node->num_children; i++)
+    keymap_node_free(&node->children[i]);
+  FREE(&node->children);
+  node->num_children = 0;
+}
+
+/**
+ * km_trie_free - Free the trie of a Menu's key bindings
+ * @param menu Menu id, e.g. #MENU_EDITOR
+ *
+ * This must be called whenever the Menu's KeymapList changes.
+ */
+static void km_trie_free(enum MenuType menu)
+{
+  if (!KeymapTries[menu])
+    return;
+
+  keymap_node_free(KeymapTries[menu]);
+  FREE(&KeymapTries[menu]);
+}
+
+/**
+ * km_trie_find - Find the child of a trie node that matches a key
+ * @param node Node of the trie
+ * @param key  Key pressed
+ * @retval ptr  Child node
+ * @retval NULL No binding continues with this key
+ */
+static struct KeymapNode *km_trie_find(struct KeymapNode *node, int key)
+{
+  int lo = 0;
+  int hi = node->num_children - 1;
+  while (lo <= hi)
+  {
+    const int mid = (lo + hi) / 2;
+    if (node->children[mid].key == key)
+      return &node->children[mid];
+    if (node->children[mid].key < key)
+      lo = mid + 1;
+    else
+      hi = mid - 1;
+  }
+  return NULL;
+}
+
+/**
+ * km_get_trie - Get the trie of a Menu's key bindings
+ * @param menu Menu id, e.g. #MENU_EDITOR
+ * @retval ptr Root of the trie
+ */
+static struct KeymapNode *km_get_trie(enum MenuType menu)
+{
+  if (KeymapTries[menu])
+    return KeymapTries[menu];
+
+  struct KeymapNode *root = mutt_mem_calloc(1, sizeof(struct KeymapNode));
+
+  struct Keymap *map = NULL;
+  STAILQ_FOREACH(map, &Keymaps[menu], entries)
+  {
+    struct KeymapNode *node = root;
+    for (int pos = 0; (pos < map->len) && !node->map; pos++)
+    {
+      const keycode_t key = map->keys[pos];
+      struct KeymapNode *child = km_trie_find(node, key);
+      if (!child)
+      {
+        /* The list is sorted, so this is usually an append */
+        int i = node->num_children;
+        mutt_mem_realloc(&node->children, (i + 1) * sizeof(struct KeymapNode));
+        for (; (i > 0) && (node->children[i - 1].key > key); i--)
+          node->children[i] = node->children[i - 1];
+        node->num_children++;
+        child = &node->children[i];
+        memset(child, 0, sizeof(*child));
+        child->key = key;
+      }
+      node = child;
+    }
+
+    /* A shorter binding hides a longer one */
+    if (!node->map && (node->num_children == 0))
+      node->map = map;
+  }
+
+  KeymapTries[menu] = root;
+  return root;
+}
+
 /**
  * mutt_keymaplist_free - Free a List of Keymaps
  * @param km_list List of Keymaps to free
@@ -395,6 +506,7 @@ static enum CommandResult km_bind_err(const char *s, enum MenuType menu, int op,
 
   size_t len = parsekeys(s, buf, MAX_SEQ);
 
+  km_trie_free(menu);
   struct Keymap *map = alloc_keys(len, buf);
   map->op = op;
   map->macro = mutt_str_dup(macro);
@@ -660,11 +772,13 @@ static int retry_generic(enum MenuType menu, keycode_t *keys, int keyslen, int l
 int km_dokey(enum MenuType menu)
 {
   struct KeyEvent tmp;
-  struct Keymap *map = STAILQ_FIRST(&Keymaps[menu]);
+  struct KeymapNode *root = km_get_trie(menu);
+  struct KeymapNode *node = root;
+  keycode_t keys[MAX_SEQ];
   int pos = 0;
   int n = 0;
 
-  if (!map && (menu != MENU_EDITOR))
+  if ((root->num_children == 0) && (menu != MENU_EDITOR))
     return retry_generic(menu, NULL, 0, 0);
 
 #ifdef USE_IMAP
@@ -672,11 +786,29 @@ int km_dokey(enum MenuType menu)
       cs_subset_number(NeoMutt->sub, "imap_keepalive");
 #endif
 
+#ifdef USE_IMAP
+  /* the index has been drawn, so a Mailbox read from the header cache can
+   * catch up with the server */
+  if ((menu == MENU_MAIN) && imap_reconcile_pending())
+    return -2;
+#endif
+
   while (true)
   {
     const short c_timeout = cs_subset_number(NeoMutt->sub, "timeout");
     int i = (c_timeout > 0) ? c_timeout : 60;
 #ifdef USE_IMAP
+    /* download the messages that might be read next, until a key is pressed */
+    while ((menu != MENU_EDITOR) && imap_prefetch_pending())
+    {
+      mutt_getch_timeout(0);
+      tmp = mutt_getch();
+      mutt_getch_timeout(-1);
+      if ((tmp.ch != -2) || SigWinch)
+        goto gotkey;
+      imap_prefetch();
+    }
+
     /* keepalive may need to run more frequently than `$timeout` allows */
     if (c_imap_keepalive)
     {
@@ -695,7 +827,7 @@ int km_dokey(enum MenuType menu)
           if ((tmp.ch != -2) || SigWinch)
             goto gotkey;
 #ifdef USE_INOTIFY
-          if (MonitorFilesChanged)
+          if (MonitorFilesChanged || MonitorSocketsRead)
             goto gotkey;
 #endif
           i -= c_imap_keepalive;
@@ -764,21 +896,19 @@ int km_dokey(enum MenuType menu)
         continue;
     }
 
-    if (!map)
+    if (root->num_children == 0)
       return tmp.op;
 
     /* Nope. Business as usual */
-    while (LastKey > map->keys[pos])
-    {
-      if ((pos > map->eq) || !STAILQ_NEXT(map, entries))
-        return retry_generic(menu, map->keys, pos, LastKey);
-      map = STAILQ_NEXT(map, entries);
-    }
+    struct KeymapNode *next = km_trie_find(node, LastKey);
+    if (!next)
+      return retry_generic(menu, keys, pos, LastKey);
 
-    if (LastKey != map->keys[pos])
-      return retry_generic(menu, map->keys, pos, LastKey);
+    node = next;
+    keys[pos++] = LastKey;
 
-    if (++pos == map->len)
+    struct Keymap *map = node->map;
+    if (map)
     {
       if (map->op != OP_MACRO)
         return map->op;
@@ -806,7 +936,7 @@ int km_dokey(enum MenuType menu)
       }
 
       generic_tokenize_push_string(map->macro, mutt_push_macro_event);
-      map = STAILQ_FIRST(&Keymaps[menu]);
+      node = root;
       pos = 0;
     }
   }
@@ -1535,6 +1665,7 @@ enum CommandResult mutt_parse_unbind(struct Buffer *buf, struct Buffer *s,
     if (all_keys)
     {
       km_unbind_all(&Keymaps[i], data);
+      km_trie_free(i);
       km_bindkey("<enter>", MENU_GENERIC, OP_GENERIC_SELECT_ENTRY);
       km_bindkey("<return>", MENU_GENERIC, OP_GENERIC_SELECT_ENTRY);
       km_bindkey("<enter>", MENU_MAIN, OP_DISPLAY_MESSAGE);
@@ -1709,5 +1840,6 @@ void mutt_keys_free(void)
   for (int i = 0; i < MENU_MAX; i++)
   {
     mutt_keymaplist_free(&Keymaps[i]);
+    km_trie_free(i);
   }
 }
@@ -30,12 +30,20 @@
  *
  * This file contains various functions for implementing a fair subset of
  * RFC1524.
+ *
+ * Each mailcap file is read once and its entries indexed by their base type,
+ * e.g. "image".  A file is read again if its size or modification time
+ * changes.  The results of `test=` commands that don't depend on the
+ * attachment are remembered until the environment changes.
  */
 
 #include "config.h"
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <time.h>
 #include "mutt/lib.h"
 #include "config/lib.h"
 #include "email/lib.h"
@@ -45,6 +53,37 @@
 #include "muttlib.h"
 #include "protos.h"
 
+/**
+ * struct MailcapLine - An entry in a mailcap file
+ */
+struct MailcapLine
+{
+  char *text; ///< Text of the entry, continuation lines joined
+  int line;   ///< Line number of the entry
+  int next;   ///< Index of the next entry with the same base type, -1 if none
+};
+ARRAY_HEAD(MailcapLineArray, struct MailcapLine);
+
+/**
+ * struct MailcapFile - A parsed mailcap file
+ */
+struct MailcapFile
+{
+  time_t mtime;                  ///< Modification time of the file
+  off_t size;                    ///< Size of the file
+  struct MailcapLineArray lines; ///< Entries, in file order
+  struct HashTable *types;       ///< Base type -> first entry, plus 1
+};
+
+/// Parsed mailcap files, path -> MailcapFile
+static struct HashTable *MailcapFiles = NULL;
+
+/// Results of `test=` commands, command -> #MAILCAP_TEST_PASS or #MAILCAP_TEST_FAIL
+static struct HashTable *MailcapTests = NULL;
+
+#define MAILCAP_TEST_PASS 1 ///< The test command succeeded
+#define MAILCAP_TEST_FAIL 2 ///< The test command failed
+
 /**
  * mailcap_expand_command - Expand expandos in a command
  * @param a        Email Body
@@ -218,6 +257,152 @@ static int get_field_text(char *field, char **entry, const char *type,
   }
 }
 
+/**
+ * mailcap_file_free - Free a MailcapFile - Implements ::hash_hdata_free_t
+ */
+static void mailcap_file_free(int type, void *obj, intptr_t data)
+{
+  struct MailcapFile *mf = obj;
+
+  struct MailcapLine *ml = NULL;
+  ARRAY_FOREACH(ml, &mf->lines)
+  {
+    FREE(&ml->text);
+  }
+  ARRAY_FREE(&mf->lines);
+  mutt_hash_free(&mf->types);
+  FREE(&mf);
+}
+
+/**
+ * mailcap_file_read - Read and index a mailcap file
+ * @param filename Filename
+ * @param st       Details of the file
+ * @retval ptr Parsed file
+ */
+static struct MailcapFile *mailcap_file_read(const char *filename, const struct stat *st)
+{
+  FILE *fp = fopen(filename, "r");
+  if (!fp)
+    return NULL;
+
+  struct MailcapFile *mf = mutt_mem_calloc(1, sizeof(*mf));
+  mf->mtime = st->st_mtime;
+  mf->size = st->st_size;
+  ARRAY_INIT(&mf->lines);
+  mf->types = mutt_hash_new(64, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS);
+
+  char *buf = NULL;
+  size_t buflen = 0;
+  int line = 0;
+  while ((buf = mutt_file_read_line(buf, &buflen, fp, &line, MUTT_RL_CONT)))
+  {
+    /* ignore comments */
+    if ((*buf == '#') || (*buf == '\0'))
+      continue;
+
+    struct MailcapLine ml = { mutt_str_dup(buf), line, -1 };
+    ARRAY_ADD(&mf->lines, ml);
+  }
+  FREE(&buf);
+  mutt_file_fclose(&fp);
+
+  /* chain the entries of each base type, in file order */
+  char *type = NULL;
+  for (int i = ARRAY_SIZE(&mf->lines) - 1; i >= 0; i--)
+  {
+    struct MailcapLine *ml = ARRAY_GET(&mf->lines, i);
+    mutt_str_replace(&type, ml->text);
+    get_field(type);
+    char *slash = strchr(type, '/');
+    if (slash)
+      *slash = '\0';
+
+    struct HashElem *he = mutt_hash_find_elem(mf->types, type);
+    if (he)
+    {
+      ml->next = (intptr_t) he->data - 1;
+      he->data = (void *) (intptr_t) (i + 1);
+    }
+    else
+    {
+      mutt_hash_insert(mf->types, type, (void *) (intptr_t) (i + 1));
+    }
+  }
+  FREE(&type);
+
+  mutt_debug(LL_DEBUG2, "read %zu mailcap entries from %s\n",
+             ARRAY_SIZE(&mf->lines), filename);
+  return mf;
+}
+
+/**
+ * mailcap_file_get - Get a parsed mailcap file
+ * @param filename Filename
+ * @retval ptr  Parsed file
+ * @retval NULL The file can't be read
+ *
+ * The file is only read again if it has changed.
+ */
+static struct MailcapFile *mailcap_file_get(const char *filename)
+{
+  if (!MailcapFiles)
+  {
+    MailcapFiles = mutt_hash_new(8, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(MailcapFiles, mailcap_file_free, 0);
+  }
+
+  struct MailcapFile *mf = mutt_hash_find(MailcapFiles, filename);
+
+  struct stat st = { 0 };
+  if (stat(filename, &st) != 0)
+  {
+    if (mf)
+      mutt_hash_delete(MailcapFiles, filename, mf);
+    return NULL;
+  }
+
+  if (mf && (mf->mtime == st.st_mtime) && (mf->size == st.st_size))
+    return mf;
+
+  if (mf)
+    mutt_hash_delete(MailcapFiles, filename, mf);
+
+  mf = mailcap_file_read(filename, &st);
+  if (mf)
+    mutt_hash_insert(MailcapFiles, filename, mf);
+  return mf;
+}
+
+/**
+ * mailcap_test - Run a mailcap test command
+ * @param command Command to run
+ * @param cache   true if the result may be remembered
+ * @retval true The test passed
+ */
+static bool mailcap_test(const char *command, bool cache)
+{
+  if (cache && MailcapTests)
+  {
+    intptr_t result = (intptr_t) mutt_hash_find(MailcapTests, command);
+    if (result != 0)
+      return (result == MAILCAP_TEST_PASS);
+  }
+
+  /* a non-zero exit code means test failed */
+  const bool pass = (mutt_system(command) == 0);
+
+  if (cache)
+  {
+    if (!MailcapTests)
+      MailcapTests = mutt_hash_new(32, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_insert(MailcapTests, command,
+                     (void *) (intptr_t) (pass ? MAILCAP_TEST_PASS : MAILCAP_TEST_FAIL));
+  }
+
+  return pass;
+}
+
 /**
  * rfc1524_mailcap_parse - Parse a mailcap entry
  * @param a        Email Body
@@ -251,15 +436,18 @@ static bool rfc1524_mailcap_parse(struct Body *a, const char *filename, const ch
     return false;
   const int btlen = ch - type;
 
-  FILE *fp = fopen(filename, "r");
-  if (fp)
+  struct MailcapFile *mf = mailcap_file_get(filename);
+  if (mf)
   {
-    size_t buflen;
-    while (!found && (buf = mutt_file_read_line(buf, &buflen, fp, &line, MUTT_RL_CONT)))
+    char *basetype = mutt_strn_dup(type, btlen);
+    const intptr_t first = (intptr_t) mutt_hash_find(mf->types, basetype) - 1;
+    FREE(&basetype);
+
+    for (int i = first; !found && (i >= 0); i = ARRAY_GET(&mf->lines, i)->next)
     {
-      /* ignore comments */
-      if (*buf == '#')
-        continue;
+      const struct MailcapLine *ml = ARRAY_GET(&mf->lines, i);
+      mutt_str_replace(&buf, ml->text);
+      line = ml->line;
       mutt_debug(LL_DEBUG2, "mailcap entry: %s\n", buf);
 
       /* check type */
@@ -360,11 +548,10 @@ static bool rfc1524_mailcap_parse(struct Body *a, const char *filename, const ch
             else
               mutt_buffer_strcpy(afilename, NONULL(a->filename));
             mailcap_expand_command(a, mutt_buffer_string(afilename), type, command);
-            if (mutt_system(mutt_buffer_string(command)))
-            {
-              /* a non-zero exit code means test failed */
+            /* only a test that doesn't look at the attachment can be cached */
+            const bool cache = !strchr(test_command, '%');
+            if (!mailcap_test(mutt_buffer_string(command), cache))
               found = false;
-            }
             FREE(&test_command);
             mutt_buffer_pool_release(&command);
             mutt_buffer_pool_release(&afilename);
@@ -415,13 +602,23 @@ static bool rfc1524_mailcap_parse(struct Body *a, const char *filename, const ch
           entry->xneomuttkeep = false;
         }
       }
-    } /* while (!found && (buf = mutt_file_read_line ())) */
-    mutt_file_fclose(&fp);
-  } /* if ((fp = fopen ())) */
+    } /* for each entry of the base type */
+  }
   FREE(&buf);
   return found;
 }
 
+/**
+ * mailcap_cache_free - Forget the parsed mailcap files and test results
+ *
+ * This should be called if the environment of the test commands changes.
+ */
+void mailcap_cache_free(void)
+{
+  mutt_hash_free(&MailcapFiles);
+  mutt_hash_free(&MailcapTests);
+}
+
 /**
  * mailcap_entry_new - Allocate memory for a new rfc1524 entry
  * @retval ptr An un-initialized struct MailcapEntry
@@ -59,6 +59,7 @@ enum MailcapLookup
   MUTT_MC_AUTOVIEW,     ///< Mailcap autoview field
 };
 
+void                 mailcap_cache_free(void);
 void                 mailcap_entry_free(struct MailcapEntry **ptr);
 struct MailcapEntry *mailcap_entry_new(void);
 int                  mailcap_expand_command(struct Body *a, const char *filename, const char *type, struct Buffer *command);
@@ -41,6 +41,7 @@
 #define MUTT_MAILDIR_LIB_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include "core/lib.h"
 
@@ -50,8 +51,20 @@ struct HeaderCache;
 extern struct MxOps MxMaildirOps;
 extern struct MxOps MxMhOps;
 
+/**
+ * struct MaildirCheck - A Maildir to check, see maildir_check_stats_all()
+ */
+struct MaildirCheck
+{
+  struct Mailbox *mailbox; ///< Mailbox to check
+  uint8_t flags;           ///< Flags for MxOps::mbox_check_stats()
+  enum MxStatus rc;        ///< Result of the check
+};
+
 int           maildir_check_empty      (const char *path);
+void          maildir_check_stats_all  (struct MaildirCheck *checks, size_t num);
 void          maildir_gen_flags        (char *dest, size_t destlen, struct Email *e);
+bool          maildir_msg_link         (struct Mailbox *m_dst, struct Mailbox *m_src, const struct Email *e);
 bool          maildir_msg_open_new     (struct Mailbox *m, struct Message *msg, const struct Email *e);
 FILE *        maildir_open_find_message(const char *folder, const char *msg, char **newname);
 void          maildir_parse_flags      (struct Email *e, const char *path);
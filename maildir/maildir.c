@@ -69,84 +69,163 @@
 #define MMC_NEW_DIR (1 << 0) ///< 'new' directory changed
 #define MMC_CUR_DIR (1 << 1) ///< 'cur' directory changed
 
+#define MAILDIR_READAHEAD       32          ///< Number of messages to open ahead of the parser
+#define MAILDIR_HCACHE_BATCH    256         ///< Number of messages to look up in the header cache at once
+
+/**
+ * struct MaildirStats - A Maildir being checked for new mail
+ *
+ * The counts are copied from the Mailbox so that the directories can be
+ * scanned on any thread, see maildir_check_stats_all().
+ */
+struct MaildirStats
+{
+  struct Mailbox *mailbox;      ///< Mailbox being checked
+  char path[PATH_MAX];          ///< Path to the Mailbox
+  struct timespec last_visited; ///< Time the Mailbox was last visited
+  bool check_stats;             ///< Count the total, new and flagged messages
+  bool check_cur;               ///< Copy of $maildir_check_cur
+  bool check_recent;            ///< Copy of $mail_check_recent
+  bool has_new;                 ///< Mailbox::has_new
+  bool unknown;                 ///< A directory couldn't be read
+  time_t now;                   ///< Time the check started
+  struct MaildirMboxData *mdata; ///< Cached results, see #MaildirDirStats
+  int msg_count;                ///< Mailbox::msg_count
+  int msg_unread;               ///< Mailbox::msg_unread
+  int msg_flagged;              ///< Mailbox::msg_flagged
+  int msg_new;                  ///< Mailbox::msg_new
+};
+
 /**
  * maildir_check_dir - Check for new mail / mail counts
- * @param m           Mailbox to check
- * @param dir_name    Path to Mailbox
+ * @param ms          Maildir being checked
+ * @param dir_name    Subdirectory, "cur" or "new"
  * @param check_new   if true, check for new mail
  * @param check_stats if true, count total, new, and flagged messages
  *
  * Checks the specified maildir subdir (cur or new) for new mail or mail counts.
+ *
+ * If the directory hasn't changed since it was last checked the same way,
+ * the cached results are used instead of reading it.
+ *
+ * @note This may run on a worker thread
  */
-static void maildir_check_dir(struct Mailbox *m, const char *dir_name,
+static void maildir_check_dir(struct MaildirStats *ms, const char *dir_name,
                               bool check_new, bool check_stats)
 {
   DIR *dirp = NULL;
   struct dirent *de = NULL;
   char *p = NULL;
   struct stat sb;
+  char path[PATH_MAX];
+  char msgpath[PATH_MAX];
 
-  struct Buffer *path = mutt_buffer_pool_get();
-  struct Buffer *msgpath = mutt_buffer_pool_get();
-  mutt_buffer_printf(path, "%s/%s", mailbox_path(m), dir_name);
+  if (snprintf(path, sizeof(path), "%s/%s", ms->path, dir_name) >= sizeof(path))
+  {
+    ms->unknown = true;
+    return;
+  }
+
+  struct stat dir_sb = { 0 };
+  const bool dir_ok = (stat(path, &dir_sb) == 0);
 
   /* when $mail_check_recent is set, if the new/ directory hasn't been modified since
    * the user last exited the m, then we know there is no recent mail.  */
-  const bool c_mail_check_recent =
-      cs_subset_bool(NeoMutt->sub, "mail_check_recent");
-  if (check_new && c_mail_check_recent)
+  if (check_new && ms->check_recent)
   {
-    if ((stat(mutt_buffer_string(path), &sb) == 0) &&
-        (mutt_file_stat_timespec_compare(&sb, MUTT_STAT_MTIME, &m->last_visited) < 0))
+    if (dir_ok &&
+        (mutt_file_stat_timespec_compare(&dir_sb, MUTT_STAT_MTIME, &ms->last_visited) < 0))
     {
       check_new = false;
     }
   }
 
   if (!(check_new || check_stats))
-    goto cleanup;
+    return;
+
+  struct MaildirDirStats *cache = NULL;
+  if (ms->mdata)
+    cache = mutt_str_equal(dir_name, "new") ? &ms->mdata->stats_new : &ms->mdata->stats_cur;
+
+  struct timespec dir_mtime = { 0 };
+  mutt_file_get_stat_timespec(&dir_mtime, &dir_sb, MUTT_STAT_MTIME);
 
-  dirp = opendir(mutt_buffer_string(path));
+  if (cache && dir_ok && cache->valid && (cache->dev == dir_sb.st_dev) &&
+      (cache->ino == dir_sb.st_ino) && (cache->mtime.tv_sec == dir_mtime.tv_sec) &&
+      (cache->mtime.tv_nsec == dir_mtime.tv_nsec) && (cache->check_new == check_new) &&
+      (cache->check_stats == check_stats) && (cache->check_recent == ms->check_recent) &&
+      (!ms->check_recent ||
+       ((cache->last_visited.tv_sec == ms->last_visited.tv_sec) &&
+        (cache->last_visited.tv_nsec == ms->last_visited.tv_nsec))))
+  {
+    ms->msg_count += cache->msg_count;
+    ms->msg_unread += cache->msg_unread;
+    ms->msg_flagged += cache->msg_flagged;
+    ms->msg_new += cache->msg_new;
+    if (cache->has_new)
+      ms->has_new = true;
+    return;
+  }
+
+  if (cache)
+    cache->valid = false;
+
+  dirp = opendir(path);
   if (!dirp)
   {
-    m->type = MUTT_UNKNOWN;
-    goto cleanup;
+    ms->unknown = true;
+    return;
   }
 
+  const int count = ms->msg_count;
+  const int unread = ms->msg_unread;
+  const int flagged = ms->msg_flagged;
+  const int new_count = ms->msg_new;
+  const bool want_new = check_new;
+  bool has_new = false;
+
   while ((de = readdir(dirp)))
   {
     if (*de->d_name == '.')
       continue;
 
+#ifdef DT_DIR
+    /* Where the filesystem reports the type, skip anything that isn't a
+     * message without a stat().  DT_UNKNOWN entries are kept, as before. */
+    if ((de->d_type != DT_UNKNOWN) && (de->d_type != DT_REG) && (de->d_type != DT_LNK))
+      continue;
+#endif
+
     p = strstr(de->d_name, ":2,");
     if (p && strchr(p + 3, 'T'))
       continue;
 
     if (check_stats)
     {
-      m->msg_count++;
+      ms->msg_count++;
       if (p && strchr(p + 3, 'F'))
-        m->msg_flagged++;
+        ms->msg_flagged++;
     }
     if (!p || !strchr(p + 3, 'S'))
     {
       if (check_stats)
-        m->msg_unread++;
+        ms->msg_unread++;
       if (check_new)
       {
-        if (c_mail_check_recent)
+        if (ms->check_recent)
         {
-          mutt_buffer_printf(msgpath, "%s/%s", mutt_buffer_string(path), de->d_name);
           /* ensure this message was received since leaving this m */
-          if ((stat(mutt_buffer_string(msgpath), &sb) == 0) &&
-              (mutt_file_stat_timespec_compare(&sb, MUTT_STAT_CTIME, &m->last_visited) <= 0))
+          int len = snprintf(msgpath, sizeof(msgpath), "%s/%s", path, de->d_name);
+          if ((len < sizeof(msgpath)) && (stat(msgpath, &sb) == 0) &&
+              (mutt_file_stat_timespec_compare(&sb, MUTT_STAT_CTIME, &ms->last_visited) <= 0))
           {
             continue;
           }
         }
-        m->has_new = true;
+        ms->has_new = true;
+        has_new = true;
         check_new = false;
-        m->msg_new++;
+        ms->msg_new++;
         if (!check_stats)
           break;
       }
@@ -155,9 +234,24 @@ static void maildir_check_dir(struct Mailbox *m, const char *dir_name,
 
   closedir(dirp);
 
-cleanup:
-  mutt_buffer_pool_release(&path);
-  mutt_buffer_pool_release(&msgpath);
+  /* A directory changed in the last second might change again without its
+   * mtime changing, so don't trust it */
+  if (!cache || !dir_ok || (dir_mtime.tv_sec >= (ms->now - 1)))
+    return;
+
+  cache->valid = true;
+  cache->dev = dir_sb.st_dev;
+  cache->ino = dir_sb.st_ino;
+  cache->mtime = dir_mtime;
+  cache->last_visited = ms->last_visited;
+  cache->check_new = want_new;
+  cache->check_stats = check_stats;
+  cache->check_recent = ms->check_recent;
+  cache->has_new = has_new;
+  cache->msg_count = ms->msg_count - count;
+  cache->msg_unread = ms->msg_unread - unread;
+  cache->msg_flagged = ms->msg_flagged - flagged;
+  cache->msg_new = ms->msg_new - new_count;
 }
 
 /**
@@ -236,7 +330,8 @@ int maildir_commit_message(struct Mailbox *m, struct Message *msg, struct Email
   char suffix[16];
   int rc = 0;
 
-  if (mutt_file_fsync_close(&msg->fp))
+  /* Only new messages (e == NULL) can be part of a batch */
+  if (e ? mutt_file_fsync_close(&msg->fp) : maildir_append_close(m, &msg->fp))
   {
     mutt_perror(_("Could not flush message to disk"));
     return -1;
@@ -298,6 +393,8 @@ int maildir_commit_message(struct Mailbox *m, struct Message *msg, struct Email
       if (e)
         mutt_str_replace(&e->path, mutt_buffer_string(path));
       mutt_str_replace(&msg->committed_path, mutt_buffer_string(full));
+      if (!e)
+        maildir_append_add(m, mutt_buffer_string(full));
       FREE(&msg->path);
 
       goto cleanup;
@@ -494,7 +591,40 @@ static int maildir_cmp_inode(const void *a, const void *b)
   const struct MdEmail *ma = *(struct MdEmail **) a;
   const struct MdEmail *mb = *(struct MdEmail **) b;
 
-  return ma->inode - mb->inode;
+  /* ino_t is usually 64-bit, so the difference won't fit in an int */
+  if (ma->inode < mb->inode)
+    return -1;
+  return (ma->inode > mb->inode);
+}
+
+/**
+ * maildir_entry_from_name - Create an unparsed Email for a Maildir file
+ * @param subdir Subdirectory, e.g. 'new'
+ * @param name   Filename, relative to subdir
+ * @param is_old true if the Email should be marked as old
+ * @retval ptr New Maildir Email helper
+ *
+ * Only the flags encoded in the filename are set, the headers are read later
+ * by maildir_delayed_parsing().
+ */
+static struct MdEmail *maildir_entry_from_name(const char *subdir,
+                                               const char *name, bool is_old)
+{
+  struct Email *e = email_new();
+  e->edata = maildir_edata_new();
+  e->edata_free = maildir_edata_free;
+
+  e->old = is_old;
+  maildir_parse_flags(e, name);
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+  mutt_buffer_printf(buf, "%s/%s", subdir, name);
+  e->path = mutt_buffer_strdup(buf);
+  mutt_buffer_pool_release(&buf);
+
+  struct MdEmail *entry = maildir_entry_new();
+  entry->email = e;
+  return entry;
 }
 
 /**
@@ -506,6 +636,10 @@ static int maildir_cmp_inode(const void *a, const void *b)
  * @retval  0 Success
  * @retval -1 Error
  * @retval -2 Aborted
+ *
+ * The messages are only named here; they're read by maildir_delayed_parsing().
+ * Sorting them by inode means that they'll then be read, and read ahead, in
+ * roughly the order they're stored on disk.
  */
 int maildir_parse_dir(struct Mailbox *m, struct MdEmailArray *mda,
                       const char *subdir, struct Progress *progress)
@@ -514,7 +648,6 @@ int maildir_parse_dir(struct Mailbox *m, struct MdEmailArray *mda,
   int rc = 0;
   bool is_old = false;
   struct MdEmail *entry = NULL;
-  struct Email *e = NULL;
 
   struct Buffer *buf = mutt_buffer_pool_get();
 
@@ -534,24 +667,20 @@ int maildir_parse_dir(struct Mailbox *m, struct MdEmailArray *mda,
     if (*de->d_name == '.')
       continue;
 
+#ifdef DT_DIR
+    /* Where the filesystem reports the type, skip anything that isn't a
+     * message without a stat().  DT_UNKNOWN entries are kept, as before. */
+    if ((de->d_type != DT_UNKNOWN) && (de->d_type != DT_REG) && (de->d_type != DT_LNK))
+      continue;
+#endif
+
     /* FOO - really ignore the return value? */
     mutt_debug(LL_DEBUG2, "queueing %s\n", de->d_name);
 
-    e = email_new();
-    e->edata = maildir_edata_new();
-    e->edata_free = maildir_edata_free;
-
-    e->old = is_old;
-    maildir_parse_flags(e, de->d_name);
-
     if (m->verbose && progress)
       mutt_progress_update(progress, ARRAY_SIZE(mda) + 1, -1);
 
-    mutt_buffer_printf(buf, "%s/%s", subdir, de->d_name);
-    e->path = mutt_buffer_strdup(buf);
-
-    entry = maildir_entry_new();
-    entry->email = e;
+    entry = maildir_entry_from_name(subdir, de->d_name, is_old);
     entry->inode = de->d_ino;
     ARRAY_ADD(mda, entry);
   }
@@ -585,21 +714,127 @@ size_t maildir_hcache_keylen(const char *fn)
   return p ? (size_t)(p - fn) : mutt_str_len(fn);
 }
 
+/**
+ * maildir_readahead - Open a message and start reading it in the background
+ * @param m  Mailbox
+ * @param md Maildir Email
+ * @retval ptr  File handle
+ * @retval NULL Error
+ *
+ * Parsing a message blocks on reading it.  By opening the next few messages
+ * early, and hinting that we'll read them, the device can fetch them all in
+ * parallel while the parser works through them one at a time.
+ */
+static FILE *maildir_readahead(struct Mailbox *m, struct MdEmail *md)
+{
+  char fn[PATH_MAX];
+  snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), md->email->path);
+
+  FILE *fp = fopen(fn, "r");
+#ifdef POSIX_FADV_WILLNEED
+  if (fp)
+    posix_fadvise(fileno(fp), 0, MAILDIR_READAHEAD_BYTES, POSIX_FADV_WILLNEED);
+#endif
+  return fp;
+}
+
+#ifdef USE_HCACHE
+/**
+ * maildir_hcache_read - Read Emails from the header cache
+ * @param[in]  m        Mailbox
+ * @param[in]  hc       Header cache
+ * @param[in]  mda      Maildir Emails to look up
+ * @param[out] misses   Maildir Emails that aren't in the cache
+ * @param[in]  progress Progress bar
+ * @param[out] done     Number of Emails processed
+ *
+ * The Emails are looked up in batches, so the backend can read the records in
+ * the order they're stored.
+ */
+static void maildir_hcache_read(struct Mailbox *m, struct HeaderCache *hc,
+                                struct MdEmailArray *mda, struct MdEmailArray *misses,
+                                struct Progress *progress, size_t *done)
+{
+  char fn[PATH_MAX];
+  const char *keys[MAILDIR_HCACHE_BATCH];
+  size_t keylens[MAILDIR_HCACHE_BATCH];
+  struct HCacheEntry entries[MAILDIR_HCACHE_BATCH];
+
+  const bool c_maildir_header_cache_verify =
+      cs_subset_bool(NeoMutt->sub, "maildir_header_cache_verify");
+
+  const size_t count = ARRAY_SIZE(mda);
+  for (size_t start = 0; start < count; start += MAILDIR_HCACHE_BATCH)
+  {
+    const size_t num = MIN(count - start, MAILDIR_HCACHE_BATCH);
+    for (size_t i = 0; i < num; i++)
+    {
+      struct MdEmail *md = *ARRAY_GET(mda, start + i);
+      keys[i] = md->email->path + 3;
+      keylens[i] = maildir_hcache_keylen(keys[i]);
+    }
+
+    mutt_hcache_fetch_many(hc, keys, keylens, num, 0, entries);
+
+    for (size_t i = 0; i < num; i++)
+    {
+      struct MdEmail *md = *ARRAY_GET(mda, start + i);
+      struct HCacheEntry *hce = &entries[i];
+
+      snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), md->email->path);
+
+      struct stat lastchanged = { 0 };
+      int rc = 0;
+      if (c_maildir_header_cache_verify)
+      {
+        rc = stat(fn, &lastchanged);
+      }
+
+      if (hce->email && (rc == 0) && (lastchanged.st_mtime <= hce->uidvalidity))
+      {
+        if (m->verbose && progress)
+          mutt_progress_update(progress, *done, -1);
+        (*done)++;
+
+        hce->email->edata = maildir_edata_new();
+        hce->email->edata_free = maildir_edata_free;
+        hce->email->old = md->email->old;
+        hce->email->path = mutt_str_dup(md->email->path);
+        email_free(&md->email);
+        md->email = hce->email;
+        maildir_parse_flags(md->email, fn);
+        continue;
+      }
+      email_free(&hce->email);
+
+      ARRAY_ADD(misses, md);
+    }
+  }
+}
+#endif
+
 /**
  * maildir_delayed_parsing - This function does the second parsing pass
  * @param[in]  m   Mailbox
  * @param[out] mda Maildir array to parse
  * @param[in]  progress Progress bar
+ *
+ * First, as many Emails as possible are read from the header cache.  Then the
+ * rest are parsed from their files, which are read ahead of the parser.
  */
 void maildir_delayed_parsing(struct Mailbox *m, struct MdEmailArray *mda,
                              struct Progress *progress)
 {
   char fn[PATH_MAX];
+  size_t done = 0;
+  struct MdEmailArray misses = ARRAY_HEAD_INITIALIZER;
 
 #ifdef USE_HCACHE
   const char *const c_header_cache =
       cs_subset_path(NeoMutt->sub, "header_cache");
   struct HeaderCache *hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  mutt_hcache_begin_txn(hc);
+  struct MdEmailArray lookups = ARRAY_HEAD_INITIALIZER;
 #endif
 
   struct MdEmail *md = NULL;
@@ -610,52 +845,65 @@ void maildir_delayed_parsing(struct Mailbox *m, struct MdEmailArray *mda,
     if (!md || !md->email || md->header_parsed)
       continue;
 
-    if (m->verbose && progress)
-      mutt_progress_update(progress, ARRAY_FOREACH_IDX, -1);
-
-    snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), md->email->path);
-
 #ifdef USE_HCACHE
-    struct stat lastchanged = { 0 };
-    int rc = 0;
-    const bool c_maildir_header_cache_verify =
-        cs_subset_bool(NeoMutt->sub, "maildir_header_cache_verify");
-    if (c_maildir_header_cache_verify)
+    if (hc)
     {
-      rc = stat(fn, &lastchanged);
+      ARRAY_ADD(&lookups, md);
+      continue;
     }
+#endif
 
-    const char *key = md->email->path + 3;
-    size_t keylen = maildir_hcache_keylen(key);
-    struct HCacheEntry hce = mutt_hcache_fetch(hc, key, keylen, 0);
+    ARRAY_ADD(&misses, md);
+  }
+
+#ifdef USE_HCACHE
+  maildir_hcache_read(m, hc, &lookups, &misses, progress, &done);
+  ARRAY_FREE(&lookups);
+#endif
+
+  /* Keep the next few files in flight while parsing */
+  FILE *ahead[MAILDIR_READAHEAD] = { NULL };
+  const size_t count = ARRAY_SIZE(&misses);
+  for (size_t i = 0; (i < count) && (i < MAILDIR_READAHEAD); i++)
+    ahead[i] = maildir_readahead(m, *ARRAY_GET(&misses, i));
 
-    if (hce.email && (rc == 0) && (lastchanged.st_mtime <= hce.uidvalidity))
+  ARRAY_FOREACH(mdp, &misses)
+  {
+    md = *mdp;
+    const size_t i = ARRAY_FOREACH_IDX;
+
+    FILE *fp = ahead[i % MAILDIR_READAHEAD];
+    ahead[i % MAILDIR_READAHEAD] = NULL;
+    if ((i + MAILDIR_READAHEAD) < count)
     {
-      hce.email->edata = maildir_edata_new();
-      hce.email->edata_free = maildir_edata_free;
-      hce.email->old = md->email->old;
-      hce.email->path = mutt_str_dup(md->email->path);
-      email_free(&md->email);
-      md->email = hce.email;
-      maildir_parse_flags(md->email, fn);
+      ahead[i % MAILDIR_READAHEAD] =
+          maildir_readahead(m, *ARRAY_GET(&misses, i + MAILDIR_READAHEAD));
     }
-    else
-#endif
+
+    if (m->verbose && progress)
+      mutt_progress_update(progress, done, -1);
+    done++;
+
+    snprintf(fn, sizeof(fn), "%s/%s", mailbox_path(m), md->email->path);
+
+    if (fp && maildir_parse_stream(m->type, fp, fn, md->email->old, md->email))
     {
-      if (maildir_parse_message(m->type, fn, md->email->old, md->email))
-      {
-        md->header_parsed = true;
+      md->header_parsed = true;
 #ifdef USE_HCACHE
-        key = md->email->path + 3;
-        keylen = maildir_hcache_keylen(key);
-        mutt_hcache_store(hc, key, keylen, md->email, 0);
+      const char *key = md->email->path + 3;
+      size_t keylen = maildir_hcache_keylen(key);
+      mutt_hcache_store(hc, key, keylen, md->email, 0);
 #endif
-      }
-      else
-        email_free(&md->email);
     }
+    else
+      email_free(&md->email);
+
+    mutt_file_fclose(&fp);
   }
+
+  ARRAY_FREE(&misses);
 #ifdef USE_HCACHE
+  mutt_hcache_commit_txn(hc);
   mutt_hcache_close(hc);
 #endif
 }
@@ -1147,6 +1395,162 @@ static bool maildir_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
   return true;
 }
 
+/**
+ * maildir_merge_email - Merge a rescanned Email into a known one
+ * @param m     Mailbox
+ * @param e     Email already in the Mailbox
+ * @param e_new Email just found on disk, with the same canonical filename
+ * @retval true The flags of e were changed
+ */
+static bool maildir_merge_email(struct Mailbox *m, struct Email *e, struct Email *e_new)
+{
+  bool flags_changed = false;
+
+  /* check to see if the message has moved to a different
+   * subdirectory.  If so, update the associated filename.  */
+  if (!mutt_str_equal(e->path, e_new->path))
+    mutt_str_replace(&e->path, e_new->path);
+
+  /* if the user hasn't modified the flags on this message, update
+   * the flags we just detected.  */
+  if (!e->changed)
+    if (maildir_update_flags(m, e, e_new))
+      flags_changed = true;
+
+  if (e->deleted == e->trash)
+  {
+    if (e->deleted != e_new->deleted)
+    {
+      e->deleted = e_new->deleted;
+      flags_changed = true;
+    }
+  }
+  e->trash = e_new->trash;
+
+  return flags_changed;
+}
+
+#ifdef USE_INOTIFY
+/**
+ * maildir_check_events - Apply the recorded file changes to a Mailbox
+ * @param m      Mailbox
+ * @param events File changes in 'new' and 'cur', see mutt_monitor_take_events()
+ * @retval enum #MxStatus
+ *
+ * This is the incremental version of maildir_mbox_check().  Only the files
+ * named in events are considered, so neither directory is read.
+ */
+static enum MxStatus maildir_check_events(struct Mailbox *m, struct MonitorEventArray *events)
+{
+  bool occult = false;
+  bool flags_changed = false;
+  int num_new = 0;
+
+  if (ARRAY_EMPTY(events))
+    return MX_STATUS_OK;
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+
+  /* A file may be renamed several times; only its latest name counts */
+  struct HashTable *latest = mutt_hash_new(ARRAY_SIZE(events), MUTT_HASH_STRDUP_KEYS);
+  struct MonitorEvent *ev = NULL;
+  ARRAY_FOREACH(ev, events)
+  {
+    maildir_canon_filename(buf, ev->name);
+    mutt_hash_delete(latest, mutt_buffer_string(buf), NULL);
+    mutt_hash_insert(latest, mutt_buffer_string(buf), ev);
+  }
+
+  const bool c_mark_old = cs_subset_bool(NeoMutt->sub, "mark_old");
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (!e)
+      break;
+
+    maildir_canon_filename(buf, e->path);
+    ev = mutt_hash_find(latest, mutt_buffer_string(buf));
+    if (!ev)
+      continue;
+
+    if (ev->added)
+    {
+      struct MdEmail *md = maildir_entry_from_name(ev->dir, ev->name,
+                                                   c_mark_old && mutt_str_equal(ev->dir, "cur"));
+      if (maildir_merge_email(m, e, md->email))
+        flags_changed = true;
+      maildir_entry_free(&md);
+      e->active = true;
+    }
+    else
+    {
+      /* The events may not name the file we know about, e.g. if it was
+       * renamed by us, so make sure that it has really gone. */
+      mutt_buffer_printf(buf, "%s/%s", ev->dir, ev->name);
+      bool gone = mutt_str_equal(mutt_buffer_string(buf), e->path);
+      if (!gone)
+      {
+        mutt_buffer_printf(buf, "%s/%s", mailbox_path(m), e->path);
+        gone = (access(mutt_buffer_string(buf), F_OK) != 0);
+      }
+
+      if (gone)
+      {
+        occult = true;
+        e->active = false;
+        e->deleted = true;
+        e->purge = true;
+      }
+    }
+
+    maildir_canon_filename(buf, e->path);
+    mutt_hash_delete(latest, mutt_buffer_string(buf), NULL);
+  }
+
+  /* Anything left is a new message */
+  struct MdEmailArray mda = ARRAY_HEAD_INITIALIZER;
+  ARRAY_FOREACH(ev, events)
+  {
+    if (!ev->added)
+      continue;
+
+    maildir_canon_filename(buf, ev->name);
+    if (mutt_hash_find(latest, mutt_buffer_string(buf)) != ev)
+      continue;
+
+    struct MdEmail *md = maildir_entry_from_name(ev->dir, ev->name,
+                                                 c_mark_old && mutt_str_equal(ev->dir, "cur"));
+    md->canon_fname = mutt_buffer_strdup(buf);
+    ARRAY_ADD(&mda, md);
+  }
+
+  mutt_hash_free(&latest);
+  mutt_buffer_pool_release(&buf);
+
+  if (occult)
+    mailbox_changed(m, NT_MAILBOX_RESORT);
+
+  maildir_delayed_parsing(m, &mda, NULL);
+
+  num_new = maildir_move_to_mailbox(m, &mda);
+  if (num_new > 0)
+  {
+    mailbox_changed(m, NT_MAILBOX_INVALID);
+    m->changed = true;
+  }
+  ARRAY_FREE(&mda);
+
+  if (occult)
+    return MX_STATUS_REOPENED;
+  if (num_new > 0)
+    return MX_STATUS_NEW_MAIL;
+  if (flags_changed)
+    return MX_STATUS_FLAGS;
+  return MX_STATUS_OK;
+}
+#endif
+
 /**
  * maildir_mbox_check - Check for new mail - Implements MxOps::mbox_check()
  *
@@ -1156,6 +1560,9 @@ static bool maildir_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
  * We check for newly added messages, and then merge the flags messages we
  * already knew about.  We don't treat either subdirectory differently, as mail
  * could be copied directly into the cur directory from another agent.
+ *
+ * If the monitor has recorded every file change in the Mailbox, only those
+ * files are considered, see maildir_check_events().
  */
 enum MxStatus maildir_mbox_check(struct Mailbox *m)
 {
@@ -1174,6 +1581,19 @@ enum MxStatus maildir_mbox_check(struct Mailbox *m)
   if (!c_check_new)
     return MX_STATUS_OK;
 
+#ifdef USE_INOTIFY
+  /* The directory mtimes are left alone, so a later full scan still notices
+   * everything that's changed */
+  struct MonitorEventArray events = ARRAY_HEAD_INITIALIZER;
+  if (mutt_monitor_take_events(m, &events))
+  {
+    MonitorContextChanged = false;
+    enum MxStatus rc = maildir_check_events(m, &events);
+    mutt_monitor_events_free(&events);
+    return rc;
+  }
+#endif
+
   struct Buffer *buf = mutt_buffer_pool_get();
   mutt_buffer_printf(buf, "%s/new", mailbox_path(m));
   if (stat(mutt_buffer_string(buf), &st_new) == -1)
@@ -1254,27 +1674,8 @@ enum MxStatus maildir_mbox_check(struct Mailbox *m)
     {
       /* message already exists, merge flags */
       e->active = true;
-
-      /* check to see if the message has moved to a different
-       * subdirectory.  If so, update the associated filename.  */
-      if (!mutt_str_equal(e->path, md->email->path))
-        mutt_str_replace(&e->path, md->email->path);
-
-      /* if the user hasn't modified the flags on this message, update
-       * the flags we just detected.  */
-      if (!e->changed)
-        if (maildir_update_flags(m, e, md->email))
-          flags_changed = true;
-
-      if (e->deleted == e->trash)
-      {
-        if (e->deleted != md->email->deleted)
-        {
-          e->deleted = md->email->deleted;
-          flags_changed = true;
-        }
-      }
-      e->trash = md->email->trash;
+      if (maildir_merge_email(m, e, md->email))
+        flags_changed = true;
 
       /* this is a duplicate of an existing email, so remove it */
       email_free(&md->email);
@@ -1332,14 +1733,32 @@ enum MxStatus maildir_mbox_check(struct Mailbox *m)
 }
 
 /**
- * maildir_mbox_check_stats - Check the Mailbox statistics - Implements MxOps::mbox_check_stats()
+ * maildir_stats_init - Prepare to check a Maildir
+ * @param ms    Maildir to check
+ * @param m     Mailbox
+ * @param flags Flags, see MxOps::mbox_check_stats()
  */
-static enum MxStatus maildir_mbox_check_stats(struct Mailbox *m, uint8_t flags)
+static void maildir_stats_init(struct MaildirStats *ms, struct Mailbox *m, uint8_t flags)
 {
-  bool check_stats = flags;
-  bool check_new = true;
+  memset(ms, 0, sizeof(*ms));
+  ms->mailbox = m;
+  mutt_str_copy(ms->path, mailbox_path(m), sizeof(ms->path));
+  ms->last_visited = m->last_visited;
+  ms->check_stats = flags;
+  ms->check_cur = cs_subset_bool(NeoMutt->sub, "maildir_check_cur");
+  ms->check_recent = cs_subset_bool(NeoMutt->sub, "mail_check_recent");
+  ms->has_new = m->has_new;
+  ms->now = mutt_date_epoch();
+
+  ms->mdata = maildir_mdata_get(m);
+  if (!ms->mdata)
+  {
+    ms->mdata = maildir_mdata_new();
+    m->mdata = ms->mdata;
+    m->mdata_free = maildir_mdata_free;
+  }
 
-  if (check_stats)
+  if (ms->check_stats)
   {
     m->msg_count = 0;
     m->msg_unread = 0;
@@ -1347,17 +1766,82 @@ static enum MxStatus maildir_mbox_check_stats(struct Mailbox *m, uint8_t flags)
     m->msg_new = 0;
   }
 
-  maildir_check_dir(m, "new", check_new, check_stats);
+  ms->msg_count = m->msg_count;
+  ms->msg_unread = m->msg_unread;
+  ms->msg_flagged = m->msg_flagged;
+  ms->msg_new = m->msg_new;
+}
+
+/**
+ * maildir_stats_run - Count the messages in a Maildir - Implements ::worker_task_t
+ */
+static void maildir_stats_run(void *item)
+{
+  struct MaildirStats *ms = item;
+
+  maildir_check_dir(ms, "new", true, ms->check_stats);
 
-  const bool c_maildir_check_cur =
-      cs_subset_bool(NeoMutt->sub, "maildir_check_cur");
-  check_new = !m->has_new && c_maildir_check_cur;
-  if (check_new || check_stats)
-    maildir_check_dir(m, "cur", check_new, check_stats);
+  const bool check_new = !ms->has_new && ms->check_cur;
+  if (check_new || ms->check_stats)
+    maildir_check_dir(ms, "cur", check_new, ms->check_stats);
+}
+
+/**
+ * maildir_stats_finish - Save the results of checking a Maildir
+ * @param ms Maildir that was checked
+ * @retval enum #MxStatus
+ */
+static enum MxStatus maildir_stats_finish(struct MaildirStats *ms)
+{
+  struct Mailbox *m = ms->mailbox;
+  if (ms->unknown)
+    m->type = MUTT_UNKNOWN;
+  m->has_new = ms->has_new;
+  m->msg_count = ms->msg_count;
+  m->msg_unread = ms->msg_unread;
+  m->msg_flagged = ms->msg_flagged;
+  m->msg_new = ms->msg_new;
 
   return m->msg_new ? MX_STATUS_NEW_MAIL : MX_STATUS_OK;
 }
 
+/**
+ * maildir_mbox_check_stats - Check the Mailbox statistics - Implements MxOps::mbox_check_stats()
+ */
+static enum MxStatus maildir_mbox_check_stats(struct Mailbox *m, uint8_t flags)
+{
+  struct MaildirStats ms;
+  maildir_stats_init(&ms, m, flags);
+  maildir_stats_run(&ms);
+  return maildir_stats_finish(&ms);
+}
+
+/**
+ * maildir_check_stats_all - Check the statistics of many Maildirs
+ * @param checks Maildirs to check
+ * @param num    Number of Maildirs
+ *
+ * This is the same as calling MxOps::mbox_check_stats() for each Mailbox, but
+ * the directories are scanned on all the CPUs.  The results are saved in the
+ * Mailboxes by the caller's thread.
+ */
+void maildir_check_stats_all(struct MaildirCheck *checks, size_t num)
+{
+  if (!checks || (num == 0))
+    return;
+
+  struct MaildirStats *stats = mutt_mem_calloc(num, sizeof(struct MaildirStats));
+  for (size_t i = 0; i < num; i++)
+    maildir_stats_init(&stats[i], checks[i].mailbox, checks[i].flags);
+
+  mutt_worker_run(maildir_stats_run, stats, sizeof(struct MaildirStats), num);
+
+  for (size_t i = 0; i < num; i++)
+    checks[i].rc = maildir_stats_finish(&stats[i]);
+
+  FREE(&stats);
+}
+
 /**
  * maildir_mbox_sync - Save changes to the Mailbox - Implements MxOps::mbox_sync()
  * @retval enum #MxStatus
@@ -1375,7 +1859,10 @@ enum MxStatus maildir_mbox_sync(struct Mailbox *m)
   const char *const c_header_cache =
       cs_subset_path(NeoMutt->sub, "header_cache");
   if (m->type == MUTT_MAILDIR)
+  {
     hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+    mutt_hcache_begin_txn(hc);
+  }
 #endif
 
   struct Progress progress;
@@ -1395,9 +1882,16 @@ enum MxStatus maildir_mbox_sync(struct Mailbox *m)
       goto err;
   }
 
+  /* Make all the renames and deletions durable at once */
+  mh_sync_dir(m, "cur");
+  mh_sync_dir(m, "new");
+
 #ifdef USE_HCACHE
   if (m->type == MUTT_MAILDIR)
+  {
+    mutt_hcache_commit_txn(hc);
     mutt_hcache_close(hc);
+  }
 #endif
 
   /* XXX race condition? */
@@ -1467,6 +1961,28 @@ static bool maildir_msg_open(struct Mailbox *m, struct Message *msg, int msgno)
   return true;
 }
 
+/**
+ * maildir_new_flags - Get the flags and directory for a new message
+ * @param[in]  e         Email being copied, may be NULL
+ * @param[out] suffix    Buffer for the flags
+ * @param[in]  suffixlen Length of the buffer
+ * @retval ptr Subdirectory for the message, "cur" or "new"
+ */
+static const char *maildir_new_flags(const struct Email *e, char *suffix, size_t suffixlen)
+{
+  if (e)
+  {
+    struct Email tmp = *e;
+    tmp.deleted = false;
+    tmp.edata = NULL;
+    maildir_gen_flags(suffix, suffixlen, &tmp);
+  }
+  else
+    *suffix = '\0';
+
+  return (e && (e->read || e->old)) ? "cur" : "new";
+}
+
 /**
  * maildir_msg_open_new - Open a new message in a Mailbox - Implements MxOps::msg_open_new()
  *
@@ -1480,22 +1996,7 @@ bool maildir_msg_open_new(struct Mailbox *m, struct Message *msg, const struct E
   int fd;
   char path[PATH_MAX];
   char suffix[16];
-  char subdir[16];
-
-  if (e)
-  {
-    struct Email tmp = *e;
-    tmp.deleted = false;
-    tmp.edata = NULL;
-    maildir_gen_flags(suffix, sizeof(suffix), &tmp);
-  }
-  else
-    *suffix = '\0';
-
-  if (e && (e->read || e->old))
-    mutt_str_copy(subdir, "cur", sizeof(subdir));
-  else
-    mutt_str_copy(subdir, "new", sizeof(subdir));
+  const char *subdir = maildir_new_flags(e, suffix, sizeof(suffix));
 
   mode_t omask = umask(mh_umask(m));
   while (true)
@@ -1537,6 +2038,60 @@ bool maildir_msg_open_new(struct Mailbox *m, struct Message *msg, const struct E
   return true;
 }
 
+/**
+ * maildir_msg_link - Copy a message to another Maildir with a hard link
+ * @param m_dst Destination Mailbox
+ * @param m_src Source Mailbox
+ * @param e     Email to copy
+ * @retval true  The message was linked
+ * @retval false The message must be copied, e.g. it's on a different filesystem
+ *
+ * The message keeps its contents, but gets a new name with the Email's flags.
+ * The caller must check that the message doesn't need rewriting.
+ */
+bool maildir_msg_link(struct Mailbox *m_dst, struct Mailbox *m_src, const struct Email *e)
+{
+  if (!m_dst || !m_src || !e || !e->path || (m_dst->type != MUTT_MAILDIR) ||
+      (m_src->type != MUTT_MAILDIR))
+  {
+    return false;
+  }
+
+  char suffix[16];
+  const char *subdir = maildir_new_flags(e, suffix, sizeof(suffix));
+
+  struct Buffer *src = mutt_buffer_pool_get();
+  struct Buffer *dst = mutt_buffer_pool_get();
+  mutt_buffer_printf(src, "%s/%s", mailbox_path(m_src), e->path);
+
+  bool rc = false;
+  while (true)
+  {
+    mutt_buffer_printf(dst, "%s/%s/%lld.R%" PRIu64 ".%s%s", mailbox_path(m_dst),
+                       subdir, (long long) mutt_date_epoch(), mutt_rand64(),
+                       NONULL(ShortHostname), suffix);
+
+    if (link(mutt_buffer_string(src), mutt_buffer_string(dst)) == 0)
+    {
+      mutt_debug(LL_DEBUG2, "linked %s to %s\n", mutt_buffer_string(src),
+                 mutt_buffer_string(dst));
+      rc = true;
+      break;
+    }
+    if (errno != EEXIST)
+    {
+      /* e.g. EXDEV, a different filesystem */
+      mutt_debug(LL_DEBUG2, "can't link %s: %s\n", mutt_buffer_string(src),
+                 strerror(errno));
+      break;
+    }
+  }
+
+  mutt_buffer_pool_release(&src);
+  mutt_buffer_pool_release(&dst);
+  return rc;
+}
+
 /**
  * maildir_msg_commit - Save changes to an email - Implements MxOps::msg_commit()
  */
@@ -1648,9 +2203,11 @@ struct MxOps MxMaildirOps = {
   .mbox_sync        = maildir_mbox_sync,
   .mbox_close       = maildir_mbox_close,
   .msg_open         = maildir_msg_open,
+  .msg_prefetch     = maildir_msg_prefetch,
   .msg_open_new     = maildir_msg_open_new,
   .msg_commit       = maildir_msg_commit,
   .msg_close        = maildir_msg_close,
+  .msg_append_batch = maildir_append_batch,
   .msg_padding_size = NULL,
   .msg_save_hcache  = maildir_msg_save_hcache,
   .tags_edit        = NULL,
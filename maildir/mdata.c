@@ -39,7 +39,10 @@ void maildir_mdata_free(void **ptr)
   if (!ptr || !*ptr)
     return;
 
-  // struct MaildirMboxData *mdata = *ptr;
+  struct MaildirMboxData *mdata = *ptr;
+  mutt_list_free(&mdata->append_paths);
+  mh_seq_free(&mdata->seq_cache.mhs);
+  FREE(&mdata->seq_cache.tags);
   FREE(ptr);
 }
 
@@ -50,6 +53,7 @@ void maildir_mdata_free(void **ptr)
 struct MaildirMboxData *maildir_mdata_new(void)
 {
   struct MaildirMboxData *mdata = mutt_mem_calloc(1, sizeof(struct MaildirMboxData));
+  STAILQ_INIT(&mdata->append_paths);
   return mdata;
 }
 
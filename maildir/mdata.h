@@ -23,11 +23,54 @@
 #ifndef MUTT_MAILDIR_MDATA_H
 #define MUTT_MAILDIR_MDATA_H
 
+#include <stdbool.h>
 #include <sys/types.h>
 #include <time.h>
+#include "mutt/lib.h"
+#include "sequence.h"
 
 struct Mailbox;
 
+/**
+ * struct MaildirDirStats - Cached results of checking a Maildir directory
+ *
+ * The results are only valid while the directory is unchanged and the
+ * check is done the same way.
+ */
+struct MaildirDirStats
+{
+  bool valid;                   ///< Is the cache in use?
+  dev_t dev;                    ///< Device of the directory
+  ino_t ino;                    ///< Inode of the directory
+  struct timespec mtime;        ///< Mtime of the directory
+  struct timespec last_visited; ///< Mailbox::last_visited used by the check
+  bool check_new;               ///< Check for new mail
+  bool check_stats;             ///< Count the messages
+  bool check_recent;            ///< $mail_check_recent used by the check
+  bool has_new;                 ///< New mail was found
+  int msg_count;                ///< Messages counted
+  int msg_unread;               ///< Unread messages counted
+  int msg_flagged;              ///< Flagged messages counted
+  int msg_new;                  ///< New messages counted
+};
+
+/**
+ * struct MhSeqCache - Cached copy of an MH '.mh_sequences' file
+ *
+ * The sequences are only valid while the file is unchanged and the sequence
+ * names are the same.
+ */
+struct MhSeqCache
+{
+  bool valid;             ///< Is the cache in use?
+  dev_t dev;              ///< Device of the file
+  ino_t ino;              ///< Inode of the file
+  off_t size;             ///< Size of the file
+  struct timespec mtime;  ///< Mtime of the file
+  char *tags;             ///< Sequence names used, e.g. "unseen:flagged:replied"
+  struct MhSequences mhs; ///< Parsed sequences
+};
+
 /**
  * struct MaildirMboxData - Maildir-specific Mailbox data - @extends Mailbox
  */
@@ -35,6 +78,13 @@ struct MaildirMboxData
 {
   struct timespec mtime_cur;
   mode_t mh_umask;
+  struct MaildirDirStats stats_new; ///< Cached check of the 'new' directory
+  struct MaildirDirStats stats_cur; ///< Cached check of the 'cur' directory
+
+  bool append_batch;               ///< Appending several messages, see maildir_append_batch()
+  struct ListHead append_paths;    ///< Messages appended, but not yet flushed to disk
+  unsigned int append_hi;          ///< MH: Number of the last message appended
+  struct MhSeqCache seq_cache;     ///< MH: Cached '.mh_sequences'
 };
 
 void                    maildir_mdata_free(void **ptr);
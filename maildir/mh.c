@@ -184,7 +184,6 @@ int mh_check_empty(const char *path)
  */
 static enum MxStatus mh_mbox_check_stats(struct Mailbox *m, uint8_t flags)
 {
-  struct MhSequences mhs = { 0 };
   DIR *dirp = NULL;
   struct dirent *de = NULL;
 
@@ -197,7 +196,8 @@ static enum MxStatus mh_mbox_check_stats(struct Mailbox *m, uint8_t flags)
     return MX_STATUS_OK;
   }
 
-  if (mh_seq_read(&mhs, mailbox_path(m)) < 0)
+  const struct MhSequences *mhs = mh_seq_load(m);
+  if (!mhs)
     return MX_STATUS_ERROR;
 
   m->msg_count = 0;
@@ -206,11 +206,11 @@ static enum MxStatus mh_mbox_check_stats(struct Mailbox *m, uint8_t flags)
 
   enum MxStatus rc = MX_STATUS_OK;
   bool check_new = true;
-  for (int i = mhs.max; i > 0; i--)
+  for (int i = mhs->max; i > 0; i--)
   {
-    if ((mh_seq_check(&mhs, i) & MH_SEQ_FLAGGED))
+    if ((mh_seq_check(mhs, i) & MH_SEQ_FLAGGED))
       m->msg_flagged++;
-    if (mh_seq_check(&mhs, i) & MH_SEQ_UNSEEN)
+    if (mh_seq_check(mhs, i) & MH_SEQ_UNSEEN)
     {
       m->msg_unread++;
       if (check_new)
@@ -230,8 +230,6 @@ static enum MxStatus mh_mbox_check_stats(struct Mailbox *m, uint8_t flags)
     }
   }
 
-  mh_seq_free(&mhs);
-
   dirp = opendir(mailbox_path(m));
   if (dirp)
   {
@@ -253,7 +251,7 @@ static enum MxStatus mh_mbox_check_stats(struct Mailbox *m, uint8_t flags)
  * @param mda Maildir array to update
  * @param mhs Sequences
  */
-void mh_update_maildir(struct MdEmailArray *mda, struct MhSequences *mhs)
+void mh_update_maildir(struct MdEmailArray *mda, const struct MhSequences *mhs)
 {
   struct MdEmail *md = NULL;
   struct MdEmail **mdp = NULL;
@@ -294,21 +292,27 @@ int mh_commit_msg(struct Mailbox *m, struct Message *msg, struct Email *e, bool
   char path[PATH_MAX];
   char tmp[16];
 
-  if (mutt_file_fsync_close(&msg->fp))
+  /* Only new messages (e == NULL) can be part of a batch */
+  if (e ? mutt_file_fsync_close(&msg->fp) : maildir_append_close(m, &msg->fp))
   {
     mutt_perror(_("Could not flush message to disk"));
     return -1;
   }
 
-  DIR *dirp = opendir(mailbox_path(m));
-  if (!dirp)
+  /* In a batch, carry on from the last message appended */
+  struct MaildirMboxData *mdata = e ? NULL : maildir_mdata_get(m);
+  if (mdata && mdata->append_batch)
+    hi = mdata->append_hi;
+
+  DIR *dirp = (hi == 0) ? opendir(mailbox_path(m)) : NULL;
+  if (!dirp && (hi == 0))
   {
     mutt_perror(mailbox_path(m));
     return -1;
   }
 
   /* figure out what the next message number is */
-  while ((de = readdir(dirp)))
+  while (dirp && (de = readdir(dirp)))
   {
     dep = de->d_name;
     if (*dep == ',')
@@ -328,7 +332,8 @@ int mh_commit_msg(struct Mailbox *m, struct Message *msg, struct Email *e, bool
         hi = n;
     }
   }
-  closedir(dirp);
+  if (dirp)
+    closedir(dirp);
 
   /* Now try to rename the file to the proper name.
    * Note: We may have to try multiple times, until we find a free slot.  */
@@ -343,6 +348,10 @@ int mh_commit_msg(struct Mailbox *m, struct Message *msg, struct Email *e, bool
       if (e)
         mutt_str_replace(&e->path, tmp);
       mutt_str_replace(&msg->committed_path, path);
+      if (!e)
+        maildir_append_add(m, path);
+      if (mdata && mdata->append_batch)
+        mdata->append_hi = hi;
       FREE(&msg->path);
       break;
     }
@@ -609,6 +618,7 @@ void mh_delayed_parsing(struct Mailbox *m, struct MdEmailArray *mda, struct Prog
   const char *const c_header_cache =
       cs_subset_path(NeoMutt->sub, "header_cache");
   struct HeaderCache *hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  mutt_hcache_begin_txn(hc);
 #endif
 
   struct MdEmail *md = NULL;
@@ -664,6 +674,7 @@ void mh_delayed_parsing(struct Mailbox *m, struct MdEmailArray *mda, struct Prog
     }
   }
 #ifdef USE_HCACHE
+  mutt_hcache_commit_txn(hc);
   mutt_hcache_close(hc);
 #endif
 
@@ -686,7 +697,6 @@ static bool mh_read_dir(struct Mailbox *m)
   if (!m)
     return false;
 
-  struct MhSequences mhs = { 0 };
   struct Progress progress;
 
   if (m->verbose)
@@ -718,13 +728,13 @@ static bool mh_read_dir(struct Mailbox *m)
   }
   mh_delayed_parsing(m, &mda, &progress);
 
-  if (mh_seq_read(&mhs, mailbox_path(m)) < 0)
+  const struct MhSequences *mhs = mh_seq_load(m);
+  if (!mhs)
   {
     maildirarray_clear(&mda);
     return false;
   }
-  mh_update_maildir(&mda, &mhs);
-  mh_seq_free(&mhs);
+  mh_update_maildir(&mda, mhs);
 
   maildir_move_to_mailbox(m, &mda);
 
@@ -866,6 +876,51 @@ static bool mh_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
   return true;
 }
 
+/**
+ * mh_check_sequences - Update the flags of the Emails from the sequences
+ * @param m   Mailbox
+ * @param mhs Sequences
+ * @retval enum #MxStatus
+ *
+ * If only the '.mh_sequences' file has changed, the messages are the same, so
+ * the directory doesn't need to be scanned again.
+ */
+static enum MxStatus mh_check_sequences(struct Mailbox *m, const struct MhSequences *mhs)
+{
+  bool flags_changed = false;
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (!e)
+      break;
+
+    if (e->changed)
+      continue;
+
+    const char *p = strrchr(e->path, '/');
+    if (p)
+      p++;
+    else
+      p = e->path;
+
+    int num = 0;
+    if (mutt_str_atoi(p, &num) < 0)
+      continue;
+    MhSeqFlags flags = mh_seq_check(mhs, num);
+
+    struct Email e_new = { 0 };
+    e_new.read = !(flags & MH_SEQ_UNSEEN);
+    e_new.flagged = (flags & MH_SEQ_FLAGGED);
+    e_new.replied = (flags & MH_SEQ_REPLIED);
+    e_new.old = e->old;
+    if (maildir_update_flags(m, e, &e_new))
+      flags_changed = true;
+  }
+
+  return flags_changed ? MX_STATUS_FLAGS : MX_STATUS_OK;
+}
+
 /**
  * mh_mbox_check - Check for new mail - Implements MxOps::mbox_check()
  *
@@ -881,8 +936,8 @@ enum MxStatus mh_mbox_check(struct Mailbox *m)
   char buf[PATH_MAX];
   struct stat st, st_cur;
   bool modified = false, occult = false, flags_changed = false;
+  bool dir_modified = false;
   int num_new = 0;
-  struct MhSequences mhs = { 0 };
   struct HashTable *fnames = NULL;
   struct MaildirMboxData *mdata = maildir_mdata_get(m);
 
@@ -912,14 +967,22 @@ enum MxStatus mh_mbox_check(struct Mailbox *m)
   }
 
   if ((rc == -1) && (stat(buf, &st_cur) == -1))
-    modified = true;
+    dir_modified = true;
 
-  if ((mutt_file_stat_timespec_compare(&st, MUTT_STAT_MTIME, &m->mtime) > 0) ||
+  if (mutt_file_stat_timespec_compare(&st, MUTT_STAT_MTIME, &m->mtime) > 0)
+    dir_modified = true;
+
+  if (dir_modified ||
       (mutt_file_stat_timespec_compare(&st_cur, MUTT_STAT_MTIME, &mdata->mtime_cur) > 0))
   {
     modified = true;
   }
 
+  /* A directory modified within the last second might have changed again,
+   * without changing its mtime */
+  if (st.st_mtime >= (mutt_date_epoch() - 1))
+    dir_modified = true;
+
   if (!modified)
     return MX_STATUS_OK;
 
@@ -939,15 +1002,27 @@ enum MxStatus mh_mbox_check(struct Mailbox *m)
     mutt_file_get_stat_timespec(&m->mtime, &st, MUTT_STAT_MTIME);
   }
 
+  /* Only the sequences have changed, so the messages are the same */
+  if (!dir_modified)
+  {
+    const struct MhSequences *mhs = mh_seq_load(m);
+    if (!mhs)
+      return MX_STATUS_ERROR;
+    return mh_check_sequences(m, mhs);
+  }
+
   struct MdEmailArray mda = ARRAY_HEAD_INITIALIZER;
 
   mh_parse_dir(m, &mda, NULL);
   mh_delayed_parsing(m, &mda, NULL);
 
-  if (mh_seq_read(&mhs, mailbox_path(m)) < 0)
+  const struct MhSequences *mhs = mh_seq_load(m);
+  if (!mhs)
+  {
+    maildirarray_clear(&mda);
     return MX_STATUS_ERROR;
-  mh_update_maildir(&mda, &mhs);
-  mh_seq_free(&mhs);
+  }
+  mh_update_maildir(&mda, mhs);
 
   /* check for modifications and adjust flags */
   fnames = mutt_hash_new(ARRAY_SIZE(&mda), MUTT_HASH_NO_FLAGS);
@@ -1031,7 +1106,10 @@ enum MxStatus mh_mbox_sync(struct Mailbox *m)
   const char *const c_header_cache =
       cs_subset_path(NeoMutt->sub, "header_cache");
   if (m->type == MUTT_MH)
+  {
     hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+    mutt_hcache_begin_txn(hc);
+  }
 #endif
 
   struct Progress progress;
@@ -1051,9 +1129,15 @@ enum MxStatus mh_mbox_sync(struct Mailbox *m)
       goto err;
   }
 
+  /* Make all the renames and deletions durable at once */
+  mh_sync_dir(m, NULL);
+
 #ifdef USE_HCACHE
   if (m->type == MUTT_MH)
+  {
+    mutt_hcache_commit_txn(hc);
     mutt_hcache_close(hc);
+  }
 #endif
 
   mh_seq_update(m);
@@ -1248,9 +1332,11 @@ struct MxOps MxMhOps = {
   .mbox_sync        = mh_mbox_sync,
   .mbox_close       = mh_mbox_close,
   .msg_open         = mh_msg_open,
+  .msg_prefetch     = maildir_msg_prefetch,
   .msg_open_new     = mh_msg_open_new,
   .msg_commit       = mh_msg_commit,
   .msg_close        = mh_msg_close,
+  .msg_append_batch = maildir_append_batch,
   .msg_padding_size = NULL,
   .msg_save_hcache  = mh_msg_save_hcache,
   .tags_edit        = NULL,
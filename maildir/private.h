@@ -27,11 +27,19 @@
 #include <stdbool.h>
 #include <sys/types.h>
 
+struct Email;
 struct MdEmailArray;
 struct Mailbox;
 
+#define MAILDIR_READAHEAD_BYTES (64 * 1024) ///< How much of each message to read ahead
+
+void   maildir_append_add     (struct Mailbox *m, const char *path);
+int    maildir_append_batch   (struct Mailbox *m, bool start);
+int    maildir_append_close   (struct Mailbox *m, FILE **fp);
 int    maildir_move_to_mailbox(struct Mailbox *m, struct MdEmailArray *mda);
+void   maildir_msg_prefetch   (struct Mailbox *m, struct Email *e);
 bool   mh_mkstemp             (struct Mailbox *m, FILE **fp, char **tgt);
+void   mh_sync_dir            (struct Mailbox *m, const char *subdir);
 mode_t mh_umask               (struct Mailbox *m);
 
 #endif /* MUTT_MAILDIR_PRIVATE_H */
@@ -38,6 +38,7 @@
 #include "email/lib.h"
 #include "core/lib.h"
 #include "sequence.h"
+#include "mdata.h"
 
 /**
  * mh_seq_alloc - Allocate more memory for sequences
@@ -75,7 +76,7 @@ void mh_seq_free(struct MhSequences *mhs)
  * @param i   Index number required
  * @retval num Flags, see #MhSeqFlags
  */
-MhSeqFlags mh_seq_check(struct MhSequences *mhs, int i)
+MhSeqFlags mh_seq_check(const struct MhSequences *mhs, int i)
 {
   if (!mhs->flags || (i > mhs->max))
     return 0;
@@ -179,15 +180,16 @@ void mh_seq_add_one(struct Mailbox *m, int n, bool unseen, bool flagged, bool re
 }
 
 /**
- * mh_seq_write_one - Write a flag sequence to a file
- * @param fp  File to write to
+ * mh_seq_write_one - Write a flag sequence to a Buffer
+ * @param buf Buffer for the result
  * @param mhs Sequence list
  * @param f   Flag, see #MhSeqFlags
  * @param tag string tag, e.g. "unseen"
  */
-static void mh_seq_write_one(FILE *fp, struct MhSequences *mhs, MhSeqFlags f, const char *tag)
+static void mh_seq_write_one(struct Buffer *buf, struct MhSequences *mhs,
+                             MhSeqFlags f, const char *tag)
 {
-  fprintf(fp, "%s:", tag);
+  mutt_buffer_add_printf(buf, "%s:", tag);
 
   int first = -1;
   int last = -1;
@@ -204,9 +206,9 @@ static void mh_seq_write_one(FILE *fp, struct MhSequences *mhs, MhSeqFlags f, co
     else if (first >= 0)
     {
       if (last < 0)
-        fprintf(fp, " %d", first);
+        mutt_buffer_add_printf(buf, " %d", first);
       else
-        fprintf(fp, " %d-%d", first, last);
+        mutt_buffer_add_printf(buf, " %d-%d", first, last);
 
       first = -1;
       last = -1;
@@ -216,18 +218,57 @@ static void mh_seq_write_one(FILE *fp, struct MhSequences *mhs, MhSeqFlags f, co
   if (first >= 0)
   {
     if (last < 0)
-      fprintf(fp, " %d", first);
+      mutt_buffer_add_printf(buf, " %d", first);
     else
-      fprintf(fp, " %d-%d", first, last);
+      mutt_buffer_add_printf(buf, " %d-%d", first, last);
   }
 
-  fputc('\n', fp);
+  mutt_buffer_addch(buf, '\n');
+}
+
+/**
+ * mh_seq_tags - Get the names of the sequences we use
+ * @param buf    Buffer for the result
+ * @param buflen Length of the buffer
+ */
+static void mh_seq_tags(char *buf, size_t buflen)
+{
+  const char *const c_mh_seq_unseen =
+      cs_subset_string(NeoMutt->sub, "mh_seq_unseen");
+  const char *const c_mh_seq_flagged =
+      cs_subset_string(NeoMutt->sub, "mh_seq_flagged");
+  const char *const c_mh_seq_replied =
+      cs_subset_string(NeoMutt->sub, "mh_seq_replied");
+  snprintf(buf, buflen, "%s:%s:%s", NONULL(c_mh_seq_unseen),
+           NONULL(c_mh_seq_flagged), NONULL(c_mh_seq_replied));
+}
+
+/**
+ * mh_seq_cache_stamp - Record which file the cached sequences came from
+ * @param cache Sequence cache
+ * @param st    Details of the '.mh_sequences' file
+ * @param tags  Sequence names, see mh_seq_tags()
+ *
+ * A file modified within the last second isn't cached, because a second change
+ * might not alter its mtime.
+ */
+static void mh_seq_cache_stamp(struct MhSeqCache *cache, struct stat *st, const char *tags)
+{
+  cache->dev = st->st_dev;
+  cache->ino = st->st_ino;
+  cache->size = st->st_size;
+  mutt_file_get_stat_timespec(&cache->mtime, st, MUTT_STAT_MTIME);
+  mutt_str_replace(&cache->tags, tags);
+  cache->valid = (cache->mtime.tv_sec < (mutt_date_epoch() - 1));
 }
 
 /**
  * mh_seq_update - Update sequence numbers
  * @param m Mailbox
  *
+ * Only our sequences are replaced, the other lines are kept as they are.  If
+ * none of them have changed, the file isn't rewritten.
+ *
  * XXX we don't currently remove deleted messages from sequences we don't know.
  * Should we?
  */
@@ -260,33 +301,7 @@ void mh_seq_update(struct Mailbox *m)
   snprintf(seq_replied, sizeof(seq_replied), "%s:", NONULL(c_mh_seq_replied));
   snprintf(seq_flagged, sizeof(seq_flagged), "%s:", NONULL(c_mh_seq_flagged));
 
-  FILE *fp_new = NULL;
-  if (!mh_mkstemp(m, &fp_new, &tmpfname))
-  {
-    /* error message? */
-    return;
-  }
-
-  snprintf(sequences, sizeof(sequences), "%s/.mh_sequences", mailbox_path(m));
-
-  /* first, copy unknown sequences */
-  FILE *fp_old = fopen(sequences, "r");
-  if (fp_old)
-  {
-    while ((buf = mutt_file_read_line(buf, &s, fp_old, NULL, MUTT_RL_NO_FLAGS)))
-    {
-      if (mutt_str_startswith(buf, seq_unseen) || mutt_str_startswith(buf, seq_flagged) ||
-          mutt_str_startswith(buf, seq_replied))
-      {
-        continue;
-      }
-
-      fprintf(fp_new, "%s\n", buf);
-    }
-  }
-  mutt_file_fclose(&fp_old);
-
-  /* now, update our unseen, flagged, and replied sequences */
+  /* first, work out our unseen, flagged, and replied sequences */
   for (int i = 0; i < m->msg_count; i++)
   {
     struct Email *e = m->emails[i];
@@ -322,27 +337,113 @@ void mh_seq_update(struct Mailbox *m)
     }
   }
 
-  /* write out the new sequences */
+  struct Buffer *line_unseen = mutt_buffer_pool_get();
+  struct Buffer *line_flagged = mutt_buffer_pool_get();
+  struct Buffer *line_replied = mutt_buffer_pool_get();
   if (unseen)
-    mh_seq_write_one(fp_new, &mhs, MH_SEQ_UNSEEN, NONULL(c_mh_seq_unseen));
+    mh_seq_write_one(line_unseen, &mhs, MH_SEQ_UNSEEN, NONULL(c_mh_seq_unseen));
   if (flagged)
-    mh_seq_write_one(fp_new, &mhs, MH_SEQ_FLAGGED, NONULL(c_mh_seq_flagged));
+    mh_seq_write_one(line_flagged, &mhs, MH_SEQ_FLAGGED, NONULL(c_mh_seq_flagged));
   if (replied)
-    mh_seq_write_one(fp_new, &mhs, MH_SEQ_REPLIED, NONULL(c_mh_seq_replied));
+    mh_seq_write_one(line_replied, &mhs, MH_SEQ_REPLIED, NONULL(c_mh_seq_replied));
 
-  mh_seq_free(&mhs);
+  /* then, replace them in the old file, keeping the unknown sequences */
+  struct Buffer *old_seqs = mutt_buffer_pool_get();
+  struct Buffer *new_seqs = mutt_buffer_pool_get();
+  bool unseen_done = false;
+  bool flagged_done = false;
+  bool replied_done = false;
 
-  /* try to commit the changes - no guarantee here */
-  mutt_file_fclose(&fp_new);
+  snprintf(sequences, sizeof(sequences), "%s/.mh_sequences", mailbox_path(m));
+  FILE *fp_old = fopen(sequences, "r");
+  if (fp_old)
+  {
+    while ((buf = mutt_file_read_line(buf, &s, fp_old, NULL, MUTT_RL_NO_FLAGS)))
+    {
+      mutt_buffer_add_printf(old_seqs, "%s\n", buf);
 
-  unlink(sequences);
-  if (mutt_file_safe_rename(tmpfname, sequences) != 0)
+      if (mutt_str_startswith(buf, seq_unseen))
+      {
+        if (!unseen_done)
+          mutt_buffer_addstr(new_seqs, mutt_buffer_string(line_unseen));
+        unseen_done = true;
+      }
+      else if (mutt_str_startswith(buf, seq_flagged))
+      {
+        if (!flagged_done)
+          mutt_buffer_addstr(new_seqs, mutt_buffer_string(line_flagged));
+        flagged_done = true;
+      }
+      else if (mutt_str_startswith(buf, seq_replied))
+      {
+        if (!replied_done)
+          mutt_buffer_addstr(new_seqs, mutt_buffer_string(line_replied));
+        replied_done = true;
+      }
+      else
+      {
+        mutt_buffer_add_printf(new_seqs, "%s\n", buf);
+      }
+    }
+  }
+  FREE(&buf);
+
+  if (!unseen_done)
+    mutt_buffer_addstr(new_seqs, mutt_buffer_string(line_unseen));
+  if (!flagged_done)
+    mutt_buffer_addstr(new_seqs, mutt_buffer_string(line_flagged));
+  if (!replied_done)
+    mutt_buffer_addstr(new_seqs, mutt_buffer_string(line_replied));
+
+  const bool changed = !fp_old || !mutt_str_equal(mutt_buffer_string(old_seqs),
+                                                  mutt_buffer_string(new_seqs));
+  mutt_file_fclose(&fp_old);
+
+  FILE *fp_new = NULL;
+  if (!changed)
   {
-    /* report an error? */
-    unlink(tmpfname);
+    mutt_debug(LL_DEBUG3, "%s is unchanged\n", sequences);
+  }
+  else if (mh_mkstemp(m, &fp_new, &tmpfname))
+  {
+    /* try to commit the changes - no guarantee here */
+    if ((fputs(mutt_buffer_string(new_seqs), fp_new) == EOF) ||
+        (mutt_file_fclose(&fp_new) != 0))
+    {
+      mutt_file_fclose(&fp_new);
+      unlink(tmpfname);
+    }
+    else
+    {
+      unlink(sequences);
+      if (mutt_file_safe_rename(tmpfname, sequences) != 0)
+      {
+        /* report an error? */
+        unlink(tmpfname);
+      }
+    }
+    FREE(&tmpfname);
   }
 
-  FREE(&tmpfname);
+  /* The new sequences are what the next read would find */
+  struct MaildirMboxData *mdata = maildir_mdata_get(m);
+  struct stat st = { 0 };
+  if (mdata && (stat(sequences, &st) == 0))
+  {
+    char tags[1024];
+    mh_seq_tags(tags, sizeof(tags));
+    mh_seq_free(&mdata->seq_cache.mhs);
+    mdata->seq_cache.mhs = mhs;
+    mhs.flags = NULL;
+    mh_seq_cache_stamp(&mdata->seq_cache, &st, tags);
+  }
+
+  mh_seq_free(&mhs);
+  mutt_buffer_pool_release(&line_unseen);
+  mutt_buffer_pool_release(&line_flagged);
+  mutt_buffer_pool_release(&line_replied);
+  mutt_buffer_pool_release(&old_seqs);
+  mutt_buffer_pool_release(&new_seqs);
 }
 
 /**
@@ -435,6 +536,58 @@ out:
   return rc;
 }
 
+/**
+ * mh_seq_load - Get the sequences of a Mailbox
+ * @param m Mailbox
+ * @retval ptr  Sequences, valid until the next call
+ * @retval NULL Error
+ *
+ * The '.mh_sequences' file is only read if it has changed since it was last
+ * read, or the names of the sequences have changed.
+ */
+const struct MhSequences *mh_seq_load(struct Mailbox *m)
+{
+  if (!m)
+    return NULL;
+
+  struct MaildirMboxData *mdata = maildir_mdata_get(m);
+  if (!mdata)
+  {
+    mdata = maildir_mdata_new();
+    m->mdata = mdata;
+    m->mdata_free = maildir_mdata_free;
+  }
+  struct MhSeqCache *cache = &mdata->seq_cache;
+
+  char tags[1024];
+  mh_seq_tags(tags, sizeof(tags));
+
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s/.mh_sequences", mailbox_path(m));
+
+  struct stat st = { 0 };
+  const bool exists = (stat(path, &st) == 0);
+  if (exists && cache->valid && (cache->dev == st.st_dev) &&
+      (cache->ino == st.st_ino) && (cache->size == st.st_size) &&
+      (mutt_file_stat_timespec_compare(&st, MUTT_STAT_MTIME, &cache->mtime) == 0) &&
+      mutt_str_equal(cache->tags, tags))
+  {
+    return &cache->mhs;
+  }
+
+  cache->valid = false;
+  mh_seq_free(&cache->mhs);
+  cache->mhs.max = 0;
+  if (!exists)
+    return &cache->mhs; /* like mh_seq_read(), no file means no sequences */
+
+  if (mh_seq_read(&cache->mhs, mailbox_path(m)) < 0)
+    return NULL;
+
+  mh_seq_cache_stamp(cache, &st, tags);
+  return &cache->mhs;
+}
+
 /**
  * mh_seq_changed - Has the mailbox changed
  * @param m Mailbox
@@ -44,10 +44,11 @@ struct MhSequences
 };
 
 int        mh_seq_read   (struct MhSequences *mhs, const char *path);
+const struct MhSequences *mh_seq_load(struct Mailbox *m);
 void       mh_seq_add_one(struct Mailbox *m, int n, bool unseen, bool flagged, bool replied);
 int        mh_seq_changed(struct Mailbox *m);
 void       mh_seq_update (struct Mailbox *m);
-MhSeqFlags mh_seq_check  (struct MhSequences *mhs, int i);
+MhSeqFlags mh_seq_check  (const struct MhSequences *mhs, int i);
 void       mh_seq_free   (struct MhSequences *mhs);
 
 #endif /* MUTT_MAILDIR_SEQUENCE_H */
@@ -30,9 +30,13 @@
  */
 
 #include "config.h"
+#include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include "private.h"
 #include "mutt/lib.h"
 #include "email/lib.h"
@@ -65,6 +69,142 @@ mode_t mh_umask(struct Mailbox *m)
   return 0777 & ~st.st_mode;
 }
 
+/**
+ * maildir_append_batch - Start or finish appending several messages - Implements MxOps::msg_append_batch()
+ *
+ * During a batch, each message is renamed into place as soon as it's written,
+ * but it isn't flushed to disk.  At the end of the batch, all the messages
+ * are flushed together.
+ */
+int maildir_append_batch(struct Mailbox *m, bool start)
+{
+  struct MaildirMboxData *mdata = maildir_mdata_get(m);
+  if (!mdata)
+  {
+    if (!start)
+      return 0;
+    mdata = maildir_mdata_new();
+    m->mdata = mdata;
+    m->mdata_free = maildir_mdata_free;
+  }
+
+  if (start)
+  {
+    mdata->append_batch = true;
+    mdata->append_hi = 0;
+    return 0;
+  }
+
+  if (!mdata->append_batch)
+    return 0;
+
+  mdata->append_batch = false;
+  if (STAILQ_EMPTY(&mdata->append_paths))
+    return 0;
+
+  int rc = 0;
+#ifdef HAVE_SYNCFS
+  /* One call flushes the whole filesystem */
+  int fd = open(mailbox_path(m), O_RDONLY);
+  if ((fd == -1) || (syncfs(fd) == -1))
+  {
+    mutt_perror(_("Could not flush message to disk"));
+    rc = -1;
+  }
+  if (fd != -1)
+    close(fd);
+#else
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &mdata->append_paths, entries)
+  {
+    int fd = open(np->data, O_RDONLY);
+    if ((fd == -1) || (fsync(fd) == -1))
+    {
+      mutt_perror(np->data);
+      rc = -1;
+    }
+    if (fd != -1)
+      close(fd);
+  }
+#endif
+  mutt_list_free(&mdata->append_paths);
+  return rc;
+}
+
+/**
+ * maildir_append_close - Close a new message
+ * @param m  Mailbox
+ * @param fp File of the new message
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * Outside a batch, the message is flushed to disk.
+ */
+int maildir_append_close(struct Mailbox *m, FILE **fp)
+{
+  struct MaildirMboxData *mdata = maildir_mdata_get(m);
+  if (mdata && mdata->append_batch)
+    return (mutt_file_fclose(fp) == 0) ? 0 : -1;
+
+  return mutt_file_fsync_close(fp);
+}
+
+/**
+ * maildir_append_add - Remember a new message, to flush it at the end of the batch
+ * @param m    Mailbox
+ * @param path Path of the message
+ */
+void maildir_append_add(struct Mailbox *m, const char *path)
+{
+  struct MaildirMboxData *mdata = maildir_mdata_get(m);
+  if (!mdata || !mdata->append_batch)
+    return;
+
+  mutt_list_insert_tail(&mdata->append_paths, mutt_str_dup(path));
+}
+
+/**
+ * maildir_msg_prefetch - Start reading an email in the background - Implements MxOps::msg_prefetch()
+ */
+void maildir_msg_prefetch(struct Mailbox *m, struct Email *e)
+{
+  if (!e->path)
+    return;
+
+  struct Buffer *path = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s/%s", mailbox_path(m), e->path);
+  mutt_file_readahead(mutt_buffer_string(path), MAILDIR_READAHEAD_BYTES);
+  mutt_buffer_pool_release(&path);
+}
+
+/**
+ * mh_sync_dir - Flush a directory's entries to disk
+ * @param m      Mailbox
+ * @param subdir Subdirectory, e.g. "cur", or NULL for the Mailbox's directory
+ *
+ * After renaming or deleting many messages, one fsync() of the directory
+ * makes all the changes durable.
+ */
+void mh_sync_dir(struct Mailbox *m, const char *subdir)
+{
+  struct Buffer *path = mutt_buffer_pool_get();
+  if (subdir)
+    mutt_buffer_printf(path, "%s/%s", mailbox_path(m), subdir);
+  else
+    mutt_buffer_strcpy(path, mailbox_path(m));
+
+  int fd = open(mutt_buffer_string(path), O_RDONLY);
+  if ((fd == -1) || (fsync(fd) == -1))
+  {
+    /* Some filesystems can't sync a directory, which isn't fatal */
+    mutt_debug(LL_DEBUG1, "can't sync %s: %s\n", mutt_buffer_string(path), strerror(errno));
+  }
+  if (fd != -1)
+    close(fd);
+
+  mutt_buffer_pool_release(&path);
+}
+
 /**
  * maildir_move_to_mailbox - Copy the Maildir list to the Mailbox
  * @param[in]  m   Mailbox
@@ -78,6 +218,7 @@ int maildir_move_to_mailbox(struct Mailbox *m, struct MdEmailArray *mda)
     return 0;
 
   int oldmsgcount = m->msg_count;
+  mx_alloc_memory(m, m->msg_count + ARRAY_SIZE(mda));
 
   struct MdEmail *md = NULL;
   struct MdEmail **mdp = NULL;
@@ -92,8 +233,7 @@ int maildir_move_to_mailbox(struct Mailbox *m, struct MdEmailArray *mda)
                md->email->flagged ? "f" : "", md->email->deleted ? "D" : "",
                md->email->replied ? "r" : "", md->email->old ? "O" : "",
                md->email->read ? "R" : "");
-    if (m->msg_count == m->email_max)
-      mx_alloc_memory(m);
+    mx_alloc_memory(m, m->msg_count + 1);
 
     m->emails[m->msg_count] = md->email;
     m->emails[m->msg_count]->index = m->msg_count;
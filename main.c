@@ -60,12 +60,15 @@
 #include "send/lib.h"
 #include "alternates.h"
 #include "attachments.h"
+#include "batch.h"
 #include "browser.h"
 #include "commands.h"
 #include "context.h"
+#include "handler.h"
 #include "hook.h"
 #include "init.h"
 #include "keymap.h"
+#include "mailcap.h"
 #include "mutt_attach.h"
 #include "mutt_globals.h"
 #include "mutt_history.h"
@@ -96,6 +99,9 @@
 #ifdef USE_AUTOCRYPT
 #include "autocrypt/lib.h"
 #endif
+#ifdef USE_NOTMUCH
+#include "notmuch/lib.h"
+#endif
 
 // clang-format off
 typedef uint8_t CliFlags;         ///< Flags for command line options, e.g. #MUTT_CLI_IGNORE
@@ -144,9 +150,31 @@ void mutt_exit(int code)
   if (code != 0)
     show_backtrace();
 #endif
+  mutt_worker_stop();
+  trace_close();
+  log_file_flush();
   exit(code);
 }
 
+/**
+ * main_worker_observer - Listen for config changes to the worker threads - Implements ::observer_t
+ */
+static int main_worker_observer(struct NotifyCallback *nc)
+{
+  if (!nc->event_data)
+    return -1;
+  if (nc->event_type != NT_CONFIG)
+    return 0;
+
+  struct EventConfig *ec = nc->event_data;
+
+  if (!mutt_str_equal(ec->name, "worker_threads"))
+    return 0;
+
+  mutt_worker_set_threads(cs_subset_number(NeoMutt->sub, "worker_threads"));
+  return 0;
+}
+
 // clang-format off
 /**
  * usage - Display NeoMutt command line
@@ -171,6 +199,7 @@ static void usage(void)
   puts(_("  neomutt [-n] [-e <command>] [-F <config>] -g <server>"));
   puts(_("  neomutt [-n] [-e <command>] [-F <config>] -p"));
   puts(_("  neomutt [-n] [-e <command>] [-F <config>] -Q <variable> [-O]"));
+  puts(_("  neomutt [-nR] [-e <command>] [-F <config>] [-f <mailbox>] -X <script>"));
   puts(_("  neomutt [-n] [-e <command>] [-F <config>] -Z"));
   puts(_("  neomutt [-n] [-e <command>] [-F <config>] -z [-f <mailbox>]"));
   puts(_("  neomutt -v[v]\n"));
@@ -209,8 +238,11 @@ static void usage(void)
          "                Add -O for one-liner documentation"));
   puts(_("  -R            Open mailbox in read-only mode"));
   puts(_("  -s <subject>  Specify a subject (must be enclosed in quotes if it has spaces)"));
+  puts(_("  -t <file>     Record a trace of the session, for Perfetto or chrome://tracing"));
   puts(_("  -v            Print the NeoMutt version and compile-time definitions and exit"));
   puts(_("  -vv           Print the NeoMutt license and copyright information and exit"));
+  puts(_("  -X <script>   Run the mailbox commands in a script, without the ncurses UI\n"
+         "                Use '-' to read the script from stdin"));
   puts(_("  -y            Start NeoMutt with a listing of all defined mailboxes"));
   puts(_("  -Z            Open the first mailbox with new message or exit immediately with\n"
          "                exit code 1 if none is found in all defined mailboxes"));
@@ -376,6 +408,8 @@ int main(int argc, char *argv[], char *envp[])
   char *new_type = NULL;
   char *dlevel = NULL;
   char *dfile = NULL;
+  char *tfile = NULL;
+  char *batch_file = NULL;
 #ifdef USE_NNTP
   const char *cli_nntp = NULL;
 #endif
@@ -444,7 +478,7 @@ int main(int argc, char *argv[], char *envp[])
     }
 
     /* USE_NNTP 'g:G' */
-    i = getopt(argc, argv, "+A:a:Bb:F:f:c:Dd:l:Ee:g:GH:i:hm:nOpQ:RSs:TvxyzZ");
+    i = getopt(argc, argv, "+A:a:Bb:F:f:c:Dd:l:Ee:g:GH:i:hm:nOpQ:RSs:t:TvxX:yzZ");
     if (i != EOF)
     {
       switch (i)
@@ -483,6 +517,10 @@ int main(int argc, char *argv[], char *envp[])
           mutt_buffer_strcpy(&folder, optarg);
           explicit_folder = true;
           break;
+        case 'X':
+          batch_file = optarg;
+          batch_mode = true;
+          break;
 #ifdef USE_NNTP
         case 'g': /* Specify a news server */
           cli_nntp = optarg;
@@ -524,6 +562,9 @@ int main(int argc, char *argv[], char *envp[])
         case 's':
           subject = optarg;
           break;
+        case 't':
+          tfile = optarg;
+          break;
 #ifdef USE_DEBUG_PARSE_TEST
         case 'T':
           test_config = true;
@@ -621,6 +662,12 @@ int main(int argc, char *argv[], char *envp[])
   if (dlevel)
     mutt_log_start();
 
+  if (tfile && (trace_open(tfile) < 0))
+  {
+    mutt_perror(tfile);
+    goto main_exit;
+  }
+
   MuttLogger = log_disp_queue;
 
   log_translation();
@@ -679,6 +726,7 @@ int main(int argc, char *argv[], char *envp[])
     goto main_curses;
 
   mutt_init_abort_key();
+  mutt_worker_set_threads(cs_subset_number(NeoMutt->sub, "worker_threads"));
 
   /* The command line overrides the config */
   if (dlevel)
@@ -782,9 +830,10 @@ int main(int argc, char *argv[], char *envp[])
 
 #ifdef USE_AUTOCRYPT
   /* Initialize autocrypt after curses messages are working,
-   * because of the initial account setup screens. */
+   * because of the initial account setup screens.
+   * If it's already set up, wait until it's first used. */
   const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-  if (c_autocrypt)
+  if (c_autocrypt && !mutt_autocrypt_db_exists())
     mutt_autocrypt_init(NULL, !(sendflags & SEND_BATCH));
 #endif
 
@@ -821,6 +870,14 @@ int main(int argc, char *argv[], char *envp[])
     mutt_buffer_pool_release(&fpath);
   }
 
+  if (batch_file)
+  {
+    if (flags & MUTT_CLI_RO)
+      cs_subset_str_native_set(NeoMutt->sub, "read_only", true, NULL);
+    rc = mutt_batch_run(batch_file, explicit_folder ? mutt_buffer_string(&folder) : NULL);
+    goto main_curses;
+  }
+
   if (batch_mode)
   {
     goto main_ok; // TEST22: neomutt -B
@@ -830,6 +887,9 @@ int main(int argc, char *argv[], char *envp[])
   notify_observer_add(NeoMutt->notify, NT_CONFIG, mutt_log_observer, NULL);
   notify_observer_add(NeoMutt->notify, NT_CONFIG, mutt_menu_config_observer, NULL);
   notify_observer_add(NeoMutt->notify, NT_CONFIG, mutt_abort_key_config_observer, NULL);
+  notify_observer_add(NeoMutt->notify, NT_CONFIG, main_worker_observer, NULL);
+  notify_observer_add(NeoMutt->notify, NT_CONFIG, mutt_decode_cache_observer, NULL);
+  notify_observer_add(NeoMutt->notify, NT_COMMAND, mutt_decode_cache_observer, NULL);
   if (Colors)
     notify_observer_add(Colors->notify, NT_CONFIG, mutt_menu_color_observer, NULL);
 
@@ -1240,7 +1300,9 @@ int main(int argc, char *argv[], char *envp[])
     repeat_error = true;
     struct Mailbox *m = mx_resolve(mutt_buffer_string(&folder));
     const bool c_read_only = cs_subset_bool(NeoMutt->sub, "read_only");
+    OptOpenCached = true;
     Context = mx_mbox_open(m, ((flags & MUTT_CLI_RO) || c_read_only) ? MUTT_READONLY : MUTT_OPEN_NO_FLAGS);
+    OptOpenCached = false;
     if (!Context)
     {
       if (m->account)
@@ -1295,19 +1357,33 @@ main_exit:
   mutt_list_free(&queries);
   crypto_module_free();
   mutt_window_free_all();
+  mutt_worker_stop();
+  trace_close();
+#ifdef USE_NOTMUCH
+  nm_db_snapshot_close();
+#endif
   mutt_buffer_pool_free();
+#ifdef USE_PCRE2_REGEX
+  mutt_pcre2_thread_free();
+#endif
   mutt_envlist_free();
   mutt_browser_cleanup();
+  mutt_ch_cache_cleanup();
   mutt_commands_cleanup();
+  mutt_expando_cleanup();
   crypt_cleanup();
   mutt_opts_free();
   subjrx_free();
   attach_free();
   alternates_free();
   mutt_keys_free();
+  mailcap_cache_free();
+  mutt_autoview_cache_free();
+  mutt_decode_cache_free();
   myvarlist_free(&MyVars);
   mutt_prex_free();
   neomutt_free(&NeoMutt);
+  mutt_socket_stats_free();
   cs_free(&cs);
   log_queue_flush(log_disp_terminal);
   log_queue_empty();
@@ -36,6 +36,11 @@ static struct ConfigDef MboxVars[] = {
   { "check_mbox_size", DT_BOOL, false, 0, NULL,
     "(mbox,mmdf) Use mailbox size as an indicator of new mail"
   },
+#ifdef USE_HCACHE
+  { "mbox_header_cache", DT_BOOL, false, 0, NULL,
+    "(mbox,mmdf) Save the message index of mbox folders in the header cache"
+  },
+#endif
   { NULL },
   // clang-format on
 };
@@ -49,9 +49,12 @@ struct MboxAccountData
 {
   FILE *fp;              ///< Mailbox file
   struct timespec atime; ///< File's last-access time
+  unsigned char tail[16]; ///< MD5 of the last block of the file, see mbox_save_tail()
 
-  bool locked : 1; ///< is the mailbox locked?
-  bool append : 1; ///< mailbox is opened in append mode
+  bool locked : 1;     ///< is the mailbox locked?
+  bool append : 1;     ///< mailbox is opened in append mode
+  bool tail_valid : 1; ///< tail matches the end of the file at Mailbox::size
+  bool append_batch : 1; ///< Appending several messages, see mbox_msg_append_batch()
 };
 
 extern struct MxOps MxMboxOps;
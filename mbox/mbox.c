@@ -38,6 +38,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -56,6 +57,9 @@
 #include "mx.h"
 #include "progress.h"
 #include "protos.h"
+#ifdef USE_HCACHE
+#include "hcache/lib.h"
+#endif
 
 /**
  * struct MUpdate - Store of new offsets, used by mutt_sync_mailbox()
@@ -69,6 +73,26 @@ struct MUpdate
   LOFF_T length;
 };
 
+#define MBOX_BLOCK_SIZE 4096 ///< Size of the blocks checksummed to identify a file
+
+#ifdef USE_HCACHE
+/**
+ * struct MboxIndexStamp - Identify the state of an mbox file
+ *
+ * This is stored in the header cache, alongside the Emails of the folder.
+ * If the file still matches, the Emails can be used instead of parsing it.
+ */
+struct MboxIndexStamp
+{
+  LOFF_T size;                ///< Size of the file
+  struct timespec mtime;      ///< Modification time of the file
+  unsigned char digest[16];   ///< MD5 of the first and last blocks of the file
+  int msg_count;              ///< Number of Emails stored
+};
+
+static const char MboxIndexKey[] = "/MBOXINDEX"; ///< Header cache key of the MboxIndexStamp
+#endif
+
 /**
  * mbox_adata_free - Free the private Account data - Implements Account::adata_free()
  */
@@ -109,6 +133,60 @@ static struct MboxAccountData *mbox_adata_get(struct Mailbox *m)
   return a->adata;
 }
 
+/**
+ * mbox_md5_block - Add a block of the mailbox file to a checksum
+ * @param fp     File handle of the mailbox
+ * @param offset Start of the block
+ * @param len    Length of the block, at most #MBOX_BLOCK_SIZE
+ * @param md5ctx Checksum to update
+ * @retval true Success
+ */
+static bool mbox_md5_block(FILE *fp, LOFF_T offset, size_t len, struct Md5Ctx *md5ctx)
+{
+  char block[MBOX_BLOCK_SIZE];
+  ssize_t rc = pread(fileno(fp), block, MIN(len, sizeof(block)), offset);
+  if (rc < 0)
+    return false;
+  mutt_md5_process_bytes(block, rc, md5ctx);
+  return true;
+}
+
+/**
+ * mbox_tail_digest - Checksum the last block of the mailbox file
+ * @param[in]  fp     File handle of the mailbox
+ * @param[in]  size   Size of the file
+ * @param[out] digest MD5 of the last #MBOX_BLOCK_SIZE bytes before size
+ * @retval true Success
+ */
+static bool mbox_tail_digest(FILE *fp, LOFF_T size, unsigned char *digest)
+{
+  struct Md5Ctx md5ctx;
+  mutt_md5_init_ctx(&md5ctx);
+
+  const LOFF_T start = MAX(size - MBOX_BLOCK_SIZE, 0);
+  if (!mbox_md5_block(fp, start, size - start, &md5ctx))
+    return false;
+
+  mutt_md5_finish_ctx(&md5ctx, digest);
+  return true;
+}
+
+/**
+ * mbox_save_tail - Remember the end of the mailbox file
+ * @param m Mailbox
+ *
+ * This is used by mbox_mbox_check() to make sure that the old contents of the
+ * file are intact when it grows.
+ */
+static void mbox_save_tail(struct Mailbox *m)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata)
+    return;
+
+  adata->tail_valid = adata->fp && mbox_tail_digest(adata->fp, m->size, adata->tail);
+}
+
 /**
  * init_mailbox - Add Mbox data to the Mailbox
  * @param m Mailbox
@@ -234,8 +312,7 @@ static enum MxOpenReturns mmdf_parse_mailbox(struct Mailbox *m)
       if (m->verbose)
         mutt_progress_update(&progress, count, (int) (loc / (m->size / 100 + 1)));
 
-      if (m->msg_count == m->email_max)
-        mx_alloc_memory(m);
+      mx_alloc_memory(m, m->msg_count + 1);
       e = email_new();
       m->emails[m->msg_count] = e;
       e->offset = loc;
@@ -327,9 +404,178 @@ static enum MxOpenReturns mmdf_parse_mailbox(struct Mailbox *m)
     return MX_OPEN_ABORT; /* action aborted */
   }
 
+  mbox_save_tail(m);
   return MX_OPEN_OK;
 }
 
+/**
+ * mbox_count_lines - Count the newlines in a block of memory
+ * @param p   Start of the block
+ * @param len Length of the block
+ * @retval num Number of newlines
+ */
+static size_t mbox_count_lines(const char *p, size_t len)
+{
+  size_t n = 0;
+  for (const char *end = p + len; (p = memchr(p, '\n', end - p)); p++)
+    n++;
+  return n;
+}
+
+/**
+ * mbox_parse_mapped - Read a mailbox through a memory map
+ * @param[in]  m        Mailbox
+ * @param[in]  progress Progress bar, may be NULL
+ * @param[out] count    Number of messages read
+ * @param[out] lines    Number of lines after the headers of the last message
+ * @retval true  Success
+ * @retval false The file couldn't be mapped, nothing was read
+ *
+ * This is the same as the stdio loop of mbox_parse_mailbox(), but rather than
+ * reading the file a line at a time, the message separators and line counts
+ * are found by scanning the map with memmem() and memchr(), which the C
+ * library vectorises.  The headers are still read by mutt_rfc822_read_header()
+ * from the mailbox file, so all the offsets are unchanged.
+ *
+ * On success, the mailbox's file position is left at the end of the file.
+ */
+static bool mbox_parse_mapped(struct Mailbox *m, struct Progress *progress,
+                              int *count, int *lines)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  const LOFF_T size = m->size;
+  LOFF_T loc = ftello(adata->fp);
+  if ((loc < 0) || (loc >= size) || ((uintmax_t) size > SIZE_MAX))
+    return false;
+
+  char *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(adata->fp), 0);
+  if (map == MAP_FAILED)
+    return false;
+
+  posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+
+  char buf[8192], return_path[256];
+  time_t t;
+  struct Email *e_cur = NULL;
+
+  while ((loc < size) && (SigInt != 1))
+  {
+    const char *line = map + loc;
+    const char *eol = memchr(line, '\n', size - loc);
+    const LOFF_T next = eol ? (eol - map + 1) : size;
+
+    bool from = false;
+    if (((size - loc) > 5) && (memcmp(line, "From ", 5) == 0))
+    {
+      const size_t len = MIN((size_t) (next - loc), sizeof(buf) - 1);
+      memcpy(buf, line, len);
+      buf[len] = '\0';
+      from = is_from(buf, return_path, sizeof(return_path), &t);
+    }
+
+    if (!from)
+    {
+      /* Jump to the next line that might be a message separator */
+      const char *sep = memmem(line, size - loc, "\nFrom ", 6);
+      const LOFF_T stop = sep ? (sep - map + 1) : size;
+      *lines += mbox_count_lines(line, stop - loc);
+      if ((stop == size) && (map[size - 1] != '\n'))
+        (*lines)++;
+      loc = stop;
+      continue;
+    }
+
+    /* Save the Content-Length of the previous message */
+    if (*count > 0)
+    {
+      struct Email *e = m->emails[m->msg_count - 1];
+      if (e->body->length < 0)
+      {
+        e->body->length = loc - e->body->offset - 1;
+        if (e->body->length < 0)
+          e->body->length = 0;
+      }
+      if (!e->lines)
+        e->lines = *lines ? *lines - 1 : 0;
+    }
+
+    (*count)++;
+
+    if (progress)
+      mutt_progress_update(progress, *count, (int) (loc / (size / 100 + 1)));
+
+    mx_alloc_memory(m, m->msg_count + 1);
+
+    m->emails[m->msg_count] = email_new();
+    e_cur = m->emails[m->msg_count];
+    e_cur->received = t - mutt_date_local_tz(t);
+    e_cur->offset = loc;
+    e_cur->index = m->msg_count;
+
+    if (fseeko(adata->fp, next, SEEK_SET) != 0)
+      mutt_debug(LL_DEBUG1, "#1 fseek() failed\n");
+    e_cur->env = mutt_rfc822_read_header(adata->fp, e_cur, false, false);
+    loc = ftello(adata->fp);
+
+    /* if we know how long this message is, either just skip over the body,
+     * or if we don't know how many lines there are, count them now.  */
+    if (e_cur->body->length > 0)
+    {
+      /* The test below avoids a potential integer overflow if the
+       * content-length is huge (thus necessarily invalid).  */
+      LOFF_T tmploc = (e_cur->body->length < size) ? (loc + e_cur->body->length + 1) : -1;
+
+      if ((tmploc > 0) && (tmploc < size))
+      {
+        /* check to see if the content-length looks valid.  we expect to
+         * to see a valid message separator at this point in the stream */
+        if (((size - tmploc) < 5) || (memcmp(map + tmploc, "From ", 5) != 0))
+        {
+          mutt_debug(LL_DEBUG1, "bad content-length in message %d (cl=" OFF_T_FMT ")\n",
+                     e_cur->index, e_cur->body->length);
+          e_cur->body->length = -1;
+        }
+      }
+      else if (tmploc != size)
+      {
+        /* content-length would put us past the end of the file, so it
+         * must be wrong */
+        e_cur->body->length = -1;
+      }
+
+      if (e_cur->body->length != -1)
+      {
+        /* good content-length.  check to see if we know how many lines
+         * are in this message.  */
+        if (e_cur->lines == 0)
+          e_cur->lines = mbox_count_lines(map + loc, e_cur->body->length);
+
+        /* continue from the next message separator */
+        loc = tmploc;
+      }
+    }
+
+    m->msg_count++;
+
+    if (TAILQ_EMPTY(&e_cur->env->return_path) && return_path[0])
+    {
+      mutt_addrlist_parse(&e_cur->env->return_path, return_path);
+    }
+
+    if (TAILQ_EMPTY(&e_cur->env->from))
+      mutt_addrlist_copy(&e_cur->env->from, &e_cur->env->return_path, false);
+
+    *lines = 0;
+  }
+
+  munmap(map, size);
+
+  if (fseeko(adata->fp, size, SEEK_SET) != 0)
+    mutt_debug(LL_DEBUG1, "#2 fseek() failed\n");
+
+  return true;
+}
+
 /**
  * mbox_parse_mailbox - Read a mailbox from disk
  * @param m Mailbox
@@ -379,6 +625,9 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
     mutt_progress_init(&progress, msg, MUTT_PROGRESS_READ, 0);
   }
 
+  if (mbox_parse_mapped(m, m->verbose ? &progress : NULL, &count, &lines))
+    goto finish;
+
   loc = ftello(adata->fp);
   while ((fgets(buf, sizeof(buf), adata->fp)) && (SigInt != 1))
   {
@@ -406,8 +655,7 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
                              (int) (ftello(adata->fp) / (m->size / 100 + 1)));
       }
 
-      if (m->msg_count == m->email_max)
-        mx_alloc_memory(m);
+      mx_alloc_memory(m, m->msg_count + 1);
 
       m->emails[m->msg_count] = email_new();
       e_cur = m->emails[m->msg_count];
@@ -497,6 +745,7 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
     loc = ftello(adata->fp);
   }
 
+finish:
   /* Only set the content-length of the previous message if we have read more
    * than one message during _this_ invocation.  If this routine is called
    * when new mail is received, we need to make sure not to clobber what
@@ -521,9 +770,194 @@ static enum MxOpenReturns mbox_parse_mailbox(struct Mailbox *m)
     return MX_OPEN_ABORT; /* action aborted */
   }
 
+  mbox_save_tail(m);
   return MX_OPEN_OK;
 }
 
+#ifdef USE_HCACHE
+/**
+ * mbox_index_stamp - Identify the current state of an mbox file
+ * @param[in]  fp    File handle of the mailbox
+ * @param[in]  st    Status of the file
+ * @param[out] stamp Identity of the file
+ * @retval true Success
+ *
+ * A message appended, or rewritten, in the same second without changing the
+ * size of the file would still change the first or last block.
+ */
+static bool mbox_index_stamp(FILE *fp, struct stat *st, struct MboxIndexStamp *stamp)
+{
+  memset(stamp, 0, sizeof(*stamp));
+  stamp->size = st->st_size;
+  mutt_file_get_stat_timespec(&stamp->mtime, st, MUTT_STAT_MTIME);
+
+  struct Md5Ctx md5ctx;
+  mutt_md5_init_ctx(&md5ctx);
+
+  if (!mbox_md5_block(fp, 0, MBOX_BLOCK_SIZE, &md5ctx))
+    return false;
+
+  if ((st->st_size > MBOX_BLOCK_SIZE) &&
+      !mbox_md5_block(fp, st->st_size - MBOX_BLOCK_SIZE, MBOX_BLOCK_SIZE, &md5ctx))
+  {
+    return false;
+  }
+
+  mutt_md5_finish_ctx(&md5ctx, stamp->digest);
+  return true;
+}
+
+/**
+ * mbox_index_load - Read the Emails of an unchanged mbox from the header cache
+ * @param m Mailbox
+ * @retval true The Emails were loaded, the mailbox doesn't need parsing
+ *
+ * @note It is assumed that the mailbox has been locked.
+ */
+static bool mbox_index_load(struct Mailbox *m)
+{
+  const bool c_mbox_header_cache = cs_subset_bool(NeoMutt->sub, "mbox_header_cache");
+  if (!c_mbox_header_cache)
+    return false;
+
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata)
+    return false;
+
+  struct stat st = { 0 };
+  struct MboxIndexStamp stamp = { 0 };
+  if ((fstat(fileno(adata->fp), &st) != 0) || !mbox_index_stamp(adata->fp, &st, &stamp))
+    return false;
+
+  const char *const c_header_cache = cs_subset_path(NeoMutt->sub, "header_cache");
+  struct HeaderCache *hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  if (!hc)
+    return false;
+
+  bool rc = false;
+  int count = 0;
+  size_t dlen = 0;
+  void *data = mutt_hcache_fetch_raw(hc, MboxIndexKey, sizeof(MboxIndexKey) - 1, &dlen);
+  if (data && (dlen == sizeof(stamp)))
+  {
+    const struct MboxIndexStamp *saved = data;
+    if ((saved->size == stamp.size) && (saved->mtime.tv_sec == stamp.mtime.tv_sec) &&
+        (saved->mtime.tv_nsec == stamp.mtime.tv_nsec) &&
+        (memcmp(saved->digest, stamp.digest, sizeof(stamp.digest)) == 0))
+    {
+      count = saved->msg_count;
+    }
+  }
+  mutt_hcache_free_raw(hc, &data);
+
+  if (count <= 0)
+    goto done;
+
+  mx_alloc_memory(m, count);
+
+  char key[32];
+  for (int i = 0; i < count; i++)
+  {
+    int keylen = snprintf(key, sizeof(key), "/%d", i);
+    struct HCacheEntry hce = mutt_hcache_fetch(hc, key, keylen, 0);
+    if (!hce.email)
+    {
+      mutt_debug(LL_DEBUG1, "message %d is missing from the header cache\n", i);
+      for (int j = 0; j < m->msg_count; j++)
+        email_free(&m->emails[j]);
+      m->msg_count = 0;
+      goto done;
+    }
+
+    mx_alloc_memory(m, m->msg_count + 1);
+
+    hce.email->index = m->msg_count;
+    m->emails[m->msg_count++] = hce.email;
+  }
+
+  /* Save information about the folder at the time we opened it. */
+  m->size = st.st_size;
+  mutt_file_get_stat_timespec(&m->mtime, &st, MUTT_STAT_MTIME);
+  mutt_file_get_stat_timespec(&adata->atime, &st, MUTT_STAT_ATIME);
+
+  if (!m->readonly)
+    m->readonly = access(mailbox_path(m), W_OK) ? true : false;
+
+  mbox_save_tail(m);
+  mutt_debug(LL_DEBUG2, "read %d messages from the header cache\n", m->msg_count);
+  rc = true;
+
+done:
+  mutt_hcache_close(hc);
+  return rc;
+}
+
+/**
+ * mbox_index_save - Save the Emails of a freshly parsed mbox to the header cache
+ * @param m Mailbox
+ *
+ * @note It is assumed that the mailbox has been locked since it was parsed.
+ */
+static void mbox_index_save(struct Mailbox *m)
+{
+  const bool c_mbox_header_cache = cs_subset_bool(NeoMutt->sub, "mbox_header_cache");
+  if (!c_mbox_header_cache || (m->msg_count == 0))
+    return;
+
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata)
+    return;
+
+  struct stat st = { 0 };
+  struct MboxIndexStamp stamp = { 0 };
+  if ((fstat(fileno(adata->fp), &st) != 0) || !mbox_index_stamp(adata->fp, &st, &stamp))
+    return;
+
+  const char *const c_header_cache = cs_subset_path(NeoMutt->sub, "header_cache");
+  struct HeaderCache *hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  if (!hc)
+    return;
+
+  mutt_hcache_begin_txn(hc);
+
+  char key[32];
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    int keylen = snprintf(key, sizeof(key), "/%d", i);
+    mutt_hcache_store(hc, key, keylen, m->emails[i], 0);
+  }
+
+  /* The stamp goes last, it validates the records before it */
+  stamp.msg_count = m->msg_count;
+  mutt_hcache_store_raw(hc, MboxIndexKey, sizeof(MboxIndexKey) - 1, &stamp, sizeof(stamp));
+
+  mutt_hcache_commit_txn(hc);
+  mutt_hcache_close(hc);
+}
+
+/**
+ * mbox_index_invalidate - Forget the saved index of an mbox
+ * @param m Mailbox
+ *
+ * This must be called before the file is rewritten.  A rewrite may leave its
+ * size, mtime and first and last blocks unchanged.
+ */
+static void mbox_index_invalidate(struct Mailbox *m)
+{
+  const bool c_mbox_header_cache = cs_subset_bool(NeoMutt->sub, "mbox_header_cache");
+  if (!c_mbox_header_cache)
+    return;
+
+  const char *const c_header_cache = cs_subset_path(NeoMutt->sub, "header_cache");
+  struct HeaderCache *hc = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  if (!hc)
+    return;
+
+  mutt_hcache_delete_record(hc, MboxIndexKey, sizeof(MboxIndexKey) - 1);
+  mutt_hcache_close(hc);
+}
+#endif
+
 /**
  * reopen_mailbox - Close and reopen a mailbox
  * @param m          Mailbox
@@ -942,6 +1376,12 @@ static enum MxOpenReturns mbox_mbox_open(struct Mailbox *m)
 
   m->has_new = true;
   enum MxOpenReturns rc = MX_OPEN_ERROR;
+#ifdef USE_HCACHE
+  const bool cached = mbox_index_load(m);
+  if (cached)
+    rc = MX_OPEN_OK;
+  else
+#endif
   if (m->type == MUTT_MBOX)
     rc = mbox_parse_mailbox(m);
   else if (m->type == MUTT_MMDF)
@@ -949,6 +1389,11 @@ static enum MxOpenReturns mbox_mbox_open(struct Mailbox *m)
   else
     rc = MX_OPEN_ERROR;
 
+#ifdef USE_HCACHE
+  if (!cached && (rc == MX_OPEN_OK))
+    mbox_index_save(m);
+#endif
+
   if (!mbox_has_new(m))
     m->has_new = false;
   clearerr(adata->fp); // Clear the EOF flag
@@ -1004,6 +1449,56 @@ static bool mbox_mbox_open_append(struct Mailbox *m, OpenMailboxFlags flags)
   return true;
 }
 
+/**
+ * mbox_appended_offset - Find the new mail appended to a mailbox
+ * @param m Mailbox
+ * @retval num Offset of the first new message separator
+ * @retval -1  The file wasn't just appended to
+ *
+ * The end of the old file must be unchanged, and a message separator must
+ * follow it.  Some MDAs write a blank line before the separator, if the file
+ * didn't end with one, so blank lines are skipped.
+ */
+static LOFF_T mbox_appended_offset(struct Mailbox *m)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata)
+    return -1;
+
+  unsigned char digest[16];
+  if (!adata->tail_valid || !mbox_tail_digest(adata->fp, m->size, digest) ||
+      (memcmp(digest, adata->tail, sizeof(digest)) != 0))
+  {
+    mutt_debug(LL_DEBUG1, "the end of the mailbox has changed\n");
+    return -1;
+  }
+
+  LOFF_T loc = m->size;
+  if (fseeko(adata->fp, loc, SEEK_SET) != 0)
+  {
+    mutt_debug(LL_DEBUG1, "#1 fseek() failed\n");
+    return -1;
+  }
+
+  char buf[1024];
+  while (fgets(buf, sizeof(buf), adata->fp))
+  {
+    if (((m->type == MUTT_MBOX) && mutt_str_startswith(buf, "From ")) ||
+        ((m->type == MUTT_MMDF) && mutt_str_equal(buf, MMDF_SEP)))
+    {
+      return loc;
+    }
+
+    if (!mutt_str_equal(buf, "\n"))
+      break;
+
+    loc = ftello(adata->fp);
+  }
+
+  mutt_debug(LL_DEBUG1, "no message separator after the old end of the mailbox\n");
+  return -1;
+}
+
 /**
  * mbox_mbox_check - Check for new mail - Implements MxOps::mbox_check()
  * @param[in]  m Mailbox
@@ -1061,48 +1556,36 @@ static enum MxStatus mbox_mbox_check(struct Mailbox *m)
       }
 
       /* Check to make sure that the only change to the mailbox is that
-       * message(s) were appended to this file.  My heuristic is that we should
-       * see the message separator at *exactly* what used to be the end of the
-       * folder.  */
-      char buf[1024];
-      if (fseeko(adata->fp, m->size, SEEK_SET) != 0)
-        mutt_debug(LL_DEBUG1, "#1 fseek() failed\n");
-      if (fgets(buf, sizeof(buf), adata->fp))
+       * message(s) were appended to this file.  If so, only the new messages
+       * need to be parsed.  */
+      const LOFF_T appended = mbox_appended_offset(m);
+      if (appended >= 0)
       {
-        if (((m->type == MUTT_MBOX) && mutt_str_startswith(buf, "From ")) ||
-            ((m->type == MUTT_MMDF) && mutt_str_equal(buf, MMDF_SEP)))
-        {
-          if (fseeko(adata->fp, m->size, SEEK_SET) != 0)
-            mutt_debug(LL_DEBUG1, "#2 fseek() failed\n");
-
-          int old_msg_count = m->msg_count;
-          if (m->type == MUTT_MBOX)
-            mbox_parse_mailbox(m);
-          else
-            mmdf_parse_mailbox(m);
-
-          if (m->msg_count > old_msg_count)
-            mailbox_changed(m, NT_MAILBOX_INVALID);
-
-          /* Only unlock the folder if it was locked inside of this routine.
-           * It may have been locked elsewhere, like in
-           * mutt_checkpoint_mailbox().  */
-          if (unlock)
-          {
-            mbox_unlock_mailbox(m);
-            mutt_sig_unblock();
-          }
+        if (fseeko(adata->fp, appended, SEEK_SET) != 0)
+          mutt_debug(LL_DEBUG1, "#2 fseek() failed\n");
 
-          return MX_STATUS_NEW_MAIL; /* signal that new mail arrived */
-        }
+        int old_msg_count = m->msg_count;
+        if (m->type == MUTT_MBOX)
+          mbox_parse_mailbox(m);
         else
-          modified = true;
+          mmdf_parse_mailbox(m);
+
+        if (m->msg_count > old_msg_count)
+          mailbox_changed(m, NT_MAILBOX_INVALID);
+
+        /* Only unlock the folder if it was locked inside of this routine.
+         * It may have been locked elsewhere, like in
+         * mutt_checkpoint_mailbox().  */
+        if (unlock)
+        {
+          mbox_unlock_mailbox(m);
+          mutt_sig_unblock();
+        }
+
+        return MX_STATUS_NEW_MAIL; /* signal that new mail arrived */
       }
       else
-      {
-        mutt_debug(LL_DEBUG1, "fgets returned NULL\n");
         modified = true;
-      }
     }
     else
       modified = true;
@@ -1131,6 +1614,123 @@ static enum MxStatus mbox_mbox_check(struct Mailbox *m)
   return MX_STATUS_ERROR;
 }
 
+/**
+ * mbox_pad_header - Make a rewritten header fill the space of the old one
+ * @param hdr  Header, ending with a blank line
+ * @param hlen Length of the header
+ * @param want Length of the old header
+ * @retval true The header is now exactly want bytes long
+ *
+ * A shorter header is padded with spaces at the end of its Status or X-Status
+ * line.  The flags parsed from those lines are unaffected, and the padding is
+ * dropped the next time the header is rewritten.
+ */
+static bool mbox_pad_header(char **hdr, size_t *hlen, size_t want)
+{
+  if (*hlen == want)
+    return true;
+  if (*hlen > want)
+    return false;
+
+  char *line = strstr(*hdr, "\nStatus: ");
+  if (!line)
+    line = strstr(*hdr, "\nX-Status: ");
+  if (!line)
+    return false;
+
+  const size_t eol = strchr(line + 1, '\n') - *hdr;
+  const size_t pad = want - *hlen;
+  mutt_mem_realloc(hdr, want + 1);
+  memmove(*hdr + eol + pad, *hdr + eol, *hlen - eol + 1);
+  memset(*hdr + eol, ' ', pad);
+  *hlen = want;
+  return true;
+}
+
+/**
+ * mbox_sync_in_place - Rewrite the changed headers without moving any messages
+ * @param[in]  m       Mailbox
+ * @param[out] written Number of headers rewritten
+ * @retval num Index of the first message that needs to be copied, or Mailbox::msg_count
+ * @retval -1  Error
+ *
+ * The changed messages at the start of the mailbox are updated in place, as
+ * long as their new headers fit exactly into their old ones, see
+ * mbox_pad_header().  This stops at the first message which is deleted, or
+ * whose size would change.  That, and everything after it, has to be copied.
+ */
+static int mbox_sync_in_place(struct Mailbox *m, int *written)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  *written = 0;
+
+  FILE *fp = NULL;
+  char *hdr = NULL;
+  int i = 0;
+  for (; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (e->deleted || e->attach_del)
+      break;
+    if (!e->changed)
+      continue;
+
+    if (!fp)
+    {
+      fp = mutt_file_mkstemp();
+      if (!fp)
+      {
+        mutt_perror(_("Could not create temporary file"));
+        i = -1;
+        break;
+      }
+    }
+
+    /* Format the header exactly as the copy below would */
+    rewind(fp);
+    if ((ftruncate(fileno(fp), 0) != 0) ||
+        (mutt_copy_header(adata->fp, e, fp, CH_FROM | CH_UPDATE | CH_UPDATE_LEN, NULL, 0) != 0) ||
+        (fflush(fp) != 0))
+    {
+      i = -1;
+      break;
+    }
+
+    LOFF_T len = ftello(fp);
+    const LOFF_T old_len = e->body->offset - e->offset;
+    if ((len <= 0) || (len > old_len))
+      break;
+
+    size_t hlen = len;
+    mutt_mem_realloc(&hdr, hlen + 1);
+    rewind(fp);
+    if (fread(hdr, 1, hlen, fp) != hlen)
+    {
+      i = -1;
+      break;
+    }
+    hdr[hlen] = '\0';
+
+    if (!mbox_pad_header(&hdr, &hlen, old_len))
+      break;
+
+    if ((fseeko(adata->fp, e->offset, SEEK_SET) != 0) ||
+        (fwrite(hdr, 1, hlen, adata->fp) != hlen) || (fflush(adata->fp) != 0))
+    {
+      mutt_perror(mailbox_path(m));
+      i = -1;
+      break;
+    }
+    (*written)++;
+  }
+
+  FREE(&hdr);
+  mutt_file_fclose(&fp);
+  if (i >= 0)
+    mutt_debug(LL_DEBUG2, "%d headers rewritten in place\n", *written);
+  return i;
+}
+
 /**
  * mbox_mbox_sync - Save changes to the Mailbox - Implements MxOps::mbox_sync()
  */
@@ -1196,6 +1796,45 @@ static enum MxStatus mbox_mbox_sync(struct Mailbox *m)
     goto fatal;
   }
 
+  /* Save the state of this folder. */
+  if (stat(mailbox_path(m), &statbuf) == -1)
+  {
+    mutt_perror(mailbox_path(m));
+    goto bail;
+  }
+
+#ifdef USE_HCACHE
+  mbox_index_invalidate(m);
+#endif
+
+  /* find the first deleted/changed message that can't be updated in place.
+   * we save a lot of time by only rewriting the mailbox from the point where
+   * it has actually changed.  */
+  int written = 0;
+  int i = mbox_sync_in_place(m, &written);
+  if (i < 0)
+    goto bail;
+
+  if (i == m->msg_count)
+  {
+    if (written == 0)
+    {
+      /* this means ctx->changed or m->msg_deleted was set, but no
+       * messages were found to be changed or deleted.  This should
+       * never happen, is we presume it is a bug in neomutt.  */
+      mutt_error(
+          _("sync: mbox modified, but no modified messages (report this bug)"));
+      mutt_debug(LL_DEBUG1, "no modified messages\n");
+      goto bail;
+    }
+
+    /* every change fitted, nothing needs to be copied */
+    mbox_unlock_mailbox(m);
+    mbox_reset_atime(m, &statbuf);
+    mbox_save_tail(m);
+    goto synced;
+  }
+
   /* Create a temporary file to write the new version of the mailbox in. */
   tempfile = mutt_buffer_pool_get();
   mutt_buffer_mktemp(tempfile);
@@ -1212,25 +1851,6 @@ static enum MxStatus mbox_mbox_sync(struct Mailbox *m)
   }
   unlink_tempfile = true;
 
-  /* find the first deleted/changed message.  we save a lot of time by only
-   * rewriting the mailbox from the point where it has actually changed.  */
-  int i = 0;
-  for (; (i < m->msg_count) && !m->emails[i]->deleted &&
-         !m->emails[i]->changed && !m->emails[i]->attach_del;
-       i++)
-  {
-  }
-  if (i == m->msg_count)
-  {
-    /* this means ctx->changed or m->msg_deleted was set, but no
-     * messages were found to be changed or deleted.  This should
-     * never happen, is we presume it is a bug in neomutt.  */
-    mutt_error(
-        _("sync: mbox modified, but no modified messages (report this bug)"));
-    mutt_debug(LL_DEBUG1, "no modified messages\n");
-    goto bail;
-  }
-
   /* save the index of the first changed/deleted message */
   first = i;
   /* where to start overwriting */
@@ -1324,13 +1944,6 @@ static enum MxStatus mbox_mbox_sync(struct Mailbox *m)
     goto bail;
   }
 
-  /* Save the state of this folder. */
-  if (stat(mailbox_path(m), &statbuf) == -1)
-  {
-    mutt_perror(mailbox_path(m));
-    goto bail;
-  }
-
   unlink_tempfile = false;
 
   fp = fopen(mutt_buffer_string(tempfile), "r");
@@ -1441,8 +2054,11 @@ static enum MxStatus mbox_mbox_sync(struct Mailbox *m)
   }
   FREE(&new_offset);
   FREE(&old_offset);
+  mbox_save_tail(m);
   unlink(mutt_buffer_string(tempfile)); /* remove partial copy of the mailbox */
   mutt_buffer_pool_release(&tempfile);
+
+synced:
   mutt_sig_unblock();
 
   const bool c_check_mbox_size =
@@ -1574,14 +2190,22 @@ static bool mbox_msg_open_new(struct Mailbox *m, struct Message *msg, const stru
 }
 
 /**
- * mbox_msg_commit - Save changes to an email - Implements MxOps::msg_commit()
+ * mbox_append_flush - Flush the appended messages to disk
+ * @param m  Mailbox
+ * @param fp File being appended to
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * During a batch, the messages are left in the stdio buffer, to be flushed by
+ * mbox_msg_append_batch().
  */
-static int mbox_msg_commit(struct Mailbox *m, struct Message *msg)
+static int mbox_append_flush(struct Mailbox *m, FILE *fp)
 {
-  if (fputc('\n', msg->fp) == EOF)
-    return -1;
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (adata && adata->append_batch)
+    return 0;
 
-  if ((fflush(msg->fp) == EOF) || (fsync(fileno(msg->fp)) == -1))
+  if ((fflush(fp) == EOF) || (fsync(fileno(fp)) == -1))
   {
     mutt_perror(_("Can't write message"));
     return -1;
@@ -1590,6 +2214,17 @@ static int mbox_msg_commit(struct Mailbox *m, struct Message *msg)
   return 0;
 }
 
+/**
+ * mbox_msg_commit - Save changes to an email - Implements MxOps::msg_commit()
+ */
+static int mbox_msg_commit(struct Mailbox *m, struct Message *msg)
+{
+  if (fputc('\n', msg->fp) == EOF)
+    return -1;
+
+  return mbox_append_flush(m, msg->fp);
+}
+
 /**
  * mbox_msg_close - Close an email - Implements MxOps::msg_close()
  */
@@ -1603,6 +2238,26 @@ static int mbox_msg_close(struct Mailbox *m, struct Message *msg)
   return 0;
 }
 
+/**
+ * mbox_msg_append_batch - Start or finish appending several messages - Implements MxOps::msg_append_batch()
+ *
+ * The Mailbox is locked for as long as it's open for appending, so a batch
+ * only saves flushing each message to disk.
+ */
+static int mbox_msg_append_batch(struct Mailbox *m, bool start)
+{
+  struct MboxAccountData *adata = mbox_adata_get(m);
+  if (!adata)
+    return 0;
+
+  const bool was_batch = adata->append_batch;
+  adata->append_batch = start;
+  if (start || !was_batch || !adata->fp)
+    return 0;
+
+  return mbox_append_flush(m, adata->fp);
+}
+
 /**
  * mbox_msg_padding_size - Bytes of padding between messages - Implements MxOps::msg_padding_size()
  * @param m Mailbox
@@ -1734,13 +2389,7 @@ static int mmdf_msg_commit(struct Mailbox *m, struct Message *msg)
   if (fputs(MMDF_SEP, msg->fp) == EOF)
     return -1;
 
-  if ((fflush(msg->fp) == EOF) || (fsync(fileno(msg->fp)) == -1))
-  {
-    mutt_perror(_("Can't write message"));
-    return -1;
-  }
-
-  return 0;
+  return mbox_append_flush(m, msg->fp);
 }
 
 /**
@@ -1827,9 +2476,11 @@ struct MxOps MxMboxOps = {
   .mbox_sync        = mbox_mbox_sync,
   .mbox_close       = mbox_mbox_close,
   .msg_open         = mbox_msg_open,
+  .msg_prefetch     = NULL,
   .msg_open_new     = mbox_msg_open_new,
   .msg_commit       = mbox_msg_commit,
   .msg_close        = mbox_msg_close,
+  .msg_append_batch = mbox_msg_append_batch,
   .msg_padding_size = mbox_msg_padding_size,
   .msg_save_hcache  = NULL,
   .tags_edit        = NULL,
@@ -1857,9 +2508,11 @@ struct MxOps MxMmdfOps = {
   .mbox_sync        = mbox_mbox_sync,
   .mbox_close       = mbox_mbox_close,
   .msg_open         = mbox_msg_open,
+  .msg_prefetch     = NULL,
   .msg_open_new     = mbox_msg_open_new,
   .msg_commit       = mmdf_msg_commit,
   .msg_close        = mbox_msg_close,
+  .msg_append_batch = mbox_msg_append_batch,
   .msg_padding_size = mmdf_msg_padding_size,
   .msg_save_hcache  = NULL,
   .tags_edit        = NULL,
@@ -31,6 +31,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 #include "mutt/lib.h"
@@ -38,8 +39,10 @@
 #include "email/lib.h"
 #include "core/lib.h"
 #include "gui/lib.h"
+#include "debug/lib.h"
 #include "mutt.h"
 #include "pattern/lib.h"
+#include "index/lib.h"
 #include "commands.h"
 #include "context.h"
 #include "keymap.h"
@@ -79,6 +82,10 @@ static int get_color(int index, unsigned char *s)
   struct Email *e = mutt_get_virt_email(Context->mailbox, index);
   int type = *s;
 
+  int *cached = index_field_color(e, type);
+  if (cached && (*cached >= 0))
+    return *cached;
+
   switch (type)
   {
     case MT_COLOR_INDEX_AUTHOR:
@@ -106,14 +113,21 @@ static int get_color(int index, unsigned char *s)
       return Colors->defs[type];
   }
 
+  int pair = 0;
+  struct PatternCache cache = { 0 };
   STAILQ_FOREACH(np, color, entries)
   {
     if (mutt_pattern_exec(SLIST_FIRST(np->color_pattern),
-                          MUTT_MATCH_FULL_ADDRESS, Context->mailbox, e, NULL))
-      return np->pair;
+                          MUTT_MATCH_FULL_ADDRESS, Context->mailbox, e, &cache))
+    {
+      pair = np->pair;
+      break;
+    }
   }
 
-  return 0;
+  if (cached)
+    *cached = pair;
+  return pair;
 }
 
 /**
@@ -276,27 +290,29 @@ static void print_enriched_string(int index, int attr, unsigned char *s, bool do
         }
         else
         {
-          if (get_color(index, s) == 0)
-          {
-            attron(attr);
-          }
-          else
-          {
-            attron(get_color(index, s));
-          }
+          const int color = get_color(index, s);
+          attron((color == 0) ? attr : color);
         }
       }
       s++;
       n -= 2;
     }
-    else if ((k = mbrtowc(&wc, (char *) s, n, &mbstate)) > 0)
+    else
     {
-      mutt_window_addnstr((char *) s, k);
-      s += k;
-      n -= k;
+      /* Write the text up to the next colour or graphic in one go */
+      unsigned char *start = s;
+      while (*s > MUTT_SPECIAL_INDEX)
+      {
+        k = mbrtowc(&wc, (char *) s, n, &mbstate);
+        if ((k == 0) || (k == (size_t)(-1)) || (k == (size_t)(-2)))
+          break;
+        s += k;
+        n -= k;
+      }
+      if (s == start)
+        break;
+      mutt_window_addnstr((char *) start, s - start);
     }
-    else
-      break;
   }
 }
 
@@ -349,6 +365,7 @@ void menu_redraw_full(struct Menu *menu)
 {
   mutt_curses_set_color(MT_COLOR_NORMAL);
   mutt_window_clear(menu->win_index);
+  menu->drawn_top = -1;
 
   window_redraw(RootWindow, true);
   menu->pagelen = menu->win_index->state.rows;
@@ -375,59 +392,115 @@ void menu_redraw_status(struct Menu *menu)
 }
 
 /**
- * menu_redraw_index - Force the redraw of the index
+ * menu_redraw_line - Redraw one line of the index
  * @param menu Current Menu
+ * @param i    Entry to draw
+ *
+ * The line of the Window is cleared if the entry doesn't exist.
  */
-void menu_redraw_index(struct Menu *menu)
+static void menu_redraw_line(struct Menu *menu, int i)
 {
   char buf[1024];
-  bool do_color;
-  int attr;
 
-  for (int i = menu->top; i < (menu->top + menu->pagelen); i++)
+  if (i >= menu->max)
   {
-    if (i < menu->max)
-    {
-      attr = menu->color(menu, i);
+    mutt_curses_set_color(MT_COLOR_NORMAL);
+    mutt_window_clearline(menu->win_index, i - menu->top);
+    return;
+  }
 
-      make_entry(menu, buf, sizeof(buf), i);
-      menu_pad_string(menu, buf, sizeof(buf));
+  const int attr = menu->color(menu, i);
 
-      mutt_curses_set_attr(attr);
-      mutt_window_move(menu->win_index, 0, i - menu->top);
-      do_color = true;
+  make_entry(menu, buf, sizeof(buf), i);
+  menu_pad_string(menu, buf, sizeof(buf));
 
-      const bool c_arrow_cursor = cs_subset_bool(NeoMutt->sub, "arrow_cursor");
-      const char *const c_arrow_string =
-          cs_subset_string(NeoMutt->sub, "arrow_string");
-      if (i == menu->current)
-      {
-        mutt_curses_set_color(MT_COLOR_INDICATOR);
-        if (c_arrow_cursor)
-        {
-          mutt_window_addstr(c_arrow_string);
-          mutt_curses_set_attr(attr);
-          mutt_window_addch(' ');
-        }
-        else
-          do_color = false;
-      }
-      else if (c_arrow_cursor)
-      {
-        /* Print space chars to match the screen width of `$arrow_string` */
-        mutt_window_printf("%*s", mutt_strwidth(c_arrow_string) + 1, "");
-      }
+  mutt_curses_set_attr(attr);
+  mutt_window_move(menu->win_index, 0, i - menu->top);
+  bool do_color = true;
 
-      print_enriched_string(i, attr, (unsigned char *) buf, do_color);
-    }
-    else
+  const bool c_arrow_cursor = cs_subset_bool(NeoMutt->sub, "arrow_cursor");
+  const char *const c_arrow_string = cs_subset_string(NeoMutt->sub, "arrow_string");
+  if (i == menu->current)
+  {
+    mutt_curses_set_color(MT_COLOR_INDICATOR);
+    if (c_arrow_cursor)
     {
-      mutt_curses_set_color(MT_COLOR_NORMAL);
-      mutt_window_clearline(menu->win_index, i - menu->top);
+      mutt_window_addstr(c_arrow_string);
+      mutt_curses_set_attr(attr);
+      mutt_window_addch(' ');
     }
+    else
+      do_color = false;
+  }
+  else if (c_arrow_cursor)
+  {
+    /* Print space chars to match the screen width of `$arrow_string` */
+    mutt_window_printf("%*s", mutt_strwidth(c_arrow_string) + 1, "");
   }
+
+  print_enriched_string(i, attr, (unsigned char *) buf, do_color);
+}
+
+/**
+ * menu_redraw_index - Force the redraw of the index
+ * @param menu Current Menu
+ */
+void menu_redraw_index(struct Menu *menu)
+{
+  for (int i = menu->top; i < (menu->top + menu->pagelen); i++)
+    menu_redraw_line(menu, i);
+
   mutt_curses_set_color(MT_COLOR_NORMAL);
   menu->redraw = 0;
+  menu->drawn_top = menu->top;
+  menu->drawn_current = menu->current;
+}
+
+/**
+ * menu_redraw_scroll - Redraw the index after the page has moved
+ * @param menu Current Menu
+ *
+ * The lines that are still visible are scrolled into place and only the new
+ * lines, and the ones that have gained or lost the indicator, are drawn.  If
+ * the Window can't be scrolled, the whole index is redrawn.
+ */
+void menu_redraw_scroll(struct Menu *menu)
+{
+  const int shift = menu->top - menu->drawn_top;
+
+  if (!ARRAY_EMPTY(&menu->dialog) || (menu->drawn_top < 0) ||
+      (menu->pagelen != menu->win_index->state.rows) ||
+      (abs(shift) >= menu->pagelen) || !mutt_window_scroll(menu->win_index, shift))
+  {
+    menu_redraw_index(menu);
+    return;
+  }
+
+  int first = menu->top;
+  int last = menu->top + menu->pagelen;
+  if (shift > 0)
+    first = last - shift;
+  else
+    last = first - shift;
+
+  for (int i = first; i < last; i++)
+    menu_redraw_line(menu, i);
+
+  /* The old indicator may have been scrolled, rather than redrawn */
+  const int old = menu->drawn_current;
+  if (((old < first) || (old >= last)) && (old >= menu->top) &&
+      (old < (menu->top + menu->pagelen)))
+  {
+    menu_redraw_line(menu, old);
+  }
+
+  if ((menu->current != old) && ((menu->current < first) || (menu->current >= last)))
+    menu_redraw_line(menu, menu->current);
+
+  mutt_curses_set_color(MT_COLOR_NORMAL);
+  menu->redraw = 0;
+  menu->drawn_top = menu->top;
+  menu->drawn_current = menu->current;
 }
 
 /**
@@ -490,6 +563,7 @@ void menu_redraw_motion(struct Menu *menu)
     print_enriched_string(menu->current, cur_color, (unsigned char *) buf, false);
   }
   menu->redraw &= REDRAW_STATUS;
+  menu->drawn_current = menu->current;
   mutt_curses_set_color(MT_COLOR_NORMAL);
 }
 
@@ -597,7 +671,7 @@ void menu_check_recenter(struct Menu *menu)
   menu->top = MAX(menu->top, 0);
 
   if (menu->top != old_top)
-    menu->redraw |= REDRAW_INDEX;
+    menu->redraw |= REDRAW_SCROLL;
 }
 
 /**
@@ -654,7 +728,7 @@ void menu_next_line(struct Menu *menu)
     menu->top++;
     if ((menu->current < (menu->top + c)) && (menu->current < (menu->max - 1)))
       menu->current++;
-    menu->redraw = REDRAW_INDEX;
+    menu->redraw = REDRAW_SCROLL;
   }
   else
     mutt_message(_("You can't scroll down farther"));
@@ -678,7 +752,7 @@ void menu_prev_line(struct Menu *menu)
   menu->top--;
   if ((menu->current >= (menu->top + menu->pagelen - c)) && (menu->current > 1))
     menu->current--;
-  menu->redraw = REDRAW_INDEX;
+  menu->redraw = REDRAW_SCROLL;
 }
 
 /**
@@ -723,7 +797,7 @@ static void menu_length_jump(struct Menu *menu, int jumplen)
       menu->current -= tmp;
     }
 
-    menu->redraw = REDRAW_INDEX;
+    menu->redraw = REDRAW_SCROLL;
   }
   else if ((menu->current != (neg ? 0 : menu->max - 1)) && ARRAY_EMPTY(&menu->dialog))
   {
@@ -870,7 +944,7 @@ void menu_current_top(struct Menu *menu)
   }
 
   menu->top = menu->current;
-  menu->redraw = REDRAW_INDEX;
+  menu->redraw = REDRAW_SCROLL;
 }
 
 /**
@@ -888,7 +962,7 @@ void menu_current_middle(struct Menu *menu)
   menu->top = menu->current - (menu->pagelen / 2);
   if (menu->top < 0)
     menu->top = 0;
-  menu->redraw = REDRAW_INDEX;
+  menu->redraw = REDRAW_SCROLL;
 }
 
 /**
@@ -906,7 +980,7 @@ void menu_current_bottom(struct Menu *menu)
   menu->top = menu->current - menu->pagelen + 1;
   if (menu->top < 0)
     menu->top = 0;
-  menu->redraw = REDRAW_INDEX;
+  menu->redraw = REDRAW_SCROLL;
 }
 
 /**
@@ -978,6 +1052,7 @@ struct Menu *mutt_menu_new(enum MenuType type)
 
   menu->type = type;
   menu->redraw = REDRAW_FULL;
+  menu->drawn_top = -1;
   menu->color = default_color;
   menu->search = generic_search;
 
@@ -1289,6 +1364,9 @@ static int menu_dialog_dokey(struct Menu *menu, int *ip)
  */
 int menu_redraw(struct Menu *menu)
 {
+  PERF_SCOPE("menu_redraw");
+  TRACE_SCOPE("ui", "menu_redraw", NULL);
+
   if (menu->custom_redraw)
   {
     menu->custom_redraw(menu);
@@ -1310,6 +1388,8 @@ int menu_redraw(struct Menu *menu)
     menu_redraw_status(menu);
   if (menu->redraw & REDRAW_INDEX)
     menu_redraw_index(menu);
+  else if (menu->redraw & REDRAW_SCROLL)
+    menu_redraw_scroll(menu);
   else if (menu->redraw & (REDRAW_MOTION | REDRAW_MOTION_RESYNC))
     menu_redraw_motion(menu);
   else if (menu->redraw == REDRAW_CURRENT)
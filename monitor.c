@@ -50,18 +50,44 @@
 
 bool MonitorFilesChanged = false;
 bool MonitorContextChanged = false;
+bool MonitorSocketsRead = false;
 
 static int INotifyFd = -1;
-static struct Monitor *Monitor = NULL;
+static struct HashTable *MonitorByDesc = NULL; ///< Watch descriptor -> Monitor
+static struct HashTable *MonitorByFile = NULL; ///< "device:inode" of the watched file -> Monitor
+static size_t MonitorCount = 0;                ///< Number of Monitors
+static bool MonitorWatchLimit = false;         ///< The inotify watch limit has been reported
 static size_t PollFdsCount = 0;
 static size_t PollFdsLen = 0;
 static struct pollfd *PollFds = NULL;
 
 static int MonitorContextDescriptor = -1;
+static int MonitorContextCurDescriptor = -1; ///< Watch on the current Maildir's 'cur' directory
 
-#define INOTIFY_MASK_DIR (IN_MOVED_TO | IN_ATTRIB | IN_CLOSE_WRITE | IN_ISDIR)
+/**
+ * struct MonitorFd - A socket that's watched while waiting for a key
+ */
+struct MonitorFd
+{
+  int fd;          ///< File descriptor
+  monitor_fd_t cb; ///< Function to read the data
+  void *data;      ///< Private data passed to the callback
+};
+ARRAY_HEAD(MonitorFdArray, struct MonitorFd);
+
+static struct MonitorFdArray MonitorFds = ARRAY_HEAD_INITIALIZER; ///< Sockets watched by mutt_monitor_poll()
+
+static struct MonitorEventArray ContextEvents = ARRAY_HEAD_INITIALIZER; ///< File changes in the current mailbox
+static bool ContextEventsRecording = false; ///< File changes are being recorded for the current mailbox
+static bool ContextEventsComplete = false;  ///< No file changes have been missed since they were last taken
+static bool MonitorFilesPending = false; ///< Changes to other mailboxes were read outside mutt_monitor_poll()
+
+#define INOTIFY_MASK_DIR                                                       \
+  (IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB | IN_CLOSE_WRITE | IN_ISDIR)
 #define INOTIFY_MASK_FILE IN_CLOSE_WRITE
 
+#define MONITOR_MAX_EVENTS 1000 ///< Beyond this many changes, a full rescan is cheaper
+
 #define EVENT_BUFLEN MAX(4096, sizeof(struct inotify_event) + NAME_MAX + 1)
 
 /**
@@ -81,7 +107,6 @@ enum ResolveResult
  */
 struct Monitor
 {
-  struct Monitor *next;
   char *mh_backup_path;
   dev_t st_dev;
   ino_t st_ino;
@@ -189,13 +214,164 @@ static int monitor_init(void)
  */
 static void monitor_check_free(void)
 {
-  if (!Monitor && (INotifyFd != -1))
+  if ((MonitorCount == 0) && (INotifyFd != -1))
   {
+    mutt_hash_free(&MonitorByDesc);
+    mutt_hash_free(&MonitorByFile);
     mutt_poll_fd_remove(INotifyFd);
     close(INotifyFd);
     INotifyFd = -1;
     MonitorFilesChanged = false;
+    MonitorFilesPending = false;
+    MonitorContextCurDescriptor = -1;
+    ContextEventsRecording = false;
+    ContextEventsComplete = false;
+    mutt_monitor_events_free(&ContextEvents);
+  }
+}
+
+/**
+ * mutt_monitor_events_free - Free an array of file changes
+ * @param events Array to free
+ */
+void mutt_monitor_events_free(struct MonitorEventArray *events)
+{
+  if (!events)
+    return;
+
+  struct MonitorEvent *ev = NULL;
+  ARRAY_FOREACH(ev, events)
+  {
+    FREE(&ev->name);
+  }
+  ARRAY_FREE(events);
+}
+
+/**
+ * monitor_events_stop - Stop recording the file changes in the current mailbox
+ */
+static void monitor_events_stop(void)
+{
+  if ((MonitorContextCurDescriptor != -1) && (INotifyFd != -1))
+  {
+    inotify_rm_watch(INotifyFd, MonitorContextCurDescriptor);
+    mutt_debug(LL_DEBUG3, "inotify_rm_watch descriptor=%d\n", MonitorContextCurDescriptor);
+  }
+
+  MonitorContextCurDescriptor = -1;
+  ContextEventsRecording = false;
+  ContextEventsComplete = false;
+  mutt_monitor_events_free(&ContextEvents);
+}
+
+/**
+ * monitor_events_start - Start recording the file changes in the current mailbox
+ *
+ * Only Maildir is supported.  The 'new' directory is already watched by the
+ * mailbox's monitor; this adds a watch for 'cur'.
+ */
+static void monitor_events_start(void)
+{
+  monitor_events_stop();
+
+  struct Mailbox *m = ctx_mailbox(Context);
+  if (!m || (m->type != MUTT_MAILDIR) || (INotifyFd == -1) ||
+      (MonitorContextDescriptor == -1))
+  {
+    return;
+  }
+
+  struct Buffer *path = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s/cur", m->realpath);
+  MonitorContextCurDescriptor =
+      inotify_add_watch(INotifyFd, mutt_buffer_string(path), INOTIFY_MASK_DIR);
+  if (MonitorContextCurDescriptor == -1)
+  {
+    mutt_debug(LL_DEBUG2, "inotify_add_watch failed for '%s', errno=%d %s\n",
+               mutt_buffer_string(path), errno, strerror(errno));
+  }
+  else
+  {
+    mutt_debug(LL_DEBUG3, "inotify_add_watch descriptor=%d for '%s'\n",
+               MonitorContextCurDescriptor, mutt_buffer_string(path));
+    ContextEventsRecording = true;
+  }
+  mutt_buffer_pool_release(&path);
+}
+
+/**
+ * monitor_record_event - Remember a file change in the current mailbox
+ * @param event inotify event
+ * @param dir   Watched subdirectory, e.g. "new"
+ */
+static void monitor_record_event(const struct inotify_event *event, const char *dir)
+{
+  if (!ContextEventsRecording || !ContextEventsComplete)
+    return;
+
+  if ((event->len == 0) || (event->mask & IN_ISDIR) || (event->name[0] == '.'))
+    return;
+
+  struct MonitorEvent ev = { 0 };
+  if (event->mask & (IN_CREATE | IN_MOVED_TO))
+    ev.added = true;
+  else if (!(event->mask & (IN_DELETE | IN_MOVED_FROM)))
+    return;
+
+  if (ARRAY_SIZE(&ContextEvents) >= MONITOR_MAX_EVENTS)
+  {
+    mutt_debug(LL_DEBUG3, "too many file changes, a rescan is needed\n");
+    ContextEventsComplete = false;
+    mutt_monitor_events_free(&ContextEvents);
+    return;
   }
+
+  ev.name = mutt_str_dup(event->name);
+  ev.dir = dir;
+  ARRAY_ADD(&ContextEvents, ev);
+}
+
+/**
+ * monitor_file_key - Create the lookup key for a watched file
+ * @param st_dev Device of the file
+ * @param st_ino Inode of the file
+ * @param buf    Buffer for the key
+ * @param buflen Length of the buffer
+ */
+static void monitor_file_key(dev_t st_dev, ino_t st_ino, char *buf, size_t buflen)
+{
+  snprintf(buf, buflen, "%llu:%llu", (unsigned long long) st_dev,
+           (unsigned long long) st_ino);
+}
+
+/**
+ * monitor_index - Add a Monitor to the lookup tables
+ * @param monitor Monitor to add
+ */
+static void monitor_index(struct Monitor *monitor)
+{
+  if (!MonitorByDesc)
+  {
+    MonitorByDesc = mutt_hash_int_new(64, MUTT_HASH_NO_FLAGS);
+    MonitorByFile = mutt_hash_new(64, MUTT_HASH_STRDUP_KEYS);
+  }
+
+  char key[64];
+  monitor_file_key(monitor->st_dev, monitor->st_ino, key, sizeof(key));
+  mutt_hash_int_insert(MonitorByDesc, monitor->desc, monitor);
+  mutt_hash_insert(MonitorByFile, key, monitor);
+}
+
+/**
+ * monitor_unindex - Remove a Monitor from the lookup tables
+ * @param monitor Monitor to remove
+ */
+static void monitor_unindex(struct Monitor *monitor)
+{
+  char key[64];
+  monitor_file_key(monitor->st_dev, monitor->st_ino, key, sizeof(key));
+  mutt_hash_int_delete(MonitorByDesc, monitor->desc, monitor);
+  mutt_hash_delete(MonitorByFile, key, monitor);
 }
 
 /**
@@ -211,11 +387,11 @@ static struct Monitor *monitor_new(struct MonitorInfo *info, int descriptor)
   monitor->st_dev = info->st_dev;
   monitor->st_ino = info->st_ino;
   monitor->desc = descriptor;
-  monitor->next = Monitor;
   if (info->type == MUTT_MH)
     monitor->mh_backup_path = mutt_str_dup(info->path);
 
-  Monitor = monitor;
+  monitor_index(monitor);
+  MonitorCount++;
 
   return monitor;
 }
@@ -247,21 +423,40 @@ static void monitor_delete(struct Monitor *monitor)
   if (!monitor)
     return;
 
-  struct Monitor **ptr = &Monitor;
+  monitor_unindex(monitor);
+  MonitorCount--;
+
+  FREE(&monitor->mh_backup_path);
+  FREE(&monitor);
+}
 
-  while (true)
+/**
+ * monitor_add_watch - Add an inotify watch
+ * @param path File to watch
+ * @param mask Events to watch for, e.g. #INOTIFY_MASK_DIR
+ * @retval >=0 Watch descriptor
+ * @retval  -1 Error
+ */
+static int monitor_add_watch(const char *path, uint32_t mask)
+{
+  int desc = inotify_add_watch(INotifyFd, path, mask);
+  if (desc != -1)
   {
-    if (!*ptr)
-      return;
-    if (*ptr == monitor)
-      break;
-    ptr = &(*ptr)->next;
+    mutt_debug(LL_DEBUG3, "inotify_add_watch descriptor=%d for '%s'\n", desc, path);
+    return desc;
   }
 
-  FREE(&monitor->mh_backup_path);
-  monitor = monitor->next;
-  FREE(ptr);
-  *ptr = monitor;
+  if ((errno == ENOSPC) && !MonitorWatchLimit)
+  {
+    /* Only say this once; every further mailbox would fail the same way */
+    mutt_debug(LL_DEBUG1, "inotify watch limit reached after %zu watches, "
+                          "see /proc/sys/fs/inotify/max_user_watches\n",
+               MonitorCount);
+    MonitorWatchLimit = true;
+  }
+  mutt_debug(LL_DEBUG2, "inotify_add_watch failed for '%s', errno=%d %s\n",
+             path, errno, strerror(errno));
+  return -1;
 }
 
 /**
@@ -273,29 +468,24 @@ static void monitor_delete(struct Monitor *monitor)
 static int monitor_handle_ignore(int desc)
 {
   int new_desc = -1;
-  struct Monitor *iter = Monitor;
+  struct Monitor *iter = NULL;
   struct stat sb;
 
-  while (iter && (iter->desc != desc))
-    iter = iter->next;
+  if (MonitorByDesc)
+    iter = mutt_hash_int_find(MonitorByDesc, desc);
 
   if (iter)
   {
     if ((iter->type == MUTT_MH) && (stat(iter->mh_backup_path, &sb) == 0))
     {
-      new_desc = inotify_add_watch(INotifyFd, iter->mh_backup_path, INOTIFY_MASK_FILE);
-      if (new_desc == -1)
-      {
-        mutt_debug(LL_DEBUG2, "inotify_add_watch failed for '%s', errno=%d %s\n",
-                   iter->mh_backup_path, errno, strerror(errno));
-      }
-      else
+      new_desc = monitor_add_watch(iter->mh_backup_path, INOTIFY_MASK_FILE);
+      if (new_desc != -1)
       {
-        mutt_debug(LL_DEBUG3, "inotify_add_watch descriptor=%d for '%s'\n",
-                   desc, iter->mh_backup_path);
+        monitor_unindex(iter);
         iter->st_dev = sb.st_dev;
         iter->st_ino = sb.st_ino;
         iter->desc = new_desc;
+        monitor_index(iter);
       }
     }
     else
@@ -371,9 +561,13 @@ static enum ResolveResult monitor_resolve(struct MonitorInfo *info, struct Mailb
   if (stat(info->path, &sb) != 0)
     return RESOLVE_RES_FAIL_STAT;
 
-  struct Monitor *iter = Monitor;
-  while (iter && ((iter->st_ino != sb.st_ino) || (iter->st_dev != sb.st_dev)))
-    iter = iter->next;
+  struct Monitor *iter = NULL;
+  if (MonitorByFile)
+  {
+    char key[64];
+    monitor_file_key(sb.st_dev, sb.st_ino, key, sizeof(key));
+    iter = mutt_hash_find(MonitorByFile, key);
+  }
 
   info->st_dev = sb.st_dev;
   info->st_ino = sb.st_ino;
@@ -382,30 +576,228 @@ static enum ResolveResult monitor_resolve(struct MonitorInfo *info, struct Mailb
   return iter ? RESOLVE_RES_OK_EXISTING : RESOLVE_RES_OK_NOTEXISTING;
 }
 
+/**
+ * monitor_read_events - Read all the pending inotify events
+ */
+static void monitor_read_events(void)
+{
+  char buf[EVENT_BUFLEN] __attribute__((aligned(__alignof__(struct inotify_event))));
+  const struct inotify_event *event = NULL;
+
+  while (INotifyFd != -1)
+  {
+    int len = read(INotifyFd, buf, sizeof(buf));
+    if (len == -1)
+    {
+      if (errno != EAGAIN)
+      {
+        mutt_debug(LL_DEBUG2, "read inotify events failed, errno=%d %s\n",
+                   errno, strerror(errno));
+      }
+      break;
+    }
+
+    for (char *ptr = buf; ptr < (buf + len);
+         ptr += sizeof(struct inotify_event) + event->len)
+    {
+      event = (const struct inotify_event *) ptr;
+      mutt_debug(LL_DEBUG3, "+ detail: descriptor=%d mask=0x%x\n", event->wd, event->mask);
+      if (event->mask & IN_Q_OVERFLOW)
+      {
+        ContextEventsComplete = false;
+        mutt_monitor_events_free(&ContextEvents);
+        MonitorContextChanged = true;
+      }
+      else if (event->mask & IN_IGNORED)
+      {
+        if (event->wd == MonitorContextCurDescriptor)
+        {
+          MonitorContextCurDescriptor = -1;
+          monitor_events_stop();
+        }
+        else
+        {
+          monitor_handle_ignore(event->wd);
+          if (MonitorContextDescriptor == -1)
+            monitor_events_stop();
+          MonitorFilesPending = true;
+        }
+      }
+      else if (event->wd == MonitorContextDescriptor)
+      {
+        MonitorContextChanged = true;
+        monitor_record_event(event, "new");
+      }
+      else if (event->wd == MonitorContextCurDescriptor)
+      {
+        MonitorContextChanged = true;
+        monitor_record_event(event, "cur");
+      }
+      else
+      {
+        /* Another mailbox has changed */
+        MonitorFilesPending = true;
+      }
+    }
+  }
+}
+
+/**
+ * mutt_monitor_take_events - Collect the file changes in the current mailbox
+ * @param[in]  m      Mailbox
+ * @param[out] events Array for the changes
+ * @retval true  events holds every change since the previous call
+ * @retval false Changes may have been missed; the caller must rescan the mailbox
+ *
+ * File changes are only recorded for the current Maildir mailbox.  The first
+ * call after it's opened returns false, so that the caller's rescan covers any
+ * changes made before the watches were set up.
+ *
+ * The caller must free events with mutt_monitor_events_free().
+ */
+bool mutt_monitor_take_events(struct Mailbox *m, struct MonitorEventArray *events)
+{
+  if (!events)
+    return false;
+
+  ARRAY_INIT(events);
+  if (!m || !ContextEventsRecording || (m != ctx_mailbox(Context)))
+    return false;
+
+  monitor_read_events();
+
+  bool complete = ContextEventsRecording && ContextEventsComplete;
+  if (complete)
+  {
+    *events = ContextEvents;
+    ARRAY_INIT(&ContextEvents);
+  }
+  else
+  {
+    mutt_monitor_events_free(&ContextEvents);
+  }
+
+  /* The caller has been told to catch up, so record from now on */
+  ContextEventsComplete = ContextEventsRecording;
+  return complete;
+}
+
+/**
+ * monitor_fd_read - Let the owner of a socket read its data
+ * @param fd Socket that's ready
+ *
+ * If the callback can't read the data, the socket is removed from the list.
+ */
+static void monitor_fd_read(int fd)
+{
+  struct MonitorFd *mfd = NULL;
+  ARRAY_FOREACH(mfd, &MonitorFds)
+  {
+    if (mfd->fd != fd)
+      continue;
+
+    if (!mfd->cb(fd, mfd->data))
+    {
+      mutt_debug(LL_DEBUG3, "stop watching socket %d\n", fd);
+      mutt_monitor_fd_remove(fd);
+    }
+    return;
+  }
+}
+
+/**
+ * mutt_monitor_fd_add - Watch a socket while waiting for a key
+ * @param fd   Socket to watch
+ * @param cb   Function to read the data
+ * @param data Private data passed to the callback
+ *
+ * When data arrives, the callback is called and the wait for a key ends, as if
+ * it had timed out, so that the screen can be updated.
+ *
+ * Adding a socket that's already watched replaces its callback.
+ */
+void mutt_monitor_fd_add(int fd, monitor_fd_t cb, void *data)
+{
+  if ((fd < 0) || !cb)
+    return;
+
+  struct MonitorFd *mfd = NULL;
+  ARRAY_FOREACH(mfd, &MonitorFds)
+  {
+    if (mfd->fd == fd)
+    {
+      mfd->cb = cb;
+      mfd->data = data;
+      return;
+    }
+  }
+
+  struct MonitorFd new_mfd = { fd, cb, data };
+  ARRAY_ADD(&MonitorFds, new_mfd);
+  mutt_poll_fd_add(0, POLLIN);
+  mutt_poll_fd_add(fd, POLLIN);
+}
+
+/**
+ * mutt_monitor_fd_remove - Stop watching a socket
+ * @param fd Socket to forget
+ *
+ * This must be called before the socket is closed.
+ */
+void mutt_monitor_fd_remove(int fd)
+{
+  struct MonitorFd *mfd = NULL;
+  ARRAY_FOREACH(mfd, &MonitorFds)
+  {
+    if (mfd->fd != fd)
+      continue;
+
+    ARRAY_REMOVE(&MonitorFds, mfd);
+    mutt_poll_fd_remove(fd);
+    break;
+  }
+
+  if (ARRAY_EMPTY(&MonitorFds))
+  {
+    ARRAY_FREE(&MonitorFds);
+    if (INotifyFd == -1)
+      mutt_poll_fd_remove(0);
+  }
+}
+
 /**
  * mutt_monitor_poll - Check for filesystem changes
  * @retval -3 unknown/unexpected events: poll timeout / fds not handled by us
- * @retval -2 monitor detected changes, no STDIN input
+ * @retval -2 monitor detected changes, or a socket was read, no STDIN input
  * @retval -1 error (see errno)
  * @retval  0 (1) input ready from STDIN, or (2) monitoring inactive -> no poll()
  *
  * Wait for I/O ready file descriptors or signals.
  *
  * MonitorFilesChanged also reflects changes to monitored files.
+ * MonitorSocketsRead is set if a watched socket has been read.
  *
- * Only STDIN and INotify file handles currently expected/supported.
- * More would ask for common infrastructure (sockets?).
+ * As well as STDIN and INotify, any sockets added by mutt_monitor_fd_add() are
+ * watched.  Their data is read by their callbacks.
  */
 int mutt_monitor_poll(void)
 {
   int rc = 0;
-  char buf[EVENT_BUFLEN] __attribute__((aligned(__alignof__(struct inotify_event))));
 
   MonitorFilesChanged = false;
+  MonitorSocketsRead = false;
 
-  if (INotifyFd != -1)
+  /* mutt_monitor_take_events() read some changes that nobody has seen yet */
+  if (MonitorFilesPending)
+  {
+    MonitorFilesPending = false;
+    MonitorFilesChanged = true;
+    return -2;
+  }
+
+  if ((INotifyFd != -1) || !ARRAY_EMPTY(&MonitorFds))
   {
-    int fds = poll(PollFds, PollFdsLen, MuttGetchTimeout);
+    int fds = poll(PollFds, PollFdsCount, MuttGetchTimeout);
 
     if (fds == -1)
     {
@@ -431,39 +823,22 @@ int mutt_monitor_poll(void)
           {
             MonitorFilesChanged = true;
             mutt_debug(LL_DEBUG3, "file change(s) detected\n");
-            char *ptr = buf;
-            const struct inotify_event *event = NULL;
-
-            while (true)
-            {
-              int len = read(INotifyFd, buf, sizeof(buf));
-              if (len == -1)
-              {
-                if (errno != EAGAIN)
-                {
-                  mutt_debug(LL_DEBUG2, "read inotify events failed, errno=%d %s\n",
-                             errno, strerror(errno));
-                }
-                break;
-              }
-
-              while (ptr < (buf + len))
-              {
-                event = (const struct inotify_event *) ptr;
-                mutt_debug(LL_DEBUG3, "+ detail: descriptor=%d mask=0x%x\n",
-                           event->wd, event->mask);
-                if (event->mask & IN_IGNORED)
-                  monitor_handle_ignore(event->wd);
-                else if (event->wd == MonitorContextDescriptor)
-                  MonitorContextChanged = true;
-                ptr += sizeof(struct inotify_event) + event->len;
-              }
-            }
+            monitor_read_events();
+            MonitorFilesPending = false;
+          }
+          else
+          {
+            /* The callback may remove the socket from the list */
+            const int fd = PollFds[i].fd;
+            MonitorSocketsRead = true;
+            monitor_fd_read(fd);
+            if ((i >= PollFdsCount) || (PollFds[i].fd != fd))
+              i--;
           }
         }
       }
       if (!input_ready)
-        rc = MonitorFilesChanged ? -2 : -3;
+        rc = (MonitorFilesChanged || MonitorSocketsRead) ? -2 : -3;
     }
   }
 
@@ -488,26 +863,29 @@ int mutt_monitor_add(struct Mailbox *m)
   if (desc != RESOLVE_RES_OK_NOTEXISTING)
   {
     if (!m && (desc == RESOLVE_RES_OK_EXISTING))
+    {
       MonitorContextDescriptor = info.monitor->desc;
+      monitor_events_start();
+    }
     rc = (desc == RESOLVE_RES_OK_EXISTING) ? 0 : -1;
     goto cleanup;
   }
 
   uint32_t mask = info.is_dir ? INOTIFY_MASK_DIR : INOTIFY_MASK_FILE;
   if (((INotifyFd == -1) && (monitor_init() == -1)) ||
-      ((desc = inotify_add_watch(INotifyFd, info.path, mask)) == -1))
+      ((desc = monitor_add_watch(info.path, mask)) == -1))
   {
-    mutt_debug(LL_DEBUG2, "inotify_add_watch failed for '%s', errno=%d %s\n",
-               info.path, errno, strerror(errno));
     rc = -1;
     goto cleanup;
   }
 
-  mutt_debug(LL_DEBUG3, "inotify_add_watch descriptor=%d for '%s'\n", desc, info.path);
+  monitor_new(&info, desc);
+
   if (!m)
+  {
     MonitorContextDescriptor = desc;
-
-  monitor_new(&info, desc);
+    monitor_events_start();
+  }
 
 cleanup:
   monitor_info_free(&info);
@@ -533,6 +911,7 @@ int mutt_monitor_remove(struct Mailbox *m)
 
   if (!m)
   {
+    monitor_events_stop();
     MonitorContextDescriptor = -1;
     MonitorContextChanged = false;
   }
@@ -565,7 +944,7 @@ int mutt_monitor_remove(struct Mailbox *m)
     }
   }
 
-  inotify_rm_watch(info.monitor->desc, INotifyFd);
+  inotify_rm_watch(INotifyFd, info.monitor->desc);
   mutt_debug(LL_DEBUG3, "inotify_rm_watch for '%s' descriptor=%d\n", info.path,
              info.monitor->desc);
 
@@ -24,14 +24,40 @@
 #define MUTT_MONITOR_H
 
 #include <stdbool.h>
+#include "mutt/lib.h"
 
 struct Mailbox;
 
+/**
+ * struct MonitorEvent - A file that appeared in, or vanished from, the current mailbox
+ */
+struct MonitorEvent
+{
+  char *name;      ///< Filename, relative to dir
+  const char *dir; ///< Watched subdirectory, e.g. "new" or "cur"
+  bool added;      ///< true if the file appeared, false if it vanished
+};
+ARRAY_HEAD(MonitorEventArray, struct MonitorEvent);
+
+/**
+ * typedef monitor_fd_t - Prototype for reading a watched socket
+ * @param fd   Socket that's ready
+ * @param data Private data passed to mutt_monitor_fd_add()
+ * @retval true  The data was read
+ * @retval false The data can't be read now, stop watching the socket
+ */
+typedef bool (*monitor_fd_t)(int fd, void *data);
+
 extern bool MonitorFilesChanged;   ///< true after a monitored file has changed
 extern bool MonitorContextChanged; ///< true after the current mailbox has changed
+extern bool MonitorSocketsRead;    ///< true after a watched socket has been read
 
 int mutt_monitor_add(struct Mailbox *m);
 int mutt_monitor_remove(struct Mailbox *m);
 int mutt_monitor_poll(void);
+void mutt_monitor_fd_add(int fd, monitor_fd_t cb, void *data);
+void mutt_monitor_fd_remove(int fd);
+bool mutt_monitor_take_events(struct Mailbox *m, struct MonitorEventArray *events);
+void mutt_monitor_events_free(struct MonitorEventArray *events);
 
 #endif /* MUTT_MONITOR_H */
@@ -38,6 +38,7 @@
 #include "string2.h"
 
 #define BAD -1
+#define B64_PAD -2
 
 /**
  * B64Chars - Characters of the Base64 encoding
@@ -72,6 +73,33 @@ const int Index64[128] = {
 };
 // clang-format on
 
+// clang-format off
+/**
+ * B64Decode - Lookup table for decoding a stream of Base64 characters
+ *
+ * Every byte has an entry, so the input doesn't need a range check.
+ * Values: 0-63 for the encoding characters, B64_PAD for '=', BAD otherwise.
+ */
+static const signed char B64Decode[256] = {
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,62, -1,-1,-1,63,
+    52,53,54,55, 56,57,58,59, 60,61,-1,-1, -1,-2,-1,-1,
+    -1, 0, 1, 2,  3, 4, 5, 6,  7, 8, 9,10, 11,12,13,14,
+    15,16,17,18, 19,20,21,22, 23,24,25,-1, -1,-1,-1,-1,
+    -1,26,27,28, 29,30,31,32, 33,34,35,36, 37,38,39,40,
+    41,42,43,44, 45,46,47,48, 49,50,51,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,
+    -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1
+};
+// clang-format on
+
 /**
  * mutt_b64_encode - Convert raw bytes to null-terminated base64 string
  * @param in     Input buffer for the raw bytes
@@ -181,6 +209,97 @@ int mutt_b64_decode(const char *in, char *out, size_t olen)
   return len;
 }
 
+/**
+ * mutt_b64_decode_stream - Decode a block of a Base64 stream
+ * @param bs    State of the decoder, initialised to zero
+ * @param in    Base64 text
+ * @param inlen Length of the text
+ * @param out   Buffer for the raw bytes, at least (inlen * 3 / 4) + 3 bytes
+ * @retval num Number of bytes written to the output buffer
+ *
+ * The text may be split anywhere, e.g. into the blocks read from a file.
+ * Characters outside the Base64 alphabet, such as line breaks, are ignored, as
+ * RFC2045 requires.  The stream ends at the first '=' and any text after it is
+ * ignored.
+ *
+ * Groups of four characters are decoded without checking the state, so a
+ * well-formed stream is decoded a line at a time.
+ */
+size_t mutt_b64_decode_stream(struct B64Stream *bs, const char *in, size_t inlen, char *out)
+{
+  if (!bs || !in || !out)
+    return 0;
+
+  const unsigned char *p = (const unsigned char *) in;
+  const unsigned char *end = p + inlen;
+  unsigned int bits = bs->bits;
+  int num = bs->num;
+  char *o = out;
+
+  while (!bs->done && (p < end))
+  {
+    if (num == 0)
+    {
+      /* Fast path: four characters of the alphabet in a row */
+      while ((end - p) >= 4)
+      {
+        const int c1 = B64Decode[p[0]];
+        const int c2 = B64Decode[p[1]];
+        const int c3 = B64Decode[p[2]];
+        const int c4 = B64Decode[p[3]];
+        if ((c1 | c2 | c3 | c4) < 0)
+          break;
+
+        const unsigned int v = (c1 << 18) | (c2 << 12) | (c3 << 6) | c4;
+        o[0] = v >> 16;
+        o[1] = v >> 8;
+        o[2] = v;
+        o += 3;
+        p += 4;
+      }
+      if (p == end)
+        break;
+    }
+
+    const int c = B64Decode[*p++];
+    if (c == BAD)
+      continue;
+
+    if (c == B64_PAD)
+    {
+      /* Keep the complete bytes of the last group */
+      if (num == 2)
+      {
+        *o++ = bits >> 4;
+      }
+      else if (num == 3)
+      {
+        *o++ = bits >> 10;
+        *o++ = bits >> 2;
+      }
+      bits = 0;
+      num = 0;
+      bs->done = true;
+      break;
+    }
+
+    bits = (bits << 6) | c;
+    if (++num == 4)
+    {
+      o[0] = bits >> 16;
+      o[1] = bits >> 8;
+      o[2] = bits;
+      o += 3;
+      bits = 0;
+      num = 0;
+    }
+  }
+
+  bs->bits = bits;
+  bs->num = num;
+  return o - out;
+}
+
 /**
  * mutt_b64_buffer_encode - Convert raw bytes to null-terminated base64 string
  * @param buf    Buffer for the result
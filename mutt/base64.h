@@ -21,16 +21,30 @@
 #ifndef MUTT_LIB_BASE64_H
 #define MUTT_LIB_BASE64_H
 
+#include <stdbool.h>
 #include <stdio.h>
 
 struct Buffer;
 
+/**
+ * struct B64Stream - State of a Base64 decoder
+ *
+ * @sa mutt_b64_decode_stream()
+ */
+struct B64Stream
+{
+  unsigned int bits; ///< Sextets of an incomplete group
+  int num;           ///< Number of sextets in the group
+  bool done;         ///< Padding has been seen
+};
+
 extern const int Index64[];
 
 #define base64val(ch) Index64[(unsigned int) (ch)]
 
 int    mutt_b64_decode(const char *in, char *out, size_t olen);
 size_t mutt_b64_encode(const char *in, size_t inlen, char *out, size_t outlen);
+size_t mutt_b64_decode_stream(struct B64Stream *bs, const char *in, size_t inlen, char *out);
 
 int    mutt_b64_buffer_decode(struct Buffer *buf, const char *in);
 size_t mutt_b64_buffer_encode(struct Buffer *buf, const char *in, size_t len);
@@ -77,6 +77,24 @@ TAILQ_HEAD(LookupList, Lookup);
 
 static struct LookupList Lookups = TAILQ_HEAD_INITIALIZER(Lookups);
 
+/// Number of iconv handles to keep open
+#define ICONV_CACHE_SIZE 16
+
+/**
+ * struct IconvCacheEntry - An open iconv handle
+ */
+struct IconvCacheEntry
+{
+  char *tocode;   ///< Destination character set, as passed to iconv_open()
+  char *fromcode; ///< Source character set, as passed to iconv_open()
+  iconv_t cd;     ///< iconv handle
+};
+
+/// Open iconv handles, most recently used first
+static struct IconvCacheEntry IconvCache[ICONV_CACHE_SIZE];
+/// Number of entries in #IconvCache
+static int IconvCacheUsed = 0;
+
 /**
  * struct MimeNames - MIME name lookup entry
  */
@@ -565,6 +583,10 @@ const char *mutt_ch_charset_lookup(const char *chs)
  *
  * @note The top-well-named MUTT_ICONV_HOOK_FROM acts on charset-hooks,
  * not at all on iconv-hooks.
+ *
+ * @note The handle belongs to a cache of the most recently used conversions,
+ * so the caller must not close it.  It stays open until ICONV_CACHE_SIZE other
+ * conversions have been opened, or mutt_ch_cache_cleanup() is called.
  */
 iconv_t mutt_ch_iconv_open(const char *tocode, const char *fromcode, uint8_t flags)
 {
@@ -595,12 +617,59 @@ iconv_t mutt_ch_iconv_open(const char *tocode, const char *fromcode, uint8_t fla
   fromcode2 = mutt_ch_iconv_lookup(fromcode1);
   fromcode2 = fromcode2 ? fromcode2 : fromcode1;
 
+  /* look for an open handle, and move it to the front */
+  for (int i = 0; i < IconvCacheUsed; i++)
+  {
+    if (mutt_str_equal(IconvCache[i].tocode, tocode2) &&
+        mutt_str_equal(IconvCache[i].fromcode, fromcode2))
+    {
+      struct IconvCacheEntry ice = IconvCache[i];
+      memmove(&IconvCache[1], &IconvCache[0], i * sizeof(struct IconvCacheEntry));
+      IconvCache[0] = ice;
+
+      /* return to the initial state */
+      iconv(ice.cd, NULL, NULL, NULL, NULL);
+      return ice.cd;
+    }
+  }
+
   /* call system iconv with names it appreciates */
   cd = iconv_open(tocode2, fromcode2);
-  if (cd != (iconv_t) -1)
-    return cd;
+  if (cd == (iconv_t) -1)
+    return (iconv_t) -1;
+
+  /* forget the least recently used handle */
+  if (IconvCacheUsed == ICONV_CACHE_SIZE)
+  {
+    struct IconvCacheEntry *ice = &IconvCache[--IconvCacheUsed];
+    iconv_close(ice->cd);
+    FREE(&ice->tocode);
+    FREE(&ice->fromcode);
+  }
 
-  return (iconv_t) -1;
+  memmove(&IconvCache[1], &IconvCache[0], IconvCacheUsed * sizeof(struct IconvCacheEntry));
+  IconvCache[0].tocode = mutt_str_dup(tocode2);
+  IconvCache[0].fromcode = mutt_str_dup(fromcode2);
+  IconvCache[0].cd = cd;
+  IconvCacheUsed++;
+
+  return cd;
+}
+
+/**
+ * mutt_ch_cache_cleanup - Close the cached iconv handles
+ *
+ * None of the handles returned by mutt_ch_iconv_open() may be used after this.
+ */
+void mutt_ch_cache_cleanup(void)
+{
+  for (int i = 0; i < IconvCacheUsed; i++)
+  {
+    iconv_close(IconvCache[i].cd);
+    FREE(&IconvCache[i].tocode);
+    FREE(&IconvCache[i].fromcode);
+  }
+  IconvCacheUsed = 0;
 }
 
 /**
@@ -738,10 +807,99 @@ int mutt_ch_check(const char *s, size_t slen, const char *from, const char *to)
     rc = errno;
 
   FREE(&saved_out);
-  iconv_close(cd);
   return rc;
 }
 
+/**
+ * utf8_valid - Is a string valid UTF-8?
+ * @param str String to check
+ * @retval true The string is valid UTF-8, or plain ASCII
+ *
+ * Overlong forms, surrogates and characters above U+10FFFF are rejected.
+ */
+static bool utf8_valid(const char *str)
+{
+  const unsigned char *s = (const unsigned char *) str;
+
+  while (*s)
+  {
+    if (*s < 0x80)
+    {
+      s++;
+      continue;
+    }
+
+    int len;
+    unsigned int min;
+    unsigned int ch;
+    if ((*s & 0xe0) == 0xc0)
+    {
+      len = 2;
+      min = 0x80;
+      ch = *s & 0x1f;
+    }
+    else if ((*s & 0xf0) == 0xe0)
+    {
+      len = 3;
+      min = 0x800;
+      ch = *s & 0x0f;
+    }
+    else if ((*s & 0xf8) == 0xf0)
+    {
+      len = 4;
+      min = 0x10000;
+      ch = *s & 0x07;
+    }
+    else
+    {
+      return false;
+    }
+
+    for (int i = 1; i < len; i++)
+    {
+      if ((s[i] & 0xc0) != 0x80)
+        return false;
+      ch = (ch << 6) | (s[i] & 0x3f);
+    }
+
+    if ((ch < min) || (ch > 0x10ffff) || ((ch >= 0xd800) && (ch <= 0xdfff)))
+      return false;
+
+    s += len;
+  }
+
+  return true;
+}
+
+/**
+ * mutt_ch_convert_is_noop - Would converting a string leave it unchanged?
+ * @param str   String to convert
+ * @param from  Current character set
+ * @param to    Target character set
+ * @param flags Flags, e.g. #MUTT_ICONV_HOOK_FROM
+ * @retval true The string is already in the target character set
+ *
+ * Only conversions to UTF-8 are checked.  Plain ASCII is the same in ASCII,
+ * UTF-8 and ISO-8859-*.  Other text must be valid UTF-8, labelled as UTF-8.
+ * If a charset-hook would change the label, the string must be converted.
+ */
+bool mutt_ch_convert_is_noop(const char *str, const char *from, const char *to, uint8_t flags)
+{
+  if (!str || !from || !to || !mutt_ch_is_utf8(to))
+    return false;
+
+  char cs[128];
+  mutt_ch_canonical_charset(cs, sizeof(cs), from);
+  if ((flags & MUTT_ICONV_HOOK_FROM) && mutt_ch_charset_lookup(cs))
+    return false;
+
+  const bool utf8 = mutt_istr_equal(cs, "utf-8");
+  if (mutt_str_is_ascii(str, strlen(str)))
+    return utf8 || mutt_istr_equal(cs, "us-ascii") || mutt_istr_startswith(cs, "iso-8859-");
+
+  return utf8 && utf8_valid(str);
+}
+
 /**
  * mutt_ch_convert_string - Convert a string between encodings
  * @param[in,out] ps    String to convert
@@ -768,6 +926,10 @@ int mutt_ch_convert_string(char **ps, const char *from, const char *to, uint8_t
   if (!to || !from)
     return -1;
 
+  /* Nothing to do if the text is already in the target character set */
+  if (mutt_ch_convert_is_noop(s, from, to, flags))
+    return 0;
+
   const char *repls[] = { "\357\277\275", "?", 0 };
   int rc = 0;
 
@@ -797,7 +959,6 @@ int mutt_ch_convert_string(char **ps, const char *from, const char *to, uint8_t
   ob = buf;
 
   mutt_ch_iconv(cd, &ib, &ibl, &ob, &obl, inrepls, outrepl, &rc);
-  iconv_close(cd);
 
   *ob = '\0';
 
@@ -840,13 +1001,7 @@ bool mutt_ch_check_charset(const char *cs, bool strict)
   }
 
   iconv_t cd = mutt_ch_iconv_open(cs, cs, MUTT_ICONV_NO_FLAGS);
-  if (cd != (iconv_t)(-1))
-  {
-    iconv_close(cd);
-    return true;
-  }
-
-  return false;
+  return (cd != (iconv_t)(-1));
 }
 
 /**
@@ -894,8 +1049,6 @@ void mutt_ch_fgetconv_close(struct FgetConv **fc)
   if (!fc || !*fc)
     return;
 
-  if ((*fc)->cd != (iconv_t) -1)
-    iconv_close((*fc)->cd);
   FREE(fc);
 }
 
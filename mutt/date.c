@@ -431,6 +431,20 @@ uint64_t mutt_date_epoch_ms(void)
   return (uint64_t) tv.tv_sec * 1000 + tv.tv_usec / 1000;
 }
 
+/**
+ * mutt_date_monotonic_us - Return the time from a monotonic clock
+ * @retval us Microseconds since an arbitrary point
+ *
+ * Unlike mutt_date_epoch_ms(), the clock isn't affected by changes to the
+ * system time, so it's suitable for measuring intervals.
+ */
+uint64_t mutt_date_monotonic_us(void)
+{
+  struct timespec ts = { 0, 0 };
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
 /**
  * mutt_date_parse_date - Parse a date string in RFC822 format
  * @param[in]  s      String to parse
@@ -61,6 +61,7 @@ void      mutt_date_make_date(struct Buffer *buf);
 int       mutt_date_make_imap(char *buf, size_t buflen, time_t timestamp);
 time_t    mutt_date_make_time(struct tm *t, bool local);
 int       mutt_date_make_tls(char *buf, size_t buflen, time_t timestamp);
+uint64_t  mutt_date_monotonic_us(void);
 void      mutt_date_normalize_time(struct tm *tm);
 time_t    mutt_date_parse_date(const char *s, struct Tz *tz_out);
 time_t    mutt_date_parse_imap(const char *s);
@@ -29,16 +29,24 @@
 #include "config.h"
 #include <stdlib.h>
 #include "exit.h"
+#include "logging.h"
+#include "trace.h"
+#include "worker.h"
 
 /**
  * mutt_exit - Leave NeoMutt NOW
  *
  * Some library routines want to exit immediately on error.
  * By having this in the library, mutt_exit() can be overridden.
+ * The worker threads are stopped first, so they aren't killed mid-task, and
+ * the trace and log files are written.
  *
  * @sa main.c
  */
 void mutt_exit(int code)
 {
+  mutt_worker_stop();
+  trace_close();
+  log_file_flush();
   exit(code);
 }
@@ -34,6 +34,7 @@
 #include <libgen.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -54,6 +55,14 @@
 #ifdef USE_FLOCK
 #include <sys/file.h>
 #endif
+#ifdef HAVE_LINUX_FS_H
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+#include <sys/sendfile.h>
+#define USE_SENDFILE
+#endif
 
 /* these characters must be escaped in regular expressions */
 static const char rx_special_chars[] = "^.[$()|*+?{\\";
@@ -63,6 +72,11 @@ const char filename_safe_chars[] =
 
 #define MAX_LOCK_ATTEMPTS 5
 
+/// Size of the buffer used to copy between files
+#define COPY_BUF_SIZE (64 * 1024)
+/// Copies smaller than this aren't worth giving to the kernel
+#define COPY_KERNEL_MIN (64 * 1024)
+
 /* This is defined in POSIX:2008 which isn't a build requirement */
 #ifndef O_NOFOLLOW
 #define O_NOFOLLOW 0
@@ -230,6 +244,161 @@ void mutt_file_unlink(const char *s)
   }
 }
 
+/**
+ * copy_kernel - Copy part of one file to another, letting the kernel do the work
+ * @param[in]  fp_in  Source file
+ * @param[in]  fp_out Destination file
+ * @param[in]  size   Maximum number of bytes to copy
+ * @param[out] copied Number of bytes copied
+ * @retval  0 Success
+ * @retval  1 Not possible, nothing was copied
+ * @retval -1 Error, see errno
+ *
+ * Both files must be regular files.  The data doesn't pass through userspace:
+ * copy_file_range() is used when possible, otherwise sendfile(), e.g. when the
+ * destination is opened for appending.
+ *
+ * Afterwards, both streams are positioned after the data that was copied.
+ */
+static int copy_kernel(FILE *fp_in, FILE *fp_out, size_t size, size_t *copied)
+{
+  *copied = 0;
+
+#if defined(HAVE_COPY_FILE_RANGE) || defined(USE_SENDFILE)
+  const int fd_in = fileno(fp_in);
+  const int fd_out = fileno(fp_out);
+  if ((fd_in < 0) || (fd_out < 0))
+    return 1;
+
+  struct stat st_in = { 0 };
+  struct stat st_out = { 0 };
+  if ((fstat(fd_in, &st_in) != 0) || (fstat(fd_out, &st_out) != 0) ||
+      !S_ISREG(st_in.st_mode) || !S_ISREG(st_out.st_mode) ||
+      ((st_in.st_dev == st_out.st_dev) && (st_in.st_ino == st_out.st_ino)))
+  {
+    return 1;
+  }
+
+  off_t off_in = ftello(fp_in);
+  if ((off_in < 0) || (off_in >= st_in.st_size))
+    return 1;
+
+  const size_t len = MIN(size, (size_t) (st_in.st_size - off_in));
+  if (len < COPY_KERNEL_MIN)
+    return 1;
+
+  /* Write anything stdio is holding, so that the file and stream agree */
+  if (fflush(fp_out) != 0)
+    return -1;
+  off_t off_out = ftello(fp_out);
+  if (off_out < 0)
+    return 1;
+
+  const int flags = fcntl(fd_out, F_GETFL);
+  bool use_range = (flags != -1) && !(flags & O_APPEND);
+#ifndef HAVE_COPY_FILE_RANGE
+  use_range = false;
+#endif
+  bool use_send = false;
+  int rc = 0;
+
+  while (*copied < len)
+  {
+    ssize_t num = -1;
+#ifdef HAVE_COPY_FILE_RANGE
+    if (use_range)
+    {
+      num = copy_file_range(fd_in, &off_in, fd_out, &off_out, len - *copied, 0);
+      /* e.g. Different filesystems, or an old kernel */
+      if ((num < 0) && (*copied == 0) &&
+          ((errno == EXDEV) || (errno == ENOSYS) || (errno == EOPNOTSUPP) ||
+           (errno == EINVAL) || (errno == EBADF)))
+      {
+        use_range = false;
+        continue;
+      }
+    }
+    else
+#endif
+    {
+#ifdef USE_SENDFILE
+      /* sendfile() writes at the file's offset, not the stream's */
+      if (!use_send && (lseek(fd_out, off_out, SEEK_SET) < 0))
+        return 1;
+      use_send = true;
+      num = sendfile(fd_out, fd_in, &off_in, len - *copied);
+      if ((num < 0) && (*copied == 0) && ((errno == EINVAL) || (errno == ENOSYS)))
+        return 1;
+#else
+      return 1;
+#endif
+    }
+
+    if (num < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      rc = -1;
+      break;
+    }
+    if (num == 0) /* The source was truncated */
+      break;
+    *copied += num;
+  }
+
+  /* The kernel moved the data; move the streams to match */
+  if (use_send)
+    off_out = lseek(fd_out, 0, SEEK_CUR);
+  const int err = errno;
+  if ((fseeko(fp_in, off_in, SEEK_SET) != 0) || (off_out < 0) ||
+      (fseeko(fp_out, off_out, SEEK_SET) != 0))
+  {
+    return -1;
+  }
+  errno = err;
+
+  return rc;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * copy_buffered - Copy some content from one file to another, using a buffer
+ * @param fp_in  Source file
+ * @param fp_out Destination file
+ * @param size   Maximum number of bytes to copy
+ * @retval num Number of bytes copied
+ * @retval -1  Error, see errno
+ */
+static ssize_t copy_buffered(FILE *fp_in, FILE *fp_out, size_t size)
+{
+  if (size == 0)
+    return 0;
+
+  /* Large reads and writes bypass stdio's own buffers */
+  char *buf = mutt_mem_malloc(MIN(size, COPY_BUF_SIZE));
+  size_t total = 0;
+  ssize_t rc = 0;
+
+  while (total < size)
+  {
+    size_t chunk = MIN(size - total, COPY_BUF_SIZE);
+    chunk = fread(buf, 1, chunk, fp_in);
+    if (chunk < 1)
+      break;
+    if (fwrite(buf, 1, chunk, fp_out) != chunk)
+    {
+      rc = -1;
+      break;
+    }
+    total += chunk;
+  }
+
+  FREE(&buf);
+  return (rc < 0) ? rc : (ssize_t) total;
+}
+
 /**
  * mutt_file_copy_bytes - Copy some content from one file to another
  * @param fp_in  Source file
@@ -237,24 +406,20 @@ void mutt_file_unlink(const char *s)
  * @param size   Maximum number of bytes to copy
  * @retval  0 Success
  * @retval -1 Error, see errno
+ *
+ * Between regular files, large copies are done by the kernel.
  */
 int mutt_file_copy_bytes(FILE *fp_in, FILE *fp_out, size_t size)
 {
   if (!fp_in || !fp_out)
     return -1;
 
-  while (size > 0)
-  {
-    char buf[2048];
-    size_t chunk = (size > sizeof(buf)) ? sizeof(buf) : size;
-    chunk = fread(buf, 1, chunk, fp_in);
-    if (chunk < 1)
-      break;
-    if (fwrite(buf, 1, chunk, fp_out) != chunk)
-      return -1;
+  size_t copied = 0;
+  if (copy_kernel(fp_in, fp_out, size, &copied) < 0)
+    return -1;
 
-    size -= chunk;
-  }
+  if (copy_buffered(fp_in, fp_out, size - copied) < 0)
+    return -1;
 
   if (fflush(fp_out) != 0)
     return -1;
@@ -267,26 +432,105 @@ int mutt_file_copy_bytes(FILE *fp_in, FILE *fp_out, size_t size)
  * @param fp_out Destination file
  * @retval  n Success, number of bytes copied
  * @retval -1 Error, see errno
+ *
+ * Between regular files, large copies are done by the kernel.
  */
 int mutt_file_copy_stream(FILE *fp_in, FILE *fp_out)
 {
   if (!fp_in || !fp_out)
     return -1;
 
-  size_t total = 0;
-  size_t l;
-  char buf[1024];
+  size_t copied = 0;
+  if (copy_kernel(fp_in, fp_out, SIZE_MAX, &copied) < 0)
+    return -1;
+
+  /* Whatever's left, e.g. from a pipe, or if the file has grown */
+  ssize_t rest = copy_buffered(fp_in, fp_out, SIZE_MAX);
+  if (rest < 0)
+    return -1;
 
-  while ((l = fread(buf, 1, sizeof(buf), fp_in)) > 0)
+  if (fflush(fp_out) != 0)
+    return -1;
+  return copied + rest;
+}
+
+/**
+ * mutt_file_clone - Copy a file, letting the kernel do the work
+ * @param fd_in  Source file
+ * @param fd_out Destination file, empty
+ * @retval  0 Success
+ * @retval  1 Not supported, nothing was written
+ * @retval -1 Error, see errno
+ *
+ * If the filesystem supports it, e.g. btrfs or XFS, the destination shares
+ * the source's data (a reflink).  Otherwise, the data is copied in the kernel,
+ * without passing through userspace.
+ */
+int mutt_file_clone(int fd_in, int fd_out)
+{
+  if ((fd_in < 0) || (fd_out < 0))
   {
-    if (fwrite(buf, 1, l, fp_out) != l)
-      return -1;
-    total += l;
+    errno = EBADF;
+    return -1;
   }
 
-  if (fflush(fp_out) != 0)
+#ifdef FICLONE
+  if (ioctl(fd_out, FICLONE, fd_in) == 0)
+    return 0;
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+  struct stat st = { 0 };
+  if (fstat(fd_in, &st) != 0)
     return -1;
-  return total;
+
+  off_t off_in = 0;
+  off_t off_out = 0;
+  while (off_in < st.st_size)
+  {
+    ssize_t len = copy_file_range(fd_in, &off_in, fd_out, &off_out,
+                                  st.st_size - off_in, 0);
+    if (len < 0)
+    {
+      /* e.g. Different filesystems, or an old kernel */
+      if ((off_out == 0) && ((errno == EXDEV) || (errno == ENOSYS) ||
+                             (errno == EOPNOTSUPP) || (errno == EINVAL)))
+      {
+        return 1;
+      }
+      return -1;
+    }
+    if (len == 0) /* The source was truncated */
+      break;
+  }
+
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * mutt_file_readahead - Ask the kernel to start reading a file
+ * @param path Path of the file
+ * @param len  How much of the file will be read, 0 for all of it
+ *
+ * The file is read into the page cache in the background, so that many reads
+ * can be in flight at once.  This is only a hint, so errors are ignored.
+ */
+void mutt_file_readahead(const char *path, size_t len)
+{
+  if (!path)
+    return;
+
+#ifdef POSIX_FADV_WILLNEED
+  int fd = open(path, O_RDONLY | O_NONBLOCK);
+  if (fd == -1)
+    return;
+
+  posix_fadvise(fd, 0, len, POSIX_FADV_WILLNEED);
+  close(fd);
+#endif
 }
 
 /**
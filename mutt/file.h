@@ -85,6 +85,7 @@ struct MuttFileIter
 typedef bool (*mutt_file_map_t)(char *line, int line_num, void *user_data);
 
 int         mutt_file_check_empty(const char *path);
+int         mutt_file_clone(int fd_in, int fd_out);
 int         mutt_file_chmod(const char *path, mode_t mode);
 int         mutt_file_chmod_add(const char *path, mode_t mode);
 int         mutt_file_chmod_add_stat(const char *path, mode_t mode, struct stat *st);
@@ -108,6 +109,7 @@ FILE *      mutt_file_mkstemp_full(const char *file, int line, const char *func)
 #define     mutt_file_mkstemp() mutt_file_mkstemp_full(__FILE__, __LINE__, __func__)
 int         mutt_file_open(const char *path, uint32_t flags);
 size_t      mutt_file_quote_filename(const char *filename, char *buf, size_t buflen);
+void        mutt_file_readahead(const char *path, size_t len);
 char *      mutt_file_read_keyword(const char *file, char *buf, size_t buflen);
 char *      mutt_file_read_line(char *line, size_t *size, FILE *fp, int *line_num, ReadLineFlags flags);
 int         mutt_file_rename(const char *oldfile, const char *newfile);
@@ -25,30 +25,59 @@
  * @page mutt_hash Hash Table data structure
  *
  * Hash Table data structure.
+ *
+ * The keys are stored in a single array, using open addressing and linear
+ * probing.  The array doubles in size once it's 70% full, so the initial size
+ * passed to mutt_hash_new() is only a hint.
  */
 
 #include "config.h"
 #include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "hash.h"
 #include "memory.h"
 #include "string2.h"
 
-#define SOME_PRIME 149711
+/// Largest fraction of the slots that may be used, before the table grows
+#define HASH_LOAD_NUM 7
+#define HASH_LOAD_DEN 10
+
+/**
+ * hash_mix - Scramble the bits of a hash
+ * @param h Hash
+ * @retval num Scrambled hash
+ *
+ * This is the finaliser of MurmurHash3.  It makes every input bit affect the
+ * low bits of the hash, which are the ones used to pick a slot.
+ */
+static size_t hash_mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return (size_t) h;
+}
 
 /**
  * gen_string_hash - Generate a hash from a string - Implements hash_gen_hash_t
+ *
+ * FNV-1a, one byte at a time, so the key doesn't need a strlen() first.
  */
-static size_t gen_string_hash(union HashKey key, size_t num_elems)
+static size_t gen_string_hash(union HashKey key)
 {
-  size_t hash = 0;
+  uint64_t hash = 0xcbf29ce484222325ULL;
   const unsigned char *s = (const unsigned char *) key.strkey;
 
   while (*s != '\0')
-    hash += ((hash << 7) + *s++);
-  hash = (hash * SOME_PRIME) % num_elems;
+  {
+    hash ^= *s++;
+    hash *= 0x100000001b3ULL;
+  }
 
-  return hash;
+  return hash_mix(hash);
 }
 
 /**
@@ -62,16 +91,18 @@ static int cmp_string_key(union HashKey a, union HashKey b)
 /**
  * gen_case_string_hash - Generate a hash from a string (ignore the case) - Implements hash_gen_hash_t
  */
-static size_t gen_case_string_hash(union HashKey key, size_t num_elems)
+static size_t gen_case_string_hash(union HashKey key)
 {
-  size_t hash = 0;
+  uint64_t hash = 0xcbf29ce484222325ULL;
   const unsigned char *s = (const unsigned char *) key.strkey;
 
   while (*s != '\0')
-    hash += ((hash << 7) + tolower(*s++));
-  hash = (hash * SOME_PRIME) % num_elems;
+  {
+    hash ^= tolower(*s++);
+    hash *= 0x100000001b3ULL;
+  }
 
-  return hash;
+  return hash_mix(hash);
 }
 
 /**
@@ -85,9 +116,9 @@ static int cmp_case_string_key(union HashKey a, union HashKey b)
 /**
  * gen_int_hash - Generate a hash from an integer - Implements hash_gen_hash_t
  */
-static size_t gen_int_hash(union HashKey key, size_t num_elems)
+static size_t gen_int_hash(union HashKey key)
 {
-  return (key.intkey % num_elems);
+  return hash_mix(key.intkey);
 }
 
 /**
@@ -107,19 +138,115 @@ static int cmp_int_key(union HashKey a, union HashKey b)
  * @param num_elems Number of elements it should contain
  * @retval ptr New Hash Table
  *
- * The Hash Table can contain more elements than num_elems, but they will be
- * chained together.
+ * The Hash Table will grow if more than num_elems elements are added.
  */
 static struct HashTable *hash_new(size_t num_elems)
 {
   struct HashTable *table = mutt_mem_calloc(1, sizeof(struct HashTable));
-  if (num_elems == 0)
-    num_elems = 2;
-  table->num_elems = num_elems;
-  table->table = mutt_mem_calloc(num_elems, sizeof(struct HashElem *));
+
+  size_t slots = 8;
+  while ((slots * HASH_LOAD_NUM / HASH_LOAD_DEN) < num_elems)
+    slots *= 2;
+
+  table->num_elems = slots;
+  table->table = mutt_mem_calloc(slots, sizeof(struct HashElem *));
+  MEM_ACCOUNT(MEM_TAG_HASH, sizeof(struct HashTable) + (slots * sizeof(struct HashElem *)), 1);
   return table;
 }
 
+/**
+ * hash_find_slot - Find the slot for a key
+ * @param table Hash Table to search
+ * @param key   Key (either string or integer)
+ * @param hash  Hash of the key
+ * @retval num Index of the slot holding the key, or the empty slot where it belongs
+ */
+static size_t hash_find_slot(const struct HashTable *table, union HashKey key, size_t hash)
+{
+  const size_t mask = table->num_elems - 1;
+  size_t i = hash & mask;
+
+  for (struct HashElem *he = table->table[i]; he; he = table->table[i])
+  {
+    if ((he->hash == hash) && (table->cmp_key(he->key, key) == 0))
+      break;
+    i = (i + 1) & mask;
+  }
+
+  return i;
+}
+
+/**
+ * hash_grow - Double the number of slots in a Hash Table
+ * @param table Hash Table to resize
+ */
+static void hash_grow(struct HashTable *table)
+{
+  struct HashElem **old = table->table;
+  const size_t old_elems = table->num_elems;
+
+  table->num_elems *= 2;
+  table->table = mutt_mem_calloc(table->num_elems, sizeof(struct HashElem *));
+  MEM_ACCOUNT(MEM_TAG_HASH, old_elems * sizeof(struct HashElem *), 0);
+
+  const size_t mask = table->num_elems - 1;
+  for (size_t i = 0; i < old_elems; i++)
+  {
+    if (!old[i])
+      continue;
+
+    size_t j = old[i]->hash & mask;
+    while (table->table[j])
+      j = (j + 1) & mask;
+    table->table[j] = old[i];
+  }
+
+  FREE(&old);
+}
+
+/**
+ * hash_clear_slot - Empty a slot, keeping the probe sequences intact
+ * @param table Hash Table
+ * @param i     Index of the slot to empty
+ *
+ * Any following elements that were displaced past the slot are moved back.
+ */
+static void hash_clear_slot(struct HashTable *table, size_t i)
+{
+  const size_t mask = table->num_elems - 1;
+
+  table->table[i] = NULL;
+  table->num_keys--;
+
+  for (size_t j = (i + 1) & mask; table->table[j]; j = (j + 1) & mask)
+  {
+    /* An element may move back to i, if its home slot isn't in (i, j] */
+    const size_t home = table->table[j]->hash & mask;
+    const bool between = (i <= j) ? ((i < home) && (home <= j)) : ((i < home) || (home <= j));
+    if (between)
+      continue;
+
+    table->table[i] = table->table[j];
+    table->table[j] = NULL;
+    i = j;
+  }
+}
+
+/**
+ * hash_elem_free - Free a HashElem
+ * @param table Hash Table it belongs to
+ * @param he    HashElem to free
+ */
+static void hash_elem_free(struct HashTable *table, struct HashElem *he)
+{
+  if (table->hdata_free)
+    table->hdata_free(he->type, he->data, table->hdata);
+  if (table->strdup_keys)
+    FREE(&he->key.strkey);
+  FREE(&he);
+  MEM_ACCOUNT(MEM_TAG_HASH, -(long) sizeof(struct HashElem), 0);
+}
+
 /**
  * union_hash_insert - Insert into a hash table using a union as a key
  * @param table Hash Table to update
@@ -134,38 +261,31 @@ static struct HashElem *union_hash_insert(struct HashTable *table,
   if (!table)
     return NULL; // LCOV_EXCL_LINE
 
+  const size_t hash = table->gen_hash(key);
+  size_t i = hash_find_slot(table, key, hash);
+  if (table->table[i] && !table->allow_dups)
+    return NULL;
+
+  if (!table->table[i] &&
+      ((table->num_keys + 1) * HASH_LOAD_DEN > table->num_elems * HASH_LOAD_NUM))
+  {
+    hash_grow(table);
+    i = hash_find_slot(table, key, hash);
+  }
+
   struct HashElem *he = mutt_mem_calloc(1, sizeof(struct HashElem));
-  size_t hash = table->gen_hash(key, table->num_elems);
+  MEM_ACCOUNT(MEM_TAG_HASH, sizeof(struct HashElem), 0);
   he->key = key;
+  he->hash = hash;
   he->data = data;
   he->type = type;
 
-  if (table->allow_dups)
-  {
-    he->next = table->table[hash];
-    table->table[hash] = he;
-  }
-  else
-  {
-    struct HashElem *tmp = NULL, *last = NULL;
+  if (!table->table[i])
+    table->num_keys++;
 
-    for (tmp = table->table[hash], last = NULL; tmp; last = tmp, tmp = tmp->next)
-    {
-      const int rc = table->cmp_key(tmp->key, key);
-      if (rc == 0)
-      {
-        FREE(&he);
-        return NULL;
-      }
-      if (rc > 0)
-        break;
-    }
-    if (last)
-      last->next = he;
-    else
-      table->table[hash] = he;
-    he->next = tmp;
-  }
+  /* The newest duplicate is found first */
+  he->next = table->table[i];
+  table->table[i] = he;
   return he;
 }
 
@@ -177,17 +297,10 @@ static struct HashElem *union_hash_insert(struct HashTable *table,
  */
 static struct HashElem *union_hash_find_elem(const struct HashTable *table, union HashKey key)
 {
-  if (!table)
+  if (!table || !table->table)
     return NULL; // LCOV_EXCL_LINE
 
-  size_t hash = table->gen_hash(key, table->num_elems);
-  struct HashElem *he = table->table[hash];
-  for (; he; he = he->next)
-  {
-    if (table->cmp_key(key, he->key) == 0)
-      return he;
-  }
-  return NULL;
+  return table->table[hash_find_slot(table, key, table->gen_hash(key))];
 }
 
 /**
@@ -214,24 +327,21 @@ static void *union_hash_find(const struct HashTable *table, union HashKey key)
  */
 static void union_hash_delete(struct HashTable *table, union HashKey key, const void *data)
 {
-  if (!table)
+  if (!table || !table->table)
     return; // LCOV_EXCL_LINE
 
-  size_t hash = table->gen_hash(key, table->num_elems);
-  struct HashElem *he = table->table[hash];
-  struct HashElem **last = &table->table[hash];
+  const size_t i = hash_find_slot(table, key, table->gen_hash(key));
+  struct HashElem **last = &table->table[i];
+  struct HashElem *he = *last;
+  if (!he)
+    return;
 
   while (he)
   {
-    if (((data == he->data) || !data) && (table->cmp_key(he->key, key) == 0))
+    if ((data == he->data) || !data)
     {
       *last = he->next;
-      if (table->hdata_free)
-        table->hdata_free(he->type, he->data, table->hdata);
-      if (table->strdup_keys)
-        FREE(&he->key.strkey);
-      FREE(&he);
-
+      hash_elem_free(table, he);
       he = *last;
     }
     else
@@ -240,6 +350,9 @@ static void union_hash_delete(struct HashTable *table, union HashKey key, const
       he = he->next;
     }
   }
+
+  if (!table->table[i])
+    hash_clear_slot(table, i);
 }
 
 /**
@@ -314,7 +427,10 @@ struct HashElem *mutt_hash_typed_insert(struct HashTable *table,
 
   union HashKey key;
   key.strkey = table->strdup_keys ? mutt_str_dup(strkey) : strkey;
-  return union_hash_insert(table, key, type, data);
+  struct HashElem *he = union_hash_insert(table, key, type, data);
+  if (!he && table->strdup_keys)
+    FREE(&key.strkey);
+  return he;
 }
 
 /**
@@ -396,7 +512,8 @@ void *mutt_hash_int_find(const struct HashTable *table, unsigned int intkey)
  * @param strkey String key to search for
  * @retval ptr HashElem matching the key
  *
- * Unlike mutt_hash_find_elem(), this will return the first matching entry.
+ * If the Hash Table allows duplicates, the other elements with the same key
+ * can be found by following HashElem::next.
  */
 struct HashElem *mutt_hash_find_bucket(const struct HashTable *table, const char *strkey)
 {
@@ -404,10 +521,8 @@ struct HashElem *mutt_hash_find_bucket(const struct HashTable *table, const char
     return NULL;
 
   union HashKey key;
-
   key.strkey = strkey;
-  size_t hash = table->gen_hash(key, table->num_elems);
-  return table->table[hash];
+  return union_hash_find_elem(table, key);
 }
 
 /**
@@ -458,13 +573,10 @@ void mutt_hash_free(struct HashTable **ptr)
     {
       tmp = elem;
       elem = elem->next;
-      if (table->hdata_free)
-        table->hdata_free(tmp->type, tmp->data, table->hdata);
-      if (table->strdup_keys)
-        FREE(&tmp->key.strkey);
-      FREE(&tmp);
+      hash_elem_free(table, tmp);
     }
   }
+  MEM_ACCOUNT(MEM_TAG_HASH, -(long) (sizeof(struct HashTable) + (table->num_elems * sizeof(struct HashElem *))), -1);
   FREE(&table->table);
   FREE(ptr);
 }
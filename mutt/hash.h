@@ -44,8 +44,9 @@ struct HashElem
 {
   int type;              ///< Type of data stored in Hash Table, e.g. #DT_STRING
   union HashKey key;     ///< Key representing the data
+  size_t hash;           ///< Hash of the key
   void *data;            ///< User-supplied data
-  struct HashElem *next; ///< Linked List
+  struct HashElem *next; ///< Next element with the same key (#MUTT_HASH_ALLOW_DUPS)
 };
 
 /**
@@ -58,13 +59,13 @@ typedef void (*hash_hdata_free_t)(int type, void *obj, intptr_t data);
 
 /**
  * typedef hash_gen_hash_t - Prototype for a Key hashing function
- * @param key       Key to hash
- * @param num_elems Number of elements in the Hash Table
+ * @param key Key to hash
+ * @retval num Hash of the key
  *
- * Turn a Key (a string or an integer) into a hash id.
- * The hash id will be a number between 0 and (num_elems-1).
+ * Turn a Key (a string or an integer) into a hash.
+ * All the bits of the hash should be well mixed.
  */
-typedef size_t (*hash_gen_hash_t)(union HashKey key, size_t num_elems);
+typedef size_t (*hash_gen_hash_t)(union HashKey key);
 
 /**
  * typedef hash_cmp_key_t - Prototype for a function to compare two Hash keys
@@ -80,13 +81,17 @@ typedef int (*hash_cmp_key_t)(union HashKey a, union HashKey b);
 
 /**
  * struct HashTable - A Hash Table
+ *
+ * The table uses open addressing with linear probing.  Each slot holds the
+ * HashElems for one key.  The table doubles in size when it's getting full.
  */
 struct HashTable
 {
-  size_t num_elems;             ///< Number of elements in the Hash Table
+  size_t num_elems;             ///< Number of slots in the Hash Table (a power of two)
+  size_t num_keys;              ///< Number of slots in use
   bool strdup_keys : 1;         ///< if set, the key->strkey is strdup()'d
   bool allow_dups  : 1;         ///< if set, duplicate keys are allowed
-  struct HashElem **table;      ///< Array of Hash keys
+  struct HashElem **table;      ///< Array of slots
   hash_gen_hash_t gen_hash;     ///< Function to generate hash id from the key
   hash_cmp_key_t cmp_key;       ///< Function to compare two Hash keys
   intptr_t hdata;               ///< Data to pass to the hdata_free() function
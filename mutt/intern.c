@@ -0,0 +1,130 @@
+/**
+ * @file
+ * Shared copies of common strings
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_intern Shared copies of common strings
+ *
+ * Many emails in a folder carry identical strings, e.g. the names of MIME
+ * parameters or the List-Post address of a mailing list.  Rather than keep a
+ * copy for each email, the strings can be stored once and shared.
+ *
+ * Each shared string is reference-counted.  The strings must not be modified.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+#include "intern.h"
+#include "hash.h"
+#include "memory.h"
+
+/// Shared strings, the data is the reference count
+static struct HashTable *InternPool = NULL;
+/// Number of strings in the pool
+static size_t InternCount = 0;
+
+/**
+ * mutt_intern_get - Get a shared copy of a string
+ * @param str String to share
+ * @retval ptr Shared copy of the string
+ * @retval NULL str was NULL
+ *
+ * The returned string must not be modified.
+ * Release it with mutt_intern_release().
+ */
+char *mutt_intern_get(const char *str)
+{
+  if (!str)
+    return NULL;
+
+  if (!InternPool)
+    InternPool = mutt_hash_new(1024, MUTT_HASH_STRDUP_KEYS);
+
+  struct HashElem *he = mutt_hash_find_elem(InternPool, str);
+  if (he)
+  {
+    he->data = (void *) ((intptr_t) he->data + 1);
+  }
+  else
+  {
+    he = mutt_hash_insert(InternPool, str, (void *) (intptr_t) 1);
+    InternCount++;
+  }
+
+  return (char *) he->key.strkey;
+}
+
+/**
+ * mutt_intern_release - Release a shared string
+ * @param[out] ptr String to release
+ *
+ * When the last reference is released, the string is freed.
+ *
+ * @note Strings that weren't got from mutt_intern_get() are simply freed.
+ */
+void mutt_intern_release(char **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct HashElem *he = InternPool ? mutt_hash_find_elem(InternPool, *ptr) : NULL;
+  if (!he || (he->key.strkey != *ptr))
+  {
+    FREE(ptr);
+    return;
+  }
+
+  intptr_t refs = (intptr_t) he->data - 1;
+  if (refs > 0)
+  {
+    he->data = (void *) refs;
+  }
+  else
+  {
+    mutt_hash_delete(InternPool, *ptr, NULL);
+    if (--InternCount == 0)
+      mutt_hash_free(&InternPool);
+  }
+
+  *ptr = NULL;
+}
+
+/**
+ * mutt_intern_replace - Swap a string for a shared copy
+ * @param[out] ptr String to replace
+ *
+ * The original string is freed.  If the string is already shared, nothing
+ * is changed.
+ */
+void mutt_intern_replace(char **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct HashElem *he = InternPool ? mutt_hash_find_elem(InternPool, *ptr) : NULL;
+  if (he && (he->key.strkey == *ptr))
+    return;
+
+  char *shared = mutt_intern_get(*ptr);
+  FREE(ptr);
+  *ptr = shared;
+}
@@ -25,34 +25,40 @@
  *
  * Each source file in the library provides a group of related functions.
  *
- * | File             | Description             |
- * | :--------------- | :---------------------- |
- * | mutt/array.h     | @subpage mutt_array     |
- * | mutt/base64.c    | @subpage mutt_base64    |
- * | mutt/buffer.c    | @subpage mutt_buffer    |
- * | mutt/charset.c   | @subpage mutt_charset   |
- * | mutt/date.c      | @subpage mutt_date      |
- * | mutt/envlist.c   | @subpage mutt_envlist   |
- * | mutt/exit.c      | @subpage mutt_exit      |
- * | mutt/file.c      | @subpage mutt_file      |
- * | mutt/filter.c    | @subpage mutt_filter    |
- * | mutt/hash.c      | @subpage mutt_hash      |
- * | mutt/list.c      | @subpage mutt_list      |
- * | mutt/logging.c   | @subpage mutt_logging   |
- * | mutt/mapping.c   | @subpage mutt_mapping   |
- * | mutt/mbyte.c     | @subpage mutt_mbyte     |
- * | mutt/md5.c       | @subpage mutt_md5       |
- * | mutt/memory.c    | @subpage mutt_memory    |
- * | mutt/notify.c    | @subpage mutt_notify    |
- * | mutt/observer.h  | @subpage mutt_observer  |
- * | mutt/path.c      | @subpage mutt_path      |
- * | mutt/pool.c      | @subpage mutt_pool      |
- * | mutt/prex.c      | @subpage mutt_prex      |
- * | mutt/random.c    | @subpage mutt_random    |
- * | mutt/regex.c     | @subpage mutt_regex     |
- * | mutt/slist.c     | @subpage mutt_slist     |
- * | mutt/signal.c    | @subpage mutt_signal    |
- * | mutt/string.c    | @subpage mutt_string    |
+ * | File               | Description               |
+ * | :----------------- | :------------------------ |
+ * | mutt/array.h       | @subpage mutt_array       |
+ * | mutt/base64.c      | @subpage mutt_base64      |
+ * | mutt/buffer.c      | @subpage mutt_buffer      |
+ * | mutt/charset.c     | @subpage mutt_charset     |
+ * | mutt/date.c        | @subpage mutt_date        |
+ * | mutt/envlist.c     | @subpage mutt_envlist     |
+ * | mutt/exit.c        | @subpage mutt_exit        |
+ * | mutt/file.c        | @subpage mutt_file        |
+ * | mutt/filter.c      | @subpage mutt_filter      |
+ * | mutt/hash.c        | @subpage mutt_hash        |
+ * | mutt/intern.c      | @subpage mutt_intern      |
+ * | mutt/list.c        | @subpage mutt_list        |
+ * | mutt/logging.c     | @subpage mutt_logging     |
+ * | mutt/mapping.c     | @subpage mutt_mapping     |
+ * | mutt/mbyte.c       | @subpage mutt_mbyte       |
+ * | mutt/md5.c         | @subpage mutt_md5         |
+ * | mutt/memory.c      | @subpage mutt_memory      |
+ * | mutt/notify.c      | @subpage mutt_notify      |
+ * | mutt/observer.h    | @subpage mutt_observer    |
+ * | mutt/path.c        | @subpage mutt_path        |
+ * | mutt/pool.c        | @subpage mutt_pool        |
+ * | mutt/prefix.c      | @subpage mutt_prefix      |
+ * | mutt/prex.c        | @subpage mutt_prex        |
+ * | mutt/random.c      | @subpage mutt_random      |
+ * | mutt/regex.c       | @subpage mutt_regex       |
+ * | mutt/regex_pcre2.c | @subpage mutt_regex_pcre2 |
+ * | mutt/slist.c       | @subpage mutt_slist       |
+ * | mutt/signal.c      | @subpage mutt_signal      |
+ * | mutt/slab.c        | @subpage mutt_slab        |
+ * | mutt/string.c      | @subpage mutt_string      |
+ * | mutt/trace.c       | @subpage mutt_trace       |
+ * | mutt/worker.c      | @subpage mutt_worker      |
  *
  * @note The library is self-contained -- some files may depend on others in
  *       the library, but none depends on source from outside.
@@ -72,6 +78,7 @@
 #include "file.h"
 #include "filter.h"
 #include "hash.h"
+#include "intern.h"
 #include "list.h"
 #include "logging.h"
 #include "mapping.h"
@@ -84,13 +91,17 @@
 #include "observer.h"
 #include "path.h"
 #include "pool.h"
+#include "prefix.h"
 #include "prex.h"
 #include "queue.h"
 #include "random.h"
 #include "regex3.h"
 #include "signal2.h"
+#include "slab.h"
 #include "slist.h"
 #include "string2.h"
+#include "trace.h"
+#include "worker.h"
 // IWYU pragma: end_exports
 
 #endif /* MUTT_MUTT_LIB_H */
@@ -24,6 +24,22 @@
  * @page mutt_logging Logging Dispatcher
  *
  * Logging Dispatcher
+ *
+ * ## Log file
+ *
+ * Each line is formatted into a buffer on the stack, then copied into a ring
+ * buffer.  A background thread writes the ring to the file, so logging at a
+ * high level doesn't wait for the disk.  If the ring fills up, the logger
+ * waits for space; lines are never dropped.  log_file_flush() waits until
+ * everything has been written.
+ *
+ * Without thread support, the file is fully buffered and flushed after every
+ * error or message.
+ *
+ * ## Subsystems
+ *
+ * log_file_set_subsystem() sets the level for the source files in one
+ * directory, e.g. "imap", overriding the file's level.
  */
 
 #include "config.h"
@@ -41,6 +57,10 @@
 #include "message.h"
 #include "queue.h"
 #include "string2.h"
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#include <signal.h>
+#endif
 
 const char *LevelAbbr = "PEWM12345N"; ///< Abbreviations of logging level names
 
@@ -64,6 +84,231 @@ static struct LogLineList LogQueue = STAILQ_HEAD_INITIALIZER(LogQueue);
 int LogQueueCount = 0; ///< Number of entries currently in the log queue
 int LogQueueMax = 0;   ///< Maximum number of entries in the log queue
 
+/// Size of the stack buffer for a log line; longer lines use the heap
+#define LOG_LINE_SIZE 4096
+
+/// Most subsystems that can have their own level
+#define LOG_MAX_SUBSYSTEMS 16
+
+/**
+ * struct LogSubsystem - The log level of a set of source files
+ */
+struct LogSubsystem
+{
+  char name[32];       ///< Directory of the source files, e.g. "imap"
+  enum LogLevel level; ///< Log level for the files
+};
+
+static struct LogSubsystem LogSubsystems[LOG_MAX_SUBSYSTEMS]; ///< Levels of the subsystems
+static int LogNumSubsystems = 0;       ///< Number of subsystems with their own level
+static enum LogLevel LogMaxLevel = 0;  ///< Highest level of the file and subsystems
+
+#ifdef USE_PTHREADS
+/// Size of the ring buffer for the log file
+#define LOG_RING_SIZE (1024 * 1024)
+
+/**
+ * struct LogRing - Log lines waiting to be written to the file
+ *
+ * head and tail only ever increase; their difference is the amount of text
+ * in the ring.
+ */
+struct LogRing
+{
+  char *data;         ///< Ring buffer, #LOG_RING_SIZE bytes
+  size_t head;        ///< Total bytes added
+  size_t tail;        ///< Total bytes written to the file
+  bool running;       ///< Is the writer thread running?
+  bool stopping;      ///< Should the writer thread exit?
+  bool idle;          ///< Is the writer thread waiting for data?
+  pthread_t thread;   ///< Writer thread
+};
+
+static struct LogRing LogRing = { 0 };                 ///< Lines for the log file
+static pthread_mutex_t LogLock = PTHREAD_MUTEX_INITIALIZER; ///< Protects LogRing
+static pthread_cond_t LogData = PTHREAD_COND_INITIALIZER;   ///< Signalled when there's data, or it's time to stop
+static pthread_cond_t LogSpace = PTHREAD_COND_INITIALIZER;  ///< Signalled when data has been written
+
+/**
+ * log_ring_main - Write the ring buffer to the log file
+ * @param arg Unused
+ * @retval NULL Always
+ */
+static void *log_ring_main(void *arg)
+{
+  pthread_mutex_lock(&LogLock);
+  while (true)
+  {
+    if (LogRing.head == LogRing.tail)
+    {
+      if (LogRing.stopping)
+        break;
+      LogRing.idle = true;
+      pthread_cond_wait(&LogData, &LogLock);
+      LogRing.idle = false;
+      continue;
+    }
+
+    /* Write everything that's contiguous in one go */
+    const size_t start = LogRing.tail % LOG_RING_SIZE;
+    size_t len = LogRing.head - LogRing.tail;
+    if (len > (LOG_RING_SIZE - start))
+      len = LOG_RING_SIZE - start;
+    pthread_mutex_unlock(&LogLock);
+
+    fwrite(LogRing.data + start, 1, len, LogFileFP);
+    fflush(LogFileFP);
+
+    pthread_mutex_lock(&LogLock);
+    LogRing.tail += len;
+    pthread_cond_broadcast(&LogSpace);
+  }
+  pthread_mutex_unlock(&LogLock);
+  return NULL;
+}
+
+/**
+ * log_ring_start - Start writing the log file in the background
+ */
+static void log_ring_start(void)
+{
+  if (LogRing.running)
+    return;
+
+  if (!LogRing.data)
+    LogRing.data = mutt_mem_malloc(LOG_RING_SIZE);
+  LogRing.head = 0;
+  LogRing.tail = 0;
+  LogRing.stopping = false;
+
+  /* Signals must be handled by the main thread */
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+  LogRing.running = (pthread_create(&LogRing.thread, NULL, log_ring_main, NULL) == 0);
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+/**
+ * log_ring_stop - Write the rest of the ring buffer and stop the thread
+ */
+static void log_ring_stop(void)
+{
+  if (!LogRing.running)
+    return;
+
+  pthread_mutex_lock(&LogLock);
+  LogRing.stopping = true;
+  pthread_cond_signal(&LogData);
+  pthread_mutex_unlock(&LogLock);
+
+  pthread_join(LogRing.thread, NULL);
+  LogRing.running = false;
+  FREE(&LogRing.data);
+}
+#endif
+
+/**
+ * log_file_write - Write some text to the log file
+ * @param str   Text to write
+ * @param len   Length of the text
+ * @param flush If true, flush the file (only without the writer thread)
+ */
+static void log_file_write(const char *str, size_t len, bool flush)
+{
+#ifdef USE_PTHREADS
+  if (LogRing.running)
+  {
+    pthread_mutex_lock(&LogLock);
+    while (len > 0)
+    {
+      size_t space = LOG_RING_SIZE - (LogRing.head - LogRing.tail);
+      if (space == 0)
+      {
+        pthread_cond_wait(&LogSpace, &LogLock);
+        continue;
+      }
+
+      const size_t start = LogRing.head % LOG_RING_SIZE;
+      size_t chunk = MIN(len, space);
+      chunk = MIN(chunk, LOG_RING_SIZE - start);
+      memcpy(LogRing.data + start, str, chunk);
+      LogRing.head += chunk;
+      str += chunk;
+      len -= chunk;
+
+      if (LogRing.idle)
+        pthread_cond_signal(&LogData);
+    }
+    pthread_mutex_unlock(&LogLock);
+    return;
+  }
+#endif
+
+  fwrite(str, 1, len, LogFileFP);
+  if (flush)
+    fflush(LogFileFP);
+}
+
+/**
+ * log_file_printf - Write formatted text to the log file
+ * @param fmt printf-like format string
+ * @param ... Arguments to be formatted
+ */
+static void log_file_printf(const char *fmt, ...)
+{
+  char buf[1024];
+
+  va_list ap;
+  va_start(ap, fmt);
+  int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+
+  if (len < 0)
+    return;
+  log_file_write(buf, MIN((size_t) len, sizeof(buf) - 1), true);
+}
+
+/**
+ * log_file_set_max_level - Find the highest level of the file and subsystems
+ */
+static void log_file_set_max_level(void)
+{
+  LogMaxLevel = LogFileLevel;
+  for (int i = 0; i < LogNumSubsystems; i++)
+    LogMaxLevel = MAX(LogMaxLevel, LogSubsystems[i].level);
+}
+
+/**
+ * subsystem_find - Find the subsystem of a source file
+ * @param file Source file, e.g. "../imap/command.c"
+ * @retval ptr  Subsystem
+ * @retval NULL The file's directory doesn't have its own level
+ */
+static struct LogSubsystem *subsystem_find(const char *file)
+{
+  if (!file)
+    return NULL;
+
+  const char *end = strrchr(file, '/');
+  if (!end)
+    return NULL;
+
+  const char *start = end;
+  while ((start > file) && (start[-1] != '/'))
+    start--;
+
+  const size_t len = end - start;
+  for (int i = 0; i < LogNumSubsystems; i++)
+  {
+    struct LogSubsystem *ls = &LogSubsystems[i];
+    if ((strncmp(ls->name, start, len) == 0) && (ls->name[len] == '\0'))
+      return ls;
+  }
+
+  return NULL;
+}
+
 /**
  * timestamp - Create a YYYY-MM-DD HH:MM:SS timestamp
  * @param stamp Unix time
@@ -76,8 +321,8 @@ int LogQueueMax = 0;   ///< Maximum number of entries in the log queue
  */
 static const char *timestamp(time_t stamp)
 {
-  static char buf[23] = { 0 };
-  static time_t last = 0;
+  static __thread char buf[23] = { 0 };
+  static __thread time_t last = 0;
 
   if (stamp == 0)
     stamp = mutt_date_epoch();
@@ -100,6 +345,9 @@ void log_file_close(bool verbose)
   if (!LogFileFP)
     return;
 
+#ifdef USE_PTHREADS
+  log_ring_stop();
+#endif
   fprintf(LogFileFP, "[%s] Closing log.\n", timestamp(0));
   fprintf(LogFileFP, "# vim: syntax=neomuttlog\n");
   mutt_file_fclose(&LogFileFP);
@@ -130,10 +378,14 @@ int log_file_open(bool verbose)
   LogFileFP = mutt_file_fopen(LogFileName, "a+");
   if (!LogFileFP)
     return -1;
-  setvbuf(LogFileFP, NULL, _IOLBF, 0);
+  setvbuf(LogFileFP, NULL, _IOFBF, 0);
 
   fprintf(LogFileFP, "[%s] NeoMutt%s debugging at level %d\n", timestamp(0),
           NONULL(LogFileVersion), LogFileLevel);
+  fflush(LogFileFP);
+#ifdef USE_PTHREADS
+  log_ring_start();
+#endif
   if (verbose)
     mutt_message(_("Debugging at level %d to file '%s'"), LogFileLevel, LogFileName);
   return 0;
@@ -181,6 +433,7 @@ int log_file_set_level(enum LogLevel level, bool verbose)
     return 0;
 
   LogFileLevel = level;
+  log_file_set_max_level();
 
   if (level == LL_MESSAGE)
   {
@@ -190,22 +443,21 @@ int log_file_set_level(enum LogLevel level, bool verbose)
   {
     if (verbose)
       mutt_message(_("Logging at level %d to file '%s'"), LogFileLevel, LogFileName);
-    fprintf(LogFileFP, "[%s] NeoMutt%s debugging at level %d\n", timestamp(0),
-            NONULL(LogFileVersion), LogFileLevel);
+    log_file_printf("[%s] NeoMutt%s debugging at level %d\n", timestamp(0),
+                    NONULL(LogFileVersion), LogFileLevel);
   }
   else
   {
     log_file_open(verbose);
   }
 
-  if (LogFileLevel >= LL_DEBUG5)
+  if ((LogMaxLevel >= LL_DEBUG5) && LogFileFP)
   {
-    fprintf(LogFileFP,
-            "\n"
-            "WARNING:\n"
-            "    Logging at this level can reveal personal information.\n"
-            "    Review the log carefully before posting in bug reports.\n"
-            "\n");
+    log_file_printf("\n"
+                    "WARNING:\n"
+                    "    Logging at this level can reveal personal information.\n"
+                    "    Review the log carefully before posting in bug reports.\n"
+                    "\n");
   }
 
   return 0;
@@ -232,6 +484,136 @@ bool log_file_running(void)
   return LogFileFP;
 }
 
+/**
+ * log_file_flush - Wait for the log file to be written
+ *
+ * Call this before exiting without closing the log.
+ */
+void log_file_flush(void)
+{
+  if (!LogFileFP)
+    return;
+
+#ifdef USE_PTHREADS
+  if (LogRing.running)
+  {
+    pthread_mutex_lock(&LogLock);
+    while (LogRing.tail != LogRing.head)
+      pthread_cond_wait(&LogSpace, &LogLock);
+    pthread_mutex_unlock(&LogLock);
+    return;
+  }
+#endif
+
+  fflush(LogFileFP);
+}
+
+/**
+ * log_file_set_subsystem - Set the log level of a subsystem
+ * @param name  Directory of the subsystem's source files, e.g. "imap"
+ * @param level Logging level
+ * @retval  0 Success
+ * @retval -1 Error, invalid name or level, or too many subsystems
+ *
+ * The subsystem's level overrides the file's level, see log_file_set_level().
+ */
+int log_file_set_subsystem(const char *name, enum LogLevel level)
+{
+  if (!name || (*name == '\0') || strchr(name, '/') || (level < LL_MESSAGE) || (level >= LL_MAX))
+    return -1;
+
+  struct LogSubsystem *ls = NULL;
+  for (int i = 0; i < LogNumSubsystems; i++)
+  {
+    if (mutt_str_equal(LogSubsystems[i].name, name))
+      ls = &LogSubsystems[i];
+  }
+
+  if (!ls)
+  {
+    if ((LogNumSubsystems == LOG_MAX_SUBSYSTEMS) ||
+        (mutt_str_len(name) >= sizeof(LogSubsystems[0].name)))
+    {
+      return -1;
+    }
+    ls = &LogSubsystems[LogNumSubsystems++];
+    mutt_str_copy(ls->name, name, sizeof(ls->name));
+  }
+
+  ls->level = level;
+  log_file_set_max_level();
+  return 0;
+}
+
+/**
+ * log_file_clear_subsystems - Forget the log levels of all subsystems
+ */
+void log_file_clear_subsystems(void)
+{
+  LogNumSubsystems = 0;
+  log_file_set_max_level();
+}
+
+/**
+ * log_file_wanted - Should a line be logged to the file?
+ * @param file  Source file of the line
+ * @param level Logging level
+ * @retval true The line should be logged
+ *
+ * Errors, warnings and messages are always wanted.
+ */
+bool log_file_wanted(const char *file, enum LogLevel level)
+{
+  if (level <= LL_MESSAGE)
+    return true;
+
+  if (level > LogMaxLevel)
+    return false;
+
+  if (LogNumSubsystems == 0)
+    return true;
+
+  struct LogSubsystem *ls = subsystem_find(file);
+  return (level <= (ls ? ls->level : LogFileLevel));
+}
+
+/**
+ * log_line_format - Format a line for the log file
+ * @param buf      Buffer for the line
+ * @param size     Size of the buffer
+ * @param stamp    Unix time, or 0 for now
+ * @param function Source function
+ * @param level    Logging level
+ * @param err      Saved errno, for #LL_PERROR
+ * @param fmt      printf-like format string
+ * @param ap       Arguments to be formatted
+ * @retval num Length of the whole line, which may be longer than the buffer
+ */
+static size_t log_line_format(char *buf, size_t size, time_t stamp, const char *function,
+                              enum LogLevel level, int err, const char *fmt, va_list ap)
+{
+  size_t len = 0;
+  int rc = snprintf(buf, size, "[%s]<%c> %s() ", timestamp(stamp),
+                    LevelAbbr[level + 3], function);
+  if (rc > 0)
+    len += rc;
+
+  rc = vsnprintf(buf + MIN(len, size), size - MIN(len, size), fmt, ap);
+  if (rc > 0)
+    len += rc;
+
+  if (level == LL_PERROR)
+    rc = snprintf(buf + MIN(len, size), size - MIN(len, size), ": %s\n", strerror(err));
+  else if (level <= LL_MESSAGE)
+    rc = snprintf(buf + MIN(len, size), size - MIN(len, size), "\n");
+  else
+    rc = 0;
+  if (rc > 0)
+    len += rc;
+
+  return len;
+}
+
 /**
  * log_disp_file - Save a log line to a file - Implements ::log_dispatcher_t
  *
@@ -239,42 +621,48 @@ bool log_file_running(void)
  * * `[TIMESTAMP]<LEVEL> FUNCTION() FORMATTED-MESSAGE`
  *
  * The caller must first set #LogFileName and #LogFileLevel, then call
- * log_file_open().  Any logging above #LogFileLevel will be ignored.
+ * log_file_open().  Any logging above #LogFileLevel, or the level of the
+ * file's subsystem, will be ignored.
  *
  * If stamp is 0, then the current time will be used.
  */
 int log_disp_file(time_t stamp, const char *file, int line,
                   const char *function, enum LogLevel level, ...)
 {
-  if (!LogFileFP || (level < LL_PERROR) || (level > LogFileLevel))
+  if (!LogFileFP || (level < LL_PERROR) || !log_file_wanted(file, level))
     return 0;
 
-  int ret = 0;
   int err = errno;
 
   if (!function)
     function = "UNKNOWN";
 
-  ret += fprintf(LogFileFP, "[%s]<%c> %s() ", timestamp(stamp),
-                 LevelAbbr[level + 3], function);
+  char stack[LOG_LINE_SIZE];
+  char *buf = stack;
 
   va_list ap;
   va_start(ap, level);
   const char *fmt = va_arg(ap, const char *);
-  ret += vfprintf(LogFileFP, fmt, ap);
+  size_t len = log_line_format(buf, sizeof(stack), stamp, function, level, err, fmt, ap);
   va_end(ap);
 
-  if (level == LL_PERROR)
+  if (len >= sizeof(stack))
   {
-    fprintf(LogFileFP, ": %s\n", strerror(err));
-  }
-  else if (level <= LL_MESSAGE)
-  {
-    fputs("\n", LogFileFP);
-    ret++;
+    buf = mutt_mem_malloc(len + 1);
+    va_start(ap, level);
+    fmt = va_arg(ap, const char *);
+    const size_t len2 = log_line_format(buf, len + 1, stamp, function, level, err, fmt, ap);
+    va_end(ap);
+    len = MIN(len, len2);
   }
 
-  return ret;
+  log_file_write(buf, len, (level <= LL_MESSAGE));
+
+  if (buf != stack)
+    FREE(&buf);
+
+  errno = err;
+  return len;
 }
 
 /**
@@ -78,7 +78,12 @@ struct LogLine
 };
 STAILQ_HEAD(LogLineList, LogLine);
 
+#ifdef LOG_MAX_LEVEL
+/* Calls above the configured level, see --with-debug-max, compile to nothing */
+#define mutt_debug(LEVEL, ...) (((LEVEL) <= LOG_MAX_LEVEL) ? (void) MuttLogger(0, __FILE__, __LINE__, __func__, LEVEL, __VA_ARGS__) : (void) 0)
+#else
 #define mutt_debug(LEVEL, ...) MuttLogger(0, __FILE__, __LINE__, __func__, LEVEL,      __VA_ARGS__)
+#endif
 #define mutt_warning(...)      MuttLogger(0, __FILE__, __LINE__, __func__, LL_WARNING, __VA_ARGS__)
 #define mutt_message(...)      MuttLogger(0, __FILE__, __LINE__, __func__, LL_MESSAGE, __VA_ARGS__)
 #define mutt_error(...)        MuttLogger(0, __FILE__, __LINE__, __func__, LL_ERROR,   __VA_ARGS__)
@@ -95,11 +100,15 @@ void log_queue_flush(log_dispatcher_t disp);
 int  log_queue_save(FILE *fp);
 void log_queue_set_max_size(int size);
 
+void log_file_clear_subsystems(void);
 void log_file_close(bool verbose);
+void log_file_flush(void);
 int  log_file_open(bool verbose);
 bool log_file_running(void);
 int  log_file_set_filename(const char *file, bool verbose);
 int  log_file_set_level(enum LogLevel level, bool verbose);
+int  log_file_set_subsystem(const char *name, enum LogLevel level);
 void log_file_set_version(const char *version);
+bool log_file_wanted(const char *file, enum LogLevel level);
 
 #endif /* MUTT_LIB_LOGGING_H */
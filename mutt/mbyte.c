@@ -30,6 +30,7 @@
 #include <ctype.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
@@ -42,6 +43,47 @@
 
 bool OptLocales; ///< (pseudo) set if user has valid locale definition
 
+/**
+ * mutt_mb_ascii_span - Count the printable ASCII characters at the start of a string
+ * @param s String to examine
+ * @param n Length of the string
+ * @retval num Number of leading bytes in the range 0x20-0x7e
+ *
+ * Each of these characters is one byte long and one screen column wide, so
+ * a run of them doesn't need to be decoded.  The string is checked eight
+ * bytes at a time.
+ *
+ * @note The caller must make sure that the string is at a character boundary
+ *       and that the encoding isn't in a shifted state.
+ */
+size_t mutt_mb_ascii_span(const char *s, size_t n)
+{
+  if (!s)
+    return 0;
+
+  const uint64_t ones = 0x0101010101010101ULL;
+  const uint64_t highs = 0x8080808080808080ULL;
+  const unsigned char *p = (const unsigned char *) s;
+  size_t i = 0;
+
+  for (; (i + sizeof(uint64_t)) <= n; i += sizeof(uint64_t))
+  {
+    uint64_t word;
+    memcpy(&word, p + i, sizeof(word));
+
+    /* Look for bytes >= 0x80, bytes < 0x20 and DEL (0x7f) */
+    const uint64_t ctrl = (word - (0x20 * ones)) & ~word;
+    const uint64_t del = word ^ (0x7f * ones);
+    if ((word | ctrl | ((del - ones) & ~del)) & highs)
+      break;
+  }
+
+  while ((i < n) && (p[i] >= 0x20) && (p[i] < 0x7f))
+    i++;
+
+  return i;
+}
+
 /**
  * mutt_mb_charlen - Count the bytes in a (multibyte) character
  * @param[in]  s     String to be examined
@@ -140,9 +182,20 @@ int mutt_mb_width(const char *str, int col, bool display)
   wchar_t wc;
   int l, w = 0, nl = 0;
   const char *p = str;
+  const size_t len = (str && CharsetIsUtf8) ? mutt_str_len(str) : 0;
 
   while (p && *p)
   {
+    if ((len != 0) && !nl)
+    {
+      /* Printable ASCII is one column per byte */
+      const size_t n = mutt_mb_ascii_span(p, len - (p - str));
+      w += n;
+      p += n;
+      if ((n != 0) || (*p == '\0'))
+        continue;
+    }
+
     if (mbtowc(&wc, p, MB_CUR_MAX) >= 0)
     {
       l = wcwidth(wc);
@@ -425,32 +478,66 @@ int mutt_mb_filter_unprintable(char **s)
   if (!s || !*s)
     return -1;
 
+  struct Buffer buf = mutt_buffer_make(0);
+  mutt_mb_buffer_filter_unprintable(&buf, *s);
+  FREE(s);
+  *s = buf.data ? buf.data : mutt_mem_calloc(1, 1);
+  return 0;
+}
+
+/**
+ * mutt_mb_buffer_filter_unprintable - Add a string to a Buffer, replacing unprintable characters
+ * @param buf Buffer for the result
+ * @param s   String to add
+ *
+ * Unprintable characters will be replaced with #ReplacementChar.
+ *
+ * The string is appended to the Buffer, so nothing needs to be allocated if
+ * the Buffer is big enough.
+ */
+void mutt_mb_buffer_filter_unprintable(struct Buffer *buf, const char *s)
+{
+  if (!buf || !s)
+    return;
+
   wchar_t wc;
   size_t k, k2;
   char scratch[MB_LEN_MAX + 1];
-  char *p = *s;
+  const char *p = s;
   mbstate_t mbstate1, mbstate2;
 
-  struct Buffer buf = mutt_buffer_make(0);
   memset(&mbstate1, 0, sizeof(mbstate1));
   memset(&mbstate2, 0, sizeof(mbstate2));
-  for (; (k = mbrtowc(&wc, p, MB_LEN_MAX, &mbstate1)); p += k)
+  while (*p)
   {
+    /* Copy any printable ASCII in one go */
+    const char *q = p;
+    while ((*q >= 0x20) && (*q < 0x7f))
+      q++;
+    if (q != p)
+    {
+      mutt_buffer_addstr_n(buf, p, q - p);
+      p = q;
+      continue;
+    }
+
+    k = mbrtowc(&wc, p, MB_LEN_MAX, &mbstate1);
+    if (k == 0)
+      break;
     if ((k == (size_t) -1) || (k == (size_t) -2))
     {
       k = 1;
       memset(&mbstate1, 0, sizeof(mbstate1));
       wc = ReplacementChar;
     }
+    p += k;
+
     if (!IsWPrint(wc))
       wc = '?';
     else if (CharsetIsUtf8 && mutt_mb_is_display_corrupting_utf8(wc))
       continue;
     k2 = wcrtomb(scratch, wc, &mbstate2);
-    scratch[k2] = '\0';
-    mutt_buffer_addstr(&buf, scratch);
+    if (k2 != (size_t) -1)
+      mutt_buffer_addstr_n(buf, scratch, k2);
   }
-  FREE(s);
-  *s = buf.data ? buf.data : mutt_mem_calloc(1, 1);
-  return 0;
 }
@@ -29,6 +29,8 @@
 #include <wchar.h> // IWYU pragma: keep
 #include <wctype.h> // IWYU pragma: keep
 
+struct Buffer;
+
 extern bool OptLocales;
 
 #ifdef LOCALES_HACK
@@ -39,7 +41,9 @@ extern bool OptLocales;
 #define IsWPrint(wc) (iswprint(wc) || (OptLocales ? 0 : (wc >= 0xa0)))
 #endif
 
+size_t mutt_mb_ascii_span(const char *s, size_t n);
 int    mutt_mb_charlen(const char *s, int *width);
+void   mutt_mb_buffer_filter_unprintable(struct Buffer *buf, const char *s);
 int    mutt_mb_filter_unprintable(char **s);
 bool   mutt_mb_get_initials(const char *name, char *buf, size_t buflen);
 bool   mutt_mb_is_display_corrupting_utf8(wchar_t wc);
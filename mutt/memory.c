@@ -27,6 +27,10 @@
  *
  * @note If any of the allocators fail, the user is notified and the program is
  *       stopped immediately.
+ *
+ * With `--debug-memory`, the biggest consumers of memory, e.g. Emails and Hash
+ * Tables, are accounted for.  Their constructors and destructors report the
+ * changes with MEM_ACCOUNT(), and mutt_mem_dump() lists the totals.
  */
 
 #include "config.h"
@@ -35,6 +39,35 @@
 #include "exit.h"
 #include "logging.h"
 #include "message.h"
+#ifdef USE_DEBUG_MEMORY
+#include <unistd.h>
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+#endif
+
+#ifdef USE_DEBUG_MEMORY
+/**
+ * struct MemAccount - Memory used by one #MemTag
+ */
+struct MemAccount
+{
+  long bytes;     ///< Bytes in use
+  long peak;      ///< Most bytes ever in use
+  long objects;   ///< Objects in use
+  long allocs;    ///< Objects ever created
+};
+
+/// Names of the #MemTag, for mutt_mem_dump()
+static const char *MemTagNames[MEM_TAG_MAX] = {
+  "Address", "Body", "Email", "Envelope", "Hash", "HeaderCache", "IMAP", "Pager",
+};
+
+static struct MemAccount MemAccounts[MEM_TAG_MAX]; ///< Memory used by each tag
+#ifdef USE_PTHREADS
+static pthread_mutex_t MemLock = PTHREAD_MUTEX_INITIALIZER; ///< Protects MemAccounts
+#endif
+#endif
 
 /**
  * mutt_mem_calloc - Allocate zeroed memory on the heap
@@ -137,3 +170,77 @@ void mutt_mem_realloc(void *ptr, size_t size)
 
   *p = r;
 }
+
+#ifdef USE_DEBUG_MEMORY
+/**
+ * mutt_mem_account - Record a change in the memory used by a tag
+ * @param tag     Kind of memory, e.g. #MEM_TAG_EMAIL
+ * @param bytes   Bytes allocated, negative if freed
+ * @param objects Objects created, negative if destroyed
+ *
+ * @note Use MEM_ACCOUNT(), which does nothing without `--debug-memory`
+ */
+void mutt_mem_account(enum MemTag tag, long bytes, long objects)
+{
+  if (tag >= MEM_TAG_MAX)
+    return;
+
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&MemLock);
+#endif
+  struct MemAccount *ma = &MemAccounts[tag];
+  ma->bytes += bytes;
+  if (ma->bytes > ma->peak)
+    ma->peak = ma->bytes;
+  ma->objects += objects;
+  if (objects > 0)
+    ma->allocs += objects;
+#ifdef USE_PTHREADS
+  pthread_mutex_unlock(&MemLock);
+#endif
+}
+
+/**
+ * mutt_mem_dump - Write a report of the memory used by each tag
+ * @param fp File to write to
+ *
+ * The process's resident size is shown, too, so the untracked memory can be
+ * estimated.
+ */
+void mutt_mem_dump(FILE *fp)
+{
+  fprintf(fp, "%-12s %12s %12s %12s %12s\n", "tag", "objects", "live KiB",
+          "peak KiB", "created");
+
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&MemLock);
+#endif
+  struct MemAccount total = { 0 };
+  for (int i = 0; i < MEM_TAG_MAX; i++)
+  {
+    const struct MemAccount *ma = &MemAccounts[i];
+    fprintf(fp, "%-12s %12ld %12.1f %12.1f %12ld\n", MemTagNames[i], ma->objects,
+            ma->bytes / 1024.0, ma->peak / 1024.0, ma->allocs);
+    total.bytes += ma->bytes;
+    total.objects += ma->objects;
+  }
+#ifdef USE_PTHREADS
+  pthread_mutex_unlock(&MemLock);
+#endif
+  fprintf(fp, "%-12s %12ld %12.1f\n", "total", total.objects, total.bytes / 1024.0);
+
+  /* Linux only, elsewhere the file won't exist */
+  FILE *fp_statm = fopen("/proc/self/statm", "r");
+  if (fp_statm)
+  {
+    long size = 0;
+    long resident = 0;
+    if (fscanf(fp_statm, "%ld %ld", &size, &resident) == 2)
+    {
+      fprintf(fp, "\n%-12s %12s %12.1f\n", "resident", "",
+              (resident * sysconf(_SC_PAGESIZE)) / 1024.0);
+    }
+    fclose(fp_statm);
+  }
+}
+#endif
@@ -24,6 +24,9 @@
 #define MUTT_LIB_MEMORY_H
 
 #include <stddef.h>
+#ifdef USE_DEBUG_MEMORY
+#include <stdio.h>
+#endif
 
 #undef MAX
 #undef MIN
@@ -39,4 +42,35 @@ void  mutt_mem_realloc(void *ptr, size_t size);
 
 #define FREE(x) mutt_mem_free(x)
 
+#ifdef USE_DEBUG_MEMORY
+/**
+ * enum MemTag - Kinds of memory that are accounted for
+ *
+ * The bytes are those of the objects themselves, not the strings they own.
+ */
+enum MemTag
+{
+  MEM_TAG_ADDRESS,   ///< struct Address
+  MEM_TAG_BODY,      ///< struct Body
+  MEM_TAG_EMAIL,     ///< struct Email
+  MEM_TAG_ENVELOPE,  ///< struct Envelope
+  MEM_TAG_HASH,      ///< Hash Tables, their slots and elements
+  MEM_TAG_HCACHE,    ///< Header cache handles and dictionary samples
+  MEM_TAG_IMAP,      ///< IMAP line buffers, MSN tables and Email data
+  MEM_TAG_PAGER,     ///< Pager line tables
+  MEM_TAG_MAX,
+};
+
+void mutt_mem_account(enum MemTag tag, long bytes, long objects);
+void mutt_mem_dump   (FILE *fp);
+
+/// Record a change in the memory used by a #MemTag
+#define MEM_ACCOUNT(TAG, BYTES, OBJECTS) mutt_mem_account(TAG, (long) (BYTES), OBJECTS)
+#else
+#define MEM_ACCOUNT(TAG, BYTES, OBJECTS)                                       \
+  do                                                                           \
+  {                                                                            \
+  } while (0)
+#endif
+
 #endif /* MUTT_LIB_MEMORY_H */
@@ -30,9 +30,20 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include "notify.h"
+#include "array.h"
 #include "memory.h"
 #include "queue.h"
 
+/**
+ * struct NotifyEvent - A notification held back by a batch
+ */
+struct NotifyEvent
+{
+  enum NotifyType type; ///< Type of event, e.g. #NT_ACCOUNT
+  int subtype;          ///< Subtype, e.g. #NT_ACCOUNT_ADD
+};
+ARRAY_HEAD(NotifyEventArray, struct NotifyEvent);
+
 /**
  * struct Notify - Notification API
  */
@@ -40,6 +51,8 @@ struct Notify
 {
   struct Notify *parent;
   struct ObserverList observers;
+  int batch;                       ///< Number of open batches, see notify_batch_begin()
+  struct NotifyEventArray pending; ///< Events held back by the batch
 };
 
 /**
@@ -68,6 +81,7 @@ void notify_free(struct Notify **ptr)
   // NOTIFY observers
 
   notify_observer_remove_all(notify);
+  ARRAY_FREE(&notify->pending);
 
   FREE(ptr);
 }
@@ -101,6 +115,9 @@ void notify_set_parent(struct Notify *notify, struct Notify *parent)
  * the Mailbox that owns it, the Account (owning the Mailbox) and finally the
  * NeoMutt object.
  *
+ * If a batch is open on a handler, events without private data stop there,
+ * see notify_batch_begin().
+ *
  * @note If Observers call `notify_observer_remove()`, then we garbage-collect
  *       any dead list entries after we've finished.
  */
@@ -110,6 +127,20 @@ static bool send(struct Notify *source, struct Notify *current,
   if (!source || !current)
     return false;
 
+  if ((current->batch > 0) && !event_data)
+  {
+    struct NotifyEvent *ev = NULL;
+    ARRAY_FOREACH(ev, &current->pending)
+    {
+      if ((ev->type == event_type) && (ev->subtype == event_subtype))
+        return true;
+    }
+
+    struct NotifyEvent ev_new = { event_type, event_subtype };
+    ARRAY_ADD(&current->pending, ev_new);
+    return true;
+  }
+
   // mutt_debug(LL_NOTIFY, "send: %d, %ld\n", event_type, event_data);
   struct ObserverNode *np = NULL;
   STAILQ_FOREACH(np, &current->observers, entries)
@@ -155,6 +186,60 @@ bool notify_send(struct Notify *notify, enum NotifyType event_type,
   return send(notify, notify, event_type, event_subtype, event_data);
 }
 
+/**
+ * notify_batch_begin - Start holding back notifications
+ * @param notify Notification handler
+ * @retval true Successful
+ *
+ * Until the matching notify_batch_end(), events without private data, that
+ * reach this handler, aren't sent any further.  Duplicate events are merged.
+ *
+ * Events with private data are sent at once, because their data may not
+ * outlive the call to notify_send().
+ *
+ * Batches may be nested.
+ */
+bool notify_batch_begin(struct Notify *notify)
+{
+  if (!notify)
+    return false;
+
+  notify->batch++;
+  return true;
+}
+
+/**
+ * notify_batch_end - Send the notifications held back by a batch
+ * @param notify Notification handler
+ * @retval true  Successful
+ * @retval false No batch was open
+ *
+ * When the outermost batch ends, each of the held events is sent once, in the
+ * order they first arrived, starting at this handler.
+ */
+bool notify_batch_end(struct Notify *notify)
+{
+  if (!notify || (notify->batch == 0))
+    return false;
+
+  notify->batch--;
+  if (notify->batch > 0)
+    return true;
+
+  /* Observers may send more events, so work on a copy */
+  struct NotifyEventArray pending = notify->pending;
+  ARRAY_INIT(&notify->pending);
+
+  struct NotifyEvent *ev = NULL;
+  ARRAY_FOREACH(ev, &pending)
+  {
+    send(notify, notify, ev->type, ev->subtype, NULL);
+  }
+  ARRAY_FREE(&pending);
+
+  return true;
+}
+
 /**
  * notify_observer_add - Add an observer to an object
  * @param notify      Notification handler
@@ -33,6 +33,9 @@ struct Notify *notify_new(void);
 void notify_free(struct Notify **ptr);
 void notify_set_parent(struct Notify *notify, struct Notify *parent);
 
+bool notify_batch_begin(struct Notify *notify);
+bool notify_batch_end(struct Notify *notify);
+
 bool notify_send(struct Notify *notify, enum NotifyType event_type, int event_subtype, void *event_data);
 bool notify_observer_add(struct Notify *notify, enum NotifyType type, observer_t callback, void *global_data);
 bool notify_observer_remove(struct Notify *notify, observer_t callback, void *global_data);
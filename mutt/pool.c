@@ -1,6 +1,6 @@
 /**
  * @file
- * A global pool of Buffers
+ * A per-thread pool of Buffers
  *
  * @authors
  * Copyright (C) 2019 Richard Russon <rich@flatcap.org>
@@ -21,33 +21,76 @@
  */
 
 /**
- * @page mutt_pool A global pool of Buffers
+ * @page mutt_pool A per-thread pool of Buffers
  *
- * A shared pool of Buffers to save lots of allocs/frees.
+ * A pool of Buffers to save lots of allocs/frees.
+ *
+ * Each thread has its own pool, so no locking is needed.  A Buffer may be
+ * released by a different thread to the one that got it.
+ *
+ * The Buffers are kept in size classes, so that one which has grown large,
+ * e.g. for an IMAP literal, isn't handed out for a short path.  Each class
+ * keeps a limited number of idle Buffers; any more are freed, so a burst of
+ * large Buffers doesn't hold on to memory forever.
  */
 
 #include "config.h"
-#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include "pool.h"
 #include "buffer.h"
-#include "logging.h"
 #include "memory.h"
 
-static size_t BufferPoolCount = 0;
-static size_t BufferPoolLen = 0;
-static size_t BufferPoolIncrement = 20;
-static size_t BufferPoolInitialBufferSize = 1024;
-static struct Buffer **BufferPool = NULL;
+/// Most idle Buffers kept in any size class
+#define POOL_MAX_IDLE 64
+
+/**
+ * struct PoolClass - A size class of pooled Buffers
+ */
+struct PoolClass
+{
+  size_t size;     ///< Size of the Buffers in the class
+  size_t max_idle; ///< Most idle Buffers to keep, at most #POOL_MAX_IDLE
+};
+
+/// Size classes, smallest first.  mutt_buffer_pool_get() uses the first.
+static const struct PoolClass PoolClasses[] = {
+  // clang-format off
+  {        1024, POOL_MAX_IDLE },
+  {   16 * 1024, 8 },
+  {  256 * 1024, 2 },
+  // clang-format on
+};
+
+/// Number of size classes
+#define POOL_NUM_CLASSES mutt_array_size(PoolClasses)
+
+/**
+ * struct BufferPool - A thread's idle Buffers
+ */
+struct BufferPool
+{
+  struct Buffer *idle[POOL_NUM_CLASSES][POOL_MAX_IDLE]; ///< Idle Buffers in each class
+  size_t count[POOL_NUM_CLASSES];                       ///< Number of idle Buffers in each class
+};
+
+#ifdef USE_PTHREADS
+static __thread struct BufferPool Pool = { 0 }; ///< This thread's pool
+#else
+static struct BufferPool Pool = { 0 }; ///< The pool
+#endif
 
 /**
  * buffer_new - Allocate a new Buffer on the heap
+ * @param size Size of the Buffer's data
  * @retval buf A newly allocated Buffer
  * @note call buffer_free to release the memory
  */
-static struct Buffer *buffer_new(void)
+static struct Buffer *buffer_new(size_t size)
 {
   struct Buffer *buf = mutt_mem_malloc(sizeof(struct Buffer));
   mutt_buffer_init(buf);
+  mutt_buffer_alloc(buf, size);
   return buf;
 }
 
@@ -65,71 +108,95 @@ static void buffer_free(struct Buffer **p)
 }
 
 /**
- * increase_buffer_pool - Increase the size of the Buffer pool
+ * pool_class_get - Get a Buffer of a size class
+ * @param cls Index of the size class
+ * @retval ptr Buffer
  */
-static void increase_buffer_pool(void)
+static struct Buffer *pool_class_get(size_t cls)
 {
-  BufferPoolLen += BufferPoolIncrement;
-  mutt_debug(LL_DEBUG1, "%zu\n", BufferPoolLen);
+  if (Pool.count[cls] == 0)
+    return buffer_new(PoolClasses[cls].size);
 
-  mutt_mem_realloc(&BufferPool, BufferPoolLen * sizeof(struct Buffer *));
-  while (BufferPoolCount < BufferPoolIncrement)
-  {
-    struct Buffer *newbuf = buffer_new();
-    mutt_buffer_alloc(newbuf, BufferPoolInitialBufferSize);
-    BufferPool[BufferPoolCount++] = newbuf;
-  }
+  return Pool.idle[cls][--Pool.count[cls]];
 }
 
 /**
  * mutt_buffer_pool_free - Release the Buffer pool
+ *
+ * Only this thread's idle Buffers are freed.  Each thread should call this
+ * before it exits.
  */
 void mutt_buffer_pool_free(void)
 {
-  mutt_debug(LL_DEBUG1, "%zu of %zu returned to pool\n", BufferPoolCount, BufferPoolLen);
-
-  while (BufferPoolCount)
-    buffer_free(&BufferPool[--BufferPoolCount]);
-  FREE(&BufferPool);
-  BufferPoolLen = 0;
+  for (size_t cls = 0; cls < POOL_NUM_CLASSES; cls++)
+  {
+    while (Pool.count[cls] > 0)
+      buffer_free(&Pool.idle[cls][--Pool.count[cls]]);
+  }
 }
 
 /**
  * mutt_buffer_pool_get - Get a Buffer from the pool
  * @retval ptr Buffer
+ *
+ * The Buffer is of the smallest class, big enough for most strings.
  */
 struct Buffer *mutt_buffer_pool_get(void)
 {
-  if (BufferPoolCount == 0)
-    increase_buffer_pool();
-  return BufferPool[--BufferPoolCount];
+  return pool_class_get(0);
+}
+
+/**
+ * mutt_buffer_pool_get_size - Get a large Buffer from the pool
+ * @param size Minimum size of the Buffer
+ * @retval ptr Buffer
+ *
+ * Use this when the Buffer is known to grow large, e.g. for a message body.
+ */
+struct Buffer *mutt_buffer_pool_get_size(size_t size)
+{
+  for (size_t cls = 0; cls < POOL_NUM_CLASSES; cls++)
+  {
+    if (PoolClasses[cls].size >= size)
+      return pool_class_get(cls);
+  }
+
+  /* Bigger than any class, it'll be shrunk when it's released */
+  return buffer_new(size);
 }
 
 /**
  * mutt_buffer_pool_release - Free a Buffer from the pool
  * @param[out] pbuf Buffer to free
+ *
+ * The Buffer joins the largest class that it fits.  If it has grown to more
+ * than twice that size, it's shrunk first.  If the class already has enough
+ * idle Buffers, it's freed.
  */
 void mutt_buffer_pool_release(struct Buffer **pbuf)
 {
   if (!pbuf || !*pbuf)
     return;
 
-  if (BufferPoolCount >= BufferPoolLen)
+  struct Buffer *buf = *pbuf;
+  *pbuf = NULL;
+
+  size_t cls = POOL_NUM_CLASSES - 1;
+  while ((cls > 0) && (buf->dsize < PoolClasses[cls].size))
+    cls--;
+
+  if (Pool.count[cls] >= PoolClasses[cls].max_idle)
   {
-    mutt_debug(LL_DEBUG1, "Internal buffer pool error\n");
-    buffer_free(pbuf);
+    buffer_free(&buf);
     return;
   }
 
-  struct Buffer *buf = *pbuf;
-  if ((buf->dsize > (2 * BufferPoolInitialBufferSize)) ||
-      (buf->dsize < BufferPoolInitialBufferSize))
+  const size_t size = PoolClasses[cls].size;
+  if ((buf->dsize > (2 * size)) || (buf->dsize < size))
   {
-    buf->dsize = BufferPoolInitialBufferSize;
+    buf->dsize = size;
     mutt_mem_realloc(&buf->data, buf->dsize);
   }
   mutt_buffer_reset(buf);
-  BufferPool[BufferPoolCount++] = buf;
-
-  *pbuf = NULL;
+  Pool.idle[cls][Pool.count[cls]++] = buf;
 }
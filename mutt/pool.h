@@ -1,6 +1,6 @@
 /**
  * @file
- * A global pool of Buffers
+ * A per-thread pool of Buffers
  *
  * @authors
  * Copyright (C) 2019 Richard Russon <rich@flatcap.org>
@@ -23,10 +23,13 @@
 #ifndef MUTT_LIB_POOL_H
 #define MUTT_LIB_POOL_H
 
+#include <stddef.h>
+
 struct Buffer;
 
 void           mutt_buffer_pool_free    (void);
 struct Buffer *mutt_buffer_pool_get     (void);
+struct Buffer *mutt_buffer_pool_get_size(size_t size);
 void           mutt_buffer_pool_release (struct Buffer **pbuf);
 
 #endif /* MUTT_LIB_POOL_H */
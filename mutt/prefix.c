@@ -0,0 +1,180 @@
+/**
+ * @file
+ * Match strings against a list of prefixes
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_prefix Match strings against a list of prefixes
+ *
+ * A PrefixSet gives the same answers as mutt_list_match(), but rather than
+ * comparing the string with every item in the List, it looks up each of the
+ * string's prefixes, of the lengths in the List, in a Hash Table.
+ *
+ * It's used for header weeding (ignore, unignore) and hdr_order, which are
+ * checked for every header line that's displayed.
+ *
+ * A PrefixSet doesn't follow changes to its List.  Free it when the List
+ * changes and create a new one when it's next needed.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prefix.h"
+#include "hash.h"
+#include "list.h"
+#include "memory.h"
+#include "queue.h"
+#include "string2.h"
+
+/**
+ * len_compare - Compare two lengths - Implements ::sort_t
+ */
+static int len_compare(const void *a, const void *b)
+{
+  const size_t la = *(const size_t *) a;
+  const size_t lb = *(const size_t *) b;
+
+  return (la > lb) - (la < lb);
+}
+
+/**
+ * mutt_prefixset_new - Compile a List of prefixes
+ * @param h List of prefixes, e.g. "X-", "Subject:"
+ * @retval ptr New PrefixSet
+ *
+ * The List may be empty.  The caller owns the PrefixSet and should free it
+ * with mutt_prefixset_free().
+ */
+struct PrefixSet *mutt_prefixset_new(const struct ListHead *h)
+{
+  struct PrefixSet *ps = mutt_mem_calloc(1, sizeof(*ps));
+  ps->hash = mutt_hash_new(32, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS);
+
+  if (!h)
+    return ps;
+
+  size_t num = 0;
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, h, entries)
+  {
+    num++;
+  }
+
+  ps->lens = mutt_mem_calloc(MAX(num, 1), sizeof(size_t));
+
+  int pos = 0;
+  STAILQ_FOREACH(np, h, entries)
+  {
+    pos++;
+    if (!np->data)
+      continue;
+
+    /* Like mutt_list_match(), anything starting with "*" matches everything */
+    if (np->data[0] == '*')
+    {
+      if (ps->star == 0)
+        ps->star = pos;
+      continue;
+    }
+
+    /* An empty prefix never matches */
+    if ((np->data[0] == '\0') || mutt_hash_find(ps->hash, np->data))
+      continue;
+
+    mutt_hash_insert(ps->hash, np->data, (void *) (intptr_t) pos);
+    ps->lens[ps->num_lens++] = mutt_str_len(np->data);
+  }
+
+  qsort(ps->lens, ps->num_lens, sizeof(size_t), len_compare);
+
+  size_t unique = 0;
+  for (size_t i = 0; i < ps->num_lens; i++)
+  {
+    if ((unique == 0) || (ps->lens[unique - 1] != ps->lens[i]))
+      ps->lens[unique++] = ps->lens[i];
+  }
+  ps->num_lens = unique;
+
+  return ps;
+}
+
+/**
+ * mutt_prefixset_free - Free a PrefixSet
+ * @param ptr PrefixSet to free
+ */
+void mutt_prefixset_free(struct PrefixSet **ptr)
+{
+  if (!ptr || !*ptr)
+    return;
+
+  struct PrefixSet *ps = *ptr;
+  mutt_hash_free(&ps->hash);
+  FREE(&ps->lens);
+  FREE(ptr);
+}
+
+/**
+ * mutt_prefixset_find - Find the first prefix of a string
+ * @param ps PrefixSet to search
+ * @param s  String to match, e.g. "Subject: Hello"
+ * @retval num Position in the List (counting from 1) of the first item that matches
+ * @retval 0   No item matches
+ *
+ * The case of the strings is ignored.
+ */
+int mutt_prefixset_find(const struct PrefixSet *ps, const char *s)
+{
+  if (!ps)
+    return 0;
+
+  int best = ps->star;
+  if ((best == 1) || !s || (ps->num_lens == 0))
+    return best;
+
+  /* Take a copy of the part of the string that could match */
+  const size_t max_len = ps->lens[ps->num_lens - 1];
+  char stack[128];
+  char *key = stack;
+  if (max_len >= sizeof(stack))
+    key = mutt_mem_malloc(max_len + 1);
+
+  size_t len = 0;
+  while ((len < max_len) && (s[len] != '\0'))
+    len++;
+  memcpy(key, s, len);
+
+  for (size_t i = 0; (i < ps->num_lens) && (ps->lens[i] <= len); i++)
+  {
+    key[ps->lens[i]] = '\0';
+    const int pos = (int) (intptr_t) mutt_hash_find(ps->hash, key);
+    key[ps->lens[i]] = s[ps->lens[i]];
+
+    if ((pos != 0) && ((best == 0) || (pos < best)))
+      best = pos;
+  }
+
+  if (key != stack)
+    FREE(&key);
+
+  return best;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file
+ * Match strings against a list of prefixes
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_PREFIX_H
+#define MUTT_LIB_PREFIX_H
+
+#include <stddef.h>
+
+struct ListHead;
+
+/**
+ * struct PrefixSet - A List of prefixes, compiled for quick matching
+ */
+struct PrefixSet
+{
+  struct HashTable *hash; ///< Prefix -> Position in the List
+  size_t *lens;           ///< Lengths of the prefixes, ascending, without repeats
+  size_t num_lens;        ///< Number of lengths
+  int star;               ///< Position of the first "*", or 0
+};
+
+void              mutt_prefixset_free(struct PrefixSet **ptr);
+int               mutt_prefixset_find(const struct PrefixSet *ps, const char *s);
+struct PrefixSet *mutt_prefixset_new (const struct ListHead *h);
+
+#endif /* MUTT_LIB_PREFIX_H */
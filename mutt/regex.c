@@ -35,10 +35,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include "buffer.h"
+#include "hash.h"
 #include "logging.h"
 #include "mbyte.h"
 #include "memory.h"
 #include "message.h"
+#include "pool.h"
 #include "queue.h"
 #include "regex3.h"
 #include "string2.h"
@@ -120,6 +122,91 @@ void mutt_regex_free(struct Regex **r)
   FREE(r);
 }
 
+/**
+ * mutt_regex_check - Cheaply check the syntax of a regex
+ * @param[in]  str  Regular expression
+ * @param[out] nsub Number of subexpressions (optional)
+ * @param[out] err  Buffer for error messages (optional)
+ * @retval true The regex looks valid
+ *
+ * This catches the common mistakes (unbalanced brackets and parentheses) in
+ * a fraction of the time that regcomp(3) takes, so that config errors can be
+ * reported without compiling every regex.  It never rejects a valid regex,
+ * but some invalid ones will only be found when they're compiled.
+ */
+bool mutt_regex_check(const char *str, size_t *nsub, struct Buffer *err)
+{
+  if (!str)
+    return false;
+
+  const char *msg = NULL;
+  size_t subs = 0;
+  int depth = 0;
+
+  for (const char *p = str; *p && !msg; p++)
+  {
+    if (*p == '\\')
+    {
+      if (p[1] == '\0')
+        msg = _("Trailing backslash");
+      else
+        p++;
+    }
+    else if (*p == '[')
+    {
+      /* A ']' straight after the '[' or '[^' is part of the list */
+      const char *q = p + 1;
+      if (*q == '^')
+        q++;
+      if (*q == ']')
+        q++;
+
+      while (*q && (*q != ']'))
+      {
+        /* Character classes, e.g. [:alpha:], are closed by ':]' */
+        if ((q[0] == '[') && ((q[1] == ':') || (q[1] == '.') || (q[1] == '=')))
+        {
+          const char *end = strchr(q + 2, ']');
+          if (end && (end[-1] == q[1]) && (end - 1 > q + 1))
+          {
+            q = end + 1;
+            continue;
+          }
+        }
+        q++;
+      }
+
+      if (*q == '\0')
+        msg = _("Unmatched [, [^, [:, [., or [=");
+      else
+        p = q;
+    }
+    else if (*p == '(')
+    {
+      depth++;
+      subs++;
+    }
+    else if ((*p == ')') && (depth > 0))
+    {
+      depth--;
+    }
+  }
+
+  if (!msg && (depth > 0))
+    msg = _("Unmatched ( or \\(");
+
+  if (msg)
+  {
+    if (err)
+      mutt_buffer_printf(err, "'%s': %s", str, msg);
+    return false;
+  }
+
+  if (nsub)
+    *nsub = subs;
+  return true;
+}
+
 /**
  * mutt_regexlist_add - Compile a regex string and add it to a list
  * @param rl    RegexList to add to
@@ -251,6 +338,169 @@ int mutt_regexlist_remove(struct RegexList *rl, const char *str)
   return rc;
 }
 
+/**
+ * regex_literal - Find the only string an anchored regex matches
+ * @param[in]  str Regular expression, e.g. `^john@example\.com$`
+ * @param[out] buf Buffer for the string, e.g. `john@example.com`
+ * @retval true The regex is a literal
+ *
+ * The regex must start with `^`, end with `$` and contain only ASCII
+ * characters that aren't special, or punctuation escaped with a backslash.
+ */
+static bool regex_literal(const char *str, struct Buffer *buf)
+{
+  const size_t len = mutt_str_len(str);
+  if ((len < 3) || (str[0] != '^') || (str[len - 1] != '$'))
+    return false;
+
+  mutt_buffer_reset(buf);
+  for (size_t i = 1; i < (len - 1); i++)
+  {
+    unsigned char c = str[i];
+    if (c == '\\')
+    {
+      c = str[++i];
+      /* \< \> \` \' are special, as are \w, \1, etc */
+      if ((i == (len - 1)) || !ispunct(c) || strchr("<>`'", c))
+        return false;
+    }
+    else if (!isgraph(c) && (c != ' '))
+    {
+      return false;
+    }
+    else if (strchr(".[]()*+?{}|^$", c))
+    {
+      return false;
+    }
+
+    mutt_buffer_addch(buf, c);
+  }
+
+  return true;
+}
+
+/**
+ * mutt_regexset_add - Add a regex to a RegexSet
+ * @param rs    RegexSet to add to
+ * @param str   Regular expression
+ * @param flags Flags, e.g. REG_ICASE
+ * @param err   Buffer for error messages
+ * @retval  0 Success, regex added to the RegexSet
+ * @retval -1 Error, see message in 'err'
+ *
+ * A literal regex is only stored as a string if it ignores case.
+ */
+int mutt_regexset_add(struct RegexSet *rs, const char *str, uint16_t flags,
+                      struct Buffer *err)
+{
+  if (!rs || !str || (*str == '\0'))
+    return 0;
+
+  if (flags & REG_ICASE)
+  {
+    struct Buffer *buf = mutt_buffer_pool_get();
+    const bool literal = regex_literal(str, buf);
+    if (literal)
+    {
+      if (!rs->literals)
+        rs->literals = mutt_hash_new(128, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS);
+      if (!mutt_hash_find(rs->literals, mutt_buffer_string(buf)))
+        mutt_hash_insert(rs->literals, mutt_buffer_string(buf), rs);
+    }
+    mutt_buffer_pool_release(&buf);
+    if (literal)
+      return 0;
+  }
+
+  return mutt_regexlist_add(&rs->regexes, str, flags, err);
+}
+
+/**
+ * mutt_regexset_free - Free the contents of a RegexSet
+ * @param rs RegexSet to empty
+ */
+void mutt_regexset_free(struct RegexSet *rs)
+{
+  if (!rs)
+    return;
+
+  mutt_regexlist_free(&rs->regexes);
+  mutt_hash_free(&rs->literals);
+}
+
+/**
+ * mutt_regexset_is_empty - Is a RegexSet empty?
+ * @param rs RegexSet to check
+ * @retval true The RegexSet has no regexes
+ */
+bool mutt_regexset_is_empty(const struct RegexSet *rs)
+{
+  if (!rs)
+    return true;
+
+  if (!STAILQ_EMPTY(&rs->regexes))
+    return false;
+  if (!rs->literals)
+    return true;
+
+  struct HashWalkState state = { 0 };
+  return !mutt_hash_walk(rs->literals, &state);
+}
+
+/**
+ * mutt_regexset_match - Does a string match a RegexSet?
+ * @param rs  RegexSet to match against
+ * @param str String to compare
+ * @retval true String matches one of the regexes
+ */
+bool mutt_regexset_match(const struct RegexSet *rs, const char *str)
+{
+  if (!rs || !str)
+    return false;
+
+  if (rs->literals && mutt_hash_find(rs->literals, str))
+  {
+    mutt_debug(LL_DEBUG5, "%s matches a literal\n", str);
+    return true;
+  }
+
+  return mutt_regexlist_match((struct RegexList *) &rs->regexes, str);
+}
+
+/**
+ * mutt_regexset_remove - Remove a regex from a RegexSet
+ * @param rs  RegexSet to alter
+ * @param str Regular expression to remove
+ * @retval  0 Success, regex was found and removed
+ * @retval -1 Error, regex wasn't found
+ *
+ * If the regex is "*", then all the regexes are removed.
+ */
+int mutt_regexset_remove(struct RegexSet *rs, const char *str)
+{
+  if (!rs || !str)
+    return -1;
+
+  if (mutt_str_equal("*", str))
+  {
+    mutt_regexset_free(rs);
+    return 0;
+  }
+
+  int rc = mutt_regexlist_remove(&rs->regexes, str);
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+  if (rs->literals && regex_literal(str, buf) &&
+      mutt_hash_find(rs->literals, mutt_buffer_string(buf)))
+  {
+    mutt_hash_delete(rs->literals, mutt_buffer_string(buf), NULL);
+    rc = 0;
+  }
+  mutt_buffer_pool_release(&buf);
+
+  return rc;
+}
+
 /**
  * mutt_replacelist_add - Add a pattern and a template to a list
  * @param rl    ReplaceList to add to
@@ -266,14 +516,18 @@ int mutt_replacelist_add(struct ReplaceList *rl, const char *pat,
   if (!rl || !pat || (*pat == '\0') || !templ)
     return 0;
 
-  struct Regex *rx = mutt_regex_compile(pat, REG_ICASE);
-  if (!rx)
+  /* The regex is compiled when it's first used, see replace_compile() */
+  size_t nsub = 0;
+  if (!mutt_regex_check(pat, &nsub, NULL))
   {
     if (err)
       mutt_buffer_printf(err, _("Bad regex: %s"), pat);
     return -1;
   }
 
+  struct Regex *rx = mutt_mem_calloc(1, sizeof(struct Regex));
+  rx->pattern = mutt_str_dup(pat);
+
   /* check to make sure the item is not already on this rl */
   struct Replace *np = NULL;
   STAILQ_FOREACH(np, rl, entries)
@@ -325,7 +579,7 @@ int mutt_replacelist_add(struct ReplaceList *rl, const char *pat,
       p++;
   }
 
-  if (np->nmatch > np->regex->regex->re_nsub)
+  if (np->nmatch > nsub)
   {
     if (err)
       mutt_buffer_printf(err, "%s", _("Not enough subexpressions for template"));
@@ -337,6 +591,33 @@ int mutt_replacelist_add(struct ReplaceList *rl, const char *pat,
   return 0;
 }
 
+/**
+ * replace_compile - Compile a Replace's regex on first use
+ * @param np Replace
+ * @retval true The regex is ready to use
+ *
+ * If the regex doesn't compile, the error is shown once and it never matches.
+ */
+static bool replace_compile(struct Replace *np)
+{
+  if (np->regex->regex)
+    return true;
+  if (np->broken)
+    return false;
+
+  regex_t *rx = mutt_mem_calloc(1, sizeof(regex_t));
+  if (REG_COMP(rx, np->regex->pattern, REG_ICASE) != 0)
+  {
+    mutt_error(_("Bad regex: %s"), np->regex->pattern);
+    FREE(&rx);
+    np->broken = true;
+    return false;
+  }
+
+  np->regex->regex = rx;
+  return true;
+}
+
 /**
  * mutt_replacelist_apply - Apply replacements to a buffer
  * @param rl     ReplaceList to apply
@@ -383,7 +664,7 @@ char *mutt_replacelist_apply(struct ReplaceList *rl, char *buf, size_t buflen, c
       nmatch = np->nmatch;
     }
 
-    if (mutt_regex_capture(np->regex, src, np->nmatch, pmatch))
+    if (replace_compile(np) && mutt_regex_capture(np->regex, src, np->nmatch, pmatch))
     {
       tlen = 0;
       switcher ^= 1;
@@ -494,7 +775,7 @@ bool mutt_replacelist_match(struct ReplaceList *rl, char *buf, size_t buflen, co
     }
 
     /* Does this pattern match? */
-    if (mutt_regex_capture(np->regex, str, (size_t) np->nmatch, pmatch))
+    if (replace_compile(np) && mutt_regex_capture(np->regex, str, (size_t) np->nmatch, pmatch))
     {
       mutt_debug(LL_DEBUG5, "%s matches %s\n", str, np->regex->pattern);
       mutt_debug(LL_DEBUG5, "%d subs\n", (int) np->regex->regex->re_nsub);
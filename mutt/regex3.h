@@ -25,12 +25,64 @@
 
 #include "config.h"
 #include <stddef.h>
+#ifndef USE_PCRE2_REGEX
 #include <regex.h>
+#endif
 #include <stdbool.h>
 #include <stdint.h>
 #include "queue.h"
 
 struct Buffer;
+struct HashTable;
+
+#ifdef USE_PCRE2_REGEX
+/* The POSIX regex API, implemented with PCRE2, see mutt/regex_pcre2.c */
+#define REG_EXTENDED (1 << 0) ///< Extended regular expressions (always used)
+#define REG_ICASE    (1 << 1) ///< Case-insensitive matching
+#define REG_NEWLINE  (1 << 2) ///< '^' and '$' match at newlines, '.' doesn't match one
+#define REG_NOSUB    (1 << 3) ///< Don't report the position of the match
+
+#define REG_NOTBOL   (1 << 0) ///< The start of the string isn't the start of a line
+#define REG_NOTEOL   (1 << 1) ///< The end of the string isn't the end of a line
+
+#define REG_NOMATCH  1 ///< The string doesn't match
+#define REG_BADPAT   2 ///< The regex is invalid
+#define REG_ESPACE   3 ///< Out of memory
+
+typedef int regoff_t;
+
+/**
+ * regmatch_t - A match of a regular expression, or of a subexpression
+ */
+typedef struct
+{
+  regoff_t rm_so; ///< Offset of the start of the match, -1 if unused
+  regoff_t rm_eo; ///< Offset after the end of the match
+} regmatch_t;
+
+/**
+ * regex_t - A regular expression, compiled by PCRE2
+ */
+typedef struct
+{
+  void *re_code;       ///< Compiled expression, pcre2_code
+  size_t re_nsub;      ///< Number of subexpressions
+  int re_cflags;       ///< Flags used to compile it, e.g. #REG_NOSUB
+  int re_error;        ///< PCRE2 error code, if it didn't compile
+  size_t re_erroffset; ///< Where in the regex the error was found
+} regex_t;
+
+int    mutt_pcre2_regcomp (regex_t *preg, const char *regex, int cflags);
+size_t mutt_pcre2_regerror(int errcode, const regex_t *preg, char *errbuf, size_t errbuf_size);
+int    mutt_pcre2_regexec (const regex_t *preg, const char *str, size_t nmatch, regmatch_t pmatch[], int eflags);
+void   mutt_pcre2_regfree (regex_t *preg);
+void   mutt_pcre2_thread_free(void);
+
+#define regcomp  mutt_pcre2_regcomp
+#define regerror mutt_pcre2_regerror
+#define regexec  mutt_pcre2_regexec
+#define regfree  mutt_pcre2_regfree
+#endif
 
 /* ... DT_REGEX */
 #define DT_REGEX_MATCH_CASE (1 << 6)  ///< Case-sensitive matching
@@ -103,6 +155,19 @@ struct RegexNode
 };
 STAILQ_HEAD(RegexList, RegexNode);
 
+/**
+ * struct RegexSet - A list of regexes, with the literal ones in a hash
+ *
+ * A case-insensitive regex such as `^john@example\.com$` can only match one
+ * string.  Those regexes are kept as strings, so they can be matched with a
+ * single lookup, however many there are.
+ */
+struct RegexSet
+{
+  struct RegexList regexes;   ///< Regexes that aren't literals
+  struct HashTable *literals; ///< Strings matched by the literal regexes
+};
+
 /**
  * struct Replace - List of regular expressions
  */
@@ -111,10 +176,12 @@ struct Replace
   struct Regex *regex;           ///< Regex containing a regular expression
   size_t nmatch;                 ///< Match the 'nth' occurrence (0 means the whole expression)
   char *templ;                   ///< Template to match
+  bool broken;                   ///< The regex didn't compile
   STAILQ_ENTRY(Replace) entries; ///< Linked list
 };
 STAILQ_HEAD(ReplaceList, Replace);
 
+bool          mutt_regex_check(const char *str, size_t *nsub, struct Buffer *err);
 struct Regex *mutt_regex_compile(const char *str, uint16_t flags);
 struct Regex *mutt_regex_new(const char *str, uint32_t flags, struct Buffer *err);
 void          mutt_regex_free(struct Regex **r);
@@ -125,6 +192,12 @@ bool              mutt_regexlist_match (struct RegexList *rl, const char *str);
 struct RegexNode *mutt_regexlist_new   (void);
 int               mutt_regexlist_remove(struct RegexList *rl, const char *str);
 
+int  mutt_regexset_add     (struct RegexSet *rs, const char *str, uint16_t flags, struct Buffer *err);
+void mutt_regexset_free    (struct RegexSet *rs);
+bool mutt_regexset_is_empty(const struct RegexSet *rs);
+bool mutt_regexset_match   (const struct RegexSet *rs, const char *str);
+int  mutt_regexset_remove  (struct RegexSet *rs, const char *str);
+
 int             mutt_replacelist_add   (struct ReplaceList *rl, const char *pat, const char *templ, struct Buffer *err);
 char *          mutt_replacelist_apply (struct ReplaceList *rl, char *buf, size_t buflen, const char *str);
 void            mutt_replacelist_free  (struct ReplaceList *rl);
@@ -0,0 +1,342 @@
+/**
+ * @file
+ * POSIX regular expressions, implemented with PCRE2
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_regex_pcre2 POSIX regular expressions, implemented with PCRE2
+ *
+ * When NeoMutt is configured with `--pcre2-regex`, the POSIX functions
+ * regcomp(), regexec(), regerror() and regfree() are replaced by these.
+ * PCRE2 compiles each regex to machine code (JIT), which is much faster than
+ * the C library for alternations and case-insensitive matching.
+ *
+ * The regex is translated from POSIX extended syntax, first:
+ * - A backslash in a bracket expression is a literal, e.g. `[\]`
+ * - An unmatched `)` is a literal
+ * - `\<` and `\>` match the start and end of a word
+ *
+ * Without #REG_NEWLINE, `.` matches a newline and `$` only matches at the end
+ * of the string, as in POSIX.
+ *
+ * The differences that remain:
+ * - Where alternatives match at the same place, the first one wins, rather
+ *   than the longest.
+ * - Collating elements, e.g. `[[.hyphen.]]`, aren't supported.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "regex3.h"
+#include "buffer.h"
+#include "charset.h"
+#include "memory.h"
+#include "pool.h"
+#include "string2.h"
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
+#ifdef USE_PTHREADS
+/// This thread's space for the results of a match
+static __thread pcre2_match_data *MatchData = NULL;
+/// Number of matches that #MatchData can hold
+static __thread uint32_t MatchDataSize = 0;
+#else
+/// Space for the results of a match
+static pcre2_match_data *MatchData = NULL;
+/// Number of matches that #MatchData can hold
+static uint32_t MatchDataSize = 0;
+#endif
+
+/**
+ * regex_translate - Convert a POSIX extended regex to PCRE2 syntax
+ * @param[in]  regex POSIX regular expression
+ * @param[out] buf   Buffer for the PCRE2 regular expression
+ */
+static void regex_translate(const char *regex, struct Buffer *buf)
+{
+  int depth = 0;
+
+  for (const char *p = regex; *p; p++)
+  {
+    if (p[0] == '\\')
+    {
+      if (p[1] == '<')
+        mutt_buffer_addstr(buf, "\\b(?=\\w)");
+      else if (p[1] == '>')
+        mutt_buffer_addstr(buf, "\\b(?<=\\w)");
+      else if (p[1] != '\0')
+        mutt_buffer_addstr_n(buf, p, 2);
+      else
+        mutt_buffer_addch(buf, '\\'); // Let PCRE2 report the error
+
+      if (p[1] != '\0')
+        p++;
+      continue;
+    }
+
+    if (p[0] == '(')
+    {
+      depth++;
+    }
+    else if (p[0] == ')')
+    {
+      if (depth == 0)
+      {
+        mutt_buffer_addstr(buf, "\\)");
+        continue;
+      }
+      depth--;
+    }
+    else if (p[0] == '[')
+    {
+      mutt_buffer_addch(buf, *p++);
+      if (*p == '^')
+        mutt_buffer_addch(buf, *p++);
+      if (*p == ']')
+      {
+        mutt_buffer_addstr(buf, "\\]");
+        p++;
+      }
+
+      for (; *p && (*p != ']'); p++)
+      {
+        if ((p[0] == '[') && ((p[1] == ':') || (p[1] == '.') || (p[1] == '=')))
+        {
+          /* A character class, e.g. [:alpha:] */
+          const char *end = strstr(p + 2, (p[1] == ':') ? ":]" : (p[1] == '.') ? ".]" : "=]");
+          if (end)
+          {
+            mutt_buffer_addstr_n(buf, p, end + 2 - p);
+            p = end + 1;
+            continue;
+          }
+        }
+
+        if (*p == '\\')
+          mutt_buffer_addch(buf, '\\');
+        mutt_buffer_addch(buf, *p);
+      }
+
+      if (*p == '\0')
+        break; // Let PCRE2 report the unterminated bracket
+    }
+
+    mutt_buffer_addch(buf, *p);
+  }
+}
+
+/**
+ * mutt_pcre2_regcomp - Compile a regular expression
+ * @param preg   Regex to fill in
+ * @param regex  Regular expression, POSIX extended syntax
+ * @param cflags Flags, e.g. #REG_ICASE
+ * @retval 0   Success
+ * @retval num Error, e.g. #REG_BADPAT
+ */
+int mutt_pcre2_regcomp(regex_t *preg, const char *regex, int cflags)
+{
+  if (!preg || !regex)
+    return REG_BADPAT;
+
+  memset(preg, 0, sizeof(*preg));
+  preg->re_cflags = cflags;
+
+  uint32_t opt = 0;
+  if (cflags & REG_ICASE)
+    opt |= PCRE2_CASELESS;
+  if (cflags & REG_NEWLINE)
+    opt |= PCRE2_MULTILINE;
+  else
+    opt |= PCRE2_DOTALL | PCRE2_DOLLAR_ENDONLY;
+
+#ifdef PCRE2_MATCH_INVALID_UTF
+  /* Match characters, not bytes, like the C library in a UTF-8 locale */
+  uint32_t unicode = 0;
+  pcre2_config(PCRE2_CONFIG_UNICODE, &unicode);
+  if (CharsetIsUtf8 && unicode)
+    opt |= PCRE2_UTF | PCRE2_UCP | PCRE2_MATCH_INVALID_UTF;
+#endif
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+  regex_translate(regex, buf);
+
+  int err = 0;
+  PCRE2_SIZE erroffset = 0;
+  pcre2_code *code = pcre2_compile((PCRE2_SPTR8) mutt_buffer_string(buf),
+                                   mutt_buffer_len(buf), opt, &err, &erroffset, NULL);
+  mutt_buffer_pool_release(&buf);
+
+  if (!code)
+  {
+    preg->re_error = err;
+    preg->re_erroffset = erroffset;
+    return (err == PCRE2_ERROR_HEAPLIMIT) ? REG_ESPACE : REG_BADPAT;
+  }
+
+  /* Without JIT support, PCRE2 interprets the regex instead */
+  pcre2_jit_compile(code, PCRE2_JIT_COMPLETE);
+
+  uint32_t nsub = 0;
+  pcre2_pattern_info(code, PCRE2_INFO_CAPTURECOUNT, &nsub);
+
+  preg->re_code = code;
+  preg->re_nsub = nsub;
+  return 0;
+}
+
+/**
+ * mutt_pcre2_regexec - Match a regular expression against a string
+ * @param preg   Compiled regex
+ * @param str    String to match
+ * @param nmatch Number of entries in @a pmatch
+ * @param pmatch Positions of the match and its subexpressions
+ * @param eflags Flags, e.g. #REG_NOTBOL
+ * @retval 0            The string matches
+ * @retval #REG_NOMATCH The string doesn't match
+ * @retval #REG_ESPACE  The match failed, e.g. it hit one of PCRE2's limits
+ *
+ * The regex may be used by several threads at once, so the results go in
+ * space belonging to the thread.  This may run on a worker thread, so it
+ * mustn't log.
+ */
+int mutt_pcre2_regexec(const regex_t *preg, const char *str, size_t nmatch,
+                       regmatch_t pmatch[], int eflags)
+{
+  if (!preg || !preg->re_code || !str)
+    return REG_NOMATCH;
+
+  if (preg->re_cflags & REG_NOSUB)
+    nmatch = 0;
+
+  const uint32_t size = MAX(nmatch, 1);
+  if (!MatchData || (MatchDataSize < size))
+  {
+    pcre2_match_data_free(MatchData);
+    MatchData = pcre2_match_data_create(size, NULL);
+    MatchDataSize = MatchData ? size : 0;
+    if (!MatchData)
+      return REG_ESPACE;
+  }
+
+  uint32_t opt = 0;
+  if (eflags & REG_NOTBOL)
+    opt |= PCRE2_NOTBOL;
+  if (eflags & REG_NOTEOL)
+    opt |= PCRE2_NOTEOL;
+
+  const pcre2_code *code = preg->re_code;
+  const size_t len = strlen(str);
+  int rc = pcre2_match(code, (PCRE2_SPTR8) str, len, 0, opt, MatchData, NULL);
+  if (rc == PCRE2_ERROR_JIT_STACKLIMIT)
+  {
+    /* The interpreter isn't limited by the JIT's stack */
+    rc = pcre2_match(code, (PCRE2_SPTR8) str, len, 0, opt | PCRE2_NO_JIT, MatchData, NULL);
+  }
+
+  if (rc == PCRE2_ERROR_NOMATCH)
+    return REG_NOMATCH;
+  if (rc < 0)
+    return REG_ESPACE;
+
+  /* rc == 0 means that all the space was used */
+  const size_t found = (rc == 0) ? MatchDataSize : rc;
+  const PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(MatchData);
+  for (size_t i = 0; i < nmatch; i++)
+  {
+    if ((i < found) && (ovector[i * 2] != PCRE2_UNSET))
+    {
+      pmatch[i].rm_so = ovector[i * 2];
+      pmatch[i].rm_eo = ovector[i * 2 + 1];
+    }
+    else
+    {
+      pmatch[i].rm_so = -1;
+      pmatch[i].rm_eo = -1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * mutt_pcre2_regerror - Describe a regex error
+ * @param errcode     Error, e.g. #REG_BADPAT
+ * @param preg        Regex that caused the error
+ * @param errbuf      Buffer for the message
+ * @param errbuf_size Length of the buffer
+ * @retval num Size needed for the whole message, including the terminating NUL
+ */
+size_t mutt_pcre2_regerror(int errcode, const regex_t *preg, char *errbuf, size_t errbuf_size)
+{
+  char msg[256] = { 0 };
+
+  if ((errcode == REG_BADPAT) && preg && (preg->re_error != 0))
+  {
+    PCRE2_UCHAR pmsg[192];
+    pcre2_get_error_message(preg->re_error, pmsg, sizeof(pmsg));
+    snprintf(msg, sizeof(msg), "%s at offset %zu", (const char *) pmsg, preg->re_erroffset);
+  }
+  else if (errcode == REG_NOMATCH)
+  {
+    mutt_str_copy(msg, "No match", sizeof(msg));
+  }
+  else if (errcode == REG_ESPACE)
+  {
+    mutt_str_copy(msg, "Out of memory", sizeof(msg));
+  }
+  else
+  {
+    mutt_str_copy(msg, "Invalid regular expression", sizeof(msg));
+  }
+
+  if (errbuf && (errbuf_size > 0))
+    mutt_str_copy(errbuf, msg, errbuf_size);
+
+  return mutt_str_len(msg) + 1;
+}
+
+/**
+ * mutt_pcre2_thread_free - Free this thread's space for match results
+ *
+ * Each thread that has matched a regex should call this before it exits.
+ */
+void mutt_pcre2_thread_free(void)
+{
+  pcre2_match_data_free(MatchData);
+  MatchData = NULL;
+  MatchDataSize = 0;
+}
+
+/**
+ * mutt_pcre2_regfree - Free a compiled regex
+ * @param preg Regex to free
+ */
+void mutt_pcre2_regfree(regex_t *preg)
+{
+  if (!preg)
+    return;
+
+  pcre2_code_free(preg->re_code);
+  preg->re_code = NULL;
+}
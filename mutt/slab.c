@@ -0,0 +1,146 @@
+/**
+ * @file
+ * Fixed-size object allocator
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_slab Fixed-size object allocator
+ *
+ * Allocate lots of objects of the same size, e.g. one for every Email in a
+ * Mailbox, without calling malloc() for each one.
+ *
+ * The objects are packed together in large chunks, which keeps them close in
+ * memory and avoids the per-allocation overhead of the heap.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <string.h>
+#include "slab.h"
+#include "memory.h"
+
+/// Alignment of the objects handed out by the Slab
+#define SLAB_ALIGN 16
+/// Size of a block of memory holding the objects
+#define SLAB_CHUNK_SIZE (64 * 1024)
+
+/**
+ * struct SlabChunk - A block of memory holding Slab objects
+ */
+struct SlabChunk
+{
+  struct SlabChunk *next; ///< Next chunk
+};
+
+/**
+ * slab_header_size - Get the size of the chunk header
+ * @retval num Size, rounded up to the object alignment
+ */
+static size_t slab_header_size(void)
+{
+  return (sizeof(struct SlabChunk) + SLAB_ALIGN - 1) & ~(size_t) (SLAB_ALIGN - 1);
+}
+
+/**
+ * slab_object_size - Get the space taken by one object
+ * @param slab Slab
+ * @retval num Size, rounded up to the object alignment
+ */
+static size_t slab_object_size(const struct Slab *slab)
+{
+  size_t size = (slab->size < sizeof(void *)) ? sizeof(void *) : slab->size;
+  return (size + SLAB_ALIGN - 1) & ~(size_t) (SLAB_ALIGN - 1);
+}
+
+/**
+ * slab_grow - Add a chunk of objects to the Slab
+ * @param slab Slab
+ */
+static void slab_grow(struct Slab *slab)
+{
+  const size_t header = slab_header_size();
+  const size_t size = slab_object_size(slab);
+
+  size_t count = (SLAB_CHUNK_SIZE - header) / size;
+  if (count == 0)
+    count = 1;
+
+  struct SlabChunk *chunk = mutt_mem_malloc(header + (count * size));
+  chunk->next = slab->chunks;
+  slab->chunks = chunk;
+
+  /* Thread the new objects onto the free list, lowest address first */
+  char *obj = (char *) chunk + header + ((count - 1) * size);
+  for (size_t i = 0; i < count; i++, obj -= size)
+  {
+    *(void **) obj = slab->free_list;
+    slab->free_list = obj;
+  }
+}
+
+/**
+ * mutt_slab_alloc - Allocate an object from a Slab
+ * @param slab Slab
+ * @retval ptr Zeroed object
+ *
+ * The object must be released with mutt_slab_free(), using the same Slab.
+ */
+void *mutt_slab_alloc(struct Slab *slab)
+{
+  if (!slab)
+    return NULL;
+
+  if (!slab->free_list)
+    slab_grow(slab);
+
+  void *obj = slab->free_list;
+  slab->free_list = *(void **) obj;
+  slab->used++;
+
+  memset(obj, 0, slab->size);
+  return obj;
+}
+
+/**
+ * mutt_slab_free - Return an object to its Slab
+ * @param slab Slab
+ * @param ptr  Object to free
+ *
+ * When the last object has been returned, all the Slab's memory is released.
+ */
+void mutt_slab_free(struct Slab *slab, void *ptr)
+{
+  if (!slab || !ptr)
+    return;
+
+  *(void **) ptr = slab->free_list;
+  slab->free_list = ptr;
+
+  if (--slab->used > 0)
+    return;
+
+  while (slab->chunks)
+  {
+    struct SlabChunk *next = slab->chunks->next;
+    FREE(&slab->chunks);
+    slab->chunks = next;
+  }
+  slab->free_list = NULL;
+}
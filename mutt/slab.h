@@ -0,0 +1,50 @@
+/**
+ * @file
+ * Fixed-size object allocator
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_SLAB_H
+#define MUTT_LIB_SLAB_H
+
+#include <stddef.h>
+
+struct SlabChunk;
+
+/**
+ * struct Slab - A cache of fixed-size objects
+ *
+ * Objects are carved out of large chunks, so that many small allocations
+ * share a few blocks of memory.  Freed objects are kept on a list for reuse.
+ * When the last object has been freed, the chunks are returned to the system.
+ */
+struct Slab
+{
+  size_t size;              ///< Size of an object
+  void *free_list;          ///< Objects ready for reuse
+  struct SlabChunk *chunks; ///< Blocks of memory holding the objects
+  size_t used;              ///< Number of objects in use
+};
+
+#define MUTT_SLAB_INIT(type) { sizeof(type), NULL, NULL, 0 }
+
+void *mutt_slab_alloc(struct Slab *slab);
+void  mutt_slab_free (struct Slab *slab, void *ptr);
+
+#endif /* MUTT_LIB_SLAB_H */
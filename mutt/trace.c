@@ -0,0 +1,269 @@
+/**
+ * @file
+ * Record a trace of what NeoMutt is doing
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_trace Record a trace of what NeoMutt is doing
+ *
+ * The trace is written in the Chrome trace event format (JSON), which can be
+ * loaded into Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+ *
+ * - TRACE_SCOPE() records how long the rest of a block takes
+ * - trace_async_begin() and trace_async_end() record something that starts
+ *   and finishes in different places, e.g. an IMAP command and its response
+ *
+ * When the trace isn't running, each TRACE_SCOPE() costs a single test.
+ *
+ * Events may be recorded from any thread.  Each thread is shown separately.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "trace.h"
+#include "file.h"
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#endif
+
+bool TraceEnabled = false; ///< Is the trace running?
+
+static FILE *TraceFP = NULL;         ///< Trace file
+static uint64_t TraceStart = 0;      ///< When the trace started, in nanoseconds
+static bool TraceFirst = true;       ///< Is the next event the first in the file?
+static int TraceThreads = 0;         ///< Number of threads that have recorded events
+static __thread int TraceTid = 0;    ///< This thread's id in the trace
+#ifdef USE_PTHREADS
+static pthread_mutex_t TraceLock = PTHREAD_MUTEX_INITIALIZER; ///< Protects the trace file
+#endif
+
+/**
+ * trace_lock - Lock the trace file
+ */
+static void trace_lock(void)
+{
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&TraceLock);
+#endif
+}
+
+/**
+ * trace_unlock - Unlock the trace file
+ */
+static void trace_unlock(void)
+{
+#ifdef USE_PTHREADS
+  pthread_mutex_unlock(&TraceLock);
+#endif
+}
+
+/**
+ * trace_now - Get the time, for the trace
+ * @retval num Nanoseconds since an arbitrary point
+ */
+static uint64_t trace_now(void)
+{
+  struct timespec ts = { 0 };
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t) ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+/**
+ * trace_string - Write a JSON string
+ * @param str String to write
+ *
+ * @note The caller must hold the lock
+ */
+static void trace_string(const char *str)
+{
+  fputc('"', TraceFP);
+  for (const unsigned char *s = (const unsigned char *) str; s && *s; s++)
+  {
+    if ((*s == '"') || (*s == '\\'))
+      fprintf(TraceFP, "\\%c", *s);
+    else if (*s < 0x20)
+      fprintf(TraceFP, "\\u%04x", *s);
+    else
+      fputc(*s, TraceFP);
+  }
+  fputc('"', TraceFP);
+}
+
+/**
+ * trace_event - Write an event
+ * @param ph     Phase, e.g. 'B' for begin
+ * @param cat    Category, e.g. "imap"
+ * @param name   Name of the event
+ * @param id     Id of an async event, or NULL
+ * @param detail Argument to show with the event, or NULL
+ *
+ * @note The caller must hold the lock
+ */
+static void trace_event(char ph, const char *cat, const char *name,
+                        const char *id, const char *detail)
+{
+  if (TraceTid == 0)
+  {
+    TraceTid = ++TraceThreads;
+    fprintf(TraceFP, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+            TraceFirst ? "" : ",\n", (int) getpid(), TraceTid);
+    trace_string((TraceTid == 1) ? "main" : "worker");
+    fputs("}}", TraceFP);
+    TraceFirst = false;
+  }
+
+  const uint64_t ns = trace_now() - TraceStart;
+  fprintf(TraceFP, "%s{\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%d,\"tid\":%d",
+          TraceFirst ? "" : ",\n", ph, (unsigned long long) (ns / 1000),
+          (unsigned int) (ns % 1000), (int) getpid(), TraceTid);
+  TraceFirst = false;
+
+  if (cat)
+  {
+    fputs(",\"cat\":", TraceFP);
+    trace_string(cat);
+  }
+  if (name)
+  {
+    fputs(",\"name\":", TraceFP);
+    trace_string(name);
+  }
+  if (id)
+  {
+    fputs(",\"id\":", TraceFP);
+    trace_string(id);
+  }
+  if (detail)
+  {
+    fputs(",\"args\":{\"detail\":", TraceFP);
+    trace_string(detail);
+    fputc('}', TraceFP);
+  }
+  fputc('}', TraceFP);
+}
+
+/**
+ * trace_open - Start recording a trace
+ * @param file File to write
+ * @retval  0 Success
+ * @retval -1 Error, see errno
+ */
+int trace_open(const char *file)
+{
+  if (!file)
+    return -1;
+
+  trace_close();
+
+  trace_lock();
+  TraceFP = mutt_file_fopen(file, "w");
+  if (TraceFP)
+  {
+    fputs("[\n", TraceFP);
+    TraceStart = trace_now();
+    TraceFirst = true;
+    TraceEnabled = true;
+  }
+  trace_unlock();
+
+  return TraceFP ? 0 : -1;
+}
+
+/**
+ * trace_close - Stop recording a trace
+ */
+void trace_close(void)
+{
+  trace_lock();
+  if (TraceFP)
+  {
+    TraceEnabled = false;
+    fputs("\n]\n", TraceFP);
+    mutt_file_fclose(&TraceFP);
+  }
+  trace_unlock();
+}
+
+/**
+ * trace_begin - Record the start of a block of code
+ * @param cat    Category, e.g. "mailbox"
+ * @param name   Name of the block
+ * @param detail Argument to show with the event, may be NULL
+ *
+ * Every call must be matched by trace_end() on the same thread.
+ */
+void trace_begin(const char *cat, const char *name, const char *detail)
+{
+  trace_lock();
+  if (TraceFP)
+    trace_event('B', cat, name, NULL, detail);
+  trace_unlock();
+}
+
+/**
+ * trace_end - Record the end of a block of code
+ */
+void trace_end(void)
+{
+  trace_lock();
+  if (TraceFP)
+    trace_event('E', NULL, NULL, NULL, NULL);
+  trace_unlock();
+}
+
+/**
+ * trace_async_begin - Record the start of an operation
+ * @param cat    Category, e.g. "imap"
+ * @param name   Name of the operation
+ * @param id     Id of the operation, unique within the category
+ * @param detail Argument to show with the event, may be NULL
+ */
+void trace_async_begin(const char *cat, const char *name, const char *id, const char *detail)
+{
+  if (!TraceEnabled)
+    return;
+
+  trace_lock();
+  if (TraceFP)
+    trace_event('b', cat, name, id, detail);
+  trace_unlock();
+}
+
+/**
+ * trace_async_end - Record the end of an operation
+ * @param cat    Category, as passed to trace_async_begin()
+ * @param name   Name, as passed to trace_async_begin()
+ * @param id     Id, as passed to trace_async_begin()
+ * @param detail Argument to show with the event, may be NULL
+ */
+void trace_async_end(const char *cat, const char *name, const char *id, const char *detail)
+{
+  if (!TraceEnabled)
+    return;
+
+  trace_lock();
+  if (TraceFP)
+    trace_event('e', cat, name, id, detail);
+  trace_unlock();
+}
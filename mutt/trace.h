@@ -0,0 +1,65 @@
+/**
+ * @file
+ * Record a trace of what NeoMutt is doing
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_TRACE_H
+#define MUTT_LIB_TRACE_H
+
+#include <stdbool.h>
+
+extern bool TraceEnabled;
+
+/**
+ * struct TraceScope - A traced block of code, see TRACE_SCOPE()
+ */
+struct TraceScope
+{
+  bool active; ///< Was the trace running when the block started?
+};
+
+void trace_async_begin(const char *cat, const char *name, const char *id, const char *detail);
+void trace_async_end  (const char *cat, const char *name, const char *id, const char *detail);
+void trace_begin      (const char *cat, const char *name, const char *detail);
+void trace_close      (void);
+void trace_end        (void);
+int  trace_open       (const char *file);
+
+/**
+ * trace_scope_end - End a TRACE_SCOPE()
+ * @param ts Scope
+ */
+static inline void trace_scope_end(struct TraceScope *ts)
+{
+  if (ts->active)
+    trace_end();
+}
+
+#ifdef __GNUC__
+/// Trace the rest of the enclosing block
+#define TRACE_SCOPE(CAT, NAME, DETAIL)                                         \
+  struct TraceScope trace_scope __attribute__((cleanup(trace_scope_end))) = { TraceEnabled }; \
+  if (trace_scope.active)                                                      \
+    trace_begin(CAT, NAME, DETAIL)
+#else
+#define TRACE_SCOPE(CAT, NAME, DETAIL)
+#endif
+
+#endif /* MUTT_LIB_TRACE_H */
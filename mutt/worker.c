@@ -0,0 +1,486 @@
+/**
+ * @file
+ * Pool of worker threads
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page mutt_worker Pool of worker threads
+ *
+ * Split a large job, e.g. sorting a big Mailbox, into independent tasks and
+ * run them on all the CPUs, or run a single task in the background.
+ *
+ * The threads are started the first time they're needed and wait for work
+ * until mutt_worker_stop() is called.  By default, one thread is run for each
+ * CPU; mutt_worker_set_threads() changes that.
+ *
+ * ## Jobs
+ *
+ * mutt_worker_run() shares an array of items between the threads.  The caller
+ * works on the items, too, and doesn't return until they're all finished.
+ *
+ * ## Background tasks
+ *
+ * mutt_worker_submit() queues a single task and returns a WorkerFuture at
+ * once.  mutt_worker_done() checks if the task has finished and
+ * mutt_worker_wait() waits for it.  If the task hasn't been started when
+ * mutt_worker_wait() is called, the caller runs it itself, so a task may wait
+ * for the tasks that it submits.  Jobs are run before background tasks.
+ *
+ * ## What a task may touch
+ *
+ * | Structure        | Safe to use from a task                               |
+ * | :--------------- | :---------------------------------------------------- |
+ * | Buffer pool      | Yes, each thread has its own pool                     |
+ * | HashTable        | Lookups only, while no thread is changing it          |
+ * | Config           | Reading, during mutt_worker_run()                     |
+ * | Mailbox, Email   | Reading, during mutt_worker_run()                     |
+ * | Logging, Notify  | No                                                    |
+ * | Screen, keyboard | No, they belong to the main thread                    |
+ *
+ * While mutt_worker_run() is waiting, the main thread can't change the config
+ * or the Mailbox.  A background task has no such guarantee: it should be
+ * given copies of the config values and Email data it needs.
+ *
+ * Anything else should be assumed to be unsafe.  A task may write to its own
+ * item, or to data that no other task shares.
+ *
+ * If NeoMutt is built without thread support, the tasks are simply run one
+ * after another, in the caller.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "worker.h"
+#include "memory.h"
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include "pool.h"
+#include "regex3.h"
+#endif
+
+/**
+ * enum WorkerState - The progress of a background task
+ */
+enum WorkerState
+{
+  WORKER_QUEUED,  ///< Waiting for a thread
+  WORKER_RUNNING, ///< Being run
+  WORKER_DONE,    ///< Finished
+};
+
+/**
+ * struct WorkerFuture - A background task
+ */
+struct WorkerFuture
+{
+  worker_task_t task;          ///< Function to run
+  void *item;                  ///< Item to work on
+  enum WorkerState state;      ///< Progress of the task
+  struct WorkerFuture *next;   ///< Next task in the queue
+};
+
+#ifdef USE_PTHREADS
+/// Number of threads to run, if there are enough CPUs
+#define WORKER_AUTO_THREADS 16
+/// Maximum number of threads to run tasks on
+#define WORKER_MAX_THREADS 64
+
+/**
+ * struct WorkerJob - A set of tasks being run by the workers
+ */
+struct WorkerJob
+{
+  worker_task_t task; ///< Function to run on each item
+  char *items;        ///< Items to work on
+  size_t size;        ///< Size of an item
+  size_t num;         ///< Number of items
+  size_t next;        ///< Next item to hand out
+  size_t done;        ///< Number of items finished
+};
+
+static pthread_mutex_t WorkerLock = PTHREAD_MUTEX_INITIALIZER; ///< Protects the variables below
+static pthread_cond_t WorkerWake = PTHREAD_COND_INITIALIZER; ///< Signalled when there's work, or it's time to stop
+static pthread_cond_t WorkerDone = PTHREAD_COND_INITIALIZER; ///< Signalled when a job, or a background task, is finished
+static pthread_t *Workers = NULL;      ///< Worker threads
+static int NumWorkers = 0;             ///< Number of worker threads
+static int WorkerThreads = 0;          ///< Number of threads wanted, 0 for one per CPU
+static bool WorkersStarted = false;    ///< Have the threads been started?
+static bool WorkersStopping = false;   ///< Should the threads exit?
+static struct WorkerJob *Job = NULL;   ///< Job being worked on
+static struct WorkerFuture *QueueHead = NULL; ///< First background task waiting for a thread
+static struct WorkerFuture *QueueTail = NULL; ///< Last background task waiting for a thread
+static __thread bool IsWorker = false; ///< Is this thread one of the workers?
+
+/**
+ * worker_take - Run tasks from a job until there are none left
+ * @param job Job to work on
+ *
+ * WorkerLock must be held.  It is released while each task runs.
+ */
+static void worker_take(struct WorkerJob *job)
+{
+  while (job->next < job->num)
+  {
+    void *item = job->items + (job->next++ * job->size);
+
+    pthread_mutex_unlock(&WorkerLock);
+    job->task(item);
+    pthread_mutex_lock(&WorkerLock);
+
+    if (++job->done == job->num)
+      pthread_cond_broadcast(&WorkerDone);
+  }
+}
+
+/**
+ * queue_remove - Remove a background task from the queue
+ * @param fut Task to remove
+ *
+ * WorkerLock must be held.
+ */
+static void queue_remove(struct WorkerFuture *fut)
+{
+  struct WorkerFuture *prev = NULL;
+  for (struct WorkerFuture *np = QueueHead; np; prev = np, np = np->next)
+  {
+    if (np != fut)
+      continue;
+
+    if (prev)
+      prev->next = np->next;
+    else
+      QueueHead = np->next;
+    if (QueueTail == np)
+      QueueTail = prev;
+    np->next = NULL;
+    return;
+  }
+}
+
+/**
+ * future_run - Run a background task
+ * @param fut Task to run
+ *
+ * WorkerLock must be held.  It is released while the task runs.
+ */
+static void future_run(struct WorkerFuture *fut)
+{
+  fut->state = WORKER_RUNNING;
+
+  pthread_mutex_unlock(&WorkerLock);
+  fut->task(fut->item);
+  pthread_mutex_lock(&WorkerLock);
+
+  fut->state = WORKER_DONE;
+  pthread_cond_broadcast(&WorkerDone);
+}
+
+/**
+ * worker_main - Wait for tasks and run them
+ * @param arg Unused
+ * @retval NULL Always
+ *
+ * When it's time to stop, the queued background tasks are finished first.
+ */
+static void *worker_main(void *arg)
+{
+  IsWorker = true;
+
+  pthread_mutex_lock(&WorkerLock);
+  while (true)
+  {
+    if (Job && (Job->next < Job->num))
+    {
+      worker_take(Job);
+    }
+    else if (QueueHead)
+    {
+      struct WorkerFuture *fut = QueueHead;
+      queue_remove(fut);
+      future_run(fut);
+    }
+    else if (WorkersStopping)
+    {
+      break;
+    }
+    else
+    {
+      pthread_cond_wait(&WorkerWake, &WorkerLock);
+    }
+  }
+  pthread_mutex_unlock(&WorkerLock);
+
+  /* Each thread has its own pool of Buffers */
+  mutt_buffer_pool_free();
+#ifdef USE_PCRE2_REGEX
+  mutt_pcre2_thread_free();
+#endif
+  return NULL;
+}
+
+/**
+ * worker_start - Start the worker threads
+ *
+ * The caller's thread counts as one of the threads.
+ */
+static void worker_start(void)
+{
+  WorkersStarted = true;
+
+  long threads = WorkerThreads;
+  if (threads <= 0)
+  {
+    threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > WORKER_AUTO_THREADS)
+      threads = WORKER_AUTO_THREADS;
+  }
+  if (threads > WORKER_MAX_THREADS)
+    threads = WORKER_MAX_THREADS;
+  if (threads < 2)
+    return;
+
+  Workers = mutt_mem_calloc(threads - 1, sizeof(pthread_t));
+
+  /* Signals must be handled by the main thread.  The workers inherit this mask. */
+  sigset_t all, old;
+  sigfillset(&all);
+  pthread_sigmask(SIG_SETMASK, &all, &old);
+
+  for (long i = 0; i < (threads - 1); i++)
+  {
+    if (pthread_create(&Workers[NumWorkers], NULL, worker_main, NULL) == 0)
+      NumWorkers++;
+  }
+
+  pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+#endif
+
+/**
+ * mutt_worker_count - How many threads can tasks run on?
+ * @retval num Number of threads, including the caller's
+ *
+ * The worker threads are started, if necessary.
+ */
+int mutt_worker_count(void)
+{
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&WorkerLock);
+  if (!WorkersStarted)
+    worker_start();
+  int num = NumWorkers + 1;
+  pthread_mutex_unlock(&WorkerLock);
+  return num;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * mutt_worker_run - Run a task on each of a set of items
+ * @param task  Function to run
+ * @param items Array of items
+ * @param size  Size of an item
+ * @param num   Number of items
+ *
+ * The tasks are shared between the worker threads and the caller.  This
+ * function returns when they have all finished.
+ *
+ * If the workers are already busy, e.g. if a task calls this function, the
+ * tasks are run by the caller alone.
+ */
+void mutt_worker_run(worker_task_t task, void *items, size_t size, size_t num)
+{
+  if (!task || !items || (num == 0))
+    return;
+
+#ifdef USE_PTHREADS
+  if ((num > 1) && (mutt_worker_count() > 1))
+  {
+    pthread_mutex_lock(&WorkerLock);
+    if (!Job)
+    {
+      struct WorkerJob job = { task, items, size, num, 0, 0 };
+      Job = &job;
+      pthread_cond_broadcast(&WorkerWake);
+
+      worker_take(&job);
+      while (job.done < job.num)
+        pthread_cond_wait(&WorkerDone, &WorkerLock);
+
+      Job = NULL;
+      pthread_mutex_unlock(&WorkerLock);
+      return;
+    }
+    pthread_mutex_unlock(&WorkerLock);
+  }
+#endif
+
+  for (size_t i = 0; i < num; i++)
+    task((char *) items + (i * size));
+}
+
+/**
+ * mutt_worker_submit - Run a task in the background
+ * @param task Function to run
+ * @param item Item to work on
+ * @retval ptr  Future for the task
+ * @retval NULL Error, no task
+ *
+ * The caller must pass the result to mutt_worker_wait().  If there are no
+ * worker threads, the task is finished before this function returns.
+ */
+struct WorkerFuture *mutt_worker_submit(worker_task_t task, void *item)
+{
+  if (!task)
+    return NULL;
+
+  struct WorkerFuture *fut = mutt_mem_calloc(1, sizeof(struct WorkerFuture));
+  fut->task = task;
+  fut->item = item;
+
+#ifdef USE_PTHREADS
+  if (mutt_worker_count() > 1)
+  {
+    pthread_mutex_lock(&WorkerLock);
+    fut->state = WORKER_QUEUED;
+    if (QueueTail)
+      QueueTail->next = fut;
+    else
+      QueueHead = fut;
+    QueueTail = fut;
+    pthread_cond_signal(&WorkerWake);
+    pthread_mutex_unlock(&WorkerLock);
+    return fut;
+  }
+#endif
+
+  task(item);
+  fut->state = WORKER_DONE;
+  return fut;
+}
+
+/**
+ * mutt_worker_done - Has a background task finished?
+ * @param fut Future from mutt_worker_submit()
+ * @retval true The task has finished, or there's no task
+ */
+bool mutt_worker_done(struct WorkerFuture *fut)
+{
+  if (!fut)
+    return true;
+
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&WorkerLock);
+  bool done = (fut->state == WORKER_DONE);
+  pthread_mutex_unlock(&WorkerLock);
+  return done;
+#else
+  return (fut->state == WORKER_DONE);
+#endif
+}
+
+/**
+ * mutt_worker_wait - Wait for a background task to finish
+ * @param[out] pfut Future from mutt_worker_submit(), will be freed
+ *
+ * If no thread has started the task yet, the caller runs it.
+ */
+void mutt_worker_wait(struct WorkerFuture **pfut)
+{
+  if (!pfut || !*pfut)
+    return;
+
+#ifdef USE_PTHREADS
+  struct WorkerFuture *fut = *pfut;
+  pthread_mutex_lock(&WorkerLock);
+  if (fut->state == WORKER_QUEUED)
+  {
+    queue_remove(fut);
+    future_run(fut);
+  }
+  while (fut->state != WORKER_DONE)
+    pthread_cond_wait(&WorkerDone, &WorkerLock);
+  pthread_mutex_unlock(&WorkerLock);
+#endif
+
+  FREE(pfut);
+}
+
+/**
+ * mutt_worker_set_threads - Set the number of threads to run tasks on
+ * @param num Number of threads, including the caller's; 0 for one per CPU
+ *
+ * If the threads are running, they're stopped, then restarted when they're
+ * next needed.
+ */
+void mutt_worker_set_threads(int num)
+{
+#ifdef USE_PTHREADS
+  if (num < 0)
+    num = 0;
+
+  pthread_mutex_lock(&WorkerLock);
+  bool restart = WorkersStarted && (num != WorkerThreads);
+  WorkerThreads = num;
+  pthread_mutex_unlock(&WorkerLock);
+
+  if (restart)
+    mutt_worker_stop();
+#endif
+}
+
+/**
+ * mutt_worker_stop - Stop the worker threads
+ *
+ * Any queued background tasks are finished first.  The threads will be
+ * started again if they're needed.  This does nothing if it's called by one
+ * of the workers.
+ */
+void mutt_worker_stop(void)
+{
+#ifdef USE_PTHREADS
+  if (IsWorker)
+    return;
+
+  pthread_mutex_lock(&WorkerLock);
+  if (!WorkersStarted)
+  {
+    pthread_mutex_unlock(&WorkerLock);
+    return;
+  }
+  WorkersStopping = true;
+  pthread_cond_broadcast(&WorkerWake);
+  pthread_mutex_unlock(&WorkerLock);
+
+  for (int i = 0; i < NumWorkers; i++)
+    pthread_join(Workers[i], NULL);
+
+  pthread_mutex_lock(&WorkerLock);
+  FREE(&Workers);
+  NumWorkers = 0;
+  WorkersStarted = false;
+  WorkersStopping = false;
+  pthread_mutex_unlock(&WorkerLock);
+#endif
+}
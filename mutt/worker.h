@@ -0,0 +1,48 @@
+/**
+ * @file
+ * Pool of worker threads
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_LIB_WORKER_H
+#define MUTT_LIB_WORKER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct WorkerFuture;
+
+/**
+ * typedef worker_task_t - Prototype for a task run by the workers
+ * @param item Item to work on
+ *
+ * The task may run on any thread, so it must not touch any shared state that
+ * isn't thread-safe, e.g. the logger.  See @ref mutt_worker for details.
+ */
+typedef void (*worker_task_t)(void *item);
+
+int                  mutt_worker_count      (void);
+bool                 mutt_worker_done       (struct WorkerFuture *fut);
+void                 mutt_worker_run        (worker_task_t task, void *items, size_t size, size_t num);
+void                 mutt_worker_set_threads(int num);
+void                 mutt_worker_stop       (void);
+struct WorkerFuture *mutt_worker_submit     (worker_task_t task, void *item);
+void                 mutt_worker_wait       (struct WorkerFuture **pfut);
+
+#endif /* MUTT_LIB_WORKER_H */
@@ -65,7 +65,7 @@ static const struct Command mutt_commands[] = {
   { "finish",              parse_finish,           0 },
   { "folder-hook",         mutt_parse_hook,        MUTT_FOLDER_HOOK },
   { "group",               parse_group,            MUTT_GROUP },
-  { "hdr_order",           parse_stailq,           IP &HeaderOrderList },
+  { "hdr_order",           parse_hdr_order,        IP &HeaderOrderList },
   { "iconv-hook",          mutt_parse_hook,        MUTT_ICONV_HOOK },
   { "ifdef",               parse_ifdef,            0 },
   { "ifndef",              parse_ifdef,            1 },
@@ -112,7 +112,7 @@ static const struct Command mutt_commands[] = {
   { "uncolor",             mutt_parse_uncolor,     0 },
 #endif
   { "ungroup",             parse_group,            MUTT_UNGROUP },
-  { "unhdr_order",         parse_unstailq,         IP &HeaderOrderList },
+  { "unhdr_order",         parse_unhdr_order,      IP &HeaderOrderList },
   { "unhook",              mutt_parse_unhook,      0 },
   { "unignore",            parse_unignore,         0 },
   { "unlists",             parse_unlists,          0 },
@@ -217,6 +217,9 @@ static struct ConfigDef MainVars[] = {
   { "auto_tag", DT_BOOL, false, 0, NULL,
     "Automatically apply actions to all tagged messages"
   },
+  { "autoview_cache_size", DT_LONG|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "Memory to use for caching the output of auto_view commands"
+  },
   { "beep", DT_BOOL, true, 0, NULL,
     "Make a noise when an error occurs"
   },
@@ -241,6 +244,9 @@ static struct ConfigDef MainVars[] = {
   { "collapse_unread", DT_BOOL, true, 0, NULL,
     "Prevent the collapse of threads with unread emails"
   },
+  { "config_cache", DT_PATH|DT_PATH_FILE, 0, 0, NULL,
+    "File to remember which config files were read cleanly"
+  },
   { "config_charset", DT_STRING, 0, 0, charset_validator,
     "Character set that the config files are in"
   },
@@ -268,6 +274,12 @@ static struct ConfigDef MainVars[] = {
   { "debug_level", DT_NUMBER, 0, 0, level_validator,
     "Logging level for debug logs"
   },
+  { "debug_subsystems", DT_SLIST|SLIST_SEP_COMMA, 0, 0, subsystems_validator,
+    "Logging levels for parts of NeoMutt, e.g. imap=5"
+  },
+  { "decode_cache_size", DT_LONG|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "Memory to use for caching decoded messages and attachments"
+  },
   { "default_hook", DT_STRING, IP "~f %s !~P | (~P ~C %s)", 0, NULL,
     "Pattern to use for hooks that only have a simple regex"
   },
@@ -378,9 +390,15 @@ static struct ConfigDef MainVars[] = {
   { "keep_flagged", DT_BOOL, false, 0, NULL,
     "Don't move flagged messages from `$spool_file` to `$mbox`"
   },
+  { "macro_redraw", DT_BOOL, true, 0, NULL,
+    "Draw the index between the functions of a macro"
+  },
   { "mail_check", DT_NUMBER|DT_NOT_NEGATIVE, 5, 0, NULL,
     "Number of seconds before NeoMutt checks for new mail"
   },
+  { "mail_check_backoff", DT_NUMBER|DT_NOT_NEGATIVE, 4, 0, NULL,
+    "Check mailboxes that don't change less often"
+  },
   { "mail_check_recent", DT_BOOL, true, 0, NULL,
     "Notify the user about new mail since the last time the mailbox was opened"
   },
@@ -423,6 +441,12 @@ static struct ConfigDef MainVars[] = {
   { "message_cache_clean", DT_BOOL, false, 0, NULL,
     "(imap/pop) Clean out obsolete entries from the message cache"
   },
+  { "message_cache_size", DT_LONG|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "(imap/pop) Maximum size of each mailbox's message cache, in kilobytes"
+  },
+  { "message_cache_sharded", DT_BOOL, false, 0, NULL,
+    "(imap/pop) Spread the message cache over many directories"
+  },
   { "message_cachedir", DT_PATH|DT_PATH_DIR, 0, 0, NULL,
     "(imap/pop) Directory for the message cache"
   },
@@ -602,6 +626,9 @@ static struct ConfigDef MainVars[] = {
   { "sort_browser", DT_SORT|DT_SORT_REVERSE, SORT_ALPHA, IP SortBrowserMethods, NULL,
     "Sort method for the browser"
   },
+  { "sort_parallel", DT_LONG|DT_NOT_NEGATIVE, 50000, 0, NULL,
+    "Sort mailboxes with at least this many emails on all CPUs"
+  },
   { "sort_re", DT_BOOL|R_INDEX|R_RESORT|R_RESORT_INIT, true, 0, pager_validator,
     "Sort method for the sidebar"
   },
@@ -614,7 +641,7 @@ static struct ConfigDef MainVars[] = {
   { "status_chars", DT_MBTABLE|R_INDEX|R_PAGER, IP "-*%A", 0, NULL,
     "Indicator characters for the status bar"
   },
-  { "status_format", DT_STRING|R_INDEX|R_PAGER, IP "-%r-NeoMutt: %D [Msgs:%?M?%M/?%m%?n? New:%n?%?o? Old:%o?%?d? Del:%d?%?F? Flag:%F?%?t? Tag:%t?%?p? Post:%p?%?b? Inc:%b?%?l? %l?]---(%s/%S)-%>-(%P)---", 0, NULL,
+  { "status_format", DT_STRING|R_INDEX|R_PAGER, IP "-%r-NeoMutt: %D [Msgs:%?M?%M/?%m%?n? New:%n?%?o? Old:%o?%?d? Del:%d?%?F? Flag:%F?%?t? Tag:%t?%?p? Post:%p?%?q? Queue:%q?%?b? Inc:%b?%?l? %l?]---(%s/%S)-%>-(%P)---", 0, NULL,
     "printf-like format string for the index's status line"
   },
   { "status_on_top", DT_BOOL|R_REFLOW, false, 0, NULL,
@@ -668,6 +695,9 @@ static struct ConfigDef MainVars[] = {
   { "weed", DT_BOOL, true, 0, NULL,
     "Filter headers when displaying/forwarding/printing/replying"
   },
+  { "worker_threads", DT_NUMBER|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "Number of threads to use for big jobs (0 for one per CPU)"
+  },
   { "wrap", DT_NUMBER|R_PAGER_FLOW, 0, 0, NULL,
     "Width to wrap text in the pager"
   },
@@ -754,6 +784,9 @@ static void init_variables(struct ConfigSet *cs)
   CONFIG_INIT_VARS(cs, autocrypt);
 #endif
   CONFIG_INIT_VARS(cs, compose);
+#ifdef USE_COMP_MBOX
+  CONFIG_INIT_VARS(cs, compmbox);
+#endif
   CONFIG_INIT_VARS(cs, conn);
 #ifdef USE_HCACHE
   CONFIG_INIT_VARS(cs, hcache);
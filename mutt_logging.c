@@ -126,8 +126,7 @@ void mutt_clear_error(void)
 int log_disp_curses(time_t stamp, const char *file, int line,
                     const char *function, enum LogLevel level, ...)
 {
-  const short c_debug_level = cs_subset_number(NeoMutt->sub, "debug_level");
-  if (level > c_debug_level)
+  if ((level > LL_MESSAGE) && !log_file_wanted(file, level))
     return 0;
 
   char buf[1024];
@@ -276,6 +275,50 @@ int mutt_log_set_level(enum LogLevel level, bool verbose)
   return 0;
 }
 
+/**
+ * subsystem_parse - Parse a subsystem's log level
+ * @param[in]  str   String to parse, e.g. "imap=5"
+ * @param[out] name  Buffer for the subsystem's name
+ * @param[out] level Logging level
+ * @retval true Success
+ */
+static bool subsystem_parse(const char *str, struct Buffer *name, int *level)
+{
+  const char *eq = strchr(NONULL(str), '=');
+  if (!eq || (eq == str))
+    return false;
+
+  if ((mutt_str_atoi(eq + 1, level) != 0) || (*level < 0) || (*level >= LL_MAX))
+    return false;
+
+  mutt_buffer_strcpy_n(name, str, eq - str);
+  return true;
+}
+
+/**
+ * mutt_log_set_subsystems - Set the logging levels of the subsystems
+ *
+ * The levels are read from `$debug_subsystems`.
+ */
+static void mutt_log_set_subsystems(void)
+{
+  log_file_clear_subsystems();
+
+  const struct Slist *c_debug_subsystems = cs_subset_slist(NeoMutt->sub, "debug_subsystems");
+  if (!c_debug_subsystems)
+    return;
+
+  struct Buffer *name = mutt_buffer_pool_get();
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &c_debug_subsystems->head, entries)
+  {
+    int level = 0;
+    if (subsystem_parse(np->data, name, &level))
+      log_file_set_subsystem(mutt_buffer_string(name), level);
+  }
+  mutt_buffer_pool_release(&name);
+}
+
 /**
  * mutt_log_start - Enable file logging
  * @retval  0 Success, or already running
@@ -285,6 +328,8 @@ int mutt_log_set_level(enum LogLevel level, bool verbose)
  */
 int mutt_log_start(void)
 {
+  mutt_log_set_subsystems();
+
   const short c_debug_level = cs_subset_number(NeoMutt->sub, "debug_level");
   if (c_debug_level < 1)
     return 0;
@@ -317,6 +362,42 @@ int level_validator(const struct ConfigSet *cs, const struct ConfigDef *cdef,
   return CSR_SUCCESS;
 }
 
+/**
+ * subsystems_validator - Validate the "debug_subsystems" config variable - Implements ConfigDef::validator()
+ */
+int subsystems_validator(const struct ConfigSet *cs, const struct ConfigDef *cdef,
+                         intptr_t value, struct Buffer *err)
+{
+  const struct Slist *subsystems = (const struct Slist *) value;
+  if (!subsystems || (subsystems->count == 0))
+    return CSR_SUCCESS;
+
+  if (subsystems->count > 16)
+  {
+    mutt_buffer_printf(err, _("Option %s: too many subsystems"), cdef->name);
+    return CSR_ERR_INVALID;
+  }
+
+  int rc = CSR_SUCCESS;
+  struct Buffer *name = mutt_buffer_pool_get();
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &subsystems->head, entries)
+  {
+    int level = 0;
+    if (!subsystem_parse(np->data, name, &level) || strchr(mutt_buffer_string(name), '/') ||
+        (mutt_buffer_len(name) >= 32))
+    {
+      mutt_buffer_printf(err, _("Option %s: %s is not of the form subsystem=level"),
+                         cdef->name, np->data);
+      rc = CSR_ERR_INVALID;
+      break;
+    }
+  }
+  mutt_buffer_pool_release(&name);
+
+  return rc;
+}
+
 /**
  * mutt_log_observer - Listen for config changes affecting the log file - Implements ::observer_t
  */
@@ -335,6 +416,8 @@ int mutt_log_observer(struct NotifyCallback *nc)
     mutt_log_set_file(c_debug_file, true);
   else if (mutt_str_equal(ec->name, "debug_level"))
     mutt_log_set_level(c_debug_level, true);
+  else if (mutt_str_equal(ec->name, "debug_subsystems"))
+    mutt_log_set_subsystems();
 
   return 0;
 }
@@ -44,13 +44,49 @@
 #include <stdio.h>
 #include "mutt/lib.h"
 #include "config/lib.h"
+#include "email/lib.h"
 #include "core/lib.h"
 #include "mutt.h"
 #include "mutt_lua.h"
+#include "context.h"
 #include "init.h"
 #include "mutt_commands.h"
+#include "mutt_globals.h"
 #include "muttlib.h"
+#include "mx.h"
 #include "myvar.h"
+#include "protos.h"
+
+/// Name of the metatable of a Lua Email
+#define LUA_EMAIL_META "mutt.Email"
+
+/**
+ * struct LuaEmail - An Email, as seen by Lua
+ *
+ * Lua may keep an Email long after the Mailbox has changed, so every use
+ * checks that it's still there.
+ */
+struct LuaEmail
+{
+  struct Mailbox *mailbox; ///< Mailbox containing the Email
+  struct Email *email;     ///< The Email
+  int msgno;               ///< Where the Email was in Mailbox::emails
+};
+
+/**
+ * LuaFlags - Names of the flags that Lua can change
+ */
+static const struct Mapping LuaFlags[] = {
+  // clang-format off
+  { "deleted", MUTT_DELETE  },
+  { "flagged", MUTT_FLAG    },
+  { "old",     MUTT_OLD     },
+  { "read",    MUTT_READ    },
+  { "replied", MUTT_REPLIED },
+  { "tagged",  MUTT_TAG     },
+  { NULL, 0 },
+  // clang-format on
+};
 
 static const struct Command lua_commands[] = {
   // clang-format off
@@ -358,6 +394,387 @@ static int lua_mutt_error(lua_State *l)
   return 0;
 }
 
+/**
+ * lua_mailbox - Get the current Mailbox
+ * @retval ptr Mailbox
+ * @retval NULL No Mailbox is open
+ */
+static struct Mailbox *lua_mailbox(void)
+{
+  return Context ? Context->mailbox : NULL;
+}
+
+/**
+ * lua_email_push - Push an Email onto the Lua stack
+ * @param l     Lua State
+ * @param m     Mailbox
+ * @param msgno Index of the Email in the Mailbox
+ */
+static void lua_email_push(lua_State *l, struct Mailbox *m, int msgno)
+{
+  struct LuaEmail *le = lua_newuserdata(l, sizeof(*le));
+  le->mailbox = m;
+  le->email = m->emails[msgno];
+  le->msgno = msgno;
+  luaL_getmetatable(l, LUA_EMAIL_META);
+  lua_setmetatable(l, -2);
+}
+
+/**
+ * lua_email_check - Get an Email from the Lua stack
+ * @param l   Lua State
+ * @param arg Stack index of the Email
+ * @retval ptr Email
+ *
+ * If the Email is no longer in the current Mailbox, a Lua error is raised.
+ */
+static struct Email *lua_email_check(lua_State *l, int arg)
+{
+  struct LuaEmail *le = luaL_checkudata(l, arg, LUA_EMAIL_META);
+  struct Mailbox *m = lua_mailbox();
+  if (!m || (le->mailbox != m))
+    luaL_error(l, "Email isn't in the current mailbox");
+
+  if ((le->msgno < m->msg_count) && (m->emails[le->msgno] == le->email))
+    return le->email;
+
+  /* The Mailbox has been sorted, or changed, since Lua saw the Email */
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    if (m->emails[i] == le->email)
+    {
+      le->msgno = i;
+      return le->email;
+    }
+  }
+
+  luaL_error(l, "Email isn't in the current mailbox");
+  return NULL;
+}
+
+/**
+ * lua_email_arg - Get an Email, or the index of one, from the Lua stack
+ * @param l   Lua State
+ * @param m   Mailbox
+ * @param arg Stack index of the Email
+ * @retval ptr Email
+ *
+ * Emails are numbered from 1.  If the argument isn't valid, a Lua error is
+ * raised.
+ */
+static struct Email *lua_email_arg(lua_State *l, struct Mailbox *m, int arg)
+{
+  if (lua_type(l, arg) == LUA_TNUMBER)
+  {
+    lua_Integer i = lua_tointeger(l, arg);
+    if ((i < 1) || (i > m->msg_count) || !m->emails[i - 1])
+      luaL_error(l, "Email %d doesn't exist", (int) i);
+    return m->emails[i - 1];
+  }
+
+  return lua_email_check(l, arg);
+}
+
+/**
+ * @defgroup lua_email_api Lua Email API
+ *
+ * Apply a change to an Email from Lua
+ *
+ * @param m    Mailbox
+ * @param e    Email to change
+ * @param data Private data
+ * @retval true The Email was changed
+ */
+typedef bool (*lua_email_fn)(struct Mailbox *m, struct Email *e, void *data);
+
+/**
+ * lua_emails_apply - Apply a function to some Emails
+ * @param l    Lua State
+ * @param m    Mailbox
+ * @param arg  Stack index of an Email, an index, or a table of them
+ * @param fn   Function to apply
+ * @param data Private data to pass to the function
+ * @retval num Number of Emails that were changed
+ *
+ * All the Emails are checked first, so a bad argument won't leave the job
+ * half-done.
+ */
+static int lua_emails_apply(lua_State *l, struct Mailbox *m, int arg,
+                            lua_email_fn fn, void *data)
+{
+  if (!lua_istable(l, arg))
+    return fn(m, lua_email_arg(l, m, arg), data) ? 1 : 0;
+
+  const int len = lua_rawlen(l, arg);
+  for (int i = 1; i <= len; i++)
+  {
+    lua_rawgeti(l, arg, i);
+    lua_email_arg(l, m, -1);
+    lua_pop(l, 1);
+  }
+
+  int count = 0;
+  for (int i = 1; i <= len; i++)
+  {
+    lua_rawgeti(l, arg, i);
+    if (fn(m, lua_email_arg(l, m, -1), data))
+      count++;
+    lua_pop(l, 1);
+  }
+
+  return count;
+}
+
+/**
+ * lua_email_index - Get a field of an Email - Implements Lua's __index
+ * @param l Lua State
+ * @retval 1 Always
+ */
+static int lua_email_index(lua_State *l)
+{
+  struct Email *e = lua_email_check(l, 1);
+  const char *field = luaL_checkstring(l, 2);
+  struct Envelope *env = e->env;
+
+  if (mutt_str_equal(field, "index"))
+  {
+    lua_pushinteger(l, ((struct LuaEmail *) lua_touserdata(l, 1))->msgno + 1);
+  }
+  else if (mutt_str_equal(field, "subject"))
+  {
+    lua_pushstring(l, env ? env->subject : NULL);
+  }
+  else if (mutt_str_equal(field, "message_id"))
+  {
+    lua_pushstring(l, env ? env->message_id : NULL);
+  }
+  else if (mutt_str_equal(field, "from") || mutt_str_equal(field, "to") ||
+           mutt_str_equal(field, "cc"))
+  {
+    struct AddressList *al = NULL;
+    if (env)
+      al = (field[0] == 'f') ? &env->from : (field[0] == 't') ? &env->to : &env->cc;
+
+    char buf[1024] = { 0 };
+    if (al)
+      mutt_addrlist_write(al, buf, sizeof(buf), true);
+    lua_pushstring(l, buf);
+  }
+  else if (mutt_str_equal(field, "date"))
+  {
+    lua_pushinteger(l, e->date_sent);
+  }
+  else if (mutt_str_equal(field, "received"))
+  {
+    lua_pushinteger(l, e->received);
+  }
+  else if (mutt_str_equal(field, "size"))
+  {
+    lua_pushinteger(l, e->body ? e->body->length : 0);
+  }
+  else if (mutt_str_equal(field, "tags"))
+  {
+    lua_pushstring(l, driver_tags_get(&e->tags));
+  }
+  else if (mutt_str_equal(field, "read"))
+  {
+    lua_pushboolean(l, e->read);
+  }
+  else if (mutt_str_equal(field, "old"))
+  {
+    lua_pushboolean(l, e->old);
+  }
+  else if (mutt_str_equal(field, "new"))
+  {
+    lua_pushboolean(l, !e->read && !e->old);
+  }
+  else if (mutt_str_equal(field, "flagged"))
+  {
+    lua_pushboolean(l, e->flagged);
+  }
+  else if (mutt_str_equal(field, "replied"))
+  {
+    lua_pushboolean(l, e->replied);
+  }
+  else if (mutt_str_equal(field, "deleted"))
+  {
+    lua_pushboolean(l, e->deleted);
+  }
+  else if (mutt_str_equal(field, "tagged"))
+  {
+    lua_pushboolean(l, e->tagged);
+  }
+  else if (mutt_str_equal(field, "visible"))
+  {
+    lua_pushboolean(l, e->visible);
+  }
+  else
+  {
+    lua_pushnil(l);
+  }
+
+  return 1;
+}
+
+/**
+ * lua_email_newindex - Refuse to change a field of an Email - Implements Lua's __newindex
+ * @param l Lua State
+ * @retval 0 Never returns
+ */
+static int lua_email_newindex(lua_State *l)
+{
+  return luaL_error(l, "Email fields are read-only, use mutt.mailbox.set_flags()");
+}
+
+/**
+ * lua_mailbox_count - Count the Emails in the current Mailbox
+ * @param l Lua State
+ * @retval 1 Always
+ */
+static int lua_mailbox_count(lua_State *l)
+{
+  struct Mailbox *m = lua_mailbox();
+  lua_pushinteger(l, m ? m->msg_count : 0);
+  return 1;
+}
+
+/**
+ * lua_mailbox_path - Get the path of the current Mailbox
+ * @param l Lua State
+ * @retval 1 Always
+ */
+static int lua_mailbox_path(lua_State *l)
+{
+  struct Mailbox *m = lua_mailbox();
+  lua_pushstring(l, m ? mailbox_path(m) : NULL);
+  return 1;
+}
+
+/**
+ * lua_mailbox_email - Get an Email from the current Mailbox
+ * @param l Lua State
+ * @retval 1 Always
+ *
+ * Emails are numbered from 1.  If the Email doesn't exist, nil is returned.
+ */
+static int lua_mailbox_email(lua_State *l)
+{
+  struct Mailbox *m = lua_mailbox();
+  lua_Integer i = luaL_checkinteger(l, 1);
+  if (!m || (i < 1) || (i > m->msg_count) || !m->emails[i - 1])
+    lua_pushnil(l);
+  else
+    lua_email_push(l, m, i - 1);
+  return 1;
+}
+
+/**
+ * lua_mailbox_next - Get the next Email - Implements Lua's iterator
+ * @param l Lua State
+ * @retval 0 No more Emails
+ * @retval 1 The next Email
+ */
+static int lua_mailbox_next(lua_State *l)
+{
+  struct Mailbox *m = lua_mailbox();
+  lua_Integer i = lua_tointeger(l, lua_upvalueindex(1));
+  if (!m || (m != lua_touserdata(l, lua_upvalueindex(2))) ||
+      (i >= m->msg_count) || !m->emails[i])
+  {
+    return 0;
+  }
+
+  lua_pushinteger(l, i + 1);
+  lua_replace(l, lua_upvalueindex(1));
+  lua_email_push(l, m, i);
+  return 1;
+}
+
+/**
+ * lua_mailbox_emails - Iterate over the Emails in the current Mailbox
+ * @param l Lua State
+ * @retval 1 Always
+ *
+ * e.g. `for e in mutt.mailbox.emails() do ... end`
+ */
+static int lua_mailbox_emails(lua_State *l)
+{
+  lua_pushinteger(l, 0);
+  lua_pushlightuserdata(l, lua_mailbox());
+  lua_pushcclosure(l, lua_mailbox_next, 2);
+  return 1;
+}
+
+/**
+ * lua_set_flag - Set a flag on an Email - Implements ::lua_email_fn
+ */
+static bool lua_set_flag(struct Mailbox *m, struct Email *e, void *data)
+{
+  const int *flag = data;
+  mutt_set_flag(m, e, flag[0], flag[1]);
+  return true;
+}
+
+/**
+ * lua_mailbox_set_flags - Set a flag on many Emails
+ * @param l Lua State
+ * @retval 1 Always
+ *
+ * e.g. `mutt.mailbox.set_flags(emails, "read", true)`
+ *
+ * The Emails may be a table of Emails, or their indices, or a single one.
+ * The number of Emails is returned.
+ */
+static int lua_mailbox_set_flags(lua_State *l)
+{
+  struct Mailbox *m = lua_mailbox();
+  if (!m)
+    return luaL_error(l, "No mailbox is open");
+
+  const char *name = luaL_checkstring(l, 2);
+  int flag[2] = { mutt_map_get_value(name, LuaFlags), true };
+  if (flag[0] == -1)
+    return luaL_error(l, "Unknown flag: %s", name);
+  if (!lua_isnoneornil(l, 3))
+    flag[1] = lua_toboolean(l, 3);
+
+  lua_pushinteger(l, lua_emails_apply(l, m, 1, lua_set_flag, flag));
+  return 1;
+}
+
+/**
+ * lua_set_tags - Change the tags of an Email - Implements ::lua_email_fn
+ */
+static bool lua_set_tags(struct Mailbox *m, struct Email *e, void *data)
+{
+  return mx_tags_commit(m, e, data) == 0;
+}
+
+/**
+ * lua_mailbox_set_tags - Change the tags of many Emails
+ * @param l Lua State
+ * @retval 1 Always
+ *
+ * e.g. `mutt.mailbox.set_tags(emails, "+todo -inbox")`
+ *
+ * The tags are in the same form as `<modify-labels>`.  The number of Emails
+ * that were changed is returned.
+ */
+static int lua_mailbox_set_tags(lua_State *l)
+{
+  struct Mailbox *m = lua_mailbox();
+  if (!m)
+    return luaL_error(l, "No mailbox is open");
+  if (!mx_tags_is_supported(m))
+    return luaL_error(l, "Mailbox doesn't support tags");
+
+  char buf[PATH_MAX];
+  mutt_str_copy(buf, luaL_checkstring(l, 2), sizeof(buf));
+
+  lua_pushinteger(l, lua_emails_apply(l, m, 1, lua_set_tags, buf));
+  return 1;
+}
+
 /**
  * lua_expose_command - Expose a NeoMutt command to the Lua interpreter
  * @param p   Lua state
@@ -381,6 +798,26 @@ static const luaL_Reg luaMuttDecl[] = {
   { "error", lua_mutt_error },   { NULL, NULL },
 };
 
+static const luaL_Reg luaMailboxDecl[] = {
+  // clang-format off
+  { "count",     lua_mailbox_count     },
+  { "email",     lua_mailbox_email     },
+  { "emails",    lua_mailbox_emails    },
+  { "path",      lua_mailbox_path      },
+  { "set_flags", lua_mailbox_set_flags },
+  { "set_tags",  lua_mailbox_set_tags  },
+  { NULL, NULL },
+  // clang-format on
+};
+
+static const luaL_Reg luaEmailMeta[] = {
+  // clang-format off
+  { "__index",    lua_email_index    },
+  { "__newindex", lua_email_newindex },
+  { NULL, NULL },
+  // clang-format on
+};
+
 #define lua_add_lib_member(LUA, TABLE, KEY, VALUE, DATATYPE_HANDLER)           \
   lua_pushstring(LUA, KEY);                                                    \
   DATATYPE_HANDLER(LUA, VALUE);                                                \
@@ -402,6 +839,14 @@ static int luaopen_mutt_decl(lua_State *l)
   lua_add_lib_member(l, lib_idx, "QUAD_NO", MUTT_NO, lua_pushinteger);
   lua_add_lib_member(l, lib_idx, "QUAD_ASKYES", MUTT_ASKYES, lua_pushinteger);
   lua_add_lib_member(l, lib_idx, "QUAD_ASKNO", MUTT_ASKNO, lua_pushinteger);
+
+  luaL_newmetatable(l, LUA_EMAIL_META);
+  luaL_setfuncs(l, luaEmailMeta, 0);
+  lua_pop(l, 1);
+
+  lua_pushstring(l, "mailbox");
+  luaL_newlib(l, luaMailboxDecl);
+  lua_settable(l, lib_idx);
   return 1;
 }
 
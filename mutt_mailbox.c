@@ -35,6 +35,7 @@
 #include "core/lib.h"
 #include "gui/lib.h"
 #include "mutt_mailbox.h"
+#include "maildir/lib.h"
 #include "muttlib.h"
 #include "mx.h"
 #include "protos.h"
@@ -44,15 +45,85 @@ static time_t MailboxStatsTime = 0; ///< last time we check performed mail_check
 static short MailboxCount = 0;  ///< how many boxes with new mail
 static short MailboxNotify = 0; ///< # of unnotified new boxes
 
+ARRAY_HEAD(MaildirCheckArray, struct MaildirCheck);
+
+/**
+ * mailbox_check_state - Summarise the counts of a Mailbox
+ * @param m Mailbox
+ * @retval num Summary, which changes if the counts do
+ */
+static unsigned int mailbox_check_state(const struct Mailbox *m)
+{
+  unsigned int state = m->has_new;
+  state = (state * 31) + m->msg_count;
+  state = (state * 31) + m->msg_unread;
+  state = (state * 31) + m->msg_flagged;
+  state = (state * 31) + m->msg_new;
+  state = (state * 31) + (unsigned int) m->size;
+  return state;
+}
+
+/**
+ * mailbox_check_schedule - Decide when to check a Mailbox again
+ * @param m Mailbox that was just checked
+ *
+ * A Mailbox that hasn't changed since its last check waits twice as long
+ * for the next, up to $mail_check_backoff times $mail_check.
+ */
+static void mailbox_check_schedule(struct Mailbox *m)
+{
+  const short c_mail_check = cs_subset_number(NeoMutt->sub, "mail_check");
+  const short c_mail_check_backoff = cs_subset_number(NeoMutt->sub, "mail_check_backoff");
+
+  const unsigned int state = mailbox_check_state(m);
+  if (m->has_new || (state != m->check_state) || (m->check_backoff < 1))
+    m->check_backoff = 1;
+  else
+    m->check_backoff = MIN(m->check_backoff * 2, MAX(c_mail_check_backoff, 1));
+  m->check_state = state;
+  m->check_next = MailboxTime + (m->check_backoff * c_mail_check);
+
+  if (m->check_backoff > 1)
+  {
+    mutt_debug(LL_DEBUG3, "%s unchanged, next check in %ds\n", mailbox_path(m),
+               m->check_backoff * c_mail_check);
+  }
+}
+
+/**
+ * mailbox_check_done - Finish checking a mailbox for new mail
+ * @param m_check Mailbox that was checked
+ * @param polled  true if the Mailbox's statistics were checked
+ * @param rc      Result of checking the statistics
+ */
+static void mailbox_check_done(struct Mailbox *m_check, bool polled, enum MxStatus rc)
+{
+  if (polled)
+    mailbox_check_schedule(m_check);
+
+  if (polled && (rc != MX_STATUS_ERROR) && m_check->has_new)
+    MailboxCount++;
+
+  if (!m_check->has_new)
+    m_check->notified = false;
+  else if (!m_check->notified)
+    MailboxNotify++;
+}
+
 /**
  * mailbox_check - Check a mailbox for new mail
  * @param m_cur       Current Mailbox
  * @param m_check     Mailbox to check
  * @param ctx_sb      stat() info for the current Mailbox
  * @param check_stats If true, also count the total, new and flagged messages
+ * @param maildirs    Maildirs whose statistics should be checked later
+ *
+ * Counting the messages in a Maildir means reading its directories, so that
+ * is left to maildir_check_stats_all(), which checks them all in parallel.
  */
 static void mailbox_check(struct Mailbox *m_cur, struct Mailbox *m_check,
-                          struct stat *ctx_sb, bool check_stats)
+                          struct stat *ctx_sb, bool check_stats,
+                          struct MaildirCheckArray *maildirs)
 {
   struct stat sb = { 0 };
 
@@ -98,28 +169,26 @@ static void mailbox_check(struct Mailbox *m_cur, struct Mailbox *m_check,
   {
     switch (m_check->type)
     {
+      case MUTT_MAILDIR:
+      {
+        struct MaildirCheck mc = { m_check, check_stats, MX_STATUS_OK };
+        ARRAY_ADD(maildirs, mc);
+        return;
+      }
       case MUTT_IMAP:
       case MUTT_MBOX:
       case MUTT_MMDF:
-      case MUTT_MAILDIR:
       case MUTT_MH:
       case MUTT_NOTMUCH:
-        if ((mx_mbox_check_stats(m_check, check_stats) != MX_STATUS_ERROR) &&
-            m_check->has_new)
-        {
-          MailboxCount++;
-        }
-        break;
+        mailbox_check_done(m_check, true, mx_mbox_check_stats(m_check, check_stats));
+        return;
       default:; /* do nothing */
     }
   }
   else if (c_check_mbox_size && m_cur && mutt_buffer_is_empty(&m_cur->pathbuf))
     m_check->size = (off_t) sb.st_size; /* update the size of current folder */
 
-  if (!m_check->has_new)
-    m_check->notified = false;
-  else if (!m_check->notified)
-    MailboxNotify++;
+  mailbox_check_done(m_check, false, MX_STATUS_OK);
 }
 
 /**
@@ -184,6 +253,7 @@ int mutt_mailbox_check(struct Mailbox *m_cur, int force)
     contex_sb.st_ino = 0;
   }
 
+  struct MaildirCheckArray maildirs = ARRAY_HEAD_INITIALIZER;
   struct MailboxList ml = STAILQ_HEAD_INITIALIZER(ml);
   neomutt_mailboxlist_get_all(&ml, NeoMutt, MUTT_MAILBOX_ANY);
   struct MailboxNode *np = NULL;
@@ -192,15 +262,56 @@ int mutt_mailbox_check(struct Mailbox *m_cur, int force)
     if (np->mailbox->flags & MB_HIDDEN)
       continue;
 
+    /* The user may change the current mailbox, so check it as soon as they leave */
+    if (np->mailbox == m_cur)
+      np->mailbox->check_next = 0;
+
+    if (!force && (t < np->mailbox->check_next))
+    {
+      /* Nothing has changed recently, so use the last results */
+      mutt_debug(LL_DEBUG5, "skipping %s until %ld\n", mailbox_path(np->mailbox),
+                 (long) np->mailbox->check_next);
+      if (np->mailbox->has_new)
+        MailboxCount++;
+      mailbox_check_done(np->mailbox, false, MX_STATUS_OK);
+      continue;
+    }
+
     mailbox_check(m_cur, np->mailbox, &contex_sb,
-                  check_stats || (!np->mailbox->first_check_stats_done && c_mail_check_stats));
+                  check_stats || (!np->mailbox->first_check_stats_done && c_mail_check_stats),
+                  &maildirs);
     np->mailbox->first_check_stats_done = true;
   }
   neomutt_mailboxlist_clear(&ml);
 
+  maildir_check_stats_all(maildirs.entries, ARRAY_SIZE(&maildirs));
+  struct MaildirCheck *mc = NULL;
+  ARRAY_FOREACH(mc, &maildirs)
+  {
+    mailbox_check_done(mc->mailbox, true, mc->rc);
+  }
+  ARRAY_FREE(&maildirs);
+
   return MailboxCount;
 }
 
+/**
+ * mutt_mailbox_check_soon - Check a Mailbox at the next opportunity
+ * @param m Mailbox that has changed
+ *
+ * The server has said that the Mailbox has changed, e.g. with IMAP IDLE, so
+ * the next mutt_mailbox_check() will check it, without waiting for
+ * $mail_check.
+ */
+void mutt_mailbox_check_soon(struct Mailbox *m)
+{
+  if (!m)
+    return;
+
+  m->check_next = 0;
+  MailboxTime = 0;
+}
+
 /**
  * mutt_mailbox_notify - Notify the user if there's new mail
  * @param m_cur Current Mailbox
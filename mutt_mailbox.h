@@ -12,6 +12,7 @@ struct stat;
 #define MUTT_MAILBOX_CHECK_FORCE_STATS (1 << 1)
 
 int  mutt_mailbox_check       (struct Mailbox *m_cur, int force);
+void mutt_mailbox_check_soon  (struct Mailbox *m);
 void mutt_mailbox_cleanup     (const char *path, struct stat *st);
 bool mutt_mailbox_list        (void);
 struct Mailbox *mutt_mailbox_next(struct Mailbox *m_cur, struct Buffer *s);
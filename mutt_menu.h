@@ -40,6 +40,7 @@ typedef uint16_t MuttRedrawFlags;      ///< Flags, e.g. #REDRAW_INDEX
 #define REDRAW_FULL           (1 << 5) ///< Redraw everything
 #define REDRAW_BODY           (1 << 6) ///< Redraw the pager
 #define REDRAW_FLOW           (1 << 7) ///< Used by pager to reflow text
+#define REDRAW_SCROLL         (1 << 8) ///< Redraw after moving the page of the menu
 
 /**
  * struct Menu - GUI selectable list of items
@@ -69,6 +70,8 @@ struct Menu
   /* the following are used only by mutt_menu_loop() */
   int top;                ///< Entry that is the top of the current page
   int oldcurrent;         ///< For driver use only
+  int drawn_top;          ///< Entry at the top of the page when the index was last drawn
+  int drawn_current;      ///< Entry with the indicator when the index was last drawn
   int search_dir;         ///< Direction of search
   int tagged;             ///< Number of tagged entries
   bool custom_search : 1; ///< The menu implements its own non-Menu::search()-compatible search, trickle OP_SEARCH*
@@ -135,6 +138,7 @@ void         menu_redraw_current(struct Menu *menu);
 void         menu_redraw_full(struct Menu *menu);
 void         menu_redraw_index(struct Menu *menu);
 void         menu_redraw_motion(struct Menu *menu);
+void         menu_redraw_scroll(struct Menu *menu);
 void         menu_redraw_status(struct Menu *menu);
 int          menu_redraw(struct Menu *menu);
 void         menu_top_page(struct Menu *menu);
@@ -29,18 +29,23 @@
 #include "config.h"
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include "mutt/lib.h"
 #include "config/lib.h"
 #include "email/lib.h"
 #include "core/lib.h"
+#include "debug/lib.h"
 #include "mutt.h"
 #include "mutt_thread.h"
 #include "mx.h"
 #include "options.h"
 #include "protos.h"
 #include "sort.h"
+#ifdef USE_HCACHE
+#include "hcache/lib.h"
+#endif
 
 /**
  * struct ThreadsContext - The "current" threading state
@@ -50,6 +55,9 @@ struct ThreadsContext
   struct Mailbox *mailbox; ///< Current mailbox
   struct MuttThread *tree; ///< Top of thread tree
   struct HashTable *hash;  ///< Hash table for threads
+  int msg_count;           ///< Number of emails in the threads
+  struct ListHead keys;    ///< Copies of the hash keys of removed emails
+  int tree_options;        ///< Options the tree was drawn with, see tree_options()
 };
 
 /**
@@ -162,9 +170,10 @@ static void linearize_tree(struct ThreadsContext *tctx)
  * this calculates whether a node is the root of a subtree that has visible
  * nodes, whether a node itself is visible, whether, if invisible, it has
  * depth anyway, and whether any of its later siblings are roots of visible
- * subtrees.  while it's at it, it frees the old thread display, so we can
- * skip parts of the tree in mutt_draw_tree() if we've decided here that we
- * don't care about them any more.
+ * subtrees.
+ *
+ * If any node of a thread is marked for redrawing, or its visibility has
+ * changed, the top of the thread is marked, see MuttThread::redraw.
  */
 static void calculate_visibility(struct MuttThread *tree, int *max_depth)
 {
@@ -173,6 +182,7 @@ static void calculate_visibility(struct MuttThread *tree, int *max_depth)
 
   struct MuttThread *tmp = NULL;
   struct MuttThread *orig_tree = tree;
+  struct MuttThread *top = NULL;
   const bool c_hide_top_missing =
       cs_subset_bool(NeoMutt->sub, "hide_top_missing");
   const bool c_hide_missing = cs_subset_bool(NeoMutt->sub, "hide_missing");
@@ -193,10 +203,13 @@ static void calculate_visibility(struct MuttThread *tree, int *max_depth)
     if (depth > *max_depth)
       *max_depth = depth;
 
+    if (depth == 0)
+      top = tree;
+    const bool was_visible = tree->visible;
+
     tree->subtree_visible = 0;
     if (tree->message)
     {
-      FREE(&tree->message->tree);
       if (is_visible(tree->message))
       {
         tree->deep = true;
@@ -225,6 +238,14 @@ static void calculate_visibility(struct MuttThread *tree, int *max_depth)
       tree->visible = false;
       tree->deep = !c_hide_missing;
     }
+
+    if (tree->redraw || (tree->visible != was_visible))
+    {
+      top->redraw = true;
+      if (tree != top)
+        tree->redraw = false;
+    }
+
     tree->next_subtree_visible =
         tree->next && (tree->next->next_subtree_visible || tree->next->subtree_visible);
     if (tree->child)
@@ -287,6 +308,8 @@ struct ThreadsContext *mutt_thread_ctx_init(struct Mailbox *m)
   tctx->mailbox = m;
   tctx->tree = NULL;
   tctx->hash = NULL;
+  STAILQ_INIT(&tctx->keys);
+  tctx->tree_options = -1;
   return tctx;
 }
 
@@ -298,38 +321,73 @@ void mutt_thread_ctx_free(struct ThreadsContext **tctx)
 {
   (*tctx)->mailbox = NULL;
   mutt_hash_free(&(*tctx)->hash);
+  mutt_list_free(&(*tctx)->keys);
   FREE(tctx);
 }
 
 /**
- * mutt_draw_tree - Draw a tree of threaded emails
- * @param tctx Threading context
- *
- * Since the graphics characters have a value >255, I have to resort to using
- * escape sequences to pass the information to print_enriched_string().  These
- * are the macros MUTT_TREE_* defined in mutt.h.
- *
- * ncurses should automatically use the default ASCII characters instead of
- * graphics chars on terminals which don't support them (see the man page for
- * curs_addch).
+ * tree_options - Get the options that affect the thread tree
+ * @retval num Bit field of the options
  */
-void mutt_draw_tree(struct ThreadsContext *tctx)
+static int tree_options(void)
 {
-  char *pfx = NULL, *mypfx = NULL, *arrow = NULL, *myarrow = NULL, *new_tree = NULL;
   const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
-  enum TreeChar corner = (c_sort & SORT_REVERSE) ? MUTT_TREE_ULCORNER : MUTT_TREE_LLCORNER;
-  enum TreeChar vtee = (c_sort & SORT_REVERSE) ? MUTT_TREE_BTEE : MUTT_TREE_TTEE;
-  const bool c_narrow_tree = cs_subset_bool(NeoMutt->sub, "narrow_tree");
-  int depth = 0, start_depth = 0, max_depth = 0, width = c_narrow_tree ? 1 : 2;
-  struct MuttThread *nextdisp = NULL, *pseudo = NULL, *parent = NULL;
+  int options = 0;
+  if (c_sort & SORT_REVERSE)
+    options |= (1 << 0);
+  if (cs_subset_bool(NeoMutt->sub, "narrow_tree"))
+    options |= (1 << 1);
+  if (cs_subset_bool(NeoMutt->sub, "hide_limited"))
+    options |= (1 << 2);
+  if (cs_subset_bool(NeoMutt->sub, "hide_missing"))
+    options |= (1 << 3);
+  if (cs_subset_bool(NeoMutt->sub, "hide_top_limited"))
+    options |= (1 << 4);
+  if (cs_subset_bool(NeoMutt->sub, "hide_top_missing"))
+    options |= (1 << 5);
+  return options;
+}
 
-  struct MuttThread *tree = tctx->tree;
+/**
+ * free_tree_strings - Free the tree strings of a thread
+ * @param top Top of the thread
+ */
+static void free_tree_strings(struct MuttThread *top)
+{
+  struct MuttThread *tree = top;
+  while (tree)
+  {
+    if (tree->message)
+      FREE(&tree->message->tree);
+
+    if (tree->child)
+    {
+      tree = tree->child;
+      continue;
+    }
+
+    while ((tree != top) && !tree->next)
+      tree = tree->parent;
+    tree = (tree == top) ? NULL : tree->next;
+  }
+}
+
+/**
+ * draw_thread - Draw the tree of one thread
+ * @param tree   Top of the thread, detached from its siblings
+ * @param pfx    Buffer for the prefix, big enough for the deepest thread
+ * @param arrow  Buffer for the arrow, big enough for the deepest thread
+ * @param width  Width of each level of the tree
+ * @param corner Character for the last child
+ * @param vtee   Character for a hidden child
+ */
+static void draw_thread(struct MuttThread *tree, char *pfx, char *arrow,
+                        int width, enum TreeChar corner, enum TreeChar vtee)
+{
+  char *mypfx = NULL, *myarrow = NULL, *new_tree = NULL;
+  int depth = 0, start_depth = 0;
+  struct MuttThread *nextdisp = NULL, *pseudo = NULL, *parent = NULL;
 
-  /* Do the visibility calculations and free the old thread chars.
-   * From now on we can simply ignore invisible subtrees */
-  calculate_visibility(tree, &max_depth);
-  pfx = mutt_mem_malloc((width * max_depth) + 2);
-  arrow = mutt_mem_malloc((width * max_depth) + 2);
   while (tree)
   {
     if (depth != 0)
@@ -426,11 +484,76 @@ void mutt_draw_tree(struct ThreadsContext *tctx)
         nextdisp = tree;
     } while (!tree->deep);
   }
+}
+
+/**
+ * draw_tree - Draw the threads whose trees have changed
+ * @param tctx Threading context
+ * @param all  If true, draw every thread
+ */
+static void draw_tree(struct ThreadsContext *tctx, bool all)
+{
+  const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
+  enum TreeChar corner = (c_sort & SORT_REVERSE) ? MUTT_TREE_ULCORNER : MUTT_TREE_LLCORNER;
+  enum TreeChar vtee = (c_sort & SORT_REVERSE) ? MUTT_TREE_BTEE : MUTT_TREE_TTEE;
+  const bool c_narrow_tree = cs_subset_bool(NeoMutt->sub, "narrow_tree");
+  int max_depth = 0, width = c_narrow_tree ? 1 : 2;
+
+  const int options = tree_options();
+  if (options != tctx->tree_options)
+    all = true;
+  tctx->tree_options = options;
+
+  /* Do the visibility calculations and find the threads that have changed.
+   * From now on we can simply ignore invisible subtrees */
+  calculate_visibility(tctx->tree, &max_depth);
+  char *pfx = mutt_mem_malloc((width * max_depth) + 2);
+  char *arrow = mutt_mem_malloc((width * max_depth) + 2);
+
+  int drawn = 0;
+  struct MuttThread *next = NULL;
+  for (struct MuttThread *top = tctx->tree; top; top = next)
+  {
+    next = top->next;
+    if (!all && !top->redraw)
+      continue;
+
+    top->redraw = false;
+    free_tree_strings(top);
+    top->next = NULL;
+    draw_thread(top, pfx, arrow, width, corner, vtee);
+    top->next = next;
+    drawn++;
+  }
+  mutt_debug(LL_DEBUG3, "drew %d threads\n", drawn);
 
   FREE(&pfx);
   FREE(&arrow);
 }
 
+/**
+ * mutt_draw_tree - Draw a tree of threaded emails
+ * @param tctx Threading context
+ *
+ * Since the graphics characters have a value >255, I have to resort to using
+ * escape sequences to pass the information to print_enriched_string().  These
+ * are the macros MUTT_TREE_* defined in mutt.h.
+ *
+ * ncurses should automatically use the default ASCII characters instead of
+ * graphics chars on terminals which don't support them (see the man page for
+ * curs_addch).
+ *
+ * Only the threads whose structure or visibility has changed since they were
+ * last drawn are drawn again.
+ */
+void mutt_draw_tree(struct ThreadsContext *tctx)
+{
+  if (!tctx)
+    return;
+
+  draw_tree(tctx, false);
+}
+
 /**
  * make_subject_list - Create a sorted list of all subjects in a thread
  * @param[out] subjects String List of subjects
@@ -538,6 +661,32 @@ static struct MuttThread *find_subject(struct Mailbox *m, struct MuttThread *cur
   return last;
 }
 
+/**
+ * subject_in_set - Does a thread contain one of a set of subjects?
+ * @param cur      Thread to check
+ * @param subjects Hash Table of subjects
+ * @param add      If true, add the thread's subjects to the set
+ * @retval true One of the thread's subjects is in the set
+ */
+static bool subject_in_set(struct MuttThread *cur, struct HashTable *subjects, bool add)
+{
+  struct ListHead list = STAILQ_HEAD_INITIALIZER(list);
+  make_subject_list(&list, cur, NULL);
+
+  bool found = false;
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &list, entries)
+  {
+    if (mutt_hash_find_elem(subjects, np->data))
+      found = true;
+    else if (add)
+      mutt_hash_insert(subjects, np->data, np->data);
+  }
+
+  mutt_list_clear(&list);
+  return found;
+}
+
 /**
  * make_subj_hash - Create a Hash Table for the email subjects
  * @param m Mailbox
@@ -564,11 +713,12 @@ static struct HashTable *make_subj_hash(struct Mailbox *m)
 
 /**
  * pseudo_threads - Thread messages by subject
- * @param tctx Threading context
+ * @param tctx    Threading context
+ * @param changed Subjects that have changed, or NULL to check every thread
  *
  * Thread by subject things that didn't get threaded by message-id
  */
-static void pseudo_threads(struct ThreadsContext *tctx)
+static void pseudo_threads(struct ThreadsContext *tctx, struct HashTable *changed)
 {
   if (!tctx || !tctx->mailbox)
     return;
@@ -587,6 +737,9 @@ static void pseudo_threads(struct ThreadsContext *tctx)
   {
     cur = tree;
     tree = tree->next;
+    /* Only a thread sharing a changed subject can find a new parent */
+    if (changed && !subject_in_set(cur, changed, false))
+      continue;
     parent = find_subject(m, cur);
     if (parent)
     {
@@ -641,7 +794,7 @@ static void pseudo_threads(struct ThreadsContext *tctx)
  */
 void mutt_clear_threads(struct ThreadsContext *tctx)
 {
-  if (!tctx || !tctx->mailbox || !tctx->mailbox->emails || !tctx->tree)
+  if (!tctx || !tctx->mailbox || !tctx->mailbox->emails || (!tctx->tree && !tctx->hash))
     return;
 
   for (int i = 0; i < tctx->mailbox->msg_count; i++)
@@ -655,7 +808,9 @@ void mutt_clear_threads(struct ThreadsContext *tctx)
     e->threaded = false;
   }
   tctx->tree = NULL;
+  tctx->msg_count = 0;
   mutt_hash_free(&tctx->hash);
+  mutt_list_free(&tctx->keys);
 }
 
 /**
@@ -685,6 +840,81 @@ static int compare_threads(const void *a, const void *b)
   }
 }
 
+/**
+ * merge_threads - Merge two sorted lists of sibling threads
+ * @param a First list, linked by `prev`
+ * @param b Second list, linked by `prev`
+ * @retval ptr Merged list, linked by `prev`
+ *
+ * If two threads compare equal, the one from @a a is put first.
+ */
+static struct MuttThread *merge_threads(struct MuttThread *a, struct MuttThread *b)
+{
+  struct MuttThread *head = NULL;
+  struct MuttThread **tail = &head;
+
+  while (a && b)
+  {
+    if (compare_threads(&b, &a) < 0)
+    {
+      *tail = b;
+      b = b->prev;
+    }
+    else
+    {
+      *tail = a;
+      a = a->prev;
+    }
+    tail = &(*tail)->prev;
+  }
+  *tail = a ? a : b;
+
+  return head;
+}
+
+/**
+ * sort_siblings - Sort a list of sibling threads
+ * @param list Threads, linked by `prev`
+ * @retval ptr Sorted list, linked by `prev`
+ *
+ * This is a stable, natural merge sort.  Runs of threads that are already in
+ * order are merged as they are, so resorting an unchanged list is linear.
+ */
+static struct MuttThread *sort_siblings(struct MuttThread *list)
+{
+  /* pending[i] holds a sorted list made from about 2^i runs */
+  struct MuttThread *pending[64] = { 0 };
+  struct MuttThread *run = NULL, *next = NULL;
+  size_t i;
+
+  while (list)
+  {
+    /* cut off the next run */
+    run = list;
+    while (list->prev && (compare_threads(&list->prev, &list) >= 0))
+      list = list->prev;
+    next = list->prev;
+    list->prev = NULL;
+    list = next;
+
+    for (i = 0; (i < (mutt_array_size(pending) - 1)) && pending[i]; i++)
+    {
+      run = merge_threads(pending[i], run);
+      pending[i] = NULL;
+    }
+    pending[i] = pending[i] ? merge_threads(pending[i], run) : run;
+  }
+
+  run = NULL;
+  for (i = 0; i < mutt_array_size(pending); i++)
+  {
+    if (pending[i])
+      run = merge_threads(pending[i], run);
+  }
+
+  return run;
+}
+
 /**
  * mutt_sort_subthreads - Sort the children of a thread
  * @param tctx Threading context
@@ -696,14 +926,13 @@ void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
   if (!thread)
     return;
 
-  struct MuttThread **array = NULL, *sort_key = NULL, *top = NULL, *tmp = NULL;
+  struct MuttThread *sort_key = NULL, *top = NULL, *tmp = NULL;
   struct Email *oldsort_key = NULL;
-  int i, array_size, sort_top = 0;
+  int sort_top = 0;
 
-  /* we put things into the array backwards to save some cycles,
-   * but we want to have to move less stuff around if we're
-   * resorting, so we sort backwards and then put them back
-   * in reverse order so they're forwards */
+  /* the siblings are sorted from the last one, following `prev`, so that
+   * a resort walks them in the order they were left in.  Sort backwards
+   * and then link them up in reverse order so they're forwards */
   short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
   c_sort ^= SORT_REVERSE;
   bool oldresort = OptNeedResort;
@@ -714,8 +943,6 @@ void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
 
   top = thread;
 
-  array_size = 256;
-  array = mutt_mem_calloc(array_size, sizeof(struct MuttThread *));
   while (true)
   {
     if (init || !thread->sort_key)
@@ -750,32 +977,20 @@ void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
       /* if it has siblings and needs to be sorted, sort it... */
       if (thread->prev && (thread->parent ? thread->parent->sort_children : sort_top))
       {
-        /* put them into the array */
-        for (i = 0; thread; i++, thread = thread->prev)
-        {
-          if (i >= array_size)
-            mutt_mem_realloc(&array, (array_size *= 2) * sizeof(struct MuttThread *));
-
-          array[i] = thread;
-        }
-
-        qsort((void *) array, i, sizeof(struct MuttThread *), *compare_threads);
+        thread = sort_siblings(thread);
 
         /* attach them back together.  make thread the last sibling. */
-        thread = array[0];
         thread->next = NULL;
-        array[i - 1]->prev = NULL;
+        for (tmp = thread; tmp->prev; tmp = tmp->prev)
+          tmp->prev->next = tmp;
 
         if (thread->parent)
-          thread->parent->child = array[i - 1];
-        else
-          top = array[i - 1];
-
-        while (--i)
         {
-          array[i - 1]->prev = array[i];
-          array[i]->next = array[i - 1];
+          thread->parent->child = tmp;
+          thread->parent->redraw = true;
         }
+        else
+          top = tmp;
       }
 
       if (thread->parent)
@@ -793,87 +1008,677 @@ void mutt_sort_subthreads(struct ThreadsContext *tctx, bool init)
           /* we just sorted its children */
           thread->sort_children = false;
 
-          oldsort_key = thread->sort_key;
-          thread->sort_key = thread->message;
+          oldsort_key = thread->sort_key;
+          thread->sort_key = thread->message;
+
+          if (c_sort & SORT_LAST)
+          {
+            if (!thread->sort_key ||
+                ((((c_sort & SORT_REVERSE) ? 1 : -1) *
+                  compare_threads((void *) &thread, (void *) &sort_key)) > 0))
+            {
+              thread->sort_key = sort_key->sort_key;
+            }
+          }
+          else if (!thread->sort_key)
+            thread->sort_key = sort_key->sort_key;
+
+          /* if its sort_key has changed, we need to resort it and siblings */
+          if (oldsort_key != thread->sort_key)
+          {
+            if (thread->parent)
+              thread->parent->sort_children = true;
+            else
+              sort_top = 1;
+          }
+        }
+      }
+      else
+      {
+        oldresort = OptNeedResort;
+        c_sort ^= SORT_REVERSE;
+        cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
+        OptNeedResort = oldresort;
+        tctx->tree = top;
+        return;
+      }
+    }
+
+    thread = thread->next;
+  }
+}
+
+/**
+ * check_subjects - Find out which emails' subjects differ from their parent's
+ * @param m       Mailbox
+ * @param init    If true, rebuild the thread
+ * @param changed If not NULL, collect the subjects of the emails checked
+ * @retval num Number of emails checked
+ */
+static int check_subjects(struct Mailbox *m, bool init, struct HashTable *changed)
+{
+  if (!m)
+    return 0;
+
+  int num_checked = 0;
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (!e || !e->thread)
+      continue;
+
+    if (e->thread->check_subject)
+      e->thread->check_subject = false;
+    else if (!init)
+      continue;
+
+    num_checked++;
+    if (changed && e->env->real_subj)
+      mutt_hash_insert(changed, e->env->real_subj, e->env->real_subj);
+
+    /* figure out which messages have subjects different than their parents' */
+    struct MuttThread *tmp = e->thread->parent;
+    while (tmp && !tmp->message)
+    {
+      tmp = tmp->parent;
+    }
+
+    if (!tmp)
+      e->subject_changed = true;
+    else if (e->env->real_subj && tmp->message->env->real_subj)
+    {
+      e->subject_changed = !mutt_str_equal(e->env->real_subj, tmp->message->env->real_subj);
+    }
+    else
+    {
+      e->subject_changed = (e->env->real_subj || tmp->message->env->real_subj);
+    }
+  }
+
+  return num_checked;
+}
+
+/**
+ * recheck_subjects - Mark a thread's messages for a subject check
+ * @param cur Thread to mark
+ *
+ * Attaching a pseudo-thread clears the subject_changed flags that match the
+ * new parent's subject, so they must be worked out again when it's detached.
+ */
+static void recheck_subjects(struct MuttThread *cur)
+{
+  struct MuttThread *start = cur;
+
+  while (true)
+  {
+    cur->check_subject = true;
+    if (cur->child)
+    {
+      cur = cur->child;
+      continue;
+    }
+
+    while (!cur->next && (cur != start))
+    {
+      cur = cur->parent;
+    }
+    if (cur == start)
+      break;
+    cur = cur->next;
+  }
+}
+
+/**
+ * unlink_pseudo_threads - Detach pseudo-threads that may need a new parent
+ * @param tctx    Threading context
+ * @param changed Subjects that have changed
+ *
+ * Only the pseudo-threads sharing a changed subject are moved to the top
+ * level.  Their own subjects are added to the set, so that threads which
+ * could now be attached to them are checked, too.
+ */
+static void unlink_pseudo_threads(struct ThreadsContext *tctx, struct HashTable *changed)
+{
+  struct Mailbox *m = tctx->mailbox;
+  bool unlinked;
+
+  /* keep going until no more subjects are added */
+  do
+  {
+    unlinked = false;
+    for (int i = 0; i < m->msg_count; i++)
+    {
+      struct Email *e = m->emails[i];
+      if (!e || !e->thread)
+        continue;
+
+      struct MuttThread *thread = e->thread;
+      struct MuttThread *tnew = NULL, *tmp = NULL;
+      for (tnew = thread->child; tnew; tnew = tmp)
+      {
+        tmp = tnew->next;
+        if (!tnew->fake_thread || !subject_in_set(tnew, changed, true))
+          continue;
+
+        unlink_message(&thread->child, tnew);
+        insert_message(&tctx->tree, NULL, tnew);
+        tnew->fake_thread = false;
+        tnew->sort_key = NULL;
+        thread->sort_children = true;
+        recheck_subjects(tnew);
+        unlinked = true;
+      }
+    }
+  } while (unlinked);
+
+  check_subjects(m, false, changed);
+}
+
+/**
+ * thread_is_pseudo - Does a thread depend on its neighbours?
+ * @param thread Thread to check
+ * @retval true The thread, or one of its children, is a pseudo-thread or a duplicate
+ */
+static bool thread_is_pseudo(const struct MuttThread *thread)
+{
+  if (thread->fake_thread || thread->duplicate_thread)
+    return true;
+  for (const struct MuttThread *child = thread->child; child; child = child->next)
+  {
+    if (child->fake_thread || child->duplicate_thread)
+      return true;
+  }
+
+  return false;
+}
+
+/**
+ * thread_make_placeholder - Turn a thread into a placeholder for a missing message
+ * @param tctx   Threading context
+ * @param thread Thread whose Email has gone
+ *
+ * If nothing is left beneath it, it's unlinked from the tree.
+ */
+static void thread_make_placeholder(struct ThreadsContext *tctx, struct MuttThread *thread)
+{
+  /* The replies' subjects were compared with this one */
+  if (thread->child)
+    recheck_subjects(thread);
+
+  thread->message = NULL;
+  thread->redraw = true;
+
+  /* Unlink the empty placeholders, as a rethread wouldn't create them */
+  struct MuttThread *parent = NULL;
+  while (thread && !thread->message && !thread->child)
+  {
+    parent = thread->parent;
+    unlink_message(parent ? &parent->child : &tctx->tree, thread);
+    thread->parent = NULL;
+    thread->next = NULL;
+    thread->prev = NULL;
+    thread->sort_key = NULL;
+    thread = parent;
+  }
+
+  /* The sort keys above may have come from the Email */
+  for (; thread; thread = thread->parent)
+  {
+    thread->sort_key = NULL;
+    thread->sort_children = true;
+  }
+}
+
+#ifdef USE_HCACHE
+/// Version of the threads saved in the header cache
+#define THREAD_CACHE_VERSION 1
+/// Header cache key of the saved threads
+#define THREAD_CACHE_KEY "/threads"
+
+#define THREAD_CACHE_MESSAGE   (1 << 0) ///< The thread has an Email
+#define THREAD_CACHE_FAKE      (1 << 1) ///< MuttThread::fake_thread
+#define THREAD_CACHE_DUPLICATE (1 << 2) ///< MuttThread::duplicate_thread
+#define THREAD_CACHE_SUBJECT   (1 << 3) ///< Email::subject_changed
+
+/**
+ * struct ThreadCacheId - The identity of an Email in the saved threads
+ */
+struct ThreadCacheId
+{
+  uint64_t id;         ///< Hash of the headers used for threading
+  struct Email *email; ///< Email
+};
+
+/**
+ * struct ThreadCacheKey - The hash key of a placeholder thread
+ */
+struct ThreadCacheKey
+{
+  const struct MuttThread *thread; ///< Placeholder for a missing message
+  const char *key;                 ///< Message-Id of the missing message
+};
+ARRAY_HEAD(ThreadCacheKeyArray, struct ThreadCacheKey);
+
+/**
+ * thread_cache_hash - Add some data to a hash of an Email's headers
+ * @param hash Hash so far
+ * @param data Data to add
+ * @param len  Length of the data
+ * @retval num New hash
+ *
+ * This is the 64-bit FNV-1a hash.
+ */
+static uint64_t thread_cache_hash(uint64_t hash, const void *data, size_t len)
+{
+  const unsigned char *p = data;
+  for (size_t i = 0; i < len; i++)
+  {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/**
+ * thread_cache_hash_str - Add a string to a hash of an Email's headers
+ * @param hash Hash so far
+ * @param str  String to add, may be NULL
+ * @retval num New hash
+ */
+static uint64_t thread_cache_hash_str(uint64_t hash, const char *str)
+{
+  if (!str)
+    return thread_cache_hash(hash, "\xff", 1);
+  return thread_cache_hash(hash, str, strlen(str) + 1);
+}
+
+/**
+ * thread_cache_email_id - Identify an Email by the headers used for threading
+ * @param e        Email
+ * @param received If true, use the received date, see `$thread_received`
+ * @retval num Hash of the headers
+ */
+static uint64_t thread_cache_email_id(const struct Email *e, bool received)
+{
+  const struct Envelope *env = e->env;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+
+  hash = thread_cache_hash_str(hash, env->message_id);
+  hash = thread_cache_hash_str(hash, env->subject);
+  hash = thread_cache_hash_str(hash, env->real_subj);
+  const bool reply = (env->real_subj != env->subject);
+  hash = thread_cache_hash(hash, &reply, sizeof(reply));
+
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &env->in_reply_to, entries)
+  {
+    hash = thread_cache_hash_str(hash, np->data);
+  }
+  hash = thread_cache_hash_str(hash, NULL);
+  STAILQ_FOREACH(np, &env->references, entries)
+  {
+    hash = thread_cache_hash_str(hash, np->data);
+  }
+
+  const time_t date = received ? e->received : e->date_sent;
+  return thread_cache_hash(hash, &date, sizeof(date));
+}
+
+/**
+ * thread_cache_options - Get the options that affect how the Emails are linked
+ * @retval num Bit field of the options
+ */
+static uint32_t thread_cache_options(void)
+{
+  uint32_t opts = 0;
+  if (cs_subset_bool(NeoMutt->sub, "duplicate_threads"))
+    opts |= (1 << 0);
+  if (cs_subset_bool(NeoMutt->sub, "strict_threads"))
+    opts |= (1 << 1);
+  if (cs_subset_bool(NeoMutt->sub, "sort_re"))
+    opts |= (1 << 2);
+  if (cs_subset_bool(NeoMutt->sub, "thread_received"))
+    opts |= (1 << 3);
+  return opts;
+}
+
+/**
+ * thread_cache_open - Open the header cache for a Mailbox's threads
+ * @param m Mailbox
+ * @retval ptr  Header cache
+ * @retval NULL The threads aren't cached
+ *
+ * Only the local Mailbox types are cached.
+ */
+static struct HeaderCache *thread_cache_open(struct Mailbox *m)
+{
+  if (!m || ((m->type != MUTT_MBOX) && (m->type != MUTT_MMDF) &&
+             (m->type != MUTT_MAILDIR) && (m->type != MUTT_MH)))
+  {
+    return NULL;
+  }
+
+  const bool c_header_cache_threads = cs_subset_bool(NeoMutt->sub, "header_cache_threads");
+  if (!c_header_cache_threads)
+    return NULL;
+
+  const char *const c_header_cache = cs_subset_path(NeoMutt->sub, "header_cache");
+  return mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+}
+
+/**
+ * thread_cache_id_cmp - Compare two ThreadCacheIds - Implements ::sort_t
+ */
+static int thread_cache_id_cmp(const void *a, const void *b)
+{
+  const struct ThreadCacheId *ta = a;
+  const struct ThreadCacheId *tb = b;
+  return (ta->id > tb->id) - (ta->id < tb->id);
+}
+
+/**
+ * thread_cache_key_cmp - Compare two ThreadCacheKeys - Implements ::sort_t
+ */
+static int thread_cache_key_cmp(const void *a, const void *b)
+{
+  const uintptr_t ta = (uintptr_t) ((const struct ThreadCacheKey *) a)->thread;
+  const uintptr_t tb = (uintptr_t) ((const struct ThreadCacheKey *) b)->thread;
+  return (ta > tb) - (ta < tb);
+}
+
+/**
+ * thread_cache_find - Find an unthreaded Email by its identity
+ * @param ids Identities of the Emails, sorted
+ * @param num Number of identities
+ * @param id  Identity to find
+ * @retval ptr  Matching Email
+ * @retval NULL The Email has gone, or they've all been threaded
+ */
+static struct Email *thread_cache_find(struct ThreadCacheId *ids, size_t num, uint64_t id)
+{
+  const struct ThreadCacheId find = { id, NULL };
+  struct ThreadCacheId *tci = bsearch(&find, ids, num, sizeof(*ids), thread_cache_id_cmp);
+  if (!tci)
+    return NULL;
+
+  /* Identical copies of an Email share an id */
+  while ((tci > ids) && (tci[-1].id == id))
+    tci--;
+  for (; (tci < (ids + num)) && (tci->id == id); tci++)
+  {
+    if (!tci->email->thread)
+      return tci->email;
+  }
+
+  return NULL;
+}
+
+/**
+ * thread_cache_save - Save the threads in the header cache
+ * @param tctx Threading context
+ *
+ * Each thread is saved in depth-first order, with its depth, its flags and
+ * either the identity of its Email, or the Message-Id of its missing message.
+ */
+static void thread_cache_save(struct ThreadsContext *tctx)
+{
+  struct HeaderCache *hc = thread_cache_open(tctx->mailbox);
+  if (!hc)
+    return;
+
+  /* The placeholders' Message-Ids are only known to the hash */
+  struct ThreadCacheKeyArray keys = ARRAY_HEAD_INITIALIZER;
+  struct HashWalkState state = { 0 };
+  struct HashElem *he = NULL;
+  while ((he = mutt_hash_walk(tctx->hash, &state)))
+  {
+    const struct MuttThread *thread = he->data;
+    if (!thread->message)
+    {
+      struct ThreadCacheKey tck = { thread, he->key.strkey };
+      ARRAY_ADD(&keys, tck);
+    }
+  }
+  ARRAY_SORT(&keys, thread_cache_key_cmp);
+
+  const bool c_thread_received = cs_subset_bool(NeoMutt->sub, "thread_received");
+  struct Buffer buf = mutt_buffer_make(4096);
+  uint32_t header[3] = { THREAD_CACHE_VERSION, thread_cache_options(), 0 };
+  mutt_buffer_addstr_n(&buf, (const char *) header, sizeof(header));
+
+  uint32_t depth = 0;
+  struct MuttThread *thread = tctx->tree;
+  while (thread)
+  {
+    uint8_t flags = 0;
+    if (thread->fake_thread)
+      flags |= THREAD_CACHE_FAKE;
+    if (thread->duplicate_thread)
+      flags |= THREAD_CACHE_DUPLICATE;
 
-          if (c_sort & SORT_LAST)
-          {
-            if (!thread->sort_key ||
-                ((((c_sort & SORT_REVERSE) ? 1 : -1) *
-                  compare_threads((void *) &thread, (void *) &sort_key)) > 0))
-            {
-              thread->sort_key = sort_key->sort_key;
-            }
-          }
-          else if (!thread->sort_key)
-            thread->sort_key = sort_key->sort_key;
+    const char *key = NULL;
+    struct Email *e = thread->message;
+    if (e)
+    {
+      flags |= THREAD_CACHE_MESSAGE;
+      if (e->subject_changed)
+        flags |= THREAD_CACHE_SUBJECT;
+      key = e->env->message_id;
+    }
+    else
+    {
+      const struct ThreadCacheKey find = { thread, NULL };
+      const struct ThreadCacheKey *tck =
+          bsearch(&find, keys.entries, ARRAY_SIZE(&keys), sizeof(find), thread_cache_key_cmp);
+      if (tck)
+        key = tck->key;
+    }
 
-          /* if its sort_key has changed, we need to resort it and siblings */
-          if (oldsort_key != thread->sort_key)
-          {
-            if (thread->parent)
-              thread->parent->sort_children = true;
-            else
-              sort_top = 1;
-          }
-        }
-      }
-      else
-      {
-        oldresort = OptNeedResort;
-        c_sort ^= SORT_REVERSE;
-        cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
-        OptNeedResort = oldresort;
-        FREE(&array);
-        tctx->tree = top;
-        return;
-      }
+    const uint32_t keylen = mutt_str_len(key);
+    mutt_buffer_addstr_n(&buf, (const char *) &depth, sizeof(depth));
+    mutt_buffer_addstr_n(&buf, (const char *) &flags, sizeof(flags));
+    if (e)
+    {
+      const uint64_t id = thread_cache_email_id(e, c_thread_received);
+      mutt_buffer_addstr_n(&buf, (const char *) &id, sizeof(id));
     }
+    mutt_buffer_addstr_n(&buf, (const char *) &keylen, sizeof(keylen));
+    mutt_buffer_addstr_n(&buf, NONULL(key), keylen);
+    header[2]++;
 
-    thread = thread->next;
+    if (thread->child)
+    {
+      thread = thread->child;
+      depth++;
+      continue;
+    }
+
+    while (thread && !thread->next)
+    {
+      thread = thread->parent;
+      depth--;
+    }
+    if (thread)
+      thread = thread->next;
   }
+
+  memcpy(buf.data, header, sizeof(header));
+  mutt_hcache_store_raw(hc, THREAD_CACHE_KEY, sizeof(THREAD_CACHE_KEY) - 1,
+                        buf.data, mutt_buffer_len(&buf));
+  mutt_debug(LL_DEBUG2, "saved %u threads, %zu bytes\n", header[2], mutt_buffer_len(&buf));
+
+  mutt_buffer_dealloc(&buf);
+  ARRAY_FREE(&keys);
+  mutt_hcache_close(hc);
 }
 
 /**
- * check_subjects - Find out which emails' subjects differ from their parent's
- * @param m    Mailbox
- * @param init If true, rebuild the thread
+ * thread_cache_restore - Rebuild the threads from the header cache
+ * @param[in]  tctx    Threading context
+ * @param[in]  data    Saved threads
+ * @param[in]  dlen    Length of the data
+ * @param[out] changed Set to true if Emails have been added or removed
+ * @retval true The threads were rebuilt
+ *
+ * The Emails that have gone become placeholders, as if they'd been removed
+ * with mutt_thread_remove_email().  The new Emails are left unthreaded.
  */
-static void check_subjects(struct Mailbox *m, bool init)
+static bool thread_cache_restore(struct ThreadsContext *tctx, const unsigned char *data,
+                                 size_t dlen, bool *changed)
 {
-  if (!m)
-    return;
+  struct Mailbox *m = tctx->mailbox;
 
+  uint32_t header[3] = { 0 };
+  if (dlen < sizeof(header))
+    return false;
+  memcpy(header, data, sizeof(header));
+  if ((header[0] != THREAD_CACHE_VERSION) || (header[1] != thread_cache_options()))
+    return false;
+
+  const bool c_thread_received = cs_subset_bool(NeoMutt->sub, "thread_received");
+  struct ThreadCacheId *ids = mutt_mem_calloc(MAX(m->msg_count, 1), sizeof(*ids));
+  size_t num_ids = 0;
   for (int i = 0; i < m->msg_count; i++)
   {
     struct Email *e = m->emails[i];
-    if (!e || !e->thread)
+    if (!e || !e->env)
       continue;
+    ids[num_ids].id = thread_cache_email_id(e, c_thread_received);
+    ids[num_ids].email = e;
+    num_ids++;
+  }
+  qsort(ids, num_ids, sizeof(*ids), thread_cache_id_cmp);
 
-    if (e->thread->check_subject)
-      e->thread->check_subject = false;
-    else if (!init)
-      continue;
+  const uint32_t num = header[2];
+  struct MuttThread **parents = mutt_mem_calloc(num + 1, sizeof(*parents));
+  ARRAY_HEAD(, struct MuttThread *) removed = ARRAY_HEAD_INITIALIZER;
+  size_t num_threaded = 0;
+  bool rc = false;
 
-    /* figure out which messages have subjects different than their parents' */
-    struct MuttThread *tmp = e->thread->parent;
-    while (tmp && !tmp->message)
+  tctx->hash = mutt_hash_new(MAX(m->msg_count, num) * 2, MUTT_HASH_ALLOW_DUPS);
+  mutt_hash_set_destructor(tctx->hash, thread_hash_destructor, 0);
+
+  size_t off = sizeof(header);
+  uint32_t max_depth = 0;
+  for (uint32_t i = 0; i < num; i++)
+  {
+    uint32_t depth = 0;
+    uint8_t flags = 0;
+    uint64_t id = 0;
+    uint32_t keylen = 0;
+
+    if ((dlen - off) < (sizeof(depth) + sizeof(flags)))
+      goto done;
+    memcpy(&depth, data + off, sizeof(depth));
+    off += sizeof(depth);
+    memcpy(&flags, data + off, sizeof(flags));
+    off += sizeof(flags);
+
+    if (flags & THREAD_CACHE_MESSAGE)
     {
-      tmp = tmp->parent;
+      if ((dlen - off) < sizeof(id))
+        goto done;
+      memcpy(&id, data + off, sizeof(id));
+      off += sizeof(id);
     }
 
-    if (!tmp)
-      e->subject_changed = true;
-    else if (e->env->real_subj && tmp->message->env->real_subj)
+    if ((dlen - off) < sizeof(keylen))
+      goto done;
+    memcpy(&keylen, data + off, sizeof(keylen));
+    off += sizeof(keylen);
+    if (((dlen - off) < keylen) || (depth > max_depth))
+      goto done;
+    const char *key = (const char *) data + off;
+    off += keylen;
+
+    struct MuttThread *thread = mutt_mem_calloc(1, sizeof(struct MuttThread));
+    thread->fake_thread = (flags & THREAD_CACHE_FAKE);
+    thread->duplicate_thread = (flags & THREAD_CACHE_DUPLICATE);
+
+    struct Email *e = NULL;
+    if (flags & THREAD_CACHE_MESSAGE)
+      e = thread_cache_find(ids, num_ids, id);
+
+    if (e)
     {
-      e->subject_changed = !mutt_str_equal(e->env->real_subj, tmp->message->env->real_subj);
+      thread->message = e;
+      e->thread = thread;
+      e->threaded = true;
+      e->subject_changed = (flags & THREAD_CACHE_SUBJECT);
+      mutt_hash_insert(tctx->hash, e->env->message_id ? e->env->message_id : "", thread);
+      num_threaded++;
     }
     else
     {
-      e->subject_changed = (e->env->real_subj || tmp->message->env->real_subj);
+      if (flags & THREAD_CACHE_MESSAGE)
+        ARRAY_ADD(&removed, thread);
+
+      char *copy = mutt_strn_dup(key, keylen);
+      mutt_list_insert_tail(&tctx->keys, copy);
+      mutt_hash_insert(tctx->hash, copy, thread);
     }
+
+    if (depth == 0)
+      insert_message(&tctx->tree, NULL, thread);
+    else
+      insert_message(&parents[depth - 1]->child, parents[depth - 1], thread);
+    parents[depth] = thread;
+    max_depth = depth + 1;
+  }
+
+  if (off != dlen)
+    goto done;
+
+  /* Pseudo-threads and duplicates depend on the Emails that have gone */
+  struct MuttThread **tp = NULL;
+  ARRAY_FOREACH(tp, &removed)
+  {
+    if (thread_is_pseudo(*tp))
+      goto done;
   }
+  ARRAY_FOREACH(tp, &removed)
+  {
+    thread_make_placeholder(tctx, *tp);
+  }
+
+  tctx->msg_count = num_threaded;
+  *changed = !ARRAY_EMPTY(&removed) || (num_threaded != num_ids);
+  rc = true;
+
+done:
+  if (!rc)
+  {
+    mutt_debug(LL_DEBUG1, "the saved threads don't match\n");
+    mutt_clear_threads(tctx);
+  }
+  ARRAY_FREE(&removed);
+  FREE(&parents);
+  FREE(&ids);
+  return rc;
+}
+
+/**
+ * thread_cache_load - Load the threads from the header cache
+ * @param[in]  tctx    Threading context
+ * @param[out] changed Set to true if Emails have been added or removed
+ * @retval true The threads were loaded
+ */
+static bool thread_cache_load(struct ThreadsContext *tctx, bool *changed)
+{
+  struct HeaderCache *hc = thread_cache_open(tctx->mailbox);
+  if (!hc)
+    return false;
+
+  size_t dlen = 0;
+  void *data = mutt_hcache_fetch_raw(hc, THREAD_CACHE_KEY, sizeof(THREAD_CACHE_KEY) - 1, &dlen);
+  const bool rc = data && thread_cache_restore(tctx, data, dlen, changed);
+
+  mutt_hcache_free_raw(hc, &data);
+  mutt_hcache_close(hc);
+  return rc;
 }
+#endif
 
 /**
  * mutt_sort_threads - Sort email threads
@@ -882,6 +1687,9 @@ static void check_subjects(struct Mailbox *m, bool init)
  */
 void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
 {
+  PERF_SCOPE("mutt_sort_threads");
+  TRACE_SCOPE("mailbox", "mutt_sort_threads", NULL);
+
   if (!tctx || !tctx->mailbox)
     return;
 
@@ -893,6 +1701,10 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
   struct MuttThread top = { 0 };
   struct ListNode *ref = NULL;
 
+  /* Threading needs the References and In-Reply-To headers */
+  for (i = 0; i < m->msg_count; i++)
+    email_env_load(m->emails[i]);
+
   /* Set `$sort` to the secondary method to support the set sort_aux=reverse-*
    * settings.  The sorting functions just look at the value of SORT_REVERSE */
   short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
@@ -906,12 +1718,31 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
   if (!tctx->hash)
     init = true;
 
+  /* If the threads are restored from the header cache, only the emails that
+   * have been added since they were saved need linking */
+  bool relink = !init;
+#ifdef USE_HCACHE
+  bool save = init;
+#endif
   if (init)
   {
-    tctx->hash = mutt_hash_new(m->msg_count * 2, MUTT_HASH_ALLOW_DUPS);
-    mutt_hash_set_destructor(tctx->hash, thread_hash_destructor, 0);
+#ifdef USE_HCACHE
+    relink = thread_cache_load(tctx, &save);
+#endif
+    if (!relink)
+    {
+      tctx->hash = mutt_hash_new(m->msg_count * 2, MUTT_HASH_ALLOW_DUPS);
+      mutt_hash_set_destructor(tctx->hash, thread_hash_destructor, 0);
+    }
   }
 
+  /* Unless we're rethreading from scratch, only the threads that share a
+   * subject with the new emails need their pseudo-threads checked again.
+   * A plain resort leaves them alone. */
+  struct HashTable *changed = NULL;
+  if (relink)
+    changed = mutt_hash_new(64, MUTT_HASH_NO_FLAGS);
+
   /* we want a quick way to see if things are actually attached to the top of the
    * thread tree or if they're just dangling, so we attach everything to a top
    * node temporarily */
@@ -937,7 +1768,7 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
     {
       const bool c_duplicate_threads =
           cs_subset_bool(NeoMutt->sub, "duplicate_threads");
-      if ((!init || c_duplicate_threads) && e->env->message_id)
+      if ((relink || c_duplicate_threads) && e->env->message_id)
         thread = mutt_hash_find(tctx->hash, e->env->message_id);
       else
         thread = NULL;
@@ -948,6 +1779,7 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
         thread->message = e;
         e->thread = thread;
         thread->check_subject = true;
+        thread->redraw = true;
 
         /* mark descendants as needing subject_changed checked */
         for (tmp = (thread->child ? thread->child : thread); tmp != thread;)
@@ -1002,23 +1834,6 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
         }
       }
     }
-    else
-    {
-      /* unlink pseudo-threads because they might be children of newly
-       * arrived messages */
-      thread = e->thread;
-      for (tnew = thread->child; tnew;)
-      {
-        tmp = tnew->next;
-        if (tnew->fake_thread)
-        {
-          unlink_message(&thread->child, tnew);
-          insert_message(&top.child, &top, tnew);
-          tnew->fake_thread = false;
-        }
-        tnew = tmp;
-      }
-    }
   }
 
   /* thread by references */
@@ -1109,11 +1924,24 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
   }
   tctx->tree = top.child;
 
-  check_subjects(tctx->mailbox, init);
+  tctx->msg_count = m->msg_count;
 
+  const int num_checked = check_subjects(tctx->mailbox, !relink, changed);
+
+  /* if no subjects have changed, neither have the pseudo-threads */
   const bool c_strict_threads = cs_subset_bool(NeoMutt->sub, "strict_threads");
-  if (!c_strict_threads)
-    pseudo_threads(tctx);
+  if (!c_strict_threads && (!changed || (num_checked > 0)))
+  {
+    if (changed)
+      unlink_pseudo_threads(tctx, changed);
+    pseudo_threads(tctx, changed);
+  }
+  mutt_hash_free(&changed);
+
+#ifdef USE_HCACHE
+  if (save)
+    thread_cache_save(tctx);
+#endif
 
   if (tctx->tree)
   {
@@ -1128,7 +1956,7 @@ void mutt_sort_threads(struct ThreadsContext *tctx, bool init)
     linearize_tree(tctx);
 
     /* Draw the thread tree. */
-    mutt_draw_tree(tctx);
+    draw_tree(tctx, init);
   }
 }
 
@@ -1603,23 +2431,135 @@ bool mutt_link_threads(struct Email *parent, struct EmailList *children, struct
   return changed;
 }
 
+/**
+ * thread_next - Find the next node of a thread, depth first
+ * @param top    Top of the thread
+ * @param thread Current node
+ * @retval ptr  Next node
+ * @retval NULL No more nodes in the thread
+ */
+static struct MuttThread *thread_next(struct MuttThread *top, struct MuttThread *thread)
+{
+  if (thread->child)
+    return thread->child;
+
+  while ((thread != top) && !thread->next)
+    thread = thread->parent;
+
+  return (thread == top) ? NULL : thread->next;
+}
+
+/**
+ * thread_can_collapse - Check whether a thread can be collapsed
+ * @param top              Top of the thread
+ * @param collapse_unread  Value of `$collapse_unread`
+ * @param collapse_flagged Value of `$collapse_flagged`
+ * @retval true Can be collapsed
+ *
+ * This is the same test as mutt_thread_can_collapse(), in one pass.
+ */
+static bool thread_can_collapse(struct MuttThread *top, bool collapse_unread,
+                                bool collapse_flagged)
+{
+  if (collapse_unread && collapse_flagged)
+    return true;
+
+  for (struct MuttThread *thread = top; thread; thread = thread_next(top, thread))
+  {
+    struct Email *e = thread->message;
+    if (!e || !e->visible)
+      continue;
+    if (!collapse_unread && !e->read)
+      return false;
+    if (!collapse_flagged && e->flagged)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * thread_set_collapsed - Collapse or uncollapse a thread
+ * @param top      Top of the thread
+ * @param collapse Collapse / uncollapse
+ *
+ * This has the same effect as mutt_collapse_thread() or
+ * mutt_uncollapse_thread(), but doesn't look for the new cursor position.
+ * The caller must call mutt_set_vnum() afterwards.
+ */
+static void thread_set_collapsed(struct MuttThread *top, bool collapse)
+{
+  struct Email *e_root = NULL;
+  int num_visible = 0;
+
+  for (struct MuttThread *thread = top; thread; thread = thread_next(top, thread))
+  {
+    struct Email *e = thread->message;
+    if (!e)
+      continue;
+
+    e->pair = 0; /* force index entry's color to be re-evaluated */
+    e->collapsed = collapse;
+    if (e->visible)
+      num_visible++;
+
+    if (collapse)
+    {
+      /* The first visible email stands for the thread */
+      if (!e_root && e->visible)
+        e_root = e;
+      else
+        e->vnum = -1;
+    }
+    else if (e->visible)
+    {
+      e->vnum = e->msgno;
+    }
+  }
+
+  /* store num_hidden in all headers, with or without a virtual index.  this
+   * will allow ~v to match all collapsed messages when switching sort order
+   * to non-threaded.  */
+  if (collapse)
+  {
+    const int num_hidden = num_visible - (e_root ? 1 : 0) + 1;
+    for (struct MuttThread *thread = top; thread; thread = thread_next(top, thread))
+    {
+      if (thread->message)
+        thread->message->num_hidden = num_hidden;
+    }
+  }
+  else if (!top->child && top->message)
+  {
+    top->message->num_hidden = 0;
+  }
+}
+
+/**
+ * thread_top_email - Find the first email of a thread
+ * @param top Top of the thread
+ * @retval ptr Email
+ */
+static struct Email *thread_top_email(struct MuttThread *top)
+{
+  struct MuttThread *thread = top;
+  while (!thread->message)
+    thread = thread->child;
+  return thread->message;
+}
+
 /**
  * mutt_thread_collapse_collapsed - re-collapse threads marked as collapsed
  * @param tctx Threading context
+ *
+ * The caller must call mutt_set_vnum() afterwards.
  */
 void mutt_thread_collapse_collapsed(struct ThreadsContext *tctx)
 {
-  struct MuttThread *thread = NULL;
-  struct MuttThread *top = tctx->tree;
-  while ((thread = top))
+  for (struct MuttThread *top = tctx->tree; top; top = top->next)
   {
-    while (!thread->message)
-      thread = thread->child;
-
-    struct Email *e = thread->message;
-    if (e->collapsed)
-      mutt_collapse_thread(e);
-    top = top->next;
+    if (thread_top_email(top)->collapsed)
+      thread_set_collapsed(top, true);
   }
 }
 
@@ -1627,26 +2567,25 @@ void mutt_thread_collapse_collapsed(struct ThreadsContext *tctx)
  * mutt_thread_collapse - toggle collapse
  * @param tctx Threading context
  * @param collapse Collapse / uncollapse
+ *
+ * Each thread is visited once, or twice if `$collapse_unread` or
+ * `$collapse_flagged` is unset.  The caller must call mutt_set_vnum()
+ * afterwards.
  */
 void mutt_thread_collapse(struct ThreadsContext *tctx, bool collapse)
 {
-  struct MuttThread *thread = NULL;
-  struct MuttThread *top = tctx->tree;
-  while ((thread = top))
-  {
-    while (!thread->message)
-      thread = thread->child;
+  const bool c_collapse_unread = cs_subset_bool(NeoMutt->sub, "collapse_unread");
+  const bool c_collapse_flagged =
+      cs_subset_bool(NeoMutt->sub, "collapse_flagged");
 
-    struct Email *e = thread->message;
+  for (struct MuttThread *top = tctx->tree; top; top = top->next)
+  {
+    struct Email *e = thread_top_email(top);
+    if (e->collapsed == collapse)
+      continue;
 
-    if (e->collapsed != collapse)
-    {
-      if (e->collapsed)
-        mutt_uncollapse_thread(e);
-      else if (mutt_thread_can_collapse(e))
-        mutt_collapse_thread(e);
-    }
-    top = top->next;
+    if (!collapse || thread_can_collapse(top, c_collapse_unread, c_collapse_flagged))
+      thread_set_collapsed(top, collapse);
   }
 }
 
@@ -1665,3 +2604,97 @@ bool mutt_thread_can_collapse(struct Email *e)
   return (c_collapse_unread || !mutt_thread_contains_unread(e)) &&
          (c_collapse_flagged || !mutt_thread_contains_flagged(e));
 }
+
+/**
+ * mutt_thread_only_appended - Have emails only been added since the threads were built?
+ * @param tctx Threading context
+ * @retval true The threads are intact and any new emails follow the threaded ones
+ *
+ * If so, the new emails can be linked into the existing threads, by calling
+ * mutt_sort_threads() with `init` set to false.
+ */
+bool mutt_thread_only_appended(struct ThreadsContext *tctx)
+{
+  if (!tctx || !tctx->mailbox || !tctx->tree || !tctx->hash)
+    return false;
+
+  struct Mailbox *m = tctx->mailbox;
+  if (m->msg_count < tctx->msg_count)
+    return false;
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (!e || ((i < tctx->msg_count) != (e->thread != NULL)))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * thread_keep_key - Stop the thread hash using an Email's string as a key
+ * @param tctx Threading context
+ * @param key  String belonging to an Email that's being removed
+ *
+ * The hash doesn't copy its keys, so any that point to the string are
+ * replaced by a copy, which lasts as long as the threads.
+ */
+static void thread_keep_key(struct ThreadsContext *tctx, const char *key)
+{
+  if (!key)
+    return;
+
+  char *copy = NULL;
+  for (struct HashElem *he = mutt_hash_find_elem(tctx->hash, key); he; he = he->next)
+  {
+    if (he->key.strkey != key)
+      continue;
+
+    if (!copy)
+    {
+      copy = mutt_str_dup(key);
+      mutt_list_insert_tail(&tctx->keys, copy);
+    }
+    he->key.strkey = copy;
+  }
+}
+
+/**
+ * mutt_thread_remove_email - Take an Email out of the threads
+ * @param tctx Threading context
+ * @param e    Email that's being removed from the Mailbox
+ * @retval true  The Email was removed, the other threads are intact
+ * @retval false The threads must be rebuilt, e.g. mutt_clear_threads()
+ *
+ * The Email's thread becomes a placeholder, like the one for a missing
+ * message.  If nothing is left beneath it, it's unlinked from the tree.
+ * mutt_sort_threads() with `init` set to false will fix up the sort keys,
+ * subjects and pseudo-threads.
+ */
+bool mutt_thread_remove_email(struct ThreadsContext *tctx, struct Email *e)
+{
+  if (!tctx || !tctx->tree || !tctx->hash || !e || !e->thread)
+    return false;
+
+  struct MuttThread *thread = e->thread;
+  if (thread_is_pseudo(thread))
+    return false;
+
+  thread_keep_key(tctx, e->env->message_id);
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, &e->env->in_reply_to, entries)
+  {
+    thread_keep_key(tctx, np->data);
+  }
+  STAILQ_FOREACH(np, &e->env->references, entries)
+  {
+    thread_keep_key(tctx, np->data);
+  }
+
+  e->thread = NULL;
+  tctx->msg_count--;
+  thread_make_placeholder(tctx, thread);
+
+  return true;
+}
@@ -56,6 +56,7 @@
 #include "init.h"
 #include "mutt_globals.h"
 #include "mx.h"
+#include "options.h"
 #include "protos.h"
 #ifdef USE_IMAP
 #include "imap/lib.h"
@@ -765,6 +766,379 @@ void mutt_safe_path(struct Buffer *dest, const struct Address *a)
       *p = '_';
 }
 
+/// Maximum number of compiled format strings to keep
+#define EXPANDO_CACHE_MAX 64
+
+/**
+ * enum ExpandoTokenType - Types of ExpandoToken
+ */
+enum ExpandoTokenType
+{
+  EXP_TEXT = 1, ///< Plain text
+  EXP_CHAR,     ///< A single character, e.g. from `%%` or `\n`
+  EXP_PAD,      ///< Padding, `%>X` or `%*X`
+  EXP_PAD_EOL,  ///< Padding to the end of the line, `%|X`
+  EXP_EXPANDO,  ///< An expando, handled by the callback
+  EXP_END,      ///< End of the format, or a bad format
+};
+
+/**
+ * struct ExpandoToken - A parsed part of a format string
+ */
+struct ExpandoToken
+{
+  enum ExpandoTokenType type; ///< Type of token, e.g. #EXP_TEXT
+  size_t next;                ///< Offset of the text following the token
+  size_t len;                 ///< Length of the text, in bytes (#EXP_TEXT)
+  size_t width;               ///< Width of the text, in screen columns (#EXP_TEXT)
+  char ch;                    ///< Character, or expando letter
+  bool optional;              ///< Expando is a conditional, `%<x?if&else>`
+  bool to_lower;              ///< Expando has the `_` modifier
+  bool no_dots;               ///< Expando has the `:` modifier
+  char prefix[128];           ///< Expando's format, e.g. "-20.20"
+  char if_str[128];           ///< Conditional's 'if' text
+  char else_str[128];         ///< Conditional's 'else' text
+};
+
+/**
+ * struct ExpandoFormat - A format string, compiled into tokens
+ *
+ * The string is parsed the first time it's expanded.  Conditionals in the
+ * old `%?x?y&z?` notation are rewritten as `%<x?y&z>`, as they're parsed.
+ */
+struct ExpandoFormat
+{
+  char *src;                             ///< Copy of the format string (maybe rewritten)
+  size_t size;                           ///< Size of src
+  int *index;                            ///< Index of the token at each offset, plus one
+  ARRAY_HEAD(, struct ExpandoToken) tokens; ///< Parsed tokens
+};
+
+static struct HashTable *ExpandoCache = NULL; ///< Compiled format strings
+static int ExpandoDepth = 0;                  ///< Nesting of mutt_expando_format()
+
+/**
+ * expando_format_free - Free an ExpandoFormat - Implements ::hash_hdata_free_t
+ */
+static void expando_format_free(int type, void *obj, intptr_t data)
+{
+  struct ExpandoFormat *ef = obj;
+  FREE(&ef->src);
+  FREE(&ef->index);
+  ARRAY_FREE(&ef->tokens);
+  FREE(&ef);
+}
+
+/**
+ * expando_format_get - Get the compiled version of a format string
+ * @param src Format string
+ * @retval ptr Compiled format
+ */
+static struct ExpandoFormat *expando_format_get(const char *src)
+{
+  struct ExpandoFormat *ef = mutt_hash_find(ExpandoCache, src);
+  if (ef)
+    return ef;
+
+  /* Don't free the formats that are being expanded by the outer calls */
+  if (!ExpandoCache || ((ExpandoDepth == 1) && (ExpandoCache->num_keys >= EXPANDO_CACHE_MAX)))
+  {
+    mutt_hash_free(&ExpandoCache);
+    ExpandoCache = mutt_hash_new(EXPANDO_CACHE_MAX, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(ExpandoCache, expando_format_free, 0);
+  }
+
+  /* Leave room for the rewriting of the conditionals */
+  const size_t len = mutt_str_len(src);
+  ef = mutt_mem_calloc(1, sizeof(struct ExpandoFormat));
+  ef->size = MAX(256, (len * 3) + 1);
+  ef->src = mutt_mem_calloc(1, ef->size);
+  memcpy(ef->src, src, len);
+  ef->index = mutt_mem_calloc(ef->size, sizeof(int));
+  ARRAY_INIT(&ef->tokens);
+
+  mutt_hash_insert(ExpandoCache, src, ef);
+  return ef;
+}
+
+/**
+ * expando_parse - Parse one token of a format string
+ * @param[in]  ef  Compiled format
+ * @param[in]  off Offset of the token
+ * @param[out] tok Token
+ */
+static void expando_parse(struct ExpandoFormat *ef, size_t off, struct ExpandoToken *tok)
+{
+  char *src = ef->src + off;
+  char *cp = NULL;
+  size_t count;
+
+  memset(tok, 0, sizeof(*tok));
+  tok->type = EXP_END;
+
+  if (*src == '%')
+  {
+    if (*++src == '%')
+    {
+      tok->type = EXP_CHAR;
+      tok->ch = '%';
+      tok->next = (src + 1) - ef->src;
+      return;
+    }
+
+    if (*src == '?')
+    {
+      /* change original %? to new %< notation */
+      /* %?x?y&z? to %<x?y&z> where y and z are nestable */
+      char *p = (char *) src;
+      *p = '<';
+      /* skip over "x" */
+      for (; *p && (*p != '?'); p++)
+        ; // do nothing
+
+      /* nothing */
+      if (*p == '?')
+        p++;
+      /* fix up the "y&z" section */
+      for (; *p && (*p != '?'); p++)
+      {
+        /* escape '<' and '>' to work inside nested-if */
+        if (((*p == '<') || (*p == '>')) &&
+            ((p - ef->src) + mutt_str_len(p) + 3 <= ef->size))
+        {
+          memmove(p + 2, p, mutt_str_len(p) + 1);
+          *p++ = '\\';
+          *p++ = '\\';
+        }
+      }
+      if (*p == '?')
+        *p = '>';
+    }
+
+    if (*src == '<')
+    {
+      tok->optional = true;
+      tok->ch = *(++src); /* save the character to switch on */
+      src++;
+      cp = tok->prefix;
+      count = 0;
+      while ((count < sizeof(tok->prefix)) && (*src != '?'))
+      {
+        *cp++ = *src++;
+        count++;
+      }
+      *cp = '\0';
+    }
+    else
+    {
+      /* eat the format string */
+      cp = tok->prefix;
+      count = 0;
+      while ((count < sizeof(tok->prefix)) && (isdigit((unsigned char) *src) || (*src == '.') ||
+                                               (*src == '-') || (*src == '=')))
+      {
+        *cp++ = *src++;
+        count++;
+      }
+      *cp = '\0';
+
+      if (*src == '\0')
+        return; /* bad format */
+
+      tok->ch = *src++; /* save the character to switch on */
+    }
+
+    if (tok->optional)
+    {
+      int lrbalance;
+
+      if (*src != '?')
+        return; /* bad format */
+      src++;
+
+      /* eat the 'if' part of the string */
+      cp = tok->if_str;
+      count = 0;
+      lrbalance = 1;
+      while ((lrbalance > 0) && (count < sizeof(tok->if_str)) && *src)
+      {
+        if ((src[0] == '%') && (src[1] == '>'))
+        {
+          /* This is a padding expando; copy two chars and carry on */
+          *cp++ = *src++;
+          *cp++ = *src++;
+          count += 2;
+          continue;
+        }
+
+        if (*src == '\\')
+        {
+          src++;
+          *cp++ = *src++;
+        }
+        else if ((src[0] == '%') && (src[1] == '<'))
+        {
+          lrbalance++;
+        }
+        else if (src[0] == '>')
+        {
+          lrbalance--;
+        }
+        if (lrbalance == 0)
+          break;
+        if ((lrbalance == 1) && (src[0] == '&'))
+          break;
+        *cp++ = *src++;
+        count++;
+      }
+      *cp = '\0';
+
+      /* eat the 'else' part of the string (optional) */
+      if (*src == '&')
+        src++; /* skip the & */
+      cp = tok->else_str;
+      count = 0;
+      while ((lrbalance > 0) && (count < sizeof(tok->else_str)) && (*src != '\0'))
+      {
+        if ((src[0] == '%') && (src[1] == '>'))
+        {
+          /* This is a padding expando; copy two chars and carry on */
+          *cp++ = *src++;
+          *cp++ = *src++;
+          count += 2;
+          continue;
+        }
+
+        if (*src == '\\')
+        {
+          src++;
+          *cp++ = *src++;
+        }
+        else if ((src[0] == '%') && (src[1] == '<'))
+        {
+          lrbalance++;
+        }
+        else if (src[0] == '>')
+        {
+          lrbalance--;
+        }
+        if (lrbalance == 0)
+          break;
+        if ((lrbalance == 1) && (src[0] == '&'))
+          break;
+        *cp++ = *src++;
+        count++;
+      }
+      *cp = '\0';
+
+      if ((*src == '\0'))
+        return; /* bad format */
+
+      src++; /* move past the trailing '>' (formerly '?') */
+    }
+
+    if ((tok->ch == '>') || (tok->ch == '*'))
+    {
+      tok->type = EXP_PAD;
+    }
+    else if (tok->ch == '|')
+    {
+      tok->type = EXP_PAD_EOL;
+    }
+    else
+    {
+      while ((tok->ch == '_') || (tok->ch == ':'))
+      {
+        if (tok->ch == '_')
+          tok->to_lower = true;
+        else if (tok->ch == ':')
+          tok->no_dots = true;
+
+        tok->ch = *src++;
+      }
+      tok->type = EXP_EXPANDO;
+    }
+    tok->next = src - ef->src;
+  }
+  else if (*src == '\\')
+  {
+    if (!*++src)
+      return;
+    switch (*src)
+    {
+      case 'f':
+        tok->ch = '\f';
+        break;
+      case 'n':
+        tok->ch = '\n';
+        break;
+      case 'r':
+        tok->ch = '\r';
+        break;
+      case 't':
+        tok->ch = '\t';
+        break;
+      case 'v':
+        tok->ch = '\v';
+        break;
+      default:
+        tok->ch = *src;
+        break;
+    }
+    tok->type = EXP_CHAR;
+    tok->next = (src + 1) - ef->src;
+  }
+  else
+  {
+    /* A run of plain text */
+    tok->type = EXP_TEXT;
+    while (*src && (*src != '%') && (*src != '\\'))
+    {
+      int width;
+      /* in case of error, simply copy byte */
+      int bytes = mutt_mb_charlen(src, &width);
+      if (bytes < 0)
+      {
+        bytes = 1;
+        width = 1;
+      }
+      src += bytes;
+      tok->len += bytes;
+      tok->width += width;
+    }
+    tok->next = src - ef->src;
+  }
+}
+
+/**
+ * expando_token - Get the token at an offset of a format string
+ * @param ef  Compiled format
+ * @param off Offset of the token
+ * @retval ptr Token
+ *
+ * The token is parsed the first time it's needed.
+ */
+static const struct ExpandoToken *expando_token(struct ExpandoFormat *ef, size_t off)
+{
+  if (ef->index[off] == 0)
+  {
+    struct ExpandoToken tok;
+    expando_parse(ef, off, &tok);
+    ARRAY_ADD(&ef->tokens, tok);
+    ef->index[off] = ARRAY_SIZE(&ef->tokens);
+  }
+
+  return ARRAY_GET(&ef->tokens, ef->index[off] - 1);
+}
+
+/**
+ * mutt_expando_cleanup - Free the compiled format strings
+ */
+void mutt_expando_cleanup(void)
+{
+  mutt_hash_free(&ExpandoCache);
+}
+
 /**
  * mutt_expando_format - Expand expandos (%x) in a string
  * @param[out] buf      Buffer in which to save string
@@ -775,27 +1149,23 @@ void mutt_safe_path(struct Buffer *dest, const struct Address *a)
  * @param[in]  callback Callback - Implements ::format_t
  * @param[in]  data     Callback data
  * @param[in]  flags    Callback flags
+ *
+ * The format string is compiled into tokens the first time it's used, so
+ * redrawing, e.g. the index, doesn't have to parse it again.
  */
 void mutt_expando_format(char *buf, size_t buflen, size_t col, int cols, const char *src,
                          format_t callback, intptr_t data, MuttFormatFlags flags)
 {
-  char prefix[128], tmp[1024];
-  char *cp = NULL, *wptr = buf;
-  char ch;
-  char if_str[128], else_str[128];
-  size_t wlen, count, len, wid;
+  char tmp[1024];
+  char *wptr = buf;
+  size_t wlen, len, wid;
   FILE *fp_filter = NULL;
   char *recycler = NULL;
 
-  char src2[256];
-  mutt_str_copy(src2, src, mutt_str_len(src) + 1);
-  src = src2;
-
   const bool c_arrow_cursor = cs_subset_bool(NeoMutt->sub, "arrow_cursor");
   const char *const c_arrow_string =
       cs_subset_string(NeoMutt->sub, "arrow_string");
 
-  prefix[0] = '\0';
   buflen--; /* save room for the terminal \0 */
   wlen = ((flags & MUTT_FORMAT_ARROWCURSOR) && c_arrow_cursor) ?
              mutt_strwidth(c_arrow_string) + 1 :
@@ -932,374 +1302,213 @@ void mutt_expando_format(char *buf, size_t buflen, size_t col, int cols, const c
     }
   }
 
-  while (*src && (wlen < buflen))
+  if (!src || (*src == '\0'))
   {
-    if (*src == '%')
+    *wptr = '\0';
+    return;
+  }
+
+  ExpandoDepth++;
+  struct ExpandoFormat *ef = expando_format_get(src);
+  size_t off = 0;
+
+  while (ef->src[off] && (wlen < buflen))
+  {
+    const struct ExpandoToken *ptok = expando_token(ef, off);
+
+    if (ptok->type == EXP_TEXT)
     {
-      if (*++src == '%')
+      if ((wlen + ptok->len) < buflen)
       {
-        *wptr++ = '%';
-        wlen++;
-        col++;
-        src++;
+        memcpy(wptr, ef->src + off, ptok->len);
+        wptr += ptok->len;
+        wlen += ptok->len;
+        col += ptok->width;
+        off = ptok->next;
         continue;
       }
 
-      if (*src == '?')
-      {
-        /* change original %? to new %< notation */
-        /* %?x?y&z? to %<x?y&z> where y and z are nestable */
-        char *p = (char *) src;
-        *p = '<';
-        /* skip over "x" */
-        for (; *p && (*p != '?'); p++)
-          ; // do nothing
-
-        /* nothing */
-        if (*p == '?')
-          p++;
-        /* fix up the "y&z" section */
-        for (; *p && (*p != '?'); p++)
-        {
-          /* escape '<' and '>' to work inside nested-if */
-          if ((*p == '<') || (*p == '>'))
-          {
-            memmove(p + 2, p, mutt_str_len(p) + 1);
-            *p++ = '\\';
-            *p++ = '\\';
-          }
-        }
-        if (*p == '?')
-          *p = '>';
-      }
-
-      if (*src == '<')
+      /* Not enough room: copy as many characters as will fit */
+      const char *text = ef->src + off;
+      while (text < (ef->src + ptok->next))
       {
-        flags |= MUTT_FORMAT_OPTIONAL;
-        ch = *(++src); /* save the character to switch on */
-        src++;
-        cp = prefix;
-        count = 0;
-        while ((count < sizeof(prefix)) && (*src != '?'))
+        int bytes, width;
+        /* in case of error, simply copy byte */
+        bytes = mutt_mb_charlen(text, &width);
+        if (bytes < 0)
         {
-          *cp++ = *src++;
-          count++;
+          bytes = 1;
+          width = 1;
         }
-        *cp = '\0';
+        if ((wlen + bytes) >= buflen)
+          break;
+        memcpy(wptr, text, bytes);
+        wptr += bytes;
+        text += bytes;
+        wlen += bytes;
+        col += width;
       }
-      else
-      {
-        flags &= ~MUTT_FORMAT_OPTIONAL;
+      wlen = buflen;
+      break;
+    }
 
-        /* eat the format string */
-        cp = prefix;
-        count = 0;
-        while ((count < sizeof(prefix)) && (isdigit((unsigned char) *src) || (*src == '.') ||
-                                            (*src == '-') || (*src == '=')))
-        {
-          *cp++ = *src++;
-          count++;
-        }
-        *cp = '\0';
+    if (ptok->type == EXP_CHAR)
+    {
+      *wptr++ = ptok->ch;
+      wlen++;
+      col++;
+      off = ptok->next;
+      continue;
+    }
 
-        if (*src == '\0')
-          break; /* bad format */
+    if (ptok->type == EXP_END)
+      break;
 
-        ch = *src++; /* save the character to switch on */
-      }
+    /* The callback may expand this format again, so take a copy */
+    struct ExpandoToken tok = *ptok;
+    const char *src = ef->src + tok.next;
+    if (tok.optional)
+      flags |= MUTT_FORMAT_OPTIONAL;
+    else
+      flags &= ~MUTT_FORMAT_OPTIONAL;
 
-      if (flags & MUTT_FORMAT_OPTIONAL)
+    /* handle generic cases first */
+    if (tok.type == EXP_PAD)
+    {
+      /* %>X: right justify to EOL, left takes precedence
+       * %*X: right justify to EOL, right takes precedence */
+      int soft = tok.ch == '*';
+      int pl, pw;
+      pl = mutt_mb_charlen(src, &pw);
+      if (pl <= 0)
       {
-        int lrbalance;
-
-        if (*src != '?')
-          break; /* bad format */
-        src++;
-
-        /* eat the 'if' part of the string */
-        cp = if_str;
-        count = 0;
-        lrbalance = 1;
-        while ((lrbalance > 0) && (count < sizeof(if_str)) && *src)
-        {
-          if ((src[0] == '%') && (src[1] == '>'))
-          {
-            /* This is a padding expando; copy two chars and carry on */
-            *cp++ = *src++;
-            *cp++ = *src++;
-            count += 2;
-            continue;
-          }
-
-          if (*src == '\\')
-          {
-            src++;
-            *cp++ = *src++;
-          }
-          else if ((src[0] == '%') && (src[1] == '<'))
-          {
-            lrbalance++;
-          }
-          else if (src[0] == '>')
-          {
-            lrbalance--;
-          }
-          if (lrbalance == 0)
-            break;
-          if ((lrbalance == 1) && (src[0] == '&'))
-            break;
-          *cp++ = *src++;
-          count++;
-        }
-        *cp = '\0';
-
-        /* eat the 'else' part of the string (optional) */
-        if (*src == '&')
-          src++; /* skip the & */
-        cp = else_str;
-        count = 0;
-        while ((lrbalance > 0) && (count < sizeof(else_str)) && (*src != '\0'))
-        {
-          if ((src[0] == '%') && (src[1] == '>'))
-          {
-            /* This is a padding expando; copy two chars and carry on */
-            *cp++ = *src++;
-            *cp++ = *src++;
-            count += 2;
-            continue;
-          }
-
-          if (*src == '\\')
-          {
-            src++;
-            *cp++ = *src++;
-          }
-          else if ((src[0] == '%') && (src[1] == '<'))
-          {
-            lrbalance++;
-          }
-          else if (src[0] == '>')
-          {
-            lrbalance--;
-          }
-          if (lrbalance == 0)
-            break;
-          if ((lrbalance == 1) && (src[0] == '&'))
-            break;
-          *cp++ = *src++;
-          count++;
-        }
-        *cp = '\0';
-
-        if ((*src == '\0'))
-          break; /* bad format */
-
-        src++; /* move past the trailing '>' (formerly '?') */
+        pl = 1;
+        pw = 1;
       }
 
-      /* handle generic cases first */
-      if ((ch == '>') || (ch == '*'))
+      /* see if there's room to add content, else ignore */
+      if (((col < cols) && (wlen < buflen)) || soft)
       {
-        /* %>X: right justify to EOL, left takes precedence
-         * %*X: right justify to EOL, right takes precedence */
-        int soft = ch == '*';
-        int pl, pw;
-        pl = mutt_mb_charlen(src, &pw);
-        if (pl <= 0)
-        {
-          pl = 1;
-          pw = 1;
-        }
+        int pad;
 
-        /* see if there's room to add content, else ignore */
-        if (((col < cols) && (wlen < buflen)) || soft)
-        {
-          int pad;
-
-          /* get contents after padding */
-          mutt_expando_format(tmp, sizeof(tmp), 0, cols, src + pl, callback, data, flags);
-          len = mutt_str_len(tmp);
-          wid = mutt_strwidth(tmp);
+        /* get contents after padding */
+        mutt_expando_format(tmp, sizeof(tmp), 0, cols, src + pl, callback, data, flags);
+        len = mutt_str_len(tmp);
+        wid = mutt_strwidth(tmp);
 
-          pad = (cols - col - wid) / pw;
-          if (pad >= 0)
-          {
-            /* try to consume as many columns as we can, if we don't have
-             * memory for that, use as much memory as possible */
-            if (wlen + (pad * pl) + len > buflen)
-              pad = (buflen > (wlen + len)) ? ((buflen - wlen - len) / pl) : 0;
-            else
-            {
-              /* Add pre-spacing to make multi-column pad characters and
-               * the contents after padding line up */
-              while (((col + (pad * pw) + wid) < cols) && ((wlen + (pad * pl) + len) < buflen))
-              {
-                *wptr++ = ' ';
-                wlen++;
-                col++;
-              }
-            }
-            while (pad-- > 0)
-            {
-              memcpy(wptr, src, pl);
-              wptr += pl;
-              wlen += pl;
-              col += pw;
-            }
-          }
-          else if (soft)
+        pad = (cols - col - wid) / pw;
+        if (pad >= 0)
+        {
+          /* try to consume as many columns as we can, if we don't have
+           * memory for that, use as much memory as possible */
+          if (wlen + (pad * pl) + len > buflen)
+            pad = (buflen > (wlen + len)) ? ((buflen - wlen - len) / pl) : 0;
+          else
           {
-            int offset = ((flags & MUTT_FORMAT_ARROWCURSOR) && c_arrow_cursor) ?
-                             mutt_strwidth(c_arrow_string) + 1 :
-                             0;
-            int avail_cols = (cols > offset) ? (cols - offset) : 0;
-            /* \0-terminate buf for length computation in mutt_wstr_trunc() */
-            *wptr = '\0';
-            /* make sure right part is at most as wide as display */
-            len = mutt_wstr_trunc(tmp, buflen, avail_cols, &wid);
-            /* truncate left so that right part fits completely in */
-            wlen = mutt_wstr_trunc(buf, buflen - len, avail_cols - wid, &col);
-            wptr = buf + wlen;
-            /* Multi-column characters may be truncated in the middle.
-             * Add spacing so the right hand side lines up. */
-            while (((col + wid) < avail_cols) && ((wlen + len) < buflen))
+            /* Add pre-spacing to make multi-column pad characters and
+             * the contents after padding line up */
+            while (((col + (pad * pw) + wid) < cols) && ((wlen + (pad * pl) + len) < buflen))
             {
               *wptr++ = ' ';
               wlen++;
               col++;
             }
           }
-          if ((len + wlen) > buflen)
-            len = mutt_wstr_trunc(tmp, buflen - wlen, cols - col, NULL);
-          memcpy(wptr, tmp, len);
-          wptr += len;
-        }
-        break; /* skip rest of input */
-      }
-      else if (ch == '|')
-      {
-        /* pad to EOL */
-        int pl, pw;
-        pl = mutt_mb_charlen(src, &pw);
-        if (pl <= 0)
-        {
-          pl = 1;
-          pw = 1;
-        }
-
-        /* see if there's room to add content, else ignore */
-        if ((col < cols) && (wlen < buflen))
-        {
-          int c = (cols - col) / pw;
-          if ((c > 0) && ((wlen + (c * pl)) > buflen))
-            c = ((signed) (buflen - wlen)) / pl;
-          while (c > 0)
+          while (pad-- > 0)
           {
             memcpy(wptr, src, pl);
             wptr += pl;
             wlen += pl;
             col += pw;
-            c--;
           }
         }
-        break; /* skip rest of input */
-      }
-      else
-      {
-        bool to_lower = false;
-        bool no_dots = false;
-
-        while ((ch == '_') || (ch == ':'))
-        {
-          if (ch == '_')
-            to_lower = true;
-          else if (ch == ':')
-            no_dots = true;
-
-          ch = *src++;
-        }
-
-        /* use callback function to handle this case */
-        *tmp = '\0';
-        src = callback(tmp, sizeof(tmp), col, cols, ch, src, prefix, if_str,
-                       else_str, data, flags);
-
-        if (to_lower)
-          mutt_str_lower(tmp);
-        if (no_dots)
+        else if (soft)
         {
-          char *p = tmp;
-          for (; *p; p++)
-            if (*p == '.')
-              *p = '_';
+          int offset = ((flags & MUTT_FORMAT_ARROWCURSOR) && c_arrow_cursor) ?
+                           mutt_strwidth(c_arrow_string) + 1 :
+                           0;
+          int avail_cols = (cols > offset) ? (cols - offset) : 0;
+          /* \0-terminate buf for length computation in mutt_wstr_trunc() */
+          *wptr = '\0';
+          /* make sure right part is at most as wide as display */
+          len = mutt_wstr_trunc(tmp, buflen, avail_cols, &wid);
+          /* truncate left so that right part fits completely in */
+          wlen = mutt_wstr_trunc(buf, buflen - len, avail_cols - wid, &col);
+          wptr = buf + wlen;
+          /* Multi-column characters may be truncated in the middle.
+           * Add spacing so the right hand side lines up. */
+          while (((col + wid) < avail_cols) && ((wlen + len) < buflen))
+          {
+            *wptr++ = ' ';
+            wlen++;
+            col++;
+          }
         }
-
-        len = mutt_str_len(tmp);
         if ((len + wlen) > buflen)
           len = mutt_wstr_trunc(tmp, buflen - wlen, cols - col, NULL);
-
         memcpy(wptr, tmp, len);
         wptr += len;
-        wlen += len;
-        col += mutt_strwidth(tmp);
       }
+      break; /* skip rest of input */
     }
-    else if (*src == '\\')
+    else if (tok.type == EXP_PAD_EOL)
     {
-      if (!*++src)
-        break;
-      switch (*src)
+      /* pad to EOL */
+      int pl, pw;
+      pl = mutt_mb_charlen(src, &pw);
+      if (pl <= 0)
       {
-        case 'f':
-          *wptr = '\f';
-          break;
-        case 'n':
-          *wptr = '\n';
-          break;
-        case 'r':
-          *wptr = '\r';
-          break;
-        case 't':
-          *wptr = '\t';
-          break;
-        case 'v':
-          *wptr = '\v';
-          break;
-        default:
-          *wptr = *src;
-          break;
+        pl = 1;
+        pw = 1;
       }
-      src++;
-      wptr++;
-      wlen++;
-      col++;
+
+      /* see if there's room to add content, else ignore */
+      if ((col < cols) && (wlen < buflen))
+      {
+        int c = (cols - col) / pw;
+        if ((c > 0) && ((wlen + (c * pl)) > buflen))
+          c = ((signed) (buflen - wlen)) / pl;
+        while (c > 0)
+        {
+          memcpy(wptr, src, pl);
+          wptr += pl;
+          wlen += pl;
+          col += pw;
+          c--;
+        }
+      }
+      break; /* skip rest of input */
     }
     else
     {
-      int bytes, width;
-      /* in case of error, simply copy byte */
-      bytes = mutt_mb_charlen(src, &width);
-      if (bytes < 0)
+      /* use callback function to handle this case */
+      *tmp = '\0';
+      src = callback(tmp, sizeof(tmp), col, cols, tok.ch, src, tok.prefix,
+                     tok.if_str, tok.else_str, data, flags);
+      off = src - ef->src;
+
+      if (tok.to_lower)
+        mutt_str_lower(tmp);
+      if (tok.no_dots)
       {
-        bytes = 1;
-        width = 1;
-      }
-      if ((bytes > 0) && ((wlen + bytes) < buflen))
-      {
-        memcpy(wptr, src, bytes);
-        wptr += bytes;
-        src += bytes;
-        wlen += bytes;
-        col += width;
-      }
-      else
-      {
-        src += buflen - wlen;
-        wlen = buflen;
+        char *p = tmp;
+        for (; *p; p++)
+          if (*p == '.')
+            *p = '_';
       }
+
+      len = mutt_str_len(tmp);
+      if ((len + wlen) > buflen)
+        len = mutt_wstr_trunc(tmp, buflen - wlen, cols - col, NULL);
+
+      memcpy(wptr, tmp, len);
+      wptr += len;
+      wlen += len;
+      col += mutt_strwidth(tmp);
     }
   }
   *wptr = '\0';
+  ExpandoDepth--;
 }
 
 /**
@@ -1457,9 +1666,13 @@ int mutt_save_confirm(const char *s, struct stat *st)
  * @param s Number of seconds to sleep
  *
  * If the user config '$sleep_time' is larger, sleep that long instead.
+ * Without a screen, the message won't be overwritten, so don't sleep at all.
  */
 void mutt_sleep(short s)
 {
+  if (OptNoCurses)
+    return;
+
   const short c_sleep_time = cs_subset_number(NeoMutt->sub, "sleep_time");
   if (c_sleep_time > s)
     sleep(c_sleep_time);
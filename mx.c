@@ -34,7 +34,9 @@
 #include <limits.h>
 #include <locale.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -44,6 +46,7 @@
 #include "core/lib.h"
 #include "alias/lib.h"
 #include "gui/lib.h"
+#include "debug/lib.h"
 #include "mutt.h"
 #include "mx.h"
 #include "maildir/lib.h"
@@ -62,6 +65,9 @@
 #include "options.h"
 #include "protos.h"
 #include "sort.h"
+#ifdef USE_AUTOCRYPT
+#include "autocrypt/lib.h"
+#endif
 #ifdef USE_COMP_MBOX
 #include "compmbox/lib.h"
 #endif
@@ -304,9 +310,13 @@ bool mx_mbox_ac_link(struct Mailbox *m)
  */
 struct Context *mx_mbox_open(struct Mailbox *m, OpenMailboxFlags flags)
 {
+  PERF_SCOPE("mx_mbox_open");
+
   if (!m)
     return NULL;
 
+  TRACE_SCOPE("mailbox", "mx_mbox_open", mailbox_path(m));
+
   struct Context *ctx = ctx_new(m);
 
   struct EventContext ev_ctx = { ctx };
@@ -399,10 +409,24 @@ struct Context *mx_mbox_open(struct Mailbox *m, OpenMailboxFlags flags)
   m->msg_tagged = 0;
   m->vcount = 0;
 
-  enum MxOpenReturns rc = m->mx_ops->mbox_open(ctx->mailbox);
+  enum MxOpenReturns rc;
+  {
+    TRACE_SCOPE("mailbox", "mbox_open", m->mx_ops->name);
+#ifdef USE_AUTOCRYPT
+    /* Store the Autocrypt headers of all the emails in one transaction */
+    mutt_autocrypt_batch_begin();
+#endif
+    rc = m->mx_ops->mbox_open(ctx->mailbox);
+#ifdef USE_AUTOCRYPT
+    mutt_autocrypt_batch_end();
+#endif
+  }
   m->opened++;
   if (rc == MX_OPEN_OK)
+  {
+    TRACE_SCOPE("mailbox", "ctx_update", NULL);
     ctx_update(ctx);
+  }
 
   if ((rc == MX_OPEN_OK) || (rc == MX_OPEN_ABORT))
   {
@@ -1066,8 +1090,13 @@ enum MxStatus mx_mbox_sync(struct Mailbox *m)
      * at least with the new threading code.  */
     if (purge || ((m->type != MUTT_MAILDIR) && (m->type != MUTT_MH)))
     {
-      /* IMAP does this automatically after handling EXPUNGE */
-      if (m->type != MUTT_IMAP)
+      /* IMAP does this automatically after handling EXPUNGE.  MH and maildir
+       * don't reorder the emails, so their threads can be kept. */
+      if ((m->type == MUTT_MAILDIR) || (m->type == MUTT_MH))
+      {
+        mailbox_changed(m, NT_MAILBOX_EXPUNGE);
+      }
+      else if (m->type != MUTT_IMAP)
       {
         mailbox_changed(m, NT_MAILBOX_UPDATE);
         mailbox_changed(m, NT_MAILBOX_RESORT);
@@ -1155,7 +1184,14 @@ enum MxStatus mx_mbox_check(struct Mailbox *m)
   if (!m || !m->mx_ops)
     return MX_STATUS_ERROR;
 
+  TRACE_SCOPE("mailbox", "mx_mbox_check", mailbox_path(m));
+#ifdef USE_AUTOCRYPT
+  mutt_autocrypt_batch_begin();
+#endif
   enum MxStatus rc = m->mx_ops->mbox_check(m);
+#ifdef USE_AUTOCRYPT
+  mutt_autocrypt_batch_end();
+#endif
   if ((rc == MX_STATUS_NEW_MAIL) || (rc == MX_STATUS_REOPENED))
   {
     mailbox_changed(m, NT_MAILBOX_INVALID);
@@ -1182,6 +1218,8 @@ struct Message *mx_msg_open(struct Mailbox *m, int msgno)
     return NULL;
   }
 
+  email_env_load(m->emails[msgno]);
+
   struct Message *msg = mutt_mem_calloc(1, sizeof(struct Message));
   if (!m->mx_ops->msg_open(m, msg, msgno))
     FREE(&msg);
@@ -1189,6 +1227,74 @@ struct Message *mx_msg_open(struct Mailbox *m, int msgno)
   return msg;
 }
 
+/**
+ * mx_msg_prefetch - Start reading an email in the background - Wrapper for MxOps::msg_prefetch()
+ * @param m Mailbox
+ * @param e Email that will be opened soon
+ *
+ * This is only a hint, so it doesn't fail.
+ */
+void mx_msg_prefetch(struct Mailbox *m, struct Email *e)
+{
+  if (!m || !e || !m->mx_ops || !m->mx_ops->msg_prefetch)
+    return;
+
+  m->mx_ops->msg_prefetch(m, e);
+}
+
+/**
+ * mx_msg_map - Map a local message into memory
+ * @param m   Mailbox
+ * @param msg Message opened by mx_msg_open()
+ * @retval true  Message::map holds the file
+ * @retval false The message can't be mapped, read Message::fp instead
+ *
+ * The map is a read-only view of the whole file behind Message::fp, so the
+ * offsets are the same as for the stream, e.g. Email::offset.  For an mbox,
+ * that's the whole mailbox.  Searches and parsers can then scan the message
+ * without copying it through stdio.
+ *
+ * Only local mailboxes are mapped.  The map is removed by mx_msg_close().
+ */
+bool mx_msg_map(struct Mailbox *m, struct Message *msg)
+{
+  if (!m || !msg || !msg->fp || msg->write)
+    return false;
+
+  if (msg->map.data)
+    return true;
+
+  switch (m->type)
+  {
+    case MUTT_MBOX:
+    case MUTT_MMDF:
+    case MUTT_MAILDIR:
+    case MUTT_MH:
+    case MUTT_COMPRESSED:
+      break;
+    default:
+      return false;
+  }
+
+  struct stat st;
+  if ((fstat(fileno(msg->fp), &st) != 0) || !S_ISREG(st.st_mode) ||
+      (st.st_size <= 0) || ((uintmax_t) st.st_size > SIZE_MAX))
+  {
+    return false;
+  }
+
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(msg->fp), 0);
+  if (map == MAP_FAILED)
+  {
+    mutt_debug(LL_DEBUG1, "mmap: %s (errno %d)\n", strerror(errno), errno);
+    return false;
+  }
+
+  msg->map.data = map;
+  msg->map.len = st.st_size;
+  return true;
+}
+
 /**
  * mx_msg_commit - Commit a message to a folder - Wrapper for MxOps::msg_commit()
  * @param m   Mailbox
@@ -1210,6 +1316,26 @@ int mx_msg_commit(struct Mailbox *m, struct Message *msg)
   return m->mx_ops->msg_commit(m, msg);
 }
 
+/**
+ * mx_msg_append_batch - Start or finish appending several messages - Wrapper for MxOps::msg_append_batch()
+ * @param m     Mailbox
+ * @param start true at the start of the batch, false at the end
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * Mailboxes that don't support batches write each message as it's committed.
+ */
+int mx_msg_append_batch(struct Mailbox *m, bool start)
+{
+  if (!m || !m->mx_ops)
+    return -1;
+
+  if (!m->mx_ops->msg_append_batch)
+    return 0;
+
+  return m->mx_ops->msg_append_batch(m, start);
+}
+
 /**
  * mx_msg_close - Close a message
  * @param[in]  m   Mailbox
@@ -1224,6 +1350,9 @@ int mx_msg_close(struct Mailbox *m, struct Message **msg)
 
   int rc = 0;
 
+  if ((*msg)->map.data)
+    munmap((void *) (*msg)->map.data, (*msg)->map.len);
+
   if (m->mx_ops && m->mx_ops->msg_close)
     rc = m->mx_ops->msg_close(m, *msg);
 
@@ -1241,34 +1370,36 @@ int mx_msg_close(struct Mailbox *m, struct Message **msg)
 
 /**
  * mx_alloc_memory - Create storage for the emails
- * @param m Mailbox
+ * @param m        Mailbox
+ * @param req_size Number of emails the Mailbox must be able to hold
+ *
+ * The arrays grow geometrically, so adding emails one at a time costs
+ * amortised O(1) copying.  Backends that know how many emails are coming
+ * can pass the total to size the arrays in a single step.
  */
-void mx_alloc_memory(struct Mailbox *m)
+void mx_alloc_memory(struct Mailbox *m, int req_size)
 {
+  if (req_size <= m->email_max)
+    return;
+
   size_t s = MAX(sizeof(struct Email *), sizeof(int));
+  size_t new_size = MAX((size_t) m->email_max * 2, 25);
+  new_size = MAX(new_size, (size_t) req_size);
 
-  if ((m->email_max + 25) * s < m->email_max * s)
+  if ((new_size > INT_MAX) || ((new_size * s) / s != new_size))
   {
     mutt_error(_("Out of memory"));
     mutt_exit(1);
   }
 
-  m->email_max += 25;
-  if (m->emails)
-  {
-    mutt_mem_realloc(&m->emails, sizeof(struct Email *) * m->email_max);
-    mutt_mem_realloc(&m->v2r, sizeof(int) * m->email_max);
-  }
-  else
-  {
-    m->emails = mutt_mem_calloc(m->email_max, sizeof(struct Email *));
-    m->v2r = mutt_mem_calloc(m->email_max, sizeof(int));
-  }
-  for (int i = m->email_max - 25; i < m->email_max; i++)
+  mutt_mem_realloc(&m->emails, sizeof(struct Email *) * new_size);
+  mutt_mem_realloc(&m->v2r, sizeof(int) * new_size);
+  for (size_t i = m->email_max; i < new_size; i++)
   {
     m->emails[i] = NULL;
     m->v2r[i] = -1;
   }
+  m->email_max = new_size;
 }
 
 /**
@@ -1618,23 +1749,17 @@ struct Mailbox *mx_mbox_find(struct Account *a, const char *path)
   struct Url *url_p = NULL;
   struct Url *url_a = NULL;
 
-  const bool use_url = (a->type == MUTT_IMAP);
-  if (use_url)
-  {
-    url_p = url_parse(path);
-    if (!url_p)
-      goto done;
-  }
+  /* Most lookups match a realpath exactly */
+  struct Mailbox *m = account_mailbox_find(a, path);
+  if (m || (a->type != MUTT_IMAP))
+    return m;
+
+  url_p = url_parse(path);
+  if (!url_p)
+    goto done;
 
   STAILQ_FOREACH(np, &a->mailboxes, entries)
   {
-    if (!use_url)
-    {
-      if (mutt_str_equal(np->mailbox->realpath, path))
-        return np->mailbox;
-      continue;
-    }
-
     url_free(&url_a);
     url_a = url_parse(np->mailbox->realpath);
     if (!url_a)
@@ -1644,16 +1769,8 @@ struct Mailbox *mx_mbox_find(struct Account *a, const char *path)
       continue;
     if (url_p->user && !mutt_istr_equal(url_a->user, url_p->user))
       continue;
-    if (a->type == MUTT_IMAP)
-    {
-      if (imap_mxcmp(url_a->path, url_p->path) == 0)
-        break;
-    }
-    else
-    {
-      if (mutt_str_equal(url_a->path, url_p->path))
-        break;
-    }
+    if (imap_mxcmp(url_a->path, url_p->path) == 0)
+      break;
   }
 
 done:
@@ -1725,18 +1842,7 @@ struct Mailbox *mx_path_resolve(const char *path)
  */
 static struct Mailbox *mx_mbox_find_by_name_ac(struct Account *a, const char *name)
 {
-  if (!a || !name)
-    return NULL;
-
-  struct MailboxNode *np = NULL;
-
-  STAILQ_FOREACH(np, &a->mailboxes, entries)
-  {
-    if (mutt_str_equal(np->mailbox->name, name))
-      return np->mailbox;
-  }
-
-  return NULL;
+  return account_mailbox_find_name(a, name);
 }
 
 /**
@@ -1822,6 +1928,7 @@ enum MxStatus mx_mbox_check_stats(struct Mailbox *m, uint8_t flags)
   if (!m)
     return MX_STATUS_ERROR;
 
+  TRACE_SCOPE("mailbox", "mx_mbox_check_stats", mailbox_path(m));
   return m->mx_ops->mbox_check_stats(m, flags);
 }
 
@@ -49,10 +49,13 @@ enum MxStatus   mx_mbox_check_stats(struct Mailbox *m, uint8_t flags);
 enum MxStatus   mx_mbox_close      (struct Context **ptr);
 struct Context *mx_mbox_open       (struct Mailbox *m, OpenMailboxFlags flags);
 enum MxStatus   mx_mbox_sync       (struct Mailbox *m);
+int             mx_msg_append_batch(struct Mailbox *m, bool start);
 int             mx_msg_close       (struct Mailbox *m, struct Message **msg);
 int             mx_msg_commit      (struct Mailbox *m, struct Message *msg);
 struct Message *mx_msg_open_new    (struct Mailbox *m, const struct Email *e, MsgOpenFlags flags);
 struct Message *mx_msg_open        (struct Mailbox *m, int msgno);
+void            mx_msg_prefetch    (struct Mailbox *m, struct Email *e);
+bool            mx_msg_map         (struct Mailbox *m, struct Message *msg);
 int             mx_msg_padding_size(struct Mailbox *m);
 int             mx_save_hcache     (struct Mailbox *m, struct Email *e);
 int             mx_path_canon      (char *buf, size_t buflen, const char *folder, enum MailboxType *type);
@@ -73,7 +76,7 @@ bool            mx_ac_add      (struct Account *a, struct Mailbox *m);
 int             mx_ac_remove   (struct Mailbox *m);
 
 int                 mx_access           (const char *path, int flags);
-void                mx_alloc_memory     (struct Mailbox *m);
+void                mx_alloc_memory     (struct Mailbox *m, int req_size);
 int                 mx_path_is_empty    (const char *path);
 void                mx_fastclose_mailbox(struct Mailbox *m);
 const struct MxOps *mx_get_ops          (enum MailboxType type);
@@ -47,6 +47,9 @@ const struct Mapping SortKeyMethods[] = {
 
 static struct ConfigDef NcryptVars[] = {
   // clang-format off
+  { "crypt_cache_size", DT_LONG|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "Memory to use for caching decrypted messages"
+  },
   { "crypt_confirm_hook", DT_BOOL, true, 0, NULL,
     "Prompt the user to confirm keys before use"
   },
@@ -99,6 +99,8 @@ void crypt_forget_passphrase(void)
   if (WithCrypto & APPLICATION_SMIME)
     crypt_smime_void_passphrase();
 
+  crypt_cache_flush();
+
   if (WithCrypto)
   {
     /* L10N: Due to the implementation details (e.g. some passwords are managed
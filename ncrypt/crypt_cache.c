@@ -0,0 +1,277 @@
+/**
+ * @file
+ * Cache of decrypted message parts
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page crypt_crypt_cache Cache of decrypted message parts
+ *
+ * Decrypting a message and verifying its signatures is slow, and it happens
+ * every time the message is displayed, or searched with `~b`.  If
+ * `$crypt_cache_size` is set, the output of the encrypted handlers is kept in
+ * memory for the rest of the session.
+ *
+ * The cache is keyed by a digest of the raw (encrypted) part and the way it
+ * is being displayed, so it doesn't matter which Mailbox, or which copy of
+ * the Email it comes from.
+ *
+ * The plaintext is kept in locked pages, so it will never be swapped out.
+ * If the pages can't be locked, the part isn't cached.  The cache is wiped if
+ * the config changes, or when the user forgets their passphrases.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "lib.h"
+#include "state.h"
+
+/**
+ * struct CryptCacheEntry - A decrypted part
+ */
+struct CryptCacheEntry
+{
+  char key[33];         ///< Digest of the part and how it's displayed
+  void *data;           ///< Handler output, in locked pages
+  size_t len;           ///< Length of the output
+  size_t size;          ///< Size of the locked pages
+  bool goodsig : 1;     ///< Body::goodsig after the handler ran
+  bool warnsig : 1;     ///< Body::warnsig after the handler ran
+  bool badsig : 1;      ///< Body::badsig after the handler ran
+#ifdef USE_AUTOCRYPT
+  bool is_autocrypt : 1; ///< Body::is_autocrypt after the handler ran
+#endif
+  TAILQ_ENTRY(CryptCacheEntry) entries; ///< Linked list, most recently used first
+};
+TAILQ_HEAD(CryptCacheList, CryptCacheEntry);
+
+static struct CryptCacheList CryptCache = TAILQ_HEAD_INITIALIZER(CryptCache);
+static size_t CryptCacheBytes = 0;     ///< Total size of the cached pages
+static bool CryptCacheObserved = false; ///< Is the config observer registered?
+
+/**
+ * cache_entry_free - Wipe and free a cache entry
+ * @param cce Cache entry
+ */
+static void cache_entry_free(struct CryptCacheEntry *cce)
+{
+  TAILQ_REMOVE(&CryptCache, cce, entries);
+  CryptCacheBytes -= cce->size;
+
+  memset(cce->data, 0, cce->len);
+  munlock(cce->data, cce->size);
+  munmap(cce->data, cce->size);
+  FREE(&cce);
+}
+
+/**
+ * crypt_cache_flush - Wipe all the decrypted parts
+ */
+void crypt_cache_flush(void)
+{
+  struct CryptCacheEntry *cce = NULL;
+  struct CryptCacheEntry *tmp = NULL;
+  TAILQ_FOREACH_SAFE(cce, &CryptCache, entries, tmp)
+  {
+    cache_entry_free(cce);
+  }
+}
+
+/**
+ * crypt_cache_config_observer - Listen for config changes - Implements ::observer_t
+ *
+ * Almost any config change can alter the way a part is displayed.
+ */
+static int crypt_cache_config_observer(struct NotifyCallback *nc)
+{
+  if ((nc->event_type != NT_CONFIG) || !nc->event_data)
+    return -1;
+
+  crypt_cache_flush();
+  return 0;
+}
+
+/**
+ * crypt_cache_key - Create the cache key for an encrypted part
+ * @param b   Body of the encrypted part
+ * @param s   State of the handler
+ * @param key Buffer for the key
+ * @retval true  The part can be cached
+ * @retval false The cache is disabled, or the part can't be read
+ */
+bool crypt_cache_key(struct Body *b, struct State *s, struct Buffer *key)
+{
+  const long c_crypt_cache_size = cs_subset_long(NeoMutt->sub, "crypt_cache_size");
+  if ((c_crypt_cache_size <= 0) || !b || !s || !s->fp_in || !key)
+    return false;
+
+  if (fseeko(s->fp_in, b->offset, SEEK_SET) != 0)
+    return false;
+
+  struct Md5Ctx ctx;
+  mutt_md5_init_ctx(&ctx);
+
+  char buf[1024];
+  snprintf(buf, sizeof(buf), "%d/%s|%d|%d|%s|", b->type, NONULL(b->subtype),
+           s->flags, s->wraplen, NONULL(s->prefix));
+  mutt_md5_process(buf, &ctx);
+
+  LOFF_T remaining = b->length;
+  while (remaining > 0)
+  {
+    const size_t chunk = MIN(sizeof(buf), (size_t) remaining);
+    if (fread(buf, 1, chunk, s->fp_in) != chunk)
+      return false;
+    mutt_md5_process_bytes(buf, chunk, &ctx);
+    remaining -= chunk;
+  }
+
+  unsigned char digest[16];
+  mutt_md5_finish_ctx(&ctx, digest);
+  mutt_buffer_alloc(key, 33);
+  mutt_md5_toascii(digest, key->data);
+  mutt_buffer_fix_dptr(key);
+  return true;
+}
+
+/**
+ * crypt_cache_fetch - Write out a cached part
+ * @param key Cache key, from crypt_cache_key()
+ * @param b   Body of the encrypted part
+ * @param s   State of the handler
+ * @retval true The part was in the cache
+ *
+ * The signature flags that the handler would have set are restored on the
+ * Body.
+ */
+bool crypt_cache_fetch(const char *key, struct Body *b, struct State *s)
+{
+  if (!key || !b || !s)
+    return false;
+
+  struct CryptCacheEntry *cce = NULL;
+  TAILQ_FOREACH(cce, &CryptCache, entries)
+  {
+    if (mutt_str_equal(cce->key, key))
+      break;
+  }
+
+  if (!cce)
+    return false;
+
+  if (fwrite(cce->data, 1, cce->len, s->fp_out) != cce->len)
+    return false;
+
+  b->goodsig |= cce->goodsig;
+  b->warnsig |= cce->warnsig;
+  b->badsig |= cce->badsig;
+#ifdef USE_AUTOCRYPT
+  b->is_autocrypt |= cce->is_autocrypt;
+#endif
+
+  TAILQ_REMOVE(&CryptCache, cce, entries);
+  TAILQ_INSERT_HEAD(&CryptCache, cce, entries);
+  mutt_debug(LL_DEBUG2, "using cached part %s\n", key);
+  return true;
+}
+
+/**
+ * crypt_cache_store - Save a decrypted part
+ * @param key Cache key, from crypt_cache_key()
+ * @param b   Body of the encrypted part, after the handler has run
+ * @param fp  File containing the handler output
+ * @param len Length of the output
+ *
+ * The least recently used parts are dropped to make room.
+ */
+void crypt_cache_store(const char *key, struct Body *b, FILE *fp, size_t len)
+{
+  if (!key || !b || !fp || (len == 0))
+    return;
+
+  const long c_crypt_cache_size = cs_subset_long(NeoMutt->sub, "crypt_cache_size");
+  const long page = sysconf(_SC_PAGESIZE);
+  const size_t size = ((len + page - 1) / page) * page;
+  if ((c_crypt_cache_size <= 0) || (size > (size_t) c_crypt_cache_size))
+    return;
+
+  void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED)
+    return;
+
+  if (mlock(data, size) != 0)
+  {
+    mutt_debug(LL_DEBUG1, "can't lock %zu bytes, not caching part\n", size);
+    munmap(data, size);
+    return;
+  }
+#ifdef MADV_DONTDUMP
+  madvise(data, size, MADV_DONTDUMP);
+#endif
+
+  if ((fseeko(fp, 0, SEEK_SET) != 0) || (fread(data, 1, len, fp) != len))
+  {
+    memset(data, 0, len);
+    munlock(data, size);
+    munmap(data, size);
+    return;
+  }
+
+  while (!TAILQ_EMPTY(&CryptCache) && ((CryptCacheBytes + size) > (size_t) c_crypt_cache_size))
+    cache_entry_free(TAILQ_LAST(&CryptCache, CryptCacheList));
+
+  if (!CryptCacheObserved)
+  {
+    notify_observer_add(NeoMutt->notify, NT_CONFIG, crypt_cache_config_observer, NULL);
+    CryptCacheObserved = true;
+  }
+
+  struct CryptCacheEntry *cce = mutt_mem_calloc(1, sizeof(*cce));
+  mutt_str_copy(cce->key, key, sizeof(cce->key));
+  cce->data = data;
+  cce->len = len;
+  cce->size = size;
+  cce->goodsig = b->goodsig;
+  cce->warnsig = b->warnsig;
+  cce->badsig = b->badsig;
+#ifdef USE_AUTOCRYPT
+  cce->is_autocrypt = b->is_autocrypt;
+#endif
+  TAILQ_INSERT_HEAD(&CryptCache, cce, entries);
+  CryptCacheBytes += size;
+}
+
+/**
+ * crypt_cache_cleanup - Wipe the cache and stop observing the config
+ */
+void crypt_cache_cleanup(void)
+{
+  crypt_cache_flush();
+  if (CryptCacheObserved && NeoMutt)
+    notify_observer_remove(NeoMutt->notify, crypt_cache_config_observer, NULL);
+  CryptCacheObserved = false;
+}
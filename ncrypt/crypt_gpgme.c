@@ -62,6 +62,7 @@
 #include "handler.h"
 #include "hook.h"
 #include "mutt_attach.h"
+#include "mutt_globals.h"
 #include "mutt_logging.h"
 #include "muttlib.h"
 #include "options.h"
@@ -658,75 +659,186 @@ static bool have_gpg_version(const char *version)
 }
 #endif
 
+/**
+ * struct GpgmeStream - A GPGME data object backed by a file
+ *
+ * The data is passed straight between GPGME and the file, so it never has to
+ * be copied into memory, or into another temporary file.
+ */
+struct GpgmeStream
+{
+  FILE *fp;   ///< File to read from, or write to
+  bool close; ///< Close the file when the data object is released
+  bool crlf;  ///< Add CRs when reading, remove them when writing
+  bool hadcr; ///< The last character read was a CR
+};
+
+/**
+ * stream_read - Read from a file - Implements gpgme_data_read_cb_t
+ *
+ * If GpgmeStream::crlf is set, bare LFs are converted to CR-LF.
+ */
+static ssize_t stream_read(void *handle, void *buffer, size_t size)
+{
+  struct GpgmeStream *gs = handle;
+  if (!gs->crlf)
+  {
+    size_t len = fread(buffer, 1, size, gs->fp);
+    if ((len == 0) && ferror(gs->fp))
+      return -1;
+    return len;
+  }
+
+  unsigned char *buf = buffer;
+  size_t len = 0;
+  int c;
+  while ((len < size) && ((c = getc(gs->fp)) != EOF))
+  {
+    if ((c == '\n') && !gs->hadcr)
+    {
+      /* put the LF back, so it's read after the CR we're inserting */
+      ungetc(c, gs->fp);
+      c = '\r';
+    }
+    gs->hadcr = (c == '\r');
+    buf[len++] = c;
+  }
+
+  if ((len == 0) && ferror(gs->fp))
+    return -1;
+  return len;
+}
+
+/**
+ * stream_write - Write to a file - Implements gpgme_data_write_cb_t
+ *
+ * If GpgmeStream::crlf is set, CRs are removed.
+ */
+static ssize_t stream_write(void *handle, const void *buffer, size_t size)
+{
+  struct GpgmeStream *gs = handle;
+  if (!gs->crlf)
+  {
+    if (fwrite(buffer, 1, size, gs->fp) != size)
+      return -1;
+    return size;
+  }
+
+  /* fixme: we are not really converting CRLF to LF but just
+   * skipping CR. Doing it correctly needs a more complex logic */
+  const char *p = buffer;
+  const char *end = p + size;
+  while (p < end)
+  {
+    const char *cr = memchr(p, '\r', end - p);
+    const size_t len = (cr ? cr : end) - p;
+    if (fwrite(p, 1, len, gs->fp) != len)
+      return -1;
+    p += len + (cr ? 1 : 0);
+  }
+  return size;
+}
+
+/**
+ * stream_seek - Seek in a file - Implements gpgme_data_seek_cb_t
+ *
+ * A converted stream can only be rewound.
+ */
+static off_t stream_seek(void *handle, off_t offset, int whence)
+{
+  struct GpgmeStream *gs = handle;
+  if (gs->crlf && ((offset != 0) || (whence != SEEK_SET)))
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (fseeko(gs->fp, offset, whence) != 0)
+    return -1;
+  gs->hadcr = false;
+  return ftello(gs->fp);
+}
+
+/**
+ * stream_release - Free a GpgmeStream - Implements gpgme_data_release_cb_t
+ */
+static void stream_release(void *handle)
+{
+  struct GpgmeStream *gs = handle;
+  if (gs->close)
+    mutt_file_fclose(&gs->fp);
+  FREE(&gs);
+}
+
+/// Callbacks for a GPGME data object backed by a file
+static struct gpgme_data_cbs StreamCallbacks = {
+  stream_read,
+  stream_write,
+  stream_seek,
+  stream_release,
+};
+
+/**
+ * stream_to_data_object - Create a GPGME data object backed by a file
+ * @param fp    File to read from, or write to
+ * @param close If true, the file is closed when the data object is released
+ * @param crlf  If true, lines are converted to CR-LF when reading, and CRs
+ *              are stripped when writing
+ * @retval ptr  Newly created GPGME data object
+ * @retval NULL Error
+ *
+ * If close is true, the data object owns the file, even on error.
+ */
+static gpgme_data_t stream_to_data_object(FILE *fp, bool close, bool crlf)
+{
+  gpgme_data_t data = NULL;
+  struct GpgmeStream *gs = mutt_mem_calloc(1, sizeof(*gs));
+  gs->fp = fp;
+  gs->close = close;
+  gs->crlf = crlf;
+
+  gpgme_error_t err = gpgme_data_new_from_cbs(&data, &StreamCallbacks, gs);
+  if (err != 0)
+  {
+    mutt_error(_("error allocating data object: %s"), gpgme_strerror(err));
+    stream_release(gs);
+    return NULL;
+  }
+
+  return data;
+}
+
 /**
  * body_to_data_object - Create GPGME object from the mail body
  * @param a       Body to use
  * @param convert If true, lines are converted to CR-LF if required
  * @retval ptr Newly created GPGME data object
+ *
+ * The body is encoded once, into an anonymous temporary file, which GPGME
+ * reads from directly.
  */
 static gpgme_data_t body_to_data_object(struct Body *a, bool convert)
 {
-  int err = 0;
-  gpgme_data_t data = NULL;
-
-  struct Buffer *tempfile = mutt_buffer_pool_get();
-  mutt_buffer_mktemp(tempfile);
-  FILE *fp_tmp = mutt_file_fopen(mutt_buffer_string(tempfile), "w+");
+  FILE *fp_tmp = mutt_file_mkstemp();
   if (!fp_tmp)
   {
-    mutt_perror(mutt_buffer_string(tempfile));
-    goto cleanup;
+    mutt_perror(_("Can't create temporary file"));
+    return NULL;
   }
 
   mutt_write_mime_header(a, fp_tmp, NeoMutt->sub);
   fputc('\n', fp_tmp);
   mutt_write_mime_body(a, fp_tmp, NeoMutt->sub);
 
-  if (convert)
-  {
-    int c, hadcr = 0;
-    unsigned char buf[1];
-
-    data = create_gpgme_data();
-    rewind(fp_tmp);
-    while ((c = fgetc(fp_tmp)) != EOF)
-    {
-      if (c == '\r')
-        hadcr = 1;
-      else
-      {
-        if ((c == '\n') && !hadcr)
-        {
-          buf[0] = '\r';
-          gpgme_data_write(data, buf, 1);
-        }
-
-        hadcr = 0;
-      }
-      /* FIXME: This is quite suboptimal */
-      buf[0] = c;
-      gpgme_data_write(data, buf, 1);
-    }
-    mutt_file_fclose(&fp_tmp);
-    gpgme_data_seek(data, 0, SEEK_SET);
-  }
-  else
+  if ((fflush(fp_tmp) != 0) || ferror(fp_tmp))
   {
+    mutt_perror(_("[tempfile]"));
     mutt_file_fclose(&fp_tmp);
-    err = gpgme_data_new_from_file(&data, mutt_buffer_string(tempfile), 1);
-    if (err != 0)
-    {
-      mutt_error(_("error allocating data object: %s"), gpgme_strerror(err));
-      gpgme_data_release(data);
-      data = NULL;
-      /* fall through to unlink the tempfile */
-    }
+    return NULL;
   }
-  unlink(mutt_buffer_string(tempfile));
+  rewind(fp_tmp);
 
-cleanup:
-  mutt_buffer_pool_release(&tempfile);
-  return data;
+  return stream_to_data_object(fp_tmp, true, convert);
 }
 
 /**
@@ -750,49 +862,6 @@ static gpgme_data_t file_to_data_object(FILE *fp, long offset, size_t length)
   return data;
 }
 
-/**
- * data_object_to_stream - Write a GPGME data object to a file
- * @param data GPGME data object
- * @param fp   File to write to
- * @retval  0 Success
- * @retval -1 Error
- */
-static int data_object_to_stream(gpgme_data_t data, FILE *fp)
-{
-  char buf[4096];
-  ssize_t nread;
-
-  int err = ((gpgme_data_seek(data, 0, SEEK_SET) == -1) ? gpgme_error_from_errno(errno) : 0);
-  if (err != 0)
-  {
-    mutt_error(_("error rewinding data object: %s"), gpgme_strerror(err));
-    return -1;
-  }
-
-  while ((nread = gpgme_data_read(data, buf, sizeof(buf))) > 0)
-  {
-    /* fixme: we are not really converting CRLF to LF but just
-     * skipping CR. Doing it correctly needs a more complex logic */
-    for (char *p = buf; nread; p++, nread--)
-    {
-      if (*p != '\r')
-        putc(*p, fp);
-    }
-
-    if (ferror(fp))
-    {
-      mutt_perror(_("[tempfile]"));
-      return -1;
-    }
-  }
-  if (nread == -1)
-  {
-    mutt_error(_("error reading data object: %s"), strerror(errno));
-    return -1;
-  }
-  return 0;
-}
-
 /**
  * data_object_to_tempfile - Copy a data object to a temporary file
  * @param[in]  data   GPGME data object
@@ -1118,6 +1187,7 @@ static char *encrypt_gpgme_object(gpgme_data_t plaintext, char *keylist, bool us
   gpgme_ctx_t ctx = NULL;
   gpgme_data_t ciphertext = NULL;
   char *outfile = NULL;
+  struct Buffer *tempfile = NULL;
 
 #if GPGME_VERSION_NUMBER >= 0x010b00 /* GPGME >= 1.11.0 */
   struct Buffer *recpstring = mutt_buffer_pool_get();
@@ -1137,7 +1207,18 @@ static char *encrypt_gpgme_object(gpgme_data_t plaintext, char *keylist, bool us
   if (!use_smime)
     gpgme_set_armor(ctx, 1);
 
-  ciphertext = create_gpgme_data();
+  /* GPGME writes the ciphertext straight into the file we return */
+  tempfile = mutt_buffer_pool_get();
+  mutt_buffer_mktemp(tempfile);
+  FILE *fp_out = mutt_file_fopen(mutt_buffer_string(tempfile), "w+");
+  if (!fp_out)
+  {
+    mutt_perror(_("Can't create temporary file"));
+    goto cleanup;
+  }
+  ciphertext = stream_to_data_object(fp_out, true, false);
+  if (!ciphertext)
+    goto cleanup;
 
   if (combined_signed)
   {
@@ -1176,7 +1257,13 @@ static char *encrypt_gpgme_object(gpgme_data_t plaintext, char *keylist, bool us
     goto cleanup;
   }
 
-  outfile = data_object_to_tempfile(ciphertext, NULL);
+  if (fflush(fp_out) != 0)
+  {
+    mutt_perror(mutt_buffer_string(tempfile));
+    goto cleanup;
+  }
+
+  outfile = mutt_buffer_strdup(tempfile);
 
 cleanup:
 #if (GPGME_VERSION_NUMBER >= 0x010b00) /* GPGME >= 1.11.0 */
@@ -1185,7 +1272,11 @@ cleanup:
   recipient_set_free(&rset);
 #endif
   gpgme_release(ctx);
+  /* this closes the file */
   gpgme_data_release(ciphertext);
+  if (!outfile && tempfile && !mutt_buffer_is_empty(tempfile))
+    unlink(mutt_buffer_string(tempfile));
+  mutt_buffer_pool_release(&tempfile);
   return outfile;
 }
 
@@ -1915,13 +2006,20 @@ static int verify_one(struct Body *sigbdy, struct State *s, const char *tempfile
   if (is_smime)
     gpgme_data_set_encoding(signature, GPGME_DATA_ENCODING_BASE64);
 
-  int err = gpgme_data_new_from_file(&message, tempfile, 1);
-  if (err != 0)
+  FILE *fp_msg = mutt_file_fopen(tempfile, "r");
+  if (!fp_msg)
+  {
+    gpgme_data_release(signature);
+    mutt_perror(tempfile);
+    return -1;
+  }
+  message = stream_to_data_object(fp_msg, true, false);
+  if (!message)
   {
     gpgme_data_release(signature);
-    mutt_error(_("error allocating data object: %s"), gpgme_strerror(err));
     return -1;
   }
+  int err = 0;
   ctx = create_gpgme_context(is_smime);
 
   /* Note: We don't need a current time output because GPGME avoids
@@ -2067,6 +2165,7 @@ static struct Body *decrypt_part(struct Body *a, struct State *s, FILE *fp_out,
   if (r_is_signed)
     *r_is_signed = 0;
 
+  const LOFF_T start = ftello(fp_out);
   gpgme_ctx_t ctx = NULL;
 restart:
   ctx = create_gpgme_context(is_smime);
@@ -2077,7 +2176,11 @@ restart:
   ciphertext = file_to_data_object(s->fp_in, a->offset, a->length);
   if (!ciphertext)
     goto cleanup;
-  plaintext = create_gpgme_data();
+  /* GPGME writes straight to fp_out, changing CRLF to LF, otherwise
+   * read_mime_header has a hard time parsing the message.  */
+  plaintext = stream_to_data_object(fp_out, false, true);
+  if (!plaintext)
+    goto cleanup;
 
   /* Do the decryption or the verification in case of the S/MIME hack. */
   if ((!is_smime) || maybe_signed)
@@ -2121,6 +2224,13 @@ restart:
         maybe_signed = true;
         gpgme_data_release(plaintext);
         plaintext = NULL;
+        /* throw away anything written by the failed attempt */
+        fflush(fp_out);
+        if ((ftruncate(fileno(fp_out), start) != 0) ||
+            (fseeko(fp_out, start, SEEK_SET) != 0))
+        {
+          goto cleanup;
+        }
         /* gpgsm ends the session after an error; restart it */
         gpgme_release(ctx);
         ctx = NULL;
@@ -2140,14 +2250,13 @@ restart:
   }
   redraw_if_needed(ctx);
 
-  /* Read the output from GPGME, and make sure to change CRLF to LF,
-   * otherwise read_mime_header has a hard time parsing the message.  */
-  if (data_object_to_stream(plaintext, fp_out))
+  gpgme_data_release(plaintext);
+  plaintext = NULL;
+  if (ferror(fp_out))
   {
+    mutt_perror(_("[tempfile]"));
     goto cleanup;
   }
-  gpgme_data_release(plaintext);
-  plaintext = NULL;
 
   if (sig_stat)
   {
@@ -3364,15 +3473,17 @@ static char *list_to_pattern(struct ListHead *list)
 
 /**
  * get_candidates - Get a list of keys which are candidates for the selection
- * @param hints  List of strings to match
- * @param app    Application type, e.g. #APPLICATION_PGP
- * @param secret If true, only match secret keys
+ * @param[in]  hints  List of strings to match
+ * @param[in]  app    Application type, e.g. #APPLICATION_PGP
+ * @param[in]  secret If true, only match secret keys
+ * @param[out] error  Set to true if the keys couldn't be listed (optional)
  * @retval ptr  Key List
- * @retval NULL Error
+ * @retval NULL Error, or no matches
  *
  * Select by looking at the HINTS list.
  */
-static struct CryptKeyInfo *get_candidates(struct ListHead *hints, SecurityFlags app, int secret)
+static struct CryptKeyInfo *get_candidates(struct ListHead *hints, SecurityFlags app,
+                                           int secret, bool *error)
 {
   struct CryptKeyInfo *db = NULL, *k = NULL, **kend = NULL;
   gpgme_error_t err;
@@ -3381,6 +3492,9 @@ static struct CryptKeyInfo *get_candidates(struct ListHead *hints, SecurityFlags
   int idx;
   gpgme_user_id_t uid = NULL;
 
+  if (error)
+    *error = false;
+
   char *pattern = list_to_pattern(hints);
   if (!pattern)
     return NULL;
@@ -3419,6 +3533,8 @@ static struct CryptKeyInfo *get_candidates(struct ListHead *hints, SecurityFlags
     if (err != 0)
     {
       mutt_error(_("gpgme_op_keylist_start failed: %s"), gpgme_strerror(err));
+      if (error)
+        *error = true;
       gpgme_release(ctx);
       FREE(&pattern);
       return NULL;
@@ -3457,7 +3573,11 @@ static struct CryptKeyInfo *get_candidates(struct ListHead *hints, SecurityFlags
       gpgme_key_unref(key);
     }
     if (gpg_err_code(err) != GPG_ERR_EOF)
+    {
       mutt_error(_("gpgme_op_keylist_next failed: %s"), gpgme_strerror(err));
+      if (error)
+        *error = true;
+    }
     gpgme_op_keylist_end(ctx);
   no_pgphints:;
   }
@@ -3470,6 +3590,8 @@ static struct CryptKeyInfo *get_candidates(struct ListHead *hints, SecurityFlags
     if (err != 0)
     {
       mutt_error(_("gpgme_op_keylist_start failed: %s"), gpgme_strerror(err));
+      if (error)
+        *error = true;
       gpgme_release(ctx);
       FREE(&pattern);
       return NULL;
@@ -3499,7 +3621,11 @@ static struct CryptKeyInfo *get_candidates(struct ListHead *hints, SecurityFlags
       gpgme_key_unref(key);
     }
     if (gpg_err_code(err) != GPG_ERR_EOF)
+    {
       mutt_error(_("gpgme_op_keylist_next failed: %s"), gpgme_strerror(err));
+      if (error)
+        *error = true;
+    }
     gpgme_op_keylist_end(ctx);
   }
 
@@ -3533,17 +3659,190 @@ static void crypt_add_string_to_hints(const char *str, struct ListHead *hints)
 }
 
 /**
- * crypt_getkeybyaddr - Find a key by email address
+ * struct CryptKeyCache - The result of looking up an address's key
+ */
+struct CryptKeyCache
+{
+  struct CryptKeyInfo *key; ///< Key that was chosen, NULL if there was no match
+};
+
+/// Keys found for addresses, see crypt_getkeybyaddr()
+static struct HashTable *KeyCache = NULL;
+/// State of the keyrings when KeyCache was filled
+static char *KeyCacheStamp = NULL;
+
+/**
+ * key_cache_hash_free - Free a cached key lookup - Implements ::hash_hdata_free_t
+ */
+static void key_cache_hash_free(int type, void *obj, intptr_t data)
+{
+  struct CryptKeyCache *kc = obj;
+  crypt_key_free(&kc->key);
+  FREE(&kc);
+}
+
+/**
+ * key_cache_stamp - Describe the state of the keyrings
+ * @param buf Buffer for the result
+ *
+ * If a key is added, or its trust changes, one of these files will change.
+ */
+static void key_cache_stamp(struct Buffer *buf)
+{
+  static const char *const files[] = { "pubring.kbx", "pubring.gpg", "trustdb.gpg" };
+
+  struct Buffer *dir = mutt_buffer_pool_get();
+  struct Buffer *path = mutt_buffer_pool_get();
+
+  gpgme_engine_info_t info = NULL;
+  if (gpgme_get_engine_info(&info) == 0)
+  {
+    for (; info; info = info->next)
+    {
+      if ((info->protocol == GPGME_PROTOCOL_OpenPGP) && info->home_dir)
+        mutt_buffer_strcpy(dir, info->home_dir);
+    }
+  }
+  if (mutt_buffer_is_empty(dir))
+  {
+    const char *gnupghome = mutt_str_getenv("GNUPGHOME");
+    if (gnupghome)
+      mutt_buffer_strcpy(dir, gnupghome);
+    else
+      mutt_buffer_printf(dir, "%s/.gnupg", NONULL(HomeDir));
+  }
+
+  mutt_buffer_reset(buf);
+  for (size_t i = 0; i < mutt_array_size(files); i++)
+  {
+    struct stat st = { 0 };
+    mutt_buffer_printf(path, "%s/%s", mutt_buffer_string(dir), files[i]);
+    if (stat(mutt_buffer_string(path), &st) == 0)
+    {
+      mutt_buffer_add_printf(buf, "%lu.%ld.%ld;", (unsigned long) st.st_ino,
+                             (long) st.st_mtime, (long) st.st_size);
+    }
+    else
+    {
+      mutt_buffer_addstr(buf, "-;");
+    }
+  }
+
+  mutt_buffer_pool_release(&dir);
+  mutt_buffer_pool_release(&path);
+}
+
+/**
+ * key_cache_check - Empty the key cache if the keyrings have changed
+ */
+static void key_cache_check(void)
+{
+  struct Buffer *stamp = mutt_buffer_pool_get();
+  key_cache_stamp(stamp);
+
+  if (!KeyCache || !mutt_str_equal(mutt_buffer_string(stamp), KeyCacheStamp))
+  {
+    mutt_hash_free(&KeyCache);
+    KeyCache = mutt_hash_new(64, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(KeyCache, key_cache_hash_free, 0);
+    mutt_str_replace(&KeyCacheStamp, mutt_buffer_string(stamp));
+  }
+
+  mutt_buffer_pool_release(&stamp);
+}
+
+/**
+ * key_cache_key - Generate the key cache's key for a lookup
+ * @param buf         Buffer for the key
+ * @param a           Address to match
+ * @param abilities   Abilities to match, see #KeyFlags
+ * @param app         Application type, e.g. #APPLICATION_PGP
+ * @param oppenc_mode If true, use opportunistic encryption
+ * @retval true The lookup can be cached
+ */
+static bool key_cache_key(struct Buffer *buf, struct Address *a, KeyFlags abilities,
+                          unsigned int app, bool oppenc_mode)
+{
+#ifdef USE_AUTOCRYPT
+  /* Autocrypt has its own keyring */
+  if (OptAutocryptGpgme)
+    return false;
+#endif
+
+  if (!KeyCache || !a || !a->mailbox)
+    return false;
+
+  mutt_buffer_printf(buf, "%u/%x/%d/%s/%s", app, (unsigned int) abilities,
+                     oppenc_mode, a->mailbox, NONULL(a->personal));
+  return true;
+}
+
+/**
+ * key_cache_free - Empty the key cache
+ */
+static void key_cache_free(void)
+{
+  mutt_hash_free(&KeyCache);
+  FREE(&KeyCacheStamp);
+}
+
+/**
+ * filter_candidates - Select the candidates that match some hints
+ * @param candidates Keys found by get_candidates()
+ * @param hints      Strings to match
+ * @retval ptr Matching keys
+ *
+ * This gives the same keys as a separate get_candidates() for the hints.
+ * GnuPG matches a plain string anywhere in a user ID, ignoring case, and
+ * lists all of the user IDs of the key.
+ */
+static struct CryptKeyInfo *filter_candidates(struct CryptKeyInfo *candidates,
+                                              struct ListHead *hints)
+{
+  struct CryptKeyInfo *db = NULL, **kend = &db;
+
+  for (struct CryptKeyInfo *k = candidates; k; k = k->next)
+  {
+    bool match = false;
+    for (gpgme_user_id_t uid = k->kobj->uids; uid && !match; uid = uid->next)
+    {
+      struct ListNode *np = NULL;
+      STAILQ_FOREACH(np, hints, entries)
+      {
+        if (np->data && *np->data && uid->uid && mutt_istr_find(uid->uid, np->data))
+        {
+          match = true;
+          break;
+        }
+      }
+    }
+
+    if (match)
+    {
+      *kend = crypt_copy_key(k);
+      kend = &(*kend)->next;
+    }
+  }
+
+  return db;
+}
+
+/**
+ * crypt_findkeybyaddr - Find a key by email address
  * @param[in]  a            Address to match
  * @param[in]  abilities    Abilities to match, see #KeyFlags
  * @param[in]  app          Application type, e.g. #APPLICATION_PGP
  * @param[out] forced_valid Set to true if user overrode key's validity
  * @param[in]  oppenc_mode  If true, use opportunistic encryption
+ * @param[in]  candidates   Candidate keys from get_candidates(), or NULL to look them up
+ * @param[out] cacheable    Set to true if the result didn't depend on the user
  * @retval ptr Matching key
  */
-static struct CryptKeyInfo *crypt_getkeybyaddr(struct Address *a,
-                                               KeyFlags abilities, unsigned int app,
-                                               int *forced_valid, bool oppenc_mode)
+static struct CryptKeyInfo *crypt_findkeybyaddr(struct Address *a, KeyFlags abilities,
+                                                unsigned int app, int *forced_valid,
+                                                bool oppenc_mode,
+                                                struct CryptKeyInfo **candidates,
+                                                bool *cacheable)
 {
   struct ListHead hints = STAILQ_HEAD_INITIALIZER(hints);
 
@@ -3559,20 +3858,32 @@ static struct CryptKeyInfo *crypt_getkeybyaddr(struct Address *a,
   struct CryptKeyInfo **matches_endp = &matches;
 
   *forced_valid = 0;
+  *cacheable = false;
 
   if (a && a->mailbox)
     crypt_add_string_to_hints(a->mailbox, &hints);
   if (a && a->personal)
     crypt_add_string_to_hints(a->personal, &hints);
 
-  if (!oppenc_mode)
-    mutt_message(_("Looking for keys matching \"%s\"..."), a ? a->mailbox : "");
-  keys = get_candidates(&hints, app, (abilities & KEYFLAG_CANSIGN));
+  bool error = false;
+  if (candidates)
+  {
+    keys = filter_candidates(*candidates, &hints);
+  }
+  else
+  {
+    if (!oppenc_mode)
+      mutt_message(_("Looking for keys matching \"%s\"..."), a ? a->mailbox : "");
+    keys = get_candidates(&hints, app, (abilities & KEYFLAG_CANSIGN), &error);
+  }
 
   mutt_list_free(&hints);
 
   if (!keys)
+  {
+    *cacheable = !error;
     return NULL;
+  }
 
   mutt_debug(LL_DEBUG5, "looking for %s <%s>\n", a ? a->personal : "", a ? a->mailbox : "");
 
@@ -3643,12 +3954,14 @@ static struct CryptKeyInfo *crypt_getkeybyaddr(struct Address *a,
         k = crypt_copy_key(a_valid_addrmatch_key);
       else
         k = NULL;
+      *cacheable = true;
     }
     else if (the_strong_valid_key && !multi)
     {
       /* There was precisely one strong match on a valid ID.
        * Proceed without asking the user.  */
       k = crypt_copy_key(the_strong_valid_key);
+      *cacheable = true;
     }
     else
     {
@@ -3659,11 +3972,111 @@ static struct CryptKeyInfo *crypt_getkeybyaddr(struct Address *a,
     crypt_key_free(&matches);
   }
   else
+  {
     k = NULL;
+    *cacheable = true;
+  }
 
   return k;
 }
 
+/**
+ * crypt_getkeybyaddr - Find a key by email address
+ * @param[in]  a            Address to match
+ * @param[in]  abilities    Abilities to match, see #KeyFlags
+ * @param[in]  app          Application type, e.g. #APPLICATION_PGP
+ * @param[out] forced_valid Set to true if user overrode key's validity
+ * @param[in]  oppenc_mode  If true, use opportunistic encryption
+ * @param[in]  candidates   Candidate keys from get_candidates(), or NULL to look them up
+ * @retval ptr Matching key
+ *
+ * Keys that were found without asking the user are remembered until the
+ * keyrings change, see key_cache_check().
+ */
+static struct CryptKeyInfo *crypt_getkeybyaddr(struct Address *a, KeyFlags abilities,
+                                               unsigned int app, int *forced_valid,
+                                               bool oppenc_mode,
+                                               struct CryptKeyInfo **candidates)
+{
+  struct Buffer *cache_key = mutt_buffer_pool_get();
+  struct CryptKeyInfo *k = NULL;
+  bool cacheable = false;
+
+  if (!key_cache_key(cache_key, a, abilities, app, oppenc_mode))
+  {
+    k = crypt_findkeybyaddr(a, abilities, app, forced_valid, oppenc_mode,
+                            candidates, &cacheable);
+    goto done;
+  }
+
+  struct CryptKeyCache *kc = mutt_hash_find(KeyCache, mutt_buffer_string(cache_key));
+  if (kc)
+  {
+    *forced_valid = 0;
+    k = kc->key ? crypt_copy_key(kc->key) : NULL;
+    goto done;
+  }
+
+  k = crypt_findkeybyaddr(a, abilities, app, forced_valid, oppenc_mode,
+                          candidates, &cacheable);
+  if (cacheable)
+  {
+    kc = mutt_mem_calloc(1, sizeof(*kc));
+    kc->key = k ? crypt_copy_key(k) : NULL;
+    mutt_hash_insert(KeyCache, mutt_buffer_string(cache_key), kc);
+  }
+
+done:
+  mutt_buffer_pool_release(&cache_key);
+  return k;
+}
+
+/**
+ * prefetch_candidates - Find the candidate keys of many addresses at once
+ * @param[in]  addrlist    Addresses to match
+ * @param[in]  oppenc_mode If true, use opportunistic encryption
+ * @param[out] candidates  Candidate keys
+ * @retval true The candidates were found
+ *
+ * One key listing is much faster than one for each address.  Addresses that
+ * are in the key cache are skipped, and nothing is done for a single address.
+ */
+static bool prefetch_candidates(struct AddressList *addrlist, bool oppenc_mode,
+                                struct CryptKeyInfo **candidates)
+{
+  struct ListHead hints = STAILQ_HEAD_INITIALIZER(hints);
+  struct Buffer *cache_key = mutt_buffer_pool_get();
+  int count = 0;
+
+  struct Address *a = NULL;
+  TAILQ_FOREACH(a, addrlist, entries)
+  {
+    if (key_cache_key(cache_key, a, KEYFLAG_CANENCRYPT, APPLICATION_PGP, oppenc_mode) &&
+        mutt_hash_find(KeyCache, mutt_buffer_string(cache_key)))
+    {
+      continue;
+    }
+
+    if (a->mailbox)
+      crypt_add_string_to_hints(a->mailbox, &hints);
+    if (a->personal)
+      crypt_add_string_to_hints(a->personal, &hints);
+    count++;
+  }
+  mutt_buffer_pool_release(&cache_key);
+
+  bool error = true;
+  if (count > 1)
+  {
+    if (!oppenc_mode)
+      mutt_message(_("Looking for keys of %d recipients..."), count);
+    *candidates = get_candidates(&hints, APPLICATION_PGP, 0, &error);
+  }
+
+  mutt_list_free(&hints);
+  return !error;
+}
+
 /**
  * crypt_getkeybystr - Find a key by string
  * @param[in]  p            String to match
@@ -3687,7 +4100,7 @@ static struct CryptKeyInfo *crypt_getkeybystr(const char *p, KeyFlags abilities,
 
   const char *pfcopy = crypt_get_fingerprint_or_id(p, &phint, &pl, &ps);
   crypt_add_string_to_hints(phint, &hints);
-  struct CryptKeyInfo *keys = get_candidates(&hints, app, (abilities & KEYFLAG_CANSIGN));
+  struct CryptKeyInfo *keys = get_candidates(&hints, app, (abilities & KEYFLAG_CANSIGN), NULL);
   mutt_list_free(&hints);
 
   if (!keys)
@@ -3830,6 +4243,13 @@ static char *find_keys(struct AddressList *addrlist, unsigned int app, bool oppe
   bool key_selected;
   struct AddressList hookal = TAILQ_HEAD_INITIALIZER(hookal);
 
+  key_cache_check();
+
+  /* Look for all the recipients' keys at once */
+  struct CryptKeyInfo *candidates = NULL;
+  const bool prefetched = (app == APPLICATION_PGP) &&
+                          prefetch_candidates(addrlist, oppenc_mode, &candidates);
+
   struct Address *a = NULL;
   TAILQ_FOREACH(a, addrlist, entries)
   {
@@ -3887,13 +4307,15 @@ static char *find_keys(struct AddressList *addrlist, unsigned int app, bool oppe
           FREE(&keylist);
           mutt_addrlist_clear(&hookal);
           mutt_list_free(&crypt_hook_list);
+          crypt_key_free(&candidates);
           return NULL;
         }
       }
 
       if (!k_info)
       {
-        k_info = crypt_getkeybyaddr(p, KEYFLAG_CANENCRYPT, app, &forced_valid, oppenc_mode);
+        k_info = crypt_getkeybyaddr(p, KEYFLAG_CANENCRYPT, app, &forced_valid, oppenc_mode,
+                                    (prefetched && (p == a)) ? &candidates : NULL);
       }
 
       if (!k_info && !oppenc_mode)
@@ -3908,6 +4330,7 @@ static char *find_keys(struct AddressList *addrlist, unsigned int app, bool oppe
         FREE(&keylist);
         mutt_addrlist_clear(&hookal);
         mutt_list_free(&crypt_hook_list);
+        crypt_key_free(&candidates);
         return NULL;
       }
 
@@ -3932,6 +4355,7 @@ static char *find_keys(struct AddressList *addrlist, unsigned int app, bool oppe
 
     mutt_list_free(&crypt_hook_list);
   }
+  crypt_key_free(&candidates);
   return keylist;
 }
 
@@ -4167,6 +4591,22 @@ void smime_gpgme_init(void)
   init_smime();
 }
 
+/**
+ * pgp_gpgme_cleanup - Implements CryptModuleSpecs::cleanup()
+ */
+void pgp_gpgme_cleanup(void)
+{
+  key_cache_free();
+}
+
+/**
+ * smime_gpgme_cleanup - Implements CryptModuleSpecs::cleanup()
+ */
+void smime_gpgme_cleanup(void)
+{
+  key_cache_free();
+}
+
 /**
  * gpgme_send_menu - Show the user the encryption/signing menu
  * @param e        Email
@@ -27,6 +27,7 @@
  */
 
 #include "config.h"
+#include <stdbool.h>
 #include "mutt/lib.h"
 #include "crypt_mod.h"
 
@@ -38,6 +39,7 @@
 struct CryptModule
 {
   struct CryptModuleSpecs *specs;    ///< Crypto module definition
+  bool initialised;                  ///< CryptModuleSpecs::init() has been called
   STAILQ_ENTRY(CryptModule) entries; ///< Linked list
 };
 STAILQ_HEAD(CryptModuleList, CryptModule);
@@ -56,25 +58,62 @@ void crypto_module_register(struct CryptModuleSpecs *specs)
 }
 
 /**
- * crypto_module_lookup - Lookup a crypto module by name
+ * find_module - Find a registered crypto module
  * @param identifier Name, e.g. #APPLICATION_PGP
  * @retval ptr Crypto module
- *
- * This function is usually used via the CRYPT_MOD_CALL[_CHECK] macros.
  */
-struct CryptModuleSpecs *crypto_module_lookup(int identifier)
+static struct CryptModule *find_module(int identifier)
 {
   struct CryptModule *module = NULL;
   STAILQ_FOREACH(module, &CryptModules, entries)
   {
     if (module->specs->identifier == identifier)
     {
-      return module->specs;
+      return module;
     }
   }
   return NULL;
 }
 
+/**
+ * crypto_module_get - Get a crypto module, ready for use
+ * @param identifier Name, e.g. #APPLICATION_PGP
+ * @retval ptr Crypto module
+ *
+ * The first time a module is used, CryptModuleSpecs::init() is called.
+ * Some backends run gpg to check its version, so this isn't done at startup.
+ *
+ * This function is usually used via the CRYPT_MOD_CALL[_CHECK] macros.
+ */
+struct CryptModuleSpecs *crypto_module_get(int identifier)
+{
+  struct CryptModule *module = find_module(identifier);
+  if (!module)
+    return NULL;
+
+  if (!module->initialised)
+  {
+    module->initialised = true;
+    if (module->specs->init)
+      module->specs->init();
+  }
+
+  return module->specs;
+}
+
+/**
+ * crypto_module_lookup - Lookup a crypto module by name
+ * @param identifier Name, e.g. #APPLICATION_PGP
+ * @retval ptr Crypto module
+ *
+ * Unlike crypto_module_get(), the module isn't initialised.
+ */
+struct CryptModuleSpecs *crypto_module_lookup(int identifier)
+{
+  struct CryptModule *module = find_module(identifier);
+  return module ? module->specs : NULL;
+}
+
 /**
  * crypto_module_free - Clean up the crypto modules
  */
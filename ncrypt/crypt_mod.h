@@ -236,6 +236,7 @@ struct CryptModuleSpecs
 
 /* High Level crypto module interface */
 void crypto_module_register(struct CryptModuleSpecs *specs);
+struct CryptModuleSpecs *crypto_module_get(int identifier);
 struct CryptModuleSpecs *crypto_module_lookup(int identifier);
 
 #endif /* MUTT_NCRYPT_CRYPT_MOD_H */
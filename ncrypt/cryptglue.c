@@ -81,18 +81,19 @@ extern struct CryptModuleSpecs CryptModSmimeGpgme;
  * call its function FUNC.  Do nothing else.  This may be used as an
  * expression. */
 #define CRYPT_MOD_CALL_CHECK(identifier, func)                                 \
-  (crypto_module_lookup(APPLICATION_##identifier) &&                           \
-   (crypto_module_lookup(APPLICATION_##identifier))->func)
+  (crypto_module_get(APPLICATION_##identifier) &&                              \
+   (crypto_module_get(APPLICATION_##identifier))->func)
 
 /* Call the function FUNC in the crypto module identified by
  * IDENTIFIER. This may be used as an expression. */
 #define CRYPT_MOD_CALL(identifier, func)                                       \
-  (*(crypto_module_lookup(APPLICATION_##identifier))->func)
+  (*(crypto_module_get(APPLICATION_##identifier))->func)
 
 /**
  * crypt_init - Initialise the crypto backends
  *
- * This calls CryptModuleSpecs::init()
+ * The backends are registered, but CryptModuleSpecs::init() isn't called
+ * until they're first used.
  */
 void crypt_init(void)
 {
@@ -129,15 +130,6 @@ void crypt_init(void)
     crypto_module_register(&CryptModSmimeGpgme);
   }
 #endif
-
-#if defined(CRYPT_BACKEND_CLASSIC_PGP) ||                                      \
-    defined(CRYPT_BACKEND_CLASSIC_SMIME) || defined(CRYPT_BACKEND_GPGME)
-  if (CRYPT_MOD_CALL_CHECK(PGP, init))
-    CRYPT_MOD_CALL(PGP, init)();
-
-  if (CRYPT_MOD_CALL_CHECK(SMIME, init))
-    CRYPT_MOD_CALL(SMIME, init)();
-#endif
 }
 
 /**
@@ -145,11 +137,16 @@ void crypt_init(void)
  */
 void crypt_cleanup(void)
 {
-  if (CRYPT_MOD_CALL_CHECK(PGP, cleanup))
-    (CRYPT_MOD_CALL(PGP, cleanup))();
+  crypt_cache_cleanup();
+
+  /* Don't initialise a backend, just to clean it up */
+  struct CryptModuleSpecs *mod = crypto_module_lookup(APPLICATION_PGP);
+  if (mod && mod->cleanup)
+    mod->cleanup();
 
-  if (CRYPT_MOD_CALL_CHECK(SMIME, cleanup))
-    (CRYPT_MOD_CALL(SMIME, cleanup))();
+  mod = crypto_module_lookup(APPLICATION_SMIME);
+  if (mod && mod->cleanup)
+    mod->cleanup();
 }
 
 /**
@@ -216,7 +213,7 @@ int crypt_pgp_decrypt_mime(FILE *fp_in, FILE **fp_out, struct Body *b, struct Bo
 {
 #ifdef USE_AUTOCRYPT
   const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-  if (c_autocrypt)
+  if (c_autocrypt && (mutt_autocrypt_init(NULL, false) == 0))
   {
     OptAutocryptGpgme = true;
     int result = pgp_gpgme_decrypt_mime(fp_in, fp_out, b, cur);
@@ -257,7 +254,7 @@ int crypt_pgp_encrypted_handler(struct Body *b, struct State *s)
 {
 #ifdef USE_AUTOCRYPT
   const bool c_autocrypt = cs_subset_bool(NeoMutt->sub, "autocrypt");
-  if (c_autocrypt)
+  if (c_autocrypt && (mutt_autocrypt_init(NULL, false) == 0))
   {
     OptAutocryptGpgme = true;
     int result = pgp_gpgme_encrypted_handler(b, s);
@@ -37,8 +37,10 @@
 #include <fcntl.h>
 #include <iconv.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
 #include "mutt/lib.h"
@@ -48,6 +50,7 @@
 #include "gnupgparse.h"
 #include "lib.h"
 #include "pgpinvoke.h"
+#include "mutt_globals.h"
 #include "pgpkey.h"
 #ifdef CRYPT_BACKEND_CLASSIC_PGP
 #include "pgplib.h"
@@ -115,7 +118,6 @@ static void fix_uid(char *uid)
         memcpy(uid, buf, n);
     }
     FREE(&buf);
-    iconv_close(cd);
   }
 }
 
@@ -405,13 +407,13 @@ bail:
 }
 
 /**
- * pgp_get_candidates - Find PGP keys matching a list of hints
+ * list_keys - Run the PGP program to list keys
  * @param keyring PGP Keyring
- * @param hints   List of strings to match
+ * @param hints   List of strings to match, may be empty
  * @retval ptr  Key list
  * @retval NULL Error
  */
-struct PgpKeyInfo *pgp_get_candidates(enum PgpRing keyring, struct ListHead *hints)
+static struct PgpKeyInfo *list_keys(enum PgpRing keyring, struct ListHead *hints)
 {
   FILE *fp = NULL;
   pid_t pid;
@@ -475,3 +477,325 @@ struct PgpKeyInfo *pgp_get_candidates(enum PgpRing keyring, struct ListHead *hin
 
   return db;
 }
+
+/**
+ * struct PgpKeyBlock - A primary key and its subkeys in the keyring cache
+ */
+struct PgpKeyBlock
+{
+  struct PgpKeyInfo *key; ///< Primary key, followed by its subkeys
+  char *uids;             ///< All the User IDs, lower case, one per line
+  bool matched;           ///< Matched by the current lookup
+};
+ARRAY_HEAD(PgpKeyBlockArray, struct PgpKeyBlock);
+
+/**
+ * struct PgpKeyring - Cached listing of a keyring
+ *
+ * Listing a big keyring is slow, so the parsed keys are kept until the keyring
+ * changes.
+ */
+struct PgpKeyring
+{
+  char *stamp;                    ///< State of the keyring and config when it was listed
+  struct PgpKeyInfo *keys;        ///< All the keys, in keyring order
+  struct PgpKeyBlockArray blocks; ///< The keys, grouped by primary key
+  struct HashTable *ids;          ///< Key IDs and fingerprints -> PgpKeyBlock index
+};
+
+/// Cached listings of the public and secret keyrings
+static struct PgpKeyring Keyrings[2] = { 0 };
+
+/**
+ * keyring_free - Free a cached keyring listing
+ * @param kr Keyring to free
+ */
+static void keyring_free(struct PgpKeyring *kr)
+{
+  struct PgpKeyBlock *kb = NULL;
+  ARRAY_FOREACH(kb, &kr->blocks)
+  {
+    FREE(&kb->uids);
+  }
+  ARRAY_FREE(&kr->blocks);
+  mutt_hash_free(&kr->ids);
+  pgp_key_free(&kr->keys);
+  FREE(&kr->stamp);
+}
+
+/**
+ * pgp_keyring_cache_free - Forget the cached keyring listings
+ */
+void pgp_keyring_cache_free(void)
+{
+  for (size_t i = 0; i < mutt_array_size(Keyrings); i++)
+    keyring_free(&Keyrings[i]);
+}
+
+/**
+ * keyring_stamp - Describe the state of a keyring
+ * @param keyring PGP Keyring
+ * @param buf     Buffer for the result
+ * @retval true  The keyring files were found
+ * @retval false The keyring can't be cached
+ *
+ * The stamp covers the listing command and the config that affects parsing,
+ * as well as the size and time of the GnuPG files.  If the command names its
+ * own keyring, we don't know which files to watch.
+ */
+static bool keyring_stamp(enum PgpRing keyring, struct Buffer *buf)
+{
+  const char *const c_cmd =
+      cs_subset_string(NeoMutt->sub, (keyring == PGP_SECRING) ? "pgp_list_secring_command" :
+                                                                "pgp_list_pubring_command");
+  if (!c_cmd || strstr(c_cmd, "--homedir") || strstr(c_cmd, "--keyring"))
+    return false;
+
+  const char *const c_charset = cs_subset_string(NeoMutt->sub, "charset");
+  const char *const c_pgp_sign_as = cs_subset_string(NeoMutt->sub, "pgp_sign_as");
+  const char *const c_pgp_default_key = cs_subset_string(NeoMutt->sub, "pgp_default_key");
+  const bool c_pgp_ignore_subkeys = cs_subset_bool(NeoMutt->sub, "pgp_ignore_subkeys");
+  mutt_buffer_printf(buf, "%s|%s|%s|%s|%d", c_cmd, NONULL(c_charset), NONULL(c_pgp_sign_as),
+                     NONULL(c_pgp_default_key), c_pgp_ignore_subkeys);
+
+  struct Buffer *home = mutt_buffer_pool_get();
+  const char *gnupghome = mutt_str_getenv("GNUPGHOME");
+  if (gnupghome)
+    mutt_buffer_strcpy(home, gnupghome);
+  else
+    mutt_buffer_printf(home, "%s/.gnupg", NONULL(HomeDir));
+
+  static const char *const files[] = {
+    "pubring.kbx", "pubring.gpg", "trustdb.gpg", "secring.gpg", "private-keys-v1.d",
+  };
+
+  bool found = false;
+  struct Buffer *path = mutt_buffer_pool_get();
+  for (size_t i = 0; i < mutt_array_size(files); i++)
+  {
+    struct stat st = { 0 };
+    mutt_buffer_concat_path(path, mutt_buffer_string(home), files[i]);
+    if (stat(mutt_buffer_string(path), &st) != 0)
+      continue;
+
+    struct timespec ts = { 0 };
+    mutt_file_get_stat_timespec(&ts, &st, MUTT_STAT_MTIME);
+    mutt_buffer_add_printf(buf, "|%s:%llu:%lld:%ld:%lld", files[i],
+                           (unsigned long long) st.st_ino, (long long) ts.tv_sec,
+                           (long) ts.tv_nsec, (long long) st.st_size);
+    /* the secret key files alone don't make a keyring */
+    if (i < 3)
+      found = true;
+  }
+
+  mutt_buffer_pool_release(&path);
+  mutt_buffer_pool_release(&home);
+  return found;
+}
+
+/**
+ * keyring_index - Group a keyring listing by primary key and index it
+ * @param kr Keyring listing
+ */
+static void keyring_index(struct PgpKeyring *kr)
+{
+  kr->ids = mutt_hash_new(1024, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS |
+                                    MUTT_HASH_ALLOW_DUPS);
+
+  struct Buffer *uids = mutt_buffer_pool_get();
+  for (struct PgpKeyInfo *k = kr->keys; k;)
+  {
+    struct PgpKeyBlock kb = { k, NULL, false };
+    const intptr_t idx = ARRAY_SIZE(&kr->blocks);
+
+    mutt_buffer_reset(uids);
+    for (struct PgpUid *u = k->address; u; u = u->next)
+    {
+      mutt_buffer_addstr(uids, NONULL(u->addr));
+      mutt_buffer_addch(uids, '\n');
+    }
+    kb.uids = mutt_buffer_strdup(uids);
+    mutt_str_lower(kb.uids);
+
+    /* the primary key and its subkeys can all be found by ID */
+    struct PgpKeyInfo *primary = k;
+    do
+    {
+      const char *keyid = NONULL(k->keyid);
+      const size_t len = strlen(keyid);
+      if (len >= 8)
+        mutt_hash_insert(kr->ids, keyid + len - 8, (void *) idx);
+      if (len > 8)
+        mutt_hash_insert(kr->ids, keyid, (void *) idx);
+      if (k->fingerprint)
+        mutt_hash_insert(kr->ids, k->fingerprint, (void *) idx);
+      k = k->next;
+    } while (k && (k->parent == primary));
+
+    ARRAY_ADD(&kr->blocks, kb);
+  }
+  mutt_buffer_pool_release(&uids);
+}
+
+/**
+ * keyring_get - Get the listing of a keyring, running the PGP program if needed
+ * @param keyring PGP Keyring
+ * @retval ptr  Cached listing
+ * @retval NULL The keyring can't be cached
+ */
+static struct PgpKeyring *keyring_get(enum PgpRing keyring)
+{
+  struct PgpKeyring *kr = &Keyrings[(keyring == PGP_SECRING) ? 1 : 0];
+  struct Buffer *stamp = mutt_buffer_pool_get();
+
+  if (!keyring_stamp(keyring, stamp))
+  {
+    keyring_free(kr);
+    kr = NULL;
+    goto done;
+  }
+
+  if (kr->stamp && mutt_str_equal(kr->stamp, mutt_buffer_string(stamp)))
+    goto done;
+
+  keyring_free(kr);
+  struct ListHead all = STAILQ_HEAD_INITIALIZER(all);
+  kr->keys = list_keys(keyring, &all);
+  keyring_index(kr);
+  kr->stamp = mutt_buffer_strdup(stamp);
+  mutt_debug(LL_DEBUG1, "cached %zu keys from the %s keyring\n", ARRAY_SIZE(&kr->blocks),
+             (keyring == PGP_SECRING) ? "secret" : "public");
+
+done:
+  mutt_buffer_pool_release(&stamp);
+  return kr;
+}
+
+/**
+ * copy_block - Copy a key and its subkeys
+ * @param[in]  kb   Block to copy
+ * @param[out] tail End of the list to add the copies to
+ * @retval ptr New end of the list
+ */
+static struct PgpKeyInfo **copy_block(struct PgpKeyBlock *kb, struct PgpKeyInfo **tail)
+{
+  struct PgpKeyInfo *primary = NULL;
+  struct PgpKeyInfo *k = kb->key;
+  do
+  {
+    struct PgpKeyInfo *copy = mutt_mem_calloc(1, sizeof(*copy));
+    copy->keyid = mutt_str_dup(k->keyid);
+    copy->fingerprint = mutt_str_dup(k->fingerprint);
+    copy->address = pgp_copy_uids(k->address, copy);
+    copy->flags = k->flags;
+    copy->keylen = k->keylen;
+    copy->gen_time = k->gen_time;
+    copy->numalg = k->numalg;
+    copy->algorithm = k->algorithm;
+    if (primary)
+      copy->parent = primary;
+    else
+      primary = copy;
+
+    *tail = copy;
+    tail = &copy->next;
+    k = k->next;
+  } while (k && (k->parent == kb->key));
+
+  return tail;
+}
+
+/**
+ * hint_is_keyid - Does a hint look like a Key ID or fingerprint?
+ * @param hint Hint to test
+ * @retval ptr  Hex digits of the ID
+ * @retval NULL Not an ID
+ *
+ * This follows the rules that gpg uses for its command line.
+ */
+static const char *hint_is_keyid(const char *hint)
+{
+  const char *hex = hint + mutt_istr_startswith(hint, "0x");
+
+  const size_t len = strlen(hex);
+  if ((len != 8) && (len != 16) && (len != 32) && (len != 40))
+    return NULL;
+
+  for (const char *p = hex; *p; p++)
+    if (!isxdigit((unsigned char) *p))
+      return NULL;
+
+  return hex;
+}
+
+/**
+ * pgp_get_candidates - Find PGP keys matching a list of hints
+ * @param keyring PGP Keyring
+ * @param hints   List of strings to match
+ * @retval ptr  Key list
+ * @retval NULL Error
+ *
+ * The keyring is listed once, then each lookup is answered from memory until
+ * the keyring changes.  Like gpg, a key matches if any hint is one of its IDs,
+ * or is part of one of its User IDs.
+ */
+struct PgpKeyInfo *pgp_get_candidates(enum PgpRing keyring, struct ListHead *hints)
+{
+  /* gpg gives special meanings to these, so let it do the work */
+  struct ListNode *np = NULL;
+  STAILQ_FOREACH(np, hints, entries)
+  {
+    if (np->data && strchr("=<>@*#&+", np->data[0]))
+      return list_keys(keyring, hints);
+  }
+
+  struct PgpKeyring *kr = keyring_get(keyring);
+  if (!kr)
+    return list_keys(keyring, hints);
+
+  struct PgpKeyBlock *kb = NULL;
+  const bool all = STAILQ_EMPTY(hints);
+  ARRAY_FOREACH(kb, &kr->blocks)
+  {
+    kb->matched = all;
+  }
+
+  char *lower = NULL;
+  STAILQ_FOREACH(np, hints, entries)
+  {
+    const char *id = hint_is_keyid(NONULL(np->data));
+    if (id)
+    {
+      for (struct HashElem *he = mutt_hash_find_bucket(kr->ids, id); he; he = he->next)
+      {
+        if (!mutt_istr_equal(he->key.strkey, id))
+          continue;
+        kb = ARRAY_GET(&kr->blocks, (intptr_t) he->data);
+        if (kb)
+          kb->matched = true;
+      }
+      continue;
+    }
+
+    mutt_str_replace(&lower, np->data);
+    if (!lower)
+      continue;
+    mutt_str_lower(lower);
+    ARRAY_FOREACH(kb, &kr->blocks)
+    {
+      if (!kb->matched && strstr(kb->uids, lower))
+        kb->matched = true;
+    }
+  }
+  FREE(&lower);
+
+  struct PgpKeyInfo *db = NULL;
+  struct PgpKeyInfo **tail = &db;
+  ARRAY_FOREACH(kb, &kr->blocks)
+  {
+    if (kb->matched)
+      tail = copy_block(kb, tail);
+  }
+
+  return db;
+}
@@ -28,5 +28,6 @@
 struct ListHead;
 
 struct PgpKeyInfo * pgp_get_candidates(enum PgpRing keyring, struct ListHead *hints);
+void                pgp_keyring_cache_free(void);
 
 #endif /* MUTT_NCRYPT_GNUPGPARSE_H */
@@ -31,6 +31,7 @@
  * | :------------------------------- | :----------------------------------- |
  * | ncrypt/config.c                  | @subpage crypt_config                |
  * | ncrypt/crypt.c                   | @subpage crypt_crypt                 |
+ * | ncrypt/crypt_cache.c             | @subpage crypt_crypt_cache           |
  * | ncrypt/cryptglue.c               | @subpage crypt_cryptglue             |
  * | ncrypt/crypt_gpgme.c             | @subpage crypt_crypt_gpgme           |
  * | ncrypt/crypt_mod.c               | @subpage crypt_crypt_mod             |
@@ -60,9 +61,7 @@
 
 struct Address;
 struct Body;
-#ifdef USE_AUTOCRYPT
 struct Buffer;
-#endif
 struct Email;
 struct EmailList;
 struct Envelope;
@@ -155,6 +154,13 @@ int          mutt_protected_headers_handler(struct Body *b, struct State *s);
 bool         mutt_should_hide_protected_subject(struct Email *e);
 int          mutt_signed_handler(struct Body *b, struct State *s);
 
+/* crypt_cache.c */
+void crypt_cache_cleanup(void);
+bool crypt_cache_fetch(const char *key, struct Body *b, struct State *s);
+void crypt_cache_flush(void);
+bool crypt_cache_key(struct Body *b, struct State *s, struct Buffer *key);
+void crypt_cache_store(const char *key, struct Body *b, FILE *fp, size_t len);
+
 /* cryptglue.c */
 void         crypt_cleanup(void);
 bool         crypt_has_module_backend(SecurityFlags type);
@@ -51,6 +51,7 @@
 #include "send/lib.h"
 #include "crypt.h"
 #include "cryptglue.h"
+#include "gnupgparse.h"
 #include "handler.h"
 #include "hook.h"
 #include "mutt_attach.h"
@@ -68,6 +69,14 @@
 char PgpPass[1024];
 time_t PgpExptime = 0; /* when does the cached passphrase expire? */
 
+/**
+ * pgp_class_cleanup - Implements CryptModuleSpecs::cleanup()
+ */
+void pgp_class_cleanup(void)
+{
+  pgp_keyring_cache_free();
+}
+
 /**
  * pgp_class_void_passphrase - Implements CryptModuleSpecs::void_passphrase()
  */
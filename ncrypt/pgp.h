@@ -46,6 +46,7 @@ char *pgp_short_keyid(struct PgpKeyInfo * k);
 char *pgp_long_keyid(struct PgpKeyInfo * k);
 char *pgp_fpr_or_lkeyid(struct PgpKeyInfo * k);
 
+void pgp_class_cleanup(void);
 int pgp_class_decrypt_mime(FILE *fp_in, FILE **fp_out, struct Body *b, struct Body **cur);
 
 char *pgp_class_find_keys(struct AddressList *addrlist, bool oppenc_mode);
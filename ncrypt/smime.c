@@ -77,29 +77,36 @@ struct SmimeCommandContext
 char SmimePass[256];
 time_t SmimeExpTime = 0; /* when does the cached passphrase expire? */
 
-static struct Buffer SmimeKeyToUse = { 0 };
-static struct Buffer SmimeCertToUse = { 0 };
-static struct Buffer SmimeIntermediateToUse = { 0 };
-
 /**
- * smime_init - Initialise smime globals
+ * struct SmimeIndexLine - A key from an SMIME index file
  */
-void smime_init(void)
+struct SmimeIndexLine
 {
-  mutt_buffer_alloc(&SmimeKeyToUse, 256);
-  mutt_buffer_alloc(&SmimeCertToUse, 256);
-  mutt_buffer_alloc(&SmimeIntermediateToUse, 256);
-}
+  char *line;           ///< Text of the line, for searching
+  struct SmimeKey *key; ///< Parsed key
+};
+ARRAY_HEAD(SmimeIndexLineArray, struct SmimeIndexLine);
 
 /**
- * smime_cleanup - Clean up smime globals
+ * struct SmimeIndex - Cache of an SMIME index file
+ *
+ * The file is only read again if it changes.
  */
-void smime_cleanup(void)
+struct SmimeIndex
 {
-  mutt_buffer_dealloc(&SmimeKeyToUse);
-  mutt_buffer_dealloc(&SmimeCertToUse);
-  mutt_buffer_dealloc(&SmimeIntermediateToUse);
-}
+  char *file;                       ///< Path of the index file
+  struct timespec mtime;            ///< Time the file was last changed
+  off_t size;                       ///< Size of the file
+  ino_t inode;                      ///< Inode of the file
+  struct SmimeIndexLineArray lines; ///< Keys in the file
+};
+
+static struct Buffer SmimeKeyToUse = { 0 };
+static struct Buffer SmimeCertToUse = { 0 };
+static struct Buffer SmimeIntermediateToUse = { 0 };
+
+/// Caches of the index files of $smime_keys and $smime_certificates
+static struct SmimeIndex SmimeIndexes[2] = { 0 };
 
 /**
  * smime_key_free - Free a list of SMIME keys
@@ -148,6 +155,45 @@ static struct SmimeKey *smime_copy_key(struct SmimeKey *key)
   return copy;
 }
 
+/**
+ * smime_index_free - Empty an SMIME index cache
+ * @param idx Index to empty
+ */
+static void smime_index_free(struct SmimeIndex *idx)
+{
+  struct SmimeIndexLine *sil = NULL;
+  ARRAY_FOREACH(sil, &idx->lines)
+  {
+    FREE(&sil->line);
+    smime_key_free(&sil->key);
+  }
+  ARRAY_FREE(&idx->lines);
+  FREE(&idx->file);
+}
+
+/**
+ * smime_init - Initialise smime globals
+ */
+void smime_init(void)
+{
+  mutt_buffer_alloc(&SmimeKeyToUse, 256);
+  mutt_buffer_alloc(&SmimeCertToUse, 256);
+  mutt_buffer_alloc(&SmimeIntermediateToUse, 256);
+}
+
+/**
+ * smime_cleanup - Clean up smime globals
+ */
+void smime_cleanup(void)
+{
+  mutt_buffer_dealloc(&SmimeKeyToUse);
+  mutt_buffer_dealloc(&SmimeCertToUse);
+  mutt_buffer_dealloc(&SmimeIntermediateToUse);
+
+  for (size_t i = 0; i < mutt_array_size(SmimeIndexes); i++)
+    smime_index_free(&SmimeIndexes[i]);
+}
+
 /*
  *     Queries and passphrase handling.
  */
@@ -502,16 +548,19 @@ static struct SmimeKey *smime_parse_key(char *buf)
 }
 
 /**
- * smime_get_candidates - Find keys matching a string
- * @param search           String to match
- * @param only_public_key  If true, only get the public keys
- * @retval ptr Matching key
+ * smime_index_read - Read an SMIME index file
+ * @param only_public_key  If true, read the index of the public keys
+ * @retval ptr  Cached index
+ * @retval NULL Error
+ *
+ * The index is searched for every key lookup, so it's cached until the file
+ * changes.
  */
-static struct SmimeKey *smime_get_candidates(const char *search, bool only_public_key)
+static struct SmimeIndex *smime_index_read(bool only_public_key)
 {
+  struct SmimeIndex *idx = &SmimeIndexes[only_public_key ? 1 : 0];
+  struct SmimeIndex *rc = NULL;
   char buf[1024];
-  struct SmimeKey *key = NULL, *results = NULL;
-  struct SmimeKey **results_end = &results;
 
   struct Buffer *index_file = mutt_buffer_pool_get();
   const char *const c_smime_certificates =
@@ -520,30 +569,85 @@ static struct SmimeKey *smime_get_candidates(const char *search, bool only_publi
   mutt_buffer_printf(index_file, "%s/.index",
                      only_public_key ? NONULL(c_smime_certificates) : NONULL(c_smime_keys));
 
+  struct stat sb = { 0 };
+  if (stat(mutt_buffer_string(index_file), &sb) != 0)
+  {
+    mutt_perror(mutt_buffer_string(index_file));
+    smime_index_free(idx);
+    goto done;
+  }
+
+  if (mutt_str_equal(idx->file, mutt_buffer_string(index_file)) &&
+      (mutt_file_stat_timespec_compare(&sb, MUTT_STAT_MTIME, &idx->mtime) == 0) &&
+      (sb.st_size == idx->size) && (sb.st_ino == idx->inode))
+  {
+    rc = idx;
+    goto done;
+  }
+
+  smime_index_free(idx);
+
   FILE *fp = mutt_file_fopen(mutt_buffer_string(index_file), "r");
   if (!fp)
   {
     mutt_perror(mutt_buffer_string(index_file));
-    mutt_buffer_pool_release(&index_file);
-    return NULL;
+    goto done;
   }
-  mutt_buffer_pool_release(&index_file);
 
   while (fgets(buf, sizeof(buf), fp))
   {
-    if (((*search == '\0')) || mutt_istr_find(buf, search))
+    char *line = mutt_str_dup(buf);
+    struct SmimeKey *key = smime_parse_key(buf);
+    if (key)
     {
-      key = smime_parse_key(buf);
-      if (key)
-      {
-        *results_end = key;
-        results_end = &key->next;
-      }
+      struct SmimeIndexLine sil = { line, key };
+      ARRAY_ADD(&idx->lines, sil);
+    }
+    else
+    {
+      FREE(&line);
     }
   }
 
   mutt_file_fclose(&fp);
 
+  idx->file = mutt_buffer_strdup(index_file);
+  mutt_file_get_stat_timespec(&idx->mtime, &sb, MUTT_STAT_MTIME);
+  idx->size = sb.st_size;
+  idx->inode = sb.st_ino;
+  rc = idx;
+
+done:
+  mutt_buffer_pool_release(&index_file);
+  return rc;
+}
+
+/**
+ * smime_get_candidates - Find keys matching a string
+ * @param search           String to match
+ * @param only_public_key  If true, only get the public keys
+ * @retval ptr Matching key
+ */
+static struct SmimeKey *smime_get_candidates(const char *search, bool only_public_key)
+{
+  struct SmimeKey *results = NULL;
+  struct SmimeKey **results_end = &results;
+
+  struct SmimeIndex *idx = smime_index_read(only_public_key);
+  if (!idx)
+    return NULL;
+
+  struct SmimeIndexLine *sil = NULL;
+  ARRAY_FOREACH(sil, &idx->lines)
+  {
+    if ((*search == '\0') || mutt_istr_find(sil->line, search))
+    {
+      struct SmimeKey *key = smime_copy_key(sil->key);
+      *results_end = key;
+      results_end = &key->next;
+    }
+  }
+
   return results;
 }
 
@@ -44,10 +44,12 @@ struct NntpAccountData
   bool hasLISTGROUPrange  : 1;
   bool hasOVER            : 1;
   bool hasXOVER           : 1;
+  bool hasCOMPRESS        : 1;
   unsigned int use_tls    : 3;
   unsigned int status     : 3;
   bool cacheable          : 1;
   bool newsrc_modified    : 1;
+  bool newsrc_dirty       : 1;
   FILE *fp_newsrc;
   char *newsrc_file;
   char *authenticators;
@@ -60,6 +60,11 @@ static struct ConfigDef NntpVars[] = {
   { "nntp_context", DT_NUMBER|DT_NOT_NEGATIVE, 1000, 0, NULL,
     "(nntp) Maximum number of articles to list (0 for all articles)"
   },
+#ifdef USE_ZLIB
+  { "nntp_deflate", DT_BOOL, true, 0, NULL,
+    "(nntp) Compress network traffic"
+  },
+#endif
   { "nntp_listgroup", DT_BOOL, true, 0, NULL,
     "(nntp) Check all articles when opening a newsgroup"
   },
@@ -69,6 +74,9 @@ static struct ConfigDef NntpVars[] = {
   { "nntp_pass", DT_STRING|DT_SENSITIVE, 0, 0, NULL,
     "(nntp) Password for the news server"
   },
+  { "nntp_pipeline_depth", DT_NUMBER|DT_NOT_NEGATIVE, 16, 0, NULL,
+    "(nntp) Number of commands to send before waiting for the answers"
+  },
   { "nntp_poll", DT_NUMBER|DT_NOT_NEGATIVE, 60, 0, NULL,
     "(nntp) Interval between checks for new posts"
   },
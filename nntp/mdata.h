@@ -42,6 +42,7 @@ struct NntpMboxData
   bool has_new_mail : 1;
   bool allowed      : 1;
   bool deleted      : 1;
+  bool newsrc_dirty : 1;
   unsigned int newsrc_len;
   struct NewsrcEntry *newsrc_ent;
   struct NntpAccountData *adata;
@@ -33,8 +33,11 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -62,6 +65,39 @@
 
 struct BodyCache;
 
+/// Start of the binary cache of the list of newsgroups, with its version
+#define ACTIVE_CACHE_MAGIC "NMactv1\n"
+
+/**
+ * struct ActiveCacheHeader - Header of the binary cache of the list of newsgroups
+ *
+ * The cache is local, so it uses the native byte order.  byte_order tells if
+ * it was written by a machine with a different one.
+ */
+struct ActiveCacheHeader
+{
+  char magic[8];           ///< ACTIVE_CACHE_MAGIC
+  uint32_t byte_order;     ///< 0x01020304, in the writer's byte order
+  uint32_t num_groups;     ///< Number of newsgroups
+  uint64_t newgroups_time; ///< Time of the last check for new newsgroups
+};
+
+/**
+ * struct ActiveCacheGroup - A newsgroup in the binary cache
+ *
+ * It's followed by the name and the description, each with a NUL.  Records
+ * aren't aligned, so they're copied out before use.
+ */
+struct ActiveCacheGroup
+{
+  uint32_t first;     ///< First article number
+  uint32_t last;      ///< Last article number
+  uint32_t desc_len;  ///< Length of the description
+  uint16_t group_len; ///< Length of the name
+  uint8_t allowed;    ///< Posting is allowed
+  uint8_t pad;        ///< Unused
+};
+
 /**
  * mdata_find - Find NntpMboxData for given newsgroup or add it
  * @param adata NNTP server
@@ -95,6 +131,74 @@ static struct NntpMboxData *mdata_find(struct NntpAccountData *adata, const char
   return mdata;
 }
 
+/**
+ * newsrc_compare_entry - Compare two .newsrc entries - Implements ::sort_t
+ */
+static int newsrc_compare_entry(const void *a, const void *b)
+{
+  const struct NewsrcEntry *ea = a;
+  const struct NewsrcEntry *eb = b;
+
+  if (ea->first == eb->first)
+    return 0;
+  return (ea->first < eb->first) ? -1 : 1;
+}
+
+/**
+ * newsrc_merge_entries - Sort the read ranges of a newsgroup and merge them
+ * @param mdata NNTP Mailbox data
+ *
+ * Another newsreader may have written the ranges in any order, or let them
+ * overlap.  Afterwards, they're in order, distinct and not adjacent.
+ */
+static void newsrc_merge_entries(struct NntpMboxData *mdata)
+{
+  struct NewsrcEntry *ent = mdata->newsrc_ent;
+  unsigned int num = 0;
+
+  qsort(ent, mdata->newsrc_len, sizeof(struct NewsrcEntry), newsrc_compare_entry);
+
+  for (unsigned int i = 0; i < mdata->newsrc_len; i++)
+  {
+    /* empty range */
+    if (ent[i].first > ent[i].last)
+      continue;
+
+    if ((num > 0) && (ent[i].first <= (ent[num - 1].last + 1)))
+    {
+      if (ent[i].last > ent[num - 1].last)
+        ent[num - 1].last = ent[i].last;
+      continue;
+    }
+    ent[num++] = ent[i];
+  }
+
+  /* nothing read */
+  if (num == 0)
+  {
+    ent[0].first = 1;
+    ent[0].last = 0;
+    num = 1;
+  }
+  mdata->newsrc_len = num;
+}
+
+/**
+ * nntp_newsrc_dirty - Note that a newsgroup's .newsrc entry has changed
+ * @param mdata NNTP Mailbox data
+ *
+ * nntp_newsrc_update() only rewrites the .newsrc if something has changed.
+ */
+void nntp_newsrc_dirty(struct NntpMboxData *mdata)
+{
+  if (!mdata)
+    return;
+
+  mdata->newsrc_dirty = true;
+  if (mdata->adata)
+    mdata->adata->newsrc_dirty = true;
+}
+
 /**
  * nntp_acache_free - Remove all temporarily cache files
  * @param mdata NNTP Mailbox data
@@ -158,6 +262,9 @@ void nntp_group_unread_stat(struct NntpMboxData *mdata)
  * @retval  0 Not changed
  * @retval  1 Parsed
  * @retval -1 Error
+ *
+ * If the file has been changed by someone else, newsgroups whose entries have
+ * changed, but haven't been written yet, keep their entries.
  */
 int nntp_newsrc_parse(struct NntpAccountData *adata)
 {
@@ -211,7 +318,7 @@ int nntp_newsrc_parse(struct NntpAccountData *adata)
   for (unsigned int i = 0; i < adata->groups_num; i++)
   {
     struct NntpMboxData *mdata = adata->groups_list[i];
-    if (!mdata)
+    if (!mdata || mdata->newsrc_dirty)
       continue;
 
     mdata->subscribed = false;
@@ -238,6 +345,8 @@ int nntp_newsrc_parse(struct NntpAccountData *adata)
 
     /* get newsgroup data */
     struct NntpMboxData *mdata = mdata_find(adata, line);
+    if (mdata->newsrc_dirty)
+      continue;
     FREE(&mdata->newsrc_ent);
 
     /* count number of entries */
@@ -278,9 +387,11 @@ int nntp_newsrc_parse(struct NntpAccountData *adata)
       mdata->newsrc_ent[j].last = 0;
       j++;
     }
+    mdata->newsrc_len = j;
+    newsrc_merge_entries(mdata);
+    j = mdata->newsrc_len;
     if (mdata->last_message == 0)
       mdata->last_message = mdata->newsrc_ent[j - 1].last;
-    mdata->newsrc_len = j;
     mutt_mem_realloc(&mdata->newsrc_ent, j * sizeof(struct NewsrcEntry));
     nntp_group_unread_stat(mdata);
     mutt_debug(LL_DEBUG2, "%s\n", mdata->group);
@@ -292,6 +403,8 @@ int nntp_newsrc_parse(struct NntpAccountData *adata)
 /**
  * nntp_newsrc_gen_entries - Generate array of .newsrc entries
  * @param m Mailbox
+ *
+ * If the entries differ from the old ones, the newsgroup is marked dirty.
  */
 void nntp_newsrc_gen_entries(struct Mailbox *m)
 {
@@ -310,12 +423,11 @@ void nntp_newsrc_gen_entries(struct Mailbox *m)
     mailbox_changed(m, NT_MAILBOX_RESORT);
   }
 
-  entries = mdata->newsrc_len;
-  if (!entries)
-  {
-    entries = 5;
-    mdata->newsrc_ent = mutt_mem_calloc(entries, sizeof(struct NewsrcEntry));
-  }
+  struct NewsrcEntry *old_ent = mdata->newsrc_ent;
+  unsigned int old_len = mdata->newsrc_len;
+
+  entries = MAX(old_len, 5);
+  mdata->newsrc_ent = mutt_mem_calloc(entries, sizeof(struct NewsrcEntry));
 
   /* Set up to fake initial sequence from 1 to the article before the
    * first article in our list */
@@ -372,6 +484,13 @@ void nntp_newsrc_gen_entries(struct Mailbox *m)
   }
   mutt_mem_realloc(&mdata->newsrc_ent, mdata->newsrc_len * sizeof(struct NewsrcEntry));
 
+  if (!old_ent || (old_len != mdata->newsrc_len) ||
+      (memcmp(old_ent, mdata->newsrc_ent, old_len * sizeof(struct NewsrcEntry)) != 0))
+  {
+    nntp_newsrc_dirty(mdata);
+  }
+  FREE(&old_ent);
+
   if (c_sort != SORT_ORDER)
   {
     cs_subset_str_native_set(NeoMutt->sub, "sort", c_sort, NULL);
@@ -383,10 +502,11 @@ void nntp_newsrc_gen_entries(struct Mailbox *m)
  * update_file - Update file with new contents
  * @param filename File to update
  * @param buf      New context
+ * @param buflen   Length of the new contents
  * @retval  0 Success
  * @retval -1 Failure
  */
-static int update_file(char *filename, char *buf)
+static int update_file(char *filename, const char *buf, size_t buflen)
 {
   FILE *fp = NULL;
   char tmpfile[PATH_MAX];
@@ -402,7 +522,7 @@ static int update_file(char *filename, char *buf)
       *tmpfile = '\0';
       break;
     }
-    if (fputs(buf, fp) == EOF)
+    if (fwrite(buf, 1, buflen, fp) != buflen)
     {
       mutt_perror(tmpfile);
       break;
@@ -435,12 +555,21 @@ static int update_file(char *filename, char *buf)
  * @param adata NNTP server
  * @retval  0 Success
  * @retval -1 Failure
+ *
+ * The file is only rewritten if an entry has changed since it was last read
+ * or written, see nntp_newsrc_dirty().
  */
 int nntp_newsrc_update(struct NntpAccountData *adata)
 {
   if (!adata)
     return -1;
 
+  if (!adata->newsrc_dirty)
+  {
+    mutt_debug(LL_DEBUG2, "%s is up to date\n", adata->newsrc_file);
+    return 0;
+  }
+
   int rc = -1;
 
   size_t buflen = 10240;
@@ -489,7 +618,7 @@ int nntp_newsrc_update(struct NntpAccountData *adata)
 
   /* newrc being fully rewritten */
   mutt_debug(LL_DEBUG1, "Updating %s\n", adata->newsrc_file);
-  if (adata->newsrc_file && (update_file(adata->newsrc_file, buf) == 0))
+  if (adata->newsrc_file && (update_file(adata->newsrc_file, buf, off) == 0))
   {
     struct stat sb;
 
@@ -503,6 +632,15 @@ int nntp_newsrc_update(struct NntpAccountData *adata)
     {
       mutt_perror(adata->newsrc_file);
     }
+
+    /* the file matches the entries now */
+    for (unsigned int i = 0; i < adata->groups_num; i++)
+    {
+      struct NntpMboxData *mdata = adata->groups_list[i];
+      if (mdata)
+        mdata->newsrc_dirty = false;
+    }
+    adata->newsrc_dirty = false;
   }
   FREE(&buf);
   return rc;
@@ -566,6 +704,32 @@ void nntp_expand_path(char *buf, size_t buflen, struct ConnAccount *cac)
   FREE(&url.path);
 }
 
+/**
+ * add_group - Add a newsgroup to the list, or update it
+ * @param adata   NNTP server
+ * @param group   Newsgroup
+ * @param first   First article number
+ * @param last    Last article number
+ * @param allowed Posting is allowed
+ * @param desc    Description (OPTIONAL)
+ */
+static void add_group(struct NntpAccountData *adata, const char *group,
+                      anum_t first, anum_t last, bool allowed, const char *desc)
+{
+  struct NntpMboxData *mdata = mdata_find(adata, group);
+  mdata->deleted = false;
+  mdata->first_message = first;
+  mdata->last_message = last;
+  mdata->allowed = allowed;
+  mutt_str_replace(&mdata->desc, desc);
+  if (mdata->newsrc_ent || (mdata->last_cached != 0))
+    nntp_group_unread_stat(mdata);
+  else if (mdata->last_message && (mdata->first_message <= mdata->last_message))
+    mdata->unread = mdata->last_message - mdata->first_message + 1;
+  else
+    mdata->unread = 0;
+}
+
 /**
  * nntp_add_group - Parse newsgroup
  * @param line String to parse
@@ -575,7 +739,6 @@ void nntp_expand_path(char *buf, size_t buflen, struct ConnAccount *cac)
 int nntp_add_group(char *line, void *data)
 {
   struct NntpAccountData *adata = data;
-  struct NntpMboxData *mdata = NULL;
   char group[1024] = { 0 };
   char desc[8192] = { 0 };
   char mod;
@@ -592,18 +755,45 @@ int nntp_add_group(char *line, void *data)
     return 0;
   }
 
-  mdata = mdata_find(adata, group);
-  mdata->deleted = false;
-  mdata->first_message = first;
-  mdata->last_message = last;
-  mdata->allowed = (mod == 'y') || (mod == 'm');
-  mutt_str_replace(&mdata->desc, desc);
-  if (mdata->newsrc_ent || (mdata->last_cached != 0))
-    nntp_group_unread_stat(mdata);
-  else if (mdata->last_message && (mdata->first_message <= mdata->last_message))
-    mdata->unread = mdata->last_message - mdata->first_message + 1;
-  else
-    mdata->unread = 0;
+  add_group(adata, group, first, last, (mod == 'y') || (mod == 'm'), desc);
+  return 0;
+}
+
+/**
+ * active_parse_binary - Load the list of newsgroups from the binary cache
+ * @param adata NNTP server
+ * @param map   Contents of the cache
+ * @param size  Size of the cache
+ * @retval  0 Success
+ * @retval -1 Failure
+ */
+static int active_parse_binary(struct NntpAccountData *adata, const char *map, size_t size)
+{
+  struct ActiveCacheHeader hdr;
+  memcpy(&hdr, map, sizeof(hdr));
+  if ((hdr.byte_order != 0x01020304) || (hdr.newgroups_time == 0))
+    return -1;
+  adata->newgroups_time = hdr.newgroups_time;
+
+  size_t off = sizeof(hdr);
+  for (uint32_t i = 0; i < hdr.num_groups; i++)
+  {
+    struct ActiveCacheGroup acg;
+    if ((size - off) < sizeof(acg))
+      return -1;
+    memcpy(&acg, map + off, sizeof(acg));
+    off += sizeof(acg);
+
+    if ((size - off) < ((size_t) acg.group_len + acg.desc_len + 2))
+      return -1;
+    const char *group = map + off;
+    const char *desc = group + acg.group_len + 1;
+    if ((group[acg.group_len] != '\0') || (desc[acg.desc_len] != '\0'))
+      return -1;
+    off += acg.group_len + acg.desc_len + 2;
+
+    add_group(adata, group, acg.first, acg.last, acg.allowed, desc);
+  }
   return 0;
 }
 
@@ -612,12 +802,16 @@ int nntp_add_group(char *line, void *data)
  * @param adata NNTP server
  * @retval  0 Success
  * @retval -1 Failure
+ *
+ * The cache is read directly from memory, see nntp_active_save_cache().
+ * A cache in the old text format is read line by line.
  */
 static int active_get_cache(struct NntpAccountData *adata)
 {
   char buf[8192];
   char file[4096];
   time_t t;
+  struct stat st = { 0 };
 
   cache_expand(file, sizeof(file), &adata->conn->account, ".active");
   mutt_debug(LL_DEBUG1, "Parsing %s\n", file);
@@ -625,6 +819,24 @@ static int active_get_cache(struct NntpAccountData *adata)
   if (!fp)
     return -1;
 
+  if ((fstat(fileno(fp), &st) == 0) && ((size_t) st.st_size >= sizeof(struct ActiveCacheHeader)))
+  {
+    char *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+    if (map != MAP_FAILED)
+    {
+      if (memcmp(map, ACTIVE_CACHE_MAGIC, 8) == 0)
+      {
+        mutt_message(_("Loading list of groups from cache..."));
+        int rc = active_parse_binary(adata, map, st.st_size);
+        munmap(map, st.st_size);
+        mutt_file_fclose(&fp);
+        mutt_clear_error();
+        return rc;
+      }
+      munmap(map, st.st_size);
+    }
+  }
+
   if (!fgets(buf, sizeof(buf), fp) || (sscanf(buf, "%ld%4095s", &t, file) != 1) || (t == 0))
   {
     mutt_file_fclose(&fp);
@@ -646,16 +858,22 @@ static int active_get_cache(struct NntpAccountData *adata)
  * @param adata NNTP server
  * @retval  0 Success
  * @retval -1 Failure
+ *
+ * The list is saved in a binary format, so it can be loaded without parsing
+ * any text.
  */
 int nntp_active_save_cache(struct NntpAccountData *adata)
 {
   if (!adata->cacheable)
     return 0;
 
-  size_t buflen = 10240;
-  char *buf = mutt_mem_calloc(1, buflen);
-  snprintf(buf, buflen, "%lu\n", (unsigned long) adata->newgroups_time);
-  size_t off = strlen(buf);
+  struct ActiveCacheHeader hdr = { { 0 } };
+  memcpy(hdr.magic, ACTIVE_CACHE_MAGIC, sizeof(hdr.magic));
+  hdr.byte_order = 0x01020304;
+  hdr.newgroups_time = adata->newgroups_time;
+
+  struct Buffer buf = mutt_buffer_make(10240);
+  mutt_buffer_addstr_n(&buf, (const char *) &hdr, sizeof(hdr));
 
   for (unsigned int i = 0; i < adata->groups_num; i++)
   {
@@ -664,22 +882,30 @@ int nntp_active_save_cache(struct NntpAccountData *adata)
     if (!mdata || mdata->deleted)
       continue;
 
-    if ((off + strlen(mdata->group) + (mdata->desc ? strlen(mdata->desc) : 0) + 50) > buflen)
-    {
-      buflen *= 2;
-      mutt_mem_realloc(&buf, buflen);
-    }
-    snprintf(buf + off, buflen - off, "%s %u %u %c%s%s\n", mdata->group,
-             mdata->last_message, mdata->first_message, mdata->allowed ? 'y' : 'n',
-             mdata->desc ? " " : "", mdata->desc ? mdata->desc : "");
-    off += strlen(buf + off);
+    size_t group_len = mutt_str_len(mdata->group);
+    size_t desc_len = mutt_str_len(mdata->desc);
+    if ((group_len > UINT16_MAX) || (desc_len > UINT32_MAX))
+      continue;
+
+    struct ActiveCacheGroup acg = { 0 };
+    acg.first = mdata->first_message;
+    acg.last = mdata->last_message;
+    acg.desc_len = desc_len;
+    acg.group_len = group_len;
+    acg.allowed = mdata->allowed;
+
+    mutt_buffer_addstr_n(&buf, (const char *) &acg, sizeof(acg));
+    mutt_buffer_addstr_n(&buf, mdata->group, group_len + 1);
+    mutt_buffer_addstr_n(&buf, NONULL(mdata->desc), desc_len + 1);
+    hdr.num_groups++;
   }
+  memcpy(buf.data, &hdr, sizeof(hdr));
 
   char file[PATH_MAX];
   cache_expand(file, sizeof(file), &adata->conn->account, ".active");
   mutt_debug(LL_DEBUG1, "Updating %s\n", file);
-  int rc = update_file(file, buf);
-  FREE(&buf);
+  int rc = update_file(file, buf.data, mutt_buffer_len(&buf));
+  mutt_buffer_dealloc(&buf);
   return rc;
 }
 
@@ -1259,6 +1485,8 @@ struct NntpMboxData *mutt_newsgroup_subscribe(struct NntpAccountData *adata, cha
     return NULL;
 
   struct NntpMboxData *mdata = mdata_find(adata, group);
+  if (!mdata->subscribed || !mdata->newsrc_ent)
+    nntp_newsrc_dirty(mdata);
   mdata->subscribed = true;
   if (!mdata->newsrc_ent)
   {
@@ -1286,6 +1514,8 @@ struct NntpMboxData *mutt_newsgroup_unsubscribe(struct NntpAccountData *adata, c
   if (!mdata)
     return NULL;
 
+  if (mdata->subscribed || mdata->newsrc_ent)
+    nntp_newsrc_dirty(mdata);
   mdata->subscribed = false;
   const bool c_save_unsubscribed =
       cs_subset_bool(NeoMutt->sub, "save_unsubscribed");
@@ -1321,6 +1551,7 @@ struct NntpMboxData *mutt_newsgroup_catchup(struct Mailbox *m,
     mdata->newsrc_len = 1;
     mdata->newsrc_ent[0].first = 1;
     mdata->newsrc_ent[0].last = mdata->last_message;
+    nntp_newsrc_dirty(mdata);
   }
   mdata->unread = 0;
   if (m && (m->mdata == mdata))
@@ -1360,6 +1591,7 @@ struct NntpMboxData *mutt_newsgroup_uncatchup(struct Mailbox *m,
     mdata->newsrc_len = 1;
     mdata->newsrc_ent[0].first = 1;
     mdata->newsrc_ent[0].last = mdata->first_message - 1;
+    nntp_newsrc_dirty(mdata);
   }
   if (m && (m->mdata == mdata))
   {
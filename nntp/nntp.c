@@ -99,6 +99,15 @@ struct FetchCtx
   struct HeaderCache *hc;
 };
 
+/**
+ * struct HeadCtx - Keep track when getting headers with HEAD
+ */
+struct HeadCtx
+{
+  struct FetchCtx *fc; ///< Fetch context
+  FILE *fp;            ///< Temporary file for the header
+};
+
 /**
  * struct ChildCtx - Keep track of the children of an article
  */
@@ -151,6 +160,7 @@ static int nntp_capabilities(struct NntpAccountData *adata)
   adata->hasLISTGROUP = false;
   adata->hasLISTGROUPrange = false;
   adata->hasOVER = false;
+  adata->hasCOMPRESS = false;
   FREE(&adata->authenticators);
 
   if ((mutt_socket_send(conn, "CAPABILITIES\r\n") < 0) ||
@@ -196,6 +206,12 @@ static int nntp_capabilities(struct NntpAccountData *adata)
 #endif
     else if (mutt_str_equal("OVER", buf))
       adata->hasOVER = true;
+    else if ((plen = mutt_str_startswith(buf, "COMPRESS ")))
+    {
+      mutt_str_cat(buf, sizeof(buf), " ");
+      if (strcasestr(buf + plen - 1, " DEFLATE "))
+        adata->hasCOMPRESS = true;
+    }
     else if (mutt_str_startswith(buf, "LIST "))
     {
       char *p = strstr(buf, " NEWSGROUPS");
@@ -701,6 +717,7 @@ static int nntp_query(struct NntpMboxData *mdata, char *line, size_t linelen)
     {
       int rc = 0;
 
+      const uint64_t start = mutt_date_monotonic_us();
       if (*line)
         rc = mutt_socket_send(adata->conn, line);
       else if (mdata->group)
@@ -711,7 +728,10 @@ static int nntp_query(struct NntpMboxData *mdata, char *line, size_t linelen)
       if (rc >= 0)
         rc = mutt_socket_readln(buf, sizeof(buf), adata->conn);
       if (rc >= 0)
+      {
+        mutt_socket_rtt(adata->conn, mutt_date_monotonic_us() - start);
         break;
+      }
     }
 
     /* reconnect */
@@ -748,6 +768,70 @@ static int nntp_query(struct NntpMboxData *mdata, char *line, size_t linelen)
   return 0;
 }
 
+/**
+ * nntp_fetch_body - Read the lines of a multi-line answer
+ * @param mdata    NNTP Mailbox data
+ * @param progress Progress bar (OPTIONAL)
+ * @param func     Callback function
+ * @param data     Data for callback function
+ * @retval  0 Success
+ * @retval -1 Connection lost
+ * @retval -2 Error in func(*line, *data)
+ *
+ * The answer's status line must already have been read.  func(*line, *data)
+ * is called for each line, then func(NULL, *data) at the end.
+ */
+static int nntp_fetch_body(struct NntpMboxData *mdata, struct Progress *progress,
+                           int (*func)(char *, void *), void *data)
+{
+  char buf[1024];
+  unsigned int lines = 0;
+  size_t off = 0;
+  int rc = 0;
+
+  char *line = mutt_mem_malloc(sizeof(buf));
+
+  while (true)
+  {
+    char *p = NULL;
+    int chunk = mutt_socket_readln_d(buf, sizeof(buf), mdata->adata->conn, MUTT_SOCK_LOG_FULL);
+    if (chunk < 0)
+    {
+      mdata->adata->status = NNTP_NONE;
+      rc = -1;
+      break;
+    }
+
+    p = buf;
+    if (!off && (buf[0] == '.'))
+    {
+      if (buf[1] == '\0')
+        break;
+      if (buf[1] == '.')
+        p++;
+    }
+
+    mutt_str_copy(line + off, p, sizeof(buf));
+
+    if (chunk >= sizeof(buf))
+      off += strlen(p);
+    else
+    {
+      if (progress)
+        mutt_progress_update(progress, ++lines, -1);
+
+      if ((rc == 0) && (func(line, data) < 0))
+        rc = -2;
+      off = 0;
+    }
+
+    mutt_mem_realloc(&line, off + sizeof(buf));
+  }
+  FREE(&line);
+  func(NULL, data);
+  return rc;
+}
+
 /**
  * nntp_fetch_lines - Read lines, calling a callback function for each
  * @param mdata NNTP Mailbox data
@@ -767,15 +851,11 @@ static int nntp_query(struct NntpMboxData *mdata, char *line, size_t linelen)
 static int nntp_fetch_lines(struct NntpMboxData *mdata, char *query, size_t qlen,
                             const char *msg, int (*func)(char *, void *), void *data)
 {
-  bool done = false;
   int rc;
 
-  while (!done)
+  while (true)
   {
     char buf[1024];
-    char *line = NULL;
-    unsigned int lines = 0;
-    size_t off = 0;
     struct Progress progress;
 
     if (msg)
@@ -790,50 +870,91 @@ static int nntp_fetch_lines(struct NntpMboxData *mdata, char *query, size_t qlen
       return 1;
     }
 
-    line = mutt_mem_malloc(sizeof(buf));
-    rc = 0;
+    rc = nntp_fetch_body(mdata, msg ? &progress : NULL, func, data);
+    if (rc != -1)
+      break;
+  }
+  return rc;
+}
 
-    while (true)
-    {
-      char *p = NULL;
-      int chunk = mutt_socket_readln_d(buf, sizeof(buf), mdata->adata->conn, MUTT_SOCK_LOG_FULL);
-      if (chunk < 0)
-      {
-        mdata->adata->status = NNTP_NONE;
-        break;
-      }
+/**
+ * nntp_fetch_pipelined - Fetch a batch of articles, sending the commands ahead
+ * @param mdata  NNTP Mailbox data
+ * @param cmd    Command, e.g. "HEAD"
+ * @param nums   Article numbers
+ * @param num    Number of articles
+ * @param func   Callback for each line of an answer
+ * @param answer Callback for each answer, given its article number and, if it failed, its status line
+ * @param data   Data for the callbacks
+ * @retval  0 Success
+ * @retval -1 Connection lost
+ * @retval -2 Error in a callback
+ *
+ * RFC3977 servers accept more commands while they're answering earlier ones,
+ * so up to `$nntp_pipeline_depth` commands are sent before the first answer
+ * is read.  This saves a round trip for each article.
+ *
+ * If the connection is lost, the rest of the commands are sent one at a
+ * time, using nntp_fetch_lines(), which reconnects.
+ */
+static int nntp_fetch_pipelined(struct NntpMboxData *mdata, const char *cmd,
+                                const anum_t *nums, size_t num,
+                                int (*func)(char *, void *),
+                                int (*answer)(anum_t, const char *, void *), void *data)
+{
+  struct NntpAccountData *adata = mdata->adata;
+  char buf[1024];
+  size_t sent = 0;
+  size_t done = 0;
+  int rc = 0;
 
-      p = buf;
-      if (!off && (buf[0] == '.'))
+  const short c_nntp_pipeline_depth = cs_subset_number(NeoMutt->sub, "nntp_pipeline_depth");
+  if ((c_nntp_pipeline_depth > 1) && adata->hasCAPABILITIES && (adata->status == NNTP_OK))
+  {
+    while (done < num)
+    {
+      for (; (sent < num) && ((sent - done) < c_nntp_pipeline_depth); sent++)
       {
-        if (buf[1] == '\0')
-        {
-          done = true;
+        snprintf(buf, sizeof(buf), "%s %u\r\n", cmd, nums[sent]);
+        if (mutt_socket_send(adata->conn, buf) < 0)
           break;
-        }
-        if (buf[1] == '.')
-          p++;
       }
+      if (sent == done)
+        break;
 
-      mutt_str_copy(line + off, p, sizeof(buf));
+      if (mutt_socket_readln(buf, sizeof(buf), adata->conn) < 0)
+        break;
 
-      if (chunk >= sizeof(buf))
-        off += strlen(p);
-      else
+      if (buf[0] == '2')
       {
-        if (msg)
-          mutt_progress_update(&progress, ++lines, -1);
-
-        if ((rc == 0) && (func(line, data) < 0))
-          rc = -2;
-        off = 0;
+        int rc2 = nntp_fetch_body(mdata, NULL, func, data);
+        if (rc2 == -1)
+          break;
+        if (rc2 < 0)
+          rc = rc2;
       }
 
-      mutt_mem_realloc(&line, off + sizeof(buf));
+      if ((rc == 0) && (answer(nums[done], (buf[0] == '2') ? NULL : buf, data) < 0))
+        rc = -2;
+      done++;
+    }
+
+    if (done < num)
+    {
+      mutt_debug(LL_DEBUG1, "connection lost after %zu of %zu answers\n", done, num);
+      adata->status = NNTP_NONE;
     }
-    FREE(&line);
-    func(NULL, data);
   }
+
+  for (; (done < num) && (rc == 0); done++)
+  {
+    snprintf(buf, sizeof(buf), "%s %u\r\n", cmd, nums[done]);
+    rc = nntp_fetch_lines(mdata, buf, sizeof(buf), NULL, func, data);
+    if (rc < 0)
+      break;
+    rc = (answer(nums[done], (rc == 0) ? NULL : buf, data) < 0) ? -2 : 0;
+  }
+
   return rc;
 }
 
@@ -983,6 +1104,38 @@ static int fetch_numbers(char *line, void *data)
   return 0;
 }
 
+/**
+ * fetch_save_email - Add a fetched Email to the Mailbox
+ * @param fc   FetchCtx
+ * @param e    Email
+ * @param anum Article number
+ */
+static void fetch_save_email(struct FetchCtx *fc, struct Email *e, anum_t anum)
+{
+  struct Mailbox *m = fc->mailbox;
+  struct NntpMboxData *mdata = m->mdata;
+
+  mx_alloc_memory(m, m->msg_count + 1);
+  m->emails[m->msg_count] = e;
+  e->index = m->msg_count++;
+  e->read = false;
+  e->old = false;
+  e->deleted = false;
+  e->edata = nntp_edata_new();
+  e->edata_free = nntp_edata_free;
+  nntp_edata_get(e)->article_num = anum;
+  if (fc->restore)
+    e->changed = true;
+  else
+  {
+    nntp_article_status(m, e, NULL, anum);
+    if (!e->read)
+      nntp_parse_xref(m, e);
+  }
+  if (anum > mdata->last_loaded)
+    mdata->last_loaded = anum;
+}
+
 /**
  * parse_overview_line - Parse overview line
  * @param line String to parse
@@ -1027,63 +1180,21 @@ static int parse_overview_line(char *line, void *data)
     return 0;
   }
 
-  /* convert overview line to header */
-  FILE *fp = mutt_file_mkstemp();
-  if (!fp)
-    return -1;
-
-  header = mdata->adata->overview_fmt;
-  while (field)
-  {
-    char *b = field;
-
-    if (*header)
-    {
-      if (!strstr(header, ":full") && (fputs(header, fp) == EOF))
-      {
-        mutt_file_fclose(&fp);
-        return -1;
-      }
-      header = strchr(header, '\0') + 1;
-    }
-
-    field = strchr(field, '\t');
-    if (field)
-      *field++ = '\0';
-    if ((fputs(b, fp) == EOF) || (fputc('\n', fp) == EOF))
-    {
-      mutt_file_fclose(&fp);
-      return -1;
-    }
-  }
-  rewind(fp);
-
   /* allocate memory for headers */
-  if (m->msg_count >= m->email_max)
-    mx_alloc_memory(m);
-
-  /* parse header */
-  m->emails[m->msg_count] = email_new();
-  e = m->emails[m->msg_count];
-  e->env = mutt_rfc822_read_header(fp, e, false, false);
-  e->env->newsgroups = mutt_str_dup(mdata->group);
-  e->received = e->date_sent;
-  mutt_file_fclose(&fp);
+  mx_alloc_memory(m, m->msg_count + 1);
 
 #ifdef USE_HCACHE
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u", anum);
+
+  /* the cached header saves parsing the overview */
   if (fc->hc)
   {
-    char buf[16];
-
-    /* try to replace with header from cache */
-    snprintf(buf, sizeof(buf), "%u", anum);
     struct HCacheEntry hce = mutt_hcache_fetch(fc->hc, buf, strlen(buf), 0);
     if (hce.email)
     {
       mutt_debug(LL_DEBUG2, "mutt_hcache_fetch %s\n", buf);
-      email_free(&e);
       e = hce.email;
-      m->emails[m->msg_count] = e;
       e->edata = NULL;
       e->read = false;
       e->old = false;
@@ -1099,36 +1210,53 @@ static int parse_overview_line(char *line, void *data)
         save = false;
       }
     }
+  }
+
+  if (!e)
+#endif
+  {
+    /* parse the overview's fields as header lines */
+    e = email_new();
+    e->env = mutt_env_new();
 
+    struct Buffer *hdr = mutt_buffer_pool_get();
+    header = mdata->adata->overview_fmt;
+    while (field)
+    {
+      char *b = field;
+
+      mutt_buffer_reset(hdr);
+      if (*header)
+      {
+        if (!strstr(header, ":full"))
+          mutt_buffer_addstr(hdr, header);
+        header = strchr(header, '\0') + 1;
+      }
+
+      field = strchr(field, '\t');
+      if (field)
+        *field++ = '\0';
+      mutt_buffer_addstr(hdr, b);
+      mutt_rfc822_parse_header(e->env, e, hdr->data, false, false);
+    }
+    mutt_buffer_pool_release(&hdr);
+
+    mutt_rfc822_finish_header(e->env, e);
+    e->env->newsgroups = mutt_str_dup(mdata->group);
+    e->received = e->date_sent;
+
+#ifdef USE_HCACHE
     /* not cached yet, store header */
-    else
+    if (fc->hc)
     {
       mutt_debug(LL_DEBUG2, "mutt_hcache_store %s\n", buf);
       mutt_hcache_store(fc->hc, buf, strlen(buf), e, 0);
     }
-  }
 #endif
+  }
 
   if (save)
-  {
-    e->index = m->msg_count++;
-    e->read = false;
-    e->old = false;
-    e->deleted = false;
-    e->edata = nntp_edata_new();
-    e->edata_free = nntp_edata_free;
-    nntp_edata_get(e)->article_num = anum;
-    if (fc->restore)
-      e->changed = true;
-    else
-    {
-      nntp_article_status(m, e, NULL, anum);
-      if (!e->read)
-        nntp_parse_xref(m, e);
-    }
-    if (anum > mdata->last_loaded)
-      mdata->last_loaded = anum;
-  }
+    fetch_save_email(fc, e, anum);
   else
     email_free(&e);
 
@@ -1138,6 +1266,112 @@ static int parse_overview_line(char *line, void *data)
   return 0;
 }
 
+/**
+ * fetch_overview_answer - Check the answer to an OVER command
+ * @param anum Article number
+ * @param err  Status line, if the command failed
+ * @param data FetchCtx
+ * @retval  0 Success, or no such article
+ * @retval -1 Invalid response
+ */
+static int fetch_overview_answer(anum_t anum, const char *err, void *data)
+{
+  struct FetchCtx *fc = data;
+  struct NntpMboxData *mdata = fc->mailbox->mdata;
+
+  if (!err || mutt_str_startswith(err, "423"))
+    return 0;
+
+  mutt_error("%s: %s", mdata->adata->hasOVER ? "OVER" : "XOVER", err);
+  return -1;
+}
+
+/**
+ * fetch_head_line - Save a header line from a HEAD command
+ * @param line Header line
+ * @param data HeadCtx
+ * @retval  0 Success
+ * @retval -1 Failure
+ */
+static int fetch_head_line(char *line, void *data)
+{
+  struct HeadCtx *hc = data;
+  return fetch_tempfile(line, hc->fp);
+}
+
+/**
+ * fetch_head_answer - Parse the header fetched with a HEAD command
+ * @param anum Article number
+ * @param err  Status line, if the command failed
+ * @param data HeadCtx
+ * @retval  0 Success, or no such article
+ * @retval -1 Invalid response
+ */
+static int fetch_head_answer(anum_t anum, const char *err, void *data)
+{
+  struct HeadCtx *hc = data;
+  struct NntpMboxData *mdata = hc->fc->mailbox->mdata;
+
+  if (err)
+  {
+    /* invalid response */
+    if (!mutt_str_startswith(err, "423"))
+    {
+      mutt_error("HEAD: %s", err);
+      return -1;
+    }
+
+    /* no such article */
+    if (mdata->bcache)
+    {
+      char buf[16];
+      snprintf(buf, sizeof(buf), "%u", anum);
+      mutt_debug(LL_DEBUG2, "#3 mutt_bcache_del %s\n", buf);
+      mutt_bcache_del(mdata->bcache, buf);
+    }
+    return 0;
+  }
+
+  /* parse header */
+  struct Email *e = email_new();
+  e->env = mutt_rfc822_read_header(hc->fp, e, false, false);
+  e->received = e->date_sent;
+  fetch_save_email(hc->fc, e, anum);
+
+  /* empty the file for the next header */
+  rewind(hc->fp);
+  if (ftruncate(fileno(hc->fp), 0) != 0)
+    return -1;
+  return 0;
+}
+
+/**
+ * fetch_heads - Fetch headers from the server with HEAD
+ * @param fc   FetchCtx
+ * @param nums Article numbers
+ * @param num  Number of articles
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * For servers that don't support OVER/XOVER.  The commands are pipelined.
+ */
+static int fetch_heads(struct FetchCtx *fc, const anum_t *nums, size_t num)
+{
+  struct HeadCtx hc = { fc, NULL };
+
+  hc.fp = mutt_file_mkstemp();
+  if (!hc.fp)
+  {
+    mutt_perror(_("Can't create temporary file"));
+    return -1;
+  }
+
+  int rc = nntp_fetch_pipelined(fc->mailbox->mdata, "HEAD", nums, num,
+                                fetch_head_line, fetch_head_answer, &hc);
+  mutt_file_fclose(&hc.fp);
+  return (rc == 0) ? 0 : -1;
+}
+
 /**
  * nntp_fetch_headers - Fetch headers
  * @param m       Mailbox
@@ -1160,6 +1394,8 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
   int rc = 0;
   anum_t current;
   anum_t first_over = first;
+  anum_t *heads = NULL;
+  size_t num_heads = 0;
 
   /* if empty group or nothing to do */
   if (!last || (first > last))
@@ -1174,6 +1410,9 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
   if (!fc.messages)
     return -1;
   fc.hc = hc;
+#ifdef USE_HCACHE
+  mutt_hcache_begin_txn(fc.hc);
+#endif
 
   /* fetch list of articles */
   const bool c_nntp_listgroup = cs_subset_bool(NeoMutt->sub, "nntp_listgroup");
@@ -1240,8 +1479,7 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
       continue;
 
     /* allocate memory for headers */
-    if (m->msg_count >= m->email_max)
-      mx_alloc_memory(m);
+    mx_alloc_memory(m, m->msg_count + 1);
 
 #ifdef USE_HCACHE
     /* try to fetch header from cache */
@@ -1285,72 +1523,28 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
         continue;
     }
 
-    /* fetch header from server */
+    /* fetch header from server, below */
     else
     {
-      FILE *fp = mutt_file_mkstemp();
-      if (!fp)
-      {
-        mutt_perror(_("Can't create temporary file"));
-        rc = -1;
-        break;
-      }
-
-      snprintf(buf, sizeof(buf), "HEAD %u\r\n", current);
-      rc = nntp_fetch_lines(mdata, buf, sizeof(buf), NULL, fetch_tempfile, fp);
-      if (rc)
-      {
-        mutt_file_fclose(&fp);
-        if (rc < 0)
-          break;
-
-        /* invalid response */
-        if (!mutt_str_startswith(buf, "423"))
-        {
-          mutt_error("HEAD: %s", buf);
-          break;
-        }
-
-        /* no such article */
-        if (mdata->bcache)
-        {
-          snprintf(buf, sizeof(buf), "%u", current);
-          mutt_debug(LL_DEBUG2, "#3 mutt_bcache_del %s\n", buf);
-          mutt_bcache_del(mdata->bcache, buf);
-        }
-        rc = 0;
-        continue;
-      }
-
-      /* parse header */
-      m->emails[m->msg_count] = email_new();
-      e = m->emails[m->msg_count];
-      e->env = mutt_rfc822_read_header(fp, e, false, false);
-      e->received = e->date_sent;
-      mutt_file_fclose(&fp);
+      if (!heads)
+        heads = mutt_mem_calloc(last - current + 1, sizeof(anum_t));
+      heads[num_heads++] = current;
+      first_over = current + 1;
+      continue;
     }
 
     /* save header in context */
-    e->index = m->msg_count++;
-    e->read = false;
-    e->old = false;
-    e->deleted = false;
-    e->edata = nntp_edata_new();
-    e->edata_free = nntp_edata_free;
-    nntp_edata_get(e)->article_num = current;
-    if (restore)
-      e->changed = true;
-    else
-    {
-      nntp_article_status(m, e, NULL, nntp_edata_get(e)->article_num);
-      if (!e->read)
-        nntp_parse_xref(m, e);
-    }
-    if (current > mdata->last_loaded)
-      mdata->last_loaded = current;
+    fetch_save_email(&fc, e, current);
     first_over = current + 1;
   }
 
+  /* fetch the headers that aren't cached, all at once */
+  if (num_heads > 0)
+  {
+    rc = fetch_heads(&fc, heads, num_heads);
+    FREE(&heads);
+  }
+
   if (!c_nntp_listgroup || !mdata->adata->hasLISTGROUP)
     current = first_over;
 
@@ -1367,12 +1561,102 @@ static int nntp_fetch_headers(struct Mailbox *m, void *hc, anum_t first, anum_t
   }
 
   FREE(&fc.messages);
+#ifdef USE_HCACHE
+  mutt_hcache_commit_txn(fc.hc);
+#endif
   if (rc != 0)
     return -1;
   mutt_clear_error();
   return 0;
 }
 
+/**
+ * nntp_fetch_list - Fetch the headers of a list of articles
+ * @param m    Mailbox
+ * @param hc   Header cache
+ * @param nums Article numbers
+ * @param num  Number of articles
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * The articles needn't be consecutive, e.g. the children of an article.
+ * Headers that aren't cached are fetched with pipelined OVER or HEAD
+ * commands, rather than one command, and one round trip, per article.
+ * Articles that are listed as deleted are restored.
+ */
+static int nntp_fetch_list(struct Mailbox *m, void *hc, const anum_t *nums, size_t num)
+{
+  struct NntpMboxData *mdata = m->mdata;
+  struct FetchCtx fc = { 0 };
+  int rc = 0;
+
+  if ((num == 0) || mdata->deleted)
+    return 0;
+
+  fc.mailbox = m;
+  fc.first = nums[0];
+  fc.last = nums[0];
+  for (size_t i = 1; i < num; i++)
+  {
+    if (nums[i] < fc.first)
+      fc.first = nums[i];
+    if (nums[i] > fc.last)
+      fc.last = nums[i];
+  }
+  fc.restore = true;
+  fc.messages = mutt_mem_calloc(fc.last - fc.first + 1, sizeof(unsigned char));
+  fc.hc = hc;
+#ifdef USE_HCACHE
+  mutt_hcache_begin_txn(fc.hc);
+#endif
+
+  anum_t *missing = mutt_mem_calloc(num, sizeof(anum_t));
+  size_t num_missing = 0;
+  for (size_t i = 0; i < num; i++)
+  {
+    if (fc.messages[nums[i] - fc.first])
+      continue;
+    fc.messages[nums[i] - fc.first] = 1;
+
+#ifdef USE_HCACHE
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u", nums[i]);
+    struct HCacheEntry hce = mutt_hcache_fetch(fc.hc, buf, strlen(buf), 0);
+    if (hce.email)
+    {
+      mutt_debug(LL_DEBUG2, "mutt_hcache_fetch %s\n", buf);
+      hce.email->edata = NULL;
+      fetch_save_email(&fc, hce.email, nums[i]);
+      continue;
+    }
+#endif
+    missing[num_missing++] = nums[i];
+  }
+
+  if (num_missing > 0)
+  {
+    if (mdata->adata->hasOVER || mdata->adata->hasXOVER)
+    {
+      rc = nntp_fetch_pipelined(mdata, mdata->adata->hasOVER ? "OVER" : "XOVER",
+                                missing, num_missing, parse_overview_line,
+                                fetch_overview_answer, &fc);
+      if (rc != 0)
+        rc = -1;
+    }
+    else
+    {
+      rc = fetch_heads(&fc, missing, num_missing);
+    }
+  }
+
+  FREE(&missing);
+  FREE(&fc.messages);
+#ifdef USE_HCACHE
+  mutt_hcache_commit_txn(fc.hc);
+#endif
+  return rc;
+}
+
 /**
  * nntp_group_poll - Check newsgroup for new articles
  * @param mdata NNTP Mailbox data
@@ -1404,6 +1688,7 @@ static int nntp_group_poll(struct NntpMboxData *mdata, bool update_stat)
       mdata->newsrc_len = 1;
       mdata->newsrc_ent[0].first = 1;
       mdata->newsrc_ent[0].last = 0;
+      nntp_newsrc_dirty(mdata);
     }
   }
   mdata->first_message = first;
@@ -1508,7 +1793,7 @@ static enum MxStatus check_mailbox(struct Mailbox *m)
           messages[anum - first] = 1;
 
         snprintf(buf, sizeof(buf), "%u", anum);
-        struct HCacheEntry hce = mutt_hcache_fetch(hc, buf, strlen(buf), 0);
+        struct HCacheEntry hce = mutt_hcache_fetch_stub(hc, buf, strlen(buf), 0);
         if (hce.email)
         {
           bool deleted;
@@ -1557,8 +1842,7 @@ static enum MxStatus check_mailbox(struct Mailbox *m)
       if (hce.email)
       {
         mutt_debug(LL_DEBUG2, "#2 mutt_hcache_fetch %s\n", buf);
-        if (m->msg_count >= m->email_max)
-          mx_alloc_memory(m);
+        mx_alloc_memory(m, m->msg_count + 1);
 
         e = hce.email;
         m->emails[m->msg_count] = e;
@@ -1857,6 +2141,29 @@ int nntp_open_connection(struct NntpAccountData *adata)
     }
   }
 
+#ifdef USE_ZLIB
+  /* RFC8054 */
+  const bool c_nntp_deflate = cs_subset_bool(NeoMutt->sub, "nntp_deflate");
+  if (adata->hasCOMPRESS && c_nntp_deflate)
+  {
+    if ((mutt_socket_send(conn, "COMPRESS DEFLATE\r\n") < 0) ||
+        (mutt_socket_readln(buf, sizeof(buf), conn) < 0))
+    {
+      return nntp_connect_error(adata);
+    }
+    if (mutt_str_startswith(buf, "206"))
+    {
+      mutt_debug(LL_DEBUG2, "NNTP compression is enabled on connection to %s\n",
+                 conn->account.host);
+      mutt_zstrm_wrap_conn(conn);
+    }
+    else
+    {
+      mutt_debug(LL_DEBUG2, "COMPRESS: %s\n", buf);
+    }
+  }
+#endif
+
   /* attempt features */
   if (nntp_attempt_features(adata) < 0)
     return -1;
@@ -2160,8 +2467,7 @@ int nntp_check_msgid(struct Mailbox *m, const char *msgid)
   }
 
   /* parse header */
-  if (m->msg_count == m->email_max)
-    mx_alloc_memory(m);
+  mx_alloc_memory(m, m->msg_count + 1);
   m->emails[m->msg_count] = email_new();
   struct Email *e = m->emails[m->msg_count];
   e->edata = nntp_edata_new();
@@ -2250,12 +2556,7 @@ int nntp_check_children(struct Mailbox *m, const char *msgid)
   hc = nntp_hcache_open(mdata);
 #endif
   int old_msg_count = m->msg_count;
-  for (int i = 0; i < cc.num; i++)
-  {
-    rc = nntp_fetch_headers(m, hc, cc.child[i], cc.child[i], true);
-    if (rc < 0)
-      break;
-  }
+  rc = nntp_fetch_list(m, hc, cc.child, cc.num);
   if (m->msg_count > old_msg_count)
     mailbox_changed(m, NT_MAILBOX_INVALID);
 
@@ -2391,6 +2692,7 @@ static enum MxOpenReturns nntp_mbox_open(struct Mailbox *m)
     {
       FREE(&mdata->newsrc_ent);
       mdata->newsrc_len = 0;
+      nntp_newsrc_dirty(mdata);
       nntp_delete_group_cache(mdata);
       nntp_newsrc_update(adata);
     }
@@ -2757,9 +3059,11 @@ struct MxOps MxNntpOps = {
   .mbox_sync        = nntp_mbox_sync,
   .mbox_close       = nntp_mbox_close,
   .msg_open         = nntp_msg_open,
+  .msg_prefetch     = NULL,
   .msg_open_new     = NULL,
   .msg_commit       = NULL,
   .msg_close        = nntp_msg_close,
+  .msg_append_batch = NULL,
   .msg_padding_size = NULL,
   .msg_save_hcache  = NULL,
   .tags_edit        = NULL,
@@ -58,6 +58,7 @@ void                    nntp_hash_destructor_t (int type, void *obj, intptr_t da
 void                    nntp_hashelem_free     (int type, void *obj, intptr_t data);
 struct HeaderCache *    nntp_hcache_open       (struct NntpMboxData *mdata);
 void                    nntp_hcache_update     (struct NntpMboxData *mdata, struct HeaderCache *hc);
+void                    nntp_newsrc_dirty      (struct NntpMboxData *mdata);
 void                    nntp_newsrc_gen_entries(struct Mailbox *m);
 int                     nntp_open_connection   (struct NntpAccountData *adata);
 
@@ -34,6 +34,7 @@ struct Mailbox;
 struct NmAccountData
 {
   notmuch_database_t *db;
+  int trans_changes;   ///< Changes made in the current transaction
   bool longrun : 1;    ///< A long-lived action is in progress
   bool trans : 1;      ///< Atomic transaction in progress
 };
@@ -48,6 +48,9 @@ static struct ConfigDef NotmuchVars[] = {
   { "nm_open_timeout", DT_NUMBER|DT_NOT_NEGATIVE, 5, 0, NULL,
     "(notmuch) Database timeout"
   },
+  { "nm_query_page_size", DT_NUMBER|DT_NOT_NEGATIVE, 0, 0, NULL,
+    "(notmuch) Number of messages to load at a time"
+  },
   { "nm_query_type", DT_STRING, IP "messages", 0, NULL,
     "(notmuch) Default query type: 'threads' or 'messages'"
   },
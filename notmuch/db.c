@@ -43,6 +43,36 @@
 #include "mdata.h"
 #include "mutt_logging.h"
 
+/// Number of changes to commit at once, within a long transaction
+#define NM_DB_TRANS_BATCH 1000
+
+static notmuch_database_t *SnapshotDb = NULL; ///< Shared read-only database
+static char *SnapshotFilename = NULL;         ///< Filename of SnapshotDb
+static time_t SnapshotMtime = 0;              ///< Modification time of SnapshotDb when it was (re)opened
+static unsigned long SnapshotRevision = 0;    ///< Revision of SnapshotDb
+static struct HashTable *SnapshotCounts = NULL; ///< Cached results of count queries on SnapshotDb
+
+/**
+ * db_file_mtime - Get the modification time of a database's files
+ * @param[in]  filename Database filename
+ * @param[out] mtime    Save the modification time
+ * @retval  0 Success (result in mtime)
+ * @retval -1 Error
+ */
+static int db_file_mtime(const char *filename, time_t *mtime)
+{
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s/.notmuch/xapian", filename);
+  mutt_debug(LL_DEBUG2, "nm: checking '%s' mtime\n", path);
+
+  struct stat st;
+  if (stat(path, &st) != 0)
+    return -1;
+
+  *mtime = st.st_mtime;
+  return 0;
+}
+
 /**
  * nm_db_get_filename - Get the filename of the Notmuch database
  * @param m Mailbox
@@ -210,6 +240,10 @@ void nm_db_free(notmuch_database_t *db)
  * @retval <0 error
  * @retval 1  new transaction started
  * @retval 0  already within transaction
+ *
+ * Within a long transaction, see nm_db_longrun_init(), each call counts as a
+ * change.  Every #NM_DB_TRANS_BATCH changes, the transaction is committed and
+ * a new one is started.
  */
 int nm_db_trans_begin(struct Mailbox *m)
 {
@@ -218,12 +252,27 @@ int nm_db_trans_begin(struct Mailbox *m)
     return -1;
 
   if (adata->trans)
+  {
+    /* Commit a long transaction in batches, to limit its memory use */
+    if (++adata->trans_changes >= NM_DB_TRANS_BATCH)
+    {
+      mutt_debug(LL_DEBUG2, "nm: db trans commit batch\n");
+      adata->trans_changes = 0;
+      if (notmuch_database_end_atomic(adata->db) ||
+          notmuch_database_begin_atomic(adata->db))
+      {
+        adata->trans = false;
+        return -1;
+      }
+    }
     return 0;
+  }
 
   mutt_debug(LL_DEBUG2, "nm: db trans start\n");
   if (notmuch_database_begin_atomic(adata->db))
     return -1;
   adata->trans = true;
+  adata->trans_changes = 0;
   return 1;
 }
 
@@ -265,16 +314,138 @@ int nm_db_get_mtime(struct Mailbox *m, time_t *mtime)
   if (!m || !mtime)
     return -1;
 
-  char path[PATH_MAX];
-  snprintf(path, sizeof(path), "%s/.notmuch/xapian", nm_db_get_filename(m));
-  mutt_debug(LL_DEBUG2, "nm: checking '%s' mtime\n", path);
+  return db_file_mtime(nm_db_get_filename(m), mtime);
+}
 
-  struct stat st;
-  if (stat(path, &st) != 0)
-    return -1;
+/**
+ * nm_db_get_snapshot - Get a read-only database that's kept open
+ * @param filename Database filename
+ * @retval ptr  Notmuch database
+ * @retval NULL Error
+ *
+ * Opening the database means reloading the Xapian metadata.  Callers that only
+ * read, e.g. nm_mbox_check_stats() for every Mailbox in the sidebar, share a
+ * read-only handle that stays open.  It's only reopened when the database has
+ * been changed, i.e. its modification time and then its revision differ.
+ *
+ * A read-only handle doesn't take the write lock, so it doesn't block any
+ * writers, including our own nm_db_get().
+ *
+ * @note The database must not be freed.  Use nm_db_snapshot_close().
+ */
+notmuch_database_t *nm_db_get_snapshot(const char *filename)
+{
+  if (!filename)
+    return NULL;
 
-  *mtime = st.st_mtime;
-  return 0;
+  /* A change in the same second wouldn't alter the mtime, so don't trust it */
+  time_t mtime = 0;
+  if ((db_file_mtime(filename, &mtime) != 0) || (mtime >= mutt_date_epoch()))
+    mtime = 0;
+
+  if (SnapshotDb && mutt_str_equal(SnapshotFilename, filename))
+  {
+    if ((mtime != 0) && (mtime == SnapshotMtime))
+      return SnapshotDb;
+
+#if LIBNOTMUCH_CHECK_VERSION(5, 4, 0)
+    /* Reopening an unchanged database is cheap, so check the revision */
+    if (notmuch_database_reopen(SnapshotDb, NOTMUCH_DATABASE_MODE_READ_ONLY) ==
+        NOTMUCH_STATUS_SUCCESS)
+    {
+      unsigned long revision = notmuch_database_get_revision(SnapshotDb, NULL);
+      mutt_debug(LL_DEBUG2, "nm: snapshot revision %lu -> %lu\n", SnapshotRevision, revision);
+      if (revision != SnapshotRevision)
+        mutt_hash_free(&SnapshotCounts);
+      SnapshotRevision = revision;
+      SnapshotMtime = mtime;
+      return SnapshotDb;
+    }
+#endif
+  }
+
+  nm_db_snapshot_close();
+
+  SnapshotDb = nm_db_do_open(filename, false, false);
+  if (!SnapshotDb)
+    return NULL;
+
+  SnapshotFilename = mutt_str_dup(filename);
+  SnapshotMtime = mtime;
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  SnapshotRevision = notmuch_database_get_revision(SnapshotDb, NULL);
+#endif
+  mutt_debug(LL_DEBUG2, "nm: snapshot open, revision %lu\n", SnapshotRevision);
+  return SnapshotDb;
+}
+
+/**
+ * snapshot_count_free - Free a cached count - Implements ::hash_hdata_free_t
+ */
+static void snapshot_count_free(int type, void *obj, intptr_t data)
+{
+  FREE(&obj);
+}
+
+/**
+ * nm_db_snapshot_count_get - Get the cached result of a count query
+ * @param[in]  key   Query, including anything else that affects the result
+ * @param[out] count Number of results
+ * @retval true The count was cached
+ *
+ * The cache is emptied whenever the shared database is reopened, or its
+ * revision changes.
+ */
+bool nm_db_snapshot_count_get(const char *key, unsigned int *count)
+{
+  unsigned int *cached = mutt_hash_find(SnapshotCounts, key);
+  if (!cached)
+    return false;
+
+  *count = *cached;
+  return true;
+}
+
+/**
+ * nm_db_snapshot_count_set - Cache the result of a count query
+ * @param key   Query, including anything else that affects the result
+ * @param count Number of results
+ */
+void nm_db_snapshot_count_set(const char *key, unsigned int count)
+{
+  if (!SnapshotDb || !key)
+    return;
+
+  if (!SnapshotCounts)
+  {
+    SnapshotCounts = mutt_hash_new(64, MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_set_destructor(SnapshotCounts, snapshot_count_free, 0);
+  }
+
+  unsigned int *cached = mutt_hash_find(SnapshotCounts, key);
+  if (!cached)
+  {
+    cached = mutt_mem_malloc(sizeof(*cached));
+    mutt_hash_insert(SnapshotCounts, key, cached);
+  }
+  *cached = count;
+}
+
+/**
+ * nm_db_snapshot_close - Close the shared read-only database
+ */
+void nm_db_snapshot_close(void)
+{
+  if (!SnapshotDb)
+    return;
+
+  mutt_debug(LL_DEBUG1, "nm: snapshot close\n");
+  nm_db_free(SnapshotDb);
+  SnapshotDb = NULL;
+  mutt_hash_free(&SnapshotCounts);
+  FREE(&SnapshotFilename);
+  SnapshotMtime = 0;
+  SnapshotRevision = 0;
 }
 
 /**
@@ -295,6 +466,10 @@ bool nm_db_is_longrun(struct Mailbox *m)
  * nm_db_longrun_init - Start a long transaction
  * @param m        Mailbox
  * @param writable Read/write?
+ *
+ * The database is kept open until nm_db_longrun_done().  If it's writable, the
+ * changes are grouped into atomic transactions, rather than each being
+ * committed separately.
  */
 void nm_db_longrun_init(struct Mailbox *m, bool writable)
 {
@@ -304,6 +479,8 @@ void nm_db_longrun_init(struct Mailbox *m, bool writable)
     return;
 
   adata->longrun = true;
+  if (writable)
+    nm_db_trans_begin(m);
   mutt_debug(LL_DEBUG2, "nm: long run initialized\n");
 }
 
@@ -317,6 +494,7 @@ void nm_db_longrun_done(struct Mailbox *m)
 
   if (adata)
   {
+    nm_db_trans_end(m);
     adata->longrun = false; /* to force nm_db_release() released DB */
     if (nm_db_release(m) == 0)
       mutt_debug(LL_DEBUG2, "nm: long run deinitialized\n");
@@ -53,9 +53,11 @@ void  nm_init                    (void);
 void  nm_db_debug_check          (struct Mailbox *m);
 void  nm_db_longrun_done         (struct Mailbox *m);
 void  nm_db_longrun_init         (struct Mailbox *m, bool writable);
+void  nm_db_snapshot_close       (void);
 char *nm_email_get_folder        (struct Email *e);
 char *nm_email_get_folder_rel_db (struct Mailbox *m, struct Email *e);
 int   nm_get_all_tags            (struct Mailbox *m, char **tag_list, int *tag_count);
+int   nm_mbox_load_more          (struct Mailbox *m, bool all);
 bool  nm_message_is_still_queried(struct Mailbox *m, struct Email *e);
 enum MailboxType nm_path_probe   (const char *path, const struct stat *st);
 void  nm_query_window_backward   (void);
@@ -53,6 +53,7 @@ void nm_mdata_free(void **ptr)
 
   url_free(&mdata->db_url);
   FREE(&mdata->db_query);
+  FREE(&mdata->db_uuid);
   FREE(ptr);
 }
 
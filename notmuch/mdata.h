@@ -38,6 +38,8 @@ struct NmMboxData
   char *db_query;              ///< Previous query
   int db_limit;                ///< Maximum number of results to return
   enum NmQueryType query_type; ///< Messages or Threads
+  unsigned long db_revision;   ///< Database revision when the query was last run
+  char *db_uuid;               ///< Database UUID, which goes with db_revision
 
   struct Progress progress;    ///< A progress bar
   int oldmsgcount;
@@ -45,6 +47,8 @@ struct NmMboxData
 
   bool noprogress : 1;         ///< Don't show the progress bar
   bool progress_ready : 1;     ///< A progress bar has been initialised
+  bool have_revision : 1;      ///< db_revision is valid
+  bool more : 1;               ///< Not all of the query's messages have been loaded, see $nm_query_page_size
 };
 
 void                  nm_mdata_free(void **ptr);
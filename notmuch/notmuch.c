@@ -100,13 +100,29 @@ void nm_init(void)
  * nm_hcache_open - Open a header cache
  * @param m Mailbox
  * @retval ptr Header cache handle
+ *
+ * The cache belongs to the database, so it's shared by all the virtual
+ * Mailboxes.  The Emails are keyed by their Message-ID, so that renaming the
+ * file, e.g. to change its flags, doesn't lose its entry.
+ *
+ * The new Emails are stored in one batch, when the cache is closed.
  */
 static struct HeaderCache *nm_hcache_open(struct Mailbox *m)
 {
 #ifdef USE_HCACHE
   const char *const c_header_cache =
       cs_subset_path(NeoMutt->sub, "header_cache");
-  return mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  const char *db_filename = nm_db_get_filename(m);
+  if (!db_filename)
+    return NULL;
+
+  struct Buffer *folder = mutt_buffer_pool_get();
+  mutt_buffer_printf(folder, "%s%s", NmUrlProtocol, db_filename);
+  struct HeaderCache *h = mutt_hcache_open(c_header_cache, mutt_buffer_string(folder), NULL);
+  mutt_buffer_pool_release(&folder);
+
+  mutt_hcache_begin_txn(h);
+  return h;
 #else
   return NULL;
 #endif
@@ -433,6 +449,21 @@ static int get_limit(struct NmMboxData *mdata)
   return mdata ? mdata->db_limit : 0;
 }
 
+/**
+ * get_page_size - Get the number of messages to load at a time
+ * @param mdata Notmuch Mailbox data
+ * @retval num Number of messages, 0 for all of them
+ *
+ * Only message queries without a limit are loaded a page at a time.
+ */
+static int get_page_size(struct NmMboxData *mdata)
+{
+  if (!mdata || (mdata->query_type == NM_QUERY_TYPE_THREADS) || (get_limit(mdata) != 0))
+    return 0;
+
+  return cs_subset_number(NeoMutt->sub, "nm_query_page_size");
+}
+
 /**
  * apply_exclude_tags - Exclude the configured tags
  * @param query Notmuch query
@@ -516,7 +547,7 @@ static int update_email_tags(struct Email *e, notmuch_message_t *msg)
 {
   struct NmEmailData *edata = nm_edata_get(e);
   char *new_tags = NULL;
-  char *old_tags = NULL;
+  const char *old_tags = NULL;
 
   mutt_debug(LL_DEBUG2, "nm: tags update requested (%s)\n", edata->virtual_id);
 
@@ -534,7 +565,6 @@ static int update_email_tags(struct Email *e, notmuch_message_t *msg)
 
   if (new_tags && old_tags && (strcmp(old_tags, new_tags) == 0))
   {
-    FREE(&old_tags);
     FREE(&new_tags);
     mutt_debug(LL_DEBUG2, "nm: tags unchanged\n");
     return 1;
@@ -544,13 +574,8 @@ static int update_email_tags(struct Email *e, notmuch_message_t *msg)
   driver_tags_replace(&e->tags, new_tags);
   FREE(&new_tags);
 
-  new_tags = driver_tags_get_transformed(&e->tags);
-  mutt_debug(LL_DEBUG2, "nm: new tags: '%s'\n", new_tags);
-  FREE(&new_tags);
-
-  new_tags = driver_tags_get(&e->tags);
-  mutt_debug(LL_DEBUG2, "nm: new tag transforms: '%s'\n", new_tags);
-  FREE(&new_tags);
+  mutt_debug(LL_DEBUG2, "nm: new tags: '%s'\n", driver_tags_get_transformed(&e->tags));
+  mutt_debug(LL_DEBUG2, "nm: new tag transforms: '%s'\n", driver_tags_get(&e->tags));
 
   return 0;
 }
@@ -818,15 +843,19 @@ static void append_message(struct HeaderCache *h, struct Mailbox *m,
   mutt_debug(LL_DEBUG2, "nm: appending message, i=%d, id=%s, path=%s\n",
              m->msg_count, notmuch_message_get_message_id(msg), path);
 
-  if (m->msg_count >= m->email_max)
-  {
-    mutt_debug(LL_DEBUG2, "nm: allocate mx memory\n");
-    mx_alloc_memory(m);
-  }
+  mx_alloc_memory(m, m->msg_count + 1);
 
 #ifdef USE_HCACHE
-  e = mutt_hcache_fetch(h, path, mutt_str_len(path), 0).email;
-  if (!e)
+  const char *id = notmuch_message_get_message_id(msg);
+  e = mutt_hcache_fetch(h, id, mutt_str_len(id), 0).email;
+  if (e)
+  {
+    /* The flags depend on the current filename */
+    e->edata = maildir_edata_new();
+    e->edata_free = maildir_edata_free;
+    maildir_parse_flags(e, path);
+  }
+  else
 #endif
   {
     if (access(path, F_OK) == 0)
@@ -857,8 +886,7 @@ static void append_message(struct HeaderCache *h, struct Mailbox *m,
     }
 
 #ifdef USE_HCACHE
-    mutt_hcache_store(h, newpath ? newpath : path,
-                      mutt_str_len(newpath ? newpath : path), e, 0);
+    mutt_hcache_store(h, id, mutt_str_len(id), e, 0);
 #endif
   }
 
@@ -986,6 +1014,7 @@ static bool read_mesgs_query(struct Mailbox *m, notmuch_query_t *q, bool dedup)
     return false;
 
   int limit = get_limit(mdata);
+  const int page = dedup ? 0 : get_page_size(mdata);
 
   notmuch_messages_t *msgs = get_messages(q);
 
@@ -1003,6 +1032,11 @@ static bool read_mesgs_query(struct Mailbox *m, notmuch_query_t *q, bool dedup)
       SigInt = 0;
       return false;
     }
+    if ((page > 0) && (m->msg_count >= page))
+    {
+      mdata->more = true;
+      break;
+    }
     notmuch_message_t *nm = notmuch_messages_get(msgs);
     append_message(h, m, q, nm, dedup);
     notmuch_message_destroy(nm);
@@ -1480,9 +1514,7 @@ static int rename_filename(struct Mailbox *m, const char *old_file,
     notmuch_message_maildir_flags_to_tags(msg);
     update_email_tags(e, msg);
 
-    char *tags = driver_tags_get(&e->tags);
-    update_tags(msg, tags);
-    FREE(&tags);
+    update_tags(msg, driver_tags_get(&e->tags));
   }
 
   rc = 0;
@@ -1528,6 +1560,230 @@ static unsigned int count_query(notmuch_database_t *db, const char *qstr, int li
   return res;
 }
 
+/**
+ * count_query_cached - Count the results of a query on the shared database
+ * @param db    Notmuch database, from nm_db_get_snapshot()
+ * @param qstr  Query to execute
+ * @param limit Maximum number of results
+ * @retval num Number of results
+ *
+ * The counts are cached until the database changes, so checking the stats of
+ * every Mailbox doesn't mean running every count query again.
+ */
+static unsigned int count_query_cached(notmuch_database_t *db, const char *qstr, int limit)
+{
+  const char *const c_nm_exclude_tags =
+      cs_subset_string(NeoMutt->sub, "nm_exclude_tags");
+
+  /* The excluded tags change the result, too */
+  struct Buffer *key = mutt_buffer_pool_get();
+  mutt_buffer_printf(key, "%s\n%s", NONULL(c_nm_exclude_tags), qstr);
+
+  unsigned int res = 0;
+  if (nm_db_snapshot_count_get(mutt_buffer_string(key), &res))
+  {
+    mutt_debug(LL_DEBUG2, "nm: count '%s', cached=%d\n", qstr, res);
+  }
+  else
+  {
+    res = count_query(db, qstr, 0);
+    nm_db_snapshot_count_set(mutt_buffer_string(key), res);
+  }
+  mutt_buffer_pool_release(&key);
+
+  if ((limit > 0) && (res > limit))
+    res = limit;
+
+  return res;
+}
+
+/**
+ * check_message - Merge a message found by a check into the Mailbox
+ * @param h   Header cache handle
+ * @param m   Mailbox
+ * @param msg Notmuch message
+ * @retval true The tags of an existing Email were changed
+ *
+ * A new message is appended to the Mailbox.  An existing one is marked active
+ * and its path, flags and tags are updated.
+ */
+static bool check_message(struct HeaderCache *h, struct Mailbox *m, notmuch_message_t *msg)
+{
+  struct Email *e = get_mutt_email(m, msg);
+
+  if (!e)
+  {
+    /* new email */
+    append_message(h, m, NULL, msg, false);
+    return false;
+  }
+
+  /* message already exists, merge flags */
+  e->active = true;
+
+  /* Check to see if the message has moved to a different subdirectory.
+   * If so, update the associated filename.  */
+  const char *new_file = get_message_last_filename(msg);
+  char old_file[PATH_MAX];
+  email_get_fullpath(e, old_file, sizeof(old_file));
+
+  if (!mutt_str_equal(old_file, new_file))
+    update_message_path(e, new_file);
+
+  if (!e->changed)
+  {
+    /* if the user hasn't modified the flags on this message, update the
+     * flags we just detected.  */
+    struct Email e_tmp = { 0 };
+    e_tmp.edata = maildir_edata_new();
+    maildir_parse_flags(&e_tmp, new_file);
+    maildir_update_flags(m, e, &e_tmp);
+    maildir_edata_free(&e_tmp.edata);
+  }
+
+  return (update_email_tags(e, msg) == 0);
+}
+
+/**
+ * save_revision - Remember the revision of the database
+ * @param m  Mailbox
+ * @param db Notmuch database the query was run on
+ *
+ * The next check can then ask for just the messages that have changed since.
+ */
+static void save_revision(struct Mailbox *m, notmuch_database_t *db)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata || !db)
+    return;
+
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  const char *uuid = NULL;
+  mdata->db_revision = notmuch_database_get_revision(db, &uuid);
+  mutt_str_replace(&mdata->db_uuid, uuid);
+  mdata->have_revision = true;
+  mutt_debug(LL_DEBUG2, "nm: revision %lu\n", mdata->db_revision);
+#endif
+}
+
+/**
+ * check_changes - Check for changes since the last revision
+ * @param[in]  m         Mailbox
+ * @param[out] new_flags Number of Emails whose tags have changed
+ * @param[out] occult    Set to true if any Emails no longer match the query
+ * @retval true  Success, the Mailbox is up to date
+ * @retval false The whole query must be checked
+ *
+ * Rather than rereading the entire query, use `lastmod:` to fetch only the
+ * messages that have changed since the last check.  Messages that no longer
+ * match are marked inactive.
+ *
+ * Messages that have been removed from the database can't be found this way,
+ * so the query is counted to make sure that nothing is missing.
+ *
+ * Only message queries without a limit can be checked like this.
+ */
+static bool check_changes(struct Mailbox *m, int *new_flags, bool *occult)
+{
+#if LIBNOTMUCH_CHECK_VERSION(4, 3, 0)
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata || !mdata->have_revision || (get_limit(mdata) != 0) ||
+      (mdata->query_type == NM_QUERY_TYPE_THREADS))
+  {
+    return false;
+  }
+
+  notmuch_database_t *db = nm_db_get(m, false);
+  const char *str = get_query_string(mdata, true);
+  if (!db || !str)
+    return false;
+
+  const char *uuid = NULL;
+  unsigned long revision = notmuch_database_get_revision(db, &uuid);
+  if (!mutt_str_equal(uuid, mdata->db_uuid) || (revision < mdata->db_revision))
+    return false;
+
+  mutt_debug(LL_DEBUG1, "nm: checking changes (revision %lu -> %lu)\n",
+             mdata->db_revision, revision);
+  if (revision == mdata->db_revision)
+    return true;
+
+  char *qstr = NULL;
+  notmuch_query_t *q = NULL;
+  notmuch_messages_t *msgs = NULL;
+
+  /* Every changed message, whether it still matches or not */
+  mutt_str_asprintf(&qstr, "lastmod:%lu..", mdata->db_revision + 1);
+  q = notmuch_query_create(db, qstr);
+  FREE(&qstr);
+  msgs = get_messages(q);
+  if (!msgs)
+    goto fail;
+
+  for (; notmuch_messages_valid(msgs); notmuch_messages_move_to_next(msgs))
+  {
+    notmuch_message_t *msg = notmuch_messages_get(msgs);
+    struct Email *e = get_mutt_email(m, msg);
+    if (e)
+      e->active = false;
+    notmuch_message_destroy(msg);
+  }
+  notmuch_query_destroy(q);
+
+  /* The changed messages that match */
+  mutt_str_asprintf(&qstr, "( %s ) and lastmod:%lu..", str, mdata->db_revision + 1);
+  q = notmuch_query_create(db, qstr);
+  FREE(&qstr);
+  if (q)
+  {
+    apply_exclude_tags(q);
+    notmuch_query_set_sort(q, NOTMUCH_SORT_NEWEST_FIRST);
+  }
+  msgs = get_messages(q);
+  if (!msgs)
+    goto fail;
+
+  struct HeaderCache *h = nm_hcache_open(m);
+  for (; notmuch_messages_valid(msgs); notmuch_messages_move_to_next(msgs))
+  {
+    notmuch_message_t *msg = notmuch_messages_get(msgs);
+    if (check_message(h, m, msg))
+      (*new_flags)++;
+    notmuch_message_destroy(msg);
+  }
+  nm_hcache_close(h);
+  notmuch_query_destroy(q);
+
+  int active = 0;
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct Email *e = m->emails[i];
+    if (!e)
+      break;
+
+    if (e->active)
+      active++;
+    else
+      *occult = true;
+  }
+
+  /* Only some of the messages of a paged query have been loaded */
+  if (!mdata->more && (active != (int) count_query(db, str, 0)))
+  {
+    mutt_debug(LL_DEBUG1, "nm: messages are missing, checking the query\n");
+    return false;
+  }
+
+  save_revision(m, db);
+  return true;
+
+fail:
+  if (q)
+    notmuch_query_destroy(q);
+#endif
+  return false;
+}
+
 /**
  * nm_email_get_folder - Get the folder for a Email
  * @param e Email
@@ -1631,6 +1887,60 @@ done:
   return rc;
 }
 
+/**
+ * nm_mbox_load_more - Load more of the messages of a paged query
+ * @param m   Mailbox
+ * @param all Load all of the remaining messages, rather than a page
+ * @retval num Number of messages loaded
+ *
+ * If `$nm_query_page_size` is set, only the first messages of a query are
+ * loaded when the Mailbox is opened.  The messages are found by running the
+ * query again and skipping those that are already loaded.
+ */
+int nm_mbox_load_more(struct Mailbox *m, bool all)
+{
+  struct NmMboxData *mdata = nm_mdata_get(m);
+  if (!mdata || !mdata->more)
+    return 0;
+
+  const int page = get_page_size(mdata);
+  const int oldcount = m->msg_count;
+  mutt_debug(LL_DEBUG1, "nm: loading more messages...[current count=%d]\n", oldcount);
+
+  mdata->more = false;
+  mdata->noprogress = true;
+
+  notmuch_query_t *q = get_query(m, false);
+  notmuch_messages_t *msgs = get_messages(q);
+  if (msgs)
+  {
+    struct HeaderCache *h = nm_hcache_open(m);
+    for (; notmuch_messages_valid(msgs); notmuch_messages_move_to_next(msgs))
+    {
+      if (!all && (page > 0) && ((m->msg_count - oldcount) >= page))
+      {
+        mdata->more = true;
+        break;
+      }
+      notmuch_message_t *nm = notmuch_messages_get(msgs);
+      append_message(h, m, q, nm, true);
+      notmuch_message_destroy(nm);
+    }
+    nm_hcache_close(h);
+  }
+
+  if (q)
+    notmuch_query_destroy(q);
+  nm_db_release(m);
+
+  if (m->msg_count > oldcount)
+    mailbox_changed(m, NT_MAILBOX_INVALID);
+
+  mutt_debug(LL_DEBUG1, "nm: loading more messages... done [count=%d, more=%d]\n",
+             m->msg_count, mdata->more);
+  return m->msg_count - oldcount;
+}
+
 /**
  * nm_url_from_query - Turn a query into a URL
  * @param m      Mailbox
@@ -1878,16 +2188,15 @@ static enum MxStatus nm_mbox_check_stats(struct Mailbox *m, uint8_t flags)
       db_filename = c_folder;
   }
 
-  /* don't be verbose about connection, as we're called from
-   * sidebar/mailbox very often */
-  db = nm_db_do_open(db_filename, false, false);
+  /* We're called for every Mailbox in the sidebar very often, so use the
+   * shared read-only database and don't be verbose about connection */
+  db = nm_db_get_snapshot(db_filename);
   if (!db)
     goto done;
 
   /* all emails */
-  m->msg_count = count_query(db, db_query, limit);
-  while (m->email_max < m->msg_count)
-    mx_alloc_memory(m);
+  m->msg_count = count_query_cached(db, db_query, limit);
+  mx_alloc_memory(m, m->msg_count);
 
   // holder variable for extending query to unread/flagged
   char *qstr = NULL;
@@ -1896,23 +2205,18 @@ static enum MxStatus nm_mbox_check_stats(struct Mailbox *m, uint8_t flags)
   const char *const c_nm_unread_tag =
       cs_subset_string(NeoMutt->sub, "nm_unread_tag");
   mutt_str_asprintf(&qstr, "( %s ) tag:%s", db_query, c_nm_unread_tag);
-  m->msg_unread = count_query(db, qstr, limit);
+  m->msg_unread = count_query_cached(db, qstr, limit);
   FREE(&qstr);
 
   // flagged messages
   const char *const c_nm_flagged_tag =
       cs_subset_string(NeoMutt->sub, "nm_flagged_tag");
   mutt_str_asprintf(&qstr, "( %s ) tag:%s", db_query, c_nm_flagged_tag);
-  m->msg_flagged = count_query(db, qstr, limit);
+  m->msg_flagged = count_query_cached(db, qstr, limit);
   FREE(&qstr);
 
   rc = (m->msg_new > 0) ? MX_STATUS_NEW_MAIL : MX_STATUS_OK;
 done:
-  if (db)
-  {
-    nm_db_free(db);
-    mutt_debug(LL_DEBUG1, "nm: count close DB\n");
-  }
   url_free(&url);
 
   mutt_debug(LL_DEBUG1, "nm: count done [rc=%d]\n", rc);
@@ -1997,9 +2301,7 @@ int nm_record_message(struct Mailbox *m, char *path, struct Email *e)
     notmuch_message_maildir_flags_to_tags(msg);
     if (e)
     {
-      char *tags = driver_tags_get(&e->tags);
-      update_tags(msg, tags);
-      FREE(&tags);
+      update_tags(msg, driver_tags_get(&e->tags));
     }
     const char *const c_nm_record_tags =
         cs_subset_string(NeoMutt->sub, "nm_record_tags");
@@ -2111,9 +2413,12 @@ static enum MxOpenReturns nm_mbox_open(struct Mailbox *m)
 
   enum MxOpenReturns rc = MX_OPEN_ERROR;
 
+  mdata->more = false;
+
   notmuch_query_t *q = get_query(m, false);
   if (q)
   {
+    save_revision(m, nm_db_get(m, false));
     rc = MX_OPEN_OK;
     switch (mdata->query_type)
     {
@@ -2165,13 +2470,21 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
 
   mutt_debug(LL_DEBUG1, "nm: checking (db=%lu mailbox=%lu)\n", mtime, m->mtime.tv_sec);
 
-  notmuch_query_t *q = get_query(m, false);
+  mdata->oldmsgcount = m->msg_count;
+  mdata->noprogress = true;
+
+  notmuch_query_t *q = NULL;
+  if (check_changes(m, &new_flags, &occult))
+    goto done;
+
+  new_flags = 0;
+  occult = false;
+  q = get_query(m, false);
   if (!q)
     goto done;
 
   mutt_debug(LL_DEBUG1, "nm: start checking (count=%d)\n", m->msg_count);
-  mdata->oldmsgcount = m->msg_count;
-  mdata->noprogress = true;
+  save_revision(m, nm_db_get(m, false));
 
   for (int i = 0; i < m->msg_count; i++)
   {
@@ -2183,6 +2496,7 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
   }
 
   int limit = get_limit(mdata);
+  const int page = get_page_size(mdata);
 
   notmuch_messages_t *msgs = get_messages(q);
 
@@ -2201,42 +2515,16 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
        notmuch_messages_move_to_next(msgs), i++)
   {
     notmuch_message_t *msg = notmuch_messages_get(msgs);
-    struct Email *e = get_mutt_email(m, msg);
-
-    if (!e)
+    /* Don't load more than a page of new messages of a paged query */
+    if ((page > 0) && ((m->msg_count - mdata->oldmsgcount) >= page) &&
+        !get_mutt_email(m, msg))
     {
-      /* new email */
-      append_message(h, m, NULL, msg, false);
-      notmuch_message_destroy(msg);
-      continue;
+      mdata->more = true;
     }
-
-    /* message already exists, merge flags */
-    e->active = true;
-
-    /* Check to see if the message has moved to a different subdirectory.
-     * If so, update the associated filename.  */
-    const char *new_file = get_message_last_filename(msg);
-    char old_file[PATH_MAX];
-    email_get_fullpath(e, old_file, sizeof(old_file));
-
-    if (!mutt_str_equal(old_file, new_file))
-      update_message_path(e, new_file);
-
-    if (!e->changed)
+    else if (check_message(h, m, msg))
     {
-      /* if the user hasn't modified the flags on this message, update the
-       * flags we just detected.  */
-      struct Email e_tmp = { 0 };
-      e_tmp.edata = maildir_edata_new();
-      maildir_parse_flags(&e_tmp, new_file);
-      maildir_update_flags(m, e, &e_tmp);
-      maildir_edata_free(&e_tmp.edata);
-    }
-
-    if (update_email_tags(e, msg) == 0)
       new_flags++;
-
+    }
     notmuch_message_destroy(msg);
   }
 
@@ -2255,9 +2543,9 @@ static enum MxStatus nm_mbox_check(struct Mailbox *m)
     }
   }
 
+done:
   if (m->msg_count > mdata->oldmsgcount)
     mailbox_changed(m, NT_MAILBOX_INVALID);
-done:
   if (q)
     notmuch_query_destroy(q);
 
@@ -2304,6 +2592,9 @@ static enum MxStatus nm_mbox_sync(struct Mailbox *m)
 
   struct HeaderCache *h = nm_hcache_open(m);
 
+  /* Keep the database open and group the changes into a few transactions */
+  nm_db_longrun_init(m, true);
+
   int mh_sync_errors = 0;
   for (int i = 0; i < m->msg_count; i++)
   {
@@ -2384,7 +2675,7 @@ static enum MxStatus nm_mbox_sync(struct Mailbox *m)
   mutt_buffer_strcpy(&m->pathbuf, url);
   m->type = MUTT_NOTMUCH;
 
-  nm_db_release(m);
+  nm_db_longrun_done(m);
 
   if (changed)
   {
@@ -2485,7 +2776,10 @@ static int nm_tags_commit(struct Mailbox *m, struct Email *e, char *buf)
 
   mutt_debug(LL_DEBUG1, "nm: tags modify: '%s'\n", buf);
 
+  int trans = nm_db_trans_begin(m);
   update_tags(msg, buf);
+  if (trans == 1)
+    nm_db_trans_end(m);
   update_email_flags(m, e, buf);
   update_email_tags(e, msg);
   mutt_set_header_color(m, e);
@@ -2557,9 +2851,11 @@ struct MxOps MxNotmuchOps = {
   .mbox_sync        = nm_mbox_sync,
   .mbox_close       = nm_mbox_close,
   .msg_open         = nm_msg_open,
+  .msg_prefetch     = NULL,
   .msg_open_new     = maildir_msg_open_new,
   .msg_commit       = nm_msg_commit,
   .msg_close        = nm_msg_close,
+  .msg_append_batch = NULL,
   .msg_padding_size = NULL,
   .msg_save_hcache  = NULL,
   .tags_edit        = nm_tags_edit,
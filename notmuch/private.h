@@ -47,6 +47,9 @@ void                nm_db_free        (notmuch_database_t *db);
 const char *        nm_db_get_filename(struct Mailbox *m);
 int                 nm_db_get_mtime   (struct Mailbox *m, time_t *mtime);
 notmuch_database_t *nm_db_get         (struct Mailbox *m, bool writable);
+notmuch_database_t *nm_db_get_snapshot(const char *filename);
+bool                nm_db_snapshot_count_get(const char *key, unsigned int *count);
+void                nm_db_snapshot_count_set(const char *key, unsigned int count);
 bool                nm_db_is_longrun  (struct Mailbox *m);
 int                 nm_db_release     (struct Mailbox *m);
 int                 nm_db_trans_begin (struct Mailbox *m);
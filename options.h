@@ -32,7 +32,6 @@ WHERE bool OptAttachMsg;           ///< (pseudo) used by attach-message
 #ifdef USE_AUTOCRYPT
 WHERE bool OptAutocryptGpgme;      ///< (pseudo) use Autocrypt context inside ncrypt/crypt_gpgme.c
 #endif
-WHERE bool OptAuxSort;             ///< (pseudo) using auxiliary sort function
 WHERE bool OptDontHandlePgpKeys;   ///< (pseudo) used to extract PGP keys
 WHERE bool OptForceRefresh;        ///< (pseudo) refresh even during macros
 WHERE bool OptIgnoreMacroEvents;   ///< (pseudo) don't process macro/push/exec events while set
@@ -46,7 +45,9 @@ WHERE bool OptNews;                ///< (pseudo) used to change reader mode
 WHERE bool OptNewsSend;            ///< (pseudo) used to change behavior when posting
 #endif
 WHERE bool OptNoCurses;            ///< (pseudo) when sending in batch mode
+WHERE bool OptOpenCached;          ///< (pseudo) the Mailbox may be shown from its cache while it's read
 WHERE bool OptPgpCheckTrust;       ///< (pseudo) used by dlg_select_pgp_key()
+WHERE bool OptRcTrusted;           ///< (pseudo) the config file is unchanged since it was last read cleanly
 WHERE bool OptRedrawTree;          ///< (pseudo) redraw the thread tree
 WHERE bool OptResortInit;          ///< (pseudo) used to force the next resort to be from scratch
 WHERE bool OptSearchInvalid;       ///< (pseudo) used to invalidate the search pattern
@@ -131,6 +131,7 @@ struct Line
   struct TextSyntax *search;
   struct QClass *quote;
   unsigned int is_cont_hdr; ///< this line is a continuation of the previous header line
+  bool colored;             ///< syntax has been matched against the colour patterns
 };
 
 /**
@@ -174,6 +175,7 @@ struct PagerRedrawData
   PagerFlags hide_quoted;
   int q_level;
   struct QClass *quote_list;
+  struct HashTable *quote_hash; ///< Lookup table of the classes in quote_list
   LOFF_T last_pos;
   LOFF_T last_offset;
   struct Menu *menu; ///< the Pager Index (PI)
@@ -453,6 +455,37 @@ static int comp_syntax_t(const void *m1, const void *m2)
   return 0;
 }
 
+/**
+ * run_flush - Write the pending text of a line
+ * @param run Text waiting to be written (OPTIONAL)
+ *
+ * The text of a line is collected until the colour changes, so that it can
+ * be written to the screen in one go.
+ */
+static void run_flush(struct Buffer *run)
+{
+  if (!run || (mutt_buffer_len(run) == 0))
+    return;
+
+  mutt_window_addnstr(mutt_buffer_string(run), mutt_buffer_len(run));
+  mutt_buffer_reset(run);
+}
+
+/**
+ * run_addwch - Add a wide character to the pending text of a line
+ * @param run Text waiting to be written
+ * @param wc  Character to add
+ */
+static void run_addwch(struct Buffer *run, wchar_t wc)
+{
+  char buf[MB_LEN_MAX * 2];
+  mbstate_t mbstate = { 0 };
+
+  const size_t n = wcrtomb(buf, wc, &mbstate);
+  if (n != (size_t)(-1))
+    mutt_buffer_addstr_n(run, buf, n);
+}
+
 /**
  * resolve_color - Set the colour for a line of text
  * @param line_info Line info array
@@ -461,9 +494,10 @@ static int comp_syntax_t(const void *m1, const void *m2)
  * @param flags     Flags, see #PagerFlags
  * @param special   Flags, e.g. A_BOLD
  * @param a         ANSI attributes
+ * @param run       Text waiting to be written before the colour changes (OPTIONAL)
  */
-static void resolve_color(struct Line *line_info, int n, int cnt,
-                          PagerFlags flags, int special, struct AnsiAttr *a)
+static void resolve_color(struct Line *line_info, int n, int cnt, PagerFlags flags,
+                          int special, struct AnsiAttr *a, struct Buffer *run)
 {
   int def_color;         /* color without syntax highlight */
   int color;             /* final color */
@@ -480,6 +514,7 @@ static void resolve_color(struct Line *line_info, int n, int cnt,
     const bool c_markers = cs_subset_bool(NeoMutt->sub, "markers");
     if (!cnt && c_markers)
     {
+      run_flush(run);
       mutt_curses_set_color(MT_COLOR_MARKERS);
       mutt_window_addch('+');
       last_color = Colors->defs[MT_COLOR_MARKERS];
@@ -584,6 +619,7 @@ static void resolve_color(struct Line *line_info, int n, int cnt,
 
   if (color != last_color)
   {
+    run_flush(run);
     mutt_curses_set_attr(color);
     last_color = color;
   }
@@ -686,7 +722,7 @@ static void cleanup_quote(struct QClass **quote_list)
 }
 
 /**
- * classify_quote - Find a style for a string
+ * insert_quote - Find or create the style for a quote prefix
  * @param[out] quote_list   List of quote colours
  * @param[in]  qptr         String to classify
  * @param[in]  length       Length of string
@@ -694,8 +730,8 @@ static void cleanup_quote(struct QClass **quote_list)
  * @param[out] q_level      Quoting level
  * @retval ptr Quoting style
  */
-static struct QClass *classify_quote(struct QClass **quote_list, const char *qptr,
-                                     size_t length, bool *force_redraw, int *q_level)
+static struct QClass *insert_quote(struct QClass **quote_list, const char *qptr,
+                                   size_t length, bool *force_redraw, int *q_level)
 {
   struct QClass *q_list = *quote_list;
   struct QClass *qc = NULL, *tmp = NULL, *ptr = NULL, *save = NULL;
@@ -1000,6 +1036,44 @@ static struct QClass *classify_quote(struct QClass **quote_list, const char *qpt
   return qc;
 }
 
+/**
+ * classify_quote - Find a style for a string
+ * @param[out] quote_list   List of quote colours
+ * @param[in]  quote_hash   Lookup table of quote prefixes to styles
+ * @param[in]  qptr         String to classify
+ * @param[in]  length       Length of string
+ * @param[out] force_redraw Set to true if a screen redraw is needed
+ * @param[out] q_level      Quoting level
+ * @retval ptr Quoting style
+ *
+ * A class's prefix never changes and it isn't freed until the pager exits, so
+ * once a prefix has been placed in the tree, it can be looked up directly.
+ */
+static struct QClass *classify_quote(struct QClass **quote_list,
+                                     struct HashTable *quote_hash, const char *qptr,
+                                     size_t length, bool *force_redraw, int *q_level)
+{
+  if (!quote_hash || (Colors->quotes_used <= 1))
+    return insert_quote(quote_list, qptr, length, force_redraw, q_level);
+
+  char buf[128];
+  char *key = (length < sizeof(buf)) ? buf : mutt_mem_malloc(length + 1);
+  memcpy(key, qptr, length);
+  key[length] = '\0';
+
+  struct QClass *qc = mutt_hash_find(quote_hash, key);
+  if (!qc)
+  {
+    qc = insert_quote(quote_list, qptr, length, force_redraw, q_level);
+    if (qc && qc->prefix && (qc->length == length))
+      mutt_hash_insert(quote_hash, qc->prefix, qc);
+  }
+
+  if (key != buf)
+    FREE(&key);
+  return qc;
+}
+
 /**
  * check_marker - Check that the unique marker is present
  * @param q Marker string
@@ -1080,20 +1154,14 @@ int mutt_is_quote_line(char *line, regmatch_t *pmatch)
 }
 
 /**
- * resolve_types - Determine the style for a line of text
- * @param[in]  buf          Formatted text
- * @param[in]  raw          Raw text
- * @param[in]  line_info    Line info array
- * @param[in]  n            Line number (index into line_info)
- * @param[in]  last         Last line
- * @param[out] quote_list   List of quote colours
- * @param[out] q_level      Quote level
- * @param[out] force_redraw Set to true if a screen redraw is needed
- * @param[in]  q_classify   If true, style the text
+ * resolve_chunks - Match a line of text against the colour patterns
+ * @param buf       Text of the line, stripped of attributes
+ * @param line_info Line info array
+ * @param n         Line number (index into line_info)
+ *
+ * The type of the line must already be known.
  */
-static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
-                          int last, struct QClass **quote_list, int *q_level,
-                          bool *force_redraw, bool q_classify)
+static void resolve_chunks(char *buf, struct Line *line_info, int n)
 {
   struct ColorLine *color_line = NULL;
   struct ColorLineList *head = NULL;
@@ -1104,103 +1172,7 @@ static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
       cs_subset_bool(NeoMutt->sub, "header_color_partial");
   int offset, i = 0;
 
-  if ((n == 0) || IS_HEADER(line_info[n - 1].type) ||
-      (check_protected_header_marker(raw) == 0))
-  {
-    if (buf[0] == '\n') /* end of header */
-    {
-      line_info[n].type = MT_COLOR_NORMAL;
-      getyx(stdscr, braille_line, braille_col);
-    }
-    else
-    {
-      /* if this is a continuation of the previous line, use the previous
-       * line's color as default. */
-      if ((n > 0) && ((buf[0] == ' ') || (buf[0] == '\t')))
-      {
-        line_info[n].type = line_info[n - 1].type; /* wrapped line */
-        if (!c_header_color_partial)
-        {
-          (line_info[n].syntax)[0].color = (line_info[n - 1].syntax)[0].color;
-          line_info[n].is_cont_hdr = 1;
-        }
-      }
-      else
-      {
-        line_info[n].type = MT_COLOR_HDRDEFAULT;
-      }
-
-      /* When this option is unset, we color the entire header the
-       * same color.  Otherwise, we handle the header patterns just
-       * like body patterns (further below).  */
-      if (!c_header_color_partial)
-      {
-        STAILQ_FOREACH(color_line, &Colors->hdr_list, entries)
-        {
-          if (regexec(&color_line->regex, buf, 0, NULL, 0) == 0)
-          {
-            line_info[n].type = MT_COLOR_HEADER;
-            line_info[n].syntax[0].color = color_line->pair;
-            if (line_info[n].is_cont_hdr)
-            {
-              /* adjust the previous continuation lines to reflect the color of this continuation line */
-              int j;
-              for (j = n - 1; j >= 0 && line_info[j].is_cont_hdr; --j)
-              {
-                line_info[j].type = line_info[n].type;
-                line_info[j].syntax[0].color = line_info[n].syntax[0].color;
-              }
-              /* now adjust the first line of this header field */
-              if (j >= 0)
-              {
-                line_info[j].type = line_info[n].type;
-                line_info[j].syntax[0].color = line_info[n].syntax[0].color;
-              }
-              *force_redraw = true; /* the previous lines have already been drawn on the screen */
-            }
-            break;
-          }
-        }
-      }
-    }
-  }
-  else if (mutt_str_startswith(raw, "\033[0m")) // Escape: a little hack...
-    line_info[n].type = MT_COLOR_NORMAL;
-  else if (check_attachment_marker((char *) raw) == 0)
-    line_info[n].type = MT_COLOR_ATTACHMENT;
-  else if (mutt_str_equal("-- \n", buf) || mutt_str_equal("-- \r\n", buf))
-  {
-    i = n + 1;
-
-    line_info[n].type = MT_COLOR_SIGNATURE;
-    while ((i < last) && (check_sig(buf, line_info, i - 1) == 0) &&
-           ((line_info[i].type == MT_COLOR_NORMAL) || (line_info[i].type == MT_COLOR_QUOTED) ||
-            (line_info[i].type == MT_COLOR_HEADER)))
-    {
-      /* oops... */
-      if (line_info[i].chunks)
-      {
-        line_info[i].chunks = 0;
-        mutt_mem_realloc(&(line_info[n].syntax), sizeof(struct TextSyntax));
-      }
-      line_info[i++].type = MT_COLOR_SIGNATURE;
-    }
-  }
-  else if (check_sig(buf, line_info, n - 1) == 0)
-    line_info[n].type = MT_COLOR_SIGNATURE;
-  else if (mutt_is_quote_line(buf, pmatch))
-
-  {
-    if (q_classify && (line_info[n].quote == NULL))
-    {
-      line_info[n].quote = classify_quote(quote_list, buf + pmatch[0].rm_so,
-                                          pmatch[0].rm_eo - pmatch[0].rm_so,
-                                          force_redraw, q_level);
-    }
-    line_info[n].type = MT_COLOR_QUOTED;
-  }
-  else
-    line_info[n].type = MT_COLOR_NORMAL;
+  line_info[n].colored = true;
 
   /* body patterns */
   if ((line_info[n].type == MT_COLOR_NORMAL) || (line_info[n].type == MT_COLOR_QUOTED) ||
@@ -1221,10 +1193,7 @@ static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
       head = &Colors->hdr_list;
     else
       head = &Colors->body_list;
-    STAILQ_FOREACH(color_line, head, entries)
-    {
-      color_line->stop_matching = false;
-    }
+    mutt_color_lines_reset(head);
     do
     {
       if (!buf[offset])
@@ -1235,8 +1204,7 @@ static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
       STAILQ_FOREACH(color_line, head, entries)
       {
         if (!color_line->stop_matching &&
-            (regexec(&color_line->regex, buf + offset, 1, pmatch,
-                     ((offset != 0) ? REG_NOTBOL : 0)) == 0))
+            mutt_color_line_match(color_line, buf, offset, pmatch))
         {
           if (pmatch[0].rm_eo != pmatch[0].rm_so)
           {
@@ -1303,6 +1271,7 @@ static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
     i = 0;
     offset = 0;
     line_info[n].chunks = 0;
+    mutt_color_lines_reset(&Colors->attach_list);
     do
     {
       if (!buf[offset])
@@ -1312,8 +1281,7 @@ static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
       null_rx = false;
       STAILQ_FOREACH(color_line, &Colors->attach_list, entries)
       {
-        if (regexec(&color_line->regex, buf + offset, 1, pmatch,
-                    ((offset != 0) ? REG_NOTBOL : 0)) == 0)
+        if (mutt_color_line_match(color_line, buf, offset, pmatch))
         {
           if (pmatch[0].rm_eo != pmatch[0].rm_so)
           {
@@ -1354,6 +1322,138 @@ static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
   }
 }
 
+/**
+ * resolve_types - Determine the style for a line of text
+ * @param[in]  buf          Formatted text
+ * @param[in]  raw          Raw text
+ * @param[in]  line_info    Line info array
+ * @param[in]  n            Line number (index into line_info)
+ * @param[in]  last         Last line
+ * @param[out] quote_list   List of quote colours
+ * @param[in]  quote_hash   Lookup table of quote prefixes
+ * @param[out] q_level      Quote level
+ * @param[out] force_redraw Set to true if a screen redraw is needed
+ * @param[in]  q_classify   If true, style the text
+ *
+ * The colour patterns are only matched if the text is styled.  Otherwise, it's
+ * left to resolve_chunks() when the line is displayed.
+ */
+static void resolve_types(char *buf, char *raw, struct Line *line_info, int n,
+                          int last, struct QClass **quote_list,
+                          struct HashTable *quote_hash, int *q_level,
+                          bool *force_redraw, bool q_classify)
+{
+  struct ColorLine *color_line = NULL;
+  regmatch_t pmatch[1];
+  const bool c_header_color_partial =
+      cs_subset_bool(NeoMutt->sub, "header_color_partial");
+  int i = 0;
+
+  if ((n == 0) || IS_HEADER(line_info[n - 1].type) ||
+      (check_protected_header_marker(raw) == 0))
+  {
+    if (buf[0] == '\n') /* end of header */
+    {
+      line_info[n].type = MT_COLOR_NORMAL;
+      getyx(stdscr, braille_line, braille_col);
+    }
+    else
+    {
+      /* if this is a continuation of the previous line, use the previous
+       * line's color as default. */
+      if ((n > 0) && ((buf[0] == ' ') || (buf[0] == '\t')))
+      {
+        line_info[n].type = line_info[n - 1].type; /* wrapped line */
+        if (!c_header_color_partial)
+        {
+          (line_info[n].syntax)[0].color = (line_info[n - 1].syntax)[0].color;
+          line_info[n].is_cont_hdr = 1;
+        }
+      }
+      else
+      {
+        line_info[n].type = MT_COLOR_HDRDEFAULT;
+      }
+
+      /* When this option is unset, we color the entire header the
+       * same color.  Otherwise, we handle the header patterns just
+       * like body patterns (further below).  */
+      if (!c_header_color_partial)
+      {
+        STAILQ_FOREACH(color_line, &Colors->hdr_list, entries)
+        {
+          if (mutt_color_line_compile(color_line) &&
+              (regexec(&color_line->regex, buf, 0, NULL, 0) == 0))
+          {
+            line_info[n].type = MT_COLOR_HEADER;
+            line_info[n].syntax[0].color = color_line->pair;
+            if (line_info[n].is_cont_hdr)
+            {
+              /* adjust the previous continuation lines to reflect the color of this continuation line */
+              int j;
+              for (j = n - 1; j >= 0 && line_info[j].is_cont_hdr; --j)
+              {
+                line_info[j].type = line_info[n].type;
+                line_info[j].syntax[0].color = line_info[n].syntax[0].color;
+              }
+              /* now adjust the first line of this header field */
+              if (j >= 0)
+              {
+                line_info[j].type = line_info[n].type;
+                line_info[j].syntax[0].color = line_info[n].syntax[0].color;
+              }
+              *force_redraw = true; /* the previous lines have already been drawn on the screen */
+            }
+            break;
+          }
+        }
+      }
+    }
+  }
+  else if (mutt_str_startswith(raw, "\033[0m")) // Escape: a little hack...
+    line_info[n].type = MT_COLOR_NORMAL;
+  else if (check_attachment_marker((char *) raw) == 0)
+    line_info[n].type = MT_COLOR_ATTACHMENT;
+  else if (mutt_str_equal("-- \n", buf) || mutt_str_equal("-- \r\n", buf))
+  {
+    i = n + 1;
+
+    line_info[n].type = MT_COLOR_SIGNATURE;
+    while ((i < last) && (check_sig(buf, line_info, i - 1) == 0) &&
+           ((line_info[i].type == MT_COLOR_NORMAL) || (line_info[i].type == MT_COLOR_QUOTED) ||
+            (line_info[i].type == MT_COLOR_HEADER)))
+    {
+      /* oops... */
+      if (line_info[i].chunks)
+      {
+        line_info[i].chunks = 0;
+        mutt_mem_realloc(&(line_info[n].syntax), sizeof(struct TextSyntax));
+      }
+      line_info[i++].type = MT_COLOR_SIGNATURE;
+    }
+  }
+  else if (check_sig(buf, line_info, n - 1) == 0)
+    line_info[n].type = MT_COLOR_SIGNATURE;
+  else if (mutt_is_quote_line(buf, pmatch))
+
+  {
+    if (q_classify && (line_info[n].quote == NULL))
+    {
+      line_info[n].quote = classify_quote(quote_list, quote_hash, buf + pmatch[0].rm_so,
+                                          pmatch[0].rm_eo - pmatch[0].rm_so,
+                                          force_redraw, q_level);
+    }
+    line_info[n].type = MT_COLOR_QUOTED;
+  }
+  else
+    line_info[n].type = MT_COLOR_NORMAL;
+
+  if (q_classify)
+    resolve_chunks(buf, line_info, n);
+  else
+    line_info[n].colored = false;
+}
+
 /**
  * is_ansi - Is this an ANSI escape sequence?
  * @param str String to test
@@ -1558,6 +1658,36 @@ static int fill_buffer(FILE *fp, LOFF_T *last_pos, LOFF_T offset, unsigned char
   return b_read;
 }
 
+/**
+ * resolve_line_chunks - Read a line and match it against the colour patterns
+ * @param[in]     fp        File to read from
+ * @param[in,out] last_pos  Offset into the file
+ * @param[in]     line_info Line info array
+ * @param[in]     n         Line number (index into line_info)
+ *
+ * This is used for a line that has scrolled out of view, but whose wrapped
+ * continuation lines are being displayed.
+ */
+static void resolve_line_chunks(FILE *fp, LOFF_T *last_pos, struct Line *line_info, int n)
+{
+  size_t buflen = 0;
+
+  if (line_info[n].offset != *last_pos)
+    fseeko(fp, line_info[n].offset, SEEK_SET);
+
+  char *buf = mutt_file_read_line(NULL, &buflen, fp, NULL, MUTT_RL_EOL);
+  *last_pos = ftello(fp);
+  if (!buf)
+    return;
+
+  struct Buffer stripped = mutt_buffer_make(buflen);
+  mutt_buffer_strip_formatting(&stripped, buf, true);
+  resolve_chunks(stripped.data, line_info, n);
+
+  mutt_buffer_dealloc(&stripped);
+  FREE(&buf);
+}
+
 /**
  * format_line - Display a line of text in the pager
  * @param[out] line_info Line info
@@ -1590,6 +1720,8 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
   if (check_attachment_marker((char *) buf) == 0)
     wrap_cols = width;
 
+  struct Buffer *run = mutt_buffer_pool_get();
+
   /* FIXME: this should come from line_info */
   memset(&mbstate, 0, sizeof(mbstate));
 
@@ -1625,7 +1757,7 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
         break;
       col += 4;
       if (pa)
-        mutt_window_printf("\\%03o", buf[ch]);
+        mutt_buffer_add_printf(run, "\\%03o", buf[ch]);
       k = 1;
       continue;
     }
@@ -1686,7 +1818,7 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
     if (pa && ((flags & (MUTT_SHOWCOLOR | MUTT_SEARCH | MUTT_PAGER_MARKER)) ||
                special || last_special || pa->attr))
     {
-      resolve_color(*line_info, n, vch, flags, special, pa);
+      resolve_color(*line_info, n, vch, flags, special, pa, run);
       last_special = special;
     }
 
@@ -1702,7 +1834,7 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
         break;
       col += t;
       if (pa)
-        mutt_addwch(wc);
+        run_addwch(run, wc);
     }
     else if (wc == '\n')
       break;
@@ -1714,7 +1846,7 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
         break;
       if (pa)
         for (; col < t; col++)
-          mutt_window_addch(' ');
+          mutt_buffer_addch(run, ' ');
       else
         col = t;
     }
@@ -1724,7 +1856,7 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
         break;
       col += 2;
       if (pa)
-        mutt_window_printf("^%c", ('@' + wc) & 0x7f);
+        mutt_buffer_add_printf(run, "^%c", ('@' + wc) & 0x7f);
     }
     else if (wc < 0x100)
     {
@@ -1732,7 +1864,7 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
         break;
       col += 4;
       if (pa)
-        mutt_window_printf("\\%03o", wc);
+        mutt_buffer_add_printf(run, "\\%03o", wc);
     }
     else
     {
@@ -1740,9 +1872,12 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
         break;
       col += k;
       if (pa)
-        mutt_addwch(ReplacementChar);
+        run_addwch(run, ReplacementChar);
     }
   }
+  run_flush(run);
+  mutt_buffer_pool_release(&run);
+
   *pspace = space;
   *pcol = col;
   *pvch = vch;
@@ -1760,6 +1895,7 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
  * @param[out] max             Maximum number of lines
  * @param[in]  flags           Flags, see #PagerFlags
  * @param[out] quote_list      Email quoting style
+ * @param[in]  quote_hash      Lookup table of quote prefixes
  * @param[out] q_level         Level of quoting
  * @param[out] force_redraw    Force a repaint
  * @param[out] search_re       Regex to highlight
@@ -1770,7 +1906,8 @@ static int format_line(struct Line **line_info, int n, unsigned char *buf,
  */
 static int display_line(FILE *fp, LOFF_T *last_pos, struct Line **line_info,
                         int n, int *last, int *max, PagerFlags flags,
-                        struct QClass **quote_list, int *q_level, bool *force_redraw,
+                        struct QClass **quote_list, struct HashTable *quote_hash,
+                        int *q_level, bool *force_redraw,
                         regex_t *search_re, struct MuttWindow *win_pager)
 {
   unsigned char *buf = NULL, *fmt = NULL;
@@ -1796,7 +1933,10 @@ static int display_line(FILE *fp, LOFF_T *last_pos, struct Line **line_info,
 
   if (*last == *max)
   {
-    mutt_mem_realloc(line_info, sizeof(struct Line) * (*max += LINES));
+    /* Grow geometrically, so a huge file doesn't cause lots of copying */
+    const int grow = MAX(LINES, *max / 2);
+    mutt_mem_realloc(line_info, sizeof(struct Line) * (*max += grow));
+    MEM_ACCOUNT(MEM_TAG_PAGER, grow * (sizeof(struct Line) + sizeof(struct TextSyntax)), 0);
     for (ch = *last; ch < *max; ch++)
     {
       memset(&((*line_info)[ch]), 0, sizeof(struct Line));
@@ -1845,13 +1985,33 @@ static int display_line(FILE *fp, LOFF_T *last_pos, struct Line **line_info,
       }
 
       resolve_types((char *) fmt, (char *) buf, *line_info, n, *last,
-                    quote_list, q_level, force_redraw, flags & MUTT_SHOWCOLOR);
+                    quote_list, quote_hash, q_level, force_redraw,
+                    flags & MUTT_SHOWCOLOR);
 
       /* avoid race condition for continuation lines when scrolling up */
       for (m = n + 1; m < *last && (*line_info)[m].offset && (*line_info)[m].continuation; m++)
         (*line_info)[m].type = curr_line->type;
     }
 
+    /* The colour patterns are matched the first time a line is displayed */
+    if ((flags & MUTT_SHOWCOLOR) && !curr_line->continuation && !curr_line->colored)
+    {
+      if (fill_buffer(fp, last_pos, curr_line->offset, &buf, &fmt, &buflen, &buf_ready) < 0)
+      {
+        if (change_last)
+          (*last)--;
+        goto out;
+      }
+
+      resolve_chunks((char *) fmt, *line_info, n);
+    }
+    else if ((flags & MUTT_SHOWCOLOR) && curr_line->continuation &&
+             !(*line_info)[curr_line->syntax[0].first].colored)
+    {
+      /* A wrapped line uses the colours of the start of the line */
+      resolve_line_chunks(fp, last_pos, *line_info, curr_line->syntax[0].first);
+    }
+
     /* this also prevents searching through the hidden lines */
     const short c_toggle_quoted_show_levels =
         cs_subset_number(NeoMutt->sub, "toggle_quoted_show_levels");
@@ -1882,7 +2042,7 @@ static int display_line(FILE *fp, LOFF_T *last_pos, struct Line **line_info,
     if (mutt_regex_capture(c_quote_regex, (char *) fmt, 1, pmatch))
     {
       curr_line->quote =
-          classify_quote(quote_list, (char *) fmt + pmatch[0].rm_so,
+          classify_quote(quote_list, quote_hash, (char *) fmt + pmatch[0].rm_so,
                          pmatch[0].rm_eo - pmatch[0].rm_so, force_redraw, q_level);
     }
     else
@@ -2010,7 +2170,7 @@ static int display_line(FILE *fp, LOFF_T *last_pos, struct Line **line_info,
 
   /* end the last color pattern (needed by S-Lang) */
   if (special || ((col != win_pager->state.cols) && (flags & (MUTT_SHOWCOLOR | MUTT_SEARCH))))
-    resolve_color(*line_info, n, vch, flags, 0, &a);
+    resolve_color(*line_info, n, vch, flags, 0, &a, NULL);
 
   /* Fill the blank space at the end of the line with the prevailing color.
    * ncurses does an implicit clrtoeol() when you do mutt_window_addch('\n') so we have
@@ -2192,7 +2352,7 @@ static void pager_custom_redraw(struct Menu *pager_menu)
     int j = -1;
     while (display_line(rd->fp, &rd->last_pos, &rd->line_info, ++i, &rd->last_line,
                         &rd->max_line, rd->has_types | rd->search_flag | (rd->flags & MUTT_PAGER_NOWRAP),
-                        &rd->quote_list, &rd->q_level, &rd->force_redraw,
+                        &rd->quote_list, rd->quote_hash, &rd->q_level, &rd->force_redraw,
                         &rd->search_re, rd->extra->win_pager) == 0)
     {
       if (!rd->line_info[i].continuation && (++j == rd->lines))
@@ -2221,7 +2381,7 @@ static void pager_custom_redraw(struct Menu *pager_menu)
                          &rd->last_line, &rd->max_line,
                          (rd->flags & MUTT_DISPLAYFLAGS) | rd->hide_quoted |
                              rd->search_flag | (rd->flags & MUTT_PAGER_NOWRAP),
-                         &rd->quote_list, &rd->q_level, &rd->force_redraw,
+                         &rd->quote_list, rd->quote_hash, &rd->q_level, &rd->force_redraw,
                          &rd->search_re, rd->extra->win_pager) > 0)
         {
           rd->lines++;
@@ -2398,6 +2558,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
     return -1;
   }
   unlink(fname);
+  rd.quote_hash = mutt_hash_new(128, MUTT_HASH_NO_FLAGS);
 
   if (rd.extra->win_index)
   {
@@ -2428,6 +2589,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
     (rd.line_info[i].syntax)[0].first = -1;
     (rd.line_info[i].syntax)[0].last = -1;
   }
+  MEM_ACCOUNT(MEM_TAG_PAGER, rd.max_line * (sizeof(struct Line) + sizeof(struct TextSyntax)), 1);
 
   pager_menu = mutt_menu_new(MENU_PAGER);
   pager_menu->pagelen = extra->win_pager->state.rows;
@@ -2631,6 +2793,9 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
 
     rc = ch;
 
+    /* The index above the pager may change, e.g. if the Email is deleted */
+    index_render_invalidate();
+
     switch (ch)
     {
       case OP_EXIT:
@@ -2892,7 +3057,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
           while (display_line(rd.fp, &rd.last_pos, &rd.line_info, line_num,
                               &rd.last_line, &rd.max_line,
                               MUTT_SEARCH | (flags & MUTT_PAGER_NSKIP) | (flags & MUTT_PAGER_NOWRAP),
-                              &rd.quote_list, &rd.q_level, &rd.force_redraw,
+                              &rd.quote_list, rd.quote_hash, &rd.q_level, &rd.force_redraw,
                               &rd.search_re, rd.extra->win_pager) == 0)
           {
             line_num++;
@@ -3011,7 +3176,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
                   (0 == (dretval = display_line(
                              rd.fp, &rd.last_pos, &rd.line_info, new_topline, &rd.last_line,
                              &rd.max_line, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                             &rd.quote_list, &rd.q_level, &rd.force_redraw,
+                             &rd.quote_list, rd.quote_hash, &rd.q_level, &rd.force_redraw,
                              &rd.search_re, rd.extra->win_pager)))) &&
                  IS_HEADER(rd.line_info[new_topline].type))
           {
@@ -3025,7 +3190,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
                 (0 == (dretval = display_line(
                            rd.fp, &rd.last_pos, &rd.line_info, new_topline, &rd.last_line,
                            &rd.max_line, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                           &rd.quote_list, &rd.q_level, &rd.force_redraw,
+                           &rd.quote_list, rd.quote_hash, &rd.q_level, &rd.force_redraw,
                            &rd.search_re, rd.extra->win_pager)))) &&
                (rd.line_info[new_topline + c_skip_quoted_offset].type != MT_COLOR_QUOTED))
         {
@@ -3042,7 +3207,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
                 (0 == (dretval = display_line(
                            rd.fp, &rd.last_pos, &rd.line_info, new_topline, &rd.last_line,
                            &rd.max_line, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                           &rd.quote_list, &rd.q_level, &rd.force_redraw,
+                           &rd.quote_list, rd.quote_hash, &rd.q_level, &rd.force_redraw,
                            &rd.search_re, rd.extra->win_pager)))) &&
                (rd.line_info[new_topline + c_skip_quoted_offset].type == MT_COLOR_QUOTED))
         {
@@ -3078,7 +3243,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
                 (0 == (dretval = display_line(
                            rd.fp, &rd.last_pos, &rd.line_info, new_topline, &rd.last_line,
                            &rd.max_line, MUTT_TYPES | (flags & MUTT_PAGER_NOWRAP),
-                           &rd.quote_list, &rd.q_level, &rd.force_redraw,
+                           &rd.quote_list, rd.quote_hash, &rd.q_level, &rd.force_redraw,
                            &rd.search_re, rd.extra->win_pager)))) &&
                IS_HEADER(rd.line_info[new_topline].type))
         {
@@ -3105,7 +3270,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
           /* make sure the types are defined to the end of file */
           while (display_line(rd.fp, &rd.last_pos, &rd.line_info, line_num, &rd.last_line,
                               &rd.max_line, rd.has_types | (flags & MUTT_PAGER_NOWRAP),
-                              &rd.quote_list, &rd.q_level, &rd.force_redraw,
+                              &rd.quote_list, rd.quote_hash, &rd.q_level, &rd.force_redraw,
                               &rd.search_re, rd.extra->win_pager) == 0)
           {
             line_num++;
@@ -3866,6 +4031,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
     }
   }
 
+  mutt_hash_free(&rd.quote_hash);
   cleanup_quote(&rd.quote_list);
 
   for (size_t i = 0; i < rd.max_line; i++)
@@ -3879,6 +4045,7 @@ int mutt_pager(const char *banner, const char *fname, PagerFlags flags, struct P
     regfree(&rd.search_re);
     rd.search_compiled = false;
   }
+  MEM_ACCOUNT(MEM_TAG_PAGER, -(long) (rd.max_line * (sizeof(struct Line) + sizeof(struct TextSyntax))), -1);
   FREE(&rd.line_info);
   mutt_menu_pop_current(pager_menu);
   mutt_menu_free(&pager_menu);
@@ -74,6 +74,200 @@ enum EatRangeError
 #define KILO 1024
 #define MEGA 1048576
 
+/**
+ * skip_bracket - Skip over a bracket expression in a regex
+ * @param p Opening bracket, '['
+ * @retval ptr  Closing bracket, ']'
+ * @retval NULL Syntax error
+ */
+static const char *skip_bracket(const char *p)
+{
+  p++;
+  if (*p == '^')
+    p++;
+  if (*p == ']')
+    p++;
+
+  for (; *p && (*p != ']'); p++)
+  {
+    /* Character classes, e.g. [:alpha:] */
+    if ((p[0] == '[') && ((p[1] == ':') || (p[1] == '.') || (p[1] == '=')))
+    {
+      const char close[3] = { p[1], ']', '\0' };
+      p = strstr(p + 2, close);
+      if (!p)
+        return NULL;
+      p++;
+    }
+  }
+
+  return *p ? p : NULL;
+}
+
+/**
+ * skip_group - Skip over a parenthesised group in a regex
+ * @param p Opening parenthesis, '('
+ * @retval ptr  Closing parenthesis, ')'
+ * @retval NULL Syntax error
+ */
+static const char *skip_group(const char *p)
+{
+  int depth = 0;
+  for (; *p; p++)
+  {
+    if (*p == '\\')
+    {
+      if (!*++p)
+        return NULL;
+    }
+    else if (*p == '[')
+    {
+      p = skip_bracket(p);
+      if (!p)
+        return NULL;
+    }
+    else if (*p == '(')
+    {
+      depth++;
+    }
+    else if ((*p == ')') && (--depth == 0))
+    {
+      return p;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * end_literal_run - Finish a run of literal characters
+ * @param run  Characters found
+ * @param best Longest run so far
+ */
+static void end_literal_run(struct Buffer *run, struct Buffer *best)
+{
+  if (mutt_buffer_len(run) > mutt_buffer_len(best))
+    mutt_buffer_copy(best, run);
+  mutt_buffer_reset(run);
+}
+
+/**
+ * regex_literal - Find a string that every match of a regex must contain
+ * @param[in]  rx    Extended regular expression
+ * @param[in]  icase The regex ignores case
+ * @param[out] exact Set to true if the regex is just the string
+ * @retval ptr  Longest literal string in the regex
+ * @retval NULL No suitable string
+ *
+ * The regex is only analysed at its top level, e.g. in `foo(bar|baz)+qu?x`,
+ * `foo` is found.  Anything that is unclear, e.g. an alternation, gives up.
+ *
+ * If icase is set, the string must be ASCII to be compared with strcasestr().
+ */
+static char *regex_literal(const char *rx, bool icase, bool *exact)
+{
+  struct Buffer *run = mutt_buffer_pool_get();
+  struct Buffer *best = mutt_buffer_pool_get();
+  char *result = NULL;
+  size_t atom = 0;       // Start of the last character in the run
+  bool last_lit = false; // Was the last atom a literal character?
+  mbstate_t mbstate = { 0 };
+
+  *exact = true;
+  for (const char *p = rx; *p;)
+  {
+    switch (*p)
+    {
+      case '|':
+      case ')':
+        goto done;
+
+      case '*':
+      case '?':
+      case '{':
+        /* The previous character is optional */
+        if (last_lit)
+        {
+          run->data[atom] = '\0';
+          run->dptr = run->data + atom;
+        }
+        end_literal_run(run, best);
+        if (*p == '{')
+        {
+          p = strchr(p, '}');
+          if (!p)
+            goto done;
+        }
+        p++;
+        break;
+
+      case '+':
+      case '.':
+      case '^':
+      case '$':
+        end_literal_run(run, best);
+        p++;
+        break;
+
+      case '[':
+      case '(':
+        end_literal_run(run, best);
+        p = (*p == '[') ? skip_bracket(p) : skip_group(p);
+        if (!p)
+          goto done;
+        p++;
+        break;
+
+      case '\\':
+        if (p[1] == '\0')
+          goto done;
+        /* e.g. \w, \<, \1 */
+        if (isalnum((unsigned char) p[1]) || (p[1] == '<') || (p[1] == '>') ||
+            (p[1] == '`') || (p[1] == '\''))
+        {
+          end_literal_run(run, best);
+          p += 2;
+          break;
+        }
+        atom = mutt_buffer_len(run);
+        mutt_buffer_addch(run, p[1]);
+        p += 2;
+        last_lit = true;
+        continue;
+
+      default:
+      {
+        if (icase && ((unsigned char) *p >= 0x80))
+          goto done;
+        size_t len = mbrlen(p, MB_CUR_MAX, &mbstate);
+        if ((len == (size_t) -1) || (len == (size_t) -2) || (len == 0))
+        {
+          memset(&mbstate, 0, sizeof(mbstate));
+          len = 1;
+        }
+        atom = mutt_buffer_len(run);
+        mutt_buffer_addstr_n(run, p, len);
+        p += len;
+        last_lit = true;
+        continue;
+      }
+    }
+
+    last_lit = false;
+    *exact = false;
+  }
+
+  end_literal_run(run, best);
+  if (!mutt_buffer_is_empty(best))
+    result = mutt_buffer_strdup(best);
+
+done:
+  if (!result)
+    *exact = false;
+  mutt_buffer_pool_release(&run);
+  mutt_buffer_pool_release(&best);
+  return result;
+}
+
 /**
  * eat_regex - Parse a regex - Implements ::eat_arg_t
  */
@@ -108,6 +302,24 @@ static bool eat_regex(struct Pattern *pat, PatternCompFlags flags,
     pat->p.group = mutt_pattern_group(buf.data);
     FREE(&buf.data);
   }
+  else if (flags & MUTT_PC_LAZY_REGEX)
+  {
+    /* Just check the syntax, the regex is compiled by patmatch() */
+    if (!mutt_regex_check(buf.data, NULL, err))
+    {
+      FREE(&buf.data);
+      return false;
+    }
+
+    pat->ign_case = mutt_mb_is_lower(buf.data);
+    bool exact = false;
+    pat->literal = regex_literal(buf.data, pat->ign_case, &exact);
+    pat->literal_only = exact;
+    if (exact)
+      FREE(&buf.data);
+    else
+      pat->lazy_regex = buf.data;
+  }
   else
   {
     pat->p.regex = mutt_mem_malloc(sizeof(regex_t));
@@ -122,6 +334,11 @@ static bool eat_regex(struct Pattern *pat, PatternCompFlags flags,
       FREE(&pat->p.regex);
       return false;
     }
+
+    pat->ign_case = (case_flags != 0);
+    bool exact = false;
+    pat->literal = regex_literal(buf.data, pat->ign_case, &exact);
+    pat->literal_only = exact;
     FREE(&buf.data);
   }
 
@@ -1058,6 +1275,9 @@ void mutt_pattern_free(struct PatternList **pat)
       FREE(&np->p.regex);
     }
 
+    FREE(&np->literal);
+    FREE(&np->lazy_regex);
+    FREE(&np->server_match);
     mutt_pattern_free(&np->child);
     FREE(&np);
 
@@ -1080,6 +1300,138 @@ static struct PatternList *mutt_pattern_node_new(void)
   return h;
 }
 
+/**
+ * pattern_cost - Estimate how expensive a Pattern is to evaluate
+ * @param pat Pattern to check
+ * @retval num Relative cost, e.g. 1 for a flag, 1000 for a body search
+ */
+static int pattern_cost(const struct Pattern *pat)
+{
+  switch (pat->op)
+  {
+    case MUTT_PAT_AND:
+    case MUTT_PAT_OR:
+    {
+      int cost = 0;
+      const struct Pattern *p = NULL;
+      SLIST_FOREACH(p, pat->child, entries)
+      {
+        cost += pattern_cost(p);
+      }
+      return cost;
+    }
+
+    case MUTT_ALL:
+    case MUTT_EXPIRED:
+    case MUTT_SUPERSEDED:
+    case MUTT_FLAG:
+    case MUTT_TAG:
+    case MUTT_NEW:
+    case MUTT_UNREAD:
+    case MUTT_REPLIED:
+    case MUTT_OLD:
+    case MUTT_READ:
+    case MUTT_DELETED:
+    case MUTT_PAT_MESSAGE:
+    case MUTT_PAT_SCORE:
+    case MUTT_PAT_SIZE:
+    case MUTT_PAT_COLLAPSED:
+    case MUTT_PAT_CRYPT_SIGN:
+    case MUTT_PAT_CRYPT_VERIFIED:
+    case MUTT_PAT_CRYPT_ENCRYPT:
+    case MUTT_PAT_PGP_KEY:
+    case MUTT_PAT_DUPLICATED:
+    case MUTT_PAT_UNREFERENCED:
+    case MUTT_PAT_BROKEN:
+      return 1;
+
+    case MUTT_PAT_DATE:
+    case MUTT_PAT_DATE_RECEIVED:
+      /* Dynamic dates are parsed again for every Email */
+      return pat->dynamic ? 5 : 1;
+
+    case MUTT_PAT_SUBJECT:
+    case MUTT_PAT_ID:
+    case MUTT_PAT_ID_EXTERNAL:
+    case MUTT_PAT_XLABEL:
+    case MUTT_PAT_HORMEL:
+    case MUTT_PAT_REFERENCE:
+      return (pat->string_match || pat->is_multi) ? 2 : 4;
+
+    case MUTT_PAT_THREAD:
+    case MUTT_PAT_PARENT:
+    case MUTT_PAT_CHILDREN:
+      return 100;
+
+    case MUTT_PAT_MIMEATTACH:
+    case MUTT_PAT_MIMETYPE:
+      /* These may need to parse the message */
+      return 500;
+
+    case MUTT_PAT_BODY:
+    case MUTT_PAT_HEADER:
+    case MUTT_PAT_WHOLE_MSG:
+      return 1000;
+
+    default:
+      /* Addresses, mailing lists, tags, etc */
+      return 10;
+  }
+}
+
+/**
+ * pattern_reorder - Put the cheapest Patterns first
+ * @param pl List of Patterns
+ *
+ * The arguments of the logical operators are sorted by pattern_cost(), so that
+ * the expensive checks, e.g. searching the body, can be skipped if a cheap
+ * check, e.g. a flag, decides the result.  Patterns of equal cost are left
+ * in the order the user wrote them.
+ */
+static void pattern_reorder(struct PatternList *pl)
+{
+  struct PatternList sorted = SLIST_HEAD_INITIALIZER(sorted);
+  struct Pattern *last = NULL;
+  int last_cost = 0;
+
+  while (!SLIST_EMPTY(pl))
+  {
+    struct Pattern *pat = SLIST_FIRST(pl);
+    SLIST_REMOVE_HEAD(pl, entries);
+
+    if ((pat->op == MUTT_PAT_AND) || (pat->op == MUTT_PAT_OR))
+      pattern_reorder(pat->child);
+
+    const int cost = pattern_cost(pat);
+    if (!last || (cost >= last_cost))
+    {
+      /* Most Patterns are already in order, so check the tail first */
+      if (last)
+        SLIST_INSERT_AFTER(last, pat, entries);
+      else
+        SLIST_INSERT_HEAD(&sorted, pat, entries);
+      last = pat;
+      last_cost = cost;
+      continue;
+    }
+
+    struct Pattern *prev = NULL;
+    struct Pattern *np = SLIST_FIRST(&sorted);
+    while (np && (pattern_cost(np) <= cost))
+    {
+      prev = np;
+      np = SLIST_NEXT(np, entries);
+    }
+
+    if (prev)
+      SLIST_INSERT_AFTER(prev, pat, entries);
+    else
+      SLIST_INSERT_HEAD(&sorted, pat, entries);
+  }
+
+  *pl = sorted;
+}
+
 /**
  * mutt_pattern_comp - Create a Pattern
  * @param m     Mailbox
@@ -1361,6 +1713,8 @@ struct PatternList *mutt_pattern_comp(struct Mailbox *m, struct Menu *menu, cons
     curlist = tmp;
   }
 
+  pattern_reorder(curlist);
+
   return curlist;
 
 cleanup:
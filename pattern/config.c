@@ -39,6 +39,11 @@ static struct ConfigDef PatternVars[] = {
   { "pattern_format", DT_STRING, IP "%2n %-15e  %d", 0, NULL,
     "printf-like format string for the pattern completion menu"
   },
+#ifdef USE_HCACHE
+  { "search_index", DT_BOOL, false, 0, NULL,
+    "Keep a summary of the local messages in the header cache to speed up searching"
+  },
+#endif
   { "thorough_search", DT_BOOL, true, 0, NULL,
     "Decode headers and messages before searching them"
   },
@@ -28,6 +28,7 @@
  */
 
 #include "config.h"
+#include <ctype.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -39,6 +40,7 @@
 #include "config/lib.h"
 #include "email/lib.h"
 #include "core/lib.h"
+#include "debug/lib.h"
 #include "alias/alias.h" // IWYU pragma: keep
 #include "alias/gui.h"   // IWYU pragma: keep
 #include "alias/lib.h"
@@ -57,6 +59,32 @@
 #include <sys/stat.h>
 #endif
 
+/**
+ * compile_lazy_regex - Compile a Pattern's regex on first use
+ * @param pat Pattern, compiled with #MUTT_PC_LAZY_REGEX
+ * @retval true The regex is ready
+ *
+ * If the regex is invalid, the error is shown once and the Pattern will never
+ * match.
+ */
+static bool compile_lazy_regex(struct Pattern *pat)
+{
+  regex_t *rx = mutt_mem_malloc(sizeof(regex_t));
+  const int flags = REG_NEWLINE | REG_NOSUB | (pat->ign_case ? REG_ICASE : 0);
+  int rc = REG_COMP(rx, pat->lazy_regex, flags);
+  if (rc != 0)
+  {
+    char errmsg[256];
+    regerror(rc, rx, errmsg, sizeof(errmsg));
+    mutt_error("'%s': %s", pat->lazy_regex, errmsg);
+    FREE(&rx);
+  }
+
+  pat->p.regex = rx;
+  FREE(&pat->lazy_regex);
+  return rx;
+}
+
 /**
  * patmatch - Compare a string to a Pattern
  * @param pat Pattern to use
@@ -64,7 +92,7 @@
  * @retval true  Match
  * @retval false No match
  */
-static bool patmatch(const struct Pattern *pat, const char *buf)
+static bool patmatch(struct Pattern *pat, const char *buf)
 {
   if (pat->is_multi)
     return (mutt_list_find(&pat->p.multi_cases, buf) != NULL);
@@ -72,7 +100,58 @@ static bool patmatch(const struct Pattern *pat, const char *buf)
     return pat->ign_case ? strcasestr(buf, pat->p.str) : strstr(buf, pat->p.str);
   if (pat->group_match)
     return mutt_group_match(pat->p.group, buf);
-  return (regexec(pat->p.regex, buf, 0, NULL, 0) == 0);
+  if (pat->literal)
+  {
+    /* Check for the literal first, it's much quicker than the regex */
+    if (!(pat->ign_case ? strcasestr(buf, pat->literal) : strstr(buf, pat->literal)))
+      return false;
+    if (pat->literal_only)
+      return true;
+  }
+  if (pat->lazy_regex && !compile_lazy_regex(pat))
+    return false;
+  return pat->p.regex && (regexec(pat->p.regex, buf, 0, NULL, 0) == 0);
+}
+
+/**
+ * mem_find - Find a string in a block of memory
+ * @param data     Memory to search
+ * @param len      Length of the memory
+ * @param str      String to find
+ * @param ign_case Ignore case, like strcasestr()
+ * @retval true The string was found
+ *
+ * Unlike strstr(), the memory may contain NULs.
+ */
+static bool mem_find(const char *data, size_t len, const char *str, bool ign_case)
+{
+  const size_t slen = strlen(str);
+  if (!ign_case)
+    return (memmem(data, len, str, slen) != NULL);
+
+  if (slen == 0)
+    return true;
+  if (len < slen)
+    return false;
+
+  const int lower = tolower((unsigned char) str[0]);
+  const int upper = toupper((unsigned char) str[0]);
+
+  /* The last place that the string could start */
+  const char *last = data + len - slen;
+  while (data <= last)
+  {
+    /* Jump to the next place that the string could start */
+    const char *lo = memchr(data, lower, last - data + 1);
+    const char *hi = (upper == lower) ? NULL : memchr(data, upper, (lo ? lo : last + 1) - data);
+    const char *p = hi ? hi : lo;
+    if (!p)
+      return false;
+    if (strncasecmp(p, str, slen) == 0)
+      return true;
+    data = p + 1;
+  }
+  return false;
 }
 
 /**
@@ -97,6 +176,152 @@ static void print_crypt_pattern_op_error(int op)
   }
 }
 
+#ifdef HAVE_FOPENCOOKIE
+/**
+ * struct SearchSink - Match a Pattern against text as it's decoded
+ *
+ * The text is split into the same pieces that msg_search() would get by
+ * reading the decoded text with fgets().
+ */
+struct SearchSink
+{
+  struct Pattern *pat;             ///< Pattern to match
+  bool match;                      ///< Has the Pattern matched?
+  char line[256];                  ///< Current line of text
+  size_t len;                      ///< Length of the current line
+#ifdef USE_HCACHE
+  struct SearchIndexBuilder *sib;  ///< Summary of the text, if needed
+#endif
+};
+
+/**
+ * search_sink_line - Match a line of text
+ * @param sink Search sink
+ */
+static void search_sink_line(struct SearchSink *sink)
+{
+  sink->line[sink->len] = '\0';
+  sink->len = 0;
+
+#ifdef USE_HCACHE
+  search_index_add(sink->sib, sink->line);
+#endif
+  if (!sink->match)
+    sink->match = patmatch(sink->pat, sink->line);
+}
+
+/**
+ * search_sink_done - Has the search sink seen enough text?
+ * @param sink Search sink
+ * @retval true The rest of the text can be ignored
+ */
+static bool search_sink_done(const struct SearchSink *sink)
+{
+#ifdef USE_HCACHE
+  /* A summary needs all of the text */
+  if (sink->sib)
+    return false;
+#endif
+  return sink->match;
+}
+
+/**
+ * search_sink_write - Match the text written to a stream - Implements cookie_write_function_t
+ * @param cookie Search sink
+ * @param buf    Text to match
+ * @param size   Length of text
+ * @retval num Number of bytes written, always size
+ */
+static ssize_t search_sink_write(void *cookie, const char *buf, size_t size)
+{
+  struct SearchSink *sink = cookie;
+
+  if (search_sink_done(sink))
+    return size;
+
+  /* Match fgets(line, sizeof(line) - 1, fp) */
+  for (size_t i = 0; i < size; i++)
+  {
+    sink->line[sink->len++] = buf[i];
+    if ((buf[i] == '\n') || (sink->len == (sizeof(sink->line) - 2)))
+      search_sink_line(sink);
+  }
+
+  return size;
+}
+
+/**
+ * msg_search_stream - Decode an email and search it
+ * @param m         Mailbox
+ * @param pat       Pattern to find
+ * @param e         Email
+ * @param msg       Open message
+ * @param summarise Summarise the text for the search index
+ * @retval true Pattern found
+ * @retval false Error or pattern not found
+ *
+ * The text is matched as it's decoded, so it isn't stored.  Once the Pattern
+ * has matched, the rest of the text is ignored.
+ */
+static bool msg_search_stream(struct Mailbox *m, struct Pattern *pat,
+                              struct Email *e, struct Message *msg, bool summarise)
+{
+  struct SearchSink *sink = mutt_mem_calloc(1, sizeof(struct SearchSink));
+  sink->pat = pat;
+
+  cookie_io_functions_t io = { NULL, search_sink_write, NULL, NULL };
+  struct State s = { 0 };
+  s.fp_in = msg->fp;
+  s.flags = MUTT_CHARCONV;
+  s.fp_out = fopencookie(sink, "w", io);
+  if (!s.fp_out)
+  {
+    mutt_perror(_("Error opening 'memory stream'"));
+    FREE(&sink);
+    return false;
+  }
+#ifdef USE_HCACHE
+  if (summarise)
+    sink->sib = search_index_new(pat, e);
+#endif
+
+  bool ok = true;
+  if (pat->op != MUTT_PAT_BODY)
+  {
+    mutt_copy_header(msg->fp, e, s.fp_out, CH_FROM | CH_DECODE, NULL, 0);
+    fflush(s.fp_out);
+  }
+
+  mutt_parse_mime_message(m, e);
+
+  if ((WithCrypto != 0) && (e->security & SEC_ENCRYPT) &&
+      !crypt_valid_passphrase(e->security))
+  {
+    ok = false;
+  }
+  else if (!search_sink_done(sink))
+  {
+    fseeko(msg->fp, e->offset, SEEK_SET);
+    mutt_body_handler(e->body, &s);
+  }
+
+  mutt_file_fclose(&s.fp_out);
+  if (sink->len != 0)
+    search_sink_line(sink);
+
+#ifdef USE_HCACHE
+  if (ok)
+    search_index_save(&sink->sib);
+  else
+    search_index_free(&sink->sib);
+#endif
+
+  bool match = ok && sink->match;
+  FREE(&sink);
+  return match;
+}
+#endif
+
 /**
  * msg_search - Search an email
  * @param m   Mailbox
@@ -108,6 +333,14 @@ static void print_crypt_pattern_op_error(int op)
 static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
 {
   bool match = false;
+  struct Email *e = m->emails[msgno];
+
+#ifdef USE_HCACHE
+  bool summarise = false;
+  if (search_index_check(m, pat, e, &summarise))
+    return false;
+#endif
+
   struct Message *msg = mx_msg_open(m, msgno);
   if (!msg)
   {
@@ -116,7 +349,6 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
 
   FILE *fp = NULL;
   long len = 0;
-  struct Email *e = m->emails[msgno];
 #ifdef USE_FMEMOPEN
   char *temp = NULL;
   size_t tempsize = 0;
@@ -124,8 +356,20 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
   struct stat st;
 #endif
 
-  const bool c_thorough_search =
-      cs_subset_bool(NeoMutt->sub, "thorough_search");
+  static struct ConfigHandle ch_thorough_search = CONFIG_HANDLE("thorough_search");
+  const bool c_thorough_search = cs_handle_bool(&ch_thorough_search, NeoMutt->sub);
+#ifdef HAVE_FOPENCOOKIE
+  if (c_thorough_search && (pat->op != MUTT_PAT_HEADER))
+  {
+#ifdef USE_HCACHE
+    match = msg_search_stream(m, pat, e, msg, summarise);
+#else
+    match = msg_search_stream(m, pat, e, msg, false);
+#endif
+    mx_msg_close(m, &msg);
+    return match;
+  }
+#endif
   if (c_thorough_search)
   {
     /* decode the header / body */
@@ -221,29 +465,79 @@ static bool msg_search(struct Mailbox *m, struct Pattern *pat, int msgno)
     }
   }
 
-  size_t blen = 256;
-  char *buf = mutt_mem_malloc(blen);
+  /* Scan the raw message in memory, rather than through stdio */
+  const char *map = NULL;
+  if (!c_thorough_search && (pat->op != MUTT_PAT_HEADER) && mx_msg_map(m, msg))
+  {
+    const LOFF_T start = (pat->op == MUTT_PAT_BODY) ? e->body->offset : e->offset;
+    if ((start >= 0) && ((size_t) start <= msg->map.len))
+    {
+      map = msg->map.data + start;
+      len = MIN((size_t) len, msg->map.len - start);
+    }
+  }
+
+  struct Buffer *buf = mutt_buffer_pool_get();
+#ifdef USE_HCACHE
+  struct SearchIndexBuilder *sib = summarise ? search_index_new(pat, e) : NULL;
+  if (!sib)
+#endif
+  {
+    /* A line can only match if the message contains the literal */
+    const char *lit = pat->string_match ? pat->p.str : pat->literal;
+    if (map && lit && !pat->is_multi && !pat->group_match &&
+        !mem_find(map, len, lit, pat->ign_case))
+    {
+      len = 0;
+    }
+  }
 
   /* search the file "fp" */
   while (len > 0)
   {
-    if (pat->op == MUTT_PAT_HEADER)
+    size_t bytes;
+    if (map)
     {
-      buf = mutt_rfc822_read_line(fp, buf, &blen);
-      if (*buf == '\0')
+      const char *eol = memchr(map, '\n', len);
+      bytes = eol ? (eol - map + 1) : len;
+      mutt_buffer_strcpy_n(buf, map, bytes);
+      map += bytes;
+    }
+    else if (pat->op == MUTT_PAT_HEADER)
+    {
+      bytes = mutt_rfc822_read_line(fp, buf);
+      if (bytes == 0)
         break;
     }
-    else if (!fgets(buf, blen - 1, fp))
-      break; /* don't loop forever */
-    if (patmatch(pat, buf))
+    else
+    {
+      if (!fgets(buf->data, buf->dsize - 1, fp))
+        break; /* don't loop forever */
+      bytes = mutt_str_len(buf->data);
+    }
+    const char *line = buf->data;
+#ifdef USE_HCACHE
+    /* To summarise a message, all of it must be read */
+    if (sib)
+    {
+      search_index_add(sib, line);
+      match = match || patmatch(pat, line);
+      len -= bytes;
+      continue;
+    }
+#endif
+    if (patmatch(pat, line))
     {
       match = true;
       break;
     }
-    len -= mutt_str_len(buf);
+    len -= bytes;
   }
 
-  FREE(&buf);
+#ifdef USE_HCACHE
+  search_index_save(&sib);
+#endif
+  mutt_buffer_pool_release(&buf);
 
   mx_msg_close(m, &msg);
 
@@ -568,7 +862,7 @@ static int match_threadchildren(struct PatternList *pat, PatternExecFlags flags,
  * @retval true  Success, pattern matched
  * @retval false Pattern did not match
  */
-static bool match_content_type(const struct Pattern *pat, struct Body *b)
+static bool match_content_type(struct Pattern *pat, struct Body *b)
 {
   if (!b)
     return false;
@@ -593,7 +887,7 @@ static bool match_content_type(const struct Pattern *pat, struct Body *b)
  * @retval true  Success, pattern matched
  * @retval false Pattern did not match
  */
-static bool match_mime_content_type(const struct Pattern *pat,
+static bool match_mime_content_type(struct Pattern *pat,
                                     struct Mailbox *m, struct Email *e)
 {
   mutt_parse_mime_message(m, e);
@@ -742,6 +1036,10 @@ static int msg_search_sendmode(struct Email *e, struct Pattern *pat)
 int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags,
                       struct Mailbox *m, struct Email *e, struct PatternCache *cache)
 {
+  PERF_SCOPE("mutt_pattern_exec");
+
+  email_env_load(e);
+
   switch (pat->op)
   {
     case MUTT_PAT_AND:
@@ -805,6 +1103,13 @@ int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags,
       /* IMAP search sets e->matched at search compile time */
       if ((m->type == MUTT_IMAP) && pat->string_match)
         return e->matched;
+      /* IMAP search may have found the messages containing the regex's literal */
+      if ((m->type == MUTT_IMAP) && pat->server_match &&
+          (pat->num_server_match == m->msg_count) && (e->index < m->msg_count) &&
+          !pat->server_match[e->index])
+      {
+        return pat->pat_not;
+      }
 #endif
       return pat->pat_not ^ msg_search(m, pat, e->msgno);
     case MUTT_PAT_SERVERSEARCH:
@@ -990,10 +1295,8 @@ int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags,
       return pat->pat_not ^ (e->env->x_label && patmatch(pat, e->env->x_label));
     case MUTT_PAT_DRIVER_TAGS:
     {
-      char *tags = driver_tags_get(&e->tags);
-      bool rc = (pat->pat_not ^ (tags && patmatch(pat, tags)));
-      FREE(&tags);
-      return rc;
+      const char *tags = driver_tags_get(&e->tags);
+      return pat->pat_not ^ (tags && patmatch(pat, tags));
     }
     case MUTT_PAT_HORMEL:
       if (!e->env)
@@ -1028,6 +1331,139 @@ int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags,
   return 0;
 }
 
+/**
+ * pattern_thread_safe - Can a Pattern be run on a worker thread?
+ * @param pat  Pattern to check
+ * @param tree Pattern may look at other Emails in the thread
+ * @retval true The Pattern doesn't do any I/O or touch any shared state
+ */
+static bool pattern_thread_safe(const struct Pattern *pat, bool tree)
+{
+  /* Compiling a lazy regex changes the Pattern */
+  if (pat->lazy_regex)
+    return false;
+
+  switch (pat->op)
+  {
+    case MUTT_PAT_AND:
+    case MUTT_PAT_OR:
+      return mutt_pattern_thread_safe(pat->child, tree);
+
+    case MUTT_PAT_THREAD:
+    case MUTT_PAT_PARENT:
+    case MUTT_PAT_CHILDREN:
+      return tree && mutt_pattern_thread_safe(pat->child, tree);
+
+    case MUTT_PAT_DATE:
+    case MUTT_PAT_DATE_RECEIVED:
+      /* Dynamic dates use the Buffer pool */
+      return !pat->dynamic;
+
+    case MUTT_PAT_CRYPT_SIGN:
+    case MUTT_PAT_CRYPT_VERIFIED:
+    case MUTT_PAT_CRYPT_ENCRYPT:
+      return WithCrypto;
+    case MUTT_PAT_PGP_KEY:
+      return (WithCrypto & APPLICATION_PGP);
+
+    case MUTT_ALL:
+    case MUTT_EXPIRED:
+    case MUTT_SUPERSEDED:
+    case MUTT_FLAG:
+    case MUTT_TAG:
+    case MUTT_NEW:
+    case MUTT_UNREAD:
+    case MUTT_REPLIED:
+    case MUTT_OLD:
+    case MUTT_READ:
+    case MUTT_DELETED:
+    case MUTT_PAT_MESSAGE:
+    case MUTT_PAT_SENDER:
+    case MUTT_PAT_FROM:
+    case MUTT_PAT_TO:
+    case MUTT_PAT_CC:
+    case MUTT_PAT_SUBJECT:
+    case MUTT_PAT_ID:
+    case MUTT_PAT_ID_EXTERNAL:
+    case MUTT_PAT_SCORE:
+    case MUTT_PAT_SIZE:
+    case MUTT_PAT_REFERENCE:
+    case MUTT_PAT_ADDRESS:
+    case MUTT_PAT_RECIPIENT:
+    case MUTT_PAT_XLABEL:
+    case MUTT_PAT_DRIVER_TAGS:
+    case MUTT_PAT_HORMEL:
+    case MUTT_PAT_DUPLICATED:
+    case MUTT_PAT_UNREFERENCED:
+    case MUTT_PAT_BROKEN:
+#ifdef USE_NNTP
+    case MUTT_PAT_NEWSGROUPS:
+#endif
+      return true;
+
+    default:
+      /* e.g. body searches, MIME parsing, config lookups, error messages */
+      return false;
+  }
+}
+
+/**
+ * mutt_pattern_thread_safe - Can a Pattern be run on a worker thread?
+ * @param pat  Pattern to check
+ * @param tree Pattern may look at other Emails in the thread
+ * @retval true The Pattern only reads the Emails, so can be run on many at once
+ *
+ * Set tree to false if the caller changes the Emails, e.g. tagging, while
+ * matching.  The thread patterns, e.g. `~(...)`, would then give different
+ * results depending on the order of the Emails.
+ */
+bool mutt_pattern_thread_safe(const struct PatternList *pat, bool tree)
+{
+  if (!pat)
+    return false;
+
+  const struct Pattern *p = NULL;
+  SLIST_FOREACH(p, pat, entries)
+  {
+    if (!pattern_thread_safe(p, tree))
+      return false;
+  }
+  return true;
+}
+
+/**
+ * mutt_pattern_reads_message - Does a Pattern read the messages?
+ * @param pat Pattern to check
+ * @retval true The Pattern searches the headers or body of each message
+ *
+ * If so, the caller can read the messages ahead of the search.
+ */
+bool mutt_pattern_reads_message(const struct PatternList *pat)
+{
+  if (!pat)
+    return false;
+
+  const struct Pattern *p = NULL;
+  SLIST_FOREACH(p, pat, entries)
+  {
+    switch (p->op)
+    {
+      case MUTT_PAT_AND:
+      case MUTT_PAT_OR:
+        if (mutt_pattern_reads_message(p->child))
+          return true;
+        break;
+      case MUTT_PAT_BODY:
+      case MUTT_PAT_HEADER:
+      case MUTT_PAT_WHOLE_MSG:
+        return true;
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
 /**
  * mutt_pattern_alias_exec - Match a pattern against an alias
  * @param pat   Pattern to match
@@ -26,14 +26,15 @@
  *
  * Match patterns to emails
  *
- * | File                 | Description                 |
- * | :------------------- | :-------------------------- |
- * | pattern/compile.c    | @subpage pattern_compile    |
- * | pattern/config.c     | @subpage pattern_config     |
- * | pattern/dlgpattern.c | @subpage pattern_dlgpattern |
- * | pattern/exec.c       | @subpage pattern_exec       |
- * | pattern/flags.c      | @subpage pattern_flags      |
- * | pattern/pattern.c    | @subpage pattern_pattern    |
+ * | File                   | Description                   |
+ * | :--------------------- | :---------------------------- |
+ * | pattern/compile.c      | @subpage pattern_compile      |
+ * | pattern/config.c       | @subpage pattern_config       |
+ * | pattern/dlgpattern.c   | @subpage pattern_dlgpattern   |
+ * | pattern/exec.c         | @subpage pattern_exec         |
+ * | pattern/flags.c        | @subpage pattern_flags        |
+ * | pattern/pattern.c      | @subpage pattern_pattern      |
+ * | pattern/search_index.c | @subpage pattern_search_index |
  */
 
 #ifndef MUTT_PATTERN_LIB_H
@@ -61,6 +62,7 @@ typedef uint8_t PatternCompFlags;           ///< Flags for mutt_pattern_comp(),
 #define MUTT_PC_FULL_MSG          (1 << 0)  ///< Enable body and header matching
 #define MUTT_PC_PATTERN_DYNAMIC   (1 << 1)  ///< Enable runtime date range evaluation
 #define MUTT_PC_SEND_MODE_SEARCH  (1 << 2)  ///< Allow send-mode body searching
+#define MUTT_PC_LAZY_REGEX        (1 << 3)  ///< Compile the regexes when they're first used
 
 /**
  * struct Pattern - A simple (non-regex) pattern
@@ -72,14 +74,19 @@ struct Pattern
   bool all_addr     : 1;         ///< All Addresses in the list must match
   bool string_match : 1;         ///< Check a string for a match
   bool group_match  : 1;         ///< Check a group of Addresses
-  bool ign_case     : 1;         ///< Ignore case for local string_match searches
+  bool ign_case     : 1;         ///< Ignore case for local string_match searches, or the literal
   bool is_alias     : 1;         ///< Is there an alias for this Address?
   bool dynamic      : 1;         ///< Evaluate date ranges at run time
   bool sendmode     : 1;         ///< Evaluate searches in send-mode
   bool is_multi     : 1;         ///< Multiple case (only for ~I pattern now)
+  bool literal_only : 1;         ///< The regex is just the literal string
   int min;                       ///< Minimum for range checks
   int max;                       ///< Maximum for range checks
   struct PatternList *child;     ///< Arguments to logical operation
+  char *literal;                 ///< String that every match of the regex contains
+  char *lazy_regex;              ///< Regex to compile when it's first used, see #MUTT_PC_LAZY_REGEX
+  bool *server_match;            ///< Server search for the literal, indexed by Email.index
+  int num_server_match;          ///< Number of entries in server_match
   union {
     regex_t *regex;              ///< Compiled regex, for non-pattern matching
     struct Group *group;         ///< Address group if group_match is set
@@ -172,6 +179,8 @@ enum PatternType
 
 int mutt_pattern_exec(struct Pattern *pat, PatternExecFlags flags, struct Mailbox *m,
                       struct Email *e, struct PatternCache *cache);
+bool mutt_pattern_reads_message(const struct PatternList *pat);
+bool mutt_pattern_thread_safe(const struct PatternList *pat, bool tree);
 int mutt_pattern_alias_exec(struct Pattern *pat, PatternExecFlags flags,
                             struct AliasView *av, struct PatternCache *cache);
 
@@ -183,6 +192,7 @@ bool dlg_select_pattern(char *buf, size_t buflen);
 int mutt_which_case(const char *s);
 int mutt_is_list_recipient(bool all_addr, struct Envelope *e);
 int mutt_is_subscribed_list_recipient(bool all_addr, struct Envelope *e);
+int mutt_pattern_apply(struct Context *ctx, int op, const char *pattern);
 int mutt_pattern_func(struct Context *ctx, int op, char *prompt);
 int mutt_pattern_alias_func(int op, char *prompt, char *menu_name, struct AliasMenuData *mdata, struct Menu *menu);
 int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op);
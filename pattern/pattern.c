@@ -87,6 +87,23 @@ static struct PatternList *SearchPattern = NULL; ///< current search pattern
 static char LastSearch[256] = { 0 };             ///< last pattern searched for
 static char LastSearchExpn[1024] = { 0 }; ///< expanded version of LastSearch
 
+/// Minimum number of Emails worth matching on the worker threads
+#define PATTERN_PARALLEL_MIN 4096
+#define PATTERN_PREFETCH 32 ///< Number of messages to read ahead of a search
+
+/**
+ * struct PatternRun - A range of Emails to match against a Pattern
+ */
+struct PatternRun
+{
+  struct Pattern *pat; ///< Pattern to match
+  struct Mailbox *m;   ///< Mailbox
+  bool virt;           ///< Use the virtual (visible) index of the Emails
+  int start;           ///< First Email
+  int end;             ///< One past the last Email
+  bool *matched;       ///< Results, indexed by Email
+};
+
 /**
  * quote_simple - Apply simple quoting to a string
  * @param str    String to quote
@@ -203,6 +220,7 @@ bool mutt_limit_current_thread(struct Context *ctx, struct Email *e)
   m->vcount = 0;
   ctx->vsize = 0;
   ctx->collapsed = false;
+  ctx->limit_seq = 0;
 
   for (int i = 0; i < m->msg_count; i++)
   {
@@ -210,6 +228,7 @@ bool mutt_limit_current_thread(struct Context *ctx, struct Email *e)
     if (!e)
       break;
 
+    ctx->limit_seq = MAX(ctx->limit_seq, e->sequence + 1);
     e->vnum = -1;
     e->visible = false;
     e->collapsed = false;
@@ -333,6 +352,87 @@ bail:
   return rc;
 }
 
+/**
+ * pattern_run - Match a range of Emails - Implements ::worker_task_t
+ */
+static void pattern_run(void *item)
+{
+  struct PatternRun *run = item;
+
+  for (int i = run->start; i < run->end; i++)
+  {
+    struct Email *e = run->virt ? mutt_get_virt_email(run->m, i) : run->m->emails[i];
+    run->matched[i] =
+        e && (mutt_pattern_exec(run->pat, MUTT_MATCH_FULL_ADDRESS, run->m, e, NULL) != 0);
+  }
+}
+
+/**
+ * pattern_match_parallel - Match many Emails against a Pattern on the worker threads
+ * @param m    Mailbox
+ * @param pat  Pattern to match
+ * @param num  Number of Emails
+ * @param virt If true, use the virtual (visible) index of the Emails
+ * @param tree If true, the Emails won't change while matching
+ * @retval ptr  Array of results, one per Email
+ * @retval NULL The Pattern must be matched on the main thread
+ *
+ * The caller must free the results.
+ */
+static bool *pattern_match_parallel(struct Mailbox *m, struct PatternList *pat,
+                                    int num, bool virt, bool tree)
+{
+  if ((num < PATTERN_PARALLEL_MIN) || !mutt_pattern_thread_safe(pat, tree))
+    return NULL;
+
+  const int workers = mutt_worker_count();
+  if (workers < 2)
+    return NULL;
+
+  /* Smaller slices share the work more evenly if some Emails are slower */
+  const int num_runs = workers * 4;
+  const int slice = (num + num_runs - 1) / num_runs;
+
+  /* The Envelopes can't be decoded on the worker threads */
+  for (int i = 0; i < num; i++)
+    email_env_load(virt ? mutt_get_virt_email(m, i) : m->emails[i]);
+
+  bool *matched = mutt_mem_calloc(num, sizeof(bool));
+  struct PatternRun *runs = mutt_mem_calloc(num_runs, sizeof(struct PatternRun));
+  for (int i = 0; i < num_runs; i++)
+  {
+    runs[i].pat = SLIST_FIRST(pat);
+    runs[i].m = m;
+    runs[i].virt = virt;
+    runs[i].start = MIN(i * slice, num);
+    runs[i].end = MIN(runs[i].start + slice, num);
+    runs[i].matched = matched;
+  }
+
+  mutt_worker_run(pattern_run, runs, sizeof(struct PatternRun), num_runs);
+  FREE(&runs);
+
+  return matched;
+}
+
+/**
+ * pattern_prefetch - Read a message ahead of the search
+ * @param m    Mailbox
+ * @param i    Index of the Email
+ * @param num  Number of Emails being searched
+ * @param virt If true, use the virtual (visible) index of the Emails
+ *
+ * Searching a message's text blocks on reading it.  Starting to read the next
+ * few messages early lets the device fetch them all in parallel.
+ */
+static void pattern_prefetch(struct Mailbox *m, int i, int num, bool virt)
+{
+  if (i >= num)
+    return;
+
+  mx_msg_prefetch(m, virt ? mutt_get_virt_email(m, i) : m->emails[i]);
+}
+
 /**
  * mutt_pattern_func - Perform some Pattern matching
  * @param ctx    Current Mailbox
@@ -346,11 +446,6 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
   if (!ctx || !ctx->mailbox)
     return -1;
 
-  struct Mailbox *m = ctx->mailbox;
-
-  struct Buffer err;
-  int rc = -1;
-  struct Progress progress;
   struct Buffer *buf = mutt_buffer_pool_get();
 
   mutt_buffer_strcpy(buf, NONULL(ctx->pattern));
@@ -367,6 +462,34 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
 
   mutt_message(_("Compiling search pattern..."));
 
+  const int rc = mutt_pattern_apply(ctx, op, mutt_buffer_string(buf));
+  mutt_buffer_pool_release(&buf);
+  return rc;
+}
+
+/**
+ * mutt_pattern_apply - Perform some Pattern matching, without prompting
+ * @param ctx     Current Mailbox
+ * @param op      Operation to perform, e.g. #MUTT_LIMIT
+ * @param pattern Pattern to match, may use $simple_search
+ * @retval  0 Success
+ * @retval -1 Failure
+ *
+ * Apart from #MUTT_LIMIT, the operations only affect the visible Emails.
+ */
+int mutt_pattern_apply(struct Context *ctx, int op, const char *pattern)
+{
+  if (!ctx || !ctx->mailbox || !pattern)
+    return -1;
+
+  struct Mailbox *m = ctx->mailbox;
+
+  struct Buffer err;
+  int rc = -1;
+  struct Progress progress;
+  struct Buffer *buf = mutt_buffer_pool_get();
+  mutt_buffer_strcpy(buf, pattern);
+
   char *simple = mutt_buffer_strdup(buf);
   const char *const c_simple_search =
       cs_subset_string(NeoMutt->sub, "simple_search");
@@ -395,27 +518,45 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
   mutt_progress_init(&progress, _("Executing command on matching messages..."),
                      MUTT_PROGRESS_READ, (op == MUTT_LIMIT) ? m->msg_count : m->vcount);
 
-  if (op == MUTT_LIMIT)
+#ifdef USE_HCACHE
+  search_index_open(m);
+#endif
+
+  if ((op == MUTT_UNTAG) && (m->msg_tagged == 0))
+  {
+    mutt_debug(LL_DEBUG1, "no tagged emails\n");
+  }
+  else if (op == MUTT_LIMIT)
   {
     m->vcount = 0;
     ctx->vsize = 0;
     ctx->collapsed = false;
+    ctx->limit_seq = 0;
     int padding = mx_msg_padding_size(m);
 
-    for (int i = 0; i < m->msg_count; i++)
+    int num = 0;
+    while ((num < m->msg_count) && m->emails[num])
+      num++;
+    bool *matched = match_all ? NULL : pattern_match_parallel(m, pat, num, false, true);
+    const bool prefetch = !match_all && !matched && mutt_pattern_reads_message(pat);
+    for (int i = 0; prefetch && (i < PATTERN_PREFETCH); i++)
+      pattern_prefetch(m, i, num, false);
+
+    for (int i = 0; i < num; i++)
     {
       struct Email *e = m->emails[i];
-      if (!e)
-        break;
+      if (prefetch)
+        pattern_prefetch(m, i + PATTERN_PREFETCH, num, false);
 
       mutt_progress_update(&progress, i, -1);
+      ctx->limit_seq = MAX(ctx->limit_seq, e->sequence + 1);
       /* new limit pattern implicitly uncollapses all threads */
       e->vnum = -1;
       e->visible = false;
       e->collapsed = false;
       e->num_hidden = 0;
-      if (match_all ||
-          mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
+      if (match_all || (matched ? matched[i] :
+          mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL)))
       {
         e->vnum = m->vcount;
         e->visible = true;
@@ -425,16 +566,26 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
         ctx->vsize += b->length + b->offset - b->hdr_offset + padding;
       }
     }
+    FREE(&matched);
   }
   else
   {
+    /* Changing the flags could affect the thread patterns of later Emails */
+    bool *matched = match_all ? NULL : pattern_match_parallel(m, pat, m->vcount, true, false);
+    const bool prefetch = !match_all && !matched && mutt_pattern_reads_message(pat);
+    for (int i = 0; prefetch && (i < PATTERN_PREFETCH); i++)
+      pattern_prefetch(m, i, m->vcount, true);
+
     for (int i = 0; i < m->vcount; i++)
     {
+      if (prefetch)
+        pattern_prefetch(m, i + PATTERN_PREFETCH, m->vcount, true);
       struct Email *e = mutt_get_virt_email(m, i);
       if (!e)
         continue;
       mutt_progress_update(&progress, i, -1);
-      if (mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL))
+      if (match_all || (matched ? matched[i] :
+                        mutt_pattern_exec(SLIST_FIRST(pat), MUTT_MATCH_FULL_ADDRESS, m, e, NULL)))
       {
         switch (op)
         {
@@ -451,8 +602,13 @@ int mutt_pattern_func(struct Context *ctx, int op, char *prompt)
         }
       }
     }
+    FREE(&matched);
   }
 
+#ifdef USE_HCACHE
+  search_index_close();
+#endif
+
   mutt_clear_error();
 
   if (op == MUTT_LIMIT)
@@ -486,88 +642,76 @@ bail:
 }
 
 /**
- * mutt_search_command - Perform a search
- * @param m    Mailbox to search through
- * @param menu Current Menu
- * @param cur  Index number of current email
- * @param op   Operation to perform, e.g. OP_SEARCH_NEXT
- * @retval >=0 Index of matching email
- * @retval -1  No match, or error
+ * search_prefetch - Read a message ahead of the search
+ * @param m    Mailbox
+ * @param cur  Index number of current Email
+ * @param incr Direction to search, 1 or -1
+ * @param j    Number of Emails past the current one
+ *
+ * Only Emails that haven't been searched yet are read.
  */
-int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
+static void search_prefetch(struct Mailbox *m, int cur, int incr, int j)
 {
-  struct Progress progress;
+  if (j >= m->vcount)
+    return;
 
-  if ((*LastSearch == '\0') || ((op != OP_SEARCH_NEXT) && (op != OP_SEARCH_OPPOSITE)))
+  int i = cur + (incr * (j + 1));
+  if ((i < 0) || (i >= m->vcount))
   {
-    char buf[256];
-    mutt_str_copy(buf, (LastSearch[0] != '\0') ? LastSearch : "", sizeof(buf));
-    if ((mutt_get_field(
-             ((op == OP_SEARCH) || (op == OP_SEARCH_NEXT)) ? _("Search for: ") : _("Reverse search for: "),
-             buf, sizeof(buf), MUTT_CLEAR | MUTT_PATTERN, false, NULL, NULL) != 0) ||
-        (buf[0] == '\0'))
-    {
-      return -1;
-    }
-
-    if ((op == OP_SEARCH) || (op == OP_SEARCH_NEXT))
-      OptSearchReverse = false;
-    else
-      OptSearchReverse = true;
-
-    /* compare the *expanded* version of the search pattern in case
-     * $simple_search has changed while we were searching */
-    struct Buffer *tmp = mutt_buffer_pool_get();
-    mutt_buffer_strcpy(tmp, buf);
-    const char *const c_simple_search =
-        cs_subset_string(NeoMutt->sub, "simple_search");
-    mutt_check_simple(tmp, NONULL(c_simple_search));
+    const bool c_wrap_search = cs_subset_bool(NeoMutt->sub, "wrap_search");
+    if (!c_wrap_search)
+      return;
+    i = ((i % m->vcount) + m->vcount) % m->vcount;
+  }
 
-    if (!SearchPattern || !mutt_str_equal(mutt_buffer_string(tmp), LastSearchExpn))
-    {
-      struct Buffer err;
-      mutt_buffer_init(&err);
-      OptSearchInvalid = true;
-      mutt_str_copy(LastSearch, buf, sizeof(LastSearch));
-      mutt_str_copy(LastSearchExpn, mutt_buffer_string(tmp), sizeof(LastSearchExpn));
-      mutt_message(_("Compiling search pattern..."));
-      mutt_pattern_free(&SearchPattern);
-      err.dsize = 256;
-      err.data = mutt_mem_malloc(err.dsize);
-      SearchPattern = mutt_pattern_comp(m, menu, tmp->data, MUTT_PC_FULL_MSG, &err);
-      if (!SearchPattern)
-      {
-        mutt_buffer_pool_release(&tmp);
-        mutt_error("%s", err.data);
-        FREE(&err.data);
-        LastSearch[0] = '\0';
-        LastSearchExpn[0] = '\0';
-        return -1;
-      }
-      FREE(&err.data);
-      mutt_clear_error();
-    }
+  struct Email *e = mutt_get_virt_email(m, i);
+  if (e && !e->searched)
+    mx_msg_prefetch(m, e);
+}
 
-    mutt_buffer_pool_release(&tmp);
-  }
+/**
+ * search_match_all - Match all the visible Emails against the search Pattern
+ * @param m Mailbox
+ *
+ * If the Pattern can be run on the worker threads, every visible Email is
+ * matched at once.  The results are kept in Email::searched and
+ * Email::matched, so each search-next only has to look at the flags.
+ */
+static void search_match_all(struct Mailbox *m)
+{
+  bool *matched = pattern_match_parallel(m, SearchPattern, m->vcount, true, true);
+  if (!matched)
+    return;
 
-  if (OptSearchInvalid)
+  for (int i = 0; i < m->vcount; i++)
   {
-    for (int i = 0; i < m->msg_count; i++)
-      m->emails[i]->searched = false;
-#ifdef USE_IMAP
-    if ((m->type == MUTT_IMAP) && (!imap_search(m, SearchPattern)))
-      return -1;
-#endif
-    OptSearchInvalid = false;
+    struct Email *e = mutt_get_virt_email(m, i);
+    if (!e)
+      continue;
+    e->searched = true;
+    e->matched = matched[i];
   }
+  FREE(&matched);
+}
 
-  int incr = OptSearchReverse ? -1 : 1;
-  if (op == OP_SEARCH_OPPOSITE)
-    incr = -incr;
+/**
+ * search_messages - Find the next Email matching the search Pattern
+ * @param m    Mailbox
+ * @param cur  Index number of current Email
+ * @param incr Direction to search, 1 or -1
+ * @retval >=0 Index number of matching Email
+ * @retval -1  No match
+ */
+static int search_messages(struct Mailbox *m, int cur, int incr)
+{
+  struct Progress progress;
 
   mutt_progress_init(&progress, _("Searching..."), MUTT_PROGRESS_READ, m->vcount);
 
+  const bool prefetch = mutt_pattern_reads_message(SearchPattern);
+  for (int j = 0; prefetch && (j < PATTERN_PREFETCH); j++)
+    search_prefetch(m, cur, incr, j);
+
   for (int i = cur + incr, j = 0; j != m->vcount; j++)
   {
     const char *msg = NULL;
@@ -610,6 +754,9 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
     }
     else
     {
+      if (prefetch)
+        search_prefetch(m, cur, incr, j + PATTERN_PREFETCH);
+
       /* remember that we've already searched this message */
       e->searched = true;
       e->matched = mutt_pattern_exec(SLIST_FIRST(SearchPattern),
@@ -637,6 +784,96 @@ int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
   return -1;
 }
 
+/**
+ * mutt_search_command - Perform a search
+ * @param m    Mailbox to search through
+ * @param menu Current Menu
+ * @param cur  Index number of current email
+ * @param op   Operation to perform, e.g. OP_SEARCH_NEXT
+ * @retval >=0 Index of matching email
+ * @retval -1  No match, or error
+ */
+int mutt_search_command(struct Mailbox *m, struct Menu *menu, int cur, int op)
+{
+  if ((*LastSearch == '\0') || ((op != OP_SEARCH_NEXT) && (op != OP_SEARCH_OPPOSITE)))
+  {
+    char buf[256];
+    mutt_str_copy(buf, (LastSearch[0] != '\0') ? LastSearch : "", sizeof(buf));
+    if ((mutt_get_field(
+             ((op == OP_SEARCH) || (op == OP_SEARCH_NEXT)) ? _("Search for: ") : _("Reverse search for: "),
+             buf, sizeof(buf), MUTT_CLEAR | MUTT_PATTERN, false, NULL, NULL) != 0) ||
+        (buf[0] == '\0'))
+    {
+      return -1;
+    }
+
+    if ((op == OP_SEARCH) || (op == OP_SEARCH_NEXT))
+      OptSearchReverse = false;
+    else
+      OptSearchReverse = true;
+
+    /* compare the *expanded* version of the search pattern in case
+     * $simple_search has changed while we were searching */
+    struct Buffer *tmp = mutt_buffer_pool_get();
+    mutt_buffer_strcpy(tmp, buf);
+    const char *const c_simple_search =
+        cs_subset_string(NeoMutt->sub, "simple_search");
+    mutt_check_simple(tmp, NONULL(c_simple_search));
+
+    if (!SearchPattern || !mutt_str_equal(mutt_buffer_string(tmp), LastSearchExpn))
+    {
+      struct Buffer err;
+      mutt_buffer_init(&err);
+      OptSearchInvalid = true;
+      mutt_str_copy(LastSearch, buf, sizeof(LastSearch));
+      mutt_str_copy(LastSearchExpn, mutt_buffer_string(tmp), sizeof(LastSearchExpn));
+      mutt_message(_("Compiling search pattern..."));
+      mutt_pattern_free(&SearchPattern);
+      err.dsize = 256;
+      err.data = mutt_mem_malloc(err.dsize);
+      SearchPattern = mutt_pattern_comp(m, menu, tmp->data, MUTT_PC_FULL_MSG, &err);
+      if (!SearchPattern)
+      {
+        mutt_buffer_pool_release(&tmp);
+        mutt_error("%s", err.data);
+        FREE(&err.data);
+        LastSearch[0] = '\0';
+        LastSearchExpn[0] = '\0';
+        return -1;
+      }
+      FREE(&err.data);
+      mutt_clear_error();
+    }
+
+    mutt_buffer_pool_release(&tmp);
+  }
+
+  if (OptSearchInvalid)
+  {
+    for (int i = 0; i < m->msg_count; i++)
+      m->emails[i]->searched = false;
+#ifdef USE_IMAP
+    if ((m->type == MUTT_IMAP) && (!imap_search(m, SearchPattern)))
+      return -1;
+#endif
+    search_match_all(m);
+    OptSearchInvalid = false;
+  }
+
+  int incr = OptSearchReverse ? -1 : 1;
+  if (op == OP_SEARCH_OPPOSITE)
+    incr = -incr;
+
+#ifdef USE_HCACHE
+  search_index_open(m);
+#endif
+  int rc = search_messages(m, cur, incr);
+#ifdef USE_HCACHE
+  search_index_close();
+#endif
+  return rc;
+}
+
 /**
  * mutt_search_alias_command - Perform a search
  * @param menu Menu to search through
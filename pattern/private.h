@@ -125,4 +125,16 @@ const struct PatternFlags *lookup_op(int op);
 const struct PatternFlags *lookup_tag(char tag);
 bool eval_date_minmax(struct Pattern *pat, const char *s, struct Buffer *err);
 
+#ifdef USE_HCACHE
+struct SearchIndexBuilder;
+
+void search_index_add(struct SearchIndexBuilder *sib, const char *line);
+bool search_index_check(struct Mailbox *m, const struct Pattern *pat, const struct Email *e, bool *summarise);
+void search_index_close(void);
+void search_index_free(struct SearchIndexBuilder **sib);
+struct SearchIndexBuilder *search_index_new(const struct Pattern *pat, const struct Email *e);
+void search_index_open(struct Mailbox *m);
+void search_index_save(struct SearchIndexBuilder **sib);
+#endif
+
 #endif /* MUTT_PATTERN_PRIVATE_H */
@@ -0,0 +1,296 @@
+/**
+ * @file
+ * Index of the words in the local messages
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page pattern_search_index Index of the words in the local messages
+ *
+ * Searching the bodies of a big local Mailbox, e.g. `~b`, means reading every
+ * message.  If `$search_index` is set, a summary of each message's text is
+ * kept in the header cache, so most of the messages can be skipped next time.
+ *
+ * The summary is a Bloom filter of the trigrams (three character sequences)
+ * of the text that was searched.  If any trigram of the search string is
+ * missing, the message can't match.  If they're all present, the message might
+ * match, so it's searched as usual.
+ *
+ * A message is summarised the first time it's searched.  Its key depends on
+ * the Message-Id and the size of the message, so if it's changed, it will be
+ * summarised again.
+ */
+
+#include "config.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "private.h"
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "email/lib.h"
+#include "core/lib.h"
+#include "lib.h"
+#include "hcache/lib.h"
+
+/// Size of a full-size summary, in bytes
+#define SEARCH_INDEX_MAX 8192
+/// Smallest summary, in bytes
+#define SEARCH_INDEX_MIN 16
+
+/**
+ * struct SearchIndexBuilder - A summary of a message being searched
+ */
+struct SearchIndexBuilder
+{
+  struct Buffer *key;  ///< Header cache key of the message
+  unsigned char *bits; ///< Full-size Bloom filter
+  size_t num_bits;     ///< Number of bits set
+};
+
+static struct HeaderCache *SearchCache = NULL; ///< Header cache of the Mailbox being searched
+static struct Mailbox *SearchMailbox = NULL;   ///< Mailbox being searched
+
+/**
+ * trigram_hash - Hash three characters
+ * @param a First character
+ * @param b Second character
+ * @param c Third character
+ * @retval num Bit number in a full-size summary
+ */
+static unsigned int trigram_hash(unsigned char a, unsigned char b, unsigned char c)
+{
+  uint32_t h = ((uint32_t) tolower(a) << 16) | ((uint32_t) tolower(b) << 8) |
+               (uint32_t) tolower(c);
+  h *= 2654435761U;
+  return h >> 16;
+}
+
+/**
+ * search_index_key - Generate the key for a message's summary
+ * @param pat Pattern being matched
+ * @param e   Email
+ * @param key Buffer for the key
+ * @retval true Success
+ */
+static bool search_index_key(const struct Pattern *pat, const struct Email *e,
+                             struct Buffer *key)
+{
+  if (!e->env || !e->env->message_id || !e->body)
+    return false;
+
+  const bool c_thorough_search = cs_subset_bool(NeoMutt->sub, "thorough_search");
+  char region = (pat->op == MUTT_PAT_BODY) ? 'b' : (pat->op == MUTT_PAT_HEADER) ? 'h' : 'B';
+
+  mutt_buffer_printf(key, "/search/%c%c/%s/%ld/%ld", region,
+                     c_thorough_search ? 't' : 'r', e->env->message_id,
+                     (long) (e->body->offset - e->offset), (long) e->body->length);
+  return true;
+}
+
+/**
+ * search_index_open - Start using the summaries of a Mailbox
+ * @param m Mailbox to be searched
+ *
+ * Only the local Mailbox types are summarised.
+ */
+void search_index_open(struct Mailbox *m)
+{
+  search_index_close();
+
+  if (!m || ((m->type != MUTT_MBOX) && (m->type != MUTT_MMDF) &&
+             (m->type != MUTT_MAILDIR) && (m->type != MUTT_MH)))
+  {
+    return;
+  }
+
+  const bool c_search_index = cs_subset_bool(NeoMutt->sub, "search_index");
+  if (!c_search_index)
+    return;
+
+  const char *const c_header_cache = cs_subset_path(NeoMutt->sub, "header_cache");
+  SearchCache = mutt_hcache_open(c_header_cache, mailbox_path(m), NULL);
+  if (!SearchCache)
+    return;
+
+  mutt_hcache_begin_txn(SearchCache);
+  SearchMailbox = m;
+}
+
+/**
+ * search_index_close - Stop using the summaries
+ *
+ * Any new summaries are saved.
+ */
+void search_index_close(void)
+{
+  mutt_hcache_close(SearchCache);
+  SearchCache = NULL;
+  SearchMailbox = NULL;
+}
+
+/**
+ * search_index_check - Can a message be skipped?
+ * @param[in]  m         Mailbox
+ * @param[in]  pat       Pattern being matched
+ * @param[in]  e         Email
+ * @param[out] summarise Set to true if the message hasn't been summarised
+ * @retval true The message can't match the Pattern
+ *
+ * If summarise is set, the caller should create a summary using
+ * search_index_new() while searching the message.
+ */
+bool search_index_check(struct Mailbox *m, const struct Pattern *pat,
+                        const struct Email *e, bool *summarise)
+{
+  *summarise = false;
+
+  if (!SearchCache || (m != SearchMailbox))
+    return false;
+
+  struct Buffer *key = mutt_buffer_pool_get();
+  if (!search_index_key(pat, e, key))
+  {
+    mutt_buffer_pool_release(&key);
+    return false;
+  }
+
+  size_t dlen = 0;
+  void *data = mutt_hcache_fetch_raw(SearchCache, mutt_buffer_string(key),
+                                     mutt_buffer_len(key), &dlen);
+  mutt_buffer_pool_release(&key);
+  if (!data)
+  {
+    *summarise = true;
+    return false;
+  }
+
+  /* Only strings can be checked, e.g. =b foo, or the literal part of a regex */
+  bool skip = false;
+  const unsigned char *str = (const unsigned char *) (pat->string_match ? pat->p.str : pat->literal);
+  const size_t mask = (dlen * 8) - 1;
+  if (str && !pat->is_multi && ((dlen & (dlen - 1)) == 0) &&
+      (dlen >= SEARCH_INDEX_MIN) && (dlen <= SEARCH_INDEX_MAX))
+  {
+    const unsigned char *bits = data;
+    for (size_t i = 0; str[i] && str[i + 1] && str[i + 2]; i++)
+    {
+      unsigned int bit = trigram_hash(str[i], str[i + 1], str[i + 2]) & mask;
+      if ((bits[bit / 8] & (1 << (bit % 8))) == 0)
+      {
+        skip = true;
+        break;
+      }
+    }
+  }
+
+  mutt_hcache_free_raw(SearchCache, &data);
+  return skip;
+}
+
+/**
+ * search_index_new - Start summarising a message
+ * @param pat Pattern being matched
+ * @param e   Email
+ * @retval ptr New summary
+ *
+ * Every line that's searched must be passed to search_index_add(), then
+ * search_index_save() must be called.
+ */
+struct SearchIndexBuilder *search_index_new(const struct Pattern *pat,
+                                            const struct Email *e)
+{
+  struct SearchIndexBuilder *sib = mutt_mem_calloc(1, sizeof(struct SearchIndexBuilder));
+  sib->key = mutt_buffer_pool_get();
+  search_index_key(pat, e, sib->key);
+  sib->bits = mutt_mem_calloc(1, SEARCH_INDEX_MAX);
+  return sib;
+}
+
+/**
+ * search_index_add - Add a line of text to a summary
+ * @param sib  Summary being built
+ * @param line Line of text
+ */
+void search_index_add(struct SearchIndexBuilder *sib, const char *line)
+{
+  if (!sib || !line)
+    return;
+
+  const unsigned char *s = (const unsigned char *) line;
+  for (size_t i = 0; s[i] && s[i + 1] && s[i + 2]; i++)
+  {
+    unsigned int bit = trigram_hash(s[i], s[i + 1], s[i + 2]);
+    unsigned char flag = 1 << (bit % 8);
+    if ((sib->bits[bit / 8] & flag) == 0)
+    {
+      sib->bits[bit / 8] |= flag;
+      sib->num_bits++;
+    }
+  }
+}
+
+/**
+ * search_index_free - Discard a summary
+ * @param sib Summary to free
+ *
+ * Use this if the message couldn't be searched completely.
+ */
+void search_index_free(struct SearchIndexBuilder **sib)
+{
+  if (!sib || !*sib)
+    return;
+
+  mutt_buffer_pool_release(&(*sib)->key);
+  FREE(&(*sib)->bits);
+  FREE(sib);
+}
+
+/**
+ * search_index_save - Save a summary to the header cache
+ * @param sib Summary to save
+ *
+ * The summary is folded to a size that fits the number of trigrams, then
+ * freed.
+ */
+void search_index_save(struct SearchIndexBuilder **sib)
+{
+  if (!sib || !*sib)
+    return;
+
+  struct SearchIndexBuilder *b = *sib;
+
+  /* Fold the summary in half while no more than a quarter of the bits are set */
+  size_t size = SEARCH_INDEX_MAX;
+  while ((size > SEARCH_INDEX_MIN) && ((size * 8 / 2) >= (b->num_bits * 4)))
+  {
+    size /= 2;
+    for (size_t i = 0; i < size; i++)
+      b->bits[i] |= b->bits[i + size];
+  }
+
+  if (SearchCache)
+  {
+    mutt_hcache_store_raw(SearchCache, mutt_buffer_string(b->key),
+                          mutt_buffer_len(b->key), b->bits, size);
+  }
+
+  search_index_free(sib);
+}
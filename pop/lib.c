@@ -32,6 +32,7 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -160,6 +161,8 @@ static int fetch_capa(const char *line, void *data)
     adata->cmd_uidl = 1;
   else if (mutt_istr_startswith(line, "TOP"))
     adata->cmd_top = 1;
+  else if (mutt_istr_startswith(line, "PIPELINING"))
+    adata->cmd_pipelining = true;
 
   return 0;
 }
@@ -207,6 +210,7 @@ static int pop_capabilities(struct PopAccountData *adata, int mode)
     adata->cmd_user = 0;
     adata->cmd_uidl = 0;
     adata->cmd_top = 0;
+    adata->cmd_pipelining = false;
     adata->resp_codes = false;
     adata->expire = true;
     adata->login_delay = 0;
@@ -467,6 +471,7 @@ int pop_query_d(struct PopAccountData *adata, char *buf, size_t buflen, char *ms
     mutt_debug(MUTT_SOCK_LOG_CMD, "> %s", msg);
   }
 
+  const uint64_t start = mutt_date_monotonic_us();
   mutt_socket_send_d(adata->conn, buf, MUTT_SOCK_LOG_FULL);
 
   char *c = strpbrk(buf, " \r\n");
@@ -474,6 +479,26 @@ int pop_query_d(struct PopAccountData *adata, char *buf, size_t buflen, char *ms
     *c = '\0';
   snprintf(adata->err_msg, sizeof(adata->err_msg), "%s: ", buf);
 
+  const int rc = pop_read_status(adata, buf, buflen);
+  if (rc != -1)
+    mutt_socket_rtt(adata->conn, mutt_date_monotonic_us() - start);
+  return rc;
+}
+
+/**
+ * pop_read_status - Read the status line of the answer to a command
+ * @param adata  POP Account data
+ * @param buf    Buffer for the status line
+ * @param buflen Length of the buffer
+ * @retval  0 Successful
+ * @retval -1 Connection lost
+ * @retval -2 Invalid command or execution error
+ *
+ * The command must already have been sent.  If it fails, the reason is
+ * appended to adata->err_msg.
+ */
+int pop_read_status(struct PopAccountData *adata, char *buf, size_t buflen)
+{
   if (mutt_socket_readln_d(buf, buflen, adata->conn, MUTT_SOCK_LOG_FULL) < 0)
   {
     adata->status = POP_DISCONNECTED;
@@ -505,14 +530,35 @@ int pop_fetch_data(struct PopAccountData *adata, const char *query,
                    struct Progress *progress, pop_fetch_t callback, void *data)
 {
   char buf[1024];
-  long pos = 0;
-  size_t lenbuf = 0;
 
   mutt_str_copy(buf, query, sizeof(buf));
   int rc = pop_query(adata, buf, sizeof(buf));
   if (rc < 0)
     return rc;
 
+  return pop_fetch_lines(adata, progress, callback, data);
+}
+
+/**
+ * pop_fetch_lines - Read the lines of a multi-line answer
+ * @param adata    POP Account data
+ * @param progress Progress bar
+ * @param callback Function called for each line
+ * @param data     Data to pass to the callback
+ * @retval  0 Successful
+ * @retval -1 Connection lost
+ * @retval -3 Error in callback(*line, *data)
+ *
+ * The status line of the answer must already have been read.
+ */
+int pop_fetch_lines(struct PopAccountData *adata, struct Progress *progress,
+                    pop_fetch_t callback, void *data)
+{
+  char buf[1024];
+  long pos = 0;
+  size_t lenbuf = 0;
+  int rc = 0;
+
   char *inbuf = mutt_mem_malloc(sizeof(buf));
 
   while (true)
@@ -106,48 +106,199 @@ static int fetch_message(const char *line, void *data)
 }
 
 /**
- * pop_read_header - Read header
- * @param adata POP Account data
- * @param e     Email
- * @retval  0 Success
- * @retval -1 Connection lost
- * @retval -2 Invalid command or execution error
- * @retval -3 Error writing to tempfile
+ * fetch_discard - Ignore a line - Implements ::pop_fetch_t
+ * @param line String to ignore
+ * @param data Unused
+ * @retval 0 Always
+ */
+static int fetch_discard(const char *line, void *data)
+{
+  return 0;
+}
+
+/**
+ * struct PopHeaderCtx - A message header being read
+ */
+struct PopHeaderCtx
+{
+  struct Email *e;     ///< Email being filled
+  struct Buffer *hdr;  ///< Header field, waiting for any continuation lines
+  size_t offset;       ///< Size of the header, as saved
+  size_t lines;        ///< Number of lines read
+  bool in_body;        ///< The end of the header has been reached
+};
+
+/**
+ * header_flush - Parse the waiting header field
+ * @param hc Header being read
  */
-static int pop_read_header(struct PopAccountData *adata, struct Email *e)
+static void header_flush(struct PopHeaderCtx *hc)
 {
-  FILE *fp = mutt_file_mkstemp();
-  if (!fp)
+  if (mutt_buffer_is_empty(hc->hdr))
+    return;
+
+  mutt_str_remove_trailing_ws(hc->hdr->data);
+  mutt_rfc822_parse_header(hc->e->env, hc->e, hc->hdr->data, false, false);
+  mutt_buffer_reset(hc->hdr);
+}
+
+/**
+ * fetch_header - Parse a line of a message header - Implements ::pop_fetch_t
+ * @param line Line of the header
+ * @param data PopHeaderCtx
+ * @retval 0 Always
+ *
+ * Continuation lines are joined, like mutt_rfc822_read_line(), so the header
+ * doesn't need to be saved to a file first.
+ */
+static int fetch_header(const char *line, void *data)
+{
+  struct PopHeaderCtx *hc = data;
+
+  hc->lines++;
+  if (hc->in_body)
+    return 0;
+
+  const size_t len = mutt_str_len(line);
+  hc->offset += len + 1;
+
+  if (IS_SPACE(line[0]) && !mutt_buffer_is_empty(hc->hdr))
   {
-    mutt_perror(_("Can't create temporary file"));
-    return -3;
+    mutt_buffer_addch(hc->hdr, ' ');
+    mutt_buffer_addstr(hc->hdr, mutt_str_skip_email_wsp(line));
+    return 0;
   }
 
+  header_flush(hc);
+
+  if ((line[0] == '\0') || IS_SPACE(line[0]))
+  {
+    hc->in_body = true;
+    return 0;
+  }
+
+  /* some bogus MTAs will quote the original "From " line */
+  if (mutt_str_startswith(line, ">From "))
+    return 0;
+
+  const char *p = strpbrk(line, ": \t");
+  if (!p || (*p != ':'))
+  {
+    /* not a header field, so this is the start of the body */
+    hc->offset -= len + 1;
+    hc->in_body = true;
+    return 0;
+  }
+
+  mutt_buffer_addstr(hc->hdr, line);
+  return 0;
+}
+
+/**
+ * fetch_size - Parse the answer to LIST - Implements ::pop_fetch_t
+ * @param line String to parse, e.g. "1 1234"
+ * @param data Array of sizes, indexed by message number
+ * @retval 0 Always
+ *
+ * The first element of the array holds the number of elements.
+ */
+static int fetch_size(const char *line, void *data)
+{
+  size_t *sizes = data;
   int index = 0;
   size_t length = 0;
+
+  if ((sscanf(line, "%d %zu", &index, &length) == 2) && (index > 0) &&
+      ((size_t) index < sizes[0]))
+  {
+    sizes[index] = length;
+  }
+  return 0;
+}
+
+/**
+ * pop_read_headers - Read the headers of some messages
+ * @param[in]  adata  POP Account data
+ * @param[in]  emails Emails to fill
+ * @param[in]  num    Number of Emails
+ * @param[in]  max    Highest message number
+ * @param[in]  update Function to call as each header is read
+ * @param[in]  data   Data for the function
+ * @param[out] done   Number of Emails filled
+ * @retval  0 Success
+ * @retval -1 Connection lost
+ * @retval -2 Invalid command or execution error
+ *
+ * The sizes of all the messages are read with a single LIST.  If the server
+ * supports PIPELINING (RFC2449), several TOP commands are sent before their
+ * answers are read.  The Emails are filled in order; if one fails, the rest
+ * are left alone.
+ */
+static int pop_read_headers(struct PopAccountData *adata, struct Email **emails,
+                            int num, int max, void (*update)(void *data),
+                            void *data, int *done)
+{
   char buf[1024];
+  *done = 0;
 
-  struct PopEmailData *edata = pop_edata_get(e);
+  size_t *sizes = mutt_mem_calloc(max + 1, sizeof(size_t));
+  sizes[0] = max + 1;
+  int rc = pop_fetch_data(adata, "LIST\r\n", NULL, fetch_size, sizes);
+  if (rc == -3)
+    rc = -2;
 
-  snprintf(buf, sizeof(buf), "LIST %d\r\n", edata->refno);
-  int rc = pop_query(adata, buf, sizeof(buf));
-  if (rc == 0)
+  struct PopHeaderCtx hc = { 0 };
+  hc.hdr = mutt_buffer_pool_get();
+
+  const int depth = adata->cmd_pipelining ? POP_PIPELINE_DEPTH : 1;
+  int sent = 0;
+  int recv = 0;
+  bool stop = (rc < 0);
+
+  while ((recv < sent) || (!stop && (sent < num)))
   {
-    sscanf(buf, "+OK %d %zu", &index, &length);
+    /* keep the pipeline full */
+    while (!stop && (sent < num) && ((sent - recv) < depth))
+    {
+      snprintf(buf, sizeof(buf), "TOP %d 0\r\n", pop_edata_get(emails[sent])->refno);
+      if (mutt_socket_send(adata->conn, buf) < 0)
+      {
+        adata->status = POP_DISCONNECTED;
+        rc = -1;
+        goto done;
+      }
+      sent++;
+    }
 
-    snprintf(buf, sizeof(buf), "TOP %d 0\r\n", edata->refno);
-    rc = pop_fetch_data(adata, buf, NULL, fetch_message, fp);
+    /* read the answer to the oldest command */
+    struct Email *e = emails[recv++];
+    int ret = pop_read_status(adata, buf, sizeof(buf));
+    if ((ret == 0) && stop)
+    {
+      ret = pop_fetch_lines(adata, NULL, fetch_discard, NULL);
+    }
+    else if (ret == 0)
+    {
+      mutt_env_free(&e->env);
+      e->env = mutt_env_new();
+      hc.e = e;
+      hc.offset = 0;
+      hc.lines = 0;
+      hc.in_body = false;
+      ret = pop_fetch_lines(adata, NULL, fetch_header, &hc);
+      header_flush(&hc);
+    }
 
     if (adata->cmd_top == 2)
     {
-      if (rc == 0)
+      if (ret == 0)
       {
         adata->cmd_top = 1;
 
         mutt_debug(LL_DEBUG1, "set TOP capability\n");
       }
 
-      if (rc == -2)
+      if (ret == -2)
       {
         adata->cmd_top = 0;
 
@@ -156,36 +307,45 @@ static int pop_read_header(struct PopAccountData *adata, struct Email *e)
                  _("Command TOP is not supported by server"));
       }
     }
-  }
 
-  switch (rc)
-  {
-    case 0:
-    {
-      rewind(fp);
-      e->env = mutt_rfc822_read_header(fp, e, false, false);
-      e->body->length = length - e->body->offset + 1;
-      rewind(fp);
-      while (!feof(fp))
-      {
-        e->body->length--;
-        fgets(buf, sizeof(buf), fp);
-      }
-      break;
-    }
-    case -2:
+    if (ret == -1)
     {
-      mutt_error("%s", adata->err_msg);
-      break;
+      rc = -1;
+      goto done;
     }
-    case -3:
+    if (stop)
+      continue;
+    if (ret < 0)
     {
-      mutt_error(_("Can't write header to temporary file"));
-      break;
+      /* read the outstanding answers, but don't use them */
+      rc = -2;
+      stop = true;
+      continue;
     }
+
+    mutt_rfc822_finish_header(e->env, e);
+
+    const int refno = pop_edata_get(e)->refno;
+    const size_t length = ((refno > 0) && (refno <= max)) ? sizes[refno] : 0;
+    e->body->hdr_offset = e->offset;
+    e->body->offset = hc.offset;
+    /* the server's size counts CRLF line endings */
+    if (length > (hc.offset + hc.lines))
+      e->body->length = length - hc.offset - hc.lines;
+    else
+      e->body->length = 0;
+
+    (*done)++;
+    if (update)
+      update(data);
   }
 
-  mutt_file_fclose(&fp);
+done:
+  if (rc == -2)
+    mutt_error("%s", adata->err_msg);
+
+  mutt_buffer_pool_release(&hc.hdr);
+  FREE(&sizes);
   return rc;
 }
 
@@ -226,8 +386,7 @@ static int fetch_uidl(const char *line, void *data)
   {
     mutt_debug(LL_DEBUG1, "new header %d %s\n", index, line);
 
-    if (i >= m->email_max)
-      mx_alloc_memory(m);
+    mx_alloc_memory(m, i + 1);
 
     m->msg_count++;
     m->emails[i] = email_new();
@@ -310,13 +469,33 @@ static struct HeaderCache *pop_hcache_open(struct PopAccountData *adata, const c
 }
 #endif
 
+/**
+ * struct PopProgress - Progress of reading the headers
+ */
+struct PopProgress
+{
+  struct Progress *progress; ///< Progress bar, or NULL
+  int done;                  ///< Number of headers read
+};
+
+/**
+ * fetch_progress - Update the progress bar after a header is read
+ * @param data PopProgress
+ */
+static void fetch_progress(void *data)
+{
+  struct PopProgress *pp = data;
+  pp->done++;
+  if (pp->progress)
+    mutt_progress_update(pp->progress, pp->done, -1);
+}
+
 /**
  * pop_fetch_headers - Read headers
  * @param m Mailbox
  * @retval  0 Success
  * @retval -1 Connection lost
  * @retval -2 Invalid command or execution error
- * @retval -3 Error writing to tempfile
  */
 static int pop_fetch_headers(struct Mailbox *m)
 {
@@ -328,6 +507,7 @@ static int pop_fetch_headers(struct Mailbox *m)
 
 #ifdef USE_HCACHE
   struct HeaderCache *hc = pop_hcache_open(adata, mailbox_path(m));
+  mutt_hcache_begin_txn(hc);
 #endif
 
   adata->check_time = mutt_date_epoch();
@@ -389,13 +569,15 @@ static int pop_fetch_headers(struct Mailbox *m)
           deleted);
     }
 
-    bool hcached = false;
+    /* use the header cache first, then read the rest from the server */
+    struct Email **fetch = mutt_mem_calloc(new_count - old_count + 1, sizeof(struct Email *));
+    bool *hcached = mutt_mem_calloc(new_count - old_count + 1, sizeof(bool));
+    int num_fetch = 0;
+    int done = 0;
     for (i = old_count; i < new_count; i++)
     {
-      if (m->verbose)
-        mutt_progress_update(&progress, i + 1 - old_count, -1);
-      struct PopEmailData *edata = pop_edata_get(m->emails[i]);
 #ifdef USE_HCACHE
+      struct PopEmailData *edata = pop_edata_get(m->emails[i]);
       struct HCacheEntry hce = mutt_hcache_fetch(hc, edata->uid, strlen(edata->uid), 0);
       if (hce.email)
       {
@@ -417,19 +599,40 @@ static int pop_fetch_headers(struct Mailbox *m)
         /* Reattach the private data */
         m->emails[i]->edata = edata;
         m->emails[i]->edata_free = pop_edata_free;
-        rc = 0;
-        hcached = true;
+        hcached[i - old_count] = true;
+        if (m->verbose)
+          mutt_progress_update(&progress, ++done, -1);
+        continue;
       }
-      else
 #endif
-          if ((rc = pop_read_header(adata, m->emails[i])) < 0)
-        break;
+      fetch[num_fetch++] = m->emails[i];
+    }
+
+    /* the emails up to the first failure are usable */
+    int last = new_count;
+    if (num_fetch > 0)
+    {
+      struct PopProgress pp = { m->verbose ? &progress : NULL, done };
+      int fetched = 0;
+      rc = pop_read_headers(adata, fetch, num_fetch, new_count, fetch_progress,
+                            &pp, &fetched);
+      if (fetched < num_fetch)
+      {
+        for (last = old_count; m->emails[last] != fetch[fetched]; last++)
+          ; // do nothing
+      }
 #ifdef USE_HCACHE
-      else
+      for (int j = 0; j < fetched; j++)
       {
-        mutt_hcache_store(hc, edata->uid, strlen(edata->uid), m->emails[i], 0);
+        struct PopEmailData *edata = pop_edata_get(fetch[j]);
+        mutt_hcache_store(hc, edata->uid, strlen(edata->uid), fetch[j], 0);
       }
 #endif
+    }
+
+    for (i = old_count; i < last; i++)
+    {
+      struct PopEmailData *edata = pop_edata_get(m->emails[i]);
 
       /* faked support for flags works like this:
        * - if 'hcached' is true, we have the message in our hcache:
@@ -445,7 +648,7 @@ static int pop_fetch_headers(struct Mailbox *m)
           (mutt_bcache_exists(adata->bcache, cache_id(edata->uid)) == 0);
       m->emails[i]->old = false;
       m->emails[i]->read = false;
-      if (hcached)
+      if (hcached[i - old_count])
       {
         const bool c_mark_old = cs_subset_bool(NeoMutt->sub, "mark_old");
         if (bcached)
@@ -461,6 +664,9 @@ static int pop_fetch_headers(struct Mailbox *m)
 
       m->msg_count++;
     }
+
+    FREE(&fetch);
+    FREE(&hcached);
   }
 
 #ifdef USE_HCACHE
@@ -507,8 +713,165 @@ static void pop_clear_cache(struct PopAccountData *adata)
   }
 }
 
+/**
+ * struct PopFetchCmd - A command sent while fetching mail
+ */
+struct PopFetchCmd
+{
+  int msgno; ///< Message number
+  bool dele; ///< DELE, otherwise RETR
+};
+
+#ifdef USE_HCACHE
+/**
+ * struct PopCheckpoint - Messages already saved by an interrupted fetch
+ *
+ * While fetching mail, the UID of each message is recorded in the header
+ * cache as soon as it's been saved.  If the fetch is interrupted, the next
+ * one skips those messages, rather than saving them twice.  The records are
+ * removed once the fetch has finished.
+ */
+struct PopCheckpoint
+{
+  struct HeaderCache *hc; ///< Header cache
+  char **uids;            ///< UIDs, indexed by message number
+  int num;                ///< Number of messages
+};
+
+/**
+ * checkpoint_uidl - Parse UIDL for the checkpoint - Implements ::pop_fetch_t
+ * @param line String to parse, e.g. "1 abc"
+ * @param data PopCheckpoint
+ * @retval 0 Always
+ */
+static int checkpoint_uidl(const char *line, void *data)
+{
+  struct PopCheckpoint *cp = data;
+  char *endp = NULL;
+
+  errno = 0;
+  long index = strtol(line, &endp, 10);
+  if (errno || (index < 1) || (index > cp->num))
+    return 0;
+  while (*endp == ' ')
+    endp++;
+  if (*endp != '\0')
+    mutt_str_replace(&cp->uids[index], endp);
+  return 0;
+}
+
+/**
+ * checkpoint_key - Create the key of a message's checkpoint
+ * @param cp    PopCheckpoint
+ * @param msgno Message number
+ * @param key   Buffer for the key
+ * @retval true The message has a UID
+ */
+static bool checkpoint_key(struct PopCheckpoint *cp, int msgno, struct Buffer *key)
+{
+  if (!cp->hc || (msgno < 1) || (msgno > cp->num) || !cp->uids[msgno])
+    return false;
+
+  mutt_buffer_printf(key, "/fetched/%s", cp->uids[msgno]);
+  return true;
+}
+
+/**
+ * checkpoint_open - Load the UIDs of the messages
+ * @param adata POP Account data
+ * @param cp    PopCheckpoint to fill
+ * @param msgs  Number of messages
+ * @retval  0 Success, or no checkpoint is possible
+ * @retval -1 Connection lost
+ */
+static int checkpoint_open(struct PopAccountData *adata, struct PopCheckpoint *cp, int msgs)
+{
+  memset(cp, 0, sizeof(*cp));
+  if (adata->cmd_uidl == 0)
+    return 0;
+
+  cp->hc = pop_hcache_open(adata, NULL);
+  if (!cp->hc)
+    return 0;
+
+  cp->num = msgs;
+  cp->uids = mutt_mem_calloc(msgs + 1, sizeof(char *));
+  int rc = pop_fetch_data(adata, "UIDL\r\n", NULL, checkpoint_uidl, cp);
+  if (rc == 0)
+    return 0;
+
+  /* no UIDs, so no checkpoint */
+  mutt_hcache_close(cp->hc);
+  cp->hc = NULL;
+  return (rc == -1) ? -1 : 0;
+}
+
+/**
+ * checkpoint_close - Forget the UIDs of the messages
+ * @param cp       PopCheckpoint
+ * @param finished If true, the fetch has finished, so remove the records
+ */
+static void checkpoint_close(struct PopCheckpoint *cp, bool finished)
+{
+  if (cp->hc && finished)
+  {
+    struct Buffer *key = mutt_buffer_pool_get();
+    for (int i = 1; i <= cp->num; i++)
+    {
+      if (checkpoint_key(cp, i, key))
+        mutt_hcache_delete_record(cp->hc, mutt_buffer_string(key), mutt_buffer_len(key));
+    }
+    mutt_buffer_pool_release(&key);
+  }
+
+  for (int i = 0; cp->uids && (i <= cp->num); i++)
+    FREE(&cp->uids[i]);
+  FREE(&cp->uids);
+  mutt_hcache_close(cp->hc);
+  cp->hc = NULL;
+}
+
+/**
+ * checkpoint_check - Was a message saved by an interrupted fetch?
+ * @param cp    PopCheckpoint
+ * @param msgno Message number
+ * @retval true The message has already been saved
+ */
+static bool checkpoint_check(struct PopCheckpoint *cp, int msgno)
+{
+  struct Buffer *key = mutt_buffer_pool_get();
+  bool found = false;
+  if (checkpoint_key(cp, msgno, key))
+  {
+    size_t dlen = 0;
+    void *data = mutt_hcache_fetch_raw(cp->hc, mutt_buffer_string(key),
+                                       mutt_buffer_len(key), &dlen);
+    found = data;
+    mutt_hcache_free_raw(cp->hc, &data);
+  }
+  mutt_buffer_pool_release(&key);
+  return found;
+}
+
+/**
+ * checkpoint_save - Record that a message has been saved
+ * @param cp    PopCheckpoint
+ * @param msgno Message number
+ */
+static void checkpoint_save(struct PopCheckpoint *cp, int msgno)
+{
+  struct Buffer *key = mutt_buffer_pool_get();
+  if (checkpoint_key(cp, msgno, key))
+    mutt_hcache_store_raw(cp->hc, mutt_buffer_string(key), mutt_buffer_len(key), "1", 1);
+  mutt_buffer_pool_release(&key);
+}
+#endif
+
 /**
  * pop_fetch_mail - Fetch messages and save them in $spool_file
+ *
+ * If the server supports PIPELINING (RFC2449), several RETR and DELE
+ * commands are sent before their answers are read.
  */
 void pop_fetch_mail(void)
 {
@@ -523,6 +886,10 @@ void pop_fetch_mail(void)
   char msgbuf[128];
   int last = 0, msgs, bytes, rset = 0, ret;
   struct ConnAccount cac = { { 0 } };
+#ifdef USE_HCACHE
+  struct PopCheckpoint cp = { 0 };
+  bool finished = false;
+#endif
 
   char *p = mutt_mem_calloc(strlen(c_pop_host) + 7, sizeof(char));
   char *url = p;
@@ -588,6 +955,11 @@ void pop_fetch_mail(void)
     goto finish;
   }
 
+#ifdef USE_HCACHE
+  if (checkpoint_open(adata, &cp, msgs) < 0)
+    goto fail;
+#endif
+
   const char *const c_spool_file = cs_subset_string(NeoMutt->sub, "spool_file");
   struct Mailbox *m_spool = mx_path_resolve(c_spool_file);
   struct Context *ctx = mx_mbox_open(m_spool, MUTT_OPEN_NO_FLAGS);
@@ -611,58 +983,125 @@ void pop_fetch_mail(void)
            bytes);
   mutt_message("%s", msgbuf);
 
-  for (int i = last + 1; i <= msgs; i++)
+  const int depth = adata->cmd_pipelining ? POP_PIPELINE_DEPTH : 1;
+  struct PopFetchCmd cmds[POP_PIPELINE_DEPTH];
+  int head = 0;
+  int num_cmds = 0;
+  int next = last + 1;
+  int done = 0;
+  bool stop = false;
+
+  while (true)
   {
-    struct Message *msg = mx_msg_open_new(ctx->mailbox, NULL, MUTT_ADD_FROM);
-    if (msg)
+    /* keep the pipeline full */
+    while (!stop && (num_cmds < depth) && (next <= msgs))
     {
-      snprintf(buf, sizeof(buf), "RETR %d\r\n", i);
-      ret = pop_fetch_data(adata, buf, NULL, fetch_message, msg->fp);
+      const int i = next++;
+      bool saved = false;
+#ifdef USE_HCACHE
+      saved = checkpoint_check(&cp, i);
+#endif
+      if (saved)
+      {
+        mutt_debug(LL_DEBUG2, "message %d was saved by an earlier fetch\n", i);
+        done++;
+        if (delanswer != MUTT_YES)
+          continue;
+      }
+
+      snprintf(buf, sizeof(buf), "%s %d\r\n", saved ? "DELE" : "RETR", i);
+      if (mutt_socket_send(adata->conn, buf) < 0)
+      {
+        adata->status = POP_DISCONNECTED;
+        goto lost;
+      }
+      cmds[(head + num_cmds++) % depth] = (struct PopFetchCmd){ i, saved };
+    }
+
+    if (num_cmds == 0)
+      break;
+
+    /* read the answer to the oldest command */
+    const struct PopFetchCmd cmd = cmds[head];
+    head = (head + 1) % depth;
+    num_cmds--;
+
+    snprintf(adata->err_msg, sizeof(adata->err_msg), "%s: ", cmd.dele ? "DELE" : "RETR");
+    ret = pop_read_status(adata, buf, sizeof(buf));
+    if (ret == -1)
+      goto lost;
+
+    if ((ret == 0) && !cmd.dele)
+    {
+      struct Message *msg = NULL;
+      if (!stop)
+        msg = mx_msg_open_new(ctx->mailbox, NULL, MUTT_ADD_FROM);
+
+      if (msg)
+        ret = pop_fetch_lines(adata, NULL, fetch_message, msg->fp);
+      else
+        ret = pop_fetch_lines(adata, NULL, fetch_discard, NULL);
+
       if (ret == -3)
         rset = 1;
-
-      if ((ret == 0) && (mx_msg_commit(ctx->mailbox, msg) != 0))
+      if ((ret == 0) && msg && (mx_msg_commit(ctx->mailbox, msg) != 0))
       {
         rset = 1;
         ret = -3;
       }
+      if (msg)
+        mx_msg_close(ctx->mailbox, &msg);
+      else if (ret == 0)
+        ret = -3;
 
-      mx_msg_close(ctx->mailbox, &msg);
-    }
-    else
-    {
-      ret = -3;
-    }
+      if (ret == -1)
+        goto lost;
 
-    if ((ret == 0) && (delanswer == MUTT_YES))
-    {
-      /* delete the message on the server */
-      snprintf(buf, sizeof(buf), "DELE %d\r\n", i);
-      ret = pop_query(adata, buf, sizeof(buf));
-    }
+      if ((ret == 0) && !stop)
+      {
+#ifdef USE_HCACHE
+        checkpoint_save(&cp, cmd.msgno);
+#endif
+        done++;
 
-    if (ret == -1)
-    {
-      m_spool->append = old_append;
-      mx_mbox_close(&ctx);
-      goto fail;
+        if (delanswer == MUTT_YES)
+        {
+          /* delete the message on the server */
+          snprintf(buf, sizeof(buf), "DELE %d\r\n", cmd.msgno);
+          if (mutt_socket_send(adata->conn, buf) < 0)
+          {
+            adata->status = POP_DISCONNECTED;
+            goto lost;
+          }
+          cmds[(head + num_cmds++) % depth] = (struct PopFetchCmd){ cmd.msgno, true };
+        }
+      }
     }
+
+    if (stop)
+      continue;
+
     if (ret == -2)
     {
       mutt_error("%s", adata->err_msg);
-      break;
+      stop = true;
+      continue;
     }
     if (ret == -3)
     {
       mutt_error(_("Error while writing mailbox"));
-      break;
+      stop = true;
+      continue;
     }
 
-    /* L10N: The plural is picked by the second numerical argument, i.e.
-       the %d right before 'messages', i.e. the total number of messages. */
-    mutt_message(ngettext("%s [%d of %d message read]",
-                          "%s [%d of %d messages read]", msgs - last),
-                 msgbuf, i - last, msgs - last);
+    if (!cmd.dele)
+    {
+      /* L10N: The plural is picked by the second numerical argument, i.e.
+         the %d right before 'messages', i.e. the total number of messages. */
+      mutt_message(ngettext("%s [%d of %d message read]",
+                            "%s [%d of %d messages read]", msgs - last),
+                   msgbuf, done, msgs - last);
+    }
   }
 
   m_spool->append = old_append;
@@ -675,18 +1114,31 @@ void pop_fetch_mail(void)
     if (pop_query(adata, buf, sizeof(buf)) == -1)
       goto fail;
   }
+#ifdef USE_HCACHE
+  finished = !stop;
+#endif
 
 finish:
   /* exit gracefully */
   mutt_str_copy(buf, "QUIT\r\n", sizeof(buf));
   if (pop_query(adata, buf, sizeof(buf)) == -1)
     goto fail;
+#ifdef USE_HCACHE
+  checkpoint_close(&cp, finished);
+#endif
   mutt_socket_close(conn);
   FREE(&conn);
   pop_adata_free((void **) &adata);
   return;
 
+lost:
+  m_spool->append = old_append;
+  mx_mbox_close(&ctx);
+
 fail:
+#ifdef USE_HCACHE
+  checkpoint_close(&cp, false);
+#endif
   mutt_error(_("Server closed connection"));
   mutt_socket_close(conn);
   pop_adata_free((void **) &adata);
@@ -764,7 +1216,11 @@ static enum MxOpenReturns pop_mbox_open(struct Mailbox *m)
   url_tostring(&url, buf, sizeof(buf), U_NO_FLAGS);
 
   mutt_buffer_strcpy(&m->pathbuf, buf);
-  mutt_str_replace(&m->realpath, mailbox_path(m));
+  if (!mutt_str_equal(m->realpath, mailbox_path(m)))
+  {
+    mutt_str_replace(&m->realpath, mailbox_path(m));
+    account_mailbox_rehash(m->account);
+  }
 
   struct PopAccountData *adata = m->account->adata;
   if (!adata)
@@ -1211,9 +1667,11 @@ struct MxOps MxPopOps = {
   .mbox_sync        = pop_mbox_sync,
   .mbox_close       = pop_mbox_close,
   .msg_open         = pop_msg_open,
+  .msg_prefetch     = NULL,
   .msg_open_new     = NULL,
   .msg_commit       = NULL,
   .msg_close        = pop_msg_close,
+  .msg_append_batch = NULL,
   .msg_padding_size = NULL,
   .msg_save_hcache  = pop_msg_save_hcache,
   .tags_edit        = NULL,
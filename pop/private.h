@@ -41,6 +41,9 @@ struct Progress;
 /* maximal length of the server response (RFC1939) */
 #define POP_CMD_RESPONSE 512
 
+/* number of commands sent ahead, if the server supports PIPELINING (RFC2449) */
+#define POP_PIPELINE_DEPTH 16
+
 /**
  * enum PopStatus - POP server responses
  */
@@ -110,6 +113,9 @@ int pop_open_connection(struct PopAccountData *adata);
 int pop_query_d(struct PopAccountData *adata, char *buf, size_t buflen, char *msg);
 int pop_fetch_data(struct PopAccountData *adata, const char *query,
                    struct Progress *progress, pop_fetch_t callback, void *data);
+int pop_fetch_lines(struct PopAccountData *adata, struct Progress *progress,
+                    pop_fetch_t callback, void *data);
+int pop_read_status(struct PopAccountData *adata, char *buf, size_t buflen);
 int pop_reconnect(struct Mailbox *m);
 void pop_logout(struct Mailbox *m);
 const char *pop_get_field(enum ConnAccountField field, void *gf_data);
@@ -49,6 +49,7 @@
 #include "hdrline.h"
 #include "keymap.h"
 #include "mutt_logging.h"
+#include "mutt_mailbox.h"
 #include "mutt_menu.h"
 #include "mutt_thread.h"
 #include "muttlib.h"
@@ -76,6 +77,69 @@ static const struct Mapping PostponeHelp[] = {
 static short PostCount = 0;
 static bool UpdateNumPostponed = false;
 
+#ifdef USE_IMAP
+/**
+ * postponed_mailbox - Find the Mailbox of a remote `$postponed`
+ * @param path Path of `$postponed`
+ * @retval ptr  Mailbox in the `mailboxes` list
+ * @retval NULL `$postponed` isn't a visible Mailbox
+ *
+ * The counts of a visible Mailbox are kept up to date by mutt_mailbox_check(),
+ * using STATUS, NOTIFY or IDLE.
+ */
+static struct Mailbox *postponed_mailbox(const char *path)
+{
+  struct Mailbox *m = mx_mbox_find2(path);
+  if (!m || (m->flags & MB_HIDDEN))
+    return NULL;
+  return m;
+}
+
+/**
+ * mutt_postponed_check_stats - Refresh the count of a remote `$postponed`
+ * @param force If true, ask the server, even if the count isn't stale
+ * @retval true The count has changed
+ *
+ * This is called after checking the mailboxes for new mail, so that drawing
+ * the status bar never has to wait for the server.
+ */
+bool mutt_postponed_check_stats(bool force)
+{
+  const char *const c_postponed = cs_subset_string(NeoMutt->sub, "postponed");
+  if (!c_postponed || (imap_path_probe(c_postponed, NULL) != MUTT_IMAP))
+    return false;
+
+  const short old_count = PostCount;
+
+  /* mutt_mailbox_check() refreshes a visible Mailbox along with the others */
+  struct Mailbox *m_post = postponed_mailbox(c_postponed);
+  if (m_post)
+  {
+    /* The index counts the messages of the open Mailbox itself */
+    if (m_post->opened)
+      return false;
+
+    UpdateNumPostponed = false;
+    if (force && (mx_mbox_check_stats(m_post, 0) == MX_STATUS_ERROR))
+      mutt_debug(LL_DEBUG3, "using old IMAP postponed count\n");
+    PostCount = m_post->msg_count;
+  }
+  else if (UpdateNumPostponed || force)
+  {
+    UpdateNumPostponed = false;
+    const int newpc = imap_path_status(c_postponed, false);
+    if (newpc >= 0)
+      PostCount = newpc;
+    else
+      mutt_debug(LL_DEBUG3, "using old IMAP postponed count\n");
+  }
+
+  if (PostCount != old_count)
+    mutt_debug(LL_DEBUG3, "%d postponed IMAP messages found\n", PostCount);
+  return PostCount != old_count;
+}
+#endif
+
 /**
  * mutt_num_postponed - Return the number of postponed messages
  * @param m    currently selected mailbox
@@ -83,6 +147,9 @@ static bool UpdateNumPostponed = false;
  * * false Use a cached value if costly to get a fresh count (IMAP)
  * * true Force check
  * @retval num Postponed messages
+ *
+ * The count of a remote `$postponed` is only fetched from the server if @a
+ * force is set.  Otherwise, it's refreshed by mutt_postponed_check_stats().
  */
 int mutt_num_postponed(struct Mailbox *m, bool force)
 {
@@ -91,19 +158,15 @@ int mutt_num_postponed(struct Mailbox *m, bool force)
   static time_t LastModify = 0;
   static char *OldPostponed = NULL;
 
-  if (UpdateNumPostponed)
-  {
-    UpdateNumPostponed = false;
-    force = true;
-  }
-
   const char *const c_postponed = cs_subset_string(NeoMutt->sub, "postponed");
   if (!mutt_str_equal(c_postponed, OldPostponed))
   {
+    if (OldPostponed)
+      PostCount = 0;
     FREE(&OldPostponed);
     OldPostponed = mutt_str_dup(c_postponed);
     LastModify = 0;
-    force = true;
+    UpdateNumPostponed = true;
   }
 
   if (!c_postponed)
@@ -120,19 +183,11 @@ int mutt_num_postponed(struct Mailbox *m, bool force)
   /* LastModify is useless for IMAP */
   if (imap_path_probe(c_postponed, NULL) == MUTT_IMAP)
   {
+    struct Mailbox *m_post = postponed_mailbox(c_postponed);
     if (force)
-    {
-      short newpc;
-
-      newpc = imap_path_status(c_postponed, false);
-      if (newpc >= 0)
-      {
-        PostCount = newpc;
-        mutt_debug(LL_DEBUG3, "%d postponed IMAP messages found\n", PostCount);
-      }
-      else
-        mutt_debug(LL_DEBUG3, "using old IMAP postponed count\n");
-    }
+      mutt_postponed_check_stats(true);
+    else if (m_post)
+      PostCount = m_post->msg_count;
     return PostCount;
   }
 #endif
@@ -202,6 +257,16 @@ int mutt_num_postponed(struct Mailbox *m, bool force)
 void mutt_update_num_postponed(void)
 {
   UpdateNumPostponed = true;
+
+#ifdef USE_IMAP
+  const char *const c_postponed = cs_subset_string(NeoMutt->sub, "postponed");
+  if (c_postponed && (imap_path_probe(c_postponed, NULL) == MUTT_IMAP))
+  {
+    struct Mailbox *m_post = postponed_mailbox(c_postponed);
+    if (m_post)
+      mutt_mailbox_check_soon(m_post);
+  }
+#endif
 }
 
 /**
@@ -0,0 +1,201 @@
+/**
+ * @file
+ * Cache of cleanly parsed config files
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page neo_rc_cache Cache of cleanly parsed config files
+ *
+ * Parsing a big config file means compiling every hook's pattern or regex,
+ * even though most hooks won't be used in a session.
+ *
+ * If `$config_cache` is set, NeoMutt remembers a digest of each config file
+ * that was read without any errors or warnings.  When an unchanged file is
+ * read again, its hooks keep the text of their patterns and compile them when
+ * they're first used.  If the file has changed, it's checked in full, as
+ * usual.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "rc_cache.h"
+
+static struct HashTable *RcDigests = NULL; ///< Config file path -> Digest of its contents
+static bool RcCacheDirty = false;          ///< Has RcDigests changed since it was read?
+
+/**
+ * rc_cache_digest_free - Free a digest - Implements ::hash_hdata_free_t
+ */
+static void rc_cache_digest_free(int type, void *obj, intptr_t data)
+{
+  FREE(&obj);
+}
+
+/**
+ * rc_cache_load - Read the digests of the config files
+ * @param file Path of the cache
+ *
+ * Each line of the cache contains the MD5 digest of a config file and its
+ * path.
+ */
+static void rc_cache_load(const char *file)
+{
+  RcDigests = mutt_hash_new(64, MUTT_HASH_STRDUP_KEYS);
+  mutt_hash_set_destructor(RcDigests, rc_cache_digest_free, 0);
+
+  FILE *fp = mutt_file_fopen(file, "r");
+  if (!fp)
+    return;
+
+  char *line = NULL;
+  size_t linelen = 0;
+  while ((line = mutt_file_read_line(line, &linelen, fp, NULL, MUTT_RL_NO_FLAGS)))
+  {
+    if ((strlen(line) < 34) || (line[32] != ' '))
+      continue;
+    line[32] = '\0';
+    mutt_hash_insert(RcDigests, line + 33, mutt_str_dup(line));
+  }
+  FREE(&line);
+  mutt_file_fclose(&fp);
+}
+
+/**
+ * rc_cache_check - Is a config file unchanged since it was last read cleanly?
+ * @param[in]  path   Absolute path of the config file
+ * @param[out] digest Digest of the file, at least 33 bytes
+ * @retval true The file can be trusted
+ *
+ * If the cache is enabled, digest is set, even if the file has changed.
+ * Otherwise, it's set to an empty string.
+ */
+bool rc_cache_check(const char *path, char *digest)
+{
+  digest[0] = '\0';
+
+  const char *const c_config_cache = cs_subset_path(NeoMutt->sub, "config_cache");
+  if (!c_config_cache || !path)
+    return false;
+
+  FILE *fp = mutt_file_fopen(path, "r");
+  if (!fp)
+    return false;
+
+  struct Md5Ctx ctx;
+  mutt_md5_init_ctx(&ctx);
+
+  char buf[4096];
+  size_t len;
+  while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+    mutt_md5_process_bytes(buf, len, &ctx);
+
+  const bool ok = !ferror(fp);
+  mutt_file_fclose(&fp);
+  if (!ok)
+    return false;
+
+  unsigned char md5[16];
+  mutt_md5_finish_ctx(&ctx, md5);
+  mutt_md5_toascii(md5, digest);
+
+  if (!RcDigests)
+    rc_cache_load(c_config_cache);
+
+  return mutt_str_equal(mutt_hash_find(RcDigests, path), digest);
+}
+
+/**
+ * rc_cache_update - Record the result of reading a config file
+ * @param path   Absolute path of the config file
+ * @param digest Digest of the file, from rc_cache_check()
+ * @param clean  True if the file was read without any errors or warnings
+ */
+void rc_cache_update(const char *path, const char *digest, bool clean)
+{
+  if (!RcDigests || !path || !digest || (digest[0] == '\0'))
+    return;
+
+  const char *old = mutt_hash_find(RcDigests, path);
+  if (clean && mutt_str_equal(old, digest))
+    return;
+  if (!clean && !old)
+    return;
+
+  mutt_hash_delete(RcDigests, path, NULL);
+  if (clean)
+    mutt_hash_insert(RcDigests, path, mutt_str_dup(digest));
+  RcCacheDirty = true;
+}
+
+/**
+ * rc_cache_save - Write the digests of the config files
+ */
+void rc_cache_save(void)
+{
+  const char *const c_config_cache = cs_subset_path(NeoMutt->sub, "config_cache");
+  if (!RcCacheDirty || !RcDigests || !c_config_cache)
+    return;
+
+  struct Buffer *tmp = mutt_buffer_pool_get();
+  mutt_buffer_printf(tmp, "%s.tmp", c_config_cache);
+
+  FILE *fp = mutt_file_fopen(mutt_buffer_string(tmp), "w");
+  if (!fp)
+  {
+    mutt_perror(mutt_buffer_string(tmp));
+    goto done;
+  }
+
+  struct HashWalkState state = { 0 };
+  struct HashElem *he = NULL;
+  while ((he = mutt_hash_walk(RcDigests, &state)))
+  {
+    fprintf(fp, "%s %s\n", (const char *) he->data, he->key.strkey);
+  }
+
+  if ((mutt_file_fclose(&fp) != 0) ||
+      (rename(mutt_buffer_string(tmp), c_config_cache) != 0))
+  {
+    mutt_perror(c_config_cache);
+    unlink(mutt_buffer_string(tmp));
+    goto done;
+  }
+
+  RcCacheDirty = false;
+
+done:
+  mutt_buffer_pool_release(&tmp);
+}
+
+/**
+ * rc_cache_free - Forget the digests of the config files
+ */
+void rc_cache_free(void)
+{
+  mutt_hash_free(&RcDigests);
+  RcCacheDirty = false;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * Cache of cleanly parsed config files
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_RC_CACHE_H
+#define MUTT_RC_CACHE_H
+
+#include <stdbool.h>
+
+bool rc_cache_check (const char *path, char *digest);
+void rc_cache_free  (void);
+void rc_cache_save  (void);
+void rc_cache_update(const char *path, const char *digest, bool clean);
+
+#endif /* MUTT_RC_CACHE_H */
@@ -28,7 +28,9 @@
 
 #include "config.h"
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "mutt/lib.h"
 #include "config/lib.h"
 #include "email/lib.h"
@@ -45,6 +47,8 @@
 #include "options.h"
 #include "protos.h"
 
+ARRAY_HEAD(ScoreTermIndexes, size_t);
+
 /**
  * struct Score - Scoring rule for email
  */
@@ -54,11 +58,183 @@ struct Score
   struct PatternList *pat;
   int val;
   bool exact; ///< if this rule matches, don't evaluate any more
+  struct ScoreTermIndexes terms; ///< The rule's terms, indexes into #ScorePlan
   struct Score *next;
 };
 
+/**
+ * struct ScoreTerm - A term of a scoring rule, shared by all the rules using it
+ */
+struct ScoreTerm
+{
+  struct Pattern *pat;  ///< Pattern, owned by the first rule to use it
+  unsigned char result; ///< Result for the current Email: 0 = unset, 1 = false, 2 = true
+};
+ARRAY_HEAD(ScoreTermArray, struct ScoreTerm);
+
 static struct Score *ScoreList = NULL;
 
+/// Distinct terms of all the scoring rules
+static struct ScoreTermArray ScorePlan = ARRAY_HEAD_INITIALIZER;
+
+/// Digest of the rules that the Emails were last scored with
+static unsigned char ScoredDigest[16] = { 0 };
+
+/**
+ * score_pattern_equal - Are two Patterns the same?
+ * @param a First Pattern
+ * @param b Second Pattern
+ * @retval true The Patterns will always give the same result
+ *
+ * Anything that can't be compared, e.g. a compiled regex, is different.
+ */
+static bool score_pattern_equal(const struct Pattern *a, const struct Pattern *b)
+{
+  if ((a->op != b->op) || (a->pat_not != b->pat_not) || (a->all_addr != b->all_addr) ||
+      (a->string_match != b->string_match) || (a->group_match != b->group_match) ||
+      (a->ign_case != b->ign_case) || (a->is_alias != b->is_alias) ||
+      (a->dynamic != b->dynamic) || (a->sendmode != b->sendmode) ||
+      (a->is_multi != b->is_multi) || (a->literal_only != b->literal_only) ||
+      (a->min != b->min) || (a->max != b->max) || a->server_match || b->server_match ||
+      !mutt_str_equal(a->literal, b->literal) || !mutt_str_equal(a->lazy_regex, b->lazy_regex))
+  {
+    return false;
+  }
+
+  if (a->child || b->child)
+  {
+    if (!a->child || !b->child)
+      return false;
+    const struct Pattern *ca = SLIST_FIRST(a->child);
+    const struct Pattern *cb = SLIST_FIRST(b->child);
+    for (; ca && cb; ca = SLIST_NEXT(ca, entries), cb = SLIST_NEXT(cb, entries))
+    {
+      if (!score_pattern_equal(ca, cb))
+        return false;
+    }
+    return !ca && !cb;
+  }
+
+  if (a->string_match)
+    return mutt_str_equal(a->p.str, b->p.str);
+  if (a->group_match)
+    return a->p.group == b->p.group;
+  if (a->is_multi)
+    return false;
+  return !a->p.regex && !b->p.regex;
+}
+
+/**
+ * score_plan_term - Find or add a term in the #ScorePlan
+ * @param pat Pattern of the term
+ * @retval num Index of the term
+ */
+static size_t score_plan_term(struct Pattern *pat)
+{
+  struct ScoreTerm *st = NULL;
+  ARRAY_FOREACH(st, &ScorePlan)
+  {
+    if (score_pattern_equal(st->pat, pat))
+      return ARRAY_FOREACH_IDX;
+  }
+
+  struct ScoreTerm term = { pat, 0 };
+  ARRAY_ADD(&ScorePlan, term);
+  return ARRAY_SIZE(&ScorePlan) - 1;
+}
+
+/**
+ * score_plan_add - Add a scoring rule's terms to the #ScorePlan
+ * @param sc Scoring rule
+ *
+ * A rule matches if all of its terms (the arguments of its top-level AND)
+ * match.  The same term is often used by several rules, e.g. `~f boss`, so
+ * each distinct term is evaluated once per Email.
+ */
+static void score_plan_add(struct Score *sc)
+{
+  struct Pattern *pat = SLIST_FIRST(sc->pat);
+  if ((pat->op == MUTT_PAT_AND) && !pat->pat_not)
+  {
+    struct Pattern *child = NULL;
+    SLIST_FOREACH(child, pat->child, entries)
+    {
+      ARRAY_ADD(&sc->terms, score_plan_term(child));
+    }
+  }
+  else
+  {
+    ARRAY_ADD(&sc->terms, score_plan_term(pat));
+  }
+}
+
+/**
+ * score_plan_rebuild - Rebuild the #ScorePlan after rules are deleted
+ */
+static void score_plan_rebuild(void)
+{
+  ARRAY_FREE(&ScorePlan);
+  for (struct Score *sc = ScoreList; sc; sc = sc->next)
+  {
+    ARRAY_FREE(&sc->terms);
+    score_plan_add(sc);
+  }
+}
+
+/**
+ * score_digest - Create a digest of the scoring rules
+ * @param digest Buffer for the 16-byte digest
+ */
+static void score_digest(unsigned char *digest)
+{
+  struct Md5Ctx ctx;
+  mutt_md5_init_ctx(&ctx);
+
+  char val[32];
+  for (struct Score *sc = ScoreList; sc; sc = sc->next)
+  {
+    snprintf(val, sizeof(val), "%c%d", sc->exact ? '=' : ' ', sc->val);
+    mutt_md5_process_bytes(sc->str, mutt_str_len(sc->str) + 1, &ctx);
+    mutt_md5_process_bytes(val, mutt_str_len(val) + 1, &ctx);
+  }
+
+  mutt_md5_finish_ctx(&ctx, digest);
+}
+
+/**
+ * score_changing - Prepare for the scoring rules to change
+ *
+ * If the Emails are up to date, remember which rules they were scored with.
+ */
+static void score_changing(void)
+{
+  if (!OptNeedRescore)
+    score_digest(ScoredDigest);
+  OptNeedRescore = true;
+}
+
+/**
+ * mutt_score_changed - Have the scoring rules really changed?
+ * @retval true The Emails need to be scored again
+ *
+ * Hooks often delete and recreate the same rules, e.g.
+ * `folder-hook . 'unscore *; score ~N 10'`.  If the rules end up the same
+ * as the ones the Emails were scored with, there's nothing to do.
+ */
+bool mutt_score_changed(void)
+{
+  if (!OptNeedRescore)
+    return false;
+
+  unsigned char digest[16];
+  score_digest(digest);
+  if (memcmp(digest, ScoredDigest, sizeof(digest)) != 0)
+    return true;
+
+  OptNeedRescore = false;
+  return false;
+}
+
 /**
  * mutt_check_rescore - Do the emails need to have their scores recalculated?
  * @param m Mailbox
@@ -66,7 +242,7 @@ static struct Score *ScoreList = NULL;
 void mutt_check_rescore(struct Mailbox *m)
 {
   const bool c_score = cs_subset_bool(NeoMutt->sub, "score");
-  if (OptNeedRescore && c_score)
+  if (c_score && mutt_score_changed())
   {
     const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
     const short c_sort_aux = cs_subset_sort(NeoMutt->sub, "sort_aux");
@@ -103,6 +279,8 @@ enum CommandResult mutt_parse_score(struct Buffer *buf, struct Buffer *s,
   struct Score *ptr = NULL, *last = NULL;
   char *pattern = NULL, *pc = NULL;
 
+  score_changing();
+
   mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
   if (!MoreArgs(s))
   {
@@ -127,7 +305,7 @@ enum CommandResult mutt_parse_score(struct Buffer *buf, struct Buffer *s,
   {
     struct PatternList *pat =
         mutt_pattern_comp(ctx_mailbox(Context), Context ? Context->menu : NULL,
-                          pattern, MUTT_PC_NO_FLAGS, err);
+                          pattern, MUTT_PC_LAZY_REGEX, err);
     if (!pat)
     {
       FREE(&pattern);
@@ -140,6 +318,7 @@ enum CommandResult mutt_parse_score(struct Buffer *buf, struct Buffer *s,
       ScoreList = ptr;
     ptr->pat = pat;
     ptr->str = pattern;
+    score_plan_add(ptr);
   }
   else
   {
@@ -160,7 +339,6 @@ enum CommandResult mutt_parse_score(struct Buffer *buf, struct Buffer *s,
     mutt_buffer_strcpy(err, _("Error: score: invalid number"));
     return MUTT_CMD_ERROR;
   }
-  OptNeedRescore = true;
   return MUTT_CMD_SUCCESS;
 }
 
@@ -174,11 +352,35 @@ void mutt_score_message(struct Mailbox *m, struct Email *e, bool upd_mbox)
 {
   struct Score *tmp = NULL;
   struct PatternCache cache = { 0 };
+  struct ScoreTerm *st = NULL;
+  size_t *idx = NULL;
+
+  ARRAY_FOREACH(st, &ScorePlan)
+  {
+    st->result = 0;
+  }
 
   e->score = 0; /* in case of re-scoring */
   for (tmp = ScoreList; tmp; tmp = tmp->next)
   {
-    if (mutt_pattern_exec(SLIST_FIRST(tmp->pat), MUTT_MATCH_FULL_ADDRESS, NULL, e, &cache) > 0)
+    bool match = true;
+    ARRAY_FOREACH(idx, &tmp->terms)
+    {
+      st = ARRAY_GET(&ScorePlan, *idx);
+      if (st->result == 0)
+      {
+        const bool rc = (mutt_pattern_exec(st->pat, MUTT_MATCH_FULL_ADDRESS,
+                                           NULL, e, &cache) > 0);
+        st->result = rc ? 2 : 1;
+      }
+      if (st->result == 1)
+      {
+        match = false;
+        break;
+      }
+    }
+
+    if (match)
     {
       if (tmp->exact || (tmp->val == 9999) || (tmp->val == -9999))
       {
@@ -214,6 +416,7 @@ enum CommandResult mutt_parse_unscore(struct Buffer *buf, struct Buffer *s,
 {
   struct Score *tmp = NULL, *last = NULL;
 
+  score_changing();
   while (MoreArgs(s))
   {
     mutt_extract_token(buf, s, MUTT_TOKEN_NO_FLAGS);
@@ -224,6 +427,8 @@ enum CommandResult mutt_parse_unscore(struct Buffer *buf, struct Buffer *s,
         last = tmp;
         tmp = tmp->next;
         mutt_pattern_free(&last->pat);
+        ARRAY_FREE(&last->terms);
+        FREE(&last->str);
         FREE(&last);
       }
       ScoreList = NULL;
@@ -239,6 +444,8 @@ enum CommandResult mutt_parse_unscore(struct Buffer *buf, struct Buffer *s,
           else
             ScoreList = tmp->next;
           mutt_pattern_free(&tmp->pat);
+          ARRAY_FREE(&tmp->terms);
+          FREE(&tmp->str);
           FREE(&tmp);
           /* there should only be one score per pattern, so we can stop here */
           break;
@@ -246,6 +453,6 @@ enum CommandResult mutt_parse_unscore(struct Buffer *buf, struct Buffer *s,
       }
     }
   }
-  OptNeedRescore = true;
+  score_plan_rebuild();
   return MUTT_CMD_SUCCESS;
 }
@@ -37,12 +37,17 @@
 #include "mutt_globals.h"
 #include "muttlib.h"
 
+/// Number of raw bytes in each line of Base64 text, i.e. 72 characters
+#define B64_LINE_BYTES 54
+
 /**
  * struct B64Context - Cursor for the Base64 conversion
+ *
+ * The bytes are collected a line at a time, then encoded and written together.
  */
 struct B64Context
 {
-  char buffer[3];
+  char buffer[B64_LINE_BYTES];
   short size;
   short linelen;
 };
@@ -68,9 +73,7 @@ static int b64_init(struct B64Context *bctx)
  */
 static void b64_flush(struct B64Context *bctx, FILE *fp_out)
 {
-  /* for some reasons, mutt_b64_encode expects the
-   * output buffer to be larger than 10B */
-  char encoded[11];
+  char encoded[((B64_LINE_BYTES / 3) * 4) + 8];
   size_t ret;
 
   if (bctx->size == 0)
@@ -82,15 +85,9 @@ static void b64_flush(struct B64Context *bctx, FILE *fp_out)
     bctx->linelen = 0;
   }
 
-  /* ret should always be equal to 4 here, because bctx->size
-   * is a value between 1 and 3 (included), but let's not hardcode it
-   * and prefer the return value of the function */
   ret = mutt_b64_encode(bctx->buffer, bctx->size, encoded, sizeof(encoded));
-  for (size_t i = 0; i < ret; i++)
-  {
-    fputc(encoded[i], fp_out);
-    bctx->linelen++;
-  }
+  fwrite(encoded, 1, ret, fp_out);
+  bctx->linelen += ret;
 
   bctx->size = 0;
 }
@@ -103,7 +100,7 @@ static void b64_flush(struct B64Context *bctx, FILE *fp_out)
  */
 static void b64_putc(struct B64Context *bctx, char c, FILE *fp_out)
 {
-  if (bctx->size == 3)
+  if (bctx->size == sizeof(bctx->buffer))
     b64_flush(bctx, fp_out);
 
   bctx->buffer[bctx->size++] = c;
@@ -158,6 +155,23 @@ static void encode_8bit(struct FgetConv *fc, FILE *fp_out)
   }
 }
 
+/**
+ * qp_escape - Quote a character for quoted-printable
+ * @param buf Buffer for the result, at least 4 bytes
+ * @param c   Character to quote
+ *
+ * The result is nul-terminated, e.g. "=3D".
+ */
+static void qp_escape(char *buf, unsigned char c)
+{
+  static const char hex[] = "0123456789ABCDEF";
+
+  buf[0] = '=';
+  buf[1] = hex[c >> 4];
+  buf[2] = hex[c & 0x0f];
+  buf[3] = '\0';
+}
+
 /**
  * encode_quoted - Encode text as quoted printable
  * @param fc     Cursor for converting a file's encoding
@@ -224,7 +238,7 @@ static void encode_quoted(struct FgetConv *fc, FILE *fp_out, bool istext)
       {
         if (linelen < 74)
         {
-          sprintf(line + linelen - 1, "=%2.2X", (unsigned char) line[linelen - 1]);
+          qp_escape(line + linelen - 1, line[linelen - 1]);
           fputs(line, fp_out);
         }
         else
@@ -234,7 +248,9 @@ static void encode_quoted(struct FgetConv *fc, FILE *fp_out, bool istext)
           line[linelen - 1] = '=';
           line[linelen] = 0;
           fputs(line, fp_out);
-          fprintf(fp_out, "\n=%2.2X", (unsigned char) savechar2);
+          fputc('\n', fp_out);
+          qp_escape(line, savechar2);
+          fputs(line, fp_out);
         }
       }
       else
@@ -257,7 +273,7 @@ static void encode_quoted(struct FgetConv *fc, FILE *fp_out, bool istext)
         fputc('\n', fp_out);
         linelen = 0;
       }
-      sprintf(line + linelen, "=%2.2X", (unsigned char) c);
+      qp_escape(line + linelen, c);
       linelen += 3;
     }
     else
@@ -275,7 +291,7 @@ static void encode_quoted(struct FgetConv *fc, FILE *fp_out, bool istext)
     {
       /* take care of trailing whitespace */
       if (linelen < 74)
-        sprintf(line + linelen - 1, "=%2.2X", (unsigned char) line[linelen - 1]);
+        qp_escape(line + linelen - 1, line[linelen - 1]);
       else
       {
         savechar = line[linelen - 1];
@@ -283,7 +299,7 @@ static void encode_quoted(struct FgetConv *fc, FILE *fp_out, bool istext)
         line[linelen] = 0;
         fputs(line, fp_out);
         fputc('\n', fp_out);
-        sprintf(line, "=%2.2X", (unsigned char) savechar);
+        qp_escape(line, savechar);
       }
     }
     else
@@ -245,6 +245,12 @@ static struct ConfigDef SendVars[] = {
   { "reverse_real_name", DT_BOOL|R_INDEX|R_PAGER, true, 0, NULL,
     "Set the 'From' from the full 'To' address the email was sent to"
   },
+  { "send_queue", DT_PATH|DT_PATH_DIR, 0, 0, NULL,
+    "Directory of messages waiting to be sent in the background"
+  },
+  { "send_queue_retry", DT_NUMBER|DT_NOT_NEGATIVE, 300, 0, NULL,
+    "Time to wait before trying to send the queue again"
+  },
   { "sendmail", DT_STRING|DT_COMMAND, IP SENDMAIL " -oem -oi", 0, NULL,
     "External command to send email"
   },
@@ -31,6 +31,7 @@
  * | send/config.c    | @subpage send_config    |
  * | send/header.c    | @subpage send_header    |
  * | send/multipart.c | @subpage send_multipart |
+ * | send/queue.c     | @subpage send_queue     |
  * | send/send.c      | @subpage send_send      |
  * | send/sendlib.c   | @subpage send_sendlib   |
  * | send/sendmail.c  | @subpage send_sendmail  |
@@ -44,6 +45,7 @@
 #include "body.h"
 #include "header.h"
 #include "multipart.h"
+#include "queue.h"
 #include "send.h"
 #include "sendlib.h"
 #include "sendmail.h"
@@ -0,0 +1,589 @@
+/**
+ * @file
+ * Queue of messages waiting to be sent
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @page send_queue Queue of messages waiting to be sent
+ *
+ * If `$send_queue` is set, a message that's ready to send is saved in that
+ * directory and handed to a background process, so NeoMutt doesn't have to
+ * wait for the SMTP server or `$sendmail`.
+ *
+ * Each message is kept in two files: `ID.msg` holds the message, exactly as
+ * it will be sent, and `ID.env` holds its envelope.  The envelope is written
+ * last, so a half-written message is never sent.  A message stays in the
+ * queue until it has been sent, so if sending fails, or NeoMutt exits, it
+ * will be tried again later, see `$send_queue_retry`.
+ */
+
+#include "config.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "lib.h"
+#include "options.h"
+
+ARRAY_HEAD(QueueIds, char *);
+
+static pid_t QueuePid = 0;        ///< Background process sending the queue
+static bool QueueAgain = false;   ///< Queue changed while it was being sent
+static time_t QueueLastRun = 0;   ///< When the queue was last sent
+static int QueueCount = -1;       ///< Number of queued messages, -1 if unknown
+static char *QueueDir = NULL;     ///< Directory that was counted
+static char QueueError[256] = ""; ///< Last error of the background process
+
+/**
+ * queue_log - Save the errors of the background process - Implements ::log_dispatcher_t
+ */
+static int queue_log(time_t stamp, const char *file, int line,
+                     const char *function, enum LogLevel level, ...)
+{
+  char buf[256];
+
+  va_list ap;
+  va_start(ap, level);
+  const char *fmt = va_arg(ap, const char *);
+  int len = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+
+  if ((level == LL_PERROR) && (len >= 0) && ((size_t) len < sizeof(buf)))
+    snprintf(buf + len, sizeof(buf) - len, ": %s", strerror(errno));
+
+  if (level <= LL_ERROR)
+    mutt_str_copy(QueueError, buf, sizeof(QueueError));
+
+  return log_disp_file(stamp, file, line, function, level, "%s", buf);
+}
+
+/**
+ * queue_id_cmp - Compare two queue IDs - Implements ::sort_t
+ */
+static int queue_id_cmp(const void *a, const void *b)
+{
+  return mutt_str_cmp(*(char *const *) a, *(char *const *) b);
+}
+
+/**
+ * queue_field - Get the value of an envelope field
+ * @param line Line of the envelope file
+ * @param name Name of the field, including ": "
+ * @retval ptr  Value of the field
+ * @retval NULL Line is a different field
+ */
+static const char *queue_field(const char *line, const char *name)
+{
+  const size_t len = mutt_str_startswith(line, name);
+  return (len == 0) ? NULL : line + len;
+}
+
+/**
+ * queue_read - List the messages in the queue
+ * @param[in]  dir Queue directory
+ * @param[out] ids IDs of the messages, oldest first
+ * @retval num Number of messages
+ */
+static int queue_read(const char *dir, struct QueueIds *ids)
+{
+  DIR *dp = opendir(dir);
+  if (!dp)
+    return 0;
+
+  struct dirent *de = NULL;
+  while ((de = readdir(dp)))
+  {
+    if (de->d_name[0] == '.')
+      continue;
+
+    const size_t len = mutt_str_len(de->d_name);
+    if ((len < 5) || !mutt_str_equal(de->d_name + len - 4, ".env"))
+      continue;
+
+    ARRAY_ADD(ids, mutt_strn_dup(de->d_name, len - 4));
+  }
+  closedir(dp);
+
+  ARRAY_SORT(ids, queue_id_cmp);
+  return ARRAY_SIZE(ids);
+}
+
+/**
+ * queue_free - Free a list of queue IDs
+ * @param ids IDs to free
+ */
+static void queue_free(struct QueueIds *ids)
+{
+  char **idp = NULL;
+  ARRAY_FOREACH(idp, ids)
+  {
+    FREE(idp);
+  }
+  ARRAY_FREE(ids);
+}
+
+/**
+ * queue_error - Get the last error of a queued message
+ * @param[in]  dir    Queue directory
+ * @param[in]  id     ID of the message
+ * @param[out] buf    Buffer for the error
+ * @param[in]  buflen Length of the buffer
+ */
+static void queue_error(const char *dir, const char *id, char *buf, size_t buflen)
+{
+  struct Buffer *path = mutt_buffer_pool_get();
+  mutt_buffer_printf(path, "%s/%s.env", dir, id);
+
+  FILE *fp = mutt_file_fopen(mutt_buffer_string(path), "r");
+  mutt_buffer_pool_release(&path);
+  if (!fp)
+    return;
+
+  char line[1024];
+  while (fgets(line, sizeof(line), fp))
+  {
+    const char *p = queue_field(line, "X-Error: ");
+    if (p)
+    {
+      mutt_str_copy(buf, p, buflen);
+      mutt_str_remove_trailing_ws(buf);
+    }
+  }
+  mutt_file_fclose(&fp);
+}
+
+/**
+ * queue_send_one - Send a queued message
+ * @param dir Queue directory
+ * @param id  ID of the message
+ * @param sub Config Subset
+ * @retval  0 Message was sent, or is being sent by another process
+ * @retval -1 Error, the message is still queued
+ */
+static int queue_send_one(const char *dir, const char *id, struct ConfigSubset *sub)
+{
+  struct Buffer *env_path = mutt_buffer_pool_get();
+  struct Buffer *msg_path = mutt_buffer_pool_get();
+  struct Buffer *out_path = mutt_buffer_pool_get();
+  mutt_buffer_printf(env_path, "%s/%s.env", dir, id);
+  mutt_buffer_printf(msg_path, "%s/%s.msg", dir, id);
+  mutt_buffer_printf(out_path, "%s/%s.out", dir, id);
+
+  struct AddressList from = TAILQ_HEAD_INITIALIZER(from);
+  struct AddressList to = TAILQ_HEAD_INITIALIZER(to);
+  struct AddressList cc = TAILQ_HEAD_INITIALIZER(cc);
+  struct AddressList bcc = TAILQ_HEAD_INITIALIZER(bcc);
+  bool eightbit = false;
+  int tries = 0;
+  int rc = 0;
+
+  FILE *fp = mutt_file_fopen(mutt_buffer_string(env_path), "r+");
+  if (!fp)
+    goto done;
+
+  /* Someone else is sending it */
+  if (mutt_file_lock(fileno(fp), true, false) != 0)
+    goto done;
+
+  /* It was sent before we got the lock */
+  struct stat st;
+  if ((stat(mutt_buffer_string(env_path), &st) != 0))
+    goto done;
+
+  char line[1024];
+  while (fgets(line, sizeof(line), fp))
+  {
+    mutt_str_remove_trailing_ws(line);
+    const char *p = NULL;
+    if ((p = queue_field(line, "From: ")))
+      mutt_addrlist_append(&from, mutt_addr_create(NULL, p));
+    else if ((p = queue_field(line, "To: ")))
+      mutt_addrlist_append(&to, mutt_addr_create(NULL, p));
+    else if ((p = queue_field(line, "Cc: ")))
+      mutt_addrlist_append(&cc, mutt_addr_create(NULL, p));
+    else if ((p = queue_field(line, "Bcc: ")))
+      mutt_addrlist_append(&bcc, mutt_addr_create(NULL, p));
+    else if ((p = queue_field(line, "X-8bit: ")))
+      eightbit = mutt_str_equal(p, "yes");
+    else if ((p = queue_field(line, "X-Tries: ")))
+      tries = atoi(p);
+  }
+
+  /* The sender deletes the file it's given, so give it a link */
+  QueueError[0] = '\0';
+  unlink(mutt_buffer_string(out_path));
+  if (link(mutt_buffer_string(msg_path), mutt_buffer_string(out_path)) != 0)
+  {
+    mutt_perror(mutt_buffer_string(msg_path));
+    rc = -1;
+  }
+  else
+  {
+#ifdef USE_SMTP
+    const char *const c_smtp_url = cs_subset_string(sub, "smtp_url");
+    if (c_smtp_url)
+    {
+      rc = mutt_smtp_send(&from, &to, &cc, &bcc, mutt_buffer_string(out_path),
+                          eightbit, sub);
+    }
+    else
+#endif
+    {
+      rc = mutt_invoke_sendmail(NULL, &from, &to, &cc, &bcc,
+                                mutt_buffer_string(out_path), eightbit, sub);
+    }
+    unlink(mutt_buffer_string(out_path));
+  }
+
+  if (rc >= 0)
+  {
+    rc = 0;
+    unlink(mutt_buffer_string(msg_path));
+    unlink(mutt_buffer_string(env_path));
+    goto done;
+  }
+
+  /* Record the failure, for the user */
+  rc = -1;
+  if (QueueError[0] == '\0')
+    mutt_str_copy(QueueError, _("Error sending message"), sizeof(QueueError));
+
+  rewind(fp);
+  struct Address *a = NULL;
+  TAILQ_FOREACH(a, &from, entries)
+  {
+    fprintf(fp, "From: %s\n", a->mailbox);
+  }
+  TAILQ_FOREACH(a, &to, entries)
+  {
+    fprintf(fp, "To: %s\n", a->mailbox);
+  }
+  TAILQ_FOREACH(a, &cc, entries)
+  {
+    fprintf(fp, "Cc: %s\n", a->mailbox);
+  }
+  TAILQ_FOREACH(a, &bcc, entries)
+  {
+    fprintf(fp, "Bcc: %s\n", a->mailbox);
+  }
+  fprintf(fp, "X-8bit: %s\n", eightbit ? "yes" : "no");
+  fprintf(fp, "X-Tries: %d\n", tries + 1);
+  fprintf(fp, "X-Error: %s\n", QueueError);
+  fflush(fp);
+  if (ftruncate(fileno(fp), ftello(fp)) != 0)
+    mutt_perror(mutt_buffer_string(env_path));
+
+done:
+  mutt_file_fclose(&fp);
+  mutt_addrlist_clear(&from);
+  mutt_addrlist_clear(&to);
+  mutt_addrlist_clear(&cc);
+  mutt_addrlist_clear(&bcc);
+  mutt_buffer_pool_release(&env_path);
+  mutt_buffer_pool_release(&msg_path);
+  mutt_buffer_pool_release(&out_path);
+  return rc;
+}
+
+/**
+ * queue_count - Count the queued messages
+ * @param dir Queue directory
+ */
+static void queue_count(const char *dir)
+{
+  struct QueueIds ids = ARRAY_HEAD_INITIALIZER;
+  QueueCount = dir ? queue_read(dir, &ids) : 0;
+  queue_free(&ids);
+
+  if (!mutt_str_equal(dir, QueueDir))
+  {
+    FREE(&QueueDir);
+    QueueDir = mutt_str_dup(dir);
+  }
+}
+
+/**
+ * queue_start - Send the queue in the background
+ * @param dir Queue directory
+ * @param sub Config Subset
+ *
+ * The queue is sent by a child process, which has its own copy of the config.
+ * Each message that can't be sent is left in the queue, with its error.
+ */
+static void queue_start(const char *dir, struct ConfigSubset *sub)
+{
+  if (QueuePid > 0)
+  {
+    QueueAgain = true;
+    return;
+  }
+
+  QueueAgain = false;
+  QueueLastRun = mutt_date_epoch();
+
+  pid_t pid = fork();
+  if (pid == -1)
+  {
+    mutt_perror("fork");
+    return;
+  }
+
+  if (pid > 0)
+  {
+    QueuePid = pid;
+    return;
+  }
+
+  /* Nobody can answer questions, or see messages, so fail instead */
+  setsid();
+  OptNoCurses = true;
+  MuttLogger = queue_log;
+
+  int fd = open("/dev/null", O_RDWR);
+  if (fd >= 0)
+  {
+    dup2(fd, 0);
+    dup2(fd, 1);
+    dup2(fd, 2);
+    if (fd > 2)
+      close(fd);
+  }
+
+  int failed = 0;
+  struct QueueIds ids = ARRAY_HEAD_INITIALIZER;
+  queue_read(dir, &ids);
+
+  char **idp = NULL;
+  ARRAY_FOREACH(idp, &ids)
+  {
+    if (queue_send_one(dir, *idp, sub) != 0)
+      failed++;
+  }
+
+  queue_free(&ids);
+  _exit(MIN(failed, 0xff));
+}
+
+/**
+ * mutt_send_queue_add - Put a message in the queue and start sending it
+ * @param msg      File containing the message, will be moved into the queue
+ * @param from     From addresses
+ * @param to       To addresses
+ * @param cc       Cc addresses
+ * @param bcc      Bcc addresses
+ * @param eightbit Message contains 8-bit data
+ * @param sub      Config Subset
+ * @retval  0 Success, the message is being sent
+ * @retval -1 Error, the message wasn't queued
+ */
+int mutt_send_queue_add(const char *msg, const struct AddressList *from,
+                        const struct AddressList *to, const struct AddressList *cc,
+                        const struct AddressList *bcc, bool eightbit,
+                        struct ConfigSubset *sub)
+{
+  static unsigned int seq = 0;
+
+  const char *const c_send_queue = cs_subset_path(sub, "send_queue");
+  if (!msg || !c_send_queue)
+    return -1;
+
+  if (mutt_file_mkdir(c_send_queue, S_IRWXU) != 0)
+  {
+    mutt_perror(c_send_queue);
+    return -1;
+  }
+
+  int rc = -1;
+  struct Buffer *id = mutt_buffer_pool_get();
+  struct Buffer *msg_path = mutt_buffer_pool_get();
+  struct Buffer *env_path = mutt_buffer_pool_get();
+  struct Buffer *tmp_path = mutt_buffer_pool_get();
+
+  mutt_buffer_printf(id, "%010llu.%d.%u", (unsigned long long) mutt_date_epoch(),
+                     (int) getpid(), seq++);
+  mutt_buffer_printf(msg_path, "%s/%s.msg", c_send_queue, mutt_buffer_string(id));
+  mutt_buffer_printf(env_path, "%s/%s.env", c_send_queue, mutt_buffer_string(id));
+  mutt_buffer_printf(tmp_path, "%s/%s.tmp", c_send_queue, mutt_buffer_string(id));
+
+  /* $tmpdir may be on another filesystem */
+  if (rename(msg, mutt_buffer_string(msg_path)) != 0)
+  {
+    FILE *fp_in = mutt_file_fopen(msg, "r");
+    FILE *fp_out = mutt_file_fopen(mutt_buffer_string(msg_path), "w");
+    if (!fp_in || !fp_out || (mutt_file_copy_stream(fp_in, fp_out) < 0))
+    {
+      mutt_perror(mutt_buffer_string(msg_path));
+      mutt_file_fclose(&fp_in);
+      mutt_file_fclose(&fp_out);
+      unlink(mutt_buffer_string(msg_path));
+      goto done;
+    }
+    mutt_file_fclose(&fp_in);
+    if (mutt_file_fclose(&fp_out) != 0)
+    {
+      mutt_perror(mutt_buffer_string(msg_path));
+      unlink(mutt_buffer_string(msg_path));
+      goto done;
+    }
+    unlink(msg);
+  }
+
+  FILE *fp = mutt_file_fopen(mutt_buffer_string(tmp_path), "w");
+  if (!fp)
+  {
+    mutt_perror(mutt_buffer_string(tmp_path));
+    goto done;
+  }
+
+  struct Address *a = NULL;
+  TAILQ_FOREACH(a, from, entries)
+  {
+    if (a->mailbox)
+      fprintf(fp, "From: %s\n", a->mailbox);
+  }
+  TAILQ_FOREACH(a, to, entries)
+  {
+    if (a->mailbox)
+      fprintf(fp, "To: %s\n", a->mailbox);
+  }
+  TAILQ_FOREACH(a, cc, entries)
+  {
+    if (a->mailbox)
+      fprintf(fp, "Cc: %s\n", a->mailbox);
+  }
+  TAILQ_FOREACH(a, bcc, entries)
+  {
+    if (a->mailbox)
+      fprintf(fp, "Bcc: %s\n", a->mailbox);
+  }
+  fprintf(fp, "X-8bit: %s\n", eightbit ? "yes" : "no");
+  fprintf(fp, "X-Tries: 0\n");
+
+  if ((mutt_file_fclose(&fp) != 0) ||
+      (rename(mutt_buffer_string(tmp_path), mutt_buffer_string(env_path)) != 0))
+  {
+    mutt_perror(mutt_buffer_string(env_path));
+    unlink(mutt_buffer_string(tmp_path));
+    goto done;
+  }
+
+  mutt_debug(LL_DEBUG1, "queued %s\n", mutt_buffer_string(id));
+  queue_count(c_send_queue);
+  queue_start(c_send_queue, sub);
+  rc = 0;
+
+done:
+  if (rc != 0)
+  {
+    /* leave the message where the caller can find it */
+    if (access(msg, F_OK) != 0)
+      rename(mutt_buffer_string(msg_path), msg);
+  }
+  mutt_buffer_pool_release(&id);
+  mutt_buffer_pool_release(&msg_path);
+  mutt_buffer_pool_release(&env_path);
+  mutt_buffer_pool_release(&tmp_path);
+  return rc;
+}
+
+/**
+ * mutt_send_queue_check - Check on the queue
+ * @retval true The number of queued messages has changed
+ *
+ * The user is told when the background process finishes.  If messages are
+ * left in the queue, they're tried again after `$send_queue_retry` seconds.
+ */
+bool mutt_send_queue_check(void)
+{
+  const char *const c_send_queue = cs_subset_path(NeoMutt->sub, "send_queue");
+  const int old_count = QueueCount;
+
+  if (!mutt_str_equal(c_send_queue, QueueDir) || (QueueCount < 0))
+    queue_count(c_send_queue);
+
+  if (QueuePid > 0)
+  {
+    int st = 0;
+    pid_t pid = waitpid(QueuePid, &st, WNOHANG);
+    if (pid == 0)
+      return (QueueCount != old_count);
+
+    QueuePid = 0;
+    const int sent = QueueCount;
+    queue_count(c_send_queue);
+
+    const int failed = ((pid > 0) && WIFEXITED(st)) ? WEXITSTATUS(st) : QueueCount;
+    if ((failed > 0) && (QueueCount > 0))
+    {
+      char err[256] = "";
+      struct QueueIds ids = ARRAY_HEAD_INITIALIZER;
+      if (queue_read(c_send_queue, &ids) > 0)
+        queue_error(c_send_queue, *ARRAY_GET(&ids, 0), err, sizeof(err));
+      queue_free(&ids);
+
+      mutt_error(ngettext("%d queued message couldn't be sent: %s",
+                          "%d queued messages couldn't be sent: %s", QueueCount),
+                 QueueCount, err[0] ? err : _("unknown error"));
+    }
+    else if ((sent > 0) && (QueueCount == 0))
+    {
+      mutt_message(ngettext("Queued message sent", "Queued messages sent", sent));
+    }
+
+    if (QueueAgain && c_send_queue)
+      queue_start(c_send_queue, NeoMutt->sub);
+
+    return true;
+  }
+
+  if (!c_send_queue || (QueueCount <= 0))
+    return (QueueCount != old_count);
+
+  /* Try again, e.g. after an error, or on startup */
+  const short c_send_queue_retry = cs_subset_number(NeoMutt->sub, "send_queue_retry");
+  if ((QueueLastRun == 0) ||
+      ((c_send_queue_retry > 0) && (mutt_date_epoch() >= (QueueLastRun + c_send_queue_retry))))
+  {
+    queue_start(c_send_queue, NeoMutt->sub);
+  }
+
+  return (QueueCount != old_count);
+}
+
+/**
+ * mutt_send_queue_count - Get the number of queued messages
+ * @retval num Number of messages waiting to be sent
+ */
+int mutt_send_queue_count(void)
+{
+  return MAX(QueueCount, 0);
+}
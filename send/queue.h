@@ -0,0 +1,35 @@
+/**
+ * @file
+ * Queue of messages waiting to be sent
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MUTT_SEND_QUEUE_H
+#define MUTT_SEND_QUEUE_H
+
+#include <stdbool.h>
+
+struct AddressList;
+struct ConfigSubset;
+
+int  mutt_send_queue_add  (const char *msg, const struct AddressList *from, const struct AddressList *to, const struct AddressList *cc, const struct AddressList *bcc, bool eightbit, struct ConfigSubset *sub);
+bool mutt_send_queue_check(void);
+int  mutt_send_queue_count(void);
+
+#endif /* MUTT_SEND_QUEUE_H */
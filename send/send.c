@@ -1506,7 +1506,7 @@ static int invoke_mta(struct Mailbox *m, struct Email *e, struct ConfigSubset *s
 
   fputc('\n', fp_tmp); /* tie off the header. */
 
-  if ((mutt_write_mime_body(e->body, fp_tmp, sub) == -1))
+  if ((mutt_body_spool_write(e->body, fp_tmp, sub) == -1))
     goto cleanup;
 
   if (mutt_file_fclose(&fp_tmp) != 0)
@@ -1529,6 +1529,23 @@ static int invoke_mta(struct Mailbox *m, struct Email *e, struct ConfigSubset *s
     goto sendmail;
 #endif
 
+  /* Let a background process wait for the server */
+  const char *const c_send_queue = cs_subset_path(sub, "send_queue");
+  if (c_send_queue && !OptNoCurses)
+  {
+    if (mutt_send_queue_add(mutt_buffer_string(tempfile), &e->env->from,
+                            &e->env->to, &e->env->cc, &e->env->bcc,
+                            (e->body->encoding == ENC_8BIT), sub) == 0)
+    {
+      rc = 1; /* sending in the background */
+    }
+    else
+    {
+      unlink(mutt_buffer_string(tempfile));
+    }
+    goto cleanup;
+  }
+
 #ifdef USE_SMTP
   if (c_smtp_url)
   {
@@ -2847,6 +2864,9 @@ int mutt_send_message(SendFlags flags, struct Email *e_templ, const char *tempfi
 
   mutt_prepare_envelope(e_templ->env, true, sub);
 
+  /* The body is encoded once, for both the MTA and the Fcc */
+  mutt_body_spool_start();
+
   const bool c_fcc_before_send = cs_subset_bool(sub, "fcc_before_send");
   if (c_fcc_before_send)
     save_fcc(e_templ, &fcc, clear_content, pgpkeylist, flags, &finalpath, sub);
@@ -2854,6 +2874,7 @@ int mutt_send_message(SendFlags flags, struct Email *e_templ, const char *tempfi
   i = invoke_mta(m, e_templ, sub);
   if (i < 0)
   {
+    mutt_body_spool_stop();
     if (!(flags & SEND_BATCH))
     {
       if (!WithCrypto)
@@ -2891,6 +2912,8 @@ int mutt_send_message(SendFlags flags, struct Email *e_templ, const char *tempfi
   if (!c_fcc_before_send)
     save_fcc(e_templ, &fcc, clear_content, pgpkeylist, flags, &finalpath, sub);
 
+  mutt_body_spool_stop();
+
   if (!OptNoCurses)
   {
     mutt_message((i != 0) ? _("Sending in background") :
@@ -34,6 +34,7 @@
 #include <inttypes.h> // IWYU pragma: keep
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -71,6 +72,46 @@ struct ContentState
   bool was_cr;
 };
 
+/// Size of the blocks that are read from an attachment
+#define CONTENT_BUF_SIZE (64 * 1024)
+/// How much of a text attachment is checked for NULs, see content_is_binary()
+#define CONTENT_BINARY_CHECK (8 * 1024)
+
+/// A byte repeated in each position of a word, for scanning eight bytes at a time
+#define ONES ((uint64_t) 0x0101010101010101ULL)
+#define HIGHS ((uint64_t) 0x8080808080808080ULL)
+
+/**
+ * printable_span - Measure a run of printable ASCII characters
+ * @param buf    Buffer to scan
+ * @param buflen Length of the buffer
+ * @retval num Length of the run, a multiple of eight
+ *
+ * The bytes are checked eight at a time.  A word is in the run if every byte
+ * is between ' ' and '~', i.e. has no special meaning to update_content_info().
+ */
+static size_t printable_span(const char *buf, size_t buflen)
+{
+  size_t len = 0;
+
+  while ((buflen - len) >= sizeof(uint64_t))
+  {
+    uint64_t w;
+    memcpy(&w, buf + len, sizeof(w));
+
+    const uint64_t high = w & HIGHS;                  // 8-bit
+    const uint64_t low = (w - (ONES * 0x20)) & ~w;    // < ' '
+    const uint64_t x = w ^ (ONES * 0x7f);
+    const uint64_t del = (x - ONES) & ~x;             // == DEL
+    if ((high | ((low | del) & HIGHS)) != 0)
+      break;
+
+    len += sizeof(w);
+  }
+
+  return len;
+}
+
 /**
  * update_content_info - Cache some info about an email
  * @param info   Info about an Attachment
@@ -99,6 +140,28 @@ static void update_content_info(struct Content *info, struct ContentState *s,
 
   for (; buflen; buf++, buflen--)
   {
+    /* In the middle of a line, skip quickly over ordinary text.  The checks
+     * for "From " and "." only look at the start of a line. */
+    if (!was_cr && (linelen >= 4))
+    {
+      const size_t span = printable_span(buf, buflen);
+      if (span > 0)
+      {
+        size_t spaces = 0;
+        while ((spaces < span) && (buf[span - spaces - 1] == ' '))
+          spaces++;
+        whitespace = (spaces == span) ? (whitespace + spaces) : spaces;
+
+        info->ascii += span;
+        linelen += span;
+        dot = false;
+        buf += span;
+        buflen -= span;
+        if (buflen == 0)
+          break;
+      }
+    }
+
     char ch = *buf;
 
     if (was_cr)
@@ -228,7 +291,7 @@ static void update_content_info(struct Content *info, struct ContentState *s,
 static size_t convert_file_to(FILE *fp, const char *fromcode, int ncodes,
                               char const *const *tocodes, int *tocode, struct Content *info)
 {
-  char bufi[256], bufu[512], bufo[4 * sizeof(bufi)];
+  char bufi[4096], bufu[2 * sizeof(bufi)], bufo[4 * sizeof(bufi)];
   size_t ret;
 
   const iconv_t cd1 = mutt_ch_iconv_open("utf-8", fromcode, MUTT_ICONV_NO_FLAGS);
@@ -344,11 +407,6 @@ static size_t convert_file_to(FILE *fp, const char *fromcode, int ncodes,
     }
   }
 
-  for (int i = 0; i < ncodes; i++)
-    if (cd[i] != (iconv_t)(-1))
-      iconv_close(cd[i]);
-
-  iconv_close(cd1);
   FREE(&cd);
   FREE(&infos);
   FREE(&score);
@@ -385,7 +443,7 @@ static size_t convert_file_from_to(FILE *fp, const char *fromcodes, const char *
   char **tcode = NULL;
   const char *c = NULL, *c1 = NULL;
   size_t ret;
-  int ncodes, i, cn;
+  int ncodes, i, cn = 0;
 
   /* Count the tocodes */
   ncodes = 0;
@@ -455,6 +513,26 @@ static size_t convert_file_from_to(FILE *fp, const char *fromcodes, const char *
   return ret;
 }
 
+/**
+ * content_is_binary - Does a file look like binary data?
+ * @param fp File to check
+ * @retval true The start of the file contains a NUL
+ *
+ * A file of unknown type that contains a NUL will become
+ * application/octet-stream, see mutt_make_file_attach(), so there's no point
+ * converting it to each of `$send_charset` first.
+ */
+static bool content_is_binary(FILE *fp)
+{
+  char buf[CONTENT_BINARY_CHECK];
+
+  rewind(fp);
+  const size_t r = fread(buf, 1, sizeof(buf), fp);
+  rewind(fp);
+
+  return memchr(buf, '\0', r) != NULL;
+}
+
 /**
  * mutt_get_content_info - Analyze file to determine MIME encoding to use
  * @param fname File to examine
@@ -472,7 +550,6 @@ struct Content *mutt_get_content_info(const char *fname, struct Body *b,
   FILE *fp = NULL;
   char *fromcode = NULL;
   char *tocode = NULL;
-  char buf[100];
   size_t r;
 
   struct stat sb;
@@ -505,7 +582,8 @@ struct Content *mutt_get_content_info(const char *fname, struct Body *b,
 
   const char *const c_charset = cs_subset_string(sub, "charset");
 
-  if (b && (b->type == TYPE_TEXT) && (!b->noconv && !b->force_charset))
+  if (b && (b->type == TYPE_TEXT) && (!b->noconv && !b->force_charset) &&
+      (b->subtype || !content_is_binary(fp)))
   {
     const char *const c_attach_charset =
         cs_subset_string(sub, "attach_charset");
@@ -532,10 +610,12 @@ struct Content *mutt_get_content_info(const char *fname, struct Body *b,
     }
   }
 
+  char *buf = mutt_mem_malloc(CONTENT_BUF_SIZE);
   rewind(fp);
-  while ((r = fread(buf, 1, sizeof(buf), fp)))
+  while ((r = fread(buf, 1, CONTENT_BUF_SIZE, fp)))
     update_content_info(info, &state, buf, r);
   update_content_info(info, &state, 0, 0);
+  FREE(&buf);
 
   mutt_file_fclose(&fp);
 
@@ -1448,6 +1528,131 @@ static void set_noconv_flags(struct Body *b, bool flag)
   }
 }
 
+/**
+ * struct BodySpool - A MIME body, rendered once and copied to each destination
+ *
+ * Sending a message writes its body for the MTA and again for each Fcc.
+ * Encoding large attachments is slow, so while spooling is on, the body is
+ * encoded once into a temporary file and then copied.
+ */
+struct BodySpool
+{
+  bool active;       ///< Is spooling on?
+  struct Body *body; ///< Body that has been rendered
+  FILE *fp;          ///< Unlinked temporary file holding the rendered body
+  LOFF_T length;     ///< Length of the rendered body
+  int lines;         ///< Number of lines in the rendered body
+  bool newline;      ///< Does the rendered body end with a newline?
+};
+
+static struct BodySpool Spool = { 0 }; ///< Body being sent
+
+/**
+ * body_spool_reset - Discard the rendered body
+ */
+static void body_spool_reset(void)
+{
+  mutt_file_fclose(&Spool.fp);
+  Spool.body = NULL;
+  Spool.length = 0;
+  Spool.lines = 0;
+  Spool.newline = false;
+}
+
+/**
+ * body_spool_render - Render a Body into the spool
+ * @param b   Body to render
+ * @param sub Config Subset
+ * @retval true Success
+ */
+static bool body_spool_render(struct Body *b, struct ConfigSubset *sub)
+{
+  if (Spool.fp && (Spool.body == b))
+    return true;
+
+  body_spool_reset();
+
+  Spool.fp = mutt_file_mkstemp();
+  if (!Spool.fp)
+    return false;
+
+  if ((mutt_write_mime_body(b, Spool.fp, sub) == -1) || (fflush(Spool.fp) != 0) ||
+      ferror(Spool.fp))
+  {
+    body_spool_reset();
+    return false;
+  }
+
+  /* Count the lines, ready for a Content-Length header */
+  char buf[8192];
+  size_t num;
+  char last = '\n';
+  rewind(Spool.fp);
+  while ((num = fread(buf, 1, sizeof(buf), Spool.fp)) > 0)
+  {
+    for (const char *p = buf; (p = memchr(p, '\n', num - (p - buf))); p++)
+      Spool.lines++;
+    Spool.length += num;
+    last = buf[num - 1];
+  }
+  Spool.newline = (last == '\n');
+  if (!Spool.newline)
+    Spool.lines++;
+
+  Spool.body = b;
+  return true;
+}
+
+/**
+ * body_spool_copy - Copy the rendered body to a file
+ * @param fp File to write to
+ * @retval  0 Success
+ * @retval -1 Error
+ */
+static int body_spool_copy(FILE *fp)
+{
+  rewind(Spool.fp);
+  return (mutt_file_copy_stream(Spool.fp, fp) < 0) ? -1 : 0;
+}
+
+/**
+ * mutt_body_spool_start - Render each Body only once
+ *
+ * Until mutt_body_spool_stop() is called, the Body must not be changed.
+ */
+void mutt_body_spool_start(void)
+{
+  body_spool_reset();
+  Spool.active = true;
+}
+
+/**
+ * mutt_body_spool_stop - Discard the rendered body
+ */
+void mutt_body_spool_stop(void)
+{
+  body_spool_reset();
+  Spool.active = false;
+}
+
+/**
+ * mutt_body_spool_write - Write a MIME body, using the spool if possible
+ * @param b   Body to write
+ * @param fp  File to write to
+ * @param sub Config Subset
+ * @retval  0 Success
+ * @retval -1 Error
+ *
+ * If spooling is off, this is the same as mutt_write_mime_body().
+ */
+int mutt_body_spool_write(struct Body *b, FILE *fp, struct ConfigSubset *sub)
+{
+  if (!Spool.active || !body_spool_render(b, sub))
+    return mutt_write_mime_body(b, fp, sub);
+
+  return body_spool_copy(fp);
+}
+
 /**
  * mutt_write_multiple_fcc - Handle FCC with multiple, comma separated entries
  * @param[in]  path      Path to mailboxes (comma separated)
@@ -1535,9 +1740,19 @@ int mutt_write_fcc(const char *path, struct Email *e, const char *msgid, bool po
     goto done;
   }
 
+  /* A spooled body has already been rendered, and its lines counted */
+  const bool spooled = !post && Spool.active && body_spool_render(e->body, sub);
+
   /* We need to add a Content-Length field to avoid problems where a line in
    * the message body begins with "From " */
-  if ((ctx_fcc->mailbox->type == MUTT_MMDF) || (ctx_fcc->mailbox->type == MUTT_MBOX))
+  if (((ctx_fcc->mailbox->type == MUTT_MMDF) || (ctx_fcc->mailbox->type == MUTT_MBOX)) &&
+      spooled)
+  {
+    /* remember new mail status before appending message */
+    need_mailbox_cleanup = true;
+    stat(path, &st);
+  }
+  else if ((ctx_fcc->mailbox->type == MUTT_MMDF) || (ctx_fcc->mailbox->type == MUTT_MBOX))
   {
     tempfile = mutt_buffer_pool_get();
     mutt_buffer_mktemp(tempfile);
@@ -1664,7 +1879,23 @@ int mutt_write_fcc(const char *path, struct Email *e, const char *msgid, bool po
   }
 #endif
 
-  if (fp_tmp)
+  if (spooled && need_mailbox_cleanup)
+  {
+    /* the copy must end with a newline, like the unspooled one below */
+    fprintf(msg->fp, "Content-Length: " OFF_T_FMT "\n",
+            Spool.length + (Spool.newline ? 0 : 1));
+    fprintf(msg->fp, "Lines: %d\n\n", Spool.lines);
+
+    rc = body_spool_copy(msg->fp);
+    if ((rc == 0) && !Spool.newline)
+      fputc('\n', msg->fp);
+  }
+  else if (spooled)
+  {
+    fputc('\n', msg->fp); /* finish off the header */
+    rc = body_spool_copy(msg->fp);
+  }
+  else if (fp_tmp)
   {
     mutt_write_mime_body(e->body, fp_tmp, sub);
 
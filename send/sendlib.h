@@ -34,6 +34,9 @@ struct Mailbox;
 
 #define MUTT_RANDTAG_LEN 16
 
+int              mutt_body_spool_write(struct Body *b, FILE *fp, struct ConfigSubset *sub);
+void             mutt_body_spool_start(void);
+void             mutt_body_spool_stop(void);
 int              mutt_bounce_message(FILE *fp, struct Mailbox *m, struct Email *e, struct AddressList *to, struct ConfigSubset *sub);
 const char *     mutt_fqdn(bool may_hide_host, const struct ConfigSubset *sub);
 struct Content * mutt_get_content_info(const char *fname, struct Body *b, struct ConfigSubset *sub);
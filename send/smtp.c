@@ -83,10 +83,15 @@ typedef uint8_t SmtpCapFlags;          ///< Flags, e.g. #SMTP_CAP_STARTTLS
 #define SMTP_CAP_DSN          (1 << 2) ///< Server supports Delivery Status Notification
 #define SMTP_CAP_EIGHTBITMIME (1 << 3) ///< Server supports 8-bit MIME content
 #define SMTP_CAP_SMTPUTF8     (1 << 4) ///< Server accepts UTF-8 strings
+#define SMTP_CAP_PIPELINING   (1 << 5) ///< Server accepts several commands at once, RFC2920
+#define SMTP_CAP_CHUNKING     (1 << 6) ///< Server accepts BDAT, RFC3030
 
-#define SMTP_CAP_ALL         ((1 << 5) - 1)
+#define SMTP_CAP_ALL         ((1 << 7) - 1)
 // clang-format on
 
+#define SMTP_PIPELINE_DEPTH 64 ///< Number of commands sent ahead, if the server supports PIPELINING
+#define SMTP_CHUNK_SIZE (64 * 1024) ///< Size of the blocks read from the message file
+
 /**
  * struct SmtpAccountData - Server connection data
  */
@@ -174,6 +179,10 @@ static int smtp_get_resp(struct SmtpAccountData *adata)
       adata->capabilities |= SMTP_CAP_STARTTLS;
     else if (mutt_istr_startswith(s, "SMTPUTF8"))
       adata->capabilities |= SMTP_CAP_SMTPUTF8;
+    else if (mutt_istr_startswith(s, "PIPELINING"))
+      adata->capabilities |= SMTP_CAP_PIPELINING;
+    else if (mutt_istr_startswith(s, "CHUNKING"))
+      adata->capabilities |= SMTP_CAP_CHUNKING;
 
     if (!valid_smtp_code(buf, n, &n))
       return SMTP_ERR_CODE;
@@ -188,16 +197,62 @@ static int smtp_get_resp(struct SmtpAccountData *adata)
 }
 
 /**
- * smtp_rcpt_to - Set the recipient to an Address
+ * smtp_send_commands - Send some commands and read their responses
  * @param adata SMTP Account data
- * @param al    AddressList to use
+ * @param cmds  Commands, each ending in CRLF
  * @retval  0 Success
  * @retval <0 Error, e.g. #SMTP_ERR_WRITE
+ *
+ * If the server supports PIPELINING, several commands are written at once,
+ * before their responses are read.  Otherwise, each command waits for the
+ * response to the one before.
+ *
+ * The responses are read in order.  If one fails, the rest aren't read, so
+ * the connection can't be used any more.
  */
-static int smtp_rcpt_to(struct SmtpAccountData *adata, const struct AddressList *al)
+static int smtp_send_commands(struct SmtpAccountData *adata, struct ListHead *cmds)
+{
+  const int depth = (adata->capabilities & SMTP_CAP_PIPELINING) ? SMTP_PIPELINE_DEPTH : 1;
+  struct Buffer *buf = mutt_buffer_pool_get();
+  struct ListNode *next = STAILQ_FIRST(cmds);
+  int pending = 0;
+  int rc = 0;
+
+  while (next || (pending > 0))
+  {
+    /* fill the window */
+    mutt_buffer_reset(buf);
+    for (; next && (pending < depth); next = STAILQ_NEXT(next, entries), pending++)
+      mutt_buffer_addstr(buf, next->data);
+
+    if (!mutt_buffer_is_empty(buf) &&
+        (mutt_socket_send(adata->conn, mutt_buffer_string(buf)) == -1))
+    {
+      rc = SMTP_ERR_WRITE;
+      break;
+    }
+
+    rc = smtp_get_resp(adata);
+    pending--;
+    if (rc != 0)
+      break;
+  }
+
+  mutt_buffer_pool_release(&buf);
+  return rc;
+}
+
+/**
+ * smtp_rcpt_to - Set the recipient to an Address
+ * @param adata SMTP Account data
+ * @param al    AddressList to use
+ * @param cmds  List for the RCPT TO commands
+ */
+static void smtp_rcpt_to(struct SmtpAccountData *adata,
+                         const struct AddressList *al, struct ListHead *cmds)
 {
   if (!al)
-    return 0;
+    return;
 
   const char *const c_dsn_notify = cs_subset_string(adata->sub, "dsn_notify");
 
@@ -214,30 +269,54 @@ static int smtp_rcpt_to(struct SmtpAccountData *adata, const struct AddressList
       snprintf(buf, sizeof(buf), "RCPT TO:<%s> NOTIFY=%s\r\n", a->mailbox, c_dsn_notify);
     else
       snprintf(buf, sizeof(buf), "RCPT TO:<%s>\r\n", a->mailbox);
-    if (mutt_socket_send(adata->conn, buf) == -1)
-      return SMTP_ERR_WRITE;
-    int rc = smtp_get_resp(adata);
-    if (rc != 0)
-      return rc;
+    mutt_list_insert_tail(cmds, mutt_str_dup(buf));
   }
+}
 
-  return 0;
+/**
+ * smtp_convert - Convert a block of the message to the SMTP format
+ * @param[in]     in      Block of the message file
+ * @param[in]     inlen   Length of the block
+ * @param[in,out] prev    Last character of the previous block, '\n' at first
+ * @param[in]     stuff   If true, escape lines beginning with '.' (DATA)
+ * @param[out]    out     Buffer for the converted block
+ *
+ * Line endings are converted to CRLF.
+ */
+static void smtp_convert(const char *in, size_t inlen, char *prev, bool stuff,
+                         struct Buffer *out)
+{
+  mutt_buffer_reset(out);
+  for (size_t i = 0; i < inlen; i++)
+  {
+    const char c = in[i];
+    if (stuff && (c == '.') && (*prev == '\n'))
+      mutt_buffer_addch(out, '.');
+    if ((c == '\n') && (*prev != '\r'))
+      mutt_buffer_addch(out, '\r');
+    mutt_buffer_addch(out, c);
+    *prev = c;
+  }
 }
 
 /**
  * smtp_data - Send data to an SMTP server
  * @param adata   SMTP Account data
  * @param msgfile Filename containing data
+ * @param sent    The DATA command has already been sent
  * @retval  0 Success
  * @retval <0 Error, e.g. #SMTP_ERR_WRITE
+ *
+ * If the server supports CHUNKING, the message is sent with BDAT.  Otherwise,
+ * it's sent after DATA, with dot-stuffing.  Either way, the file is read in
+ * large blocks.  If the server supports PIPELINING, the responses to the BDAT
+ * commands are read at the end.
  */
-static int smtp_data(struct SmtpAccountData *adata, const char *msgfile)
+static int smtp_data(struct SmtpAccountData *adata, const char *msgfile, bool sent)
 {
-  char buf[1024];
   struct Progress progress;
   struct stat st;
-  int rc, term = 0;
-  size_t buflen = 0;
+  int rc = 0;
 
   FILE *fp = fopen(msgfile, "r");
   if (!fp)
@@ -249,57 +328,90 @@ static int smtp_data(struct SmtpAccountData *adata, const char *msgfile)
   unlink(msgfile);
   mutt_progress_init(&progress, _("Sending message..."), MUTT_PROGRESS_NET, st.st_size);
 
-  snprintf(buf, sizeof(buf), "DATA\r\n");
-  if (mutt_socket_send(adata->conn, buf) == -1)
-  {
-    mutt_file_fclose(&fp);
-    return SMTP_ERR_WRITE;
-  }
-  rc = smtp_get_resp(adata);
-  if (rc != 0)
+  const bool chunking = (adata->capabilities & SMTP_CAP_CHUNKING);
+  const bool pipelining = (adata->capabilities & SMTP_CAP_PIPELINING);
+
+  if (!chunking && !sent)
   {
-    mutt_file_fclose(&fp);
-    return rc;
+    if (mutt_socket_send(adata->conn, "DATA\r\n") == -1)
+    {
+      mutt_file_fclose(&fp);
+      return SMTP_ERR_WRITE;
+    }
+    rc = smtp_get_resp(adata);
+    if (rc != 0)
+    {
+      mutt_file_fclose(&fp);
+      return rc;
+    }
   }
 
-  while (fgets(buf, sizeof(buf) - 1, fp))
+  char *block = mutt_mem_malloc(SMTP_CHUNK_SIZE);
+  struct Buffer *out = mutt_buffer_pool_get_size(2 * SMTP_CHUNK_SIZE + 8);
+  char cmd[64];
+  char prev = '\n';
+  int pending = 0;
+  size_t len;
+
+  do
   {
-    buflen = mutt_str_len(buf);
-    term = buflen && buf[buflen - 1] == '\n';
-    if (term && ((buflen == 1) || (buf[buflen - 2] != '\r')))
-      snprintf(buf + buflen - 1, sizeof(buf) - buflen + 1, "\r\n");
-    if (buf[0] == '.')
+    len = fread(block, 1, SMTP_CHUNK_SIZE, fp);
+    smtp_convert(block, len, &prev, !chunking, out);
+
+    /* the message must end with CRLF */
+    const bool last = (len < SMTP_CHUNK_SIZE);
+    if (last && (prev != '\n'))
     {
-      if (mutt_socket_send_d(adata->conn, ".", MUTT_SOCK_LOG_FULL) == -1)
+      mutt_buffer_addstr(out, "\r\n");
+      prev = '\n';
+    }
+
+    if (chunking && (!mutt_buffer_is_empty(out) || last))
+    {
+      snprintf(cmd, sizeof(cmd), "BDAT %zu%s\r\n", mutt_buffer_len(out), last ? " LAST" : "");
+      if (mutt_socket_send(adata->conn, cmd) == -1)
       {
-        mutt_file_fclose(&fp);
-        return SMTP_ERR_WRITE;
+        rc = SMTP_ERR_WRITE;
+        break;
       }
+      pending++;
     }
-    if (mutt_socket_send_d(adata->conn, buf, MUTT_SOCK_LOG_FULL) == -1)
+
+    if (!mutt_buffer_is_empty(out) &&
+        (mutt_socket_write_d(adata->conn, mutt_buffer_string(out),
+                             mutt_buffer_len(out), MUTT_SOCK_LOG_FULL) == -1))
     {
-      mutt_file_fclose(&fp);
-      return SMTP_ERR_WRITE;
+      rc = SMTP_ERR_WRITE;
+      break;
+    }
+
+    /* without PIPELINING, each chunk waits for its response */
+    for (; (pending > 0) && (!pipelining || last); pending--)
+    {
+      rc = smtp_get_resp(adata);
+      if (rc != 0)
+        break;
     }
+    if (rc != 0)
+      break;
+
     mutt_progress_update(&progress, ftell(fp), -1);
-  }
-  if (!term && buflen &&
-      (mutt_socket_send_d(adata->conn, "\r\n", MUTT_SOCK_LOG_FULL) == -1))
-  {
-    mutt_file_fclose(&fp);
-    return SMTP_ERR_WRITE;
-  }
+  } while (len == SMTP_CHUNK_SIZE);
+
+  if ((rc == 0) && ferror(fp))
+    rc = -1;
+
+  FREE(&block);
+  mutt_buffer_pool_release(&out);
   mutt_file_fclose(&fp);
+  if ((rc != 0) || chunking)
+    return rc;
 
   /* terminate the message body */
   if (mutt_socket_send(adata->conn, ".\r\n") == -1)
     return SMTP_ERR_WRITE;
 
-  rc = smtp_get_resp(adata);
-  if (rc != 0)
-    return rc;
-
-  return 0;
+  return smtp_get_resp(adata);
 }
 
 /**
@@ -940,24 +1052,27 @@ int mutt_smtp_send(const struct AddressList *from, const struct AddressList *to,
       snprintf(buf + len, sizeof(buf) - len, " SMTPUTF8");
     }
     mutt_strn_cat(buf, sizeof(buf), "\r\n", 3);
-    if (mutt_socket_send(adata.conn, buf) == -1)
-    {
-      rc = SMTP_ERR_WRITE;
-      break;
-    }
-    rc = smtp_get_resp(&adata);
-    if (rc != 0)
-      break;
 
-    /* send the recipient list */
-    if ((rc = smtp_rcpt_to(&adata, to)) || (rc = smtp_rcpt_to(&adata, cc)) ||
-        (rc = smtp_rcpt_to(&adata, bcc)))
-    {
+    /* send the sender's address and the recipient list, and, if they can be
+     * pipelined, the DATA command, too */
+    struct ListHead cmds = STAILQ_HEAD_INITIALIZER(cmds);
+    mutt_list_insert_tail(&cmds, mutt_str_dup(buf));
+    smtp_rcpt_to(&adata, to, &cmds);
+    smtp_rcpt_to(&adata, cc, &cmds);
+    smtp_rcpt_to(&adata, bcc, &cmds);
+
+    const bool data_sent = (adata.capabilities & SMTP_CAP_PIPELINING) &&
+                           !(adata.capabilities & SMTP_CAP_CHUNKING);
+    if (data_sent)
+      mutt_list_insert_tail(&cmds, mutt_str_dup("DATA\r\n"));
+
+    rc = smtp_send_commands(&adata, &cmds);
+    mutt_list_free(&cmds);
+    if (rc != 0)
       break;
-    }
 
     /* send the message data */
-    rc = smtp_data(&adata, msgfile);
+    rc = smtp_data(&adata, msgfile, data_sent);
     if (rc != 0)
       break;
 
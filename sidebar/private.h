@@ -32,18 +32,52 @@ struct Mailbox;
 
 extern struct ListHead SidebarWhitelist;
 
+/**
+ * struct SbEntryStats - Everything that SbEntry::display was formatted from
+ *
+ * If none of these have changed, the entry doesn't need formatting again.
+ */
+struct SbEntryStats
+{
+  unsigned int generation; ///< #ConfigGeneration
+  int width;               ///< Width of the entry
+  int depth;               ///< Indentation depth
+  int has_new;             ///< Mailbox::has_new
+  int msg_count;           ///< Mailbox::msg_count
+  int msg_unread;          ///< Mailbox::msg_unread
+  int msg_flagged;         ///< Mailbox::msg_flagged
+  int msg_new;             ///< Mailbox::msg_new
+  int is_current;          ///< Mailbox is open in the Context
+  int msg_deleted;         ///< Mailbox::msg_deleted of the open Mailbox
+  int msg_tagged;          ///< Mailbox::msg_tagged of the open Mailbox
+  int vcount;              ///< Mailbox::vcount of the open Mailbox
+};
+
 /**
  * struct SbEntry - Info about folders in the sidebar
  */
 struct SbEntry
 {
-  char box[256];           ///< Mailbox path (possibly abbreviated)
-  char display[256];       ///< Formatted string to display
-  int depth;               ///< Indentation depth
-  struct Mailbox *mailbox; ///< Mailbox this represents
-  bool is_hidden;          ///< Don't show, e.g. $sidebar_new_mail_only
-  enum ColorId color;      ///< Colour to use
+  char box[256];             ///< Mailbox path (possibly abbreviated)
+  char display[256];         ///< Formatted string to display
+  char name[256];            ///< Mailbox::name used for the display
+  struct SbEntryStats stats; ///< What the display was formatted from
+  bool formatted;            ///< Is the display valid?
+  int depth;                 ///< Indentation depth
+  struct Mailbox *mailbox;   ///< Mailbox this represents
+  bool is_hidden;            ///< Don't show, e.g. $sidebar_new_mail_only
+  enum ColorId color;        ///< Colour to use
+};
+
+/**
+ * struct SbRow - A row of the Sidebar, as it was last calculated
+ */
+struct SbRow
+{
+  struct SbEntry *entry; ///< Entry displayed on the row
+  enum ColorId color;    ///< Colour of the row
 };
+ARRAY_HEAD(SbRowArray, struct SbRow);
 
 /**
  * enum DivType - Source of the sidebar divider character
@@ -61,6 +95,7 @@ enum DivType
 struct SidebarWindowData
 {
   ARRAY_HEAD(, struct SbEntry *) entries; ///< Items to display in the sidebar
+  struct SbRowArray rows;                 ///< Rows displayed by the last recalc
 
   int top_index;             ///< First mailbox visible in sidebar
   int opn_index;             ///< Current (open) mailbox
@@ -68,6 +103,7 @@ struct SidebarWindowData
   int bot_index;             ///< Last mailbox visible in sidebar
 
   short previous_sort;       ///< Old `$sidebar_sort_method`
+  short sorted_by;           ///< Sort order of the entries, or -1 if unsorted
   enum DivType divider_type; ///< Type of divider to use, e.g. #SB_DIV_ASCII
   short divider_width;       ///< Width of the divider in screen columns
 };
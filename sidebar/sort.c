@@ -28,6 +28,7 @@
 
 #include "config.h"
 #include <stdbool.h>
+#include <string.h>
 #include "private.h"
 #include "mutt/lib.h"
 #include "config/lib.h"
@@ -163,16 +164,65 @@ static int sb_sort_unsorted(const void *a, const void *b)
   return (sbe1->mailbox->gen - sbe2->mailbox->gen);
 }
 
+/**
+ * sb_sort_insert - Move the out-of-order entries into place
+ * @param wdata Sidebar data
+ * @param fn    Sort function
+ * @retval true  The entries are sorted
+ * @retval false Too many entries are out of order, they need a full sort
+ *
+ * Between refreshes, only a few Mailboxes change, so most of the entries are
+ * still in order.  Each one that's out of place is found with a binary search
+ * and moved, which keeps the sort stable.
+ */
+static bool sb_sort_insert(struct SidebarWindowData *wdata, sort_t fn)
+{
+  const size_t num = ARRAY_SIZE(&wdata->entries);
+  if (num < 2)
+    return true;
+
+  struct SbEntry **list = ARRAY_GET(&wdata->entries, 0);
+  size_t moved = 0;
+
+  for (size_t i = 1; i < num; i++)
+  {
+    if (fn(&list[i - 1], &list[i]) <= 0)
+      continue;
+
+    /* Find the first entry that sorts after this one */
+    struct SbEntry *sbe = list[i];
+    size_t lo = 0;
+    size_t hi = i - 1;
+    while (lo < hi)
+    {
+      const size_t mid = lo + ((hi - lo) / 2);
+      if (fn(&list[mid], &sbe) > 0)
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+
+    moved += i - lo;
+    if (moved > (4 * num))
+      return false;
+
+    memmove(&list[lo + 1], &list[lo], (i - lo) * sizeof(*list));
+    list[lo] = sbe;
+  }
+
+  return true;
+}
+
 /**
  * sb_sort_entries - Sort the Sidebar entries
  * @param wdata Sidebar data
  * @param sort  Sort order, e.g. #SORT_PATH
  *
  * Sort the `wdata->entries` array according to the current sort config option
- * `$sidebar_sort_method`. This calls qsort to do the work which calls our
- * callback function "cb_qsort_sbe".
+ * `$sidebar_sort_method`.
  *
- * Once sorted, the prev/next links will be reconstructed.
+ * If the entries are already in this order, only the entries whose position
+ * has changed are moved, see sb_sort_insert().  Otherwise qsort does the work.
  */
 void sb_sort_entries(struct SidebarWindowData *wdata, enum SortType sort)
 {
@@ -202,5 +252,9 @@ void sb_sort_entries(struct SidebarWindowData *wdata, enum SortType sort)
   }
 
   sb_sort_reverse = (sort & SORT_REVERSE);
-  ARRAY_SORT(&wdata->entries, fn);
+
+  if ((wdata->sorted_by != sort) || !sb_sort_insert(wdata, fn))
+    ARRAY_SORT(&wdata->entries, fn);
+
+  wdata->sorted_by = sort;
 }
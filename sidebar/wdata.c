@@ -40,6 +40,7 @@ struct SidebarWindowData *sb_wdata_new(void)
 {
   struct SidebarWindowData *wdata = mutt_mem_calloc(1, sizeof(struct SidebarWindowData));
   ARRAY_INIT(&wdata->entries);
+  wdata->sorted_by = -1;
   return wdata;
 }
 
@@ -59,6 +60,7 @@ void sb_wdata_free(struct MuttWindow *win, void **ptr)
     FREE(sbep);
   }
   ARRAY_FREE(&wdata->entries);
+  ARRAY_FREE(&wdata->rows);
 
   FREE(ptr);
 }
@@ -187,8 +187,9 @@ static const char *abbrev_url(const char *mbox, enum MailboxType type)
 static size_t add_indent(char *buf, size_t buflen, const struct SbEntry *sbe)
 {
   size_t res = 0;
+  static struct ConfigHandle ch_sidebar_indent_string = CONFIG_HANDLE("sidebar_indent_string");
   const char *const c_sidebar_indent_string =
-      cs_subset_string(NeoMutt->sub, "sidebar_indent_string");
+      cs_handle_string(&ch_sidebar_indent_string, NeoMutt->sub);
   for (int i = 0; i < sbe->depth; i++)
   {
     res += mutt_str_copy(buf + res, c_sidebar_indent_string, buflen - res);
@@ -455,8 +456,8 @@ static const char *sidebar_format_str(char *buf, size_t buflen, size_t col, int
  */
 static void make_sidebar_entry(char *buf, size_t buflen, int width, struct SbEntry *sbe)
 {
-  const char *const c_sidebar_format =
-      cs_subset_string(NeoMutt->sub, "sidebar_format");
+  static struct ConfigHandle ch_sidebar_format = CONFIG_HANDLE("sidebar_format");
+  const char *const c_sidebar_format = cs_handle_string(&ch_sidebar_format, NeoMutt->sub);
   mutt_expando_format(buf, buflen, 0, width, NONULL(c_sidebar_format),
                       sidebar_format_str, (intptr_t) sbe, MUTT_FORMAT_NO_FLAGS);
 
@@ -661,6 +662,7 @@ int sb_recalc(struct MuttWindow *win)
 
   if (!prepare_sidebar(wdata, win->state.rows))
   {
+    ARRAY_SHRINK(&wdata->rows, ARRAY_SIZE(&wdata->rows));
     win->actions |= WA_REPAINT;
     return 0;
   }
@@ -674,8 +676,15 @@ int sb_recalc(struct MuttWindow *win)
   if (wdata->top_index < 0)
     return 0;
 
+  /* The output of a filter can change at any time */
+  static struct ConfigHandle ch_sidebar_format = CONFIG_HANDLE("sidebar_format");
+  const char *const c_sidebar_format = cs_handle_string(&ch_sidebar_format, NeoMutt->sub);
+  const size_t fmt_len = mutt_str_len(c_sidebar_format);
+  const bool is_filter = (fmt_len > 0) && (c_sidebar_format[fmt_len - 1] == '|');
+
   int width = num_cols - wdata->divider_width;
   int row = 0;
+  bool changed = false;
   struct SbEntry **sbep = NULL;
   ARRAY_FOREACH_FROM(sbep, &wdata->entries, wdata->top_index)
   {
@@ -703,7 +712,8 @@ int sb_recalc(struct MuttWindow *win)
 
     const char *path = mailbox_path(m);
 
-    const char *const c_folder = cs_subset_string(NeoMutt->sub, "folder");
+    static struct ConfigHandle ch_folder = CONFIG_HANDLE("folder");
+    const char *const c_folder = cs_handle_string(&ch_folder, NeoMutt->sub);
     // Try to abbreviate the full path
     const char *abbr = abbrev_folder(path, c_folder, m->type);
     if (!abbr)
@@ -712,13 +722,15 @@ int sb_recalc(struct MuttWindow *win)
 
     /* Compute the depth */
     const char *last_part = abbr;
+    static struct ConfigHandle ch_sidebar_delim_chars = CONFIG_HANDLE("sidebar_delim_chars");
     const char *const c_sidebar_delim_chars =
-        cs_subset_string(NeoMutt->sub, "sidebar_delim_chars");
+        cs_handle_string(&ch_sidebar_delim_chars, NeoMutt->sub);
     entry->depth = calc_path_depth(abbr, c_sidebar_delim_chars, &last_part);
 
     const bool short_path_is_abbr = (short_path == abbr);
+    static struct ConfigHandle ch_sidebar_short_path = CONFIG_HANDLE("sidebar_short_path");
     const bool c_sidebar_short_path =
-        cs_subset_bool(NeoMutt->sub, "sidebar_short_path");
+        cs_handle_bool(&ch_sidebar_short_path, NeoMutt->sub);
     if (c_sidebar_short_path)
     {
       short_path = last_part;
@@ -726,24 +738,75 @@ int sb_recalc(struct MuttWindow *win)
 
     // Don't indent if we were unable to create an abbreviation.
     // Otherwise, the full path will be indent, and it looks unusual.
+    static struct ConfigHandle ch_sidebar_folder_indent = CONFIG_HANDLE("sidebar_folder_indent");
     const bool c_sidebar_folder_indent =
-        cs_subset_bool(NeoMutt->sub, "sidebar_folder_indent");
+        cs_handle_bool(&ch_sidebar_folder_indent, NeoMutt->sub);
     if (c_sidebar_folder_indent && short_path_is_abbr)
     {
+      static struct ConfigHandle ch_sidebar_component_depth =
+          CONFIG_HANDLE("sidebar_component_depth");
       const short c_sidebar_component_depth =
-          cs_subset_number(NeoMutt->sub, "sidebar_component_depth");
+          cs_handle_number(&ch_sidebar_component_depth, NeoMutt->sub);
       if (c_sidebar_component_depth > 0)
         entry->depth -= c_sidebar_component_depth;
     }
     else if (!c_sidebar_folder_indent)
       entry->depth = 0;
 
-    mutt_str_copy(entry->box, short_path, sizeof(entry->box));
-    make_sidebar_entry(entry->display, sizeof(entry->display), width, entry);
+    struct SbEntryStats stats = { 0 };
+    stats.generation = ConfigGeneration;
+    stats.width = width;
+    stats.depth = entry->depth;
+    stats.has_new = m->has_new;
+    stats.msg_count = m->msg_count;
+    stats.msg_unread = m->msg_unread;
+    stats.msg_flagged = m->msg_flagged;
+    stats.msg_new = m->msg_new;
+    if (m_ctx && mutt_str_equal(m_ctx->realpath, m->realpath))
+    {
+      stats.is_current = true;
+      stats.msg_deleted = m_ctx->msg_deleted;
+      stats.msg_tagged = m_ctx->msg_tagged;
+      stats.vcount = m_ctx->vcount;
+    }
+
+    /* Only format the entry if something it displays has changed */
+    if (is_filter || !entry->formatted || (memcmp(&stats, &entry->stats, sizeof(stats)) != 0) ||
+        !mutt_str_equal(entry->box, short_path) ||
+        !mutt_str_equal(entry->name, NONULL(m->name)))
+    {
+      char old_display[sizeof(entry->display)];
+      mutt_str_copy(old_display, entry->display, sizeof(old_display));
+
+      mutt_str_copy(entry->box, short_path, sizeof(entry->box));
+      mutt_str_copy(entry->name, NONULL(m->name), sizeof(entry->name));
+      make_sidebar_entry(entry->display, sizeof(entry->display), width, entry);
+      entry->stats = stats;
+      entry->formatted = true;
+
+      if (!mutt_str_equal(old_display, entry->display))
+        changed = true;
+    }
+
+    /* Only repaint if what's on screen would change */
+    struct SbRow *sbr = ARRAY_GET(&wdata->rows, row);
+    if (!sbr || (sbr->entry != entry) || (sbr->color != entry->color))
+    {
+      struct SbRow new_row = { entry, entry->color };
+      ARRAY_SET(&wdata->rows, row, new_row);
+      changed = true;
+    }
     row++;
   }
 
-  win->actions |= WA_REPAINT;
+  if (ARRAY_SIZE(&wdata->rows) != row)
+  {
+    ARRAY_SHRINK(&wdata->rows, ARRAY_SIZE(&wdata->rows) - row);
+    changed = true;
+  }
+
+  if (changed)
+    win->actions |= WA_REPAINT;
   return 0;
 }
 
@@ -865,7 +928,6 @@ int sb_repaint(struct MuttWindow *win)
       mutt_window_move(win, col, row);
       mutt_curses_set_color(entry->color);
       mutt_window_printf("%s", entry->display);
-      mutt_refresh();
       row++;
     }
   }
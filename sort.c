@@ -36,6 +36,7 @@
 #include "address/lib.h"
 #include "email/lib.h"
 #include "core/lib.h"
+#include "debug/lib.h"
 #include "alias/lib.h"
 #include "sort.h"
 #include "context.h"
@@ -51,6 +52,47 @@
 /* function to use as discriminator when normal sort method is equal */
 static sort_t AuxSort = NULL;
 
+/* (pseudo) using auxiliary sort function.  Each thread of a parallel sort
+ * needs its own copy. */
+#ifdef USE_PTHREADS
+static __thread bool OptAuxSort = false;
+#else
+static bool OptAuxSort = false;
+#endif
+
+/**
+ * struct SortKey - An Email with its precomputed sort keys
+ *
+ * The Email must be the first member, so that the compare functions can treat
+ * a pointer to a SortKey as a pointer to an Email pointer.
+ */
+struct SortKey
+{
+  struct Email *email;  ///< Email to sort
+  char *from;           ///< Name of the sender, see mutt_get_name()
+  char *to;             ///< Name of the first recipient, see mutt_get_name()
+  double spam;          ///< Numeric value of the spam attribute
+  char *spam_end;       ///< Rest of the spam attribute, after the number
+};
+
+/* if set, the compare functions are sorting an array of SortKeys */
+static bool SortKeys = false;
+/* $sort and $sort_aux, cached while sorting SortKeys */
+static short SortKeysSort = 0;
+static short SortKeysSortAux = 0;
+
+/**
+ * struct SortRun - A slice of the SortKeys, for a parallel sort
+ */
+struct SortRun
+{
+  struct SortKey *keys; ///< Keys in the run
+  size_t num;           ///< Number of keys in the run
+  size_t num_next;      ///< Number of keys in the following run, to merge with this one
+  struct SortKey *dest; ///< Where to put the merged runs
+  sort_t sortfunc;      ///< Sort function
+};
+
 /**
  * sort_code - Modify the results of sorting
  * @param rc Return code from sort
@@ -58,8 +100,13 @@ static sort_t AuxSort = NULL;
  */
 int sort_code(int rc)
 {
-  const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
-  const short c_sort_aux = cs_subset_sort(NeoMutt->sub, "sort_aux");
+  short c_sort = SortKeysSort;
+  short c_sort_aux = SortKeysSortAux;
+  if (!SortKeys)
+  {
+    c_sort = cs_subset_sort(NeoMutt->sub, "sort");
+    c_sort_aux = cs_subset_sort(NeoMutt->sub, "sort_aux");
+  }
 
   return ((OptAuxSort ? c_sort_aux : c_sort) & SORT_REVERSE) ? -rc : rc;
 }
@@ -190,11 +237,21 @@ static int compare_to(const void *a, const void *b)
 {
   struct Email const *const *ppa = (struct Email const *const *) a;
   struct Email const *const *ppb = (struct Email const *const *) b;
-  char fa[128];
+  char buf[128];
+  const char *fa = NULL, *fb = NULL;
 
-  mutt_str_copy(fa, mutt_get_name(TAILQ_FIRST(&(*ppa)->env->to)), sizeof(fa));
-  const char *fb = mutt_get_name(TAILQ_FIRST(&(*ppb)->env->to));
-  int result = mutt_istrn_cmp(fa, fb, sizeof(fa));
+  if (SortKeys)
+  {
+    fa = ((struct SortKey const *) a)->to;
+    fb = ((struct SortKey const *) b)->to;
+  }
+  else
+  {
+    mutt_str_copy(buf, mutt_get_name(TAILQ_FIRST(&(*ppa)->env->to)), sizeof(buf));
+    fa = buf;
+    fb = mutt_get_name(TAILQ_FIRST(&(*ppb)->env->to));
+  }
+  int result = mutt_istrn_cmp(fa, fb, sizeof(buf));
   result = perform_auxsort(result, a, b);
   return sort_code(result);
 }
@@ -206,11 +263,21 @@ static int compare_from(const void *a, const void *b)
 {
   struct Email const *const *ppa = (struct Email const *const *) a;
   struct Email const *const *ppb = (struct Email const *const *) b;
-  char fa[128];
+  char buf[128];
+  const char *fa = NULL, *fb = NULL;
 
-  mutt_str_copy(fa, mutt_get_name(TAILQ_FIRST(&(*ppa)->env->from)), sizeof(fa));
-  const char *fb = mutt_get_name(TAILQ_FIRST(&(*ppb)->env->from));
-  int result = mutt_istrn_cmp(fa, fb, sizeof(fa));
+  if (SortKeys)
+  {
+    fa = ((struct SortKey const *) a)->from;
+    fb = ((struct SortKey const *) b)->from;
+  }
+  else
+  {
+    mutt_str_copy(buf, mutt_get_name(TAILQ_FIRST(&(*ppa)->env->from)), sizeof(buf));
+    fa = buf;
+    fb = mutt_get_name(TAILQ_FIRST(&(*ppb)->env->from));
+  }
+  int result = mutt_istrn_cmp(fa, fb, sizeof(buf));
   result = perform_auxsort(result, a, b);
   return sort_code(result);
 }
@@ -272,8 +339,19 @@ static int compare_spam(const void *a, const void *b)
   /* Both have spam attrs. */
 
   /* preliminary numeric examination */
-  difference =
-      (strtod((*ppa)->env->spam.data, &aptr) - strtod((*ppb)->env->spam.data, &bptr));
+  if (SortKeys)
+  {
+    struct SortKey const *ka = (struct SortKey const *) a;
+    struct SortKey const *kb = (struct SortKey const *) b;
+    difference = ka->spam - kb->spam;
+    aptr = ka->spam_end;
+    bptr = kb->spam_end;
+  }
+  else
+  {
+    difference = (strtod((*ppa)->env->spam.data, &aptr) -
+                  strtod((*ppb)->env->spam.data, &bptr));
+  }
 
   /* map double into comparison (-1, 0, or 1) */
   result = ((difference < 0.0) ? -1 : (difference > 0.0) ? 1 : 0);
@@ -368,6 +446,246 @@ sort_t mutt_get_sort_func(enum SortType method)
   /* not reached */
 }
 
+/**
+ * sort_needs_keys - Does a sort method have expensive keys?
+ * @param method Sort type, see #SortType
+ * @retval true The keys should be calculated up front
+ */
+static bool sort_needs_keys(short method)
+{
+  method &= SORT_MASK;
+  return (method == SORT_FROM) || (method == SORT_TO) || (method == SORT_SPAM);
+}
+
+/**
+ * sort_key_name - Precompute the name to sort an address by
+ * @param al Address list
+ * @retval ptr Name, truncated as in compare_from()
+ */
+static char *sort_key_name(struct AddressList *al)
+{
+  char buf[128];
+  mutt_str_copy(buf, mutt_get_name(TAILQ_FIRST(al)), sizeof(buf));
+  return mutt_str_dup(buf);
+}
+
+/**
+ * sort_sorted_prefix - How many of the emails are already in order?
+ * @param m        Mailbox
+ * @param sortfunc Sort function
+ * @retval num Length of the run of sorted emails at the start of the Mailbox
+ *
+ * All the emails are in order after some have been removed, e.g. by an
+ * expunge.  If new emails have been added, only they will be out of order.
+ */
+static int sort_sorted_prefix(struct Mailbox *m, sort_t sortfunc)
+{
+  for (int i = 1; i < m->msg_count; i++)
+  {
+    if (sortfunc(&m->emails[i - 1], &m->emails[i]) > 0)
+      return i;
+  }
+  return m->msg_count;
+}
+
+/**
+ * sort_merge_tail - Sort the emails after a sorted run, and merge them in
+ * @param m        Mailbox
+ * @param sortfunc Sort function
+ * @param sorted   Number of emails already in order, see sort_sorted_prefix()
+ *
+ * The emails are merged from the end, so new emails belonging at the end
+ * cost almost nothing.
+ */
+static void sort_merge_tail(struct Mailbox *m, sort_t sortfunc, int sorted)
+{
+  const int num_tail = m->msg_count - sorted;
+  struct Email **tail = mutt_mem_malloc(num_tail * sizeof(struct Email *));
+  memcpy(tail, m->emails + sorted, num_tail * sizeof(struct Email *));
+  qsort((void *) tail, num_tail, sizeof(struct Email *), sortfunc);
+
+  int i = sorted - 1;
+  int j = num_tail - 1;
+  for (int k = m->msg_count - 1; j >= 0; k--)
+  {
+    if ((i >= 0) && (sortfunc(&m->emails[i], &tail[j]) > 0))
+      m->emails[k] = m->emails[i--];
+    else
+      m->emails[k] = tail[j--];
+  }
+
+  FREE(&tail);
+}
+
+/**
+ * sort_use_parallel - Should a Mailbox be sorted in parallel?
+ * @param m Mailbox
+ * @retval true The Mailbox is big enough, see $sort_parallel
+ */
+static bool sort_use_parallel(struct Mailbox *m)
+{
+#ifdef USE_PTHREADS
+  const long c_sort_parallel = cs_subset_long(NeoMutt->sub, "sort_parallel");
+  return (c_sort_parallel > 0) && (m->msg_count >= c_sort_parallel) &&
+         (mutt_worker_count() > 1);
+#else
+  return false;
+#endif
+}
+
+/**
+ * sort_run - Sort a run of SortKeys - Implements ::worker_task_t
+ */
+static void sort_run(void *item)
+{
+  struct SortRun *run = item;
+  qsort(run->keys, run->num, sizeof(struct SortKey), run->sortfunc);
+}
+
+/**
+ * merge_runs - Merge two adjacent runs of SortKeys - Implements ::worker_task_t
+ *
+ * If two keys compare equal, the one from the first run is put first.
+ */
+static void merge_runs(void *item)
+{
+  struct SortRun *run = item;
+  struct SortKey *a = run->keys;
+  struct SortKey *a_end = a + run->num;
+  struct SortKey *b = a_end;
+  struct SortKey *b_end = b + run->num_next;
+  struct SortKey *dest = run->dest;
+
+  while ((a < a_end) && (b < b_end))
+  {
+    if (run->sortfunc(b, a) < 0)
+      *dest++ = *b++;
+    else
+      *dest++ = *a++;
+  }
+  while (a < a_end)
+    *dest++ = *a++;
+  while (b < b_end)
+    *dest++ = *b++;
+}
+
+/**
+ * sort_keys_parallel - Sort an array of SortKeys on all the CPUs
+ * @param keys     Keys to sort
+ * @param num      Number of keys
+ * @param sortfunc Sort function
+ *
+ * The keys are split into one run per thread and each run is sorted.  Then
+ * pairs of runs are merged, in parallel, until only one is left.
+ */
+static void sort_keys_parallel(struct SortKey *keys, size_t num, sort_t sortfunc)
+{
+  size_t num_runs = mutt_worker_count();
+  struct SortRun *runs = mutt_mem_calloc(num_runs, sizeof(struct SortRun));
+
+  size_t start = 0;
+  for (size_t i = 0; i < num_runs; i++)
+  {
+    size_t end = (num * (i + 1)) / num_runs;
+    runs[i].keys = keys + start;
+    runs[i].num = end - start;
+    runs[i].sortfunc = sortfunc;
+    start = end;
+  }
+  mutt_worker_run(sort_run, runs, sizeof(struct SortRun), num_runs);
+
+  struct SortKey *tmp = mutt_mem_malloc(num * sizeof(struct SortKey));
+  struct SortKey *src = keys;
+  struct SortKey *dest = tmp;
+  while (num_runs > 1)
+  {
+    /* pair up the runs: 0+1, 2+3, ... */
+    size_t num_pairs = 0;
+    for (size_t i = 0; i < num_runs; i += 2, num_pairs++)
+    {
+      struct SortRun *pair = &runs[num_pairs];
+      pair->dest = dest + (runs[i].keys - src);
+      pair->keys = runs[i].keys;
+      pair->num = runs[i].num;
+      pair->num_next = ((i + 1) < num_runs) ? runs[i + 1].num : 0;
+    }
+    mutt_worker_run(merge_runs, runs, sizeof(struct SortRun), num_pairs);
+
+    for (size_t i = 0; i < num_pairs; i++)
+    {
+      runs[i].keys = runs[i].dest;
+      runs[i].num += runs[i].num_next;
+    }
+    num_runs = num_pairs;
+
+    struct SortKey *swap = src;
+    src = dest;
+    dest = swap;
+  }
+
+  if (src != keys)
+    memcpy(keys, src, num * sizeof(struct SortKey));
+
+  FREE(&tmp);
+  FREE(&runs);
+}
+
+/**
+ * sort_with_keys - Sort the emails, working out their keys only once
+ * @param m        Mailbox
+ * @param sortfunc Sort function
+ * @param sort     Primary sort method, `$sort`
+ * @param sort_aux Secondary sort method, `$sort_aux`
+ *
+ * Names and spam scores are costly to work out, so they are calculated once
+ * for each Email.  The Emails are sorted along with their keys, then put back
+ * into the Mailbox.
+ *
+ * Once the keys are known, the compare functions don't touch any shared state,
+ * so big Mailboxes can be sorted by several threads at once.
+ */
+static void sort_with_keys(struct Mailbox *m, sort_t sortfunc, short sort, short sort_aux)
+{
+  sort &= SORT_MASK;
+  sort_aux &= SORT_MASK;
+  const bool key_from = (sort == SORT_FROM) || (sort_aux == SORT_FROM);
+  const bool key_to = (sort == SORT_TO) || (sort_aux == SORT_TO);
+  const bool key_spam = (sort == SORT_SPAM) || (sort_aux == SORT_SPAM);
+
+  struct SortKey *keys = mutt_mem_calloc(m->msg_count, sizeof(struct SortKey));
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    struct SortKey *key = &keys[i];
+    key->email = m->emails[i];
+
+    struct Envelope *env = key->email->env;
+    if (key_from)
+      key->from = sort_key_name(&env->from);
+    if (key_to)
+      key->to = sort_key_name(&env->to);
+    if (key_spam && !mutt_buffer_is_empty(&env->spam))
+      key->spam = strtod(env->spam.data, &key->spam_end);
+  }
+
+  SortKeysSort = cs_subset_sort(NeoMutt->sub, "sort");
+  SortKeysSortAux = cs_subset_sort(NeoMutt->sub, "sort_aux");
+  SortKeys = true;
+  if (sort_use_parallel(m))
+    sort_keys_parallel(keys, m->msg_count, sortfunc);
+  else
+    qsort(keys, m->msg_count, sizeof(struct SortKey), sortfunc);
+  SortKeys = false;
+
+  for (int i = 0; i < m->msg_count; i++)
+  {
+    m->emails[i] = keys[i].email;
+    FREE(&keys[i].from);
+    FREE(&keys[i].to);
+  }
+  FREE(&keys);
+}
+
 /**
  * mutt_sort_headers - Sort emails by their headers
  * @param m       Mailbox
@@ -378,10 +696,14 @@ sort_t mutt_get_sort_func(enum SortType method)
 void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
                        bool init, off_t *vsize)
 {
+  PERF_SCOPE("mutt_sort_headers");
+  TRACE_SCOPE("mailbox", "mutt_sort_headers", NULL);
+
   if (!m || !m->emails[0])
     return;
 
   sort_t sortfunc = NULL;
+  int sorted = 0;
 
   OptNeedResort = false;
 
@@ -400,7 +722,7 @@ void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
     mutt_message(_("Sorting mailbox..."));
 
   const bool c_score = cs_subset_bool(NeoMutt->sub, "score");
-  if (OptNeedRescore && c_score)
+  if (c_score && mutt_score_changed())
   {
     for (int i = 0; i < m->msg_count; i++)
     {
@@ -423,6 +745,13 @@ void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
 
   const short c_sort = cs_subset_sort(NeoMutt->sub, "sort");
   const short c_sort_aux = cs_subset_sort(NeoMutt->sub, "sort_aux");
+  if (((c_sort & SORT_MASK) == SORT_SPAM) || ((c_sort_aux & SORT_MASK) == SORT_SPAM))
+  {
+    /* The spam tag isn't one of the index fields from the header cache */
+    for (int i = 0; i < m->msg_count; i++)
+      email_env_load(m->emails[i]);
+  }
+
   if ((c_sort & SORT_MASK) == SORT_THREADS)
   {
     AuxSort = NULL;
@@ -443,6 +772,20 @@ void mutt_sort_headers(struct Mailbox *m, struct ThreadsContext *threads,
     mutt_error(_("Could not find sorting function [report this bug]"));
     return;
   }
+  else if ((sorted = sort_sorted_prefix(m, sortfunc)) == m->msg_count)
+  {
+    /* nothing to do */
+  }
+  else if ((m->msg_count - sorted) <= (m->msg_count / 4))
+  {
+    /* e.g. new mail has arrived */
+    sort_merge_tail(m, sortfunc, sorted);
+  }
+  else if (sort_needs_keys(c_sort) || sort_needs_keys(c_sort_aux) ||
+           sort_use_parallel(m))
+  {
+    sort_with_keys(m, sortfunc, c_sort, c_sort_aux);
+  }
   else
   {
     qsort((void *) m->emails, m->msg_count, sizeof(struct Email *), sortfunc);
@@ -33,11 +33,15 @@
 #include <sys/types.h>
 #include "mutt/lib.h"
 #include "config/lib.h"
+#include "email/lib.h"
 #include "core/lib.h"
+#include "conn/lib.h"
 #include "gui/lib.h"
 #include "status.h"
+#include "send/lib.h"
 #include "context.h"
 #include "format_flags.h"
+#include "mutt_account.h"
 #include "mutt_globals.h"
 #include "mutt_mailbox.h"
 #include "mutt_menu.h"
@@ -69,6 +73,34 @@ struct MenuStatusLineData
   struct Mailbox *m;
 };
 
+/**
+ * status_conn_stats - Get the network statistics of a Mailbox's server
+ * @param m Mailbox
+ * @retval ptr  Network statistics
+ * @retval NULL The Mailbox isn't remote, or hasn't connected
+ */
+static struct ConnStats *status_conn_stats(struct Mailbox *m)
+{
+  if (!m)
+    return NULL;
+
+  struct ConnAccount cac = { { 0 } };
+  if (m->type == MUTT_IMAP)
+    cac.type = MUTT_ACCT_TYPE_IMAP;
+  else if (m->type == MUTT_POP)
+    cac.type = MUTT_ACCT_TYPE_POP;
+  else
+    return NULL;
+
+  struct Url *url = url_parse(mailbox_path(m));
+  struct ConnStats *stats = NULL;
+  if (url && (mutt_account_fromurl(&cac, url) == 0))
+    stats = mutt_socket_stats_find(&cac);
+
+  url_free(&url);
+  return stats;
+}
+
 /**
  * status_format_str - Create the status bar string - Implements ::format_t
  *
@@ -84,6 +116,7 @@ struct MenuStatusLineData
  * | \%L     | Size (in bytes) of the messages shown (or limited)
  * | \%M     | Number of messages shown (virtual message count when limiting)
  * | \%m     | Total number of messages
+ * | \%N     | Network traffic and round trip time of the mailbox's server
  * | \%n     | Number of new messages
  * | \%o     | Number of old unread messages
  * | \%p     | Number of postponed messages
@@ -249,6 +282,29 @@ static const char *status_format_str(char *buf, size_t buflen, size_t col, int c
       break;
     }
 
+    case 'N':
+    {
+      struct ConnStats *stats = status_conn_stats(m);
+      if (!optional)
+      {
+        if (stats)
+        {
+          char in[32], out[32];
+          mutt_str_pretty_size(in, sizeof(in), stats->bytes_in);
+          mutt_str_pretty_size(out, sizeof(out), stats->bytes_out);
+          snprintf(tmp, sizeof(tmp), "%s/%s %llums", in, out,
+                   (unsigned long long) (stats->rtt / 1000));
+        }
+        else
+          tmp[0] = '\0';
+        snprintf(fmt, sizeof(fmt), "%%%ss", prec);
+        snprintf(buf, buflen, fmt, tmp);
+      }
+      else if (!stats)
+        optional = false;
+      break;
+    }
+
     case 'o':
     {
       const int num = m ? (m->msg_unread - m->msg_new) : 0;
@@ -299,6 +355,19 @@ static const char *status_format_str(char *buf, size_t buflen, size_t col, int c
       break;
     }
 
+    case 'q':
+    {
+      const int count = mutt_send_queue_count();
+      if (!optional)
+      {
+        snprintf(fmt, sizeof(fmt), "%%%sd", prec);
+        snprintf(buf, buflen, fmt, count);
+      }
+      else if (count == 0)
+        optional = false;
+      break;
+    }
+
     case 'r':
     {
       size_t i = 0;
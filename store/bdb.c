@@ -222,6 +222,29 @@ static int store_bdb_delete_record(void *store, const char *key, size_t klen)
   return ctx->db->del(ctx->db, NULL, &dkey, 0);
 }
 
+/**
+ * store_bdb_begin_txn - Implements StoreOps::begin_txn()
+ */
+static int store_bdb_begin_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  /* The environment isn't opened with DB_INIT_TXN, so there's nothing to do */
+  return 0;
+}
+
+/**
+ * store_bdb_commit_txn - Implements StoreOps::commit_txn()
+ */
+static int store_bdb_commit_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  return 0;
+}
+
 /**
  * store_bdb_close - Implements StoreOps::close()
  */
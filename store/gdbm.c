@@ -123,6 +123,29 @@ static int store_gdbm_delete_record(void *store, const char *key, size_t klen)
   return gdbm_delete(db, dkey);
 }
 
+/**
+ * store_gdbm_begin_txn - Implements StoreOps::begin_txn()
+ */
+static int store_gdbm_begin_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  /* GDBM doesn't have transactions and isn't opened with GDBM_SYNC */
+  return 0;
+}
+
+/**
+ * store_gdbm_commit_txn - Implements StoreOps::commit_txn()
+ */
+static int store_gdbm_commit_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  return 0;
+}
+
 /**
  * store_gdbm_close - Implements StoreOps::close()
  */
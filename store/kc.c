@@ -124,6 +124,40 @@ static int store_kyotocabinet_delete_record(void *store, const char *key, size_t
   return 0;
 }
 
+/**
+ * store_kyotocabinet_begin_txn - Implements StoreOps::begin_txn()
+ */
+static int store_kyotocabinet_begin_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  KCDB *db = store;
+  if (!kcdbbegintran(db, 0))
+  {
+    int ecode = kcdbecode(db);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
+/**
+ * store_kyotocabinet_commit_txn - Implements StoreOps::commit_txn()
+ */
+static int store_kyotocabinet_commit_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  KCDB *db = store;
+  if (!kcdbendtran(db, 1))
+  {
+    int ecode = kcdbecode(db);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
 /**
  * store_kyotocabinet_close - Implements StoreOps::close()
  */
@@ -74,6 +74,21 @@ struct StoreOps
    */
   void *(*open)(const char *path);
 
+  /**
+   * open_named - Open a named database in a shared Store
+   * @param[in] path Path to the database file
+   * @param[in] name Name of the database within the file
+   * @retval ptr  Success, Store pointer
+   * @retval NULL Failure
+   *
+   * Many Stores, e.g. one per mailbox of an account, can share one database
+   * file.  Each name is a separate set of Keys.  The file stays open, so
+   * opening another of its names is cheap.
+   *
+   * This is optional, backends that don't support it leave it NULL.
+   */
+  void *(*open_named)(const char *path, const char *name);
+
   /**
    * fetch - Fetch a Value from the Store
    * @param[in]  store Store retrieved via open()
@@ -82,9 +97,31 @@ struct StoreOps
    * @param[out] vlen  Length of the Value
    * @retval ptr  Success, Value associated with the Key
    * @retval NULL Error, or Key not found
+   *
+   * The Value may be owned by the Store, e.g. LMDB returns a pointer into its
+   * memory map.  It must not be modified and is only valid until the next
+   * write to the Store, or until it's closed.
    */
   void *(*fetch)(void *store, const char *key, size_t klen, size_t *vlen);
 
+  /**
+   * fetch_many - Fetch many Values from the Store
+   * @param[in]  store  Store retrieved via open()
+   * @param[in]  keys   Keys identifying the records
+   * @param[in]  klens  Lengths of the Key strings
+   * @param[in]  num    Number of Keys
+   * @param[out] values Values associated with the Keys, NULL if not found
+   * @param[out] vlens  Lengths of the Values
+   *
+   * This is the same as calling fetch() for each Key, but the backend can
+   * look them up in the order they're stored, in one pass.  Each Value must
+   * be freed with free().
+   *
+   * This is optional, backends that don't support it leave it NULL.
+   */
+  void (*fetch_many)(void *store, const char **keys, const size_t *klens,
+                     size_t num, void **values, size_t *vlens);
+
   /**
    * free - Free a Value returned by fetch()
    * @param[in]  store Store retrieved via open()
@@ -114,6 +151,27 @@ struct StoreOps
    */
   int (*delete_record)(void *store, const char *key, size_t klen);
 
+  /**
+   * begin_txn - Start a batch of writes
+   * @param[in] store Store retrieved via open()
+   * @retval 0   Success
+   * @retval num Error, a backend-specific error code
+   *
+   * Subsequent calls to store() and delete_record() are grouped together,
+   * until commit_txn() is called.  This saves a lock or sync per record on
+   * backends that support transactions.  Other backends treat this as a no-op.
+   * Batches can't be nested.
+   */
+  int (*begin_txn)(void *store);
+
+  /**
+   * commit_txn - Finish a batch of writes
+   * @param[in] store Store retrieved via open()
+   * @retval 0   Success
+   * @retval num Error, a backend-specific error code
+   */
+  int (*commit_txn)(void *store);
+
   /**
    * close - Close a Store connection
    * @param[in,out] ptr Store retrieved via open()
@@ -139,6 +197,24 @@ bool                   store_is_valid_backend(const char *str);
     .free           = store_##_name##_free,                                    \
     .store          = store_##_name##_store,                                   \
     .delete_record  = store_##_name##_delete_record,                           \
+    .begin_txn      = store_##_name##_begin_txn,                               \
+    .commit_txn     = store_##_name##_commit_txn,                              \
+    .close          = store_##_name##_close,                                   \
+    .version        = store_##_name##_version,                                 \
+  };
+
+#define STORE_BACKEND_OPS_NAMED(_name)                                         \
+  const struct StoreOps store_##_name##_ops = {                                \
+    .name           = #_name,                                                  \
+    .open           = store_##_name##_open,                                    \
+    .open_named     = store_##_name##_open_named,                              \
+    .fetch          = store_##_name##_fetch,                                   \
+    .fetch_many     = store_##_name##_fetch_many,                              \
+    .free           = store_##_name##_free,                                    \
+    .store          = store_##_name##_store,                                   \
+    .delete_record  = store_##_name##_delete_record,                           \
+    .begin_txn      = store_##_name##_begin_txn,                               \
+    .commit_txn     = store_##_name##_commit_txn,                              \
     .close          = store_##_name##_close,                                   \
     .version        = store_##_name##_version,                                 \
   };
@@ -33,6 +33,8 @@
 #include "config.h"
 #include <stddef.h>
 #include <lmdb.h>
+#include <stdlib.h>
+#include <string.h>
 #include "mutt/lib.h"
 #include "lib.h"
 
@@ -40,6 +42,9 @@
  * The file is mmap(2)'d into memory. */
 const size_t LMDB_DB_SIZE = 2147483648;
 
+/** The maximum number of named databases in a shared file */
+const unsigned int LMDB_MAX_DBS = 4096;
+
 /**
  * enum MdbTxnMode - LMDB transaction state
  */
@@ -50,40 +55,57 @@ enum MdbTxnMode
   TXN_WRITE,         ///< Write transaction in progress
 };
 
+/**
+ * struct LmdbEnv - An open LMDB database file
+ *
+ * LMDB allows one transaction per thread for each environment, so the Stores
+ * sharing a file also share its transaction.
+ */
+struct LmdbEnv
+{
+  char *path;                    ///< Path of a shared file, NULL if private
+  MDB_env *env;                  ///< LMDB environment
+  MDB_txn *txn;                  ///< Current transaction
+  enum MdbTxnMode txn_mode;      ///< State of the transaction
+  STAILQ_ENTRY(LmdbEnv) entries; ///< Linked list
+};
+STAILQ_HEAD(LmdbEnvList, LmdbEnv);
+
+/// Shared files, kept open until NeoMutt exits
+static struct LmdbEnvList SharedEnvs = STAILQ_HEAD_INITIALIZER(SharedEnvs);
+
 /**
  * struct StoreLmdbCtx - LMDB context
  */
 struct StoreLmdbCtx
 {
-  MDB_env *env;
-  MDB_txn *txn;
-  MDB_dbi db;
-  enum MdbTxnMode txn_mode;
+  struct LmdbEnv *env; ///< Database file
+  MDB_dbi db;          ///< Database within the file
 };
 
 /**
  * mdb_get_r_txn - Get an LMDB read transaction
- * @param ctx LMDB context
+ * @param env LMDB database file
  * @retval num LMDB return code, e.g. MDB_SUCCESS
  */
-static int mdb_get_r_txn(struct StoreLmdbCtx *ctx)
+static int mdb_get_r_txn(struct LmdbEnv *env)
 {
   int rc;
 
-  if (ctx->txn && ((ctx->txn_mode == TXN_READ) || (ctx->txn_mode == TXN_WRITE)))
+  if (env->txn && ((env->txn_mode == TXN_READ) || (env->txn_mode == TXN_WRITE)))
     return MDB_SUCCESS;
 
-  if (ctx->txn)
-    rc = mdb_txn_renew(ctx->txn);
+  if (env->txn)
+    rc = mdb_txn_renew(env->txn);
   else
-    rc = mdb_txn_begin(ctx->env, NULL, MDB_RDONLY, &ctx->txn);
+    rc = mdb_txn_begin(env->env, NULL, MDB_RDONLY, &env->txn);
 
   if (rc == MDB_SUCCESS)
-    ctx->txn_mode = TXN_READ;
+    env->txn_mode = TXN_READ;
   else
   {
     mutt_debug(LL_DEBUG2, "%s: %s\n",
-               ctx->txn ? "mdb_txn_renew" : "mdb_txn_begin", mdb_strerror(rc));
+               env->txn ? "mdb_txn_renew" : "mdb_txn_begin", mdb_strerror(rc));
   }
 
   return rc;
@@ -91,25 +113,25 @@ static int mdb_get_r_txn(struct StoreLmdbCtx *ctx)
 
 /**
  * mdb_get_w_txn - Get an LMDB write transaction
- * @param ctx LMDB context
+ * @param env LMDB database file
  * @retval num LMDB return code, e.g. MDB_SUCCESS
  */
-static int mdb_get_w_txn(struct StoreLmdbCtx *ctx)
+static int mdb_get_w_txn(struct LmdbEnv *env)
 {
   int rc;
 
-  if (ctx->txn)
+  if (env->txn)
   {
-    if (ctx->txn_mode == TXN_WRITE)
+    if (env->txn_mode == TXN_WRITE)
       return MDB_SUCCESS;
 
     /* Free up the memory for readonly or reset transactions */
-    mdb_txn_abort(ctx->txn);
+    mdb_txn_abort(env->txn);
   }
 
-  rc = mdb_txn_begin(ctx->env, NULL, 0, &ctx->txn);
+  rc = mdb_txn_begin(env->env, NULL, 0, &env->txn);
   if (rc == MDB_SUCCESS)
-    ctx->txn_mode = TXN_WRITE;
+    env->txn_mode = TXN_WRITE;
   else
     mutt_debug(LL_DEBUG2, "mdb_txn_begin: %s\n", mdb_strerror(rc));
 
@@ -117,63 +139,181 @@ static int mdb_get_w_txn(struct StoreLmdbCtx *ctx)
 }
 
 /**
- * store_lmdb_open - Implements StoreOps::open()
+ * mdb_abort_txn - Abandon an LMDB transaction
+ * @param env LMDB database file
  */
-static void *store_lmdb_open(const char *path)
+static void mdb_abort_txn(struct LmdbEnv *env)
 {
-  if (!path)
-    return NULL;
-
-  int rc;
+  mdb_txn_abort(env->txn);
+  env->txn_mode = TXN_UNINITIALIZED;
+  env->txn = NULL;
+}
 
-  struct StoreLmdbCtx *ctx = mutt_mem_calloc(1, sizeof(struct StoreLmdbCtx));
+/**
+ * lmdb_env_open - Open an LMDB database file
+ * @param path   Path to the database file
+ * @param maxdbs Number of named databases allowed, 0 for none
+ * @retval ptr  Success, LMDB database file
+ * @retval NULL Failure
+ */
+static struct LmdbEnv *lmdb_env_open(const char *path, unsigned int maxdbs)
+{
+  struct LmdbEnv *env = mutt_mem_calloc(1, sizeof(struct LmdbEnv));
 
-  rc = mdb_env_create(&ctx->env);
+  int rc = mdb_env_create(&env->env);
   if (rc != MDB_SUCCESS)
   {
     mutt_debug(LL_DEBUG2, "mdb_env_create: %s\n", mdb_strerror(rc));
-    FREE(&ctx);
+    FREE(&env);
     return NULL;
   }
 
-  mdb_env_set_mapsize(ctx->env, LMDB_DB_SIZE);
+  mdb_env_set_mapsize(env->env, LMDB_DB_SIZE);
+  if (maxdbs != 0)
+    mdb_env_set_maxdbs(env->env, maxdbs);
 
-  rc = mdb_env_open(ctx->env, path, MDB_NOSUBDIR, 0644);
+  rc = mdb_env_open(env->env, path, MDB_NOSUBDIR, 0644);
   if (rc != MDB_SUCCESS)
   {
     mutt_debug(LL_DEBUG2, "mdb_env_open: %s\n", mdb_strerror(rc));
-    goto fail_env;
+    mdb_env_close(env->env);
+    FREE(&env);
+    return NULL;
+  }
+
+  return env;
+}
+
+/**
+ * lmdb_env_close - Close an LMDB database file
+ * @param ptr LMDB database file
+ */
+static void lmdb_env_close(struct LmdbEnv **ptr)
+{
+  struct LmdbEnv *env = *ptr;
+
+  if (env->txn)
+  {
+    if (env->txn_mode == TXN_WRITE)
+      mdb_txn_commit(env->txn);
+    else
+      mdb_txn_abort(env->txn);
+
+    env->txn_mode = TXN_UNINITIALIZED;
+    env->txn = NULL;
   }
 
-  rc = mdb_get_r_txn(ctx);
+  mdb_env_close(env->env);
+  FREE(&env->path);
+  FREE(ptr);
+}
+
+/**
+ * store_lmdb_open - Implements StoreOps::open()
+ */
+static void *store_lmdb_open(const char *path)
+{
+  if (!path)
+    return NULL;
+
+  int rc;
+
+  struct LmdbEnv *env = lmdb_env_open(path, 0);
+  if (!env)
+    return NULL;
+
+  struct StoreLmdbCtx *ctx = mutt_mem_calloc(1, sizeof(struct StoreLmdbCtx));
+  ctx->env = env;
+
+  rc = mdb_get_r_txn(env);
   if (rc != MDB_SUCCESS)
   {
     mutt_debug(LL_DEBUG2, "mdb_txn_begin: %s\n", mdb_strerror(rc));
     goto fail_env;
   }
 
-  rc = mdb_dbi_open(ctx->txn, NULL, MDB_CREATE, &ctx->db);
+  rc = mdb_dbi_open(env->txn, NULL, MDB_CREATE, &ctx->db);
   if (rc != MDB_SUCCESS)
   {
     mutt_debug(LL_DEBUG2, "mdb_dbi_open: %s\n", mdb_strerror(rc));
     goto fail_dbi;
   }
 
-  mdb_txn_reset(ctx->txn);
-  ctx->txn_mode = TXN_UNINITIALIZED;
+  mdb_txn_reset(env->txn);
+  env->txn_mode = TXN_UNINITIALIZED;
   return ctx;
 
 fail_dbi:
-  mdb_txn_abort(ctx->txn);
-  ctx->txn_mode = TXN_UNINITIALIZED;
-  ctx->txn = NULL;
+  mdb_abort_txn(env);
 
 fail_env:
-  mdb_env_close(ctx->env);
+  lmdb_env_close(&ctx->env);
   FREE(&ctx);
   return NULL;
 }
 
+/**
+ * store_lmdb_open_named - Implements StoreOps::open_named()
+ */
+static void *store_lmdb_open_named(const char *path, const char *name)
+{
+  if (!path || !name)
+    return NULL;
+
+  struct LmdbEnv *env = NULL;
+  STAILQ_FOREACH(env, &SharedEnvs, entries)
+  {
+    if (mutt_str_equal(env->path, path))
+      break;
+  }
+
+  if (!env)
+  {
+    env = lmdb_env_open(path, LMDB_MAX_DBS);
+    if (!env)
+      return NULL;
+
+    env->path = mutt_str_dup(path);
+    STAILQ_INSERT_TAIL(&SharedEnvs, env, entries);
+  }
+
+  /* A database may need to be created, which needs a write transaction of its
+   * own.  Another Store's batch of writes is finished first. */
+  if (env->txn && (env->txn_mode == TXN_WRITE))
+    mdb_txn_commit(env->txn);
+  else if (env->txn)
+    mdb_txn_abort(env->txn);
+  env->txn_mode = TXN_UNINITIALIZED;
+  env->txn = NULL;
+
+  int rc = mdb_get_w_txn(env);
+  if (rc != MDB_SUCCESS)
+    return NULL;
+
+  MDB_dbi db = 0;
+  rc = mdb_dbi_open(env->txn, name, MDB_CREATE, &db);
+  if (rc != MDB_SUCCESS)
+  {
+    mutt_debug(LL_DEBUG2, "mdb_dbi_open: %s\n", mdb_strerror(rc));
+    mdb_abort_txn(env);
+    return NULL;
+  }
+
+  rc = mdb_txn_commit(env->txn);
+  env->txn_mode = TXN_UNINITIALIZED;
+  env->txn = NULL;
+  if (rc != MDB_SUCCESS)
+  {
+    mutt_debug(LL_DEBUG2, "mdb_txn_commit: %s\n", mdb_strerror(rc));
+    return NULL;
+  }
+
+  struct StoreLmdbCtx *ctx = mutt_mem_calloc(1, sizeof(struct StoreLmdbCtx));
+  ctx->env = env;
+  ctx->db = db;
+  return ctx;
+}
+
 /**
  * store_lmdb_fetch - Implements StoreOps::fetch()
  */
@@ -191,14 +331,14 @@ static void *store_lmdb_fetch(void *store, const char *key, size_t klen, size_t
   dkey.mv_size = klen;
   data.mv_data = NULL;
   data.mv_size = 0;
-  int rc = mdb_get_r_txn(ctx);
+  int rc = mdb_get_r_txn(ctx->env);
   if (rc != MDB_SUCCESS)
   {
-    ctx->txn = NULL;
+    ctx->env->txn = NULL;
     mutt_debug(LL_DEBUG2, "txn_renew: %s\n", mdb_strerror(rc));
     return NULL;
   }
-  rc = mdb_get(ctx->txn, ctx->db, &dkey, &data);
+  rc = mdb_get(ctx->env->txn, ctx->db, &dkey, &data);
   if (rc == MDB_NOTFOUND)
   {
     return NULL;
@@ -213,6 +353,100 @@ static void *store_lmdb_fetch(void *store, const char *key, size_t klen, size_t
   return data.mv_data;
 }
 
+/**
+ * struct LmdbKey - A Key to look up, and where its Value goes
+ */
+struct LmdbKey
+{
+  MDB_val key;  ///< Key
+  size_t index; ///< Index of the Key in the caller's list
+};
+
+/**
+ * lmdb_key_cmp - Compare two Keys in the order LMDB stores them - Implements ::sort_t
+ */
+static int lmdb_key_cmp(const void *a, const void *b)
+{
+  const MDB_val *ka = &((const struct LmdbKey *) a)->key;
+  const MDB_val *kb = &((const struct LmdbKey *) b)->key;
+
+  const size_t len = MIN(ka->mv_size, kb->mv_size);
+  int rc = memcmp(ka->mv_data, kb->mv_data, len);
+  if (rc != 0)
+    return rc;
+
+  return (ka->mv_size > kb->mv_size) - (ka->mv_size < kb->mv_size);
+}
+
+/**
+ * store_lmdb_fetch_many - Implements StoreOps::fetch_many()
+ *
+ * The Keys are looked up in sorted order with one cursor.  LMDB checks if
+ * each Key is on the cursor's current page before searching the tree, so
+ * neighbouring records are found without starting from the root.
+ */
+static void store_lmdb_fetch_many(void *store, const char **keys, const size_t *klens,
+                                  size_t num, void **values, size_t *vlens)
+{
+  if (!values || !vlens)
+    return;
+
+  for (size_t i = 0; i < num; i++)
+  {
+    values[i] = NULL;
+    vlens[i] = 0;
+  }
+
+  if (!store || !keys || !klens || (num == 0))
+    return;
+
+  struct StoreLmdbCtx *ctx = store;
+
+  int rc = mdb_get_r_txn(ctx->env);
+  if (rc != MDB_SUCCESS)
+  {
+    ctx->env->txn = NULL;
+    mutt_debug(LL_DEBUG2, "txn_renew: %s\n", mdb_strerror(rc));
+    return;
+  }
+
+  MDB_cursor *cursor = NULL;
+  rc = mdb_cursor_open(ctx->env->txn, ctx->db, &cursor);
+  if (rc != MDB_SUCCESS)
+  {
+    mutt_debug(LL_DEBUG2, "mdb_cursor_open: %s\n", mdb_strerror(rc));
+    return;
+  }
+
+  struct LmdbKey *lk = mutt_mem_calloc(num, sizeof(*lk));
+  for (size_t i = 0; i < num; i++)
+  {
+    lk[i].key.mv_data = (void *) keys[i];
+    lk[i].key.mv_size = klens[i];
+    lk[i].index = i;
+  }
+  qsort(lk, num, sizeof(*lk), lmdb_key_cmp);
+
+  for (size_t i = 0; i < num; i++)
+  {
+    MDB_val dkey = lk[i].key;
+    MDB_val data = { 0 };
+    rc = mdb_cursor_get(cursor, &dkey, &data, MDB_SET);
+    if (rc == MDB_SUCCESS)
+    {
+      values[lk[i].index] = data.mv_data;
+      vlens[lk[i].index] = data.mv_size;
+    }
+    else if (rc != MDB_NOTFOUND)
+    {
+      mutt_debug(LL_DEBUG2, "mdb_cursor_get: %s\n", mdb_strerror(rc));
+    }
+  }
+
+  FREE(&lk);
+  mdb_cursor_close(cursor);
+}
+
 /**
  * store_lmdb_free - Implements StoreOps::free()
  */
@@ -238,19 +472,17 @@ static int store_lmdb_store(void *store, const char *key, size_t klen, void *val
   dkey.mv_size = klen;
   databuf.mv_data = value;
   databuf.mv_size = vlen;
-  int rc = mdb_get_w_txn(ctx);
+  int rc = mdb_get_w_txn(ctx->env);
   if (rc != MDB_SUCCESS)
   {
     mutt_debug(LL_DEBUG2, "mdb_get_w_txn: %s\n", mdb_strerror(rc));
     return rc;
   }
-  rc = mdb_put(ctx->txn, ctx->db, &dkey, &databuf, 0);
+  rc = mdb_put(ctx->env->txn, ctx->db, &dkey, &databuf, 0);
   if (rc != MDB_SUCCESS)
   {
     mutt_debug(LL_DEBUG2, "mdb_put: %s\n", mdb_strerror(rc));
-    mdb_txn_abort(ctx->txn);
-    ctx->txn_mode = TXN_UNINITIALIZED;
-    ctx->txn = NULL;
+    mdb_abort_txn(ctx->env);
   }
   return rc;
 }
@@ -269,24 +501,63 @@ static int store_lmdb_delete_record(void *store, const char *key, size_t klen)
 
   dkey.mv_data = (void *) key;
   dkey.mv_size = klen;
-  int rc = mdb_get_w_txn(ctx);
+  int rc = mdb_get_w_txn(ctx->env);
   if (rc != MDB_SUCCESS)
   {
     mutt_debug(LL_DEBUG2, "mdb_get_w_txn: %s\n", mdb_strerror(rc));
     return rc;
   }
-  rc = mdb_del(ctx->txn, ctx->db, &dkey, NULL);
+  rc = mdb_del(ctx->env->txn, ctx->db, &dkey, NULL);
   if ((rc != MDB_SUCCESS) && (rc != MDB_NOTFOUND))
   {
     mutt_debug(LL_DEBUG2, "mdb_del: %s\n", mdb_strerror(rc));
-    mdb_txn_abort(ctx->txn);
-    ctx->txn_mode = TXN_UNINITIALIZED;
-    ctx->txn = NULL;
+    mdb_abort_txn(ctx->env);
   }
 
   return rc;
 }
 
+/**
+ * store_lmdb_begin_txn - Implements StoreOps::begin_txn()
+ */
+static int store_lmdb_begin_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct StoreLmdbCtx *ctx = store;
+
+  int rc = mdb_get_w_txn(ctx->env);
+  if (rc != MDB_SUCCESS)
+    mutt_debug(LL_DEBUG2, "mdb_get_w_txn: %s\n", mdb_strerror(rc));
+
+  return rc;
+}
+
+/**
+ * store_lmdb_commit_txn - Implements StoreOps::commit_txn()
+ */
+static int store_lmdb_commit_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct StoreLmdbCtx *ctx = store;
+
+  struct LmdbEnv *env = ctx->env;
+
+  if (!env->txn || (env->txn_mode != TXN_WRITE))
+    return MDB_SUCCESS;
+
+  int rc = mdb_txn_commit(env->txn);
+  if (rc != MDB_SUCCESS)
+    mutt_debug(LL_DEBUG2, "mdb_txn_commit: %s\n", mdb_strerror(rc));
+
+  env->txn_mode = TXN_UNINITIALIZED;
+  env->txn = NULL;
+  return rc;
+}
+
 /**
  * store_lmdb_close - Implements StoreOps::close()
  */
@@ -296,19 +567,28 @@ static void store_lmdb_close(void **ptr)
     return;
 
   struct StoreLmdbCtx *db = *ptr;
+  struct LmdbEnv *env = db->env;
 
-  if (db->txn)
+  if (env->path)
   {
-    if (db->txn_mode == TXN_WRITE)
-      mdb_txn_commit(db->txn);
-    else
-      mdb_txn_abort(db->txn);
-
-    db->txn_mode = TXN_UNINITIALIZED;
-    db->txn = NULL;
+    /* A shared file stays open.  Finish the batch of writes and let go of the
+     * snapshot, so that LMDB can reuse the pages freed since. */
+    if (env->txn && (env->txn_mode == TXN_WRITE))
+    {
+      mdb_txn_commit(env->txn);
+      env->txn = NULL;
+    }
+    else if (env->txn && (env->txn_mode == TXN_READ))
+    {
+      mdb_txn_reset(env->txn);
+    }
+    env->txn_mode = TXN_UNINITIALIZED;
+  }
+  else
+  {
+    lmdb_env_close(&db->env);
   }
 
-  mdb_env_close(db->env);
   FREE(ptr);
 }
 
@@ -320,4 +600,4 @@ static const char *store_lmdb_version(void)
   return "lmdb " MDB_VERSION_STRING;
 }
 
-STORE_BACKEND_OPS(lmdb)
+STORE_BACKEND_OPS_NAMED(lmdb)
@@ -102,6 +102,32 @@ static int store_qdbm_delete_record(void *store, const char *key, size_t klen)
   return success ? 0 : dpecode ? dpecode : -1;
 }
 
+/**
+ * store_qdbm_begin_txn - Implements StoreOps::begin_txn()
+ */
+static int store_qdbm_begin_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  VILLA *db = store;
+  bool success = vltranbegin(db);
+  return success ? 0 : dpecode ? dpecode : -1;
+}
+
+/**
+ * store_qdbm_commit_txn - Implements StoreOps::commit_txn()
+ */
+static int store_qdbm_commit_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  VILLA *db = store;
+  bool success = vltrancommit(db);
+  return success ? 0 : dpecode ? dpecode : -1;
+}
+
 /**
  * store_qdbm_close - Implements StoreOps::close()
  */
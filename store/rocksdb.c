@@ -33,6 +33,17 @@
 #include "mutt/lib.h"
 #include "lib.h"
 
+/** The size of the block cache, shared by all the open databases (32MiB) */
+const size_t ROCKSDB_CACHE_SIZE = 33554432;
+
+/** Bits per key of the Bloom filters */
+const int ROCKSDB_BLOOM_BITS = 10;
+
+/// Block cache, shared by all the open databases
+static rocksdb_cache_t *BlockCache = NULL;
+/// Number of open databases using the block cache
+static int BlockCacheUsers = 0;
+
 /**
  * struct RocksDbCtx - Berkeley DB context
  */
@@ -42,9 +53,31 @@ struct RocksDbCtx
   rocksdb_options_t *options;
   rocksdb_readoptions_t *read_options;
   rocksdb_writeoptions_t *write_options;
+  rocksdb_writebatch_wi_t *batch; ///< Batch of writes, see begin_txn()
   char *err;
 };
 
+/**
+ * rocksdb_ctx_free - Free the options of a RocksDB context
+ * @param ptr RocksDB context
+ */
+static void rocksdb_ctx_free(struct RocksDbCtx **ptr)
+{
+  struct RocksDbCtx *ctx = *ptr;
+
+  rocksdb_options_destroy(ctx->options);
+  rocksdb_readoptions_destroy(ctx->read_options);
+  rocksdb_writeoptions_destroy(ctx->write_options);
+
+  if (--BlockCacheUsers == 0)
+  {
+    rocksdb_cache_destroy(BlockCache);
+    BlockCache = NULL;
+  }
+
+  FREE(ptr);
+}
+
 /**
  * store_rocksdb_open - Implements StoreOps::open()
  */
@@ -53,7 +86,7 @@ static void *store_rocksdb_open(const char *path)
   if (!path)
     return NULL;
 
-  struct RocksDbCtx *ctx = mutt_mem_malloc(sizeof(struct RocksDbCtx));
+  struct RocksDbCtx *ctx = mutt_mem_calloc(1, sizeof(struct RocksDbCtx));
 
   /* RocksDB store errors in form of strings */
   ctx->err = NULL;
@@ -63,6 +96,21 @@ static void *store_rocksdb_open(const char *path)
   rocksdb_options_set_create_if_missing(ctx->options, 1);
   rocksdb_options_set_keep_log_file_num(ctx->options, 1);
 
+  /* The hcache only does point lookups, by UID or filename.  A Bloom filter
+   * skips the files that don't have the key, and the blocks are cached once
+   * for all the open mailboxes. */
+  if (!BlockCache)
+    BlockCache = rocksdb_cache_create_lru(ROCKSDB_CACHE_SIZE);
+  BlockCacheUsers++;
+
+  rocksdb_block_based_table_options_t *table_options = rocksdb_block_based_options_create();
+  rocksdb_block_based_options_set_block_cache(table_options, BlockCache);
+  rocksdb_block_based_options_set_filter_policy(
+      table_options, rocksdb_filterpolicy_create_bloom_full(ROCKSDB_BLOOM_BITS));
+  rocksdb_block_based_options_set_cache_index_and_filter_blocks(table_options, 1);
+  rocksdb_options_set_block_based_table_factory(ctx->options, table_options);
+  rocksdb_block_based_options_destroy(table_options);
+
   /* setup read options, we verify with checksums */
   ctx->read_options = rocksdb_readoptions_create();
   rocksdb_readoptions_set_verify_checksums(ctx->read_options, 1);
@@ -79,7 +127,7 @@ static void *store_rocksdb_open(const char *path)
   if (ctx->err)
   {
     rocksdb_free(ctx->err);
-    FREE(&ctx);
+    rocksdb_ctx_free(&ctx);
     return NULL;
   }
 
@@ -96,7 +144,19 @@ static void *store_rocksdb_fetch(void *store, const char *key, size_t klen, size
 
   struct RocksDbCtx *ctx = store;
 
-  void *rv = rocksdb_get(ctx->db, ctx->read_options, key, klen, vlen, &ctx->err);
+  void *rv = NULL;
+  if (ctx->batch)
+  {
+    /* Include the writes that haven't been committed yet */
+    rv = rocksdb_writebatch_wi_get_from_batch_and_db(ctx->batch, ctx->db,
+                                                     ctx->read_options, key,
+                                                     klen, vlen, &ctx->err);
+  }
+  else
+  {
+    rv = rocksdb_get(ctx->db, ctx->read_options, key, klen, vlen, &ctx->err);
+  }
+
   if (ctx->err)
   {
     rocksdb_free(ctx->err);
@@ -126,6 +186,12 @@ static int store_rocksdb_store(void *store, const char *key, size_t klen,
 
   struct RocksDbCtx *ctx = store;
 
+  if (ctx->batch)
+  {
+    rocksdb_writebatch_wi_put(ctx->batch, key, klen, value, vlen);
+    return 0;
+  }
+
   rocksdb_put(ctx->db, ctx->write_options, key, klen, value, vlen, &ctx->err);
   if (ctx->err)
   {
@@ -147,6 +213,12 @@ static int store_rocksdb_delete_record(void *store, const char *key, size_t klen
 
   struct RocksDbCtx *ctx = store;
 
+  if (ctx->batch)
+  {
+    rocksdb_writebatch_wi_delete(ctx->batch, key, klen);
+    return 0;
+  }
+
   rocksdb_delete(ctx->db, ctx->write_options, key, klen, &ctx->err);
   if (ctx->err)
   {
@@ -158,6 +230,50 @@ static int store_rocksdb_delete_record(void *store, const char *key, size_t klen
   return 0;
 }
 
+/**
+ * store_rocksdb_begin_txn - Implements StoreOps::begin_txn()
+ */
+static int store_rocksdb_begin_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct RocksDbCtx *ctx = store;
+
+  /* The writes are collected in a WriteBatch and applied in one go */
+  if (!ctx->batch)
+    ctx->batch = rocksdb_writebatch_wi_create(0, 1);
+
+  return 0;
+}
+
+/**
+ * store_rocksdb_commit_txn - Implements StoreOps::commit_txn()
+ */
+static int store_rocksdb_commit_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  struct RocksDbCtx *ctx = store;
+
+  if (!ctx->batch)
+    return 0;
+
+  int rc = 0;
+  rocksdb_write_writebatch_wi(ctx->db, ctx->write_options, ctx->batch, &ctx->err);
+  if (ctx->err)
+  {
+    rocksdb_free(ctx->err);
+    ctx->err = NULL;
+    rc = -1;
+  }
+
+  rocksdb_writebatch_wi_destroy(ctx->batch);
+  ctx->batch = NULL;
+  return rc;
+}
+
 /**
  * store_rocksdb_close - Implements StoreOps::close()
  */
@@ -168,13 +284,11 @@ static void store_rocksdb_close(void **ptr)
 
   struct RocksDbCtx *ctx = *ptr;
 
+  store_rocksdb_commit_txn(ctx);
+
   /* close database and free resources */
   rocksdb_close(ctx->db);
-  rocksdb_options_destroy(ctx->options);
-  rocksdb_readoptions_destroy(ctx->read_options);
-  rocksdb_writeoptions_destroy(ctx->write_options);
-
-  FREE(ptr);
+  rocksdb_ctx_free(&ctx);
   *ptr = NULL;
 }
 
@@ -116,6 +116,40 @@ static int store_tokyocabinet_delete_record(void *store, const char *key, size_t
   return 0;
 }
 
+/**
+ * store_tokyocabinet_begin_txn - Implements StoreOps::begin_txn()
+ */
+static int store_tokyocabinet_begin_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  TCBDB *db = store;
+  if (!tcbdbtranbegin(db))
+  {
+    int ecode = tcbdbecode(db);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
+/**
+ * store_tokyocabinet_commit_txn - Implements StoreOps::commit_txn()
+ */
+static int store_tokyocabinet_commit_txn(void *store)
+{
+  if (!store)
+    return -1;
+
+  TCBDB *db = store;
+  if (!tcbdbtrancommit(db))
+  {
+    int ecode = tcbdbecode(db);
+    return ecode ? ecode : -1;
+  }
+  return 0;
+}
+
 /**
  * store_tokyocabinet_close - Implements StoreOps::close()
  */
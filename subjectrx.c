@@ -28,6 +28,7 @@
 
 #include "config.h"
 #include <stdint.h>
+#include <string.h>
 #include "mutt/lib.h"
 #include "email/lib.h"
 #include "core/lib.h"
@@ -38,6 +39,49 @@
 
 static struct ReplaceList SubjectRegexList = STAILQ_HEAD_INITIALIZER(SubjectRegexList);
 static struct Notify *SubjRxNotify = NULL;
+/// Fingerprint of #SubjectRegexList, stored with each Envelope's disp_subj
+static uint32_t SubjRxTag = 0;
+
+/**
+ * subjrx_update_tag - Fingerprint the Subject Regex List
+ * @retval true The rules have changed
+ *
+ * Display subjects made by the old rules are recreated lazily, when they're
+ * next needed.  If a hook replaces the rules with identical ones, e.g. on
+ * changing folder, nothing needs to be redone.
+ */
+static bool subjrx_update_tag(void)
+{
+  uint32_t tag = 0;
+
+  if (!STAILQ_EMPTY(&SubjectRegexList))
+  {
+    struct Md5Ctx md5ctx;
+    unsigned char digest[16];
+    struct Replace *np = NULL;
+
+    mutt_md5_init_ctx(&md5ctx);
+    STAILQ_FOREACH(np, &SubjectRegexList, entries)
+    {
+      /* Include the NULs, to separate the fields */
+      const char *pattern = NONULL(np->regex->pattern);
+      const char *templ = NONULL(np->templ);
+      mutt_md5_process_bytes(pattern, strlen(pattern) + 1, &md5ctx);
+      mutt_md5_process_bytes(templ, strlen(templ) + 1, &md5ctx);
+    }
+    mutt_md5_finish_ctx(&md5ctx, digest);
+
+    memcpy(&tag, digest, sizeof(tag));
+    if (tag == 0) // 0 means "no rules"
+      tag = 1;
+  }
+
+  if (tag == SubjRxTag)
+    return false;
+
+  SubjRxTag = tag;
+  return true;
+}
 
 /**
  * subjrx_free - Free the Subject Regex List
@@ -46,6 +90,7 @@ void subjrx_free(void)
 {
   notify_free(&SubjRxNotify);
   mutt_replacelist_free(&SubjectRegexList);
+  SubjRxTag = 0;
 }
 
 /**
@@ -130,33 +175,18 @@ bool subjrx_apply_mods(struct Envelope *env)
   if (!env || !env->subject || (*env->subject == '\0'))
     return false;
 
-  if (env->disp_subj)
+  if (env->disp_subj && (env->disp_subj_tag == SubjRxTag))
     return true;
 
+  FREE(&env->disp_subj);
   if (STAILQ_EMPTY(&SubjectRegexList))
     return false;
 
   env->disp_subj = mutt_replacelist_apply(&SubjectRegexList, NULL, 0, env->subject);
+  env->disp_subj_tag = SubjRxTag;
   return true;
 }
 
-/**
- * subjrx_clear_mods - Clear out all modified email subjects
- */
-void subjrx_clear_mods(struct Mailbox *m)
-{
-  if (!m)
-    return;
-
-  for (int i = 0; i < m->msg_count; i++)
-  {
-    struct Email *e = m->emails[i];
-    if (!e || !e->env)
-      continue;
-    FREE(&e->env->disp_subj);
-  }
-}
-
 /**
  * parse_subjectrx_list - Parse the 'subjectrx' command - Implements Command::parse()
  */
@@ -166,7 +196,7 @@ enum CommandResult parse_subjectrx_list(struct Buffer *buf, struct Buffer *s,
   enum CommandResult rc;
 
   rc = parse_replace_list(buf, s, &SubjectRegexList, err);
-  if (rc == MUTT_CMD_SUCCESS)
+  if ((rc == MUTT_CMD_SUCCESS) && subjrx_update_tag())
   {
     notify_send(SubjRxNotify, NT_SUBJRX, NT_SUBJRX_ADD, NULL);
   }
@@ -182,7 +212,7 @@ enum CommandResult parse_unsubjectrx_list(struct Buffer *buf, struct Buffer *s,
   enum CommandResult rc;
 
   rc = parse_unreplace_list(buf, s, &SubjectRegexList, err);
-  if (rc == MUTT_CMD_SUCCESS)
+  if ((rc == MUTT_CMD_SUCCESS) && subjrx_update_tag())
   {
     notify_send(SubjRxNotify, NT_SUBJRX, NT_SUBJRX_DELETE, NULL);
   }
@@ -28,7 +28,7 @@
 #include "mutt_commands.h"
 
 struct Buffer;
-struct Mailbox;
+struct Envelope;
 
 /**
  * enum NotifySubjRx - Subject Regex notification types
@@ -54,6 +54,5 @@ enum CommandResult parse_subjectrx_list  (struct Buffer *buf, struct Buffer *s,
 enum CommandResult parse_unsubjectrx_list(struct Buffer *buf, struct Buffer *s, intptr_t data, struct Buffer *err);
 
 bool subjrx_apply_mods(struct Envelope *env);
-void subjrx_clear_mods(struct Mailbox *m);
 
 #endif /* MUTT_SUBJECTRX_H */
@@ -0,0 +1,70 @@
+/**
+ * @file
+ * Test code for account_mailbox_find_name()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "test_common.h"
+
+void test_account_mailbox_find_name(void)
+{
+  // struct Mailbox *account_mailbox_find_name(struct Account *a, const char *name);
+
+  {
+    struct Account a = { 0 };
+    TEST_CHECK(account_mailbox_find_name(NULL, "apple") == NULL);
+    TEST_CHECK(account_mailbox_find_name(&a, NULL) == NULL);
+  }
+
+  {
+    NeoMutt = test_neomutt_create();
+    struct ConfigSubset *sub = cs_subset_new("account", NULL, NULL);
+    struct Account *a = account_new("dummy", sub);
+    TEST_CHECK(a != NULL);
+
+    struct Mailbox *m1 = mailbox_new();
+    m1->realpath = mutt_str_dup("/apple");
+    m1->name = mutt_str_dup("Apple");
+    struct Mailbox *m2 = mailbox_new();
+    m2->realpath = mutt_str_dup("/banana");
+    m2->name = NULL;
+
+    TEST_CHECK(account_mailbox_add(a, m1));
+    TEST_CHECK(account_mailbox_add(a, m2));
+
+    TEST_CHECK(account_mailbox_find_name(a, "Apple") == m1);
+    TEST_CHECK(account_mailbox_find_name(a, "apple") == NULL);
+    TEST_CHECK(account_mailbox_find_name(a, "/banana") == NULL);
+
+    TEST_CHECK(account_mailbox_remove(a, m1));
+    TEST_CHECK(account_mailbox_find_name(a, "Apple") == NULL);
+    mailbox_free(&m1);
+
+    account_free(&a);
+    cs_subset_free(&sub);
+    test_neomutt_destroy(&NeoMutt);
+  }
+}
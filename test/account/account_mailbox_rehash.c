@@ -0,0 +1,66 @@
+/**
+ * @file
+ * Test code for account_mailbox_rehash()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "test_common.h"
+
+void test_account_mailbox_rehash(void)
+{
+  // void account_mailbox_rehash(struct Account *a);
+
+  {
+    account_mailbox_rehash(NULL);
+    TEST_CHECK_(1, "account_mailbox_rehash(NULL)");
+  }
+
+  {
+    NeoMutt = test_neomutt_create();
+    struct ConfigSubset *sub = cs_subset_new("account", NULL, NULL);
+    struct Account *a = account_new("dummy", sub);
+    TEST_CHECK(a != NULL);
+
+    struct Mailbox *m = mailbox_new();
+    m->realpath = mutt_str_dup("/apple");
+    m->name = mutt_str_dup("Apple");
+
+    TEST_CHECK(account_mailbox_add(a, m));
+
+    mutt_str_replace(&m->realpath, "/banana");
+    mutt_str_replace(&m->name, "Banana");
+    account_mailbox_rehash(a);
+
+    TEST_CHECK(account_mailbox_find(a, "/apple") == NULL);
+    TEST_CHECK(account_mailbox_find(a, "/banana") == m);
+    TEST_CHECK(account_mailbox_find_name(a, "Apple") == NULL);
+    TEST_CHECK(account_mailbox_find_name(a, "Banana") == m);
+
+    account_free(&a);
+    cs_subset_free(&sub);
+    test_neomutt_destroy(&NeoMutt);
+  }
+}
@@ -127,4 +127,27 @@ void test_mutt_addrlist_parse(void)
     TEST_CHECK(a == NULL);
     mutt_addrlist_clear(&alist);
   }
+
+  {
+    /* Simple and complex forms of the same addresses */
+    static const char *tests[][2] = {
+      { "John  Smith <john@example.com>", "John Smith <john@example.com>" },
+      { "\"Smith, John\" <john@example.com>", "\"Smith, John\"<john@example.com >" },
+      { "john@example.com", "john @ example.com" },
+      { "J.R. Bob <jr.bob@example.com>", "J.R. Bob <jr . bob @ example . com>" },
+    };
+
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i][0]);
+      struct AddressList al1 = TAILQ_HEAD_INITIALIZER(al1);
+      struct AddressList al2 = TAILQ_HEAD_INITIALIZER(al2);
+      TEST_CHECK(mutt_addrlist_parse(&al1, tests[i][0]) == 1);
+      TEST_CHECK(mutt_addrlist_parse(&al2, tests[i][1]) == 1);
+      TEST_CHECK(mutt_addrlist_equal(&al1, &al2));
+      TEST_CHECK_STR_EQ(TAILQ_FIRST(&al1)->personal, TAILQ_FIRST(&al2)->personal);
+      mutt_addrlist_clear(&al1);
+      mutt_addrlist_clear(&al2);
+    }
+  }
 }
@@ -0,0 +1,90 @@
+/**
+ * @file
+ * Test code for mutt_b64_decode_stream()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_b64_decode_stream(void)
+{
+  // size_t mutt_b64_decode_stream(struct B64Stream *bs, const char *in, size_t inlen, char *out);
+
+  {
+    char out[16];
+    TEST_CHECK(mutt_b64_decode_stream(NULL, "SGVs", 4, out) == 0);
+  }
+
+  {
+    struct B64Stream bs = { 0 };
+    TEST_CHECK(mutt_b64_decode_stream(&bs, NULL, 4, "banana") == 0);
+  }
+
+  {
+    struct B64Stream bs = { 0 };
+    TEST_CHECK(mutt_b64_decode_stream(&bs, "SGVs", 4, NULL) == 0);
+  }
+
+  // Line breaks are ignored and the padding ends the stream
+  {
+    static const char in[] = "SGVs\nbG8g\r\nd29y\nbGQ=\njunk";
+    char out[32] = { 0 };
+    struct B64Stream bs = { 0 };
+    size_t len = mutt_b64_decode_stream(&bs, in, sizeof(in) - 1, out);
+    TEST_CHECK(len == 11);
+    TEST_CHECK(memcmp(out, "Hello world", 11) == 0);
+    TEST_CHECK(bs.done);
+  }
+
+  // The text can be split anywhere
+  {
+    static const char in[] = "SGVsbG8gd29ybGQh\nSGk=";
+    static const char clear[] = "Hello world!Hi";
+    for (size_t split = 0; split < sizeof(in); split++)
+    {
+      char out[32] = { 0 };
+      struct B64Stream bs = { 0 };
+      size_t len = mutt_b64_decode_stream(&bs, in, split, out);
+      len += mutt_b64_decode_stream(&bs, in + split, sizeof(in) - 1 - split, out + len);
+      TEST_CASE_("%zu", split);
+      TEST_CHECK(len == sizeof(clear) - 1);
+      TEST_CHECK(memcmp(out, clear, sizeof(clear) - 1) == 0);
+    }
+  }
+
+  // Every byte value survives
+  {
+    char clear[256];
+    for (int i = 0; i < 256; i++)
+      clear[i] = i;
+    char in[512] = { 0 };
+    size_t elen = mutt_b64_encode(clear, sizeof(clear), in, sizeof(in));
+
+    char out[256 + 3] = { 0 };
+    struct B64Stream bs = { 0 };
+    size_t len = mutt_b64_decode_stream(&bs, in, elen, out);
+    TEST_CHECK(len == sizeof(clear));
+    TEST_CHECK(memcmp(out, clear, sizeof(clear)) == 0);
+  }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * Benchmark the address parser
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "email/lib.h"
+#include "bench.h"
+
+/// Address lists of increasing difficulty
+static const char *AddressStrings[] = {
+  "john@example.com",
+  "John Doe <john@example.com>",
+  "\"Doe, John\" <john@example.com>, jane@example.com",
+  "John Doe <john@example.com> (work), \"Jane Q. Public\" <jane.public@mail.example.org>",
+  "undisclosed-recipients:;",
+  "team: alice@example.com, Bob <bob@example.net>, \"Carol\" <carol@example.org>;",
+  "=?utf-8?Q?J=C3=B6rg_M=C3=BCller?= <joerg@example.de>, <bare@example.com>",
+  "a@b.c, d@e.f, g@h.i, j@k.l, m@n.o, p@q.r, s@t.u, v@w.x, y@z.a, b@c.d",
+};
+
+/**
+ * bench_addrlist_parse - Benchmark mutt_addrlist_parse()
+ */
+static size_t bench_addrlist_parse(void)
+{
+  for (size_t i = 0; i < mutt_array_size(AddressStrings); i++)
+  {
+    struct AddressList al = TAILQ_HEAD_INITIALIZER(al);
+    mutt_addrlist_parse(&al, AddressStrings[i]);
+    mutt_addrlist_clear(&al);
+  }
+  return mutt_array_size(AddressStrings);
+}
+
+/**
+ * bench_addrlist_write - Benchmark mutt_addrlist_write() on the corpus
+ */
+static size_t bench_addrlist_write(void)
+{
+  char buf[1024];
+  for (size_t i = 0; i < BenchCorpus.num; i++)
+  {
+    const struct Envelope *env = BenchCorpus.emails[i]->env;
+    if (env)
+      mutt_addrlist_write(&env->to, buf, sizeof(buf), false);
+  }
+  return BenchCorpus.num;
+}
+
+// clang-format off
+const struct Benchmark BenchAddress[] = {
+  { "mutt_addrlist_parse", NULL, bench_addrlist_parse, NULL },
+  { "mutt_addrlist_write", NULL, bench_addrlist_write, NULL },
+  { NULL },
+};
+// clang-format on
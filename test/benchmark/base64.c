@@ -0,0 +1,85 @@
+/**
+ * @file
+ * Benchmark the base64 codec
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <string.h>
+#include "mutt/lib.h"
+#include "bench.h"
+
+/// Size of the data to encode
+#define B64_SIZE 65536
+
+static char *Plain = NULL;   ///< Data to encode
+static char *Encoded = NULL; ///< Data to decode
+static char *Output = NULL;  ///< Space for the results
+
+/**
+ * b64_setup - Create the data for the base64 benchmarks
+ */
+static void b64_setup(void)
+{
+  Plain = mutt_mem_malloc(B64_SIZE);
+  for (size_t i = 0; i < B64_SIZE; i++)
+    Plain[i] = (char) ((i * 7) ^ (i >> 3));
+
+  const size_t len = ((B64_SIZE + 2) / 3) * 4 + 1;
+  Encoded = mutt_mem_malloc(len);
+  mutt_b64_encode(Plain, B64_SIZE, Encoded, len);
+  Output = mutt_mem_malloc(len);
+}
+
+/**
+ * b64_teardown - Free the data for the base64 benchmarks
+ */
+static void b64_teardown(void)
+{
+  FREE(&Plain);
+  FREE(&Encoded);
+  FREE(&Output);
+}
+
+/**
+ * bench_b64_encode - Benchmark mutt_b64_encode(), per KiB
+ */
+static size_t bench_b64_encode(void)
+{
+  mutt_b64_encode(Plain, B64_SIZE, Output, ((B64_SIZE + 2) / 3) * 4 + 1);
+  return B64_SIZE / 1024;
+}
+
+/**
+ * bench_b64_decode - Benchmark mutt_b64_decode(), per KiB
+ */
+static size_t bench_b64_decode(void)
+{
+  mutt_b64_decode(Encoded, Output, B64_SIZE);
+  return B64_SIZE / 1024;
+}
+
+// clang-format off
+const struct Benchmark BenchBase64[] = {
+  { "mutt_b64_decode", b64_setup, bench_b64_decode, b64_teardown },
+  { "mutt_b64_encode", b64_setup, bench_b64_encode, b64_teardown },
+  { NULL },
+};
+// clang-format on
@@ -0,0 +1,76 @@
+/**
+ * @file
+ * Shared code for the benchmarks
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEST_BENCHMARK_BENCH_H
+#define TEST_BENCHMARK_BENCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+struct Email;
+
+/**
+ * struct Benchmark - A function to time
+ *
+ * Each call to run() does one pass over the benchmark's data.  The harness
+ * repeats run() until enough time has passed.
+ */
+struct Benchmark
+{
+  const char *name;         ///< Name of the benchmark
+  void (*setup)(void);      ///< Prepare the data, may be NULL
+  size_t (*run)(void);      ///< Run one pass, returning the number of operations
+  void (*teardown)(void);   ///< Free the data, may be NULL
+};
+
+/**
+ * struct BenchCorpus - Emails to parse and match
+ *
+ * The headers are either generated, or read from an mbox given with `-f`.
+ */
+struct BenchCorpus
+{
+  char *data;             ///< Headers of all the messages, separated by blank lines
+  size_t len;             ///< Length of the data
+  FILE *fp;               ///< Temporary file holding the data
+  size_t *offsets;        ///< Start of each message's headers
+  struct Email **emails;  ///< Parsed messages
+  size_t num;             ///< Number of messages
+};
+
+extern struct BenchCorpus BenchCorpus;
+extern const char *BenchMbox;
+
+void bench_corpus_load(void);
+void bench_corpus_free(void);
+
+// clang-format off
+extern const struct Benchmark BenchAddress[];
+extern const struct Benchmark BenchBase64[];
+extern const struct Benchmark BenchHash[];
+extern const struct Benchmark BenchMbyte[];
+extern const struct Benchmark BenchParse[];
+extern const struct Benchmark BenchPattern[];
+extern const struct Benchmark BenchRfc2047[];
+// clang-format on
+
+#endif /* TEST_BENCHMARK_BENCH_H */
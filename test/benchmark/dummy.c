@@ -0,0 +1,39 @@
+/**
+ * @file
+ * Stubs of functions the benchmarks don't reach
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define MAIN_C 1
+#include "config.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include "mutt_globals.h"
+
+typedef uint16_t MuttRedrawFlags;
+
+bool ResumeEditedDraftFiles;
+
+void mutt_menu_set_current_redraw_full(void)
+{
+}
+
+void mutt_menu_set_current_redraw(MuttRedrawFlags redraw)
+{
+}
@@ -0,0 +1,120 @@
+/**
+ * @file
+ * Benchmark the hash tables
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdio.h>
+#include "mutt/lib.h"
+#include "bench.h"
+
+/// Number of keys in the table
+#define HASH_KEYS 10000
+
+static char *Keys[HASH_KEYS];            ///< Keys that look like Message-IDs
+static struct HashTable *Table = NULL;  ///< Table for the lookups
+
+/**
+ * hash_setup - Create the keys for the hash benchmarks
+ */
+static void hash_setup(void)
+{
+  char buf[128];
+  for (size_t i = 0; i < HASH_KEYS; i++)
+  {
+    snprintf(buf, sizeof(buf), "<%zu.%zx@mail.example.com>", i, i * 2654435761U);
+    Keys[i] = mutt_str_dup(buf);
+  }
+}
+
+/**
+ * hash_teardown - Free the keys for the hash benchmarks
+ */
+static void hash_teardown(void)
+{
+  for (size_t i = 0; i < HASH_KEYS; i++)
+    FREE(&Keys[i]);
+}
+
+/**
+ * bench_hash_insert - Benchmark mutt_hash_insert() and mutt_hash_free()
+ */
+static size_t bench_hash_insert(void)
+{
+  struct HashTable *table = mutt_hash_new(HASH_KEYS, MUTT_HASH_NO_FLAGS);
+  for (size_t i = 0; i < HASH_KEYS; i++)
+    mutt_hash_insert(table, Keys[i], Keys[i]);
+  mutt_hash_free(&table);
+  return HASH_KEYS;
+}
+
+/**
+ * hash_find_setup - Fill a table with half of the keys
+ */
+static void hash_find_setup(void)
+{
+  hash_setup();
+  Table = mutt_hash_new(HASH_KEYS, MUTT_HASH_NO_FLAGS);
+  for (size_t i = 0; i < HASH_KEYS; i += 2)
+    mutt_hash_insert(Table, Keys[i], Keys[i]);
+}
+
+/**
+ * hash_find_teardown - Free the table and the keys
+ */
+static void hash_find_teardown(void)
+{
+  mutt_hash_free(&Table);
+  hash_teardown();
+}
+
+/**
+ * bench_hash_find - Benchmark mutt_hash_find(), half of which miss
+ */
+static size_t bench_hash_find(void)
+{
+  for (size_t i = 0; i < HASH_KEYS; i++)
+    mutt_hash_find(Table, Keys[i]);
+  return HASH_KEYS;
+}
+
+/**
+ * bench_hash_delete - Benchmark mutt_hash_insert() then mutt_hash_delete()
+ */
+static size_t bench_hash_delete(void)
+{
+  struct HashTable *table = mutt_hash_new(HASH_KEYS, MUTT_HASH_NO_FLAGS);
+  for (size_t i = 0; i < HASH_KEYS; i++)
+    mutt_hash_insert(table, Keys[i], Keys[i]);
+  for (size_t i = 0; i < HASH_KEYS; i++)
+    mutt_hash_delete(table, Keys[i], Keys[i]);
+  mutt_hash_free(&table);
+  return HASH_KEYS;
+}
+
+// clang-format off
+const struct Benchmark BenchHash[] = {
+  { "mutt_hash_delete", hash_setup,      bench_hash_delete, hash_teardown },
+  { "mutt_hash_find",   hash_find_setup, bench_hash_find,   hash_find_teardown },
+  { "mutt_hash_insert", hash_setup,      bench_hash_insert, hash_teardown },
+  { NULL },
+};
+// clang-format on
@@ -0,0 +1,220 @@
+/**
+ * @file
+ * Benchmark hub
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Time some of the library functions that NeoMutt calls most.
+ *
+ * Usage: neomutt-benchmark [-f mbox] [-t seconds] [benchmark...]
+ *
+ * - `-f` parse and match the headers of a real mailbox
+ * - `-t` minimum time to spend on each benchmark (default 0.5s)
+ * - Only run the benchmarks whose names start with one of the arguments
+ *
+ * The results are written as tab-separated columns: name, number of
+ * operations, total seconds, nanoseconds per operation.
+ */
+
+#include "config.h"
+#include <locale.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
+#include "bench.h"
+
+#define CONFIG_INIT_TYPE(CS, NAME)                                             \
+  extern const struct ConfigSetType cst_##NAME;                                \
+  cs_register_type(CS, &cst_##NAME)
+
+const char *BenchMbox = NULL; ///< Mailbox to read, from `-f`
+
+/// Config used by the library functions
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "assumed_charset",         DT_STRING,                                0,          0, NULL, },
+  { "auto_subscribe",          DT_BOOL,                                  false,      0, NULL, },
+  { "autocrypt",               DT_BOOL,                                  false,      0, NULL, },
+  { "charset",                 DT_STRING|DT_NOT_EMPTY|DT_CHARSET_SINGLE, IP "utf-8", 0, NULL, },
+  { "external_search_command", DT_STRING|DT_COMMAND,                     0,          0, NULL, },
+  { "hidden_tags",             DT_SLIST|SLIST_SEP_COMMA,                 IP "unread,draft,flagged,passed,replied,attachment,signed,encrypted", 0, NULL, },
+  { "idn_decode",              DT_BOOL,                                  true,       0, NULL, },
+  { "idn_encode",              DT_BOOL,                                  true,       0, NULL, },
+  { "mark_old",                DT_BOOL,                                  true,       0, NULL, },
+  { "reply_regex",             DT_REGEX,                                 IP "^((re)(\\[[0-9]+\\])*:[ \t]*)*", 0, NULL, },
+  { "rfc2047_parameters",      DT_BOOL,                                  false,      0, NULL, },
+  { "send_charset",            DT_STRING,                                IP "us-ascii:iso-8859-1:utf-8", 0, NULL, },
+  { "simple_search",           DT_STRING,                                IP "~f %s | ~s %s", 0, NULL, },
+  { "spam_separator",          DT_STRING,                                IP ",",     0, NULL, },
+  { "thorough_search",         DT_BOOL,                                  true,       0, NULL, },
+  { "weed",                    DT_BOOL,                                  true,       0, NULL, },
+  { NULL },
+  // clang-format on
+};
+
+/// All the groups of benchmarks
+static const struct Benchmark *Benchmarks[] = {
+  BenchAddress, BenchBase64, BenchHash,    BenchMbyte,
+  BenchParse,   BenchPattern, BenchRfc2047, NULL,
+};
+
+/**
+ * bench_now - Get the time, for measuring intervals
+ * @retval num Seconds since an arbitrary point
+ */
+static double bench_now(void)
+{
+  struct timespec ts = { 0 };
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/**
+ * bench_wanted - Was a benchmark asked for?
+ * @param name  Name of the benchmark
+ * @param names Names from the command line
+ * @param num   Number of names
+ * @retval true The benchmark should be run
+ */
+static bool bench_wanted(const char *name, char **names, int num)
+{
+  if (num == 0)
+    return true;
+
+  for (int i = 0; i < num; i++)
+    if (mutt_str_startswith(name, names[i]))
+      return true;
+
+  return false;
+}
+
+/**
+ * bench_run - Time a benchmark
+ * @param b       Benchmark
+ * @param seconds Minimum time to spend
+ */
+static void bench_run(const struct Benchmark *b, double seconds)
+{
+  if (b->setup)
+    b->setup();
+
+  /* warm the caches */
+  b->run();
+
+  size_t ops = 0;
+  const double start = bench_now();
+  double elapsed = 0;
+  do
+  {
+    ops += b->run();
+    elapsed = bench_now() - start;
+  } while (elapsed < seconds);
+
+  if (b->teardown)
+    b->teardown();
+
+  printf("%s\t%zu\t%.6f\t%.1f\n", b->name, ops, elapsed, (ops ? (elapsed * 1e9) / ops : 0));
+  fflush(stdout);
+}
+
+/**
+ * bench_neomutt_create - Set up the config for the benchmarks
+ */
+static void bench_neomutt_create(void)
+{
+  struct ConfigSet *cs = cs_new(50);
+  CONFIG_INIT_TYPE(cs, bool);
+  CONFIG_INIT_TYPE(cs, number);
+  CONFIG_INIT_TYPE(cs, regex);
+  CONFIG_INIT_TYPE(cs, slist);
+  CONFIG_INIT_TYPE(cs, string);
+  NeoMutt = neomutt_new(cs);
+  cs_register_variables(cs, Vars, 0);
+}
+
+/**
+ * bench_neomutt_destroy - Free the config
+ */
+static void bench_neomutt_destroy(void)
+{
+  struct ConfigSet *cs = NeoMutt->sub->cs;
+  neomutt_free(&NeoMutt);
+  cs_free(&cs);
+}
+
+/**
+ * main - Run the benchmarks
+ * @param argc Number of command line arguments
+ * @param argv Command line arguments
+ * @retval 0 Success
+ * @retval 1 Error
+ */
+int main(int argc, char *argv[])
+{
+  double seconds = 0.5;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "f:t:")) != -1)
+  {
+    switch (opt)
+    {
+      case 'f':
+        BenchMbox = optarg;
+        break;
+      case 't':
+        seconds = atof(optarg);
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-f mbox] [-t seconds] [benchmark...]\n", argv[0]);
+        return 1;
+    }
+  }
+
+  if (!setlocale(LC_ALL, "C.UTF-8") && !setlocale(LC_ALL, "en_US.UTF-8"))
+    fprintf(stderr, "Can't set locale to C.UTF-8 or en_US.UTF-8\n");
+
+  bench_neomutt_create();
+  bench_corpus_load();
+  if (BenchCorpus.num == 0)
+  {
+    fprintf(stderr, "No messages in %s\n", NONULL(BenchMbox));
+    return 1;
+  }
+
+  printf("# benchmark\tops\tseconds\tns/op\n");
+  for (size_t i = 0; Benchmarks[i]; i++)
+  {
+    for (const struct Benchmark *b = Benchmarks[i]; b->name; b++)
+    {
+      if (bench_wanted(b->name, argv + optind, argc - optind))
+        bench_run(b, seconds);
+    }
+  }
+
+  bench_corpus_free();
+  bench_neomutt_destroy();
+  mutt_buffer_pool_free();
+  return 0;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file
+ * Benchmark the multibyte string functions
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "bench.h"
+
+/// Strings of mixed widths
+static const char *MbStrings[] = {
+  "urgent report about the quarterly numbers",
+  "Kviečiame drauge pildyti ESO pasižadėjimų girliandą!",
+  "聪明的 Hello 聪明的",
+  "Tab\tseparated\tcolumns",
+  "Ελληνικά και English",
+  "😀 emoji 😀 and combining é",
+};
+
+/**
+ * bench_mb_width - Benchmark mutt_mb_width()
+ */
+static size_t bench_mb_width(void)
+{
+  for (size_t i = 0; i < mutt_array_size(MbStrings); i++)
+    mutt_mb_width(MbStrings[i], 0, true);
+  return mutt_array_size(MbStrings);
+}
+
+/**
+ * bench_mb_width_corpus - Benchmark mutt_mb_width() on the corpus Subjects
+ */
+static size_t bench_mb_width_corpus(void)
+{
+  for (size_t i = 0; i < BenchCorpus.num; i++)
+  {
+    const struct Envelope *env = BenchCorpus.emails[i]->env;
+    if (env && env->subject)
+      mutt_mb_width(env->subject, 0, true);
+  }
+  return BenchCorpus.num;
+}
+
+// clang-format off
+const struct Benchmark BenchMbyte[] = {
+  { "mutt_mb_width",        NULL, bench_mb_width,        NULL },
+  { "mutt_mb_width_corpus", NULL, bench_mb_width_corpus, NULL },
+  { NULL },
+};
+// clang-format on
@@ -0,0 +1,217 @@
+/**
+ * @file
+ * Benchmark the header parser
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "bench.h"
+
+/// Number of generated messages
+#define CORPUS_SIZE 2000
+
+struct BenchCorpus BenchCorpus = { 0 };
+
+/**
+ * corpus_generate - Make up the headers of some messages
+ * @param buf Buffer for the headers
+ */
+static void corpus_generate(struct Buffer *buf)
+{
+  static const char *names[] = { "Alice", "Bob Smith", "\"Carol, Q.\"", "Dave" };
+  static const char *subjects[] = {
+    "urgent report",
+    "=?utf-8?Q?Kvie=C4=8Diame_drauge_pildyti?=",
+    "Re: [list] release plans",
+    "=?iso-8859-1?B?SGVsbG8gd29ybGQ=?= again",
+  };
+
+  for (int i = 0; i < CORPUS_SIZE; i++)
+  {
+    mutt_buffer_add_printf(buf, "From: %s <user%d@example.com>\n", names[i % 4], i % 97);
+    mutt_buffer_add_printf(buf, "To: list@lists.example.org, %s <friend%d@example.net>\n",
+                           names[(i + 1) % 4], i % 13);
+    if (i % 3 == 0)
+      mutt_buffer_addstr(buf, "Cc: boss@example.com, \"Team\" <team@example.com>\n");
+    mutt_buffer_add_printf(buf, "Subject: %s %d\n", subjects[i % 4], i);
+    mutt_buffer_add_printf(buf, "Date: Mon, %d Jun 2020 %02d:%02d:00 +0100\n",
+                           1 + (i % 28), i % 24, i % 60);
+    mutt_buffer_add_printf(buf, "Message-ID: <%d.bench@example.com>\n", i);
+    if (i > 0)
+    {
+      mutt_buffer_add_printf(buf, "In-Reply-To: <%d.bench@example.com>\n", i / 2);
+      mutt_buffer_add_printf(buf, "References: <%d.bench@example.com> <%d.bench@example.com>\n",
+                             i / 4, i / 2);
+    }
+    mutt_buffer_addstr(buf, "MIME-Version: 1.0\n"
+                            "Content-Type: text/plain; charset=utf-8; format=flowed\n"
+                            "Content-Transfer-Encoding: quoted-printable\n"
+                            "X-Mailer: benchmark\n\n");
+  }
+}
+
+/**
+ * corpus_read - Read the headers of the messages in an mbox
+ * @param buf  Buffer for the headers
+ * @param path Path to the mbox
+ * @retval true Success
+ */
+static bool corpus_read(struct Buffer *buf, const char *path)
+{
+  FILE *fp = fopen(path, "r");
+  if (!fp)
+  {
+    perror(path);
+    return false;
+  }
+
+  char line[8192];
+  bool in_header = false;
+  while (fgets(line, sizeof(line), fp))
+  {
+    if (mutt_str_startswith(line, "From "))
+    {
+      in_header = true;
+      continue;
+    }
+
+    if (!in_header)
+      continue;
+
+    mutt_buffer_addstr(buf, line);
+    if ((line[0] == '\n') || mutt_str_equal(line, "\r\n"))
+      in_header = false;
+  }
+
+  fclose(fp);
+  if (in_header)
+    mutt_buffer_addch(buf, '\n');
+  return true;
+}
+
+/**
+ * corpus_parse - Parse all the headers in the corpus
+ * @param keep If true, keep the Emails
+ * @retval num Number of messages parsed
+ */
+static size_t corpus_parse(bool keep)
+{
+  FILE *fp = BenchCorpus.fp;
+  for (size_t i = 0; i < BenchCorpus.num; i++)
+  {
+    fseek(fp, BenchCorpus.offsets[i], SEEK_SET);
+    struct Email *e = email_new();
+    e->env = mutt_rfc822_read_header(fp, e, false, false);
+    if (keep)
+      BenchCorpus.emails[i] = e;
+    else
+      email_free(&e);
+  }
+
+  return BenchCorpus.num;
+}
+
+/**
+ * bench_corpus_load - Load the messages for the benchmarks
+ */
+void bench_corpus_load(void)
+{
+  struct Buffer buf = mutt_buffer_make(1 << 20);
+  if (BenchMbox)
+  {
+    if (!corpus_read(&buf, BenchMbox))
+    {
+      mutt_buffer_dealloc(&buf);
+      return;
+    }
+  }
+  else
+  {
+    corpus_generate(&buf);
+  }
+
+  BenchCorpus.len = mutt_buffer_len(&buf);
+  BenchCorpus.data = buf.data;
+
+  /* each message's headers end with a blank line */
+  size_t max = 1024;
+  BenchCorpus.offsets = mutt_mem_calloc(max, sizeof(size_t));
+  for (size_t off = 0; off < BenchCorpus.len;)
+  {
+    if (BenchCorpus.num == max)
+    {
+      max *= 2;
+      mutt_mem_realloc(&BenchCorpus.offsets, max * sizeof(size_t));
+    }
+    BenchCorpus.offsets[BenchCorpus.num++] = off;
+
+    const char *end = strstr(BenchCorpus.data + off, "\n\n");
+    const char *crlf = strstr(BenchCorpus.data + off, "\n\r\n");
+    if (crlf && (!end || (crlf < end)))
+      end = crlf + 1;
+    if (!end)
+      break;
+    off = (end - BenchCorpus.data) + 2;
+  }
+
+  BenchCorpus.fp = tmpfile();
+  if (!BenchCorpus.fp || (fwrite(BenchCorpus.data, 1, BenchCorpus.len, BenchCorpus.fp) != BenchCorpus.len))
+  {
+    BenchCorpus.num = 0;
+    return;
+  }
+
+  BenchCorpus.emails = mutt_mem_calloc(BenchCorpus.num, sizeof(struct Email *));
+  corpus_parse(true);
+}
+
+/**
+ * bench_corpus_free - Free the messages
+ */
+void bench_corpus_free(void)
+{
+  for (size_t i = 0; i < BenchCorpus.num; i++)
+    email_free(&BenchCorpus.emails[i]);
+  FREE(&BenchCorpus.emails);
+  FREE(&BenchCorpus.offsets);
+  FREE(&BenchCorpus.data);
+  if (BenchCorpus.fp)
+    fclose(BenchCorpus.fp);
+  BenchCorpus.fp = NULL;
+  BenchCorpus.num = 0;
+}
+
+/**
+ * bench_read_header - Benchmark mutt_rfc822_read_header()
+ */
+static size_t bench_read_header(void)
+{
+  return corpus_parse(false);
+}
+
+// clang-format off
+const struct Benchmark BenchParse[] = {
+  { "mutt_rfc822_read_header", NULL, bench_read_header, NULL },
+  { NULL },
+};
+// clang-format on
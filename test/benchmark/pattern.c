@@ -0,0 +1,92 @@
+/**
+ * @file
+ * Benchmark the pattern matcher
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include <stdio.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "pattern/lib.h"
+#include "bench.h"
+
+/// Patterns that only need the headers
+static const char *PatternStrings[] = {
+  "~s report",
+  "~f alice | ~s release",
+  "~C example.com ~s urgent",
+  "!~x bench.*example.com",
+  "~d 01/06/2020-15/06/2020",
+};
+
+static struct PatternList *Patterns[mutt_array_size(PatternStrings)]; ///< Compiled patterns
+
+/**
+ * pattern_setup - Compile the patterns
+ */
+static void pattern_setup(void)
+{
+  struct Buffer *err = mutt_buffer_pool_get();
+  for (size_t i = 0; i < mutt_array_size(PatternStrings); i++)
+  {
+    Patterns[i] = mutt_pattern_comp(NULL, NULL, PatternStrings[i], MUTT_PC_NO_FLAGS, err);
+    if (!Patterns[i])
+      fprintf(stderr, "%s: %s\n", PatternStrings[i], mutt_buffer_string(err));
+  }
+  mutt_buffer_pool_release(&err);
+}
+
+/**
+ * pattern_teardown - Free the patterns
+ */
+static void pattern_teardown(void)
+{
+  for (size_t i = 0; i < mutt_array_size(PatternStrings); i++)
+    mutt_pattern_free(&Patterns[i]);
+}
+
+/**
+ * bench_pattern_exec - Benchmark mutt_pattern_exec() on the corpus
+ */
+static size_t bench_pattern_exec(void)
+{
+  size_t num = 0;
+  for (size_t i = 0; i < mutt_array_size(PatternStrings); i++)
+  {
+    if (!Patterns[i])
+      continue;
+
+    for (size_t j = 0; j < BenchCorpus.num; j++)
+    {
+      mutt_pattern_exec(SLIST_FIRST(Patterns[i]), MUTT_MATCH_FULL_ADDRESS, NULL,
+                        BenchCorpus.emails[j], NULL);
+    }
+    num += BenchCorpus.num;
+  }
+  return num;
+}
+
+// clang-format off
+const struct Benchmark BenchPattern[] = {
+  { "mutt_pattern_exec", pattern_setup, bench_pattern_exec, pattern_teardown },
+  { NULL },
+};
+// clang-format on
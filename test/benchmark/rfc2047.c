@@ -0,0 +1,66 @@
+/**
+ * @file
+ * Benchmark the RFC2047 decoder
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <stddef.h>
+#include "mutt/lib.h"
+#include "email/lib.h"
+#include "bench.h"
+#include "rfc2047/common.h"
+
+/**
+ * bench_rfc2047_decode - Benchmark rfc2047_decode() on the unit test data
+ */
+static size_t bench_rfc2047_decode(void)
+{
+  size_t num = 0;
+  for (; rfc2047_test_data[num].original; num++)
+  {
+    char *s = mutt_str_dup(rfc2047_test_data[num].original);
+    rfc2047_decode(&s);
+    FREE(&s);
+  }
+  return num;
+}
+
+/**
+ * bench_rfc2047_encode - Benchmark rfc2047_encode() on the unit test data
+ */
+static size_t bench_rfc2047_encode(void)
+{
+  size_t num = 0;
+  for (; rfc2047_test_data[num].decoded; num++)
+  {
+    char *s = mutt_str_dup(rfc2047_test_data[num].decoded);
+    rfc2047_encode(&s, NULL, 0, "utf-8");
+    FREE(&s);
+  }
+  return num;
+}
+
+// clang-format off
+const struct Benchmark BenchRfc2047[] = {
+  { "rfc2047_decode", NULL, bench_rfc2047_decode, NULL },
+  { "rfc2047_encode", NULL, bench_rfc2047_encode, NULL },
+  { NULL },
+};
+// clang-format on
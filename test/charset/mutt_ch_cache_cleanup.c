@@ -0,0 +1,59 @@
+/**
+ * @file
+ * Test code for mutt_ch_cache_cleanup()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <iconv.h>
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_ch_cache_cleanup(void)
+{
+  // void mutt_ch_cache_cleanup(void);
+
+  {
+    mutt_ch_cache_cleanup();
+    TEST_CHECK_(1, "mutt_ch_cache_cleanup()");
+  }
+
+  {
+    iconv_t cd1 = mutt_ch_iconv_open("utf-8", "iso-8859-1", MUTT_ICONV_NO_FLAGS);
+    TEST_CHECK(cd1 != (iconv_t) -1);
+
+    /* The same conversion reuses the open handle */
+    iconv_t cd2 = mutt_ch_iconv_open("UTF-8", "latin1", MUTT_ICONV_NO_FLAGS);
+    TEST_CHECK(cd2 == cd1);
+
+    /* A handle that's been used is reset */
+    char in[] = "caf\xe9";
+    char out[16];
+    const char *ib = in;
+    size_t ibl = 4;
+    char *ob = out;
+    size_t obl = sizeof(out);
+    TEST_CHECK(iconv(cd2, (ICONV_CONST char **) &ib, &ibl, &ob, &obl) == 0);
+    TEST_CHECK(((ob - out) == 5) && (memcmp(out, "caf\xc3\xa9", 5) == 0));
+
+    mutt_ch_cache_cleanup();
+  }
+}
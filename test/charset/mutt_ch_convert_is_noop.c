@@ -0,0 +1,54 @@
+/**
+ * @file
+ * Test code for mutt_ch_convert_is_noop()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_ch_convert_is_noop(void)
+{
+  // bool mutt_ch_convert_is_noop(const char *str, const char *from, const char *to, uint8_t flags);
+
+  {
+    TEST_CHECK(!mutt_ch_convert_is_noop(NULL, "utf-8", "utf-8", MUTT_ICONV_NO_FLAGS));
+    TEST_CHECK(!mutt_ch_convert_is_noop("apple", NULL, "utf-8", MUTT_ICONV_NO_FLAGS));
+    TEST_CHECK(!mutt_ch_convert_is_noop("apple", "utf-8", NULL, MUTT_ICONV_NO_FLAGS));
+  }
+
+  {
+    TEST_CHECK(mutt_ch_convert_is_noop("apple", "us-ascii", "utf-8", MUTT_ICONV_NO_FLAGS));
+    TEST_CHECK(mutt_ch_convert_is_noop("apple", "ISO-8859-15", "UTF-8", MUTT_ICONV_NO_FLAGS));
+    TEST_CHECK(mutt_ch_convert_is_noop("caf\xc3\xa9", "utf-8", "utf-8", MUTT_ICONV_NO_FLAGS));
+  }
+
+  {
+    /* 8-bit text in another charset */
+    TEST_CHECK(!mutt_ch_convert_is_noop("caf\xe9", "iso-8859-1", "utf-8", MUTT_ICONV_NO_FLAGS));
+    /* invalid UTF-8: truncated, overlong, surrogate */
+    TEST_CHECK(!mutt_ch_convert_is_noop("caf\xc3", "utf-8", "utf-8", MUTT_ICONV_NO_FLAGS));
+    TEST_CHECK(!mutt_ch_convert_is_noop("\xc0\xaf", "utf-8", "utf-8", MUTT_ICONV_NO_FLAGS));
+    TEST_CHECK(!mutt_ch_convert_is_noop("\xed\xa0\x80", "utf-8", "utf-8", MUTT_ICONV_NO_FLAGS));
+    /* only conversions to UTF-8 are checked */
+    TEST_CHECK(!mutt_ch_convert_is_noop("apple", "us-ascii", "iso-8859-1", MUTT_ICONV_NO_FLAGS));
+  }
+}
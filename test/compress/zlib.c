@@ -45,6 +45,8 @@ void test_compress_zlib(void)
     // Degenerate tests
     TEST_CHECK(cops->compress(NULL, NULL, 0, NULL) == NULL);
     TEST_CHECK(cops->decompress(NULL, NULL, 0) == NULL);
+    TEST_CHECK(cops->dict_train(NULL, NULL, NULL, 0, NULL) == NULL);
+    TEST_CHECK(!cops->dict_load(NULL, NULL, 0));
     void *cctx = NULL;
     cops->close(NULL);
     TEST_CHECK_(1, "cops->close(NULL)");
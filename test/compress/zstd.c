@@ -23,6 +23,8 @@
 #define TEST_NO_MAIN
 #include "config.h"
 #include "acutest.h"
+#include <stdio.h>
+#include <string.h>
 #include "mutt/lib.h"
 #include "compress/lib.h"
 #include "common.h"
@@ -35,6 +37,8 @@ void test_compress_zstd(void)
   // void *open(short level);
   // void *compress(void *cctx, const char *data, size_t dlen, size_t *clen);
   // void *decompress(void *cctx, const char *cbuf, size_t clen);
+  // void *dict_train(void *cctx, const char *samples, const size_t *sizes, unsigned int count, size_t *dlen);
+  // bool  dict_load(void *cctx, const char *dict, size_t dlen);
   // void  close(void **cctx);
 
   const struct ComprOps *cops = compress_get_ops("zstd");
@@ -45,6 +49,8 @@ void test_compress_zstd(void)
     // Degenerate tests
     TEST_CHECK(cops->compress(NULL, NULL, 0, NULL) == NULL);
     TEST_CHECK(cops->decompress(NULL, NULL, 0) == NULL);
+    TEST_CHECK(cops->dict_train(NULL, NULL, NULL, 0, NULL) == NULL);
+    TEST_CHECK(!cops->dict_load(NULL, NULL, 0));
     void *cctx = NULL;
     cops->close(NULL);
     TEST_CHECK_(1, "cops->close(NULL)");
@@ -81,5 +87,56 @@ void test_compress_zstd(void)
     cops->close(&cctx);
   }
 
+  {
+    // Dictionary
+    struct Buffer samples = mutt_buffer_make(0);
+    size_t sizes[200];
+    char record[256];
+    for (int i = 0; i < mutt_array_size(sizes); i++)
+    {
+      sizes[i] = snprintf(record, sizeof(record),
+                          "From: user%d@example.com\nTo: list@example.org\n"
+                          "Subject: Re: [list] topic %d\nMessage-ID: <%d.%d@example.com>\n",
+                          i % 13, i * 7, i, i * 31);
+      mutt_buffer_addstr_n(&samples, record, sizes[i]);
+    }
+
+    void *cctx = cops->open(MIN_COMP_LEVEL);
+    TEST_CHECK(cctx != NULL);
+
+    // Not a dictionary
+    TEST_CHECK(!cops->dict_load(cctx, record, sizes[0]));
+
+    size_t dlen = 0;
+    void *dict = cops->dict_train(cctx, samples.data, sizes, mutt_array_size(sizes), &dlen);
+    if (TEST_CHECK(dict != NULL))
+    {
+      char *dcopy = mutt_mem_malloc(dlen);
+      memcpy(dcopy, dict, dlen);
+
+      size_t clen = 0;
+      void *cdata = cops->compress(cctx, samples.data, sizes[0], &clen);
+      TEST_CHECK(cdata != NULL);
+      char *ccopy = mutt_mem_malloc(clen);
+      memcpy(ccopy, cdata, clen);
+
+      // Dictionary frames can't be read without the dictionary
+      void *dctx = cops->open(MIN_COMP_LEVEL);
+      TEST_CHECK(cops->decompress(dctx, ccopy, clen) == NULL);
+
+      TEST_CHECK(cops->dict_load(dctx, dcopy, dlen));
+      void *ddata = cops->decompress(dctx, ccopy, clen);
+      TEST_CHECK(ddata != NULL);
+      TEST_CHECK(memcmp(ddata, samples.data, sizes[0]) == 0);
+
+      cops->close(&dctx);
+      FREE(&ccopy);
+      FREE(&dcopy);
+    }
+
+    cops->close(&cctx);
+    mutt_buffer_dealloc(&samples);
+  }
+
   compress_data_tests(cops, MIN_COMP_LEVEL, MAX_COMP_LEVEL);
 }
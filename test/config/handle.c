@@ -0,0 +1,101 @@
+/**
+ * @file
+ * Test code for the Config Handles
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "config/common.h"
+#include "config/lib.h"
+#include "core/lib.h"
+
+// clang-format off
+static struct ConfigDef Vars[] = {
+  { "Apple",      DT_BOOL,   false,      0, NULL, },
+  { "Banana",     DT_NUMBER, 42,         0, NULL, },
+  { "Cherry",     DT_STRING, IP "cherry", 0, NULL, },
+  { NULL },
+};
+// clang-format on
+
+void test_config_handle(void)
+{
+  struct ConfigSet *cs = cs_new(30);
+  if (!TEST_CHECK(cs != NULL))
+    return;
+
+  cs_register_type(cs, &cst_bool);
+  cs_register_type(cs, &cst_number);
+  cs_register_type(cs, &cst_string);
+  if (!TEST_CHECK(cs_register_variables(cs, Vars, 0)))
+  {
+    cs_free(&cs);
+    return;
+  }
+
+  NeoMutt = neomutt_new(cs);
+  struct ConfigSubset *sub = NeoMutt->sub;
+
+  struct ConfigHandle ch_apple = CONFIG_HANDLE("Apple");
+  struct ConfigHandle ch_banana = CONFIG_HANDLE("Banana");
+  struct ConfigHandle ch_cherry = CONFIG_HANDLE("Cherry");
+
+  // First read looks up the item
+  TEST_CHECK(cs_handle_bool(&ch_apple, sub) == false);
+  TEST_CHECK(cs_handle_number(&ch_banana, sub) == 42);
+  TEST_CHECK(mutt_str_equal(cs_handle_string(&ch_cherry, sub), "cherry"));
+  TEST_CHECK(ch_apple.sub == sub);
+  TEST_CHECK(ch_apple.generation == ConfigGeneration);
+
+  // Nothing has changed, so the cached value is used
+  const unsigned int gen = ConfigGeneration;
+  TEST_CHECK(cs_handle_number(&ch_banana, sub) == 42);
+  TEST_CHECK(ConfigGeneration == gen);
+
+  // Any change makes every handle look again
+  TEST_CHECK(CSR_RESULT(cs_subset_str_native_set(sub, "Banana", 99, NULL)) == CSR_SUCCESS);
+  TEST_CHECK(ConfigGeneration != gen);
+  TEST_CHECK(ch_apple.generation != ConfigGeneration);
+  TEST_CHECK(cs_handle_number(&ch_banana, sub) == 99);
+  TEST_CHECK(cs_handle_bool(&ch_apple, sub) == false);
+
+  TEST_CHECK(CSR_RESULT(cs_subset_str_string_set(sub, "Cherry", "damson", NULL)) == CSR_SUCCESS);
+  TEST_CHECK(mutt_str_equal(cs_handle_string(&ch_cherry, sub), "damson"));
+
+  TEST_CHECK(CSR_RESULT(cs_subset_str_reset(sub, "Apple", NULL)) == CSR_SUCCESS);
+  TEST_CHECK(CSR_RESULT(cs_subset_str_native_set(sub, "Apple", true, NULL)) == CSR_SUCCESS);
+  TEST_CHECK(cs_handle_bool(&ch_apple, sub) == true);
+
+  // A different subset sees its own value
+  struct ConfigSubset *sub2 = cs_subset_new("fruit", sub, NeoMutt->notify);
+  TEST_CHECK(cs_handle_number(&ch_banana, sub2) == 99);
+  TEST_CHECK(ch_banana.sub == sub2);
+
+  struct HashElem *he = cs_subset_create_inheritance(sub2, "Banana");
+  TEST_CHECK(CSR_RESULT(cs_subset_he_native_set(sub2, he, 7, NULL)) == CSR_SUCCESS);
+  TEST_CHECK(cs_handle_number(&ch_banana, sub2) == 7);
+  TEST_CHECK(cs_handle_number(&ch_banana, sub) == 99);
+
+  cs_subset_free(&sub2);
+  neomutt_free(&NeoMutt);
+  cs_free(&cs);
+}
@@ -0,0 +1,40 @@
+/**
+ * @file
+ * Test code for mutt_date_monotonic_us()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_date_monotonic_us(void)
+{
+  // uint64_t mutt_date_monotonic_us(void);
+
+  {
+    const uint64_t t1 = mutt_date_monotonic_us();
+    mutt_date_sleep_ms(10);
+    const uint64_t t2 = mutt_date_monotonic_us();
+    TEST_CHECK(t1 != 0);
+    TEST_CHECK(t2 >= (t1 + 10000));
+    TEST_MSG("t1 = %llu, t2 = %llu", (unsigned long long) t1, (unsigned long long) t2);
+  }
+}
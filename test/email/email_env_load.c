@@ -0,0 +1,80 @@
+/**
+ * @file
+ * Test code for email_env_load()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "email/lib.h"
+
+static int LoadCount = 0;
+
+static void test_env_load(struct Email *e)
+{
+  LoadCount++;
+  e->env->organization = mutt_str_dup((char *) e->env_rest);
+}
+
+void test_email_env_load(void)
+{
+  // void email_env_load(struct Email *e);
+
+  {
+    email_env_load(NULL);
+    TEST_CHECK_(1, "email_env_load(NULL)");
+  }
+
+  {
+    struct Email *e = email_new();
+    e->env = mutt_env_new();
+    email_env_load(e);
+    TEST_CHECK(e->env->organization == NULL);
+    email_free(&e);
+  }
+
+  {
+    LoadCount = 0;
+    struct Email *e = email_new();
+    e->env = mutt_env_new();
+    e->env_rest = (unsigned char *) mutt_str_dup("apple");
+    e->env_load = test_env_load;
+
+    email_env_load(e);
+    TEST_CHECK(LoadCount == 1);
+    TEST_CHECK(e->env_rest == NULL);
+    TEST_CHECK(mutt_str_equal(e->env->organization, "apple"));
+
+    email_env_load(e);
+    TEST_CHECK(LoadCount == 1);
+    email_free(&e);
+  }
+
+  {
+    struct Email *e = email_new();
+    e->env = mutt_env_new();
+    e->env_rest = (unsigned char *) mutt_str_dup("banana");
+    e->env_load = test_env_load;
+    email_free(&e);
+    TEST_CHECK_(1, "email_free() with an unloaded Envelope");
+  }
+}
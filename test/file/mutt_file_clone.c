@@ -0,0 +1,66 @@
+/**
+ * @file
+ * Test code for mutt_file_clone()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_file_clone(void)
+{
+  // int mutt_file_clone(int fd_in, int fd_out);
+
+  {
+    TEST_CHECK(mutt_file_clone(-1, 1) == -1);
+  }
+
+  {
+    TEST_CHECK(mutt_file_clone(0, -1) == -1);
+  }
+
+  {
+    static const char text[] = "From: alice@example.com\nSubject: clone\n\nHello\n";
+
+    FILE *fp_in = tmpfile();
+    FILE *fp_out = tmpfile();
+    TEST_CHECK(fp_in && fp_out);
+    fputs(text, fp_in);
+    fflush(fp_in);
+
+    int rc = mutt_file_clone(fileno(fp_in), fileno(fp_out));
+    TEST_CHECK((rc == 0) || (rc == 1));
+    TEST_MSG("rc = %d", rc);
+    if (rc == 0)
+    {
+      char buf[128] = { 0 };
+      rewind(fp_out);
+      size_t len = fread(buf, 1, sizeof(buf) - 1, fp_out);
+      TEST_CHECK(len == (sizeof(text) - 1));
+      TEST_CHECK(mutt_str_equal(buf, text));
+    }
+
+    fclose(fp_in);
+    fclose(fp_out);
+  }
+}
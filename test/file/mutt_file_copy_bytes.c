@@ -23,6 +23,7 @@
 #define TEST_NO_MAIN
 #include "config.h"
 #include "acutest.h"
+#include <stdio.h>
 #include "mutt/lib.h"
 
 void test_mutt_file_copy_bytes(void)
@@ -38,4 +39,42 @@ void test_mutt_file_copy_bytes(void)
     FILE fp = { 0 };
     TEST_CHECK(mutt_file_copy_bytes(&fp, NULL, 10) != 0);
   }
+
+  {
+    // Copy from the middle of a large file, some by the kernel, if it can
+    const size_t size = 200 * 1024;
+    char *data = mutt_mem_malloc(size);
+    for (size_t i = 0; i < size; i++)
+      data[i] = 'A' + (i % 19);
+
+    FILE *fp_in = tmpfile();
+    FILE *fp_out = tmpfile();
+    TEST_CHECK(fp_in && fp_out);
+    fwrite(data, 1, size, fp_in);
+    fseeko(fp_in, 1000, SEEK_SET);
+
+    const size_t len = 150 * 1024;
+    TEST_CHECK(mutt_file_copy_bytes(fp_in, fp_out, len) == 0);
+    TEST_CHECK(ftello(fp_in) == (off_t) (1000 + len));
+    TEST_CHECK(ftello(fp_out) == (off_t) len);
+
+    // The streams carry on from the end of the copy
+    TEST_CHECK(fgetc(fp_in) == data[1000 + len]);
+
+    char *buf = mutt_mem_calloc(1, len + 16);
+    rewind(fp_out);
+    TEST_CHECK(fread(buf, 1, len + 16, fp_out) == len);
+    TEST_CHECK(memcmp(buf, data + 1000, len) == 0);
+
+    // Asking for more than there is copies the rest
+    rewind(fp_out);
+    fseeko(fp_in, size - 100, SEEK_SET);
+    TEST_CHECK(mutt_file_copy_bytes(fp_in, fp_out, len) == 0);
+    TEST_CHECK(ftello(fp_out) == 100);
+
+    FREE(&buf);
+    fclose(fp_in);
+    fclose(fp_out);
+    FREE(&data);
+  }
 }
@@ -23,6 +23,8 @@
 #define TEST_NO_MAIN
 #include "config.h"
 #include "acutest.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include "mutt/lib.h"
 
 void test_mutt_file_copy_stream(void)
@@ -38,4 +40,62 @@ void test_mutt_file_copy_stream(void)
     FILE fp = { 0 };
     TEST_CHECK(mutt_file_copy_stream(&fp, NULL) != 0);
   }
+
+  {
+    // Large enough to be copied by the kernel, if it can
+    const size_t size = 300 * 1024;
+    char *data = mutt_mem_malloc(size);
+    for (size_t i = 0; i < size; i++)
+      data[i] = 'a' + (i % 23);
+
+    FILE *fp_in = tmpfile();
+    TEST_CHECK(fp_in != NULL);
+    fwrite(data, 1, size, fp_in);
+    rewind(fp_in);
+
+    // Part of the source has already been read, into stdio's buffer
+    char skip[10];
+    TEST_CHECK(fread(skip, 1, sizeof(skip), fp_in) == sizeof(skip));
+
+    for (int append = 0; append < 2; append++)
+    {
+      TEST_CASE(append ? "append" : "write");
+      FILE *fp_out = tmpfile();
+      TEST_CHECK(fp_out != NULL);
+      if (append)
+      {
+        /* Reopen the same file for appending */
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fileno(fp_out));
+        fp_out = freopen(path, "a+", fp_out);
+        if (!fp_out)
+          continue;
+      }
+
+      // Part of the destination hasn't been written yet
+      fputs("HEAD", fp_out);
+
+      fseeko(fp_in, sizeof(skip), SEEK_SET);
+      TEST_CHECK(mutt_file_copy_stream(fp_in, fp_out) == (int) (size - sizeof(skip)));
+      TEST_CHECK(feof(fp_in) || (ftello(fp_in) == (off_t) size));
+
+      // The streams carry on from the end of the copy
+      fputs("TAIL", fp_out);
+      fflush(fp_out);
+
+      const size_t out_size = 4 + size - sizeof(skip) + 4;
+      char *buf = mutt_mem_calloc(1, out_size + 16);
+      rewind(fp_out);
+      TEST_CHECK(fread(buf, 1, out_size + 16, fp_out) == out_size);
+      TEST_CHECK(memcmp(buf, "HEAD", 4) == 0);
+      TEST_CHECK(memcmp(buf + 4, data + sizeof(skip), size - sizeof(skip)) == 0);
+      TEST_CHECK(memcmp(buf + out_size - 4, "TAIL", 4) == 0);
+
+      FREE(&buf);
+      fclose(fp_out);
+    }
+
+    fclose(fp_in);
+    FREE(&data);
+  }
 }
@@ -23,6 +23,9 @@
 #define TEST_NO_MAIN
 #include "config.h"
 #include "acutest.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include "mutt/lib.h"
 
 void test_mutt_hash_delete(void)
@@ -58,6 +61,52 @@ void test_mutt_hash_delete(void)
     mutt_hash_insert(table, "banana", &dummy2);
     mutt_hash_insert(table, "cherry", &dummy3);
     mutt_hash_delete(table, "banana", NULL);
+    TEST_CHECK(!mutt_hash_find(table, "banana"));
+    TEST_CHECK(mutt_hash_find(table, "apple") == &dummy1);
+    TEST_CHECK(mutt_hash_find(table, "cherry") == &dummy3);
+    mutt_hash_free(&table);
+  }
+
+  {
+    // Deleting keys mustn't hide the others
+    char key[32];
+    struct HashTable *table = mutt_hash_new(16, MUTT_HASH_STRDUP_KEYS);
+    for (intptr_t i = 0; i < 5000; i++)
+    {
+      snprintf(key, sizeof(key), "key%ld", (long) i);
+      mutt_hash_insert(table, key, (void *) (i + 1));
+    }
+    for (intptr_t i = 0; i < 5000; i += 2)
+    {
+      snprintf(key, sizeof(key), "key%ld", (long) i);
+      mutt_hash_delete(table, key, NULL);
+    }
+    TEST_CHECK(table->num_keys == 2500);
+
+    bool ok = true;
+    for (intptr_t i = 0; i < 5000; i++)
+    {
+      snprintf(key, sizeof(key), "key%ld", (long) i);
+      void *data = mutt_hash_find(table, key);
+      ok &= ((i % 2) == 0) ? (data == NULL) : (data == (void *) (i + 1));
+    }
+    TEST_CHECK(ok);
+    mutt_hash_free(&table);
+  }
+
+  {
+    // Delete one of several duplicates
+    struct HashTable *table = mutt_hash_new(16, MUTT_HASH_ALLOW_DUPS);
+    mutt_hash_insert(table, "apple", &dummy1);
+    mutt_hash_insert(table, "apple", &dummy2);
+    mutt_hash_insert(table, "apple", &dummy3);
+    mutt_hash_delete(table, "apple", &dummy2);
+    struct HashElem *he = mutt_hash_find_bucket(table, "apple");
+    TEST_CHECK(he && (he->data == &dummy3));
+    TEST_CHECK(he && he->next && (he->next->data == &dummy1) && !he->next->next);
+    mutt_hash_delete(table, "apple", NULL);
+    TEST_CHECK(!mutt_hash_find(table, "apple"));
+    TEST_CHECK(table->num_keys == 0);
     mutt_hash_free(&table);
   }
 }
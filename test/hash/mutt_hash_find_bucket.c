@@ -49,7 +49,14 @@ void test_mutt_hash_find_bucket(void)
     mutt_hash_insert(table, "banana", &dummy2);
     mutt_hash_insert(table, "banana", &dummy3);
     mutt_hash_insert(table, "cherry", &dummy3);
-    mutt_hash_find_bucket(table, "banana");
+    struct HashElem *he = mutt_hash_find_bucket(table, "banana");
+    int count = 0;
+    for (; he; he = he->next)
+    {
+      TEST_CHECK(mutt_str_equal(he->key.strkey, "banana"));
+      count++;
+    }
+    TEST_CHECK(count == 3);
     mutt_hash_free(&table);
   }
 }
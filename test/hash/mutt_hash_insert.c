@@ -23,6 +23,9 @@
 #define TEST_NO_MAIN
 #include "config.h"
 #include "acutest.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include "mutt/lib.h"
 
 void test_mutt_hash_insert(void)
@@ -44,4 +47,36 @@ void test_mutt_hash_insert(void)
     TEST_CHECK(mutt_hash_insert(table, "apple", NULL) != NULL);
     mutt_hash_free(&table);
   }
+
+  {
+    struct HashTable *table = mutt_hash_new(10, MUTT_HASH_STRDUP_KEYS);
+    TEST_CHECK(mutt_hash_insert(table, "apple", "banana") != NULL);
+    TEST_CHECK(mutt_hash_insert(table, "apple", "cherry") == NULL);
+    TEST_CHECK(mutt_str_equal(mutt_hash_find(table, "apple"), "banana"));
+    mutt_hash_free(&table);
+  }
+
+  {
+    // Many more keys than the table was created for
+    char key[32];
+    struct HashTable *table = mutt_hash_new(10, MUTT_HASH_STRDUP_KEYS);
+    for (intptr_t i = 0; i < 50000; i++)
+    {
+      snprintf(key, sizeof(key), "<%ld@example.com>", (long) i);
+      mutt_hash_insert(table, key, (void *) i);
+    }
+    TEST_CHECK(table->num_keys == 50000);
+    TEST_CHECK(table->num_keys * 10 <= table->num_elems * 7);
+
+    bool found = true;
+    for (intptr_t i = 0; i < 50000; i++)
+    {
+      snprintf(key, sizeof(key), "<%ld@example.com>", (long) i);
+      struct HashElem *he = mutt_hash_find_elem(table, key);
+      found &= (he && (he->data == (void *) i));
+    }
+    TEST_CHECK(found);
+    TEST_CHECK(!mutt_hash_find(table, "<50000@example.com>"));
+    mutt_hash_free(&table);
+  }
 }
@@ -0,0 +1,63 @@
+/**
+ * @file
+ * Test code for mutt_intern_release()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_intern_release(void)
+{
+  // void mutt_intern_release(char **ptr);
+
+  {
+    mutt_intern_release(NULL);
+    TEST_CHECK_(1, "mutt_intern_release(NULL)");
+  }
+
+  {
+    char *str = NULL;
+    mutt_intern_release(&str);
+    TEST_CHECK_(1, "mutt_intern_release(&str)");
+  }
+
+  {
+    // The string lives until the last reference is released
+    char *a = mutt_intern_get("apple");
+    char *b = mutt_intern_get("apple");
+    mutt_intern_release(&a);
+    TEST_CHECK(a == NULL);
+    TEST_CHECK(mutt_str_equal(b, "apple"));
+    mutt_intern_release(&b);
+    TEST_CHECK(b == NULL);
+  }
+
+  {
+    // An ordinary copy, with the same text, is simply freed
+    char *shared = mutt_intern_get("banana");
+    char *copy = mutt_str_dup("banana");
+    mutt_intern_release(&copy);
+    TEST_CHECK(copy == NULL);
+    TEST_CHECK(mutt_str_equal(shared, "banana"));
+    mutt_intern_release(&shared);
+  }
+}
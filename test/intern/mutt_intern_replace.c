@@ -0,0 +1,53 @@
+/**
+ * @file
+ * Test code for mutt_intern_replace()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_intern_replace(void)
+{
+  // void mutt_intern_replace(char **ptr);
+
+  {
+    mutt_intern_replace(NULL);
+    TEST_CHECK_(1, "mutt_intern_replace(NULL)");
+  }
+
+  {
+    char *a = mutt_str_dup("cherry");
+    char *b = mutt_str_dup("cherry");
+    mutt_intern_replace(&a);
+    mutt_intern_replace(&b);
+    TEST_CHECK(mutt_str_equal(a, "cherry"));
+    TEST_CHECK(a == b);
+
+    // Replacing a shared string changes nothing
+    char *c = a;
+    mutt_intern_replace(&c);
+    TEST_CHECK(c == a);
+
+    mutt_intern_release(&a);
+    mutt_intern_release(&b);
+  }
+}
@@ -0,0 +1,91 @@
+/**
+ * @file
+ * Test code for log_file_flush()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+
+void test_log_file_flush(void)
+{
+  // void log_file_flush(void);
+
+  {
+    log_file_flush();
+    TEST_CHECK_(1, "log_file_flush()");
+  }
+
+  {
+    // Every line reaches the file, in order
+    char path[] = "/tmp/neomutt-test-log-XXXXXX";
+    int fd = mkstemp(path);
+    TEST_CHECK(fd >= 0);
+    close(fd);
+
+    TEST_CHECK(log_file_set_level(LL_DEBUG2, false) == 0);
+    TEST_CHECK(log_file_set_filename(path, false) == 0);
+
+    char big[8192];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+
+    for (int i = 0; i < 20000; i++)
+      log_disp_file(0, "test.c", 0, "test", LL_DEBUG1, "line %d\n", i);
+    log_disp_file(0, "test.c", 0, "test", LL_DEBUG1, "big %s\n", big);
+    log_disp_file(0, "test.c", 0, "test", LL_DEBUG3, "ignored\n");
+    log_file_flush();
+
+    FILE *fp = fopen(path, "r");
+    TEST_CHECK(fp != NULL);
+    char line[10240];
+    int next = 0;
+    bool ok = true;
+    bool found_big = false;
+    while (fp && fgets(line, sizeof(line), fp))
+    {
+      const char *p = strstr(line, "test() ");
+      if (!p)
+        continue;
+      p += 7;
+      if (mutt_str_startswith(p, "line "))
+        ok &= (atoi(p + 5) == next++);
+      else if (mutt_str_startswith(p, "big "))
+        found_big = (strlen(p) == (4 + sizeof(big)));
+      else
+        ok = false;
+    }
+    if (fp)
+      fclose(fp);
+
+    TEST_CHECK(ok);
+    TEST_CHECK(next == 20000);
+    TEST_MSG("lines = %d", next);
+    TEST_CHECK(found_big);
+
+    log_file_close(false);
+    log_file_set_level(LL_MESSAGE, false);
+    unlink(path);
+  }
+}
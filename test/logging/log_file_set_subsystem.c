@@ -0,0 +1,79 @@
+/**
+ * @file
+ * Test code for log_file_set_subsystem()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_log_file_set_subsystem(void)
+{
+  // int log_file_set_subsystem(const char *name, enum LogLevel level);
+
+  {
+    TEST_CHECK(log_file_set_subsystem(NULL, LL_DEBUG1) == -1);
+    TEST_CHECK(log_file_set_subsystem("", LL_DEBUG1) == -1);
+    TEST_CHECK(log_file_set_subsystem("imap/auth", LL_DEBUG1) == -1);
+    TEST_CHECK(log_file_set_subsystem("imap", LL_ERROR) == -1);
+    TEST_CHECK(log_file_set_subsystem("imap", LL_MAX) == -1);
+  }
+
+  {
+    // A subsystem's level overrides the file's level
+    TEST_CHECK(log_file_set_level(LL_DEBUG1, false) == 0);
+    TEST_CHECK(log_file_set_subsystem("imap", LL_DEBUG5) == 0);
+    TEST_CHECK(log_file_set_subsystem("conn", LL_MESSAGE) == 0);
+
+    TEST_CHECK(log_file_wanted("../imap/command.c", LL_DEBUG5));
+    TEST_CHECK(log_file_wanted("imap/command.c", LL_DEBUG5));
+    TEST_CHECK(!log_file_wanted("../imap/command.c", LL_NOTIFY));
+    TEST_CHECK(!log_file_wanted("../maildir/maildir.c", LL_DEBUG2));
+    TEST_CHECK(log_file_wanted("../maildir/maildir.c", LL_DEBUG1));
+    TEST_CHECK(!log_file_wanted("main.c", LL_DEBUG2));
+    TEST_CHECK(!log_file_wanted("../conn/socket.c", LL_DEBUG1));
+    TEST_CHECK(log_file_wanted("../conn/socket.c", LL_ERROR));
+    TEST_CHECK(!log_file_wanted("../xyzimap/foo.c", LL_DEBUG5));
+
+    // Setting a subsystem again changes its level
+    TEST_CHECK(log_file_set_subsystem("imap", LL_DEBUG2) == 0);
+    TEST_CHECK(!log_file_wanted("../imap/command.c", LL_DEBUG3));
+
+    log_file_clear_subsystems();
+    TEST_CHECK(!log_file_wanted("../imap/command.c", LL_DEBUG2));
+    TEST_CHECK(log_file_wanted("../imap/command.c", LL_DEBUG1));
+  }
+
+  {
+    // There's a limit to the number of subsystems
+    char name[16];
+    int rc = 0;
+    for (int i = 0; i < 20; i++)
+    {
+      snprintf(name, sizeof(name), "sub%d", i);
+      rc += log_file_set_subsystem(name, LL_DEBUG2);
+    }
+    TEST_CHECK(rc == -4);
+    log_file_clear_subsystems();
+  }
+
+  log_file_set_level(LL_MESSAGE, false);
+}
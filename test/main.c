@@ -34,6 +34,9 @@
   /* account */                                                                \
   NEOMUTT_TEST_ITEM(test_account_free)                                         \
   NEOMUTT_TEST_ITEM(test_account_mailbox_add)                                  \
+  NEOMUTT_TEST_ITEM(test_account_mailbox_find)                                 \
+  NEOMUTT_TEST_ITEM(test_account_mailbox_find_name)                            \
+  NEOMUTT_TEST_ITEM(test_account_mailbox_rehash)                               \
   NEOMUTT_TEST_ITEM(test_account_mailbox_remove)                               \
   NEOMUTT_TEST_ITEM(test_account_new)                                          \
                                                                                \
@@ -82,6 +85,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_b64_buffer_decode)                               \
   NEOMUTT_TEST_ITEM(test_mutt_b64_buffer_encode)                               \
   NEOMUTT_TEST_ITEM(test_mutt_b64_decode)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_b64_decode_stream)                               \
   NEOMUTT_TEST_ITEM(test_mutt_b64_encode)                                      \
                                                                                \
   /* body */                                                                   \
@@ -106,6 +110,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_buffer_make)                                     \
   NEOMUTT_TEST_ITEM(test_mutt_buffer_pool_free)                                \
   NEOMUTT_TEST_ITEM(test_mutt_buffer_pool_get)                                 \
+  NEOMUTT_TEST_ITEM(test_mutt_buffer_pool_get_size)                            \
   NEOMUTT_TEST_ITEM(test_mutt_buffer_pool_release)                             \
   NEOMUTT_TEST_ITEM(test_mutt_buffer_printf)                                   \
   NEOMUTT_TEST_ITEM(test_mutt_buffer_reset)                                    \
@@ -115,12 +120,14 @@
   NEOMUTT_TEST_ITEM(test_mutt_buffer_substrcpy)                                \
                                                                                \
   /* charset */                                                                \
+  NEOMUTT_TEST_ITEM(test_mutt_ch_cache_cleanup)                                \
   NEOMUTT_TEST_ITEM(test_mutt_ch_canonical_charset)                            \
   NEOMUTT_TEST_ITEM(test_mutt_ch_charset_lookup)                               \
   NEOMUTT_TEST_ITEM(test_mutt_ch_check)                                        \
   NEOMUTT_TEST_ITEM(test_mutt_ch_check_charset)                                \
   NEOMUTT_TEST_ITEM(test_mutt_ch_choose)                                       \
   NEOMUTT_TEST_ITEM(test_mutt_ch_chscmp)                                       \
+  NEOMUTT_TEST_ITEM(test_mutt_ch_convert_is_noop)                              \
   NEOMUTT_TEST_ITEM(test_mutt_ch_convert_nonmime_string)                       \
   NEOMUTT_TEST_ITEM(test_mutt_ch_convert_string)                               \
   NEOMUTT_TEST_ITEM(test_mutt_ch_fgetconv)                                     \
@@ -142,6 +149,7 @@
   NEOMUTT_TEST_ITEM(test_config_bool)                                          \
   NEOMUTT_TEST_ITEM(test_config_dump)                                          \
   NEOMUTT_TEST_ITEM(test_config_enum)                                          \
+  NEOMUTT_TEST_ITEM(test_config_handle)                                        \
   NEOMUTT_TEST_ITEM(test_config_helpers)                                       \
   NEOMUTT_TEST_ITEM(test_config_initial)                                       \
   NEOMUTT_TEST_ITEM(test_config_long)                                          \
@@ -171,6 +179,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_date_make_imap)                                  \
   NEOMUTT_TEST_ITEM(test_mutt_date_make_time)                                  \
   NEOMUTT_TEST_ITEM(test_mutt_date_make_tls)                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_date_monotonic_us)                               \
   NEOMUTT_TEST_ITEM(test_mutt_date_normalize_time)                             \
   NEOMUTT_TEST_ITEM(test_mutt_date_parse_date)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_date_parse_imap)                                 \
@@ -178,6 +187,7 @@
                                                                                \
   /* email */                                                                  \
   NEOMUTT_TEST_ITEM(test_email_cmp_strict)                                     \
+  NEOMUTT_TEST_ITEM(test_email_env_load)                                       \
   NEOMUTT_TEST_ITEM(test_email_free)                                           \
   NEOMUTT_TEST_ITEM(test_email_new)                                            \
   NEOMUTT_TEST_ITEM(test_email_size)                                           \
@@ -215,6 +225,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_file_chmod_add_stat)                             \
   NEOMUTT_TEST_ITEM(test_mutt_file_chmod_rm)                                   \
   NEOMUTT_TEST_ITEM(test_mutt_file_chmod_rm_stat)                              \
+  NEOMUTT_TEST_ITEM(test_mutt_file_clone)                                      \
   NEOMUTT_TEST_ITEM(test_mutt_file_copy_bytes)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_file_copy_stream)                                \
   NEOMUTT_TEST_ITEM(test_mutt_file_decrease_mtime)                             \
@@ -231,6 +242,7 @@
   NEOMUTT_TEST_ITEM(test_mutt_file_mkstemp_full)                               \
   NEOMUTT_TEST_ITEM(test_mutt_file_open)                                       \
   NEOMUTT_TEST_ITEM(test_mutt_file_quote_filename)                             \
+  NEOMUTT_TEST_ITEM(test_mutt_file_readahead)                                  \
   NEOMUTT_TEST_ITEM(test_mutt_file_read_keyword)                               \
   NEOMUTT_TEST_ITEM(test_mutt_file_read_line)                                  \
   NEOMUTT_TEST_ITEM(test_mutt_file_rename)                                     \
@@ -308,6 +320,11 @@
   NEOMUTT_TEST_ITEM(test_mutt_idna_print_version)                              \
   NEOMUTT_TEST_ITEM(test_mutt_idna_to_ascii_lz)                                \
                                                                                \
+  /* intern */                                                                 \
+  NEOMUTT_TEST_ITEM(test_mutt_intern_get)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_intern_release)                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_intern_replace)                                  \
+                                                                               \
   /* list */                                                                   \
   NEOMUTT_TEST_ITEM(test_mutt_list_clear)                                      \
   NEOMUTT_TEST_ITEM(test_mutt_list_compare)                                    \
@@ -326,10 +343,12 @@
   NEOMUTT_TEST_ITEM(test_log_disp_queue)                                       \
   NEOMUTT_TEST_ITEM(test_log_disp_terminal)                                    \
   NEOMUTT_TEST_ITEM(test_log_file_close)                                       \
+  NEOMUTT_TEST_ITEM(test_log_file_flush)                                       \
   NEOMUTT_TEST_ITEM(test_log_file_open)                                        \
   NEOMUTT_TEST_ITEM(test_log_file_running)                                     \
   NEOMUTT_TEST_ITEM(test_log_file_set_filename)                                \
   NEOMUTT_TEST_ITEM(test_log_file_set_level)                                   \
+  NEOMUTT_TEST_ITEM(test_log_file_set_subsystem)                               \
   NEOMUTT_TEST_ITEM(test_log_file_set_version)                                 \
   NEOMUTT_TEST_ITEM(test_log_queue_add)                                        \
   NEOMUTT_TEST_ITEM(test_log_queue_empty)                                      \
@@ -354,6 +373,8 @@
   NEOMUTT_TEST_ITEM(test_mutt_map_get_value_n)                                 \
                                                                                \
   /* mbyte */                                                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_mb_ascii_span)                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_mb_buffer_filter_unprintable)                    \
   NEOMUTT_TEST_ITEM(test_mutt_mb_charlen)                                      \
   NEOMUTT_TEST_ITEM(test_mutt_mb_filter_unprintable)                           \
   NEOMUTT_TEST_ITEM(test_mutt_mb_get_initials)                                 \
@@ -391,6 +412,8 @@
   NEOMUTT_TEST_ITEM(test_neomutt_new)                                          \
                                                                                \
   /* notify */                                                                 \
+  NEOMUTT_TEST_ITEM(test_notify_batch_begin)                                   \
+  NEOMUTT_TEST_ITEM(test_notify_batch_end)                                     \
   NEOMUTT_TEST_ITEM(test_notify_free)                                          \
   NEOMUTT_TEST_ITEM(test_notify_new)                                           \
   NEOMUTT_TEST_ITEM(test_notify_observer_add)                                  \
@@ -419,6 +442,8 @@
   NEOMUTT_TEST_ITEM(test_mutt_parse_multipart)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_parse_part)                                      \
   NEOMUTT_TEST_ITEM(test_mutt_read_mime_header)                                \
+  NEOMUTT_TEST_ITEM(test_mutt_rfc822_finish_header)                            \
+  NEOMUTT_TEST_ITEM(test_mutt_rfc822_parse_header)                             \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_parse_line)                               \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_parse_message)                            \
   NEOMUTT_TEST_ITEM(test_mutt_rfc822_read_header)                              \
@@ -444,12 +469,18 @@
   /* pattern */                                                                \
   NEOMUTT_TEST_ITEM(test_mutt_pattern_comp)                                    \
                                                                                \
+  /* prefix */                                                                 \
+  NEOMUTT_TEST_ITEM(test_mutt_prefixset_find)                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_prefixset_free)                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_prefixset_new)                                   \
+                                                                               \
   /* prex */                                                                   \
   NEOMUTT_TEST_ITEM(test_mutt_prex_capture)                                    \
   NEOMUTT_TEST_ITEM(test_mutt_prex_free)                                       \
                                                                                \
   /* regex */                                                                  \
   NEOMUTT_TEST_ITEM(test_mutt_regex_capture)                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_regex_check)                                     \
   NEOMUTT_TEST_ITEM(test_mutt_regex_compile)                                   \
   NEOMUTT_TEST_ITEM(test_mutt_regex_free)                                      \
   NEOMUTT_TEST_ITEM(test_mutt_regex_match)                                     \
@@ -459,6 +490,11 @@
   NEOMUTT_TEST_ITEM(test_mutt_regexlist_match)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_regexlist_new)                                   \
   NEOMUTT_TEST_ITEM(test_mutt_regexlist_remove)                                \
+  NEOMUTT_TEST_ITEM(test_mutt_regexset_add)                                    \
+  NEOMUTT_TEST_ITEM(test_mutt_regexset_free)                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_regexset_is_empty)                               \
+  NEOMUTT_TEST_ITEM(test_mutt_regexset_match)                                  \
+  NEOMUTT_TEST_ITEM(test_mutt_regexset_remove)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_replacelist_add)                                 \
   NEOMUTT_TEST_ITEM(test_mutt_replacelist_apply)                               \
   NEOMUTT_TEST_ITEM(test_mutt_replacelist_free)                                \
@@ -488,6 +524,10 @@
   NEOMUTT_TEST_ITEM(test_mutt_sig_unblock)                                     \
   NEOMUTT_TEST_ITEM(test_mutt_sig_unblock_system)                              \
                                                                                \
+  /* slab */                                                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_slab_alloc)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_slab_free)                                       \
+                                                                               \
   /* slist */                                                                  \
   NEOMUTT_TEST_ITEM(test_slist_add_list)                                       \
   NEOMUTT_TEST_ITEM(test_slist_add_string)                                     \
@@ -560,6 +600,9 @@
   NEOMUTT_TEST_ITEM(test_thread_hash_destructor)                               \
   NEOMUTT_TEST_ITEM(test_unlink_message)                                       \
                                                                                \
+  /* trace */                                                                  \
+  NEOMUTT_TEST_ITEM(test_trace_open)                                           \
+                                                                               \
   /* url */                                                                    \
   NEOMUTT_TEST_ITEM(test_url_check_scheme)                                     \
   NEOMUTT_TEST_ITEM(test_url_free)                                             \
@@ -567,7 +610,16 @@
   NEOMUTT_TEST_ITEM(test_url_pct_decode)                                       \
   NEOMUTT_TEST_ITEM(test_url_pct_encode)                                       \
   NEOMUTT_TEST_ITEM(test_url_tobuffer)                                         \
-  NEOMUTT_TEST_ITEM(test_url_tostring)
+  NEOMUTT_TEST_ITEM(test_url_tostring)                                         \
+                                                                               \
+  /* worker */                                                                 \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_count)                                    \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_done)                                     \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_run)                                      \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_set_threads)                              \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_stop)                                     \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_submit)                                   \
+  NEOMUTT_TEST_ITEM(test_mutt_worker_wait)
 
 /******************************************************************************
  * You probably don't need to touch what follows.
@@ -581,6 +633,9 @@ NEOMUTT_TEST_LIST
 #ifdef USE_LZ4
   NEOMUTT_TEST_ITEM(test_compress_lz4)
 #endif
+#ifdef USE_PCRE2_REGEX
+  NEOMUTT_TEST_ITEM(test_mutt_pcre2_regexec)
+#endif
 #ifdef USE_NOTMUCH
   NEOMUTT_TEST_ITEM(test_nm_parse_type_from_query)
   NEOMUTT_TEST_ITEM(test_nm_query_type_to_string)
@@ -631,6 +686,9 @@ NEOMUTT_TEST_ITEM(test_compress_common)
 #ifdef USE_LZ4
   NEOMUTT_TEST_ITEM(test_compress_lz4)
 #endif
+#ifdef USE_PCRE2_REGEX
+  NEOMUTT_TEST_ITEM(test_mutt_pcre2_regexec)
+#endif
 #ifdef USE_NOTMUCH
   NEOMUTT_TEST_ITEM(test_nm_parse_type_from_query)
   NEOMUTT_TEST_ITEM(test_nm_query_type_to_string)
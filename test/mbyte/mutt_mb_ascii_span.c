@@ -0,0 +1,71 @@
+/**
+ * @file
+ * Test code for mutt_mb_ascii_span()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <string.h>
+#include "mutt/lib.h"
+
+void test_mutt_mb_ascii_span(void)
+{
+  // size_t mutt_mb_ascii_span(const char *s, size_t n);
+
+  {
+    TEST_CHECK(mutt_mb_ascii_span(NULL, 10) == 0);
+    TEST_CHECK(mutt_mb_ascii_span("apple", 0) == 0);
+  }
+
+  {
+    const char *str = "The quick brown fox jumps over the lazy dog";
+    TEST_CHECK(mutt_mb_ascii_span(str, strlen(str)) == strlen(str));
+    TEST_CHECK(mutt_mb_ascii_span(str, 11) == 11);
+  }
+
+  {
+    // Every position of a bad byte, in and around the first two words
+    const char bad[] = { '\0', '\t', '\n', '\033', 0x1f,
+                         0x7f, (char) 0x80, (char) 0xc3, (char) 0xff };
+    for (size_t b = 0; b < sizeof(bad); b++)
+    {
+      for (size_t pos = 0; pos < 20; pos++)
+      {
+        char str[32];
+        memset(str, 'x', sizeof(str));
+        str[pos] = bad[b];
+        TEST_CHECK(mutt_mb_ascii_span(str, sizeof(str)) == pos);
+        TEST_MSG("byte 0x%02x, position %zu", (unsigned char) bad[b], pos);
+      }
+    }
+  }
+
+  {
+    // The edges of the printable range
+    const char *str = " ~~         ~";
+    TEST_CHECK(mutt_mb_ascii_span(str, strlen(str)) == strlen(str));
+  }
+
+  {
+    const char *str = "caf\xc3\xa9 au lait";
+    TEST_CHECK(mutt_mb_ascii_span(str, strlen(str)) == 3);
+  }
+}
@@ -0,0 +1,51 @@
+/**
+ * @file
+ * Test code for mutt_mb_buffer_filter_unprintable()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "test_common.h"
+
+void test_mutt_mb_buffer_filter_unprintable(void)
+{
+  // void mutt_mb_buffer_filter_unprintable(struct Buffer *buf, const char *s);
+
+  {
+    mutt_mb_buffer_filter_unprintable(NULL, "apple");
+    TEST_CHECK_(1, "mutt_mb_buffer_filter_unprintable(NULL, \"apple\")");
+  }
+
+  {
+    struct Buffer buf = mutt_buffer_make(0);
+    mutt_mb_buffer_filter_unprintable(&buf, NULL);
+    TEST_CHECK(mutt_buffer_is_empty(&buf));
+  }
+
+  {
+    struct Buffer buf = mutt_buffer_make(0);
+    mutt_buffer_addstr(&buf, "Subject: ");
+    mutt_mb_buffer_filter_unprintable(&buf, "one\ttwo\x01three");
+    TEST_CHECK_STR_EQ("Subject: one?two?three", mutt_buffer_string(&buf));
+    mutt_buffer_dealloc(&buf);
+  }
+}
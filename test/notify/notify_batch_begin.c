@@ -0,0 +1,69 @@
+/**
+ * @file
+ * Test code for notify_batch_begin()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static int NumEvents = 0;
+
+static int count_observer(struct NotifyCallback *nc)
+{
+  NumEvents++;
+  return 0;
+}
+
+void test_notify_batch_begin(void)
+{
+  // bool notify_batch_begin(struct Notify *notify);
+
+  {
+    TEST_CHECK(!notify_batch_begin(NULL));
+  }
+
+  {
+    struct Notify *parent = notify_new();
+    struct Notify *child = notify_new();
+    notify_set_parent(child, parent);
+    notify_observer_add(parent, NT_ALL, count_observer, NULL);
+
+    NumEvents = 0;
+    TEST_CHECK(notify_batch_begin(parent));
+
+    // Events without data are held back
+    TEST_CHECK(notify_send(child, NT_ATTACH, 1, NULL));
+    TEST_CHECK(notify_send(child, NT_ATTACH, 1, NULL));
+    TEST_CHECK(NumEvents == 0);
+
+    // Events with data are sent at once
+    int data = 42;
+    TEST_CHECK(notify_send(child, NT_ATTACH, 1, &data));
+    TEST_CHECK(NumEvents == 1);
+
+    TEST_CHECK(notify_batch_end(parent));
+    TEST_CHECK(NumEvents == 2);
+
+    notify_free(&child);
+    notify_free(&parent);
+  }
+}
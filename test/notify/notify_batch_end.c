@@ -0,0 +1,79 @@
+/**
+ * @file
+ * Test code for notify_batch_end()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static int Events[8] = { 0 };
+static int NumEvents = 0;
+
+static int record_observer(struct NotifyCallback *nc)
+{
+  if (NumEvents < 8)
+    Events[NumEvents++] = nc->event_subtype;
+  return 0;
+}
+
+void test_notify_batch_end(void)
+{
+  // bool notify_batch_end(struct Notify *notify);
+
+  {
+    TEST_CHECK(!notify_batch_end(NULL));
+  }
+
+  {
+    struct Notify *notify = notify_new();
+    TEST_CHECK(!notify_batch_end(notify));
+    notify_free(&notify);
+  }
+
+  {
+    struct Notify *notify = notify_new();
+    notify_observer_add(notify, NT_ALL, record_observer, NULL);
+
+    NumEvents = 0;
+    TEST_CHECK(notify_batch_begin(notify));
+    TEST_CHECK(notify_batch_begin(notify));
+    notify_send(notify, NT_ATTACH, 2, NULL);
+    notify_send(notify, NT_ATTACH, 1, NULL);
+    notify_send(notify, NT_ATTACH, 2, NULL);
+
+    // The inner batch doesn't send anything
+    TEST_CHECK(notify_batch_end(notify));
+    TEST_CHECK(NumEvents == 0);
+
+    // Duplicates are merged, in the order they first arrived
+    TEST_CHECK(notify_batch_end(notify));
+    TEST_CHECK(NumEvents == 2);
+    TEST_CHECK(Events[0] == 2);
+    TEST_CHECK(Events[1] == 1);
+
+    // Once the batch has ended, events are sent at once
+    notify_send(notify, NT_ATTACH, 1, NULL);
+    TEST_CHECK(NumEvents == 3);
+
+    notify_free(&notify);
+  }
+}
@@ -0,0 +1,46 @@
+/**
+ * @file
+ * Test code for mutt_rfc822_finish_header()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "email/lib.h"
+
+void test_mutt_rfc822_finish_header(void)
+{
+  // void mutt_rfc822_finish_header(struct Envelope *env, struct Email *e);
+
+  {
+    struct Email e = { 0 };
+    mutt_rfc822_finish_header(NULL, &e);
+    TEST_CHECK_(1, "mutt_rfc822_finish_header(NULL, &e)");
+  }
+
+  {
+    struct Envelope env = { 0 };
+    mutt_rfc822_finish_header(&env, NULL);
+    TEST_CHECK_(1, "mutt_rfc822_finish_header(&env, NULL)");
+  }
+}
@@ -0,0 +1,52 @@
+/**
+ * @file
+ * Test code for mutt_rfc822_parse_header()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+#include "address/lib.h"
+#include "email/lib.h"
+
+void test_mutt_rfc822_parse_header(void)
+{
+  // bool mutt_rfc822_parse_header(struct Envelope *env, struct Email *e, char *line, bool user_hdrs, bool weed);
+
+  {
+    char line[] = "Subject: apple";
+    TEST_CHECK(!mutt_rfc822_parse_header(NULL, NULL, line, false, false));
+  }
+
+  {
+    struct Envelope *env = mutt_env_new();
+    TEST_CHECK(!mutt_rfc822_parse_header(env, NULL, NULL, false, false));
+    mutt_env_free(&env);
+  }
+
+  {
+    struct Envelope *env = mutt_env_new();
+    char line[] = "apple banana";
+    TEST_CHECK(!mutt_rfc822_parse_header(env, NULL, line, false, false));
+    mutt_env_free(&env);
+  }
+}
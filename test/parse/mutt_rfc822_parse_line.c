@@ -58,4 +58,35 @@ void test_mutt_rfc822_parse_line(void)
     struct Email e = { 0 };
     TEST_CHECK(mutt_rfc822_parse_line(&envelope, &e, "apple", NULL, false, false, false) == 0);
   }
+
+  {
+    /* Header names are matched whatever their case */
+    static const char *known[] = { "Subject", "SUBJECT", "subject", "To",
+                                   "X-Label", "x-LABEL", "Mail-Followup-To",
+                                   "List-Post", "MIME-Version", NULL };
+    for (int i = 0; known[i]; i++)
+    {
+      struct Envelope *env = mutt_env_new();
+      char value[] = "banana";
+      TEST_CHECK(mutt_rfc822_parse_line(env, NULL, (char *) known[i], value,
+                                        false, false, false) == 1);
+      TEST_MSG("%s", known[i]);
+      mutt_env_free(&env);
+    }
+  }
+
+  {
+    /* Names that are similar to known headers */
+    static const char *unknown[] = { "", "T", "Subjects", "Subjec", "Tutocrypt",
+                                     "X-Labels", "Mail-", "Xlabel", NULL };
+    for (int i = 0; unknown[i]; i++)
+    {
+      struct Envelope *env = mutt_env_new();
+      char value[] = "banana";
+      TEST_CHECK(mutt_rfc822_parse_line(env, NULL, (char *) unknown[i], value,
+                                        false, false, false) == 0);
+      TEST_MSG("%s", unknown[i]);
+      mutt_env_free(&env);
+    }
+  }
 }
@@ -29,21 +29,60 @@
 
 void test_mutt_rfc822_read_line(void)
 {
-  // char *mutt_rfc822_read_line(FILE *fp, char *line, size_t *linelen);
+  // size_t mutt_rfc822_read_line(FILE *fp, struct Buffer *buf);
 
   {
-    size_t linelen = 0;
-    TEST_CHECK(!mutt_rfc822_read_line(NULL, "apple", &linelen));
+    struct Buffer buf = mutt_buffer_make(0);
+    TEST_CHECK(mutt_rfc822_read_line(NULL, &buf) == 0);
   }
 
   {
     FILE fp = { 0 };
-    size_t linelen = 0;
-    TEST_CHECK(!mutt_rfc822_read_line(&fp, NULL, &linelen));
+    TEST_CHECK(mutt_rfc822_read_line(&fp, NULL) == 0);
   }
 
   {
-    FILE fp = { 0 };
-    TEST_CHECK(!mutt_rfc822_read_line(&fp, "apple", NULL));
+    static const char *header = "Subject: one\n"
+                                "\ttwo  \n"
+                                "    three\n"
+                                "To:   a@example.com \n"
+                                "\n"
+                                "Body: text\n";
+    FILE *fp = tmpfile();
+    TEST_CHECK(fp != NULL);
+    fputs(header, fp);
+    rewind(fp);
+
+    struct Buffer buf = mutt_buffer_make(0);
+    TEST_CHECK(mutt_rfc822_read_line(fp, &buf) == 30);
+    TEST_CHECK(mutt_str_equal(mutt_buffer_string(&buf), "Subject: one two three"));
+    TEST_MSG("Got: %s", mutt_buffer_string(&buf));
+    TEST_CHECK(mutt_rfc822_read_line(fp, &buf) == 21);
+    TEST_CHECK(mutt_str_equal(mutt_buffer_string(&buf), "To:   a@example.com"));
+    TEST_MSG("Got: %s", mutt_buffer_string(&buf));
+    TEST_CHECK(mutt_rfc822_read_line(fp, &buf) == 0);
+    TEST_CHECK(ftell(fp) == 52);
+
+    mutt_buffer_dealloc(&buf);
+    fclose(fp);
+  }
+
+  {
+    /* A field that's longer than the Buffer */
+    FILE *fp = tmpfile();
+    TEST_CHECK(fp != NULL);
+    fputs("X-Long: ", fp);
+    for (int i = 0; i < 1000; i++)
+      fputs("abcdefghij", fp);
+    fputs("\n\n", fp);
+    rewind(fp);
+
+    struct Buffer buf = mutt_buffer_make(0);
+    TEST_CHECK(mutt_rfc822_read_line(fp, &buf) == 10009);
+    TEST_CHECK(mutt_buffer_len(&buf) == 10008);
+    TEST_CHECK(mutt_rfc822_read_line(fp, &buf) == 0);
+
+    mutt_buffer_dealloc(&buf);
+    fclose(fp);
   }
 }
@@ -703,6 +703,18 @@ void test_mutt_pattern_comp(void)
                               .max = 0,
                               .p.str = NULL },
                             /* root->child */
+                            { .op = MUTT_PAT_SUBJECT,
+                              .pat_not = false,
+                              .all_addr = false,
+                              .string_match = true,
+                              .group_match = false,
+                              .ign_case = true,
+                              .is_alias = false,
+                              .is_multi = false,
+                              .min = 0,
+                              .max = 0,
+                              .p.str = "quux" },
+                            /* root->child->next */
                             { .op = MUTT_PAT_OR,
                               .pat_not = true,
                               .all_addr = false,
@@ -714,7 +726,7 @@ void test_mutt_pattern_comp(void)
                               .min = 0,
                               .max = 0,
                               .p.str = NULL },
-                            /* root->child->child */
+                            /* root->child->next->child */
                             { .op = MUTT_PAT_SUBJECT,
                               .pat_not = false,
                               .all_addr = false,
@@ -726,7 +738,7 @@ void test_mutt_pattern_comp(void)
                               .min = 0,
                               .max = 0,
                               .p.str = "foo" },
-                            /* root->child->child->next */
+                            /* root->child->next->child->next */
                             { .op = MUTT_PAT_SUBJECT,
                               .pat_not = false,
                               .all_addr = false,
@@ -737,9 +749,80 @@ void test_mutt_pattern_comp(void)
                               .is_multi = false,
                               .min = 0,
                               .max = 0,
-                              .p.str = "bar" },
+                              .p.str = "bar" }
+    };
+
+    SLIST_INIT(&expected);
+    SLIST_INSERT_HEAD(&expected, &e[0], entries);
+    struct PatternList child1, child2;
+    SLIST_INIT(&child1);
+    e[0].child = &child1;
+    SLIST_INSERT_HEAD(e[0].child, &e[1], entries);
+    SLIST_INSERT_AFTER(&e[1], &e[2], entries);
+    SLIST_INIT(&child2);
+    e[2].child = &child2;
+    SLIST_INSERT_HEAD(e[2].child, &e[3], entries);
+    SLIST_INSERT_AFTER(&e[3], &e[4], entries);
+
+    if (!TEST_CHECK(!cmp_pattern(pat, &expected)))
+    {
+      char s2[1024];
+      canonical_pattern(s2, &expected, 0);
+      TEST_MSG("Expected:\n%s", s2);
+      canonical_pattern(s2, pat, 0);
+      TEST_MSG("Actual:\n%s", s2);
+    }
+
+    char *msg = "";
+    if (!TEST_CHECK(!strcmp(err.data, msg)))
+    {
+      TEST_MSG("Expected: %s", msg);
+      TEST_MSG("Actual  : %s", err.data);
+    }
+
+    mutt_pattern_free(&pat);
+  }
+
+  {
+    char *s = "=b foo ~F";
+
+    mutt_buffer_reset(&err);
+    struct PatternList *pat = mutt_pattern_comp(NULL, NULL, s, MUTT_PC_FULL_MSG, &err);
+
+    if (!TEST_CHECK(pat != NULL))
+    {
+      TEST_MSG("Expected: pat != NULL");
+      TEST_MSG("Actual  : pat == NULL");
+    }
+
+    struct PatternList expected;
+
+    struct Pattern e[3] = { /* root */
+                            { .op = MUTT_PAT_AND,
+                              .pat_not = false,
+                              .all_addr = false,
+                              .string_match = false,
+                              .group_match = false,
+                              .ign_case = false,
+                              .is_alias = false,
+                              .is_multi = false,
+                              .min = 0,
+                              .max = 0,
+                              .p.str = NULL },
+                            /* root->child */
+                            { .op = MUTT_FLAG,
+                              .pat_not = false,
+                              .all_addr = false,
+                              .string_match = false,
+                              .group_match = false,
+                              .ign_case = false,
+                              .is_alias = false,
+                              .is_multi = false,
+                              .min = 0,
+                              .max = 0,
+                              .p.str = NULL },
                             /* root->child->next */
-                            { .op = MUTT_PAT_SUBJECT,
+                            { .op = MUTT_PAT_BODY,
                               .pat_not = false,
                               .all_addr = false,
                               .string_match = true,
@@ -749,20 +832,16 @@ void test_mutt_pattern_comp(void)
                               .is_multi = false,
                               .min = 0,
                               .max = 0,
-                              .p.str = "quux" }
+                              .p.str = "foo" }
     };
 
     SLIST_INIT(&expected);
     SLIST_INSERT_HEAD(&expected, &e[0], entries);
-    struct PatternList child1, child2;
-    SLIST_INIT(&child1);
-    e[0].child = &child1;
+    struct PatternList child;
+    SLIST_INIT(&child);
+    e[0].child = &child;
     SLIST_INSERT_HEAD(e[0].child, &e[1], entries);
-    SLIST_INIT(&child2);
-    e[1].child = &child2;
-    SLIST_INSERT_HEAD(e[1].child, &e[2], entries);
-    SLIST_INSERT_AFTER(&e[2], &e[3], entries);
-    SLIST_INSERT_AFTER(&e[1], &e[4], entries);
+    SLIST_INSERT_AFTER(&e[1], &e[2], entries);
 
     if (!TEST_CHECK(!cmp_pattern(pat, &expected)))
     {
@@ -783,5 +862,46 @@ void test_mutt_pattern_comp(void)
     mutt_pattern_free(&pat);
   }
 
+  {
+    static const struct
+    {
+      const char *pattern;
+      const char *literal;
+      bool exact;
+    } tests[] = {
+      // clang-format off
+      { "~s foo",            "foo",         true  },
+      { "~s 'foo\\.bar'",    "foo.bar",     true  },
+      { "~s 'ab.*cdef'",     "cdef",        false },
+      { "~s '^hello world'", "hello world", false },
+      { "~s 'colou?r'",      "colo",        false },
+      { "~s 'go+gle'",       "gle",         false },
+      { "~s 'x(ab|cd)long'", "long",        false },
+      { "~s '[abc]+'",       NULL,          false },
+      { "~s 'foo|bar'",      NULL,          false },
+      { "~s '\\bword'",      "word",        false },
+      // clang-format on
+    };
+
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i].pattern);
+      mutt_buffer_reset(&err);
+      struct PatternList *pat = mutt_pattern_comp(NULL, NULL, tests[i].pattern, 0, &err);
+      if (!TEST_CHECK(pat != NULL))
+        continue;
+
+      struct Pattern *p = SLIST_FIRST(pat);
+      if (!TEST_CHECK(mutt_str_equal(p->literal, tests[i].literal)))
+      {
+        TEST_MSG("Expected: %s", NONULL(tests[i].literal));
+        TEST_MSG("Actual  : %s", NONULL(p->literal));
+      }
+      TEST_CHECK(p->literal_only == tests[i].exact);
+
+      mutt_pattern_free(&pat);
+    }
+  }
+
   mutt_buffer_dealloc(&err);
 }
@@ -147,6 +147,15 @@ struct Message *mx_msg_open(struct Mailbox *m, int msgno)
   return NULL;
 }
 
+void mx_msg_prefetch(struct Mailbox *m, struct Email *e)
+{
+}
+
+bool mx_msg_map(struct Mailbox *m, struct Message *msg)
+{
+  return false;
+}
+
 int mx_msg_padding_size(struct Mailbox *m)
 {
   return 0;
@@ -172,6 +181,10 @@ struct Email *mutt_get_virt_email(struct Mailbox *m, int vnum)
   return m->emails[inum];
 }
 
+void mutt_encode_path(struct Buffer *buf, const char *src)
+{
+}
+
 void mutt_buffer_mktemp_full(struct Buffer *buf, const char *prefix,
                              const char *suffix, const char *src, int line)
 {
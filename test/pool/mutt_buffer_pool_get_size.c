@@ -0,0 +1,65 @@
+/**
+ * @file
+ * Test code for mutt_buffer_pool_get_size()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+
+void test_mutt_buffer_pool_get_size(void)
+{
+  // struct Buffer *mutt_buffer_pool_get_size(size_t size);
+
+  {
+    struct Buffer *buf = mutt_buffer_pool_get_size(0);
+    TEST_CHECK(buf != NULL);
+    TEST_CHECK(buf->dsize >= 1024);
+    mutt_buffer_pool_release(&buf);
+  }
+
+  {
+    struct Buffer *buf = mutt_buffer_pool_get_size(100000);
+    TEST_CHECK(buf != NULL);
+    TEST_CHECK(buf->dsize >= 100000);
+    mutt_buffer_pool_release(&buf);
+  }
+
+  {
+    struct Buffer *buf = mutt_buffer_pool_get_size(1000000);
+    TEST_CHECK(buf != NULL);
+    TEST_CHECK(buf->dsize >= 1000000);
+    mutt_buffer_pool_release(&buf);
+  }
+
+  {
+    /* A large Buffer isn't handed out for a small request */
+    struct Buffer *big = mutt_buffer_pool_get_size(100000);
+    mutt_buffer_pool_release(&big);
+    struct Buffer *buf = mutt_buffer_pool_get();
+    TEST_CHECK(buf->dsize < 100000);
+    TEST_MSG("dsize = %zu", buf->dsize);
+    mutt_buffer_pool_release(&buf);
+  }
+
+  mutt_buffer_pool_free();
+}
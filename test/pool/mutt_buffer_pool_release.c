@@ -39,4 +39,28 @@ void test_mutt_buffer_pool_release(void)
     mutt_buffer_pool_release(&buf);
     TEST_CHECK_(1, "mutt_buffer_pool_release(&buf)");
   }
+
+  {
+    /* A Buffer that's grown is shrunk again */
+    struct Buffer *buf = mutt_buffer_pool_get();
+    mutt_buffer_alloc(buf, 5000);
+    mutt_buffer_pool_release(&buf);
+    TEST_CHECK(buf == NULL);
+    buf = mutt_buffer_pool_get();
+    TEST_CHECK(buf->dsize == 1024);
+    TEST_MSG("dsize = %zu", buf->dsize);
+    mutt_buffer_pool_release(&buf);
+  }
+
+  {
+    /* Releasing lots of large Buffers doesn't keep them all */
+    struct Buffer *bufs[50] = { 0 };
+    for (size_t i = 0; i < mutt_array_size(bufs); i++)
+      bufs[i] = mutt_buffer_pool_get_size(200000);
+    for (size_t i = 0; i < mutt_array_size(bufs); i++)
+      mutt_buffer_pool_release(&bufs[i]);
+    TEST_CHECK_(1, "release 50 large buffers");
+  }
+
+  mutt_buffer_pool_free();
 }
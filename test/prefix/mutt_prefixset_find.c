@@ -0,0 +1,95 @@
+/**
+ * @file
+ * Test code for mutt_prefixset_find()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_prefixset_find(void)
+{
+  // int mutt_prefixset_find(const struct PrefixSet *ps, const char *s);
+
+  {
+    TEST_CHECK(mutt_prefixset_find(NULL, "apple") == 0);
+  }
+
+  struct ListHead list = STAILQ_HEAD_INITIALIZER(list);
+  mutt_list_insert_tail(&list, "X-");
+  mutt_list_insert_tail(&list, "subject:");
+  mutt_list_insert_tail(&list, "X-Mailer");
+  mutt_list_insert_tail(&list, "");
+  mutt_list_insert_tail(&list, "to");
+
+  {
+    struct PrefixSet *ps = mutt_prefixset_new(&list);
+    TEST_CHECK(mutt_prefixset_find(ps, NULL) == 0);
+    TEST_CHECK(mutt_prefixset_find(ps, "") == 0);
+    TEST_CHECK(mutt_prefixset_find(ps, "Subject: Hello") == 2);
+    TEST_CHECK(mutt_prefixset_find(ps, "Subject") == 0);
+    TEST_CHECK(mutt_prefixset_find(ps, "To: bob@example.com") == 5);
+    TEST_CHECK(mutt_prefixset_find(ps, "Topic: fruit") == 5);
+    TEST_CHECK(mutt_prefixset_find(ps, "From: bob@example.com") == 0);
+    // The first item in the list wins
+    TEST_CHECK(mutt_prefixset_find(ps, "x-mailer: NeoMutt") == 1);
+    mutt_prefixset_free(&ps);
+  }
+
+  {
+    // It agrees with mutt_list_match()
+    static const char *tests[] = {
+      "X-Label: work", "subject: x", "SUBJECT:", "t", "to", "Cc: alice", "x",
+    };
+    struct PrefixSet *ps = mutt_prefixset_new(&list);
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      TEST_CASE(tests[i]);
+      TEST_CHECK((mutt_prefixset_find(ps, tests[i]) != 0) == mutt_list_match(tests[i], &list));
+    }
+    mutt_prefixset_free(&ps);
+  }
+
+  {
+    // "*" matches everything
+    mutt_list_insert_tail(&list, "*");
+    struct PrefixSet *ps = mutt_prefixset_new(&list);
+    TEST_CHECK(mutt_prefixset_find(ps, "From: bob@example.com") == 6);
+    TEST_CHECK(mutt_prefixset_find(ps, "X-Label: work") == 1);
+    mutt_prefixset_free(&ps);
+  }
+
+  {
+    // Prefixes longer than the copy on the stack
+    struct ListHead long_list = STAILQ_HEAD_INITIALIZER(long_list);
+    char prefix[300];
+    memset(prefix, 'a', sizeof(prefix) - 1);
+    prefix[sizeof(prefix) - 1] = '\0';
+    mutt_list_insert_tail(&long_list, prefix);
+    struct PrefixSet *ps = mutt_prefixset_new(&long_list);
+    TEST_CHECK(mutt_prefixset_find(ps, prefix) == 1);
+    TEST_CHECK(mutt_prefixset_find(ps, "aaaa") == 0);
+    mutt_prefixset_free(&ps);
+    mutt_list_clear(&long_list);
+  }
+
+  mutt_list_clear(&list);
+}
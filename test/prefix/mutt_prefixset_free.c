@@ -0,0 +1,48 @@
+/**
+ * @file
+ * Test code for mutt_prefixset_free()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_prefixset_free(void)
+{
+  // void mutt_prefixset_free(struct PrefixSet **ptr);
+
+  {
+    mutt_prefixset_free(NULL);
+    TEST_CHECK_(1, "mutt_prefixset_free(NULL)");
+  }
+
+  {
+    struct PrefixSet *ps = NULL;
+    mutt_prefixset_free(&ps);
+    TEST_CHECK_(1, "mutt_prefixset_free(&ps)");
+  }
+
+  {
+    struct PrefixSet *ps = mutt_prefixset_new(NULL);
+    mutt_prefixset_free(&ps);
+    TEST_CHECK(ps == NULL);
+  }
+}
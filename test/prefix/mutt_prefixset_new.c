@@ -0,0 +1,57 @@
+/**
+ * @file
+ * Test code for mutt_prefixset_new()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_prefixset_new(void)
+{
+  // struct PrefixSet *mutt_prefixset_new(const struct ListHead *h);
+
+  {
+    struct PrefixSet *ps = mutt_prefixset_new(NULL);
+    TEST_CHECK(ps != NULL);
+    TEST_CHECK(ps->num_lens == 0);
+    mutt_prefixset_free(&ps);
+  }
+
+  {
+    // Repeated lengths are only stored once
+    struct ListHead list = STAILQ_HEAD_INITIALIZER(list);
+    mutt_list_insert_tail(&list, "cc");
+    mutt_list_insert_tail(&list, "to");
+    mutt_list_insert_tail(&list, "from:");
+    mutt_list_insert_tail(&list, "date");
+    mutt_list_insert_tail(&list, "*");
+
+    struct PrefixSet *ps = mutt_prefixset_new(&list);
+    TEST_CHECK(ps->num_lens == 3);
+    TEST_CHECK(ps->lens[0] == 2);
+    TEST_CHECK(ps->lens[1] == 4);
+    TEST_CHECK(ps->lens[2] == 5);
+    TEST_CHECK(ps->star == 5);
+    mutt_prefixset_free(&ps);
+    mutt_list_clear(&list);
+  }
+}
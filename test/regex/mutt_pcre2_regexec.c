@@ -0,0 +1,115 @@
+/**
+ * @file
+ * Test code for mutt_pcre2_regexec()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+struct PosixTest
+{
+  const char *regex;
+  int cflags;
+  const char *str;
+  int so; ///< Start of the match, -1 for no match
+  int eo; ///< End of the match
+};
+
+void test_mutt_pcre2_regexec(void)
+{
+  // int mutt_pcre2_regexec(const regex_t *preg, const char *str, size_t nmatch, regmatch_t pmatch[], int eflags);
+
+  {
+    TEST_CHECK(regexec(NULL, "apple", 0, NULL, 0) == REG_NOMATCH);
+  }
+
+  {
+    static const struct PosixTest tests[] = {
+      // clang-format off
+      { "b+",             0,           "abbbc",       1, 4 },
+      { "APPLE",          REG_ICASE,   "an apple",    3, 8 },
+      { "[\\]",           0,           "a\\b",        1, 2 },
+      { "[]x]+",          0,           "a]x]b",       1, 4 },
+      { "a)",             0,           "(a)",         1, 3 },
+      { "\\<cat\\>",      0,           "concat cat",  7, 10 },
+      { "[[:digit:]]{2}", 0,           "a1b23",       3, 5 },
+      { "a.b",            0,           "a\nb",        0, 3 },
+      { "a.b",            REG_NEWLINE, "a\nb",        -1, -1 },
+      { "^b",             REG_NEWLINE, "a\nb",        2, 3 },
+      { "a$",             0,           "a\n",         -1, -1 },
+      { "(x|y)z",         0,           "wyz",         1, 3 },
+      // clang-format on
+    };
+
+    for (size_t i = 0; i < mutt_array_size(tests); i++)
+    {
+      const struct PosixTest *t = &tests[i];
+      TEST_CASE(t->regex);
+
+      regex_t rx;
+      if (!TEST_CHECK(REG_COMP(&rx, t->regex, t->cflags) == 0))
+        continue;
+
+      regmatch_t m[1] = { 0 };
+      int rc = regexec(&rx, t->str, 1, m, 0);
+      if (t->so < 0)
+      {
+        TEST_CHECK(rc == REG_NOMATCH);
+      }
+      else
+      {
+        TEST_CHECK(rc == 0);
+        TEST_CHECK((m[0].rm_so == t->so) && (m[0].rm_eo == t->eo));
+        TEST_MSG("Expected: %d-%d", t->so, t->eo);
+        TEST_MSG("Actual  : %d-%d", m[0].rm_so, m[0].rm_eo);
+      }
+      regfree(&rx);
+    }
+  }
+
+  {
+    // Subexpressions that didn't take part in the match
+    regex_t rx;
+    TEST_CHECK(REG_COMP(&rx, "(a)|(b)", 0) == 0);
+    TEST_CHECK(rx.re_nsub == 2);
+
+    regmatch_t m[4];
+    TEST_CHECK(regexec(&rx, "b", 4, m, 0) == 0);
+    TEST_CHECK((m[1].rm_so == -1) && (m[2].rm_so == 0) && (m[3].rm_so == -1));
+
+    TEST_CHECK(regexec(&rx, "xb", 1, m, REG_NOTBOL) == 0);
+    regfree(&rx);
+  }
+
+  {
+    // Errors are described
+    regex_t rx;
+    int rc = REG_COMP(&rx, "(a", 0);
+    TEST_CHECK(rc == REG_BADPAT);
+
+    char buf[256] = { 0 };
+    TEST_CHECK(regerror(rc, &rx, buf, sizeof(buf)) > 1);
+    TEST_CHECK(buf[0] != '\0');
+    TEST_MSG("%s", buf);
+    regfree(&rx);
+  }
+}
@@ -0,0 +1,78 @@
+/**
+ * @file
+ * Test code for mutt_regex_check()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_regex_check(void)
+{
+  // bool mutt_regex_check(const char *str, size_t *nsub, struct Buffer *err);
+
+  {
+    TEST_CHECK(!mutt_regex_check(NULL, NULL, NULL));
+  }
+
+  {
+    static const char *good[] = {
+      "",         "apple",       "^a.*b$",      "(a|b)(c)",  "[]a]",
+      "[^]a]",    "[[:alpha:]]", "[(]",         "a\\(b",      "a)",
+      "[a[]",     "x{2}",        "\\\\",        "(a(b)c)",   "[a-z]+([0-9])",
+    };
+    static const size_t subs[] = {
+      0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1,
+    };
+
+    for (size_t i = 0; i < mutt_array_size(good); i++)
+    {
+      TEST_CASE(good[i]);
+      size_t nsub = 99;
+      TEST_CHECK(mutt_regex_check(good[i], &nsub, NULL));
+      TEST_CHECK(nsub == subs[i]);
+      TEST_MSG("Expected: %zu", subs[i]);
+      TEST_MSG("Actual  : %zu", nsub);
+
+      regex_t rx;
+      TEST_CHECK(REG_COMP(&rx, good[i], 0) == 0);
+      regfree(&rx);
+    }
+  }
+
+  {
+    static const char *bad[] = {
+      "a\\", "[abc", "[]", "[^]", "(a", "((a)", "[[:alpha:]", "a(b[)]",
+    };
+
+    for (size_t i = 0; i < mutt_array_size(bad); i++)
+    {
+      TEST_CASE(bad[i]);
+      struct Buffer *err = mutt_buffer_pool_get();
+      TEST_CHECK(!mutt_regex_check(bad[i], NULL, err));
+      TEST_CHECK(!mutt_buffer_is_empty(err));
+
+      regex_t rx;
+      TEST_CHECK(REG_COMP(&rx, bad[i], 0) != 0);
+      mutt_buffer_pool_release(&err);
+    }
+  }
+}
@@ -0,0 +1,71 @@
+/**
+ * @file
+ * Test code for mutt_regexset_add()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_regexset_add(void)
+{
+  // int mutt_regexset_add(struct RegexSet *rs, const char *str, uint16_t flags, struct Buffer *err);
+
+  {
+    TEST_CHECK(mutt_regexset_add(NULL, "apple", 0, NULL) == 0);
+  }
+
+  {
+    struct RegexSet rs = { STAILQ_HEAD_INITIALIZER(rs.regexes), NULL };
+    TEST_CHECK(mutt_regexset_add(&rs, NULL, 0, NULL) == 0);
+    TEST_CHECK(mutt_regexset_add(&rs, "", 0, NULL) == 0);
+    TEST_CHECK(mutt_regexset_is_empty(&rs));
+  }
+
+  {
+    struct RegexSet rs = { STAILQ_HEAD_INITIALIZER(rs.regexes), NULL };
+    struct Buffer *err = mutt_buffer_pool_get();
+
+    // Literals are stored as strings
+    TEST_CHECK(mutt_regexset_add(&rs, "^john@example\\.com$", REG_ICASE, err) == 0);
+    TEST_CHECK(mutt_regexset_add(&rs, "^john@example\\.com$", REG_ICASE, err) == 0);
+    TEST_CHECK(rs.literals != NULL);
+    TEST_CHECK(STAILQ_EMPTY(&rs.regexes));
+
+    // Everything else is a regex
+    TEST_CHECK(mutt_regexset_add(&rs, "^jane@example.com$", REG_ICASE, err) == 0);
+    TEST_CHECK(mutt_regexset_add(&rs, "jim@example\\.com", REG_ICASE, err) == 0);
+    TEST_CHECK(mutt_regexset_add(&rs, "^\\<joe@example\\.com$", REG_ICASE, err) == 0);
+    TEST_CHECK(mutt_regexset_add(&rs, "^jill@example\\.com$", 0, err) == 0);
+    int count = 0;
+    struct RegexNode *np = NULL;
+    STAILQ_FOREACH(np, &rs.regexes, entries)
+    {
+      count++;
+    }
+    TEST_CHECK(count == 4);
+
+    TEST_CHECK(mutt_regexset_add(&rs, "^(bad$", REG_ICASE, err) != 0);
+
+    mutt_buffer_pool_release(&err);
+    mutt_regexset_free(&rs);
+  }
+}
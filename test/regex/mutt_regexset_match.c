@@ -0,0 +1,60 @@
+/**
+ * @file
+ * Test code for mutt_regexset_match()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_regexset_match(void)
+{
+  // bool mutt_regexset_match(const struct RegexSet *rs, const char *str);
+
+  {
+    TEST_CHECK(!mutt_regexset_match(NULL, "apple"));
+  }
+
+  {
+    struct RegexSet rs = { STAILQ_HEAD_INITIALIZER(rs.regexes), NULL };
+    TEST_CHECK(!mutt_regexset_match(&rs, NULL));
+    TEST_CHECK(!mutt_regexset_match(&rs, "apple"));
+  }
+
+  {
+    struct RegexSet rs = { STAILQ_HEAD_INITIALIZER(rs.regexes), NULL };
+    mutt_regexset_add(&rs, "^john@example\\.com$", REG_ICASE, NULL);
+    mutt_regexset_add(&rs, "^john\\+list@example\\.com$", REG_ICASE, NULL);
+    mutt_regexset_add(&rs, "^jane@example.com$", REG_ICASE, NULL);
+    mutt_regexset_add(&rs, "@example\\.org", REG_ICASE, NULL);
+
+    TEST_CHECK(mutt_regexset_match(&rs, "john@example.com"));
+    TEST_CHECK(mutt_regexset_match(&rs, "JOHN@Example.COM"));
+    TEST_CHECK(mutt_regexset_match(&rs, "john+list@example.com"));
+    TEST_CHECK(!mutt_regexset_match(&rs, "john@exampleXcom"));
+    TEST_CHECK(!mutt_regexset_match(&rs, "xjohn@example.com"));
+    TEST_CHECK(mutt_regexset_match(&rs, "jane@exampleXcom"));
+    TEST_CHECK(mutt_regexset_match(&rs, "jim@example.org"));
+    TEST_CHECK(!mutt_regexset_match(&rs, "jim@example.net"));
+
+    mutt_regexset_free(&rs);
+  }
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * Test code for mutt_regexset_remove()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_regexset_remove(void)
+{
+  // int mutt_regexset_remove(struct RegexSet *rs, const char *str);
+
+  {
+    TEST_CHECK(mutt_regexset_remove(NULL, "apple") != 0);
+  }
+
+  {
+    struct RegexSet rs = { STAILQ_HEAD_INITIALIZER(rs.regexes), NULL };
+    TEST_CHECK(mutt_regexset_remove(&rs, NULL) != 0);
+    TEST_CHECK(mutt_regexset_remove(&rs, "^apple$") != 0);
+  }
+
+  {
+    struct RegexSet rs = { STAILQ_HEAD_INITIALIZER(rs.regexes), NULL };
+    mutt_regexset_add(&rs, "^apple$", REG_ICASE, NULL);
+    mutt_regexset_add(&rs, "banana", REG_ICASE, NULL);
+    mutt_regexset_add(&rs, "^cherry$", REG_ICASE, NULL);
+
+    TEST_CHECK(mutt_regexset_remove(&rs, "^APPLE$") == 0);
+    TEST_CHECK(!mutt_regexset_match(&rs, "apple"));
+    TEST_CHECK(mutt_regexset_remove(&rs, "banana") == 0);
+    TEST_CHECK(!mutt_regexset_match(&rs, "banana"));
+    TEST_CHECK(mutt_regexset_match(&rs, "cherry"));
+
+    TEST_CHECK(mutt_regexset_remove(&rs, "*") == 0);
+    TEST_CHECK(mutt_regexset_is_empty(&rs));
+  }
+}
@@ -0,0 +1,76 @@
+/**
+ * @file
+ * Test code for mutt_slab_alloc()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdbool.h>
+#include "mutt/lib.h"
+
+struct SlabTest
+{
+  int num;
+  char name[20];
+};
+
+void test_mutt_slab_alloc(void)
+{
+  // void *mutt_slab_alloc(struct Slab *slab);
+
+  {
+    TEST_CHECK(mutt_slab_alloc(NULL) == NULL);
+  }
+
+  {
+    struct Slab slab = MUTT_SLAB_INIT(struct SlabTest);
+    struct SlabTest *st = mutt_slab_alloc(&slab);
+    TEST_CHECK(st != NULL);
+    TEST_CHECK(st->num == 0);
+    TEST_CHECK(st->name[0] == '\0');
+    TEST_CHECK(slab.used == 1);
+    mutt_slab_free(&slab, st);
+  }
+
+  {
+    // Enough objects to need several chunks
+    struct Slab slab = MUTT_SLAB_INIT(struct SlabTest);
+    struct SlabTest *objs[10000];
+    bool zeroed = true;
+    for (int i = 0; i < 10000; i++)
+    {
+      objs[i] = mutt_slab_alloc(&slab);
+      zeroed &= (objs[i]->num == 0);
+      objs[i]->num = i;
+    }
+    TEST_CHECK(zeroed);
+    TEST_CHECK(slab.used == 10000);
+
+    bool intact = true;
+    for (int i = 0; i < 10000; i++)
+      intact &= (objs[i]->num == i);
+    TEST_CHECK(intact);
+
+    for (int i = 0; i < 10000; i++)
+      mutt_slab_free(&slab, objs[i]);
+    TEST_CHECK(slab.used == 0);
+  }
+}
@@ -0,0 +1,63 @@
+/**
+ * @file
+ * Test code for mutt_slab_free()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_slab_free(void)
+{
+  // void mutt_slab_free(struct Slab *slab, void *ptr);
+
+  {
+    struct Slab slab = MUTT_SLAB_INIT(long);
+    mutt_slab_free(NULL, NULL);
+    mutt_slab_free(&slab, NULL);
+    TEST_CHECK_(1, "mutt_slab_free(&slab, NULL)");
+  }
+
+  {
+    // A freed object is reused, and zeroed
+    struct Slab slab = MUTT_SLAB_INIT(long);
+    long *keep = mutt_slab_alloc(&slab);
+    long *l = mutt_slab_alloc(&slab);
+    *l = 42;
+    mutt_slab_free(&slab, l);
+    TEST_CHECK(slab.used == 1);
+    long *l2 = mutt_slab_alloc(&slab);
+    TEST_CHECK(l2 == l);
+    TEST_CHECK(*l2 == 0);
+    mutt_slab_free(&slab, l2);
+    mutt_slab_free(&slab, keep);
+  }
+
+  {
+    // Freeing the last object releases the memory
+    struct Slab slab = MUTT_SLAB_INIT(long);
+    long *l = mutt_slab_alloc(&slab);
+    mutt_slab_free(&slab, l);
+    TEST_CHECK(slab.used == 0);
+    TEST_CHECK(slab.chunks == NULL);
+    TEST_CHECK(slab.free_list == NULL);
+  }
+}
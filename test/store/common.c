@@ -67,6 +67,12 @@ bool test_store_degenerate(const struct StoreOps *sops, const char *name)
   if (!TEST_CHECK(sops->delete_record(NULL, NULL, 0) != 0))
     return false;
 
+  if (!TEST_CHECK(sops->begin_txn(NULL) != 0))
+    return false;
+
+  if (!TEST_CHECK(sops->commit_txn(NULL) != 0))
+    return false;
+
   sops->close(NULL);
   TEST_CHECK_(1, "sops->close(NULL)");
 
@@ -107,5 +113,23 @@ bool test_store_db(const struct StoreOps *sops, void *db)
   if (!TEST_CHECK(rc == 0))
     return false;
 
+  rc = sops->begin_txn(db);
+  if (!TEST_CHECK(rc == 0))
+    return false;
+
+  rc = sops->store(db, key, klen, value, vlen);
+  if (!TEST_CHECK(rc == 0))
+    return false;
+
+  rc = sops->commit_txn(db);
+  if (!TEST_CHECK(rc == 0))
+    return false;
+
+  data = sops->fetch(db, key, klen, &vlen);
+  if (!TEST_CHECK(data != NULL))
+    return false;
+
+  sops->free(db, &data);
+
   return true;
 }
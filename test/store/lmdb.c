@@ -24,6 +24,7 @@
 #include "config.h"
 #include "acutest.h"
 #include <limits.h>
+#include <string.h>
 #include "mutt/lib.h"
 #include "store/lib.h"
 #include "common.h"
@@ -50,4 +51,48 @@ void test_store_lmdb(void)
   TEST_CHECK(test_store_db(sops, db) == true);
 
   sops->close(&db);
+
+  // Named databases sharing one file
+  TEST_CHECK(sops->open_named(NULL, "inbox") == NULL);
+  TEST_CHECK(sops->open_named(path, NULL) == NULL);
+
+  mutt_str_cat(path, sizeof(path), "-shared");
+
+  void *inbox = sops->open_named(path, "inbox");
+  void *sent = sops->open_named(path, "sent");
+  TEST_CHECK((inbox != NULL) && (sent != NULL));
+
+  TEST_CHECK(test_store_db(sops, inbox) == true);
+
+  size_t vlen = 0;
+  TEST_CHECK(sops->fetch(sent, "one", 3, &vlen) == NULL);
+
+  sops->close(&inbox);
+  sops->close(&sent);
+
+  inbox = sops->open_named(path, "inbox");
+  TEST_CHECK(sops->fetch(inbox, "one", 3, &vlen) != NULL);
+
+  // Fetch many records at once, in any order
+  TEST_CHECK(sops->store(inbox, "apple", 5, "red", 3) == 0);
+  TEST_CHECK(sops->store(inbox, "banana", 6, "yellow", 6) == 0);
+  TEST_CHECK(sops->store(inbox, "cherry", 6, "dark red", 8) == 0);
+
+  const char *keys[] = { "cherry", "missing", "apple", "banana" };
+  const size_t klens[] = { 6, 7, 5, 6 };
+  void *values[4] = { 0 };
+  size_t vlens[4] = { 0 };
+
+  sops->fetch_many(inbox, keys, klens, 4, values, vlens);
+  TEST_CHECK((vlens[0] == 8) && values[0] && (memcmp(values[0], "dark red", 8) == 0));
+  TEST_CHECK((values[1] == NULL) && (vlens[1] == 0));
+  TEST_CHECK((vlens[2] == 3) && values[2] && (memcmp(values[2], "red", 3) == 0));
+  TEST_CHECK((vlens[3] == 6) && values[3] && (memcmp(values[3], "yellow", 6) == 0));
+  for (size_t i = 0; i < 4; i++)
+    sops->free(inbox, &values[i]);
+
+  sops->fetch_many(NULL, keys, klens, 4, values, vlens);
+  TEST_CHECK((values[0] == NULL) && (values[3] == NULL));
+
+  sops->close(&inbox);
 }
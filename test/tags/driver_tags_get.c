@@ -25,13 +25,54 @@
 #include "acutest.h"
 #include "mutt/lib.h"
 #include "address/lib.h"
+#include "config/lib.h"
+#include "core/lib.h"
 #include "email/lib.h"
+#include "test_common.h"
+
+static struct ConfigDef Vars[] = {
+  // clang-format off
+  { "hidden_tags", DT_SLIST|SLIST_SEP_COMMA, IP "unread", 0, NULL, },
+  { NULL },
+  // clang-format on
+};
 
 void test_driver_tags_get(void)
 {
-  // char *driver_tags_get(struct TagList *list);
+  // const char *driver_tags_get(struct TagList *list);
 
   {
     TEST_CHECK(!driver_tags_get(NULL));
   }
+
+  {
+    NeoMutt = test_neomutt_create();
+    TEST_CHECK(cs_register_variables(NeoMutt->sub->cs, Vars, 0));
+    TagTransforms = mutt_hash_new(8, MUTT_HASH_STRCASECMP | MUTT_HASH_STRDUP_KEYS);
+    mutt_hash_insert(TagTransforms, "inbox", "i");
+
+    struct TagList tags;
+    driver_tags_init(&tags);
+    TEST_CHECK(!driver_tags_get(&tags));
+    TEST_CHECK(!driver_tags_get_transformed(&tags));
+
+    char str[] = "inbox unread work";
+    TEST_CHECK(driver_tags_replace(&tags, str));
+    TEST_CHECK_STR_EQ("inbox work", driver_tags_get(&tags));
+    TEST_CHECK_STR_EQ("i work", driver_tags_get_transformed(&tags));
+    TEST_CHECK_STR_EQ("unread", driver_tags_get_transformed_for(&tags, "unread"));
+    TEST_CHECK_STR_EQ("i", driver_tags_get_transformed_for(&tags, "inbox"));
+
+    /* The cached strings follow the changes */
+    driver_tags_add(&tags, mutt_str_dup("todo"));
+    TEST_CHECK_STR_EQ("inbox work todo", driver_tags_get(&tags));
+    TEST_CHECK_STR_EQ("i work todo", driver_tags_get_transformed(&tags));
+
+    driver_tags_free(&tags);
+    TEST_CHECK(!driver_tags_get(&tags));
+    TEST_CHECK(!driver_tags_get_transformed(&tags));
+
+    mutt_hash_free(&TagTransforms);
+    test_neomutt_destroy(&NeoMutt);
+  }
 }
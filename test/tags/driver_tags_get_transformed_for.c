@@ -29,7 +29,7 @@
 
 void test_driver_tags_get_transformed_for(void)
 {
-  // char *driver_tags_get_transformed_for(struct TagList *list, const char *name);
+  // const char *driver_tags_get_transformed_for(struct TagList *list, const char *name);
 
   {
     struct TagList taghead = { 0 };
@@ -51,4 +51,15 @@ void test_insert_message(void)
     insert_message(&tnew, &newparent, NULL);
     TEST_CHECK_(1, "insert_message(&tnew, &newparent, NULL)");
   }
+
+  {
+    struct MuttThread *tnew = NULL;
+    struct MuttThread newparent = { 0 };
+    struct MuttThread cur = { 0 };
+    insert_message(&tnew, &newparent, &cur);
+    TEST_CHECK(tnew == &cur);
+    TEST_CHECK(cur.parent == &newparent);
+    TEST_CHECK(cur.redraw);
+    TEST_CHECK(newparent.redraw);
+  }
 }
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * Test code for trace_open()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "mutt/lib.h"
+
+void test_trace_open(void)
+{
+  // int trace_open(const char *file);
+
+  {
+    TEST_CHECK(trace_open(NULL) == -1);
+    TEST_CHECK(trace_open("") == -1);
+    TEST_CHECK(trace_open("/nonexistent/trace.json") == -1);
+    TEST_CHECK(!TraceEnabled);
+  }
+
+  {
+    // Nothing is recorded while the trace is closed
+    trace_begin("test", "closed", NULL);
+    trace_end();
+    trace_close();
+    TEST_CHECK_(1, "trace_close()");
+  }
+
+  {
+    char path[] = "/tmp/neomutt-test-trace-XXXXXX";
+    int fd = mkstemp(path);
+    TEST_CHECK(fd >= 0);
+    close(fd);
+
+    TEST_CHECK(trace_open(path) == 0);
+    TEST_CHECK(TraceEnabled);
+    {
+      TRACE_SCOPE("test", "scope", "a \"quoted\"\\path\n");
+      trace_async_begin("test", "async", "A1", NULL);
+      trace_async_end("test", "async", "A1", "OK");
+    }
+    trace_close();
+    TEST_CHECK(!TraceEnabled);
+
+    FILE *fp = fopen(path, "r");
+    TEST_CHECK(fp != NULL);
+    char buf[4096] = { 0 };
+    size_t len = fp ? fread(buf, 1, sizeof(buf) - 1, fp) : 0;
+    if (fp)
+      fclose(fp);
+
+    TEST_CHECK(len > 0);
+    TEST_CHECK(mutt_str_startswith(buf, "[\n"));
+    TEST_CHECK((len > 3) && mutt_str_equal(buf + len - 3, "\n]\n"));
+    TEST_CHECK(strstr(buf, "\"ph\":\"B\"") != NULL);
+    TEST_CHECK(strstr(buf, "\"ph\":\"E\"") != NULL);
+    TEST_CHECK(strstr(buf, "\"ph\":\"b\"") != NULL);
+    TEST_CHECK(strstr(buf, "\"ph\":\"e\"") != NULL);
+    TEST_CHECK(strstr(buf, "\"id\":\"A1\"") != NULL);
+    TEST_CHECK(strstr(buf, "a \\\"quoted\\\"\\\\path\\u000a") != NULL);
+    TEST_CHECK(strstr(buf, "closed") == NULL);
+    TEST_MSG("trace = %s", buf);
+
+    unlink(path);
+  }
+}
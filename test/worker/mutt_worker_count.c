@@ -0,0 +1,41 @@
+/**
+ * @file
+ * Test code for mutt_worker_count()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+void test_mutt_worker_count(void)
+{
+  // int mutt_worker_count(void);
+
+  {
+    int num = mutt_worker_count();
+    TEST_CHECK(num >= 1);
+#ifndef USE_PTHREADS
+    TEST_CHECK(num == 1);
+#endif
+    TEST_CHECK(mutt_worker_count() == num);
+    mutt_worker_stop();
+  }
+}
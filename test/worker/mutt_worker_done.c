@@ -0,0 +1,51 @@
+/**
+ * @file
+ * Test code for mutt_worker_done()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static void increment(void *item)
+{
+  (*(long *) item)++;
+}
+
+void test_mutt_worker_done(void)
+{
+  // bool mutt_worker_done(struct WorkerFuture *fut);
+
+  {
+    TEST_CHECK(mutt_worker_done(NULL));
+  }
+
+  {
+    long l = 0;
+    struct WorkerFuture *fut = mutt_worker_submit(increment, &l);
+    while (!mutt_worker_done(fut))
+      ; // spin
+    TEST_CHECK(l == 1);
+    mutt_worker_wait(&fut);
+  }
+
+  mutt_worker_stop();
+}
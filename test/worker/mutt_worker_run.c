@@ -0,0 +1,79 @@
+/**
+ * @file
+ * Test code for mutt_worker_run()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static void square(void *item)
+{
+  long *l = item;
+  *l = *l * *l;
+}
+
+static void nested(void *item)
+{
+  long pair[2] = { 2, 3 };
+  mutt_worker_run(square, pair, sizeof(long), 2);
+  *(long *) item = pair[0] + pair[1];
+}
+
+void test_mutt_worker_run(void)
+{
+  // void mutt_worker_run(worker_task_t task, void *items, size_t size, size_t num);
+
+  {
+    long l = 3;
+    mutt_worker_run(NULL, &l, sizeof(l), 1);
+    mutt_worker_run(square, NULL, sizeof(l), 1);
+    mutt_worker_run(square, &l, sizeof(l), 0);
+    TEST_CHECK(l == 3);
+  }
+
+  {
+    // Every item is worked on exactly once
+    long items[1000];
+    for (long i = 0; i < 1000; i++)
+      items[i] = i;
+
+    mutt_worker_run(square, items, sizeof(long), 1000);
+
+    bool ok = true;
+    for (long i = 0; i < 1000; i++)
+      ok &= (items[i] == (i * i));
+    TEST_CHECK(ok);
+  }
+
+  {
+    // A task may start more tasks
+    long items[50] = { 0 };
+    mutt_worker_run(nested, items, sizeof(long), 50);
+
+    bool ok = true;
+    for (int i = 0; i < 50; i++)
+      ok &= (items[i] == 13);
+    TEST_CHECK(ok);
+  }
+
+  mutt_worker_stop();
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * Test code for mutt_worker_set_threads()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static void increment(void *item)
+{
+  (*(long *) item)++;
+}
+
+void test_mutt_worker_set_threads(void)
+{
+  // void mutt_worker_set_threads(int num);
+
+  {
+    mutt_worker_set_threads(1);
+    TEST_CHECK(mutt_worker_count() == 1);
+  }
+
+  {
+    // A future is finished at once, if there are no workers
+    long l = 0;
+    struct WorkerFuture *fut = mutt_worker_submit(increment, &l);
+    TEST_CHECK(mutt_worker_done(fut));
+    TEST_CHECK(l == 1);
+    mutt_worker_wait(&fut);
+  }
+
+  {
+    mutt_worker_set_threads(3);
+    int num = mutt_worker_count();
+    TEST_CHECK((num == 1) || (num == 3));
+    TEST_MSG("count = %d", num);
+  }
+
+  {
+    // Queued tasks are finished when the workers are stopped
+    long items[100] = { 0 };
+    struct WorkerFuture *futs[100] = { 0 };
+    for (int i = 0; i < 100; i++)
+      futs[i] = mutt_worker_submit(increment, &items[i]);
+    mutt_worker_set_threads(0);
+
+    bool ok = true;
+    for (int i = 0; i < 100; i++)
+    {
+      ok &= mutt_worker_done(futs[i]);
+      mutt_worker_wait(&futs[i]);
+      ok &= (items[i] == 1);
+    }
+    TEST_CHECK(ok);
+  }
+
+  mutt_worker_stop();
+}
@@ -0,0 +1,56 @@
+/**
+ * @file
+ * Test code for mutt_worker_stop()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static void increment(void *item)
+{
+  (*(long *) item)++;
+}
+
+void test_mutt_worker_stop(void)
+{
+  // void mutt_worker_stop(void);
+
+  {
+    mutt_worker_stop();
+    mutt_worker_stop();
+    TEST_CHECK_(1, "mutt_worker_stop()");
+  }
+
+  {
+    // The workers are restarted when they're needed again
+    long items[100] = { 0 };
+    mutt_worker_run(increment, items, sizeof(long), 100);
+    mutt_worker_stop();
+    mutt_worker_run(increment, items, sizeof(long), 100);
+    mutt_worker_stop();
+
+    bool ok = true;
+    for (int i = 0; i < 100; i++)
+      ok &= (items[i] == 2);
+    TEST_CHECK(ok);
+  }
+}
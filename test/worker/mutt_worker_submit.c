@@ -0,0 +1,95 @@
+/**
+ * @file
+ * Test code for mutt_worker_submit()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static void square(void *item)
+{
+  long *l = item;
+  *l = *l * *l;
+}
+
+/**
+ * struct Spawn - A task that submits more tasks
+ */
+struct Spawn
+{
+  long items[10];
+  long sum;
+};
+
+static void spawn(void *item)
+{
+  struct Spawn *s = item;
+  struct WorkerFuture *futs[10] = { 0 };
+  for (int i = 0; i < 10; i++)
+  {
+    s->items[i] = i;
+    futs[i] = mutt_worker_submit(square, &s->items[i]);
+  }
+
+  s->sum = 0;
+  for (int i = 0; i < 10; i++)
+  {
+    mutt_worker_wait(&futs[i]);
+    s->sum += s->items[i];
+  }
+}
+
+void test_mutt_worker_submit(void)
+{
+  // struct WorkerFuture *mutt_worker_submit(worker_task_t task, void *item);
+
+  {
+    long l = 3;
+    TEST_CHECK(mutt_worker_submit(NULL, &l) == NULL);
+    TEST_CHECK(l == 3);
+  }
+
+  {
+    long l = 3;
+    struct WorkerFuture *fut = mutt_worker_submit(square, &l);
+    TEST_CHECK(fut != NULL);
+    mutt_worker_wait(&fut);
+    TEST_CHECK(l == 9);
+  }
+
+  {
+    // A task may submit, and wait for, more tasks
+    struct Spawn spawns[20] = { 0 };
+    struct WorkerFuture *futs[20] = { 0 };
+    for (int i = 0; i < 20; i++)
+      futs[i] = mutt_worker_submit(spawn, &spawns[i]);
+    for (int i = 0; i < 20; i++)
+      mutt_worker_wait(&futs[i]);
+
+    bool ok = true;
+    for (int i = 0; i < 20; i++)
+      ok &= (spawns[i].sum == 285);
+    TEST_CHECK(ok);
+  }
+
+  mutt_worker_stop();
+}
@@ -0,0 +1,67 @@
+/**
+ * @file
+ * Test code for mutt_worker_wait()
+ *
+ * @authors
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define TEST_NO_MAIN
+#include "config.h"
+#include "acutest.h"
+#include "mutt/lib.h"
+
+static void increment(void *item)
+{
+  (*(long *) item)++;
+}
+
+void test_mutt_worker_wait(void)
+{
+  // void mutt_worker_wait(struct WorkerFuture **pfut);
+
+  {
+    mutt_worker_wait(NULL);
+    TEST_CHECK_(1, "mutt_worker_wait(NULL)");
+  }
+
+  {
+    struct WorkerFuture *fut = NULL;
+    mutt_worker_wait(&fut);
+    TEST_CHECK_(1, "mutt_worker_wait(&fut)");
+  }
+
+  {
+    // Every task is run exactly once
+    long items[500] = { 0 };
+    struct WorkerFuture *futs[500] = { 0 };
+    for (int i = 0; i < 500; i++)
+      futs[i] = mutt_worker_submit(increment, &items[i]);
+    for (int i = 499; i >= 0; i--)
+    {
+      mutt_worker_wait(&futs[i]);
+      TEST_CHECK(futs[i] == NULL);
+    }
+
+    bool ok = true;
+    for (int i = 0; i < 500; i++)
+      ok &= (items[i] == 1);
+    TEST_CHECK(ok);
+  }
+
+  mutt_worker_stop();
+}
@@ -257,6 +257,9 @@ static struct CompileOptions comp_opts[] = {
 #else
   { "lua", 0 },
 #endif
+#ifdef USE_DEBUG_MEMORY
+  { "memory", 2 },
+#endif
 #ifdef HAVE_META
   { "meta", 1 },
 #else
@@ -291,11 +294,22 @@ static struct CompileOptions comp_opts[] = {
 #ifdef HAVE_PCRE2
   { "pcre2", 1 },
 #endif
+#ifdef USE_PCRE2_REGEX
+  { "pcre2-regex", 1 },
+#endif
+#ifdef USE_DEBUG_PERF
+  { "perf", 2 },
+#endif
 #ifdef CRYPT_BACKEND_CLASSIC_PGP
   { "pgp", 1 },
 #else
   { "pgp", 0 },
 #endif
+#ifdef USE_PTHREADS
+  { "pthreads", 1 },
+#else
+  { "pthreads", 0 },
+#endif
 #ifndef HAVE_PCRE2
   { "regex", 1 },
 #endif